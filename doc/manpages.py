@@ -118,6 +118,7 @@ man_pages = [
     ('man3/flux_future_wait_all_create', 'flux_future_push', 'functions for future composition', [author], 3),
     ('man3/flux_future_wait_all_create', 'flux_future_first_child', 'functions for future composition', [author], 3),
     ('man3/flux_future_wait_all_create', 'flux_future_next_child', 'functions for future composition', [author], 3),
+    ('man3/flux_future_wait_all_create', 'flux_future_next_ready_child', 'functions for future composition', [author], 3),
     ('man3/flux_future_wait_all_create', 'flux_future_get_child', 'functions for future composition', [author], 3),
     ('man3/flux_future_wait_all_create', 'flux_future_wait_all_create', 'functions for future composition', [author], 3),
     ('man3/flux_get_rank', 'flux_get_size', 'query Flux broker info', [author], 3),
@@ -142,6 +143,8 @@ man_pages = [
     ('man3/flux_kvs_getroot', 'flux_kvs_getroot_cancel', 'look up KVS root hash', [author], 3),
     ('man3/flux_kvs_getroot', 'flux_kvs_getroot', 'look up KVS root hash', [author], 3),
     ('man3/flux_kvs_lookup', 'flux_kvs_lookupat', 'look up KVS key', [author], 3),
+    ('man3/flux_kvs_lookup', 'flux_kvs_lookup_batch', 'look up KVS key', [author], 3),
+    ('man3/flux_kvs_lookup', 'flux_kvs_lookup_batch_get_index', 'look up KVS key', [author], 3),
     ('man3/flux_kvs_lookup', 'flux_kvs_lookup_get', 'look up KVS key', [author], 3),
     ('man3/flux_kvs_lookup', 'flux_kvs_lookup_get_unpack', 'look up KVS key', [author], 3),
     ('man3/flux_kvs_lookup', 'flux_kvs_lookup_get_raw', 'look up KVS key', [author], 3),
@@ -172,6 +175,7 @@ man_pages = [
     ('man3/flux_msg_create', 'flux_msg_decref', 'functions for Flux messages', [author], 3),
     ('man3/flux_msg_create', 'flux_msg_destroy', 'functions for Flux messages', [author], 3),
     ('man3/flux_msg_encode', 'flux_msg_decode', 'convert a Flux message to buffer and back again', [author], 3),
+    ('man3/flux_msg_encode', 'flux_msg_decode_ref', 'convert a Flux message to buffer and back again', [author], 3),
     ('man3/flux_msg_encode', 'flux_msg_encode', 'convert a Flux message to buffer and back again', [author], 3),
     ('man3/flux_msg_has_flag', 'flux_msg_has_flag', 'test/set Flux message flags', [author], 3),
     ('man3/flux_msg_has_flag', 'flux_msg_set_flag', 'test/set Flux message flags', [author], 3),
@@ -216,6 +220,7 @@ man_pages = [
     ('man3/flux_respond', 'flux_respond_pack', 'respond to a request', [author], 3),
     ('man3/flux_respond', 'flux_respond_raw', 'respond to a request', [author], 3),
     ('man3/flux_respond', 'flux_respond_error', 'respond to a request', [author], 3),
+    ('man3/flux_respond', 'flux_respond_batch', 'respond to a request', [author], 3),
     ('man3/flux_respond', 'flux_respond', 'respond to a request', [author], 3),
     ('man3/flux_response_decode', 'flux_response_decode_raw', 'decode a Flux response message', [author], 3),
     ('man3/flux_response_decode', 'flux_response_decode_error', 'decode a Flux response message', [author], 3),
@@ -231,6 +236,7 @@ man_pages = [
     ('man3/flux_rpc', 'flux_rpc_get_nodeid', 'perform a remote procedure call to a Flux service', [author], 3),
     ('man3/flux_send', 'flux_send', 'send message using Flux Message Broker', [author], 3),
     ('man3/flux_send', 'flux_send_new', 'send message using Flux Message Broker', [author], 3),
+    ('man3/flux_send', 'flux_send_batch', 'send message using Flux Message Broker', [author], 3),
     ('man3/flux_service_register', 'flux_service_register', 'Register service with flux broker', [author], 3),
     ('man3/flux_service_register', 'flux_service_unregister', 'Unregister service with flux broker', [author], 3),
     ('man3/flux_shell_add_completion_ref', 'flux_shell_remove_completion_ref', 'Manipulate conditions for job completion.', [author], 3),
@@ -288,6 +294,7 @@ man_pages = [
     ('man3/hostlist_create', 'hostlist_destroy', 'Manipulate lists of hostnames', [author], 3),
     ('man3/hostlist_create', 'hostlist_decode', 'Manipulate lists of hostnames', [author], 3),
     ('man3/hostlist_create', 'hostlist_encode', 'Manipulate lists of hostnames', [author], 3),
+    ('man3/hostlist_create', 'hostlist_join', 'Manipulate lists of hostnames', [author], 3),
     ('man3/hostlist_create', 'hostlist_copy', 'Manipulate lists of hostnames', [author], 3),
     ('man3/hostlist_create', 'hostlist_append', 'Manipulate lists of hostnames', [author], 3),
     ('man3/hostlist_create', 'hostlist_append_list', 'Manipulate lists of hostnames', [author], 3),
@@ -310,6 +317,9 @@ man_pages = [
     ('man3/idset_create', 'idset_clear', 'Manipulate numerically sorted sets of non-negative integers', [author], 3),
     ('man3/idset_create', 'idset_range_clear', 'Manipulate numerically sorted sets of non-negative integers', [author], 3),
     ('man3/idset_create', 'idset_test', 'Manipulate numerically sorted sets of non-negative integers', [author], 3),
+    ('man3/idset_create', 'idset_set_array', 'Manipulate numerically sorted sets of non-negative integers', [author], 3),
+    ('man3/idset_create', 'idset_test_array', 'Manipulate numerically sorted sets of non-negative integers', [author], 3),
+    ('man3/idset_create', 'idset_to_array', 'Manipulate numerically sorted sets of non-negative integers', [author], 3),
     ('man3/idset_create', 'idset_first', 'Manipulate numerically sorted sets of non-negative integers', [author], 3),
     ('man3/idset_create', 'idset_next', 'Manipulate numerically sorted sets of non-negative integers', [author], 3),
     ('man3/idset_create', 'idset_prev', 'Manipulate numerically sorted sets of non-negative integers', [author], 3),
@@ -339,8 +349,11 @@ man_pages = [
     ('man3/flux_jobtap_get_flux','flux_jobtap_service_register', 'Flux jobtap plugin interfaces', [author], 3),
     ('man3/flux_jobtap_get_flux','flux_jobtap_reprioritize_all', 'Flux jobtap plugin interfaces', [author], 3),
     ('man3/flux_jobtap_get_flux','flux_jobtap_reprioritize_job', 'Flux jobtap plugin interfaces', [author], 3),
+    ('man3/flux_jobtap_get_flux','flux_jobtap_reprioritize_jobs', 'Flux jobtap plugin interfaces', [author], 3),
+    ('man3/flux_jobtap_get_flux','flux_jobtap_reprioritize_user', 'Flux jobtap plugin interfaces', [author], 3),
     ('man3/flux_jobtap_get_flux','flux_jobtap_priority_unavail', 'Flux jobtap plugin interfaces', [author], 3),
     ('man3/flux_jobtap_get_flux','flux_jobtap_reject_job', 'Flux jobtap plugin interfaces', [author], 3),
+    ('man3/flux_sync_create','flux_sync_set_jitter', 'Synchronize on system heartbeat', [author], 3),
     ('man3/flux_sync_create','flux_sync_create', 'Synchronize on system heartbeat', [author], 3),
     ('man3/flux_job_timeleft','flux_job_timeleft', 'Get remaining time for a job', [author], 3),
     ('man5/flux-config', 'flux-config', 'Flux configuration files', [author], 5),
@@ -356,6 +369,9 @@ man_pages = [
     ('man5/flux-config-queues', 'flux-config-queues', 'configure Flux job queues', [author], 5),
     ('man5/flux-config-job-manager', 'flux-config-job-manager', 'configure Flux job manager service', [author], 5),
     ('man5/flux-config-kvs', 'flux-config-kvs', 'configure Flux kvs service', [author], 5),
+    ('man5/flux-config-content-sqlite', 'flux-config-content-sqlite', 'configure Flux content-sqlite service', [author], 5),
+    ('man5/flux-config-modules', 'flux-config-modules', 'configure Flux broker module placement', [author], 5),
+    ('man5/flux-config-connector-local', 'flux-config-connector-local', 'configure Flux local connector', [author], 5),
     ('man7/flux-broker-attributes', 'flux-broker-attributes', 'overview Flux broker attributes', [author], 7),
     ('man7/flux-jobtap-plugins', 'flux-jobtap-plugins', 'overview Flux jobtap plugin API', [author], 7),
     ('man7/flux-environment', 'flux-environment', 'Flux environment overview', [author], 7),
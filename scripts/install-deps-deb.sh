@@ -11,6 +11,7 @@ apt install \
   uuid-dev \
   libjansson-dev \
   liblz4-dev \
+  libzstd-dev \
   libarchive-dev \
   libhwloc-dev \
   libsqlite3-dev \
@@ -0,0 +1,169 @@
+###############################################################
+# Copyright 2026 Lawrence Livermore National Security, LLC
+# (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+#
+# This file is part of the Flux resource manager framework.
+# For details, see https://github.com/flux-framework.
+#
+# SPDX-License-Identifier: LGPL-3.0
+###############################################################
+
+"""asyncio integration for Flux handles
+
+A Flux handle may be attached to an asyncio event loop so that Flux
+futures can be awaited from coroutines, e.g.::
+
+    async def ping(handle):
+        return await handle.rpc("broker.ping", {"seq": 1})
+
+Awaiting a future attaches its handle to the running loop automatically.
+The handle's pollfd is registered as a reader with the loop, and on each
+wakeup every message already queued on the handle is dispatched by running
+the Flux reactor without blocking, up to ``batch`` messages, before control
+returns to the loop.  If messages remain, draining continues on the next
+loop iteration so other coroutines are not starved.
+
+Only message handlers and future continuations are driven this way.
+Flux reactor timers, including ``then()`` timeouts, do not run while the
+asyncio loop has control, so use :func:`asyncio.wait_for` for timeouts.
+"""
+
+import asyncio
+
+from flux.constants import FLUX_POLLIN, FLUX_REACTOR_NOWAIT
+from flux.core.inner import ffi
+
+# Attached handles, keyed by (loop, flux_t address)
+_READERS = {}
+
+
+def _handle_key(handle, loop):
+    return (loop, int(ffi.cast("uintptr_t", handle.handle)))
+
+
+class HandleReader:
+    """Dispatch messages for a Flux handle from an asyncio event loop
+
+    Args:
+        handle (flux.Flux): The Flux handle to attach
+        loop: The asyncio event loop
+        batch (int): Maximum number of messages dispatched per wakeup
+    """
+
+    def __init__(self, handle, loop, batch=256):
+        self.handle = handle
+        self.loop = loop
+        self.batch = batch
+        self.reactor = handle.get_reactor()
+        self.fd = handle.pollfd()
+        self.counters = ffi.new("flux_msgcounters_t *")
+        self.scheduled = False
+        loop.add_reader(self.fd, self._wakeup)
+
+        #  The pollfd is edge triggered, so messages queued before the
+        #   reader was added would otherwise not be seen.
+        self._wakeup()
+
+    def _rx_count(self):
+        self.handle.get_msgcounters(self.counters)
+        counters = self.counters
+        return (
+            counters.request_rx
+            + counters.response_rx
+            + counters.event_rx
+            + counters.control_rx
+        )
+
+    def _wakeup(self):
+        if not self.scheduled:
+            self.scheduled = True
+            self.loop.call_soon(self._drain)
+
+    def _drain(self):
+        self.scheduled = False
+        if self.fd is None:
+            return
+        count = 0
+        with self.handle.in_reactor():
+            while count < self.batch and self.handle.pollevents() & FLUX_POLLIN:
+                before = self._rx_count()
+                self.handle.flux_reactor_run(self.reactor, FLUX_REACTOR_NOWAIT)
+                #  Stop if nothing was received, e.g. no message handler
+                #   is registered to consume what is queued.
+                if self._rx_count() == before:
+                    break
+                count += 1
+        if count == self.batch:
+            self._wakeup()
+        type(self.handle).raise_if_exception()
+
+    def close(self):
+        """Stop dispatching messages for this handle from the loop"""
+        if self.fd is not None:
+            self.loop.remove_reader(self.fd)
+            self.fd = None
+
+
+def attach(handle, loop=None, batch=256):
+    """Attach a Flux handle to an asyncio event loop
+
+    Attaching the same handle to the same loop again returns the existing
+    reader.
+
+    Args:
+        handle (flux.Flux): The Flux handle to attach
+        loop: The event loop, by default the current event loop
+        batch (int): Maximum number of messages dispatched per wakeup
+
+    Returns:
+        HandleReader: The reader, which may be passed to :func:`detach`.
+    """
+    if loop is None:
+        loop = asyncio.get_event_loop()
+    key = _handle_key(handle, loop)
+    if key not in _READERS:
+        _READERS[key] = HandleReader(handle, loop, batch=batch)
+    return _READERS[key]
+
+
+def detach(handle, loop=None):
+    """Detach a Flux handle from an asyncio event loop
+
+    This should be called before the handle or loop is closed.
+    """
+    if loop is None:
+        loop = asyncio.get_event_loop()
+    reader = _READERS.pop(_handle_key(handle, loop), None)
+    if reader is not None:
+        reader.close()
+
+
+def wrap_future(future, loop=None):
+    """Return an asyncio future that completes with a Flux future
+
+    The result is the value of ``future.get()``, or its exception.
+    The Flux future's handle is attached to the loop if necessary.
+    """
+    if loop is None:
+        loop = asyncio.get_event_loop()
+    afuture = loop.create_future()
+
+    def set_result(fut):
+        if afuture.done():
+            return
+        try:
+            afuture.set_result(fut.get())
+        # pylint: disable=broad-except
+        except Exception as exc:
+            afuture.set_exception(exc)
+
+    if future.is_ready():
+        set_result(future)
+        return afuture
+
+    handle = future.get_flux()
+    if handle is None:
+        raise ValueError("future has no Flux handle and is not fulfilled")
+    attach(handle, loop)
+    future.then(set_result)
+    return afuture
@@ -256,6 +256,16 @@ class Future(WrapperPimpl):
             self.raise_if_handle_exception()
             raise
 
+    def __await__(self):
+        """
+        Await fulfillment of this future from an asyncio coroutine.
+        Returns the result of get(). See flux.aio.
+        """
+        # pylint: disable=cyclic-import, import-outside-toplevel
+        import flux.aio
+
+        return flux.aio.wrap_future(self).__await__()
+
     def incref(self):
         self.pimpl.flux_future_incref()
 
@@ -15,22 +15,6 @@ from _flux._hostlist import ffi, lib
 from flux.wrapper import Wrapper, WrapperPimpl
 
 
-class HostlistIterator:
-    def __init__(self, hostlist):
-        self._hostlist = hostlist
-        self._index = 0
-
-    def __iter__(self):
-        return self
-
-    def __next__(self):
-        if self._index < len(self._hostlist):
-            result = self._hostlist[self._index]
-            self._index += 1
-            return result
-        raise StopIteration
-
-
 class Hostlist(WrapperPimpl):
     """A Flux hostlist object
 
@@ -155,7 +139,7 @@ class Hostlist(WrapperPimpl):
 
     def __iter__(self):
         """Return a Hostlist iterator"""
-        return HostlistIterator(self)
+        return iter(self.expand())
 
     def __contains__(self, name):
         """Test if a hostname is in a Hostlist"""
@@ -212,7 +196,17 @@ class Hostlist(WrapperPimpl):
 
     def expand(self):
         """Convert a Hostlist to a Python list"""
-        return list(self)
+        #
+        #  N.B. Expand in one call to hostlist_join() rather than calling
+        #   hostlist_nth() per host, and free the result explicitly as in
+        #   encode()
+        #
+        val = lib.hostlist_join(self.handle, b"\n")
+        if val == ffi.NULL:
+            raise OSError(ffi.errno, "hostlist_join failed")
+        result = ffi.string(val).decode("utf-8")
+        lib.free(val)
+        return result.split("\n") if result else []
 
     def copy(self):
         """Copy a Hostlist object"""
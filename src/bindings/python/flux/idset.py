@@ -19,22 +19,6 @@ IDSET_FLAG_RANGE = lib.IDSET_FLAG_RANGE
 IDSET_FLAG_BRACKETS = lib.IDSET_FLAG_BRACKETS
 
 
-class IDsetIterator:
-    def __init__(self, idset):
-        self._idset = idset
-        self._next = idset.pimpl.first()
-
-    def __iter__(self):
-        return self
-
-    def __next__(self):
-        result = self._next
-        self._next = self._idset.pimpl.next(result)
-        if result == IDSET_INVALID_ID:
-            raise StopIteration
-        return result
-
-
 class IDset(WrapperPimpl):
     """A Flux idset object
 
@@ -79,7 +63,7 @@ class IDset(WrapperPimpl):
             #   slightly less efficient.
             arg = str(arg)
         elif isinstance(arg, collections.abc.Iterable) and not isinstance(arg, str):
-            arg = ",".join(str(i) for i in sorted(arg))
+            handle = self._create_from_ids(arg)
         elif isinstance(arg, int):
             arg = str(arg)
 
@@ -91,6 +75,21 @@ class IDset(WrapperPimpl):
                 "IDset() expected an idset string or iterable, got " + type(arg)
             )
 
+    @staticmethod
+    def _create_from_ids(ids):
+        """Return a new idset handle containing ``ids``, set in one call"""
+        try:
+            array = ffi.new("unsigned int[]", list(ids))
+        except (TypeError, OverflowError):
+            raise ValueError(f"IDset(): Invalid argument: {ids}")
+        handle = lib.idset_create(0, lib.IDSET_FLAG_AUTOGROW)
+        if handle == ffi.NULL:
+            raise MemoryError("IDset(): out of memory")
+        if lib.idset_set_array(handle, array, len(array)) < 0:
+            lib.idset_destroy(handle)
+            raise ValueError(f"IDset(): Invalid argument: {ids}")
+        return handle
+
     def __str__(self):
         return self.encode()
 
@@ -103,7 +102,7 @@ class IDset(WrapperPimpl):
         return self.pimpl.count()
 
     def __iter__(self):
-        return IDsetIterator(self)
+        return iter(self.expand())
 
     def __contains__(self, i):
         return self.test(i)
@@ -218,7 +217,10 @@ class IDset(WrapperPimpl):
 
     def expand(self):
         """Expand an IDset into a list of integers"""
-        return list(self)
+        count = self.count()
+        array = ffi.new("unsigned int[]", count)
+        count = lib.idset_to_array(self.handle, array, count)
+        return ffi.unpack(array, count)
 
     def count(self):
         """Return the number of integers in an IDset"""
@@ -243,6 +245,20 @@ class IDset(WrapperPimpl):
         lib.free(val)
         return result.decode("utf-8")
 
+    def test_many(self, ids):
+        """Test membership of many ids at once
+        :param: ids: iterable of integers
+        :returns: a list of bool, one for each id
+        """
+        ids = list(ids)
+        try:
+            array = ffi.new("unsigned int[]", ids)
+        except (TypeError, OverflowError):
+            raise ValueError("IDset.test_many: ids must be non-negative integers")
+        result = ffi.new("bool[]", len(ids))
+        lib.idset_test_array(self.handle, array, result, len(ids))
+        return ffi.unpack(result, len(ids))
+
     def first(self):
         """Return the first id set in an IDset"""
         return self.pimpl.first()
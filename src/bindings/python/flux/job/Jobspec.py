@@ -1028,3 +1028,72 @@ class JobspecV1(Jobspec):
         if conf is not None:
             jobspec.add_file("conf.json", conf)
         return jobspec
+
+
+class JobspecTemplate:
+    """Encode many variants of a jobspec efficiently
+
+    Encoding a jobspec with :meth:`Jobspec.dumps` serializes the entire
+    jobspec each time.  A JobspecTemplate encodes each top level section
+    of ``jobspec`` once, and :meth:`encode` re-encodes only the sections
+    touched by a patch, so generating many similar jobspecs (e.g. for
+    :func:`flux.job.submit_batch_async`) costs little more than encoding
+    the fields that change.
+
+    :param jobspec: the base jobspec, which is copied
+    :type jobspec: Jobspec or its string encoding
+    """
+
+    def __init__(self, jobspec):
+        if not isinstance(jobspec, Jobspec):
+            jobspec = Jobspec(**json.loads(_convert_jobspec_arg_to_string(jobspec)))
+        self.jobspec = json.loads(jobspec.dumps())
+        self._sections = {
+            key: json.dumps(value, ensure_ascii=False)
+            for key, value in self.jobspec.items()
+        }
+
+    @staticmethod
+    def _patch(section, path, value):
+        obj = section
+        for key in path[:-1]:
+            if isinstance(obj, list):
+                obj = obj[int(key)]
+            else:
+                obj = obj.setdefault(key, {})
+        if isinstance(obj, list):
+            obj[int(path[-1])] = value
+        else:
+            obj[path[-1]] = value
+
+    def encode(self, patch=None):
+        """Return the jobspec string encoding with ``patch`` applied
+
+        :param patch: mapping of period-delimited keys to new values,
+            e.g. ``{"tasks.0.command": ["hostname"]}``.  Integer
+            components index into lists, and missing dictionary keys
+            are created.  The template itself is not modified.
+        :type patch: dict
+        :rtype: str
+        """
+        if not patch:
+            sections = self._sections
+        else:
+            sections = dict(self._sections)
+            touched = {}
+            for key, value in patch.items():
+                path = key.split(".")
+                top = path[0]
+                if top not in touched:
+                    touched[top] = json.loads(sections.get(top, "{}"))
+                if len(path) == 1:
+                    touched[top] = value
+                else:
+                    self._patch(touched[top], path[1:], value)
+            for top, section in touched.items():
+                sections[top] = json.dumps(section, ensure_ascii=False)
+        return (
+            "{"
+            + ",".join(f"{json.dumps(key)}:{val}" for key, val in sections.items())
+            + "}"
+        )
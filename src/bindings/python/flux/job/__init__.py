@@ -8,11 +8,17 @@
 # SPDX-License-Identifier: LGPL-3.0
 ###############################################################
 
-from flux.job.Jobspec import Jobspec, JobspecV1, validate_jobspec
+from flux.job.Jobspec import Jobspec, JobspecV1, JobspecTemplate, validate_jobspec
 from flux.job.JobID import id_parse, id_encode, JobID
 from flux.job.kvs import job_kvs, job_kvs_guest
 from flux.job.kill import kill_async, kill, cancel_async, cancel
-from flux.job.submit import submit_async, submit, submit_get_id
+from flux.job.submit import (
+    submit_async,
+    submit,
+    submit_get_id,
+    submit_batch_async,
+    submit_batch,
+)
 from flux.job.info import JobInfo, JobInfoFormat, job_fields_to_attrs
 from flux.job.list import job_list, job_list_inactive, job_list_id, JobList, get_job
 from flux.job.kvslookup import job_info_lookup, JobKVSLookup, job_kvs_lookup
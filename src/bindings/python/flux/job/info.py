@@ -342,52 +342,55 @@ class JobInfo:
     )
 
     def __init__(self, info_resp):
-        #  Set defaults, then update with job-list.list response items:
-        combined_dict = self.defaults.copy()
-        combined_dict.update(info_resp)
-
-        #  Cast jobid to JobID
-        combined_dict["id"] = JobID(combined_dict["id"])
-
-        #  Rename "state" to "state_id" and "result" to "result_id"
+        #  Keep the job-list.list response as is.  Other values are
+        #  converted from it on first access by __getattr__(), so listing
+        #  many jobs only pays for the fields that are actually used.
+        self._info = info_resp
+        self._id = JobID(info_resp["id"])
+
+    def _decode(self, attr):
+        info = self._info
+        #  "state" and "result" are returned as "state_id" and "result_id"
         #  until returned state is a string:
-        if "state" in combined_dict:
-            combined_dict["state_id"] = combined_dict.pop("state")
-
-        if "result" in combined_dict:
-            combined_dict["result_id"] = combined_dict.pop("result")
-
-        # Overwrite "exception" with our exception object
-        exc1 = combined_dict.get("exception_occurred", "")
-        exc2 = combined_dict.get("exception_severity", "")
-        exc3 = combined_dict.get("exception_type", "")
-        exc4 = combined_dict.get("exception_note", "")
-        combined_dict["exception"] = ExceptionInfo(exc1, exc2, exc3, exc4)
-
-        aDict = combined_dict.get("annotations", {})
-        combined_dict["annotations"] = AnnotationsInfo(aDict)
-        combined_dict["sched"] = combined_dict["annotations"].sched
-        combined_dict["user"] = combined_dict["annotations"].user
-
-        deps = combined_dict.get("dependencies", [])
-        combined_dict["dependencies"] = DependencyList(deps)
-
-        #  Set all keys as self._{key} to be found by getattr and
-        #   memoized_property decorator:
-        for key, value in combined_dict.items():
-            setattr(self, "_{0}".format(key), value)
+        if attr == "state_id":
+            return info["state"]
+        if attr == "result_id":
+            return info["result"]
+        if attr == "exception":
+            return ExceptionInfo(
+                info.get("exception_occurred", ""),
+                info.get("exception_severity", ""),
+                info.get("exception_type", ""),
+                info.get("exception_note", ""),
+            )
+        if attr == "annotations":
+            return AnnotationsInfo(info.get("annotations", {}))
+        if attr in ("sched", "user"):
+            return getattr(self.annotations, attr)
+        if attr == "dependencies":
+            return DependencyList(info.get("dependencies", []))
+        if attr in info:
+            return info[attr]
+        return self.defaults[attr]
 
     #  getattr method to return all non-computed values in job-list.list
     #   response by default. Avoids the need to wrap @property methods
-    #   that just return self._<attr>.
+    #   that just return self._<attr>.  Values are stored as self._<attr>
+    #   to be found by the memoized_property decorator.
     #
     def __getattr__(self, attr):
         if attr.startswith("_"):
             raise AttributeError
         try:
-            return getattr(self, "_{0}".format(attr))
-        except (KeyError, AttributeError):
+            return self.__dict__["_" + attr]
+        except KeyError:
+            pass
+        try:
+            value = self._decode(attr)
+        except KeyError:
             raise AttributeError("invalid JobInfo attribute '{}'".format(attr))
+        setattr(self, "_" + attr, value)
+        return value
 
     def get_instance_info(self):
         if self.uri and self.state_single == "R":  # pylint: disable=W0143
@@ -23,6 +23,12 @@ class JobListRPC(RPC):
         """Returns all jobs in the RPC."""
         return self.get()["jobs"]
 
+    def get_cursor(self):
+        """Returns a cursor for the next page of jobs, or None if the
+        listing is complete.
+        """
+        return self.get().get("cursor")
+
     def get_jobinfos(self):
         """Yields a JobInfo object for each job in its current state.
 
@@ -50,6 +56,7 @@ def job_list(
     since=0.0,
     name=None,
     queue=None,
+    cursor=None,
 ):
     # N.B. an "and" operation with no values returns everything
     constraint = {"and": []}
@@ -74,6 +81,8 @@ def job_list(
         "since": since,
         "constraint": constraint,
     }
+    if cursor:
+        payload["cursor"] = cursor
     return JobListRPC(flux_handle, "job-list.list", payload)
 
 
@@ -202,6 +211,11 @@ class JobList:
     :since: Limit jobs to those that have been active since a given timestamp.
     :name: Limit jobs to those with a specific name.
     :queue: Limit jobs to those submitted to a specific queue.
+    :cursor: Resume a listing after the last job of a previous page, as
+             returned in ``next_cursor``.
+
+    After ``jobs()``, ``next_cursor`` is set to a cursor for the next page
+    of jobs if ``max_entries`` jobs were returned, or None otherwise.
     """
 
     # pylint: disable=too-many-instance-attributes
@@ -235,6 +249,7 @@ class JobList:
         since=0.0,
         name=None,
         queue=None,
+        cursor=None,
     ):
         self.handle = flux_handle
         self.attrs = list(attrs)
@@ -245,6 +260,8 @@ class JobList:
         self.name = name
         self.queue = queue
         self.ids = list(map(JobID, ids)) if ids else None
+        self.cursor = cursor
+        self.next_cursor = None
         self.errors = []
         for fname in filters:
             for x in fname.split(","):
@@ -301,6 +318,7 @@ class JobList:
             since=self.since,
             name=self.name,
             queue=self.queue,
+            cursor=self.cursor,
         )
 
     def jobs(self):
@@ -315,4 +333,6 @@ class JobList:
         jobs = rpc.get_jobs()
         if hasattr(rpc, "errors"):
             self.errors = rpc.errors
+        if hasattr(rpc, "get_cursor"):
+            self.next_cursor = rpc.get_cursor()
         return [JobInfo(job) for job in jobs]
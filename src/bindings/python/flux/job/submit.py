@@ -135,3 +135,68 @@ def submit(
     """
     future = submit_async(flux_handle, jobspec, urgency, waitable, debug, pre_signed)
     return future.get_id()
+
+
+def submit_batch_async(
+    flux_handle,
+    jobspecs,
+    urgency=lib.FLUX_JOB_URGENCY_DEFAULT,
+    waitable=False,
+    debug=False,
+    pre_signed=False,
+    novalidate=False,
+):
+    """Ask Flux to run many jobs, without waiting for any response
+
+    Send a submit request for each jobspec in ``jobspecs`` without waiting
+    for earlier requests to complete.  The job-ingest module combines
+    requests that arrive together into one batch, so pipelining requests
+    this way is much faster than calling :func:`submit` for each job.
+    Jobspecs are signed in C as for :func:`submit_async`.
+
+    Arguments other than ``jobspecs`` apply to every job and are as
+    described in :func:`submit_async`.
+
+    :param jobspecs: jobspecs, for example strings generated with
+        :meth:`flux.job.JobspecTemplate.encode`
+    :type jobspecs: iterable of Jobspec or string encodings
+    :returns: a list of futures in the same order as ``jobspecs``
+    :rtype: list of SubmitFuture
+    """
+    return [
+        submit_async(
+            flux_handle,
+            jobspec,
+            urgency=urgency,
+            waitable=waitable,
+            debug=debug,
+            pre_signed=pre_signed,
+            novalidate=novalidate,
+        )
+        for jobspec in jobspecs
+    ]
+
+
+def submit_batch(flux_handle, jobspecs, **kwargs):
+    """Submit many jobs to Flux
+
+    Like :func:`submit_batch_async`, but block until all responses have
+    been received.  A job that could not be submitted is represented by
+    the exception raised for it, so one failure does not hide the IDs of
+    jobs that were submitted.
+
+    :param flux_handle: handle for Flux broker from flux.Flux()
+    :type flux_handle: Flux
+    :param jobspecs: jobspecs to submit
+    :type jobspecs: iterable of Jobspec or string encodings
+    :param kwargs: other arguments to :func:`submit_batch_async`
+    :returns: job IDs or exceptions, in the same order as ``jobspecs``
+    :rtype: list
+    """
+    result = []
+    for future in submit_batch_async(flux_handle, jobspecs, **kwargs):
+        try:
+            result.append(future.get_id())
+        except OSError as exc:
+            result.append(exc)
+    return result
@@ -10,6 +10,7 @@
 
 import argparse
 import base64
+import concurrent.futures
 import copy
 import errno
 import glob
@@ -1047,6 +1048,51 @@ class Tree:
         )
 
 
+def tree_map(func, roots, get_children, max_workers=None, max_depth=None):
+    """Call func(node) concurrently for every node of a tree
+
+    Nodes are visited one level at a time with a single pool of at most
+    ``max_workers`` threads, so a tree is traversed in a number of rounds
+    proportional to its depth rather than its number of nodes. This suits
+    queries that open a handle to each nested instance in a hierarchy.
+
+    Args:
+        func: function called with each node, returning its result
+        roots: iterable of nodes at depth 0
+        get_children: function called with a node and its result,
+            returning an iterable of the node's children
+        max_workers: maximum number of threads (default chosen by
+            :py:class:`concurrent.futures.ThreadPoolExecutor`)
+        max_depth: if not None, do not visit nodes deeper than this
+
+    Returns:
+        A list with a ``(node, result, children)`` tuple for each root,
+        in order, where ``children`` is a list of the same form.
+    """
+    top = [[node, None, []] for node in roots]
+    level = top
+    depth = 0
+    with concurrent.futures.ThreadPoolExecutor(max_workers) as executor:
+        while level:
+            results = executor.map(func, [entry[0] for entry in level])
+            nextlevel = []
+            for entry, result in zip(level, results):
+                entry[1] = result
+                if max_depth is None or depth < max_depth:
+                    entry[2] = [
+                        [child, None, []]
+                        for child in get_children(entry[0], result)
+                    ]
+                    nextlevel.extend(entry[2])
+            level = nextlevel
+            depth += 1
+
+    def freeze(entries):
+        return [(node, result, freeze(children)) for node, result, children in entries]
+
+    return freeze(top)
+
+
 #  Slightly modified from https://stackoverflow.com/a/7205107
 def dict_merge(src, new):
     "merges dict new into dict src"
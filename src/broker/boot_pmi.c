@@ -203,6 +203,104 @@ static void trace_upmi (void *arg, const char *text)
     fprintf (stderr, "boot_pmi: %s\n", text);
 }
 
+/* Fetch the hostname from the business card of 'rank'.
+ * The caller must free the result.
+ */
+static char *get_peer_hostname (struct upmi *upmi, int rank)
+{
+    flux_error_t error;
+    char key[64];
+    char *val;
+    const char *peer_hostname;
+    char *s = NULL;
+    json_t *o;
+
+    if (snprintf (key, sizeof (key), "%d", rank) >= sizeof (key)) {
+        log_msg ("pmi key string overflow");
+        return NULL;
+    }
+    if (upmi_get (upmi, key, rank, &val, &error) < 0) {
+        log_msg ("%s: get %s: %s", upmi_describe (upmi), key, error.text);
+        return NULL;
+    }
+    if (!(o = json_loads (val, 0, NULL))
+        || json_unpack (o, "{s:s}", "hostname", &peer_hostname) < 0)
+        log_msg ("error decoding rank %d pmi business card", rank);
+    else if (!(s = strdup (peer_hostname)))
+        log_err ("strdup");
+    json_decref (o);
+    free (val);
+    return s;
+}
+
+/* Build hostlist of all ranks.  Ranks that broker.mapping places on the
+ * same node share a hostname, so only one business card is fetched per
+ * node, and none for this broker's node.  A single node instance, such
+ * as one started by 'flux start --test-size=N', thus needs no fetches
+ * instead of N per rank.  Without a mapping, every card is fetched.
+ */
+static int build_hostlist (struct upmi *upmi,
+                           attr_t *attrs,
+                           struct upmi_info *info,
+                           const char *hostname,
+                           struct hostlist *hl)
+{
+    const char *val;
+    struct taskmap *map = NULL;
+    char **names = NULL;
+    int nnodes = 0;
+    int rc = -1;
+    int i;
+
+    if (attr_get (attrs, "broker.mapping", &val, NULL) == 0
+        && val
+        && (map = taskmap_decode (val, NULL))
+        && taskmap_total_ntasks (map) == info->size
+        && (nnodes = taskmap_nnodes (map)) > 0) {
+        int nodeid = taskmap_nodeid (map, info->rank);
+
+        if (!(names = calloc (nnodes, sizeof (names[0])))
+            || (nodeid >= 0 && !(names[nodeid] = strdup (hostname)))) {
+            log_err ("out of memory");
+            goto done;
+        }
+    }
+    for (i = 0; i < info->size; i++) {
+        int nodeid = names ? taskmap_nodeid (map, i) : -1;
+        const char *name;
+        char *peer = NULL;
+
+        if (nodeid >= 0 && nodeid < nnodes && names[nodeid])
+            name = names[nodeid];
+        else if (i == info->rank)
+            name = hostname;
+        else {
+            if (!(peer = get_peer_hostname (upmi, i)))
+                goto done;
+            name = peer;
+            if (nodeid >= 0 && nodeid < nnodes) {
+                names[nodeid] = peer;
+                peer = NULL;
+            }
+        }
+        if (hostlist_append (hl, name) < 0) {
+            log_err ("hostlist_append");
+            free (peer);
+            goto done;
+        }
+        free (peer);
+    }
+    rc = 0;
+done:
+    if (names) {
+        for (i = 0; i < nnodes; i++)
+            free (names[i]);
+        free (names);
+    }
+    taskmap_destroy (map);
+    return rc;
+}
+
 int boot_pmi (struct overlay *overlay, attr_t *attrs)
 {
     const char *topo_uri;
@@ -409,35 +507,12 @@ int boot_pmi (struct overlay *overlay, attr_t *attrs)
         free (val);
     }
 
-    /* Fetch the business card of all ranks and build hostlist.
-     * The hostlist is built independently (and in parallel) on all ranks.
+    /* Build the hostlist independently (and in parallel) on all ranks,
+     * unless it was set on the command line.
      */
-    for (i = 0; i < info.size; i++) {
-        const char *peer_hostname;
-
-        if (snprintf (key, sizeof (key), "%d", i) >= sizeof (key)) {
-            log_msg ("pmi key string overflow");
-            goto error;
-        }
-        if (upmi_get (upmi, key, i, &val, &error) < 0) {
-            log_msg ("%s: get %s: %s", upmi_describe (upmi), key, error.text);
+    if (attr_get (attrs, "hostlist", NULL, NULL) < 0) {
+        if (build_hostlist (upmi, attrs, &info, hostname, hl) < 0)
             goto error;
-        }
-        if (!(o = json_loads (val, 0, NULL))
-            || json_unpack (o, "{s:s}", "hostname", &peer_hostname) < 0) {
-            log_msg ("error decoding rank %d pmi business card", i);
-            json_decref (o);
-            free (val);
-            goto error;
-        }
-        if (hostlist_append (hl, peer_hostname) < 0) {
-            log_err ("hostlist_append");
-            json_decref (o);
-            free (val);
-            goto error;
-        }
-        json_decref (o);
-        free (val);
     }
 
     /* One more barrier before allowing connects to commence.
@@ -69,6 +69,7 @@
 #include "modhash.h"
 #include "brokercfg.h"
 #include "groups.h"
+#include "treereduce.h"
 #include "overlay.h"
 #include "service.h"
 #include "attr.h"
@@ -124,6 +125,8 @@ static int check_statedir (attr_t *attrs);
 static int create_runat_phases (broker_ctx_t *ctx);
 
 static int handle_event (broker_ctx_t *ctx, const flux_msg_t *msg);
+static int event_subscribe_cb (const char *topic, void *arg);
+static int event_unsubscribe_cb (const char *topic, void *arg);
 
 static void init_attrs (attr_t *attrs, pid_t pid, struct flux_msg_cred *cred);
 
@@ -236,6 +239,7 @@ int main (int argc, char *argv[])
 
     if (!(ctx.sigwatchers = zlist_new ())
         || !(ctx.modhash = modhash_create ())
+        || !(ctx.lazy_modules = zhash_new ())
         || !(ctx.services = service_switch_create ())
         || !(ctx.attrs = attr_create ())
         || !(ctx.sub = subhash_create ()))
@@ -340,6 +344,8 @@ int main (int argc, char *argv[])
         log_err ("overlay_create");
         goto cleanup;
     }
+    subhash_set_subscribe (ctx.sub, event_subscribe_cb, &ctx);
+    subhash_set_unsubscribe (ctx.sub, event_unsubscribe_cb, &ctx);
 
     /* Arrange for the publisher to route event messages.
      */
@@ -432,6 +438,10 @@ int main (int argc, char *argv[])
         log_err ("groups_create");
         goto cleanup;
     }
+    if (!(ctx.treereduce = treereduce_create (&ctx))) {
+        log_err ("treereduce_create");
+        goto cleanup;
+    }
 
     if (ctx.verbose) {
         const char *parent = overlay_get_parent_uri (ctx.overlay);
@@ -470,7 +480,7 @@ int main (int argc, char *argv[])
         log_err ("heaptrace_initialize");
         goto cleanup;
     }
-    if (exec_initialize (ctx.h, ctx.rank, ctx.attrs) < 0) {
+    if (exec_initialize (ctx.h, ctx.overlay, ctx.rank, ctx.attrs) < 0) {
         log_err ("exec_initialize");
         goto cleanup;
     }
@@ -553,10 +563,13 @@ cleanup:
         if (ctx.exit_rc == 0)
             ctx.exit_rc = 1;
     }
+    zhash_destroy (&ctx.lazy_modules);
     zlist_destroy (&ctx.sigwatchers);
     shutdown_destroy (ctx.shutdown);
     state_machine_destroy (ctx.state_machine);
     overlay_destroy (ctx.overlay);
+    ctx.overlay = NULL;
+    treereduce_destroy (ctx.treereduce);
     groups_destroy (ctx.groups);
     service_switch_destroy (ctx.services);
     broker_remove_services (handlers);
@@ -660,6 +673,12 @@ static void init_attrs (attr_t *attrs, pid_t pid, struct flux_msg_cred *cred)
     if (attr_add (attrs, "version", FLUX_CORE_VERSION_STRING, 0) < 0)
         log_err_exit ("attr_add version");
 
+    if (attr_add (attrs,
+                  "broker.payload-encodings",
+                  "json,cbor",
+                  ATTR_IMMUTABLE) < 0)
+        log_err_exit ("attr_add broker.payload-encodings");
+
     char tmp[32];
     snprintf (tmp, sizeof (tmp), "%ju", (uintmax_t)cred->userid);
     if (attr_add (attrs, "security.owner", tmp, ATTR_IMMUTABLE) < 0)
@@ -1221,6 +1240,38 @@ static int mod_svc_cb (flux_msg_t **msg, void *arg)
     return module_sendmsg_new (p, msg);
 }
 
+/* Apply the cpu-affinity setting from the [modules.<name>] table, or if
+ * unset, from the [modules] table, to module 'p'.  The default keeps
+ * modules on the NUMA node of the broker thread, close to the message
+ * queues they share with it.
+ */
+static int set_module_affinity (broker_ctx_t *ctx,
+                                module_t *p,
+                                flux_error_t *error)
+{
+    const flux_conf_t *conf = flux_get_conf (ctx->h);
+    const char *name = module_get_name (p);
+    const char *spec = "broker";
+    flux_error_t e;
+
+    if (flux_conf_unpack (conf,
+                          &e,
+                          "{s?{s?s}}",
+                          "modules",
+                            "cpu-affinity", &spec) < 0
+        || flux_conf_unpack (conf,
+                             &e,
+                             "{s?{s?{s?s}}}",
+                             "modules",
+                               name,
+                                 "cpu-affinity", &spec) < 0) {
+        errprintf (error, "error parsing [modules] config: %s", e.text);
+        errno = EINVAL;
+        return -1;
+    }
+    return module_set_cpu_affinity (p, spec, error);
+}
+
 /* Load broker module.
  * 'name' is the name to use for the module (NULL = use dso basename minus ext)
  * 'path' is either a dso path or a dso basename (e.g. "kvs" or "/a/b/kvs.so".
@@ -1268,6 +1319,10 @@ static int load_module (broker_ctx_t *ctx,
                              args,
                              error)))
         goto error;
+    if (set_module_affinity (ctx, p, error) < 0) {
+        module_destroy (p);
+        goto error;
+    }
     modhash_add (ctx->modhash, p);
     if (service_add (ctx->services,
                      module_get_name (p),
@@ -1279,6 +1334,7 @@ static int load_module (broker_ctx_t *ctx,
     }
     module_set_poller_cb (p, module_cb, ctx);
     module_set_status_cb (p, module_status_cb, ctx);
+    module_set_subscribe_cb (p, event_subscribe_cb, event_unsubscribe_cb, ctx);
     if (request && module_push_insmod (p, request) < 0) { // response deferred
         errprintf (error, "error saving %s request", module_get_name (p));
         goto service_remove;
@@ -1301,12 +1357,131 @@ error:
     return -1;
 }
 
+/* A lazy module is registered as a stub service.  The first request to
+ * the service loads the module, then is delivered to it like any other
+ * request.  Messages sent to a module before its thread is running are
+ * queued by module_sendmsg_new(), so nothing more is needed to hold
+ * requests while the module initializes.  Only modules that are purely
+ * request driven should be loaded this way, since a module that is not
+ * yet loaded is not subscribed to any events.
+ */
+struct lazy_module {
+    broker_ctx_t *ctx;
+    char *name;
+    char *path;
+    json_t *args;
+};
+
+static void lazy_module_destroy (struct lazy_module *lm)
+{
+    if (lm) {
+        int saved_errno = errno;
+        free (lm->name);
+        free (lm->path);
+        json_decref (lm->args);
+        free (lm);
+        errno = saved_errno;
+    }
+}
+
+static int lazy_svc_cb (flux_msg_t **msg, void *arg)
+{
+    struct lazy_module *lm = arg;
+    broker_ctx_t *ctx = lm->ctx;
+    flux_error_t error;
+    int rc;
+
+    /* Remove the stub so load_module() can register the real service.
+     * The stub is owned by ctx->lazy_modules, so it survives this.
+     */
+    service_remove (ctx->services, lm->name);
+    zhash_freefn (ctx->lazy_modules, lm->name, NULL);
+    zhash_delete (ctx->lazy_modules, lm->name);
+
+    flux_log (ctx->h, LOG_DEBUG, "loading %s on first use", lm->name);
+    if (load_module (ctx, lm->name, lm->path, lm->args, NULL, &error) < 0) {
+        flux_log (ctx->h,
+                  LOG_ERR,
+                  "error loading %s on first use: %s",
+                  lm->name,
+                  error.text);
+        errno = ENOSYS;
+        rc = -1;
+    }
+    else
+        rc = service_send_new (ctx->services, msg);
+    lazy_module_destroy (lm);
+    return rc;
+}
+
+/* Find a lazy module by name or path, like modhash_lookup_byname().
+ */
+static struct lazy_module *lazy_module_lookup (broker_ctx_t *ctx,
+                                               const char *name)
+{
+    struct lazy_module *lm;
+
+    if ((lm = zhash_lookup (ctx->lazy_modules, name)))
+        return lm;
+    lm = zhash_first (ctx->lazy_modules);
+    while (lm) {
+        if (streq (lm->path, name))
+            return lm;
+        lm = zhash_next (ctx->lazy_modules);
+    }
+    return NULL;
+}
+
+/* Register 'name' (NULL = dso basename minus ext) to be loaded from
+ * 'path' when its service is first used.
+ */
+static int load_module_lazy (broker_ctx_t *ctx,
+                             const char *name,
+                             const char *path,
+                             json_t *args)
+{
+    struct lazy_module *lm;
+
+    if (!(lm = calloc (1, sizeof (*lm))))
+        return -1;
+    lm->ctx = ctx;
+    lm->args = json_incref (args);
+    if (!(lm->path = strdup (path))
+        || !(lm->name = name ? strdup (name) : module_name_from_path (path)))
+        goto error;
+    if (modhash_lookup_byname (ctx->modhash, lm->name)
+        || zhash_lookup (ctx->lazy_modules, lm->name)) {
+        errno = EEXIST;
+        goto error;
+    }
+    if (service_add (ctx->services, lm->name, NULL, lazy_svc_cb, lm) < 0)
+        goto error;
+    zhash_update (ctx->lazy_modules, lm->name, lm);
+    zhash_freefn (ctx->lazy_modules,
+                  lm->name,
+                  (zhash_free_fn *)lazy_module_destroy);
+    flux_log (ctx->h, LOG_DEBUG, "insmod %s (lazy)", lm->name);
+    return 0;
+error:
+    lazy_module_destroy (lm);
+    return -1;
+}
+
 static int unload_module (broker_ctx_t *ctx,
                           const char *name,
                           const flux_msg_t *request)
 {
+    struct lazy_module *lm;
     module_t *p;
 
+    if ((lm = lazy_module_lookup (ctx, name))) {
+        flux_log (ctx->h, LOG_DEBUG, "rmmod %s (lazy)", lm->name);
+        service_remove (ctx->services, lm->name);
+        zhash_delete (ctx->lazy_modules, lm->name);
+        if (flux_respond (ctx->h, request, NULL) < 0)
+            flux_log_error (ctx->h, "error responding to rmmod request");
+        return 0;
+    }
     if (!(p = modhash_lookup_byname (ctx->modhash, name))) {
         errno = ENOENT;
         return -1;
@@ -1391,16 +1566,25 @@ static void broker_insmod_cb (flux_t *h,
     const char *name = NULL;
     const char *path;
     json_t *args;
+    int lazy = 0;
     flux_error_t error;
     const char *errmsg = NULL;
 
     if (flux_request_unpack (msg,
                              NULL,
-                             "{s?s s:s s:o}",
+                             "{s?s s:s s:o s?b}",
                              "name", &name,
                              "path", &path,
-                             "args", &args) < 0)
+                             "args", &args,
+                             "lazy", &lazy) < 0)
         goto error;
+    if (lazy) {
+        if (load_module_lazy (ctx, name, path, args) < 0)
+            goto error;
+        if (flux_respond (h, msg, NULL) < 0)
+            flux_log_error (h, "%s: flux_respond", __FUNCTION__);
+        return;
+    }
     if (load_module (ctx, name, path, args, msg, &error) < 0) {
         errmsg = error.text;
         goto error;
@@ -1411,6 +1595,33 @@ error:
         flux_log_error (h, "%s: flux_respond_error", __FUNCTION__);
 }
 
+/* Append lsmod entries for lazy modules that have not been loaded yet.
+ */
+static int lazy_module_list_append (broker_ctx_t *ctx, json_t *mods)
+{
+    struct lazy_module *lm;
+
+    lm = zhash_first (ctx->lazy_modules);
+    while (lm) {
+        json_t *entry;
+
+        if (!(entry = json_pack ("{s:s s:s s:i s:i s:[s] s:b}",
+                                 "name", lm->name,
+                                 "path", lm->path,
+                                 "idle", 0,
+                                 "status", FLUX_MODSTATE_INIT,
+                                 "services", lm->name,
+                                 "lazy", 1))
+            || json_array_append_new (mods, entry) < 0) {
+            json_decref (entry);
+            errno = ENOMEM;
+            return -1;
+        }
+        lm = zhash_next (ctx->lazy_modules);
+    }
+    return 0;
+}
+
 /* List loaded modules
  */
 static void broker_lsmod_cb (flux_t *h,
@@ -1424,7 +1635,8 @@ static void broker_lsmod_cb (flux_t *h,
 
     if (flux_request_decode (msg, NULL, NULL) < 0)
         goto error;
-    if (!(mods = modhash_get_modlist (ctx->modhash, now, ctx->services)))
+    if (!(mods = modhash_get_modlist (ctx->modhash, now, ctx->services))
+        || lazy_module_list_append (ctx, mods) < 0)
         goto error;
     if (flux_respond_pack (h, msg, "{s:O}", "mods", mods) < 0)
         flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
@@ -1435,6 +1647,34 @@ error:
         flux_log_error (h, "%s: flux_respond_error", __FUNCTION__);
 }
 
+/* Get sampled resource usage of a module
+ */
+static void broker_module_history_cb (flux_t *h,
+                                      flux_msg_handler_t *mh,
+                                      const flux_msg_t *msg,
+                                      void *arg)
+{
+    broker_ctx_t *ctx = arg;
+    const char *name;
+    module_t *p;
+    json_t *o;
+
+    if (flux_request_unpack (msg, NULL, "{s:s}", "name", &name) < 0)
+        goto error;
+    if (!(p = modhash_lookup_byname (ctx->modhash, name))) {
+        errno = ENOENT;
+        goto error;
+    }
+    if (!(o = module_get_history (p)))
+        goto error;
+    if (flux_respond_pack (h, msg, "o", o) < 0)
+        flux_log_error (h, "error responding to module-history request");
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        flux_log_error (h, "error responding to module-history request");
+}
+
 static void broker_module_debug_cb (flux_t *h,
                                     flux_msg_handler_t *mh,
                                     const flux_msg_t *msg,
@@ -1647,6 +1887,12 @@ static const struct flux_msg_handler_spec htab[] = {
         method_ping_cb,
         FLUX_ROLE_USER
     },
+    {
+        FLUX_MSGTYPE_REQUEST,
+        "broker.stats-get",
+        method_stats_get_cb,
+        FLUX_ROLE_USER
+    },
     {
         FLUX_MSGTYPE_REQUEST,
         "broker.rmmod",
@@ -1671,6 +1917,12 @@ static const struct flux_msg_handler_spec htab[] = {
         broker_module_debug_cb,
         0,
     },
+    {
+        FLUX_MSGTYPE_REQUEST,
+        "broker.module-history",
+        broker_module_history_cb,
+        FLUX_ROLE_USER,
+    },
     {
         FLUX_MSGTYPE_REQUEST,
         "broker.module-status",
@@ -1715,6 +1967,7 @@ static struct internal_service services[] = {
     { "runat",              NULL },
     { "state-machine",      NULL },
     { "groups",             NULL },
+    { "treereduce",         NULL },
     { "shutdown",           NULL },
     { "rexec",              NULL },
     { NULL, NULL, },
@@ -1813,6 +2066,26 @@ drop:
     return -1;
 }
 
+/* Subscriptions of broker-resident services and modules are registered
+ * with the overlay so they can be passed upstream for event filtering.
+ * N.B. subscriptions may be dropped after the overlay is destroyed.
+ */
+static int event_subscribe_cb (const char *topic, void *arg)
+{
+    broker_ctx_t *ctx = arg;
+    if (!ctx->overlay)
+        return 0;
+    return overlay_event_subscribe (ctx->overlay, topic);
+}
+
+static int event_unsubscribe_cb (const char *topic, void *arg)
+{
+    broker_ctx_t *ctx = arg;
+    if (!ctx->overlay)
+        return 0;
+    return overlay_event_unsubscribe (ctx->overlay, topic);
+}
+
 /* Distribute events downstream, and to module and broker-resident subscribers.
  * On rank 0, publisher is wired to send events here also.
  */
@@ -1830,7 +2103,9 @@ static int handle_event (broker_ctx_t *ctx, const flux_msg_t *msg)
         //flux_log (ctx->h, LOG_DEBUG, "dropping duplicate event %d", seq);
         return -1;
     }
-    if (ctx->event_recv_seq > 0) { /* don't log initial missed events */
+    /* Don't log initial missed events, or gaps due to event filtering.
+     */
+    if (ctx->event_recv_seq > 0 && !overlay_event_filtered (ctx->overlay)) {
         int first = ctx->event_recv_seq + 1;
         int count = seq - first;
         if (count > 1)
@@ -35,6 +35,7 @@ struct broker {
     struct flux_msg_cred cred;  /* instance owner */
 
     struct modhash *modhash;
+    zhash_t *lazy_modules;      /* stubs for modules loaded on first use */
 
     int verbose;
     int event_recv_seq;
@@ -46,6 +47,7 @@ struct broker {
     struct content_cache *cache;
     struct publisher *publisher;
     struct groups *groups;
+    struct treereduce *treereduce;
 
     struct runat *runat;
     struct state_machine *state_machine;
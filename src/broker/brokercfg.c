@@ -9,6 +9,15 @@
 \************************************************************/
 
 /* brokercfg.c - broker configuration
+ *
+ * Each broker parses the TOML config files in config.path at startup,
+ * since bootstrap settings are needed before the TBON is up.  Afterwards,
+ * 'flux config reload --all' can parse the files on one broker and
+ * distribute the parsed object to its TBON subtree with treereduce.run,
+ * calling config.apply on each rank, so the files are read once rather
+ * than by every broker.  Node-local overrides in config.override-path,
+ * if set, are merged over the config on each broker, whether it was
+ * parsed locally or distributed.
  */
 
 #if HAVE_CONFIG_H
@@ -20,6 +29,7 @@
 
 #include "src/common/libutil/log.h"
 #include "src/common/libutil/errprintf.h"
+#include "ccan/str/str.h"
 
 #include "attr.h"
 #include "modhash.h"
@@ -29,29 +39,93 @@
 struct brokercfg {
     flux_t *h;
     char *path;
+    char *override_path;
     flux_msg_handler_t **handlers;
     modhash_t *modhash;
     flux_future_t *reload_f;
+    flux_future_t *distribute_f;
 };
 
-static int brokercfg_set (flux_t *h,
+/* Merge table 'src' into 'dst'.  Tables present in both are merged
+ * recursively, other values in 'src' replace those in 'dst'.
+ */
+static int conf_merge (json_t *dst, json_t *src)
+{
+    const char *key;
+    json_t *val;
+
+    json_object_foreach (src, key, val) {
+        json_t *cur = json_object_get (dst, key);
+
+        if (json_is_object (cur) && json_is_object (val)) {
+            if (conf_merge (cur, val) < 0)
+                return -1;
+        }
+        else if (json_object_set (dst, key, val) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/* Return a new reference to 'conf', or if config.override-path is set,
+ * a copy of 'conf' with the overrides merged in.
+ */
+static flux_conf_t *brokercfg_override (struct brokercfg *cfg,
+                                        const flux_conf_t *conf,
+                                        flux_error_t *errp)
+{
+    flux_conf_t *override;
+    flux_conf_t *cpy;
+    flux_error_t error;
+    json_t *dst;
+    json_t *src;
+
+    if (!cfg->override_path)
+        return (flux_conf_t *)flux_conf_incref (conf);
+    if (!(override = flux_conf_parse (cfg->override_path, &error))) {
+        errprintf (errp, "Config override file error: %s", error.text);
+        return NULL;
+    }
+    /* N.B. the copy is not shared yet, so it is safe to modify the
+     * object returned by flux_conf_unpack().
+     */
+    if (!(cpy = flux_conf_copy (conf))
+        || flux_conf_unpack (cpy, NULL, "o", &dst) < 0
+        || flux_conf_unpack (override, NULL, "o", &src) < 0
+        || conf_merge (dst, src) < 0) {
+        errprintf (errp, "Error merging config overrides");
+        flux_conf_decref (cpy);
+        flux_conf_decref (override);
+        errno = ENOMEM;
+        return NULL;
+    }
+    flux_conf_decref (override);
+    return cpy;
+}
+
+/* Store 'conf', with any node-local overrides merged in, in cfg->h for
+ * later access by flux_get_conf().  The caller retains its reference.
+ */
+static int brokercfg_set (struct brokercfg *cfg,
                           const flux_conf_t *conf,
                           flux_error_t *error)
 {
-    if (flux_set_conf (h, conf) < 0) {
+    flux_conf_t *cpy;
+
+    if (!(cpy = brokercfg_override (cfg, conf, error)))
+        return -1;
+    if (flux_set_conf (cfg->h, cpy) < 0) {
         errprintf (error, "Error caching config object");
+        flux_conf_decref (cpy);
         return -1;
     }
     return 0;
 }
 
 /* Parse config object from TOML config files if path is set;
- * otherwise, create an empty config object.  Store the object
- * in ctx->h for later access by flux_get_conf().
+ * otherwise, create an empty config object.
  */
-static int brokercfg_parse (flux_t *h,
-                            const char *path,
-                            flux_error_t *errp)
+static flux_conf_t *brokercfg_parse (const char *path, flux_error_t *errp)
 {
     flux_error_t error;
     flux_conf_t *conf;
@@ -61,21 +135,30 @@ static int brokercfg_parse (flux_t *h,
             errprintf (errp,
                        "Config file error: %s",
                        error.text);
-            return -1;
+            return NULL;
         }
     }
     else {
         if (!(conf = flux_conf_create ())) {
             errprintf (errp, "Error creating config object");
-            return -1;
+            return NULL;
         }
     }
-    if (brokercfg_set (h, conf, errp) < 0)
-        goto error;
-    return 0;
-error:
+    return conf;
+}
+
+/* Parse config files and store the result in cfg->h.
+ */
+static int brokercfg_load (struct brokercfg *cfg, flux_error_t *error)
+{
+    flux_conf_t *conf;
+    int rc;
+
+    if (!(conf = brokercfg_parse (cfg->path, error)))
+        return -1;
+    rc = brokercfg_set (cfg, conf, error);
     flux_conf_decref (conf);
-    return -1;
+    return rc;
 }
 
 /* Now that all modules have responded to '<name>.config-reload' request,
@@ -113,7 +196,19 @@ static void reload_continuation (flux_future_t *cf, void *arg)
     if (errnum != 0)
         goto error;
 
-    if (flux_respond (cfg->h, msg, NULL) < 0)
+    /* config.apply responses identify the rank for treereduce.run.
+     */
+    if (flux_future_aux_get (cf, "brokercfg::apply")) {
+        uint32_t rank;
+        char s[16];
+
+        if (flux_get_rank (cfg->h, &rank) < 0
+            || snprintf (s, sizeof (s), "%u", (unsigned int)rank)
+                >= sizeof (s)
+            || flux_respond_pack (cfg->h, msg, "{s:s}", "rank", s) < 0)
+            flux_log_error (cfg->h, "reload: flux_respond");
+    }
+    else if (flux_respond (cfg->h, msg, NULL) < 0)
         flux_log_error (cfg->h, "reload: flux_respond");
     flux_log (cfg->h, LOG_INFO, "configuration updated");
     flux_future_destroy (cfg->reload_f);
@@ -172,6 +267,7 @@ error:
 static int update_modules_and_respond (flux_t *h,
                                        struct brokercfg *cfg,
                                        const flux_msg_t *msg,
+                                       bool apply,
                                        flux_error_t *error)
 {
     flux_future_t *f;
@@ -191,6 +287,8 @@ static int update_modules_and_respond (flux_t *h,
         flux_msg_decref (msg);
         goto error;
     }
+    if (apply && flux_future_aux_set (f, "brokercfg::apply", cfg, NULL) < 0)
+        goto error;
     cfg->reload_f = f;
     return 0;
 error:
@@ -199,9 +297,91 @@ error:
     return -1;
 }
 
+/* The config.apply treereduce has completed on all ranks in this broker's
+ * subtree.  Respond to the original config.reload request.
+ */
+static void distribute_continuation (flux_future_t *f, void *arg)
+{
+    struct brokercfg *cfg = arg;
+    const flux_msg_t *msg = flux_future_aux_get (f, "flux::request");
+    const char *errors;
+
+    if (flux_rpc_get_unpack (f, "{s:s}", "errors", &errors) < 0) {
+        if (flux_respond_error (cfg->h, msg, errno, future_strerror (f, errno))
+            < 0)
+            flux_log_error (cfg->h, "error responding to config.reload");
+        goto done;
+    }
+    if (!streq (errors, "")) {
+        char errbuf[256];
+        (void)snprintf (errbuf,
+                        sizeof (errbuf),
+                        "config update failed on rank %s, see broker logs",
+                        errors);
+        flux_log (cfg->h, LOG_ERR, "%s", errbuf);
+        if (flux_respond_error (cfg->h, msg, EIO, errbuf) < 0)
+            flux_log_error (cfg->h, "error responding to config.reload");
+        goto done;
+    }
+    if (flux_respond (cfg->h, msg, NULL) < 0)
+        flux_log_error (cfg->h, "error responding to config.reload");
+done:
+    flux_future_destroy (cfg->distribute_f);
+    cfg->distribute_f = NULL;
+}
+
+/* Parse the config files once and send the result to every broker in
+ * this broker's TBON subtree, including this one, with config.apply.
+ */
+static int distribute (flux_t *h,
+                       struct brokercfg *cfg,
+                       const flux_msg_t *msg,
+                       flux_error_t *error)
+{
+    flux_conf_t *conf;
+    flux_future_t *f = NULL;
+    json_t *o;
+
+    if (cfg->distribute_f) {
+        errprintf (error, "config distribution in progress, try again later");
+        errno = EBUSY;
+        return -1;
+    }
+    if (!(conf = brokercfg_parse (cfg->path, error)))
+        return -1;
+    if (flux_conf_unpack (conf, error, "o", &o) < 0)
+        goto error;
+    if (!(f = flux_rpc_pack (h,
+                             "treereduce.run",
+                             FLUX_NODEID_ANY,
+                             0,
+                             "{s:s s:s s:s s:O}",
+                             "topic", "config.apply",
+                             "op", "idset",
+                             "key", "rank",
+                             "payload", o))
+        || flux_future_then (f, -1., distribute_continuation, cfg) < 0
+        || flux_future_aux_set (f,
+                                "flux::request",
+                                (void *)flux_msg_incref (msg),
+                                (flux_free_f)flux_msg_decref) < 0) {
+        errprintf (error, "failed to distribute config");
+        goto error;
+    }
+    cfg->distribute_f = f;
+    flux_conf_decref (conf);
+    return 0;
+error:
+    flux_future_destroy (f);
+    flux_conf_decref (conf);
+    return -1;
+}
+
 /* Handle request to re-parse config object from TOML config files.
  * If files fail to parse, generate an immediate error response.  Otherwise,
  * initiate reload of config in all loaded modules and respond when complete.
+ * If "all" is true, parse the files here and distribute the result to all
+ * brokers in this broker's TBON subtree instead.
  */
 static void reload_cb (flux_t *h,
                        flux_msg_handler_t *mh,
@@ -210,9 +390,20 @@ static void reload_cb (flux_t *h,
 {
     struct brokercfg *cfg = arg;
     flux_error_t error;
+    int all = 0;
 
-    if (brokercfg_parse (h, cfg->path, &error) < 0
-        || update_modules_and_respond (h, cfg, msg, &error) < 0)
+    if (flux_msg_has_payload (msg)
+        && flux_request_unpack (msg, NULL, "{s?b}", "all", &all) < 0) {
+        errprintf (&error, "error decoding config.reload request");
+        goto error;
+    }
+    if (all) {
+        if (distribute (h, cfg, msg, &error) < 0)
+            goto error;
+        return;
+    }
+    if (brokercfg_load (cfg, &error) < 0
+        || update_modules_and_respond (h, cfg, msg, false, &error) < 0)
         goto error;
     return;
 error:
@@ -236,16 +427,40 @@ static void load_cb (flux_t *h,
         errprintf (&error, "error decoding config.load request");
         goto error;
     }
-    if (brokercfg_set (h, flux_conf_incref (conf), &error) < 0) {
-        flux_conf_decref (conf);
+    if (brokercfg_set (cfg, conf, &error) < 0
+        || update_modules_and_respond (h, cfg, msg, false, &error) < 0)
+        goto error;
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, error.text) < 0)
+        flux_log_error (h, "error responding to config.load request");
+}
+
+/* Handle request from treereduce.run to replace config object with
+ * request payload, as distributed by 'config.reload' with "all" set.
+ * Respond with {"rank":s} once all loaded modules have reloaded.
+ */
+static void apply_cb (flux_t *h,
+                      flux_msg_handler_t *mh,
+                      const flux_msg_t *msg,
+                      void *arg)
+{
+    struct brokercfg *cfg = arg;
+    const flux_conf_t *conf = NULL;
+    flux_error_t error;
+
+    if (flux_conf_reload_decode (msg, &conf) < 0) {
+        errprintf (&error, "error decoding config.apply request");
         goto error;
     }
-    if (update_modules_and_respond (h, cfg, msg, &error) < 0)
+    if (brokercfg_set (cfg, conf, &error) < 0
+        || update_modules_and_respond (h, cfg, msg, true, &error) < 0)
         goto error;
     return;
 error:
+    flux_log (h, LOG_ERR, "config.apply: %s", error.text);
     if (flux_respond_error (h, msg, errno, error.text) < 0)
-        flux_log_error (h, "error responding to config.load request");
+        flux_log_error (h, "error responding to config.apply request");
 }
 
 static void get_cb (flux_t *h,
@@ -274,6 +489,7 @@ error:
 static const struct flux_msg_handler_spec htab[] = {
     { FLUX_MSGTYPE_REQUEST,  "config.reload", reload_cb, 0 },
     { FLUX_MSGTYPE_REQUEST,  "config.load", load_cb, 0 },
+    { FLUX_MSGTYPE_REQUEST,  "config.apply", apply_cb, 0 },
     { FLUX_MSGTYPE_REQUEST,  "config.get", get_cb, FLUX_ROLE_USER },
     FLUX_MSGHANDLER_TABLE_END,
 };
@@ -284,7 +500,9 @@ void brokercfg_destroy (struct brokercfg *cfg)
         int saved_errno = errno;
         flux_msg_handler_delvec (cfg->handlers);
         flux_future_destroy (cfg->reload_f);
+        flux_future_destroy (cfg->distribute_f);
         free (cfg->path);
+        free (cfg->override_path);
         free (cfg);
         errno = saved_errno;
     }
@@ -297,6 +515,7 @@ struct brokercfg *brokercfg_create (flux_t *h,
 {
     struct brokercfg *cfg;
     flux_error_t error;
+    const char *override_path;
 
     if (!(cfg = calloc (1, sizeof (*cfg))))
         return NULL;
@@ -308,7 +527,10 @@ struct brokercfg *brokercfg_create (flux_t *h,
         if (!(cfg->path = strdup (path)))
             goto error;
     }
-    if (brokercfg_parse (h, path, &error) < 0) {
+    if (attr_get (attrs, "config.override-path", &override_path, NULL) == 0
+        && !(cfg->override_path = strdup (override_path)))
+        goto error;
+    if (brokercfg_load (cfg, &error) < 0) {
         log_msg ("%s", error.text);
         goto error;
     }
@@ -55,10 +55,14 @@ static int reject_nonlocal (const flux_msg_t *msg,
     return 0;
 }
 
-int exec_initialize (flux_t *h, uint32_t rank, attr_t *attrs)
+int exec_initialize (flux_t *h,
+                     struct overlay *ov,
+                     uint32_t rank,
+                     attr_t *attrs)
 {
     subprocess_server_t *s = NULL;
     const char *local_uri;
+    json_t *topo = NULL;
 
     if (attr_get (attrs, "local-uri", &local_uri, NULL) < 0)
         goto cleanup;
@@ -66,14 +70,21 @@ int exec_initialize (flux_t *h, uint32_t rank, attr_t *attrs)
         goto cleanup;
     if (rank == 0)
         subprocess_server_set_auth_cb (s, reject_nonlocal, h);
+    /* Let rexec.bulk-exec fan out over the TBON subtree of this rank.
+     */
+    if (!(topo = overlay_get_subtree_topo (ov, rank))
+        || subprocess_server_set_topology (s, topo) < 0)
+        goto cleanup;
     if (flux_aux_set (h,
                       "flux::exec",
                       s,
                       (flux_free_f)subprocess_server_destroy) < 0)
         goto cleanup;
+    json_decref (topo);
     return 0;
 cleanup:
     subprocess_server_destroy (s);
+    json_decref (topo);
     return -1;
 }
 
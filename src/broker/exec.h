@@ -14,12 +14,16 @@
 #include <stdint.h>
 #include <flux/core.h>
 #include "attr.h"
+#include "overlay.h"
 
 /* Send SIGTERM / SIGKILL to all subprocesses, to be called at
  * beginning of teardown of broker */
 void exec_terminate_subprocesses (flux_t *h);
 
-int exec_initialize (flux_t *h, uint32_t rank, attr_t *attrs);
+int exec_initialize (flux_t *h,
+                     struct overlay *ov,
+                     uint32_t rank,
+                     attr_t *attrs);
 
 #endif /* BROKER_EXEC_H */
 
@@ -49,6 +49,7 @@ typedef struct {
     int stderr_level;
     stderr_mode_t stderr_mode;
     int level;
+    int filter;         // max of the above levels, read by module threads
     zlist_t *buf;
     int ring_size;
     int seq;
@@ -62,6 +63,22 @@ struct logbuf_entry {
 
 void logbuf_destroy (logbuf_t *logbuf);
 
+/* Messages with a greater level than all of the configured levels are
+ * dropped by logbuf_append(), so modules need not send them.
+ */
+static void logbuf_update_filter (logbuf_t *logbuf)
+{
+    int filter = logbuf->level;
+
+    if (filter < logbuf->forward_level)
+        filter = logbuf->forward_level;
+    if (filter < logbuf->critical_level)
+        filter = logbuf->critical_level;
+    if (filter < logbuf->stderr_level)
+        filter = logbuf->stderr_level;
+    __atomic_store_n (&logbuf->filter, filter, __ATOMIC_RELAXED);
+}
+
 static void logbuf_entry_destroy (struct logbuf_entry *e)
 {
     if (e) {
@@ -137,6 +154,7 @@ static logbuf_t *logbuf_create (void)
     logbuf->stderr_level = default_stderr_level;
     logbuf->stderr_mode = default_stderr_mode;
     logbuf->level = default_level;
+    logbuf_update_filter (logbuf);
     logbuf->ring_size = default_ring_size;
     if (!(logbuf->buf = zlist_new ())) {
         errno = ENOMEM;
@@ -175,6 +193,7 @@ static int logbuf_set_forward_level (logbuf_t *logbuf, int level)
         return -1;
     }
     logbuf->forward_level = level;
+    logbuf_update_filter (logbuf);
     return 0;
 }
 
@@ -185,6 +204,7 @@ static int logbuf_set_critical_level (logbuf_t *logbuf, int level)
         return -1;
     }
     logbuf->critical_level = level;
+    logbuf_update_filter (logbuf);
     return 0;
 }
 
@@ -195,6 +215,7 @@ static int logbuf_set_stderr_level (logbuf_t *logbuf, int level)
         return -1;
     }
     logbuf->stderr_level = level;
+    logbuf_update_filter (logbuf);
     return 0;
 }
 
@@ -205,6 +226,7 @@ static int logbuf_set_level (logbuf_t *logbuf, int level)
         return -1;
     }
     logbuf->level = level;
+    logbuf_update_filter (logbuf);
     return 0;
 }
 
@@ -612,6 +634,13 @@ static void logbuf_finalize (void *arg)
     /* FIXME: need logbuf_unregister_attrs() */
 }
 
+const int *logbuf_get_filter (flux_t *h)
+{
+    logbuf_t *logbuf = flux_aux_get (h, "flux::logbuf");
+
+    return logbuf ? &logbuf->filter : NULL;
+}
+
 int logbuf_initialize (flux_t *h, uint32_t rank, attr_t *attrs)
 {
     logbuf_t *logbuf = logbuf_create ();
@@ -16,6 +16,12 @@
 
 int logbuf_initialize (flux_t *h, uint32_t rank, attr_t *attrs);
 
+/* Get a pointer to the highest log level that the broker does anything
+ * with, for flux_log_set_filter().  It is updated when the log level
+ * attributes change.  Returns NULL if logbuf_initialize() was not called.
+ */
+const int *logbuf_get_filter (flux_t *h);
+
 #endif /* BROKER_LOG_H */
 
 /*
@@ -105,15 +105,24 @@ static json_t *modhash_entry_tojson (module_t *p,
 {
     json_t *svcs;
     json_t *entry = NULL;
+    struct module_stats stats;
 
     if (!(svcs  = service_list_byuuid (sw, module_get_uuid (p))))
         return NULL;
-    entry = json_pack ("{s:s s:s s:i s:i s:O}",
+    module_get_stats (p, &stats);
+    entry = json_pack ("{s:s s:s s:i s:i s:O s:f s:{s:I s:I} s:{s:I s:I}}",
                        "name", module_get_name (p),
                        "path", module_get_path (p),
                        "idle", (int)(now - module_get_lastseen (p)),
                        "status", module_get_status (p),
-                       "services", svcs);
+                       "services", svcs,
+                       "cpu", stats.cpu,
+                       "rx",
+                         "msgs", (json_int_t)stats.rx_msgs,
+                         "bytes", (json_int_t)stats.rx_bytes,
+                       "tx",
+                         "msgs", (json_int_t)stats.tx_msgs,
+                         "bytes", (json_int_t)stats.tx_bytes);
     json_decref (svcs);
     return entry;
 }
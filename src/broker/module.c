@@ -18,10 +18,13 @@
 #include "src/common/libmissing/argz.h"
 #endif
 #include <unistd.h>
+#include <sched.h>
+#include <stdio.h>
 #include <sys/types.h>
 #include <sys/syscall.h>
 #include <signal.h>
 #include <pthread.h>
+#include <time.h>
 #include <assert.h>
 #include <uuid.h>
 #ifndef UUID_STR_LEN
@@ -34,6 +37,7 @@
 #include <sys/syscall.h>
 #endif
 
+#include "src/common/libidset/idset.h"
 #include "src/common/libutil/log.h"
 #include "src/common/libutil/errprintf.h"
 #include "src/common/libutil/errno_safe.h"
@@ -42,6 +46,18 @@
 
 #include "module.h"
 #include "modservice.h"
+#include "log.h"
+
+/* Resource usage is sampled every MODULE_SAMPLE_PERIOD seconds into a
+ * ring of MODULE_SAMPLES entries (one hour).
+ */
+#define MODULE_SAMPLE_PERIOD 60.
+#define MODULE_SAMPLES 60
+
+struct module_sample {
+    double t;
+    struct module_stats stats;
+};
 
 struct broker_module {
     flux_watcher_t *broker_w;
@@ -56,6 +72,7 @@ struct broker_module {
     char *parent_uuid_str;
     int rank;
     json_t *attr_cache;     /* attrs to be cached in module flux_t */
+    const int *log_filter;  /* broker log level filter, may be NULL */
     flux_conf_t *conf;
     pthread_t t;            /* module thread */
     mod_main_f *main;       /* dlopened mod_main() */
@@ -81,6 +98,16 @@ struct broker_module {
 
     flux_t *h;               /* module's handle */
     struct subhash *sub;
+
+    cpu_set_t cpus;         /* module thread affinity, if cpus_valid */
+    bool cpus_valid;
+
+    struct module_stats stats;
+    bool thread_running;    /* p->t may be passed to pthread_getcpuclockid */
+    flux_watcher_t *sample_w;
+    struct module_sample samples[MODULE_SAMPLES];
+    int sample_next;
+    int sample_count;
 };
 
 static int setup_module_profiling (module_t *p)
@@ -189,6 +216,8 @@ static void *module_thread (void *arg)
         goto done;
     }
     flux_log_set_appname (p->h, p->name);
+    if (p->log_filter)
+        flux_log_set_filter (p->h, p->log_filter);
     if (flux_set_conf (p->h, p->conf) < 0) {
         log_err ("%s: error setting config object", p->name);
         goto done;
@@ -273,7 +302,22 @@ static void module_cb (flux_reactor_t *r,
         p->poller_cb (p, p->poller_arg);
 }
 
-static char *module_name_from_path (const char *s)
+static void sample_cb (flux_reactor_t *r,
+                       flux_watcher_t *w,
+                       int revents,
+                       void *arg)
+{
+    module_t *p = arg;
+    struct module_sample *sample = &p->samples[p->sample_next];
+
+    sample->t = flux_reactor_now (r);
+    module_get_stats (p, &sample->stats);
+    p->sample_next = (p->sample_next + 1) % MODULE_SAMPLES;
+    if (p->sample_count < MODULE_SAMPLES)
+        p->sample_count++;
+}
+
+char *module_name_from_path (const char *s)
 {
     char *path, *name, *cpy;
     char *cp;
@@ -388,12 +432,21 @@ module_t *module_create (flux_t *h,
         errprintf (error, "could not create %s flux handle watcher", p->name);
         goto cleanup;
     }
+    if (!(p->sample_w = flux_timer_watcher_create (r,
+                                                   MODULE_SAMPLE_PERIOD,
+                                                   MODULE_SAMPLE_PERIOD,
+                                                   sample_cb,
+                                                   p))) {
+        errprintf (error, "could not create %s sample timer", p->name);
+        goto cleanup;
+    }
     /* Optimization: create attribute cache to be primed in the module's
      * flux_t handle.  Priming the cache avoids a synchronous RPC from
      * flux_attr_get(3) for common attrs like rank, etc.
      */
     if (attr_cache_to_json (h, &p->attr_cache) < 0)
         goto nomem;
+    p->log_filter = logbuf_get_filter (h);
     return p;
 nomem:
     errprintf (error, "out of memory");
@@ -428,9 +481,79 @@ int module_get_status (module_t *p)
     return p ? p->status : 0;
 }
 
+void module_get_stats (module_t *p, struct module_stats *stats)
+{
+    /* The thread CPU clock is valid until the thread is joined.  Keep the
+     * last reading so usage is still reported after the thread exits.
+     */
+    if (p->thread_running) {
+        clockid_t id;
+        struct timespec ts;
+
+        if (pthread_getcpuclockid (p->t, &id) == 0
+            && clock_gettime (id, &ts) == 0)
+            p->stats.cpu = ts.tv_sec + ts.tv_nsec * 1E-9;
+    }
+    *stats = p->stats;
+}
+
+json_t *module_get_history (module_t *p)
+{
+    json_t *samples;
+    json_t *o;
+    int i;
+
+    if (!(samples = json_array ()))
+        goto nomem;
+    i = (p->sample_next - p->sample_count + MODULE_SAMPLES) % MODULE_SAMPLES;
+    for (int n = 0; n < p->sample_count; n++) {
+        struct module_sample *sample = &p->samples[i];
+        json_t *entry;
+
+        if (!(entry = json_pack ("[f f I I I I]",
+                                 sample->t,
+                                 sample->stats.cpu,
+                                 (json_int_t)sample->stats.rx_msgs,
+                                 (json_int_t)sample->stats.rx_bytes,
+                                 (json_int_t)sample->stats.tx_msgs,
+                                 (json_int_t)sample->stats.tx_bytes))
+            || json_array_append_new (samples, entry) < 0) {
+            json_decref (entry);
+            goto nomem;
+        }
+        i = (i + 1) % MODULE_SAMPLES;
+    }
+    if (!(o = json_pack ("{s:f s:O}",
+                         "period", MODULE_SAMPLE_PERIOD,
+                         "samples", samples)))
+        goto nomem;
+    json_decref (samples);
+    return o;
+nomem:
+    json_decref (samples);
+    errno = ENOMEM;
+    return NULL;
+}
+
+static void stats_count (const flux_msg_t *msg,
+                         uint64_t *msgs,
+                         uint64_t *bytes)
+{
+    int size;
+
+    (*msgs)++;
+    if (flux_msg_has_payload (msg)
+        && flux_msg_get_payload (msg, NULL, &size) == 0)
+        (*bytes) += size;
+}
+
 flux_msg_t *module_recvmsg (module_t *p)
 {
-    return flux_recv (p->h_broker, FLUX_MATCH_ANY, FLUX_O_NONBLOCK);
+    flux_msg_t *msg;
+
+    if ((msg = flux_recv (p->h_broker, FLUX_MATCH_ANY, FLUX_O_NONBLOCK)))
+        stats_count (msg, &p->stats.rx_msgs, &p->stats.rx_bytes);
+    return msg;
 }
 
 int module_sendmsg_new (module_t *p, flux_msg_t **msg)
@@ -452,6 +575,7 @@ int module_sendmsg_new (module_t *p, flux_msg_t **msg)
             return -1;
         }
     }
+    stats_count (*msg, &p->stats.tx_msgs, &p->stats.tx_bytes);
     if (p->deferred_messages) {
         if (flux_msglist_append (p->deferred_messages, *msg) < 0)
             return -1;
@@ -486,8 +610,12 @@ void module_destroy (module_t *p)
         return;
 
     if (p->t) {
+        struct module_stats stats;
+
+        module_get_stats (p, &stats); // last CPU reading
         if ((e = pthread_join (p->t, &res)) != 0)
             log_errn_exit (e, "pthread_cancel");
+        p->thread_running = false;
         if (p->status != FLUX_MODSTATE_EXITED) {
             /* Calls broker.c module_status_cb() => service_remove_byuuid()
              * and releases a reference on 'p'.  Without this, disconnect
@@ -505,6 +633,7 @@ void module_destroy (module_t *p)
 
     flux_watcher_stop (p->broker_w);
     flux_watcher_destroy (p->broker_w);
+    flux_watcher_destroy (p->sample_w);
     flux_close (p->h_broker);
 
 #ifndef __SANITIZE_ADDRESS__
@@ -572,18 +701,132 @@ int module_set_defer (module_t *p, bool flag)
     return 0;
 }
 
+/* Add the CPUs in 'ids' to 'set'.
+ */
+static int cpuset_add_idset (cpu_set_t *set, const struct idset *ids)
+{
+    unsigned int id;
+
+    id = idset_first (ids);
+    while (id != IDSET_INVALID_ID) {
+        if (id >= CPU_SETSIZE) {
+            errno = EOVERFLOW;
+            return -1;
+        }
+        CPU_SET (id, set);
+        id = idset_next (ids, id);
+    }
+    return 0;
+}
+
+/* Set 'set' to the CPUs that the calling thread may run on, restricted
+ * to the NUMA node it is running on now.  If the node cannot be
+ * determined, e.g. sysfs is unavailable, the whole affinity mask is used.
+ */
+static int get_local_cpus (cpu_set_t *set)
+{
+    unsigned int cpu, node;
+    char path[64];
+    char buf[1024];
+    FILE *f;
+    struct idset *ids;
+    cpu_set_t local;
+    int errnum;
+
+    if ((errnum = pthread_getaffinity_np (pthread_self (),
+                                          sizeof (*set),
+                                          set))) {
+        errno = errnum;
+        return -1;
+    }
+    if (syscall (SYS_getcpu, &cpu, &node, NULL) < 0)
+        return 0;
+    snprintf (path, sizeof (path), "/sys/devices/system/node/node%u/cpulist",
+              node);
+    if (!(f = fopen (path, "r")))
+        return 0;
+    if (!fgets (buf, sizeof (buf), f)) {
+        fclose (f);
+        return 0;
+    }
+    fclose (f);
+    buf[strcspn (buf, "\n")] = '\0';
+    CPU_ZERO (&local);
+    if (!(ids = idset_decode (buf)))
+        return 0;
+    if (cpuset_add_idset (&local, ids) == 0) {
+        CPU_AND (&local, &local, set);
+        if (CPU_COUNT (&local) > 0)
+            *set = local;
+    }
+    idset_destroy (ids);
+    return 0;
+}
+
+int module_set_cpu_affinity (module_t *p,
+                             const char *spec,
+                             flux_error_t *error)
+{
+    struct idset *ids;
+
+    if (streq (spec, "none")) {
+        p->cpus_valid = false;
+        return 0;
+    }
+    if (streq (spec, "broker")) {
+        if (get_local_cpus (&p->cpus) < 0) {
+            errprintf (error, "error getting broker CPU affinity");
+            return -1;
+        }
+    }
+    else {
+        if (!(ids = idset_decode (spec)) || idset_count (ids) == 0) {
+            idset_destroy (ids);
+            errprintf (error, "invalid cpu-affinity: %s", spec);
+            errno = EINVAL;
+            return -1;
+        }
+        CPU_ZERO (&p->cpus);
+        if (cpuset_add_idset (&p->cpus, ids) < 0) {
+            idset_destroy (ids);
+            errprintf (error, "cpu-affinity %s exceeds %d CPUs",
+                       spec,
+                       CPU_SETSIZE);
+            return -1;
+        }
+        idset_destroy (ids);
+    }
+    p->cpus_valid = true;
+    return 0;
+}
+
 int module_start (module_t *p)
 {
+    pthread_attr_t attr;
     int errnum;
     int rc = -1;
 
+    if ((errnum = pthread_attr_init (&attr))) {
+        errno = errnum;
+        return -1;
+    }
+    if (p->cpus_valid
+        && (errnum = pthread_attr_setaffinity_np (&attr,
+                                                  sizeof (p->cpus),
+                                                  &p->cpus))) {
+        errno = errnum;
+        goto done;
+    }
     flux_watcher_start (p->broker_w);
-    if ((errnum = pthread_create (&p->t, NULL, module_thread, p))) {
+    if ((errnum = pthread_create (&p->t, &attr, module_thread, p))) {
         errno = errnum;
         goto done;
     }
+    p->thread_running = true;
+    flux_watcher_start (p->sample_w);
     rc = 0;
 done:
+    pthread_attr_destroy (&attr);
     return rc;
 }
 
@@ -657,6 +900,15 @@ const flux_msg_t *module_pop_insmod (module_t *p)
     return flux_msglist_pop (p->insmod_requests);
 }
 
+void module_set_subscribe_cb (module_t *p,
+                              subscribe_f sub,
+                              subscribe_f unsub,
+                              void *arg)
+{
+    subhash_set_subscribe (p->sub, sub, arg);
+    subhash_set_unsubscribe (p->sub, unsub, arg);
+}
+
 int module_subscribe (module_t *p, const char *topic)
 {
     return subhash_subscribe (p->sub, topic);
@@ -15,6 +15,7 @@
 #include <flux/core.h>
 
 #include "src/common/librouter/disconnect.h"
+#include "src/common/librouter/subhash.h"
 
 typedef struct broker_module module_t;
 typedef void (*modpoller_cb_f)(module_t *p, void *arg);
@@ -29,6 +30,11 @@ module_t *module_create (flux_t *h,
                          flux_error_t *error);
 void module_destroy (module_t *p);
 
+/* Derive the default module name from a dso path or basename,
+ * e.g. "/a/b/kvs.so" -> "kvs".  Caller must free.
+ */
+char *module_name_from_path (const char *path);
+
 /* accessors
  */
 const char *module_get_name (module_t *p);
@@ -36,11 +42,42 @@ const char *module_get_path (module_t *p);
 const char *module_get_uuid (module_t *p);
 double module_get_lastseen (module_t *p);
 
+/* Resource accounting.  'rx' counts messages from the module to the
+ * broker and 'tx' messages from the broker to the module.  Byte counts
+ * are payload bytes.  'cpu' is the CPU time consumed by the module thread
+ * in seconds.
+ */
+struct module_stats {
+    double cpu;
+    uint64_t rx_msgs;
+    uint64_t rx_bytes;
+    uint64_t tx_msgs;
+    uint64_t tx_bytes;
+};
+void module_get_stats (module_t *p, struct module_stats *stats);
+
+/* Return the periodic samples of module_get_stats() collected since the
+ * module was started, oldest first, as
+ *   {"period":f "samples":[[timestamp, cpu, rxmsgs, rxbytes,
+ *                           txmsgs, txbytes], ...]}
+ * Only the most recent samples are retained.
+ */
+json_t *module_get_history (module_t *p);
+
 /* The poller callback is called when module socket is ready for
  * reading with module_recvmsg().
  */
 void module_set_poller_cb (module_t *p, modpoller_cb_f cb, void *arg);
 
+/* The subscribe callbacks are called when the module subscribes to a new
+ * topic or drops its last subscription to one, including when the module
+ * is destroyed.
+ */
+void module_set_subscribe_cb (module_t *p,
+                              subscribe_f sub,
+                              subscribe_f unsub,
+                              void *arg);
+
 /* Send/recv a message for to/from a specific module.
  */
 flux_msg_t *module_recvmsg (module_t *p);
@@ -69,6 +106,15 @@ void module_set_status_cb (module_t *p, module_status_cb_f cb, void *arg);
 int module_get_errnum (module_t *p);
 void module_set_errnum (module_t *p, int errnum);
 
+/* Set the CPU affinity of the module thread, applied by module_start().
+ * 'spec' is "none" to leave placement to the kernel, "broker" for the CPUs
+ * of the NUMA node the broker thread is running on, or a list of CPUs in
+ * idset form, e.g. "0-3,8".
+ */
+int module_set_cpu_affinity (module_t *p,
+                             const char *spec,
+                             flux_error_t *error);
+
 /* Start module thread.
  */
 int module_start (module_t *p);
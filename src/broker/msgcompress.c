@@ -0,0 +1,185 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* msgcompress.c - LZ4 compression of overlay message payloads */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <lz4.h>
+#include <flux/core.h>
+
+#include "msgcompress.h"
+
+#define HEADER_SIZE (MSGCOMPRESS_MAGIC_SIZE + 4)
+
+struct msgcompress {
+    size_t threshold;
+    char *buf;
+    size_t bufsize;
+    struct msgcompress_stats tx;
+    struct msgcompress_stats rx;
+};
+
+static int grow_buf (struct msgcompress *mc, size_t size)
+{
+    char *buf;
+
+    if (mc->bufsize >= size)
+        return 0;
+    if (!(buf = realloc (mc->buf, size))) {
+        errno = ENOMEM;
+        return -1;
+    }
+    mc->buf = buf;
+    mc->bufsize = size;
+    return 0;
+}
+
+static bool is_compressed (const void *data, int size)
+{
+    return (size >= MSGCOMPRESS_MAGIC_SIZE
+            && !memcmp (data, MSGCOMPRESS_MAGIC, MSGCOMPRESS_MAGIC_SIZE));
+}
+
+int msgcompress_encode (struct msgcompress *mc,
+                        const flux_msg_t *msg,
+                        flux_msg_t **cmsg)
+{
+    const void *data;
+    int size;
+    bool needed;
+    int bound;
+    int r;
+    uint32_t nsize;
+    flux_msg_t *cpy;
+
+    if (!mc || !msg || !cmsg) {
+        errno = EINVAL;
+        return -1;
+    }
+    *cmsg = NULL;
+    if (!flux_msg_has_payload (msg))
+        return 0;
+    if (flux_msg_get_payload (msg, &data, &size) < 0)
+        return -1;
+    needed = is_compressed (data, size);
+    if (!needed && size < mc->threshold)
+        return 0;
+    if (size > LZ4_MAX_INPUT_SIZE) {
+        errno = EOVERFLOW;
+        return -1;
+    }
+    bound = LZ4_compressBound (size);
+    if (grow_buf (mc, HEADER_SIZE + bound) < 0)
+        return -1;
+    r = LZ4_compress_default (data, mc->buf + HEADER_SIZE, size, bound);
+    if (r == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!needed && HEADER_SIZE + r >= size)
+        return 0; // incompressible
+    memcpy (mc->buf, MSGCOMPRESS_MAGIC, MSGCOMPRESS_MAGIC_SIZE);
+    nsize = htonl (size);
+    memcpy (mc->buf + MSGCOMPRESS_MAGIC_SIZE, &nsize, sizeof (nsize));
+    if (!(cpy = flux_msg_copy (msg, false))
+        || flux_msg_set_payload (cpy, mc->buf, HEADER_SIZE + r) < 0) {
+        flux_msg_destroy (cpy);
+        return -1;
+    }
+    mc->tx.count++;
+    mc->tx.raw_bytes += size;
+    mc->tx.compressed_bytes += HEADER_SIZE + r;
+    *cmsg = cpy;
+    return 0;
+}
+
+int msgcompress_decode (struct msgcompress *mc, flux_msg_t *msg)
+{
+    const void *data;
+    int size;
+    uint32_t nsize;
+    int rawsize;
+    int r;
+
+    if (!mc || !msg) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!flux_msg_has_payload (msg))
+        return 0;
+    if (flux_msg_get_payload (msg, &data, &size) < 0)
+        return -1;
+    if (!is_compressed (data, size))
+        return 0;
+    if (size < HEADER_SIZE)
+        goto inval;
+    memcpy (&nsize, (char *)data + MSGCOMPRESS_MAGIC_SIZE, sizeof (nsize));
+    rawsize = ntohl (nsize);
+    if (rawsize < 0 || rawsize > LZ4_MAX_INPUT_SIZE)
+        goto inval;
+    if (grow_buf (mc, rawsize > 0 ? rawsize : 1) < 0)
+        return -1;
+    r = LZ4_decompress_safe ((char *)data + HEADER_SIZE,
+                             mc->buf,
+                             size - HEADER_SIZE,
+                             rawsize);
+    if (r != rawsize)
+        goto inval;
+    mc->rx.count++;
+    mc->rx.raw_bytes += rawsize;
+    mc->rx.compressed_bytes += size;
+    return flux_msg_set_payload (msg, mc->buf, rawsize);
+inval:
+    errno = EPROTO;
+    return -1;
+}
+
+void msgcompress_get_stats (struct msgcompress *mc,
+                            struct msgcompress_stats *tx,
+                            struct msgcompress_stats *rx)
+{
+    if (mc) {
+        if (tx)
+            *tx = mc->tx;
+        if (rx)
+            *rx = mc->rx;
+    }
+}
+
+void msgcompress_destroy (struct msgcompress *mc)
+{
+    if (mc) {
+        int saved_errno = errno;
+        free (mc->buf);
+        free (mc);
+        errno = saved_errno;
+    }
+}
+
+struct msgcompress *msgcompress_create (size_t threshold)
+{
+    struct msgcompress *mc;
+
+    if (!(mc = calloc (1, sizeof (*mc))))
+        return NULL;
+    mc->threshold = threshold;
+    return mc;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,65 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _BROKER_MSGCOMPRESS_H
+#define _BROKER_MSGCOMPRESS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <flux/core.h>
+
+/* LZ4 compression of overlay message payloads.
+ *
+ * A compressed payload is MSGCOMPRESS_MAGIC, followed by the uncompressed
+ * size (4 bytes, network order), followed by the LZ4 block.  Compression
+ * is negotiated per connection, so a peer that did not ask for it never
+ * receives one.  On a compressing connection, a raw payload that happens
+ * to begin with the magic is compressed regardless of size so that the
+ * receiver cannot misread it.
+ */
+
+#define MSGCOMPRESS_MAGIC       "\xff" "LZ4"
+#define MSGCOMPRESS_MAGIC_SIZE  4
+
+struct msgcompress_stats {
+    uint64_t count;             // messages (de)compressed
+    uint64_t raw_bytes;         // payload bytes before compression
+    uint64_t compressed_bytes;  // payload bytes after compression
+};
+
+/* Create context for payloads of at least 'threshold' bytes.
+ */
+struct msgcompress *msgcompress_create (size_t threshold);
+void msgcompress_destroy (struct msgcompress *mc);
+
+/* If 'msg' should be compressed, set '*cmsg' to a copy with a compressed
+ * payload, which the caller must destroy.  Otherwise set '*cmsg' to NULL
+ * and the caller should send 'msg' as is.  An incompressible payload is
+ * left alone.  Returns 0 on success, -1 on failure with errno set.
+ */
+int msgcompress_encode (struct msgcompress *mc,
+                        const flux_msg_t *msg,
+                        flux_msg_t **cmsg);
+
+/* Decompress the payload of 'msg' in place, if it is compressed.
+ * Returns 0 on success, -1 on failure with errno set (EPROTO if the
+ * compressed payload is malformed).
+ */
+int msgcompress_decode (struct msgcompress *mc, flux_msg_t *msg);
+
+void msgcompress_get_stats (struct msgcompress *mc,
+                            struct msgcompress_stats *tx,
+                            struct msgcompress_stats *rx);
+
+#endif /* !_BROKER_MSGCOMPRESS_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -37,10 +37,12 @@
 #include "src/common/libutil/monotime.h"
 #include "src/common/libutil/errprintf.h"
 #include "src/common/librouter/rpc_track.h"
+#include "src/common/librouter/subhash.h"
 #include "ccan/str/str.h"
 
 #include "overlay.h"
 #include "attr.h"
+#include "msgcompress.h"
 
 /* How long to wait (seconds) for a peer broker's TCP ACK before disconnecting.
  * This can be configured via TOML and on the broker command line.
@@ -110,6 +112,13 @@ struct child {
     enum subtree_status status;
     struct timespec status_timestamp;
     bool torpid;
+    bool compress;          // negotiated in hello handshake
+    bool congested;         // last send failed because queue was full
+    bool notify_pending;    // status changed, monitor not yet notified
+    uint64_t sent;
+    uint64_t dropped;
+    uint64_t filtered;      // events not sent due to no subscription
+    struct subhash *event_sub; // subtree subscriptions (NULL=unfiltered)
     struct rpc_track *tracker;
 };
 
@@ -123,6 +132,8 @@ struct parent {
     char uuid[UUID_STR_LEN];
     bool hello_error;
     bool hello_responded;
+    bool compress;          // negotiated in hello handshake
+    bool event_filter;      // negotiated in hello handshake
     bool offline;           // set upon receipt of CONTROL_DISCONNECT
     bool goodbye_sent;
     flux_future_t *f_goodbye;
@@ -137,6 +148,16 @@ struct parent {
 static const double sync_min = 1.0;
 static const double sync_max = 5.0;
 
+/* Limit on messages handled per child_cb() call.
+ */
+static const int child_recv_batch = 256;
+
+/* Default zeromq I/O thread count is one per io_thread_children TBON
+ * children, plus one, up to io_threads_max.
+ */
+static const int io_thread_children = 64;
+static const int io_threads_max = 4;
+
 static const double default_torpid_min = 5.0;
 static const double default_torpid_max = 30.0;
 
@@ -168,6 +189,13 @@ struct overlay {
     double torpid_max;
     double tcp_user_timeout;
     double connect_timeout;
+    int compress_threshold;
+    struct msgcompress *compress; // NULL if compression is disabled
+    int child_hwm;              // per-child send queue limit (0=unlimited)
+    int io_threads;             // zeromq I/O threads (0=auto)
+    int sockbuf;                // kernel socket buffer size (0=OS default)
+    int event_filter;           // filter events sent to children
+    struct subhash *event_sub;  // subscriptions of this broker's subtree
 
     struct parent parent;
 
@@ -180,6 +208,10 @@ struct overlay {
     zhashx_t *child_hash;
     enum subtree_status status;
     struct timespec status_timestamp;
+    bool status_pending;        // child status changed since last flush
+    flux_watcher_t *status_w;   // prepare watcher that flushes status
+    struct timespec create_timestamp;
+    double wireup;              // secs until subtree first full (-1=not yet)
     struct zmqutil_monitor *bind_monitor;
 
     zlist_t *monitor_callbacks;
@@ -227,6 +259,15 @@ static bool subtree_is_online (enum subtree_status status)
     }
 }
 
+/* Record the time from overlay creation until the subtree first became
+ * full.  On rank 0 this is the time to wire up the entire instance.
+ */
+static void wireup_update (struct overlay *ov)
+{
+    if (ov->wireup < 0 && ov->status == SUBTREE_STATUS_FULL)
+        ov->wireup = monotime_since (ov->create_timestamp) / 1000.0;
+}
+
 /* Call this function after a child->status changes.
  * It calculates a new subtree status based on the state of children,
  * then if the status has changed, the parent is informed with a
@@ -258,6 +299,7 @@ static void subtree_status_update (struct overlay *ov)
     if (ov->status != status) {
         ov->status = status;
         monotime (&ov->status_timestamp);
+        wireup_update (ov);
         overlay_control_parent (ov, CONTROL_STATUS, ov->status);
         overlay_health_respond_all (ov);
     }
@@ -319,6 +361,7 @@ int overlay_set_topology (struct overlay *ov, struct topology *topo)
     else
         ov->status = SUBTREE_STATUS_FULL;
     monotime (&ov->status_timestamp);
+    wireup_update (ov);
     if (ov->rank > 0) {
         ov->parent.rank = topology_get_parent (topo);
         ov->parent.tracker = rpc_track_create (MSG_HASH_TYPE_UUID_MATCHTAG);
@@ -507,15 +550,20 @@ const char *overlay_get_parent_uri (struct overlay *ov)
 
 static int overlay_sendmsg_parent (struct overlay *ov, const flux_msg_t *msg)
 {
+    flux_msg_t *cmsg = NULL;
     int rc = -1;
 
     if (!ov->parent.zsock || ov->parent.offline || ov->parent.goodbye_sent) {
         errno = EHOSTUNREACH;
         goto done;
     }
-    rc = zmqutil_msg_send (ov->parent.zsock, msg);
+    if (ov->parent.compress
+        && msgcompress_encode (ov->compress, msg, &cmsg) < 0)
+        goto done;
+    rc = zmqutil_msg_send (ov->parent.zsock, cmsg ? cmsg : msg);
     if (rc == 0)
         ov->parent.lastsent = flux_reactor_now (ov->reactor);
+    flux_msg_destroy (cmsg);
 done:
     return rc;
 }
@@ -606,8 +654,19 @@ int overlay_sendmsg_new (struct overlay *ov,
                 rpc_track_update (ov->parent.tracker, *msg);
             }
             else {
-                if (overlay_sendmsg_child (ov, *msg) < 0)
+                if (overlay_sendmsg_child (ov, *msg) < 0) {
+                    /* Undo the route pushes above so that the caller's
+                     * error response (e.g. EAGAIN if the child's queue is
+                     * full) is routed back to the sender.
+                     */
+                    if (child) {
+                        int saved_errno = errno;
+                        (void)flux_msg_route_delete_last (*msg);
+                        (void)flux_msg_route_delete_last (*msg);
+                        errno = saved_errno;
+                    }
                     return -1;
+                }
                 if (!child) {
                     if ((uuid = flux_msg_route_last (*msg)))
                         child = child_lookup_online (ov, ov->uuid);
@@ -733,6 +792,38 @@ static void fail_child_rpcs (const flux_msg_t *msg, void *arg)
     flux_msg_destroy (rep);
 }
 
+/* Propagate pending child status changes: recompute subtree status,
+ * call monitor callbacks for each child that changed, and respond to
+ * health requests.
+ */
+static void overlay_status_flush (struct overlay *ov)
+{
+    struct child *child;
+
+    if (ov->status_w)
+        flux_watcher_stop (ov->status_w);
+    if (!ov->status_pending)
+        return;
+    ov->status_pending = false;
+
+    subtree_status_update (ov);
+    foreach_overlay_child (ov, child) {
+        if (child->notify_pending) {
+            child->notify_pending = false;
+            overlay_monitor_notify (ov, child->rank);
+        }
+    }
+    overlay_health_respond_all (ov);
+}
+
+static void status_prep_cb (flux_reactor_t *r,
+                            flux_watcher_t *w,
+                            int revents,
+                            void *arg)
+{
+    overlay_status_flush (arg);
+}
+
 static void overlay_child_status_update (struct overlay *ov,
                                          struct child *child,
                                          int status)
@@ -742,6 +833,8 @@ static void overlay_child_status_update (struct overlay *ov,
             && !subtree_is_online (status)) {
             zhashx_delete (ov->child_hash, child->uuid);
             rpc_track_purge (child->tracker, fail_child_rpcs, ov);
+            subhash_destroy (child->event_sub);
+            child->event_sub = NULL;
         }
         else if (!subtree_is_online (child->status)
             && subtree_is_online (status)) {
@@ -751,68 +844,149 @@ static void overlay_child_status_update (struct overlay *ov,
         child->status = status;
         monotime (&child->status_timestamp);
 
-        subtree_status_update (ov);
-        overlay_monitor_notify (ov, child->rank);
-        overlay_health_respond_all (ov);
+        child->notify_pending = true;
+        ov->status_pending = true;
+        /* A child coming online is the common case during a large instance
+         * startup, when many hellos may arrive in one reactor iteration.
+         * Defer the subtree status update and notifications to the prepare
+         * watcher so they run once per batch instead of once per hello.
+         * Going offline is handled immediately so that observers see the
+         * transition even if the child reconnects right away.
+         */
+        if (subtree_is_online (status) && ov->status_w)
+            flux_watcher_start (ov->status_w);
+        else
+            overlay_status_flush (ov);
     }
 }
 
-static int overlay_sendmsg_child (struct overlay *ov, const flux_msg_t *msg)
+/* Account for a send to 'child' that returned 'rc'.  If tbon.child_hwm is
+ * set, a child that is not keeping up causes sends to fail with EAGAIN once
+ * its queue is full.  Log when a child enters and leaves that state.
+ */
+static void overlay_child_sent (struct overlay *ov,
+                                struct child *child,
+                                int rc)
 {
-    int rc = -1;
+    int saved_errno = errno;
 
-    if (!ov->bind_zsock) {
-        errno = EHOSTUNREACH;
-        goto done;
+    if (rc == 0) {
+        child->sent++;
+        if (child->congested) {
+            flux_log (ov->h,
+                      LOG_WARNING,
+                      "%s (rank %lu) send queue has drained",
+                      flux_get_hostbyrank (ov->h, child->rank),
+                      (unsigned long)child->rank);
+            child->congested = false;
+        }
     }
-    rc = zmqutil_msg_send_ex (ov->bind_zsock, msg, true);
-    /* Since ROUTER socket has ZMQ_ROUTER_MANDATORY set, EHOSTUNREACH on a
-     * connected peer signifies a disconnect.  See zmq_setsockopt(3).
-     */
-    if (rc < 0 && errno == EHOSTUNREACH) {
-        int saved_errno = errno;
-        const char *uuid;
-        struct child *child;
-
-        if ((uuid = flux_msg_route_last (msg))
-            && (child = child_lookup_online (ov, uuid))) {
+    else if (errno == EAGAIN) {
+        child->dropped++;
+        if (!child->congested) {
             flux_log (ov->h,
-                      LOG_ERR,
-                      "%s (rank %d) has disconnected unexpectedly."
-                      " Marking it LOST.",
+                      LOG_WARNING,
+                      "%s (rank %lu) send queue is full (tbon.child_hwm=%d),"
+                      " dropping messages",
                       flux_get_hostbyrank (ov->h, child->rank),
-                      (int)child->rank);
-            overlay_child_status_update (ov, child, SUBTREE_STATUS_LOST);
+                      (unsigned long)child->rank,
+                      ov->child_hwm);
+            child->congested = true;
         }
-        errno = saved_errno;
     }
-done:
-    return rc;
+    errno = saved_errno;
 }
 
-/* Push child->uuid onto the message, then pop it off again after sending.
+/* Since ROUTER socket has ZMQ_ROUTER_MANDATORY set, EHOSTUNREACH on a
+ * connected peer signifies a disconnect.  See zmq_setsockopt(3).
  */
-static int overlay_mcast_child_one (struct overlay *ov,
-                                    flux_msg_t *msg,
-                                    struct child *child)
+static void overlay_child_unreachable (struct overlay *ov, struct child *child)
 {
-    if (flux_msg_route_push (msg, child->uuid) < 0)
-        return -1;
-    int rc = overlay_sendmsg_child (ov, msg);
-    (void)flux_msg_route_delete_last (msg);
+    int saved_errno = errno;
+
+    flux_log (ov->h,
+              LOG_ERR,
+              "%s (rank %d) has disconnected unexpectedly."
+              " Marking it LOST.",
+              flux_get_hostbyrank (ov->h, child->rank),
+              (int)child->rank);
+    overlay_child_status_update (ov, child, SUBTREE_STATUS_LOST);
+    errno = saved_errno;
+}
+
+static int overlay_sendmsg_child (struct overlay *ov, const flux_msg_t *msg)
+{
+    const char *uuid;
+    struct child *child = NULL;
+    flux_msg_t *cmsg = NULL;
+    int rc = -1;
+
+    if (!ov->bind_zsock) {
+        errno = EHOSTUNREACH;
+        goto done;
+    }
+    if ((uuid = flux_msg_route_last (msg)))
+        child = child_lookup_online (ov, uuid);
+    if (child
+        && child->compress
+        && msgcompress_encode (ov->compress, msg, &cmsg) < 0)
+        goto done;
+    rc = zmqutil_msg_send_ex (ov->bind_zsock, cmsg ? cmsg : msg, true);
+    if (child) {
+        overlay_child_sent (ov, child, rc);
+        if (rc < 0 && errno == EHOSTUNREACH)
+            overlay_child_unreachable (ov, child);
+    }
+    flux_msg_destroy (cmsg);
+done:
     return rc;
 }
 
+/* Encode the message once, then send it to each online child with only
+ * the leading identity frame varying, so the payload is not re-encoded
+ * and copied per child.  If compression is enabled, the payload is also
+ * compressed once, and that encoding is shared by the children that
+ * negotiated compression.
+ */
 static void overlay_mcast_child (struct overlay *ov, flux_msg_t *msg)
 {
+    struct zmqutil_mcast *mc[2] = { NULL, NULL }; // raw, compressed
+    flux_msg_t *cmsg = NULL;
     struct child *child;
+    const char *topic = NULL;
+    int i;
+
+    if (!ov->bind_zsock)
+        return;
+    (void)flux_msg_get_topic (msg, &topic);
 
     flux_msg_route_enable (msg);
 
+    if (ov->compress && msgcompress_encode (ov->compress, msg, &cmsg) < 0) {
+        flux_log_error (ov->h, "mcast error compressing message");
+        return;
+    }
     foreach_overlay_child (ov, child) {
         if (subtree_is_online (child->status)) {
-            if (overlay_mcast_child_one (ov, msg, child) < 0) {
-                if (errno != EHOSTUNREACH) {
+            if (child->event_sub
+                && !subhash_topic_match (child->event_sub, topic)) {
+                child->filtered++;
+                continue;
+            }
+            i = (cmsg && child->compress) ? 1 : 0;
+            if (!mc[i] && !(mc[i] = zmqutil_mcast_create (i ? cmsg : msg))) {
+                flux_log_error (ov->h, "mcast error encoding message");
+                continue;
+            }
+            int rc = zmqutil_mcast_send (ov->bind_zsock,
+                                         mc[i],
+                                         child->uuid,
+                                         true);
+            overlay_child_sent (ov, child, rc);
+            if (rc < 0) {
+                if (errno == EHOSTUNREACH)
+                    overlay_child_unreachable (ov, child);
+                else if (errno != EAGAIN) {
                     flux_log_error (ov->h,
                                     "mcast error to child rank %lu",
                                     (unsigned long)child->rank);
@@ -820,6 +994,9 @@ static void overlay_mcast_child (struct overlay *ov, flux_msg_t *msg)
             }
         }
     }
+    zmqutil_mcast_destroy (mc[0]);
+    zmqutil_mcast_destroy (mc[1]);
+    flux_msg_destroy (cmsg);
 }
 
 static void logdrop (struct overlay *ov,
@@ -868,20 +1045,13 @@ static int clear_msg_role (flux_msg_t *msg, uint32_t role)
 
 /* Handle a message received from TBON child (downstream).
  */
-static void child_cb (flux_reactor_t *r,
-                      flux_watcher_t *w,
-                      int revents,
-                      void *arg)
+static void child_recv (struct overlay *ov, flux_msg_t *msg)
 {
-    struct overlay *ov = arg;
-    flux_msg_t *msg;
     int type = -1;
     const char *topic = NULL;
     const char *uuid = NULL;
     struct child *child;
 
-    if (!(msg = zmqutil_msg_recv (ov->bind_zsock)))
-        return;
     if (clear_msg_role (msg, FLUX_ROLE_LOCAL) < 0) {
         logdrop (ov, OVERLAY_DOWNSTREAM, msg, "failed to clear local role");
         goto done;
@@ -927,6 +1097,10 @@ static void child_cb (flux_reactor_t *r,
     assert (subtree_is_online (child->status));
 
     child->lastseen = flux_reactor_now (ov->reactor);
+    if (child->compress && msgcompress_decode (ov->compress, msg) < 0) {
+        logdrop (ov, OVERLAY_DOWNSTREAM, msg, "failed to decompress payload");
+        goto done;
+    }
     switch (type) {
         case FLUX_MSGTYPE_CONTROL: {
             int type, status;
@@ -957,6 +1131,31 @@ done:
     flux_msg_decref (msg);
 }
 
+/* Receive up to child_recv_batch messages per reactor iteration, so that
+ * a burst of traffic from many children (e.g. hellos at startup) is handled
+ * without returning to the reactor for each message.
+ * N.B. the socket may be closed during shutdown by a message handler.
+ */
+static void child_cb (flux_reactor_t *r,
+                      flux_watcher_t *w,
+                      int revents,
+                      void *arg)
+{
+    struct overlay *ov = arg;
+    flux_msg_t *msg;
+    int count = 0;
+    int events;
+
+    do {
+        if (!(msg = zmqutil_msg_recv (ov->bind_zsock)))
+            return;
+        child_recv (ov, msg);
+    } while (++count < child_recv_batch
+             && ov->bind_zsock
+             && zgetsockopt_int (ov->bind_zsock, ZMQ_EVENTS, &events) == 0
+             && (events & ZMQ_POLLIN));
+}
+
 /* Parent endpoint disconnected, so any pending RPCs going that way
  * get EHOSTUNREACH responses so they can fail fast.
  */
@@ -1005,6 +1204,10 @@ static void parent_cb (flux_reactor_t *r,
             goto done;
         }
     }
+    if (ov->parent.compress && msgcompress_decode (ov->compress, msg) < 0) {
+        logdrop (ov, OVERLAY_UPSTREAM, msg, "failed to decompress payload");
+        goto done;
+    }
     switch (type) {
         case FLUX_MSGTYPE_RESPONSE:
             rpc_track_update (ov->parent.tracker, msg);
@@ -1072,6 +1275,21 @@ static bool version_check (int v1, int v2, flux_error_t *error)
     return true;
 }
 
+/* Subscriptions of a child subtree are added to this broker's subtree
+ * subscriptions, which are in turn passed upstream.
+ */
+static int child_subscribe_cb (const char *topic, void *arg)
+{
+    struct overlay *ov = arg;
+    return subhash_subscribe (ov->event_sub, topic);
+}
+
+static int child_unsubscribe_cb (const char *topic, void *arg)
+{
+    struct overlay *ov = arg;
+    return subhash_unsubscribe (ov->event_sub, topic);
+}
+
 /* Handle overlay.hello request from downstream (child) TBON peer.
  * The peer may be rejected here if it is improperly configured.
  * If successful the child's status is updated to reflect its online
@@ -1089,15 +1307,19 @@ static void hello_request_handler (struct overlay *ov, const flux_msg_t *msg)
     flux_msg_t *response;
     const char *uuid;
     int status;
+    int compress = 0;
+    int event_filter = 0;
     int hello_log_level = LOG_DEBUG;
 
     if (flux_request_unpack (msg,
                              NULL,
-                             "{s:I s:i s:s s:i}",
+                             "{s:I s:i s:s s:i s?b s?b}",
                              "rank", &rank,
                              "version", &version,
                              "uuid", &uuid,
-                             "status", &status) < 0)
+                             "status", &status,
+                             "compress", &compress,
+                             "event_filter", &event_filter) < 0)
         goto error; // EPROTO (unlikely)
 
     if (flux_msg_authorize (msg, FLUX_USERID_UNKNOWN) < 0) {
@@ -1140,6 +1362,7 @@ static void hello_request_handler (struct overlay *ov, const flux_msg_t *msg)
         overlay_child_status_update (ov, child, SUBTREE_STATUS_LOST);
         hello_log_level = LOG_ERR; // want hello log to stand out in this case
     }
+    child->compress = false;
 
     if (!version_check (version, ov->version, &error)) {
         flux_log (ov->h, LOG_ERR,
@@ -1152,6 +1375,17 @@ static void hello_request_handler (struct overlay *ov, const flux_msg_t *msg)
         goto error;
     }
 
+    /* The child passes its subtree's subscriptions upstream after it
+     * receives the response, so start with none.
+     */
+    event_filter = (event_filter && ov->event_filter);
+    if (event_filter) {
+        if (!(child->event_sub = subhash_create ()))
+            goto error;
+        subhash_set_subscribe (child->event_sub, child_subscribe_cb, ov);
+        subhash_set_unsubscribe (child->event_sub, child_unsubscribe_cb, ov);
+    }
+
     snprintf (child->uuid, sizeof (child->uuid), "%s", uuid);
     overlay_child_status_update (ov, child, status);
 
@@ -1162,11 +1396,19 @@ static void hello_request_handler (struct overlay *ov, const flux_msg_t *msg)
               (unsigned long)child->rank,
               subtree_status_str (child->status));
 
+    /* Enable compression only after the (uncompressed) response is sent.
+     */
+    compress = (compress && ov->compress);
     if (!(response = flux_response_derive (msg, 0))
-        || flux_msg_pack (response, "{s:s}", "uuid", ov->uuid) < 0
+        || flux_msg_pack (response,
+                          "{s:s s:b s:b}",
+                          "uuid", ov->uuid,
+                          "compress", compress,
+                          "event_filter", event_filter) < 0
         || overlay_sendmsg_child (ov, response) < 0)
         flux_log_error (ov->h, "error responding to overlay.hello request");
     flux_msg_destroy (response);
+    child->compress = compress;
     return;
 error:
     if (!(response = flux_response_derive (msg, errno))
@@ -1185,9 +1427,15 @@ static void hello_response_handler (struct overlay *ov, const flux_msg_t *msg)
 {
     const char *errstr = NULL;
     const char *uuid;
+    int compress = 0;
+    int event_filter = 0;
 
     if (flux_response_decode (msg, NULL, NULL) < 0
-        || flux_msg_unpack (msg, "{s:s}", "uuid", &uuid) < 0) {
+        || flux_msg_unpack (msg,
+                            "{s:s s?b s?b}",
+                            "uuid", &uuid,
+                            "compress", &compress,
+                            "event_filter", &event_filter) < 0) {
         int saved_errno = errno;
         (void)flux_msg_get_string (msg, &errstr);
         errno = saved_errno;
@@ -1199,8 +1447,12 @@ static void hello_response_handler (struct overlay *ov, const flux_msg_t *msg)
               (unsigned long)ov->parent.rank,
               uuid);
     snprintf (ov->parent.uuid, sizeof (ov->parent.uuid), "%s", uuid);
+    ov->parent.compress = (compress && ov->compress);
     ov->parent.hello_responded = true;
     ov->parent.hello_error = false;
+    ov->parent.event_filter = event_filter;
+    if (ov->parent.event_filter && subhash_renew (ov->event_sub) < 0)
+        flux_log_error (ov->h, "error sending subscriptions to parent");
     overlay_monitor_notify (ov, FLUX_NODEID_ANY);
     return;
 error:
@@ -1220,11 +1472,13 @@ static int hello_request_send (struct overlay *ov,
 
     if (!(msg = flux_request_encode ("overlay.hello", NULL))
         || flux_msg_pack (msg,
-                          "{s:I s:i s:s s:i}",
+                          "{s:I s:i s:s s:i s:b s:b}",
                           "rank", rank,
                           "version", ov->version,
                           "uuid", ov->uuid,
-                          "status", ov->status) < 0
+                          "status", ov->status,
+                          "compress", ov->compress ? 1 : 0,
+                          "event_filter", 1) < 0
         || flux_msg_set_rolemask (msg, FLUX_ROLE_OWNER) < 0
         || overlay_sendmsg_parent (ov, msg) < 0) {
         flux_msg_decref (msg);
@@ -1265,6 +1519,33 @@ static void parent_monitor_cb (struct zmqutil_monitor *mon, void *arg)
     }
 }
 
+/* Create the zeromq context if it was not provided by the caller.
+ * Socket I/O, framing, and CURVE encryption are performed by the context's
+ * I/O threads, leaving the reactor thread to route decoded messages.
+ * Unless tbon.io_threads is set, a broker with many children gets
+ * more than one.
+ */
+static int overlay_zctx_create (struct overlay *ov)
+{
+    int n = ov->io_threads;
+
+    if (ov->zctx)
+        return 0;
+    if (n == 0) {
+        n = 1 + ov->child_count / io_thread_children;
+        if (n > io_threads_max)
+            n = io_threads_max;
+    }
+    if (!(ov->zctx = zmq_ctx_new ()))
+        return -1;
+    if (zmq_ctx_set (ov->zctx, ZMQ_IO_THREADS, n) < 0) {
+        ERRNO_SAFE_WRAP (zmq_ctx_term, ov->zctx);
+        ov->zctx = NULL;
+        return -1;
+    }
+    return 0;
+}
+
 int overlay_connect (struct overlay *ov)
 {
     if (ov->rank > 0) {
@@ -1272,7 +1553,7 @@ int overlay_connect (struct overlay *ov)
             errno = EINVAL;
             return -1;
         }
-        if (!ov->zctx && !(ov->zctx = zmq_ctx_new ()))
+        if (overlay_zctx_create (ov) < 0)
             return -1;
         if (!(ov->parent.zsock = zmq_socket (ov->zctx, ZMQ_DEALER))
             || zsetsockopt_int (ov->parent.zsock, ZMQ_SNDHWM, 0) < 0
@@ -1287,6 +1568,15 @@ int overlay_connect (struct overlay *ov)
                                 ZMQ_CURVE_SERVERKEY,
                                 ov->parent.pubkey) < 0)
             return -1;
+        if (ov->sockbuf > 0) {
+            if (zsetsockopt_int (ov->parent.zsock,
+                                 ZMQ_SNDBUF,
+                                 ov->sockbuf) < 0
+                || zsetsockopt_int (ov->parent.zsock,
+                                    ZMQ_RCVBUF,
+                                    ov->sockbuf) < 0)
+                return -1;
+        }
         /* The socket monitor is only used for logging.
          * Setup may fail if libzmq is too old.
          */
@@ -1336,7 +1626,7 @@ int overlay_bind (struct overlay *ov, const char *uri)
         log_err ("overlay_bind: invalid arguments");
         return -1;
     }
-    if (!ov->zctx && !(ov->zctx = zmq_ctx_new ())) {
+    if (overlay_zctx_create (ov) < 0) {
         log_err ("error creating zeromq context");
         return -1;
     }
@@ -1348,7 +1638,7 @@ int overlay_bind (struct overlay *ov, const char *uri)
     zmqutil_zap_set_logger (ov->zap, zaplogger, ov);
 
     if (!(ov->bind_zsock = zmq_socket (ov->zctx, ZMQ_ROUTER))
-        || zsetsockopt_int (ov->bind_zsock, ZMQ_SNDHWM, 0) < 0
+        || zsetsockopt_int (ov->bind_zsock, ZMQ_SNDHWM, ov->child_hwm) < 0
         || zsetsockopt_int (ov->bind_zsock, ZMQ_RCVHWM, 0) < 0
         || zsetsockopt_int (ov->bind_zsock, ZMQ_LINGER, 5) < 0
         || zsetsockopt_int (ov->bind_zsock, ZMQ_ROUTER_MANDATORY, 1) < 0
@@ -1358,6 +1648,13 @@ int overlay_bind (struct overlay *ov, const char *uri)
         log_err ("error creating zmq ROUTER socket");
         return -1;
     }
+    if (ov->sockbuf > 0) {
+        if (zsetsockopt_int (ov->bind_zsock, ZMQ_SNDBUF, ov->sockbuf) < 0
+            || zsetsockopt_int (ov->bind_zsock, ZMQ_RCVBUF, ov->sockbuf) < 0) {
+            log_err ("error setting socket buffer size on bind socket");
+            return -1;
+        }
+    }
     /* The socket monitor is only used for logging.
      * Setup may fail if libzmq is too old.
      */
@@ -1480,6 +1777,99 @@ int overlay_set_monitor_cb (struct overlay *ov,
     return 0;
 }
 
+/* A child has sent an overlay.subscribe or overlay.unsubscribe request
+ * to update the subscriptions of its subtree.  No response is sent.
+ */
+static void overlay_subscribe_cb (flux_t *h,
+                                  flux_msg_handler_t *mh,
+                                  const flux_msg_t *msg,
+                                  void *arg)
+{
+    struct overlay *ov = arg;
+    const char *uuid;
+    const char *topic;
+    const char *name;
+    struct child *child;
+    int rc;
+
+    if (flux_request_unpack (msg, &name, "{s:s}", "topic", &topic) < 0
+        || !(uuid = flux_msg_route_last (msg))
+        || !(child = child_lookup_online (ov, uuid))
+        || !child->event_sub) {
+        flux_log (h, LOG_ERR, "malformed overlay subscription request");
+        return;
+    }
+    if (streq (name, "overlay.subscribe"))
+        rc = subhash_subscribe (child->event_sub, topic);
+    else
+        rc = subhash_unsubscribe (child->event_sub, topic);
+    if (rc < 0) {
+        flux_log_error (h,
+                        "%s (rank %lu) %s %s",
+                        flux_get_hostbyrank (h, child->rank),
+                        (unsigned long)child->rank,
+                        name,
+                        topic);
+    }
+}
+
+/* Called when the first subscription to 'topic' is added to this broker's
+ * subtree, or the last is removed.  Pass the change upstream if the parent
+ * filters events.
+ */
+static int parent_subscribe (struct overlay *ov,
+                             const char *topic,
+                             const char *name)
+{
+    flux_msg_t *msg;
+
+    if (ov->rank == 0 || !ov->parent.event_filter)
+        return 0;
+    if (!(msg = flux_request_encode (name, NULL))
+        || flux_msg_pack (msg, "{s:s}", "topic", topic) < 0
+        || flux_msg_set_rolemask (msg, FLUX_ROLE_OWNER) < 0
+        || flux_msg_set_noresponse (msg) < 0
+        || overlay_sendmsg_parent (ov, msg) < 0) {
+        flux_msg_decref (msg);
+        return -1;
+    }
+    flux_msg_decref (msg);
+    return 0;
+}
+
+static int parent_subscribe_cb (const char *topic, void *arg)
+{
+    return parent_subscribe (arg, topic, "overlay.subscribe");
+}
+
+static int parent_unsubscribe_cb (const char *topic, void *arg)
+{
+    return parent_subscribe (arg, topic, "overlay.unsubscribe");
+}
+
+int overlay_event_subscribe (struct overlay *ov, const char *topic)
+{
+    if (!ov || !topic) {
+        errno = EINVAL;
+        return -1;
+    }
+    return subhash_subscribe (ov->event_sub, topic);
+}
+
+int overlay_event_unsubscribe (struct overlay *ov, const char *topic)
+{
+    if (!ov || !topic) {
+        errno = EINVAL;
+        return -1;
+    }
+    return subhash_unsubscribe (ov->event_sub, topic);
+}
+
+bool overlay_event_filtered (struct overlay *ov)
+{
+    return ov ? ov->parent.event_filter : false;
+}
+
 /* A child has sent an overlay.goodbye request.
  * Respond, then transition it to OFFLINE.
  */
@@ -1557,23 +1947,114 @@ static int child_rpc_track_count (struct overlay *ov)
     return count;
 }
 
+/* Accumulate stats of all child trackers into 'st'.
+ */
+static void child_rpc_track_stats (struct overlay *ov,
+                                   struct rpc_track_stats *st)
+{
+    struct rpc_track_stats cst;
+    int i;
+
+    for (i = 0; i < ov->child_count; i++) {
+        if (!ov->children[i].tracker)
+            continue;
+        rpc_track_get_stats (ov->children[i].tracker, &cst);
+        st->tracked += cst.tracked;
+        st->completed += cst.completed;
+        st->disconnected += cst.disconnected;
+        st->purged += cst.purged;
+        st->senders += cst.senders;
+    }
+}
+
+static json_t *child_stats (struct overlay *ov)
+{
+    json_t *array;
+    json_t *entry;
+    struct child *child;
+
+    if (!(array = json_array ()))
+        goto nomem;
+    foreach_overlay_child (ov, child) {
+        if (!(entry = json_pack ("{s:i s:I s:I s:I s:b s:i}",
+                                 "rank", child->rank,
+                                 "sent", (json_int_t)child->sent,
+                                 "dropped", (json_int_t)child->dropped,
+                                 "filtered", (json_int_t)child->filtered,
+                                 "congested", child->congested,
+                                 "rpc", rpc_track_count (child->tracker)))
+            || json_array_append_new (array, entry) < 0) {
+            json_decref (entry);
+            goto nomem;
+        }
+    }
+    return array;
+nomem:
+    json_decref (array);
+    errno = ENOMEM;
+    return NULL;
+}
+
 static void overlay_stats_get_cb (flux_t *h,
                                   flux_msg_handler_t *mh,
                                   const flux_msg_t *msg,
                                   void *arg)
 {
     struct overlay *ov = arg;
+    struct msgcompress_stats tx = { 0 };
+    struct msgcompress_stats rx = { 0 };
+    struct rpc_track_stats prpc = { 0 };
+    struct rpc_track_stats crpc = { 0 };
+    json_t *children = NULL;
 
-    if (flux_request_decode (msg, NULL, NULL) < 0)
+    if (flux_request_decode (msg, NULL, NULL) < 0
+        || !(children = child_stats (ov)))
         goto error;
+    msgcompress_get_stats (ov->compress, &tx, &rx);
+    rpc_track_get_stats (ov->parent.tracker, &prpc);
+    child_rpc_track_stats (ov, &crpc);
     if (flux_respond_pack (h,
                            msg,
-                           "{s:i s:i s:i s:i s:i}",
+                           "{s:i s:i s:i s:i s:i s:i s:i s:i s:b s:o"
+                           " s:{s:i s:{s:I s:I s:I} s:{s:I s:I s:I}}"
+                           " s:{s:{s:I s:I s:I s:I s:i}"
+                           " s:{s:I s:I s:I s:I s:i}}}",
                            "child-count", ov->child_count,
                            "child-connected", overlay_get_child_peer_count (ov),
                            "parent-count", ov->rank > 0 ? 1 : 0,
                            "parent-rpc", rpc_track_count (ov->parent.tracker),
-                           "child-rpc", child_rpc_track_count (ov)) < 0)
+                           "child-rpc", child_rpc_track_count (ov),
+                           "child-hwm", ov->child_hwm,
+                           "sockbuf", ov->sockbuf,
+                           "io-threads", ov->zctx
+                               ? zmq_ctx_get (ov->zctx, ZMQ_IO_THREADS) : 0,
+                           "event-filter", ov->event_filter,
+                           "children", children,
+                           "compress",
+                             "threshold", ov->compress_threshold,
+                             "tx",
+                               "count", (json_int_t)tx.count,
+                               "raw-bytes", (json_int_t)tx.raw_bytes,
+                               "compressed-bytes",
+                                 (json_int_t)tx.compressed_bytes,
+                             "rx",
+                               "count", (json_int_t)rx.count,
+                               "raw-bytes", (json_int_t)rx.raw_bytes,
+                               "compressed-bytes",
+                                 (json_int_t)rx.compressed_bytes,
+                           "rpc-track",
+                             "parent",
+                               "tracked", (json_int_t)prpc.tracked,
+                               "completed", (json_int_t)prpc.completed,
+                               "disconnected", (json_int_t)prpc.disconnected,
+                               "purged", (json_int_t)prpc.purged,
+                               "senders", prpc.senders,
+                             "child",
+                               "tracked", (json_int_t)crpc.tracked,
+                               "completed", (json_int_t)crpc.completed,
+                               "disconnected", (json_int_t)crpc.disconnected,
+                               "purged", (json_int_t)crpc.purged,
+                               "senders", crpc.senders) < 0)
         flux_log_error (h, "error responding to overlay.stats-get");
     return;
 error:
@@ -1605,10 +2086,11 @@ static int overlay_health_respond (struct overlay *ov, const flux_msg_t *msg)
     duration = monotime_since (ov->status_timestamp) / 1000.0;
     if (flux_respond_pack (ov->h,
                            msg,
-                           "{s:i s:s s:f s:O}",
+                           "{s:i s:s s:f s:f s:O}",
                            "rank", ov->rank,
                            "status", subtree_status_str (ov->status),
                            "duration", duration,
+                           "wireup", ov->wireup,
                            "children", array) < 0)
         flux_log_error (ov->h, "error responding to overlay.health");
     json_decref (array);
@@ -2082,6 +2564,175 @@ static int overlay_configure_zmqdebug (struct overlay *ov)
     return 0;
 }
 
+/* Configure tbon.child_hwm, the number of messages that may be queued to
+ * each TBON child before sends fail with EAGAIN.  A value of 0 (the default)
+ * means unlimited.
+ */
+static int overlay_configure_child_hwm (struct overlay *ov)
+{
+    const flux_conf_t *cf;
+
+    ov->child_hwm = 0;
+    if ((cf = flux_get_conf (ov->h))) {
+        flux_error_t error;
+
+        if (flux_conf_unpack (cf,
+                              &error,
+                              "{s?{s?i}}",
+                              "tbon",
+                                "child_hwm", &ov->child_hwm) < 0) {
+            log_msg ("Config file error [tbon]: %s", error.text);
+            return -1;
+        }
+    }
+    if (overlay_configure_attr_int (ov->attrs,
+                                    "tbon.child_hwm",
+                                    ov->child_hwm,
+                                    &ov->child_hwm) < 0)
+        return -1;
+    if (ov->child_hwm < 0) {
+        log_msg ("tbon.child_hwm must be >= 0");
+        errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
+
+/* Configure tbon.io_threads, the number of zeromq I/O threads.
+ * A value of 0 (the default) selects a number based on the TBON fanout.
+ */
+static int overlay_configure_io_threads (struct overlay *ov)
+{
+    const flux_conf_t *cf;
+
+    ov->io_threads = 0;
+    if ((cf = flux_get_conf (ov->h))) {
+        flux_error_t error;
+
+        if (flux_conf_unpack (cf,
+                              &error,
+                              "{s?{s?i}}",
+                              "tbon",
+                                "io_threads", &ov->io_threads) < 0) {
+            log_msg ("Config file error [tbon]: %s", error.text);
+            return -1;
+        }
+    }
+    if (overlay_configure_attr_int (ov->attrs,
+                                    "tbon.io_threads",
+                                    ov->io_threads,
+                                    &ov->io_threads) < 0)
+        return -1;
+    if (ov->io_threads < 0) {
+        log_msg ("tbon.io_threads must be >= 0");
+        errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
+
+/* Configure tbon.sockbuf, the kernel send and receive buffer size in bytes
+ * for overlay sockets.  Larger buffers let bulk transfers keep a fast link
+ * busy.  A value of 0 (the default) leaves the OS default in place.
+ */
+static int overlay_configure_sockbuf (struct overlay *ov)
+{
+    const flux_conf_t *cf;
+
+    ov->sockbuf = 0;
+    if ((cf = flux_get_conf (ov->h))) {
+        flux_error_t error;
+
+        if (flux_conf_unpack (cf,
+                              &error,
+                              "{s?{s?i}}",
+                              "tbon",
+                                "sockbuf", &ov->sockbuf) < 0) {
+            log_msg ("Config file error [tbon]: %s", error.text);
+            return -1;
+        }
+    }
+    if (overlay_configure_attr_int (ov->attrs,
+                                    "tbon.sockbuf",
+                                    ov->sockbuf,
+                                    &ov->sockbuf) < 0)
+        return -1;
+    if (ov->sockbuf < 0) {
+        log_msg ("tbon.sockbuf must be >= 0");
+        errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
+
+/* Configure tbon.compress_threshold.  Payloads of at least this many bytes
+ * are LZ4 compressed on connections where both peers enable it.
+ * A value of 0 (the default) disables compression.
+ */
+static int overlay_configure_compress (struct overlay *ov)
+{
+    const flux_conf_t *cf;
+
+    ov->compress_threshold = 0;
+    if ((cf = flux_get_conf (ov->h))) {
+        flux_error_t error;
+
+        if (flux_conf_unpack (cf,
+                              &error,
+                              "{s?{s?i}}",
+                              "tbon",
+                                "compress_threshold",
+                                &ov->compress_threshold) < 0) {
+            log_msg ("Config file error [tbon]: %s", error.text);
+            return -1;
+        }
+    }
+    if (overlay_configure_attr_int (ov->attrs,
+                                    "tbon.compress_threshold",
+                                    ov->compress_threshold,
+                                    &ov->compress_threshold) < 0)
+        return -1;
+    if (ov->compress_threshold < 0) {
+        log_msg ("tbon.compress_threshold must be >= 0");
+        errno = EINVAL;
+        return -1;
+    }
+    if (ov->compress_threshold > 0) {
+        if (!(ov->compress = msgcompress_create (ov->compress_threshold)))
+            return -1;
+    }
+    return 0;
+}
+
+/* Configure tbon.event_filter, which if nonzero, suppresses events sent to
+ * child subtrees that have no matching subscription.
+ */
+static int overlay_configure_event_filter (struct overlay *ov)
+{
+    const flux_conf_t *cf;
+
+    ov->event_filter = 0;
+    if ((cf = flux_get_conf (ov->h))) {
+        flux_error_t error;
+
+        if (flux_conf_unpack (cf,
+                              &error,
+                              "{s?{s?b}}",
+                              "tbon",
+                                "event_filter",
+                                &ov->event_filter) < 0) {
+            log_msg ("Config file error [tbon]: %s", error.text);
+            return -1;
+        }
+    }
+    if (overlay_configure_attr_int (ov->attrs,
+                                    "tbon.event_filter",
+                                    ov->event_filter,
+                                    &ov->event_filter) < 0)
+        return -1;
+    return 0;
+}
+
 /* Configure tbon.topo attribute.
  * Ascending precedence: compiled-in default, TOML config, command line.
  * Topology creation is deferred to bootstrap, when we know the instance size.
@@ -2130,6 +2781,11 @@ void overlay_destroy (struct overlay *ov)
         int saved_errno = errno;
 
         flux_msglist_destroy (ov->health_requests);
+        flux_watcher_destroy (ov->status_w);
+
+        /* Don't send unsubscribes upstream during teardown.
+         */
+        subhash_set_unsubscribe (ov->event_sub, NULL, NULL);
 
         cert_destroy (ov->cert);
         zmqutil_zap_destroy (ov->zap);
@@ -2154,8 +2810,10 @@ void overlay_destroy (struct overlay *ov)
         zhashx_destroy (&ov->child_hash);
         if (ov->children) {
             int i;
-            for (i = 0; i < ov->child_count; i++)
+            for (i = 0; i < ov->child_count; i++) {
                 rpc_track_destroy (ov->children[i].tracker);
+                subhash_destroy (ov->children[i].event_sub);
+            }
             free (ov->children);
         }
         rpc_track_destroy (ov->parent.tracker);
@@ -2166,7 +2824,9 @@ void overlay_destroy (struct overlay *ov)
                 free (mon);
             zlist_destroy (&ov->monitor_callbacks);
         }
+        subhash_destroy (ov->event_sub);
         topology_decref (ov->topo);
+        msgcompress_destroy (ov->compress);
         if (!ov->zctx_external)
             zmq_ctx_term (ov->zctx);
         free (ov);
@@ -2211,6 +2871,18 @@ static const struct flux_msg_handler_spec htab[] = {
         overlay_goodbye_cb,
         0,
     },
+    {
+        FLUX_MSGTYPE_REQUEST,
+        "overlay.subscribe",
+        overlay_subscribe_cb,
+        0,
+    },
+    {
+        FLUX_MSGTYPE_REQUEST,
+        "overlay.unsubscribe",
+        overlay_subscribe_cb,
+        0,
+    },
     {
         FLUX_MSGTYPE_RESPONSE,
         "overlay.goodbye",
@@ -2239,6 +2911,8 @@ struct overlay *overlay_create (flux_t *h,
     ov->recv_cb = cb;
     ov->recv_arg = arg;
     ov->version = FLUX_CORE_VERSION_HEX;
+    ov->wireup = -1;
+    monotime (&ov->create_timestamp);
     uuid_generate (uuid);
     uuid_unparse (uuid, ov->uuid);
     if (zctx) {
@@ -2267,6 +2941,20 @@ struct overlay *overlay_create (flux_t *h,
         goto error;
     if (overlay_configure_zmqdebug (ov) < 0)
         goto error;
+    if (overlay_configure_compress (ov) < 0)
+        goto error;
+    if (overlay_configure_child_hwm (ov) < 0)
+        goto error;
+    if (overlay_configure_io_threads (ov) < 0)
+        goto error;
+    if (overlay_configure_sockbuf (ov) < 0)
+        goto error;
+    if (overlay_configure_event_filter (ov) < 0)
+        goto error;
+    if (!(ov->event_sub = subhash_create ()))
+        goto error;
+    subhash_set_subscribe (ov->event_sub, parent_subscribe_cb, ov);
+    subhash_set_unsubscribe (ov->event_sub, parent_unsubscribe_cb, ov);
     if (overlay_configure_topo (ov) < 0)
         goto error;
     if (flux_msg_handler_addvec (h, htab, ov, &ov->handlers) < 0)
@@ -2275,6 +2963,10 @@ struct overlay *overlay_create (flux_t *h,
         goto nomem;
     if (!(ov->health_requests = flux_msglist_create ()))
         goto error;
+    if (!(ov->status_w = flux_prepare_watcher_create (ov->reactor,
+                                                      status_prep_cb,
+                                                      ov)))
+        goto error;
     if (!(ov->parent.f_goodbye = flux_future_create (NULL, NULL)))
         goto error;
     flux_future_set_flux (ov->parent.f_goodbye, h);
@@ -121,6 +121,18 @@ const char *overlay_get_subtree_status (struct overlay *ov, int rank);
  */
 bool overlay_peer_is_torpid (struct overlay *ov, uint32_t rank);
 
+/* Register event subscriptions of this broker and its modules.  If the
+ * parent filters events by subscription (tbon.event_filter), the combined
+ * subscriptions of this broker's subtree are passed upstream.
+ */
+int overlay_event_subscribe (struct overlay *ov, const char *topic);
+int overlay_event_unsubscribe (struct overlay *ov, const char *topic);
+
+/* Return true if the parent only forwards events that match a
+ * subscription in this subtree, so event sequence gaps are expected.
+ */
+bool overlay_event_filtered (struct overlay *ov);
+
 /* Broker should call overlay_bind() if there are children.  This may happen
  * before any peers are authorized as long as they are authorized before they
  * try to connect.
@@ -0,0 +1,150 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <flux/core.h>
+
+#include "src/common/libtap/tap.h"
+#include "ccan/str/str.h"
+#include "src/broker/msgcompress.h"
+
+static flux_msg_t *create_msg (const void *data, int size)
+{
+    flux_msg_t *msg;
+
+    if (!(msg = flux_msg_create (FLUX_MSGTYPE_REQUEST))
+        || flux_msg_set_topic (msg, "a.b") < 0
+        || flux_msg_set_payload (msg, data, size) < 0)
+        BAIL_OUT ("error creating test message");
+    return msg;
+}
+
+static void check_payload (const flux_msg_t *msg,
+                           const void *data,
+                           int size,
+                           const char *desc)
+{
+    const void *buf;
+    int len;
+
+    ok (flux_msg_get_payload (msg, &buf, &len) == 0
+        && len == size
+        && memcmp (buf, data, size) == 0,
+        "%s", desc);
+}
+
+static void check_roundtrip (void)
+{
+    struct msgcompress *mc;
+    struct msgcompress_stats tx, rx;
+    flux_msg_t *msg;
+    flux_msg_t *cmsg;
+    char *buf;
+    int size = 8192;
+    const char *topic;
+    const void *cbuf;
+    int csize;
+
+    if (!(buf = malloc (size)))
+        BAIL_OUT ("out of memory");
+    memset (buf, 'x', size);
+
+    ok ((mc = msgcompress_create (1024)) != NULL,
+        "msgcompress_create works");
+
+    msg = create_msg ("small", 5);
+    cmsg = NULL;
+    ok (msgcompress_encode (mc, msg, &cmsg) == 0 && cmsg == NULL,
+        "msgcompress_encode leaves a payload under the threshold alone");
+    flux_msg_destroy (msg);
+
+    msg = create_msg (buf, size);
+    ok (msgcompress_encode (mc, msg, &cmsg) == 0 && cmsg != NULL,
+        "msgcompress_encode compresses a large payload");
+    ok (flux_msg_get_payload (cmsg, &cbuf, &csize) == 0
+        && csize < size
+        && memcmp (cbuf, MSGCOMPRESS_MAGIC, MSGCOMPRESS_MAGIC_SIZE) == 0,
+        "compressed payload is smaller and starts with magic");
+    ok (flux_msg_get_topic (cmsg, &topic) == 0 && streq (topic, "a.b"),
+        "compressed message retains topic");
+    ok (msgcompress_decode (mc, cmsg) == 0,
+        "msgcompress_decode works");
+    check_payload (cmsg, buf, size, "decompressed payload matches original");
+    ok (msgcompress_decode (mc, cmsg) == 0,
+        "msgcompress_decode on an uncompressed message is a no-op");
+    check_payload (cmsg, buf, size, "payload is unchanged");
+
+    msgcompress_get_stats (mc, &tx, &rx);
+    ok (tx.count == 1
+        && tx.raw_bytes == size
+        && tx.compressed_bytes == csize
+        && rx.count == 1
+        && rx.raw_bytes == size
+        && rx.compressed_bytes == csize,
+        "msgcompress_get_stats reports compressed and raw bytes");
+    flux_msg_destroy (cmsg);
+    flux_msg_destroy (msg);
+
+    /* Raw payload that mimics the magic must be wrapped even when small.
+     */
+    memcpy (buf, MSGCOMPRESS_MAGIC, MSGCOMPRESS_MAGIC_SIZE);
+    msg = create_msg (buf, 16);
+    ok (msgcompress_encode (mc, msg, &cmsg) == 0 && cmsg != NULL,
+        "msgcompress_encode wraps a small payload that starts with magic");
+    ok (msgcompress_decode (mc, cmsg) == 0,
+        "msgcompress_decode works");
+    check_payload (cmsg, buf, 16, "payload starting with magic round trips");
+    flux_msg_destroy (cmsg);
+    flux_msg_destroy (msg);
+
+    /* Malformed compressed payloads fail with EPROTO.
+     */
+    msg = create_msg (MSGCOMPRESS_MAGIC "\0\0\0\x10" "garbage", 15);
+    errno = 0;
+    ok (msgcompress_decode (mc, msg) < 0 && errno == EPROTO,
+        "msgcompress_decode fails with EPROTO on bad LZ4 data");
+    flux_msg_destroy (msg);
+    msg = create_msg (MSGCOMPRESS_MAGIC "\0", 5);
+    errno = 0;
+    ok (msgcompress_decode (mc, msg) < 0 && errno == EPROTO,
+        "msgcompress_decode fails with EPROTO on truncated header");
+    flux_msg_destroy (msg);
+
+    errno = 0;
+    ok (msgcompress_encode (NULL, NULL, &cmsg) < 0 && errno == EINVAL,
+        "msgcompress_encode mc=NULL fails with EINVAL");
+    errno = 0;
+    ok (msgcompress_decode (NULL, NULL) < 0 && errno == EINVAL,
+        "msgcompress_decode mc=NULL fails with EINVAL");
+    lives_ok ({msgcompress_destroy (NULL);},
+              "msgcompress_destroy NULL doesn't crash");
+
+    msgcompress_destroy (mc);
+    free (buf);
+}
+
+int main (int argc, char *argv[])
+{
+    plan (NO_PLAN);
+
+    check_roundtrip ();
+
+    done_testing ();
+    return 0;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
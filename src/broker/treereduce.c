@@ -0,0 +1,590 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* treereduce.c - gather and reduce responses over a TBON subtree
+ *
+ * A treereduce.run request names a service method, an optional payload
+ * for it, and a reduction operator.  The broker that receives it forwards
+ * the treereduce.run request to each of its TBON children and sends the
+ * method request to itself.  Once all have responded, it combines the
+ * results with the operator and responds once.  Applied recursively, the
+ * requester receives a single response covering the whole subtree rooted
+ * at the target broker, and no broker handles more than 1 + fanout
+ * responses, instead of the root handling one per rank.
+ *
+ * Request:
+ *   {"topic":s "op":s "payload"?o "key"?s}
+ *
+ * Response:
+ *   {"value":o "ranks":s "errors":s}
+ *
+ * If "key" is set, that member of each method response is reduced,
+ * otherwise the entire response payload is.  "value" is null if no rank
+ * contributed.  "ranks" is the idset of contributing ranks. "errors" is
+ * the idset of ranks whose method request failed, whose response could not
+ * be reduced, or that could not be reached.
+ *
+ * Operators:
+ *   idset        union of RFC 22 idset strings
+ *   merge        shallow merge of objects
+ *   concat       concatenation of strings, in TBON pre-order
+ *   sum/min/max  of numbers (integer unless a real is encountered)
+ *
+ * N.B. the method request is sent with instance owner credentials,
+ * so treereduce.run is restricted to the instance owner.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include <jansson.h>
+#include <flux/core.h>
+
+#include "src/common/libidset/idset.h"
+#include "src/common/libutil/errno_safe.h"
+#include "src/common/libczmqcontainers/czmq_containers.h"
+#include "ccan/str/str.h"
+
+#include "overlay.h"
+#include "treereduce.h"
+
+typedef int (*reduce_f)(json_t **acc, json_t *value);
+
+struct reduce_op {
+    const char *name;
+    reduce_f reduce;
+};
+
+struct slot {
+    flux_future_t *f;
+    struct idset *subtree;  // ranks reached through this slot
+    json_t *value;
+    struct idset *ranks;
+    struct idset *errors;
+};
+
+struct reduction {
+    struct treereduce *tr;
+    const flux_msg_t *request;
+    const struct reduce_op *op;
+    const char *key;
+    int count;
+    int pending;
+    struct slot slots[];
+};
+
+struct treereduce {
+    struct broker *ctx;
+    flux_msg_handler_t **handlers;
+    zlistx_t *reductions;
+};
+
+static int reduce_idset (json_t **acc, json_t *value)
+{
+    struct idset *ids;
+    char *s;
+    json_t *o;
+
+    if (!json_is_string (value)
+        || !(ids = idset_decode (*acc ? json_string_value (*acc) : "")))
+        goto inval;
+    if (idset_decode_add (ids, json_string_value (value), -1, NULL) < 0) {
+        idset_destroy (ids);
+        goto inval;
+    }
+    s = idset_encode (ids, IDSET_FLAG_RANGE);
+    idset_destroy (ids);
+    if (!s || !(o = json_string (s))) {
+        free (s);
+        errno = ENOMEM;
+        return -1;
+    }
+    free (s);
+    json_decref (*acc);
+    *acc = o;
+    return 0;
+inval:
+    errno = EPROTO;
+    return -1;
+}
+
+static int reduce_merge (json_t **acc, json_t *value)
+{
+    if (!json_is_object (value)) {
+        errno = EPROTO;
+        return -1;
+    }
+    if (!*acc) {
+        if (!(*acc = json_copy (value)))
+            goto nomem;
+        return 0;
+    }
+    if (json_object_update (*acc, value) < 0)
+        goto nomem;
+    return 0;
+nomem:
+    errno = ENOMEM;
+    return -1;
+}
+
+static int reduce_concat (json_t **acc, json_t *value)
+{
+    size_t len1 = *acc ? json_string_length (*acc) : 0;
+    size_t len2;
+    char *s;
+    json_t *o;
+
+    if (!json_is_string (value)) {
+        errno = EPROTO;
+        return -1;
+    }
+    len2 = json_string_length (value);
+    if (!(s = malloc (len1 + len2 + 1)))
+        return -1;
+    if (len1 > 0)
+        memcpy (s, json_string_value (*acc), len1);
+    memcpy (s + len1, json_string_value (value), len2);
+    o = json_stringn (s, len1 + len2);
+    free (s);
+    if (!o) {
+        errno = ENOMEM;
+        return -1;
+    }
+    json_decref (*acc);
+    *acc = o;
+    return 0;
+}
+
+/* Combine two numbers with 'fn' ('+', '<', or '>'), keeping an integer
+ * result as long as both operands are integers.
+ */
+static int reduce_number (json_t **acc, json_t *value, char fn)
+{
+    json_t *o;
+
+    if (!json_is_number (value)) {
+        errno = EPROTO;
+        return -1;
+    }
+    if (!*acc) {
+        *acc = json_incref (value);
+        return 0;
+    }
+    if (json_is_integer (*acc) && json_is_integer (value)) {
+        json_int_t a = json_integer_value (*acc);
+        json_int_t b = json_integer_value (value);
+        json_int_t r;
+
+        if (fn == '+')
+            r = a + b;
+        else if (fn == '<')
+            r = a < b ? a : b;
+        else
+            r = a > b ? a : b;
+        o = json_integer (r);
+    }
+    else {
+        double a = json_number_value (*acc);
+        double b = json_number_value (value);
+        double r;
+
+        if (fn == '+')
+            r = a + b;
+        else if (fn == '<')
+            r = a < b ? a : b;
+        else
+            r = a > b ? a : b;
+        o = json_real (r);
+    }
+    if (!o) {
+        errno = ENOMEM;
+        return -1;
+    }
+    json_decref (*acc);
+    *acc = o;
+    return 0;
+}
+
+static int reduce_sum (json_t **acc, json_t *value)
+{
+    return reduce_number (acc, value, '+');
+}
+
+static int reduce_min (json_t **acc, json_t *value)
+{
+    return reduce_number (acc, value, '<');
+}
+
+static int reduce_max (json_t **acc, json_t *value)
+{
+    return reduce_number (acc, value, '>');
+}
+
+static const struct reduce_op ops[] = {
+    { "idset", reduce_idset },
+    { "merge", reduce_merge },
+    { "concat", reduce_concat },
+    { "sum", reduce_sum },
+    { "min", reduce_min },
+    { "max", reduce_max },
+};
+
+static const struct reduce_op *reduce_op_lookup (const char *name)
+{
+    int i;
+
+    for (i = 0; i < sizeof (ops) / sizeof (ops[0]); i++) {
+        if (streq (ops[i].name, name))
+            return &ops[i];
+    }
+    return NULL;
+}
+
+static void reduction_destroy (struct reduction *red)
+{
+    if (red) {
+        int saved_errno = errno;
+        int i;
+        for (i = 0; i < red->count; i++) {
+            flux_future_destroy (red->slots[i].f);
+            idset_destroy (red->slots[i].subtree);
+            json_decref (red->slots[i].value);
+            idset_destroy (red->slots[i].ranks);
+            idset_destroy (red->slots[i].errors);
+        }
+        flux_msg_decref (red->request);
+        free (red);
+        errno = saved_errno;
+    }
+}
+
+static void reduction_destructor (void **item)
+{
+    if (item) {
+        reduction_destroy (*item);
+        *item = NULL;
+    }
+}
+
+/* All slots have completed.  Reduce them in order and respond.
+ */
+static void reduction_finish (struct reduction *red)
+{
+    flux_t *h = red->tr->ctx->h;
+    struct idset *ranks;
+    struct idset *errors;
+    char *ranks_s = NULL;
+    char *errors_s = NULL;
+    json_t *acc = NULL;
+    int i;
+
+    if (!(ranks = idset_create (0, IDSET_FLAG_AUTOGROW))
+        || !(errors = idset_create (0, IDSET_FLAG_AUTOGROW)))
+        goto error;
+    for (i = 0; i < red->count; i++) {
+        struct slot *slot = &red->slots[i];
+
+        if (slot->errors && idset_add (errors, slot->errors) < 0)
+            goto error;
+        if (!slot->value || json_is_null (slot->value))
+            continue;
+        if (red->op->reduce (&acc, slot->value) < 0) {
+            if (errno != EPROTO)
+                goto error;
+            if (idset_add (errors, slot->ranks) < 0)
+                goto error;
+        }
+        else if (idset_add (ranks, slot->ranks) < 0)
+            goto error;
+    }
+    if (!(ranks_s = idset_encode (ranks, IDSET_FLAG_RANGE))
+        || !(errors_s = idset_encode (errors, IDSET_FLAG_RANGE)))
+        goto error;
+    if (flux_respond_pack (h,
+                           red->request,
+                           "{s:O s:s s:s}",
+                           "value", acc ? acc : json_null (),
+                           "ranks", ranks_s,
+                           "errors", errors_s) < 0)
+        flux_log_error (h, "error responding to treereduce.run");
+    goto done;
+error:
+    if (flux_respond_error (h, red->request, errno, NULL) < 0)
+        flux_log_error (h, "error responding to treereduce.run");
+done:
+    free (ranks_s);
+    free (errors_s);
+    json_decref (acc);
+    idset_destroy (ranks);
+    idset_destroy (errors);
+}
+
+static void reduction_complete_slot (struct reduction *red)
+{
+    if (--red->pending == 0) {
+        void *cursor;
+
+        reduction_finish (red);
+        if ((cursor = zlistx_find (red->tr->reductions, red)))
+            zlistx_delete (red->tr->reductions, cursor);
+    }
+}
+
+static void local_continuation (flux_future_t *f, void *arg)
+{
+    struct reduction *red = arg;
+    struct slot *slot = flux_future_aux_get (f, "treereduce::slot");
+    json_t *o;
+    json_t *value;
+
+    if (flux_rpc_get_unpack (f, "o", &o) < 0)
+        goto error;
+    if (red->key) {
+        if (!(value = json_object_get (o, red->key)))
+            goto error;
+    }
+    else
+        value = o;
+    if (!(slot->ranks = idset_copy (slot->subtree)))
+        goto error;
+    slot->value = json_incref (value);
+    reduction_complete_slot (red);
+    return;
+error:
+    slot->errors = idset_copy (slot->subtree);
+    reduction_complete_slot (red);
+}
+
+static void child_continuation (flux_future_t *f, void *arg)
+{
+    struct reduction *red = arg;
+    struct slot *slot = flux_future_aux_get (f, "treereduce::slot");
+    json_t *value;
+    const char *ranks;
+    const char *errors;
+
+    if (flux_rpc_get_unpack (f,
+                             "{s:o s:s s:s}",
+                             "value", &value,
+                             "ranks", &ranks,
+                             "errors", &errors) < 0
+        || !(slot->ranks = idset_decode (ranks))
+        || !(slot->errors = idset_decode (errors))) {
+        idset_destroy (slot->ranks);
+        idset_destroy (slot->errors);
+        slot->ranks = NULL;
+        slot->errors = idset_copy (slot->subtree);
+    }
+    else
+        slot->value = json_incref (value);
+    reduction_complete_slot (red);
+}
+
+static int add_subtree_ranks (struct idset *ids, json_t *topo)
+{
+    int rank;
+    json_t *children;
+    size_t index;
+    json_t *child;
+
+    if (json_unpack (topo,
+                     "{s:i s:o}",
+                     "rank", &rank,
+                     "children", &children) < 0) {
+        errno = EPROTO;
+        return -1;
+    }
+    if (idset_set (ids, rank) < 0)
+        return -1;
+    json_array_foreach (children, index, child) {
+        if (add_subtree_ranks (ids, child) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/* Send the request for one slot.  If it cannot be sent, the slot is
+ * completed immediately with its subtree in the error set.
+ */
+static int slot_start (struct reduction *red,
+                       int index,
+                       uint32_t rank,
+                       const char *topic,
+                       json_t *payload,
+                       flux_continuation_f cb)
+{
+    flux_t *h = red->tr->ctx->h;
+    struct slot *slot = &red->slots[index];
+
+    if (payload)
+        slot->f = flux_rpc_pack (h, topic, rank, 0, "O", payload);
+    else
+        slot->f = flux_rpc (h, topic, NULL, rank, 0);
+    if (!slot->f
+        || flux_future_aux_set (slot->f, "treereduce::slot", slot, NULL) < 0
+        || flux_future_then (slot->f, -1., cb, red) < 0) {
+        flux_future_destroy (slot->f);
+        slot->f = NULL;
+        if (!(slot->errors = idset_copy (slot->subtree)))
+            return -1;
+        red->pending--;
+    }
+    return 0;
+}
+
+static void run_cb (flux_t *h,
+                    flux_msg_handler_t *mh,
+                    const flux_msg_t *msg,
+                    void *arg)
+{
+    struct treereduce *tr = arg;
+    uint32_t rank = tr->ctx->rank;
+    const char *topic;
+    const char *opname;
+    json_t *payload = NULL;
+    const char *key = NULL;
+    const char *errmsg = NULL;
+    const struct reduce_op *op;
+    json_t *topo = NULL;
+    json_t *children;
+    json_t *child;
+    json_t *req = NULL;
+    struct reduction *red = NULL;
+    size_t index;
+
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s:s s:s s?o s?s}",
+                             "topic", &topic,
+                             "op", &opname,
+                             "payload", &payload,
+                             "key", &key) < 0)
+        goto error;
+    if (!(op = reduce_op_lookup (opname))) {
+        errmsg = "unknown reduction operator";
+        errno = EINVAL;
+        goto error;
+    }
+    if (!(topo = overlay_get_subtree_topo (tr->ctx->overlay, rank))
+        || !(children = json_object_get (topo, "children"))
+        || !json_is_array (children))
+        goto error;
+    if (!(red = calloc (1, sizeof (*red)
+                           + (json_array_size (children) + 1)
+                           * sizeof (red->slots[0]))))
+        goto error;
+    red->tr = tr;
+    red->request = flux_msg_incref (msg);
+    red->op = op;
+    red->key = key;
+    red->count = red->pending = json_array_size (children) + 1;
+
+    if (!(red->slots[0].subtree = idset_create (0, IDSET_FLAG_AUTOGROW))
+        || idset_set (red->slots[0].subtree, rank) < 0)
+        goto error;
+    json_array_foreach (children, index, child) {
+        if (!(red->slots[index + 1].subtree = idset_create (0,
+                                                      IDSET_FLAG_AUTOGROW))
+            || add_subtree_ranks (red->slots[index + 1].subtree, child) < 0)
+            goto error;
+    }
+    if (!(req = json_pack ("{s:s s:s}", "topic", topic, "op", opname))
+        || (payload && json_object_set (req, "payload", payload) < 0)
+        || (key && json_object_set_new (req, "key", json_string (key)) < 0)) {
+        errno = ENOMEM;
+        goto error;
+    }
+    if (!zlistx_add_end (tr->reductions, red)) {
+        errno = ENOMEM;
+        goto error;
+    }
+    if (slot_start (red, 0, rank, topic, payload, local_continuation) < 0)
+        goto error_listed;
+    json_array_foreach (children, index, child) {
+        int child_rank;
+
+        if (json_unpack (child, "{s:i}", "rank", &child_rank) < 0
+            || slot_start (red,
+                           index + 1,
+                           child_rank,
+                           "treereduce.run",
+                           req,
+                           child_continuation) < 0)
+            goto error_listed;
+    }
+    /* Every slot may have failed to start.
+     */
+    red->pending++;
+    reduction_complete_slot (red);
+    json_decref (req);
+    json_decref (topo);
+    return;
+error_listed:
+    /* Outstanding futures are destroyed with the reduction.
+     */
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        flux_log_error (h, "error responding to treereduce.run");
+    zlistx_delete (tr->reductions, zlistx_find (tr->reductions, red));
+    json_decref (req);
+    json_decref (topo);
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, errmsg) < 0)
+        flux_log_error (h, "error responding to treereduce.run");
+    ERRNO_SAFE_WRAP (json_decref, req);
+    ERRNO_SAFE_WRAP (json_decref, topo);
+    reduction_destroy (red);
+}
+
+static const struct flux_msg_handler_spec htab[] = {
+    {   FLUX_MSGTYPE_REQUEST,
+        "treereduce.run",
+        run_cb,
+        0
+    },
+    FLUX_MSGHANDLER_TABLE_END,
+};
+
+void treereduce_destroy (struct treereduce *tr)
+{
+    if (tr) {
+        int saved_errno = errno;
+        flux_msg_handler_delvec (tr->handlers);
+        zlistx_destroy (&tr->reductions);
+        free (tr);
+        errno = saved_errno;
+    }
+}
+
+struct treereduce *treereduce_create (struct broker *ctx)
+{
+    struct treereduce *tr;
+
+    if (!(tr = calloc (1, sizeof (*tr))))
+        return NULL;
+    tr->ctx = ctx;
+    if (!(tr->reductions = zlistx_new ())) {
+        errno = ENOMEM;
+        goto error;
+    }
+    zlistx_set_destructor (tr->reductions, reduction_destructor);
+    if (flux_msg_handler_addvec (ctx->h, htab, tr, &tr->handlers) < 0)
+        goto error;
+    return tr;
+error:
+    treereduce_destroy (tr);
+    return NULL;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,21 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _BROKER_TREEREDUCE_H
+#define _BROKER_TREEREDUCE_H
+
+#include "broker.h"
+
+struct treereduce *treereduce_create (struct broker *ctx);
+void treereduce_destroy (struct treereduce *tr);
+
+#endif // !_BROKER_TREEREDUCE_H
+
+// vi:ts=4 sw=4 expandtab
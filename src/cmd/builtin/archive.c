@@ -40,6 +40,8 @@ static void unmap_archive (flux_t *h, const char *name);
 
 static const char *default_chunksize = "1M";
 static const char *default_small_file_threshold = "1K";
+static const int default_window = 64;
+static const int max_default_threads = 16;
 const char *default_archive_hashtype = "sha1";
 const char *default_name = "main";
 
@@ -72,8 +74,66 @@ struct create_ctx {
     json_t *archive;
     flux_kvs_txn_t *txn;
     int preserve_seq;
+    int window;
+    flux_future_t **stores;     // ring of up to 'window' pending stores
+    int stores_head;
+    int stores_count;
 };
 
+/* Wait for the oldest pending content store and check that the blobref
+ * returned matches the one recorded in the fileref.
+ */
+static void store_retire (struct create_ctx *ctx)
+{
+    flux_future_t *f = ctx->stores[ctx->stores_head];
+    const char *path = flux_future_aux_get (f, "path");
+    const char *expected = flux_future_aux_get (f, "blobref");
+    const char *blobref;
+
+    if (content_store_get_blobref (f, ctx->param.hashtype, &blobref) < 0)
+        log_msg_exit ("%s: error storing blob: %s",
+                      path,
+                      future_strerror (f, errno));
+    if (!streq (blobref, expected))
+        log_msg_exit ("%s: content store returned unexpected blobref %s",
+                      path,
+                      blobref);
+    flux_future_destroy (f);
+    ctx->stores_head = (ctx->stores_head + 1) % ctx->window;
+    ctx->stores_count--;
+}
+
+static void store_drain (struct create_ctx *ctx)
+{
+    while (ctx->stores_count > 0)
+        store_retire (ctx);
+}
+
+/* Start storing a blob, retiring the oldest pending store first if the
+ * window is full.  The blob is copied into the request message, so the
+ * caller may unmap it as soon as this returns.
+ */
+static void store_blob (struct create_ctx *ctx,
+                        const char *path,
+                        const void *data,
+                        int size,
+                        const char *blobref)
+{
+    flux_future_t *f;
+    char *cpy = NULL;
+    char *pathcpy = NULL;
+
+    if (ctx->stores_count == ctx->window)
+        store_retire (ctx);
+    if (!(f = content_store (ctx->h, data, size, 0))
+        || !(cpy = strdup (blobref))
+        || flux_future_aux_set (f, "blobref", cpy, free) < 0
+        || !(pathcpy = strdup (path))
+        || flux_future_aux_set (f, "path", pathcpy, free) < 0)
+        log_err_exit ("%s: error storing blob", path);
+    ctx->stores[(ctx->stores_head + ctx->stores_count++) % ctx->window] = f;
+}
+
 /* Request that the content module mmap(2) the file at 'path', providing
  * the same 'chunksize' as was used to create the RFC 37 fileref below,
  * so that all the same blobrefs are created and made available in the cache.
@@ -102,6 +162,7 @@ static void mmap_fileref_data (struct create_ctx *ctx, const char *path)
 }
 
 /* Store the blobs of an RFC 37 blobvec-encoded fileref to the content store.
+ * Stores are pipelined and may still be pending when this returns.
  * If the --preserve option was specified, create a KVS reference to each
  * blob (added to the pending KVS transaction).
  */
@@ -121,20 +182,13 @@ static void store_fileref_data (struct create_ctx *ctx,
             const char *blobref;
             json_int_t size;
             json_int_t offset;
-            flux_future_t *f;
 
             if (json_unpack (entry, "[I,I,s]", &offset, &size, &blobref) < 0)
                 log_msg_exit ("%s: error decoding fileref object data", path);
             if (offset + size > mapinfo->size)
                 log_msg_exit ("%s: fileref offset exceeds file size", path);
 
-            // store blob (synchronously)
-            if (!(f = content_store (ctx->h, mapinfo->base + offset, size, 0))
-                || flux_rpc_get (f, NULL) < 0)
-                log_msg_exit ("%s: error storing blob: %s",
-                              path,
-                              future_strerror (f, errno));
-            flux_future_destroy (f);
+            store_blob (ctx, path, mapinfo->base + offset, size, blobref);
 
             /* Optionally store a KVS key that references blob for --preserve.
              * N.B. we don't attempt to combine blobrefs that belong to the
@@ -163,7 +217,7 @@ static void store_fileref_data (struct create_ctx *ctx,
 }
 
 /* Create an RFC 37 fileref object for 'path', and append it to ctx->archive.
- * Then synchronously store any blobs to the content store if the file is not
+ * Then start storing any blobs to the content store if the file is not
  * fully contained in the fileref.
  */
 static void add_archive_file (struct create_ctx *ctx, const char *path)
@@ -211,6 +265,7 @@ static int subcmd_create (optparse_t *p, int ac, char *av[])
     const char *s;
     char *hashtype;
     char *key;
+    long ncpus;
 
     memset (&ctx, 0, sizeof (ctx));
 
@@ -246,6 +301,21 @@ static int subcmd_create (optparse_t *p, int ac, char *av[])
     ctx.param.small_file_threshold = optparse_get_size_int (p,
                                                  "small-file-threshold",
                                                  default_small_file_threshold);
+    if ((ctx.window = optparse_get_int (p, "window", default_window)) < 1)
+        log_msg_exit ("--window must be at least 1");
+    if (!(ctx.stores = calloc (ctx.window, sizeof (ctx.stores[0]))))
+        log_msg_exit ("out of memory");
+    if ((ncpus = sysconf (_SC_NPROCESSORS_ONLN)) < 1)
+        ncpus = 1;
+    if (ncpus > max_default_threads)
+        ncpus = max_default_threads;
+    if ((ctx.param.threads = optparse_get_int (p, "threads", ncpus)) < 1)
+        log_msg_exit ("--threads must be at least 1");
+    s = optparse_get_str (p, "chunking", "fixed");
+    if (streq (s, "content"))
+        ctx.param.content_defined = true;
+    else if (!streq (s, "fixed"))
+        log_msg_exit ("--chunking must be fixed or content");
     if (!(ctx.h = builtin_get_flux_handle (p)))
         log_err_exit ("flux_open");
 
@@ -269,6 +339,8 @@ static int subcmd_create (optparse_t *p, int ac, char *av[])
             log_msg_exit ("--mmap cannot work with --preserve");
         if (optparse_hasopt (p, "no-force-primary"))
             log_msg_exit ("--mmap cannot work with --no-force-primary");
+        if (ctx.param.content_defined)
+            log_msg_exit ("--mmap cannot work with --chunking=content");
     }
     if (optparse_hasopt (p, "overwrite") && optparse_hasopt (p, "append"))
         log_msg_exit ("--overwrite and --append cannot be used together");
@@ -337,6 +409,10 @@ static int subcmd_create (optparse_t *p, int ac, char *av[])
         }
     }
 
+    /* Wait for pending content stores before the archive references them.
+     */
+    store_drain (&ctx);
+
     /* commit ctx.archive object to KVS
      */
     flux_future_t *f = NULL;
@@ -350,6 +426,7 @@ static int subcmd_create (optparse_t *p, int ac, char *av[])
 
     free (key);
     flux_kvs_txn_destroy (ctx.txn);
+    free (ctx.stores);
     free (hashtype);
 
     return 0;
@@ -684,6 +761,13 @@ static struct optparse_option create_opts[] = {
       .usage = "Preserve data over Flux restart" },
     { .name = "mmap", .has_arg = 0,
       .usage = "Use mmap(2) to map file content" },
+    { .name = "chunking", .has_arg = 1, .arginfo = "TYPE",
+      .usage = "Split large files into fixed (default) or content-defined"
+               " blobs", },
+    { .name = "threads", .has_arg = 1, .arginfo = "N",
+      .usage = "Hash blobs with up to N threads (default: number of CPUs)", },
+    { .name = "window", .has_arg = 1, .arginfo = "N",
+      .usage = "Keep up to N content stores in flight (default 64)", },
     { .name = "chunksize", .has_arg = 1, .arginfo = "N[KMG]",
       .usage = "Limit blob size to N bytes with 0=unlimited (default 1M)",
       .flags = OPTPARSE_OPT_HIDDEN, },
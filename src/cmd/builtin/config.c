@@ -218,7 +218,16 @@ static int internal_config_reload (optparse_t *p, int ac, char *av[])
     }
     if (!(h = builtin_get_flux_handle (p)))
         log_err_exit ("flux_open");
-    if (!(f = flux_rpc (h, "config.reload", NULL, FLUX_NODEID_ANY, 0)))
+    if (optparse_hasopt (p, "all"))
+        f = flux_rpc_pack (h,
+                           "config.reload",
+                           FLUX_NODEID_ANY,
+                           0,
+                           "{s:b}",
+                           "all", 1);
+    else
+        f = flux_rpc (h, "config.reload", NULL, FLUX_NODEID_ANY, 0);
+    if (!f)
         log_err_exit ("error constructing config.reload RPC");
     if (flux_future_get (f, NULL) < 0)
         log_msg_exit ("reload: %s", flux_future_error_string (f));
@@ -309,6 +318,13 @@ static struct optparse_option get_opts[] = {
     OPTPARSE_TABLE_END
 };
 
+static struct optparse_option reload_opts[] = {
+    { .name = "all", .key = 'a', .has_arg = 0,
+      .usage = "Parse config files once and distribute to all brokers"
+    },
+    OPTPARSE_TABLE_END
+};
+
 static struct optparse_option builtin_opts[] = {
     { .name = "intree", .has_arg = 0,
       .usage = "Force in-tree paths to be used"
@@ -332,7 +348,7 @@ static struct optparse_subcommand config_subcmds[] = {
       "Reload broker configuration from files",
       internal_config_reload,
       0,
-      NULL,
+      reload_opts,
     },
     { "get",
       "[OPTIONS] [NAME]",
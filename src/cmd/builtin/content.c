@@ -14,6 +14,7 @@
 #include "builtin.h"
 
 #include <unistd.h>
+#include <jansson.h>
 
 #include "src/common/libutil/blobref.h"
 #include "src/common/libutil/read_all.h"
@@ -168,6 +169,74 @@ static int internal_content_dropcache (optparse_t *p, int ac, char *av[])
     return (0);
 }
 
+static int internal_content_gc (optparse_t *p, int ac, char *av[])
+{
+    flux_t *h;
+    flux_future_t *f = NULL;
+    int marked;
+    int deleted;
+
+    if (optparse_option_index (p) != ac) {
+        optparse_print_usage (p);
+        exit (1);
+    }
+    if (!(h = builtin_get_flux_handle (p)))
+        log_err_exit ("flux_open");
+    if (!(f = flux_rpc (h, "content.gc", NULL, 0, 0))
+        || flux_rpc_get_unpack (f,
+                                "{s:i s:i}",
+                                "marked", &marked,
+                                "deleted", &deleted) < 0)
+        log_msg_exit ("content.gc: %s", future_strerror (f, errno));
+    if (optparse_hasopt (p, "verbose"))
+        printf ("marked %d, deleted %d objects\n", marked, deleted);
+    flux_future_destroy (f);
+    flux_close (h);
+    return (0);
+}
+
+static int internal_content_dict_train (optparse_t *p, int ac, char *av[])
+{
+    flux_t *h;
+    flux_future_t *f = NULL;
+    json_t *o;
+    int id;
+    int size;
+    int samples;
+
+    if (optparse_option_index (p) != ac) {
+        optparse_print_usage (p);
+        exit (1);
+    }
+    if (!(o = json_object ()))
+        log_msg_exit ("out of memory");
+    if (optparse_hasopt (p, "samples")) {
+        json_t *val = json_integer (optparse_get_int (p, "samples", 0));
+        if (!val || json_object_set_new (o, "samples", val) < 0)
+            log_msg_exit ("out of memory");
+    }
+    if (optparse_hasopt (p, "size")) {
+        json_t *val = json_integer (optparse_get_int (p, "size", 0));
+        if (!val || json_object_set_new (o, "size", val) < 0)
+            log_msg_exit ("out of memory");
+    }
+    if (!(h = builtin_get_flux_handle (p)))
+        log_err_exit ("flux_open");
+    if (!(f = flux_rpc_pack (h, "content-backing.dict-train", 0, 0, "O", o))
+        || flux_rpc_get_unpack (f,
+                                "{s:i s:i s:i}",
+                                "id", &id,
+                                "size", &size,
+                                "samples", &samples) < 0)
+        log_msg_exit ("content-backing.dict-train: %s",
+                      future_strerror (f, errno));
+    printf ("dictionary %d: %d bytes from %d samples\n", id, size, samples);
+    json_decref (o);
+    flux_future_destroy (f);
+    flux_close (h);
+    return (0);
+}
+
 int cmd_content (optparse_t *p, int ac, char *av[])
 {
     log_init ("flux-content");
@@ -191,6 +260,20 @@ static struct optparse_option store_opts[] = {
       OPTPARSE_TABLE_END
 };
 
+static struct optparse_option gc_opts[] = {
+    { .name = "verbose",  .key = 'v',  .has_arg = 0,
+      .usage = "Print the number of objects marked and deleted", },
+    OPTPARSE_TABLE_END,
+};
+
+static struct optparse_option dict_train_opts[] = {
+    { .name = "samples", .has_arg = 1, .arginfo = "N",
+      .usage = "Sample at most N objects (default 10000)", },
+    { .name = "size", .has_arg = 1, .arginfo = "N",
+      .usage = "Limit dictionary to N bytes (default 112640)", },
+    OPTPARSE_TABLE_END,
+};
+
 static struct optparse_subcommand content_subcmds[] = {
     { "load",
       "[OPTIONS] BLOBREF ...",
@@ -220,6 +303,20 @@ static struct optparse_subcommand content_subcmds[] = {
       0,
       NULL,
     },
+    { "gc",
+      "[OPTIONS]",
+      "Delete unreachable blobs from the backing store",
+      internal_content_gc,
+      0,
+      gc_opts,
+    },
+    { "dict-train",
+      "[OPTIONS]",
+      "Train a compression dictionary in the backing store",
+      internal_content_dict_train,
+      0,
+      dict_train_opts,
+    },
     OPTPARSE_SUBCMD_END
 };
 
@@ -27,6 +27,7 @@
 #include "src/common/libutil/fsd.h"
 #include "src/common/libutil/blobref.h"
 #include "src/common/libcontent/content.h"
+#include "src/common/libczmqcontainers/czmq_containers.h"
 #include "ccan/str/str.h"
 
 #include "builtin.h"
@@ -44,6 +45,8 @@ static time_t dump_time;
 static gid_t dump_gid;
 static uid_t dump_uid;
 static int keycount;
+static int window;
+static zhashx_t *inflight; // blobref => content.load future
 
 static void progress (int delta_keys)
 {
@@ -123,6 +126,136 @@ static void dump_write_data (struct archive *ar, const void *data, int size)
                  "assuming non-fatal libarchive write size reporting error");
 }
 
+/* Before descending into a directory, hint the content cache to start
+ * loading the blobs referenced by its entries, so that the sequential loads
+ * that follow don't each wait on the backing store.  Hints are best effort
+ * and are sent in batches of up to PREFETCH_MAX hashes.
+ */
+#define PREFETCH_MAX 256
+
+struct prefetch {
+    uint8_t hashes[PREFETCH_MAX * BLOBREF_MAX_DIGEST_SIZE];
+    int hash_size;
+    int count;
+};
+
+static void prefetch_flush (flux_t *h, struct prefetch *pf)
+{
+    if (pf->count > 0)
+        (void)content_prefetch (h, pf->hashes, pf->hash_size, pf->count);
+    pf->count = 0;
+}
+
+static void prefetch_add (flux_t *h, struct prefetch *pf, json_t *treeobj)
+{
+    int count;
+
+    if ((content_flags & CONTENT_FLAG_CACHE_BYPASS)
+        || (!treeobj_is_valref (treeobj) && !treeobj_is_dirref (treeobj)))
+        return;
+    count = treeobj_get_count (treeobj);
+    for (int i = 0; i < count; i++) {
+        const char *ref = treeobj_get_blobref (treeobj, i);
+        int n;
+
+        if (!ref
+            || (n = blobref_strtohash (ref,
+                                       pf->hashes + pf->count * pf->hash_size,
+                                       BLOBREF_MAX_DIGEST_SIZE)) < 0)
+            continue;
+        pf->hash_size = n;
+        if (++pf->count == PREFETCH_MAX)
+            prefetch_flush (h, pf);
+    }
+}
+
+/* Content loads are pipelined.  As the walk reaches each directory entry,
+ * loads are sent for the blobs referenced by the entries that follow it,
+ * up to 'window' loads in flight.  When the walk reaches a blob, it claims
+ * the load already in flight, or sends a new one if there is none.
+ */
+static bool loader_request (flux_t *h, const char *blobref)
+{
+    flux_future_t *f;
+
+    if (zhashx_lookup (inflight, blobref))
+        return true;
+    if (zhashx_size (inflight) >= window)
+        return false;
+    if (!(f = content_load_byblobref (h, blobref, content_flags))
+        || zhashx_insert (inflight, blobref, f) < 0) {
+        flux_future_destroy (f);
+        return false;
+    }
+    return true;
+}
+
+/* Request the blobs referenced by 'treeobj'.  Return false if the window
+ * filled up before all were requested.
+ */
+static bool loader_request_treeobj (flux_t *h, json_t *treeobj)
+{
+    if (treeobj_is_valref (treeobj) || treeobj_is_dirref (treeobj)) {
+        int count = treeobj_get_count (treeobj);
+        for (int i = 0; i < count; i++) {
+            const char *blobref = treeobj_get_blobref (treeobj, i);
+            if (blobref && !loader_request (h, blobref))
+                return false;
+        }
+    }
+    return true;
+}
+
+static flux_future_t *loader_claim (flux_t *h, const char *blobref)
+{
+    flux_future_t *f;
+
+    if ((f = zhashx_lookup (inflight, blobref))) {
+        zhashx_delete (inflight, blobref);
+        return f;
+    }
+    return content_load_byblobref (h, blobref, content_flags);
+}
+
+/* Destroy loads that were never claimed, e.g. duplicate blobrefs.
+ */
+static void loader_destroy (void)
+{
+    flux_future_t *f;
+
+    f = zhashx_first (inflight);
+    while (f) {
+        flux_future_destroy (f);
+        f = zhashx_next (inflight);
+    }
+    zhashx_destroy (&inflight);
+}
+
+/* Iterate over entries of 'dict', keeping loads in flight for the
+ * entries ahead of the current one.
+ */
+struct lookahead {
+    json_t *dict;
+    void *iter;
+    int index;
+};
+
+static void lookahead_fill (flux_t *h,
+                            struct lookahead *la,
+                            void *cur,
+                            int index)
+{
+    if (la->index < index) {
+        la->iter = cur;
+        la->index = index;
+    }
+    while (la->iter
+           && loader_request_treeobj (h, json_object_iter_value (la->iter))) {
+        la->iter = json_object_iter_next (la->dict, la->iter);
+        la->index++;
+    }
+}
+
 static void dump_valref (struct archive *ar,
                          flux_t *h,
                          const char *path,
@@ -151,9 +284,11 @@ static void dump_valref (struct archive *ar,
         log_err_exit ("could not create message list");
     for (int i = 0; i < count; i++) {
         flux_future_t *f;
-        if (!(f = content_load_byblobref (h,
-                                          treeobj_get_blobref (treeobj, i),
-                                          content_flags))
+        for (int j = i + 1; j < count; j++) {
+            if (!loader_request (h, treeobj_get_blobref (treeobj, j)))
+                break;
+        }
+        if (!(f = loader_claim (h, treeobj_get_blobref (treeobj, i)))
             || flux_future_get (f, (const void **)&msg) < 0
             || flux_response_decode_raw (msg, NULL, &data, &len) < 0) {
             log_msg_exit ("%s: missing blobref %d: %s",
@@ -254,15 +389,22 @@ static void dump_dir (struct archive *ar,
                       json_t *treeobj)
 {
     json_t *dict = treeobj_get_data (treeobj);
-    const char *name;
-    json_t *entry;
+    struct lookahead la = { .dict = dict, .iter = NULL, .index = -1 };
+    void *iter = json_object_iter (dict);
+    int index = 0;
 
-    json_object_foreach (dict, name, entry) {
+    while (iter) {
+        const char *name = json_object_iter_key (iter);
+        json_t *entry = json_object_iter_value (iter);
         char *newpath;
+
+        lookahead_fill (h, &la, iter, index);
         if (asprintf (&newpath, "%s/%s", path, name) < 0)
             log_msg_exit ("out of memory");
         dump_treeobj (ar, h, newpath, entry); // recurse
         free (newpath);
+        iter = json_object_iter_next (dict, iter);
+        index++;
     }
 }
 
@@ -278,9 +420,7 @@ static void dump_dirref (struct archive *ar,
 
     if (treeobj_get_count (treeobj) != 1)
         log_msg_exit ("%s: blobref count is not 1", path);
-    if (!(f = content_load_byblobref (h,
-                                      treeobj_get_blobref (treeobj, 0),
-                                      content_flags))
+    if (!(f = loader_claim (h, treeobj_get_blobref (treeobj, 0)))
         || content_load_get (f, &buf, &buflen) < 0) {
         log_msg_exit ("%s: missing blobref: %s",
                       path,
@@ -288,9 +428,42 @@ static void dump_dirref (struct archive *ar,
     }
     if (!(treeobj_deref = treeobj_decodeb (buf, buflen)))
         log_err_exit ("%s: could not decode directory", path);
-    if (!treeobj_is_dir (treeobj_deref))
+    if (treeobj_is_dirshard (treeobj_deref)) {
+        json_t *buckets = treeobj_dirshard_get_buckets (treeobj_deref);
+        const char *name;
+        json_t *bucket;
+        struct prefetch pf = { .count = 0 };
+        struct lookahead la = { .dict = buckets, .iter = NULL, .index = -1 };
+        void *iter;
+        int index = 0;
+
+        json_object_foreach (buckets, name, bucket)
+            prefetch_add (h, &pf, bucket);
+        prefetch_flush (h, &pf);
+        iter = json_object_iter (buckets);
+        while (iter) {
+            bucket = json_object_iter_value (iter);
+            if (!treeobj_is_dirref (bucket))
+                log_msg_exit ("%s: invalid directory shard", path);
+            lookahead_fill (h, &la, iter, index);
+            dump_dirref (ar, h, path, bucket); // recurse
+            iter = json_object_iter_next (buckets, iter);
+            index++;
+        }
+    }
+    else if (!treeobj_is_dir (treeobj_deref))
         log_msg_exit ("%s: dirref references non-directory", path);
-    dump_dir (ar, h, path, treeobj_deref); // recurse
+    else {
+        json_t *dict = treeobj_get_data (treeobj_deref);
+        const char *name;
+        json_t *entry;
+        struct prefetch pf = { .count = 0 };
+
+        json_object_foreach (dict, name, entry)
+            prefetch_add (h, &pf, entry);
+        prefetch_flush (h, &pf);
+        dump_dir (ar, h, path, treeobj_deref); // recurse
+    }
     json_decref (treeobj_deref);
     flux_future_destroy (f);
 }
@@ -349,8 +522,17 @@ static void dump_blobref (struct archive *ar,
         log_msg_exit ("root tree object is not a directory");
 
     dict = treeobj_get_data (treeobj);
-    json_object_foreach (dict, key, entry) {
+    struct lookahead la = { .dict = dict, .iter = NULL, .index = -1 };
+    void *iter = json_object_iter (dict);
+    int index = 0;
+
+    while (iter) {
+        key = json_object_iter_key (iter);
+        entry = json_object_iter_value (iter);
+        lookahead_fill (h, &la, iter, index);
         dump_treeobj (ar, h, key, entry);
+        iter = json_object_iter_next (dict, iter);
+        index++;
     }
     json_decref (treeobj);
     flux_future_destroy (f);
@@ -379,6 +561,10 @@ static int cmd_dump (optparse_t *p, int ac, char *av[])
         content_flags |= CONTENT_FLAG_CACHE_BYPASS;
         kvs_checkpoint_flags |= KVS_CHECKPOINT_FLAG_CACHE_BYPASS;
     }
+    if ((window = optparse_get_int (p, "window", 64)) < 1)
+        log_msg_exit ("--window must be at least 1");
+    if (!(inflight = zhashx_new ()))
+        log_msg_exit ("out of memory");
 
     dump_time = time (NULL);
     dump_uid = getuid ();
@@ -424,6 +610,7 @@ static int cmd_dump (optparse_t *p, int ac, char *av[])
     progress_end ();
 
     dump_destroy (ar);
+    loader_destroy ();
     flux_close (h);
 
     return 0;
@@ -442,6 +629,9 @@ static struct optparse_option dump_opts[] = {
     { .name = "no-cache", .has_arg = 0,
       .usage = "Bypass the broker content cache",
     },
+    { .name = "window", .has_arg = 1, .arginfo = "N",
+      .usage = "Keep up to N content loads in flight (default 64)",
+    },
     OPTPARSE_TABLE_END
 };
 
@@ -42,7 +42,8 @@ static struct optparse_option status_opts[] = {
     },
     { .name = "verbose", .key = 'v', .has_arg = 2, .arginfo = "[LEVEL]",
       .usage = "Increase reporting detail:"
-               " 1=show time since current state was entered,"
+               " 1=show time since current state was entered"
+               " and time to initial wireup,"
                " 2=show round-trip RPC times."
     },
     { .name = "timeout", .key = 't', .has_arg = 1, .arginfo = "FSD",
@@ -91,6 +92,7 @@ struct status {
     double timeout;
     optparse_t *opt;
     struct timespec start;
+    double wireup;
     const char *wait;
     struct idset *highlight;
     zlistx_t *stack;
@@ -180,6 +182,19 @@ static const char *status_duration (struct status *ctx, double since)
     return buf;
 }
 
+/* Show how long it took the subtree to first come fully online, as
+ * measured by the subtree root.
+ */
+static void status_wireup (struct status *ctx)
+{
+    char dbuf[128];
+
+    if (ctx->wireup < 0)
+        printf ("wireup: incomplete\n");
+    else if (fsd_format_duration (dbuf, sizeof (dbuf), ctx->wireup) == 0)
+        printf ("wireup: %s\n", dbuf);
+}
+
 static const char *status_colorize (struct status *ctx,
                                     const char *status,
                                     bool ghost)
@@ -542,6 +557,7 @@ static int status_healthwalk (struct status *ctx,
     flux_future_t *f;
     json_t *children;
     const char *errstr;
+    double wireup = -1;
     int rc = 0;
 
     monotime (&ctx->start);
@@ -549,10 +565,11 @@ static int status_healthwalk (struct status *ctx,
 
     if (!(f = health_rpc (ctx, rank, ctx->wait, ctx->timeout))
         || flux_rpc_get_unpack (f,
-                                "{s:i s:s s:f s:o}",
+                                "{s:i s:s s:f s?f s:o}",
                                 "rank", &node.rank,
                                 "status", &node.status,
                                 "duration", &node.duration,
+                                "wireup", &wireup,
                                 "children", &children) < 0) {
         errstr = future_strerror (f, errno);
         /* RPC failed.
@@ -572,6 +589,8 @@ static int status_healthwalk (struct status *ctx,
         rc = -1;
         goto done;
     }
+    if (level == 0)
+        ctx->wireup = wireup;
     node.subtree_ranks = subtree_ranks (ctx->h, node.rank);
     if (fun (ctx, &node, true, level)) {
         if (children) {
@@ -780,7 +799,10 @@ static int subcmd_status (optparse_t *p, int ac, char *av[])
     else
         fun = show_all;
 
+    ctx.wireup = -1;
     status_healthwalk (&ctx, rank, 0, NIL, fun);
+    if (ctx.verbose >= 1)
+        status_wireup (&ctx);
 
     zlistx_destroy (&ctx.stack);
     idset_destroy (ctx.highlight);
@@ -46,6 +46,16 @@ static time_t restore_timestamp;
 static int blobcount;
 static int keycount;
 static int blob_size_limit;
+static int window;
+
+/* Content stores are pipelined.  The blobref of each blob is computed
+ * locally so the walk can continue without waiting for the store response.
+ * Up to 'window' stores are kept in flight, and each response is checked
+ * against the expected blobref as the oldest stores are retired.
+ */
+static flux_future_t **stores;
+static int stores_head;
+static int stores_count;
 
 static void progress (int delta_blob, int delta_keys)
 {
@@ -110,6 +120,51 @@ static void restore_destroy (struct archive *ar)
     archive_read_free (ar);
 }
 
+static void store_retire (const char *hash_type)
+{
+    flux_future_t *f = stores[stores_head];
+    const char *expected = flux_future_aux_get (f, "blobref");
+    const char *blobref;
+
+    if (content_store_get_blobref (f, hash_type, &blobref) < 0)
+        log_msg_exit ("error storing blob: %s", future_strerror (f, errno));
+    if (!streq (blobref, expected))
+        log_msg_exit ("content store returned unexpected blobref %s", blobref);
+    flux_future_destroy (f);
+    stores_head = (stores_head + 1) % window;
+    stores_count--;
+}
+
+static void store_drain (const char *hash_type)
+{
+    while (stores_count > 0)
+        store_retire (hash_type);
+}
+
+/* Start storing 'buf' and place its blobref in 'blobref'.
+ */
+static void store_blob (flux_t *h,
+                        const char *hash_type,
+                        const void *buf,
+                        int size,
+                        char *blobref,
+                        int blobref_size)
+{
+    flux_future_t *f;
+    char *cpy = NULL;
+
+    if (blobref_hash (hash_type, buf, size, blobref, blobref_size) < 0)
+        log_err_exit ("error computing blobref");
+    if (stores_count == window)
+        store_retire (hash_type);
+    if (!(f = content_store (h, buf, size, content_flags))
+        || !(cpy = strdup (blobref))
+        || flux_future_aux_set (f, "blobref", cpy, free) < 0)
+        log_err_exit ("error storing blob");
+    stores[(stores_head + stores_count++) % window] = f;
+    progress (1, 0);
+}
+
 static json_t *restore_dir (flux_t *h, const char *hash_type, json_t *dir)
 {
     json_t *data = treeobj_get_data (dir);
@@ -131,21 +186,15 @@ static json_t *restore_dir (flux_t *h, const char *hash_type, json_t *dir)
     }
 
     char *s;
-    flux_future_t *f;
-    const char *blobref;
+    char blobref[BLOBREF_MAX_STRING_SIZE];
     json_t *dirref;
 
     if (!(s = treeobj_encode (ndir)))
         log_msg_exit ("out of memory");
-    if (!(f = content_store (h, s, strlen (s), content_flags))
-        || content_store_get_blobref (f, hash_type, &blobref) < 0)
-        log_msg_exit ("error storing dirref blob: %s",
-                      future_strerror (f, errno));
-    progress (1, 0);
+    store_blob (h, hash_type, s, strlen (s), blobref, sizeof (blobref));
     if (!(dirref = treeobj_create_dirref (blobref)))
         log_msg_exit ("out of memory");
     free (s);
-    flux_future_destroy (f);
     json_decref (ndir);
 
     return dirref;
@@ -233,18 +282,11 @@ static void restore_value (flux_t *h,
             log_err_exit ("error creating val object for %s", path);
     }
     else {
-        flux_future_t *f;
-        const char *blobref;
+        char blobref[BLOBREF_MAX_STRING_SIZE];
 
-        if (!(f = content_store (h, buf, size, content_flags))
-            || content_store_get_blobref (f, hash_type, &blobref) < 0)
-            log_msg_exit ("error storing blob for %s: %s",
-                          path,
-                          future_strerror (f, errno));
-        progress (1, 0);
+        store_blob (h, hash_type, buf, size, blobref, sizeof (blobref));
         if (!(treeobj = treeobj_create_valref (blobref)))
             log_err_exit ("error creating valref object for %s", path);
-        flux_future_destroy (f);
     }
     restore_treeobj (root, path, treeobj);
     json_decref (treeobj);
@@ -326,6 +368,7 @@ static json_t *restore_snapshot (struct archive *ar,
     }
     free (buf);
     rootref = restore_dir (h, hash_type, root);
+    store_drain (hash_type);
     json_decref (root);
 
     return rootref;
@@ -391,6 +434,10 @@ static int cmd_restore (optparse_t *p, int ac, char *av[])
         kvs_checkpoint_flags |= KVS_CHECKPOINT_FLAG_CACHE_BYPASS;
     }
     blob_size_limit = optparse_get_size_int (p, "size-limit", "0");
+    if ((window = optparse_get_int (p, "window", 64)) < 1)
+        log_msg_exit ("--window must be at least 1");
+    if (!(stores = calloc (window, sizeof (stores[0]))))
+        log_msg_exit ("out of memory");
 
     h = builtin_get_flux_handle (p);
 
@@ -478,6 +525,7 @@ static int cmd_restore (optparse_t *p, int ac, char *av[])
         flush_content (h, 0);
 
     restore_destroy (ar);
+    free (stores);
     flux_close (h);
 
     return 0;
@@ -503,6 +551,9 @@ static struct optparse_option restore_opts[] = {
     { .name = "size-limit", .has_arg = 1, .arginfo = "SIZE",
       .usage = "Do not restore blobs greater than SIZE bytes",
     },
+    { .name = "window", .has_arg = 1, .arginfo = "N",
+      .usage = "Keep up to N content stores in flight (default 64)",
+    },
     OPTPARSE_TABLE_END
 };
 
@@ -13,6 +13,7 @@
 #endif
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
 #include <fcntl.h>
 #include <stdio.h>
 #include <unistd.h>
@@ -30,6 +31,7 @@
 #include "src/common/libutil/log.h"
 #include "src/common/libsubprocess/fbuf.h"
 #include "src/common/libsubprocess/fbuf_watcher.h"
+#include "src/common/libsubprocess/bulk.h"
 #include "ccan/str/str.h"
 
 static struct optparse_option cmdopts[] = {
@@ -58,6 +60,13 @@ static struct optparse_option cmdopts[] = {
     { .name = "jobid", .key = 'j', .has_arg = 1, .arginfo = "JOBID",
       .usage = "Set target ranks to nodes assigned to JOBID and  "
                "service name to job shell exec service" },
+    { .name = "bulk", .has_arg = 0,
+      .usage = "Launch on all ranks with one request that is fanned out "
+               "over the overlay network" },
+    { .name = "aggregate", .key = 'a', .has_arg = 0,
+      .usage = "Print identical output from multiple ranks once, "
+               "labeled with the ranks, after all have exited "
+               "(implies --bulk)" },
     OPTPARSE_TABLE_END
 };
 
@@ -73,6 +82,7 @@ zhashx_t *exitsets;
 struct idset *hanging;
 
 zlist_t *subprocesses;
+subprocess_bulk_t *bulk;
 
 optparse_t *opts = NULL;
 
@@ -108,6 +118,29 @@ void idset_destroy_wrapper (void *data)
     idset_destroy (idset);
 }
 
+/* Return the set of ranks that exited with 'ec' or 'signum',
+ * creating it if necessary.
+ */
+static struct idset *exitset_get (int ec, int signum)
+{
+    char buf[128];
+    struct idset *idset;
+
+    if (signum)
+        sprintf (buf, "%s", strsignal (signum));
+    else
+        sprintf (buf, "Exit %d", ec);
+
+    /* use exit code as key for hash */
+    if (!(idset = zhashx_lookup (exitsets, buf))) {
+        if (!(idset = idset_create (rank_range, 0)))
+            log_err_exit ("idset_create");
+        (void)zhashx_insert (exitsets, buf, idset);
+        (void)zhashx_freefn (exitsets, buf, idset_destroy_wrapper);
+    }
+    return idset;
+}
+
 void completion_cb (flux_subprocess_t *p)
 {
     int rank = flux_subprocess_rank (p);
@@ -122,23 +155,7 @@ void completion_cb (flux_subprocess_t *p)
         exit_code = ec;
 
     if (ec > 0) {
-        char buf[128];
-        struct idset *idset;
-
-        if (signum)
-            sprintf (buf, "%s", strsignal (signum));
-        else
-            sprintf (buf, "Exit %d", ec);
-
-        /* use exit code as key for hash */
-        if (!(idset = zhashx_lookup (exitsets, buf))) {
-            if (!(idset = idset_create (rank_range, 0)))
-                log_err_exit ("idset_create");
-            (void)zhashx_insert (exitsets, buf, idset);
-            (void)zhashx_freefn (exitsets, buf, idset_destroy_wrapper);
-        }
-
-        if (idset_set (idset, rank) < 0)
+        if (idset_set (exitset_get (ec, signum), rank) < 0)
             log_err_exit ("idset_set");
     }
 
@@ -146,6 +163,20 @@ void completion_cb (flux_subprocess_t *p)
         log_err_exit ("idset_clear");
 }
 
+/* bash standard, 126 for permission/access denied, 127 for
+ * command not found.  68 (EX_NOHOST) for No route to host.
+ */
+static int errnum_exit_code (int errnum)
+{
+    if (errnum == EPERM || errnum == EACCES)
+        return 126;
+    else if (errnum == ENOENT)
+        return 127;
+    else if (errnum == EHOSTUNREACH)
+        return 68;
+    return 1;
+}
+
 void state_cb (flux_subprocess_t *p, flux_subprocess_state_t state)
 {
     if (state == FLUX_SUBPROCESS_RUNNING) {
@@ -176,7 +207,7 @@ void state_cb (flux_subprocess_t *p, flux_subprocess_state_t state)
         flux_cmd_t *cmd = flux_subprocess_get_cmd (p);
         int errnum = flux_subprocess_fail_errno (p);
         const char *errmsg = flux_subprocess_fail_error (p);
-        int ec = 1;
+        int ec;
 
         /* N.B. if no error message available from
          * flux_subprocess_fail_error(), errmsg is set to strerror of
@@ -187,16 +218,7 @@ void state_cb (flux_subprocess_t *p, flux_subprocess_state_t state)
                  flux_cmd_arg (cmd, 0),
                  errmsg);
 
-        /* bash standard, 126 for permission/access denied, 127 for
-         * command not found.  68 (EX_NOHOST) for No route to host.
-         */
-        if (errnum == EPERM || errnum == EACCES)
-            ec = 126;
-        else if (errnum == ENOENT)
-            ec = 127;
-        else if (errnum == EHOSTUNREACH)
-            ec = 68;
-
+        ec = errnum_exit_code (errnum);
         if (ec > exit_code)
             exit_code = ec;
     }
@@ -218,6 +240,242 @@ void output_cb (flux_subprocess_t *p, const char *stream)
     }
 }
 
+static void bulk_exited (const struct idset *ranks)
+{
+    exited += idset_count (ranks);
+    if (idset_subtract (hanging, ranks) < 0)
+        log_err_exit ("idset_subtract");
+    if (stdin_w && exited == rank_count)
+        flux_watcher_stop (stdin_w);
+}
+
+static void bulk_start_cb (subprocess_bulk_t *b,
+                           const struct idset *ranks,
+                           void *arg)
+{
+    started += idset_count (ranks);
+}
+
+static void bulk_exit_cb (subprocess_bulk_t *b,
+                          const struct idset *ranks,
+                          int status,
+                          void *arg)
+{
+    int ec = 0;
+    int signum = 0;
+
+    if (WIFEXITED (status))
+        ec = WEXITSTATUS (status);
+    else if (WIFSIGNALED (status)) {
+        /* bash standard, signals + 128 */
+        signum = WTERMSIG (status);
+        ec = signum + 128;
+    }
+    if (ec > exit_code)
+        exit_code = ec;
+    if (ec > 0) {
+        if (idset_add (exitset_get (ec, signum), ranks) < 0)
+            log_err_exit ("idset_add");
+    }
+    bulk_exited (ranks);
+}
+
+static void bulk_error_cb (subprocess_bulk_t *b,
+                           const struct idset *ranks,
+                           int errnum,
+                           const char *errmsg,
+                           void *arg)
+{
+    const char *argv0 = arg;
+    char *s;
+    int ec;
+
+    if (!(s = idset_encode (ranks, IDSET_FLAG_RANGE)))
+        log_err_exit ("idset_encode");
+    log_msg ("Error: rank %s: %s: %s",
+             s,
+             argv0,
+             errmsg ? errmsg : strerror (errnum));
+    free (s);
+    ec = errnum_exit_code (errnum);
+    if (ec > exit_code)
+        exit_code = ec;
+    bulk_exited (ranks);
+}
+
+/* With --aggregate, the output of each rank is a path in a tree of
+ * lines shared by all ranks, so ranks with identical output share one
+ * copy of it, and ranks with the same last line have identical output.
+ */
+struct outline {
+    struct outline *parent;
+    int len;
+    char data[];
+};
+
+struct aggregate {
+    zhashx_t *lines;            // "parent:data" => struct outline
+    struct outline **tail[2];   // stdout, stderr: last line by rank
+};
+
+struct aggregate agg;
+
+static void outline_destructor (void **item)
+{
+    if (item) {
+        free (*item);
+        *item = NULL;
+    }
+}
+
+static void aggregate_init (void)
+{
+    if (!(agg.lines = zhashx_new ())
+        || !(agg.tail[0] = calloc (rank_range, sizeof (agg.tail[0][0])))
+        || !(agg.tail[1] = calloc (rank_range, sizeof (agg.tail[1][0]))))
+        log_msg_exit ("out of memory");
+    zhashx_set_destructor (agg.lines, outline_destructor);
+}
+
+static void aggregate_fini (void)
+{
+    zhashx_destroy (&agg.lines);
+    free (agg.tail[0]);
+    free (agg.tail[1]);
+}
+
+static struct outline *outline_get (struct outline *parent,
+                                    const char *data,
+                                    int len)
+{
+    struct outline *line;
+    char *key;
+
+    if (asprintf (&key, "%p:%.*s", parent, len, data) < 0)
+        log_msg_exit ("out of memory");
+    if (!(line = zhashx_lookup (agg.lines, key))
+        || line->len != len
+        || memcmp (line->data, data, len) != 0) {
+        if (!(line = malloc (sizeof (*line) + len)))
+            log_msg_exit ("out of memory");
+        line->parent = parent;
+        line->len = len;
+        memcpy (line->data, data, len);
+        (void)zhashx_insert (agg.lines, key, line);
+    }
+    free (key);
+    return line;
+}
+
+static void aggregate_append (const struct idset *ranks,
+                              const char *stream,
+                              const char *data,
+                              int len)
+{
+    struct outline **tail = agg.tail[streq (stream, "stderr") ? 1 : 0];
+    struct outline *parent = NULL;
+    struct outline *line = NULL;
+    unsigned int rank;
+
+    /* Ranks in a group usually have the same output so far, so only
+     * look up the new line when the parent changes.
+     */
+    rank = idset_first (ranks);
+    while (rank != IDSET_INVALID_ID) {
+        if (rank >= rank_range)
+            log_msg_exit ("output from unexpected rank %u", rank);
+        if (!line || tail[rank] != parent) {
+            parent = tail[rank];
+            line = outline_get (parent, data, len);
+        }
+        tail[rank] = line;
+        rank = idset_next (ranks, rank);
+    }
+}
+
+static void outline_print (struct outline *line, FILE *fp)
+{
+    struct outline **lines;
+    struct outline *l;
+    int count = 0;
+    int i;
+
+    for (l = line; l != NULL; l = l->parent)
+        count++;
+    if (!(lines = calloc (count, sizeof (*lines))))
+        log_msg_exit ("out of memory");
+    i = count;
+    for (l = line; l != NULL; l = l->parent)
+        lines[--i] = l;
+    for (i = 0; i < count; i++)
+        fwrite (lines[i]->data, lines[i]->len, 1, fp);
+    free (lines);
+}
+
+/* Print the output of each group of ranks with identical output,
+ * in the style of dshbak -c.
+ */
+static void aggregate_print (struct outline **tail, FILE *fp)
+{
+    struct idset *done;
+    unsigned int rank;
+
+    if (!(done = idset_create (rank_range, 0)))
+        log_err_exit ("idset_create");
+    for (rank = 0; rank < rank_range; rank++) {
+        struct idset *group;
+        char *s;
+
+        if (!tail[rank] || idset_test (done, rank))
+            continue;
+        if (!(group = idset_create (rank_range, 0)))
+            log_err_exit ("idset_create");
+        for (unsigned int i = rank; i < rank_range; i++) {
+            if (tail[i] == tail[rank] && idset_set (group, i) < 0)
+                log_err_exit ("idset_set");
+        }
+        if (idset_add (done, group) < 0
+            || !(s = idset_encode (group,
+                                   IDSET_FLAG_BRACKETS | IDSET_FLAG_RANGE)))
+            log_err_exit ("idset_encode");
+        fprintf (fp, "----------------\n%s\n----------------\n", s);
+        outline_print (tail[rank], fp);
+        free (s);
+        idset_destroy (group);
+    }
+    idset_destroy (done);
+}
+
+static void bulk_output_cb (subprocess_bulk_t *b,
+                            const struct idset *ranks,
+                            const char *stream,
+                            const char *data,
+                            int len,
+                            void *arg)
+{
+    FILE *fstream = streq (stream, "stderr") ? stderr : stdout;
+    unsigned int rank;
+
+    if (agg.lines) {
+        aggregate_append (ranks, stream, data, len);
+        return;
+    }
+    rank = idset_first (ranks);
+    while (rank != IDSET_INVALID_ID) {
+        if (optparse_getopt (opts, "label-io", NULL) > 0)
+            fprintf (fstream, "%u: ", rank);
+        fwrite (data, len, 1, fstream);
+        rank = idset_next (ranks, rank);
+    }
+}
+
+static void bulk_complete_cb (subprocess_bulk_t *b, void *arg)
+{
+    if (stdin_w)
+        flux_watcher_stop (stdin_w);
+    flux_reactor_stop (flux_get_reactor (flux_handle));
+}
+
 static void stdin_cb (flux_reactor_t *r,
                       flux_watcher_t *w,
                       int revents,
@@ -231,6 +489,14 @@ static void stdin_cb (flux_reactor_t *r,
     if (!(ptr = fbuf_read (fb, -1, &lenp)))
         log_err_exit ("fbuf_read");
 
+    if (bulk) {
+        if ((lenp && subprocess_bulk_write (bulk, "stdin", ptr, lenp) < 0)
+            || (!lenp && subprocess_bulk_close (bulk, "stdin") < 0))
+            log_err_exit ("error writing stdin");
+        if (!lenp)
+            flux_watcher_stop (stdin_w);
+        return;
+    }
     if (lenp) {
         p = zlist_first (subprocesses);
         while (p) {
@@ -343,7 +609,10 @@ static void signal_cb (int signum)
                  signum,
                  started - exited);
 
-    killall (subprocesses, signum);
+    if (bulk)
+        flux_future_destroy (subprocess_bulk_kill (bulk, signum));
+    else
+        killall (subprocesses, signum);
 
     if (signum == SIGINT) {
         if (sigint_count)
@@ -709,7 +978,30 @@ int main (int argc, char *argv[])
     service_name = optparse_get_str (opts,
                                      "service",
                                      job_service ? job_service : "rexec");
-    rank = idset_first (targets);
+    if (optparse_hasopt (opts, "bulk") || optparse_hasopt (opts, "aggregate")) {
+        subprocess_bulk_ops_t bulk_ops = {
+            .on_start = bulk_start_cb,
+            .on_exit = bulk_exit_cb,
+            .on_error = bulk_error_cb,
+            .on_output = bulk_output_cb,
+            .on_complete = bulk_complete_cb,
+        };
+        if (job_service)
+            log_msg_exit ("--bulk cannot be used with --jobid");
+        if (use_imp)
+            log_msg_exit ("--bulk cannot be used with flux-imp");
+        if (optparse_hasopt (opts, "aggregate"))
+            aggregate_init ();
+        if (!(bulk = subprocess_bulk_exec (h,
+                                           service_name,
+                                           0,
+                                           targets,
+                                           cmd,
+                                           &bulk_ops,
+                                           (void *)flux_cmd_arg (cmd, 0))))
+            log_err_exit ("subprocess_bulk_exec");
+    }
+    rank = bulk ? IDSET_INVALID_ID : idset_first (targets);
     while (rank != IDSET_INVALID_ID) {
         flux_subprocess_t *p;
         if (!(p = flux_rexec_ex (h,
@@ -735,6 +1027,8 @@ int main (int argc, char *argv[])
      */
     if (optparse_getopt (opts, "noinput", NULL) > 0) {
         flux_subprocess_t *p;
+        if (bulk && subprocess_bulk_close (bulk, "stdin") < 0)
+            log_err_exit ("subprocess_bulk_close");
         p = zlist_first (subprocesses);
         while (p) {
             if (flux_subprocess_close (p, "stdin") < 0)
@@ -758,6 +1052,11 @@ int main (int argc, char *argv[])
                                                   0,
                                                   NULL)))
             log_err_exit ("fbuf_read_watcher_create");
+        /* The subprocess servers handle stdin for a bulk launch only
+         * after the launch, so there is no need to wait for start.
+         */
+        if (bulk)
+            flux_watcher_start (stdin_w);
     }
     if (signal (SIGINT, signal_cb) == SIG_ERR)
         log_err_exit ("signal");
@@ -768,6 +1067,12 @@ int main (int argc, char *argv[])
     if (flux_reactor_run (r, 0) < 0)
         log_err_exit ("flux_reactor_run");
 
+    if (agg.lines) {
+        aggregate_print (agg.tail[0], stdout);
+        aggregate_print (agg.tail[1], stderr);
+        aggregate_fini ();
+    }
+
     if (optparse_getopt (opts, "verbose", NULL) > 0)
         fprintf (stderr,
                  "%03fms: %d tasks complete with code %d\n",
@@ -791,6 +1096,7 @@ int main (int argc, char *argv[])
     free (job_service);
     free (cwd);
     flux_cmd_destroy(cmd);
+    subprocess_bulk_destroy (bulk);
     flux_close (h);
     optparse_destroy (opts);
     log_fini ();
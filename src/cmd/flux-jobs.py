@@ -115,12 +115,13 @@ def need_instance_info(fields):
 
 # pylint: disable=too-many-branches
 def fetch_jobs_flux(args, fields, flux_handle=None):
+    toplevel = flux_handle is None
     if not flux_handle:
         flux_handle = flux.Flux()
 
     attrs = job_fields_to_attrs(fields)
 
-    if args.color == "always" or args.color == "auto":
+    if args.color == "always" or (args.color == "auto" and sys.stdout.isatty()):
         attrs.update(job_fields_to_attrs(["result", "annotations"]))
     if args.recursive:
         attrs.update(job_fields_to_attrs(["annotations", "status", "userid"]))
@@ -166,9 +167,12 @@ def fetch_jobs_flux(args, fields, flux_handle=None):
         since=since,
         name=args.name,
         queue=args.queue,
+        cursor=args.cursor if toplevel else None,
     )
 
     jobs = jobs_rpc.jobs()
+    if toplevel:
+        args.next_cursor = jobs_rpc.next_cursor
 
     if need_instance_info(fields):
         with concurrent.futures.ThreadPoolExecutor(args.threads) as executor:
@@ -232,6 +236,13 @@ def parse_args():
         help="Include jobs that have become inactive since WHEN. "
         + "(implies -a if no other --filter option is specified)",
     )
+    parser.add_argument(
+        "--cursor",
+        type=str,
+        metavar="CURSOR",
+        help="Resume listing after the last job of a previous page. "
+        + "CURSOR is taken from the output of --json",
+    )
     parser.add_argument(
         "-n",
         "--no-header",
@@ -338,7 +349,7 @@ def parse_args():
     )
     # Hidden '--from-stdin' option for testing only.
     parser.add_argument("--from-stdin", action="store_true", help=argparse.SUPPRESS)
-    parser.set_defaults(filtered=False)
+    parser.set_defaults(filtered=False, next_cursor=None)
     return parser.parse_args()
 
 
@@ -393,7 +404,22 @@ def get_jobs_recursive(job, args, fields):
     return (job, jobs, stats)
 
 
-def print_jobs(jobs, args, formatter, path="", level=0):
+def fetch_jobs_tree(children, args, fields, max_depth):
+    """Fetch jobs from 'children' and their descendants, one level at a time"""
+
+    def get_children(job, result):
+        return [x for x in result[1] if is_user_instance(x, args)]
+
+    return flux.util.tree_map(
+        lambda job: get_jobs_recursive(job, args, fields),
+        children,
+        get_children,
+        max_workers=args.threads,
+        max_depth=max_depth,
+    )
+
+
+def print_jobs(jobs, args, formatter, path="", level=0, tree=None):
     children = []
     # Array of jobs as dict
     result = []
@@ -428,18 +454,17 @@ def print_jobs(jobs, args, formatter, path="", level=0):
     #  Reset args.jobids since it won't apply recursively:
     args.jobids = None
 
-    futures = []
-    with concurrent.futures.ThreadPoolExecutor(args.threads) as executor:
-        for job in children:
-            futures.append(
-                executor.submit(get_jobs_recursive, job, args, formatter.fields)
-            )
+    #  At the top level, fetch all descendants up front, so that each
+    #  level of the hierarchy is queried concurrently.  JSON output only
+    #  includes the jobs of immediate children.
+    if tree is None:
+        max_depth = 0 if args.json else args.level - level - 1
+        tree = fetch_jobs_tree(children, args, formatter.fields, max_depth)
 
     if path:
         path = f"{path}/"
 
-    for future in futures:
-        (job, jobs, stats) = future.result()
+    for _, (job, jobs, stats), subtree in tree:
 
         #  If generating JSON, just add this job's children to a job["jobs"]
         #  array and continue:
@@ -455,7 +480,9 @@ def print_jobs(jobs, args, formatter, path="", level=0):
                 f"{stats.running} running, {stats.successful} completed, "
                 f"{stats.failed} failed, {stats.pending} pending"
             )
-        print_jobs(jobs, args, formatter, path=thispath, level=level + 1)
+        print_jobs(
+            jobs, args, formatter, path=thispath, level=level + 1, tree=subtree
+        )
 
     return result
 
@@ -511,7 +538,10 @@ def main():
             if result:
                 print(json.dumps(result[0]))
         else:
-            print(json.dumps({"jobs": result}))
+            output = {"jobs": result}
+            if args.next_cursor:
+                output["cursor"] = args.next_cursor
+            print(json.dumps(output))
 
 
 if __name__ == "__main__":
@@ -29,6 +29,7 @@
 #include "src/common/libutil/log.h"
 #include "src/common/libutil/read_all.h"
 #include "src/common/libkvs/treeobj.h"
+#include "src/common/libkvs/kvs_util_private.h"
 #include "src/common/libeventlog/eventlog.h"
 #include "src/common/libeventlog/formatter.h"
 #include "ccan/str/str.h"
@@ -49,6 +50,7 @@ int cmd_dir (optparse_t *p, int argc, char **argv);
 int cmd_ls (optparse_t *p, int argc, char **argv);
 int cmd_getroot (optparse_t *p, int argc, char **argv);
 int cmd_eventlog (optparse_t *p, int argc, char **argv);
+int cmd_top (optparse_t *p, int argc, char **argv);
 
 static int get_window_width (optparse_t *p, int fd);
 static void dump_kvs_dir (const flux_kvsdir_t *dir, int maxcol,
@@ -56,6 +58,10 @@ static void dump_kvs_dir (const flux_kvsdir_t *dir, int maxcol,
 
 #define min(a,b) ((a)<(b)?(a):(b))
 
+/* flux kvs put --stream commits its input in pieces of this size.
+ */
+#define STREAM_CHUNK_SIZE (1024*1024)
+
 static struct optparse_option readlink_opts[] =  {
     { .name = "namespace", .key = 'N', .has_arg = 1,
       .usage = "Specify KVS namespace to use.",
@@ -106,6 +112,9 @@ static struct optparse_option get_opts[] =  {
     { .name = "count", .key = 'c', .has_arg = 1, .arginfo = "COUNT",
       .usage = "Display at most COUNT changes",
     },
+    { .name = "stream", .has_arg = 0,
+      .usage = "Write raw value as it arrives without buffering it all",
+    },
     OPTPARSE_TABLE_END
 };
 
@@ -137,6 +146,9 @@ static struct optparse_option put_opts[] =  {
     { .name = "sync", .key = 'S', .has_arg = 0,
       .usage = "Flushes content and checkpoints after completing put",
     },
+    { .name = "stream", .has_arg = 0,
+      .usage = "Store raw value from stdin in pieces (key=-)",
+    },
     OPTPARSE_TABLE_END
 };
 
@@ -226,6 +238,19 @@ static struct optparse_option getroot_opts[] =  {
     OPTPARSE_TABLE_END
 };
 
+static struct optparse_option top_opts[] =  {
+    { .name = "rank", .key = 'r', .has_arg = 1, .arginfo = "RANK",
+      .usage = "Show activity handled by broker RANK (default 0)",
+    },
+    { .name = "type", .key = 't', .has_arg = 1, .arginfo = "TYPE",
+      .usage = "Show only one table: namespace, prefix, or userid",
+    },
+    { .name = "limit", .key = 'n', .has_arg = 1, .arginfo = "N",
+      .usage = "Show at most N entries per table (default 10)",
+    },
+    OPTPARSE_TABLE_END
+};
+
 static struct optparse_option copy_opts[] =  {
     { .name = "src-namespace", .key = 'S', .has_arg = 1,
       .usage = "Specify source key's namespace",
@@ -288,14 +313,15 @@ static struct optparse_subcommand subcommands[] = {
     },
     { "get",
       "[-N ns] [-r|-t] [-a treeobj] [-l] [-W] [-w] [-u] [-A] [-f] "
-        "[-c COUNT] key [key...]",
+        "[-c COUNT] [--stream] key [key...]",
       "Get value stored under key",
       cmd_get,
       0,
       get_opts
     },
     { "put",
-      "[-N ns] [-O|-b|-s] [-r|-t] [-n] [-A] [-S] key=value [key=value...]",
+      "[-N ns] [-O|-b|-s] [-r|-t] [-n] [-A] [-S] [--stream] "
+        "key=value [key=value...]",
       "Store value under key",
       cmd_put,
       0,
@@ -385,6 +411,13 @@ static struct optparse_subcommand subcommands[] = {
       0,
       getroot_opts
     },
+    { "top",
+      "[-r rank] [-t type] [-n limit]",
+      "Show the busiest namespaces, key prefixes, and users",
+      cmd_top,
+      0,
+      top_opts
+    },
     { "eventlog",
       NULL,
       "Manipulate a KVS eventlog",
@@ -776,6 +809,35 @@ void cmd_get_one (flux_t *h, const char *key, struct lookup_ctx *ctx)
     }
 }
 
+/* Write the value of 'key' to stdout as it arrives, one blob at a time.
+ */
+void cmd_get_stream (flux_t *h, const char *ns, const char *key)
+{
+    flux_future_t *f;
+    const void *data;
+    int len;
+
+    if (!ns && !(ns = kvs_get_namespace ()))
+        log_err_exit ("%s", key);
+    if (!(f = flux_rpc_pack (h,
+                             "kvs.lookup-stream",
+                             FLUX_NODEID_ANY,
+                             FLUX_RPC_STREAMING,
+                             "{s:s s:s s:i}",
+                             "key", key,
+                             "namespace", ns,
+                             "flags", 0)))
+        log_err_exit ("%s", key);
+    while (flux_rpc_get_raw (f, &data, &len) == 0) {
+        if (write_all (STDOUT_FILENO, data, len) < 0)
+            log_err_exit ("%s", key);
+        flux_future_reset (f);
+    }
+    if (errno != ENODATA)
+        log_err_exit ("%s", key);
+    flux_future_destroy (f);
+}
+
 int cmd_get (optparse_t *p, int argc, char **argv)
 {
     flux_t *h;
@@ -792,11 +854,26 @@ int cmd_get (optparse_t *p, int argc, char **argv)
     ctx.maxcount = optparse_get_int (p, "count", 0);
     ctx.ns = optparse_get_str (p, "namespace", NULL);
 
+    if (optparse_hasopt (p, "stream")) {
+        const char *incompat[] = {
+            "treeobj", "at", "label", "waitcreate", "watch", NULL
+        };
+        for (i = 0; incompat[i] != NULL; i++) {
+            if (optparse_hasopt (p, incompat[i]))
+                log_msg_exit ("--stream cannot be used with --%s",
+                              incompat[i]);
+        }
+    }
+
     if (!(h = flux_open (NULL, 0)))
         log_err_exit ("flux_open");
 
-    for (i = optindex; i < argc; i++)
-        cmd_get_one (h, argv[i], &ctx);
+    for (i = optindex; i < argc; i++) {
+        if (optparse_hasopt (p, "stream"))
+            cmd_get_stream (h, ctx.ns, argv[i]);
+        else
+            cmd_get_one (h, argv[i], &ctx);
+    }
     /* Unless --watch is specified, cmd_get_one() starts the reactor and
      * waits for it to complete, effectively making each lookup synchronous,
      * so that value output order matches command line order of keys.
@@ -837,6 +914,79 @@ void commit_finish (flux_future_t *f, optparse_t *p)
     }
 }
 
+/* Read up to 'size' bytes from 'fd', stopping short only at EOF.
+ */
+static ssize_t read_chunk (int fd, void *buf, size_t size)
+{
+    size_t count = 0;
+
+    while (count < size) {
+        ssize_t n = read (fd, (char *)buf + count, size - count);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        if (n == 0)
+            break;
+        count += n;
+    }
+    return count;
+}
+
+/* Store stdin under 'key' without holding it all in memory.  It is
+ * appended in pieces to a temporary key, so each commit is small, then
+ * moved to 'key' in one commit, so readers see either the old value or
+ * the complete new one.
+ */
+void cmd_put_stream (flux_t *h,
+                     const char *ns,
+                     const char *key,
+                     int commit_flags,
+                     optparse_t *p)
+{
+    char *tmpkey;
+    void *buf;
+    ssize_t n;
+    int put_flags = 0;
+    flux_kvs_txn_t *txn;
+    flux_future_t *f;
+    const char *treeobj;
+
+    if (asprintf (&tmpkey, "%s~stream-%d", key, (int)getpid ()) < 0)
+        log_err_exit ("%s", key);
+    buf = xzmalloc (STREAM_CHUNK_SIZE);
+    do {
+        if ((n = read_chunk (STDIN_FILENO, buf, STREAM_CHUNK_SIZE)) < 0)
+            log_err_exit ("stdin");
+        if (n == 0 && put_flags != 0)
+            break;
+        if (!(txn = flux_kvs_txn_create ())
+            || flux_kvs_txn_put_raw (txn, put_flags, tmpkey, buf, n) < 0
+            || !(f = flux_kvs_commit (h, ns, 0, txn))
+            || flux_future_get (f, NULL) < 0)
+            log_err_exit ("%s", key);
+        flux_future_destroy (f);
+        flux_kvs_txn_destroy (txn);
+        put_flags = FLUX_KVS_APPEND;
+    } while (n == STREAM_CHUNK_SIZE);
+    free (buf);
+
+    if (!(f = flux_kvs_lookup (h, ns, FLUX_KVS_TREEOBJ, tmpkey))
+        || flux_kvs_lookup_get_treeobj (f, &treeobj) < 0
+        || !(txn = flux_kvs_txn_create ())
+        || flux_kvs_txn_put_treeobj (txn, 0, key, treeobj) < 0
+        || flux_kvs_txn_unlink (txn, 0, tmpkey) < 0)
+        log_err_exit ("%s", key);
+    flux_future_destroy (f);
+    if (!(f = flux_kvs_commit (h, ns, commit_flags, txn)))
+        log_err_exit ("flux_kvs_commit");
+    commit_finish (f, p);
+    flux_future_destroy (f);
+    flux_kvs_txn_destroy (txn);
+    free (tmpkey);
+}
+
 int cmd_put (optparse_t *p, int argc, char **argv)
 {
     flux_t *h;
@@ -860,9 +1010,26 @@ int cmd_put (optparse_t *p, int argc, char **argv)
     if (optparse_hasopt (p, "sync"))
         commit_flags |= FLUX_KVS_SYNC;
 
+    if (optparse_hasopt (p, "stream")) {
+        if (optparse_hasopt (p, "treeobj") || optparse_hasopt (p, "append"))
+            log_msg_exit ("put: --stream cannot be used with -t or -A");
+        if (argc - optindex != 1 || !strends (argv[optindex], "=-"))
+            log_msg_exit ("put: --stream requires a single key=- argument");
+    }
+
     if (!(h = flux_open (NULL, 0)))
         log_err_exit ("flux_open");
 
+    if (optparse_hasopt (p, "stream")) {
+        char *key = xstrdup (argv[optindex]);
+
+        key[strlen (key) - 2] = '\0';
+        cmd_put_stream (h, ns, key, commit_flags, p);
+        free (key);
+        flux_close (h);
+        return (0);
+    }
+
     if (!(txn = flux_kvs_txn_create ()))
         log_err_exit ("flux_kvs_txn_create");
     for (i = optindex; i < argc; i++) {
@@ -1845,6 +2012,87 @@ int cmd_getroot (optparse_t *p, int argc, char **argv)
     return (0);
 }
 
+static void top_print (const char *type, json_t *top, int limit)
+{
+    json_t *a;
+    size_t index;
+    json_t *entry;
+
+    if (!(a = json_object_get (top, type)) || !json_is_array (a))
+        log_msg_exit ("kvs.stats-get response has no %s table", type);
+    printf ("%-10s %10s %10s %10s %12s %9s\n",
+            type,
+            "COUNT",
+            "LOOKUPS",
+            "COMMITS",
+            "BYTES",
+            "LATENCY");
+    json_array_foreach (a, index, entry) {
+        const char *name;
+        json_int_t count, lookups, commits, bytes;
+        double latency;
+
+        if (index >= limit)
+            break;
+        if (json_unpack (entry,
+                         "{s:s s:I s:I s:I s:I s:f}",
+                         "name", &name,
+                         "count", &count,
+                         "lookups", &lookups,
+                         "commits", &commits,
+                         "bytes", &bytes,
+                         "latency", &latency) < 0)
+            log_msg_exit ("error decoding kvs.stats-get %s table", type);
+        printf ("%-10s %10ju %10ju %10ju %12ju %8.3fs\n",
+                name,
+                (uintmax_t)count,
+                (uintmax_t)lookups,
+                (uintmax_t)commits,
+                (uintmax_t)bytes,
+                latency);
+    }
+}
+
+int cmd_top (optparse_t *p, int argc, char **argv)
+{
+    flux_t *h;
+    int optindex = optparse_option_index (p);
+    const char *types[] = { "namespace", "prefix", "userid", NULL };
+    const char *type = optparse_get_str (p, "type", NULL);
+    int limit = optparse_get_int (p, "limit", 10);
+    int rank = optparse_get_int (p, "rank", 0);
+    flux_future_t *f;
+    json_t *top;
+
+    if (optindex != argc) {
+        optparse_print_usage (p);
+        exit (1);
+    }
+    if (type
+        && !streq (type, "namespace")
+        && !streq (type, "prefix")
+        && !streq (type, "userid"))
+        log_msg_exit ("--type must be namespace, prefix, or userid");
+    if (limit < 0)
+        log_msg_exit ("--limit must be >= 0");
+
+    if (!(h = flux_open (NULL, 0)))
+        log_err_exit ("flux_open");
+    if (!(f = flux_rpc (h, "kvs.stats-get", NULL, rank, 0))
+        || flux_rpc_get_unpack (f, "{s:o}", "top", &top) < 0)
+        log_msg_exit ("kvs.stats-get: %s", future_strerror (f, errno));
+    for (int i = 0; types[i] != NULL; i++) {
+        if (type && !streq (type, types[i]))
+            continue;
+        if (i > 0 && !type)
+            printf ("\n");
+        top_print (types[i], top, limit);
+    }
+    flux_future_destroy (f);
+    flux_close (h);
+    return (0);
+}
+
 /* combine 'argv' elements into one space-separated string (caller must free).
  * assumes 'argv' is NULL terminated.
  */
@@ -12,6 +12,7 @@
 #include "config.h"
 #endif
 #include <stdio.h>
+#include <stdint.h>
 #include <getopt.h>
 #include <flux/core.h>
 #include <flux/optparse.h>
@@ -44,7 +45,7 @@ int cmd_debug (optparse_t *p, int argc, char **argv);
 
 static struct optparse_option list_opts[] = {
     { .name = "long",  .key = 'l',  .has_arg = 0,
-      .usage = "Include full DSO path for each module", },
+      .usage = "Include resource usage and full DSO path for each module", },
     OPTPARSE_TABLE_END,
 };
 
@@ -69,6 +70,9 @@ static struct optparse_option load_opts[] =  {
     { .name = "name", .has_arg = 1, .arginfo = "NAME",
       .usage = "Override default module name",
     },
+    { .name = "lazy", .has_arg = 0,
+      .usage = "Defer loading until the module's service is first used",
+    },
     OPTPARSE_TABLE_END,
 };
 
@@ -85,6 +89,9 @@ static struct optparse_option stats_opts[] =  {
     { .name = "rusage", .key = 'R', .has_arg = 0,
       .usage = "Request rusage data instead of stats",
     },
+    { .name = "history", .key = 'H', .has_arg = 0,
+      .usage = "Request sampled resource usage history instead of stats",
+    },
     { .name = "clear", .key = 'c', .has_arg = 0,
       .usage = "Clear stats on target rank",
     },
@@ -114,7 +121,7 @@ static struct optparse_subcommand subcommands[] = {
       list_opts,
     },
     { "remove",
-      "[OPTIONS] module",
+      "[OPTIONS] module...",
       "Unload module",
       cmd_remove,
       0,
@@ -275,7 +282,9 @@ static void module_load (flux_t *h,
         || !(payload = json_pack ("{s:s s:O}",
                                "path", fullpath ? fullpath : path,
                                "args", args))
-        || (name && set_string (payload, "name", name) < 0))
+        || (name && set_string (payload, "name", name) < 0)
+        || (optparse_hasopt (p, "lazy")
+            && json_object_set_new (payload, "lazy", json_true ()) < 0))
         log_msg_exit ("failed to create broker.insmod payload");
     if (!(f = flux_rpc_pack (h,
                              "broker.insmod",
@@ -312,10 +321,11 @@ int cmd_load (optparse_t *p, int argc, char **argv)
     return 0;
 }
 
-static void module_remove (flux_t *h, optparse_t *p, const char *path)
+static int module_remove (flux_t *h, optparse_t *p, const char *path)
 {
     char *fullpath = NULL;
     flux_future_t *f;
+    int rc = 0;
 
     if (canonicalize_if_path (path, &fullpath) < 0)
         log_err_exit ("could not canonicalize module path '%s'", path);
@@ -327,32 +337,40 @@ static void module_remove (flux_t *h, optparse_t *p, const char *path)
                              "{s:s}",
                              "name", fullpath ? fullpath : path))
         || flux_rpc_get (f, NULL) < 0) {
-        if (!(optparse_hasopt (p, "force") && errno == ENOENT))
-            log_msg_exit ("remove %s: %s", path, future_strerror (f, errno));
+        if (!(optparse_hasopt (p, "force") && errno == ENOENT)) {
+            log_msg ("remove %s: %s", path, future_strerror (f, errno));
+            rc = -1;
+        }
     }
     flux_future_destroy (f);
     free (fullpath);
+    return rc;
 }
 
+/* Remove one or more modules in order over a single connection, so that
+ * rc3 can unload modules without starting a process for each one.
+ * A failure does not stop removal of the remaining modules.
+ */
 int cmd_remove (optparse_t *p, int argc, char **argv)
 {
     int n = optparse_option_index (p);
-    char *path;
+    int errors = 0;
     flux_t *h;
 
-    if (n != argc - 1) {
+    if (n == argc) {
         optparse_print_usage (p);
         exit (1);
     }
-    path = argv[n];
-
     if (!(h = flux_open (NULL, 0)))
         log_err_exit ("flux_open");
 
-    module_remove (h, p, path);
+    while (n < argc) {
+        if (module_remove (h, p, argv[n++]) < 0)
+            errors++;
+    }
 
     flux_close (h);
-    return (0);
+    return (errors > 0 ? 1 : 0);
 }
 
 int cmd_reload (optparse_t *p, int argc, char **argv)
@@ -373,7 +391,8 @@ int cmd_reload (optparse_t *p, int argc, char **argv)
     /* If --name=NAME was specified, remove by that name rather than
      * the path so the correct instantiation of the DSO is selected.
      */
-    module_remove (h, p, name ? name : path);
+    if (module_remove (h, p, name ? name : path) < 0)
+        exit (1);
 
     module_load (h, p, path, argc - n, argv + n);
     return (0);
@@ -415,9 +434,15 @@ void lsmod_idle_string (int idle, char *buf, int bufsz)
         snprintf (buf, bufsz, "idle");
 }
 
+/* Pseudo-state for a lazy module that has not been loaded yet.
+ */
+#define LSMOD_STATE_LAZY (-1)
+
 char lsmod_state_char (int state)
 {
     switch (state) {
+    case LSMOD_STATE_LAZY:
+        return 'L';
     case FLUX_MODSTATE_INIT:
         return 'I';
     case FLUX_MODSTATE_RUNNING:
@@ -435,8 +460,9 @@ void lsmod_print_header (FILE *f, bool longopt)
 {
     if (longopt) {
         fprintf (f,
-                 "%-24.24s %4s  %c %-8s %s\n",
-                 "Module", "Idle", 'S', "Service", "Path");
+                 "%-24.24s %4s  %c %8s %8s %8s %-8s %s\n",
+                 "Module", "Idle", 'S', "CPU", "RxMsgs", "TxMsgs",
+                 "Service", "Path");
     }
     else {
         fprintf (f,
@@ -451,6 +477,9 @@ void lsmod_print_entry (FILE *f,
                        int idle,
                        int status,
                        json_t *services,
+                       double cpu,
+                       json_int_t rxmsgs,
+                       json_int_t txmsgs,
                        bool longopt)
 {
     char idle_s[16];
@@ -460,10 +489,13 @@ void lsmod_print_entry (FILE *f,
 
     if (longopt) {
         char *s = lsmod_services_string (services, name, 8);
-        fprintf (f, "%-24.24s %4s  %c %-8s %s\n",
+        fprintf (f, "%-24.24s %4s  %c %8.2f %8jd %8jd %-8s %s\n",
                  name,
                  idle_s,
                  state,
+                 cpu,
+                 (intmax_t)rxmsgs,
+                 (intmax_t)txmsgs,
                  s ? s : "",
                  path);
         free (s);
@@ -490,16 +522,37 @@ void lsmod_print_list (FILE *f, json_t *o, bool longopt)
     json_t *services;
 
     json_array_foreach (o, index, value) {
-        if (json_unpack (value, "{s:s s:s s:i s:i s:o}",
+        double cpu = 0.;
+        json_int_t rxmsgs = 0;
+        json_int_t txmsgs = 0;
+        int lazy = 0;
+
+        if (json_unpack (value,
+                         "{s:s s:s s:i s:i s:o s?F s?{s:I} s?{s:I} s?b}",
                          "name", &name,
                          "path", &path,
                          "idle", &idle,
                          "status", &status,
-                         "services", &services) < 0)
+                         "services", &services,
+                         "cpu", &cpu,
+                         "rx", "msgs", &rxmsgs,
+                         "tx", "msgs", &txmsgs,
+                         "lazy", &lazy) < 0)
             log_msg_exit ("Error parsing lsmod response");
+        if (lazy)
+            status = LSMOD_STATE_LAZY;
         if (!json_is_array (services))
             log_msg_exit ("Error parsing lsmod services array");
-        lsmod_print_entry (f, name, path, idle, status, services, longopt);
+        lsmod_print_entry (f,
+                           name,
+                           path,
+                           idle,
+                           status,
+                           services,
+                           cpu,
+                           rxmsgs,
+                           txmsgs,
+                           longopt);
     }
 }
 
@@ -604,6 +657,20 @@ int cmd_stats (optparse_t *p, int argc, char **argv)
         if (flux_send (h, msg, 0) < 0)
             log_err_exit ("sending event");
         flux_msg_destroy (msg);
+    } else if (optparse_hasopt (p, "history")) {
+        topic = xasprintf ("broker.module-history");
+        if (!(f = flux_rpc_pack (h,
+                                 topic,
+                                 nodeid,
+                                 0,
+                                 "{s:s}",
+                                 "name", service)))
+            log_err_exit ("%s", topic);
+        if (flux_rpc_get (f, &json_str) < 0)
+            log_err_exit ("%s", topic);
+        if (!json_str)
+            log_errn_exit (EPROTO, "%s", topic);
+        parse_json (p, json_str);
     } else if (optparse_hasopt (p, "rusage")) {
         topic = xasprintf ("%s.rusage", service);
         if (!(f = flux_rpc (h, topic, NULL, nodeid, 0)))
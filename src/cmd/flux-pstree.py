@@ -9,7 +9,6 @@
 ##############################################################
 
 import argparse
-import concurrent.futures
 import logging
 import sys
 
@@ -111,28 +110,43 @@ class TreeFormatter:
         return ""
 
 
-def process_entry(entry, formatter, filters, level, max_level, combine):
+def fetch_jobs(uri, filters, jobids=None):
+    """Return a list of job entries from the instance at uri
 
-    job = JobInfo(entry).get_instance_info()
+    This may fail if the instance hasn't loaded the job-list module
+    or if the current user is not owner, in which case an empty list
+    is returned.
+    """
+    try:
+        jobs_rpc = JobList(
+            flux.Flux(uri), ids=jobids, filters=filters, attrs=["all"]
+        ).fetch_jobs()
+        jobs = jobs_rpc.get_jobs()
+    except (OSError, FileNotFoundError):
+        return []
 
-    # pylint: disable=comparison-with-callable
-    parent = job.uri and job.state_single == "R"
+    #  Print all errors accumulated in JobList RPC:
+    #  fetch_jobs() may not set errors list, must check first
+    if hasattr(jobs_rpc, "errors"):
+        try:
+            for err in jobs_rpc.errors:
+                print(err, file=sys.stderr)
+        except EnvironmentError:
+            pass
+    return jobs
 
-    label = formatter.format(job, parent)
-    prefix = formatter.format_prefix(job)
 
-    if not parent:
-        return Tree(label, prefix)
-    return load_tree(
-        label,
-        formatter,
-        prefix=prefix,
-        uri=str(job.uri),
-        filters=filters,
-        level=level + 1,
-        max_level=max_level,
-        combine_children=combine,
-    )
+class Node:
+    """A job in the tree, with the job-list query for its children"""
+
+    def __init__(self, entry, level):
+        self.entry = entry
+        self.level = level
+        self.job = None
+
+    def is_parent(self):
+        # pylint: disable=comparison-with-callable
+        return self.job.uri and self.job.state_single == "R"
 
 
 # pylint: disable=too-many-locals
@@ -148,61 +162,46 @@ def load_tree(
     skip_root=True,
     jobids=None,
 ):
+    """Load the tree of jobs below the instance at uri
+
+    Each nested instance is queried concurrently with the other
+    instances at the same depth, so the number of rounds of queries is
+    proportional to the depth of the hierarchy.
+    """
 
     #  Only apply filters below root unless no_skip_root
     orig_filters = filters
     if filters is None or (level == 0 and skip_root):
         filters = ["running"]
+    if orig_filters is None:
+        orig_filters = ["running"]
 
     tree = Tree(label, prefix=prefix, combine_children=combine_children)
     if level > max_level:
         return tree
 
-    #  Attempt to load jobs from uri
-    #  This may fail if the instance hasn't loaded the job-list module
-    #   or if the current user is not owner
-    #
-    try:
-        jobs_rpc = JobList(
-            flux.Flux(uri), ids=jobids, filters=filters, attrs=["all"]
-        ).fetch_jobs()
-        jobs = jobs_rpc.get_jobs()
-    except (OSError, FileNotFoundError):
-        return tree
-
-    #  Print all errors accumulated in JobList RPC:
-    #  fetch_jobs() may not set errors list, must check first
-    if hasattr(jobs_rpc, "errors"):
-        try:
-            for err in jobs_rpc.errors:
-                print(err, file=sys.stderr)
-        except EnvironmentError:
-            pass
-
-    #  Since the executor cannot be used recursively, start one per
-    #   loop iteration. This is very wasteful but greatly speeds up
-    #   execution with even a moderate number of jobs using the ssh:
-    #   connector. At some point this should be replaced by a global
-    #   thread pool that can work with recursive execution.
-    #
-    executor = concurrent.futures.ThreadPoolExecutor()
-    futures = []
-    for entry in jobs:
-        futures.append(
-            executor.submit(
-                process_entry,
-                entry,
-                formatter,
-                orig_filters,
-                level,
-                max_level,
-                combine_children,
-            )
-        )
-
-    for future in futures:
-        tree.append_tree(future.result())
-
+    def visit(node):
+        node.job = JobInfo(node.entry).get_instance_info()
+        if node.is_parent() and node.level + 1 <= max_level:
+            return fetch_jobs(str(node.job.uri), orig_filters)
+        return []
+
+    def get_children(node, entries):
+        return [Node(entry, node.level + 1) for entry in entries]
+
+    def build(parent, entries):
+        for node, _, children in entries:
+            label = formatter.format(node.job, node.is_parent())
+            prefix = formatter.format_prefix(node.job)
+            if not node.is_parent():
+                parent.append_tree(Tree(label, prefix))
+                continue
+            subtree = Tree(label, prefix=prefix, combine_children=combine_children)
+            build(subtree, children)
+            parent.append_tree(subtree)
+
+    roots = [Node(entry, level) for entry in fetch_jobs(uri, filters, jobids)]
+    build(tree, flux.util.tree_map(visit, roots, get_children))
     return tree
 
 
@@ -14,7 +14,6 @@ import json
 import logging
 import os.path
 import sys
-from itertools import combinations
 
 import flux
 from flux.hostlist import Hostlist
@@ -512,30 +511,26 @@ class ResourceSetExtra(ResourceSet):
 
 def split_by_property_combinations(rset):
     """
-    Split a resource set by all combinations of its properties.
-    This is done in hopes of splitting a resource into the minimum number
-    of subsets that may produce unique lines in the resource listing output.
+    Split a resource set into subsets of ranks that have the same
+    combination of properties, i.e. the minimum number of subsets that
+    may produce unique lines in the resource listing output.
+
+    Properties are assigned per rank, so group ranks by their property
+    combination directly.  Only combinations that occur are generated,
+    rather than every possible one, which is exponential in the number
+    of properties.
     """
+    rank_properties = {}
+    for name, ranks in json.loads(rset.get_properties()).items():
+        for rank in IDset(ranks):
+            rank_properties.setdefault(rank, []).append(name)
 
-    def constraint_combinations(rset):
-        properties = set(json.loads(rset.get_properties()).keys())
-        sets = [
-            set(combination)
-            for i in range(1, len(properties) + 1)
-            for combination in combinations(properties, i)
-        ]
-        # Also include the empty set, i.e. resources with no properties
-        sets.append(set())
-
-        # generate RFC 31 constraint objects for each property combination
-        result = []
-        for cset in sets:
-            diff = properties - cset
-            cset.update(["^" + x for x in diff])
-            result.append({"properties": list(cset)})
-        return result
-
-    return [rset.copy_constraint(x) for x in constraint_combinations(rset)]
+    groups = {}
+    for rank in rset.ranks:
+        key = tuple(sorted(rank_properties.get(rank, [])))
+        groups.setdefault(key, IDset()).set(rank)
+
+    return [rset.copy_ranks(ranks) for ranks in groups.values()]
 
 
 def resources_uniq_lines(resources, states, formatter, config):
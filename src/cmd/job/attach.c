@@ -15,6 +15,7 @@
 #endif
 #include <unistd.h>
 #include <stdio.h>
+#include <time.h>
 #include <jansson.h>
 #include <sys/ioctl.h>
 #include <signal.h>
@@ -65,6 +66,15 @@ struct optparse_option attach_opts[] = {
     { .name = "label-io", .key = 'l', .has_arg = 0,
       .usage = "Label output by rank",
     },
+    { .name = "tail", .key = 'n', .has_arg = 1, .arginfo = "N",
+      .usage = "Start with the last N entries of output already written",
+    },
+    { .name = "skip", .has_arg = 1, .arginfo = "N",
+      .usage = "Skip the first N entries of output",
+    },
+    { .name = "since", .has_arg = 1, .arginfo = "FSD",
+      .usage = "Only display output written in the last FSD",
+    },
     { .name = "verbose", .key = 'v', .has_arg = 0,
       .usage = "Increase verbosity",
     },
@@ -483,17 +493,43 @@ void attach_stdin_cb (flux_reactor_t *r, flux_watcher_t *w,
     }
 }
 
-/*  Start the guest.output eventlog watcher
+/*  Start the guest.output eventlog watcher.
+ *  If --tail, --skip, or --since were specified, job-info passes over
+ *  the corresponding output entries, so they are never sent or decoded
+ *  here.  The header entry may be among them, but it carries nothing
+ *  that is needed, so consider it parsed.
  */
 void attach_output_start (struct attach_ctx *ctx)
 {
+    int tail = optparse_get_int (ctx->p, "tail", 0);
+    int skip = optparse_get_int (ctx->p, "skip", 0);
+    double since = 0.;
+
     if (ctx->output_f)
         return;
 
-    if (!(ctx->output_f = flux_job_event_watch (ctx->h,
-                                                ctx->id,
-                                                "guest.output",
-                                                0)))
+    if (optparse_hasopt (ctx->p, "since")) {
+        double duration = optparse_get_duration (ctx->p, "since", 0.);
+        struct timespec now;
+        clock_gettime (CLOCK_REALTIME, &now);
+        since = now.tv_sec + now.tv_nsec * 1E-9 - duration;
+    }
+    if (tail < 0 || skip < 0)
+        log_msg_exit ("--tail and --skip values must not be negative");
+    if (tail > 0 || skip > 0 || since > 0.)
+        ctx->output_header_parsed = true;
+
+    if (!(ctx->output_f = flux_rpc_pack (ctx->h,
+                                         "job-info.eventlog-watch",
+                                         FLUX_NODEID_ANY,
+                                         FLUX_RPC_STREAMING,
+                                         "{s:I s:s s:i s:i s:i s:f}",
+                                         "id", ctx->id,
+                                         "path", "guest.output",
+                                         "flags", 0,
+                                         "tail", tail,
+                                         "skip", skip,
+                                         "since", since)))
         log_err_exit ("flux_job_event_watch");
 
     if (flux_future_then (ctx->output_f, -1.,
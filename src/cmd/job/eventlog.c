@@ -45,6 +45,9 @@ struct optparse_option eventlog_opts[] =  {
       .usage = "Specify alternate eventlog name or path suffix "
                "(e.g. \"exec\", \"output\", or \"guest.exec.eventlog\")",
     },
+    { .name = "tail", .key = 'n', .has_arg = 1, .arginfo = "N",
+      .usage = "Display only the last N events",
+    },
     OPTPARSE_TABLE_END
 };
 
@@ -203,11 +206,24 @@ int cmd_eventlog (optparse_t *p, int argc, char **argv)
         log_err_exit ("eventlog_formatter_create");
     formatter_parse_options (p, ctx.evf);
 
-    if (!(f = flux_rpc_pack (h, topic, FLUX_NODEID_ANY, 0,
-                             "{s:I s:[s] s:i}",
-                             "id", ctx.id,
-                             "keys", ctx.path,
-                             "flags", 0)))
+    if (optparse_hasopt (p, "tail")) {
+        int count = optparse_get_int (p, "tail", 0);
+        if (count <= 0)
+            log_msg_exit ("--tail value must be greater than zero");
+        f = flux_rpc_pack (h, "job-info.eventlog-tail", FLUX_NODEID_ANY, 0,
+                           "{s:I s:s s:i}",
+                           "id", ctx.id,
+                           "key", ctx.path,
+                           "count", count);
+    }
+    else {
+        f = flux_rpc_pack (h, topic, FLUX_NODEID_ANY, 0,
+                           "{s:I s:[s] s:i}",
+                           "id", ctx.id,
+                           "keys", ctx.path,
+                           "flags", 0);
+    }
+    if (!f)
         log_err_exit ("flux_rpc_pack");
     if (flux_future_then (f, -1., eventlog_continuation, &ctx) < 0)
         log_err_exit ("flux_future_then");
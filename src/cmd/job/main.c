@@ -94,6 +94,9 @@ extern int cmd_last (optparse_t *p, int argc, char **argv);
 extern int cmd_hostpids (optparse_t *p, int argc, char **argv);
 extern struct optparse_option hostpids_opts[];
 
+extern int cmd_timing (optparse_t *p, int argc, char **argv);
+extern struct optparse_option timing_opts[];
+
 
 static struct optparse_option global_opts[] =  {
     OPTPARSE_TABLE_END
@@ -268,6 +271,13 @@ static struct optparse_subcommand subcommands[] = {
       0,
       hostpids_opts,
     },
+    { "timing",
+      "[OPTIONS] JOBID",
+      "Display job shell startup phase timing (requires -o timing)",
+      cmd_timing,
+      0,
+      timing_opts,
+    },
     { "last",
       "SLICE",
       "List my most recently submitted job id(s)",
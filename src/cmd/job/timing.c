@@ -0,0 +1,316 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* flux-job timing */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdio.h>
+#include <string.h>
+#include <float.h>
+#include <jansson.h>
+
+#include <flux/core.h>
+#include <flux/optparse.h>
+
+#include "src/common/libutil/log.h"
+#include "src/common/libeventlog/eventlog.h"
+#include "ccan/str/str.h"
+#include "common.h"
+
+struct optparse_option timing_opts[] =  {
+    { .name = "plugins",
+      .key = 'p',
+      .has_arg = 0,
+      .usage = "Also list the slowest shell plugin callbacks",
+    },
+    { .name = "timeout",
+      .key = 't',
+      .has_arg = 1,
+      .arginfo = "DURATION",
+      .usage = "timeout after DURATION",
+    },
+    OPTPARSE_TABLE_END
+};
+
+#define BAR_WIDTH 30
+
+struct phase {
+    const char *name;
+    double start_sum;   // sum of start offsets
+    double end_max;     // latest end offset
+    double min;
+    double max;
+    double sum;
+    int max_rank;
+    int count;
+};
+
+/* Wait for the shell.timing event in the exec eventlog of 'id' and
+ * return its "ranks" array.
+ */
+static json_t *get_timing_records (flux_t *h, flux_jobid_t id, double timeout)
+{
+    flux_future_t *f;
+    json_t *ranks = NULL;
+
+    if (!(f = flux_job_event_watch (h,
+                                    id,
+                                    "guest.exec.eventlog",
+                                    FLUX_JOB_EVENT_WATCH_WAITCREATE)))
+        log_err_exit ("flux_job_event_watch");
+    while (!ranks) {
+        const char *entry;
+        const char *name;
+        json_t *o;
+        json_t *context;
+
+        if (flux_future_wait_for (f, timeout) < 0 && errno == ETIMEDOUT)
+            log_msg_exit ("timeout waiting for shell.timing event");
+        if (flux_job_event_watch_get (f, &entry) < 0) {
+            if (errno == ENODATA)
+                log_msg_exit ("no shell.timing event"
+                              " (was the job run with -o timing?)");
+            if (errno == ENOENT)
+                log_msg_exit ("no such job");
+            log_msg_exit ("waiting for shell.timing event: %s",
+                          future_strerror (f, errno));
+        }
+        if (!(o = eventlog_entry_decode (entry)))
+            log_err_exit ("eventlog_entry_decode");
+        if (eventlog_entry_parse (o, NULL, &name, &context) < 0)
+            log_err_exit ("eventlog_entry_parse");
+        if (streq (name, "shell.timing")) {
+            if (!(ranks = json_object_get (context, "ranks"))
+                || !json_is_array (ranks))
+                log_msg_exit ("malformed shell.timing event");
+            json_incref (ranks);
+            flux_job_event_watch_cancel (f);
+        }
+        json_decref (o);
+        flux_future_reset (f);
+    }
+    flux_future_destroy (f);
+    return ranks;
+}
+
+static struct phase *phase_lookup (struct phase *phases,
+                                   int *nphases,
+                                   const char *name)
+{
+    struct phase *p;
+
+    for (int i = 0; i < *nphases; i++) {
+        if (streq (phases[i].name, name))
+            return &phases[i];
+    }
+    p = &phases[(*nphases)++];
+    memset (p, 0, sizeof (*p));
+    p->name = name;
+    p->min = DBL_MAX;
+    return p;
+}
+
+/* Print a bar spanning [start, end] on a scale of [0, total].
+ */
+static void print_bar (double start, double end, double total)
+{
+    char bar[BAR_WIDTH + 1];
+    int a = 0;
+    int b = 0;
+
+    if (total > 0.) {
+        a = start / total * BAR_WIDTH;
+        b = end / total * BAR_WIDTH;
+    }
+    if (a >= BAR_WIDTH)
+        a = BAR_WIDTH - 1;
+    if (b <= a)
+        b = a + 1;
+    if (b > BAR_WIDTH)
+        b = BAR_WIDTH;
+    memset (bar, ' ', BAR_WIDTH);
+    memset (bar + a, '#', b - a);
+    bar[BAR_WIDTH] = '\0';
+    printf ("|%s|", bar);
+}
+
+static void print_phases (json_t *ranks)
+{
+    size_t index;
+    json_t *record;
+    double t0 = DBL_MAX;
+    double total = 0.;
+    struct phase *phases = NULL;
+    int nphases = 0;
+    int maxphases = 0;
+
+    json_array_foreach (ranks, index, record) {
+        double start;
+        if (json_unpack (record, "{s:F}", "start", &start) < 0)
+            log_msg_exit ("malformed shell.timing record");
+        if (start < t0)
+            t0 = start;
+    }
+    json_array_foreach (ranks, index, record) {
+        int rank;
+        double start;
+        json_t *a;
+        size_t i;
+        json_t *entry;
+        double offset;
+
+        if (json_unpack (record,
+                         "{s:i s:F s:o}",
+                         "rank", &rank,
+                         "start", &start,
+                         "phases", &a) < 0
+            || !json_is_array (a))
+            log_msg_exit ("malformed shell.timing record");
+        if (maxphases < nphases + json_array_size (a)) {
+            maxphases = nphases + json_array_size (a);
+            if (!(phases = realloc (phases, maxphases * sizeof (*phases))))
+                log_msg_exit ("out of memory");
+        }
+        offset = start - t0;
+        json_array_foreach (a, i, entry) {
+            const char *name;
+            double t;
+            struct phase *p;
+
+            if (json_unpack (entry, "[s F]", &name, &t) < 0)
+                log_msg_exit ("malformed shell.timing phase");
+            p = phase_lookup (phases, &nphases, name);
+            p->start_sum += offset;
+            offset += t;
+            if (p->end_max < offset)
+                p->end_max = offset;
+            if (p->min > t)
+                p->min = t;
+            if (p->max < t) {
+                p->max = t;
+                p->max_rank = rank;
+            }
+            p->sum += t;
+            p->count++;
+        }
+        if (total < offset)
+            total = offset;
+    }
+    printf ("%-16s %8s %8s %8s %8s %5s\n",
+            "PHASE", "START", "MIN", "AVG", "MAX", "RANK");
+    for (int i = 0; i < nphases; i++) {
+        struct phase *p = &phases[i];
+        double start = p->start_sum / p->count;
+
+        printf ("%-16s %8.3f %8.3f %8.3f %8.3f %5d ",
+                p->name,
+                start,
+                p->min,
+                p->sum / p->count,
+                p->max,
+                p->max_rank);
+        print_bar (start, p->end_max, total);
+        printf ("\n");
+    }
+    printf ("%-16s %8s %8s %8s %8.3f\n", "total", "", "", "", total);
+    free (phases);
+}
+
+static void print_plugins (json_t *ranks)
+{
+    size_t index;
+    json_t *record;
+    json_t *max;
+
+    /* Build {"topic/plugin":[seconds, rank]} holding the slowest rank
+     * for each plugin callback.
+     */
+    if (!(max = json_object ()))
+        log_msg_exit ("out of memory");
+    json_array_foreach (ranks, index, record) {
+        int rank;
+        json_t *plugins;
+        const char *topic;
+        json_t *o;
+
+        if (json_unpack (record,
+                         "{s:i s:o}",
+                         "rank", &rank,
+                         "plugins", &plugins) < 0)
+            log_msg_exit ("malformed shell.timing record");
+        json_object_foreach (plugins, topic, o) {
+            const char *name;
+            json_t *val;
+
+            json_object_foreach (o, name, val) {
+                char key[256];
+                double t = json_real_value (val);
+                double prev;
+                json_t *entry;
+
+                snprintf (key, sizeof (key), "%s %s", topic, name);
+                if ((entry = json_object_get (max, key))
+                    && json_unpack (entry, "[F]", &prev) == 0
+                    && prev >= t)
+                    continue;
+                if (json_object_set_new (max,
+                                         key,
+                                         json_pack ("[f i]", t, rank)) < 0)
+                    log_msg_exit ("out of memory");
+            }
+        }
+    }
+    printf ("\n%-40s %8s %5s\n", "CALLBACK", "MAX", "RANK");
+    {
+        const char *key;
+        json_t *entry;
+
+        json_object_foreach (max, key, entry) {
+            double t;
+            int rank;
+            if (json_unpack (entry, "[F i]", &t, &rank) < 0)
+                log_msg_exit ("malformed plugin timing");
+            printf ("%-40s %8.3f %5d\n", key, t, rank);
+        }
+    }
+    json_decref (max);
+}
+
+int cmd_timing (optparse_t *p, int argc, char **argv)
+{
+    int optindex = optparse_option_index (p);
+    double timeout = optparse_get_duration (p, "timeout", -1.);
+    flux_jobid_t id;
+    flux_t *h;
+    json_t *ranks;
+
+    if (argc - optindex != 1) {
+        optparse_print_usage (p);
+        exit (1);
+    }
+    id = parse_jobid (argv[optindex]);
+
+    if (!(h = flux_open (NULL, 0)))
+        log_err_exit ("flux_open");
+
+    ranks = get_timing_records (h, id, timeout);
+    print_phases (ranks);
+    if (optparse_hasopt (p, "plugins"))
+        print_plugins (ranks);
+
+    json_decref (ranks);
+    flux_close (h);
+    return 0;
+}
+
+/* vi: ts=4 sw=4 expandtab
+ */
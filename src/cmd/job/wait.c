@@ -14,6 +14,7 @@
 #include "config.h"
 #endif
 #include <stdio.h>
+#include <jansson.h>
 
 #include <flux/core.h>
 #include <flux/optparse.h>
@@ -55,32 +56,49 @@ int cmd_wait (optparse_t *p, int argc, char **argv)
     if (!(h = flux_open (NULL, 0)))
         log_err_exit ("flux_open");
     if (optparse_hasopt (p, "all")) {
+        /* A streaming wait returns the results of many jobs per response
+         * and ends with ENODATA when there are no more waitable jobs.
+         */
+        if (!(f = flux_rpc_pack (h,
+                                 "job-manager.wait",
+                                 FLUX_NODEID_ANY,
+                                 FLUX_RPC_STREAMING,
+                                 "{s:I}",
+                                 "id", FLUX_JOBID_ANY)))
+            log_err_exit ("flux_rpc_pack");
         for (;;) {
-            if (!(f = flux_job_wait (h, FLUX_JOBID_ANY)))
-                log_err_exit ("flux_job_wait");
-            if (flux_job_wait_get_status (f, &success, &errstr) < 0) {
-                if (errno == ECHILD) { // no more waitable jobs
-                    flux_future_destroy (f);
+            json_t *jobs;
+            size_t index;
+            json_t *entry;
+
+            if (flux_rpc_get_unpack (f, "{s:o}", "jobs", &jobs) < 0) {
+                if (errno == ENODATA) // no more waitable jobs
                     break;
-                }
-                log_msg_exit ("flux_job_wait_get_status: %s",
-                              future_strerror (f, errno));
-            }
-            if (flux_job_wait_get_id (f, &id) < 0)
-                log_msg_exit ("flux_job_wait_get_id: %s",
-                              future_strerror (f, errno));
-            if (!success) {
-                fprintf (stderr, "%s: %s\n", idf58 (id), errstr);
-                rc = 1;
+                log_msg_exit ("wait: %s", future_strerror (f, errno));
             }
-            else {
-                if (optparse_hasopt (p, "verbose"))
-                    fprintf (stderr,
-                             "%s: job completed successfully\n",
-                             idf58 (id));
+            json_array_foreach (jobs, index, entry) {
+                int ok;
+
+                if (json_unpack (entry,
+                                 "{s:I s:b s:s}",
+                                 "id", &id,
+                                 "success", &ok,
+                                 "errstr", &errstr) < 0)
+                    log_msg_exit ("error decoding wait response");
+                if (!ok) {
+                    fprintf (stderr, "%s: %s\n", idf58 (id), errstr);
+                    rc = 1;
+                }
+                else {
+                    if (optparse_hasopt (p, "verbose"))
+                        fprintf (stderr,
+                                 "%s: job completed successfully\n",
+                                 idf58 (id));
+                }
             }
-            flux_future_destroy (f);
+            flux_future_reset (f);
         }
+        flux_future_destroy (f);
     }
     else {
         if (!(f = flux_job_wait (h, id)))
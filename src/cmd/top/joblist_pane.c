@@ -18,6 +18,7 @@
 #include <jansson.h>
 
 #include "src/common/libutil/fsd.h"
+#include "src/common/libutil/jpath.h"
 #include "src/common/libjob/idf58.h"
 #include "ccan/str/str.h"
 
@@ -383,6 +384,138 @@ void joblist_pane_query (struct joblist_pane *joblist)
         fatal (errno, "error sending job-list.list RPC request");
 }
 
+static void joblist_update (struct joblist_pane *joblist)
+{
+    joblist_filter_jobs (joblist);
+    joblist_pane_draw (joblist);
+}
+
+/* Insert 'job' into jobs_all, replacing any previous entry for the same
+ * job, and keeping the most recently started jobs first as job-list does.
+ */
+static void joblist_insert (struct joblist_pane *joblist, json_t *job)
+{
+    flux_jobid_t id;
+    double t_run;
+    int index;
+    size_t i;
+    json_t *entry;
+
+    if (json_unpack (job, "{s:I s:f}", "id", &id, "t_run", &t_run) < 0)
+        return;
+    if ((index = lookup_jobid_index (joblist->jobs_all, id)) >= 0)
+        json_array_remove (joblist->jobs_all, index);
+    json_array_foreach (joblist->jobs_all, i, entry) {
+        double t;
+        if (json_unpack (entry, "{s:f}", "t_run", &t) == 0 && t < t_run)
+            break;
+    }
+    if (json_array_insert (joblist->jobs_all, i, job) < 0)
+        fatal (ENOMEM, "error inserting job in joblist");
+    while (json_array_size (joblist->jobs_all) > win_dim.y_length - 1)
+        json_array_remove (joblist->jobs_all,
+                           json_array_size (joblist->jobs_all) - 1);
+}
+
+static void list_id_continuation (flux_future_t *f, void *arg)
+{
+    struct joblist_pane *joblist = arg;
+    json_t *job;
+    int state;
+
+    /* The job may be gone by now, or job-list may not be loaded.
+     * Either way, there is nothing to add.
+     */
+    if (flux_rpc_get_unpack (f, "{s:o}", "job", &job) == 0
+        && json_unpack (job, "{s:i}", "state", &state) == 0
+        && (state & FLUX_JOB_STATE_RUNNING)
+        && joblist->jobs_all) {
+        joblist_insert (joblist, job);
+        joblist_update (joblist);
+    }
+    flux_future_destroy (f);
+}
+
+/* Fetch one newly running job from job-list.  Ask job-list to wait for the
+ * job to reach RUN state, since it may not have processed the alloc event
+ * that triggered this request yet.
+ */
+static void joblist_query_id (struct joblist_pane *joblist, flux_jobid_t id)
+{
+    flux_future_t *f;
+
+    if (!(f = flux_rpc_pack (joblist->top->h,
+                             "job-list.list-id",
+                             0,
+                             0,
+                             "{s:I s:i s:[s,s,s,s,s,s,s,s]}",
+                             "id", id,
+                             "state", FLUX_JOB_STATE_RUN,
+                             "attrs",
+                               "annotations",
+                               "userid",
+                               "state",
+                               "name",
+                               "queue",
+                               "nnodes",
+                               "ntasks",
+                               "t_run"))
+        || flux_future_then (f, -1, list_id_continuation, joblist) < 0)
+        fatal (errno, "error sending job-list.list-id RPC request");
+}
+
+/* Apply a memo event to the job's user annotations, as job-list does.
+ */
+static void joblist_memo (struct joblist_pane *joblist,
+                          json_t *job,
+                          json_t *context)
+{
+    json_t *annotations;
+
+    if (!(annotations = json_object_get (job, "annotations"))
+        || !json_is_object (annotations)) {
+        if (!(annotations = json_object ())
+            || json_object_set_new (job, "annotations", annotations) < 0)
+            fatal (ENOMEM, "error creating job annotations");
+    }
+    if (jpath_update (annotations, "user", context) < 0
+        || jpath_clear_null (annotations) < 0)
+        fatal (errno, "error updating job annotations");
+}
+
+/* Update the job list incrementally from a job-manager journal event.
+ * Return true if the list may now be missing jobs that are running, so
+ * the caller should schedule a full query.
+ */
+bool joblist_pane_jobevent (struct joblist_pane *joblist,
+                            flux_jobid_t id,
+                            const char *name,
+                            json_t *context)
+{
+    int index;
+
+    if (!joblist->jobs_all)
+        return true;
+    if (streq (name, "alloc"))
+        joblist_query_id (joblist, id);
+    else if ((index = lookup_jobid_index (joblist->jobs_all, id)) >= 0) {
+        if (streq (name, "memo") && context) {
+            joblist_memo (joblist,
+                          json_array_get (joblist->jobs_all, index),
+                          context);
+            joblist_update (joblist);
+        }
+        else if (streq (name, "clean")) {
+            bool full = json_array_size (joblist->jobs_all)
+                        == win_dim.y_length - 1;
+            json_array_remove (joblist->jobs_all, index);
+            joblist_update (joblist);
+            return full;
+        }
+    }
+    return false;
+}
+
 void joblist_pane_refresh (struct joblist_pane *joblist)
 {
     wnoutrefresh (joblist->win);
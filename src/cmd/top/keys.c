@@ -70,6 +70,13 @@ static void keys_cb (flux_reactor_t *r,
             summary_pane_draw (keys->top->summary_pane);
             joblist_pane_draw (keys->top->joblist_pane);
             break;
+        case KEY_RESIZE:
+            clear ();
+            summary_pane_query (keys->top->summary_pane);
+            joblist_pane_query (keys->top->joblist_pane);
+            summary_pane_draw (keys->top->summary_pane);
+            joblist_pane_draw (keys->top->joblist_pane);
+            break;
     }
 }
 
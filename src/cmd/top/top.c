@@ -23,6 +23,12 @@
 
 static const double job_activity_rate_limit = 2;
 
+/* When panes are updated from the job manager journal, resource counts
+ * only change on alloc and free events, so merely re-query resources
+ * every N heartbeats to catch nodes going up or down.
+ */
+static const unsigned int resource_poll_heartbeats = 15;
+
 __attribute__ ((noreturn)) void fatal (int errnum, const char *fmt, ...)
 {
     va_list ap;
@@ -60,7 +66,9 @@ static void heartbeat_cb (flux_t *h,
     summary_pane_heartbeat (top->summary_pane);
     summary_pane_draw (top->summary_pane);
     joblist_pane_draw (top->joblist_pane);
-    summary_pane_query (top->summary_pane);
+    if (!top->journal_active
+        || ++top->heartbeat_count % resource_poll_heartbeats == 0)
+        summary_pane_query (top->summary_pane);
 }
 
 static void jobtimer_cb (flux_reactor_t *r,
@@ -70,25 +78,82 @@ static void jobtimer_cb (flux_reactor_t *r,
 {
     struct top *top = arg;
 
-    joblist_pane_query (top->joblist_pane);
+    if (!top->journal_active || top->joblist_stale)
+        joblist_pane_query (top->joblist_pane);
+    if (top->resource_stale)
+        summary_pane_query (top->summary_pane);
+    top->joblist_stale = false;
+    top->resource_stale = false;
     top->jobtimer_running = false;
 }
 
-/* After some job stats activity, and after a rate-limited delay,
- * trigger queries for info in the two panes.
+/* Trigger queries for info in the two panes after a rate-limited delay.
  */
-static void stats_continuation (flux_future_t *f, void *arg)
+static void schedule_query (struct top *top)
 {
-    struct top *top = arg;
     if (!top->jobtimer_running) {
         flux_timer_watcher_reset (top->jobtimer, job_activity_rate_limit, 0.);
         flux_watcher_start (top->jobtimer);
         top->jobtimer_running = true;
     }
+}
+
+/* Unless the journal is keeping the joblist up to date, treat job stats
+ * activity as a hint that the joblist should be queried again.
+ */
+static void stats_continuation (flux_future_t *f, void *arg)
+{
+    struct top *top = arg;
+    if (!top->journal_active)
+        schedule_query (top);
     summary_pane_jobstats (top->summary_pane, f);
     flux_future_reset (f);
 }
 
+/* Handle a response from the job manager journal.  The backlog is skipped,
+ * since the joblist pane made a full query at startup.  Once the sentinel
+ * arrives, each event updates the panes incrementally.  If the journal is
+ * not available, e.g. to guests, fall back to polling job-list.
+ */
+static void journal_continuation (flux_future_t *f, void *arg)
+{
+    struct top *top = arg;
+    flux_jobid_t id;
+    json_t *events;
+    size_t index;
+    json_t *entry;
+
+    if (flux_rpc_get_unpack (f,
+                             "{s:I s:o}",
+                             "id", &id,
+                             "events", &events) < 0) {
+        top->journal_active = false;
+        schedule_query (top);
+        return;
+    }
+    if (id == FLUX_JOBID_ANY)
+        top->journal_active = true;
+    else if (top->journal_active) {
+        json_array_foreach (events, index, entry) {
+            const char *name;
+            json_t *context = NULL;
+
+            if (json_unpack (entry,
+                             "{s:s s?o}",
+                             "name", &name,
+                             "context", &context) < 0)
+                continue;
+            if (joblist_pane_jobevent (top->joblist_pane, id, name, context))
+                top->joblist_stale = true;
+            if (streq (name, "alloc") || streq (name, "free"))
+                top->resource_stale = true;
+        }
+        if (top->joblist_stale || top->resource_stale)
+            schedule_query (top);
+    }
+    flux_future_reset (f);
+}
+
 void refresh_cb (flux_reactor_t *r,
                  flux_watcher_t *w,
                  int revents,
@@ -195,6 +260,7 @@ void top_destroy (struct top *top)
         flux_watcher_destroy (top->refresh);
         flux_watcher_destroy (top->jobtimer);
         flux_future_destroy (top->f_stats);
+        flux_future_destroy (top->f_journal);
         flux_msg_handler_delvec (top->handlers);
         joblist_pane_destroy (top->joblist_pane);
         summary_pane_destroy (top->summary_pane);
@@ -292,6 +358,29 @@ struct top *top_create (const char *uri,
                                  stats_continuation,
                                  top) < 0)
          fatal (errno, "error making streaming job-stats request");
+    /* Running jobs enter the joblist on alloc and leave on clean, and memo
+     * events carry annotations such as the URI of a subinstance.  Jobs
+     * in other states are filtered out so pending jobs cost nothing.
+     */
+    if (!(top->f_journal = flux_rpc_pack (top->h,
+                                          "job-manager.events-journal",
+                                          0,
+                                          FLUX_RPC_STREAMING,
+                                          "{s:{s:i s:i s:i s:i} s:i s:b}",
+                                          "allow",
+                                            "alloc", 1,
+                                            "free", 1,
+                                            "memo", 1,
+                                            "clean", 1,
+                                          "states",
+                                            FLUX_JOB_STATE_RUNNING
+                                            | FLUX_JOB_STATE_INACTIVE,
+                                          "coalesce", 1))
+        || flux_future_then (top->f_journal,
+                             -1,
+                             journal_continuation,
+                             top) < 0)
+        fatal (errno, "error making streaming events-journal request");
 
 #if ASSUME_BROKEN_LOCALE
     top->f_char = "f";
@@ -48,6 +48,11 @@ struct top {
     bool jobtimer_running;
     flux_msg_handler_t **handlers;
     flux_future_t *f_stats;
+    flux_future_t *f_journal;
+    bool journal_active;        // panes are updated from journal events
+    bool joblist_stale;         // joblist needs a full query
+    bool resource_stale;        // resource counts need a query
+    unsigned int heartbeat_count;
 };
 
 struct dimension {
@@ -82,6 +87,10 @@ void joblist_pane_query (struct joblist_pane *joblist);
 void joblist_pane_set_current (struct joblist_pane *joblist, bool next);
 void joblist_pane_enter (struct joblist_pane *joblist);
 void joblist_filter_jobs (struct joblist_pane *joblist);
+bool joblist_pane_jobevent (struct joblist_pane *joblist,
+                            flux_jobid_t id,
+                            const char *name,
+                            json_t *context);
 
 struct keys *keys_create (struct top *top);
 void keys_destroy (struct keys *keys);
@@ -19,6 +19,8 @@
 #include <pwd.h>
 #include <stdio.h>
 
+#include "src/common/libutil/hashmap.h"
+
 #include "top.h"
 
 struct ucache_entry {
@@ -27,28 +29,34 @@ struct ucache_entry {
 };
 
 struct ucache {
-    struct ucache_entry *users;
-    size_t len;
+    struct hashmap *users;      // uid_t => struct ucache_entry
 };
 
-/* Add a new entry to the end of the cache.
+static void ucache_entry_destroy (void **item)
+{
+    if (item) {
+        free (*item);
+        *item = NULL;
+    }
+}
+
+/* Add a new entry to the cache.
  * If memory allocation fails, return NULL with errno set.
  */
 static const char *ucache_add (struct ucache *ucache,
                                uid_t userid,
                                const char *name)
 {
-    struct ucache_entry *new_users;
     struct ucache_entry *entry;
 
-    if (!(new_users = realloc (ucache->users,
-                               sizeof (ucache->users[0]) * (ucache->len + 1))))
+    if (!(entry = calloc (1, sizeof (*entry))))
         return NULL;
-    ucache->users = new_users;
-    entry = &ucache->users[ucache->len++];
-
     entry->id = userid;
     snprintf (entry->name, sizeof (entry->name), "%s", name);
+    if (hashmap_insert (ucache->users, &entry->id, entry) < 0) {
+        free (entry);
+        return NULL;
+    }
     return entry->name;
 }
 
@@ -58,12 +66,11 @@ static const char *ucache_add (struct ucache *ucache,
  */
 const char *ucache_lookup (struct ucache *ucache, uid_t userid)
 {
+    struct ucache_entry *entry;
     struct passwd *pwd;
 
-    for (int i = 0; i < ucache->len; i++) {
-        if (ucache->users[i].id == userid)
-            return ucache->users[i].name;
-    }
+    if ((entry = hashmap_lookup (ucache->users, &userid)))
+        return entry->name;
     if (!(pwd = getpwuid (userid)))
         return NULL;
     return ucache_add (ucache, userid, pwd->pw_name);
@@ -73,7 +80,7 @@ void ucache_destroy (struct ucache *ucache)
 {
     if (ucache) {
         int saved_errno = errno;
-        free (ucache->users);
+        hashmap_destroy (ucache->users);
         free (ucache);
         errno = saved_errno;
     }
@@ -85,6 +92,11 @@ struct ucache *ucache_create (void)
 
     if (!(ucache = calloc (1, sizeof (*ucache))))
         return NULL;
+    if (!(ucache->users = hashmap_create (sizeof (uid_t), NULL, NULL))) {
+        ucache_destroy (ucache);
+        return NULL;
+    }
+    hashmap_set_destructor (ucache->users, ucache_entry_destroy);
     return ucache;
 }
 
@@ -14,6 +14,9 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <errno.h>
+#include <limits.h>
+#include <string.h>
+#include <arpa/inet.h>
 #include <flux/core.h>
 
 #include "content.h"
@@ -54,6 +57,64 @@ flux_future_t *content_load_byblobref (flux_t *h,
     return content_load_byhash (h, hash, hash_size, flags);
 }
 
+flux_future_t *content_load_byhash_hint (flux_t *h,
+                                         const void *hash,
+                                         int hash_len,
+                                         const void *hints,
+                                         int hint_count,
+                                         int flags)
+{
+    flux_future_t *f;
+    uint8_t *buf;
+    size_t len;
+    uint32_t rank = FLUX_NODEID_ANY;
+
+    if (!h || !hash || hash_len <= 0 || hint_count < 0
+        || (hint_count > 0 && !hints)) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (hint_count == 0 || (flags & CONTENT_FLAG_CACHE_BYPASS))
+        return content_load_byhash (h, hash, hash_len, flags);
+    if (hint_count >= INT_MAX / hash_len) {
+        errno = EFBIG;
+        return NULL;
+    }
+    len = (size_t)hash_len * (hint_count + 1);
+    if (!(buf = malloc (len)))
+        return NULL;
+    memcpy (buf, hash, hash_len);
+    memcpy (buf + hash_len, hints, (size_t)hash_len * hint_count);
+    if ((flags & CONTENT_FLAG_UPSTREAM))
+        rank = FLUX_NODEID_UPSTREAM;
+    f = flux_rpc_raw (h, "content.load", buf, len, rank, 0);
+    ERRNO_SAFE_WRAP (free, buf);
+    return f;
+}
+
+int content_prefetch (flux_t *h, const void *hashes, int hash_len, int count)
+{
+    flux_future_t *f;
+
+    if (!h || !hashes || hash_len <= 0 || count <= 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (count > INT_MAX / hash_len) {
+        errno = EFBIG;
+        return -1;
+    }
+    if (!(f = flux_rpc_raw (h,
+                            "content.load",
+                            hashes,
+                            hash_len * count,
+                            FLUX_NODEID_ANY,
+                            FLUX_RPC_NORESPONSE)))
+        return -1;
+    flux_future_destroy (f);
+    return 0;
+}
+
 int content_load_get (flux_future_t *f, const void **buf, int *len)
 {
     return flux_rpc_get_raw (f, buf, len);
@@ -118,6 +179,84 @@ int content_store_get_blobref (flux_future_t *f,
     return 0;
 }
 
+flux_future_t *content_store_batch (flux_t *h,
+                                    const struct iovec *iov,
+                                    int count)
+{
+    flux_future_t *f;
+    uint8_t *buf;
+    size_t len = 0;
+    size_t offset = 0;
+    int *countp;
+
+    if (!h || count < 0 || (count > 0 && !iov)) {
+        errno = EINVAL;
+        return NULL;
+    }
+    for (int i = 0; i < count; i++) {
+        if (iov[i].iov_len > UINT32_MAX) {
+            errno = EFBIG;
+            return NULL;
+        }
+        len += sizeof (uint32_t) + iov[i].iov_len;
+    }
+    if (len > INT_MAX) {
+        errno = EFBIG;
+        return NULL;
+    }
+    if (!(countp = malloc (sizeof (*countp))))
+        return NULL;
+    *countp = count;
+    if (!(buf = malloc (len > 0 ? len : 1))) {
+        ERRNO_SAFE_WRAP (free, countp);
+        return NULL;
+    }
+    for (int i = 0; i < count; i++) {
+        uint32_t blob_len = htonl (iov[i].iov_len);
+
+        memcpy (buf + offset, &blob_len, sizeof (blob_len));
+        offset += sizeof (blob_len);
+        memcpy (buf + offset, iov[i].iov_base, iov[i].iov_len);
+        offset += iov[i].iov_len;
+    }
+    f = flux_rpc_raw (h, "content.store-batch", buf, len, 0, 0);
+    ERRNO_SAFE_WRAP (free, buf);
+    if (!f
+        || flux_future_aux_set (f, "flux::count", countp, free) < 0) {
+        ERRNO_SAFE_WRAP (free, countp);
+        flux_future_destroy (f);
+        return NULL;
+    }
+    return f;
+}
+
+int content_store_batch_get_hash (flux_future_t *f,
+                                  int index,
+                                  const void **hash,
+                                  int *hash_len)
+{
+    const uint8_t *buf;
+    int buf_size;
+    int *countp;
+    int size;
+
+    if (flux_rpc_get_raw (f, (const void **)&buf, &buf_size) < 0)
+        return -1;
+    if (!(countp = flux_future_aux_get (f, "flux::count"))
+        || index < 0
+        || index >= *countp
+        || buf_size % *countp != 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    size = buf_size / *countp;
+    if (hash)
+        *hash = buf + index * size;
+    if (hash_len)
+        *hash_len = size;
+    return 0;
+}
+
 /*
  * vi:tabstop=4 shiftwidth=4 expandtab
  */
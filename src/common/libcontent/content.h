@@ -11,6 +11,8 @@
 #ifndef _FLUX_CONTENT_H
 #define _FLUX_CONTENT_H
 
+#include <sys/uio.h>
+
 /* flags */
 enum {
     CONTENT_FLAG_CACHE_BYPASS = 1,/* request direct to backing store */
@@ -27,6 +29,25 @@ flux_future_t *content_load_byblobref (flux_t *h,
                                        const char *blobref,
                                        int flags);
 
+/* Send request to load blob by hash, with 'hints', a sequence of
+ * 'hint_count' hashes of length 'hash_len' that the caller expects to load
+ * soon.  The content cache starts loading the hinted blobs in the
+ * background, so later loads are answered from the cache.  Hints are not
+ * sent with CONTENT_FLAG_CACHE_BYPASS.
+ */
+flux_future_t *content_load_byhash_hint (flux_t *h,
+                                         const void *hash,
+                                         int hash_len,
+                                         const void *hints,
+                                         int hint_count,
+                                         int flags);
+
+/* Ask the content cache to start loading 'count' blobs whose hashes
+ * of length 'hash_len' are concatenated in 'hashes'.  No response is sent.
+ * Returns 0 on success, -1 on failure with errno set.
+ */
+int content_prefetch (flux_t *h, const void *hashes, int hash_len, int count);
+
 /* Get result of load request (blob).
  * This blocks until response is received.
  * Storage for 'buf' belongs to 'f' and is valid until 'f' is destroyed.
@@ -47,6 +68,22 @@ int content_store_get_blobref (flux_future_t *f,
                                const char *hash_name,
                                const char **blobref);
 
+/* Send one request to store 'count' blobs, described by 'iov'.
+ * The blobs are copied into the request, which is handled on rank 0.
+ */
+flux_future_t *content_store_batch (flux_t *h,
+                                    const struct iovec *iov,
+                                    int count);
+
+/* Get the hash of blob 'index' of a batch store request.
+ * Storage belongs to 'f' and is valid until 'f' is destroyed.
+ * Returns 0 on success, -1 on failure with errno set.
+ */
+int content_store_batch_get_hash (flux_future_t *f,
+                                  int index,
+                                  const void **hash,
+                                  int *hash_len);
+
 #endif /* !_FLUX_CONTENT_H */
 
 /*
@@ -75,6 +75,7 @@ extern "C" {
 #define zlistx_cursor fzlistx_cursor
 #define zlistx_handle_item fzlistx_handle_item
 #define zlistx_find fzlistx_find
+#define zlistx_seek fzlistx_seek
 #define zlistx_detach fzlistx_detach
 #define zlistx_detach_cur fzlistx_detach_cur
 #define zlistx_delete fzlistx_delete
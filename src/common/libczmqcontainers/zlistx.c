@@ -341,6 +341,25 @@ zlistx_find (zlistx_t *self, void *item)
 }
 
 
+//  --------------------------------------------------------------------------
+//  Set the cursor to the item with the given handle, which must be on this
+//  list, so that zlistx_next () continues from it. Returns the item, or NULL
+//  if handle is NULL.
+
+void *
+zlistx_seek (zlistx_t *self, void *handle)
+{
+    assert (self);
+    if (!handle)
+        return NULL;
+
+    node_t *node = (node_t *) handle;
+    assert (node->tag == NODE_TAG);
+    self->cursor = node;
+    return node->item;
+}
+
+
 //  --------------------------------------------------------------------------
 //  Detach an item from the list, using its handle. The item is not modified,
 //  and the caller is responsible for destroying it if necessary. If handle is
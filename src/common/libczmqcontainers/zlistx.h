@@ -113,6 +113,12 @@ CZMQ_EXPORT void *
 CZMQ_EXPORT void *
     zlistx_find (zlistx_t *self, void *item);
 
+//  Set the cursor to the item with the given handle, which must be on this
+//  list, so that zlistx_next () continues from it. Returns the item, or NULL
+//  if handle is NULL.
+CZMQ_EXPORT void *
+    zlistx_seek (zlistx_t *self, void *handle);
+
 //  Detach an item from the list, using its handle. The item is not modified,
 //  and the caller is responsible for destroying it if necessary. If handle is
 //  null, detaches the first item on the list. Returns item that was detached,
@@ -14,14 +14,17 @@
 #include <flux/core.h>
 #include <jansson.h>
 #include <time.h>
+#include <ctype.h>
 
 #include "src/common/libczmqcontainers/czmq_containers.h"
 #include "ccan/str/str.h"
+#include "src/common/libutil/errno_safe.h"
 
 #include "eventlog.h"
 
 static json_t *eventlog_entry_decode_common (const char *event,
                                              bool trailing_newline);
+bool eventlog_entry_validate (json_t *entry);
 
 int eventlog_entry_parse (json_t *entry,
                           double *timestamp,
@@ -52,70 +55,284 @@ int eventlog_entry_parse (json_t *entry,
     return 0;
 }
 
-static int eventlog_entry_append (json_t *a, const char *event)
-{
-    json_t *o = NULL;
-
-    if (!(o = eventlog_entry_decode_common (event, false)))
-        return -1;
-
-    if (json_array_append_new (a, o) < 0) {
-        json_decref (o);
-        errno = ENOMEM;
-        return -1;
-    }
-
-    return 0;
-}
-
 json_t *eventlog_decode (const char *s)
 {
-    char *copy = NULL;
-    char *input;
     json_t *a = NULL;
-    int save_errno;
-    char *ptr;
+    json_t *entry;
+    size_t len;
+    size_t offset = 0;
+    int rc;
 
     if (!s) {
         errno = EINVAL;
         return NULL;
     }
 
-    if (!(copy = strdup (s)))
-        return NULL;
-    input = copy;
+    len = strlen (s);
 
     /* gotta have atleast 1 newline, if not empty string */
-    if (strlen (s) && !(ptr = strchr (input, '\n'))) {
+    if (len && !memchr (s, '\n', len)) {
         errno = EINVAL;
-        goto error;
+        return NULL;
     }
 
     if (!(a = json_array ())) {
         errno = ENOMEM;
-        goto error;
+        return NULL;
     }
 
-    while ((ptr = strchr (input, '\n'))) {
-        (*ptr++) = '\0';
-
-        if (eventlog_entry_append (a, input) < 0)
+    while ((rc = eventlog_decode_next (s, len, &offset, &entry)) > 0) {
+        if (json_array_append_new (a, entry) < 0) {
+            json_decref (entry);
+            errno = ENOMEM;
             goto error;
-
-        input = ptr;
+        }
     }
+    if (rc < 0)
+        goto error;
 
-    free (copy);
     return a;
 
  error:
-    save_errno = errno;
-    free (copy);
-    json_decref (a);
-    errno = save_errno;
+    ERRNO_SAFE_WRAP (json_decref, a);
+    return NULL;
+}
+
+/* Find the entry at '*offset' in 's'.  Return 1 and set 'line' and
+ * 'linelen' to the entry, without its newline, and advance '*offset' to
+ * the next entry.  Return 0 if there is no complete entry at '*offset'.
+ */
+static int next_line (const char *s,
+                      size_t len,
+                      size_t *offset,
+                      const char **line,
+                      size_t *linelen)
+{
+    const char *p;
+
+    if (!s || !offset || *offset > len) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!(p = memchr (s + *offset, '\n', len - *offset)))
+        return 0;
+    *line = s + *offset;
+    *linelen = p - *line;
+    *offset += *linelen + 1;
+    return 1;
+}
+
+int eventlog_decode_next (const char *s,
+                          size_t len,
+                          size_t *offset,
+                          json_t **entry)
+{
+    const char *line;
+    size_t linelen;
+    size_t start;
+    json_t *o = NULL;
+    int rc;
+
+    if (!entry) {
+        errno = EINVAL;
+        return -1;
+    }
+    start = *offset;
+    if ((rc = next_line (s, len, offset, &line, &linelen)) <= 0)
+        return rc;
+    if (linelen == 0
+        || !(o = json_loadb (line, linelen, JSON_ALLOW_NUL, NULL))
+        || !eventlog_entry_validate (o)) {
+        json_decref (o);
+        *offset = start;
+        errno = EINVAL;
+        return -1;
+    }
+    *entry = o;
+    return 1;
+}
+
+/* Minimal scanner for one JSON entry, used to pick out "timestamp" and
+ * "name" while skipping over everything else, including the context.
+ * Each function returns a pointer just past what it consumed, or NULL
+ * if the input is not well formed.  Only what is needed to find the
+ * extent of a value is checked here.
+ */
+static const char *scan_ws (const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+        p++;
+    return p;
+}
+
+static const char *scan_string (const char *p, const char *end)
+{
+    if (p == end || *p++ != '"')
+        return NULL;
+    while (p < end) {
+        if (*p == '"')
+            return p + 1;
+        if (*p == '\\')
+            p++;
+        p++;
+    }
     return NULL;
 }
 
+static const char *scan_value (const char *p, const char *end)
+{
+    int depth = 0;
+
+    if (p == end)
+        return NULL;
+    if (*p == '"')
+        return scan_string (p, end);
+    if (*p != '{' && *p != '[') {
+        const char *start = p;
+        while (p < end && !strchr (",}] \t\r", *p))
+            p++;
+        return p > start ? p : NULL;
+    }
+    do {
+        if (p == end)
+            return NULL;
+        switch (*p) {
+            case '"':
+                if (!(p = scan_string (p, end)))
+                    return NULL;
+                continue;
+            case '{':
+            case '[':
+                depth++;
+                break;
+            case '}':
+            case ']':
+                depth--;
+                break;
+        }
+        p++;
+    } while (depth > 0);
+    return p;
+}
+
+static bool key_is (const char *key, const char *keyend, const char *name)
+{
+    size_t len = strlen (name);
+
+    return keyend - key == len + 2 && !strncmp (key + 1, name, len);
+}
+
+static int scan_entry (const char *line,
+                       size_t linelen,
+                       double *timestamp,
+                       const char **name,
+                       size_t *namelen)
+{
+    const char *p = line;
+    const char *end = line + linelen;
+    bool have_timestamp = false;
+    bool have_name = false;
+
+    p = scan_ws (p, end);
+    if (p == end || *p++ != '{')
+        return -1;
+    p = scan_ws (p, end);
+    while (p < end && *p != '}') {
+        const char *key = p;
+        const char *keyend;
+        const char *val;
+
+        if (!(keyend = scan_string (p, end)))
+            return -1;
+        p = scan_ws (keyend, end);
+        if (p == end || *p++ != ':')
+            return -1;
+        val = scan_ws (p, end);
+        if (!(p = scan_value (val, end)))
+            return -1;
+        if (key_is (key, keyend, "timestamp")) {
+            char *endptr;
+
+            if (*val != '-' && !isdigit (*val))
+                return -1;
+            errno = 0;
+            *timestamp = strtod (val, &endptr);
+            if (errno != 0 || endptr != p)
+                return -1;
+            have_timestamp = true;
+        }
+        else if (key_is (key, keyend, "name")) {
+            /* escaped names are left to the full decoder */
+            if (*val != '"' || memchr (val, '\\', p - val))
+                return -1;
+            *name = val + 1;
+            *namelen = p - val - 2;
+            have_name = true;
+        }
+        p = scan_ws (p, end);
+        if (p < end && *p == ',') {
+            p = scan_ws (p + 1, end);
+            if (p == end || *p != '"')
+                return -1;
+        }
+        else if (p == end || *p != '}')
+            return -1;
+    }
+    if (p == end
+        || scan_ws (p + 1, end) != end
+        || !have_timestamp
+        || !have_name)
+        return -1;
+    return 0;
+}
+
+int eventlog_scan_next (const char *s,
+                        size_t len,
+                        size_t *offset,
+                        double *timestamp,
+                        char *name,
+                        size_t namesz)
+{
+    const char *line;
+    size_t linelen;
+    size_t start;
+    double t = 0.;
+    const char *n = NULL;
+    size_t nlen = 0;
+    json_t *o = NULL;
+    int rc;
+
+    start = *offset;
+    if ((rc = next_line (s, len, offset, &line, &linelen)) <= 0)
+        return rc;
+    if (scan_entry (line, linelen, &t, &n, &nlen) < 0) {
+        /* fall back to a full decode, e.g. for an escaped name */
+        *offset = start;
+        if (eventlog_decode_next (s, len, offset, &o) < 0)
+            return -1;
+        if (eventlog_entry_parse (o, &t, &n, NULL) < 0) {
+            ERRNO_SAFE_WRAP (json_decref, o);
+            *offset = start;
+            return -1;
+        }
+        nlen = strlen (n);
+    }
+    if (name) {
+        if (nlen >= namesz) {
+            json_decref (o);
+            *offset = start;
+            errno = EOVERFLOW;
+            return -1;
+        }
+        memcpy (name, n, nlen);
+        name[nlen] = '\0';
+    }
+    if (timestamp)
+        *timestamp = t;
+    json_decref (o);
+    return 1;
+}
+
 bool eventlog_entry_validate (json_t *entry)
 {
     json_t *name;
@@ -360,35 +577,35 @@ char *eventlog_encode (json_t *a)
 
 int eventlog_contains_event (const char *s, const char *name)
 {
-    json_t *a = NULL;
-    size_t index;
-    json_t *value;
-    int rv = -1;
+    char n[64];
+    size_t len;
+    size_t offset = 0;
+    int rc;
 
     if (!s || !name) {
         errno = EINVAL;
         return -1;
     }
 
-    if (!(a = eventlog_decode (s)))
+    /* gotta have atleast 1 newline, if not empty string */
+    len = strlen (s);
+    if (len && !memchr (s, '\n', len)) {
+        errno = EINVAL;
         return -1;
+    }
 
-    json_array_foreach (a, index, value) {
-        double t;
-        const char *n;
-        json_t *c;
-        if (eventlog_entry_parse (value, &t, &n, &c) < 0)
-            goto out;
-        if (streq (name, n)) {
-            rv = 1;
-            goto out;
+    /* names longer than the buffer can't match, so skip over them */
+    while ((rc = eventlog_scan_next (s, len, &offset, NULL, n, sizeof (n))) > 0
+           || (rc < 0 && errno == EOVERFLOW)) {
+        if (rc < 0) {
+            if (eventlog_scan_next (s, len, &offset, NULL, NULL, 0) < 0)
+                return -1;
+            continue;
         }
+        if (streq (name, n))
+            return 1;
     }
-
-    rv = 0;
-out:
-    json_decref (a);
-    return rv;
+    return rc;
 }
 
 /*
@@ -27,6 +27,30 @@ int eventlog_entry_parse (json_t *entry,
 /* decode an eventlog into an json array of event objects */
 json_t *eventlog_decode (const char *s);
 
+/* decode the eventlog entry at byte '*offset' of eventlog 's' of length
+ * 'len' and advance '*offset' to the next entry.  Start with *offset = 0.
+ * A caller following a growing eventlog may keep the offset and resume
+ * from it after more entries are appended.  Returns 1 on success, 0 if
+ * there is no complete entry at '*offset' (a trailing partial line is
+ * left for a later call), or -1 on error with *offset unchanged.
+ */
+int eventlog_decode_next (const char *s,
+                          size_t len,
+                          size_t *offset,
+                          json_t **entry);
+
+/* like eventlog_decode_next(), but only extract the timestamp and name,
+ * skipping over the context without decoding it.  The name is copied to
+ * 'name' of size 'namesz' (EOVERFLOW if it doesn't fit).  'timestamp' and
+ * 'name' may be NULL.
+ */
+int eventlog_scan_next (const char *s,
+                        size_t len,
+                        size_t *offset,
+                        double *timestamp,
+                        char *name,
+                        size_t namesz);
+
 /* encode json array of event objects into an eventlog */
 char *eventlog_encode (json_t *a);
 
@@ -16,12 +16,30 @@
 #include <flux/core.h>
 
 #include "src/common/libczmqcontainers/czmq_containers.h"
+#include "ccan/str/str.h"
 
 #include "eventlog.h"
 #include "eventlogger.h"
 
+/*  Eventloggers created on the same handle share a group.  When one of
+ *   them commits a batch, the current batches of the others that target
+ *   the same namespace are joined to it, so that appends to many
+ *   eventlogs made at about the same time go out in one KVS commit.
+ */
+struct eventlogger_group {
+    int refcount;
+    zlist_t *loggers;
+};
+
+struct eventlog_append {
+    char *path;
+    char *entrystr;
+};
+
 struct eventlog_batch {
     zlist_t *entries;
+    zlist_t *appends;       /* struct eventlog_append, for joining batches */
+    zlist_t *joined;        /* batches committed along with this one */
     flux_kvs_txn_t *txn;
     flux_watcher_t *timer;
     struct eventlogger *ev;
@@ -37,11 +55,61 @@ struct eventlogger {
     struct eventlog_batch *current;
     struct eventlogger_ops ops;
     void *arg;
+    struct eventlogger_group *group;
 };
 
+static const char *group_auxkey = "flux::eventlogger_group";
+
+static void eventlogger_group_decref (struct eventlogger_group *group)
+{
+    if (group && --group->refcount == 0) {
+        zlist_destroy (&group->loggers);
+        free (group);
+    }
+}
+
+/*  Join the group for handle 'h', creating it if necessary.
+ *  The handle holds one reference, and each member eventlogger another.
+ */
+static struct eventlogger_group *eventlogger_group_join (flux_t *h,
+                                                         struct eventlogger *ev)
+{
+    struct eventlogger_group *group;
+
+    if (!(group = flux_aux_get (h, group_auxkey))) {
+        if (!(group = calloc (1, sizeof (*group))))
+            return NULL;
+        group->refcount = 1;
+        if (!(group->loggers = zlist_new ())
+            || flux_aux_set (h,
+                             group_auxkey,
+                             group,
+                             (flux_free_f)eventlogger_group_decref) < 0) {
+            eventlogger_group_decref (group);
+            return NULL;
+        }
+    }
+    if (zlist_append (group->loggers, ev) < 0) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    group->refcount++;
+    return group;
+}
+
+static void eventlogger_group_leave (struct eventlogger_group *group,
+                                     struct eventlogger *ev)
+{
+    if (group) {
+        zlist_remove (group->loggers, ev);
+        eventlogger_group_decref (group);
+    }
+}
+
 static void eventlogger_decref (struct eventlogger *ev)
 {
     if (ev && --ev->refcount == 0) {
+        eventlogger_group_leave (ev->group, ev);
         free (ev->ns);
         if (ev->pending) {
             assert (zlist_size (ev->pending) == 0);
@@ -80,11 +148,24 @@ int eventlogger_set_commit_timeout (struct eventlogger *ev, double timeout)
     return 0;
 }
 
+static void eventlog_append_destroy (struct eventlog_append *append)
+{
+    if (append) {
+        free (append->path);
+        free (append->entrystr);
+        free (append);
+    }
+}
+
 static void eventlog_batch_destroy (struct eventlog_batch *batch)
 {
     if (batch) {
         if (batch->entries)
             zlist_destroy (&batch->entries);
+        if (batch->appends)
+            zlist_destroy (&batch->appends);
+        if (batch->joined)
+            zlist_destroy (&batch->joined);
         flux_watcher_destroy (batch->timer);
         flux_kvs_txn_destroy (batch->txn);
         free (batch);
@@ -138,13 +219,75 @@ static void eventlog_batch_error (struct eventlog_batch *batch, int errnum)
     }
 }
 
+/*  Joined batches belong to other eventloggers, which are not told
+ *   about the outcome through the future returned to the caller, so
+ *   report errors and completion for them here.
+ */
+static void eventlog_batch_complete_joined (struct eventlog_batch *batch,
+                                            int errnum)
+{
+    struct eventlog_batch *b;
+
+    while ((b = zlist_pop (batch->joined))) {
+        if (errnum)
+            eventlog_batch_error (b, errnum);
+        eventlogger_batch_complete (b);
+    }
+}
+
 static void commit_cb (flux_future_t *f, void *arg)
 {
     struct eventlog_batch *batch = arg;
+
+    eventlog_batch_complete_joined (batch,
+                                    flux_future_get (f, NULL) < 0 ? errno : 0);
     eventlogger_batch_complete (batch);
     flux_future_destroy (f);
 }
 
+static bool ns_equal (const char *ns1, const char *ns2)
+{
+    if (!ns1 || !ns2)
+        return ns1 == ns2;
+    return streq (ns1, ns2);
+}
+
+/*  Move the current batches of other eventloggers in the group that
+ *   target the same namespace into 'batch'.
+ */
+static void eventlogger_join_batches (struct eventlogger *ev,
+                                      struct eventlog_batch *batch)
+{
+    zlist_t *loggers = ev->group->loggers;
+    struct eventlogger *other;
+
+    other = zlist_first (loggers);
+    while (other) {
+        struct eventlog_batch *b = other->current;
+
+        if (other != ev && b && ns_equal (other->ns, ev->ns)) {
+            struct eventlog_append *append;
+
+            if (zlist_append (batch->joined, b) < 0)
+                break; // leave the rest to commit on their own
+            flux_watcher_stop (b->timer);
+            other->current = NULL;
+            append = zlist_first (b->appends);
+            while (append) {
+                if (flux_kvs_txn_put (batch->txn,
+                                      FLUX_KVS_APPEND,
+                                      append->path,
+                                      append->entrystr) < 0) {
+                    eventlog_batch_error (b, errno);
+                    break;
+                }
+                append = zlist_next (b->appends);
+            }
+        }
+        other = zlist_next (loggers);
+    }
+}
+
 static flux_future_t *eventlogger_commit_batch (struct eventlogger *ev,
                                                 struct eventlog_batch *batch)
 {
@@ -166,15 +309,21 @@ static flux_future_t *eventlogger_commit_batch (struct eventlogger *ev,
     }
     else {
         /*  Otherwise, stop any pending timer watcher and start a
-         *   kvs commit operation. Call eventlogger_batch_complete()
-         *   when the commit is done, and return a future to the caller
+         *   kvs commit operation that also carries any batches joined
+         *   from other eventloggers in the group. Call
+         *   eventlogger_batch_complete() when the commit is done, and return a future to the caller
          *   that will be fulfilled on return from that function.
          */
         flux_watcher_stop (batch->timer);
-        if (!(fc = flux_kvs_commit (ev->h, ev->ns, flags, batch->txn)))
-            return NULL;
-        if (!(f = flux_future_and_then (fc, commit_cb, batch)))
+        eventlogger_join_batches (ev, batch);
+        if (!(fc = flux_kvs_commit (ev->h, ev->ns, flags, batch->txn))
+            || !(f = flux_future_and_then (fc, commit_cb, batch))) {
+            int saved_errno = errno;
+            eventlog_batch_complete_joined (batch, saved_errno);
             flux_future_destroy (fc);
+            errno = saved_errno;
+            return NULL;
+        }
     }
     return f;
 }
@@ -218,12 +367,18 @@ static struct eventlog_batch * eventlog_batch_create (struct eventlogger *ev)
     flux_reactor_t *r = flux_get_reactor (ev->h);
     batch->ev = ev;
     batch->entries = zlist_new ();
+    batch->appends = zlist_new ();
+    batch->joined = zlist_new ();
     batch->txn = flux_kvs_txn_create ();
     batch->timer = flux_timer_watcher_create (r,
                                               ev->batch_timeout, 0.,
                                               timer_cb,
                                               batch);
-    if (!batch->entries || !batch->txn || !batch->timer) {
+    if (!batch->entries
+        || !batch->appends
+        || !batch->joined
+        || !batch->txn
+        || !batch->timer) {
         eventlog_batch_destroy (batch);
         return NULL;
     }
@@ -255,6 +410,10 @@ struct eventlogger *eventlogger_create (flux_t *h,
         ev->ops = *ops;
         ev->arg = arg;
         ev->refcount = 1;
+        if (!(ev->group = eventlogger_group_join (h, ev))) {
+            eventlogger_destroy (ev);
+            return NULL;
+        }
     }
     return ev;
 }
@@ -271,6 +430,32 @@ static struct eventlog_batch * eventlog_batch_get (struct eventlogger *ev)
     return batch;
 }
 
+/*  Add an append to 'batch', keeping a copy in case the batch is
+ *   later joined to a batch of another eventlogger.
+ */
+static int eventlog_batch_put (struct eventlog_batch *batch,
+                               const char *path,
+                               const char *entrystr)
+{
+    struct eventlog_append *append;
+
+    if (flux_kvs_txn_put (batch->txn, FLUX_KVS_APPEND, path, entrystr) < 0)
+        return -1;
+    if (!(append = calloc (1, sizeof (*append)))
+        || !(append->path = strdup (path))
+        || !(append->entrystr = strdup (entrystr))
+        || zlist_append (batch->appends, append) < 0) {
+        eventlog_append_destroy (append);
+        errno = ENOMEM;
+        return -1;
+    }
+    zlist_freefn (batch->appends,
+                  append,
+                  (zlist_free_fn *) eventlog_append_destroy,
+                  true);
+    return 0;
+}
+
 static int append_wait (struct eventlogger *ev,
                         const char *path,
                         const char *entrystr)
@@ -280,9 +465,7 @@ static int append_wait (struct eventlogger *ev,
     if (!batch)
         return -1;
 
-    if (flux_kvs_txn_put (ev->current->txn,
-                          FLUX_KVS_APPEND,
-                          path, entrystr) < 0)
+    if (eventlog_batch_put (batch, path, entrystr) < 0)
         return -1;
 
     return eventlogger_flush (ev);
@@ -297,11 +480,8 @@ static int append_async (struct eventlogger *ev,
 
     if (!batch)
         return -1;
-    if (flux_kvs_txn_put (ev->current->txn,
-                          FLUX_KVS_APPEND,
-                          path,
-                          entrystr) < 0)
-            return -1;
+    if (eventlog_batch_put (batch, path, entrystr) < 0)
+        return -1;
 
     if (zlist_append (batch->entries, entry) < 0)
         return -1;
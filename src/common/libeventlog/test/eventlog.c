@@ -511,6 +511,115 @@ void eventlog_contains_event_test (void)
         "eventlog_contains_event returns 0, no foobar event in eventlog");
 }
 
+void eventlog_decode_next_test (void)
+{
+    const char *log =
+        "{\"timestamp\":42.0,\"name\":\"foo\"}\n"
+        "{\"timestamp\":43.0,\"name\":\"bar\",\"context\":{\"bar\":16}}\n"
+        "{\"timestamp\":44.0,\"na";
+    size_t len = strlen (log);
+    size_t offset = 0;
+    size_t first;
+    json_t *entry = NULL;
+    const char *name;
+    double t;
+
+    ok (eventlog_decode_next (log, len, &offset, &entry) == 1
+        && eventlog_entry_parse (entry, &t, &name, NULL) == 0
+        && t == 42.0
+        && streq (name, "foo"),
+        "eventlog_decode_next returns first entry");
+    json_decref (entry);
+    first = offset;
+    ok (offset > 0 && log[offset - 1] == '\n',
+        "eventlog_decode_next advanced offset past first entry");
+    ok (eventlog_decode_next (log, len, &offset, &entry) == 1
+        && eventlog_entry_parse (entry, &t, &name, NULL) == 0
+        && t == 43.0
+        && streq (name, "bar"),
+        "eventlog_decode_next returns second entry");
+    json_decref (entry);
+    ok (eventlog_decode_next (log, len, &offset, &entry) == 0
+        && streq (log + offset, "{\"timestamp\":44.0,\"na"),
+        "eventlog_decode_next returns 0 on partial entry");
+    ok (eventlog_decode_next (log, first, &offset, &entry) < 0
+        && errno == EINVAL,
+        "eventlog_decode_next fails with EINVAL on offset > len");
+
+    offset = first;
+    ok (eventlog_decode_next (log, len, &offset, &entry) == 1
+        && eventlog_entry_parse (entry, &t, NULL, NULL) == 0
+        && t == 43.0,
+        "eventlog_decode_next can resume at a saved offset");
+    json_decref (entry);
+
+    offset = 0;
+    errno = 0;
+    ok (eventlog_decode_next ("foo\n", 4, &offset, &entry) < 0
+        && errno == EINVAL
+        && offset == 0,
+        "eventlog_decode_next fails with EINVAL on bad entry");
+    errno = 0;
+    ok (eventlog_decode_next (log, len, &offset, NULL) < 0
+        && errno == EINVAL,
+        "eventlog_decode_next fails with EINVAL on NULL entry");
+}
+
+void eventlog_scan_next_test (void)
+{
+    const char *log =
+        "{\"timestamp\":42.5,\"name\":\"foo\"}\n"
+        "{\"context\":{\"s\":\"}\\\"]\",\"a\":[1,{}]},"
+            "\"name\":\"bar\",\"timestamp\":43}\n"
+        "{\"timestamp\":44.0,\"name\":\"a\\u0062c\"}\n"
+        "{\"timestamp\":45.0,\"name\":\"toolongname\"}\n";
+    size_t len = strlen (log);
+    size_t offset = 0;
+    size_t saved;
+    char name[8];
+    double t;
+
+    ok (eventlog_scan_next (log, len, &offset, &t, name, sizeof (name)) == 1
+        && t == 42.5
+        && streq (name, "foo"),
+        "eventlog_scan_next returns first name and timestamp");
+    ok (eventlog_scan_next (log, len, &offset, &t, name, sizeof (name)) == 1
+        && t == 43
+        && streq (name, "bar"),
+        "eventlog_scan_next skips context and handles any key order");
+    ok (eventlog_scan_next (log, len, &offset, &t, name, sizeof (name)) == 1
+        && t == 44.0
+        && streq (name, "abc"),
+        "eventlog_scan_next handles escaped name");
+    saved = offset;
+    errno = 0;
+    ok (eventlog_scan_next (log, len, &offset, &t, name, sizeof (name)) < 0
+        && errno == EOVERFLOW
+        && offset == saved,
+        "eventlog_scan_next fails with EOVERFLOW if name doesn't fit");
+    ok (eventlog_scan_next (log, len, &offset, &t, NULL, 0) == 1
+        && t == 45.0,
+        "eventlog_scan_next works with NULL name");
+    ok (eventlog_scan_next (log, len, &offset, &t, name, sizeof (name)) == 0,
+        "eventlog_scan_next returns 0 at end of log");
+
+    for (int i = 0; badevent[i] != NULL; i++) {
+        char buf[512];
+        const char *s = badevent[i];
+        size_t off = 0;
+        int rc;
+
+        /* skip over leading good entries and stop at partial entries */
+        errno = 0;
+        while ((rc = eventlog_scan_next (s, strlen (s), &off,
+                                         &t, name, sizeof (name))) > 0)
+            ;
+        ok (rc < 0 ? errno == EINVAL : eventlog_decode (s) == NULL,
+            "eventlog_scan_next event=\"%s\" does not succeed",
+            printable (buf, s));
+    }
+}
+
 int main (int argc, char *argv[])
 {
     plan (NO_PLAN);
@@ -523,6 +632,8 @@ int main (int argc, char *argv[])
     eventlog_entry_encoding ();
     /* eventlog_entry_encoding_errors (); */
     eventlog_contains_event_test ();
+    eventlog_decode_next_test ();
+    eventlog_scan_next_test ();
 
     done_testing ();
 }
@@ -12,6 +12,9 @@
 #include "config.h"
 #endif
 
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <limits.h>
 #include <stdlib.h>
@@ -26,10 +29,126 @@
 #include "ccan/str/str.h"
 #include "src/common/libutil/dirwalk.h"
 #include "src/common/libutil/errno_safe.h"
+#include "src/common/libutil/blobref.h"
 #include "src/common/libcontent/content.h"
 
 #include "fileref.h"
 
+/* Blobs are extracted one at a time, but the content cache is asked to
+ * start loading up to PREFETCH_WINDOW blobs ahead, so that on a job's
+ * nodes they stream down the TBON while earlier ones are being written.
+ * Since each broker's cache fetches a blob from its parent only once,
+ * shells on many nodes share each fetch.
+ */
+#define PREFETCH_WINDOW 64
+
+struct prefetch {
+    uint8_t *hashes;    // hashes of all blobvec blobs, in extraction order
+    int hash_size;
+    int count;
+    int sent;           // number of hashes sent as hints so far
+    int used;           // number of blobs extracted so far
+};
+
+/* If the local broker has a blob mmapped from a file that this process
+ * can read too (e.g. on the node where 'flux archive create --mmap' was
+ * run), it is copied straight from that file instead of through the
+ * content cache.  Lookups stop after the first one that fails.
+ */
+struct mmap_source {
+    bool disabled;
+    char *path;
+    int fd;
+};
+
+struct filemap_ctx {
+    flux_t *h;
+    struct prefetch pf;
+    struct mmap_source src;
+};
+
+static int prefetch_collect_file (struct prefetch *pf, json_t *fileref)
+{
+    const char *encoding = NULL;
+    json_t *data = NULL;
+    size_t index;
+    json_t *o;
+
+    if (json_unpack (fileref,
+                     "{s?s s?o}",
+                     "encoding", &encoding,
+                     "data", &data) < 0
+        || !encoding
+        || !streq (encoding, "blobvec"))
+        return 0;
+    json_array_foreach (data, index, o) {
+        json_int_t offset;
+        json_int_t size;
+        const char *blobref;
+        uint8_t hash[BLOBREF_MAX_DIGEST_SIZE];
+        int n;
+
+        if (json_unpack (o, "[I,I,s]", &offset, &size, &blobref) < 0
+            || (n = blobref_strtohash (blobref, hash, sizeof (hash))) < 0
+            || (pf->count > 0 && n != pf->hash_size))
+            return -1;
+        if ((pf->count % PREFETCH_WINDOW) == 0) {
+            uint8_t *hashes;
+            size_t size = (pf->count + PREFETCH_WINDOW) * n;
+            if (!(hashes = realloc (pf->hashes, size)))
+                return -1;
+            pf->hashes = hashes;
+        }
+        memcpy (pf->hashes + pf->count * n, hash, n);
+        pf->hash_size = n;
+        pf->count++;
+    }
+    return 0;
+}
+
+/* Collect the hashes of the blobs referenced by 'files'.  Hints are best
+ * effort, so collection just stops at the first entry that can't be used.
+ */
+static void prefetch_collect (struct prefetch *pf, json_t *files)
+{
+    const char *key;
+    size_t index;
+    json_t *entry;
+
+    if (json_is_array (files)) {
+        json_array_foreach (files, index, entry) {
+            if (prefetch_collect_file (pf, entry) < 0)
+                return;
+        }
+    }
+    else {
+        json_object_foreach (files, key, entry) {
+            if (prefetch_collect_file (pf, entry) < 0)
+                return;
+        }
+    }
+}
+
+/* Keep hints outstanding for the next PREFETCH_WINDOW blobs, sending them
+ * in batches of at least half a window.
+ */
+static void prefetch_advance (flux_t *h, struct prefetch *pf)
+{
+    int end = pf->used + PREFETCH_WINDOW;
+
+    if (end > pf->count)
+        end = pf->count;
+    if (end - pf->sent < PREFETCH_WINDOW / 2 && end < pf->count)
+        return;
+    if (end > pf->sent) {
+        (void)content_prefetch (h,
+                                pf->hashes + pf->sent * pf->hash_size,
+                                pf->hash_size,
+                                end - pf->sent);
+        pf->sent = end;
+    }
+}
+
 
 /* Decode the raw data field a fileref object, setting the result in 'data'
  * and 'data_size'.  Caller must free.
@@ -69,7 +188,129 @@ static const char *fixup_archive_error_string (struct archive *archive)
     return errstr;
 }
 
-static int extract_blob (flux_t *h,
+static void mmap_source_close (struct mmap_source *src)
+{
+    if (src->path) {
+        close (src->fd);
+        free (src->path);
+        src->path = NULL;
+    }
+}
+
+static int mmap_source_open (struct mmap_source *src, const char *path)
+{
+    int fd;
+    char *cpy;
+
+    if (src->path && streq (src->path, path))
+        return src->fd;
+    if ((fd = open (path, O_RDONLY | O_CLOEXEC)) < 0)
+        return -1;
+    if (!(cpy = strdup (path))) {
+        ERRNO_SAFE_WRAP (close, fd);
+        return -1;
+    }
+    mmap_source_close (src);
+    src->path = cpy;
+    src->fd = fd;
+    return fd;
+}
+
+/* Try to write a blob from the file the local broker has mapped it from.
+ * Returns 1 if the blob was written, 0 if it should be loaded from the
+ * content cache instead, or -1 on error.
+ */
+static int extract_blob_mmap (struct filemap_ctx *ctx,
+                              struct archive *archive,
+                              const char *path,
+                              json_int_t file_offset,
+                              json_int_t size,
+                              const char *blobref,
+                              flux_error_t *errp)
+{
+    flux_future_t *f;
+    const char *srcpath;
+    json_int_t offset;
+    int blobsize;
+    int fd;
+    struct stat sb;
+    long pagesize = sysconf (_SC_PAGESIZE);
+    off_t delta;
+    void *p;
+    char hashtype[16];
+    char ref[BLOBREF_MAX_STRING_SIZE];
+    const char *cp;
+    int rc = 0;
+
+    if (ctx->src.disabled)
+        return 0;
+    if (!(f = flux_rpc_pack (ctx->h,
+                             "content.mmap-lookup",
+                             FLUX_NODEID_ANY,
+                             0,
+                             "{s:s}",
+                             "blobref", blobref))
+        || flux_rpc_get_unpack (f,
+                                "{s:s s:I s:i}",
+                                "path", &srcpath,
+                                "offset", &offset,
+                                "size", &blobsize) < 0
+        || blobsize != size
+        || (fd = mmap_source_open (&ctx->src, srcpath)) < 0
+        || fstat (fd, &sb) < 0
+        || sb.st_size < offset + size)
+        goto disable;
+    delta = offset % pagesize;
+    if ((p = mmap (NULL,
+                   size + delta,
+                   PROT_READ,
+                   MAP_SHARED,
+                   fd,
+                   offset - delta)) == MAP_FAILED)
+        goto disable;
+    /* The file may have changed since it was archived.
+     */
+    if (!(cp = strchr (blobref, '-'))
+        || cp - blobref >= sizeof (hashtype))
+        goto unmap_disable;
+    memcpy (hashtype, blobref, cp - blobref);
+    hashtype[cp - blobref] = '\0';
+    if (blobref_hash (hashtype,
+                      (char *)p + delta,
+                      size,
+                      ref,
+                      sizeof (ref)) < 0)
+        goto unmap_disable;
+    if (!streq (ref, blobref)) {
+        rc = errprintf (errp,
+                        "%s: content of %s has changed since it was archived",
+                        path,
+                        srcpath);
+    }
+    else if (archive_write_data_block (archive,
+                                       (char *)p + delta,
+                                       size,
+                                       file_offset) != ARCHIVE_OK) {
+        rc = errprintf (errp,
+                        "%s: write: %s",
+                        path,
+                        fixup_archive_error_string (archive));
+    }
+    else
+        rc = 1;
+    munmap (p, size + delta);
+    flux_future_destroy (f);
+    return rc;
+unmap_disable:
+    munmap (p, size + delta);
+disable:
+    ctx->src.disabled = true;
+    mmap_source_close (&ctx->src);
+    flux_future_destroy (f);
+    return 0;
+}
+
+static int extract_blob (struct filemap_ctx *ctx,
                          struct archive *archive,
                          const char *path,
                          json_t *o,
@@ -83,6 +324,7 @@ static int extract_blob (flux_t *h,
     flux_future_t *f;
     const void *buf;
     int size;
+    int rc;
 
     if (json_unpack (o,
                      "[I,I,s]",
@@ -90,7 +332,17 @@ static int extract_blob (flux_t *h,
                      &entry.size,
                      &entry.blobref) < 0)
         return errprintf (errp, "%s: error decoding blobvec entry", path);
-    if (!(f = content_load_byblobref (h, entry.blobref, 0))
+    prefetch_advance (ctx->h, &ctx->pf);
+    ctx->pf.used++;
+    if ((rc = extract_blob_mmap (ctx,
+                                 archive,
+                                 path,
+                                 entry.offset,
+                                 entry.size,
+                                 entry.blobref,
+                                 errp)) != 0)
+        return rc < 0 ? -1 : 0;
+    if (!(f = content_load_byblobref (ctx->h, entry.blobref, 0))
         || content_load_get (f, &buf, &size) < 0) {
         return errprintf (errp,
                           "%s: error loading offset=%ju size=%ju from %s: %s",
@@ -127,7 +379,7 @@ static int extract_blob (flux_t *h,
  *  libarchive object 'archive' and using 'path' as the default path
  *  if no path is encoded in 'fileref'.
  */
-static int extract_file (flux_t *h,
+static int extract_file (struct filemap_ctx *ctx,
                          struct archive *archive,
                          const char *path,
                          json_t *fileref,
@@ -237,7 +489,7 @@ static int extract_file (flux_t *h,
         }
         else if (streq (encoding, "blobvec")) {
             json_array_foreach (data, index, o) {
-                if (extract_blob (h, archive, path, o, errp) < 0)
+                if (extract_blob (ctx, archive, path, o, errp) < 0)
                     return -1;
             }
         }
@@ -280,8 +532,10 @@ int filemap_extract (flux_t *h,
     size_t index;
     json_t *entry;
     struct archive *archive;
+    struct filemap_ctx ctx = { .h = h };
     int rc = -1;
 
+    prefetch_collect (&ctx.pf, files);
     if (!(archive = archive_write_disk_new ())
         || archive_write_disk_set_options (archive,
                                            libarchive_flags) != ARCHIVE_OK) {
@@ -291,7 +545,7 @@ int filemap_extract (flux_t *h,
 
     if (json_is_array (files)) {
         json_array_foreach (files, index, entry) {
-            if (extract_file (h,
+            if (extract_file (&ctx,
                               archive,
                               NULL,
                               entry,
@@ -302,7 +556,7 @@ int filemap_extract (flux_t *h,
         }
     } else {
         json_object_foreach (files, key, entry) {
-            if (extract_file (h,
+            if (extract_file (&ctx,
                               archive,
                               key,
                               entry,
@@ -316,6 +570,8 @@ int filemap_extract (flux_t *h,
 out:
     if (archive)
         archive_write_free (archive);
+    mmap_source_close (&ctx.src);
+    free (ctx.pf.hashes);
     return rc;
 }
 
@@ -22,6 +22,8 @@
 #include <errno.h>
 #include <jansson.h>
 #include <assert.h>
+#include <pthread.h>
+#include <stdint.h>
 
 #include "ccan/base64/base64.h"
 
@@ -32,27 +34,147 @@
 #include "src/common/libutil/fdutils.h"
 #include "fileref.h"
 
-static int blobvec_append (json_t *blobvec,
-                           const void *mapbuf,
-                           off_t offset,
-                           size_t blobsize,
-                           const char *hashtype)
-{
+struct blob {
+    off_t offset;
+    size_t size;
     char blobref[BLOBREF_MAX_STRING_SIZE];
-    json_t *o;
-    json_int_t offsetj = offset;
-    json_int_t blobsizej = blobsize;
-
-    if (blobref_hash (hashtype,
-                      mapbuf + offset,
-                      blobsize,
-                      blobref,
-                      sizeof (blobref)) < 0)
-        return -1;
-    if (!(o = json_pack ("[I,I,s]", offsetj, blobsizej, blobref))
-        || json_array_append_new (blobvec, o) < 0) {
-        json_decref (o);
-        errno = ENOMEM;
+};
+
+struct blobtab {
+    struct blob *blobs;
+    int count;
+    int alloc;
+    const void *mapbuf;
+    const char *hashtype;
+    int next;               // next blob to hash (shared by hash threads)
+    int errnum;
+};
+
+static int blobtab_append (struct blobtab *tab, off_t offset, size_t size)
+{
+    if (tab->count == tab->alloc) {
+        int alloc = tab->alloc ? tab->alloc * 2 : 64;
+        struct blob *blobs;
+
+        if (!(blobs = realloc (tab->blobs, alloc * sizeof (blobs[0])))) {
+            errno = ENOMEM;
+            return -1;
+        }
+        tab->blobs = blobs;
+        tab->alloc = alloc;
+    }
+    tab->blobs[tab->count].offset = offset;
+    tab->blobs[tab->count].size = size;
+    tab->count++;
+    return 0;
+}
+
+/* Fill the gear table used by the rolling hash.  The values need only be
+ * well mixed and identical from run to run so that unchanged data always
+ * splits at the same places, so use splitmix64 with a fixed seed.
+ */
+static void gear_init (uint64_t *gear)
+{
+    uint64_t x = 0x666c7578;
+
+    for (int i = 0; i < 256; i++) {
+        uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        gear[i] = z ^ (z >> 31);
+    }
+}
+
+/* Split the data region of 'size' bytes at 'offset' into blobs.
+ * If 'gear' is NULL, cut every 'chunksize' bytes.  Otherwise, place
+ * boundaries where a gear rolling hash over the preceding bytes has its
+ * top bits clear, so that an insertion or deletion only changes the blobs
+ * around it.  Content-defined blobs are at least chunksize/16 bytes and
+ * at most chunksize bytes, typically near chunksize/5.
+ */
+static int blobtab_split (struct blobtab *tab,
+                          off_t offset,
+                          size_t size,
+                          int chunksize,
+                          const uint64_t *gear)
+{
+    const unsigned char *p = tab->mapbuf;
+    size_t min = chunksize / 16;
+    int bits = 0;
+
+    while ((2UL << bits) <= chunksize / 8)
+        bits++;
+    while (size > 0) {
+        size_t blobsize = size < chunksize ? size : chunksize;
+
+        if (gear && blobsize > min) {
+            uint64_t h = 0;
+            size_t i;
+
+            for (i = min; i < blobsize; i++) {
+                h = (h << 1) + gear[p[offset + i]];
+                if (bits > 0 && (h >> (64 - bits)) == 0) {
+                    i++;
+                    break;
+                }
+            }
+            blobsize = i;
+        }
+        if (blobtab_append (tab, offset, blobsize) < 0)
+            return -1;
+        offset += blobsize;
+        size -= blobsize;
+    }
+    return 0;
+}
+
+static void *hash_thread (void *arg)
+{
+    struct blobtab *tab = arg;
+    int i;
+
+    while ((i = __atomic_fetch_add (&tab->next, 1, __ATOMIC_RELAXED))
+           < tab->count) {
+        struct blob *blob = &tab->blobs[i];
+
+        if (blobref_hash (tab->hashtype,
+                          tab->mapbuf + blob->offset,
+                          blob->size,
+                          blob->blobref,
+                          sizeof (blob->blobref)) < 0) {
+            __atomic_store_n (&tab->errnum, errno, __ATOMIC_RELAXED);
+            break;
+        }
+    }
+    return NULL;
+}
+
+/* Compute the blobref of each blob in 'tab'.  Hashing dominates the cost
+ * of archiving large files, and blobs are independent, so spread the work
+ * over up to 'threads' threads (including the calling thread).
+ */
+static int blobtab_hash (struct blobtab *tab, int threads)
+{
+    pthread_t *tids = NULL;
+    int n = 0;
+
+    if (threads > tab->count)
+        threads = tab->count;
+    if (threads > 1) {
+        if (!(tids = calloc (threads - 1, sizeof (tids[0])))) {
+            errno = ENOMEM;
+            return -1;
+        }
+        while (n < threads - 1
+            && pthread_create (&tids[n], NULL, hash_thread, tab) == 0)
+            n++;
+    }
+    hash_thread (tab);
+    for (int i = 0; i < n; i++)
+        pthread_join (tids[i], NULL);
+    free (tids);
+    if (tab->errnum) {
+        errno = tab->errnum;
         return -1;
     }
     return 0;
@@ -68,25 +190,27 @@ static bool file_has_no_data (int fd)
 }
 
 /* Walk the regular file represented by 'fd', appending blobvec array entries
- * to 'blobvec' array for each 'chunksize' region.  Use SEEK_DATA and SEEK_HOLE
- * to skip holes in sparse files - see lseek(2).
+ * to 'blobvec' array for each blob in the file.  Use SEEK_DATA and SEEK_HOLE
+ * to skip holes in sparse files - see lseek(2).  Blob boundaries are found
+ * first, then the blobs are hashed (possibly in parallel).
  */
 static json_t *blobvec_create (int fd,
                                const void *mapbuf,
                                size_t size,
                                const char *hashtype,
-                               int chunksize)
+                               int chunksize,
+                               struct blobvec_param *param)
 {
-    json_t *blobvec;
+    struct blobtab tab = { .mapbuf = mapbuf, .hashtype = hashtype };
+    uint64_t gear[256];
+    json_t *blobvec = NULL;
     off_t offset = 0;
 
     assert (fd >= 0);
     assert (size > 0);
 
-    if (!(blobvec = json_array ())) {
-        errno = ENOMEM;
-        goto error;
-    }
+    if (param->content_defined)
+        gear_init (gear);
     while (offset < size) {
 #ifdef SEEK_DATA
         // N.B. fails with ENXIO if there is no more data
@@ -98,7 +222,6 @@ static json_t *blobvec_create (int fd,
 #endif
         if (offset < size) {
             off_t notdata;
-            int blobsize;
 
 #ifdef SEEK_HOLE
             // N.B. returns size if there are no more holes
@@ -108,21 +231,38 @@ static json_t *blobvec_create (int fd,
             notdata = size;
 #endif /* SEEK_HOLE */
 
-            blobsize = notdata - offset;
-            if (blobsize > chunksize)
-                blobsize = chunksize;
-            if (blobvec_append (blobvec,
-                                mapbuf,
-                                offset,
-                                blobsize,
-                                hashtype) < 0)
+            if (blobtab_split (&tab,
+                               offset,
+                               notdata - offset,
+                               chunksize,
+                               param->content_defined ? gear : NULL) < 0)
                 goto error;
-            offset += blobsize;
+            offset = notdata;
+        }
+    }
+    if (blobtab_hash (&tab, param->threads) < 0)
+        goto error;
+    if (!(blobvec = json_array ()))
+        goto nomem;
+    for (int i = 0; i < tab.count; i++) {
+        json_t *o;
+
+        if (!(o = json_pack ("[I,I,s]",
+                             (json_int_t)tab.blobs[i].offset,
+                             (json_int_t)tab.blobs[i].size,
+                             tab.blobs[i].blobref))
+            || json_array_append_new (blobvec, o) < 0) {
+            json_decref (o);
+            goto nomem;
         }
     }
+    free (tab.blobs);
     return blobvec;
+nomem:
+    errno = ENOMEM;
 error:
     ERRNO_SAFE_WRAP (json_decref, blobvec);
+    ERRNO_SAFE_WRAP (free, tab.blobs);
     return NULL;
 }
 
@@ -155,12 +295,18 @@ static json_t *fileref_create_blobvec (const char *path,
                                        struct stat *sb,
                                        const char *hashtype,
                                        int chunksize,
+                                       struct blobvec_param *param,
                                        flux_error_t *error)
 {
     json_t *blobvec;
     json_t *o;
 
-    blobvec = blobvec_create (fd, mapbuf, sb->st_size, hashtype, chunksize);
+    blobvec = blobvec_create (fd,
+                              mapbuf,
+                              sb->st_size,
+                              hashtype,
+                              chunksize,
+                              param);
     if (!blobvec) {
         errprintf (error,
                    "%s: error creating blobvec array: %s",
@@ -338,7 +484,8 @@ json_t *fileref_create_ex (const char *path,
     if (param) {
         if (param->chunksize < 0
             || param->hashtype == NULL
-            || param->small_file_threshold < 0) {
+            || param->small_file_threshold < 0
+            || param->threads < 0) {
             errprintf (error, "invalid blobvec encoding parameters");
             goto inval;
         }
@@ -397,6 +544,7 @@ json_t *fileref_create_ex (const char *path,
                                           &sb,
                                           param->hashtype,
                                           chunksize,
+                                          param,
                                           error)))
             goto error;
     }
@@ -21,7 +21,10 @@ struct blobvec_param {
     const char *hashtype;
     int chunksize;              // maximum size of each blob
     int small_file_threshold;   // no blobvec encoding for regular files of
-};                              //  size <= thresh (0=always blobvec)
+                                //  size <= thresh (0=always blobvec)
+    bool content_defined;       // place blob boundaries with a rolling hash
+    int threads;                // hash blobs with up to N threads (0,1=off)
+};
 
 struct blobvec_mapinfo {
     void *base;
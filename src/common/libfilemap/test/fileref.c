@@ -51,6 +51,26 @@ static json_t *xfileref_create_vec (const char *path,
     return o;
 }
 
+static json_t *xfileref_create_cdc (const char *path,
+                                    int chunksize,
+                                    int threads)
+{
+    json_t *o;
+    flux_error_t error;
+    struct blobvec_param blobvec_param = {
+        .hashtype = "sha1",
+        .chunksize = chunksize,
+        .small_file_threshold = 4096,
+        .content_defined = true,
+        .threads = threads,
+    };
+
+    o = fileref_create_ex (path, &blobvec_param, NULL, &error);
+    if (!o)
+        diag ("%s", error.text);
+    return o;
+}
+
 static json_t *xfileref_create (const char *path)
 {
     json_t *o;
@@ -175,6 +195,25 @@ void mkfile_string (const char *name, const char *s)
     close (fd);
 }
 
+/* Create test file 'name' containing 'size' pseudo-random bytes, with
+ * 'insert' spliced in at offset 'size/2' if non-NULL.
+ */
+void mkfile_random (const char *name, size_t size, const char *insert)
+{
+    FILE *f;
+
+    srand (42);
+    if (!(f = fopen (mkpath (name), "w")))
+        BAIL_OUT ("could not create %s: %s", name, strerror (errno));
+    for (size_t i = 0; i < size; i++) {
+        if (i == size / 2 && insert)
+            fputs (insert, f);
+        fputc (rand () & 0xff, f);
+    }
+    if (fclose (f) != 0)
+        BAIL_OUT ("error closing %s: %s", name, strerror (errno));
+}
+
 void mkfile_empty (const char *name, size_t size)
 {
     int fd;
@@ -624,11 +663,73 @@ void test_empty (void)
     rmfile ("testempty2");
 }
 
+/* Count entries of blobvec 'a' whose blobref also appears in blobvec 'b'.
+ */
+int count_shared (json_t *a, json_t *b)
+{
+    size_t i, j;
+    json_t *ea, *eb;
+    int count = 0;
+
+    json_array_foreach (a, i, ea) {
+        json_array_foreach (b, j, eb) {
+            if (json_equal (json_array_get (ea, 2), json_array_get (eb, 2))) {
+                count++;
+                break;
+            }
+        }
+    }
+    return count;
+}
+
+void test_content_defined (void)
+{
+    json_t *o1, *o2, *o3;
+    json_t *data1 = NULL, *data2 = NULL, *data3 = NULL;
+    size_t index;
+    json_t *entry;
+    bool sizes_ok = true;
+    int n;
+
+    mkfile_random ("testcdc", 262144, NULL);
+    o1 = xfileref_create_cdc (mkpath ("testcdc"), 16384, 1);
+    o2 = xfileref_create_cdc (mkpath ("testcdc"), 16384, 4);
+    if (!o1 || !o2
+        || json_unpack (o1, "{s:o}", "data", &data1) < 0
+        || json_unpack (o2, "{s:o}", "data", &data2) < 0)
+        BAIL_OUT ("failed to create content-defined test objects");
+    n = json_array_size (data1);
+    ok (n > 262144 / 16384 && check_fileref (o1, "testcdc", n),
+        "fileref_create content_defined=true works (%d blobrefs)", n);
+    json_array_foreach (data1, index, entry) {
+        if (json_integer_value (json_array_get (entry, 1)) > 16384)
+            sizes_ok = false;
+    }
+    ok (sizes_ok == true,
+        "content-defined blobs do not exceed chunksize");
+    ok (json_equal (data1, data2),
+        "hashing with threads=4 produces the same blobvec as threads=1");
+
+    mkfile_random ("testcdc", 262144, "inserted text");
+    o3 = xfileref_create_cdc (mkpath ("testcdc"), 16384, 4);
+    if (!o3 || json_unpack (o3, "{s:o}", "data", &data3) < 0)
+        BAIL_OUT ("failed to create content-defined test object");
+    ok (check_fileref (o3, "testcdc", json_array_size (data3)),
+        "fileref_create content_defined=true works on modified file");
+    ok (count_shared (data3, data1) >= n - 2,
+        "inserting text changes at most two content-defined blobs");
+
+    json_decref (o1);
+    json_decref (o2);
+    json_decref (o3);
+    rmfile ("testcdc");
+}
+
 void test_expfail (void)
 {
     json_t *o;
     flux_error_t error;
-    struct blobvec_param param;
+    struct blobvec_param param = { 0 };
 
     mkfile ("test", 4096, "zz");
 
@@ -676,6 +777,17 @@ void test_expfail (void)
     ok (o == NULL && errno == EINVAL,
         "fileref_create_ex param.small_file_threshold=-1 fails with EINVAL");
 
+    errno = 0;
+    param.chunksize = 1024;
+    param.hashtype = "sha1";
+    param.small_file_threshold = 0;
+    param.threads = -1;
+    o = fileref_create_ex (mkpath ("test"), &param, NULL, &error);
+    if (!o)
+        diag ("%s", error.text);
+    ok (o == NULL && errno == EINVAL,
+        "fileref_create_ex param.threads=-1 fails with EINVAL");
+
     rmfile ("test");
 }
 
@@ -739,6 +851,7 @@ int main (int argc, char *argv[])
     test_link ();
     test_small ();
     test_empty ();
+    test_content_defined ();
     test_expfail ();
     test_pretty_print ();
 
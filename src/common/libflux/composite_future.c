@@ -12,6 +12,8 @@
 #include "config.h"
 #endif
 
+#include <string.h>
+
 #include "src/common/libczmqcontainers/czmq_containers.h"
 
 #include "future.h"
@@ -22,11 +24,24 @@ struct composite_future {
     int seq;             /* sequence for anonymous children          */
     unsigned int any:1;  /* true if this future is a "wait any" type */
     zhash_t *children;   /* hash of child futures by name            */
+    int count;           /* number of children                       */
+    int ready_count;     /* number of children fulfilled at least once */
+    int errnum;          /* errno of most recent failed child        */
+    zlistx_t *ready;     /* children in order of first fulfillment,  */
+                         /*   not yet returned by next_ready_child() */
+};
+
+/*  Per-child data, stored in the child's aux container:
+ */
+struct composite_child {
+    bool ready;
+    char name[];
 };
 
 static void composite_future_destroy (struct composite_future *f)
 {
     if (f) {
+        zlistx_destroy (&f->ready);
         if (f->children)
             zhash_destroy (&f->children);
         free (f);
@@ -38,8 +53,9 @@ static struct composite_future * composite_future_create (void)
     struct composite_future *cf = calloc (1, sizeof (*cf));
     if (cf == NULL)
         return NULL;
-    if (!(cf->children = zhash_new ())) {
-        free (cf);
+    if (!(cf->children = zhash_new ())
+        || !(cf->ready = zlistx_new ())) {
+        composite_future_destroy (cf);
         return (NULL);
     }
     return (cf);
@@ -53,38 +69,35 @@ static struct composite_future * composite_get (flux_future_t *f)
 }
 
 /*
- *  Return true if all futures in this composite are ready
- */
-static bool wait_all_is_ready (struct composite_future *cf, int *errnum)
-{
-    int err = 0;
-    flux_future_t *f = zhash_first (cf->children);
-    while (f) {
-        if (!flux_future_is_ready (f))
-            return (false);
-        if (flux_future_get (f, NULL) < 0)
-            err = errno;
-        f = zhash_next (cf->children);
-    }
-    *errnum = err;
-    return (true);
-}
-
-/*
- *  Return true if cf->any or if all futures are fulfilled.
+ *  Account for the fulfillment of child 'f', then return true if cf->any
+ *   or if all futures are fulfilled.
  *  Sets *errp to returned errno if any future failed for wait_all
  *   case, or if 'f', the current future, has error set for
  *   wait_any case.
+ *  Children are counted only on their first fulfillment, so this is O(1)
+ *   regardless of the number of children.
  */
 static bool composite_is_ready (struct composite_future *cf,
                                 flux_future_t *f,
                                 int *errp)
 {
+    struct composite_child *child = flux_future_aux_get (f, "flux::child");
+    int err = flux_future_get (f, NULL) < 0 ? errno : 0;
+
+    if (child && !child->ready) {
+        child->ready = true;
+        cf->ready_count++;
+        if (err)
+            cf->errnum = err;
+        if (!zlistx_add_end (cf->ready, child->name))
+            cf->errnum = err = ENOMEM;
+    }
     if (cf->any) {
-        *errp = flux_future_get (f, NULL) < 0 ? errno : 0;
+        *errp = err;
         return true;
     }
-    return wait_all_is_ready (cf, errp);
+    *errp = cf->errnum;
+    return cf->ready_count == cf->count;
 }
 
 /*  Continuation for children of a composition future -- simply check
@@ -196,6 +209,7 @@ flux_future_t *flux_future_wait_any_create (void)
 int flux_future_push (flux_future_t *f, const char *name, flux_future_t *child)
 {
     struct composite_future *cf = NULL;
+    struct composite_child *cc;
     char *anon = NULL;
     int rc = -1;
 
@@ -213,11 +227,21 @@ int flux_future_push (flux_future_t *f, const char *name, flux_future_t *child)
         goto done;
     }
     zhash_freefn (cf->children, name, (flux_free_f) flux_future_destroy);
-    if (flux_future_aux_set (child, "flux::parent", f, NULL) < 0) {
-        zhash_delete (cf->children, name);
-        goto done;
+    if (!(cc = calloc (1, sizeof (*cc) + strlen (name) + 1)))
+        goto error;
+    strcpy (cc->name, name);
+    if (flux_future_aux_set (child, "flux::child", cc, free) < 0) {
+        free (cc);
+        goto error;
     }
+    if (flux_future_aux_set (child, "flux::parent", f, NULL) < 0)
+        goto error;
+    cf->count++;
     rc = 0;
+    goto done;
+error:
+    /* N.B. the child hash entry destructor destroys 'child' */
+    zhash_delete (cf->children, name);
 done:
     free (anon);
     return rc;
@@ -257,6 +281,16 @@ const char *flux_future_next_child (flux_future_t *f)
     return (zhash_cursor (cf->children));
 }
 
+const char *flux_future_next_ready_child (flux_future_t *f)
+{
+    struct composite_future *cf = NULL;
+    if (!f || !(cf = composite_get (f))) {
+        errno = EINVAL;
+        return (NULL);
+    }
+    return (zlistx_detach (cf->ready, NULL));
+}
+
 /*  Chained futures support: */
 
 /*
@@ -43,8 +43,16 @@ struct flux_handle_ops {
     // added in v0.56.0
     int         (*send_new)(void *impl, flux_msg_t **msg, int flags);
 
+    // added in v0.63.0
+    // Send up to 'count' messages, returning the number sent (at least one)
+    // or -1 on error.  Optional - flux_send_batch() falls back to op->send.
+    int         (*send_batch)(void *impl,
+                              const flux_msg_t **msgs,
+                              int count,
+                              int flags);
+
     // added in v0.56.0
-    void        *_pad[4]; // reserved for future use
+    void        *_pad[3]; // reserved for future use
 };
 
 flux_t *flux_handle_create (void *impl,
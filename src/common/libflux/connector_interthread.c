@@ -37,6 +37,8 @@
 #include "message_private.h" // for access to msg->aux
 #include "msg_deque.h"
 
+#define SEND_BATCH_MAX 64
+
 struct channel {
     char *name;
     struct msg_deque *pair[2];
@@ -79,8 +81,8 @@ static struct channel *channel_create (const char *name)
 
     if (!(chan = calloc (1, sizeof (*chan)))
         || !(chan->name = strdup (name))
-        || !(chan->pair[0] = msg_deque_create (0))
-        || !(chan->pair[1] = msg_deque_create (0)))
+        || !(chan->pair[0] = msg_deque_create (MSG_DEQUE_MPSC))
+        || !(chan->pair[1] = msg_deque_create (MSG_DEQUE_MPSC)))
         goto error;
     list_node_init (&chan->list);
     return chan;
@@ -192,26 +194,36 @@ static int router_process (flux_msg_t *msg, const char *name)
     return 0;
 }
 
-static int op_send_new (void *impl, flux_msg_t **msg, int flags)
+/* Prepare a message for transit to the other end of the channel.
+ */
+static int send_prepare (struct interthread_ctx *ctx, flux_msg_t *msg)
 {
-    struct interthread_ctx *ctx = impl;
     struct flux_msg_cred cred;
 
-    if (flux_msg_get_cred (*msg, &cred) < 0)
+    if (flux_msg_get_cred (msg, &cred) < 0)
         return -1;
     if (cred.userid == FLUX_USERID_UNKNOWN
         && cred.rolemask == FLUX_ROLE_NONE) {
-        if (flux_msg_set_cred (*msg, ctx->cred) < 0)
+        if (flux_msg_set_cred (msg, ctx->cred) < 0)
             return -1;
     }
     if (ctx->router) {
-        if (router_process (*msg, ctx->router) < 0)
+        if (router_process (msg, ctx->router) < 0)
             return -1;
     }
     /* The aux container doesn't survive transit of a TCP channel
      * so it shouldn't survive transit of this kind either.
      */
-    aux_destroy (&(*msg)->aux);
+    aux_destroy (&msg->aux);
+    return 0;
+}
+
+static int op_send_new (void *impl, flux_msg_t **msg, int flags)
+{
+    struct interthread_ctx *ctx = impl;
+
+    if (send_prepare (ctx, *msg) < 0)
+        return -1;
     if (msg_deque_push_back (ctx->send, *msg) < 0)
         return -1;
     *msg = NULL;
@@ -230,6 +242,36 @@ static int op_send (void *impl, const flux_msg_t *msg, int flags)
     return 0;
 }
 
+/* Copy up to SEND_BATCH_MAX messages, then enqueue them with one lock
+ * acquisition and at most one wakeup of the receiver.
+ */
+static int op_send_batch (void *impl,
+                          const flux_msg_t **msgs,
+                          int count,
+                          int flags)
+{
+    struct interthread_ctx *ctx = impl;
+    flux_msg_t *cpy[SEND_BATCH_MAX];
+    int n = count < SEND_BATCH_MAX ? count : SEND_BATCH_MAX;
+    int i;
+
+    for (i = 0; i < n; i++) {
+        if (!(cpy[i] = flux_msg_copy (msgs[i], true)))
+            goto error;
+        if (send_prepare (ctx, cpy[i]) < 0) {
+            flux_msg_destroy (cpy[i]);
+            goto error;
+        }
+    }
+    if (msg_deque_push_back_batch (ctx->send, cpy, n) < 0)
+        goto error;
+    return n;
+error:
+    while (--i >= 0)
+        flux_msg_destroy (cpy[i]);
+    return -1;
+}
+
 static flux_msg_t *op_recv (void *impl, int flags)
 {
     struct interthread_ctx *ctx = impl;
@@ -280,6 +322,30 @@ error:
     return -1;
 }
 
+static int op_getopt (void *impl, const char *option, void *val, size_t size)
+{
+    struct interthread_ctx *ctx = impl;
+    struct msg_deque_stats stats;
+
+    msg_deque_get_stats (ctx->recv, &stats);
+    if (streq (option, FLUX_OPT_RECV_QUEUE_DEPTH)) {
+        if (size != sizeof (stats.depth) || !val)
+            goto error;
+        memcpy (val, &stats.depth, size);
+    }
+    else if (streq (option, FLUX_OPT_RECV_QUEUE_WAKEUPS)) {
+        if (size != sizeof (stats.wakeups) || !val)
+            goto error;
+        memcpy (val, &stats.wakeups, size);
+    }
+    else
+        goto error;
+    return 0;
+error:
+    errno = EINVAL;
+    return -1;
+}
+
 static void op_fini (void *impl)
 {
     struct interthread_ctx *ctx = impl;
@@ -335,6 +401,8 @@ static const struct flux_handle_ops handle_ops = {
     .pollevents = op_pollevents,
     .send = op_send,
     .send_new = op_send_new,
+    .send_batch = op_send_batch,
+    .getopt = op_getopt,
     .recv = op_recv,
     .setopt = op_setopt,
     .impl_destroy = op_fini,
@@ -83,6 +83,22 @@ static int op_send (void *impl, const flux_msg_t *msg, int flags)
     return usock_client_send (ctx->uclient, msg, flags);
 }
 
+static int op_send_batch (void *impl,
+                          const flux_msg_t **msgs,
+                          int count,
+                          int flags)
+{
+    struct local_connector *ctx = impl;
+
+    if (ctx->testing_userid != FLUX_USERID_UNKNOWN
+        || ctx->testing_rolemask != FLUX_ROLE_NONE) {
+        if (send_testing (ctx, msgs[0], flags) < 0)
+            return -1;
+        return 1;
+    }
+    return usock_client_send_batch (ctx->uclient, msgs, count, flags);
+}
+
 static flux_msg_t *op_recv (void *impl, int flags)
 {
     struct local_connector *ctx = impl;
@@ -223,6 +239,7 @@ static const struct flux_handle_ops handle_ops = {
     .pollfd = op_pollfd,
     .pollevents = op_pollevents,
     .send = op_send,
+    .send_batch = op_send_batch,
     .recv = op_recv,
     .reconnect = op_reconnect,
     .setopt = op_setopt,
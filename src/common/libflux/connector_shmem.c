@@ -0,0 +1,360 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* connector_shmem.c - shared memory connector for same-node clients
+ *
+ * shmem://PATH takes the same PATH as local://.  The client connects to
+ * PATH-shmem, which is served by the connector-local module, and
+ * receives a shmring (see librouter/shmring.h) in exchange.  The socket
+ * is kept open so that the broker notices when the client goes away and
+ * vice versa.
+ *
+ * The pollfd is an epoll fd containing the shmring eventfd and the
+ * socket.  op_pollevents() announces that the client is going to sleep
+ * whenever it reports nothing to read, so the broker only writes the
+ * eventfd when the client is actually blocked.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <sys/epoll.h>
+#include <poll.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <flux/core.h>
+
+#include "src/common/librouter/usock.h"
+#include "src/common/librouter/shmring.h"
+#include "src/common/libutil/errprintf.h"
+#include "src/common/libutil/errno_safe.h"
+#include "ccan/str/str.h"
+
+struct shmem_connector {
+    struct shmring *ring;
+    uint32_t testing_userid;
+    uint32_t testing_rolemask;
+    flux_t *h;
+    int fd;
+    int epfd;
+    bool sleeping;
+    bool hangup;
+    char *path;
+};
+
+static const struct flux_handle_ops handle_ops;
+
+static void shmem_disconnect (struct shmem_connector *ctx);
+static int shmem_connect (struct shmem_connector *ctx);
+
+/* If we told the broker we were sleeping, take it back, and check the
+ * socket for hangup since that may be what woke us.
+ */
+static void shmem_awake (struct shmem_connector *ctx)
+{
+    if (ctx->sleeping) {
+        struct pollfd pfd = { .fd = ctx->fd, .events = POLLIN };
+
+        shmring_wake (ctx->ring);
+        ctx->sleeping = false;
+        if (poll (&pfd, 1, 0) > 0 && pfd.revents != 0)
+            ctx->hangup = true;
+    }
+}
+
+/* Block until the broker makes progress on either ring.
+ */
+static int shmem_wait (struct shmem_connector *ctx)
+{
+    if (ctx->hangup) {
+        errno = ECONNRESET;
+        return -1;
+    }
+    if (shmring_sleep (ctx->ring)) {
+        struct epoll_event ev;
+
+        ctx->sleeping = true;
+        while (epoll_wait (ctx->epfd, &ev, 1, -1) < 0) {
+            if (errno != EINTR)
+                return -1;
+        }
+        shmem_awake (ctx);
+    }
+    return 0;
+}
+
+static int shmem_flush (struct shmem_connector *ctx, int flags)
+{
+    while (shmring_flush (ctx->ring) < 0) {
+        if (errno != EAGAIN || (flags & FLUX_O_NONBLOCK))
+            return -1;
+        if (shmem_wait (ctx) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+static int op_pollevents (void *impl)
+{
+    struct shmem_connector *ctx = impl;
+    int revents = 0;
+
+    if (!ctx->ring)
+        return 0;
+    shmem_awake (ctx);
+    if (ctx->hangup)
+        return FLUX_POLLERR;
+    for (;;) {
+        if (shmring_flush (ctx->ring) < 0 && errno != EAGAIN)
+            return FLUX_POLLERR;
+        if (shmring_rx_ready (ctx->ring)) {
+            revents |= FLUX_POLLIN;
+            break;
+        }
+        if (shmring_sleep (ctx->ring)) {
+            ctx->sleeping = true;
+            break;
+        }
+    }
+    if (!shmring_tx_pending (ctx->ring))
+        revents |= FLUX_POLLOUT;
+    return revents;
+}
+
+static int op_pollfd (void *impl)
+{
+    struct shmem_connector *ctx = impl;
+
+    return ctx->ring ? ctx->epfd : -1;
+}
+
+static int shmem_send (struct shmem_connector *ctx,
+                       const flux_msg_t *msg,
+                       int flags)
+{
+    shmem_awake (ctx);
+    if (ctx->hangup) {
+        errno = ECONNRESET;
+        return -1;
+    }
+    if (shmem_flush (ctx, flags) < 0)
+        return -1;
+    /* In non-blocking mode, a message may be accepted but only partially
+     * copied to the ring.  The remainder is copied by the next send,
+     * recv, or pollevents call.
+     */
+    if (shmring_send (ctx->ring, msg) < 0 && errno != EAGAIN)
+        return -1;
+    if (!(flags & FLUX_O_NONBLOCK))
+        return shmem_flush (ctx, flags);
+    return 0;
+}
+
+/* Special send function for testing that sets the userid/rolemask to
+ * values set with flux_opt_set().  The connector-local module
+ * overwrites these credentials for guests, but allows pass-through for
+ * instance owner.  This is useful for service access control testing.
+ */
+static int send_testing (struct shmem_connector *ctx,
+                         const flux_msg_t *msg,
+                         int flags)
+{
+    flux_msg_t *cpy;
+
+    if (!(cpy = flux_msg_copy (msg, true)))
+        return -1;
+    if (flux_msg_set_userid (cpy, ctx->testing_userid) < 0)
+        goto error;
+    if (flux_msg_set_rolemask (cpy, ctx->testing_rolemask) < 0)
+        goto error;
+    if (shmem_send (ctx, cpy, flags) < 0)
+        goto error;
+    flux_msg_destroy (cpy);
+    return 0;
+error:
+    flux_msg_destroy (cpy);
+    return -1;
+}
+
+static int op_send (void *impl, const flux_msg_t *msg, int flags)
+{
+    struct shmem_connector *ctx = impl;
+
+    if (ctx->testing_userid != FLUX_USERID_UNKNOWN
+        || ctx->testing_rolemask != FLUX_ROLE_NONE)
+        return send_testing (ctx, msg, flags);
+
+    return shmem_send (ctx, msg, flags);
+}
+
+static flux_msg_t *op_recv (void *impl, int flags)
+{
+    struct shmem_connector *ctx = impl;
+    flux_msg_t *msg;
+
+    shmem_awake (ctx);
+    if (shmring_flush (ctx->ring) < 0 && errno != EAGAIN)
+        return NULL;
+    while (!(msg = shmring_recv (ctx->ring))) {
+        if (errno != EAGAIN)
+            return NULL;
+        if (ctx->hangup) {
+            errno = ECONNRESET;
+            return NULL;
+        }
+        if ((flags & FLUX_O_NONBLOCK))
+            return NULL;
+        if (shmem_wait (ctx) < 0)
+            return NULL;
+    }
+    return msg;
+}
+
+static int op_setopt (void *impl,
+                      const char *option,
+                      const void *val,
+                      size_t size)
+{
+    struct shmem_connector *ctx = impl;
+    size_t val_size;
+    int rc = -1;
+
+    if (streq (option, FLUX_OPT_TESTING_USERID)) {
+        val_size = sizeof (ctx->testing_userid);
+        if (size != val_size || !val) {
+            errno = EINVAL;
+            goto done;
+        }
+        memcpy (&ctx->testing_userid, val, val_size);
+    }
+    else if (streq (option, FLUX_OPT_TESTING_ROLEMASK)) {
+        val_size = sizeof (ctx->testing_rolemask);
+        if (size != val_size || !val) {
+            errno = EINVAL;
+            goto done;
+        }
+        memcpy (&ctx->testing_rolemask, val, val_size);
+    }
+    else {
+        errno = EINVAL;
+        goto done;
+    }
+    rc = 0;
+done:
+    return rc;
+}
+
+static void op_fini (void *impl)
+{
+    struct shmem_connector *ctx = impl;
+
+    if (ctx) {
+        int saved_errno = errno;
+        shmem_disconnect (ctx);
+        free (ctx->path);
+        free (ctx);
+        errno = saved_errno;
+    }
+}
+
+flux_t *connector_shmem_init (const char *path, int flags, flux_error_t *errp)
+{
+    struct shmem_connector *ctx;
+
+    if (!path) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(ctx = calloc (1, sizeof (*ctx))))
+        return NULL;
+
+    ctx->testing_userid = FLUX_USERID_UNKNOWN;
+    ctx->testing_rolemask = FLUX_ROLE_NONE;
+    ctx->fd = -1;
+    ctx->epfd = -1;
+
+    if (asprintf (&ctx->path, "%s%s", path, SHMRING_SOCKET_SUFFIX) < 0) {
+        ctx->path = NULL;
+        goto error;
+    }
+    if (shmem_connect (ctx) < 0) {
+        if (errno == ENOENT)
+            errprintf (errp,
+                       "broker socket %s was not found",
+                       ctx->path);
+        goto error;
+    }
+    if (!(ctx->h = flux_handle_create (ctx, &handle_ops, flags)))
+        goto error;
+    return ctx->h;
+error:
+    op_fini (ctx);
+    return NULL;
+}
+
+static void shmem_disconnect (struct shmem_connector *ctx)
+{
+    shmring_destroy (ctx->ring);
+    ctx->ring = NULL;
+    if (ctx->epfd >= 0) {
+        close (ctx->epfd);
+        ctx->epfd = -1;
+    }
+    if (ctx->fd >= 0) {
+        close (ctx->fd);
+        ctx->fd = -1;
+    }
+    ctx->sleeping = false;
+    ctx->hangup = false;
+}
+
+static int epoll_add (int epfd, int fd)
+{
+    struct epoll_event ev = { .events = EPOLLIN };
+
+    return epoll_ctl (epfd, EPOLL_CTL_ADD, fd, &ev);
+}
+
+static int shmem_connect (struct shmem_connector *ctx)
+{
+    struct usock_retry_params retry = USOCK_RETRY_DEFAULT;
+
+    if ((ctx->fd = usock_client_connect (ctx->path, retry)) < 0
+        || !(ctx->ring = shmring_recv_fds (ctx->fd))
+        || (ctx->epfd = epoll_create1 (EPOLL_CLOEXEC)) < 0
+        || epoll_add (ctx->epfd, shmring_pollfd (ctx->ring)) < 0
+        || epoll_add (ctx->epfd, ctx->fd) < 0) {
+        ERRNO_SAFE_WRAP (shmem_disconnect, ctx);
+        return -1;
+    }
+    return 0;
+}
+
+static int op_reconnect (void *impl)
+{
+    struct shmem_connector *ctx = impl;
+
+    shmem_disconnect (ctx);
+    return shmem_connect (ctx);
+}
+
+static const struct flux_handle_ops handle_ops = {
+    .pollfd = op_pollfd,
+    .pollevents = op_pollevents,
+    .send = op_send,
+    .recv = op_recv,
+    .reconnect = op_reconnect,
+    .setopt = op_setopt,
+    .impl_destroy = op_fini,
+};
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
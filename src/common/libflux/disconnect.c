@@ -16,6 +16,8 @@
 #endif
 #include <flux/core.h>
 
+#include "msglist_private.h"
+
 bool flux_disconnect_match (const flux_msg_t *msg1, const flux_msg_t *msg2)
 {
     struct flux_msg_cred cred;
@@ -41,13 +43,13 @@ int flux_msglist_disconnect (struct flux_msglist *l, const flux_msg_t *msg)
     const flux_msg_t *item;
     int count = 0;
 
-    item = flux_msglist_first (l);
+    item = msglist_sender_first (l, msg);
     while (item) {
         if (flux_disconnect_match (msg, item)) {
-            flux_msglist_delete (l);
+            msglist_sender_delete (l);
             count++;
         }
-        item = flux_msglist_next (l);
+        item = msglist_sender_next (l);
     }
     return count;
 }
@@ -79,16 +81,16 @@ int flux_msglist_cancel (flux_t *h,
     const flux_msg_t *item;
     int count = 0;
 
-    item = flux_msglist_first (l);
+    item = msglist_sender_first (l, msg);
     while (item) {
         if (flux_cancel_match (msg, item)) {
             if (flux_respond_error (h, item, ENODATA, NULL) < 0)
                 return -1;
-            flux_msglist_delete (l);
+            msglist_sender_delete (l);
             count++;
             break;
         }
-        item = flux_msglist_next (l);
+        item = msglist_sender_next (l);
     }
     return count;
 }
@@ -36,6 +36,7 @@ typedef struct {
     char buf[FLUX_MAX_LOGBUF];
     flux_log_f cb;
     void *cb_arg;
+    const int *filter;
 } logctx_t;
 
 static void freectx (void *arg)
@@ -98,6 +99,12 @@ void flux_log_set_redirect (flux_t *h, flux_log_f fun, void *arg)
     }
 }
 
+void flux_log_set_filter (flux_t *h, const int *level)
+{
+    logctx_t *ctx = getctx (h);
+    if (ctx)
+        ctx->filter = level;
+}
 
 const char *flux_strerror (int errnum)
 {
@@ -141,6 +148,9 @@ int flux_vlog (flux_t *h, int level, const char *fmt, va_list ap)
         errno = ENOMEM;
         goto fatal;
     }
+    if (ctx->filter
+        && LOG_PRI (level) > __atomic_load_n (ctx->filter, __ATOMIC_RELAXED))
+        return 0;
 
     stdlog_init (&hdr);
     hdr.pri = STDLOG_PRI (level, LOG_USER);
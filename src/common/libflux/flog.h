@@ -61,6 +61,13 @@ void flux_log_error (flux_t *h, const char *fmt, ...)
  */
 void flux_log_set_redirect (flux_t *h, flux_log_f fun, void *arg);
 
+/* Discard messages with a level greater than *level before they are
+ * formatted.  'level' must remain valid for the life of the handle, and
+ * may be updated concurrently by another thread.  The broker uses this
+ * to filter log messages from modules at the source.
+ */
+void flux_log_set_filter (flux_t *h, const int *level);
+
 /* Convert errno to string.
  * Flux errno space includes POSIX errno + zeromq errors.
  */
@@ -29,10 +29,12 @@
 
 #include "src/common/libczmqcontainers/czmq_containers.h"
 #include "src/common/libutil/iterators.h"
+#include "src/common/libutil/hdrhist.h"
 
 #define FRIPP_MAX_PACKET_LEN 1440
 #define INTERNAL_BUFFSIZE 128
 #define DEFAULT_AGG_PERIOD 1.0
+#define TIMER_PRECISION 3   /* quantiles within 12.5% */
 
 typedef enum {
     BRUBECK_COUNTER,
@@ -50,6 +52,7 @@ struct metric {
     union val prev;
     bool inc;
     metric_type type;
+    struct hdrhist *hist;   /* timer: microseconds, this period */
 };
 
 struct fripp_ctx {
@@ -206,7 +209,7 @@ int fripp_count (struct fripp_ctx *ctx,
     struct metric *m;
 
     if (!(m = zhashx_lookup (ctx->metrics, name))) {
-        if (!(m = malloc (sizeof (*m))))
+        if (!(m = calloc (1, sizeof (*m))))
             return -1;
 
         zhashx_insert (ctx->metrics, name, (void *) m);
@@ -266,17 +269,21 @@ int fripp_timing (struct fripp_ctx *ctx,
 
     struct metric *m;
 
+    /* Timings are aggregated into a histogram over each period, and
+     * reported as quantiles.
+     */
     if (!(m = zhashx_lookup (ctx->metrics, name))) {
-        if (!(m = malloc (sizeof (*m))))
+        if (!(m = calloc (1, sizeof (*m))))
             return -1;
 
         zhashx_insert (ctx->metrics, name, (void *) m);
-        m->prev.d = -1.0;
     }
+    if (!m->hist && !(m->hist = hdrhist_create (TIMER_PRECISION)))
+        return -1;
 
     m->type = BRUBECK_TIMER;
     m->inc = false;
-    m->cur.d = ms;
+    hdrhist_record (m->hist, ms * 1000.);
 
     flux_watcher_start (ctx->w);
 
@@ -286,11 +293,49 @@ int fripp_timing (struct fripp_ctx *ctx,
 static void metric_destroy (void **item)
 {
     if (item) {
-        free (*item);
+        struct metric *m = *item;
+        if (m) {
+            hdrhist_destroy (m->hist);
+            free (m);
+        }
         *item = NULL;
     }
 }
 
+static int timer_append (struct fripp_ctx *ctx,
+                         const char *name,
+                         struct hdrhist *hist)
+{
+    static const struct {
+        const char *suffix;
+        double q;
+    } quantiles[] = {
+        { "p50", 0.50 },
+        { "p95", 0.95 },
+        { "p99", 0.99 },
+        { "max", 1.0 },
+    };
+
+    if (fripp_packet_appendf (ctx,
+                              "%s.%s.count:%ju|g\n",
+                              ctx->prefix,
+                              name,
+                              (uintmax_t)hdrhist_count (hist)) < 0)
+        return -1;
+    for (int i = 0; i < sizeof (quantiles) / sizeof (quantiles[0]); i++) {
+        if (fripp_packet_appendf (ctx,
+                                  "%s.%s.%s:%lf|g\n",
+                                  ctx->prefix,
+                                  name,
+                                  quantiles[i].suffix,
+                                  hdrhist_quantile (hist,
+                                                    quantiles[i].q) / 1000.)
+            < 0)
+            return -1;
+    }
+    return 0;
+}
+
 static void timer_cb (flux_reactor_t *r,
                       flux_watcher_t *w,
                       int revents,
@@ -318,8 +363,13 @@ static void timer_cb (flux_reactor_t *r,
             zlist_append (ctx->done, (void *) name);
             continue;
         }
-        if (m->type == BRUBECK_TIMER && m->cur.d == m->prev.d) {
-            zlist_append (ctx->done, (void *) name);
+        if (m->type == BRUBECK_TIMER) {
+            if (hdrhist_count (m->hist) == 0)
+                zlist_append (ctx->done, (void *) name);
+            else {
+                (void)timer_append (ctx, name, m->hist);
+                hdrhist_clear (m->hist);
+            }
             continue;
         }
 
@@ -340,13 +390,6 @@ static void timer_cb (flux_reactor_t *r,
                                            name,
                                            m->cur.l);
                 break;
-            case BRUBECK_TIMER:
-                rc = fripp_packet_appendf (ctx,
-                                           "%s.%s:%lf|ms\n",
-                                           ctx->prefix,
-                                           name,
-                                           m->cur.d);
-                break;
             default:
                 break;
         }
@@ -22,6 +22,7 @@
 
 #include "future.h"
 #include "flog.h"
+#include "trace.h"
 
 struct now_context {
     flux_t *h;              // (optional) cloned flux_t handle
@@ -66,6 +67,7 @@ struct flux_future {
     zlist_t *queue;
     flux_future_t *embed;
     int refcount;
+    struct trace_ctx trace;     // continuation runs in this trace context
 };
 
 static void check_cb (flux_reactor_t *r, flux_watcher_t *w,
@@ -314,9 +316,16 @@ flux_future_t *flux_future_create (flux_future_init_f cb, void *arg)
     f->queue = NULL;
     f->embed = NULL;
     f->refcount = 1;
+    trace_ctx_get (&f->trace);
     return f;
 }
 
+void future_set_trace (flux_future_t *f, const struct trace_ctx *ctx)
+{
+    if (f && ctx)
+        f->trace = *ctx;
+}
+
 void flux_future_incref (flux_future_t *f)
 {
     if (f)
@@ -793,8 +802,14 @@ static void check_cb (flux_reactor_t *r, flux_watcher_t *w,
 
     flux_watcher_stop (f->then->timer);
     then_context_stop (f->then);
-    if (f->then->continuation)
+    if (f->then->continuation) {
+        struct trace_ctx saved;
+
+        trace_ctx_get (&saved);
+        trace_ctx_set (&f->trace);
         f->then->continuation (f, f->then->continuation_arg);
+        trace_ctx_set (&saved);
+    }
     // N.B. callback might destroy future
 }
 
@@ -89,6 +89,14 @@ int flux_future_push (flux_future_t *cf, const char *name, flux_future_t *f);
 const char * flux_future_first_child (flux_future_t *cf);
 const char * flux_future_next_child (flux_future_t *cf);
 
+/* Return the name of the next child that was fulfilled since the last call,
+ * in order of fulfillment, or NULL if there are none.  Each child is
+ * returned once.  With a wait_any composite, this allows children to be
+ * processed as they are fulfilled by calling flux_future_reset(3) on the
+ * composite after each one.
+ */
+const char *flux_future_next_ready_child (flux_future_t *cf);
+
 flux_future_t *flux_future_get_child (flux_future_t *cf, const char *name);
 
 /* Future chaining
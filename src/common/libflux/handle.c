@@ -99,11 +99,13 @@ flux_t *connector_interthread_init (const char *uri,
                                     int flags,
                                     flux_error_t *errp);
 flux_t *connector_local_init (const char *uri, int flags, flux_error_t *errp);
+flux_t *connector_shmem_init (const char *uri, int flags, flux_error_t *errp);
 
 static struct builtin_connector builtin_connectors[] = {
     { "loop", &connector_loop_init },
     { "interthread", &connector_interthread_init },
     { "local", &connector_local_init },
+    { "shmem", &connector_shmem_init },
 };
 
 static void handle_trace (flux_t *h, const char *fmt, ...)
@@ -866,6 +868,68 @@ int flux_send (flux_t *h, const flux_msg_t *msg, int flags)
     return 0;
 }
 
+int flux_send_batch (flux_t *h,
+                     const flux_msg_t **msgs,
+                     int count,
+                     int flags)
+{
+    int sent = 0;
+    int i;
+
+    if (!h
+        || !msgs
+        || count < 0
+        || validate_flags (flags, FLUX_O_NONBLOCK) < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    for (i = 0; i < count; i++) {
+        if (!msgs[i]) {
+            errno = EINVAL;
+            return -1;
+        }
+    }
+    h = lookup_clone_ancestor (h);
+    if (!h->ops->send_batch) {
+        while (sent < count) {
+            if (flux_send (h, msgs[sent], flags) < 0)
+                return sent > 0 ? sent : -1;
+            sent++;
+        }
+        return sent;
+    }
+    if (h->destroy_in_progress) {
+        errno = ENOSYS;
+        return -1;
+    }
+    flags |= h->flags;
+    while (sent < count) {
+        int n;
+
+        if ((n = h->ops->send_batch (h->impl,
+                                     msgs + sent,
+                                     count - sent,
+                                     flags)) < 0) {
+            if (comms_error (h, errno) < 0)
+                return sent > 0 ? sent : -1;
+            /* retry if comms_error() returns success */
+            continue;
+        }
+        /* Account only for messages that were actually sent.
+         */
+        for (i = sent; i < sent + n; i++) {
+            update_tx_stats (h, msgs[i]);
+            handle_trace_message (h, msgs[i]);
+#if HAVE_CALIPER
+            profiling_msg_snapshot(h, msgs[i], flags, "send");
+#endif
+            rpc_track_update (h->tracker, msgs[i]);
+        }
+        sent += n;
+    }
+    return sent;
+}
+
 int flux_send_new (flux_t *h, flux_msg_t **msg, int flags)
 {
     if (!h || !msg || !*msg || (*msg)->refcount > 1) {
@@ -71,6 +71,13 @@ enum {
 #define FLUX_OPT_TESTING_ROLEMASK   "flux::testing_rolemask"
 #define FLUX_OPT_ROUTER_NAME        "flux::router_name"
 
+/* Read-only options for flux_opt_get(), if supported by the connector.
+ * RECV_QUEUE_DEPTH (int) is the number of messages waiting to be received.
+ * RECV_QUEUE_WAKEUPS (uint64_t) counts receive queue signals to the reactor.
+ */
+#define FLUX_OPT_RECV_QUEUE_DEPTH   "flux::recv_queue_depth"
+#define FLUX_OPT_RECV_QUEUE_WAKEUPS "flux::recv_queue_wakeups"
+
 /* Create/destroy a broker handle.
  * The 'uri' scheme name selects a connector to dynamically load.
  * The rest of the URI is parsed in an connector-specific manner.
@@ -148,6 +155,18 @@ int flux_send (flux_t *h, const flux_msg_t *msg, int flags);
  */
 int flux_send_new (flux_t *h, flux_msg_t **msg, int flags);
 
+/* Send 'count' messages in order.  Connectors that support it may coalesce
+ * the messages into fewer system calls or wakeups than flux_send() would.
+ * flags are as for flux_send().
+ * Returns 'count' on success.  On failure, returns the number of messages
+ * sent before the error, or -1 if none were sent, with errno set.  Only
+ * messages that were sent are counted in handle statistics and traced.
+ */
+int flux_send_batch (flux_t *h,
+                     const flux_msg_t **msgs,
+                     int count,
+                     int flags);
+
 /* Receive a message
  * flags may be 0 or FLUX_O_TRACE or FLUX_O_NONBLOCK (FLUX_O_COPROC is ignored)
  * flux_recv reads messages from the handle until 'match' is matched,
@@ -0,0 +1,188 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* latency.c - callback duration histograms
+ *
+ * The environment variable FLUX_CALLBACK_LATENCY enables instrumentation.
+ * Its value is a Flux Standard Duration threshold above which message
+ * handler callbacks are logged, e.g. "100ms", or "0" to collect
+ * histograms without logging.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "src/common/libczmqcontainers/czmq_containers.h"
+#include "src/common/libutil/fsd.h"
+#include "src/common/libutil/hdrhist.h"
+
+#include "latency.h"
+
+#define PRECISION       2       /* four buckets per power of two */
+
+struct latency_hist {
+    int msgtype;
+    struct hdrhist *hist;   // microseconds
+    char name[];
+};
+
+struct latency {
+    zhashx_t *hists;        // "msgtype name" => struct latency_hist
+};
+
+static pthread_once_t env_once = PTHREAD_ONCE_INIT;
+static bool env_enabled;
+static double env_threshold;
+
+static void env_init (void)
+{
+    const char *s;
+
+    if ((s = getenv ("FLUX_CALLBACK_LATENCY"))
+        && fsd_parse_duration (s, &env_threshold) == 0)
+        env_enabled = true;
+}
+
+bool latency_enabled (double *threshold)
+{
+    pthread_once (&env_once, env_init);
+    if (env_enabled && threshold)
+        *threshold = env_threshold;
+    return env_enabled;
+}
+
+double latency_now (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1E-9;
+}
+
+void latency_hist_record (struct latency_hist *hist, double seconds)
+{
+    if (hist)
+        hdrhist_record (hist->hist, seconds * 1E6);
+}
+
+static void hist_destructor (void **item)
+{
+    if (item) {
+        struct latency_hist *hist = *item;
+        if (hist) {
+            hdrhist_destroy (hist->hist);
+            free (hist);
+        }
+        *item = NULL;
+    }
+}
+
+void latency_destroy (struct latency *l)
+{
+    if (l) {
+        int saved_errno = errno;
+        zhashx_destroy (&l->hists);
+        free (l);
+        errno = saved_errno;
+    }
+}
+
+struct latency *latency_create (void)
+{
+    struct latency *l;
+
+    if (!(l = calloc (1, sizeof (*l))))
+        return NULL;
+    if (!(l->hists = zhashx_new ())) {
+        free (l);
+        errno = ENOMEM;
+        return NULL;
+    }
+    zhashx_set_destructor (l->hists, hist_destructor);
+    return l;
+}
+
+struct latency_hist *latency_hist_get (struct latency *l,
+                                       const char *name,
+                                       int msgtype)
+{
+    struct latency_hist *hist;
+    char key[256];
+
+    if (!l || !name)
+        return NULL;
+    (void)snprintf (key, sizeof (key), "%d %s", msgtype, name);
+    if (!(hist = zhashx_lookup (l->hists, key))) {
+        if (!(hist = calloc (1, sizeof (*hist) + strlen (name) + 1)))
+            return NULL;
+        if (!(hist->hist = hdrhist_create (PRECISION))) {
+            free (hist);
+            return NULL;
+        }
+        strcpy (hist->name, name);
+        hist->msgtype = msgtype;
+        (void)zhashx_insert (l->hists, key, hist);
+    }
+    return hist;
+}
+
+void latency_clear (struct latency *l)
+{
+    if (l) {
+        struct latency_hist *hist;
+
+        hist = zhashx_first (l->hists);
+        while (hist) {
+            hdrhist_clear (hist->hist);
+            hist = zhashx_next (l->hists);
+        }
+    }
+}
+
+int latency_foreach (struct latency *l, flux_latency_f cb, void *arg)
+{
+    struct latency_hist *hist;
+    int count = 0;
+
+    if (!l)
+        return 0;
+    hist = zhashx_first (l->hists);
+    while (hist) {
+        if (hdrhist_count (hist->hist) > 0) {
+            struct flux_latency_stats stats = {
+                .name = hist->name,
+                .msgtype = hist->msgtype,
+                .count = hdrhist_count (hist->hist),
+                .mean = hdrhist_mean (hist->hist) * 1E-6,
+                .max = hdrhist_max (hist->hist) * 1E-6,
+                .p50 = hdrhist_quantile (hist->hist, 0.50) * 1E-6,
+                .p90 = hdrhist_quantile (hist->hist, 0.90) * 1E-6,
+                .p99 = hdrhist_quantile (hist->hist, 0.99) * 1E-6,
+            };
+            if (cb)
+                cb (&stats, arg);
+            count++;
+        }
+        hist = zhashx_next (l->hists);
+    }
+    return count;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
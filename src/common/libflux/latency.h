@@ -0,0 +1,58 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _FLUX_CORE_LATENCY_H
+#define _FLUX_CORE_LATENCY_H
+
+#include <stdbool.h>
+
+#include "reactor.h"
+
+/* Named callback duration histograms, used by the reactor and message
+ * dispatcher when FLUX_CALLBACK_LATENCY is set in the environment.
+ *
+ * Buckets are log-linear (four per power of two) in microseconds, so the
+ * relative error of a reported quantile is at most 25%.
+ */
+
+struct latency;
+struct latency_hist;
+
+/* Return true if instrumentation is enabled.  If so, set 'threshold' to
+ * the duration in seconds above which callbacks should be logged, or zero
+ * if they should not be logged.
+ */
+bool latency_enabled (double *threshold);
+
+struct latency *latency_create (void);
+void latency_destroy (struct latency *l);
+
+/* Look up histogram by name and msgtype, creating it if it doesn't exist.
+ * The histogram remains valid until the container is destroyed.
+ */
+struct latency_hist *latency_hist_get (struct latency *l,
+                                       const char *name,
+                                       int msgtype);
+
+void latency_hist_record (struct latency_hist *hist, double seconds);
+
+/* Monotonic time in seconds, for measuring durations.
+ */
+double latency_now (void);
+
+void latency_clear (struct latency *l);
+
+int latency_foreach (struct latency *l, flux_latency_f cb, void *arg);
+
+#endif /* !_FLUX_CORE_LATENCY_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -47,6 +47,8 @@
 #include "message_iovec.h"
 #include "message_route.h"
 #include "message_proto.h"
+#include "message_cbor.h"
+#include "msg_pool.h"
 
 static int msg_validate (const flux_msg_t *msg)
 {
@@ -79,13 +81,66 @@ static void msg_setup_type (flux_msg_t *msg)
     }
 }
 
+static struct msg_payload_ref *payload_ref_create (flux_free_f destroy,
+                                                   void *arg)
+{
+    struct msg_payload_ref *ref;
+
+    if (!(ref = malloc (sizeof (*ref))))
+        return NULL;
+    ref->refcount = 1;
+    ref->destroy = destroy;
+    ref->arg = arg;
+    return ref;
+}
+
+static struct msg_payload_ref *payload_ref_incref (struct msg_payload_ref *ref)
+{
+    __atomic_add_fetch (&ref->refcount, 1, __ATOMIC_RELAXED);
+    return ref;
+}
+
+static void payload_ref_decref (struct msg_payload_ref *ref)
+{
+    if (ref && __atomic_sub_fetch (&ref->refcount, 1, __ATOMIC_ACQ_REL) == 0) {
+        if (ref->destroy)
+            ref->destroy (ref->arg);
+        free (ref);
+    }
+}
+
+/* Free an owned payload or drop the reference on a borrowed one.
+ */
+static void msg_payload_release (flux_msg_t *msg)
+{
+    if (msg->payload_ref) {
+        payload_ref_decref (msg->payload_ref);
+        msg->payload_ref = NULL;
+    }
+    else
+        msg_pool_buf_free (msg->payload);
+    msg->payload = NULL;
+    msg->payload_size = 0;
+}
+
+/* Drop objects derived from the payload.
+ */
+static void msg_payload_cache_clear (flux_msg_t *msg)
+{
+    json_decref (msg->json);
+    msg->json = NULL;
+    free (msg->json_str);
+    msg->json_str = NULL;
+}
+
 flux_msg_t *msg_create (void)
 {
     flux_msg_t *msg;
 
-    if (!(msg = calloc (1, sizeof (*msg))))
+    if (!(msg = msg_pool_msg_alloc ()))
         return NULL;
-    list_head_init (&msg->routes);
+    msg->routes = msg->routes_inline;
+    msg->routes_size = MSG_ROUTES_INLINE;
     list_node_init (&msg->list);
     msg->proto.userid = FLUX_USERID_UNKNOWN;
     msg->proto.rolemask = FLUX_ROLE_NONE;
@@ -112,14 +167,13 @@ void flux_msg_destroy (flux_msg_t *msg)
 {
     if (msg && msg->refcount > 0 && --msg->refcount == 0) {
         int saved_errno = errno;
-        if (msg_has_route (msg))
-            msg_route_clear (msg);
-        free (msg->topic);
-        free (msg->payload);
-        json_decref (msg->json);
+        msg_route_clear (msg);
+        msg_pool_buf_free (msg->topic);
+        msg_payload_release (msg);
+        msg_payload_cache_clear (msg);
         aux_destroy (&msg->aux);
         free (msg->lasterr);
-        free (msg);
+        msg_pool_msg_free (msg);
         errno = saved_errno;
     }
 }
@@ -183,17 +237,17 @@ ssize_t flux_msg_encode_size (const flux_msg_t *msg)
     if (msg_validate (msg) < 0)
         return -1;
 
-    encode_count (&size, PROTO_SIZE);
+    encode_count (&size, proto_size (&msg->proto));
     if (msg_has_payload (msg))
         encode_count (&size, msg->payload_size);
     if (msg_has_topic (msg))
         encode_count (&size, strlen (msg->topic));
     if (msg_has_route (msg)) {
-        struct route_id *r = NULL;
+        int i;
         /* route delimiter */
         encode_count (&size, 0);
-        list_for_each (&msg->routes, r, route_id_node)
-            encode_count (&size, strlen (r->id));
+        for (i = 0; i < msg->routes_len; i++)
+            encode_count (&size, msg->routes[i].len);
     }
     return size;
 }
@@ -228,7 +282,8 @@ static ssize_t encode_frame (uint8_t *buf,
 
 int flux_msg_encode (const flux_msg_t *msg, void *buf, size_t size)
 {
-    uint8_t proto[PROTO_SIZE];
+    uint8_t proto[PROTO_SIZE_MAX];
+    int proto_len;
     ssize_t total = 0;
     ssize_t n;
 
@@ -240,12 +295,13 @@ int flux_msg_encode (const flux_msg_t *msg, void *buf, size_t size)
         return -1;
     }
     if (msg_has_route (msg)) {
-        struct route_id *r = NULL;
-        list_for_each (&msg->routes, r, route_id_node) {
+        int i;
+        /* last hop is encoded first */
+        for (i = msg->routes_len - 1; i >= 0; i--) {
             if ((n = encode_frame (buf + total,
                                    size - total,
-                                   r->id,
-                                   strlen (r->id))) < 0)
+                                   (void *)route_id_str (&msg->routes[i]),
+                                   msg->routes[i].len)) < 0)
                 return -1;
             total += n;
         }
@@ -273,19 +329,23 @@ int flux_msg_encode (const flux_msg_t *msg, void *buf, size_t size)
             return -1;
         total += n;
     }
-    if (proto_encode (&msg->proto, proto, PROTO_SIZE) < 0
+    if ((proto_len = proto_encode (&msg->proto, proto, sizeof (proto))) < 0
         || (n = encode_frame (buf + total,
                               size - total,
                               proto,
-                              PROTO_SIZE)) < 0)
+                              proto_len)) < 0)
         return -1;
     total += n;
     return 0;
 }
 
-flux_msg_t *flux_msg_decode (const void *buf, size_t size)
+/* Split encoded message into an iovec of frames that point into 'buf'.
+ */
+static int decode_iovec (const void *buf,
+                         size_t size,
+                         struct msg_iovec **iovp,
+                         int *iovcntp)
 {
-    flux_msg_t *msg;
     const uint8_t *p = buf;
     struct msg_iovec *iov = NULL;
     int iovlen = 0;
@@ -314,16 +374,64 @@ flux_msg_t *flux_msg_decode (const void *buf, size_t size)
         }
         iov[iovcnt].data = p;
         iov[iovcnt].size = n;
+        iov[iovcnt].transport_data = NULL;
         iovcnt++;
         p += n;
     }
-    if (!(msg = iovec_to_msg (iov, iovcnt)))
-        goto error;
-    free (iov);
-    return msg;
+    *iovp = iov;
+    *iovcntp = iovcnt;
+    return 0;
 error:
     ERRNO_SAFE_WRAP (free, iov);
-    return NULL;
+    return -1;
+}
+
+flux_msg_t *flux_msg_decode (const void *buf, size_t size)
+{
+    flux_msg_t *msg;
+    struct msg_iovec *iov;
+    int iovcnt;
+
+    if (decode_iovec (buf, size, &iov, &iovcnt) < 0)
+        return NULL;
+    msg = iovec_to_msg (iov, iovcnt);
+    ERRNO_SAFE_WRAP (free, iov);
+    return msg;
+}
+
+flux_msg_t *flux_msg_decode_ref (const void *buf,
+                                 size_t size,
+                                 flux_free_f destroy,
+                                 void *arg)
+{
+    flux_msg_t *msg;
+    struct msg_iovec *iov;
+    int iovcnt;
+    bool borrowed = false;
+    int i;
+
+    if (!destroy) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (decode_iovec (buf, size, &iov, &iovcnt) < 0) {
+        ERRNO_SAFE_WRAP (destroy, arg);
+        return NULL;
+    }
+    for (i = 0; i < iovcnt; i++)
+        iov[i].transport_data = arg;
+    msg = iovec_to_msg_borrow (iov, iovcnt, destroy);
+    /* iovec_to_msg_borrow() clears transport_data of the payload frame
+     * if ownership of 'arg' was transferred to the message.
+     */
+    for (i = 0; i < iovcnt; i++) {
+        if (!iov[i].transport_data)
+            borrowed = true;
+    }
+    ERRNO_SAFE_WRAP (free, iov);
+    if (!borrowed)
+        ERRNO_SAFE_WRAP (destroy, arg);
+    return msg;
 }
 
 int flux_msg_set_type (flux_msg_t *msg, int type)
@@ -460,6 +568,32 @@ int flux_msg_get_rolemask (const flux_msg_t *msg, uint32_t *rolemask)
     return 0;
 }
 
+int flux_msg_set_trace (flux_msg_t *msg, uint64_t trace_id, uint64_t span_id)
+{
+    if (msg_validate (msg) < 0)
+        return -1;
+    msg->proto.trace_id = trace_id;
+    msg->proto.span_id = trace_id ? span_id : 0;
+    return 0;
+}
+
+int flux_msg_get_trace (const flux_msg_t *msg,
+                        uint64_t *trace_id,
+                        uint64_t *span_id)
+{
+    if (msg_validate (msg) < 0)
+        return -1;
+    if (msg->proto.trace_id == 0) {
+        errno = ENOENT;
+        return -1;
+    }
+    if (trace_id)
+        *trace_id = msg->proto.trace_id;
+    if (span_id)
+        *span_id = msg->proto.span_id;
+    return 0;
+}
+
 int flux_msg_get_cred (const flux_msg_t *msg, struct flux_msg_cred *cred)
 {
     if (msg_validate (msg) < 0)
@@ -757,24 +891,20 @@ int flux_msg_route_delete_last (flux_msg_t *msg)
 /* replaces flux_msg_nexthop */
 const char *flux_msg_route_last (const flux_msg_t *msg)
 {
-    struct route_id *r;
-
     if (msg_validate (msg) < 0 || !msg_has_route (msg))
         return NULL;
-    if ((r = list_top (&msg->routes, struct route_id, route_id_node)))
-        return r->id;
+    if (msg->routes_len > 0)
+        return route_id_str (&msg->routes[msg->routes_len - 1]);
     return NULL;
 }
 
 /* replaces flux_msg_sender */
 const char *flux_msg_route_first (const flux_msg_t *msg)
 {
-    struct route_id *r;
-
     if (msg_validate (msg) < 0 || !msg_has_route (msg))
         return NULL;
-    if ((r = list_tail (&msg->routes, struct route_id, route_id_node)))
-        return r->id;
+    if (msg->routes_len > 0)
+        return route_id_str (&msg->routes[0]);
     return NULL;
 }
 
@@ -793,24 +923,24 @@ int flux_msg_route_count (const flux_msg_t *msg)
  */
 static int flux_msg_route_size (const flux_msg_t *msg)
 {
-    struct route_id *r = NULL;
     int size = 0;
+    int i;
 
     assert (msg);
     if (!msg_has_route (msg)) {
         errno = EPROTO;
         return -1;
     }
-    list_for_each (&msg->routes, r, route_id_node)
-        size += strlen (r->id);
+    for (i = 0; i < msg->routes_len; i++)
+        size += msg->routes[i].len;
     return size;
 }
 
 char *flux_msg_route_string (const flux_msg_t *msg)
 {
-    struct route_id *r = NULL;
     int hops, len;
     char *buf, *cp;
+    int i;
 
     if (msg_validate (msg) < 0)
         return NULL;
@@ -823,14 +953,15 @@ char *flux_msg_route_string (const flux_msg_t *msg)
         return NULL;
     if (!(cp = buf = malloc (len + hops + 1)))
         return NULL;
-    list_for_each_rev (&msg->routes, r, route_id_node) {
+    for (i = 0; i < msg->routes_len; i++) {
+        const struct route_id *r = &msg->routes[i];
         if (cp > buf)
             *cp++ = '!';
-        int cpylen = strlen (r->id);
+        int cpylen = r->len;
         if (cpylen > 8) /* abbreviate long UUID */
             cpylen = 8;
         assert (cp - buf + cpylen < len + hops);
-        memcpy (cp, r->id, cpylen);
+        memcpy (cp, route_id_str (r), cpylen);
         cp += cpylen;
     }
     *cp = '\0';
@@ -847,13 +978,24 @@ int flux_msg_set_payload (flux_msg_t *msg, const void *buf, int size)
 {
     if (msg_validate (msg) < 0)
         return -1;
-    json_decref (msg->json);            /* invalidate cached json object */
-    msg->json = NULL;
+    msg_payload_cache_clear (msg);      /* invalidate cached json object */
     if (!msg_has_payload (msg) && (buf == NULL || size == 0))
         return 0;
+    /* Case #1a: replace borrowed payload.
+     * N.B. buf may point into the borrowed payload.
+     */
+    if (msg_has_payload (msg) && msg->payload_ref
+        && (buf != NULL && size > 0)) {
+        void *ptr;
+        if (!(ptr = msg_pool_buf_alloc (size)))
+            return -1;
+        memcpy (ptr, buf, size);
+        msg_payload_release (msg);
+        msg->payload = ptr;
+        msg->payload_size = size;
     /* Case #1: replace existing payload.
      */
-    if (msg_has_payload (msg) && (buf != NULL && size > 0)) {
+    } else if (msg_has_payload (msg) && (buf != NULL && size > 0)) {
         assert (msg->payload);
         if (msg->payload != buf || msg->payload_size != size) {
             if (payload_overlap (msg, buf)) {
@@ -863,19 +1005,19 @@ int flux_msg_set_payload (flux_msg_t *msg, const void *buf, int size)
         }
         if (size > msg->payload_size) {
             void *ptr;
-            if (!(ptr = realloc (msg->payload, size))) {
+            if (!(ptr = msg_pool_buf_realloc (msg->payload, size))) {
                 errno = ENOMEM;
                 return -1;
             }
             msg->payload = ptr;
-            msg->payload_size = size;
         }
         memcpy (msg->payload, buf, size);
+        msg->payload_size = size;
     /* Case #2: add payload.
      */
     } else if (!msg_has_payload (msg) && (buf != NULL && size > 0)) {
         assert (!msg->payload);
-        if (!(msg->payload = malloc (size)))
+        if (!(msg->payload = msg_pool_buf_alloc (size)))
             return -1;
         msg->payload_size = size;
         memcpy (msg->payload, buf, size);
@@ -884,14 +1026,47 @@ int flux_msg_set_payload (flux_msg_t *msg, const void *buf, int size)
      */
     } else if (msg_has_payload (msg) && (buf == NULL || size == 0)) {
         assert (msg->payload);
-        free (msg->payload);
-        msg->payload = NULL;
-        msg->payload_size = 0;
+        msg_payload_release (msg);
         msg_clear_flag (msg, FLUX_MSGFLAG_PAYLOAD);
     }
     return 0;
 }
 
+int msg_set_payload_ref (flux_msg_t *msg,
+                         const void *buf,
+                         size_t size,
+                         flux_free_f destroy,
+                         void *arg)
+{
+    struct msg_payload_ref *ref;
+
+    if (!(ref = payload_ref_create (destroy, arg)))
+        return -1;
+    msg_payload_cache_clear (msg);      /* invalidate cached json object */
+    if (msg_has_payload (msg))
+        msg_payload_release (msg);
+    msg->payload = (void *)buf;
+    msg->payload_size = size;
+    msg->payload_ref = ref;
+    msg_set_flag (msg, FLUX_MSGFLAG_PAYLOAD);
+    return 0;
+}
+
+int flux_msg_set_payload_ref (flux_msg_t *msg,
+                              const void *buf,
+                              int size,
+                              flux_free_f destroy,
+                              void *arg)
+{
+    if (msg_validate (msg) < 0)
+        return -1;
+    if (!buf || size <= 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    return msg_set_payload_ref (msg, buf, size, destroy, arg);
+}
+
 static inline void msg_lasterr_reset (flux_msg_t *msg)
 {
     if (msg_validate (msg) == 0) {
@@ -915,7 +1090,36 @@ static inline void msg_lasterr_set (flux_msg_t *msg,
     errno = saved_errno;
 }
 
-int flux_msg_vpack (flux_msg_t *msg, const char *fmt, va_list ap)
+/* Adopt 'buf', allocated with msg_pool_buf_alloc(), as the payload.
+ */
+static void msg_set_payload_owned (flux_msg_t *msg, void *buf, size_t size)
+{
+    msg_payload_cache_clear (msg);
+    if (msg_has_payload (msg))
+        msg_payload_release (msg);
+    msg->payload = buf;
+    msg->payload_size = size;
+    msg_set_flag (msg, FLUX_MSGFLAG_PAYLOAD);
+}
+
+static int msg_set_cbor (flux_msg_t *msg, json_t *o)
+{
+    ssize_t size;
+    void *buf;
+
+    if ((size = cbor_encoded_size (o)) < 0)
+        return -1;
+    if (!(buf = msg_pool_buf_alloc (size)))
+        return -1;
+    if (cbor_encode (o, buf, size) < 0) {
+        ERRNO_SAFE_WRAP (msg_pool_buf_free, buf);
+        return -1;
+    }
+    msg_set_payload_owned (msg, buf, size);
+    return 0;
+}
+
+static int msg_vpack (flux_msg_t *msg, bool cbor, const char *fmt, va_list ap)
 {
     char *json_str = NULL;
     json_t *json = NULL;
@@ -937,6 +1141,14 @@ int flux_msg_vpack (flux_msg_t *msg, const char *fmt, va_list ap)
         msg_lasterr_set (msg, "payload is not a JSON object");
         goto error_inval;
     }
+    if (cbor) {
+        if (msg_set_cbor (msg, json) < 0) {
+            msg_lasterr_set (msg, "cbor encode: %s", strerror (errno));
+            goto error;
+        }
+        json_decref (json);
+        return 0;
+    }
     if (!(json_str = json_dumps (json, JSON_COMPACT))) {
         msg_lasterr_set (msg, "json_dumps failed on pack result");
         goto error_inval;
@@ -958,6 +1170,11 @@ error:
     return -1;
 }
 
+int flux_msg_vpack (flux_msg_t *msg, const char *fmt, va_list ap)
+{
+    return msg_vpack (msg, false, fmt, ap);
+}
+
 int flux_msg_pack (flux_msg_t *msg, const char *fmt, ...)
 {
     va_list ap;
@@ -969,6 +1186,29 @@ int flux_msg_pack (flux_msg_t *msg, const char *fmt, ...)
     return rc;
 }
 
+int flux_msg_vpack_cbor (flux_msg_t *msg, const char *fmt, va_list ap)
+{
+    return msg_vpack (msg, true, fmt, ap);
+}
+
+int flux_msg_pack_cbor (flux_msg_t *msg, const char *fmt, ...)
+{
+    va_list ap;
+    int rc;
+
+    va_start (ap, fmt);
+    rc = flux_msg_vpack_cbor (msg, fmt, ap);
+    va_end (ap);
+    return rc;
+}
+
+bool flux_msg_is_cbor (const flux_msg_t *msg)
+{
+    if (msg_validate (msg) < 0 || !msg_has_payload (msg))
+        return false;
+    return cbor_is_encoded (msg->payload, msg->payload_size);
+}
+
 int flux_msg_get_payload (const flux_msg_t *msg, const void **buf, int *size)
 {
     if (msg_validate (msg) < 0)
@@ -1000,6 +1240,26 @@ int flux_msg_set_string (flux_msg_t *msg, const char *s)
         return flux_msg_set_payload (msg, NULL, 0);
 }
 
+/* Decode a CBOR payload to JSON text, cached in msg->json_str.
+ * N.B. as in flux_msg_vunpack(), msg is "annotated" despite const.
+ */
+static const char *msg_cbor_string (flux_msg_t *msg)
+{
+    if (!msg->json_str) {
+        if (!msg->json
+            && !(msg->json = cbor_decode (msg->payload,
+                                          msg->payload_size,
+                                          NULL)))
+            return NULL;
+        if (!(msg->json_str = json_dumps (msg->json,
+                                          JSON_COMPACT | JSON_ENCODE_ANY))) {
+            errno = ENOMEM;
+            return NULL;
+        }
+    }
+    return msg->json_str;
+}
+
 int flux_msg_get_string (const flux_msg_t *msg, const char **s)
 {
     const char *buf;
@@ -1011,6 +1271,9 @@ int flux_msg_get_string (const flux_msg_t *msg, const char **s)
     if (flux_msg_get_payload (msg, (const void **)&buf, &size) < 0) {
         errno = 0;
         result = NULL;
+    } else if (cbor_is_encoded (buf, size)) {
+        if (!(result = msg_cbor_string ((flux_msg_t *)msg)))
+            return -1;
     } else {
         if (!buf || size == 0 || buf[size - 1] != '\0') {
             errno = EPROTO;
@@ -1041,6 +1304,19 @@ int flux_msg_vunpack (const flux_msg_t *cmsg, const char *fmt, va_list ap)
         errno = EINVAL;
         return -1;
     }
+    if (!msg->json && flux_msg_is_cbor (msg)) {
+        if (!(msg->json = cbor_decode (msg->payload,
+                                       msg->payload_size,
+                                       &err))) {
+            msg_lasterr_set (msg, "%s", err.text);
+            return -1;
+        }
+        if (!json_is_object (msg->json)) {
+            msg_lasterr_set (msg, "payload is not a JSON object");
+            errno = EPROTO;
+            return -1;
+        }
+    }
     if (!msg->json) {
         if (flux_msg_get_string (msg, &json_str) < 0) {
             msg_lasterr_set (msg, "flux_msg_get_string: %s", strerror (errno));
@@ -1101,15 +1377,17 @@ int flux_msg_set_topic (flux_msg_t *msg, const char *topic)
         return -1;
     }
     if (msg_has_topic (msg) && topic) {         /* case 1: replace topic */
-        free (msg->topic);
-        if (!(msg->topic = strdup (topic)))
+        char *cpy;
+        if (!(cpy = msg_pool_strdup (topic)))
             return -1;
+        msg_pool_buf_free (msg->topic);
+        msg->topic = cpy;
     } else if (!msg_has_topic (msg) && topic) { /* case 2: add topic */
-        if (!(msg->topic = strdup (topic)))
+        if (!(msg->topic = msg_pool_strdup (topic)))
             return -1;
         msg_set_flag (msg, FLUX_MSGFLAG_TOPIC);
     } else if (msg_has_topic (msg) && !topic) { /* case 3: delete topic */
-        free (msg->topic);
+        msg_pool_buf_free (msg->topic);
         msg->topic = NULL;
         msg_clear_flag (msg, FLUX_MSGFLAG_TOPIC);
     }
@@ -1145,20 +1423,26 @@ flux_msg_t *flux_msg_copy (const flux_msg_t *msg, bool payload)
     cpy->proto = msg->proto;
 
     if (flux_msg_route_count (msg) > 0) {
-        struct route_id *r = NULL;
-        list_for_each_rev (&msg->routes, r, route_id_node) {
-            if (flux_msg_route_push (cpy, r->id) < 0)
+        int i;
+        for (i = 0; i < msg->routes_len; i++) {
+            const struct route_id *r = &msg->routes[i];
+            if (msg_route_push (cpy, route_id_str (r), r->len) < 0)
                 goto error;
         }
     }
     if (msg->topic) {
-        if (!(cpy->topic = strdup (msg->topic)))
+        if (!(cpy->topic = msg_pool_strdup (msg->topic)))
             goto nomem;
     }
     if (msg->payload) {
-        if (payload) {
+        if (payload && msg->payload_ref) {
+            cpy->payload = msg->payload;
+            cpy->payload_size = msg->payload_size;
+            cpy->payload_ref = payload_ref_incref (msg->payload_ref);
+        }
+        else if (payload) {
             cpy->payload_size = msg->payload_size;
-            if (!(cpy->payload = malloc (cpy->payload_size)))
+            if (!(cpy->payload = msg_pool_buf_alloc (cpy->payload_size)))
                 goto error;
             memcpy (cpy->payload, msg->payload, msg->payload_size);
         }
@@ -1357,6 +1641,12 @@ void flux_msg_fprint_ts (FILE *f, const flux_msg_t *msg, double timestamp)
                      msg->proto.aux2);
             break;
     }
+    if (msg->proto.trace_id) {
+        fprintf (f, "%s trace=%016" PRIx64 " span=%016" PRIx64 "\n",
+                 prefix,
+                 msg->proto.trace_id,
+                 msg->proto.span_id);
+    }
     /* Route stack
      */
     hops = flux_msg_route_count (msg); /* -1 if no route stack */
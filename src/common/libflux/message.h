@@ -130,6 +130,18 @@ int flux_msg_encode (const flux_msg_t *msg, void *buf, size_t size);
  */
 flux_msg_t *flux_msg_decode (const void *buf, size_t size);
 
+/* Decode a flux_msg_t from buffer, with a large payload referencing 'buf'
+ * directly instead of being copied.  The message takes ownership of
+ * 'buf' and calls destroy (arg) once it is no longer needed, which may be
+ * before this function returns if the payload was small enough to copy,
+ * or if decoding failed.  'buf' must not be modified until then.
+ * Returns message on success, NULL on failure with errno set.
+ */
+flux_msg_t *flux_msg_decode_ref (const void *buf,
+                                 size_t size,
+                                 flux_free_f destroy,
+                                 void *arg);
+
 /* Get/set message type
  * For FLUX_MSGTYPE_REQUEST: set_type initializes nodeid to FLUX_NODEID_ANY
  * For FLUX_MSGTYPE_RESPONSE: set_type initializes errnum to 0
@@ -171,6 +183,19 @@ int flux_msg_get_topic (const flux_msg_t *msg, const char **topic);
  */
 int flux_msg_get_payload (const flux_msg_t *msg, const void **buf, int *size);
 int flux_msg_set_payload (flux_msg_t *msg, const void *buf, int size);
+
+/* Set payload to 'buf' without copying.  The message takes ownership of
+ * 'buf' and calls destroy (arg) when the payload is released, e.g. when the
+ * last message referencing it is destroyed or the payload is replaced.
+ * Messages copied with flux_msg_copy() share the buffer.  'buf' must not
+ * be modified until destroy is called, which may occur in another thread.
+ * On failure, destroy is not called.
+ */
+int flux_msg_set_payload_ref (flux_msg_t *msg,
+                              const void *buf,
+                              int size,
+                              flux_free_f destroy,
+                              void *arg);
 bool flux_msg_has_payload (const flux_msg_t *msg);
 
 /* Test/set/clear message flags
@@ -197,6 +222,16 @@ int flux_msg_vpack (flux_msg_t *msg, const char *fmt, va_list ap);
 int flux_msg_unpack (const flux_msg_t *msg, const char *fmt, ...);
 int flux_msg_vunpack (const flux_msg_t *msg, const char *fmt, va_list ap);
 
+/* Like flux_msg_pack(), but encode the JSON object in binary (CBOR) form,
+ * which is cheaper to produce and parse.  flux_msg_unpack() and
+ * flux_msg_get_string() accept either encoding, but peers linked with an
+ * older libflux-core do not, so the receiver must be known to support it.
+ * flux_msg_is_cbor() returns true if the payload is CBOR encoded.
+ */
+int flux_msg_pack_cbor (flux_msg_t *msg, const char *fmt, ...);
+int flux_msg_vpack_cbor (flux_msg_t *msg, const char *fmt, va_list ap);
+bool flux_msg_is_cbor (const flux_msg_t *msg);
+
 /* Return a string representation of the last error encountered for `msg`.
  *
  * If no last error is available, an empty string will be returned.
@@ -258,6 +293,16 @@ int flux_msg_authorize (const flux_msg_t *msg, uint32_t userid);
  */
 bool flux_msg_is_local (const flux_msg_t *msg);
 
+/* Get/set request trace context (see flux-environment(7) FLUX_TRACE_SAMPLE).
+ * 'trace_id' identifies the trace and 'span_id' the span that sent the
+ * message.  Set 'trace_id' to 0 to remove the context.
+ * flux_msg_get_trace() fails with ENOENT if the message is not traced.
+ */
+int flux_msg_set_trace (flux_msg_t *msg, uint64_t trace_id, uint64_t span_id);
+int flux_msg_get_trace (const flux_msg_t *msg,
+                        uint64_t *trace_id,
+                        uint64_t *span_id);
+
 /* Get/set errnum (response only)
  */
 int flux_msg_set_errnum (flux_msg_t *msg, int errnum);
@@ -364,6 +409,19 @@ char *flux_msg_route_string (const flux_msg_t *msg);
 bool flux_msg_route_match_first (const flux_msg_t *msg1,
                                  const flux_msg_t *msg2);
 
+/* Message allocation cache counters for the calling thread.
+ * A "hit" is an allocation satisfied from the thread's freelist,
+ * a "miss" is one that fell through to malloc(3).
+ */
+struct flux_msg_pool_stats {
+    uint64_t msg_hit;
+    uint64_t msg_miss;
+    uint64_t buf_hit;
+    uint64_t buf_miss;
+};
+
+void flux_msg_pool_get_stats (struct flux_msg_pool_stats *stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,565 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* message_cbor.c - encode/decode JSON message payloads as CBOR
+ *
+ * Text JSON costs a number formatting and string escaping pass on the
+ * sender and a tokenizing pass on the receiver.  CBOR is length-prefixed
+ * and typed, so both directions are mostly memcpy.  The payload is still
+ * built and consumed as a json_t, so jansson format strings work as usual.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <errno.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <jansson.h>
+
+#include "ccan/endian/endian.h"
+
+#include "message_cbor.h"
+
+#define CBOR_MAJOR_UINT     0
+#define CBOR_MAJOR_NINT     1
+#define CBOR_MAJOR_TEXT     3
+#define CBOR_MAJOR_ARRAY    4
+#define CBOR_MAJOR_MAP      5
+#define CBOR_MAJOR_SIMPLE   7
+
+#define CBOR_FALSE          0xf4
+#define CBOR_TRUE           0xf5
+#define CBOR_NULL           0xf6
+#define CBOR_FLOAT64        0xfb
+
+/* Same limit as jansson's parser.
+ */
+#define CBOR_MAX_DEPTH      2048
+
+static const uint8_t cbor_prefix[CBOR_PREFIX_SIZE] = { 0xd9, 0xd9, 0xf7 };
+
+struct reader {
+    const uint8_t *start;
+    const uint8_t *p;
+    const uint8_t *end;
+    json_error_t *error;
+};
+
+bool cbor_is_encoded (const void *buf, size_t size)
+{
+    return (buf
+            && size >= CBOR_PREFIX_SIZE
+            && memcmp (buf, cbor_prefix, CBOR_PREFIX_SIZE) == 0);
+}
+
+static size_t head_size (uint64_t val)
+{
+    if (val < 24)
+        return 1;
+    if (val <= UINT8_MAX)
+        return 2;
+    if (val <= UINT16_MAX)
+        return 3;
+    if (val <= UINT32_MAX)
+        return 5;
+    return 9;
+}
+
+static uint8_t *put_head (uint8_t *p, int major, uint64_t val)
+{
+    uint8_t ib = major << 5;
+
+    if (val < 24)
+        *p++ = ib | val;
+    else if (val <= UINT8_MAX) {
+        *p++ = ib | 24;
+        *p++ = val;
+    }
+    else if (val <= UINT16_MAX) {
+        beint16_t v = cpu_to_be16 (val);
+        *p++ = ib | 25;
+        memcpy (p, &v, sizeof (v));
+        p += sizeof (v);
+    }
+    else if (val <= UINT32_MAX) {
+        beint32_t v = cpu_to_be32 (val);
+        *p++ = ib | 26;
+        memcpy (p, &v, sizeof (v));
+        p += sizeof (v);
+    }
+    else {
+        beint64_t v = cpu_to_be64 (val);
+        *p++ = ib | 27;
+        memcpy (p, &v, sizeof (v));
+        p += sizeof (v);
+    }
+    return p;
+}
+
+static ssize_t value_size (json_t *o)
+{
+    ssize_t size;
+    ssize_t n;
+
+    switch (json_typeof (o)) {
+        case JSON_OBJECT: {
+            const char *key;
+            json_t *value;
+
+            size = head_size (json_object_size (o));
+            json_object_foreach (o, key, value) {
+                size_t len = strlen (key);
+                if ((n = value_size (value)) < 0)
+                    return -1;
+                size += head_size (len) + len + n;
+            }
+            return size;
+        }
+        case JSON_ARRAY: {
+            size_t index;
+            json_t *value;
+
+            size = head_size (json_array_size (o));
+            json_array_foreach (o, index, value) {
+                if ((n = value_size (value)) < 0)
+                    return -1;
+                size += n;
+            }
+            return size;
+        }
+        case JSON_STRING: {
+            size_t len = json_string_length (o);
+            return head_size (len) + len;
+        }
+        case JSON_INTEGER: {
+            json_int_t i = json_integer_value (o);
+            return head_size (i >= 0 ? (uint64_t)i : (uint64_t)(-1 - i));
+        }
+        case JSON_REAL:
+            return 9;
+        case JSON_TRUE:
+        case JSON_FALSE:
+        case JSON_NULL:
+            return 1;
+    }
+    errno = EINVAL;
+    return -1;
+}
+
+ssize_t cbor_encoded_size (json_t *o)
+{
+    ssize_t size;
+
+    if (!o) {
+        errno = EINVAL;
+        return -1;
+    }
+    if ((size = value_size (o)) < 0)
+        return -1;
+    return CBOR_PREFIX_SIZE + size;
+}
+
+/* The caller has ensured that the buffer is large enough.
+ */
+static uint8_t *put_value (uint8_t *p, json_t *o)
+{
+    switch (json_typeof (o)) {
+        case JSON_OBJECT: {
+            const char *key;
+            json_t *value;
+
+            p = put_head (p, CBOR_MAJOR_MAP, json_object_size (o));
+            json_object_foreach (o, key, value) {
+                size_t len = strlen (key);
+                p = put_head (p, CBOR_MAJOR_TEXT, len);
+                memcpy (p, key, len);
+                p = put_value (p + len, value);
+            }
+            break;
+        }
+        case JSON_ARRAY: {
+            size_t index;
+            json_t *value;
+
+            p = put_head (p, CBOR_MAJOR_ARRAY, json_array_size (o));
+            json_array_foreach (o, index, value)
+                p = put_value (p, value);
+            break;
+        }
+        case JSON_STRING: {
+            size_t len = json_string_length (o);
+            p = put_head (p, CBOR_MAJOR_TEXT, len);
+            memcpy (p, json_string_value (o), len);
+            p += len;
+            break;
+        }
+        case JSON_INTEGER: {
+            json_int_t i = json_integer_value (o);
+            if (i >= 0)
+                p = put_head (p, CBOR_MAJOR_UINT, i);
+            else
+                p = put_head (p, CBOR_MAJOR_NINT, (uint64_t)(-1 - i));
+            break;
+        }
+        case JSON_REAL: {
+            double d = json_real_value (o);
+            uint64_t bits;
+            beint64_t v;
+
+            memcpy (&bits, &d, sizeof (bits));
+            v = cpu_to_be64 (bits);
+            *p++ = CBOR_FLOAT64;
+            memcpy (p, &v, sizeof (v));
+            p += sizeof (v);
+            break;
+        }
+        case JSON_TRUE:
+            *p++ = CBOR_TRUE;
+            break;
+        case JSON_FALSE:
+            *p++ = CBOR_FALSE;
+            break;
+        case JSON_NULL:
+            *p++ = CBOR_NULL;
+            break;
+    }
+    return p;
+}
+
+ssize_t cbor_encode (json_t *o, void *buf, size_t size)
+{
+    ssize_t needed;
+    uint8_t *p = buf;
+
+    if (!buf || (needed = cbor_encoded_size (o)) < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (size < needed) {
+        errno = EOVERFLOW;
+        return -1;
+    }
+    memcpy (p, cbor_prefix, CBOR_PREFIX_SIZE);
+    p = put_value (p + CBOR_PREFIX_SIZE, o);
+    return p - (uint8_t *)buf;
+}
+
+static void __attribute__ ((format (printf, 2, 3)))
+decode_error (struct reader *r, const char *fmt, ...)
+{
+    if (r->error) {
+        va_list ap;
+
+        va_start (ap, fmt);
+        vsnprintf (r->error->text, sizeof (r->error->text), fmt, ap);
+        va_end (ap);
+        snprintf (r->error->source, sizeof (r->error->source), "<cbor>");
+        r->error->line = -1;
+        r->error->column = -1;
+        r->error->position = r->p - r->start;
+    }
+}
+
+static bool get_bytes (struct reader *r, void *dst, size_t len)
+{
+    if (r->end - r->p < len) {
+        decode_error (r, "unexpected end of input");
+        return false;
+    }
+    memcpy (dst, r->p, len);
+    r->p += len;
+    return true;
+}
+
+/* Read an initial byte and its argument.
+ */
+static bool get_head (struct reader *r, int *major, int *info, uint64_t *val)
+{
+    uint8_t ib;
+
+    if (!get_bytes (r, &ib, 1))
+        return false;
+    *major = ib >> 5;
+    *info = ib & 0x1f;
+    if (*info < 24)
+        *val = *info;
+    else if (*info == 24) {
+        uint8_t v;
+        if (!get_bytes (r, &v, sizeof (v)))
+            return false;
+        *val = v;
+    }
+    else if (*info == 25) {
+        beint16_t v;
+        if (!get_bytes (r, &v, sizeof (v)))
+            return false;
+        *val = be16_to_cpu (v);
+    }
+    else if (*info == 26) {
+        beint32_t v;
+        if (!get_bytes (r, &v, sizeof (v)))
+            return false;
+        *val = be32_to_cpu (v);
+    }
+    else if (*info == 27) {
+        beint64_t v;
+        if (!get_bytes (r, &v, sizeof (v)))
+            return false;
+        *val = be64_to_cpu (v);
+    }
+    else {
+        r->p--;
+        decode_error (r, "unsupported CBOR item 0x%02x", ib);
+        return false;
+    }
+    return true;
+}
+
+static double half_to_double (uint16_t half)
+{
+    int exp = (half >> 10) & 0x1f;
+    int mant = half & 0x3ff;
+    double d;
+
+    if (exp == 0)
+        d = ldexp (mant, -24);
+    else if (exp != 31)
+        d = ldexp (mant + 1024, exp - 25);
+    else
+        d = mant == 0 ? INFINITY : NAN;
+    return (half & 0x8000) ? -d : d;
+}
+
+static json_t *get_value (struct reader *r, int depth);
+
+static json_t *get_string (struct reader *r, uint64_t len)
+{
+    json_t *o;
+
+    if (r->end - r->p < len) {
+        decode_error (r, "string length exceeds input");
+        return NULL;
+    }
+    if (!(o = json_stringn ((const char *)r->p, len))) {
+        decode_error (r, "invalid UTF-8 string");
+        return NULL;
+    }
+    r->p += len;
+    return o;
+}
+
+static json_t *get_array (struct reader *r, uint64_t count, int depth)
+{
+    json_t *o;
+    uint64_t i;
+
+    if (r->end - r->p < count) {
+        decode_error (r, "array length exceeds input");
+        return NULL;
+    }
+    if (!(o = json_array ()))
+        goto nomem;
+    for (i = 0; i < count; i++) {
+        json_t *value;
+        if (!(value = get_value (r, depth + 1)))
+            goto error;
+        if (json_array_append_new (o, value) < 0)
+            goto nomem;
+    }
+    return o;
+nomem:
+    decode_error (r, "out of memory");
+error:
+    json_decref (o);
+    return NULL;
+}
+
+static json_t *get_map (struct reader *r, uint64_t count, int depth)
+{
+    json_t *o;
+    uint64_t i;
+    char buf[256];
+    char *key = NULL;
+
+    if ((r->end - r->p) / 2 < count) {
+        decode_error (r, "map length exceeds input");
+        return NULL;
+    }
+    if (!(o = json_object ()))
+        goto nomem;
+    for (i = 0; i < count; i++) {
+        int major, info;
+        uint64_t len;
+        json_t *value;
+
+        if (!get_head (r, &major, &info, &len))
+            goto error;
+        if (major != CBOR_MAJOR_TEXT) {
+            decode_error (r, "map key is not a string");
+            goto error;
+        }
+        if (r->end - r->p < len) {
+            decode_error (r, "string length exceeds input");
+            goto error;
+        }
+        if (memchr (r->p, '\0', len)) {
+            decode_error (r, "NUL byte in object key not supported");
+            goto error;
+        }
+        key = buf;
+        if (len >= sizeof (buf) && !(key = malloc (len + 1)))
+            goto nomem;
+        memcpy (key, r->p, len);
+        key[len] = '\0';
+        r->p += len;
+        if (!(value = get_value (r, depth + 1)))
+            goto error;
+        if (json_object_set_new (o, key, value) < 0) {
+            decode_error (r, "invalid object key");
+            goto error;
+        }
+        if (key != buf)
+            free (key);
+        key = NULL;
+    }
+    return o;
+nomem:
+    decode_error (r, "out of memory");
+error:
+    if (key != buf)
+        free (key);
+    json_decref (o);
+    return NULL;
+}
+
+static json_t *get_simple (struct reader *r, int info, uint64_t val)
+{
+    json_t *o = NULL;
+
+    switch (info) {
+        case 20:
+            o = json_false ();
+            break;
+        case 21:
+            o = json_true ();
+            break;
+        case 22:
+            o = json_null ();
+            break;
+        case 25:
+            o = json_real (half_to_double (val));
+            break;
+        case 26: {
+            uint32_t bits = val;
+            float f;
+            memcpy (&f, &bits, sizeof (f));
+            o = json_real (f);
+            break;
+        }
+        case 27: {
+            uint64_t bits = val;
+            double d;
+            memcpy (&d, &bits, sizeof (d));
+            o = json_real (d);
+            break;
+        }
+        default:
+            decode_error (r, "unsupported CBOR simple value");
+            return NULL;
+    }
+    if (!o)
+        decode_error (r, "real value is not finite");
+    return o;
+}
+
+static json_t *get_value (struct reader *r, int depth)
+{
+    int major, info;
+    uint64_t val;
+    json_t *o = NULL;
+
+    if (depth > CBOR_MAX_DEPTH) {
+        decode_error (r, "maximum nesting depth exceeded");
+        return NULL;
+    }
+    if (!get_head (r, &major, &info, &val))
+        return NULL;
+    switch (major) {
+        case CBOR_MAJOR_UINT:
+            if (val > INT64_MAX) {
+                decode_error (r, "integer out of range");
+                return NULL;
+            }
+            if (!(o = json_integer ((json_int_t)val)))
+                decode_error (r, "out of memory");
+            break;
+        case CBOR_MAJOR_NINT:
+            if (val > INT64_MAX) {
+                decode_error (r, "integer out of range");
+                return NULL;
+            }
+            if (!(o = json_integer (-1 - (json_int_t)val)))
+                decode_error (r, "out of memory");
+            break;
+        case CBOR_MAJOR_TEXT:
+            o = get_string (r, val);
+            break;
+        case CBOR_MAJOR_ARRAY:
+            o = get_array (r, val, depth);
+            break;
+        case CBOR_MAJOR_MAP:
+            o = get_map (r, val, depth);
+            break;
+        case CBOR_MAJOR_SIMPLE:
+            o = get_simple (r, info, val);
+            break;
+        default:
+            decode_error (r, "unsupported CBOR major type %d", major);
+            break;
+    }
+    return o;
+}
+
+json_t *cbor_decode (const void *buf, size_t size, json_error_t *error)
+{
+    struct reader r = {
+        .start = buf,
+        .p = buf,
+        .end = (const uint8_t *)buf + size,
+        .error = error,
+    };
+    json_t *o;
+
+    if (!cbor_is_encoded (buf, size)) {
+        decode_error (&r, "missing CBOR self-describe tag");
+        goto error;
+    }
+    r.p += CBOR_PREFIX_SIZE;
+    if (!(o = get_value (&r, 0)))
+        goto error;
+    if (r.p != r.end) {
+        decode_error (&r, "trailing data after CBOR item");
+        json_decref (o);
+        goto error;
+    }
+    return o;
+error:
+    errno = EPROTO;
+    return NULL;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,53 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _FLUX_CORE_MESSAGE_CBOR_H
+#define _FLUX_CORE_MESSAGE_CBOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include <jansson.h>
+
+/* Binary (CBOR, RFC 8949) encoding of JSON payloads.
+ *
+ * Encoded payloads begin with the CBOR "self-described" tag (0xd9d9f7),
+ * which cannot begin a JSON text, so binary and JSON payloads can be told
+ * apart without a message flag.  Only the subset of CBOR needed to
+ * represent JSON values is produced or accepted: definite length strings,
+ * arrays and maps, integers, doubles, booleans, and null.
+ */
+
+#define CBOR_PREFIX_SIZE    3
+
+/* Return true if payload 'buf' of length 'size' is CBOR encoded.
+ */
+bool cbor_is_encoded (const void *buf, size_t size);
+
+/* Return the encoded size of 'o' including the prefix, or -1 with
+ * errno = EINVAL if 'o' cannot be encoded.
+ */
+ssize_t cbor_encoded_size (json_t *o);
+
+/* Encode 'o' into 'buf', which must be at least cbor_encoded_size (o)
+ * bytes.  Returns the number of bytes written or -1 with errno set.
+ */
+ssize_t cbor_encode (json_t *o, void *buf, size_t size);
+
+/* Decode 'buf' of length 'size' to a new JSON value.
+ * Returns NULL with errno = EPROTO and 'error' filled in on failure.
+ */
+json_t *cbor_decode (const void *buf, size_t size, json_error_t *error);
+
+#endif /* !_FLUX_CORE_MESSAGE_CBOR_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
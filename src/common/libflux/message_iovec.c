@@ -23,8 +23,11 @@
 #include "message_route.h"
 #include "message_proto.h"
 #include "message_iovec.h"
+#include "msg_pool.h"
 
-flux_msg_t *iovec_to_msg (struct msg_iovec *iov, int iovcnt)
+static flux_msg_t *iovec_to_msg_ex (struct msg_iovec *iov,
+                                    int iovcnt,
+                                    flux_free_f destroy)
 {
     unsigned int index = 0;
     flux_msg_t *msg;
@@ -48,18 +51,24 @@ flux_msg_t *iovec_to_msg (struct msg_iovec *iov, int iovcnt)
         goto error;
     }
     if (msg_has_route (msg)) {
+        unsigned int count;
+        int i;
         /* On first access index == 0 && iovcnt > 0 guaranteed
          * Re-add check if code changes. */
         /* if (index == iovcnt) { */
         /*     errno = EPROTO; */
         /*     return -1; */
         /* } */
-        while ((index < iovcnt) && iov[index].size > 0) {
-            if (msg_route_append (msg,
-                                  (char *)iov[index].data,
-                                  iov[index].size) < 0)
-                goto error;
+        while ((index < iovcnt) && iov[index].size > 0)
             index++;
+        /* The first route frame is the last hop, so push in reverse.
+         */
+        count = index;
+        for (i = count - 1; i >= 0; i--) {
+            if (msg_route_push (msg,
+                                (char *)iov[i].data,
+                                iov[i].size) < 0)
+                goto error;
         }
         if (index < iovcnt)
             index++;
@@ -69,8 +78,8 @@ flux_msg_t *iovec_to_msg (struct msg_iovec *iov, int iovcnt)
             errno = EPROTO;
             goto error;
         }
-        if (!(msg->topic = strndup ((char *)iov[index].data,
-                                    iov[index].size)))
+        if (!(msg->topic = msg_pool_strndup ((char *)iov[index].data,
+                                             iov[index].size)))
             goto error;
         if (index < iovcnt)
             index++;
@@ -80,10 +89,23 @@ flux_msg_t *iovec_to_msg (struct msg_iovec *iov, int iovcnt)
             errno = EPROTO;
             goto error;
         }
-        msg->payload_size = iov[index].size;
-        if (!(msg->payload = malloc (msg->payload_size)))
-            goto error;
-        memcpy (msg->payload, iov[index].data, msg->payload_size);
+        if (destroy
+            && iov[index].transport_data
+            && iov[index].size >= IOVEC_BORROW_MIN) {
+            if (msg_set_payload_ref (msg,
+                                     iov[index].data,
+                                     iov[index].size,
+                                     destroy,
+                                     iov[index].transport_data) < 0)
+                goto error;
+            iov[index].transport_data = NULL;
+        }
+        else {
+            msg->payload_size = iov[index].size;
+            if (!(msg->payload = msg_pool_buf_alloc (msg->payload_size)))
+                goto error;
+            memcpy (msg->payload, iov[index].data, msg->payload_size);
+        }
         if (index < iovcnt)
             index++;
     }
@@ -98,6 +120,18 @@ error:
     return NULL;
 }
 
+flux_msg_t *iovec_to_msg (struct msg_iovec *iov, int iovcnt)
+{
+    return iovec_to_msg_ex (iov, iovcnt, NULL);
+}
+
+flux_msg_t *iovec_to_msg_borrow (struct msg_iovec *iov,
+                                 int iovcnt,
+                                 flux_free_f destroy)
+{
+    return iovec_to_msg_ex (iov, iovcnt, destroy);
+}
+
 int msg_to_iovec (const flux_msg_t *msg,
                   uint8_t *proto,
                   int proto_len,
@@ -107,13 +141,14 @@ int msg_to_iovec (const flux_msg_t *msg,
     struct msg_iovec *iov = NULL;
     int index;
     int frame_count;
+    int proto_size;
 
     /* msg never completed initial setup */
     if (!msg_type_is_valid (msg)) {
         errno = EPROTO;
         return -1;
     }
-    if (proto_encode (&msg->proto, proto, proto_len) < 0)
+    if ((proto_size = proto_encode (&msg->proto, proto, proto_len)) < 0)
         return -1;
 
     if ((frame_count = msg_frames (msg)) < 0)
@@ -127,7 +162,7 @@ int msg_to_iovec (const flux_msg_t *msg,
     index = frame_count - 1;
 
     iov[index].data = proto;
-    iov[index].size = PROTO_SIZE;
+    iov[index].size = proto_size;
     if (msg_has_payload (msg)) {
         index--;
         assert (index >= 0);
@@ -141,17 +176,17 @@ int msg_to_iovec (const flux_msg_t *msg,
         iov[index].size = strlen (msg->topic);
     }
     if (msg_has_route (msg)) {
-        struct route_id *r = NULL;
+        int i;
         /* delimiter */
         index--;
         assert (index >= 0);
         iov[index].data = NULL;
         iov[index].size = 0;
-        list_for_each_rev (&msg->routes, r, route_id_node) {
+        for (i = 0; i < msg->routes_len; i++) {
             index--;
             assert (index >= 0);
-            iov[index].data = r->id;
-            iov[index].size = strlen (r->id);
+            iov[index].data = route_id_str (&msg->routes[i]);
+            iov[index].size = msg->routes[i].len;
         }
     }
     (*iovp) = iov;
@@ -25,6 +25,21 @@ struct msg_iovec {
 
 flux_msg_t *iovec_to_msg (struct msg_iovec *iov, int iovcnt);
 
+/* Payload frames smaller than this are copied even if borrowing.
+ */
+#define IOVEC_BORROW_MIN    4096
+
+/* Like iovec_to_msg(), but if the payload frame has non-NULL transport_data
+ * and is at least IOVEC_BORROW_MIN bytes, the message payload points
+ * directly at the frame data instead of a copy.  Ownership of that
+ * transport_data passes to the message, which calls destroy (transport_data)
+ * when the payload is released.  The iovec's transport_data field is set to
+ * NULL to indicate that the transfer took place.
+ */
+flux_msg_t *iovec_to_msg_borrow (struct msg_iovec *iov,
+                                 int iovcnt,
+                                 flux_free_f destroy);
+
 int msg_to_iovec (const flux_msg_t *msg,
                   uint8_t *proto,
                   int proto_len,
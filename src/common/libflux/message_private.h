@@ -17,11 +17,21 @@
 #include "ccan/list/list.h"
 
 #include "message_proto.h"
+#include "message_route.h"
+
+/* Route stack depth that can be held without allocation.
+ * This covers a client request traversing a few TBON levels.
+ */
+#define MSG_ROUTES_INLINE   6
 
 struct flux_msg {
-    // optional route list, if FLUX_MSGFLAG_ROUTE
-    struct list_head routes;
-    int routes_len;     /* to avoid looping */
+    // optional route stack, if FLUX_MSGFLAG_ROUTE
+    // routes[0] is the first hop (sender), routes[routes_len - 1] the last.
+    // routes points to routes_inline unless the stack outgrew it.
+    struct route_id *routes;
+    int routes_len;
+    int routes_size;
+    struct route_id routes_inline[MSG_ROUTES_INLINE];
 
     // optional topic frame, if FLUX_MSGFLAG_TOPIC
     char *topic;
@@ -29,19 +39,40 @@ struct flux_msg {
     // optional payload frame, if FLUX_MSGFLAG_PAYLOAD
     void *payload;
     size_t payload_size;
+    struct msg_payload_ref *payload_ref; // non-NULL if payload is borrowed
 
     // required proto frame data
     struct proto proto;
 
     json_t *json;
+    char *json_str;      // JSON text transcoded from CBOR payload, if any
     char *lasterr;
     struct aux_item *aux;
     int refcount;
     struct list_node list; // for use by msg_deque container only
 };
 
+/* A borrowed payload is not owned by the message.  It may be shared by
+ * message copies, possibly in different threads, so refcount is
+ * manipulated atomically.  destroy (arg) is called on the last decref.
+ */
+struct msg_payload_ref {
+    int refcount;
+    flux_free_f destroy;
+    void *arg;
+};
+
 flux_msg_t *msg_create (void);
 
+/* Set payload to 'buf' without copying, replacing any existing payload.
+ * On failure, destroy is not called.
+ */
+int msg_set_payload_ref (flux_msg_t *msg,
+                         const void *buf,
+                         size_t size,
+                         flux_free_f destroy,
+                         void *arg);
+
 int msg_frames (const flux_msg_t *msg);
 
 #define msgtype_is_valid(tp) \
@@ -41,13 +41,31 @@ static bool be_push_u32(char **p, size_t *len, uint32_t val)
     return push_bytes (p, len, &v, sizeof (v));
 }
 
+static bool be_pull_u64 (const char **p, size_t *max_len, uint64_t *val)
+{
+    beint64_t v;
+
+    if (pull_bytes (p, max_len, &v, sizeof (v))) {
+        if (val)
+            *val = be64_to_cpu (v);
+        return true;
+    }
+    return false;
+}
+
+static bool be_push_u64 (char **p, size_t *len, uint64_t val)
+{
+    beint64_t v = cpu_to_be64 (val);
+    return push_bytes (p, len, &v, sizeof (v));
+}
+
 /* Realloc(3) replacement for push() that simply returns the pointer, unless
- * the requested length exceeds the fixed size of an encoded proto frame.
- * It assumes proto_encode() has received a static buffer >= PROTO_SIZE.
+ * the requested length exceeds the maximum size of an encoded proto frame.
+ * It assumes proto_encode() has received a buffer >= proto_size (proto).
  */
 static void *proto_realloc (void *ptr, size_t len)
 {
-    if (len > PROTO_SIZE)
+    if (len > PROTO_SIZE_MAX)
         return NULL;
     return ptr;
 }
@@ -59,7 +77,7 @@ int proto_encode (const struct proto *proto, void *buf, size_t size)
 
     push_set_realloc (proto_realloc);
 
-    if (size < PROTO_SIZE
+    if (size < proto_size (proto)
         || !push_u8 (&cp, &len, PROTO_MAGIC)
         || !push_u8 (&cp, &len, PROTO_VERSION)
         || !push_u8 (&cp, &len, proto->type)
@@ -68,11 +86,13 @@ int proto_encode (const struct proto *proto, void *buf, size_t size)
         || !be_push_u32 (&cp, &len, proto->rolemask)
         || !be_push_u32 (&cp, &len, proto->aux1)
         || !be_push_u32 (&cp, &len, proto->aux2)
-        || len < size) {
+        || (proto->trace_id
+            && (!be_push_u64 (&cp, &len, proto->trace_id)
+                || !be_push_u64 (&cp, &len, proto->span_id)))) {
         errno = EINVAL;
         return -1;
     }
-    return 0;
+    return len;
 }
 
 int proto_decode (struct proto *proto, const void *buf, size_t size)
@@ -90,8 +110,21 @@ int proto_decode (struct proto *proto, const void *buf, size_t size)
         || !be_pull_u32 (&cp, &len, &proto->userid)
         || !be_pull_u32 (&cp, &len, &proto->rolemask)
         || !be_pull_u32 (&cp, &len, &proto->aux1)
-        || !be_pull_u32 (&cp, &len, &proto->aux2)
-        || len > 0) {
+        || !be_pull_u32 (&cp, &len, &proto->aux2)) {
+        errno = EPROTO;
+        return -1;
+    }
+    proto->trace_id = 0;
+    proto->span_id = 0;
+    if (len == PROTO_SIZE_TRACE - PROTO_SIZE) {
+        if (!be_pull_u64 (&cp, &len, &proto->trace_id)
+            || !be_pull_u64 (&cp, &len, &proto->span_id)
+            || proto->trace_id == 0) {
+            errno = EPROTO;
+            return -1;
+        }
+    }
+    if (len > 0) {
         errno = EPROTO;
         return -1;
     }
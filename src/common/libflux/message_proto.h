@@ -15,6 +15,14 @@
 #define PROTO_VERSION       1
 #define PROTO_SIZE          20
 
+/* A traced message (trace_id != 0) appends the 64-bit trace and span IDs
+ * to the RFC 3 proto frame, so decoders accept either frame size.
+ */
+#define PROTO_SIZE_TRACE    (PROTO_SIZE + 16)
+#define PROTO_SIZE_MAX      PROTO_SIZE_TRACE
+
+#define proto_size(p)       ((p)->trace_id ? PROTO_SIZE_TRACE : PROTO_SIZE)
+
 struct proto {
     uint8_t type;
     uint8_t flags;
@@ -32,8 +40,13 @@ struct proto {
         uint32_t control_status; // control
         uint32_t aux2; // common accessor
     };
+    uint64_t trace_id;
+    uint64_t span_id;
 };
 
+/* Encode 'proto' to 'buf', which must hold at least proto_size (proto)
+ * bytes.  Returns the encoded size, or -1 on error.
+ */
 int proto_encode (const struct proto *proto, void *buf, size_t size);
 int proto_decode (struct proto *proto, const void *buf, size_t size);
 
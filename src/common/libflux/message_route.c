@@ -13,6 +13,7 @@
 #endif
 #include <errno.h>
 #include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 #include <arpa/inet.h>
 #include <assert.h>
@@ -21,74 +22,92 @@
 #include "message.h"
 #include "message_private.h"
 #include "message_route.h"
+#include "msg_pool.h"
 
-static void route_id_destroy (void *data)
+static void route_id_clear (struct route_id *r)
 {
-    if (data) {
-        struct route_id *r = data;
-        free (r);
+    if (r->heap) {
+        msg_pool_buf_free (r->heap);
+        r->heap = NULL;
     }
 }
 
-static struct route_id *route_id_create (const char *id, unsigned int id_len)
+static int route_id_set (struct route_id *r,
+                         const char *id,
+                         unsigned int id_len)
 {
-    struct route_id *r;
-    if (!(r = calloc (1, sizeof (*r) + id_len + 1)))
-        return NULL;
-    if (id && id_len) {
-        memcpy (r->id, id, id_len);
-        list_node_init (&(r->route_id_node));
+    char *dst = r->buf;
+
+    if (id_len >= sizeof (r->buf)) {
+        if (!(dst = msg_pool_buf_alloc (id_len + 1)))
+            return -1;
+        r->heap = dst;
     }
-    return r;
+    else
+        r->heap = NULL;
+    memcpy (dst, id, id_len);
+    dst[id_len] = '\0';
+    r->len = id_len;
+    return 0;
 }
 
-int msg_route_push (flux_msg_t *msg,
-                    const char *id,
-                    unsigned int id_len)
+/* Double the route stack capacity, moving from the inline array to
+ * the heap on first growth.
+ */
+static int route_stack_grow (flux_msg_t *msg)
 {
-    struct route_id *r;
-    if (!(r = route_id_create (id, strlen (id))))
+    int new_size = msg->routes_size * 2;
+    struct route_id *new;
+
+    if (msg->routes == msg->routes_inline) {
+        if (!(new = malloc (sizeof (*new) * new_size)))
+            return -1;
+        memcpy (new, msg->routes, sizeof (*new) * msg->routes_len);
+    }
+    else if (!(new = realloc (msg->routes, sizeof (*new) * new_size)))
         return -1;
-    list_add (&msg->routes, &r->route_id_node);
-    msg->routes_len++;
+    msg->routes = new;
+    msg->routes_size = new_size;
     return 0;
 }
 
-int msg_route_append (flux_msg_t *msg,
-                      const char *id,
-                      unsigned int id_len)
+int msg_route_push (flux_msg_t *msg,
+                    const char *id,
+                    unsigned int id_len)
 {
-    struct route_id *r;
     assert (msg);
-    assert (msg_has_route (msg));
     assert (id);
-    if (!(r = route_id_create (id, id_len)))
+    if (msg->routes_len == msg->routes_size) {
+        if (route_stack_grow (msg) < 0)
+            return -1;
+    }
+    if (route_id_set (&msg->routes[msg->routes_len], id, id_len) < 0)
         return -1;
-    list_add_tail (&msg->routes, &r->route_id_node);
     msg->routes_len++;
     return 0;
 }
 
 void msg_route_clear (flux_msg_t *msg)
 {
-    struct route_id *r;
+    int i;
+
     assert (msg);
-    assert (msg_has_route (msg));
-    while ((r = list_pop (&msg->routes, struct route_id, route_id_node)))
-        route_id_destroy (r);
-    list_head_init (&msg->routes);
+    for (i = 0; i < msg->routes_len; i++)
+        route_id_clear (&msg->routes[i]);
+    if (msg->routes != msg->routes_inline) {
+        free (msg->routes);
+        msg->routes = msg->routes_inline;
+        msg->routes_size = MSG_ROUTES_INLINE;
+    }
     msg->routes_len = 0;
 }
 
 int msg_route_delete_last (flux_msg_t *msg)
 {
-    struct route_id *r;
     assert (msg);
     assert (msg_has_route (msg));
-    if ((r = list_pop (&msg->routes, struct route_id, route_id_node))) {
-        route_id_destroy (r);
-        msg->routes_len--;
-    }
+    if (msg->routes_len > 0)
+        route_id_clear (&msg->routes[--msg->routes_len]);
     return 0;
 }
 
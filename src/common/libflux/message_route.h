@@ -11,19 +11,30 @@
 #ifndef _FLUX_CORE_MESSAGE_ROUTE_H
 #define _FLUX_CORE_MESSAGE_ROUTE_H
 
+/* Route IDs shorter than ROUTE_ID_INLINE (e.g. a UUID string) are stored
+ * in the route_id itself; longer ones are allocated.
+ */
+#define ROUTE_ID_INLINE     40
+
 struct route_id {
-    struct list_node route_id_node;
-    char id[0];                 /* variable length id stored at end of struct */
+    char *heap;                 /* NULL if id is stored in buf */
+    unsigned int len;
+    char buf[ROUTE_ID_INLINE];
 };
 
+static inline const char *route_id_str (const struct route_id *r)
+{
+    return r->heap ? r->heap : r->buf;
+}
+
+/* Push 'id' onto the route stack, becoming the last hop.
+ */
 int msg_route_push (flux_msg_t *msg,
                     const char *id,
                     unsigned int id_len);
 
-int msg_route_append (flux_msg_t *msg,
-                      const char *id,
-                      unsigned int id_len);
-
+/* Pop all routes and release any memory allocated for the route stack.
+ */
 void msg_route_clear (flux_msg_t *msg);
 
 int msg_route_delete_last (flux_msg_t *msg);
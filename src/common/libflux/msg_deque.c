@@ -35,6 +35,15 @@
  *
  * In the current implementation, msg_deque size is unlimited, so POLLOUT is
  * always asserted in pollevents.
+ *
+ * With MSG_DEQUE_MPSC, push_back is lock-free and may be called from any
+ * number of threads, but all other operations must be called from a single
+ * consumer thread.  Pushed messages are linked onto an intrusive list
+ * (Vyukov's MPSC algorithm) through msg->list.next, and a stub node keeps
+ * the list non-empty so producers never contend with the consumer.  An
+ * atomic message count drives signaling: only the producer that takes the
+ * count from zero to non-zero writes the eventfd.  Messages requeued with
+ * push_front are kept on a private list owned by the consumer.
  */
 
 #if HAVE_CONFIG_H
@@ -46,6 +55,7 @@
 #include <pthread.h>
 #include <stdint.h>
 #include <errno.h>
+#include <sched.h>
 
 #include "ccan/list/list.h"
 
@@ -61,8 +71,17 @@ struct msg_deque {
     uint64_t event;
     pthread_mutex_t lock;
     int flags;
+    int count;
+    uint64_t wakeups;
+
+    /* MSG_DEQUE_MPSC only */
+    struct list_node *head;     // producers push here
+    struct list_node *tail;     // consumer pops here
+    struct list_node stub;
+    struct list_head front;     // push_front() messages, consumer only
 };
 
+
 void msg_deque_destroy (struct msg_deque *q)
 {
     if (q) {
@@ -72,7 +91,7 @@ void msg_deque_destroy (struct msg_deque *q)
             flux_msg_destroy (msg);
         if (q->pollfd >= 0)
             (void)close (q->pollfd);
-        if (!(q->flags & MSG_DEQUE_SINGLE_THREAD))
+        if (!(q->flags & (MSG_DEQUE_SINGLE_THREAD | MSG_DEQUE_MPSC)))
             pthread_mutex_destroy (&q->lock);
         free (q);
         errno = saved_errno;
@@ -83,7 +102,9 @@ struct msg_deque *msg_deque_create (int flags)
 {
     struct msg_deque *q;
 
-    if (flags != 0 && flags != MSG_DEQUE_SINGLE_THREAD) {
+    if (flags != 0
+        && flags != MSG_DEQUE_SINGLE_THREAD
+        && flags != MSG_DEQUE_MPSC) {
         errno = EINVAL;
         return NULL;
     }
@@ -92,9 +113,12 @@ struct msg_deque *msg_deque_create (int flags)
     q->flags = flags;
     q->pollfd = -1;
     q->pollevents = POLLOUT;
-    if (!(flags & MSG_DEQUE_SINGLE_THREAD))
+    if (!(flags & (MSG_DEQUE_SINGLE_THREAD | MSG_DEQUE_MPSC)))
         pthread_mutex_init (&q->lock, NULL);
     list_head_init (&q->messages);
+    list_head_init (&q->front);
+    q->stub.next = NULL;
+    q->head = q->tail = &q->stub;
     return q;
 }
 
@@ -117,6 +141,7 @@ static int msg_deque_raise_event (struct msg_deque *q)
         q->event = 1;
         if (write (q->pollfd, &q->event, sizeof (q->event)) < 0)
             return -1;
+        q->wakeups++;
     }
     return 0;
 }
@@ -134,6 +159,93 @@ static int msg_deque_clear_event (struct msg_deque *q)
     return 0;
 }
 
+/* Lock-free push of node 'n' by any thread.
+ */
+static void mpsc_link (struct msg_deque *q, struct list_node *n)
+{
+    struct list_node *prev;
+
+    __atomic_store_n (&n->next, NULL, __ATOMIC_RELAXED);
+    prev = __atomic_exchange_n (&q->head, n, __ATOMIC_ACQ_REL);
+    __atomic_store_n (&prev->next, n, __ATOMIC_RELEASE);
+}
+
+/* Pop a node from the consumer end.  Returns NULL if the list is empty,
+ * or if a producer has swapped in a new head but not yet linked it.
+ */
+static struct list_node *mpsc_unlink (struct msg_deque *q)
+{
+    struct list_node *tail = q->tail;
+    struct list_node *next = __atomic_load_n (&tail->next, __ATOMIC_ACQUIRE);
+
+    if (tail == &q->stub) {
+        if (!next)
+            return NULL;
+        q->tail = tail = next;
+        next = __atomic_load_n (&tail->next, __ATOMIC_ACQUIRE);
+    }
+    if (next) {
+        q->tail = next;
+        return tail;
+    }
+    if (tail != __atomic_load_n (&q->head, __ATOMIC_ACQUIRE))
+        return NULL;
+    mpsc_link (q, &q->stub);
+    next = __atomic_load_n (&tail->next, __ATOMIC_ACQUIRE);
+    if (next) {
+        q->tail = next;
+        return tail;
+    }
+    return NULL;
+}
+
+/* Account for 'n' new messages, waking the consumer if the queue was empty.
+ * The eventfd counter accumulates, so concurrent writes are harmless.
+ */
+static int mpsc_added (struct msg_deque *q, int n)
+{
+    if (__atomic_fetch_add (&q->count, n, __ATOMIC_SEQ_CST) == 0) {
+        int fd = __atomic_load_n (&q->pollfd, __ATOMIC_SEQ_CST);
+        if (fd >= 0) {
+            uint64_t val = 1;
+            if (write (fd, &val, sizeof (val)) < 0)
+                return -1;
+            __atomic_add_fetch (&q->wakeups, 1, __ATOMIC_RELAXED);
+        }
+    }
+    return 0;
+}
+
+/* Mark a message node as queued so check_push_args() rejects it.
+ */
+static void mpsc_push (struct msg_deque *q, flux_msg_t *msg)
+{
+    msg->list.prev = NULL;
+    mpsc_link (q, &msg->list);
+}
+
+static flux_msg_t *mpsc_pop_front (struct msg_deque *q)
+{
+    struct list_node *n;
+    flux_msg_t *msg;
+
+    if ((msg = list_pop (&q->front, struct flux_msg, list))) {
+        list_node_init (&msg->list);
+        goto done;
+    }
+    if (__atomic_load_n (&q->count, __ATOMIC_SEQ_CST) == 0)
+        return NULL;
+    /* A non-zero count means a message is linked, or is about to be.
+     */
+    while (!(n = mpsc_unlink (q)))
+        sched_yield ();
+    msg = container_of (n, struct flux_msg, list);
+    list_node_init (&msg->list);
+done:
+    __atomic_sub_fetch (&q->count, 1, __ATOMIC_SEQ_CST);
+    return msg;
+}
+
 bool check_push_args (struct msg_deque *q, flux_msg_t *msg)
 {
     if (!q || !msg)
@@ -161,6 +273,10 @@ int msg_deque_push_back (struct msg_deque *q, flux_msg_t *msg)
         errno = EINVAL;
         return -1;
     }
+    if ((q->flags & MSG_DEQUE_MPSC)) {
+        mpsc_push (q, msg);
+        return mpsc_added (q, 1);
+    }
     msg_deque_lock (q);
     if (!(q->pollevents & POLLIN)) {
         q->pollevents |= POLLIN;
@@ -170,6 +286,45 @@ int msg_deque_push_back (struct msg_deque *q, flux_msg_t *msg)
         }
     }
     list_add (&q->messages, &msg->list);
+    q->count++;
+    msg_deque_unlock (q);
+    return 0;
+}
+
+int msg_deque_push_back_batch (struct msg_deque *q,
+                               flux_msg_t **msgs,
+                               int count)
+{
+    int i;
+
+    if (!q || !msgs || count < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    for (i = 0; i < count; i++) {
+        if (!check_push_args (q, msgs[i])) {
+            errno = EINVAL;
+            return -1;
+        }
+    }
+    if (count == 0)
+        return 0;
+    if ((q->flags & MSG_DEQUE_MPSC)) {
+        for (i = 0; i < count; i++)
+            mpsc_push (q, msgs[i]);
+        return mpsc_added (q, count);
+    }
+    msg_deque_lock (q);
+    if (!(q->pollevents & POLLIN)) {
+        q->pollevents |= POLLIN;
+        if (msg_deque_raise_event (q) < 0) {
+            msg_deque_unlock (q);
+            return -1;
+        }
+    }
+    for (i = 0; i < count; i++)
+        list_add (&q->messages, &msgs[i]->list);
+    q->count += count;
     msg_deque_unlock (q);
     return 0;
 }
@@ -180,6 +335,10 @@ int msg_deque_push_front (struct msg_deque *q, flux_msg_t *msg)
         errno = EINVAL;
         return -1;
     }
+    if ((q->flags & MSG_DEQUE_MPSC)) {
+        list_add (&q->front, &msg->list);
+        return mpsc_added (q, 1);
+    }
     msg_deque_lock (q);
     if (!(q->pollevents & POLLIN)) {
         q->pollevents |= POLLIN;
@@ -189,6 +348,7 @@ int msg_deque_push_front (struct msg_deque *q, flux_msg_t *msg)
         }
     }
     list_add_tail (&q->messages, &msg->list);
+    q->count++;
     msg_deque_unlock (q);
     return 0;
 }
@@ -197,10 +357,13 @@ flux_msg_t *msg_deque_pop_front (struct msg_deque *q)
 {
     if (!q)
         return NULL;
+    if ((q->flags & MSG_DEQUE_MPSC))
+        return mpsc_pop_front (q);
     msg_deque_lock (q);
     flux_msg_t *msg = list_tail (&q->messages, struct flux_msg, list);
     if (msg) {
         list_del_init (&msg->list);
+        q->count--;
         if ((q->pollevents & POLLIN) && list_empty (&q->messages))
             q->pollevents &= ~POLLIN;
     }
@@ -212,6 +375,8 @@ bool msg_deque_empty (struct msg_deque *q)
 {
     if (!q)
         return true;
+    if ((q->flags & MSG_DEQUE_MPSC))
+        return __atomic_load_n (&q->count, __ATOMIC_SEQ_CST) == 0;
     msg_deque_lock (q);
     bool res = list_empty (&q->messages);
     msg_deque_unlock (q);
@@ -225,6 +390,23 @@ int msg_deque_pollfd (struct msg_deque *q)
         return -1;
     }
     int rc;
+    if ((q->flags & MSG_DEQUE_MPSC)) {
+        if (q->pollfd < 0) {
+            int fd;
+            if ((fd = eventfd (0, EFD_NONBLOCK)) < 0)
+                return -1;
+            __atomic_store_n (&q->pollfd, fd, __ATOMIC_SEQ_CST);
+            /* A producer that raced with the store may have skipped the
+             * eventfd, so raise it here if messages are already queued.
+             */
+            if (__atomic_load_n (&q->count, __ATOMIC_SEQ_CST) > 0) {
+                uint64_t val = 1;
+                if (write (fd, &val, sizeof (val)) < 0)
+                    return -1;
+            }
+        }
+        return q->pollfd;
+    }
     msg_deque_lock (q);
     if (q->pollfd < 0) {
         q->event = q->pollevents ? 1 : 0;
@@ -242,6 +424,21 @@ int msg_deque_pollevents (struct msg_deque *q)
         return -1;
     }
     int rc = -1;
+    if ((q->flags & MSG_DEQUE_MPSC)) {
+        /* Clear the eventfd before sampling count, so a message pushed
+         * after this point re-arms it.
+         */
+        if (q->pollfd >= 0) {
+            uint64_t val;
+            if (read (q->pollfd, &val, sizeof (val)) < 0
+                && errno != EAGAIN && errno != EWOULDBLOCK)
+                return -1;
+        }
+        rc = POLLOUT;
+        if (__atomic_load_n (&q->count, __ATOMIC_SEQ_CST) > 0)
+            rc |= POLLIN;
+        return rc;
+    }
     msg_deque_lock (q);
     if (msg_deque_clear_event (q) < 0)
         goto done;
@@ -251,4 +448,12 @@ done:
     return rc;
 }
 
+void msg_deque_get_stats (struct msg_deque *q, struct msg_deque_stats *stats)
+{
+    if (q && stats) {
+        stats->depth = __atomic_load_n (&q->count, __ATOMIC_RELAXED);
+        stats->wakeups = __atomic_load_n (&q->wakeups, __ATOMIC_RELAXED);
+    }
+}
+
 // vi:ts=4 sw=4 expandtab
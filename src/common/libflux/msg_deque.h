@@ -13,9 +13,14 @@
 
 /* If flags contains MSG_DEQUE_SINGLE_THREAD, pthread locking is eliminated
  * and messages are permitted to be pushed with a reference count > 1.
+ *
+ * If flags contains MSG_DEQUE_MPSC, msg_deque_push_back() and
+ * msg_deque_push_back_batch() are lock-free and may be called from any
+ * thread, but all other functions must be called from one consumer thread.
  */
 enum {
     MSG_DEQUE_SINGLE_THREAD = 1,
+    MSG_DEQUE_MPSC = 2,
 };
 
 struct msg_deque *msg_deque_create (int flags);
@@ -28,6 +33,14 @@ void msg_deque_destroy (struct msg_deque *q);
  */
 int msg_deque_push_back (struct msg_deque *q, flux_msg_t *msg);
 int msg_deque_push_front (struct msg_deque *q, flux_msg_t *msg);
+
+/* Push 'count' messages onto the back of the deque in order, taking the
+ * lock and raising POLLIN at most once.  All references are stolen on
+ * success; on failure, none are.
+ */
+int msg_deque_push_back_batch (struct msg_deque *q,
+                               flux_msg_t **msgs,
+                               int count);
 flux_msg_t *msg_deque_pop_front (struct msg_deque *q);
 
 int msg_deque_pollfd (struct msg_deque *q);
@@ -35,6 +48,13 @@ int msg_deque_pollevents (struct msg_deque *q);
 
 bool msg_deque_empty (struct msg_deque *q);
 
+struct msg_deque_stats {
+    int depth;          // messages currently queued
+    uint64_t wakeups;   // times pollfd was signaled
+};
+
+void msg_deque_get_stats (struct msg_deque *q, struct msg_deque_stats *stats);
+
 #endif // !_FLUX_CORE_MSG_DEQUE_H
 
 // vi:ts=4 sw=4 expandtab
@@ -12,6 +12,8 @@
 #include "config.h"
 #endif
 #include <assert.h>
+#include <stdlib.h>
+#include <string.h>
 #if HAVE_CALIPER
 #include <caliper/cali.h>
 #include <sys/syscall.h>
@@ -27,22 +29,39 @@
 #include "msg_handler.h"
 #include "response.h"
 #include "flog.h"
+#include "latency.h"
+#include "trace.h"
 
 struct handler_stack {
     flux_msg_handler_t *mh;  // current message handler in stack
     zlistx_t *stack;         // stack of message handlers if >1
 };
 
+/* Trie of dot-separated topic words, for handlers registered
+ * with a "word.word.*" topic glob.
+ */
+struct topic_trie {
+    zhashx_t *children;     // word => struct topic_trie
+    zlistx_t *handlers;
+};
+
 struct dispatch {
     flux_t *h;
-    zlist_t *handlers;
     zlist_t *handlers_new;
     zhashx_t *handlers_rpc; // matchtag => response handler
     zhashx_t *handlers_method; // topic => request handler (non-glob only)
+    zhashx_t *handlers_exact; // topic => list of handlers (not in above)
+    struct topic_trie *handlers_prefix; // "prefix.*" glob handlers
+    zlistx_t *handlers_glob; // all other glob handlers
+    int handlers_count;     // number of handlers in the three above
+    uint64_t handler_seq;
+    unsigned int destroy_gen;
     flux_watcher_t *w;
     int running_count;
     int usecount;
     zlist_t *unmatched;
+    struct latency *latency;    // NULL unless FLUX_CALLBACK_LATENCY is set
+    double latency_threshold;
 #if HAVE_CALIPER
     cali_id_t prof_msg_type;
     cali_id_t prof_msg_topic;
@@ -58,6 +77,9 @@ struct flux_msg_handler {
     uint32_t rolemask;
     flux_msg_handler_f fn;
     void *arg;
+    uint64_t seq;           // creation order, for ordered dispatch
+    zlistx_t *ilist;        // list in topic index containing handler
+    void *ihandle;
     uint8_t running:1;
 };
 
@@ -191,6 +213,276 @@ static bool isa_multmatch (const char *s)
     return false;
 }
 
+/* Return true if topic glob 's' has the form "word.word.*" with no other
+ * glob characters, so it may be matched by prefix.  N.B. fnmatch(3) is
+ * called without FNM_PATHNAME, so this matches any topic beginning with
+ * "word.word.".
+ */
+static bool isa_prefix (const char *s)
+{
+    size_t len;
+
+    if (!s || (len = strlen (s)) < 3)
+        return false;
+    if (s[len - 1] != '*' || s[len - 2] != '.')
+        return false;
+    if (strcspn (s, "*?[\\") != len - 1)
+        return false;
+    /* empty words would not survive the trip through the trie */
+    if (s[0] == '.' || strstr (s, "..") != NULL)
+        return false;
+    return true;
+}
+
+static void topic_trie_destroy (struct topic_trie *node)
+{
+    if (node) {
+        int saved_errno = errno;
+        zhashx_destroy (&node->children);
+        zlistx_destroy (&node->handlers);
+        free (node);
+        errno = saved_errno;
+    }
+}
+
+static void topic_trie_destructor (void **item)
+{
+    if (item) {
+        topic_trie_destroy (*item);
+        *item = NULL;
+    }
+}
+
+static struct topic_trie *topic_trie_create (void)
+{
+    struct topic_trie *node;
+
+    if (!(node = calloc (1, sizeof (*node))))
+        return NULL;
+    return node;
+}
+
+/* Find or create the trie node for "word.word.*" glob 's'.
+ */
+static struct topic_trie *topic_trie_get (struct topic_trie *root,
+                                          const char *s)
+{
+    struct topic_trie *node = root;
+    char *cpy;
+    char *word;
+    char *saveptr = NULL;
+    char *str;
+
+    if (!(cpy = strdup (s)))
+        return NULL;
+    cpy[strlen (cpy) - 2] = '\0'; // drop ".*"
+    str = cpy;
+    while ((word = strtok_r (str, ".", &saveptr))) {
+        struct topic_trie *child = NULL;
+
+        str = NULL;
+        if (!node->children) {
+            if (!(node->children = zhashx_new ()))
+                goto nomem;
+            zhashx_set_destructor (node->children, topic_trie_destructor);
+        }
+        if (!(child = zhashx_lookup (node->children, word))) {
+            if (!(child = topic_trie_create ()))
+                goto error;
+            (void)zhashx_insert (node->children, word, child);
+        }
+        node = child;
+    }
+    free (cpy);
+    return node;
+nomem:
+    errno = ENOMEM;
+error:
+    ERRNO_SAFE_WRAP (free, cpy);
+    return NULL;
+}
+
+static void exact_list_destructor (void **item)
+{
+    if (item) {
+        zlistx_destroy ((zlistx_t **)item);
+        *item = NULL;
+    }
+}
+
+/* Add handler to the topic index.  Lists are kept newest first.
+ */
+static int topic_index_add (struct dispatch *d, flux_msg_handler_t *mh)
+{
+    const char *glob = mh->match.topic_glob;
+    zlistx_t *l;
+
+    if (!isa_multmatch (glob)) {
+        if (!(l = zhashx_lookup (d->handlers_exact, glob))) {
+            if (!(l = zlistx_new ()))
+                goto nomem;
+            (void)zhashx_insert (d->handlers_exact, glob, l);
+        }
+    }
+    else if (isa_prefix (glob)) {
+        struct topic_trie *node;
+
+        if (!(node = topic_trie_get (d->handlers_prefix, glob)))
+            return -1;
+        if (!node->handlers && !(node->handlers = zlistx_new ()))
+            goto nomem;
+        l = node->handlers;
+    }
+    else
+        l = d->handlers_glob;
+    if (!(mh->ihandle = zlistx_add_start (l, mh)))
+        goto nomem;
+    mh->ilist = l;
+    d->handlers_count++;
+    return 0;
+nomem:
+    errno = ENOMEM;
+    return -1;
+}
+
+static void topic_index_remove (struct dispatch *d, flux_msg_handler_t *mh)
+{
+    if (mh->ilist) {
+        zlistx_delete (mh->ilist, mh->ihandle);
+        if (zlistx_size (mh->ilist) == 0
+            && !isa_multmatch (mh->match.topic_glob))
+            zhashx_delete (d->handlers_exact, mh->match.topic_glob);
+        mh->ilist = NULL;
+        mh->ihandle = NULL;
+        d->handlers_count--;
+    }
+}
+
+/* Handlers that might match a topic, sorted newest first.
+ */
+struct candidates {
+    flux_msg_handler_t **v;
+    int count;
+    int size;
+    flux_msg_handler_t *buf[32];
+};
+
+static void candidates_init (struct candidates *c)
+{
+    c->v = c->buf;
+    c->count = 0;
+    c->size = sizeof (c->buf) / sizeof (c->buf[0]);
+}
+
+static void candidates_clean (struct candidates *c)
+{
+    if (c->v != c->buf)
+        free (c->v);
+    candidates_init (c);
+}
+
+static int candidates_add (struct candidates *c,
+                           zlistx_t *l,
+                           uint64_t seq_max)
+{
+    flux_msg_handler_t *mh;
+
+    if (!l)
+        return 0;
+    mh = zlistx_first (l);
+    while (mh) {
+        if (mh->seq < seq_max) {
+            if (c->count == c->size) {
+                int size = c->size * 2;
+                flux_msg_handler_t **v;
+
+                if (c->v == c->buf) {
+                    if (!(v = malloc (size * sizeof (*v))))
+                        return -1;
+                    memcpy (v, c->buf, c->count * sizeof (*v));
+                }
+                else if (!(v = realloc (c->v, size * sizeof (*v))))
+                    return -1;
+                c->v = v;
+                c->size = size;
+            }
+            c->v[c->count++] = mh;
+        }
+        mh = zlistx_next (l);
+    }
+    return 0;
+}
+
+/* Walk the trie one topic word at a time, collecting "prefix.*" handlers
+ * for each prefix of 'topic' that is followed by a '.'.
+ */
+static int candidates_add_prefix (struct candidates *c,
+                                  struct topic_trie *node,
+                                  const char *topic,
+                                  uint64_t seq_max)
+{
+    const char *word = topic;
+    const char *dot;
+    char buf[128];
+
+    while (node->children && (dot = strchr (word, '.'))) {
+        size_t len = dot - word;
+        char *key = buf;
+
+        if (len >= sizeof (buf) && !(key = malloc (len + 1)))
+            return -1;
+        memcpy (key, word, len);
+        key[len] = '\0';
+        node = zhashx_lookup (node->children, key);
+        if (key != buf)
+            free (key);
+        if (!node)
+            break;
+        if (candidates_add (c, node->handlers, seq_max) < 0)
+            return -1;
+        word = dot + 1;
+    }
+    return 0;
+}
+
+static int candidates_cmp (const void *a, const void *b)
+{
+    const flux_msg_handler_t *mh1 = *(const flux_msg_handler_t **)a;
+    const flux_msg_handler_t *mh2 = *(const flux_msg_handler_t **)b;
+
+    if (mh1->seq > mh2->seq)
+        return -1;
+    if (mh1->seq < mh2->seq)
+        return 1;
+    return 0;
+}
+
+/* Gather handlers created before 'seq_max' that might match 'topic'.
+ * 'topic' may be NULL if the message has none.
+ */
+static int candidates_get (struct candidates *c,
+                           struct dispatch *d,
+                           const char *topic,
+                           uint64_t seq_max)
+{
+    c->count = 0;
+    if (topic) {
+        if (candidates_add (c,
+                            zhashx_lookup (d->handlers_exact, topic),
+                            seq_max) < 0
+            || candidates_add_prefix (c,
+                                      d->handlers_prefix,
+                                      topic,
+                                      seq_max) < 0)
+            return -1;
+    }
+    if (candidates_add (c, d->handlers_glob, seq_max) < 0)
+        return -1;
+    if (c->count > 1)
+        qsort (c->v, c->count, sizeof (c->v[0]), candidates_cmp);
+    return 0;
+}
+
 static void dispatch_requeue (struct dispatch *d)
 {
     if (d->unmatched) {
@@ -211,10 +503,10 @@ static void dispatch_usecount_decr (struct dispatch *d)
             dispatch_requeue (d);
             zlist_destroy (&d->unmatched);
         }
-        if (d->handlers) {
-            assert (zlist_size (d->handlers) == 0);
-            zlist_destroy (&d->handlers);
-        }
+        assert (d->handlers_count == 0);
+        zhashx_destroy (&d->handlers_exact);
+        topic_trie_destroy (d->handlers_prefix);
+        zlistx_destroy (&d->handlers_glob);
         if (d->handlers_new) {
             assert (zlist_size (d->handlers_new) == 0);
             zlist_destroy (&d->handlers_new);
@@ -222,6 +514,7 @@ static void dispatch_usecount_decr (struct dispatch *d)
         flux_watcher_destroy (d->w);
         zhashx_destroy (&d->handlers_rpc);
         zhashx_destroy (&d->handlers_method);
+        latency_destroy (d->latency);
         free (d);
         errno = saved_errno;
     }
@@ -248,10 +541,15 @@ static struct dispatch *dispatch_get (flux_t *h)
             return NULL;
         memset (d, 0, sizeof (*d));
         d->usecount = 1;
-        if (!(d->handlers = zlist_new ()))
-            goto nomem;
         if (!(d->handlers_new = zlist_new ()))
             goto nomem;
+        if (!(d->handlers_exact = zhashx_new ()))
+            goto nomem;
+        zhashx_set_destructor (d->handlers_exact, exact_list_destructor);
+        if (!(d->handlers_prefix = topic_trie_create ()))
+            goto error;
+        if (!(d->handlers_glob = zlistx_new ()))
+            goto nomem;
         d->h = h;
         d->w = flux_handle_watcher_create (r, h, FLUX_POLLIN, handle_cb, d);
         if (!d->w)
@@ -265,6 +563,9 @@ static struct dispatch *dispatch_get (flux_t *h)
 
         if (!(d->handlers_method = method_hash_create ()))
             goto nomem;
+        if (latency_enabled (&d->latency_threshold)
+            && !(d->latency = latency_create ()))
+            goto error;
 #if HAVE_CALIPER
         d->prof_msg_type = cali_create_attribute ("flux.message.type",
                                                   CALI_TYPE_STRING,
@@ -323,9 +624,53 @@ static int copy_match (struct flux_match *dst,
     return 0;
 }
 
+/* Run a handler and record its duration, keyed by topic glob, or by
+ * message topic if the handler has none (e.g. RPC response handlers).
+ * Log the message topic if it exceeds the threshold.  N.B. the handler
+ * may destroy itself so don't access 'mh' afterwards.
+ */
+static void call_handler_timed (flux_msg_handler_t *mh, const flux_msg_t *msg)
+{
+    struct dispatch *d = mh->d;
+    struct latency_hist *hist;
+    const char *topic = "unknown";
+    const char *name;
+    int type = 0;
+    double t;
+
+    (void)flux_msg_get_topic (msg, &topic);
+    (void)flux_msg_get_type (msg, &type);
+    if (!(name = mh->match.topic_glob))
+        name = topic;
+    hist = latency_hist_get (d->latency, name, type);
+
+    t = latency_now ();
+    mh->fn (d->h, mh, msg, mh->arg);
+    t = latency_now () - t;
+
+    latency_hist_record (hist, t);
+    if (d->latency_threshold > 0. && t > d->latency_threshold) {
+        flux_log (d->h,
+                  LOG_WARNING,
+                  "%s %s handler took %.0fms",
+                  topic,
+                  flux_msg_typestr (type),
+                  t * 1000);
+    }
+}
+
+static void call_handler_fn (flux_msg_handler_t *mh, const flux_msg_t *msg)
+{
+    if (mh->d->latency)
+        call_handler_timed (mh, msg);
+    else
+        mh->fn (mh->d->h, mh, msg, mh->arg);
+}
+
 static void call_handler (flux_msg_handler_t *mh, const flux_msg_t *msg)
 {
     uint32_t rolemask;
+    int type;
 
     if (flux_msg_get_rolemask (msg, &rolemask) < 0)
         return;
@@ -341,7 +686,17 @@ static void call_handler (flux_msg_handler_t *mh, const flux_msg_t *msg)
         }
         return;
     }
-    mh->fn (mh->d->h, mh, msg, mh->arg);
+    if (flux_msg_get_type (msg, &type) == 0
+        && type == FLUX_MSGTYPE_REQUEST
+        && flux_msg_get_trace (msg, NULL, NULL) == 0) {
+        struct trace_ctx saved;
+
+        trace_request_begin (mh->d->h, msg, &saved);
+        call_handler_fn (mh, msg);
+        trace_request_finish (mh->d->h, msg, &saved);
+    }
+    else
+        call_handler_fn (mh, msg);
 }
 
 /* Messages are matched in the following order:
@@ -350,6 +705,12 @@ static void call_handler (flux_msg_handler_t *mh, const flux_msg_t *msg)
  * 3) Requests and responses not matched above - sent to first match in
  *    list of handlers, where most recently registered handlers match first.
  * 4) Events - sent to all matches in list of handlers
+ *
+ * For 3) and 4), candidates are gathered from the topic index rather than
+ * testing every handler: literal topics by hash lookup, "prefix.*" globs
+ * by walking the trie, plus any other globs.  If a handler destroys other
+ * handlers while an event is being broadcast, candidates are re-gathered,
+ * continuing with handlers older than the last one called.
  */
 static bool dispatch_message (struct dispatch *d,
                               const flux_msg_t *msg,
@@ -383,17 +744,40 @@ static bool dispatch_message (struct dispatch *d,
     }
     /* other */
     if (!match) {
-        FOREACH_ZLIST (d->handlers, mh) {
-            if (!mh->running)
-                continue;
-            if (flux_msg_cmp (msg, mh->match)) {
+        struct candidates c;
+        const char *topic;
+        uint64_t seq_max = UINT64_MAX;
+        bool restart;
+        int i;
+
+        if (flux_msg_get_topic (msg, &topic) < 0)
+            topic = NULL;
+        candidates_init (&c);
+        do {
+            unsigned int gen = d->destroy_gen;
+
+            restart = false;
+            if (candidates_get (&c, d, topic, seq_max) < 0) {
+                flux_log_error (d->h, "error gathering message handlers");
+                break;
+            }
+            for (i = 0; i < c.count; i++) {
+                mh = c.v[i];
+                if (!mh->running || !flux_msg_cmp (msg, mh->match))
+                    continue;
+                seq_max = mh->seq;
                 call_handler (mh, msg);
                 if (type != FLUX_MSGTYPE_EVENT) {
                     match = true;
                     break;
                 }
+                if (d->destroy_gen != gen) {
+                    restart = true;
+                    break;
+                }
             }
-        }
+        } while (restart);
+        candidates_clean (&c);
     }
     return match;
 }
@@ -422,20 +806,15 @@ static void handle_late_response (struct dispatch *d, const flux_msg_t *msg)
         fprintf (stderr, "MATCHDEBUG: reclaimed matchtag=%d\n", matchtag);
 }
 
-static int transfer_items_zlist (zlist_t *from, zlist_t *to)
+static int transfer_new_handlers (struct dispatch *d)
 {
-    void *item;
-    int rc = -1;
+    flux_msg_handler_t *mh;
 
-    while ((item = zlist_pop (from))) {
-        if (zlist_push (to, item) < 0) {
-            errno = ENOMEM;
-            goto done;
-        }
+    while ((mh = zlist_pop (d->handlers_new))) {
+        if (topic_index_add (d, mh) < 0)
+            return -1;
     }
-    rc = 0;
-done:
-    return rc;
+    return 0;
 }
 
 static void handle_cb (flux_reactor_t *r,
@@ -467,7 +846,7 @@ static void handle_cb (flux_reactor_t *r,
     /* Add any new handlers here, making handler creation
      * safe to call during handlers list traversal below.
      */
-    if (transfer_items_zlist (d->handlers_new, d->handlers) < 0)
+    if (transfer_new_handlers (d) < 0)
         goto done;
 
 #if defined(HAVE_CALIPER)
@@ -608,8 +987,9 @@ void flux_msg_handler_destroy (flux_msg_handler_t *mh)
         }
         else {
             zlist_remove (mh->d->handlers_new, mh);
-            zlist_remove (mh->d->handlers, mh);
+            topic_index_remove (mh->d, mh);
         }
+        mh->d->destroy_gen++;
         flux_msg_handler_stop (mh);
         dispatch_usecount_decr (mh->d);
         free_msg_handler (mh);
@@ -639,6 +1019,7 @@ flux_msg_handler_t *flux_msg_handler_create (flux_t *h,
     mh->fn = cb;
     mh->arg = arg;
     mh->d = d;
+    mh->seq = ++d->handler_seq;
     /* Response (valid matchtag):
      * Fail if entry in the handlers_rpc hash exists, since that probably
      * indicates a matchtag reuse problem!
@@ -666,8 +1047,8 @@ flux_msg_handler_t *flux_msg_handler_create (flux_t *h,
      * Event messages are broadcast to all matching handlers.
      */
     else {
-        /* N.B. append(handlers_new); later, pop(handlers_new), push(handlers).
-         * Net effect: push(handlers).
+        /* N.B. append(handlers_new); later, pop(handlers_new), then push
+         * onto the appropriate topic index list.
          */
         if (zlist_append (d->handlers_new, mh) < 0) {
             errno = ENOMEM;
@@ -753,6 +1134,29 @@ void flux_msg_handler_delvec (flux_msg_handler_t *handlers[])
     }
 }
 
+int flux_msg_handler_latency_foreach (flux_t *h,
+                                      flux_latency_f cb,
+                                      void *arg)
+{
+    struct dispatch *d;
+
+    if (!h) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!(d = dispatch_get (h)))
+        return -1;
+    return latency_foreach (d->latency, cb, arg);
+}
+
+void flux_msg_handler_latency_clear (flux_t *h)
+{
+    struct dispatch *d;
+
+    if (h && (d = dispatch_get (h)))
+        latency_clear (d->latency);
+}
+
 int flux_dispatch_requeue (flux_t *h)
 {
     struct dispatch *d;
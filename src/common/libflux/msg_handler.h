@@ -13,6 +13,7 @@
 
 #include "message.h"
 #include "handle.h"
+#include "reactor.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -61,6 +62,39 @@ int flux_msg_handler_addvec (flux_t *h,
                              flux_msg_handler_t **msg_handlers[]);
 void flux_msg_handler_delvec (flux_msg_handler_t *msg_handlers[]);
 
+/* Call 'cb' for each message handler topic and type that has been
+ * dispatched since latency stats on 'h' were last cleared.  Returns the
+ * number of calls.  See flux_reactor_latency_foreach().
+ */
+int flux_msg_handler_latency_foreach (flux_t *h,
+                                      flux_latency_f cb,
+                                      void *arg);
+void flux_msg_handler_latency_clear (flux_t *h);
+
+/* A traced request handled on 'h', from dispatch to its first response.
+ * IDs are those carried in the message (see flux_msg_get_trace()).
+ * 'start' is wall clock time, 'duration' is in seconds.
+ */
+struct flux_trace_span {
+    uint64_t trace_id;
+    uint64_t span_id;
+    uint64_t parent_id;
+    const char *topic;
+    double start;
+    double duration;
+};
+
+typedef void (*flux_trace_span_f)(const struct flux_trace_span *span,
+                                  void *arg);
+
+/* Call 'cb' for each of the most recent traced requests handled on 'h'
+ * since spans were last cleared, oldest first.  Returns the number of calls.
+ */
+int flux_msg_handler_trace_foreach (flux_t *h,
+                                    flux_trace_span_f cb,
+                                    void *arg);
+void flux_msg_handler_trace_clear (flux_t *h);
+
 /* Requeue any unmatched messages, if handle was cloned.
  */
 int flux_dispatch_requeue (flux_t *h);
@@ -0,0 +1,294 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* msg_pool.c - per-thread freelists for message allocations
+ *
+ * Every request, response, and event crosses msg_create() and
+ * flux_msg_destroy(), which otherwise costs several malloc/free pairs
+ * per message (struct flux_msg, topic, payload, one per route).
+ * Keep recently freed objects on per-thread, size-classed freelists so
+ * the common case never enters the allocator.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "message.h"
+#include "message_private.h"
+#include "msg_pool.h"
+
+#define MSG_POOL_MIN_SHIFT  5       /* smallest class is 32 bytes */
+#define MSG_POOL_NCLASS     8       /* 32, 64, ... 4096 */
+#define MSG_POOL_MSG_MAX    1024    /* max cached struct flux_msg */
+#define MSG_POOL_CLASS_MAX  65536   /* max cached bytes per buffer class */
+#define MSG_POOL_CLASS_MIN  16      /* min cached buffers per class */
+
+/* Prepended to every buffer.  The union maintains malloc(3) alignment
+ * for the caller's portion.
+ */
+union bufhdr {
+    struct {
+        size_t capacity;
+        int class;                  /* -1 if not pooled */
+    } info;
+    long double align_ld;
+    void *align_p;
+};
+
+struct freenode {
+    struct freenode *next;
+};
+
+struct msg_pool {
+    struct freenode *msgs;
+    int msgs_count;
+    struct freenode *bufs[MSG_POOL_NCLASS];
+    int bufs_count[MSG_POOL_NCLASS];
+    struct flux_msg_pool_stats stats;
+};
+
+static __thread struct msg_pool *tls_pool;
+static __thread bool tls_pool_exited;
+
+static pthread_key_t pool_key;
+static pthread_once_t pool_key_once = PTHREAD_ONCE_INIT;
+static bool pool_disabled;
+
+static void pool_destroy (struct msg_pool *pool)
+{
+    if (pool) {
+        struct freenode *n;
+        int i;
+
+        while ((n = pool->msgs)) {
+            pool->msgs = n->next;
+            free (n);
+        }
+        for (i = 0; i < MSG_POOL_NCLASS; i++) {
+            while ((n = pool->bufs[i])) {
+                pool->bufs[i] = n->next;
+                free ((union bufhdr *)n - 1);
+            }
+        }
+        free (pool);
+    }
+}
+
+/* Called on pthread_exit() for threads that used the pool.
+ */
+static void pool_key_destructor (void *arg)
+{
+    tls_pool = NULL;
+    tls_pool_exited = true;
+    pool_destroy (arg);
+}
+
+static void pool_key_init (void)
+{
+    if (getenv ("FLUX_MSG_POOL_DISABLE"))
+        pool_disabled = true;
+    (void)pthread_key_create (&pool_key, pool_key_destructor);
+}
+
+/* The main thread never runs key destructors, so drain its pool at exit
+ * to keep leak checkers quiet.  Frees after this point bypass the pool.
+ */
+static void __attribute__ ((destructor)) pool_atexit (void)
+{
+    struct msg_pool *pool = tls_pool;
+
+    tls_pool = NULL;
+    tls_pool_exited = true;
+    pool_destroy (pool);
+}
+
+static struct msg_pool *pool_get (void)
+{
+    struct msg_pool *pool;
+
+    if (tls_pool)
+        return tls_pool;
+    if (tls_pool_exited)
+        return NULL;
+    pthread_once (&pool_key_once, pool_key_init);
+    if (pool_disabled)
+        return NULL;
+    if (!(pool = calloc (1, sizeof (*pool))))
+        return NULL;
+    if (pthread_setspecific (pool_key, pool) != 0) {
+        free (pool);
+        return NULL;
+    }
+    tls_pool = pool;
+    return pool;
+}
+
+flux_msg_t *msg_pool_msg_alloc (void)
+{
+    struct msg_pool *pool = pool_get ();
+    flux_msg_t *msg;
+
+    if (pool && pool->msgs) {
+        struct freenode *n = pool->msgs;
+        pool->msgs = n->next;
+        pool->msgs_count--;
+        pool->stats.msg_hit++;
+        msg = (flux_msg_t *)n;
+        memset (msg, 0, sizeof (*msg));
+        return msg;
+    }
+    if (pool)
+        pool->stats.msg_miss++;
+    if (!(msg = calloc (1, sizeof (*msg))))
+        errno = ENOMEM;
+    return msg;
+}
+
+void msg_pool_msg_free (flux_msg_t *msg)
+{
+    if (msg) {
+        struct msg_pool *pool = pool_get ();
+
+        if (pool && pool->msgs_count < MSG_POOL_MSG_MAX) {
+            struct freenode *n = (struct freenode *)msg;
+            n->next = pool->msgs;
+            pool->msgs = n;
+            pool->msgs_count++;
+        }
+        else
+            free (msg);
+    }
+}
+
+/* Return the smallest class that can hold 'size' bytes, or -1 if
+ * 'size' exceeds MSG_POOL_BUF_MAX.
+ */
+static int size_to_class (size_t size)
+{
+    int class = 0;
+
+    if (size > MSG_POOL_BUF_MAX)
+        return -1;
+    while (((size_t)1 << (class + MSG_POOL_MIN_SHIFT)) < size)
+        class++;
+    return class;
+}
+
+static inline size_t class_to_size (int class)
+{
+    return (size_t)1 << (class + MSG_POOL_MIN_SHIFT);
+}
+
+static inline int class_limit (int class)
+{
+    int limit = MSG_POOL_CLASS_MAX / class_to_size (class);
+    return limit > MSG_POOL_CLASS_MIN ? limit : MSG_POOL_CLASS_MIN;
+}
+
+void *msg_pool_buf_alloc (size_t size)
+{
+    struct msg_pool *pool = pool_get ();
+    union bufhdr *hdr;
+    int class = size_to_class (size);
+    size_t capacity = class < 0 ? size : class_to_size (class);
+
+    if (pool && class >= 0 && pool->bufs[class]) {
+        struct freenode *n = pool->bufs[class];
+        pool->bufs[class] = n->next;
+        pool->bufs_count[class]--;
+        pool->stats.buf_hit++;
+        return n;
+    }
+    if (pool)
+        pool->stats.buf_miss++;
+    if (!(hdr = malloc (sizeof (*hdr) + capacity))) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    hdr->info.capacity = capacity;
+    hdr->info.class = class;
+    return hdr + 1;
+}
+
+void msg_pool_buf_free (void *buf)
+{
+    if (buf) {
+        union bufhdr *hdr = (union bufhdr *)buf - 1;
+        int class = hdr->info.class;
+        struct msg_pool *pool;
+
+        if (class >= 0
+            && (pool = pool_get ())
+            && pool->bufs_count[class] < class_limit (class)) {
+            struct freenode *n = buf;
+            n->next = pool->bufs[class];
+            pool->bufs[class] = n;
+            pool->bufs_count[class]++;
+        }
+        else
+            free (hdr);
+    }
+}
+
+void *msg_pool_buf_realloc (void *buf, size_t size)
+{
+    union bufhdr *hdr;
+    void *new;
+
+    if (!buf)
+        return msg_pool_buf_alloc (size);
+    hdr = (union bufhdr *)buf - 1;
+    if (size <= hdr->info.capacity)
+        return buf;
+    if (!(new = msg_pool_buf_alloc (size)))
+        return NULL;
+    memcpy (new, buf, hdr->info.capacity);
+    msg_pool_buf_free (buf);
+    return new;
+}
+
+char *msg_pool_strndup (const char *s, size_t n)
+{
+    size_t len = strnlen (s, n);
+    char *cpy;
+
+    if (!(cpy = msg_pool_buf_alloc (len + 1)))
+        return NULL;
+    memcpy (cpy, s, len);
+    cpy[len] = '\0';
+    return cpy;
+}
+
+char *msg_pool_strdup (const char *s)
+{
+    return msg_pool_strndup (s, strlen (s));
+}
+
+void flux_msg_pool_get_stats (struct flux_msg_pool_stats *stats)
+{
+    struct msg_pool *pool;
+
+    if (stats) {
+        if ((pool = pool_get ()))
+            *stats = pool->stats;
+        else
+            memset (stats, 0, sizeof (*stats));
+    }
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
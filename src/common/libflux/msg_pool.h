@@ -0,0 +1,51 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _FLUX_CORE_MSG_POOL_H
+#define _FLUX_CORE_MSG_POOL_H
+
+#include <stddef.h>
+
+#include "message.h"
+
+/* Per-thread cache of message structures and small buffers.
+ *
+ * Freed objects are pushed onto freelists owned by the thread that frees
+ * them, so an object allocated in one thread and destroyed in another
+ * (e.g. sent over an interthread connector) simply migrates.  Freelists
+ * are bounded and are released when the thread exits.
+ *
+ * Buffers are size-classed in powers of two up to MSG_POOL_BUF_MAX bytes.
+ * Larger buffers fall through to malloc(3), but must still be freed with
+ * msg_pool_buf_free() since every buffer carries a small header.
+ *
+ * Set FLUX_MSG_POOL_DISABLE in the environment to bypass caching, e.g.
+ * when looking for use-after-free errors with valgrind or ASAN.
+ */
+
+#define MSG_POOL_BUF_MAX    4096
+
+/* Returns a zeroed struct flux_msg, or NULL with errno set.
+ */
+flux_msg_t *msg_pool_msg_alloc (void);
+void msg_pool_msg_free (flux_msg_t *msg);
+
+void *msg_pool_buf_alloc (size_t size);
+void *msg_pool_buf_realloc (void *buf, size_t size);
+void msg_pool_buf_free (void *buf);
+
+char *msg_pool_strdup (const char *s);
+char *msg_pool_strndup (const char *s, size_t n);
+
+#endif /* !_FLUX_CORE_MSG_POOL_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
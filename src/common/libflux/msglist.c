@@ -20,12 +20,20 @@
 
 #include "message.h"
 #include "msglist.h"
+#include "msglist_private.h"
 
+/* 'senders' maps the first route id of each message ("" if none) to a
+ * list of the message's handles in 'zl', so that disconnect and cancel
+ * visit only one sender's messages.  It is built on first use, so lists
+ * that never see a disconnect or cancel don't pay for it.
+ */
 struct flux_msglist {
     zlistx_t *zl;
     int pollevents;
     int pollfd;
     uint64_t event;
+    zhashx_t *senders;
+    zlistx_t *sender_cur;
 };
 
 static void *msg_duplicator (const void *item)
@@ -41,6 +49,81 @@ static void msg_destructor (void **item)
     }
 }
 
+static void handles_destructor (void **item)
+{
+    if (item) {
+        zlistx_destroy ((zlistx_t **)item);
+        *item = NULL;
+    }
+}
+
+static const char *msg_sender (const flux_msg_t *msg)
+{
+    const char *sender = flux_msg_route_first (msg);
+    return sender ? sender : "";
+}
+
+static int sender_add (struct flux_msglist *l, void *handle)
+{
+    const char *sender = msg_sender (zlistx_handle_item (handle));
+    zlistx_t *handles;
+
+    if (!(handles = zhashx_lookup (l->senders, sender))) {
+        if (!(handles = zlistx_new ()))
+            goto nomem;
+        (void)zhashx_insert (l->senders, sender, handles);
+    }
+    if (!zlistx_add_end (handles, handle))
+        goto nomem;
+    return 0;
+nomem:
+    errno = ENOMEM;
+    return -1;
+}
+
+static void sender_remove (struct flux_msglist *l, void *handle)
+{
+    const char *sender = msg_sender (zlistx_handle_item (handle));
+    zlistx_t *handles;
+    void *h;
+
+    if (!(handles = zhashx_lookup (l->senders, sender)))
+        return;
+    if ((h = zlistx_find (handles, handle)))
+        zlistx_delete (handles, h);
+    if (zlistx_size (handles) == 0) {
+        if (l->sender_cur == handles)
+            l->sender_cur = NULL;
+        zhashx_delete (l->senders, sender);
+    }
+}
+
+static void senders_destroy (struct flux_msglist *l)
+{
+    zhashx_destroy (&l->senders);
+    l->sender_cur = NULL;
+}
+
+static int senders_create (struct flux_msglist *l)
+{
+    void *handle;
+
+    if (!(l->senders = zhashx_new ())) {
+        errno = ENOMEM;
+        return -1;
+    }
+    zhashx_set_destructor (l->senders, handles_destructor);
+    handle = zlistx_first (l->zl) ? zlistx_cursor (l->zl) : NULL;
+    while (handle) {
+        if (sender_add (l, handle) < 0) {
+            senders_destroy (l);
+            return -1;
+        }
+        handle = zlistx_next (l->zl) ? zlistx_cursor (l->zl) : NULL;
+    }
+    return 0;
+}
+
 struct flux_msglist *flux_msglist_create (void)
 {
     struct flux_msglist *l;
@@ -63,6 +146,7 @@ void flux_msglist_destroy (struct flux_msglist *l)
 {
     if (l) {
         int saved_errno = errno;
+        senders_destroy (l);
         zlistx_destroy (&l->zl);
         if (l->pollfd >= 0)
             close (l->pollfd);
@@ -96,33 +180,41 @@ static int msglist_clear_event (struct flux_msglist *l)
 
 int flux_msglist_append (struct flux_msglist *l, const flux_msg_t *msg)
 {
+    void *handle;
+
     if (!(l->pollevents & POLLIN)) {
         l->pollevents |= POLLIN;
         if (msglist_raise_event (l) < 0)
             return -1;
     }
-    if (!zlistx_add_end (l->zl, (flux_msg_t *)msg)) {
+    if (!(handle = zlistx_add_end (l->zl, (flux_msg_t *)msg))) {
         l->pollevents |= POLLERR;
         msglist_raise_event (l);
         errno = ENOMEM;
         return -1;
     }
+    if (l->senders && sender_add (l, handle) < 0)
+        senders_destroy (l);
     return 0;
 }
 
 int flux_msglist_push (struct flux_msglist *l, const flux_msg_t *msg)
 {
+    void *handle;
+
     if (!(l->pollevents & POLLIN)) {
         l->pollevents |= POLLIN;
         if (msglist_raise_event (l) < 0)
             return -1;
     }
-    if (!zlistx_add_start (l->zl, (flux_msg_t *)msg)) {
+    if (!(handle = zlistx_add_start (l->zl, (flux_msg_t *)msg))) {
         l->pollevents |= POLLERR;
         msglist_raise_event (l);
         errno = ENOMEM;
         return -1;
     }
+    if (l->senders && sender_add (l, handle) < 0)
+        senders_destroy (l);
     return 0;
 }
 
@@ -145,6 +237,8 @@ void flux_msglist_delete (struct flux_msglist *l)
 {
     void *handle = zlistx_cursor (l->zl);
     if (handle) {
+        if (l->senders)
+            sender_remove (l, handle);
         zlistx_delete (l->zl, handle);
         if ((l->pollevents & POLLIN) && zlistx_size (l->zl) == 0)
             l->pollevents &= ~POLLIN;
@@ -153,14 +247,65 @@ void flux_msglist_delete (struct flux_msglist *l)
 
 const flux_msg_t *flux_msglist_pop (struct flux_msglist *l)
 {
-    void *item = zlistx_detach_cur (l->zl);
-    if (item) {
+    void *handle = zlistx_cursor (l->zl);
+    void *item;
+
+    /* With no cursor, the first message is popped.
+     */
+    if (!handle && zlistx_first (l->zl))
+        handle = zlistx_cursor (l->zl);
+    if (handle && l->senders)
+        sender_remove (l, handle);
+    if ((item = zlistx_detach_cur (l->zl))) {
         if ((l->pollevents & POLLIN) && zlistx_size (l->zl) == 0)
             l->pollevents &= ~POLLIN;
     }
     return item;
 }
 
+const flux_msg_t *msglist_sender_first (struct flux_msglist *l,
+                                        const flux_msg_t *msg)
+{
+    void *handle;
+
+    if (!l->senders && senders_create (l) < 0)
+        return NULL;
+    if (!(l->sender_cur = zhashx_lookup (l->senders, msg_sender (msg))))
+        return NULL;
+    if (!(handle = zlistx_first (l->sender_cur)))
+        return NULL;
+    return zlistx_handle_item (handle);
+}
+
+const flux_msg_t *msglist_sender_next (struct flux_msglist *l)
+{
+    void *handle;
+
+    if (!l->sender_cur || !(handle = zlistx_next (l->sender_cur)))
+        return NULL;
+    return zlistx_handle_item (handle);
+}
+
+void msglist_sender_delete (struct flux_msglist *l)
+{
+    zlistx_t *handles = l->sender_cur;
+    void *h;
+
+    if (handles && (h = zlistx_cursor (handles))) {
+        void *handle = zlistx_handle_item (h);
+        const char *sender = msg_sender (zlistx_handle_item (handle));
+
+        zlistx_delete (handles, h);
+        if (zlistx_size (handles) == 0) {
+            l->sender_cur = NULL;
+            zhashx_delete (l->senders, sender);
+        }
+        zlistx_delete (l->zl, handle);
+        if ((l->pollevents & POLLIN) && zlistx_size (l->zl) == 0)
+            l->pollevents &= ~POLLIN;
+    }
+}
+
 int flux_msglist_count (struct flux_msglist *l)
 {
     return l ? zlistx_size (l->zl) : 0;
@@ -0,0 +1,32 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _FLUX_CORE_MSGLIST_PRIVATE_H
+#define _FLUX_CORE_MSGLIST_PRIVATE_H
+
+#include "message.h"
+#include "msglist.h"
+
+/* Iterate over the messages in 'l' with the same sender (first route id)
+ * as 'msg', in list order.  The cost is proportional to the number of
+ * such messages, not the length of the list.  msglist_sender_delete()
+ * deletes the current message; iteration may continue afterwards.
+ * The list must not otherwise be modified during iteration.
+ */
+const flux_msg_t *msglist_sender_first (struct flux_msglist *l,
+                                        const flux_msg_t *msg);
+const flux_msg_t *msglist_sender_next (struct flux_msglist *l);
+void msglist_sender_delete (struct flux_msglist *l);
+
+#endif /* !_FLUX_CORE_MSGLIST_PRIVATE_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
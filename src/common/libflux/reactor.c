@@ -26,6 +26,7 @@
 #include "src/common/libutil/fdutils.h"
 
 #include "reactor_private.h"
+#include "latency.h"
 
 static int valid_flags (int flags, int valid)
 {
@@ -46,6 +47,7 @@ static void reactor_usecount_decr (flux_reactor_t *r)
             else
                 ev_loop_destroy (r->loop);
         }
+        latency_destroy (r->latency);
         free (r);
         errno = saved_errno;
     }
@@ -61,18 +63,34 @@ void flux_reactor_destroy (flux_reactor_t *r)
     reactor_usecount_decr (r);
 }
 
+/* libev never selects io_uring on its own, so when requested, list it
+ * ahead of the recommended backends.  libev tries io_uring first and falls
+ * back (e.g. to epoll) if the kernel doesn't support it.
+ */
+static unsigned int backend_flags (int flags)
+{
+    unsigned int ev_flags = 0;
+
+    if ((flags & FLUX_REACTOR_IOURING)
+        && (ev_supported_backends () & EVBACKEND_IOURING))
+        ev_flags = EVBACKEND_IOURING | ev_recommended_backends ();
+    return ev_flags;
+}
+
 flux_reactor_t *flux_reactor_create (int flags)
 {
     flux_reactor_t *r;
+    unsigned int ev_flags;
 
-    if (valid_flags (flags, FLUX_REACTOR_SIGCHLD) < 0)
+    if (valid_flags (flags, FLUX_REACTOR_SIGCHLD | FLUX_REACTOR_IOURING) < 0)
         return NULL;
     if (!(r = calloc (1, sizeof (*r))))
         return NULL;
+    ev_flags = backend_flags (flags);
     if ((flags & FLUX_REACTOR_SIGCHLD))
-        r->loop = ev_default_loop (EVFLAG_SIGNALFD);
+        r->loop = ev_default_loop (ev_flags | EVFLAG_SIGNALFD);
     else
-        r->loop = ev_loop_new (EVFLAG_NOSIGMASK);
+        r->loop = ev_loop_new (ev_flags | EVFLAG_NOSIGMASK);
     if (!r->loop) {
         errno = ENOMEM;
         flux_reactor_destroy (r);
@@ -80,6 +98,10 @@ flux_reactor_t *flux_reactor_create (int flags)
     }
     ev_set_userdata (r->loop, r);
     r->usecount = 1;
+    if (latency_enabled (NULL) && !(r->latency = latency_create ())) {
+        flux_reactor_destroy (r);
+        return NULL;
+    }
     return r;
 }
 
@@ -199,6 +221,49 @@ struct flux_watcher_ops * flux_watcher_get_ops (flux_watcher_t *w)
     return NULL;
 }
 
+/* Run the watcher callback, recording its duration if latency
+ * instrumentation is enabled.  The callback may destroy the watcher or
+ * drop the last reactor reference, so hold a reference across the call.
+ */
+static void watcher_call (struct ev_loop *loop,
+                          flux_watcher_t *w,
+                          int revents,
+                          const char *type)
+{
+    flux_reactor_t *r = ev_userdata (loop);
+
+    if (!w->fn)
+        return;
+    if (r->latency) {
+        struct latency_hist *hist = latency_hist_get (r->latency, type, 0);
+        double t0 = latency_now ();
+
+        reactor_usecount_incr (r);
+        w->fn (r, w, libev_to_events (revents), w->arg);
+        latency_hist_record (hist, latency_now () - t0);
+        reactor_usecount_decr (r);
+    }
+    else
+        w->fn (r, w, libev_to_events (revents), w->arg);
+}
+
+int flux_reactor_latency_foreach (flux_reactor_t *r,
+                                  flux_latency_f cb,
+                                  void *arg)
+{
+    if (!r) {
+        errno = EINVAL;
+        return -1;
+    }
+    return latency_foreach (r->latency, cb, arg);
+}
+
+void flux_reactor_latency_clear (flux_reactor_t *r)
+{
+    if (r)
+        latency_clear (r->latency);
+}
+
 void flux_watcher_start (flux_watcher_t *w)
 {
     if (w) {
@@ -269,8 +334,7 @@ static void handle_stop (flux_watcher_t *w)
 static void handle_cb (struct ev_loop *loop, struct ev_flux *fw, int revents)
 {
     struct flux_watcher *w = fw->data;
-    if (w->fn)
-        w->fn (ev_userdata (loop), w, libev_to_events (revents), w->arg);
+    watcher_call (loop, w, revents, "handle");
 }
 
 static struct flux_watcher_ops handle_watcher = {
@@ -317,8 +381,7 @@ static void fd_stop (flux_watcher_t *w)
 static void fd_cb (struct ev_loop *loop, ev_io *iow, int revents)
 {
     struct flux_watcher *w = iow->data;
-    if (w->fn)
-        w->fn (ev_userdata (loop), w, libev_to_events (revents), w->arg);
+    watcher_call (loop, w, revents, "fd");
 }
 
 static struct flux_watcher_ops fd_watcher = {
@@ -365,8 +428,7 @@ static void timer_stop (flux_watcher_t *w)
 static void timer_cb (struct ev_loop *loop, ev_timer *tw, int revents)
 {
     struct flux_watcher *w = tw->data;
-    if (w->fn)
-        w->fn (ev_userdata (loop), w, libev_to_events (revents), w->arg);
+    watcher_call (loop, w, revents, "timer");
 }
 
 static struct flux_watcher_ops timer_watcher = {
@@ -433,8 +495,7 @@ static void periodic_cb (struct ev_loop *loop, ev_periodic *pw, int revents)
 {
     struct f_periodic *fp = pw->data;
     struct flux_watcher *w = fp->w;
-    if (w->fn)
-        fp->w->fn (ev_userdata (loop), w, libev_to_events (revents), w->arg);
+    watcher_call (loop, w, revents, "periodic");
 }
 
 static ev_tstamp periodic_reschedule_cb (ev_periodic *pw, ev_tstamp now)
@@ -530,8 +591,7 @@ static void prepare_stop (flux_watcher_t *w)
 static void prepare_cb (struct ev_loop *loop, ev_prepare *pw, int revents)
 {
     struct flux_watcher *w = pw->data;
-    if (w->fn)
-        w->fn (ev_userdata (loop), w, libev_to_events (revents), w->arg);
+    watcher_call (loop, w, revents, "prepare");
 }
 
 static struct flux_watcher_ops prepare_watcher = {
@@ -571,8 +631,7 @@ static void check_stop (flux_watcher_t *w)
 static void check_cb (struct ev_loop *loop, ev_check *cw, int revents)
 {
     struct flux_watcher *w = cw->data;
-    if (w->fn)
-        w->fn (ev_userdata (loop), w, libev_to_events (revents), w->arg);
+    watcher_call (loop, w, revents, "check");
 }
 
 static struct flux_watcher_ops check_watcher = {
@@ -612,8 +671,7 @@ static void idle_stop (flux_watcher_t *w)
 static void idle_cb (struct ev_loop *loop, ev_idle *iw, int revents)
 {
     struct flux_watcher *w = iw->data;
-    if (w->fn)
-        w->fn (ev_userdata (loop), w, libev_to_events (revents), w->arg);
+    watcher_call (loop, w, revents, "idle");
 }
 
 static struct flux_watcher_ops idle_watcher = {
@@ -653,8 +711,7 @@ static void child_stop (flux_watcher_t *w)
 static void child_cb (struct ev_loop *loop, ev_child *cw, int revents)
 {
     struct flux_watcher *w = cw->data;
-    if (w->fn)
-        w->fn (ev_userdata (loop), w, libev_to_events (revents), w->arg);
+    watcher_call (loop, w, revents, "child");
 }
 
 static struct flux_watcher_ops child_watcher = {
@@ -720,8 +777,7 @@ static void signal_stop (flux_watcher_t *w)
 static void signal_cb (struct ev_loop *loop, ev_signal *sw, int revents)
 {
     struct flux_watcher *w = sw->data;
-    if (w->fn)
-        w->fn (ev_userdata (loop), w, libev_to_events (revents), w->arg);
+    watcher_call (loop, w, revents, "signal");
 }
 
 static struct flux_watcher_ops signal_watcher = {
@@ -771,8 +827,7 @@ static void stat_stop (flux_watcher_t *w)
 static void stat_cb (struct ev_loop *loop, ev_stat *sw, int revents)
 {
     struct flux_watcher *w = sw->data;
-    if (w->fn)
-        w->fn (ev_userdata (loop), w, libev_to_events (revents), w->arg);
+    watcher_call (loop, w, revents, "stat");
 }
 
 static struct flux_watcher_ops stat_watcher = {
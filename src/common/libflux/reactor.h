@@ -14,6 +14,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "handle.h"
 
@@ -39,6 +40,7 @@ enum {
 enum {
     FLUX_REACTOR_SIGCHLD = 1,  /* enable use of child watchers */
                                /*    only one thread can do this per program */
+    FLUX_REACTOR_IOURING = 2,  /* prefer io_uring backend if available */
 };
 
 flux_reactor_t *flux_reactor_create (int flags);
@@ -63,6 +65,32 @@ double flux_reactor_time (void);
 void flux_reactor_active_incref (flux_reactor_t *r);
 void flux_reactor_active_decref (flux_reactor_t *r);
 
+/* Callback latency statistics, collected only when FLUX_CALLBACK_LATENCY
+ * is set in the environment.  Durations are in seconds.  Quantiles are
+ * estimated from a histogram and are accurate to within 25%.
+ */
+struct flux_latency_stats {
+    const char *name;   // watcher type, or message handler topic
+    int msgtype;        // FLUX_MSGTYPE_* for message handlers, else 0
+    uint64_t count;
+    double mean;
+    double max;
+    double p50;
+    double p90;
+    double p99;
+};
+
+typedef void (*flux_latency_f)(const struct flux_latency_stats *stats,
+                               void *arg);
+
+/* Call 'cb' for each watcher type that has run a callback since the
+ * reactor was created or last cleared.  Returns the number of calls.
+ */
+int flux_reactor_latency_foreach (flux_reactor_t *r,
+                                  flux_latency_f cb,
+                                  void *arg);
+void flux_reactor_latency_clear (flux_reactor_t *r);
+
 
 /* Watchers
  */
@@ -22,6 +22,7 @@ struct flux_reactor {
     struct ev_loop *loop;
     int usecount;
     unsigned int errflag:1;
+    struct latency *latency;    // NULL unless FLUX_CALLBACK_LATENCY is set
 };
 
 struct flux_watcher {
@@ -13,8 +13,17 @@
 #endif
 #include <errno.h>
 #include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <arpa/inet.h>
 #include <flux/core.h>
 
+#include "src/common/libutil/errno_safe.h"
+
+#include "response_private.h"
+#include "trace.h"
+
 static int response_decode (const flux_msg_t *msg, const char **topic)
 {
     int type;
@@ -245,6 +254,7 @@ int flux_respond (flux_t *h, const flux_msg_t *request, const char *s)
         flux_msg_destroy (msg);
         return -1;
     }
+    trace_request_respond (h, request);
     return 0;
 }
 
@@ -261,12 +271,17 @@ static int flux_respond_vpack (flux_t *h,
     }
     if (flux_msg_is_noresponse (request))
         return 0;
+    /* Answer a CBOR request in kind, since the requester understands it.
+     */
     if (!(msg = flux_response_derive (request, 0))
-        || flux_msg_vpack (msg, fmt, ap) < 0
+        || (flux_msg_is_cbor (request)
+            ? flux_msg_vpack_cbor (msg, fmt, ap)
+            : flux_msg_vpack (msg, fmt, ap)) < 0
         || flux_send_new (h, &msg, 0) < 0) {
         flux_msg_destroy (msg);
         return -1;
     }
+    trace_request_respond (h, request);
     return 0;
 }
 
@@ -307,9 +322,111 @@ int flux_respond_raw (flux_t *h,
         flux_msg_destroy (msg);
         return -1;
     }
+    trace_request_respond (h, request);
+    return 0;
+}
+
+int flux_respond_batch (flux_t *h,
+                        const flux_msg_t *request,
+                        const char **results,
+                        int count)
+{
+    flux_msg_t *msg = NULL;
+    size_t size = RESPONSE_BATCH_MAGIC_SIZE;
+    char *buf = NULL;
+    char *cp;
+    int i;
+
+    if (!h || !request || !results || count < 1 || count > INT32_MAX / 4) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (flux_msg_is_noresponse (request))
+        return 0;
+    if (!flux_msg_is_streaming (request)) {
+        errno = EPROTO;
+        return -1;
+    }
+    for (i = 0; i < count; i++) {
+        size += sizeof (uint32_t);
+        if (results[i])
+            size += strlen (results[i]) + 1;
+    }
+    if (size > INT32_MAX) {
+        errno = EOVERFLOW;
+        return -1;
+    }
+    if (!(buf = malloc (size)))
+        return -1;
+    memcpy (buf, RESPONSE_BATCH_MAGIC, RESPONSE_BATCH_MAGIC_SIZE);
+    cp = buf + RESPONSE_BATCH_MAGIC_SIZE;
+    for (i = 0; i < count; i++) {
+        uint32_t len = results[i] ? strlen (results[i]) + 1 : 0;
+        uint32_t nlen = htonl (len);
+
+        memcpy (cp, &nlen, sizeof (nlen));
+        cp += sizeof (nlen);
+        if (len > 0) {
+            memcpy (cp, results[i], len);
+            cp += len;
+        }
+    }
+    if (!(msg = flux_response_derive (request, 0))
+        || flux_msg_set_payload (msg, buf, size) < 0
+        || flux_send_new (h, &msg, 0) < 0) {
+        ERRNO_SAFE_WRAP (free, buf);
+        flux_msg_destroy (msg);
+        return -1;
+    }
+    free (buf);
+    trace_request_respond (h, request);
     return 0;
 }
 
+bool response_is_batch (const flux_msg_t *msg)
+{
+    const void *buf;
+    int size;
+
+    if (flux_msg_get_payload (msg, &buf, &size) < 0
+        || size < RESPONSE_BATCH_MAGIC_SIZE
+        || memcmp (buf, RESPONSE_BATCH_MAGIC, RESPONSE_BATCH_MAGIC_SIZE) != 0)
+        return false;
+    return true;
+}
+
+int response_batch_next (const flux_msg_t *msg,
+                         size_t *offset,
+                         const void **bufp,
+                         int *sizep)
+{
+    const char *buf;
+    int size;
+    uint32_t nlen;
+    uint32_t len;
+
+    if (flux_msg_get_payload (msg, (const void **)&buf, &size) < 0)
+        return -1;
+    if (*offset == 0)
+        *offset = RESPONSE_BATCH_MAGIC_SIZE;
+    if (*offset == size)
+        return 0;
+    if (size - *offset < sizeof (nlen))
+        goto eproto;
+    memcpy (&nlen, buf + *offset, sizeof (nlen));
+    len = ntohl (nlen);
+    if (size - *offset - sizeof (nlen) < len)
+        goto eproto;
+    *offset += sizeof (nlen);
+    *bufp = len > 0 ? buf + *offset : NULL;
+    *sizep = len;
+    *offset += len;
+    return 1;
+eproto:
+    errno = EPROTO;
+    return -1;
+}
+
 int flux_respond_error (flux_t *h,
                         const flux_msg_t *request,
                         int errnum,
@@ -331,6 +448,7 @@ int flux_respond_error (flux_t *h,
         flux_msg_destroy (msg);
         return -1;
     }
+    trace_request_respond (h, request);
     return 0;
 }
 
@@ -103,6 +103,18 @@ int flux_respond_error (flux_t *h,
                         int errnum,
                         const char *errstr);
 
+/* Respond to a streaming request with 'count' string results in one
+ * message.  The requester's RPC future yields them in order, one per
+ * flux_future_reset(), as though each had been sent with flux_respond().
+ * Elements of 'results' may be NULL (no payload).  Older versions of
+ * libflux-core cannot decode such a response, so a service should only
+ * use it when the request asks for it.
+ */
+int flux_respond_batch (flux_t *h,
+                        const flux_msg_t *request,
+                        const char **results,
+                        int count);
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,43 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _FLUX_CORE_RESPONSE_PRIVATE_H
+#define _FLUX_CORE_RESPONSE_PRIVATE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "message.h"
+
+/* A batch response, sent by flux_respond_batch(), carries several results
+ * in one payload:
+ *   magic[4] then for each result: size[4] (network order), data[size]
+ * The magic cannot begin a JSON or CBOR payload.
+ */
+#define RESPONSE_BATCH_MAGIC        "\xff" "FB1"
+#define RESPONSE_BATCH_MAGIC_SIZE   4
+
+bool response_is_batch (const flux_msg_t *msg);
+
+/* Iterate over results in a batch response.  Set '*offset' to zero
+ * before the first call.  Returns 1 and assigns 'buf' and 'size' if a
+ * result was found, 0 at the end, or -1 with errno = EPROTO if the
+ * batch is malformed.  A result with no payload has size zero.
+ */
+int response_batch_next (const flux_msg_t *msg,
+                         size_t *offset,
+                         const void **buf,
+                         int *size);
+
+#endif /* !_FLUX_CORE_RESPONSE_PRIVATE_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
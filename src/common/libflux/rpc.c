@@ -16,6 +16,7 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdarg.h>
+#include <string.h>
 #if HAVE_CALIPER
 #include <caliper/cali.h>
 #include <sys/syscall.h>
@@ -23,15 +24,18 @@
 #include <jansson.h>
 
 #include "src/common/libutil/errno_safe.h"
+#include "ccan/str/str.h"
 
 #include "request.h"
 #include "response.h"
+#include "response_private.h"
 #include "message.h"
 #include "attr.h"
 #include "rpc.h"
 #include "reactor.h"
 #include "msg_handler.h"
 #include "flog.h"
+#include "trace.h"
 
 struct flux_rpc {
     uint32_t matchtag;
@@ -175,6 +179,30 @@ int flux_rpc_get_unpack (flux_future_t *f, const char *fmt, ...)
     return rc;
 }
 
+/* Split a batch response from flux_respond_batch() into one fulfillment
+ * per result, so a streaming RPC consumer sees them as separate responses.
+ */
+static int fulfill_batch (flux_future_t *f, const flux_msg_t *msg)
+{
+    size_t offset = 0;
+    const void *buf;
+    int size;
+    int rc;
+
+    while ((rc = response_batch_next (msg, &offset, &buf, &size)) > 0) {
+        flux_msg_t *cpy;
+
+        if (!(cpy = flux_msg_copy (msg, false)))
+            return -1;
+        if (size > 0 && flux_msg_set_payload (cpy, buf, size) < 0) {
+            flux_msg_destroy (cpy);
+            return -1;
+        }
+        flux_future_fulfill (f, cpy, (flux_free_f)flux_msg_destroy);
+    }
+    return rc;
+}
+
 /* Message handler for response.
  * Parse the response message here so one could call flux_future_get()
  * instead of flux_rpc_get() to test result of RPC with no response payload.
@@ -199,6 +227,13 @@ static void response_cb (flux_t *h,
 #endif
     if (flux_response_decode (msg, NULL, NULL) < 0)
         goto error;
+    if ((rpc->flags & FLUX_RPC_STREAMING) && response_is_batch (msg)) {
+        if (fulfill_batch (f, msg) < 0) {
+            flux_future_fulfill_error (f, errno, NULL);
+            flux_msg_handler_stop (mh);
+        }
+        return;
+    }
     if (!(cpy = flux_msg_copy (msg, true)))
         goto error;
     flux_future_fulfill (f, cpy, (flux_free_f)flux_msg_destroy);
@@ -249,6 +284,7 @@ static flux_future_t *flux_rpc_message_send_new (flux_t *h,
                                                  int flags)
 {
     struct flux_rpc *rpc = NULL;
+    struct trace_ctx trace;
     flux_future_t *f;
 
     if (!(f = flux_future_create (initialize_cb, NULL)))
@@ -278,6 +314,9 @@ static flux_future_t *flux_rpc_message_send_new (flux_t *h,
     }
     if (flux_msg_set_nodeid (*msg, nodeid) < 0)
         goto error;
+    if (trace_request_prepare (*msg, &trace) < 0)
+        goto error;
+    future_set_trace (f, &trace);
 #if HAVE_CALIPER
     cali_begin_string_byname ("flux.message.rpc", "single");
     cali_begin_int_byname ("flux.message.rpc.nodeid", nodeid);
@@ -380,6 +419,42 @@ flux_future_t *flux_rpc_raw (flux_t *h,
     return f;
 }
 
+/* Return true if the broker advertises support for CBOR payloads in
+ * the broker.payload-encodings attribute.  A client using the local
+ * connector may be linked with a different libflux-core than the broker,
+ * so do not assume.  The answer is cached in the handle.
+ */
+static bool rpc_cbor_supported (flux_t *h)
+{
+    const char *auxkey = "flux::rpc_cbor";
+    int *supported;
+
+    if (!(supported = flux_aux_get (h, auxkey))) {
+        const char *s = flux_attr_get (h, "broker.payload-encodings");
+        char *cpy;
+        char *tok;
+        char *saveptr = NULL;
+
+        if (!(supported = calloc (1, sizeof (*supported))))
+            return false;
+        if (s && (cpy = strdup (s))) {
+            char *str = cpy;
+            while ((tok = strtok_r (str, ",", &saveptr))) {
+                if (streq (tok, "cbor"))
+                    *supported = 1;
+                str = NULL;
+            }
+            free (cpy);
+        }
+        if (flux_aux_set (h, auxkey, supported, free) < 0) {
+            int result = *supported;
+            free (supported);
+            return result;
+        }
+    }
+    return *supported;
+}
+
 flux_future_t *flux_rpc_vpack (flux_t *h,
                                const char *topic,
                                uint32_t nodeid,
@@ -389,14 +464,23 @@ flux_future_t *flux_rpc_vpack (flux_t *h,
 {
     flux_msg_t *msg;
     flux_future_t *f;
+    int rc;
 
-    if (validate_flags (flags, FLUX_RPC_NORESPONSE | FLUX_RPC_STREAMING) < 0
+    if (validate_flags (flags,
+                        FLUX_RPC_NORESPONSE
+                        | FLUX_RPC_STREAMING
+                        | FLUX_RPC_CBOR) < 0
         || !h) {
         errno = EINVAL;
         return NULL;
     }
-    if (!(msg = flux_request_encode (topic, NULL))
-        || flux_msg_vpack (msg, fmt, ap) < 0
+    if (!(msg = flux_request_encode (topic, NULL)))
+        return NULL;
+    if ((flags & FLUX_RPC_CBOR) && rpc_cbor_supported (h))
+        rc = flux_msg_vpack_cbor (msg, fmt, ap);
+    else
+        rc = flux_msg_vpack (msg, fmt, ap);
+    if (rc < 0
         || !(f = flux_rpc_message_send_new (h, &msg, nodeid, flags))) {
         flux_msg_destroy (msg);
         return NULL;
@@ -21,6 +21,7 @@ extern "C" {
 enum {
     FLUX_RPC_NORESPONSE = 1,
     FLUX_RPC_STREAMING = 2,
+    FLUX_RPC_CBOR = 4,          // flux_rpc_pack() only: binary payload
 };
 
 flux_future_t *flux_rpc (flux_t *h,
@@ -53,8 +53,10 @@ void flux_stats_gauge_set (flux_t *h, const char *name, ssize_t value);
 void flux_stats_gauge_inc (flux_t *h, const char *name, ssize_t inc);
 
 
-/* Update (or create) and store 'ms' for 'name' to be sent on the
- * next flush.
+/* Record 'ms' for 'name'.  Timings recorded during an aggregation period
+ * are summarized at the next flush as gauges 'name.count', 'name.p50',
+ * 'name.p95', 'name.p99' and 'name.max' (ms, within 12.5%).  If the
+ * period is 0, 'ms' is sent immediately as a statsd timer.
  */
 void flux_stats_timing (flux_t *h, const char *name, double ms);
 
@@ -15,6 +15,10 @@
 #include "config.h"
 #endif
 
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
 #include <flux/core.h>
 
 struct flux_sync {
@@ -23,6 +27,11 @@ struct flux_sync {
     int count;
     double last;
     double minimum;
+    double jitter;
+    unsigned int seed;
+    flux_watcher_t *timer;
+    flux_reactor_t *timer_r;
+    bool pending;
 };
 
 static const char *auxkey = "flux::sync";
@@ -36,6 +45,7 @@ static void sync_destroy (struct flux_sync *sync)
                                        "heartbeat.pulse",
                                        FLUX_RPC_NORESPONSE);
         flux_future_destroy (f);
+        flux_watcher_destroy (sync->timer);
         free (sync);
         errno = saved_errno;
     }
@@ -50,6 +60,7 @@ static struct flux_sync *sync_create (flux_t *h, double minimum)
         return NULL;
     sync->h = h;
     sync->minimum = minimum;
+    sync->seed = (unsigned int)getpid () ^ (unsigned int)(uintptr_t)sync;
     if (!(f = flux_event_subscribe_ex (sync->h,
                                        "heartbeat.pulse",
                                        FLUX_RPC_NORESPONSE)))
@@ -61,6 +72,47 @@ error:
     return NULL;
 }
 
+static void timer_cb (flux_reactor_t *r,
+                      flux_watcher_t *w,
+                      int revents,
+                      void *arg)
+{
+    flux_future_t *f = arg;
+    struct flux_sync *sync = flux_future_aux_get (f, auxkey);
+
+    sync->pending = false;
+    flux_future_fulfill (f, NULL, NULL);
+}
+
+/* Fulfill 'f' after 'delay' seconds using a timer in the reactor of the
+ * context where the heartbeat was handled.  Returns -1 if that is not
+ * possible, so the caller can fulfill 'f' immediately instead.
+ */
+static int fulfill_later (flux_future_t *f,
+                          struct flux_sync *sync,
+                          flux_reactor_t *r,
+                          double delay)
+{
+    if (sync->timer && sync->timer_r != r) {
+        flux_watcher_destroy (sync->timer);
+        sync->timer = NULL;
+        sync->pending = false;
+    }
+    if (!sync->timer) {
+        if (!(sync->timer = flux_timer_watcher_create (r,
+                                                       0.,
+                                                       0.,
+                                                       timer_cb,
+                                                       f)))
+            return -1;
+        sync->timer_r = r;
+    }
+    flux_timer_watcher_reset (sync->timer, delay, 0.);
+    flux_watcher_start (sync->timer);
+    sync->pending = true;
+    return 0;
+}
+
 /* Special note about the non-reactive case:  events are delivered to all
  * matching message handlers, not first match like requests.  Therefore, the
  * future implementation must requeue events even if they were matched in the
@@ -75,9 +127,11 @@ static void heartbeat_cb (flux_t *h,
                           const flux_msg_t *msg,
                           void *arg)
 {
-    double now = flux_reactor_now (flux_get_reactor (h));
+    flux_reactor_t *r = flux_get_reactor (h);
+    double now = flux_reactor_now (r);
     flux_future_t *f = arg;
     struct flux_sync *sync = flux_future_aux_get (f, auxkey);
+    double interval = 0.;
     uint32_t seq;
 
     if (flux_msg_authorize (msg, FLUX_USERID_UNKNOWN) < 0
@@ -89,10 +143,22 @@ static void heartbeat_cb (flux_t *h,
             return;
         if (sync->minimum > 0. && now - sync->last < sync->minimum)
             return;
+        interval = now - sync->last;
     }
     sync->seq = seq;
     sync->count++;
     sync->last = now;
+    if (sync->jitter > 0. && interval > 0.) {
+        double delay;
+
+        if (sync->pending)
+            return; // fulfillment for a previous heartbeat is pending
+        if (interval > sync->jitter)
+            interval = sync->jitter;
+        delay = interval * rand_r (&sync->seed) / ((double)RAND_MAX + 1);
+        if (fulfill_later (f, sync, r, delay) == 0)
+            return;
+    }
     flux_future_fulfill (f, NULL, NULL);
 }
 
@@ -148,6 +214,18 @@ error:
     return NULL;
 }
 
+int flux_sync_set_jitter (flux_future_t *f, double maximum)
+{
+    struct flux_sync *sync;
+
+    if (!f || maximum < 0. || !(sync = flux_future_aux_get (f, auxkey))) {
+        errno = EINVAL;
+        return -1;
+    }
+    sync->jitter = maximum;
+    return 0;
+}
+
 /*
  * vi:tabstop=4 shiftwidth=4 expandtab
  */
@@ -23,6 +23,12 @@ extern "C" {
  */
 flux_future_t *flux_sync_create (flux_t *h, double minimum);
 
+/* Delay each fulfillment by a random fraction of the time since the
+ * previous one, up to 'maximum' seconds, so that brokers across the
+ * instance do not all act on a heartbeat at the same instant.
+ */
+int flux_sync_set_jitter (flux_future_t *f, double maximum);
+
 #ifdef __cplusplus
 }
 #endif
@@ -12,6 +12,7 @@
 #include "config.h"
 #endif
 #include <stdio.h>
+#include <string.h>
 
 #include "src/common/libflux/reactor.h"
 #include "src/common/libflux/future.h"
@@ -800,6 +801,113 @@ static void test_issue_5923 (flux_reactor_t *r)
         "issue5923: and_then_cb was not called");
 }
 
+static char ready_order[64];
+
+static void ready_cb (flux_future_t *f, void *arg)
+{
+    const char *name;
+
+    while ((name = flux_future_next_ready_child (f)))
+        strcat (ready_order, name);
+    strcat (ready_order, ".");
+    flux_future_reset (f);
+}
+
+/* Fulfill 'f', then let its continuation and that of its parent run.
+ */
+static void fulfill_and_run (flux_reactor_t *r, flux_future_t *f)
+{
+    flux_future_fulfill (f, NULL, NULL);
+    if (flux_reactor_run (r, FLUX_REACTOR_NOWAIT) < 0
+        || flux_reactor_run (r, FLUX_REACTOR_NOWAIT) < 0)
+        BAIL_OUT ("flux_reactor_run failed");
+}
+
+/* Children are returned by flux_future_next_ready_child() in the order
+ * they were fulfilled, and a wait_any composite can be used to process
+ * them as they arrive.
+ */
+static void test_composite_ready_iter (flux_reactor_t *r, bool any)
+{
+    flux_future_t *fc;
+    flux_future_t *f[3];
+    const char *names[] = { "a", "b", "c" };
+    int i;
+
+    fc = any ? flux_future_wait_any_create () : flux_future_wait_all_create ();
+    if (!fc)
+        BAIL_OUT ("error creating composite future");
+    flux_future_set_reactor (fc, r);
+    for (i = 0; i < 3; i++) {
+        if (!(f[i] = flux_future_create (init_no_fulfill, NULL))
+            || flux_future_push (fc, names[i], f[i]) < 0)
+            BAIL_OUT ("error creating child future");
+    }
+    ok (flux_future_next_ready_child (fc) == NULL,
+        "%s: flux_future_next_ready_child returns NULL before fulfillment",
+        any ? "any" : "all");
+    errno = 0;
+    ok (flux_future_next_ready_child (f[0]) == NULL && errno == EINVAL,
+        "%s: flux_future_next_ready_child on non-composite fails with EINVAL",
+        any ? "any" : "all");
+    ready_order[0] = '\0';
+    if (flux_future_then (fc, -1., ready_cb, NULL) < 0)
+        BAIL_OUT ("flux_future_then failed");
+    fulfill_and_run (r, f[2]);
+    fulfill_and_run (r, f[0]);
+    fulfill_and_run (r, f[1]);
+    if (any)
+        is (ready_order, "c.a.b.",
+            "any: children were processed as they were fulfilled");
+    else
+        is (ready_order, "cab.",
+            "all: children were returned in order of fulfillment");
+    flux_future_destroy (fc);
+}
+
+static void noop_cb (flux_future_t *f, void *arg)
+{
+}
+
+/* A wait_all composite with many children is fulfilled once the last
+ * child is fulfilled, no sooner.
+ */
+static void test_composite_all_many (flux_reactor_t *r)
+{
+    flux_future_t *fc;
+    flux_future_t *f;
+    const char *name;
+    int count = 10000;
+    int i;
+
+    if (!(fc = flux_future_wait_all_create ()))
+        BAIL_OUT ("error creating composite future");
+    flux_future_set_reactor (fc, r);
+    for (i = 0; i < count; i++) {
+        if (!(f = flux_future_create (init_no_fulfill, NULL))
+            || flux_future_push (fc, NULL, f) < 0)
+            BAIL_OUT ("error creating child future");
+    }
+    if (flux_future_then (fc, -1., noop_cb, NULL) < 0)
+        BAIL_OUT ("flux_future_then failed");
+    name = flux_future_first_child (fc);
+    for (i = 0; i < count - 1; i++) {
+        flux_future_fulfill (flux_future_get_child (fc, name), NULL, NULL);
+        name = flux_future_next_child (fc);
+    }
+    if (flux_reactor_run (r, FLUX_REACTOR_NOWAIT) < 0)
+        BAIL_OUT ("flux_reactor_run failed");
+    ok (!flux_future_is_ready (fc),
+        "all-many: composite is not ready with one child outstanding");
+    flux_future_fulfill (flux_future_get_child (fc, name), NULL, NULL);
+    if (flux_reactor_run (r, FLUX_REACTOR_NOWAIT) < 0)
+        BAIL_OUT ("flux_reactor_run failed");
+    ok (flux_future_is_ready (fc),
+        "all-many: composite is ready once all %d children are fulfilled",
+        count);
+    flux_future_destroy (fc);
+}
+
 int main (int argc, char *argv[])
 {
     flux_reactor_t *reactor;
@@ -826,6 +934,9 @@ int main (int argc, char *argv[])
 
     test_composite_anon_child (reactor, false);
     test_empty_composite (reactor);
+    test_composite_ready_iter (reactor, false);
+    test_composite_ready_iter (reactor, true);
+    test_composite_all_many (reactor);
 
     test_future_fulfill_next (reactor);
 
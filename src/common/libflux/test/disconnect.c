@@ -225,12 +225,139 @@ void check_cancel (void)
     flux_close (h);
 }
 
+/* Many requests from a few senders, interleaved, with the list modified
+ * through the regular interfaces before and after the sender index is
+ * built by the first disconnect.
+ */
+void check_many_senders (void)
+{
+    flux_t *h;
+    struct flux_msglist *l;
+    const flux_msg_t *item;
+    flux_msg_t *msg;
+    uint32_t matchtag;
+    int errors;
+    int count;
+    int i;
+
+    if (!(h = flux_open ("loop://", 0)))
+        BAIL_OUT ("failed to create loop handle");
+    if (!(l = flux_msglist_create ()))
+        BAIL_OUT ("flux_msglist_create failed");
+    for (i = 0; i < 400; i++) {
+        if (!(msg = create_request (i % 4, 0, 0, i)))
+            BAIL_OUT ("could not create test message");
+        if (flux_msglist_append (l, msg) < 0)
+            BAIL_OUT ("flux_msglist_append failed");
+        flux_msg_decref (msg);
+    }
+
+    /* cancel matchtag 201 from sender 1
+     */
+    if (!(msg = create_cancel (1, FLUX_ROLE_USER, 0, 201)))
+        BAIL_OUT ("could not create cancel message");
+    count = flux_msglist_cancel (h, l, msg);
+    flux_msg_decref (msg);
+    ok (count == 1 && flux_msglist_count (l) == 399,
+        "flux_msglist_cancel removed one of many messages");
+    ok ((msg = flux_recv (h, FLUX_MATCH_ANY, FLUX_O_NONBLOCK)) != NULL
+        && flux_msg_get_matchtag (msg, &matchtag) == 0
+        && matchtag == 201,
+        "flux_msglist_cancel responded to the right message");
+    flux_msg_decref (msg);
+
+    /* cancel matchtag 202 from sender 1 (it was sent by sender 2)
+     */
+    if (!(msg = create_cancel (1, FLUX_ROLE_USER, 0, 202)))
+        BAIL_OUT ("could not create cancel message");
+    count = flux_msglist_cancel (h, l, msg);
+    flux_msg_decref (msg);
+    ok (count == 0 && flux_msglist_count (l) == 399,
+        "flux_msglist_cancel ignores other senders' matchtags");
+
+    /* delete the first message (sender 0) with the regular interface,
+     * and push/append more from sender 2 and a new sender 5
+     */
+    (void)flux_msglist_first (l);
+    flux_msglist_delete (l);
+    if (!(msg = create_request (2, 0, 0, 1000)))
+        BAIL_OUT ("could not create test message");
+    if (flux_msglist_push (l, msg) < 0)
+        BAIL_OUT ("flux_msglist_push failed");
+    flux_msg_decref (msg);
+    if (!(msg = create_request (5, 0, 0, 1001)))
+        BAIL_OUT ("could not create test message");
+    if (flux_msglist_append (l, msg) < 0)
+        BAIL_OUT ("flux_msglist_append failed");
+    flux_msg_decref (msg);
+    ok (flux_msglist_count (l) == 400,
+        "msglist contains 400 messages");
+
+    /* disconnect senders 0 and 2
+     */
+    if (!(msg = create_request (0, FLUX_ROLE_USER, 0, 0)))
+        BAIL_OUT ("could not create disconnect message");
+    count = flux_msglist_disconnect (l, msg);
+    flux_msg_decref (msg);
+    ok (count == 99,
+        "flux_msglist_disconnect removed sender 0 messages");
+    if (!(msg = create_request (2, FLUX_ROLE_USER, 0, 0)))
+        BAIL_OUT ("could not create disconnect message");
+    count = flux_msglist_disconnect (l, msg);
+    flux_msg_decref (msg);
+    ok (count == 101,
+        "flux_msglist_disconnect removed sender 2 messages");
+    ok (flux_msglist_count (l) == 200,
+        "msglist contains 200 messages");
+
+    /* the rest of the list is intact and in order
+     */
+    errors = 0;
+    i = 1;
+    item = flux_msglist_first (l);
+    while (item && i < 400) {
+        if (i == 201)
+            i += 2;
+        if (flux_msg_get_matchtag (item, &matchtag) < 0 || matchtag != i)
+            errors++;
+        item = flux_msglist_next (l);
+        i += 2;
+    }
+    ok (errors == 0
+        && item != NULL
+        && flux_msg_get_matchtag (item, &matchtag) == 0
+        && matchtag == 1001,
+        "remaining messages are in order");
+    ok (flux_msglist_next (l) == NULL,
+        "flux_msglist_next returns NULL at the end of the list");
+
+    /* pop everything, then disconnect sender 1.  No cursor is set,
+     * so each pop takes the first message.
+     */
+    while ((item = flux_msglist_pop (l))) {
+        if (flux_msg_get_matchtag (item, &matchtag) == 0 && matchtag == 1001)
+            break;
+        flux_msg_decref (item);
+    }
+    flux_msg_decref (item);
+    if (!(msg = create_request (1, FLUX_ROLE_USER, 0, 0)))
+        BAIL_OUT ("could not create disconnect message");
+    count = flux_msglist_disconnect (l, msg);
+    flux_msg_decref (msg);
+    ok (count == 0 && flux_msglist_count (l) == 0,
+        "flux_msglist_disconnect after pop finds nothing");
+
+    flux_msglist_destroy (l);
+    flux_close (h);
+}
+
 int main (int argc, char *argv[])
 {
     plan (NO_PLAN);
 
     check_disconnect ();
     check_cancel ();
+    check_many_senders ();
 
     done_testing();
     return (0);
@@ -516,6 +516,124 @@ void test_cloned_dispatch (flux_t *orig)
     diag ("destroyed reactor, closed clone");
 }
 
+#define ORDER_MAX 8
+int order[ORDER_MAX];
+int order_count;
+flux_msg_handler_t *order_victim;
+void order_cb (flux_t *h,
+               flux_msg_handler_t *mh,
+               const flux_msg_t *msg,
+               void *arg)
+{
+    int id = *(int *)arg;
+
+    if (order_count < ORDER_MAX)
+        order[order_count++] = id;
+    /* handler 0 destroys handler 1 while the event is being broadcast */
+    if (id == 0 && order_victim) {
+        flux_msg_handler_destroy (order_victim);
+        order_victim = NULL;
+    }
+}
+
+/* Exercise the topic index with a mix of literal, prefix, and other globs.
+ * Events go to all matching handlers, newest first.  Requests go to the
+ * newest matching handler only.
+ */
+void test_topic_index (flux_t *h)
+{
+    const char *globs[] = { "a.b", "a.*", "x.*", "a.b.*", "a.?", "*" };
+    int ids[] = { 0, 1, 2, 3, 4, 5 };
+    flux_msg_handler_t *mh[6];
+    struct flux_match match = FLUX_MATCH_EVENT;
+    flux_msg_t *msg;
+    int i;
+
+    for (i = 0; i < 6; i++) {
+        match.topic_glob = (char *)globs[i];
+        if (!(mh[i] = flux_msg_handler_create (h, match, order_cb, &ids[i])))
+            BAIL_OUT ("flux_msg_handler_create failed");
+        flux_msg_handler_start (mh[i]);
+    }
+    if (!(msg = flux_event_encode ("a.b", NULL)))
+        BAIL_OUT ("flux_event_encode failed");
+    order_count = 0;
+    ok (flux_send (h, msg, 0) == 0
+        && flux_reactor_run (flux_get_reactor (h), FLUX_REACTOR_NOWAIT) >= 0,
+        "topic index: sent a.b event and ran reactor");
+    ok (order_count == 4
+        && order[0] == 5 && order[1] == 4 && order[2] == 1 && order[3] == 0,
+        "topic index: matching handlers were called, newest first");
+    flux_msg_destroy (msg);
+
+    if (!(msg = flux_event_encode ("a.b.c", NULL)))
+        BAIL_OUT ("flux_event_encode failed");
+    order_count = 0;
+    ok (flux_send (h, msg, 0) == 0
+        && flux_reactor_run (flux_get_reactor (h), FLUX_REACTOR_NOWAIT) >= 0,
+        "topic index: sent a.b.c event and ran reactor");
+    ok (order_count == 3
+        && order[0] == 5 && order[1] == 3 && order[2] == 1,
+        "topic index: a.b.c matched *, a.b.*, and a.*");
+    flux_msg_destroy (msg);
+
+    /* Handler 0 is the oldest, so re-create handler 1 after it to make
+     * it the victim that is destroyed mid-broadcast.
+     */
+    flux_msg_handler_destroy (mh[0]);
+    match.topic_glob = "a.b";
+    if (!(mh[0] = flux_msg_handler_create (h, match, order_cb, &ids[0])))
+        BAIL_OUT ("flux_msg_handler_create failed");
+    flux_msg_handler_start (mh[0]);
+    order_victim = mh[1];
+    mh[1] = NULL;
+    if (!(msg = flux_event_encode ("a.b", NULL)))
+        BAIL_OUT ("flux_event_encode failed");
+    order_count = 0;
+    ok (flux_send (h, msg, 0) == 0
+        && flux_reactor_run (flux_get_reactor (h), FLUX_REACTOR_NOWAIT) >= 0,
+        "topic index: sent a.b event and ran reactor");
+    ok (order_count == 3
+        && order[0] == 0 && order[1] == 5 && order[2] == 4,
+        "topic index: handler destroyed during broadcast was skipped");
+    flux_msg_destroy (msg);
+
+    for (i = 0; i < 6; i++)
+        flux_msg_handler_destroy (mh[i]);
+
+    /* The newest matching request handler wins.
+     */
+    match = FLUX_MATCH_REQUEST;
+    match.topic_glob = "svc.*";
+    if (!(mh[0] = flux_msg_handler_create (h, match, order_cb, &ids[0])))
+        BAIL_OUT ("flux_msg_handler_create failed");
+    match.topic_glob = "svc.f?o";
+    if (!(mh[1] = flux_msg_handler_create (h, match, order_cb, &ids[1])))
+        BAIL_OUT ("flux_msg_handler_create failed");
+    flux_msg_handler_start (mh[0]);
+    flux_msg_handler_start (mh[1]);
+    if (!(msg = flux_request_encode ("svc.foo", NULL)))
+        BAIL_OUT ("flux_request_encode failed");
+    order_count = 0;
+    ok (flux_send (h, msg, 0) == 0
+        && flux_reactor_run (flux_get_reactor (h), FLUX_REACTOR_NOWAIT) >= 0,
+        "topic index: sent svc.foo request and ran reactor");
+    ok (order_count == 1 && order[0] == 1,
+        "topic index: request went to newest matching handler");
+    flux_msg_destroy (msg);
+    if (!(msg = flux_request_encode ("svc.bar", NULL)))
+        BAIL_OUT ("flux_request_encode failed");
+    order_count = 0;
+    ok (flux_send (h, msg, 0) == 0
+        && flux_reactor_run (flux_get_reactor (h), FLUX_REACTOR_NOWAIT) >= 0,
+        "topic index: sent svc.bar request and ran reactor");
+    ok (order_count == 1 && order[0] == 0,
+        "topic index: request went to prefix handler");
+    flux_msg_destroy (msg);
+    flux_msg_handler_destroy (mh[1]);
+    flux_msg_handler_destroy (mh[0]);
+}
+
 int main (int argc, char *argv[])
 {
     flux_t *h;
@@ -535,6 +653,7 @@ int main (int argc, char *argv[])
     test_request_catchall (h);
     test_response_catchall (h);
     test_response_with_routes (h);
+    test_topic_index (h);
 
     flux_close (h);
     done_testing();
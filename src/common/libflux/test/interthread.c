@@ -182,6 +182,63 @@ void test_router (void)
     flux_close (h);
 }
 
+void test_batch (void)
+{
+    const char *uri = "interthread://test1";
+    flux_t *h;
+    flux_t *h2;
+    const flux_msg_t *msgs[100];
+    flux_msg_t *msg;
+    char topic[32];
+    const char *t;
+    flux_msgcounters_t mcs;
+    int errors;
+    int i;
+
+    h = flux_open (uri, 0);
+    ok (h != NULL,
+        "batch: flux_open %s (1) works", uri);
+    h2 = flux_open (uri, 0);
+    ok (h2 != NULL,
+        "batch: flux_open %s (2) works", uri);
+
+    for (i = 0; i < ARRAY_SIZE (msgs); i++) {
+        snprintf (topic, sizeof (topic), "foo.%d", i);
+        if (!(msg = flux_request_encode (topic, NULL)))
+            BAIL_OUT ("batch: could not create request");
+        msgs[i] = msg;
+    }
+    ok (flux_send_batch (h, msgs, ARRAY_SIZE (msgs), 0) == ARRAY_SIZE (msgs),
+        "batch: flux_send_batch sent %d messages", (int)ARRAY_SIZE (msgs));
+    flux_get_msgcounters (h, &mcs);
+    ok (mcs.request_tx == ARRAY_SIZE (msgs),
+        "batch: each sent message was counted once");
+    errors = 0;
+    for (i = 0; i < ARRAY_SIZE (msgs); i++) {
+        snprintf (topic, sizeof (topic), "foo.%d", i);
+        if (!(msg = flux_recv (h2, FLUX_MATCH_ANY, FLUX_O_NONBLOCK))
+            || flux_request_decode (msg, &t, NULL) < 0
+            || !streq (t, topic))
+            errors++;
+        flux_msg_destroy (msg);
+    }
+    ok (errors == 0,
+        "batch: messages were received in order");
+    ok (flux_send_batch (h, msgs, 0, 0) == 0,
+        "batch: flux_send_batch count=0 works");
+    errno = 0;
+    ok (flux_send_batch (NULL, msgs, 1, 0) < 0 && errno == EINVAL,
+        "batch: flux_send_batch h=NULL fails with EINVAL");
+    errno = 0;
+    ok (flux_send_batch (h, NULL, 1, 0) < 0 && errno == EINVAL,
+        "batch: flux_send_batch msgs=NULL fails with EINVAL");
+
+    for (i = 0; i < ARRAY_SIZE (msgs); i++)
+        flux_msg_decref (msgs[i]);
+    flux_close (h2);
+    flux_close (h);
+}
+
 struct test_thread {
     pthread_t t;
     flux_t *h;
@@ -400,6 +457,7 @@ int main (int argc, char *argv[])
 
     test_basic ();
     test_router ();
+    test_batch ();
     test_threads ();
     test_poll ();
 
@@ -0,0 +1,184 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <errno.h>
+#include <stdlib.h>
+#include <flux/core.h>
+
+#include "src/common/libflux/latency.h"
+#include "src/common/libtap/tap.h"
+#include "ccan/str/str.h"
+
+struct lookup {
+    const char *name;
+    int msgtype;
+    struct flux_latency_stats stats;
+    bool found;
+};
+
+static void lookup_cb (const struct flux_latency_stats *stats, void *arg)
+{
+    struct lookup *l = arg;
+
+    if (streq (stats->name, l->name) && stats->msgtype == l->msgtype) {
+        l->stats = *stats;
+        l->found = true;
+    }
+}
+
+static void check_hist (void)
+{
+    struct latency *l;
+    struct latency_hist *hist;
+    struct lookup lk = { .name = "foo", .msgtype = 0 };
+    int i;
+
+    ok ((l = latency_create ()) != NULL,
+        "latency_create works");
+    ok ((hist = latency_hist_get (l, "foo", 0)) != NULL,
+        "latency_hist_get works");
+    ok (latency_hist_get (l, "foo", 0) == hist,
+        "latency_hist_get returns the same histogram for the same key");
+    ok (latency_hist_get (l, "foo", FLUX_MSGTYPE_REQUEST) != hist,
+        "latency_hist_get returns a different histogram for another type");
+    ok (latency_foreach (l, lookup_cb, &lk) == 0,
+        "latency_foreach skips empty histograms");
+
+    /* 90 x 1ms, 9 x 10ms, 1 x 1s */
+    for (i = 0; i < 90; i++)
+        latency_hist_record (hist, 0.001);
+    for (i = 0; i < 9; i++)
+        latency_hist_record (hist, 0.010);
+    latency_hist_record (hist, 1.0);
+
+    ok (latency_foreach (l, lookup_cb, &lk) == 1 && lk.found,
+        "latency_foreach returns one histogram");
+    ok (lk.stats.count == 100,
+        "count is correct");
+    ok (lk.stats.max == 1.0,
+        "max is correct");
+    ok (lk.stats.mean > 0.0117 && lk.stats.mean < 0.0119,
+        "mean is correct");
+    ok (lk.stats.p50 >= 0.001 && lk.stats.p50 <= 0.00125,
+        "p50 is within 25%% of 1ms (%g)", lk.stats.p50);
+    ok (lk.stats.p90 >= 0.001 && lk.stats.p90 <= 0.00125,
+        "p90 is within 25%% of 1ms (%g)", lk.stats.p90);
+    ok (lk.stats.p99 >= 0.010 && lk.stats.p99 <= 0.0125,
+        "p99 is within 25%% of 10ms (%g)", lk.stats.p99);
+
+    latency_clear (l);
+    ok (latency_foreach (l, NULL, NULL) == 0,
+        "latency_clear empties histograms");
+
+    latency_hist_record (hist, 1E6);
+    latency_hist_record (hist, -1);
+    ok (latency_foreach (l, NULL, NULL) == 1,
+        "out of range values are recorded");
+
+    latency_destroy (l);
+    lives_ok ({latency_hist_record (NULL, 1.0);},
+        "latency_hist_record hist=NULL doesn't crash");
+}
+
+static void timer_cb (flux_reactor_t *r,
+                      flux_watcher_t *w,
+                      int revents,
+                      void *arg)
+{
+    flux_watcher_destroy (w);
+}
+
+static void check_reactor (void)
+{
+    flux_reactor_t *r;
+    flux_watcher_t *w;
+    struct lookup lk = { .name = "timer", .msgtype = 0 };
+
+    if (!(r = flux_reactor_create (0)))
+        BAIL_OUT ("flux_reactor_create failed");
+    ok (flux_reactor_latency_foreach (r, NULL, NULL) == 0,
+        "flux_reactor_latency_foreach returns 0 before any callbacks");
+    if (!(w = flux_timer_watcher_create (r, 0.01, 0., timer_cb, NULL)))
+        BAIL_OUT ("flux_timer_watcher_create failed");
+    flux_watcher_start (w);
+    ok (flux_reactor_run (r, 0) == 0,
+        "reactor ran a timer watcher that destroyed itself");
+    ok (flux_reactor_latency_foreach (r, lookup_cb, &lk) == 1
+        && lk.found
+        && lk.stats.count == 1,
+        "timer watcher callback was recorded");
+    flux_reactor_latency_clear (r);
+    ok (flux_reactor_latency_foreach (r, NULL, NULL) == 0,
+        "flux_reactor_latency_clear works");
+    errno = 0;
+    ok (flux_reactor_latency_foreach (NULL, NULL, NULL) < 0
+        && errno == EINVAL,
+        "flux_reactor_latency_foreach r=NULL fails with EINVAL");
+    flux_reactor_destroy (r);
+}
+
+static void event_cb (flux_t *h,
+                      flux_msg_handler_t *mh,
+                      const flux_msg_t *msg,
+                      void *arg)
+{
+}
+
+static void check_dispatch (void)
+{
+    flux_t *h;
+    flux_msg_handler_t *mh;
+    flux_msg_t *msg;
+    struct flux_match match = FLUX_MATCH_EVENT;
+    struct lookup lk = { .name = "a.*", .msgtype = FLUX_MSGTYPE_EVENT };
+
+    if (!(h = flux_open ("loop://", 0)))
+        BAIL_OUT ("could not create loop handle");
+    match.topic_glob = "a.*";
+    if (!(mh = flux_msg_handler_create (h, match, event_cb, NULL)))
+        BAIL_OUT ("flux_msg_handler_create failed");
+    flux_msg_handler_start (mh);
+    if (!(msg = flux_event_encode ("a.b", NULL))
+        || flux_send (h, msg, 0) < 0)
+        BAIL_OUT ("error sending event");
+    flux_msg_destroy (msg);
+    ok (flux_reactor_run (flux_get_reactor (h), FLUX_REACTOR_NOWAIT) >= 0,
+        "reactor dispatched an event");
+    ok (flux_msg_handler_latency_foreach (h, lookup_cb, &lk) == 1
+        && lk.found
+        && lk.stats.count == 1,
+        "handler callback was recorded under its topic glob");
+    flux_msg_handler_latency_clear (h);
+    ok (flux_msg_handler_latency_foreach (h, NULL, NULL) == 0,
+        "flux_msg_handler_latency_clear works");
+    flux_msg_handler_destroy (mh);
+    flux_close (h);
+}
+
+int main (int argc, char *argv[])
+{
+    plan (NO_PLAN);
+
+    setenv ("FLUX_CALLBACK_LATENCY", "0", 1);
+
+    check_hist ();
+    check_reactor ();
+    check_dispatch ();
+
+    done_testing ();
+    return (0);
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -626,6 +626,82 @@ void check_payload_json_formatted (void)
     flux_msg_destroy (msg);
 }
 
+void check_payload_cbor (void)
+{
+    flux_msg_t *msg;
+    flux_msg_t *cpy;
+    const char *s;
+    const char *t;
+    int i;
+    double d;
+    int size;
+
+    if (!(msg = flux_msg_create (FLUX_MSGTYPE_REQUEST)))
+        BAIL_OUT ("flux_msg_create failed");
+    ok (flux_msg_is_cbor (msg) == false,
+        "flux_msg_is_cbor returns false on message with no payload");
+    ok (flux_msg_pack_cbor (msg, "[i,i]", 1, 2) < 0 && errno == EINVAL,
+        "flux_msg_pack_cbor array fails with EINVAL");
+    ok (flux_msg_pack_cbor (msg,
+                            "{s:i s:s s:f s:[b,n]}",
+                            "foo", 42,
+                            "bar", "baz",
+                            "pi", 3.5,
+                            "list", 1) == 0,
+        "flux_msg_pack_cbor works");
+    ok (flux_msg_is_cbor (msg) == true,
+        "flux_msg_is_cbor returns true");
+    ok (flux_msg_get_payload (msg, NULL, &size) == 0 && size > 0,
+        "message has a payload");
+    i = 0;
+    s = NULL;
+    d = 0;
+    ok (flux_msg_unpack (msg,
+                         "{s:i s:s s:f}",
+                         "foo", &i,
+                         "bar", &s,
+                         "pi", &d) == 0,
+        "flux_msg_unpack works on CBOR payload");
+    ok (i == 42 && s != NULL && streq (s, "baz") && d == 3.5,
+        "decoded content matches encoded content");
+    ok (flux_msg_get_string (msg, &s) == 0
+        && s != NULL
+        && streq (s, "{\"foo\":42,\"bar\":\"baz\",\"pi\":3.5,"
+                     "\"list\":[true,null]}"),
+        "flux_msg_get_string transcodes CBOR payload to JSON");
+
+    if (!(cpy = flux_msg_copy (msg, true)))
+        BAIL_OUT ("flux_msg_copy failed");
+    t = NULL;
+    ok (flux_msg_unpack (cpy, "{s:s}", "bar", &t) == 0
+        && t != NULL
+        && streq (t, "baz"),
+        "flux_msg_unpack works on copy of message with CBOR payload");
+    flux_msg_destroy (cpy);
+
+    ok (flux_msg_pack (msg, "{s:i}", "foo", 43) == 0,
+        "flux_msg_pack can replace CBOR payload with JSON");
+    ok (flux_msg_is_cbor (msg) == false,
+        "flux_msg_is_cbor returns false");
+    ok (flux_msg_get_string (msg, &s) == 0
+        && s != NULL
+        && streq (s, "{\"foo\":43}"),
+        "flux_msg_get_string returns new JSON payload");
+
+    ok (flux_msg_set_payload (msg, "\xd9\xd9\xf7\xa1", 4) == 0,
+        "set truncated CBOR payload");
+    errno = 0;
+    ok (flux_msg_unpack (msg, "{}") < 0 && errno == EPROTO,
+        "flux_msg_unpack fails with EPROTO");
+    ok (strlen (flux_msg_last_error (msg)) > 0,
+        "flux_msg_last_error: %s", flux_msg_last_error (msg));
+    errno = 0;
+    ok (flux_msg_get_string (msg, &s) < 0 && errno == EPROTO,
+        "flux_msg_get_string fails with EPROTO");
+
+    flux_msg_destroy (msg);
+}
+
 /* flux_msg_get_payload, flux_msg_set_payload
  *  on message with and without routes, with and without topic string
  */
@@ -1382,6 +1458,257 @@ void check_proto_internal (void)
     }
 }
 
+/* A traced proto frame appends the 8-byte trace and span IDs.
+ */
+void check_proto_trace (void)
+{
+    struct proto p = { .type = FLUX_MSGTYPE_REQUEST,
+                       .userid = 100, .rolemask = FLUX_ROLE_OWNER,
+                       .trace_id = 0x0102030405060708ULL,
+                       .span_id = 0x1112131415161718ULL };
+    struct proto p2;
+    uint8_t buf[PROTO_SIZE_MAX];
+    int len;
+
+    ok (proto_size (&p) == PROTO_SIZE_TRACE,
+        "proto_size is PROTO_SIZE_TRACE for a traced message");
+    errno = 0;
+    ok (proto_encode (&p, buf, PROTO_SIZE) < 0 && errno == EINVAL,
+        "proto_encode fails with EINVAL if buffer has no room for trace");
+    len = proto_encode (&p, buf, sizeof (buf));
+    ok (len == PROTO_SIZE_TRACE,
+        "proto_encode returns traced size");
+    ok (buf[PROTO_SIZE] == 0x01 && buf[PROTO_SIZE + 7] == 0x08
+        && buf[PROTO_SIZE + 8] == 0x11 && buf[PROTO_SIZE + 15] == 0x18,
+        "trace and span IDs are encoded in network order");
+    memset (&p2, 0xff, sizeof (p2));
+    ok (proto_decode (&p2, buf, len) == 0
+        && p2.trace_id == p.trace_id
+        && p2.span_id == p.span_id
+        && p2.userid == p.userid,
+        "proto_decode decodes traced frame");
+    memset (&p2, 0xff, sizeof (p2));
+    ok (proto_decode (&p2, buf, PROTO_SIZE) == 0
+        && p2.trace_id == 0 && p2.span_id == 0,
+        "proto_decode clears trace of untraced frame");
+    memset (buf + PROTO_SIZE, 0, 8);
+    errno = 0;
+    ok (proto_decode (&p2, buf, len) < 0 && errno == EPROTO,
+        "proto_decode fails with EPROTO on zero trace ID");
+    errno = 0;
+    ok (proto_decode (&p2, buf, PROTO_SIZE + 8) < 0 && errno == EPROTO,
+        "proto_decode fails with EPROTO on truncated trace");
+}
+
+void check_trace (void)
+{
+    flux_msg_t *msg;
+    flux_msg_t *msg2;
+    flux_msg_t *cpy;
+    uint64_t trace_id, span_id;
+    void *buf = NULL;
+    ssize_t size;
+
+    if (!(msg = flux_msg_create (FLUX_MSGTYPE_REQUEST))
+        || flux_msg_set_topic (msg, "foo.bar") < 0)
+        BAIL_OUT ("failed to create test message");
+    errno = 0;
+    ok (flux_msg_get_trace (msg, &trace_id, &span_id) < 0 && errno == ENOENT,
+        "flux_msg_get_trace fails with ENOENT on untraced message");
+    ok (flux_msg_set_trace (msg, 42, 43) == 0,
+        "flux_msg_set_trace works");
+    ok (flux_msg_get_trace (msg, &trace_id, &span_id) == 0
+        && trace_id == 42 && span_id == 43,
+        "flux_msg_get_trace returns trace context");
+
+    if (!(cpy = flux_msg_copy (msg, true)))
+        BAIL_OUT ("flux_msg_copy failed");
+    ok (flux_msg_get_trace (cpy, &trace_id, &span_id) == 0
+        && trace_id == 42 && span_id == 43,
+        "trace context is copied");
+    flux_msg_destroy (cpy);
+
+    if ((size = flux_msg_encode_size (msg)) < 0
+        || !(buf = malloc (size))
+        || flux_msg_encode (msg, buf, size) < 0)
+        BAIL_OUT ("flux_msg_encode failed");
+    msg2 = flux_msg_decode (buf, size);
+    ok (msg2 != NULL,
+        "traced message encoded and decoded");
+    ok (flux_msg_get_trace (msg2, &trace_id, &span_id) == 0
+        && trace_id == 42 && span_id == 43,
+        "trace context survives encode/decode");
+    flux_msg_destroy (msg2);
+    free (buf);
+
+    ok (flux_msg_set_trace (msg, 0, 43) == 0
+        && flux_msg_get_trace (msg, NULL, NULL) < 0 && errno == ENOENT,
+        "flux_msg_set_trace with trace_id=0 removes trace context");
+    flux_msg_destroy (msg);
+}
+
+/* Push enough routes, including one longer than the inline id size, to
+ * spill the route stack to the heap, then check encode/decode/copy.
+ */
+void check_routes_deep (void)
+{
+    flux_msg_t *msg, *msg2, *cpy;
+    char id[64];
+    char longid[128];
+    void *buf = NULL;
+    ssize_t size;
+    int i;
+    bool valid;
+
+    if (!(msg = flux_msg_create (FLUX_MSGTYPE_REQUEST)))
+        BAIL_OUT ("flux_msg_create failed");
+    flux_msg_route_enable (msg);
+    for (i = 0; i < 32; i++) {
+        snprintf (id, sizeof (id), "%d", i);
+        if (flux_msg_route_push (msg, id) < 0)
+            BAIL_OUT ("flux_msg_route_push failed");
+    }
+    memset (longid, 'L', sizeof (longid) - 1);
+    longid[sizeof (longid) - 1] = '\0';
+    ok (flux_msg_route_push (msg, longid) == 0,
+        "flux_msg_route_push works with a long route id");
+    ok (flux_msg_route_count (msg) == 33,
+        "flux_msg_route_count returns 33");
+    ok (streq (flux_msg_route_first (msg), "0")
+        && streq (flux_msg_route_last (msg), longid),
+        "first and last routes are correct");
+
+    if ((size = flux_msg_encode_size (msg)) < 0
+        || !(buf = malloc (size))
+        || flux_msg_encode (msg, buf, size) < 0)
+        BAIL_OUT ("error encoding message");
+    ok ((msg2 = flux_msg_decode (buf, size)) != NULL,
+        "flux_msg_decode works on deep route stack");
+    free (buf);
+    ok ((cpy = flux_msg_copy (msg2, false)) != NULL,
+        "flux_msg_copy works on deep route stack");
+    ok (flux_msg_route_count (cpy) == 33
+        && streq (flux_msg_route_first (cpy), "0")
+        && streq (flux_msg_route_last (cpy), longid),
+        "copy of decoded message has correct routes");
+    valid = true;
+    (void)flux_msg_route_delete_last (cpy);
+    for (i = 31; i >= 0; i--) {
+        snprintf (id, sizeof (id), "%d", i);
+        if (!streq (flux_msg_route_last (cpy), id))
+            valid = false;
+        (void)flux_msg_route_delete_last (cpy);
+    }
+    ok (valid && flux_msg_route_count (cpy) == 0,
+        "routes pop off in reverse order of push");
+    flux_msg_destroy (cpy);
+    flux_msg_destroy (msg2);
+    flux_msg_destroy (msg);
+}
+
+static int ref_destroy_count;
+
+static void ref_destroy (void *arg)
+{
+    ref_destroy_count++;
+    free (arg);
+}
+
+void check_payload_ref (void)
+{
+    flux_msg_t *msg, *cpy, *msg2;
+    char *buf;
+    const void *p;
+    int size;
+    void *encodebuf = NULL;
+    ssize_t encodesize;
+
+    if (!(buf = strdup ("abcdefghij")))
+        BAIL_OUT ("out of memory");
+    if (!(msg = flux_msg_create (FLUX_MSGTYPE_REQUEST)))
+        BAIL_OUT ("flux_msg_create failed");
+
+    errno = 0;
+    ok (flux_msg_set_payload_ref (msg, NULL, 1, ref_destroy, buf) < 0
+        && errno == EINVAL,
+        "flux_msg_set_payload_ref buf=NULL fails with EINVAL");
+    ref_destroy_count = 0;
+    ok (flux_msg_set_payload_ref (msg, buf, 11, ref_destroy, buf) == 0,
+        "flux_msg_set_payload_ref works");
+    ok (flux_msg_get_payload (msg, &p, &size) == 0
+        && p == buf
+        && size == 11,
+        "flux_msg_get_payload returns borrowed buffer");
+    ok ((cpy = flux_msg_copy (msg, true)) != NULL,
+        "flux_msg_copy works");
+    ok (flux_msg_get_payload (cpy, &p, &size) == 0 && p == buf,
+        "copy shares borrowed buffer");
+    flux_msg_destroy (msg);
+    ok (ref_destroy_count == 0,
+        "destroying original does not release shared buffer");
+    ok (flux_msg_set_payload (cpy, (char *)buf + 5, 6) == 0,
+        "flux_msg_set_payload from within borrowed buffer works");
+    ok (ref_destroy_count == 1,
+        "replacing payload released borrowed buffer");
+    ok (flux_msg_get_payload (cpy, &p, &size) == 0
+        && size == 6
+        && streq (p, "fghij"),
+        "new payload has expected content");
+    flux_msg_destroy (cpy);
+
+    /* decode_ref with a payload large enough to borrow
+     */
+    if (!(msg = flux_msg_create (FLUX_MSGTYPE_EVENT))
+        || flux_msg_set_topic (msg, "foo") < 0)
+        BAIL_OUT ("error creating message");
+    if (!(buf = calloc (1, 8192)))
+        BAIL_OUT ("out of memory");
+    memset (buf, 'x', 8191);
+    if (flux_msg_set_string (msg, buf) < 0)
+        BAIL_OUT ("flux_msg_set_string failed");
+    free (buf);
+    if ((encodesize = flux_msg_encode_size (msg)) < 0
+        || !(encodebuf = malloc (encodesize))
+        || flux_msg_encode (msg, encodebuf, encodesize) < 0)
+        BAIL_OUT ("error encoding message");
+    flux_msg_destroy (msg);
+    ref_destroy_count = 0;
+    ok ((msg2 = flux_msg_decode_ref (encodebuf,
+                                     encodesize,
+                                     ref_destroy,
+                                     encodebuf)) != NULL,
+        "flux_msg_decode_ref works");
+    ok (ref_destroy_count == 0,
+        "large payload was borrowed");
+    ok (flux_msg_get_payload (msg2, &p, &size) == 0
+        && size == 8192
+        && (char *)p > (char *)encodebuf
+        && (char *)p < (char *)encodebuf + encodesize,
+        "payload references the encode buffer");
+    flux_msg_destroy (msg2);
+    ok (ref_destroy_count == 1,
+        "destroying message released the encode buffer");
+
+    /* decode_ref with a small payload
+     */
+    if (!(msg = flux_msg_create (FLUX_MSGTYPE_EVENT))
+        || flux_msg_set_string (msg, "small") < 0)
+        BAIL_OUT ("error creating message");
+    if ((encodesize = flux_msg_encode_size (msg)) < 0
+        || !(encodebuf = malloc (encodesize))
+        || flux_msg_encode (msg, encodebuf, encodesize) < 0)
+        BAIL_OUT ("error encoding message");
+    flux_msg_destroy (msg);
+    ref_destroy_count = 0;
+    ok ((msg2 = flux_msg_decode_ref (encodebuf,
+                                     encodesize,
+                                     ref_destroy,
+                                     encodebuf)) != NULL
+        && ref_destroy_count == 1,
+        "flux_msg_decode_ref copies a small payload and releases buffer");
+    flux_msg_destroy (msg2);
+}
+
 int main (int argc, char *argv[])
 {
     int opt;
@@ -1396,14 +1723,17 @@ int main (int argc, char *argv[])
     check_cornercase ();
     check_proto ();
     check_routes ();
+    check_routes_deep ();
     check_topic ();
     check_payload ();
     check_payload_json ();
     check_payload_json_formatted ();
+    check_payload_cbor ();
     check_matchtag ();
     check_security ();
     check_aux ();
     check_copy ();
+    check_payload_ref ();
     check_flags ();
 
     check_cmp ();
@@ -1416,6 +1746,8 @@ int main (int argc, char *argv[])
     check_print_rolemask ();
 
     check_proto_internal ();
+    check_proto_trace ();
+    check_trace ();
 
     done_testing();
     return (0);
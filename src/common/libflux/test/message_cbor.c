@@ -0,0 +1,225 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <jansson.h>
+
+#include "src/common/libflux/message_cbor.h"
+#include "src/common/libtap/tap.h"
+
+/* Encoding examples from RFC 8949 Appendix A.
+ */
+struct vector {
+    const char *json;
+    const char *cbor;
+    size_t len;
+};
+
+static const struct vector vectors[] = {
+    { "0",                  "\x00",                                 1 },
+    { "23",                 "\x17",                                 1 },
+    { "24",                 "\x18\x18",                             2 },
+    { "100",                "\x18\x64",                             2 },
+    { "1000",               "\x19\x03\xe8",                         3 },
+    { "1000000",            "\x1a\x00\x0f\x42\x40",                 5 },
+    { "1000000000000",      "\x1b\x00\x00\x00\xe8\xd4\xa5\x10\x00", 9 },
+    { "-1",                 "\x20",                                 1 },
+    { "-1000",              "\x39\x03\xe7",                         3 },
+    { "1.1",                "\xfb\x3f\xf1\x99\x99\x99\x99\x99\x9a", 9 },
+    { "false",              "\xf4",                                 1 },
+    { "true",               "\xf5",                                 1 },
+    { "null",               "\xf6",                                 1 },
+    { "\"\"",               "\x60",                                 1 },
+    { "\"IETF\"",           "\x64\x49\x45\x54\x46",                 5 },
+    { "\"\\u00fc\"",        "\x62\xc3\xbc",                         3 },
+    { "[]",                 "\x80",                                 1 },
+    { "[1,[2,3]]",          "\x82\x01\x82\x02\x03",                 5 },
+    { "{}",                 "\xa0",                                 1 },
+    { "{\"a\":1}",          "\xa1\x61\x61\x01",                     4 },
+};
+
+static void check_vectors (void)
+{
+    int i;
+
+    for (i = 0; i < sizeof (vectors) / sizeof (vectors[0]); i++) {
+        const struct vector *v = &vectors[i];
+        json_t *o;
+        json_t *o2;
+        char buf[64];
+        ssize_t n;
+
+        if (!(o = json_loads (v->json, JSON_DECODE_ANY, NULL)))
+            BAIL_OUT ("json_loads %s failed", v->json);
+        n = cbor_encode (o, buf, sizeof (buf));
+        ok (n == CBOR_PREFIX_SIZE + v->len
+            && cbor_encoded_size (o) == n
+            && memcmp (buf + CBOR_PREFIX_SIZE, v->cbor, v->len) == 0,
+            "cbor_encode %s works", v->json);
+        o2 = cbor_decode (buf, n, NULL);
+        ok (o2 != NULL && json_equal (o, o2),
+            "cbor_decode %s works", v->json);
+        json_decref (o2);
+        json_decref (o);
+    }
+}
+
+static void check_roundtrip (void)
+{
+    json_t *o;
+    json_t *o2;
+    void *buf;
+    ssize_t size;
+    char key[300];
+
+    memset (key, 'k', sizeof (key) - 1);
+    key[sizeof (key) - 1] = '\0';
+    o = json_pack ("{s:I s:I s:s# s:f s:[s,{}] s:i}",
+                   "max", (json_int_t)INT64_MAX,
+                   "min", (json_int_t)INT64_MIN,
+                   "nul", "a\0b", 3,
+                   "real", -0.25,
+                   "array", "x",
+                   key, 1);
+    if (!o)
+        BAIL_OUT ("json_pack failed");
+    ok ((size = cbor_encoded_size (o)) > 0,
+        "cbor_encoded_size works");
+    if (!(buf = malloc (size)))
+        BAIL_OUT ("out of memory");
+    errno = 0;
+    ok (cbor_encode (o, buf, size - 1) < 0 && errno == EOVERFLOW,
+        "cbor_encode fails with EOVERFLOW if buffer is too small");
+    ok (cbor_encode (o, buf, size) == size,
+        "cbor_encode works");
+    ok (cbor_is_encoded (buf, size) == true,
+        "cbor_is_encoded returns true");
+    o2 = cbor_decode (buf, size, NULL);
+    ok (o2 != NULL && json_equal (o, o2),
+        "cbor_decode round trip preserves value");
+    json_decref (o2);
+    free (buf);
+    json_decref (o);
+
+    ok (cbor_is_encoded ("{}", 3) == false,
+        "cbor_is_encoded returns false for JSON");
+    ok (cbor_is_encoded (NULL, 0) == false,
+        "cbor_is_encoded returns false for NULL");
+    errno = 0;
+    ok (cbor_encoded_size (NULL) < 0 && errno == EINVAL,
+        "cbor_encoded_size o=NULL fails with EINVAL");
+}
+
+static void check_floats (void)
+{
+    struct {
+        const char *cbor;
+        size_t len;
+        double value;
+    } tab[] = {
+        { "\xd9\xd9\xf7\xf9\x3c\x00", 6, 1.0 },
+        { "\xd9\xd9\xf7\xf9\x7b\xff", 6, 65504.0 },
+        { "\xd9\xd9\xf7\xf9\xc4\x00", 6, -4.0 },
+        { "\xd9\xd9\xf7\xf9\x00\x01", 6, 5.960464477539063e-8 },
+        { "\xd9\xd9\xf7\xfa\x47\xc3\x50\x00", 8, 100000.0 },
+    };
+    int i;
+
+    for (i = 0; i < sizeof (tab) / sizeof (tab[0]); i++) {
+        json_t *o = cbor_decode (tab[i].cbor, tab[i].len, NULL);
+        ok (json_is_real (o) && json_real_value (o) == tab[i].value,
+            "cbor_decode %g works", tab[i].value);
+        json_decref (o);
+    }
+}
+
+static void check_errors (void)
+{
+    struct {
+        const char *cbor;
+        size_t len;
+        const char *desc;
+    } tab[] = {
+        { "\xa0", 1, "missing prefix" },
+        { "\xd9\xd9\xf7", 3, "empty item" },
+        { "\xd9\xd9\xf7\xa0\xa0", 5, "trailing data" },
+        { "\xd9\xd9\xf7\x9f\xff", 5, "indefinite length array" },
+        { "\xd9\xd9\xf7\x41\x00", 5, "byte string" },
+        { "\xd9\xd9\xf7\xc0\x60", 5, "tagged item" },
+        { "\xd9\xd9\xf7\x1b\x80\x00\x00\x00\x00\x00\x00\x00", 12,
+          "integer greater than INT64_MAX" },
+        { "\xd9\xd9\xf7\x3b\x80\x00\x00\x00\x00\x00\x00\x00", 12,
+          "integer less than INT64_MIN" },
+        { "\xd9\xd9\xf7\x62\xc3\x28", 6, "invalid UTF-8" },
+        { "\xd9\xd9\xf7\x65\x61", 5, "truncated string" },
+        { "\xd9\xd9\xf7\x19\x01", 5, "truncated integer" },
+        { "\xd9\xd9\xf7\x9a\xff\xff\xff\xff", 8, "huge array count" },
+        { "\xd9\xd9\xf7\xa1\x01\x01", 6, "non-string map key" },
+        { "\xd9\xd9\xf7\xa1\x63\x61\x00\x62\x01", 9, "map key with NUL" },
+        { "\xd9\xd9\xf7\xf9\x7c\x00", 6, "infinity" },
+        { "\xd9\xd9\xf7\xf7", 4, "undefined" },
+    };
+    int i;
+
+    for (i = 0; i < sizeof (tab) / sizeof (tab[0]); i++) {
+        json_error_t error;
+        json_t *o;
+
+        errno = 0;
+        memset (&error, 0, sizeof (error));
+        o = cbor_decode (tab[i].cbor, tab[i].len, &error);
+        ok (o == NULL && errno == EPROTO && strlen (error.text) > 0,
+            "cbor_decode %s fails: %s", tab[i].desc, error.text);
+        json_decref (o);
+    }
+}
+
+static void check_depth (void)
+{
+    size_t len = CBOR_PREFIX_SIZE + 4096;
+    char *buf;
+    json_t *o;
+
+    if (!(buf = malloc (len)))
+        BAIL_OUT ("out of memory");
+    memcpy (buf, "\xd9\xd9\xf7", CBOR_PREFIX_SIZE);
+    memset (buf + CBOR_PREFIX_SIZE, 0x81, len - CBOR_PREFIX_SIZE - 1);
+    buf[len - 1] = 0x80;
+    errno = 0;
+    o = cbor_decode (buf, len, NULL);
+    ok (o == NULL && errno == EPROTO,
+        "cbor_decode fails on deeply nested arrays");
+    json_decref (o);
+    free (buf);
+}
+
+int main (int argc, char *argv[])
+{
+    plan (NO_PLAN);
+
+    check_vectors ();
+    check_roundtrip ();
+    check_floats ();
+    check_errors ();
+    check_depth ();
+
+    done_testing ();
+    return (0);
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
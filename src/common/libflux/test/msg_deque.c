@@ -12,6 +12,7 @@
 #include "config.h"
 #endif
 #include <poll.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <flux/core.h>
 
@@ -87,6 +88,54 @@ void check_queue (void)
     msg_deque_destroy (q);
 }
 
+void check_batch (void)
+{
+    struct msg_deque *q;
+    flux_msg_t *msgs[3];
+    flux_msg_t *msg;
+    int i;
+
+    for (i = 0; i < 3; i++) {
+        if (!(msgs[i] = flux_msg_create (FLUX_MSGTYPE_REQUEST)))
+            BAIL_OUT ("flux_msg_create failed");
+    }
+    if (!(q = msg_deque_create (0)))
+        BAIL_OUT ("msg_deque_create failed");
+    ok (msg_deque_push_back_batch (q, msgs, 0) == 0
+        && msg_deque_empty (q) == true,
+        "msg_deque_push_back_batch count=0 works");
+    ok ((msg_deque_pollevents (q) & POLLIN) == 0,
+        "POLLIN is not raised");
+
+    (void)flux_msg_incref (msgs[2]);
+    errno = 0;
+    ok (msg_deque_push_back_batch (q, msgs, 3) < 0 && errno == EINVAL
+        && msg_deque_empty (q) == true,
+        "msg_deque_push_back_batch fails with EINVAL if any refcount > 1");
+    flux_msg_decref (msgs[2]);
+
+    ok (msg_deque_push_back_batch (q, msgs, 3) == 0,
+        "msg_deque_push_back_batch works");
+    ok ((msg_deque_pollevents (q) & POLLIN) != 0,
+        "POLLIN is raised");
+    for (i = 0; i < 3; i++) {
+        ok ((msg = msg_deque_pop_front (q)) == msgs[i],
+            "msg_deque_pop_front popped msg%d", i + 1);
+        flux_msg_destroy (msg);
+    }
+    ok (msg_deque_empty (q) == true,
+        "msg_deque_empty is true");
+
+    errno = 0;
+    ok (msg_deque_push_back_batch (NULL, msgs, 1) < 0 && errno == EINVAL,
+        "msg_deque_push_back_batch q=NULL fails with EINVAL");
+    errno = 0;
+    ok (msg_deque_push_back_batch (q, NULL, 1) < 0 && errno == EINVAL,
+        "msg_deque_push_back_batch msgs=NULL fails with EINVAL");
+
+    msg_deque_destroy (q);
+}
+
 void check_poll (void)
 {
     struct msg_deque *q;
@@ -181,6 +230,145 @@ void check_single_thread (void)
     msg_deque_destroy (q);
 }
 
+void check_mpsc (void)
+{
+    struct msg_deque *q;
+    struct msg_deque_stats stats;
+    flux_msg_t *msg1;
+    flux_msg_t *msg2 = NULL;
+    flux_msg_t *msg3 = NULL;
+    flux_msg_t *msg;
+    struct pollfd pfd;
+
+    if (!(msg1 = flux_msg_create (FLUX_MSGTYPE_REQUEST))
+        || !(msg2 = flux_msg_create (FLUX_MSGTYPE_REQUEST))
+        || !(msg3 = flux_msg_create (FLUX_MSGTYPE_REQUEST)))
+        BAIL_OUT ("flux_msg_create failed");
+
+    q = msg_deque_create (MSG_DEQUE_MPSC);
+    ok (q != NULL,
+        "mpsc: msg_deque_create flags=MPSC works");
+    pfd.fd = msg_deque_pollfd (q);
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    ok (pfd.fd >= 0,
+        "mpsc: msg_deque_pollfd works");
+    ok (msg_deque_pollevents (q) == POLLOUT,
+        "mpsc: msg_deque_pollevents on empty queue returns POLLOUT");
+    ok (msg_deque_pop_front (q) == NULL,
+        "mpsc: msg_deque_pop_front on empty queue returns NULL");
+
+    ok (msg_deque_push_back (q, msg1) == 0
+        && msg_deque_push_back (q, msg2) == 0,
+        "mpsc: msg_deque_push_back msg1, msg2 works");
+    errno = 0;
+    ok (msg_deque_push_back (q, msg1) < 0 && errno == EINVAL,
+        "mpsc: msg_deque_push_back of queued message fails with EINVAL");
+    ok (msg_deque_push_front (q, msg3) == 0,
+        "mpsc: msg_deque_push_front msg3 works");
+    ok (poll (&pfd, 1, 0) == 1 && pfd.revents == POLLIN,
+        "mpsc: pollfd is ready");
+    msg_deque_get_stats (q, &stats);
+    ok (stats.depth == 3 && stats.wakeups == 1,
+        "mpsc: depth is 3 and pollfd was signaled once");
+    ok (msg_deque_pollevents (q) == (POLLOUT | POLLIN),
+        "mpsc: msg_deque_pollevents returns POLLOUT|POLLIN");
+    pfd.revents = 0;
+    ok (poll (&pfd, 1, 0) == 0,
+        "mpsc: pollfd is no longer ready");
+    ok ((msg = msg_deque_pop_front (q)) == msg3,
+        "mpsc: msg_deque_pop_front popped msg3");
+    flux_msg_destroy (msg);
+    ok ((msg = msg_deque_pop_front (q)) == msg1,
+        "mpsc: msg_deque_pop_front popped msg1");
+    flux_msg_destroy (msg);
+    ok ((msg = msg_deque_pop_front (q)) == msg2,
+        "mpsc: msg_deque_pop_front popped msg2");
+    flux_msg_destroy (msg);
+    ok (msg_deque_empty (q) == true,
+        "mpsc: msg_deque_empty is true");
+    ok (msg_deque_pollevents (q) == POLLOUT,
+        "mpsc: msg_deque_pollevents returns POLLOUT");
+
+    msg_deque_destroy (q);
+}
+
+#define MPSC_PRODUCERS  4
+#define MPSC_MESSAGES   10000
+
+struct producer {
+    pthread_t t;
+    struct msg_deque *q;
+    int id;
+};
+
+static void *producer_thread (void *arg)
+{
+    struct producer *p = arg;
+    flux_msg_t *msg;
+    int i;
+
+    for (i = 0; i < MPSC_MESSAGES; i++) {
+        if (!(msg = flux_msg_create (FLUX_MSGTYPE_REQUEST))
+            || flux_msg_set_nodeid (msg, p->id) < 0
+            || flux_msg_set_matchtag (msg, i) < 0
+            || msg_deque_push_back (p->q, msg) < 0)
+            BAIL_OUT ("producer %d failed", p->id);
+    }
+    return NULL;
+}
+
+void check_mpsc_threads (void)
+{
+    struct producer p[MPSC_PRODUCERS];
+    int next[MPSC_PRODUCERS] = { 0 };
+    struct msg_deque *q;
+    struct msg_deque_stats stats;
+    struct pollfd pfd;
+    int count = 0;
+    int errors = 0;
+    int i, e;
+
+    if (!(q = msg_deque_create (MSG_DEQUE_MPSC)))
+        BAIL_OUT ("msg_deque_create failed");
+    pfd.fd = msg_deque_pollfd (q);
+    pfd.events = POLLIN;
+    for (i = 0; i < MPSC_PRODUCERS; i++) {
+        p[i].q = q;
+        p[i].id = i;
+        if ((e = pthread_create (&p[i].t, NULL, producer_thread, &p[i])))
+            BAIL_OUT ("pthread_create failed");
+    }
+    while (count < MPSC_PRODUCERS * MPSC_MESSAGES) {
+        flux_msg_t *msg;
+        uint32_t nodeid, matchtag;
+
+        if (poll (&pfd, 1, -1) < 0)
+            BAIL_OUT ("poll failed");
+        if (msg_deque_pollevents (q) < 0)
+            BAIL_OUT ("msg_deque_pollevents failed");
+        while ((msg = msg_deque_pop_front (q))) {
+            if (flux_msg_get_nodeid (msg, &nodeid) < 0
+                || flux_msg_get_matchtag (msg, &matchtag) < 0
+                || nodeid >= MPSC_PRODUCERS
+                || matchtag != next[nodeid]++)
+                errors++;
+            flux_msg_destroy (msg);
+            count++;
+        }
+    }
+    for (i = 0; i < MPSC_PRODUCERS; i++)
+        pthread_join (p[i].t, NULL);
+    ok (count == MPSC_PRODUCERS * MPSC_MESSAGES && errors == 0,
+        "mpsc: %d producers sent %d messages each, in order",
+        MPSC_PRODUCERS, MPSC_MESSAGES);
+    msg_deque_get_stats (q, &stats);
+    diag ("wakeups=%ju", (uintmax_t)stats.wakeups);
+    ok (stats.depth == 0 && stats.wakeups <= count,
+        "mpsc: queue is empty and wakeups were coalesced");
+    msg_deque_destroy (q);
+}
+
 void check_inval (void)
 {
     struct msg_deque *q;
@@ -262,8 +450,11 @@ int main (int argc, char *argv[])
 
     check_queue ();
     check_poll ();
+    check_batch ();
     check_inval ();
     check_single_thread ();
+    check_mpsc ();
+    check_mpsc_threads ();
 
     done_testing ();
     return (0);
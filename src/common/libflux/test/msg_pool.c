@@ -0,0 +1,142 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <errno.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "src/common/libflux/message.h"
+#include "src/common/libflux/msg_pool.h"
+#include "src/common/libtap/tap.h"
+#include "ccan/str/str.h"
+
+static void check_msg_reuse (void)
+{
+    struct flux_msg_pool_stats before, after;
+    flux_msg_t *msg;
+
+    flux_msg_pool_get_stats (&before);
+    if (!(msg = flux_msg_create (FLUX_MSGTYPE_REQUEST)))
+        BAIL_OUT ("flux_msg_create failed");
+    if (flux_msg_set_topic (msg, "foo.bar") < 0)
+        BAIL_OUT ("flux_msg_set_topic failed");
+    if (flux_msg_set_string (msg, "hello") < 0)
+        BAIL_OUT ("flux_msg_set_string failed");
+    flux_msg_route_enable (msg);
+    if (flux_msg_route_push (msg, "route1") < 0)
+        BAIL_OUT ("flux_msg_route_push failed");
+    flux_msg_destroy (msg);
+
+    if (!(msg = flux_msg_create (FLUX_MSGTYPE_EVENT)))
+        BAIL_OUT ("flux_msg_create failed");
+    if (flux_msg_set_topic (msg, "baz") < 0)
+        BAIL_OUT ("flux_msg_set_topic failed");
+    flux_msg_pool_get_stats (&after);
+    ok (after.msg_hit > before.msg_hit,
+        "second flux_msg_create was satisfied from the pool");
+    ok (after.buf_hit > before.buf_hit,
+        "topic buffer was satisfied from the pool");
+    ok (!flux_msg_has_flag (msg, FLUX_MSGFLAG_ROUTE)
+        && !flux_msg_has_payload (msg),
+        "recycled message does not retain old flags or payload");
+    flux_msg_destroy (msg);
+}
+
+static void check_buf (void)
+{
+    char *s;
+    char *p;
+
+    ok ((s = msg_pool_strdup ("abc")) != NULL && streq (s, "abc"),
+        "msg_pool_strdup works");
+    ok ((p = msg_pool_buf_realloc (s, 16)) == s,
+        "msg_pool_buf_realloc within class capacity returns same buffer");
+    ok ((p = msg_pool_buf_realloc (s, 1000)) != NULL && streq (p, "abc"),
+        "msg_pool_buf_realloc to a larger class preserves content");
+    msg_pool_buf_free (p);
+
+    ok ((s = msg_pool_strndup ("abcdef", 3)) != NULL && streq (s, "abc"),
+        "msg_pool_strndup works");
+    msg_pool_buf_free (s);
+
+    ok ((p = msg_pool_buf_alloc (MSG_POOL_BUF_MAX * 4)) != NULL,
+        "msg_pool_buf_alloc works for size larger than largest class");
+    memset (p, 0x55, MSG_POOL_BUF_MAX * 4);
+    msg_pool_buf_free (p);
+
+    lives_ok ({msg_pool_buf_free (NULL);},
+        "msg_pool_buf_free buf=NULL doesn't crash");
+    lives_ok ({msg_pool_msg_free (NULL);},
+        "msg_pool_msg_free msg=NULL doesn't crash");
+}
+
+static void check_payload_shrink (void)
+{
+    flux_msg_t *msg;
+    const void *buf;
+    int size;
+
+    if (!(msg = flux_msg_create (FLUX_MSGTYPE_REQUEST)))
+        BAIL_OUT ("flux_msg_create failed");
+    if (flux_msg_set_payload (msg, "0123456789", 10) < 0
+        || flux_msg_set_payload (msg, "abc", 3) < 0)
+        BAIL_OUT ("flux_msg_set_payload failed");
+    ok (flux_msg_get_payload (msg, &buf, &size) == 0
+        && size == 3
+        && memcmp (buf, "abc", 3) == 0,
+        "replacing payload with a smaller one updates payload size");
+    flux_msg_destroy (msg);
+}
+
+static void *thread_destroy (void *arg)
+{
+    flux_msg_t *msg = arg;
+    flux_msg_destroy (msg);
+    return NULL;
+}
+
+/* A message created in one thread may be destroyed in another.
+ */
+static void check_cross_thread (void)
+{
+    pthread_t t;
+    flux_msg_t *msg;
+    int e;
+
+    if (!(msg = flux_msg_create (FLUX_MSGTYPE_REQUEST))
+        || flux_msg_set_topic (msg, "a.b") < 0
+        || flux_msg_set_string (msg, "xyz") < 0)
+        BAIL_OUT ("error creating message");
+    if ((e = pthread_create (&t, NULL, thread_destroy, msg)) != 0)
+        BAIL_OUT ("pthread_create: %s", strerror (e));
+    if ((e = pthread_join (t, NULL)) != 0)
+        BAIL_OUT ("pthread_join: %s", strerror (e));
+    pass ("message destroyed in another thread");
+}
+
+int main (int argc, char *argv[])
+{
+    plan (NO_PLAN);
+
+    check_msg_reuse ();
+    check_buf ();
+    check_payload_shrink ();
+    check_cross_thread ();
+
+    done_testing ();
+    return (0);
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
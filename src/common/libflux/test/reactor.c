@@ -634,6 +634,22 @@ static void test_reactor_flags (flux_reactor_t *r)
         "flux_reactor_create flags=0xffff fails with EINVAL");
 }
 
+/* The io_uring backend may not be available, but reactor creation
+ * should succeed regardless, with a working fallback.
+ */
+static void test_iouring (void)
+{
+    flux_reactor_t *r;
+
+    ok ((r = flux_reactor_create (FLUX_REACTOR_IOURING)) != NULL,
+        "flux_reactor_create FLUX_REACTOR_IOURING works");
+    if (!r)
+        BAIL_OUT ("flux_reactor_create failed");
+    test_fd (r);
+    test_timer (r);
+    flux_reactor_destroy (r);
+}
+
 int main (int argc, char *argv[])
 {
     flux_reactor_t *reactor;
@@ -661,6 +677,8 @@ int main (int argc, char *argv[])
 
     flux_reactor_destroy (reactor);
 
+    test_iouring ();
+
     lives_ok ({ reactor_destroy_early ();},
         "destroying reactor then watcher doesn't segfault");
 
@@ -184,6 +184,42 @@ error:
         BAIL_OUT ("flux_respond_error: %s", flux_strerror (errno));
 }
 
+/* increment n, and report whether the request was CBOR encoded */
+void rpctest_cbor_cb (flux_t *h, flux_msg_handler_t *mh,
+                      const flux_msg_t *msg, void *arg)
+{
+    int n;
+
+    if (flux_request_unpack (msg, NULL, "{s:i}", "n", &n) < 0)
+        goto error;
+    if (flux_respond_pack (h,
+                           msg,
+                           "{s:i s:b}",
+                           "n", n + 1,
+                           "cbor", flux_msg_is_cbor (msg)) < 0)
+        BAIL_OUT ("flux_respond_pack: %s", flux_strerror (errno));
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        BAIL_OUT ("flux_respond_error: %s", flux_strerror (errno));
+}
+
+/* Send three results in one batch response followed by ENODATA.
+ * The second result has no payload.
+ */
+void rpctest_batch_cb (flux_t *h, flux_msg_handler_t *mh,
+                       const flux_msg_t *msg, void *arg)
+{
+    const char *results[] = { "{\"seq\":0}", NULL, "{\"seq\":2}" };
+
+    if (flux_respond_batch (h, msg, results, 3) < 0)
+        goto error;
+    errno = ENODATA;
+error:
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        BAIL_OUT ("flux_respond_error: %s", flux_strerror (errno));
+}
+
 static const struct flux_msg_handler_spec htab[] = {
     { FLUX_MSGTYPE_REQUEST,   "rpctest.incr",    rpctest_incr_cb, 0 },
     { FLUX_MSGTYPE_REQUEST,   "rpctest.hello",   rpctest_hello_cb, 0 },
@@ -193,6 +229,8 @@ static const struct flux_msg_handler_spec htab[] = {
     { FLUX_MSGTYPE_REQUEST,   "rpctest.rawecho", rpctest_rawecho_cb, 0 },
     { FLUX_MSGTYPE_REQUEST,   "rpctest.nodeid",  rpctest_nodeid_cb, 0 },
     { FLUX_MSGTYPE_REQUEST,   "rpctest.multi",   rpctest_multi_cb, 0 },
+    { FLUX_MSGTYPE_REQUEST,   "rpctest.cbor",    rpctest_cbor_cb, 0 },
+    { FLUX_MSGTYPE_REQUEST,   "rpctest.batch",   rpctest_batch_cb, 0 },
     FLUX_MSGHANDLER_TABLE_END,
 };
 
@@ -951,6 +989,98 @@ static void test_rpc_get_nodeid (flux_t *h)
     flux_future_destroy (f);
 }
 
+static void test_cbor (flux_t *h)
+{
+    flux_future_t *f;
+    const flux_msg_t *msg;
+    const char *s;
+    int n;
+    int cbor;
+
+    errno = 0;
+    ok (flux_rpc (h, "rpctest.cbor", "{}", FLUX_NODEID_ANY, FLUX_RPC_CBOR)
+        == NULL && errno == EINVAL,
+        "flux_rpc flags=FLUX_RPC_CBOR fails with EINVAL");
+
+    if (flux_attr_set_cacheonly (h, "broker.payload-encodings", "json,cbor")
+        < 0)
+        BAIL_OUT ("flux_attr_set_cacheonly failed");
+    f = flux_rpc_pack (h,
+                       "rpctest.cbor",
+                       FLUX_NODEID_ANY,
+                       FLUX_RPC_CBOR,
+                       "{s:i}",
+                       "n", 41);
+    ok (f != NULL,
+        "flux_rpc_pack flags=FLUX_RPC_CBOR works");
+    n = cbor = 0;
+    ok (flux_rpc_get_unpack (f, "{s:i s:b}", "n", &n, "cbor", &cbor) == 0
+        && n == 42
+        && cbor == 1,
+        "service received CBOR request and responded");
+    ok (flux_future_get (f, (const void **)&msg) == 0
+        && flux_msg_is_cbor (msg),
+        "response was CBOR encoded");
+    ok (flux_rpc_get (f, &s) == 0
+        && s != NULL
+        && streq (s, "{\"n\":42,\"cbor\":true}"),
+        "flux_rpc_get returns response as JSON text");
+    flux_future_destroy (f);
+
+    f = flux_rpc_pack (h, "rpctest.cbor", FLUX_NODEID_ANY, 0, "{s:i}", "n", 1);
+    ok (f != NULL,
+        "flux_rpc_pack flags=0 works");
+    n = cbor = 1;
+    ok (flux_rpc_get_unpack (f, "{s:i s:b}", "n", &n, "cbor", &cbor) == 0
+        && n == 2
+        && cbor == 0,
+        "service received JSON request");
+    ok (flux_future_get (f, (const void **)&msg) == 0
+        && !flux_msg_is_cbor (msg),
+        "response was JSON encoded");
+    flux_future_destroy (f);
+}
+
+static void test_batch (flux_t *h)
+{
+    flux_future_t *f;
+    const char *s;
+    int seq;
+
+    f = flux_rpc (h, "rpctest.batch", NULL, FLUX_NODEID_ANY, 0);
+    if (!f)
+        BAIL_OUT ("flux_rpc failed");
+    errno = 0;
+    ok (flux_rpc_get (f, NULL) < 0 && errno == EPROTO,
+        "batch: flux_respond_batch fails with EPROTO on non-streaming RPC");
+    flux_future_destroy (f);
+
+    f = flux_rpc (h, "rpctest.batch", NULL, FLUX_NODEID_ANY,
+                  FLUX_RPC_STREAMING);
+    if (!f)
+        BAIL_OUT ("flux_rpc failed");
+    seq = -1;
+    ok (flux_rpc_get_unpack (f, "{s:i}", "seq", &seq) == 0 && seq == 0,
+        "batch: received first result");
+    flux_future_reset (f);
+    s = "x";
+    ok (flux_rpc_get (f, &s) == 0 && s == NULL,
+        "batch: received second result with no payload");
+    flux_future_reset (f);
+    seq = -1;
+    ok (flux_rpc_get_unpack (f, "{s:i}", "seq", &seq) == 0 && seq == 2,
+        "batch: received third result");
+    flux_future_reset (f);
+    errno = 0;
+    ok (flux_rpc_get (f, NULL) < 0 && errno == ENODATA,
+        "batch: stream terminated with ENODATA");
+    flux_future_destroy (f);
+
+    errno = 0;
+    ok (flux_respond_batch (h, NULL, NULL, 1) < 0 && errno == EINVAL,
+        "flux_respond_batch request=NULL fails with EINVAL");
+}
+
 static int comms_err (flux_t *h, void *arg)
 {
     BAIL_OUT ("fatal coms error: %s", strerror (errno));
@@ -991,6 +1121,8 @@ int main (int argc, char *argv[])
     test_multi_rpc_active_count (h);
 
     test_rpc_get_nodeid (h);
+    test_cbor (h);
+    test_batch (h);
 
     ok (test_server_stop (h) == 0,
         "stopped test server thread");
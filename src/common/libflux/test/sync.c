@@ -102,7 +102,10 @@ void continuation (flux_future_t *f, void *arg)
         flux_future_reset (f);
 }
 
-void test_sync_reactive (double heartrate, double min, double max)
+void test_sync_reactive (double heartrate,
+                         double min,
+                         double max,
+                         double jitter)
 {
     flux_t *h = flux_open ("loop://", 0);
     struct heartbeat_ctx ctx = { .h = h, .seq = 0 };
@@ -127,6 +130,10 @@ void test_sync_reactive (double heartrate, double min, double max)
     f = flux_sync_create (h, min);
     ok (f != NULL,
         "flux_sync_create works");
+    if (jitter > 0.) {
+        ok (flux_sync_set_jitter (f, jitter) == 0,
+            "flux_sync_set_jitter %.2f works", jitter);
+    }
     ok (flux_future_then (f, max, continuation, &count) == 0,
         "flux_future_then heartrate=%.2f min=%.2f max=max", heartrate, min,max);
     count = 4;
@@ -142,16 +149,29 @@ void test_sync_reactive (double heartrate, double min, double max)
 
 int main (int argc, char *argv[])
 {
+    flux_future_t *f;
+
     plan (NO_PLAN);
 
     errno = 0;
     ok (flux_sync_create (NULL, 0.) == NULL && errno == EINVAL,
         "flux_sync_create h=NULL fails with EINVAL");
 
+    errno = 0;
+    ok (flux_sync_set_jitter (NULL, 1.) < 0 && errno == EINVAL,
+        "flux_sync_set_jitter f=NULL fails with EINVAL");
+    if (!(f = flux_future_create (NULL, NULL)))
+        BAIL_OUT ("flux_future_create failed");
+    errno = 0;
+    ok (flux_sync_set_jitter (f, 1.) < 0 && errno == EINVAL,
+        "flux_sync_set_jitter on a non-sync future fails with EINVAL");
+    flux_future_destroy (f);
+
     test_non_reactive_loop ();
-    test_sync_reactive (0.01, 0.,   5.);    // driven by heartbeat
-    test_sync_reactive (0.01, 0.1,  5.);    //   same, but skip some heartbeats
-    test_sync_reactive (5.,   0,    0.01);  // driven by 'max' timeout
+    test_sync_reactive (0.01, 0.,   5., 0.);    // driven by heartbeat
+    test_sync_reactive (0.01, 0.1,  5., 0.);    //   same, but skip some
+    test_sync_reactive (5.,   0,    0.01, 0.);  // driven by 'max' timeout
+    test_sync_reactive (0.01, 0.,   5., 1.);    // heartbeat with jitter
 
     done_testing();
     return (0);
@@ -0,0 +1,186 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <errno.h>
+#include <stdlib.h>
+#include <flux/core.h>
+
+#include "src/common/libflux/trace.h"
+#include "src/common/libtap/tap.h"
+#include "ccan/str/str.h"
+
+struct result {
+    uint64_t root_trace_id;     // trace context of foo.outer request
+    uint64_t root_span_id;
+    uint64_t inner_trace_id;    // trace context of foo.inner request
+    uint64_t inner_parent_id;
+    uint64_t then_trace_id;     // current trace in continuation
+    struct flux_trace_span spans[4];
+    int nspans;
+};
+
+static void inner_cb (flux_t *h,
+                      flux_msg_handler_t *mh,
+                      const flux_msg_t *msg,
+                      void *arg)
+{
+    struct result *res = arg;
+
+    (void)flux_msg_get_trace (msg,
+                              &res->inner_trace_id,
+                              &res->inner_parent_id);
+}
+
+static void outer_cb (flux_t *h,
+                      flux_msg_handler_t *mh,
+                      const flux_msg_t *msg,
+                      void *arg)
+{
+    struct result *res = arg;
+    flux_future_t *f;
+
+    (void)flux_msg_get_trace (msg, &res->root_trace_id, &res->root_span_id);
+    if (!(f = flux_rpc (h, "foo.inner", NULL, 0, FLUX_RPC_NORESPONSE)))
+        BAIL_OUT ("error sending foo.inner");
+    flux_future_destroy (f);
+    if (flux_respond (h, msg, NULL) < 0)
+        BAIL_OUT ("error responding to foo.outer");
+}
+
+static void outer_continuation (flux_future_t *f, void *arg)
+{
+    struct result *res = arg;
+    struct trace_ctx ctx;
+
+    trace_ctx_get (&ctx);
+    res->then_trace_id = ctx.trace_id;
+    flux_reactor_stop (flux_future_get_reactor (f));
+    flux_future_destroy (f);
+}
+
+static void span_cb (const struct flux_trace_span *span, void *arg)
+{
+    struct result *res = arg;
+
+    if (res->nspans < 4)
+        res->spans[res->nspans++] = *span;
+}
+
+static const struct flux_msg_handler_spec htab[] = {
+    { FLUX_MSGTYPE_REQUEST, "foo.outer", outer_cb, 0 },
+    { FLUX_MSGTYPE_REQUEST, "foo.inner", inner_cb, 0 },
+    FLUX_MSGHANDLER_TABLE_END,
+};
+
+static void check_propagate (void)
+{
+    flux_t *h;
+    flux_msg_handler_t **handlers;
+    flux_future_t *f;
+    struct result res = { 0 };
+    struct trace_ctx ctx;
+
+    if (!(h = flux_open ("loop://", 0)))
+        BAIL_OUT ("could not create loop handle");
+    if (flux_msg_handler_addvec (h, htab, &res, &handlers) < 0)
+        BAIL_OUT ("flux_msg_handler_addvec failed");
+
+    if (!(f = flux_rpc (h, "foo.outer", NULL, 0, 0))
+        || flux_future_then (f, -1., outer_continuation, &res) < 0)
+        BAIL_OUT ("error sending foo.outer");
+    ok (flux_reactor_run (flux_get_reactor (h), 0) >= 0,
+        "reactor ran");
+
+    ok (res.root_trace_id != 0 && res.root_span_id != 0,
+        "sampled request was given a new trace");
+    ok (res.inner_trace_id == res.root_trace_id,
+        "request sent by handler joined the trace");
+    ok (res.then_trace_id == res.root_trace_id,
+        "continuation ran in the trace context of its request");
+    trace_ctx_get (&ctx);
+    ok (ctx.trace_id == 0,
+        "trace context is restored after callbacks");
+
+    ok (flux_msg_handler_trace_foreach (h, span_cb, &res) == 2,
+        "flux_msg_handler_trace_foreach reports two spans");
+    ok (res.nspans == 2
+        && streq (res.spans[0].topic, "foo.inner")
+        && streq (res.spans[1].topic, "foo.outer"),
+        "spans are listed in order of completion");
+    ok (res.spans[1].parent_id == res.root_span_id
+        && res.spans[1].trace_id == res.root_trace_id,
+        "foo.outer span is a child of the client span");
+    ok (res.spans[0].parent_id == res.inner_parent_id
+        && res.spans[0].span_id != res.inner_parent_id,
+        "foo.inner span has its own ID");
+    ok (res.inner_parent_id == res.spans[1].span_id,
+        "foo.inner span is a child of the foo.outer span");
+    ok (res.spans[1].start > 0. && res.spans[1].duration >= 0.,
+        "span has start time and duration");
+
+    flux_msg_handler_trace_clear (h);
+    ok (flux_msg_handler_trace_foreach (h, NULL, NULL) == 0,
+        "flux_msg_handler_trace_clear works");
+    errno = 0;
+    ok (flux_msg_handler_trace_foreach (NULL, NULL, NULL) < 0
+        && errno == EINVAL,
+        "flux_msg_handler_trace_foreach h=NULL fails with EINVAL");
+
+    flux_msg_handler_delvec (handlers);
+    flux_close (h);
+}
+
+static void check_prepare (void)
+{
+    flux_msg_t *msg;
+    struct trace_ctx ctx;
+    struct trace_ctx cur = { .trace_id = 1, .span_id = 2 };
+    struct trace_ctx none = { 0 };
+    uint64_t trace_id, span_id;
+
+    if (!(msg = flux_request_encode ("foo.bar", NULL)))
+        BAIL_OUT ("flux_request_encode failed");
+    ok (flux_msg_set_trace (msg, 3, 4) == 0
+        && trace_request_prepare (msg, &ctx) == 0
+        && ctx.trace_id == 3 && ctx.span_id == 4,
+        "trace_request_prepare leaves existing trace context alone");
+    flux_msg_destroy (msg);
+
+    if (!(msg = flux_request_encode ("foo.bar", NULL)))
+        BAIL_OUT ("flux_request_encode failed");
+    trace_ctx_set (&cur);
+    ok (trace_request_prepare (msg, &ctx) == 0
+        && ctx.trace_id == 1 && ctx.span_id == 2
+        && flux_msg_get_trace (msg, &trace_id, &span_id) == 0
+        && trace_id == 1 && span_id == 2,
+        "trace_request_prepare applies the current trace context");
+    trace_ctx_set (&none);
+    flux_msg_destroy (msg);
+}
+
+int main (int argc, char *argv[])
+{
+    plan (NO_PLAN);
+
+    setenv ("FLUX_TRACE_SAMPLE", "1", 1);
+
+    check_propagate ();
+    check_prepare ();
+
+    done_testing ();
+    return (0);
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,282 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* trace.c - request tracing
+ *
+ * A traced request carries a 64-bit trace ID shared by all requests of
+ * one operation, and the 64-bit ID of the span that sent it (see
+ * message_proto.h).  A span is the handling of one request: from the
+ * dispatch of the request to its first response, or to the return of the
+ * handler if no response is expected.  The span's parent is the span that
+ * sent the request.
+ *
+ * A trace starts when a process with FLUX_TRACE_SAMPLE set in its
+ * environment sends a request outside of any trace.  The value is the
+ * fraction of such requests that are traced, e.g. "1" or "0.01".  Every
+ * process that handles a traced request propagates the trace to requests
+ * it sends on behalf of the request, and records the span in a ring of
+ * the most recent TRACE_SPANS_MAX spans on its handle, whether or not
+ * FLUX_TRACE_SAMPLE is set.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "handle.h"
+#include "message.h"
+#include "msg_handler.h"
+#include "trace.h"
+
+#define TRACE_SPANS_MAX 1024
+#define TRACE_TOPIC_MAX 64
+
+struct trace_pending {
+    struct flux_trace_span span;
+    struct timespec t0;
+    bool done;
+};
+
+struct trace_span_rec {
+    struct flux_trace_span span;
+    char topic[TRACE_TOPIC_MAX];
+};
+
+struct trace_spans {
+    struct trace_span_rec recs[TRACE_SPANS_MAX];
+    int next;
+    int count;
+};
+
+static const char *pending_auxkey = "flux::trace";
+static const char *spans_auxkey = "flux::trace_spans";
+
+static __thread struct trace_ctx tls_current;
+static __thread uint64_t tls_rand_state;
+
+static pthread_once_t env_once = PTHREAD_ONCE_INIT;
+static double env_sample;
+
+static void env_init (void)
+{
+    const char *s;
+    char *endptr;
+    double d;
+
+    if ((s = getenv ("FLUX_TRACE_SAMPLE"))) {
+        errno = 0;
+        d = strtod (s, &endptr);
+        if (errno == 0 && *endptr == '\0' && d > 0.)
+            env_sample = d < 1. ? d : 1.;
+    }
+}
+
+/* splitmix64, seeded per thread.  IDs need only be unique, not secret.
+ */
+static uint64_t trace_rand (void)
+{
+    uint64_t z;
+
+    if (tls_rand_state == 0) {
+        struct timespec ts;
+        clock_gettime (CLOCK_REALTIME, &ts);
+        tls_rand_state = ((uint64_t)ts.tv_sec << 32)
+                         ^ (uint64_t)ts.tv_nsec
+                         ^ ((uint64_t)getpid () << 16)
+                         ^ (uint64_t)(uintptr_t)&tls_rand_state;
+    }
+    z = (tls_rand_state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static uint64_t trace_id_create (void)
+{
+    uint64_t id;
+
+    while ((id = trace_rand ()) == 0)
+        ;
+    return id;
+}
+
+static bool trace_sample (void)
+{
+    pthread_once (&env_once, env_init);
+    if (env_sample == 0.)
+        return false;
+    if (env_sample == 1.)
+        return true;
+    return (trace_rand () >> 11) * 0x1.0p-53 < env_sample;
+}
+
+void trace_ctx_get (struct trace_ctx *ctx)
+{
+    *ctx = tls_current;
+}
+
+void trace_ctx_set (const struct trace_ctx *ctx)
+{
+    tls_current = *ctx;
+}
+
+int trace_request_prepare (flux_msg_t *msg, struct trace_ctx *ctx)
+{
+    struct trace_ctx new = { 0 };
+
+    if (flux_msg_get_trace (msg, &ctx->trace_id, &ctx->span_id) == 0)
+        return 0;
+    if (tls_current.trace_id)
+        new = tls_current;
+    else if (trace_sample ()) {
+        new.trace_id = trace_id_create ();
+        new.span_id = trace_id_create ();
+    }
+    if (new.trace_id
+        && flux_msg_set_trace (msg, new.trace_id, new.span_id) < 0)
+        return -1;
+    *ctx = new;
+    return 0;
+}
+
+static struct trace_spans *spans_get (flux_t *h, bool create)
+{
+    struct trace_spans *spans;
+
+    if (!(spans = flux_aux_get (h, spans_auxkey)) && create) {
+        if (!(spans = calloc (1, sizeof (*spans))))
+            return NULL;
+        if (flux_aux_set (h, spans_auxkey, spans, free) < 0) {
+            free (spans);
+            return NULL;
+        }
+    }
+    return spans;
+}
+
+static void spans_append (flux_t *h, struct trace_pending *p)
+{
+    struct trace_spans *spans;
+    struct trace_span_rec *rec;
+    struct timespec t1;
+
+    if (p->done || !(spans = spans_get (h, true)))
+        return;
+    p->done = true;
+    clock_gettime (CLOCK_MONOTONIC, &t1);
+    p->span.duration = (t1.tv_sec - p->t0.tv_sec)
+                       + (t1.tv_nsec - p->t0.tv_nsec) * 1E-9;
+
+    rec = &spans->recs[spans->next];
+    rec->span = p->span;
+    snprintf (rec->topic,
+              sizeof (rec->topic),
+              "%s",
+              p->span.topic ? p->span.topic : "");
+    rec->span.topic = rec->topic;
+    spans->next = (spans->next + 1) % TRACE_SPANS_MAX;
+    if (spans->count < TRACE_SPANS_MAX)
+        spans->count++;
+}
+
+void trace_request_begin (flux_t *h,
+                          const flux_msg_t *msg,
+                          struct trace_ctx *saved)
+{
+    struct trace_pending *p;
+    struct timespec ts;
+    uint64_t trace_id;
+    uint64_t parent_id;
+
+    *saved = tls_current;
+    if (flux_msg_get_trace (msg, &trace_id, &parent_id) < 0)
+        return;
+    if (!(p = calloc (1, sizeof (*p))))
+        return;
+    p->span.trace_id = trace_id;
+    p->span.span_id = trace_id_create ();
+    p->span.parent_id = parent_id;
+    clock_gettime (CLOCK_REALTIME, &ts);
+    p->span.start = ts.tv_sec + ts.tv_nsec * 1E-9;
+    clock_gettime (CLOCK_MONOTONIC, &p->t0);
+    /* N.B. the message is shared with the handler, which owns it for
+     * the duration of the callback.  The pending span lives in its aux
+     * container until the message is destroyed.
+     */
+    if (flux_msg_aux_set ((flux_msg_t *)msg, pending_auxkey, p, free) < 0) {
+        free (p);
+        return;
+    }
+    (void)flux_msg_get_topic (msg, &p->span.topic);
+    tls_current.trace_id = trace_id;
+    tls_current.span_id = p->span.span_id;
+}
+
+void trace_request_finish (flux_t *h,
+                           const flux_msg_t *msg,
+                           const struct trace_ctx *saved)
+{
+    struct trace_pending *p;
+
+    tls_current = *saved;
+    if (flux_msg_is_noresponse (msg)
+        && (p = flux_msg_aux_get (msg, pending_auxkey)))
+        spans_append (h, p);
+}
+
+void trace_request_respond (flux_t *h, const flux_msg_t *request)
+{
+    struct trace_pending *p;
+
+    if ((p = flux_msg_aux_get (request, pending_auxkey)))
+        spans_append (h, p);
+}
+
+int flux_msg_handler_trace_foreach (flux_t *h,
+                                    flux_trace_span_f cb,
+                                    void *arg)
+{
+    struct trace_spans *spans;
+    int i;
+
+    if (!h) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!(spans = spans_get (h, false)))
+        return 0;
+    i = (spans->next - spans->count + TRACE_SPANS_MAX) % TRACE_SPANS_MAX;
+    for (int n = 0; n < spans->count && cb; n++) {
+        cb (&spans->recs[i].span, arg);
+        i = (i + 1) % TRACE_SPANS_MAX;
+    }
+    return spans->count;
+}
+
+void flux_msg_handler_trace_clear (flux_t *h)
+{
+    struct trace_spans *spans;
+
+    if (h && (spans = spans_get (h, false))) {
+        spans->next = 0;
+        spans->count = 0;
+    }
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,69 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _FLUX_CORE_TRACE_H
+#define _FLUX_CORE_TRACE_H
+
+#include <stdint.h>
+
+#include "handle.h"
+#include "message.h"
+#include "future.h"
+
+/* Request tracing, used by the RPC code and message dispatcher.
+ *
+ * Each thread has a current trace context.  It is set while a handler
+ * for a traced request runs, and while continuations of futures created
+ * in a traced context run, so that requests sent from either join the
+ * trace.
+ */
+
+struct trace_ctx {
+    uint64_t trace_id;  // 0 if none
+    uint64_t span_id;
+};
+
+/* Give an outgoing request the current context, or a new trace if there
+ * is none and FLUX_TRACE_SAMPLE selects it.  A request that already has
+ * a context is left alone.  Its context, if any, is copied to 'ctx'.
+ */
+int trace_request_prepare (flux_msg_t *msg, struct trace_ctx *ctx);
+
+/* Start a span for received request 'msg' if it is traced, make it
+ * current, and save the previous context in 'saved'.  Call
+ * trace_request_finish() after the handler returns to restore 'saved',
+ * and to end the span if the request expects no response.
+ */
+void trace_request_begin (flux_t *h,
+                          const flux_msg_t *msg,
+                          struct trace_ctx *saved);
+void trace_request_finish (flux_t *h,
+                           const flux_msg_t *msg,
+                           const struct trace_ctx *saved);
+
+/* End the span of 'request' when it receives its first response.
+ */
+void trace_request_respond (flux_t *h, const flux_msg_t *request);
+
+/* Get/set the calling thread's current context.
+ */
+void trace_ctx_get (struct trace_ctx *ctx);
+void trace_ctx_set (const struct trace_ctx *ctx);
+
+/* Implemented in future.c.  Set the context that continuations of 'f'
+ * run in, which defaults to the current context when 'f' was created.
+ */
+void future_set_trace (flux_future_t *f, const struct trace_ctx *ctx);
+
+#endif /* !_FLUX_CORE_TRACE_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,270 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* batcher.c - adaptive commit batching
+ *
+ * Histograms have one bucket per power of two.  Bucket N counts values
+ * in [2^N, 2^(N+1)), except bucket 0 which also counts zero.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <errno.h>
+#include <jansson.h>
+#include <flux/core.h>
+
+#include "src/common/libutil/errno_safe.h"
+#include "src/common/libutil/tstat.h"
+
+#include "batcher.h"
+
+#define HIST_BUCKETS 40
+
+struct hist {
+    tstat_t ts;
+    uint64_t bucket[HIST_BUCKETS];
+};
+
+struct batcher {
+    flux_watcher_t *timer;
+    double armed;           // timeout of running timer, or -1 if stopped
+    batcher_f cb;
+    void *arg;
+
+    double delay;
+    int max_count;
+    size_t max_bytes;
+
+    bool open;
+    int count;
+    size_t bytes;
+    int inflight;
+
+    struct hist size;       // batch size in items
+    struct hist latency;    // commit latency in microseconds
+};
+
+static double batcher_now (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1E-9;
+}
+
+static void hist_record (struct hist *h, uint64_t value)
+{
+    int i = 0;
+
+    tstat_push (&h->ts, value);
+    while (value > 1 && i < HIST_BUCKETS - 1) {
+        value >>= 1;
+        i++;
+    }
+    h->bucket[i]++;
+}
+
+static json_t *hist_encode (struct hist *h)
+{
+    json_t *o;
+    json_t *buckets;
+    char key[32];
+    int i;
+
+    if (!(buckets = json_object ()))
+        goto nomem;
+    for (i = 0; i < HIST_BUCKETS; i++) {
+        json_t *val;
+        if (h->bucket[i] == 0)
+            continue;
+        snprintf (key, sizeof (key), "%ju", (uintmax_t)1 << i);
+        if (!(val = json_integer (h->bucket[i]))
+            || json_object_set_new (buckets, key, val) < 0) {
+            json_decref (val);
+            json_decref (buckets);
+            goto nomem;
+        }
+    }
+    if (!(o = json_pack ("{s:i s:f s:f s:f s:o}",
+                         "count", tstat_count (&h->ts),
+                         "min", tstat_min (&h->ts),
+                         "max", tstat_max (&h->ts),
+                         "mean", tstat_mean (&h->ts),
+                         "hist", buckets)))
+        goto nomem;
+    return o;
+nomem:
+    errno = ENOMEM;
+    return NULL;
+}
+
+static void arm (struct batcher *b, double timeout)
+{
+    if (b->armed >= 0 && b->armed <= timeout)
+        return;
+    flux_timer_watcher_reset (b->timer, timeout, 0.);
+    flux_watcher_start (b->timer);
+    b->armed = timeout;
+}
+
+static void disarm (struct batcher *b)
+{
+    flux_watcher_stop (b->timer);
+    b->armed = -1;
+}
+
+static bool over_limit (struct batcher *b)
+{
+    if (b->max_count > 0 && b->count >= b->max_count)
+        return true;
+    if (b->max_bytes > 0 && b->bytes >= b->max_bytes)
+        return true;
+    return false;
+}
+
+static void timer_cb (flux_reactor_t *r,
+                      flux_watcher_t *w,
+                      int revents,
+                      void *arg)
+{
+    struct batcher *b = arg;
+
+    b->armed = -1;
+    if (b->open)
+        b->cb (b, b->arg);
+}
+
+void batcher_add (struct batcher *b, int count, size_t bytes)
+{
+    bool was_open = b->open;
+
+    b->open = true;
+    b->count += count;
+    b->bytes += bytes;
+    if (over_limit (b))
+        arm (b, 0.);
+    else if (b->delay > 0) {
+        if (!was_open)
+            arm (b, b->delay);
+    }
+    else if (b->inflight == 0)
+        arm (b, 0.);
+}
+
+void batcher_reset (struct batcher *b)
+{
+    b->open = false;
+    b->count = 0;
+    b->bytes = 0;
+    disarm (b);
+}
+
+double batcher_commit_start (struct batcher *b)
+{
+    hist_record (&b->size, b->count);
+    batcher_reset (b);
+    b->inflight++;
+    return batcher_now ();
+}
+
+void batcher_commit_finish (struct batcher *b, double t_start)
+{
+    double t = batcher_now () - t_start;
+
+    hist_record (&b->latency, t > 0 ? (uint64_t)(t * 1E6) : 0);
+    if (b->inflight > 0)
+        b->inflight--;
+    if (b->inflight == 0 && b->open && b->delay == 0)
+        arm (b, 0.);
+}
+
+void batcher_set_limits (struct batcher *b, int max_count, size_t max_bytes)
+{
+    b->max_count = max_count;
+    b->max_bytes = max_bytes;
+}
+
+int batcher_set_delay (struct batcher *b, double delay)
+{
+    if (delay < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    b->delay = delay;
+    return 0;
+}
+
+double batcher_get_delay (struct batcher *b)
+{
+    return b->delay;
+}
+
+json_t *batcher_stats (struct batcher *b)
+{
+    json_t *size;
+    json_t *latency;
+    json_t *o;
+
+    if (!(size = hist_encode (&b->size)))
+        return NULL;
+    if (!(latency = hist_encode (&b->latency))) {
+        ERRNO_SAFE_WRAP (json_decref, size);
+        return NULL;
+    }
+    if (!(o = json_pack ("{s:f s:i s:I s:i s:o s:o}",
+                         "delay", b->delay,
+                         "max-count", b->max_count,
+                         "max-bytes", (json_int_t)b->max_bytes,
+                         "inflight", b->inflight,
+                         "batch-size", size,
+                         "commit-usec", latency))) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    return o;
+}
+
+void batcher_destroy (struct batcher *b)
+{
+    if (b) {
+        int saved_errno = errno;
+        flux_watcher_destroy (b->timer);
+        free (b);
+        errno = saved_errno;
+    }
+}
+
+struct batcher *batcher_create (flux_reactor_t *r, batcher_f cb, void *arg)
+{
+    struct batcher *b;
+
+    if (!r || !cb) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(b = calloc (1, sizeof (*b))))
+        return NULL;
+    if (!(b->timer = flux_timer_watcher_create (r, 0., 0., timer_cb, b)))
+        goto error;
+    b->armed = -1;
+    b->cb = cb;
+    b->arg = arg;
+    return b;
+error:
+    batcher_destroy (b);
+    return NULL;
+}
+
+// vi:ts=4 sw=4 expandtab
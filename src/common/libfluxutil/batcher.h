@@ -0,0 +1,70 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _LIBFLUXUTIL_BATCHER_H
+#define _LIBFLUXUTIL_BATCHER_H
+
+#include <stddef.h>
+#include <jansson.h>
+#include <flux/core.h>
+
+/* Decide when to commit a batch of updates, e.g. to the KVS.
+ *
+ * If no commit is in flight, the open batch is committed on the next
+ * reactor loop iteration, so an update made while idle is not delayed.
+ * While commits are in flight, the batch grows until they complete or
+ * until it reaches the count or size limit.
+ *
+ * If a fixed delay is set, each batch is instead committed that long
+ * after its first update, as with a plain timer.
+ */
+
+struct batcher;
+
+/* Called when the open batch should be committed.  The callback should
+ * close the batch and call batcher_commit_start() or batcher_reset().
+ */
+typedef void (*batcher_f)(struct batcher *b, void *arg);
+
+struct batcher *batcher_create (flux_reactor_t *r, batcher_f cb, void *arg);
+void batcher_destroy (struct batcher *b);
+
+/* Commit the open batch once it holds 'max_count' items or 'max_bytes'
+ * bytes, whether or not a commit is in flight.  Zero means no limit.
+ */
+void batcher_set_limits (struct batcher *b, int max_count, size_t max_bytes);
+
+/* Set a fixed delay in seconds, or zero for adaptive batching (default).
+ */
+int batcher_set_delay (struct batcher *b, double delay);
+double batcher_get_delay (struct batcher *b);
+
+/* Account for 'count' items totalling 'bytes' added to the open batch,
+ * and arrange for the callback to be called when it should be committed.
+ */
+void batcher_add (struct batcher *b, int count, size_t bytes);
+
+/* The open batch was closed without a commit.
+ */
+void batcher_reset (struct batcher *b);
+
+/* The open batch was closed and its commit started.  Returns the start
+ * time to pass to batcher_commit_finish() when the commit completes.
+ */
+double batcher_commit_start (struct batcher *b);
+void batcher_commit_finish (struct batcher *b, double t_start);
+
+/* Return an object with histograms of batch size and commit latency.
+ */
+json_t *batcher_stats (struct batcher *b);
+
+// vi:ts=4 sw=4 expandtab
+
+#endif // !_LIBFLUXUTIL_BATCHER_H
@@ -14,6 +14,7 @@
 #include <jansson.h>
 #include <flux/core.h>
 #include <time.h>
+#include <inttypes.h>
 #include <sys/resource.h>
 
 #include "src/common/libutil/errno_safe.h"
@@ -154,19 +155,138 @@ error:
         flux_log_error (h, "error responding to rusage request");
 }
 
+static void latency_append (const struct flux_latency_stats *stats, void *arg)
+{
+    json_t *o = arg;
+    json_t *dict = o;
+    json_t *entry;
+
+    if (stats->msgtype != 0) {
+        const char *type = flux_msg_typestr (stats->msgtype);
+        if (!(dict = json_object_get (o, type))) {
+            if (!(dict = json_object ())
+                || json_object_set_new (o, type, dict) < 0) {
+                json_decref (dict);
+                return;
+            }
+        }
+    }
+    if (!(entry = json_pack ("{s:I s:f s:f s:f s:f s:f}",
+                             "count", (json_int_t)stats->count,
+                             "mean", stats->mean,
+                             "max", stats->max,
+                             "p50", stats->p50,
+                             "p90", stats->p90,
+                             "p99", stats->p99))
+        || json_object_set_new (dict, stats->name, entry) < 0)
+        json_decref (entry);
+}
+
+/* Summarize callback latency histograms, if FLUX_CALLBACK_LATENCY is set.
+ * Returns NULL if there is nothing to report.
+ */
+static json_t *latency_stats (flux_t *h)
+{
+    json_t *watchers;
+    json_t *handlers;
+    json_t *o = NULL;
+    int nwatchers;
+    int nhandlers;
+
+    if (!(watchers = json_object ())
+        || !(handlers = json_object ())) {
+        json_decref (watchers);
+        return NULL;
+    }
+    nwatchers = flux_reactor_latency_foreach (flux_get_reactor (h),
+                                              latency_append,
+                                              watchers);
+    nhandlers = flux_msg_handler_latency_foreach (h,
+                                                  latency_append,
+                                                  handlers);
+    if (nwatchers > 0 || nhandlers > 0) {
+        o = json_pack ("{s:O s:O}",
+                       "watchers", watchers,
+                       "handlers", handlers);
+    }
+    json_decref (watchers);
+    json_decref (handlers);
+    return o;
+}
+
+static void trace_append (const struct flux_trace_span *span, void *arg)
+{
+    json_t *a = arg;
+    json_t *entry;
+    char trace_id[17];
+    char span_id[17];
+    char parent_id[17];
+
+    snprintf (trace_id, sizeof (trace_id), "%016" PRIx64, span->trace_id);
+    snprintf (span_id, sizeof (span_id), "%016" PRIx64, span->span_id);
+    snprintf (parent_id, sizeof (parent_id), "%016" PRIx64, span->parent_id);
+    if (!(entry = json_pack ("{s:s s:s s:s s:s s:f s:f}",
+                             "trace_id", trace_id,
+                             "span_id", span_id,
+                             "parent_id", parent_id,
+                             "topic", span->topic,
+                             "start", span->start,
+                             "duration", span->duration))
+        || json_array_append_new (a, entry) < 0)
+        json_decref (entry);
+}
+
+/* List recent spans of traced requests, if any.
+ * Returns NULL if there is nothing to report.
+ */
+static json_t *trace_stats (flux_t *h)
+{
+    json_t *a;
+
+    if (!(a = json_array ()))
+        return NULL;
+    if (flux_msg_handler_trace_foreach (h, trace_append, a) <= 0) {
+        json_decref (a);
+        return NULL;
+    }
+    return a;
+}
+
 void method_stats_get_cb (flux_t *h,
                           flux_msg_handler_t *mh,
                           const flux_msg_t *msg,
                           void *arg)
 {
     flux_msgcounters_t mcs;
+    struct flux_msg_pool_stats pool;
+    int depth;
+    uint64_t wakeups;
+    json_t *recvq = NULL;
+    json_t *latency = NULL;
+    json_t *trace = NULL;
 
     if (flux_request_decode (msg, NULL, NULL) < 0)
         goto error;
     flux_get_msgcounters (h, &mcs);
+    latency = latency_stats (h);
+    trace = trace_stats (h);
+    flux_msg_pool_get_stats (&pool);
+    /* Only some connectors, e.g. interthread, track receive queue stats.
+     */
+    if (flux_opt_get (h, FLUX_OPT_RECV_QUEUE_DEPTH, &depth, sizeof (depth)) == 0
+        && flux_opt_get (h,
+                         FLUX_OPT_RECV_QUEUE_WAKEUPS,
+                         &wakeups,
+                         sizeof (wakeups)) == 0) {
+        if (!(recvq = json_pack ("{s:i s:I}",
+                                 "depth", depth,
+                                 "wakeups", (json_int_t)wakeups)))
+            goto nomem;
+    }
     if (flux_respond_pack (h,
                            msg,
-                           "{s:{s:i s:i s:i s:i} s:{s:i s:i s:i s:i}}",
+                           "{s:{s:i s:i s:i s:i} s:{s:i s:i s:i s:i}"
+                           " s:{s:I s:I s:I s:I} s?o s?o s?o}",
                            "tx",
                              "request", mcs.request_tx,
                              "response", mcs.response_tx,
@@ -176,9 +296,21 @@ void method_stats_get_cb (flux_t *h,
                              "request", mcs.request_rx,
                              "response", mcs.response_rx,
                              "event", mcs.event_rx,
-                             "control", mcs.control_rx) < 0)
+                             "control", mcs.control_rx,
+                           "msgpool",
+                             "msg-hit", (json_int_t)pool.msg_hit,
+                             "msg-miss", (json_int_t)pool.msg_miss,
+                             "buf-hit", (json_int_t)pool.buf_hit,
+                             "buf-miss", (json_int_t)pool.buf_miss,
+                           "recvq", recvq,
+                           "latency", latency,
+                           "trace", trace) < 0)
         flux_log_error (h, "error responding to stats-get request");
     return;
+nomem:
+    json_decref (latency);
+    json_decref (trace);
+    errno = ENOMEM;
 error:
     if (flux_respond_error (h, msg, errno, NULL) < 0)
         flux_log_error (h, "error responding to stats-get request");
@@ -192,6 +324,9 @@ void method_stats_clear_cb (flux_t *h,
     if (flux_request_decode (msg, NULL, NULL) < 0)
         goto error;
     flux_clr_msgcounters (h);
+    flux_reactor_latency_clear (flux_get_reactor (h));
+    flux_msg_handler_latency_clear (h);
+    flux_msg_handler_trace_clear (h);
     if (flux_respond (h, msg, NULL) < 0)
         flux_log_error (h, "error responding to stats-clear request");
     return;
@@ -205,8 +340,12 @@ void method_stats_clear_event_cb (flux_t *h,
                                   const flux_msg_t *msg,
                                   void *arg)
 {
-    if (flux_event_decode (msg, NULL, NULL) == 0)
+    if (flux_event_decode (msg, NULL, NULL) == 0) {
         flux_clr_msgcounters (h);
+        flux_reactor_latency_clear (flux_get_reactor (h));
+        flux_msg_handler_latency_clear (h);
+        flux_msg_handler_trace_clear (h);
+    }
 }
 
 // vi:ts=4 sw=4 expandtab
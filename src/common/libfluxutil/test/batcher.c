@@ -0,0 +1,167 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <errno.h>
+#include <jansson.h>
+#include <flux/core.h>
+
+#include "src/common/libtap/tap.h"
+#include "src/common/libfluxutil/batcher.h"
+
+static int calls;
+static double t_start[8];
+static int inflight;
+
+static void commit_cb (struct batcher *b, void *arg)
+{
+    calls++;
+    if (inflight < 8)
+        t_start[inflight++] = batcher_commit_start (b);
+}
+
+static void finish_all (struct batcher *b)
+{
+    while (inflight > 0)
+        batcher_commit_finish (b, t_start[--inflight]);
+}
+
+void test_badargs (flux_reactor_t *r)
+{
+    struct batcher *b;
+
+    errno = 0;
+    ok (batcher_create (NULL, commit_cb, NULL) == NULL && errno == EINVAL,
+        "batcher_create r=NULL fails with EINVAL");
+    errno = 0;
+    ok (batcher_create (r, NULL, NULL) == NULL && errno == EINVAL,
+        "batcher_create cb=NULL fails with EINVAL");
+
+    if (!(b = batcher_create (r, commit_cb, NULL)))
+        BAIL_OUT ("batcher_create failed");
+    errno = 0;
+    ok (batcher_set_delay (b, -1.) < 0 && errno == EINVAL,
+        "batcher_set_delay -1 fails with EINVAL");
+    batcher_destroy (b);
+
+    lives_ok ({batcher_destroy (NULL);},
+        "batcher_destroy b=NULL doesn't crash");
+}
+
+void test_adaptive (flux_reactor_t *r)
+{
+    struct batcher *b;
+    json_t *o;
+    int size_count, latency_count;
+    double max;
+
+    calls = 0;
+    if (!(b = batcher_create (r, commit_cb, NULL)))
+        BAIL_OUT ("batcher_create failed");
+
+    batcher_add (b, 1, 10);
+    ok (flux_reactor_run (r, 0) >= 0 && calls == 1,
+        "idle batcher commits on the next loop iteration");
+
+    batcher_add (b, 1, 10);
+    batcher_add (b, 1, 10);
+    batcher_add (b, 1, 10);
+    ok (flux_reactor_run (r, 0) >= 0 && calls == 1,
+        "batch is held while a commit is in flight");
+    finish_all (b);
+    ok (flux_reactor_run (r, 0) >= 0 && calls == 2,
+        "batch is committed when the commit in flight completes");
+
+    batcher_set_limits (b, 2, 0);
+    batcher_add (b, 1, 10);
+    ok (flux_reactor_run (r, 0) >= 0 && calls == 2,
+        "batch below count limit is held while a commit is in flight");
+    batcher_add (b, 1, 10);
+    ok (flux_reactor_run (r, 0) >= 0 && calls == 3,
+        "batch at count limit is committed with a commit in flight");
+    finish_all (b);
+
+    batcher_set_limits (b, 0, 100);
+    batcher_add (b, 1, 10);
+    ok (flux_reactor_run (r, 0) >= 0 && calls == 4,
+        "idle batcher commits on the next loop iteration");
+    batcher_add (b, 1, 100);
+    ok (flux_reactor_run (r, 0) >= 0 && calls == 5,
+        "batch at size limit is committed with a commit in flight");
+    finish_all (b);
+
+    batcher_add (b, 1, 10);
+    batcher_reset (b);
+    ok (flux_reactor_run (r, 0) >= 0 && calls == 5,
+        "batcher_reset cancels the pending commit");
+
+    if (!(o = batcher_stats (b)))
+        BAIL_OUT ("batcher_stats failed");
+    ok (json_unpack (o,
+                     "{s:{s:i s:f} s:{s:i}}",
+                     "batch-size",
+                       "count", &size_count,
+                       "max", &max,
+                     "commit-usec",
+                       "count", &latency_count) == 0,
+        "batcher_stats works");
+    ok (size_count == 5 && latency_count == 5 && max == 3,
+        "batcher_stats reports 5 commits with a largest batch of 3");
+    json_decref (o);
+
+    batcher_destroy (b);
+}
+
+void test_delay (flux_reactor_t *r)
+{
+    struct batcher *b;
+    double t0;
+
+    calls = 0;
+    if (!(b = batcher_create (r, commit_cb, NULL)))
+        BAIL_OUT ("batcher_create failed");
+    ok (batcher_set_delay (b, 0.05) == 0 && batcher_get_delay (b) == 0.05,
+        "batcher_set_delay 0.05 works");
+
+    flux_reactor_now_update (r);
+    t0 = flux_reactor_now (r);
+    batcher_add (b, 1, 10);
+    ok (flux_reactor_run (r, 0) >= 0 && calls == 1,
+        "batch with fixed delay is committed");
+    flux_reactor_now_update (r);
+    ok (flux_reactor_now (r) - t0 >= 0.05,
+        "batch was committed after the fixed delay");
+    finish_all (b);
+
+    batcher_destroy (b);
+}
+
+int main (int argc, char *argv[])
+{
+    flux_reactor_t *r;
+
+    plan (NO_PLAN);
+
+    if (!(r = flux_reactor_create (0)))
+        BAIL_OUT ("flux_reactor_create failed");
+
+    test_badargs (r);
+    test_adaptive (r);
+    test_delay (r);
+
+    flux_reactor_destroy (r);
+
+    done_testing ();
+    return (0);
+}
+
+// vi: ts=4 sw=4 expandtab
@@ -57,6 +57,28 @@ struct current {
     int depth;
 };
 
+/* Build a hostname index after this many hostlist_find() calls on an
+ * unmodified hostlist with at least this many ranges.  Below that, the
+ * linear scan is cheaper than expanding every host into the index.
+ */
+#define INDEX_FIND_THRESHOLD 4
+#define INDEX_MIN_RANGES 8
+
+struct index_entry {
+    char *host;
+    int pos;                /* position of host in the hostlist */
+    int index;              /* hostrange containing host */
+    int depth;              /* offset of host in hostrange */
+};
+
+/* Open addressing hash of expanded hostnames, built lazily by
+ * hostlist_find() and dropped whenever the hostlist is modified.
+ */
+struct hostindex {
+    struct index_entry *entries;
+    size_t size;            /* power of 2 */
+};
+
 /* Hostlist - a dynamic array of hostrange objects
  */
 struct hostlist {
@@ -66,6 +88,9 @@ struct hostlist {
     struct hostrange **hr;  /* pointer to hostrange array */
 
     struct current current; /* iterator cursor */
+
+    struct hostindex *index;
+    int nfind;              /* finds since last modification */
 };
 
 /* _range struct helper for parsing hostlist strings
@@ -120,6 +145,84 @@ static char * next_tok (char *sep, char **str)
 }
 
 
+static size_t hash_host (const char *s)
+{
+    size_t h = 2166136261u;     /* FNV-1a */
+    while (*s) {
+        h ^= (unsigned char) *s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static void hostindex_destroy (struct hostindex *idx)
+{
+    if (idx) {
+        for (size_t i = 0; i < idx->size; i++)
+            free (idx->entries[i].host);
+        free (idx->entries);
+        free (idx);
+    }
+}
+
+/* Drop the index.  Call this before any change to the hostlist.
+ */
+static void hostlist_invalidate (struct hostlist *hl)
+{
+    hostindex_destroy (hl->index);
+    hl->index = NULL;
+    hl->nfind = 0;
+}
+
+static struct index_entry *hostindex_slot (struct hostindex *idx,
+                                           const char *host)
+{
+    size_t i = hash_host (host) & (idx->size - 1);
+    while (idx->entries[i].host && strcmp (idx->entries[i].host, host) != 0)
+        i = (i + 1) & (idx->size - 1);
+    return &idx->entries[i];
+}
+
+/* Index every host in 'hl' by its expanded name.  If a name occurs more
+ * than once, keep the first position, as the linear search would find.
+ */
+static struct hostindex *hostindex_create (struct hostlist *hl)
+{
+    struct hostindex *idx;
+    int pos = 0;
+
+    if (!(idx = calloc (1, sizeof (*idx))))
+        return NULL;
+    idx->size = 16;
+    while (idx->size < (size_t) hl->nhosts * 2)
+        idx->size <<= 1;
+    if (!(idx->entries = calloc (idx->size, sizeof (idx->entries[0]))))
+        goto error;
+    for (int i = 0; i < hl->nranges; i++) {
+        int count = hostrange_count (hl->hr[i]);
+        for (int depth = 0; depth < count; depth++, pos++) {
+            struct index_entry *e;
+            char *host;
+
+            if (!(host = hostrange_host_tostring (hl->hr[i], depth)))
+                goto error;
+            e = hostindex_slot (idx, host);
+            if (e->host) {
+                free (host);
+                continue;
+            }
+            e->host = host;
+            e->pos = pos;
+            e->index = i;
+            e->depth = depth;
+        }
+    }
+    return idx;
+error:
+    hostindex_destroy (idx);
+    return NULL;
+}
+
 struct hostlist * hostlist_create (void)
 {
     struct hostlist * new = calloc (1, sizeof (*new));
@@ -185,6 +288,7 @@ static int hostlist_append_range (struct hostlist *hl, struct hostrange * hr)
 
     assert (hr != NULL);
 
+    hostlist_invalidate (hl);
     tail = (hl->nranges > 0) ? hl->hr[hl->nranges-1] : hl->hr[0];
 
     if (hl->size == hl->nranges && !hostlist_expand (hl))
@@ -245,6 +349,8 @@ static int hostlist_insert_range (struct hostlist *hl,
     if (hl->size == hl->nranges && !hostlist_expand (hl))
         return 0;
 
+    hostlist_invalidate (hl);
+
     /* copy new hostrange into slot "n" in array */
     tmp = hl->hr[n];
     hl->hr[n] = hostrange_copy (hr);
@@ -315,6 +421,7 @@ static void hostlist_delete_range (struct hostlist *hl, int n)
     assert (hl != NULL);
     assert (n < hl->nranges && n >= 0);
 
+    hostlist_invalidate (hl);
     old = hl->hr[n];
     for (i = n; i < hl->nranges - 1; i++)
         hl->hr[i] = hl->hr[i + 1];
@@ -598,6 +705,7 @@ void hostlist_destroy (struct hostlist *hl)
             hostrange_destroy (hl->hr[i]);
         free (hl->hr);
         free (hl->current.host);
+        hostindex_destroy (hl->index);
         free (hl);
         errno = saved_errno;
     }
@@ -717,11 +825,32 @@ static int hostlist_find_host (struct hostlist *hl,
 
 int hostlist_find (struct hostlist *hl, const char *hostname)
 {
+    int pos;
+
     if (!hl || !hostname) {
         errno = EINVAL;
         return -1;
     }
-    return hostlist_find_host (hl, hostname, &hl->current);
+    if (!hl->index
+        && hl->nranges >= INDEX_MIN_RANGES
+        && ++hl->nfind >= INDEX_FIND_THRESHOLD)
+        hl->index = hostindex_create (hl); // on failure, fall back to scan
+    if (hl->index) {
+        struct index_entry *e = hostindex_slot (hl->index, hostname);
+        if (e->host) {
+            set_current (&hl->current, e->index, e->depth);
+            return e->pos;
+        }
+    }
+    /*  Not every name that matches a hostrange is its canonical expansion,
+     *   e.g. when zero padding is ambiguous, so a miss must still be
+     *   confirmed by a scan.  A match may have adjusted a hostrange's
+     *   width, so drop the index in that case.
+     */
+    pos = hostlist_find_host (hl, hostname, &hl->current);
+    if (pos >= 0 && hl->index)
+        hostlist_invalidate (hl);
+    return pos;
 }
 
 /*  Remove host at cursor 'cur'. If the current real cursor hl->current
@@ -735,6 +864,7 @@ static int hostlist_remove_at (struct hostlist *hl, struct current *cur)
     if (cur->index > hl->nhosts - 1)
         return 0;
 
+    hostlist_invalidate (hl);
     hr = hl->hr[cur->index];
 
     /*  If we're removing the current host, invalidate cursor hostname
@@ -928,6 +1058,7 @@ void hostlist_sort (struct hostlist *hl)
         return;
     if (hl->nranges <= 1)
         return;
+    hostlist_invalidate (hl);
     qsort (hl->hr, hl->nranges, sizeof (struct hostrange *), _cmp);
     hostlist_coalesce (hl);
 }
@@ -959,6 +1090,7 @@ void hostlist_uniq (struct hostlist *hl)
     if (hl->nranges <= 1)
         return;
 
+    hostlist_invalidate (hl);
     qsort (hl->hr, hl->nranges, sizeof (struct hostrange *), &_cmp);
 
     while (i < hl->nranges) {
@@ -1058,6 +1190,51 @@ fail:
     return NULL;
 }
 
+char *hostlist_join (struct hostlist *hl, char sep)
+{
+    int saved_errno;
+    char *result = NULL;
+    size_t len;
+    FILE *fp;
+    int i;
+    unsigned long j;
+
+    if (hl == NULL) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(fp = open_memstream (&result, &len)))
+        goto fail;
+    for (i = 0; i < hl->nranges; i++) {
+        unsigned long n = hostrange_count (hl->hr[i]);
+        for (j = 0; j < n; j++) {
+            char *host;
+            int rc;
+
+            if ((i > 0 || j > 0) && fputc (sep, fp) == EOF)
+                goto fail;
+            if (!(host = hostrange_host_tostring (hl->hr[i], j)))
+                goto fail;
+            rc = fputs (host, fp);
+            free (host);
+            if (rc == EOF)
+                goto fail;
+        }
+    }
+    if (fclose (fp) < 0) {
+        fp = NULL;
+        goto fail;
+    }
+    return result;
+fail:
+    saved_errno = errno;
+    if (fp)
+        fclose (fp);
+    free (result);
+    errno = saved_errno;
+    return NULL;
+}
+
 static struct hostrange * hr_current (struct hostlist *hl)
 {
     assert (hl != NULL);
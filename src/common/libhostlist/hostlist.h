@@ -32,6 +32,14 @@ struct hostlist *hostlist_decode (const char *s);
  */
 char *hostlist_encode (struct hostlist *hl);
 
+/*
+ *  Return all hosts in 'hl' in order, separated by 'sep', as one string
+ *   which the caller must free.  This lets language bindings expand a
+ *   hostlist in one call instead of one call per host.  The cursor is
+ *   not affected.  Returns NULL on failure with errno set.
+ */
+char *hostlist_join (struct hostlist *hl, char sep);
+
 /*
  *  Copy a hostlist
  */
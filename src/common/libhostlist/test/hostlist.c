@@ -12,6 +12,7 @@
 #include "config.h"
 #endif
 
+#include <stdio.h>
 #include <string.h>
 #include <errno.h>
 
@@ -343,6 +344,64 @@ void test_find ()
     }
 }
 
+/*  Repeat the find tests on hostlists with enough ranges that lookups
+ *   go through the hostname index.
+ */
+void test_find_indexed ()
+{
+    struct find_test *t = find_tests;
+
+    while (t && t->input) {
+        struct hostlist *hl = hostlist_decode (t->input);
+        int errors = 0;
+        if (!hl || hostlist_append (hl, "zz[1,3,5,7,9,11,13,15,17]") < 0)
+            BAIL_OUT ("hostlist_decode (%s) failed!", t->input);
+        for (int i = 0; i < 10; i++) {
+            if (hostlist_find (hl, t->arg) != t->rc
+                || (t->rc >= 0 && strcmp (hostlist_current (hl), t->arg) != 0))
+                errors++;
+        }
+        ok (errors == 0,
+            "repeated hostlist_find ('%s,zz[...]', '%s') returned %d",
+            t->input, t->arg, t->rc);
+        hostlist_destroy (hl);
+        t++;
+    }
+}
+
+void test_find_large ()
+{
+    struct hostlist *hl = hostlist_create ();
+    char host[64];
+    int errors = 0;
+
+    if (!hl)
+        BAIL_OUT ("hostlist_create failed");
+    for (int i = 0; i < 10000; i += 2) {
+        snprintf (host, sizeof (host), "node%d", i);
+        if (hostlist_append (hl, host) < 0)
+            BAIL_OUT ("hostlist_append failed");
+    }
+    for (int i = 0; i < 10000; i++) {
+        snprintf (host, sizeof (host), "node%d", i);
+        if (hostlist_find (hl, host) != (i % 2 ? -1 : i / 2))
+            errors++;
+    }
+    ok (errors == 0,
+        "hostlist_find works on 5000 ranges");
+    ok (hostlist_delete (hl, "node[0-99]") == 50,
+        "deleted 50 hosts");
+    errors = 0;
+    for (int i = 0; i < 10000; i += 2) {
+        snprintf (host, sizeof (host), "node%d", i);
+        if (hostlist_find (hl, host) != (i < 100 ? -1 : i / 2 - 50))
+            errors++;
+    }
+    ok (errors == 0,
+        "hostlist_find works after hostlist is modified");
+    hostlist_destroy (hl);
+}
+
 struct delete_test {
     char *input;
     char *delete;
@@ -604,6 +663,37 @@ static void test_encode_large ()
     hostlist_destroy (hl);
 }
 
+static void test_join ()
+{
+    struct hostlist *hl;
+    const char *cur;
+    char *s;
+
+    errno = 0;
+    ok (hostlist_join (NULL, ',') == NULL && errno == EINVAL,
+        "hostlist_join (NULL) returns EINVAL");
+
+    if (!(hl = hostlist_create ()))
+        BAIL_OUT ("hostlist_create");
+    s = hostlist_join (hl, ',');
+    ok (s && strcmp (s, "") == 0,
+        "hostlist_join of empty hostlist returns empty string");
+    free (s);
+    hostlist_destroy (hl);
+
+    if (!(hl = hostlist_decode ("foo[1-3,07],bar")))
+        BAIL_OUT ("hostlist_decode");
+    hostlist_nth (hl, 1);
+    s = hostlist_join (hl, '\n');
+    ok (s && strcmp (s, "foo1\nfoo2\nfoo3\nfoo07\nbar") == 0,
+        "hostlist_join works");
+    free (s);
+    cur = hostlist_current (hl);
+    ok (cur && strcmp (cur, "foo2") == 0,
+        "hostlist_join does not move the cursor");
+    hostlist_destroy (hl);
+}
+
 int main (int argc, char *argv[])
 {
     plan (NO_PLAN);
@@ -616,11 +706,14 @@ int main (int argc, char *argv[])
     test_append ();
     test_nth ();
     test_find ();
+    test_find_indexed ();
+    test_find_large ();
     test_delete ();
     test_sortuniq ();
     test_iteration ();
     test_iteration_with_delete ();
     test_encode_large ();
+    test_join ();
 
     done_testing ();
 }
@@ -329,6 +329,73 @@ bool idset_test (const struct idset *idset, unsigned int id)
     return (vebsucc (idset->T, id) == id);
 }
 
+int idset_set_array (struct idset *idset,
+                     const unsigned int *ids,
+                     size_t count)
+{
+    unsigned int max = 0;
+    size_t i;
+
+    if (!idset || (count > 0 && !ids)) {
+        errno = EINVAL;
+        return -1;
+    }
+    for (i = 0; i < count; i++) {
+        if (!valid_id (ids[i])) {
+            errno = EINVAL;
+            return -1;
+        }
+        if (ids[i] > max)
+            max = ids[i];
+    }
+    /* Grow once up front rather than doubling repeatedly in idset_set().
+     */
+    if (count > 0
+        && max >= idset_universe_size (idset)
+        && !(idset->flags & IDSET_FLAG_INITFULL)
+        && idset_grow (idset, (size_t)max + 1) < 0)
+        return -1;
+    for (i = 0; i < count; i++) {
+        if (idset_set (idset, ids[i]) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+size_t idset_test_array (const struct idset *idset,
+                         const unsigned int *ids,
+                         bool *result,
+                         size_t count)
+{
+    size_t found = 0;
+    size_t i;
+
+    if (!ids || !result)
+        return 0;
+    for (i = 0; i < count; i++) {
+        if ((result[i] = idset_test (idset, ids[i])))
+            found++;
+    }
+    return found;
+}
+
+size_t idset_to_array (const struct idset *idset,
+                       unsigned int *ids,
+                       size_t size)
+{
+    size_t n = 0;
+    unsigned int id;
+
+    if (!idset || !ids)
+        return 0;
+    id = vebsucc (idset->T, 0);
+    while (n < size && id < idset->T.M) {
+        ids[n++] = id;
+        id = vebsucc (idset->T, id + 1);
+    }
+    return n;
+}
+
 unsigned int idset_first (const struct idset *idset)
 {
     unsigned int next = IDSET_INVALID_ID;
@@ -447,18 +514,30 @@ bool idset_equal (const struct idset *idset1,
     return true;
 }
 
-bool idset_has_intersection (const struct idset *a, const struct idset *b)
+/* Find the first id >= 'id' that is in both 'a' and 'b' by alternately
+ * advancing each set to the other's successor.  Gaps in either set are
+ * skipped in a single vebsucc() call, so walking the intersection costs
+ * in proportion to the number of alternations rather than to the size
+ * of the sets.  Return IDSET_INVALID_ID if there is no such id.
+ */
+static unsigned int common_succ (const struct idset *a,
+                                 const struct idset *b,
+                                 unsigned int id)
 {
-    if (a && b) {
-        unsigned int id;
-
-        id = idset_first (b);
-        while (id != IDSET_INVALID_ID) {
-            if (idset_test (a, id))
-                return true;
-            id = idset_next (b, id);
-        }
+    while (id < a->T.M && id < b->T.M) {
+        unsigned int x = vebsucc (a->T, id);
+        if (x >= a->T.M || x >= b->T.M)
+            break;
+        if ((id = vebsucc (b->T, x)) == x)
+            return x;
     }
+    return IDSET_INVALID_ID;
+}
+
+bool idset_has_intersection (const struct idset *a, const struct idset *b)
+{
+    if (a && b)
+        return common_succ (a, b, 0) != IDSET_INVALID_ID;
     return false;
 }
 
@@ -506,6 +585,17 @@ int idset_subtract (struct idset *a, const struct idset *b)
     if (b) {
         unsigned int id;
 
+        /* Unless 'a' implicitly contains ids beyond its universe, only
+         * ids in both sets need to be cleared.
+         */
+        if (!(a->flags & IDSET_FLAG_INITFULL)) {
+            id = common_succ (a, b, 0);
+            while (id != IDSET_INVALID_ID) {
+                idset_del_nocheck (a, id);
+                id = common_succ (a, b, id + 1);
+            }
+            return 0;
+        }
         id = idset_first (b);
         while (id != IDSET_INVALID_ID) {
             if (idset_clear (a, id) < 0)
@@ -542,15 +632,23 @@ struct idset *idset_intersect (const struct idset *a, const struct idset *b)
         errno = EINVAL;
         return NULL;
     }
-    if (!(result = idset_copy (a)))
+    /* Start from an empty set with the universe and flags of 'a' and add
+     * only the common ids, rather than copying 'a' and clearing the rest.
+     */
+    if (!(result = malloc (sizeof (*result))))
+        return NULL;
+    result->flags = a->flags;
+    result->count = 0;
+    result->T = vebnew (a->T.M, 0);
+    if (!result->T.D) {
+        free (result);
+        errno = ENOMEM;
         return NULL;
-    id = idset_first (a);
+    }
+    id = common_succ (a, b, 0);
     while (id != IDSET_INVALID_ID) {
-        if (!idset_test (b, id) && idset_clear (result, id) < 0) {
-            idset_destroy (result);
-            return NULL;
-        }
-        id = idset_next (a, id);
+        idset_put_nocheck (result, id);
+        id = common_succ (a, b, id + 1);
     }
     return result;
 }
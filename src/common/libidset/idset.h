@@ -150,6 +150,28 @@ int idset_range_clear (struct idset *idset, unsigned int lo, unsigned int hi);
  */
 bool idset_test (const struct idset *idset, unsigned int id);
 
+/* Bulk versions of idset_set() and idset_test() for language bindings,
+ * which would otherwise pay a call per id.
+ * idset_set_array() adds 'count' ids from 'ids', growing the idset at
+ * most once.  Return 0 on success, -1 on failure with errno set.
+ * idset_test_array() sets result[i] to idset_test (idset, ids[i]) and
+ * returns the number of ids that are members.
+ */
+int idset_set_array (struct idset *idset,
+                     const unsigned int *ids,
+                     size_t count);
+size_t idset_test_array (const struct idset *idset,
+                         const unsigned int *ids,
+                         bool *result,
+                         size_t count);
+
+/* Copy up to 'size' ids from idset to 'ids' in ascending order.
+ * Return the number of ids copied, or 0 if idset or ids is invalid.
+ */
+size_t idset_to_array (const struct idset *idset,
+                       unsigned int *ids,
+                       size_t size);
+
 /* Return the first id in the idset.
  * Returns IDSET_INVALID_ID if the idset is empty.
  */
@@ -0,0 +1,940 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <ctype.h>
+
+#include "idset.h"
+#include "idset_private.h"
+#include "idset64.h"
+
+#define CHUNK_SHIFT     16
+#define CHUNK_MASK      0xffff
+#define ARRAY_MAX       4096
+#define BITMAP_WORDS    1024
+
+/* A chunk stores either a sorted 'array' of 'card' offsets, or a 'bitmap'
+ * of BITMAP_WORDS words with 'card' bits set.  Exactly one is non-NULL.
+ */
+struct chunk {
+    uint64_t key;
+    uint32_t card;
+    uint32_t size;
+    uint16_t *array;
+    uint64_t *bitmap;
+};
+
+struct idset64 {
+    struct chunk *chunks;   // sorted by key
+    size_t n;
+    size_t alloc;
+    size_t count;
+};
+
+static void chunk_free (struct chunk *c)
+{
+    free (c->array);
+    free (c->bitmap);
+    c->array = NULL;
+    c->bitmap = NULL;
+}
+
+/* Return the index of the first array element >= off.
+ */
+static uint32_t array_lower_bound (const struct chunk *c, uint32_t off)
+{
+    uint32_t lo = 0;
+    uint32_t hi = c->card;
+
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (c->array[mid] < off)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static int chunk_to_bitmap (struct chunk *c)
+{
+    uint64_t *bitmap;
+
+    if (!(bitmap = calloc (BITMAP_WORDS, sizeof (bitmap[0]))))
+        return -1;
+    for (uint32_t i = 0; i < c->card; i++)
+        bitmap[c->array[i] >> 6] |= UINT64_C(1) << (c->array[i] & 63);
+    free (c->array);
+    c->array = NULL;
+    c->size = 0;
+    c->bitmap = bitmap;
+    return 0;
+}
+
+/* Convert back to an array once the bitmap is sparse enough.  Half of
+ * ARRAY_MAX is used so that a chunk hovering at the threshold does not
+ * flip representation on every call.  Failure is harmless.
+ */
+static void chunk_maybe_to_array (struct chunk *c)
+{
+    uint16_t *array;
+    uint32_t n = 0;
+
+    if (!c->bitmap || c->card > ARRAY_MAX / 2)
+        return;
+    if (!(array = malloc (sizeof (array[0]) * (c->card ? c->card : 1))))
+        return;
+    for (uint32_t i = 0; i < BITMAP_WORDS; i++) {
+        uint64_t w = c->bitmap[i];
+        while (w) {
+            array[n++] = (i << 6) | __builtin_ctzll (w);
+            w &= w - 1;
+        }
+    }
+    free (c->bitmap);
+    c->bitmap = NULL;
+    c->array = array;
+    c->size = c->card ? c->card : 1;
+}
+
+static bool chunk_test (const struct chunk *c, uint32_t off)
+{
+    uint32_t i;
+
+    if (c->bitmap)
+        return c->bitmap[off >> 6] & (UINT64_C(1) << (off & 63));
+    i = array_lower_bound (c, off);
+    return i < c->card && c->array[i] == off;
+}
+
+/* Return 1 if 'off' was added, 0 if it was already present,
+ * or -1 on failure.
+ */
+static int chunk_set (struct chunk *c, uint32_t off)
+{
+    uint32_t i;
+
+    if (!c->bitmap) {
+        i = array_lower_bound (c, off);
+        if (i < c->card && c->array[i] == off)
+            return 0;
+        if (c->card < ARRAY_MAX) {
+            if (c->card == c->size) {
+                uint32_t nsize = c->size ? c->size * 2 : 4;
+                uint16_t *p;
+                if (!(p = realloc (c->array, sizeof (p[0]) * nsize)))
+                    return -1;
+                c->array = p;
+                c->size = nsize;
+            }
+            memmove (&c->array[i + 1],
+                     &c->array[i],
+                     sizeof (c->array[0]) * (c->card - i));
+            c->array[i] = off;
+            c->card++;
+            return 1;
+        }
+        if (chunk_to_bitmap (c) < 0)
+            return -1;
+    }
+    if (chunk_test (c, off))
+        return 0;
+    c->bitmap[off >> 6] |= UINT64_C(1) << (off & 63);
+    c->card++;
+    return 1;
+}
+
+/* Return 1 if 'off' was removed, 0 if it was not present.
+ */
+static int chunk_clear (struct chunk *c, uint32_t off)
+{
+    uint32_t i;
+
+    if (c->bitmap) {
+        if (!chunk_test (c, off))
+            return 0;
+        c->bitmap[off >> 6] &= ~(UINT64_C(1) << (off & 63));
+        c->card--;
+        chunk_maybe_to_array (c);
+        return 1;
+    }
+    i = array_lower_bound (c, off);
+    if (i == c->card || c->array[i] != off)
+        return 0;
+    memmove (&c->array[i],
+             &c->array[i + 1],
+             sizeof (c->array[0]) * (c->card - i - 1));
+    c->card--;
+    return 1;
+}
+
+/* Find the first run of consecutive offsets starting at or after 'from'.
+ * Return false if there is none.
+ */
+static bool chunk_next_run (const struct chunk *c,
+                            uint32_t from,
+                            uint32_t *lop,
+                            uint32_t *hip)
+{
+    uint32_t lo, hi;
+
+    if (from > CHUNK_MASK)
+        return false;
+    if (c->bitmap) {
+        uint32_t i = from >> 6;
+        uint64_t w = c->bitmap[i] & (~UINT64_C(0) << (from & 63));
+
+        while (w == 0) {
+            if (++i == BITMAP_WORDS)
+                return false;
+            w = c->bitmap[i];
+        }
+        lo = (i << 6) | __builtin_ctzll (w);
+
+        /* Now look for the first clear bit after lo.
+         */
+        w = ~c->bitmap[i] & (~UINT64_C(0) << (lo & 63));
+        while (w == 0) {
+            if (++i == BITMAP_WORDS)
+                break;
+            w = ~c->bitmap[i];
+        }
+        hi = i == BITMAP_WORDS ? CHUNK_MASK
+                               : ((i << 6) | __builtin_ctzll (w)) - 1;
+    }
+    else {
+        uint32_t i = array_lower_bound (c, from);
+        if (i == c->card)
+            return false;
+        lo = hi = c->array[i];
+        while (i + 1 < c->card && c->array[i + 1] == hi + 1) {
+            hi++;
+            i++;
+        }
+    }
+    *lop = lo;
+    *hip = hi;
+    return true;
+}
+
+static int chunk_copy (struct chunk *dst, const struct chunk *src)
+{
+    memset (dst, 0, sizeof (*dst));
+    dst->key = src->key;
+    dst->card = src->card;
+    if (src->bitmap) {
+        if (!(dst->bitmap = malloc (sizeof (uint64_t) * BITMAP_WORDS)))
+            return -1;
+        memcpy (dst->bitmap, src->bitmap, sizeof (uint64_t) * BITMAP_WORDS);
+    }
+    else {
+        dst->size = src->card ? src->card : 1;
+        if (!(dst->array = malloc (sizeof (uint16_t) * dst->size)))
+            return -1;
+        memcpy (dst->array, src->array, sizeof (uint16_t) * src->card);
+    }
+    return 0;
+}
+
+static uint32_t bitmap_count (const uint64_t *bitmap)
+{
+    uint32_t count = 0;
+    for (int i = 0; i < BITMAP_WORDS; i++)
+        count += __builtin_popcountll (bitmap[i]);
+    return count;
+}
+
+/* Binary search for the chunk with 'key'.  Return its index, or -1 if
+ * not found, with the insertion point in 'posp'.
+ */
+static ssize_t find_chunk (const struct idset64 *set,
+                           uint64_t key,
+                           size_t *posp)
+{
+    size_t lo = 0;
+    size_t hi = set->n;
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (set->chunks[mid].key < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (posp)
+        *posp = lo;
+    if (lo < set->n && set->chunks[lo].key == key)
+        return lo;
+    return -1;
+}
+
+/* Return the chunk with 'key', inserting an empty one if necessary.
+ */
+static struct chunk *get_chunk (struct idset64 *set, uint64_t key)
+{
+    size_t pos;
+    ssize_t i;
+    struct chunk *c;
+
+    if ((i = find_chunk (set, key, &pos)) >= 0)
+        return &set->chunks[i];
+    if (set->n == set->alloc) {
+        size_t nalloc = set->alloc ? set->alloc * 2 : 8;
+        struct chunk *p;
+        if (!(p = realloc (set->chunks, sizeof (p[0]) * nalloc)))
+            return NULL;
+        set->chunks = p;
+        set->alloc = nalloc;
+    }
+    memmove (&set->chunks[pos + 1],
+             &set->chunks[pos],
+             sizeof (set->chunks[0]) * (set->n - pos));
+    set->n++;
+    c = &set->chunks[pos];
+    memset (c, 0, sizeof (*c));
+    c->key = key;
+    return c;
+}
+
+static void remove_chunk (struct idset64 *set, size_t i)
+{
+    chunk_free (&set->chunks[i]);
+    memmove (&set->chunks[i],
+             &set->chunks[i + 1],
+             sizeof (set->chunks[0]) * (set->n - i - 1));
+    set->n--;
+}
+
+struct idset64 *idset64_create (void)
+{
+    return calloc (1, sizeof (struct idset64));
+}
+
+void idset64_destroy (struct idset64 *set)
+{
+    if (set) {
+        int saved_errno = errno;
+        for (size_t i = 0; i < set->n; i++)
+            chunk_free (&set->chunks[i]);
+        free (set->chunks);
+        free (set);
+        errno = saved_errno;
+    }
+}
+
+struct idset64 *idset64_copy (const struct idset64 *set)
+{
+    struct idset64 *cpy;
+
+    if (!set) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(cpy = idset64_create ()))
+        return NULL;
+    if (set->n > 0) {
+        if (!(cpy->chunks = calloc (set->n, sizeof (cpy->chunks[0]))))
+            goto error;
+        cpy->alloc = set->n;
+        for (size_t i = 0; i < set->n; i++) {
+            if (chunk_copy (&cpy->chunks[i], &set->chunks[i]) < 0)
+                goto error;
+            cpy->n++;
+        }
+    }
+    cpy->count = set->count;
+    return cpy;
+error:
+    idset64_destroy (cpy);
+    errno = ENOMEM;
+    return NULL;
+}
+
+int idset64_set (struct idset64 *set, uint64_t id)
+{
+    struct chunk *c;
+    int rc;
+
+    if (!set || id == IDSET64_INVALID_ID) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!(c = get_chunk (set, id >> CHUNK_SHIFT))
+        || (rc = chunk_set (c, id & CHUNK_MASK)) < 0) {
+        errno = ENOMEM;
+        return -1;
+    }
+    set->count += rc;
+    return 0;
+}
+
+/* Set offsets [lo, hi] in chunk 'c'.  Return the number of ids added,
+ * or -1 on failure.
+ */
+static int chunk_range_set (struct chunk *c, uint32_t lo, uint32_t hi)
+{
+    uint32_t before = c->card;
+
+    if (!c->bitmap && c->card + (hi - lo + 1) > ARRAY_MAX) {
+        if (chunk_to_bitmap (c) < 0)
+            return -1;
+    }
+    if (c->bitmap) {
+        for (uint32_t i = lo >> 6; i <= hi >> 6; i++) {
+            uint64_t mask = ~UINT64_C(0);
+            if (i == lo >> 6)
+                mask &= ~UINT64_C(0) << (lo & 63);
+            if (i == hi >> 6 && (hi & 63) != 63)
+                mask &= ~(~UINT64_C(0) << ((hi & 63) + 1));
+            c->card += __builtin_popcountll (mask & ~c->bitmap[i]);
+            c->bitmap[i] |= mask;
+        }
+    }
+    else {
+        for (uint32_t off = lo; off <= hi; off++) {
+            if (chunk_set (c, off) < 0)
+                return -1;
+        }
+    }
+    return c->card - before;
+}
+
+int idset64_range_set (struct idset64 *set, uint64_t lo, uint64_t hi)
+{
+    if (!set || lo == IDSET64_INVALID_ID || hi == IDSET64_INVALID_ID) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (hi < lo) {
+        uint64_t tmp = hi;
+        hi = lo;
+        lo = tmp;
+    }
+    for (uint64_t key = lo >> CHUNK_SHIFT; key <= hi >> CHUNK_SHIFT; key++) {
+        uint32_t clo = key == lo >> CHUNK_SHIFT ? lo & CHUNK_MASK : 0;
+        uint32_t chi = key == hi >> CHUNK_SHIFT ? hi & CHUNK_MASK : CHUNK_MASK;
+        struct chunk *c;
+        int n;
+
+        if (!(c = get_chunk (set, key))
+            || (n = chunk_range_set (c, clo, chi)) < 0) {
+            errno = ENOMEM;
+            return -1;
+        }
+        set->count += n;
+    }
+    return 0;
+}
+
+int idset64_clear (struct idset64 *set, uint64_t id)
+{
+    ssize_t i;
+
+    if (!set || id == IDSET64_INVALID_ID) {
+        errno = EINVAL;
+        return -1;
+    }
+    if ((i = find_chunk (set, id >> CHUNK_SHIFT, NULL)) >= 0) {
+        set->count -= chunk_clear (&set->chunks[i], id & CHUNK_MASK);
+        if (set->chunks[i].card == 0)
+            remove_chunk (set, i);
+    }
+    return 0;
+}
+
+bool idset64_test (const struct idset64 *set, uint64_t id)
+{
+    ssize_t i;
+
+    if (!set || id == IDSET64_INVALID_ID)
+        return false;
+    if ((i = find_chunk (set, id >> CHUNK_SHIFT, NULL)) < 0)
+        return false;
+    return chunk_test (&set->chunks[i], id & CHUNK_MASK);
+}
+
+size_t idset64_count (const struct idset64 *set)
+{
+    return set ? set->count : 0;
+}
+
+/* Return the first id >= 'id', or IDSET64_INVALID_ID.
+ */
+static uint64_t succ (const struct idset64 *set, uint64_t id)
+{
+    size_t pos;
+    uint32_t lo, hi;
+
+    if (id == IDSET64_INVALID_ID)
+        return IDSET64_INVALID_ID;
+    if (find_chunk (set, id >> CHUNK_SHIFT, &pos) >= 0) {
+        if (chunk_next_run (&set->chunks[pos], id & CHUNK_MASK, &lo, &hi))
+            return (set->chunks[pos].key << CHUNK_SHIFT) | lo;
+        pos++;
+    }
+    if (pos < set->n
+        && chunk_next_run (&set->chunks[pos], 0, &lo, &hi))
+        return (set->chunks[pos].key << CHUNK_SHIFT) | lo;
+    return IDSET64_INVALID_ID;
+}
+
+uint64_t idset64_first (const struct idset64 *set)
+{
+    if (!set)
+        return IDSET64_INVALID_ID;
+    return succ (set, 0);
+}
+
+uint64_t idset64_next (const struct idset64 *set, uint64_t id)
+{
+    if (!set || id >= IDSET64_INVALID_ID - 1)
+        return IDSET64_INVALID_ID;
+    return succ (set, id + 1);
+}
+
+uint64_t idset64_last (const struct idset64 *set)
+{
+    const struct chunk *c;
+
+    if (!set || set->n == 0)
+        return IDSET64_INVALID_ID;
+    c = &set->chunks[set->n - 1];
+    if (c->bitmap) {
+        for (int i = BITMAP_WORDS - 1; i >= 0; i--) {
+            if (c->bitmap[i])
+                return (c->key << CHUNK_SHIFT)
+                       | (i << 6)
+                       | (63 - __builtin_clzll (c->bitmap[i]));
+        }
+        return IDSET64_INVALID_ID; // not reached: empty chunks are removed
+    }
+    return (c->key << CHUNK_SHIFT) | c->array[c->card - 1];
+}
+
+static bool chunk_equal (const struct chunk *a, const struct chunk *b)
+{
+    if (a->key != b->key || a->card != b->card)
+        return false;
+    if (a->bitmap && b->bitmap)
+        return !memcmp (a->bitmap, b->bitmap, sizeof (uint64_t) * BITMAP_WORDS);
+    if (a->array && b->array)
+        return !memcmp (a->array, b->array, sizeof (uint16_t) * a->card);
+    for (uint32_t i = 0; i < (a->array ? a->card : b->card); i++) {
+        uint32_t off = a->array ? a->array[i] : b->array[i];
+        if (!chunk_test (a->array ? b : a, off))
+            return false;
+    }
+    return true;
+}
+
+bool idset64_equal (const struct idset64 *a, const struct idset64 *b)
+{
+    if (!a || !b || a->count != b->count || a->n != b->n)
+        return false;
+    for (size_t i = 0; i < a->n; i++) {
+        if (!chunk_equal (&a->chunks[i], &b->chunks[i]))
+            return false;
+    }
+    return true;
+}
+
+/* Call 'fun' on each offset of 'c' and return the sum of the results,
+ * or -1 if any call fails.
+ */
+static int chunk_foreach (const struct chunk *c,
+                          struct chunk *arg,
+                          int (*fun)(struct chunk *c, uint32_t off))
+{
+    int total = 0;
+    int rc;
+
+    if (c->bitmap) {
+        for (uint32_t i = 0; i < BITMAP_WORDS; i++) {
+            uint64_t w = c->bitmap[i];
+            while (w) {
+                if ((rc = fun (arg, (i << 6) | __builtin_ctzll (w))) < 0)
+                    return -1;
+                total += rc;
+                w &= w - 1;
+            }
+        }
+    }
+    else {
+        for (uint32_t i = 0; i < c->card; i++) {
+            if ((rc = fun (arg, c->array[i])) < 0)
+                return -1;
+            total += rc;
+        }
+    }
+    return total;
+}
+
+int idset64_add (struct idset64 *a, const struct idset64 *b)
+{
+    if (!a) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!b || a == b)
+        return 0;
+    for (size_t i = 0; i < b->n; i++) {
+        const struct chunk *cb = &b->chunks[i];
+        struct chunk *ca;
+        uint32_t before;
+
+        if (!(ca = get_chunk (a, cb->key)))
+            goto nomem;
+        before = ca->card;
+        if (cb->bitmap && !ca->bitmap && chunk_to_bitmap (ca) < 0)
+            goto nomem;
+        if (ca->bitmap && cb->bitmap) {
+            for (int j = 0; j < BITMAP_WORDS; j++)
+                ca->bitmap[j] |= cb->bitmap[j];
+            ca->card = bitmap_count (ca->bitmap);
+        }
+        else if (chunk_foreach (cb, ca, chunk_set) < 0) {
+            a->count += ca->card - before;
+            goto nomem;
+        }
+        a->count += ca->card - before;
+    }
+    return 0;
+nomem:
+    errno = ENOMEM;
+    return -1;
+}
+
+int idset64_subtract (struct idset64 *a, const struct idset64 *b)
+{
+    size_t i = 0;
+    size_t j = 0;
+
+    if (!a) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!b)
+        return 0;
+    if (a == b) {
+        while (a->n > 0)
+            remove_chunk (a, a->n - 1);
+        a->count = 0;
+        return 0;
+    }
+    while (i < a->n && j < b->n) {
+        struct chunk *ca = &a->chunks[i];
+        const struct chunk *cb = &b->chunks[j];
+
+        if (ca->key < cb->key)
+            i++;
+        else if (ca->key > cb->key)
+            j++;
+        else {
+            uint32_t before = ca->card;
+            if (ca->bitmap && cb->bitmap) {
+                for (int k = 0; k < BITMAP_WORDS; k++)
+                    ca->bitmap[k] &= ~cb->bitmap[k];
+                ca->card = bitmap_count (ca->bitmap);
+                chunk_maybe_to_array (ca);
+            }
+            else if (ca->array) {
+                uint32_t n = 0;
+                for (uint32_t k = 0; k < ca->card; k++) {
+                    if (!chunk_test (cb, ca->array[k]))
+                        ca->array[n++] = ca->array[k];
+                }
+                ca->card = n;
+            }
+            else
+                (void)chunk_foreach (cb, ca, chunk_clear);
+            a->count -= before - ca->card;
+            if (ca->card == 0)
+                remove_chunk (a, i);
+            else
+                i++;
+            j++;
+        }
+    }
+    return 0;
+}
+
+static int chunk_intersect (struct chunk *dst,
+                            const struct chunk *a,
+                            const struct chunk *b)
+{
+    memset (dst, 0, sizeof (*dst));
+    dst->key = a->key;
+    if (a->bitmap && b->bitmap) {
+        if (!(dst->bitmap = malloc (sizeof (uint64_t) * BITMAP_WORDS)))
+            return -1;
+        for (int i = 0; i < BITMAP_WORDS; i++)
+            dst->bitmap[i] = a->bitmap[i] & b->bitmap[i];
+        dst->card = bitmap_count (dst->bitmap);
+        chunk_maybe_to_array (dst);
+        return 0;
+    }
+    /* At least one is an array, so the result fits in an array.
+     */
+    if (b->array && (!a->array || b->card < a->card)) {
+        const struct chunk *tmp = a;
+        a = b;
+        b = tmp;
+    }
+    if (!(dst->array = malloc (sizeof (uint16_t) * (a->card ? a->card : 1))))
+        return -1;
+    dst->size = a->card ? a->card : 1;
+    for (uint32_t i = 0; i < a->card; i++) {
+        if (chunk_test (b, a->array[i]))
+            dst->array[dst->card++] = a->array[i];
+    }
+    return 0;
+}
+
+struct idset64 *idset64_intersect (const struct idset64 *a,
+                                   const struct idset64 *b)
+{
+    struct idset64 *result;
+    size_t i = 0;
+    size_t j = 0;
+
+    if (!a || !b) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(result = idset64_create ()))
+        return NULL;
+    while (i < a->n && j < b->n) {
+        if (a->chunks[i].key < b->chunks[j].key)
+            i++;
+        else if (a->chunks[i].key > b->chunks[j].key)
+            j++;
+        else {
+            struct chunk c;
+            struct chunk *dst;
+
+            if (chunk_intersect (&c, &a->chunks[i], &b->chunks[j]) < 0)
+                goto nomem;
+            if (c.card == 0)
+                chunk_free (&c);
+            else {
+                if (!(dst = get_chunk (result, c.key))) {
+                    chunk_free (&c);
+                    goto nomem;
+                }
+                *dst = c;
+                result->count += c.card;
+            }
+            i++;
+            j++;
+        }
+    }
+    return result;
+nomem:
+    idset64_destroy (result);
+    errno = ENOMEM;
+    return NULL;
+}
+
+struct strbuf {
+    char *s;
+    size_t sz;
+    size_t len;
+};
+
+static int __attribute__ ((format (printf, 2, 3)))
+strbuf_printf (struct strbuf *sb, const char *fmt, ...)
+{
+    va_list ap;
+    char buf[64];
+    int n;
+
+    va_start (ap, fmt);
+    n = vsnprintf (buf, sizeof (buf), fmt, ap);
+    va_end (ap);
+    if (n < 0 || n >= sizeof (buf))
+        return -1;
+    if (sb->len + n + 1 > sb->sz) {
+        size_t nsz = sb->sz ? sb->sz : IDSET_ENCODE_CHUNK;
+        char *p;
+        while (sb->len + n + 1 > nsz)
+            nsz *= 2;
+        if (!(p = realloc (sb->s, nsz)))
+            return -1;
+        sb->s = p;
+        sb->sz = nsz;
+    }
+    memcpy (sb->s + sb->len, buf, n + 1);
+    sb->len += n;
+    return 0;
+}
+
+static int encode_range (struct strbuf *sb,
+                         uint64_t lo,
+                         uint64_t hi,
+                         int flags)
+{
+    const char *sep = sb->len > 0 ? "," : "";
+
+    if ((flags & IDSET_FLAG_BRACKETS) && sb->len == 1)
+        sep = "";
+    if (lo == hi)
+        return strbuf_printf (sb, "%s%ju", sep, (uintmax_t)lo);
+    if ((flags & IDSET_FLAG_RANGE))
+        return strbuf_printf (sb, "%s%ju-%ju", sep, (uintmax_t)lo, (uintmax_t)hi);
+    for (uint64_t id = lo; id <= hi; id++) {
+        if (strbuf_printf (sb, "%s%ju", sep, (uintmax_t)id) < 0)
+            return -1;
+        sep = ",";
+    }
+    return 0;
+}
+
+char *idset64_encode (const struct idset64 *set, int flags)
+{
+    struct strbuf sb = { 0 };
+    uint64_t lo = 0;
+    uint64_t hi = 0;
+    bool have_range = false;
+
+    if (validate_idset_flags (flags, IDSET_FLAG_BRACKETS
+                                   | IDSET_FLAG_RANGE) < 0)
+        return NULL;
+    if (!set) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if ((flags & IDSET_FLAG_BRACKETS) && set->count > 1) {
+        if (strbuf_printf (&sb, "[") < 0)
+            goto nomem;
+    }
+    for (size_t i = 0; i < set->n; i++) {
+        const struct chunk *c = &set->chunks[i];
+        uint64_t base = c->key << CHUNK_SHIFT;
+        uint32_t rlo, rhi;
+        uint32_t from = 0;
+
+        while (chunk_next_run (c, from, &rlo, &rhi)) {
+            /* Runs that meet at a chunk boundary are joined.
+             */
+            if (have_range && base + rlo == hi + 1)
+                hi = base + rhi;
+            else {
+                if (have_range && encode_range (&sb, lo, hi, flags) < 0)
+                    goto nomem;
+                lo = base + rlo;
+                hi = base + rhi;
+                have_range = true;
+            }
+            from = rhi + 2;
+        }
+    }
+    if (have_range && encode_range (&sb, lo, hi, flags) < 0)
+        goto nomem;
+    if ((flags & IDSET_FLAG_BRACKETS) && set->count > 1) {
+        if (strbuf_printf (&sb, "]") < 0)
+            goto nomem;
+    }
+    if (!sb.s && !(sb.s = strdup ("")))
+        goto nomem;
+    return sb.s;
+nomem:
+    free (sb.s);
+    errno = ENOMEM;
+    return NULL;
+}
+
+/* Parse a decimal id without leading zeros or sign.
+ */
+static int parse_id (const char **sp, uint64_t *idp)
+{
+    const char *s = *sp;
+    uint64_t id = 0;
+
+    if (!isdigit (*s) || (s[0] == '0' && isdigit (s[1])))
+        return -1;
+    while (isdigit (*s)) {
+        unsigned int d = *s++ - '0';
+        if (id > (IDSET64_INVALID_ID - 1 - d) / 10)
+            return -1;
+        id = id * 10 + d;
+    }
+    *sp = s;
+    *idp = id;
+    return 0;
+}
+
+struct idset64 *idset64_decode (const char *str)
+{
+    struct idset64 *set;
+    const char *s = str;
+    const char *end;
+    uint64_t prev = 0;
+    bool first = true;
+
+    if (!str) {
+        errno = EINVAL;
+        return NULL;
+    }
+    end = s + strlen (s);
+    if (*s == '[') {
+        if (end == s + 1 || end[-1] != ']')
+            goto inval;
+        s++;
+        end--;
+    }
+    if (!(set = idset64_create ()))
+        return NULL;
+    while (s < end) {
+        uint64_t lo, hi;
+
+        if (parse_id (&s, &lo) < 0)
+            goto error;
+        hi = lo;
+        if (*s == '-') {
+            s++;
+            if (parse_id (&s, &hi) < 0 || hi < lo)
+                goto error;
+        }
+        /* Ranges must be disjoint and in ascending order, as for idset.
+         */
+        if (!first && lo <= prev)
+            goto error;
+        if (idset64_range_set (set, lo, hi) < 0)
+            goto error_nomem;
+        prev = hi;
+        first = false;
+        if (s < end) {
+            if (*s != ',' || s + 1 == end)
+                goto error;
+            s++;
+        }
+    }
+    return set;
+error:
+    idset64_destroy (set);
+inval:
+    errno = EINVAL;
+    return NULL;
+error_nomem:
+    idset64_destroy (set);
+    return NULL;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,76 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* An idset64 is a sorted set of 64-bit ids, such as FLUIDs, drawn from a
+ * universe too large or too sparse for an idset.
+ *
+ * Ids are grouped in chunks of 2^16 that share their upper 48 bits.  Only
+ * chunks with members are stored.  A chunk holds a sorted array of 16-bit
+ * offsets while it has 4096 members or fewer, and a 64K-bit bitmap
+ * otherwise, so memory stays proportional to the number of ids for sparse
+ * sets and to one bit per id for dense ones.
+ *
+ * The string representation is the same as for idset, e.g. "[1-5,7]".
+ */
+
+#ifndef HAVE_LIBIDSET_IDSET64_H
+#define HAVE_LIBIDSET_IDSET64_H 1
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+#define IDSET64_INVALID_ID  UINT64_MAX
+
+struct idset64 *idset64_create (void);
+void idset64_destroy (struct idset64 *set);
+struct idset64 *idset64_copy (const struct idset64 *set);
+
+/* Add/remove one id or the inclusive range [lo, hi].
+ * Return 0 on success, -1 on failure with errno set.
+ */
+int idset64_set (struct idset64 *set, uint64_t id);
+int idset64_range_set (struct idset64 *set, uint64_t lo, uint64_t hi);
+int idset64_clear (struct idset64 *set, uint64_t id);
+
+bool idset64_test (const struct idset64 *set, uint64_t id);
+size_t idset64_count (const struct idset64 *set);
+
+/* Iterate in ascending order.
+ * Return IDSET64_INVALID_ID if there are no (more) ids.
+ */
+uint64_t idset64_first (const struct idset64 *set);
+uint64_t idset64_next (const struct idset64 *set, uint64_t id);
+uint64_t idset64_last (const struct idset64 *set);
+
+bool idset64_equal (const struct idset64 *a, const struct idset64 *b);
+
+/* Add ids in 'b' to 'a', or remove them from 'a'.
+ * Return 0 on success, -1 on failure with errno set.
+ */
+int idset64_add (struct idset64 *a, const struct idset64 *b);
+int idset64_subtract (struct idset64 *a, const struct idset64 *b);
+
+/* Return a new set containing the ids in both 'a' and 'b'.
+ */
+struct idset64 *idset64_intersect (const struct idset64 *a,
+                                   const struct idset64 *b);
+
+/* Encode/decode as for idset_encode() and idset_decode().
+ * 'flags' may include IDSET_FLAG_BRACKETS and IDSET_FLAG_RANGE.
+ */
+char *idset64_encode (const struct idset64 *set, int flags);
+struct idset64 *idset64_decode (const char *s);
+
+#endif /* !HAVE_LIBIDSET_IDSET64_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
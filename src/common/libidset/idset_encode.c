@@ -25,40 +25,52 @@
 /* Format a string like printf, then append it to *s.
  * The allocated size of '*s' is '*sz'.
  * The current string length of '*s' is '*len'.
- * Grow *s by IDSET_ENCODE_CHUNK to allow new string to be appended.
+ * Grow *s geometrically, starting at IDSET_ENCODE_CHUNK, to allow the new
+ * string to be appended.  Appending at *len keeps encoding linear in the
+ * length of the result.
  * Returns 0 on success, -1 on failure with errno = ENOMEM.
  */
 static int __attribute__ ((format (printf, 4, 5)))
 catprintf (char **s, size_t *sz, size_t *len, const char *fmt, ...)
 {
     va_list ap;
-    char *ns;
+    char buf[64];
+    char *ns = buf;
     size_t nlen;
     int rc;
 
     va_start (ap, fmt);
-    rc = vasprintf (&ns, fmt, ap);
+    rc = vsnprintf (buf, sizeof (buf), fmt, ap);
     va_end (ap);
     if (rc < 0)
         return -1;
-    nlen = strlen (ns);
+    if (rc >= sizeof (buf)) {
+        va_start (ap, fmt);
+        rc = vasprintf (&ns, fmt, ap);
+        va_end (ap);
+        if (rc < 0)
+            return -1;
+    }
+    nlen = rc;
 
-    while (*len + nlen + 1 > *sz) {
-        size_t nsz = *sz + IDSET_ENCODE_CHUNK;
+    if (*len + nlen + 1 > *sz) {
+        size_t nsz = *sz ? *sz : IDSET_ENCODE_CHUNK;
         char *p;
+        while (*len + nlen + 1 > nsz)
+            nsz *= 2;
         if (!(p = realloc (*s, nsz)))
             goto error;
-        if (*s == NULL)
-            *p = '\0';
         *s = p;
         *sz = nsz;
     }
-    strcat (*s, ns);
+    memcpy (*s + *len, ns, nlen + 1);
     *len += nlen;
-    free (ns);
+    if (ns != buf)
+        free (ns);
     return 0;
 error:
-    free (ns);
+    if (ns != buf)
+        free (ns);
     errno = ENOMEM;
     return -1;
 }
@@ -546,6 +546,9 @@ static struct testop optab[] = {
     { "[0-1]",  OP_INTER,   "[2-3]",    "[]",       0,  0 },
     { "[0-1]",  OP_INTER,   "[1-2]",    "[1]",      0,  0 },
     { "[0-1]",  OP_INTER,   "[0-1]",    "[0-1]",    0,  0 },
+    { "[1,3,5,7]", OP_INTER, "[0,2,4,6,8]", "[]",   0,  0 },
+    { "[0-2,5,9-12,2000]", OP_INTER, "[1,3-5,11-15,2000-2001]",
+                            "[1,5,11-12,2000]",     0,  0 },
     { NULL,     OP_ADD,     "[0]",      NULL,       -1, EINVAL },
     { "[0]",    OP_ADD,     NULL,       "[0]",      0,  0 },
     { "[0]",    OP_ADD,     "[0]",      "[0]",      0,  0 },
@@ -554,6 +557,7 @@ static struct testop optab[] = {
     { "[0]",    OP_SUB,     NULL,       "[0]",      0,  0 },
     { "[0,1]",  OP_SUB,     "[1]",      "[0]",      0,  0 },
     { "[0,1]",  OP_SUB,     "[2]",      "[0,1]",    0,  0 },
+    { "[0-3,1500]", OP_SUB, "[1,3,1500-4000]", "[0,2]", 0, 0 },
 };
 
 static void tryop (const char *s1,
@@ -680,6 +684,58 @@ void test_copy (void)
     idset_destroy (idset);
 }
 
+void test_array (void)
+{
+    struct idset *idset;
+    unsigned int ids[] = { 7, 3, 5000, 3 };
+    unsigned int probe[] = { 3, 4, 5000, 5001 };
+    bool result[4];
+    unsigned int out[8];
+    char *s;
+
+    if (!(idset = idset_create (0, IDSET_FLAG_AUTOGROW)))
+        BAIL_OUT ("idset_create failed");
+    ok (idset_set_array (idset, ids, 4) == 0,
+        "idset_set_array works with duplicates and growth");
+    s = idset_encode (idset, 0);
+    ok (s && streq (s, "3,7,5000"),
+        "idset contains 3,7,5000");
+    free (s);
+    ok (idset_count (idset) == 3,
+        "idset_count returns 3");
+    ok (idset_test_array (idset, probe, result, 4) == 2
+        && result[0] && !result[1] && result[2] && !result[3],
+        "idset_test_array works");
+    ok (idset_to_array (idset, out, 8) == 3
+        && out[0] == 3 && out[1] == 7 && out[2] == 5000,
+        "idset_to_array works");
+    ok (idset_to_array (idset, out, 2) == 2
+        && out[0] == 3 && out[1] == 7,
+        "idset_to_array stops at size");
+    ok (idset_set_array (idset, NULL, 0) == 0,
+        "idset_set_array with count=0 works");
+
+    errno = 0;
+    ok (idset_set_array (NULL, ids, 4) < 0 && errno == EINVAL,
+        "idset_set_array idset=NULL fails with EINVAL");
+    ids[1] = IDSET_INVALID_ID;
+    errno = 0;
+    ok (idset_set_array (idset, ids, 4) < 0 && errno == EINVAL,
+        "idset_set_array with invalid id fails with EINVAL");
+    ok (idset_to_array (NULL, out, 8) == 0,
+        "idset_to_array idset=NULL returns 0");
+    ok (idset_test_array (idset, NULL, result, 4) == 0,
+        "idset_test_array ids=NULL returns 0");
+    idset_destroy (idset);
+
+    if (!(idset = idset_create (16, 0)))
+        BAIL_OUT ("idset_create failed");
+    errno = 0;
+    ok (idset_set_array (idset, probe, 4) < 0 && errno == EINVAL,
+        "idset_set_array out of range fails with EINVAL without autogrow");
+    idset_destroy (idset);
+}
+
 void test_autogrow (void)
 {
     struct idset *idset;
@@ -1203,6 +1259,7 @@ int main (int argc, char *argv[])
     test_range_clear ();
     test_equal ();
     test_copy ();
+    test_array ();
     test_autogrow ();
     test_format_first ();
     issue_1974 ();
@@ -0,0 +1,220 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "src/common/libtap/tap.h"
+#include "src/common/libidset/idset.h"
+#include "src/common/libidset/idset64.h"
+#include "ccan/array_size/array_size.h"
+#include "ccan/str/str.h"
+
+struct inout {
+    const char *in;
+    int flags;
+    const char *out;
+};
+
+static struct inout codec_tab[] = {
+    { "",               0,                  "" },
+    { "[]",             0,                  "" },
+    { "2",              0,                  "2" },
+    { "7-9",            0,                  "7,8,9" },
+    { "7-9",            IDSET_FLAG_RANGE,   "7-9" },
+    { "1,7-9,16",       IDSET_FLAG_RANGE|IDSET_FLAG_BRACKETS, "[1,7-9,16]" },
+    { "[4]",            IDSET_FLAG_RANGE|IDSET_FLAG_BRACKETS, "4" },
+    { "65534-65537",    IDSET_FLAG_RANGE,   "65534-65537" },
+    { "18446744073709551614", 0,            "18446744073709551614" },
+    { "1,4294967296-4294967297,9007199254740992", IDSET_FLAG_RANGE,
+                        "1,4294967296-4294967297,9007199254740992" },
+
+    /* expected failures */
+    { "x",              0,                  NULL },
+    { "01",             0,                  NULL },
+    { "3,2",            0,                  NULL },
+    { "2,2",            0,                  NULL },
+    { "3-1",            0,                  NULL },
+    { "1,",             0,                  NULL },
+    { "[1",             0,                  NULL },
+    { "-5",             0,                  NULL },
+    { "18446744073709551615", 0,            NULL },
+};
+
+static void test_codec (void)
+{
+    for (int i = 0; i < ARRAY_SIZE (codec_tab); i++) {
+        struct inout *t = &codec_tab[i];
+        struct idset64 *set = idset64_decode (t->in);
+        char *s = NULL;
+
+        if (!t->out) {
+            ok (set == NULL && errno == EINVAL,
+                "idset64_decode '%s' fails with EINVAL", t->in);
+            continue;
+        }
+        if (!set || !(s = idset64_encode (set, t->flags)))
+            BAIL_OUT ("idset64 codec failed on '%s'", t->in);
+        is (s, t->out,
+            "idset64 '%s' flags=0x%x encodes as '%s'", t->in, t->flags, s);
+        free (s);
+        idset64_destroy (set);
+    }
+}
+
+static void test_basic (void)
+{
+    struct idset64 *set;
+    uint64_t big = UINT64_C(1) << 52;
+
+    if (!(set = idset64_create ()))
+        BAIL_OUT ("idset64_create failed");
+    ok (idset64_count (set) == 0
+        && idset64_first (set) == IDSET64_INVALID_ID
+        && idset64_last (set) == IDSET64_INVALID_ID,
+        "new idset64 is empty");
+    ok (idset64_set (set, big) == 0
+        && idset64_set (set, 3) == 0
+        && idset64_set (set, 3) == 0,
+        "idset64_set works, including an existing id");
+    ok (idset64_count (set) == 2, "count is 2");
+    ok (idset64_test (set, big) && idset64_test (set, 3)
+        && !idset64_test (set, 4),
+        "idset64_test works");
+    ok (idset64_first (set) == 3
+        && idset64_next (set, 3) == big
+        && idset64_next (set, big) == IDSET64_INVALID_ID
+        && idset64_last (set) == big,
+        "idset64_first/next/last iterate in order");
+    ok (idset64_clear (set, 3) == 0
+        && idset64_clear (set, 5) == 0
+        && idset64_count (set) == 1
+        && idset64_first (set) == big,
+        "idset64_clear works, including a missing id");
+    errno = 0;
+    ok (idset64_set (set, IDSET64_INVALID_ID) < 0 && errno == EINVAL,
+        "idset64_set IDSET64_INVALID_ID fails with EINVAL");
+    idset64_destroy (set);
+}
+
+/* Fill a chunk past the array limit so it is stored as a bitmap, then
+ * empty it again.
+ */
+static void test_dense (void)
+{
+    struct idset64 *set;
+    struct idset64 *cpy;
+    uint64_t base = UINT64_C(5) << 32;
+    char *s;
+    int errors = 0;
+
+    if (!(set = idset64_create ()))
+        BAIL_OUT ("idset64_create failed");
+    for (uint64_t id = base; id < base + 10000; id += 2) {
+        if (idset64_set (set, id) < 0)
+            BAIL_OUT ("idset64_set failed");
+    }
+    ok (idset64_count (set) == 5000, "set 5000 ids one at a time");
+    ok (idset64_range_set (set, base + 10000, base + 200000) == 0
+        && idset64_count (set) == 5000 + 190001,
+        "idset64_range_set across chunks works");
+    ok (idset64_last (set) == base + 200000,
+        "idset64_last works on bitmap chunk");
+    if (!(s = idset64_encode (set, IDSET_FLAG_RANGE)))
+        BAIL_OUT ("idset64_encode failed");
+    ok (strstr (s, ",21474846480-21475036480") != NULL,
+        "range spanning chunk boundaries is encoded as one range");
+    free (s);
+
+    if (!(cpy = idset64_copy (set)))
+        BAIL_OUT ("idset64_copy failed");
+    ok (idset64_equal (set, cpy), "idset64_copy is equal to original");
+    for (uint64_t id = base; id < base + 10000; id += 2) {
+        if (idset64_clear (set, id) < 0 || idset64_test (set, id))
+            errors++;
+    }
+    ok (errors == 0 && idset64_count (set) == 190001,
+        "cleared ids from bitmap chunk");
+    ok (!idset64_equal (set, cpy), "sets are no longer equal");
+    ok (idset64_subtract (cpy, set) == 0
+        && idset64_count (cpy) == 5000
+        && idset64_first (cpy) == base
+        && idset64_last (cpy) == base + 9998,
+        "idset64_subtract works");
+    ok (idset64_subtract (set, set) == 0 && idset64_count (set) == 0
+        && idset64_first (set) == IDSET64_INVALID_ID,
+        "idset64_subtract of a set from itself empties it");
+    idset64_destroy (cpy);
+    idset64_destroy (set);
+}
+
+static void test_ops (void)
+{
+    struct idset64 *a = idset64_decode ("1-3,65536-200000,4294967296");
+    struct idset64 *b = idset64_decode ("2,100000-300000,4294967296-4294967300");
+    struct idset64 *r;
+    char *s;
+
+    if (!a || !b)
+        BAIL_OUT ("idset64_decode failed");
+
+    if (!(r = idset64_intersect (a, b)))
+        BAIL_OUT ("idset64_intersect failed");
+    s = idset64_encode (r, IDSET_FLAG_RANGE);
+    is (s, "2,100000-200000,4294967296", "idset64_intersect works");
+    ok (idset64_count (r) == 100003, "intersect count is correct");
+    free (s);
+    idset64_destroy (r);
+
+    if (!(r = idset64_copy (a)) || idset64_add (r, b) < 0)
+        BAIL_OUT ("idset64_add failed");
+    s = idset64_encode (r, IDSET_FLAG_RANGE);
+    is (s, "1-3,65536-300000,4294967296-4294967300", "idset64_add works");
+    ok (idset64_count (r) == 3 + 234465 + 5, "add count is correct");
+    free (s);
+
+    if (idset64_subtract (r, a) < 0)
+        BAIL_OUT ("idset64_subtract failed");
+    s = idset64_encode (r, IDSET_FLAG_RANGE);
+    is (s, "200001-300000,4294967297-4294967300", "idset64_subtract works");
+    free (s);
+    idset64_destroy (r);
+
+    errno = 0;
+    ok (idset64_intersect (a, NULL) == NULL && errno == EINVAL,
+        "idset64_intersect a NULL fails with EINVAL");
+    errno = 0;
+    ok (idset64_add (NULL, b) < 0 && errno == EINVAL,
+        "idset64_add NULL b fails with EINVAL");
+
+    idset64_destroy (a);
+    idset64_destroy (b);
+}
+
+int main (int argc, char *argv[])
+{
+    plan (NO_PLAN);
+
+    test_codec ();
+    test_basic ();
+    test_dense ();
+    test_ops ();
+
+    done_testing ();
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
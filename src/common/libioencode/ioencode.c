@@ -13,13 +13,14 @@
 #endif
 
 #include <stdarg.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 #include <errno.h>
 
 #include <jansson.h>
 
-#include "src/common/libccan/ccan/base64/base64.h"
+#include "src/common/libutil/b64.h"
 #include "src/common/libutil/errno_safe.h"
 #include "ccan/str/str.h"
 
@@ -34,10 +35,10 @@ static json_t *data_encode_base64 (const char *stream,
     ssize_t n;
     json_t *o = NULL;
     char *dest = NULL;
-    size_t destlen = base64_encoded_length (len) + 1; /* +1 for NUL */
+    size_t destlen = b64_encoded_length (len) + 1; /* +1 for NUL */
 
     if ((dest = malloc (destlen))
-        && (n = base64_encode (dest, destlen, data, len)) >= 0) {
+        && (n = b64_encode (dest, destlen, data, len)) >= 0) {
         if (!(o = json_pack ("{s:s s:s s:s s:s#}",
                              "stream", stream,
                              "rank", rank,
@@ -105,11 +106,11 @@ static int decode_data_base64 (char *src,
                                size_t *lenp)
 {
     ssize_t rc;
-    size_t size = base64_decoded_length (srclen);
+    size_t size = b64_decoded_length (srclen);
     if (datap) {
         if (!(*datap = malloc (size)))
             return -1;
-        if ((rc = base64_decode (*datap, size, src, srclen)) < 0) {
+        if ((rc = b64_decode (*datap, size, src, srclen)) < 0) {
             ERRNO_SAFE_WRAP (free, (*datap));
             return -1;
         }
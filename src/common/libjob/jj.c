@@ -14,38 +14,137 @@
 
 #include <errno.h>
 #include <string.h>
+#include <stdarg.h>
+#include <stdio.h>
 #include <jansson.h>
 
 #include "ccan/str/str.h"
 
 #include "jj.h"
 
+/* The jobspec is decoded in one walk over the tree with direct object
+ * lookups, rather than with several json_unpack_ex() passes, each of
+ * which parses a format string and looks keys up again.  Error messages
+ * match the ones json_unpack_ex() would have produced for the formats
+ * previously used here, since they are user visible.
+ */
+
+static const char *type_name (json_t *o)
+{
+    switch (json_typeof (o)) {
+        case JSON_OBJECT:
+            return "object";
+        case JSON_ARRAY:
+            return "array";
+        case JSON_STRING:
+            return "string";
+        case JSON_INTEGER:
+            return "integer";
+        case JSON_REAL:
+            return "real";
+        case JSON_TRUE:
+            return "true";
+        case JSON_FALSE:
+            return "false";
+        case JSON_NULL:
+            break;
+    }
+    return "null";
+}
+
+static __attribute__ ((format (printf, 2, 3)))
+int jj_error (struct jj_counts *jj, const char *fmt, ...)
+{
+    va_list ap;
+
+    va_start (ap, fmt);
+    vsnprintf (jj->error, sizeof (jj->error) - 1, fmt, ap);
+    va_end (ap);
+    errno = EINVAL;
+    return -1;
+}
+
+/* Look up required key 'key' in object 'o', which must be of 'type'
+ * (or a number if type is JSON_REAL).  On failure, format an error
+ * prefixed with 'prefix'.
+ */
+static json_t *jj_get (struct jj_counts *jj,
+                       const char *prefix,
+                       json_t *o,
+                       const char *key,
+                       json_type type)
+{
+    json_t *val;
+
+    if (!json_is_object (o)) {
+        jj_error (jj, "%sExpected object, got %s", prefix, type_name (o));
+        return NULL;
+    }
+    if (!(val = json_object_get (o, key))) {
+        jj_error (jj, "%sObject item not found: %s", prefix, key);
+        return NULL;
+    }
+    switch (type) {
+        case JSON_STRING:
+            if (!json_is_string (val))
+                goto mismatch;
+            break;
+        case JSON_INTEGER:
+            if (!json_is_integer (val))
+                goto mismatch;
+            break;
+        case JSON_REAL:
+            if (!json_is_number (val)) {
+                jj_error (jj,
+                          "%sExpected real or integer, got %s",
+                          prefix,
+                          type_name (val));
+                return NULL;
+            }
+            break;
+        default:
+            break;
+    }
+    return val;
+mismatch:
+    jj_error (jj,
+              "%sExpected %s, got %s",
+              prefix,
+              type == JSON_STRING ? "string" : "integer",
+              type_name (val));
+    return NULL;
+}
+
 static int jj_read_level (json_t *o, int level, struct jj_counts *jj);
 
 static int jj_read_vertex (json_t *o, int level, struct jj_counts *jj)
 {
+    char prefix[32];
+    json_t *val;
     int count;
-    const char *type = NULL;
-    json_t *with = NULL;
-    json_error_t error;
-    int exclusive = 0;
+    const char *type;
+    json_t *with;
+    bool exclusive = false;
 
-    if (json_unpack_ex (o, &error, 0, "{ s:s s:i s?b s?o }",
-                       "type", &type,
-                       "count", &count,
-                       "exclusive", &exclusive,
-                       "with", &with) < 0) {
-        snprintf (jj->error, sizeof (jj->error) - 1,
-                  "level %d: %s", level, error.text);
-        errno = EINVAL;
+    snprintf (prefix, sizeof (prefix), "level %d: ", level);
+    if (!(val = jj_get (jj, prefix, o, "type", JSON_STRING)))
         return -1;
-    }
-    if (count <= 0) {
-        sprintf (jj->error, "Invalid count %d for type '%s'",
-                            count, type);
-        errno = EINVAL;
+    type = json_string_value (val);
+    if (!(val = jj_get (jj, prefix, o, "count", JSON_INTEGER)))
         return -1;
+    count = json_integer_value (val);
+    if ((val = json_object_get (o, "exclusive"))) {
+        if (!json_is_boolean (val))
+            return jj_error (jj,
+                             "%sExpected true or false, got %s",
+                             prefix,
+                             type_name (val));
+        exclusive = json_is_true (val);
     }
+    with = json_object_get (o, "with");
+
+    if (count <= 0)
+        return jj_error (jj, "Invalid count %d for type '%s'", count, type);
     if (streq (type, "node")) {
         jj->nnodes = count;
         if (exclusive)
@@ -57,11 +156,8 @@ static int jj_read_vertex (json_t *o, int level, struct jj_counts *jj)
         jj->slot_size = count;
     else if (streq (type, "gpu"))
         jj->slot_gpus = count;
-    else {
-        sprintf (jj->error, "Unsupported resource type '%s'", type);
-        errno = EINVAL;
-        return -1;
-    }
+    else
+        return jj_error (jj, "Unsupported resource type '%s'", type);
     if (with)
         return jj_read_level (with, level+1, jj);
     return 0;
@@ -70,15 +166,11 @@ static int jj_read_vertex (json_t *o, int level, struct jj_counts *jj)
 
 static int jj_read_level (json_t *o, int level, struct jj_counts *jj)
 {
-    int i;
+    size_t i;
     json_t *v = NULL;
 
-    if (!json_is_array (o)) {
-        snprintf (jj->error, sizeof (jj->error) - 1,
-                  "level %d: must be an array", level);
-        errno = EINVAL;
-        return -1;
-    }
+    if (!json_is_array (o))
+        return jj_error (jj, "level %d: must be an array", level);
     json_array_foreach (o, i, v) {
         if (jj_read_vertex (v, level, jj) < 0)
             return -1;
@@ -86,6 +178,22 @@ static int jj_read_level (json_t *o, int level, struct jj_counts *jj)
     return 0;
 }
 
+/* Tasks are optional here, and only the first task's count is read.
+ */
+static void jj_read_tasks (json_t *tasks, struct jj_counts *jj)
+{
+    json_t *count;
+    json_t *val;
+
+    if (!(count = json_object_get (json_array_get (tasks, 0), "count")))
+        return;
+    if ((val = json_object_get (count, "total")) && json_is_integer (val))
+        jj->ntasks = json_integer_value (val);
+    else if ((val = json_object_get (count, "per_slot"))
+        && json_is_integer (val))
+        jj->ntasks_per_slot = json_integer_value (val);
+}
+
 int jj_get_counts (const char *spec, struct jj_counts *jj)
 {
     json_t *o = NULL;
@@ -106,9 +214,11 @@ int jj_get_counts (const char *spec, struct jj_counts *jj)
 
 int jj_get_counts_json (json_t *jobspec, struct jj_counts *jj)
 {
+    const char *prefix = "at top level: ";
+    const char *dprefix = "at top level: getting duration: ";
+    json_t *val;
+    json_t *resources;
     int version;
-    json_t *resources = NULL;
-    json_error_t error;
 
     if (!jj) {
         errno = EINVAL;
@@ -116,14 +226,13 @@ int jj_get_counts_json (json_t *jobspec, struct jj_counts *jj)
     }
     memset (jj, 0, sizeof (*jj));
 
-    if (json_unpack_ex (jobspec, &error, 0, "{s:i s:o}",
-                        "version", &version,
-                        "resources", &resources) < 0) {
-        snprintf (jj->error, sizeof (jj->error) - 1,
-                  "at top level: %s", error.text);
-        errno = EINVAL;
+    if (!jobspec)
+        return jj_error (jj, "%sNULL root value", prefix);
+    if (!(val = jj_get (jj, prefix, jobspec, "version", JSON_INTEGER)))
+        return -1;
+    version = json_integer_value (val);
+    if (!(resources = jj_get (jj, prefix, jobspec, "resources", JSON_NULL)))
         return -1;
-    }
     if (version != 1) {
         snprintf (jj->error, sizeof (jj->error) - 1,
                  "Invalid version: expected 1, got %d", version);
@@ -132,15 +241,11 @@ int jj_get_counts_json (json_t *jobspec, struct jj_counts *jj)
     }
     /* N.B. attributes.system is generally optional, but
      * attributes.system.duration is required in jobspec version 1 */
-    if (json_unpack_ex (jobspec, &error, 0, "{s:{s:{s:F}}}",
-                        "attributes",
-                          "system",
-                            "duration", &jj->duration) < 0) {
-        snprintf (jj->error, sizeof (jj->error) - 1,
-                  "at top level: getting duration: %s", error.text);
-        errno = EINVAL;
+    if (!(val = jj_get (jj, dprefix, jobspec, "attributes", JSON_NULL))
+        || !(val = jj_get (jj, dprefix, val, "system", JSON_NULL))
+        || !(val = jj_get (jj, dprefix, val, "duration", JSON_REAL)))
         return -1;
-    }
+    jj->duration = json_number_value (val);
     if (jj_read_level (resources, 0, jj) < 0)
         return -1;
 
@@ -158,6 +263,7 @@ int jj_get_counts_json (json_t *jobspec, struct jj_counts *jj)
     }
     if (jj->nnodes)
         jj->nslots *= jj->nnodes;
+    jj_read_tasks (json_object_get (jobspec, "tasks"), jj);
     return 0;
 }
 
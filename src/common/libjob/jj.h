@@ -30,6 +30,9 @@ struct jj_counts {
 
     double duration; /* attributes.system.duration if set */
 
+    int ntasks;          /* tasks[0].count.total if set, else 0 */
+    int ntasks_per_slot; /* tasks[0].count.per_slot if set, else 0 */
+
     char error[JJ_ERROR_TEXT_LENGTH]; /* On error, contains error description */
 };
 
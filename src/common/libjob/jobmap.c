@@ -0,0 +1,168 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* jobmap.c - hash table keyed by flux_jobid_t
+ *
+ * A typed wrapper around libutil/hashmap.c with the 8 byte job id stored
+ * inline as the key.  The id is its own hash: hashmap spreads it with
+ * Fibonacci hashing, which suits FLUIDs, whose low bits are a sequence
+ * number.  This adds a duplicator and jobmap_values() for job-manager.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdlib.h>
+#include <stdbool.h>
+#include <errno.h>
+
+#include "src/common/libutil/hashmap.h"
+
+#include "jobmap.h"
+
+struct jobmap {
+    struct hashmap *map;
+    jobmap_destructor_f destructor;
+    jobmap_duplicator_f duplicator;
+};
+
+static size_t jobmap_hash (const void *key, size_t keysize)
+{
+    return (size_t)*(const flux_jobid_t *)key;
+}
+
+static bool jobmap_equal (const void *key1, const void *key2, size_t keysize)
+{
+    return *(const flux_jobid_t *)key1 == *(const flux_jobid_t *)key2;
+}
+
+size_t jobmap_size (struct jobmap *map)
+{
+    return map ? hashmap_size (map->map) : 0;
+}
+
+int jobmap_insert (struct jobmap *map, flux_jobid_t id, void *item)
+{
+    if (!map) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (map->duplicator) {
+        if (!(item = map->duplicator (item)))
+            return -1;
+    }
+    if (hashmap_insert (map->map, &id, item) < 0) {
+        if (map->duplicator && map->destructor) {
+            int saved_errno = errno;
+            map->destructor (&item);
+            errno = saved_errno;
+        }
+        return -1;
+    }
+    return 0;
+}
+
+void *jobmap_lookup (struct jobmap *map, flux_jobid_t id)
+{
+    return map ? hashmap_lookup (map->map, &id) : NULL;
+}
+
+void jobmap_delete (struct jobmap *map, flux_jobid_t id)
+{
+    if (map)
+        hashmap_delete (map->map, &id);
+}
+
+void jobmap_purge (struct jobmap *map)
+{
+    if (map)
+        hashmap_purge (map->map);
+}
+
+void *jobmap_first (struct jobmap *map)
+{
+    return map ? hashmap_first (map->map) : NULL;
+}
+
+void *jobmap_next (struct jobmap *map)
+{
+    return map ? hashmap_next (map->map) : NULL;
+}
+
+zlistx_t *jobmap_values (struct jobmap *map)
+{
+    zlistx_t *l;
+    void *item;
+
+    if (!map) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(l = zlistx_new ()))
+        goto nomem;
+    zlistx_set_destructor (l, map->destructor);
+    zlistx_set_duplicator (l, map->duplicator);
+    item = hashmap_first (map->map);
+    while (item) {
+        if (!zlistx_add_end (l, item))
+            goto nomem;
+        item = hashmap_next (map->map);
+    }
+    return l;
+nomem:
+    zlistx_destroy (&l);
+    errno = ENOMEM;
+    return NULL;
+}
+
+void jobmap_set_destructor (struct jobmap *map,
+                            jobmap_destructor_f destructor)
+{
+    if (map) {
+        map->destructor = destructor;
+        hashmap_set_destructor (map->map, destructor);
+    }
+}
+
+void jobmap_set_duplicator (struct jobmap *map,
+                            jobmap_duplicator_f duplicator)
+{
+    if (map)
+        map->duplicator = duplicator;
+}
+
+void jobmap_destroy (struct jobmap *map)
+{
+    if (map) {
+        int saved_errno = errno;
+        hashmap_destroy (map->map);
+        free (map);
+        errno = saved_errno;
+    }
+}
+
+struct jobmap *jobmap_create (void)
+{
+    struct jobmap *map;
+
+    if (!(map = calloc (1, sizeof (*map))))
+        return NULL;
+    if (!(map->map = hashmap_create (sizeof (flux_jobid_t),
+                                     jobmap_hash,
+                                     jobmap_equal))) {
+        free (map);
+        return NULL;
+    }
+    return map;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,75 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _JOBMAP_H
+#define _JOBMAP_H
+
+#include <stddef.h>
+#include <flux/core.h>
+
+#include "src/common/libczmqcontainers/czmq_containers.h"
+
+/* jobmap - hash table of items keyed by flux_jobid_t
+ *
+ * A libutil hashmap with the id stored inline as the key, so unlike a
+ * zhashx_t from job_hash_create(), the key need not remain valid for the
+ * lifetime of the item.
+ *
+ * The destructor and duplicator have the same signatures as their zhashx
+ * counterparts, so job_destructor() and job_duplicator() may be used to
+ * have the map manage the life cycle of job objects.
+ */
+
+typedef void (*jobmap_destructor_f) (void **item);
+typedef void *(*jobmap_duplicator_f) (const void *item);
+
+struct jobmap *jobmap_create (void);
+void jobmap_destroy (struct jobmap *map);
+
+void jobmap_set_destructor (struct jobmap *map,
+                            jobmap_destructor_f destructor);
+void jobmap_set_duplicator (struct jobmap *map,
+                            jobmap_duplicator_f duplicator);
+
+size_t jobmap_size (struct jobmap *map);
+
+/* Insert 'item' under 'id'.  Fail with EEXIST if 'id' is already present.
+ */
+int jobmap_insert (struct jobmap *map, flux_jobid_t id, void *item);
+
+/* Return the item stored under 'id', or NULL if not found.
+ */
+void *jobmap_lookup (struct jobmap *map, flux_jobid_t id);
+
+/* Remove the item stored under 'id', destroying it with the destructor,
+ * if any.  This is a no-op if 'id' is not present.
+ */
+void jobmap_delete (struct jobmap *map, flux_jobid_t id);
+
+/* Remove all items.
+ */
+void jobmap_purge (struct jobmap *map);
+
+/* Iterate over items in no particular order.  As with zhashx, the map
+ * must not be modified during iteration.
+ */
+void *jobmap_first (struct jobmap *map);
+void *jobmap_next (struct jobmap *map);
+
+/* Return a list of all items, duplicated with the duplicator, if any.
+ * The list's destructor is set to the map's destructor.
+ */
+zlistx_t *jobmap_values (struct jobmap *map);
+
+#endif /* _JOBMAP_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
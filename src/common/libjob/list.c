@@ -46,7 +46,10 @@ flux_future_t *flux_job_list (flux_t *h,
         errno = ENOMEM;
         return NULL;
     }
-    if (!(f = flux_rpc_pack (h, "job-list.list", FLUX_NODEID_ANY, 0,
+    if (!(f = flux_rpc_pack (h,
+                             "job-list.list",
+                             FLUX_NODEID_ANY,
+                             FLUX_RPC_CBOR,
                              "{s:i s:o s:o}",
                              "max_entries", max_entries,
                              "attrs", o,
@@ -80,7 +83,10 @@ flux_future_t *flux_job_list_inactive (flux_t *h,
         errno = ENOMEM;
         return NULL;
     }
-    if (!(f = flux_rpc_pack (h, "job-list.list", FLUX_NODEID_ANY, 0,
+    if (!(f = flux_rpc_pack (h,
+                             "job-list.list",
+                             FLUX_NODEID_ANY,
+                             FLUX_RPC_CBOR,
                              "{s:i s:f s:o s:o}",
                              "max_entries", max_entries,
                              "since", since,
@@ -0,0 +1,213 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <errno.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <flux/core.h>
+
+#include "src/common/libtap/tap.h"
+#include "src/common/libjob/jobmap.h"
+
+struct item {
+    flux_jobid_t id;
+    int refcount;
+};
+
+static int destroyed;
+
+static void item_destructor (void **item)
+{
+    if (item && *item) {
+        struct item *it = *item;
+        if (--it->refcount == 0) {
+            destroyed++;
+            free (it);
+        }
+        *item = NULL;
+    }
+}
+
+static void *item_duplicator (const void *item)
+{
+    struct item *it = (struct item *)item;
+    it->refcount++;
+    return it;
+}
+
+static struct item *item_create (flux_jobid_t id)
+{
+    struct item *it;
+
+    if (!(it = calloc (1, sizeof (*it))))
+        BAIL_OUT ("out of memory");
+    it->id = id;
+    it->refcount = 1;
+    return it;
+}
+
+/* Generate FLUID-like ids: timestamp in the high bits, a generator id,
+ * then a sequence number in the low bits.
+ */
+static flux_jobid_t fluid (int i)
+{
+    return ((flux_jobid_t)(1000 + i / 4) << 24) | (3 << 10) | (i % 4);
+}
+
+static void test_basic (void)
+{
+    struct jobmap *map;
+    struct item *it;
+
+    if (!(map = jobmap_create ()))
+        BAIL_OUT ("jobmap_create failed");
+    ok (jobmap_size (map) == 0,
+        "jobmap_size is 0 on new map");
+    ok (jobmap_lookup (map, 42) == NULL,
+        "jobmap_lookup on empty map returns NULL");
+    ok (jobmap_first (map) == NULL,
+        "jobmap_first on empty map returns NULL");
+
+    it = item_create (0);
+    ok (jobmap_insert (map, 0, it) == 0,
+        "jobmap_insert id=0 works");
+    ok (jobmap_lookup (map, 0) == it,
+        "jobmap_lookup id=0 finds item");
+    errno = 0;
+    ok (jobmap_insert (map, 0, it) < 0 && errno == EEXIST,
+        "jobmap_insert of duplicate id fails with EEXIST");
+    ok (jobmap_first (map) == it && jobmap_next (map) == NULL,
+        "iteration returns one item");
+    jobmap_delete (map, 0);
+    ok (jobmap_size (map) == 0 && jobmap_lookup (map, 0) == NULL,
+        "jobmap_delete removes item");
+    jobmap_delete (map, 0);
+    ok (jobmap_size (map) == 0,
+        "jobmap_delete of missing id is a no-op");
+    free (it);
+
+    jobmap_destroy (map);
+}
+
+static void test_many (int count)
+{
+    struct jobmap *map;
+    struct item *it;
+    zlistx_t *l;
+    int errors;
+    int n;
+    int i;
+
+    if (!(map = jobmap_create ()))
+        BAIL_OUT ("jobmap_create failed");
+    jobmap_set_destructor (map, item_destructor);
+    jobmap_set_duplicator (map, item_duplicator);
+
+    destroyed = 0;
+    errors = 0;
+    for (i = 0; i < count; i++) {
+        it = item_create (fluid (i));
+        if (jobmap_insert (map, it->id, it) < 0)
+            errors++;
+        item_destructor ((void **)&it);
+    }
+    ok (errors == 0 && jobmap_size (map) == count,
+        "inserted %d items", count);
+
+    errors = 0;
+    for (i = 0; i < count; i++) {
+        if (!(it = jobmap_lookup (map, fluid (i))) || it->id != fluid (i))
+            errors++;
+    }
+    ok (errors == 0,
+        "all %d items can be found", count);
+    ok (jobmap_lookup (map, fluid (count)) == NULL,
+        "missing id is not found");
+
+    n = 0;
+    it = jobmap_first (map);
+    while (it) {
+        n++;
+        it = jobmap_next (map);
+    }
+    ok (n == count,
+        "iteration visits %d items", count);
+
+    /* Delete every other item, then check the rest remain reachable
+     * after backward shift deletion.
+     */
+    for (i = 0; i < count; i += 2)
+        jobmap_delete (map, fluid (i));
+    ok (jobmap_size (map) == count / 2 && destroyed == (count + 1) / 2,
+        "deleted %d items", (count + 1) / 2);
+    errors = 0;
+    for (i = 0; i < count; i++) {
+        it = jobmap_lookup (map, fluid (i));
+        if ((i % 2 == 0 && it != NULL) || (i % 2 == 1 && it == NULL))
+            errors++;
+    }
+    ok (errors == 0,
+        "remaining items can be found, deleted items cannot");
+
+    l = jobmap_values (map);
+    ok (l != NULL && zlistx_size (l) == count / 2,
+        "jobmap_values returns %d items", count / 2);
+    zlistx_destroy (&l);
+    ok (destroyed == (count + 1) / 2,
+        "destroying jobmap_values list drops only its references");
+
+    jobmap_purge (map);
+    ok (jobmap_size (map) == 0 && destroyed == count,
+        "jobmap_purge destroys all items");
+    ok (jobmap_first (map) == NULL,
+        "iteration of purged map returns NULL");
+
+    jobmap_destroy (map);
+}
+
+static void test_inval (void)
+{
+    errno = 0;
+    ok (jobmap_insert (NULL, 1, "foo") < 0 && errno == EINVAL,
+        "jobmap_insert map=NULL fails with EINVAL");
+    ok (jobmap_lookup (NULL, 1) == NULL,
+        "jobmap_lookup map=NULL returns NULL");
+    ok (jobmap_size (NULL) == 0,
+        "jobmap_size map=NULL returns 0");
+    ok (jobmap_first (NULL) == NULL && jobmap_next (NULL) == NULL,
+        "jobmap_first/next map=NULL return NULL");
+    errno = 0;
+    ok (jobmap_values (NULL) == NULL && errno == EINVAL,
+        "jobmap_values map=NULL fails with EINVAL");
+    lives_ok ({jobmap_delete (NULL, 1);},
+        "jobmap_delete map=NULL doesn't crash");
+    lives_ok ({jobmap_destroy (NULL);},
+        "jobmap_destroy map=NULL doesn't crash");
+}
+
+int main (int argc, char *argv[])
+{
+    plan (NO_PLAN);
+
+    test_basic ();
+    test_many (10);
+    test_many (100000);
+    test_inval ();
+
+    done_testing ();
+    return 0;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -29,9 +29,17 @@ flux_future_t *kvs_checkpoint_commit (flux_t *h,
 {
     flux_future_t *f = NULL;
     const char *topic = "content.checkpoint-put";
-    int valid_flags = KVS_CHECKPOINT_FLAG_CACHE_BYPASS;
-
-    if (!h || !rootref || (flags & ~valid_flags)) {
+    int valid_flags = KVS_CHECKPOINT_FLAG_CACHE_BYPASS
+                      | KVS_CHECKPOINT_FLAG_DURABLE;
+
+    /* The backing store has no notion of pending blobs, so a durable
+     * checkpoint must go through the content cache.
+     */
+    if (!h
+        || !rootref
+        || (flags & ~valid_flags)
+        || ((flags & KVS_CHECKPOINT_FLAG_CACHE_BYPASS)
+            && (flags & KVS_CHECKPOINT_FLAG_DURABLE))) {
         errno = EINVAL;
         return NULL;
     }
@@ -46,14 +54,16 @@ flux_future_t *kvs_checkpoint_commit (flux_t *h,
                              topic,
                              0,
                              0,
-                             "{s:s s:{s:i s:s s:i s:f}}",
+                             "{s:s s:{s:i s:s s:i s:f} s:b}",
                              "key",
                              key,
                              "value",
                              "version", 1,
                              "rootref", rootref,
                              "sequence", sequence,
-                             "timestamp", timestamp)))
+                             "timestamp", timestamp,
+                             "durable",
+                             (flags & KVS_CHECKPOINT_FLAG_DURABLE) ? 1 : 0)))
         return NULL;
 
     return f;
@@ -16,6 +16,8 @@
 /* flags */
 enum {
     KVS_CHECKPOINT_FLAG_CACHE_BYPASS = 1,/* request direct to backing store */
+    KVS_CHECKPOINT_FLAG_DURABLE = 2,     /* write checkpoint once the blobs
+                                          * stored before it are durable */
 };
 
 #define KVS_DEFAULT_CHECKPOINT "kvs-primary"
@@ -17,6 +17,9 @@
 #include <jansson.h>
 #include <flux/core.h>
 
+#include "src/common/libutil/errno_safe.h"
+#include "ccan/str/str.h"
+
 #include "kvs_dir_private.h"
 #include "kvs_lookup.h"
 #include "kvs_util_private.h"
@@ -27,6 +30,8 @@ struct lookup_ctx {
     char *key;
     char *atref;
     int flags;
+    char **keys;       // keys of flux_kvs_lookup_batch(), indexed by response
+    int count;
 
     json_t *treeobj;
     char *treeobj_str; // json_dumps of tree object returned from lookup
@@ -48,6 +53,11 @@ static void free_ctx (struct lookup_ctx *ctx)
     if (ctx) {
         free (ctx->key);
         free (ctx->atref);
+        if (ctx->keys) {
+            for (int i = 0; i < ctx->count; i++)
+                free (ctx->keys[i]);
+            free (ctx->keys);
+        }
         json_decref (ctx->treeobj);
         free (ctx->treeobj_str);
         free (ctx->val_data);
@@ -113,7 +123,7 @@ flux_future_t *flux_kvs_lookup (flux_t *h,
     struct lookup_ctx *ctx;
     flux_future_t *f;
     const char *topic = "kvs.lookup";
-    int rpc_flags = 0;
+    int rpc_flags = FLUX_RPC_CBOR;
 
     if (!h
         || !key
@@ -182,7 +192,7 @@ flux_future_t *flux_kvs_lookupat (flux_t *h,
     if (!(f = flux_rpc_pack (h,
                              "kvs.lookup",
                              FLUX_NODEID_ANY,
-                             0,
+                             FLUX_RPC_CBOR,
                              "{s:s s:i s:O}",
                              "key", key,
                              "flags", flags,
@@ -201,10 +211,79 @@ flux_future_t *flux_kvs_lookupat (flux_t *h,
     return f;
 }
 
-static int decode_treeobj (flux_future_t *f, json_t **treeobj)
+flux_future_t *flux_kvs_lookup_batch (flux_t *h,
+                                      const char *ns,
+                                      int flags,
+                                      const char **keys,
+                                      int count)
+{
+    struct lookup_ctx *ctx;
+    flux_future_t *f;
+    json_t *a = NULL;
+
+    if (!h
+        || !keys
+        || count <= 0
+        || validate_lookup_flags (flags, false) < 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!ns) {
+        if (!(ns = kvs_get_namespace ()))
+            return NULL;
+    }
+    if (!(ctx = calloc (1, sizeof (*ctx)))
+        || !(ctx->keys = calloc (count, sizeof (ctx->keys[0])))
+        || !(a = json_array ()))
+        goto nomem;
+    ctx->h = h;
+    ctx->flags = flags;
+    ctx->count = count;
+    for (int i = 0; i < count; i++) {
+        if (!keys[i] || strlen (keys[i]) == 0) {
+            errno = EINVAL;
+            goto error;
+        }
+        if (!(ctx->keys[i] = strdup (keys[i]))
+            || json_array_append_new (a, json_string (keys[i])) < 0)
+            goto nomem;
+    }
+    if (!(f = flux_rpc_pack (h,
+                             "kvs.lookup-batch",
+                             FLUX_NODEID_ANY,
+                             FLUX_RPC_CBOR | FLUX_RPC_STREAMING,
+                             "{s:O s:s s:i}",
+                             "keys", a,
+                             "namespace", ns,
+                             "flags", flags)))
+        goto error;
+    if (flux_future_aux_set (f, auxkey, ctx, (flux_free_f)free_ctx) < 0) {
+        flux_future_destroy (f);
+        goto error;
+    }
+    json_decref (a);
+    return f;
+nomem:
+    errno = ENOMEM;
+error:
+    ERRNO_SAFE_WRAP (free_ctx, ctx);
+    ERRNO_SAFE_WRAP (json_decref, a);
+    return NULL;
+}
+
+static int decode_treeobj (flux_future_t *f,
+                           struct lookup_ctx *ctx,
+                           json_t **treeobj)
 {
     json_t *obj;
+    int errnum;
 
+    /* a failed lookup of one key in a batch is a successful response */
+    if (ctx->keys
+        && flux_rpc_get_unpack (f, "{s:i}", "errno", &errnum) == 0) {
+        errno = errnum;
+        return -1;
+    }
     if (flux_rpc_get_unpack (f, "{s:o}", "val", &obj) < 0)
         return -1;
     if (treeobj_validate (obj) < 0) {
@@ -226,6 +305,39 @@ static struct lookup_ctx *get_lookup_ctx (flux_future_t *f)
     return ctx;
 }
 
+static const char *get_key (flux_future_t *f, struct lookup_ctx *ctx)
+{
+    int index;
+
+    if (!ctx->keys)
+        return ctx->key;
+    if (flux_kvs_lookup_batch_get_index (f, &index) < 0)
+        return NULL;
+    return ctx->keys[index];
+}
+
+int flux_kvs_lookup_batch_get_index (flux_future_t *f, int *index)
+{
+    struct lookup_ctx *ctx;
+    int i;
+
+    if (!(ctx = get_lookup_ctx (f)))
+        return -1;
+    if (!ctx->keys) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (flux_rpc_get_unpack (f, "{s:i}", "index", &i) < 0)
+        return -1;
+    if (i < 0 || i >= ctx->count) {
+        errno = EPROTO;
+        return -1;
+    }
+    if (index)
+        *index = i;
+    return 0;
+}
+
 /* Parse the lookup response message, extracting the 'val' treeobj.
  * If decoded results were previously cached and the response has
  * changed (e.g. future has been reset and another response has arrived),
@@ -235,7 +347,7 @@ static int parse_response (flux_future_t *f, struct lookup_ctx *ctx)
 {
     json_t *treeobj2;
 
-    if (decode_treeobj (f, &treeobj2) < 0)
+    if (decode_treeobj (f, ctx, &treeobj2) < 0)
         return -1;
     if (!ctx->treeobj || !json_equal (ctx->treeobj, treeobj2)) {
         json_decref (ctx->treeobj);
@@ -358,15 +470,23 @@ int flux_kvs_lookup_get_raw (flux_future_t *f, const void **data, int *len)
 int flux_kvs_lookup_get_dir (flux_future_t *f, const flux_kvsdir_t **dirp)
 {
     struct lookup_ctx *ctx;
+    const char *key;
 
     if (!(ctx = get_lookup_ctx (f)))
         return -1;
     if (parse_response (f, ctx) < 0)
         return -1;
+    if (!(key = get_key (f, ctx)))
+        return -1;
+    /* batch responses for different keys may carry the same treeobj */
+    if (ctx->dir && !streq (flux_kvsdir_key (ctx->dir), key)) {
+        flux_kvsdir_destroy (ctx->dir);
+        ctx->dir = NULL;
+    }
     if (!ctx->dir) {
         if (!(ctx->dir = kvsdir_create_fromobj (ctx->h,
                                                 ctx->atref,
-                                                ctx->key,
+                                                key,
                                                 ctx->treeobj)))
             return -1;
     }
@@ -405,7 +525,7 @@ const char *flux_kvs_lookup_get_key (flux_future_t *f)
 
     if (!(ctx = get_lookup_ctx (f)))
         return NULL;
-    return ctx->key;
+    return get_key (f, ctx);
 }
 
 
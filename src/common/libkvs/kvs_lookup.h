@@ -24,6 +24,20 @@ flux_future_t *flux_kvs_lookupat (flux_t *h,
                                   const char *key,
                                   const char *treeobj);
 
+/* Look up 'count' keys against one snapshot of namespace 'ns' in a
+ * single request.  The future is fulfilled once per key, in no
+ * particular order, then with ENODATA after the last key.  Use
+ * flux_kvs_lookup_batch_get_index() to find the key a response is for,
+ * then the flux_kvs_lookup_get*() functions as with flux_kvs_lookup(),
+ * and flux_future_reset() to advance to the next response.
+ */
+flux_future_t *flux_kvs_lookup_batch (flux_t *h,
+                                      const char *ns,
+                                      int flags,
+                                      const char **keys,
+                                      int count);
+int flux_kvs_lookup_batch_get_index (flux_future_t *f, int *index);
+
 int flux_kvs_lookup_get (flux_future_t *f, const char **value);
 int flux_kvs_lookup_get_unpack (flux_future_t *f, const char *fmt, ...);
 int flux_kvs_lookup_get_raw (flux_future_t *f, const void **data, int *len);
@@ -33,6 +33,15 @@ void errors (void)
     ok (flux_kvs_lookupat (NULL, 0, NULL, NULL) == NULL && errno == EINVAL,
         "flux_kvs_lookupat fails on bad input");
 
+    errno = 0;
+    ok (flux_kvs_lookup_batch (NULL, NULL, 0, NULL, 0) == NULL
+        && errno == EINVAL,
+        "flux_kvs_lookup_batch fails on bad input");
+
+    errno = 0;
+    ok (flux_kvs_lookup_batch_get_index (NULL, NULL) < 0 && errno == EINVAL,
+        "flux_kvs_lookup_batch_get_index fails on bad input");
+
     errno = 0;
     ok (flux_kvs_lookup_get (NULL, NULL) < 0 && errno == EINVAL,
         "flux_kvs_lookup_get fails on bad input");
@@ -64,6 +73,10 @@ void errors (void)
     ok (flux_kvs_lookup_cancel (f) == -1 && errno == EINVAL,
         "flux_kvs_lookup_cancel future=(wrong type) fails with EINVAL");
 
+    errno = 0;
+    ok (flux_kvs_lookup_batch_get_index (f, NULL) < 0 && errno == EINVAL,
+        "flux_kvs_lookup_batch_get_index future=(wrong type) fails with EINVAL");
+
     flux_future_destroy (f);
 }
 
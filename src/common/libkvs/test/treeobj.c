@@ -805,6 +805,200 @@ void test_corner_cases (void)
     json_decref (symlink);
 }
 
+void test_dirshard (void)
+{
+    json_t *dir, *shard, *sub, *val, *bucket, *cpy;
+    const json_t *entry;
+    const char *key;
+    char name[16];
+    int i, count, total;
+
+    ok (treeobj_create_dirshard (-1) == NULL && errno == EINVAL,
+        "treeobj_create_dirshard fails on negative level");
+    ok (treeobj_create_dirshard (TREEOBJ_DIRSHARD_MAXLEVEL + 1) == NULL
+        && errno == EINVAL,
+        "treeobj_create_dirshard fails on level > max");
+    ok ((shard = treeobj_create_dirshard (0)) != NULL,
+        "treeobj_create_dirshard works");
+    ok (treeobj_is_dirshard (shard) && !treeobj_is_dir (shard),
+        "treeobj_is_dirshard returns true");
+    ok (treeobj_validate (shard) == 0,
+        "treeobj_validate likes empty dirshard");
+    ok (treeobj_get_count (shard) == 0,
+        "treeobj_get_count returns 0 for empty dirshard");
+    ok (treeobj_dirshard_get_level (shard) == 0,
+        "treeobj_dirshard_get_level returns 0");
+    ok (treeobj_dirshard_get_bucket (shard, "foo") == NULL && errno == ENOENT,
+        "treeobj_dirshard_get_bucket fails with ENOENT on empty dirshard");
+    ok (treeobj_dirshard_get_level (NULL) < 0 && errno == EINVAL,
+        "treeobj_dirshard_get_level fails on bad input");
+    ok (treeobj_dirshard_get_buckets (NULL) == NULL && errno == EINVAL,
+        "treeobj_dirshard_get_buckets fails on bad input");
+
+    val = treeobj_create_val ("foo", 4);
+    if (!val)
+        BAIL_OUT ("can't continue without test values");
+    ok (treeobj_dirshard_set_bucket (shard, "foo", val) < 0
+        && errno == EINVAL,
+        "treeobj_dirshard_set_bucket fails on val bucket");
+
+    /* split a directory and make sure every entry landed in its bucket */
+    if (!(dir = treeobj_create_dir ()))
+        BAIL_OUT ("treeobj_create_dir failed");
+    for (i = 0; i < 1000; i++) {
+        snprintf (name, sizeof (name), "key%d", i);
+        if (treeobj_insert_entry (dir, name, val) < 0)
+            BAIL_OUT ("treeobj_insert_entry failed");
+    }
+    json_decref (shard);
+    ok (treeobj_dirshard_split (val, 0) == NULL && errno == EINVAL,
+        "treeobj_dirshard_split fails on non-dir");
+    ok ((shard = treeobj_dirshard_split (dir, 0)) != NULL,
+        "treeobj_dirshard_split works");
+    ok (treeobj_validate (shard) == 0,
+        "treeobj_validate likes split dirshard");
+    count = treeobj_get_count (shard);
+    ok (count > 1 && count <= 256,
+        "dirshard has %d buckets", count);
+    total = 0;
+    for (i = 0; i < 1000; i++) {
+        snprintf (name, sizeof (name), "key%d", i);
+        if (!(entry = treeobj_dirshard_peek_bucket (shard, name))
+            || !treeobj_peek_entry (entry, name))
+            break;
+    }
+    ok (i == 1000,
+        "every entry is found in its bucket");
+    json_object_foreach (treeobj_dirshard_get_buckets (shard), key, bucket) {
+        total += treeobj_get_count (bucket);
+    }
+    ok (total == 1000,
+        "buckets hold 1000 entries in total");
+
+    /* nested dirshard must be at the next level */
+    ok ((sub = treeobj_create_dirshard (1)) != NULL,
+        "treeobj_create_dirshard level 1 works");
+    ok (treeobj_dirshard_set_bucket (shard, "key0", sub) == 0,
+        "treeobj_dirshard_set_bucket works with level 1 dirshard");
+    ok (treeobj_validate (shard) == 0,
+        "treeobj_validate likes nested dirshard");
+    ok ((cpy = treeobj_deep_copy (shard)) != NULL
+        && json_equal (cpy, shard),
+        "treeobj_deep_copy works on dirshard");
+    json_decref (cpy);
+    json_decref (sub);
+    ok ((sub = treeobj_create_dirshard (2)) != NULL,
+        "treeobj_create_dirshard level 2 works");
+    ok (treeobj_dirshard_set_bucket (shard, "key0", sub) == 0,
+        "treeobj_dirshard_set_bucket works with level 2 dirshard");
+    ok (treeobj_validate (shard) < 0 && errno == EINVAL,
+        "treeobj_validate rejects nested dirshard with wrong level");
+    json_decref (sub);
+
+    json_decref (shard);
+    json_decref (dir);
+    json_decref (val);
+}
+
+void test_codec_binary (void)
+{
+    json_t *dir, *sub, *shard, *o, *cpy;
+    char blobref[BLOBREF_MAX_STRING_SIZE];
+    char *data;
+    size_t len;
+    char *s;
+    int i;
+
+    if (!(dir = treeobj_create_dir ())
+        || !(sub = treeobj_create_dir ()))
+        BAIL_OUT ("treeobj_create_dir failed");
+    blobref_hash ("sha1", "abc", 3, blobref, sizeof (blobref));
+    o = treeobj_create_val ("foo\0bar", 7);
+    treeobj_insert_entry (dir, "val", o);
+    json_decref (o);
+    o = treeobj_create_val (NULL, 0);
+    treeobj_insert_entry (dir, "empty", o);
+    json_decref (o);
+    o = treeobj_create_valref (blobref);
+    blobref_hash ("sha256", "abc", 3, blobref, sizeof (blobref));
+    treeobj_append_blobref (o, blobref);
+    treeobj_insert_entry (dir, "valref", o);
+    json_decref (o);
+    o = treeobj_create_dirref (blobref);
+    treeobj_insert_entry (dir, "dirref", o);
+    json_decref (o);
+    o = treeobj_create_symlink (NULL, "a.b.c");
+    treeobj_insert_entry (sub, "link", o);
+    json_decref (o);
+    o = treeobj_create_symlink ("ns", "a.b.c");
+    treeobj_insert_entry (sub, "nslink", o);
+    json_decref (o);
+    treeobj_insert_entry (dir, "sub", sub);
+    json_decref (sub);
+    for (i = 0; i < 16; i++) {
+        char name[16];
+        snprintf (name, sizeof (name), "key%d", i);
+        o = treeobj_create_val (name, strlen (name));
+        treeobj_insert_entry (sub, name, o);
+        json_decref (o);
+    }
+    if (!(shard = treeobj_dirshard_split (sub, 0)))
+        BAIL_OUT ("treeobj_dirshard_split failed");
+    treeobj_insert_entry (dir, "shard", shard);
+
+    errno = 0;
+    ok (treeobj_encode_binary (NULL, &len) == NULL && errno == EINVAL,
+        "treeobj_encode_binary obj=NULL fails with EINVAL");
+    errno = 0;
+    ok (treeobj_encode_binary (dir, NULL) == NULL && errno == EINVAL,
+        "treeobj_encode_binary lenp=NULL fails with EINVAL");
+
+    data = treeobj_encode_binary (dir, &len);
+    ok (data != NULL && (unsigned char)data[0] == TREEOBJ_BINARY_MAGIC,
+        "treeobj_encode_binary works");
+    s = treeobj_encode (dir);
+    ok (s != NULL && len < strlen (s),
+        "binary encoding is smaller than JSON (%zu < %zu)",
+        len, s ? strlen (s) : 0);
+    free (s);
+
+    ok ((cpy = treeobj_decodeb (data, len)) != NULL,
+        "treeobj_decodeb decodes binary encoding");
+    ok (json_equal (cpy, dir),
+        "decoded object is identical to original");
+    json_decref (cpy);
+
+    errno = 0;
+    ok (treeobj_decodeb (data, len - 1) == NULL && errno == EPROTO,
+        "treeobj_decodeb fails with EPROTO on truncated binary encoding");
+    data[1] = 2;
+    errno = 0;
+    ok (treeobj_decodeb (data, len) == NULL && errno == EPROTO,
+        "treeobj_decodeb fails with EPROTO on unknown binary version");
+    free (data);
+
+    /* encoding does not depend on the order entries were inserted */
+    o = treeobj_create_dir ();
+    sub = treeobj_create_dir ();
+    treeobj_insert_entry (o, "b", sub);
+    treeobj_insert_entry (o, "a", sub);
+    data = treeobj_encode_binary (o, &len);
+    json_decref (o);
+    o = treeobj_create_dir ();
+    treeobj_insert_entry (o, "a", sub);
+    treeobj_insert_entry (o, "b", sub);
+    s = treeobj_encode_binary (o, &len);
+    ok (data != NULL && s != NULL && memcmp (data, s, len) == 0,
+        "binary encoding is independent of insertion order");
+    free (s);
+    free (data);
+    json_decref (o);
+    json_decref (sub);
+
+    json_decref (shard);
+    json_decref (dir);
+}
+
 int main(int argc, char** argv)
 {
     plan (NO_PLAN);
@@ -817,9 +1011,11 @@ int main(int argc, char** argv)
     test_copy ();
     test_deep_copy ();
     test_symlink ();
+    test_dirshard ();
     test_corner_cases ();
 
     test_codec ();
+    test_codec_binary ();
 
     done_testing();
 }
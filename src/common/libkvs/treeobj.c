@@ -17,16 +17,29 @@
 #include <string.h>
 #include <assert.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
 #include <jansson.h>
 
-#include "ccan/base64/base64.h"
+#include "ccan/array_size/array_size.h"
 #include "ccan/str/str.h"
+#include "src/common/libutil/b64.h"
 #include "src/common/libutil/blobref.h"
+#include "src/common/libutil/errno_safe.h"
 
 #include "treeobj.h"
 
 static const int treeobj_version = 1;
 
+static bool dirshard_valid_bucket_name (const char *s)
+{
+    return (strlen (s) == 2
+            && strchr ("0123456789abcdef", s[0])
+            && strchr ("0123456789abcdef", s[1]));
+}
+
 static int treeobj_unpack (json_t *obj, const char **typep, json_t **datap)
 {
     json_t *data;
@@ -109,6 +122,30 @@ int treeobj_validate (const json_t *obj)
                 goto inval;
         }
     }
+    else if (streq (type, "dirshard")) {
+        const json_t *buckets;
+        const char *key;
+        int level;
+        if (json_unpack ((json_t *)data,
+                         "{s:i s:o !}",
+                         "level", &level,
+                         "buckets", &buckets) < 0
+            || level < 0
+            || level > TREEOBJ_DIRSHARD_MAXLEVEL
+            || !json_is_object (buckets))
+            goto inval;
+        json_object_foreach ((json_t *)buckets, key, o) {
+            if (!dirshard_valid_bucket_name (key)
+                || (!treeobj_is_dir (o)
+                    && !treeobj_is_dirref (o)
+                    && !treeobj_is_dirshard (o))
+                || treeobj_validate (o) < 0)
+                goto inval;
+            if (treeobj_is_dirshard (o)
+                && treeobj_dirshard_get_level (o) != level + 1)
+                goto inval;
+        }
+    }
     else if (streq (type, "symlink")) {
         json_t *o;
         if (!json_is_object (data))
@@ -174,6 +211,12 @@ bool treeobj_is_dirref (const json_t *obj)
     return type && streq (type, "dirref");
 }
 
+bool treeobj_is_dirshard (const json_t *obj)
+{
+    const char *type = treeobj_get_type (obj);
+    return type && streq (type, "dirshard");
+}
+
 json_t *treeobj_get_data (json_t *obj)
 {
     json_t *data;
@@ -233,12 +276,12 @@ int treeobj_decode_val (const json_t *obj, void **dp, int *lp)
     }
     xdatastr = json_string_value (xdata);
     xlen = strlen (xdatastr);
-    databuflen = base64_decoded_length (xlen) + 1; // +1  for a trailing \0
+    databuflen = b64_decoded_length (xlen) + 1; // +1  for a trailing \0
 
     if (databuflen > 1) {
         if (!(data = malloc (databuflen)))
             return -1;
-        if ((datalen = base64_decode (data, databuflen, xdatastr, xlen)) < 0) {
+        if ((datalen = b64_decode (data, databuflen, xdatastr, xlen)) < 0) {
             free (data);
             errno = EINVAL;
             return -1;
@@ -271,6 +314,9 @@ int treeobj_get_count (const json_t *obj)
     else if (streq (type, "dir")) {
         count = json_object_size (data);
     }
+    else if (streq (type, "dirshard")) {
+        count = json_object_size (json_object_get (data, "buckets"));
+    }
     else if (streq (type, "symlink") || streq (type, "val")) {
         count = 1;
     } else {
@@ -387,9 +433,25 @@ json_t *treeobj_copy (json_t *obj)
         return NULL;
     }
     /* shallow copy of treeobj data and deep copy of treeobj is
-     * identical except for dir object.
+     * identical except for dir and dirshard objects.
      */
-    if (treeobj_is_dir (obj)) {
+    if (treeobj_is_dirshard (obj)) {
+        json_t *buckets;
+
+        if (!(cpy = treeobj_create_dirshard (treeobj_dirshard_get_level (obj))))
+            return NULL;
+        if (!(buckets = json_copy (json_object_get (data, "buckets")))
+            || json_object_set_new (treeobj_get_data (cpy),
+                                    "buckets",
+                                    buckets) < 0) {
+            save_errno = errno;
+            json_decref (buckets);
+            json_decref (cpy);
+            errno = save_errno;
+            return NULL;
+        }
+    }
+    else if (treeobj_is_dir (obj)) {
         if (!(cpy = treeobj_create_dir ()))
             return NULL;
 
@@ -480,6 +542,162 @@ json_t *treeobj_create_dir (void)
     return obj;
 }
 
+json_t *treeobj_create_dirshard (int level)
+{
+    json_t *obj;
+
+    if (level < 0 || level > TREEOBJ_DIRSHARD_MAXLEVEL) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(obj = json_pack ("{s:i s:s s:{s:i s:{}}}",
+                           "ver", treeobj_version,
+                           "type", "dirshard",
+                           "data",
+                             "level", level,
+                             "buckets"))) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    return obj;
+}
+
+int treeobj_dirshard_get_level (const json_t *obj)
+{
+    const char *type;
+    const json_t *data;
+    int level;
+
+    if (treeobj_peek (obj, &type, &data) < 0
+        || !streq (type, "dirshard")
+        || json_unpack ((json_t *)data, "{s:i}", "level", &level) < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    return level;
+}
+
+json_t *treeobj_dirshard_get_buckets (json_t *obj)
+{
+    const char *type;
+    json_t *data, *buckets;
+
+    if (treeobj_unpack (obj, &type, &data) < 0
+        || !streq (type, "dirshard")
+        || !(buckets = json_object_get (data, "buckets"))) {
+        errno = EINVAL;
+        return NULL;
+    }
+    return buckets;
+}
+
+/* 32-bit FNV-1a.  This is part of the dirshard format, don't change it.
+ */
+static uint32_t dirshard_hash (const char *name)
+{
+    uint32_t hash = 2166136261u;
+
+    while (*name) {
+        hash ^= (unsigned char)*name++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static int dirshard_bucket_name (const json_t *obj,
+                                 const char *name,
+                                 char *buf)
+{
+    int level;
+
+    if (!name || (level = treeobj_dirshard_get_level (obj)) < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    snprintf (buf, 3, "%02x", (dirshard_hash (name) >> (8 * level)) & 0xff);
+    return 0;
+}
+
+const json_t *treeobj_dirshard_peek_bucket (const json_t *obj,
+                                            const char *name)
+{
+    char bucket_name[3];
+    const json_t *bucket;
+
+    if (dirshard_bucket_name (obj, name, bucket_name) < 0)
+        return NULL;
+    /* N.B. safe to cast away const, since buckets is not modified */
+    if (!(bucket = json_object_get (treeobj_dirshard_get_buckets ((json_t *)obj),
+                                    bucket_name))) {
+        errno = ENOENT;
+        return NULL;
+    }
+    return bucket;
+}
+
+json_t *treeobj_dirshard_get_bucket (json_t *obj, const char *name)
+{
+    return (json_t *)treeobj_dirshard_peek_bucket (obj, name);
+}
+
+int treeobj_dirshard_set_bucket (json_t *obj, const char *name, json_t *bucket)
+{
+    char bucket_name[3];
+
+    if (!bucket
+        || (!treeobj_is_dir (bucket)
+            && !treeobj_is_dirref (bucket)
+            && !treeobj_is_dirshard (bucket))
+        || dirshard_bucket_name (obj, name, bucket_name) < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (json_object_set (treeobj_dirshard_get_buckets (obj),
+                         bucket_name,
+                         bucket) < 0) {
+        errno = ENOMEM;
+        return -1;
+    }
+    return 0;
+}
+
+json_t *treeobj_dirshard_split (const json_t *dir, int level)
+{
+    json_t *shard;
+    const json_t *data;
+    const char *name;
+    json_t *entry;
+    int save_errno;
+
+    if (!treeobj_is_dir (dir)
+        || treeobj_peek (dir, NULL, &data) < 0
+        || !(shard = treeobj_create_dirshard (level))) {
+        errno = EINVAL;
+        return NULL;
+    }
+    json_object_foreach ((json_t *)data, name, entry) {
+        json_t *bucket;
+
+        if (!(bucket = treeobj_dirshard_get_bucket (shard, name))) {
+            if (errno != ENOENT
+                || !(bucket = treeobj_create_dir ())
+                || treeobj_dirshard_set_bucket (shard, name, bucket) < 0) {
+                json_decref (bucket);
+                goto error;
+            }
+            json_decref (bucket); // shard now holds a reference
+        }
+        if (treeobj_insert_entry_novalidate (bucket, name, entry) < 0)
+            goto error;
+    }
+    return shard;
+error:
+    save_errno = errno;
+    json_decref (shard);
+    errno = save_errno;
+    return NULL;
+}
+
 json_t *treeobj_create_symlink (const char *ns, const char *target)
 {
     json_t *data, *obj;
@@ -523,10 +741,10 @@ json_t *treeobj_create_val (const void *data, int len)
     char *xdata;
     json_t *obj = NULL;
 
-    xlen = base64_encoded_length (len) + 1; /* +1 for NUL */
+    xlen = b64_encoded_length (len) + 1; /* +1 for NUL */
     if (!(xdata = malloc (xlen)))
         goto done;
-    if (base64_encode (xdata, xlen, (char *)data, len) < 0)
+    if (b64_encode (xdata, xlen, data, len) < 0)
         goto done;
     if (!(obj = json_pack ("{s:i s:s s:s}",
                            "ver", treeobj_version,
@@ -620,6 +838,467 @@ error:
     return NULL;
 }
 
+/* Compact binary encoding.
+ *
+ * The encoding begins with TREEOBJ_BINARY_MAGIC and a format version
+ * byte, followed by one encoded treeobj:
+ *
+ *   val:      TYPE_VAL, varint length, raw data
+ *   valref:   TYPE_VALREF, varint count, blobrefs
+ *   dirref:   TYPE_DIRREF, varint count, blobrefs
+ *   dir:      TYPE_DIR, varint count, { varint length, name, treeobj }
+ *   dirshard: TYPE_DIRSHARD, varint level, varint count,
+ *             { bucket byte, treeobj }
+ *   symlink:  TYPE_SYMLINK, flags, [ varint length, namespace ],
+ *             varint length, target
+ *
+ * A blobref is a hash type byte followed by the digest.  Varints are
+ * unsigned LEB128.  Dir entries and dirshard buckets are sorted by name
+ * so that the encoding (and thus the blobref) of a given object is
+ * stable.
+ */
+enum {
+    BINARY_VERSION = 1,
+    BINARY_MAXDEPTH = 2048,
+};
+
+enum {
+    TYPE_VAL = 1,
+    TYPE_VALREF = 2,
+    TYPE_DIR = 3,
+    TYPE_DIRREF = 4,
+    TYPE_SYMLINK = 5,
+    TYPE_DIRSHARD = 6,
+};
+
+enum {
+    SYMLINK_FLAG_NAMESPACE = 1,
+};
+
+static const char *binary_hashtypes[] = { NULL, "sha1", "sha256" };
+
+struct bbuf {
+    unsigned char *data;
+    size_t len;
+    size_t size;
+};
+
+static int bbuf_put (struct bbuf *b, const void *data, size_t len)
+{
+    if (b->len + len > b->size) {
+        size_t size = b->size ? b->size : 256;
+        unsigned char *p;
+
+        while (size < b->len + len)
+            size *= 2;
+        if (!(p = realloc (b->data, size)))
+            return -1;
+        b->data = p;
+        b->size = size;
+    }
+    if (len > 0)
+        memcpy (b->data + b->len, data, len);
+    b->len += len;
+    return 0;
+}
+
+static int bbuf_put_byte (struct bbuf *b, unsigned char c)
+{
+    return bbuf_put (b, &c, 1);
+}
+
+static int bbuf_put_varint (struct bbuf *b, uint64_t val)
+{
+    unsigned char buf[10];
+    int n = 0;
+
+    do {
+        buf[n] = val & 0x7f;
+        val >>= 7;
+        if (val)
+            buf[n] |= 0x80;
+        n++;
+    } while (val);
+    return bbuf_put (b, buf, n);
+}
+
+static int bbuf_put_string (struct bbuf *b, const char *s)
+{
+    size_t len = strlen (s);
+
+    if (bbuf_put_varint (b, len) < 0 || bbuf_put (b, s, len) < 0)
+        return -1;
+    return 0;
+}
+
+static int bbuf_put_blobref (struct bbuf *b, const char *blobref)
+{
+    char hash[BLOBREF_MAX_DIGEST_SIZE];
+    int hash_len;
+    int i;
+
+    if ((hash_len = blobref_strtohash (blobref, hash, sizeof (hash))) < 0)
+        return -1;
+    for (i = 1; i < ARRAY_SIZE (binary_hashtypes); i++) {
+        if (strstarts (blobref, binary_hashtypes[i])
+            && blobref[strlen (binary_hashtypes[i])] == '-')
+            break;
+    }
+    if (i == ARRAY_SIZE (binary_hashtypes)) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (bbuf_put_byte (b, i) < 0 || bbuf_put (b, hash, hash_len) < 0)
+        return -1;
+    return 0;
+}
+
+static int bbuf_put_blobrefs (struct bbuf *b, unsigned char type,
+                              const json_t *data)
+{
+    size_t index;
+    json_t *o;
+
+    if (bbuf_put_byte (b, type) < 0
+        || bbuf_put_varint (b, json_array_size (data)) < 0)
+        return -1;
+    json_array_foreach (data, index, o) {
+        if (bbuf_put_blobref (b, json_string_value (o)) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+static int strcmp_cb (const void *a, const void *b)
+{
+    return strcmp (*(const char **)a, *(const char **)b);
+}
+
+/* Return the keys of object 'o' in sorted order.
+ * The caller must free the returned array (but not the keys).
+ */
+static const char **sorted_keys (const json_t *o)
+{
+    const char **keys;
+    const char *key;
+    json_t *value;
+    int i = 0;
+
+    if (!(keys = calloc (json_object_size (o) + 1, sizeof (keys[0]))))
+        return NULL;
+    json_object_foreach ((json_t *)o, key, value)
+        keys[i++] = key;
+    qsort (keys, i, sizeof (keys[0]), strcmp_cb);
+    return keys;
+}
+
+static int bbuf_put_treeobj (struct bbuf *b, const json_t *obj);
+
+static int bbuf_put_entries (struct bbuf *b, const json_t *data, bool shard)
+{
+    const char **keys;
+    int i;
+    int rc = -1;
+
+    if (!(keys = sorted_keys (data))
+        || bbuf_put_varint (b, json_object_size (data)) < 0)
+        goto done;
+    for (i = 0; keys[i] != NULL; i++) {
+        if (shard) {
+            if (bbuf_put_byte (b, strtoul (keys[i], NULL, 16)) < 0)
+                goto done;
+        }
+        else if (bbuf_put_string (b, keys[i]) < 0)
+            goto done;
+        if (bbuf_put_treeobj (b, json_object_get (data, keys[i])) < 0)
+            goto done;
+    }
+    rc = 0;
+done:
+    free (keys);
+    return rc;
+}
+
+static int bbuf_put_treeobj (struct bbuf *b, const json_t *obj)
+{
+    const json_t *data;
+    const char *type;
+
+    if (treeobj_peek (obj, &type, &data) < 0)
+        return -1;
+    if (streq (type, "val")) {
+        void *val;
+        int len;
+        int rc;
+
+        if (treeobj_decode_val (obj, &val, &len) < 0)
+            return -1;
+        rc = 0;
+        if (bbuf_put_byte (b, TYPE_VAL) < 0
+            || bbuf_put_varint (b, len) < 0
+            || bbuf_put (b, val, len) < 0)
+            rc = -1;
+        ERRNO_SAFE_WRAP (free, val);
+        return rc;
+    }
+    if (streq (type, "valref"))
+        return bbuf_put_blobrefs (b, TYPE_VALREF, data);
+    if (streq (type, "dirref"))
+        return bbuf_put_blobrefs (b, TYPE_DIRREF, data);
+    if (streq (type, "dir")) {
+        if (bbuf_put_byte (b, TYPE_DIR) < 0
+            || bbuf_put_entries (b, data, false) < 0)
+            return -1;
+        return 0;
+    }
+    if (streq (type, "dirshard")) {
+        if (bbuf_put_byte (b, TYPE_DIRSHARD) < 0
+            || bbuf_put_varint (b, treeobj_dirshard_get_level (obj)) < 0
+            || bbuf_put_entries (b,
+                                 json_object_get (data, "buckets"),
+                                 true) < 0)
+            return -1;
+        return 0;
+    }
+    if (streq (type, "symlink")) {
+        const char *ns = NULL;
+        const char *target;
+
+        if (treeobj_get_symlink (obj, &ns, &target) < 0
+            || bbuf_put_byte (b, TYPE_SYMLINK) < 0
+            || bbuf_put_byte (b, ns ? SYMLINK_FLAG_NAMESPACE : 0) < 0
+            || (ns && bbuf_put_string (b, ns) < 0)
+            || bbuf_put_string (b, target) < 0)
+            return -1;
+        return 0;
+    }
+    errno = EINVAL;
+    return -1;
+}
+
+void *treeobj_encode_binary (const json_t *obj, size_t *lenp)
+{
+    struct bbuf b = { 0 };
+
+    if (!lenp || treeobj_validate (obj) < 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (bbuf_put_byte (&b, TREEOBJ_BINARY_MAGIC) < 0
+        || bbuf_put_byte (&b, BINARY_VERSION) < 0
+        || bbuf_put_treeobj (&b, obj) < 0) {
+        ERRNO_SAFE_WRAP (free, b.data);
+        return NULL;
+    }
+    *lenp = b.len;
+    return b.data;
+}
+
+struct bcursor {
+    const unsigned char *p;
+    size_t len;
+};
+
+static int bcursor_get (struct bcursor *c, const void **data, size_t len)
+{
+    if (len > c->len)
+        return -1;
+    *data = c->p;
+    c->p += len;
+    c->len -= len;
+    return 0;
+}
+
+static int bcursor_get_byte (struct bcursor *c, unsigned char *val)
+{
+    const unsigned char *p;
+
+    if (bcursor_get (c, (const void **)&p, 1) < 0)
+        return -1;
+    *val = *p;
+    return 0;
+}
+
+static int bcursor_get_varint (struct bcursor *c, size_t *val)
+{
+    uint64_t result = 0;
+    unsigned char byte;
+    int shift = 0;
+
+    do {
+        if (shift > 56 || bcursor_get_byte (c, &byte) < 0)
+            return -1;
+        result |= (uint64_t)(byte & 0x7f) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    if (result > SIZE_MAX)
+        return -1;
+    *val = result;
+    return 0;
+}
+
+/* Get a length-prefixed string, which may not contain NUL.
+ * The caller must free the result.
+ */
+static char *bcursor_get_string (struct bcursor *c)
+{
+    const void *data;
+    size_t len;
+    char *s;
+
+    if (bcursor_get_varint (c, &len) < 0
+        || bcursor_get (c, &data, len) < 0
+        || memchr (data, '\0', len)
+        || !(s = strndup (data, len)))
+        return NULL;
+    return s;
+}
+
+static json_t *bcursor_get_blobrefs (struct bcursor *c, json_t *obj)
+{
+    size_t count;
+
+    if (!obj || bcursor_get_varint (c, &count) < 0)
+        goto error;
+    while (count-- > 0) {
+        char blobref[BLOBREF_MAX_STRING_SIZE];
+        unsigned char hashtype;
+        const void *hash;
+        ssize_t hash_len;
+
+        if (bcursor_get_byte (c, &hashtype) < 0
+            || hashtype == 0
+            || hashtype >= ARRAY_SIZE (binary_hashtypes)
+            || (hash_len = blobref_validate_hashtype
+                                (binary_hashtypes[hashtype])) < 0
+            || bcursor_get (c, &hash, hash_len) < 0
+            || blobref_hashtostr (binary_hashtypes[hashtype],
+                                  hash,
+                                  hash_len,
+                                  blobref,
+                                  sizeof (blobref)) < 0
+            || treeobj_append_blobref (obj, blobref) < 0)
+            goto error;
+    }
+    return obj;
+error:
+    json_decref (obj);
+    return NULL;
+}
+
+static json_t *bcursor_get_treeobj (struct bcursor *c, int depth);
+
+static json_t *bcursor_get_entries (struct bcursor *c,
+                                    json_t *obj,
+                                    json_t *data,
+                                    int depth)
+{
+    size_t count;
+
+    if (!obj || bcursor_get_varint (c, &count) < 0)
+        goto error;
+    while (count-- > 0) {
+        char bucket[3];
+        char *name = NULL;
+        unsigned char index;
+        json_t *o;
+
+        if (data) {
+            if (bcursor_get_byte (c, &index) < 0)
+                goto error;
+            snprintf (bucket, sizeof (bucket), "%02x", index);
+        }
+        else if (!(name = bcursor_get_string (c)))
+            goto error;
+        if (!(o = bcursor_get_treeobj (c, depth + 1))
+            || json_object_set_new (data ? data : treeobj_get_data (obj),
+                                    data ? bucket : name,
+                                    o) < 0) {
+            free (name);
+            goto error;
+        }
+        free (name);
+    }
+    return obj;
+error:
+    json_decref (obj);
+    return NULL;
+}
+
+static json_t *bcursor_get_treeobj (struct bcursor *c, int depth)
+{
+    unsigned char type;
+
+    if (depth > BINARY_MAXDEPTH || bcursor_get_byte (c, &type) < 0)
+        return NULL;
+    switch (type) {
+        case TYPE_VAL: {
+            const void *data;
+            size_t len;
+
+            if (bcursor_get_varint (c, &len) < 0
+                || len > INT_MAX
+                || bcursor_get (c, &data, len) < 0)
+                return NULL;
+            return treeobj_create_val (data, len);
+        }
+        case TYPE_VALREF:
+            return bcursor_get_blobrefs (c, treeobj_create_valref (NULL));
+        case TYPE_DIRREF:
+            return bcursor_get_blobrefs (c, treeobj_create_dirref (NULL));
+        case TYPE_DIR:
+            return bcursor_get_entries (c, treeobj_create_dir (), NULL, depth);
+        case TYPE_DIRSHARD: {
+            json_t *obj;
+            size_t level;
+
+            if (bcursor_get_varint (c, &level) < 0
+                || level > TREEOBJ_DIRSHARD_MAXLEVEL
+                || !(obj = treeobj_create_dirshard (level)))
+                return NULL;
+            return bcursor_get_entries (c,
+                                        obj,
+                                        treeobj_dirshard_get_buckets (obj),
+                                        depth);
+        }
+        case TYPE_SYMLINK: {
+            unsigned char flags;
+            char *ns = NULL;
+            char *target = NULL;
+            json_t *obj = NULL;
+
+            if (bcursor_get_byte (c, &flags) == 0
+                && (!(flags & SYMLINK_FLAG_NAMESPACE)
+                    || (ns = bcursor_get_string (c)))
+                && (target = bcursor_get_string (c)))
+                obj = treeobj_create_symlink (ns, target);
+            free (ns);
+            free (target);
+            return obj;
+        }
+    }
+    return NULL;
+}
+
+static json_t *treeobj_decode_binary (const char *buf, size_t buflen)
+{
+    struct bcursor c = { .p = (const unsigned char *)buf, .len = buflen };
+    unsigned char magic, version;
+    json_t *obj;
+
+    if (bcursor_get_byte (&c, &magic) < 0
+        || magic != TREEOBJ_BINARY_MAGIC
+        || bcursor_get_byte (&c, &version) < 0
+        || version != BINARY_VERSION
+        || !(obj = bcursor_get_treeobj (&c, 0)))
+        return NULL;
+    if (c.len > 0) {
+        json_decref (obj);
+        return NULL;
+    }
+    return obj;
+}
+
 json_t *treeobj_decode (const char *buf)
 {
     if (!buf) {
@@ -632,8 +1311,12 @@ json_t *treeobj_decode (const char *buf)
 json_t *treeobj_decodeb (const char *buf, size_t buflen)
 {
     json_t *obj = NULL;
-    if (!(obj = json_loadb (buf, buflen, 0, NULL))
-        || treeobj_validate (obj) < 0) {
+
+    if (buf && buflen > 0 && (unsigned char)buf[0] == TREEOBJ_BINARY_MAGIC)
+        obj = treeobj_decode_binary (buf, buflen);
+    else
+        obj = json_loadb (buf, buflen, 0, NULL);
+    if (!obj || treeobj_validate (obj) < 0) {
         errno = EPROTO;
         goto error;
     }
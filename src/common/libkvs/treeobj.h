@@ -45,6 +45,7 @@ bool treeobj_is_val (const json_t *obj);
 bool treeobj_is_valref (const json_t *obj);
 bool treeobj_is_dir (const json_t *obj);
 bool treeobj_is_dirref (const json_t *obj);
+bool treeobj_is_dirshard (const json_t *obj);
 
 /* get type-specific value.
  * For dirref/valref, this is an array of blobrefs.
@@ -72,6 +73,7 @@ int treeobj_decode_val (const json_t *obj, void **data, int *len);
 /* get type-specific count.
  * For dirref/valref, this is the number of blobrefs.
  * For directory, this is number of entries
+ * For dirshard, this is the number of buckets.
  * For symlink or val, this is 1.
  * Return count on success, -1 on error with errno = EINVAL.
  */
@@ -130,6 +132,43 @@ json_t *treeobj_create_valref_buf (const char *hashtype,
                                    void *data,
                                    int len);
 
+/* Sharded directories (a flux-core extension to RFC 11).
+ *
+ * A dirshard holds the entries of one large directory spread over up to
+ * 256 buckets, so that a change only rewrites the bucket holding the
+ * changed entry.  Its data is an object:
+ *
+ *   { "level":i, "buckets":{ "xx":treeobj, ... } }
+ *
+ * where "xx" is byte 'level' of the 32-bit FNV-1a hash of an entry name,
+ * in lowercase hex.  A bucket is a dir, a dirshard of the next level, or
+ * a dirref to either.  Only levels 0 to TREEOBJ_DIRSHARD_MAXLEVEL exist.
+ * A dirshard is only ever reached through a dirref (or inline during a
+ * KVS commit), never as the root directory.
+ */
+#define TREEOBJ_DIRSHARD_MAXLEVEL 3
+
+json_t *treeobj_create_dirshard (int level);
+int treeobj_dirshard_get_level (const json_t *obj);
+
+/* Return the buckets dictionary, owned by 'obj'.
+ */
+json_t *treeobj_dirshard_get_buckets (json_t *obj);
+
+/* get/set the bucket that entry 'name' belongs in.  Get returns NULL
+ * with errno = ENOENT if the bucket does not exist.  Set takes a
+ * reference on 'bucket' (caller retains ownership).
+ */
+json_t *treeobj_dirshard_get_bucket (json_t *obj, const char *name);
+const json_t *treeobj_dirshard_peek_bucket (const json_t *obj,
+                                            const char *name);
+int treeobj_dirshard_set_bucket (json_t *obj, const char *name, json_t *bucket);
+
+/* Create a dirshard at 'level' holding the entries of 'dir' in inline
+ * dir buckets.  The entries are shared with 'dir', not copied.
+ */
+json_t *treeobj_dirshard_split (const json_t *dir, int level);
+
 /* Convert a treeobj to/from string.
  * The return value of treeobj_decode must be destroyed with json_decref().
  * The return value of treeobj_encode must be destroyed with free().
@@ -138,6 +177,16 @@ json_t *treeobj_decode (const char *buf);
 json_t *treeobj_decodeb (const char *buf, size_t buflen);
 char *treeobj_encode (const json_t *obj);
 
+/* Convert a treeobj to a compact binary encoding, with raw val data and
+ * binary blobrefs, returning the length in 'lenp'.  Binary encodings
+ * begin with TREEOBJ_BINARY_MAGIC, which cannot start a JSON text, and
+ * treeobj_decodeb() accepts either encoding.
+ * The return value must be destroyed with free().
+ */
+#define TREEOBJ_BINARY_MAGIC 0xff
+
+void *treeobj_encode_binary (const json_t *obj, size_t *lenp);
+
 #endif /* !_FLUX_KVS_TREEOBJ_H */
 
 /*
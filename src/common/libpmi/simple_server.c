@@ -224,6 +224,7 @@ int pmi_simple_server_request (struct pmi_simple_server *pmi,
                                int rank)
 {
     char resp[SIMPLE_MAX_PROTO_LINE+1];
+    char cmd[32];
     int rc = 0;
     struct client *cli;
 
@@ -246,8 +247,20 @@ int pmi_simple_server_request (struct pmi_simple_server *pmi,
         snprintf (resp, sizeof (resp), "cmd=spawn_result rc=-1\n");
         cli->mcmd_started = false;
     }
+    /* Extract the command name once, then dispatch on it, rather than
+     * scanning the line for each possible "cmd=" value in turn.
+     * Lines without one may only start a multi-line spawn command.
+     */
+    else if (keyval_parse_word (buf, "cmd", cmd, sizeof (cmd)) < 0) {
+        /* spawn */
+        if (keyval_parse_isword (buf, "mcmd", "spawn") < 0)
+            goto proto;
+        /* FIXME - not implemented */
+        cli->mcmd_started = true;
+        goto out_noresponse;
+    }
     /* init */
-    else if (keyval_parse_isword (buf, "cmd", "init") == 0) {
+    else if (streq (cmd, "init")) {
         unsigned int pmi_version, pmi_subversion;
         if (keyval_parse_uint (buf, "pmi_version", &pmi_version) < 0)
             goto proto;
@@ -271,7 +284,7 @@ int pmi_simple_server_request (struct pmi_simple_server *pmi,
         }
     }
     /* maxes */
-    else if (keyval_parse_isword (buf, "cmd", "get_maxes") == 0) {
+    else if (streq (cmd, "get_maxes")) {
         snprintf (resp,
                   sizeof (resp),
                   "cmd=maxes rc=0 kvsname_max=%d keylen_max=%d vallen_max=%d\n",
@@ -280,7 +293,7 @@ int pmi_simple_server_request (struct pmi_simple_server *pmi,
                   SIMPLE_KVS_VAL_MAX);
     }
     /* abort */
-    else if (keyval_parse_isword (buf, "cmd", "abort") == 0) {
+    else if (streq (cmd, "abort")) {
         unsigned int code;
         char msg[SIMPLE_KVS_VAL_MAX];
 
@@ -299,32 +312,32 @@ int pmi_simple_server_request (struct pmi_simple_server *pmi,
         /*  Abort call above should kill program, o/w continue as before */
     }
     /* finalize */
-    else if (keyval_parse_isword (buf, "cmd", "finalize") == 0) {
+    else if (streq (cmd, "finalize")) {
         snprintf (resp, sizeof (resp), "cmd=finalize_ack rc=0\n");
         rc = 1; /* Indicates fd should be closed */
     }
     /* universe */
-    else if (keyval_parse_isword (buf, "cmd", "get_universe_size") == 0) {
+    else if (streq (cmd, "get_universe_size")) {
         snprintf (resp,
                   sizeof (resp),
                   "cmd=universe_size rc=0 size=%d\n",
                   pmi->universe_size);
     }
     /* appnum */
-    else if (keyval_parse_isword (buf, "cmd", "get_appnum") == 0) {
+    else if (streq (cmd, "get_appnum")) {
         snprintf (resp,
                   sizeof (resp), "cmd=appnum rc=0 appnum=%d\n",
                   pmi->appnum);
     }
     /* kvsname */
-    else if (keyval_parse_isword (buf, "cmd", "get_my_kvsname") == 0) {
+    else if (streq (cmd, "get_my_kvsname")) {
         snprintf (resp,
                   sizeof (resp),
                   "cmd=my_kvsname rc=0 kvsname=%s\n",
                   pmi->kvsname);
     }
     /* put */
-    else if (keyval_parse_isword (buf, "cmd", "put") == 0) {
+    else if (streq (cmd, "put")) {
         char name[SIMPLE_KVS_NAME_MAX];
         char key[SIMPLE_KVS_KEY_MAX];
         char val[SIMPLE_KVS_VAL_MAX];
@@ -358,7 +371,7 @@ put_respond:
         snprintf (resp, sizeof (resp), "cmd=put_result rc=%d\n", result);
     }
     /* get */
-    else if (keyval_parse_isword (buf, "cmd", "get") == 0) {
+    else if (streq (cmd, "get")) {
         char name[SIMPLE_KVS_NAME_MAX];
         char key[SIMPLE_KVS_KEY_MAX];
         int result = keyval_parse_word (buf, "kvsname", name, sizeof (name));
@@ -384,7 +397,7 @@ get_respond:
         return (pmi_simple_server_kvs_get_error (pmi, client, result));
     }
     /* barrier */
-    else if (keyval_parse_isword (buf, "cmd", "barrier_in") == 0) {
+    else if (streq (cmd, "barrier_in")) {
         if (++pmi->local_barrier_count == pmi->local_size) {
             if (pmi->ops.barrier_enter) {
                 if (pmi->ops.barrier_enter (pmi->arg) < 0)
@@ -396,30 +409,23 @@ get_respond:
         }
     }
     /* publish */
-    else if (keyval_parse_isword (buf, "cmd", "publish_name") == 0) {
+    else if (streq (cmd, "publish_name")) {
         /* FIXME - not implemented */
         snprintf (resp, sizeof (resp), "cmd=publish_result rc=-1 msg=%s\n",
                   "command not implemented");
     }
     /* unpublish */
-    else if (keyval_parse_isword (buf, "cmd", "unpublish_name") == 0) {
+    else if (streq (cmd, "unpublish_name")) {
         /* FIXME - not implemented */
         snprintf (resp, sizeof (resp), "cmd=unpublish_result rc=-1 msg=%s\n",
                   "command not implemented");
     }
     /* lookup */
-    else if (keyval_parse_isword (buf, "cmd", "lookup_name") == 0) {
+    else if (streq (cmd, "lookup_name")) {
         /* FIXME - not implemented */
         snprintf (resp, sizeof (resp), "cmd=lookup_result rc=-1 msg=%s\n",
                   "command not implemented");
     }
-    /* spawn */
-    else if (keyval_parse_isword (buf, "mcmd", "spawn") == 0) {
-        /* FIXME - not implemented */
-        cli->mcmd_started = true;
-        goto out_noresponse;
-    }
-
     /* unknown command */
     else
         goto proto;
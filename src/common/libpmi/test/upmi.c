@@ -13,6 +13,8 @@
 #endif
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
 
 #include "src/common/libtap/tap.h"
 #include "ccan/str/str.h"
@@ -166,6 +168,103 @@ void test_env (void)
     (void)unsetenv ("FLUX_PMI_CLIENT_SEARCHPATH");
 }
 
+#define SHM_SIZE 8
+
+/* Run in a child process as 'rank' of a SHM_SIZE job.
+ * Return 0 on success, or the failing step number.
+ */
+static int shm_client (const char *uri, int rank)
+{
+    char buf[16];
+    struct upmi *upmi;
+    struct upmi_info info;
+    char key[64];
+    char val[64];
+    char *cp;
+
+    snprintf (buf, sizeof (buf), "%d", rank);
+    if (setenv ("PMI_RANK", buf, 1) < 0)
+        return 1;
+    snprintf (buf, sizeof (buf), "%d", SHM_SIZE);
+    if (setenv ("PMI_SIZE", buf, 1) < 0)
+        return 1;
+    if (!(upmi = upmi_create (uri, 0, NULL, NULL, NULL)))
+        return 2;
+    if (upmi_initialize (upmi, &info, NULL) < 0
+        || info.rank != rank
+        || info.size != SHM_SIZE)
+        return 3;
+    for (int n = 0; n < 2; n++) {
+        snprintf (key, sizeof (key), "key.%d.%d", n, rank);
+        snprintf (val, sizeof (val), "val.%d.%d", n, rank);
+        if (upmi_put (upmi, key, val, NULL) < 0)
+            return 4;
+        if (upmi_barrier (upmi, NULL) < 0)
+            return 5;
+        for (int i = 0; i < SHM_SIZE; i++) {
+            snprintf (key, sizeof (key), "key.%d.%d", n, i);
+            snprintf (val, sizeof (val), "val.%d.%d", n, i);
+            if (upmi_get (upmi, key, i, &cp, NULL) < 0)
+                return 6;
+            if (!streq (cp, val))
+                return 7;
+            free (cp);
+        }
+    }
+    if (upmi_get (upmi, "notakey", -1, &cp, NULL) == 0)
+        return 8;
+    if (upmi_finalize (upmi, NULL) < 0)
+        return 9;
+    upmi_destroy (upmi);
+    return 0;
+}
+
+void test_shm (void)
+{
+    char uri[64];
+    char path[128];
+    pid_t pid[SHM_SIZE];
+    struct upmi *upmi;
+    flux_error_t error;
+    int failed = 0;
+
+    snprintf (uri, sizeof (uri), "shm:test-upmi-%d", (int)getpid ());
+    for (int i = 0; i < SHM_SIZE; i++) {
+        if ((pid[i] = fork ()) < 0)
+            BAIL_OUT ("fork failed");
+        if (pid[i] == 0)
+            _exit (shm_client (uri, i));
+    }
+    for (int i = 0; i < SHM_SIZE; i++) {
+        int status = 0;
+        if (waitpid (pid[i], &status, 0) < 0
+            || !WIFEXITED (status)
+            || WEXITSTATUS (status) != 0) {
+            diag ("rank %d failed: status 0x%x", i, status);
+            failed++;
+        }
+    }
+    ok (failed == 0,
+        "%d processes exchanged keys with method=shm", SHM_SIZE);
+    snprintf (path, sizeof (path), "/dev/shm/%s", uri + 4);
+    ok (access (path, F_OK) < 0,
+        "shared memory segment was unlinked");
+
+    (void)unsetenv ("FLUX_PMI_SHM");
+    (void)setenv ("PMI_RANK", "0", 1);
+    (void)setenv ("PMI_SIZE", "1", 1);
+    upmi = upmi_create ("shm", 0, NULL, NULL, &error);
+    ok (upmi == NULL,
+        "upmi_create spec=shm fails without a segment name");
+    diag ("%s", error.text);
+    (void)unsetenv ("PMI_RANK");
+    upmi = upmi_create (uri, 0, NULL, NULL, &error);
+    ok (upmi == NULL,
+        "upmi_create spec=shm fails without PMI_RANK");
+    diag ("%s", error.text);
+    (void)unsetenv ("PMI_SIZE");
+}
+
 int main (int argc, char **argv)
 {
     plan (NO_PLAN);
@@ -177,6 +276,7 @@ int main (int argc, char **argv)
     test_inval ();
     test_dso ();
     test_env ();
+    test_shm ();
 
     done_testing ();
     return 0;
@@ -57,12 +57,14 @@ int upmi_simple_init (flux_plugin_t *p);
 int upmi_libpmi2_init (flux_plugin_t *p);
 int upmi_libpmi_init (flux_plugin_t *p);
 int upmi_single_init (flux_plugin_t *p);
+int upmi_shm_init (flux_plugin_t *p);
 
 static flux_plugin_init_f builtins[] = {
     &upmi_simple_init,
     &upmi_libpmi2_init,
     &upmi_libpmi_init,
     &upmi_single_init,
+    &upmi_shm_init,
 };
 
 static const char *default_methods = "simple libpmi2 libpmi single";
@@ -0,0 +1,439 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* upmi_shm.c - exchange PMI keys through a node-local shared memory segment
+ *
+ * All processes that share a segment name form one PMI job.  Rank and size
+ * are taken from PMI_RANK and PMI_SIZE.  The segment name is taken from the
+ * URI path (shm:NAME) or from FLUX_PMI_SHM, and should be unique to the job,
+ * e.g. include the jobid.
+ *
+ * The first process to open the segment initializes it.  The segment holds
+ * a process-shared mutex and condition variable for the barrier, and an
+ * append-only area of key/value records.  Each process indexes records
+ * into a local dictionary as they are needed, so a get costs one lock
+ * acquisition plus a hash lookup.  The segment name is unlinked as soon
+ * as all ranks have attached, so nothing is left behind in /dev/shm if
+ * the job later terminates abnormally.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <jansson.h>
+#include <flux/core.h>
+
+#include "src/common/libutil/errprintf.h"
+#include "src/common/libutil/monotime.h"
+
+#include "upmi.h"
+#include "upmi_plugin.h"
+
+#define SHM_MAGIC       0x666c7078
+#define SHM_SIZE        (64*1024*1024) // sparse: untouched pages cost nothing
+
+/* How long a process waits for the segment to be created and initialized.
+ */
+static const double attach_timeout = 60.;
+
+struct shm_header {
+    uint32_t magic;
+    int size;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int attached;
+    int barrier_count;
+    unsigned int barrier_gen;
+    size_t used;            // bytes of data[] in use
+    char data[];
+};
+
+struct shm_record {
+    uint32_t keylen;        // not including \0
+    uint32_t vallen;        // not including \0
+    char data[];            // key \0 value \0
+};
+
+struct plugin_ctx {
+    char *name;             // shm_open(3) name, with leading slash
+    int rank;
+    int size;
+    struct shm_header *hdr;
+    size_t scanned;         // records below this offset are in index
+    json_t *index;
+};
+
+static const char *plugin_name = "shm";
+
+static void shm_lock (struct shm_header *hdr)
+{
+    if (pthread_mutex_lock (&hdr->lock) == EOWNERDEAD)
+        pthread_mutex_consistent (&hdr->lock);
+}
+
+static void shm_unlock (struct shm_header *hdr)
+{
+    pthread_mutex_unlock (&hdr->lock);
+}
+
+static size_t record_size (size_t keylen, size_t vallen)
+{
+    size_t n = sizeof (struct shm_record) + keylen + vallen + 2;
+    return (n + 7) & ~(size_t)7;
+}
+
+static int shm_init (struct shm_header *hdr, int size)
+{
+    pthread_mutexattr_t mattr;
+    pthread_condattr_t cattr;
+
+    if (pthread_mutexattr_init (&mattr) != 0)
+        return -1;
+    if (pthread_mutexattr_setpshared (&mattr, PTHREAD_PROCESS_SHARED) != 0
+        || pthread_mutexattr_setrobust (&mattr, PTHREAD_MUTEX_ROBUST) != 0
+        || pthread_mutex_init (&hdr->lock, &mattr) != 0) {
+        pthread_mutexattr_destroy (&mattr);
+        return -1;
+    }
+    pthread_mutexattr_destroy (&mattr);
+    if (pthread_condattr_init (&cattr) != 0)
+        return -1;
+    if (pthread_condattr_setpshared (&cattr, PTHREAD_PROCESS_SHARED) != 0
+        || pthread_cond_init (&hdr->cond, &cattr) != 0) {
+        pthread_condattr_destroy (&cattr);
+        return -1;
+    }
+    pthread_condattr_destroy (&cattr);
+    hdr->size = size;
+    __atomic_store_n (&hdr->magic, SHM_MAGIC, __ATOMIC_RELEASE);
+    return 0;
+}
+
+/* Open the segment, creating it if this is the first process to arrive,
+ * then wait for the creator to size and initialize it.
+ */
+static int shm_attach (struct plugin_ctx *ctx, flux_error_t *error)
+{
+    struct timespec t0;
+    struct stat sb;
+    bool creator = false;
+    void *p;
+    int fd;
+
+    monotime (&t0);
+    if ((fd = shm_open (ctx->name, O_RDWR | O_CREAT | O_EXCL, 0600)) >= 0)
+        creator = true;
+    else if (errno == EEXIST)
+        fd = shm_open (ctx->name, O_RDWR, 0);
+    if (fd < 0)
+        return errprintf (error, "shm_open %s: %s", ctx->name, strerror (errno));
+    if (creator) {
+        if (ftruncate (fd, SHM_SIZE) < 0) {
+            errprintf (error, "ftruncate %s: %s", ctx->name, strerror (errno));
+            goto error;
+        }
+    }
+    else {
+        while (fstat (fd, &sb) == 0 && sb.st_size < SHM_SIZE) {
+            if (monotime_since (t0) / 1000 > attach_timeout) {
+                errprintf (error, "timed out waiting for %s", ctx->name);
+                goto error;
+            }
+            usleep (1000);
+        }
+    }
+    p = mmap (NULL, SHM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        errprintf (error, "mmap %s: %s", ctx->name, strerror (errno));
+        goto error;
+    }
+    close (fd);
+    ctx->hdr = p;
+    if (creator) {
+        if (shm_init (ctx->hdr, ctx->size) < 0) {
+            (void)shm_unlink (ctx->name);
+            return errprintf (error, "error initializing %s", ctx->name);
+        }
+    }
+    else {
+        while (__atomic_load_n (&ctx->hdr->magic, __ATOMIC_ACQUIRE)
+               != SHM_MAGIC) {
+            if (monotime_since (t0) / 1000 > attach_timeout)
+                return errprintf (error, "timed out waiting for %s", ctx->name);
+            usleep (1000);
+        }
+    }
+    if (ctx->hdr->size != ctx->size) {
+        return errprintf (error,
+                          "%s: size %d does not match PMI_SIZE %d",
+                          ctx->name,
+                          ctx->hdr->size,
+                          ctx->size);
+    }
+    shm_lock (ctx->hdr);
+    if (++ctx->hdr->attached == ctx->size)
+        (void)shm_unlink (ctx->name);
+    shm_unlock (ctx->hdr);
+    return 0;
+error:
+    if (creator)
+        (void)shm_unlink (ctx->name);
+    close (fd);
+    return -1;
+}
+
+/* Add records appended since the last call to the local index.
+ * Call with the segment locked.
+ */
+static int shm_index_update (struct plugin_ctx *ctx)
+{
+    while (ctx->scanned < ctx->hdr->used) {
+        struct shm_record *rec;
+        json_t *o;
+
+        rec = (struct shm_record *)(ctx->hdr->data + ctx->scanned);
+        if (!(o = json_string (rec->data + rec->keylen + 1))
+            || json_object_set_new (ctx->index, rec->data, o) < 0) {
+            json_decref (o);
+            return -1;
+        }
+        ctx->scanned += record_size (rec->keylen, rec->vallen);
+    }
+    return 0;
+}
+
+static void plugin_ctx_destroy (struct plugin_ctx *ctx)
+{
+    if (ctx) {
+        int saved_errno = errno;
+        if (ctx->hdr)
+            (void)munmap (ctx->hdr, SHM_SIZE);
+        json_decref (ctx->index);
+        free (ctx->name);
+        free (ctx);
+        errno = saved_errno;
+    }
+}
+
+static struct plugin_ctx *plugin_ctx_create (const char *name,
+                                             flux_error_t *error)
+{
+    struct plugin_ctx *ctx;
+    const char *s;
+    char *endptr;
+
+    if (!(ctx = calloc (1, sizeof (*ctx)))
+        || !(ctx->index = json_object ())
+        || asprintf (&ctx->name, "%s%s", name[0] == '/' ? "" : "/", name) < 0) {
+        errprintf (error, "out of memory");
+        goto error;
+    }
+    if (!(s = getenv ("PMI_RANK"))
+        || (errno = 0, ctx->rank = strtol (s, &endptr, 10), errno != 0)
+        || *endptr != '\0'
+        || ctx->rank < 0) {
+        errprintf (error, "PMI_RANK is missing or invalid");
+        goto error;
+    }
+    if (!(s = getenv ("PMI_SIZE"))
+        || (errno = 0, ctx->size = strtol (s, &endptr, 10), errno != 0)
+        || *endptr != '\0'
+        || ctx->size <= ctx->rank) {
+        errprintf (error, "PMI_SIZE is missing or invalid");
+        goto error;
+    }
+    return ctx;
+error:
+    plugin_ctx_destroy (ctx);
+    return NULL;
+}
+
+static int op_put (flux_plugin_t *p,
+                   const char *topic,
+                   flux_plugin_arg_t *args,
+                   void *data)
+{
+    struct plugin_ctx *ctx = flux_plugin_aux_get (p, plugin_name);
+    const char *key;
+    const char *value;
+    struct shm_record *rec;
+    size_t keylen;
+    size_t vallen;
+    size_t n;
+
+    if (flux_plugin_arg_unpack (args,
+                                FLUX_PLUGIN_ARG_IN,
+                                "{s:s s:s}",
+                                "key", &key,
+                                "value", &value) < 0)
+        return upmi_seterror (p, args, "error unpacking put arguments");
+    keylen = strlen (key);
+    vallen = strlen (value);
+    n = record_size (keylen, vallen);
+
+    shm_lock (ctx->hdr);
+    if (ctx->hdr->used + n > SHM_SIZE - sizeof (struct shm_header)) {
+        shm_unlock (ctx->hdr);
+        return upmi_seterror (p, args, "shared memory segment is full");
+    }
+    rec = (struct shm_record *)(ctx->hdr->data + ctx->hdr->used);
+    rec->keylen = keylen;
+    rec->vallen = vallen;
+    memcpy (rec->data, key, keylen + 1);
+    memcpy (rec->data + keylen + 1, value, vallen + 1);
+    ctx->hdr->used += n;
+    shm_unlock (ctx->hdr);
+    return 0;
+}
+
+static int op_get (flux_plugin_t *p,
+                   const char *topic,
+                   flux_plugin_arg_t *args,
+                   void *data)
+{
+    struct plugin_ctx *ctx = flux_plugin_aux_get (p, plugin_name);
+    const char *key;
+    const char *value;
+    int rc;
+
+    if (flux_plugin_arg_unpack (args,
+                                FLUX_PLUGIN_ARG_IN,
+                                "{s:s}",
+                                "key", &key) < 0)
+        return upmi_seterror (p, args, "error unpacking get arguments");
+
+    shm_lock (ctx->hdr);
+    rc = shm_index_update (ctx);
+    shm_unlock (ctx->hdr);
+    if (rc < 0)
+        return upmi_seterror (p, args, "dictionary update error");
+
+    if (json_unpack (ctx->index, "{s:s}", key, &value) < 0)
+        return upmi_seterror (p, args, "key not found");
+
+    if (flux_plugin_arg_pack (args,
+                              FLUX_PLUGIN_ARG_OUT,
+                              "{s:s}",
+                              "value", value) < 0)
+        return -1;
+    return 0;
+}
+
+static int op_barrier (flux_plugin_t *p,
+                       const char *topic,
+                       flux_plugin_arg_t *args,
+                       void *data)
+{
+    struct plugin_ctx *ctx = flux_plugin_aux_get (p, plugin_name);
+    struct shm_header *hdr = ctx->hdr;
+    unsigned int gen;
+
+    shm_lock (hdr);
+    gen = hdr->barrier_gen;
+    if (++hdr->barrier_count == hdr->size) {
+        hdr->barrier_count = 0;
+        hdr->barrier_gen++;
+        pthread_cond_broadcast (&hdr->cond);
+    }
+    else {
+        while (hdr->barrier_gen == gen) {
+            if (pthread_cond_wait (&hdr->cond, &hdr->lock) == EOWNERDEAD)
+                pthread_mutex_consistent (&hdr->lock);
+        }
+    }
+    shm_unlock (hdr);
+    return 0;
+}
+
+static int op_initialize (flux_plugin_t *p,
+                          const char *topic,
+                          flux_plugin_arg_t *args,
+                          void *data)
+{
+    struct plugin_ctx *ctx = flux_plugin_aux_get (p, plugin_name);
+    flux_error_t error;
+
+    if (shm_attach (ctx, &error) < 0)
+        return upmi_seterror (p, args, "%s", error.text);
+    if (flux_plugin_arg_pack (args,
+                              FLUX_PLUGIN_ARG_OUT,
+                              "{s:i s:s s:i}",
+                              "rank", ctx->rank,
+                              "name", ctx->name + 1,
+                              "size", ctx->size) < 0)
+        return -1;
+    return 0;
+}
+
+static int op_finalize (flux_plugin_t *p,
+                        const char *topic,
+                        flux_plugin_arg_t *args,
+                        void *data)
+{
+    return 0;
+}
+
+static int op_preinit (flux_plugin_t *p,
+                       const char *topic,
+                       flux_plugin_arg_t *args,
+                       void *data)
+{
+    struct plugin_ctx *ctx;
+    flux_error_t error;
+    const char *path = NULL;
+
+    if (flux_plugin_arg_unpack (args,
+                                FLUX_PLUGIN_ARG_IN,
+                                "{s?s}",
+                                "path", &path) < 0)
+        return upmi_seterror (p, args, "error unpacking preinit arguments");
+    if (!path)
+        path = getenv ("FLUX_PMI_SHM");
+    if (!path || strlen (path) == 0)
+        return upmi_seterror (p, args, "FLUX_PMI_SHM not found in environ");
+    if (!(ctx = plugin_ctx_create (path, &error)))
+        return upmi_seterror (p, args, "%s", error.text);
+    if (flux_plugin_aux_set (p,
+                             plugin_name,
+                             ctx,
+                             (flux_free_f)plugin_ctx_destroy) < 0) {
+        plugin_ctx_destroy (ctx);
+        return upmi_seterror (p, args, "%s", strerror (errno));
+    }
+    return 0;
+}
+
+static const struct flux_plugin_handler optab[] = {
+    { "upmi.put",           op_put,         NULL },
+    { "upmi.get",           op_get,         NULL },
+    { "upmi.barrier",       op_barrier,     NULL },
+    { "upmi.initialize",    op_initialize,  NULL },
+    { "upmi.finalize",      op_finalize,    NULL },
+    { "upmi.preinit",       op_preinit,     NULL },
+    { 0 },
+};
+
+int upmi_shm_init (flux_plugin_t *p)
+{
+    if (flux_plugin_register (p, plugin_name, optab) < 0)
+        return -1;
+    return 0;
+}
+
+// vi:ts=4 sw=4 expandtab
@@ -81,6 +81,97 @@ static void rank_hash_purge (struct rlist *rl)
     zhashx_purge (rl->rank_index);
 }
 
+/*  Index of up nodes with available cores. buckets[k] is the set of
+ *   ranks with exactly k available cores, so the allocators can find
+ *   nodes with room for a slot without sorting the whole node list.
+ *
+ *  The index is built on first use. Callers that change the available
+ *   cores or up state of a node remove it from the index beforehand and
+ *   insert it again afterward. Callers that renumber ranks invalidate it.
+ */
+struct avail_index {
+    struct idset **buckets;
+    size_t size;
+};
+
+static void avail_index_destroy (struct avail_index *idx)
+{
+    if (idx) {
+        int saved_errno = errno;
+        for (size_t i = 0; i < idx->size; i++)
+            idset_destroy (idx->buckets[i]);
+        free (idx->buckets);
+        free (idx);
+        errno = saved_errno;
+    }
+}
+
+static void avail_index_invalidate (struct rlist *rl)
+{
+    avail_index_destroy (rl->avail_index);
+    rl->avail_index = NULL;
+}
+
+static int avail_index_grow (struct avail_index *idx, size_t size)
+{
+    struct idset **buckets;
+
+    if (!(buckets = realloc (idx->buckets, size * sizeof (*buckets))))
+        return -1;
+    memset (buckets + idx->size, 0, (size - idx->size) * sizeof (*buckets));
+    idx->buckets = buckets;
+    idx->size = size;
+    return 0;
+}
+
+static void avail_index_insert (struct rlist *rl, struct rnode *n)
+{
+    struct avail_index *idx = rl->avail_index;
+    size_t avail;
+
+    if (!idx || (avail = rnode_avail (n)) == 0)
+        return;
+    if ((avail >= idx->size && avail_index_grow (idx, avail + 1) < 0)
+        || (!idx->buckets[avail]
+            && !(idx->buckets[avail] = idset_create (0, IDSET_FLAG_AUTOGROW)))
+        || idset_set (idx->buckets[avail], n->rank) < 0) {
+        /*  Drop the index rather than let it go stale. It will be
+         *   rebuilt on the next allocation.
+         */
+        avail_index_invalidate (rl);
+    }
+}
+
+static void avail_index_remove (struct rlist *rl, struct rnode *n)
+{
+    struct avail_index *idx = rl->avail_index;
+    size_t avail;
+
+    if (idx
+        && (avail = rnode_avail (n)) > 0
+        && avail < idx->size
+        && idx->buckets[avail])
+        (void) idset_clear (idx->buckets[avail], n->rank);
+}
+
+static struct avail_index *avail_index_get (struct rlist *rl)
+{
+    struct rnode *n;
+
+    if (!rl->avail_index) {
+        if (!(rl->avail_index = calloc (1, sizeof (*rl->avail_index))))
+            return NULL;
+        n = zlistx_first (rl->nodes);
+        while (n && rl->avail_index) {
+            avail_index_insert (rl, n);
+            n = zlistx_next (rl->nodes);
+        }
+        if (!rl->avail_index)
+            errno = ENOMEM;
+    }
+    return rl->avail_index;
+}
+
 static int
 sprintfcat (char **s, size_t *sz, size_t *lenp, const char *fmt, ...)
 {
@@ -110,6 +201,7 @@ void rlist_destroy (struct rlist *rl)
 {
     if (rl) {
         int saved_errno = errno;
+        avail_index_destroy (rl->avail_index);
         zlistx_destroy (&rl->nodes);
         zhashx_destroy (&rl->noremap);
         zhashx_destroy (&rl->rank_index);
@@ -193,6 +285,7 @@ static int rlist_add_rnode_new (struct rlist *rl, struct rnode *n)
     if (rank_hash_insert (rl, n) < 0)
         return -1;
     rlist_update_totals (rl, n);
+    avail_index_insert (rl, n);
     return 0;
 }
 
@@ -204,7 +297,11 @@ static int rlist_add_rnode (struct rlist *rl, struct rnode *n)
 {
     struct rnode *found = rlist_find_rank (rl, n->rank);
     if (found) {
-        if (rnode_add (found, n) < 0)
+        int rc;
+        avail_index_remove (rl, found);
+        rc = rnode_add (found, n);
+        avail_index_insert (rl, found);
+        if (rc < 0)
             return -1;
         rlist_update_totals (rl, n);
         rnode_destroy (n);
@@ -284,6 +381,18 @@ struct rlist *rlist_copy_cores (const struct rlist *orig)
     return rlist_copy_internal (orig, copy_cores, NULL);
 }
 
+static struct rnode *copy_avail (const struct rnode *rnode, void *arg)
+{
+    if (!rnode->up)
+        return NULL;
+    return rnode_copy_avail (rnode);
+}
+
+struct rlist *rlist_copy_avail (const struct rlist *orig)
+{
+    return rlist_copy_internal (orig, copy_avail, NULL);
+}
+
 struct rlist *rlist_copy_down (const struct rlist *orig)
 {
     struct rnode *n;
@@ -400,6 +509,7 @@ static int rlist_remove_rank (struct rlist *rl, int rank)
         errno = ENOENT;
         return -1;
     }
+    avail_index_remove (rl, n);
     rank_hash_delete (rl, rank);
     zlistx_delete (rl->nodes, handle);
     return 0;
@@ -423,6 +533,7 @@ int rlist_remap (struct rlist *rl)
     uint32_t rank = 0;
     struct rnode *n;
 
+    avail_index_invalidate (rl);
     rank_hash_purge (rl);
 
     /*   Sort list by ascending rank, then rerank starting at 0
@@ -504,6 +615,7 @@ int rlist_rerank (struct rlist *rl, const char *hosts, flux_error_t *errp)
         goto done;
     }
 
+    avail_index_invalidate (rl);
     rank_hash_purge (rl);
 
     /* Save original rank mapping in case of undo
@@ -529,6 +641,7 @@ static struct rnode *rlist_detach_rank (struct rlist *rl, uint32_t rank)
 {
     struct rnode *n = rlist_find_rank (rl, rank);
     if (n) {
+        avail_index_remove (rl, n);
         zlistx_detach (rl->nodes, zlistx_find (rl->nodes, n));
         rank_hash_delete (rl, rank);
     }
@@ -909,11 +1022,15 @@ int rlist_rank_add_child (struct rlist *rl,
                           const char *ids)
 {
     struct rnode *n = rlist_find_rank (rl, rank);
+    struct rnode_child *c;
     if (!n) {
         errno = ENOENT;
         return -1;
     }
-    if (rnode_add_child (n, name, ids) == NULL)
+    avail_index_remove (rl, n);
+    c = rnode_add_child (n, name, ids);
+    avail_index_insert (rl, n);
+    if (c == NULL)
         return -1;
     return 0;
 }
@@ -924,17 +1041,34 @@ static int rlist_append_ranks (struct rlist *rl,
 {
     int rc = -1;
     unsigned int i;
+    struct rnode *template = NULL;
     struct idset * ranks = idset_decode (rank);
     if (!ranks)
         return -1;
+
+    /*  All ranks in an R_lite entry share the same children, so decode
+     *   them once and copy the resulting rnode for each rank.  Copying
+     *   idsets is much cheaper than decoding them again for each of
+     *   what may be thousands of ranks.
+     */
     i = idset_first (ranks);
+    if (i != IDSET_INVALID_ID
+        && !(template = rnode_create_children (NULL, i, children)))
+        goto err;
     while (i != IDSET_INVALID_ID) {
-        if (rlist_append_rank (rl, NULL, i, children) < 0)
+        struct rnode *n = rnode_copy (template);
+        if (!n)
+            goto err;
+        n->rank = i;
+        if (rlist_add_rnode (rl, n) < 0) {
+            rnode_destroy (n);
             goto err;
+        }
         i = idset_next (ranks, i);
     }
     rc = 0;
 err:
+    rnode_destroy (template);
     idset_destroy (ranks);
     return rc;
 }
@@ -1260,16 +1394,40 @@ struct multi_rnode {
     const struct rnode *rnode;
 };
 
-static int multi_rnode_cmp (struct multi_rnode *x, const struct rnode *n)
+/* Return a key that is equal for two nodes if rnode_cmp() finds them
+ * identical and they have the same up/down status, so that nodes can be
+ * collapsed with a hash lookup rather than a search of the list, which
+ * is quadratic in the number of nodes when they are heterogeneous.
+ */
+static char *multi_rnode_key (const struct rnode *n)
 {
-    int rv = rnode_cmp (x->rnode, n);
-
-    /* Only collapse nodes with same avail idset + same up/down status */
-    if (rv == 0 && n->up == x->rnode->up)
-        return 0;
+    json_t *o;
+    struct rnode_child *c;
+    char *s = NULL;
+    char *key = NULL;
 
-    /* O/w, order doesn't matter too much, but put up nodes first */
-    return n->up ? -1 : 1;
+    if (!(o = json_object ()))
+        return NULL;
+    c = zhashx_first (n->children);
+    while (c) {
+        char *ids;
+        json_t *val;
+
+        if (!(ids = idset_encode (c->avail, IDSET_FLAG_RANGE)))
+            goto done;
+        val = json_string (ids);
+        free (ids);
+        if (json_object_set_new (o, c->name, val) < 0)
+            goto done;
+        c = zhashx_next (n->children);
+    }
+    if (!(s = json_dumps (o, JSON_COMPACT | JSON_SORT_KEYS))
+        || asprintf (&key, "%s%s", n->up ? "up" : "down", s) < 0)
+        key = NULL;
+done:
+    free (s);
+    json_decref (o);
+    return key;
 }
 
 static void multi_rnode_destroy (struct multi_rnode **mrn)
@@ -1319,28 +1477,37 @@ static zlistx_t * rlist_mrlist (const struct rlist *rl)
     struct rnode *n = NULL;
     struct multi_rnode *mrn = NULL;
     zlistx_t *l = zlistx_new ();
+    zhashx_t *index = zhashx_new (); // multi_rnode_key => mrn in 'l'
+    char *key = NULL;
 
-    zlistx_set_comparator (l, (zlistx_comparator_fn *) multi_rnode_cmp);
+    if (!l || !index)
+        goto fail;
     zlistx_set_destructor (l, (zlistx_destructor_fn *) multi_rnode_destroy);
 
     n = zlistx_first (rl->nodes);
     while (n) {
-        if (zlistx_find (l, n)) {
-            if (!(mrn = zlistx_handle_item (zlistx_cursor (l)))
-                    || idset_set (mrn->ids, n->rank) < 0) {
+        if (!(key = multi_rnode_key (n)))
+            goto fail;
+        if ((mrn = zhashx_lookup (index, key))) {
+            if (idset_set (mrn->ids, n->rank) < 0)
                 goto fail;
-            }
         }
         else {
             if (!(mrn = multi_rnode_create (n))
-                    || !zlistx_add_end (l, mrn)) {
+                    || !zlistx_add_end (l, mrn)
+                    || zhashx_insert (index, key, mrn) < 0) {
                 goto fail;
             }
         }
+        free (key);
+        key = NULL;
         n = zlistx_next (rl->nodes);
     }
+    zhashx_destroy (&index);
     return (l);
 fail:
+    free (key);
+    zhashx_destroy (&index);
     zlistx_destroy (&l);
     return NULL;
 }
@@ -1768,16 +1935,6 @@ static int by_rank (const void *item1, const void *item2)
     return (x->rank - y->rank);
 }
 
-static int by_avail (const void *item1, const void *item2)
-{
-    int n;
-    const struct rnode *x = item1;
-    const struct rnode *y = item2;
-    if ((n = rnode_avail (x) - rnode_avail (y)) == 0)
-        n = by_rank (x, y);
-    return n;
-}
-
 static int by_used (const void *item1, const void *item2)
 {
     int n;
@@ -1793,7 +1950,13 @@ static int by_used (const void *item1, const void *item2)
 static int rlist_rnode_alloc (struct rlist *rl, struct rnode *n,
                               int count, struct idset **idsetp)
 {
-    if (!n || rnode_alloc (n, count, idsetp) < 0)
+    int rc;
+    if (!n)
+        return -1;
+    avail_index_remove (rl, n);
+    rc = rnode_alloc (n, count, idsetp);
+    avail_index_insert (rl, n);
+    if (rc < 0)
         return -1;
     rl->avail -= idset_count (*idsetp);
     return 0;
@@ -1810,95 +1973,162 @@ static uint32_t rlist_rnode_rank (struct rlist *rl)
 }
 #endif
 
-static struct rnode *rlist_first (struct rlist *rl)
+/*  Return the next rank after 'prev' (or the first rank if 'prev' is
+ *   IDSET_INVALID_ID) with exactly 'avail' cores available.
+ */
+static unsigned int avail_bucket_next (struct rlist *rl,
+                                       size_t avail,
+                                       unsigned int prev)
+{
+    struct avail_index *idx = rl->avail_index;
+
+    if (!idx || avail >= idx->size || !idx->buckets[avail])
+        return IDSET_INVALID_ID;
+    if (prev == IDSET_INVALID_ID)
+        return idset_first (idx->buckets[avail]);
+    return idset_next (idx->buckets[avail], prev);
+}
+
+/*  Return the lowest rank after 'prev' (or the lowest rank if 'prev' is
+ *   IDSET_INVALID_ID) with at least 'min' cores available.
+ */
+static unsigned int avail_index_next_rank (struct rlist *rl,
+                                           size_t min,
+                                           unsigned int prev)
+{
+    unsigned int next = IDSET_INVALID_ID;
+
+    if (rl->avail_index) {
+        for (size_t k = min; k < rl->avail_index->size; k++) {
+            unsigned int id = avail_bucket_next (rl, k, prev);
+            if (id < next)
+                next = id;
+        }
+    }
+    return next;
+}
+
+/*  Allocate as many slots of size cores_per_slot as will fit on node 'n',
+ *   up to '*slots', and append the allocated cores to 'result'.
+ */
+static int rlist_rnode_alloc_slots (struct rlist *rl,
+                                    struct rnode *n,
+                                    int cores_per_slot,
+                                    int *slots,
+                                    struct rlist *result)
 {
-    return zlistx_first (rl->nodes);
+    while (*slots > 0) {
+        int rc;
+        struct idset *ids = NULL;
+
+        if (rlist_rnode_alloc (rl, n, cores_per_slot, &ids) < 0)
+            return errno == ENOSPC ? 0 : -1;
+        rc = rlist_append_cores (result, n->hostname, n->rank, ids);
+        idset_destroy (ids);
+        if (rc < 0)
+            return -1;
+        (*slots)--;
+    }
+    return 0;
 }
 
-static struct rnode *rlist_next (struct rlist *rl)
+static struct rlist *rlist_alloc_unwind (struct rlist *rl,
+                                         struct rlist *result)
 {
-    return zlistx_next (rl->nodes);
+    rlist_free (rl, result);
+    rlist_destroy (result);
+    errno = ENOSPC;
+    return NULL;
 }
 
 /*
  *  Allocate the first available N slots of size cores_per_slot from
- *   resource list rl after sorting the nodes with the current sort strategy.
+ *   resource list rl, filling up nodes in rank order. Only up nodes
+ *   with room for at least one slot are visited.
  */
 static struct rlist * rlist_alloc_first_fit (struct rlist *rl,
                                              int cores_per_slot,
                                              int slots)
 {
-    int rc;
-    struct idset *ids = NULL;
-    struct rnode *n = NULL;
     struct rlist *result = NULL;
+    unsigned int rank = IDSET_INVALID_ID;
 
-    zlistx_sort (rl->nodes);
-
-    if (!(n = rlist_first (rl)))
+    if (!avail_index_get (rl) || !(result = rlist_create ()))
         return NULL;
 
-    if (!(result = rlist_create ()))
+    while (slots > 0) {
+        if ((rank = avail_index_next_rank (rl, cores_per_slot, rank))
+            == IDSET_INVALID_ID)
+            break;
+        if (rlist_rnode_alloc_slots (rl,
+                                     rlist_find_rank (rl, rank),
+                                     cores_per_slot,
+                                     &slots,
+                                     result) < 0)
+            return rlist_alloc_unwind (rl, result);
+    }
+    if (slots != 0)
+        return rlist_alloc_unwind (rl, result);
+    return result;
+}
+
+/*
+ *  Allocate `slots` of size cores_per_slot from rlist `rl`, visiting
+ *   nodes by available core count, smallest first if `ascending` is true
+ *   ("best fit", minimize nodes used) or largest first otherwise ("worst
+ *   fit", spread jobs across nodes). Ties are broken by rank.
+ *
+ *  A node is filled until it cannot hold another slot before moving on,
+ *   so by then it has dropped to a bucket that will not be visited again.
+ */
+static struct rlist * rlist_alloc_by_avail (struct rlist *rl,
+                                            int cores_per_slot,
+                                            int slots,
+                                            bool ascending)
+{
+    struct avail_index *idx;
+    struct rlist *result = NULL;
+    size_t size;
+
+    if (!(idx = avail_index_get (rl)) || !(result = rlist_create ()))
         return NULL;
 
-    /* 2. assign slots to first nodes where they fit
+    /*  Allocation only lowers availability, so the number of buckets
+     *   will not grow while slots are assigned.
      */
-    while (n && slots) {
-        /*  Try to allocate a slot on this node. If we fail with ENOSPC,
-         *   then advance to the next node and try again.
-         */
-        if ((rc = rlist_rnode_alloc (rl, n, cores_per_slot, &ids)) < 0) {
-            if (errno != ENOSPC)
-                goto unwind;
-            n = rlist_next (rl);
-            continue;
+    size = idx->size;
+    for (size_t i = cores_per_slot; slots > 0 && i < size; i++) {
+        size_t k = ascending ? i : size - 1 - (i - cores_per_slot);
+        unsigned int rank = avail_bucket_next (rl, k, IDSET_INVALID_ID);
+        while (slots > 0 && rank != IDSET_INVALID_ID) {
+            if (rlist_rnode_alloc_slots (rl,
+                                         rlist_find_rank (rl, rank),
+                                         cores_per_slot,
+                                         &slots,
+                                         result) < 0)
+                return rlist_alloc_unwind (rl, result);
+            rank = avail_bucket_next (rl, k, rank);
         }
-        /*  Append the allocated cores to the result set and continue
-         *   if needed
-         */
-        rc = rlist_append_cores (result, n->hostname, n->rank, ids);
-        idset_destroy (ids);
-        if (rc < 0)
-            goto unwind;
-        slots--;
-    }
-    if (slots != 0) {
-unwind:
-        rlist_free (rl, result);
-        rlist_destroy (result);
-        errno = ENOSPC;
-        return NULL;
     }
+    if (slots != 0)
+        return rlist_alloc_unwind (rl, result);
     return result;
 }
 
-/*
- *  Allocate `slots` of size cores_per_slot from rlist `rl` and return
- *   the result. Sorts the node list by smallest available first, so that
- *   we get something like "best fit". (minimize nodes used)
- */
 static struct rlist * rlist_alloc_best_fit (struct rlist *rl,
                                             int cores_per_slot,
                                             int slots)
 {
-    zlistx_set_comparator (rl->nodes, by_avail);
-    return rlist_alloc_first_fit (rl, cores_per_slot, slots);
+    return rlist_alloc_by_avail (rl, cores_per_slot, slots, true);
 }
 
-/*
- *  Allocate `slots` of size cores_per_slot from rlist `rl` and return
- *   the result. Sorts the node list by least utilized first, so that
- *   we get something like "worst fit". (Spread jobs across nodes)
- */
 static struct rlist * rlist_alloc_worst_fit (struct rlist *rl,
                                              int cores_per_slot,
                                              int slots)
 {
-    zlistx_set_comparator (rl->nodes, by_used);
-    return rlist_alloc_first_fit (rl, cores_per_slot, slots);
+    return rlist_alloc_by_avail (rl, cores_per_slot, slots, false);
 }
 
-
 static zlistx_t *rlist_get_nnodes (struct rlist *rl, int nnodes)
 {
     struct rnode *n;
@@ -1971,7 +2201,9 @@ static struct rlist *rlist_alloc_nnodes (struct rlist *rl,
                 rnode_destroy (cpy);
                 goto unwind;
             }
+            avail_index_remove (rl, n);
             rnode_alloc_idset (n, n->cores->ids);
+            avail_index_insert (rl, n);
             nleft--;
             n = zlistx_next (rl->nodes);
         }
@@ -2200,12 +2432,16 @@ struct rlist *rlist_alloc (struct rlist *rl,
 
 static int rlist_free_rnode (struct rlist *rl, struct rnode *n)
 {
+    int rc;
     struct rnode *rnode = rlist_find_rank (rl, n->rank);
     if (!rnode) {
         errno = ENOENT;
         return -1;
     }
-    if (rnode_free_idset (rnode, n->cores->ids) < 0)
+    avail_index_remove (rl, rnode);
+    rc = rnode_free_idset (rnode, n->cores->ids);
+    avail_index_insert (rl, rnode);
+    if (rc < 0)
         return -1;
     if (rnode->up)
         rl->avail += idset_count (n->cores->ids);
@@ -2214,12 +2450,16 @@ static int rlist_free_rnode (struct rlist *rl, struct rnode *n)
 
 static int rlist_alloc_rnode (struct rlist *rl, struct rnode *n)
 {
+    int rc;
     struct rnode *rnode = rlist_find_rank (rl, n->rank);
     if (!rnode) {
         errno = ENOENT;
         return -1;
     }
-    if (rnode_alloc_idset (rnode, n->cores->avail) < 0)
+    avail_index_remove (rl, rnode);
+    rc = rnode_alloc_idset (rnode, n->cores->avail);
+    avail_index_insert (rl, rnode);
+    if (rc < 0)
         return -1;
     if (rnode->up)
         rl->avail -= idset_count (n->cores->avail);
@@ -2302,7 +2542,10 @@ size_t rlist_count (const struct rlist *rl, const char *type)
 static int rlist_mark_all (struct rlist *rl, bool up)
 {
     int count = 0;
-    struct rnode *n = zlistx_first (rl->nodes);
+    struct rnode *n;
+
+    avail_index_invalidate (rl);
+    n = zlistx_first (rl->nodes);
     while (n) {
         if (n->up != up)
             count += idset_count (n->cores->avail);
@@ -2325,7 +2568,9 @@ static int rlist_mark_state (struct rlist *rl, bool up, const char *ids)
         if (n) {
             if (n->up != up)
                 count += idset_count (n->cores->avail);
+            avail_index_remove (rl, n);
             n->up = up;
+            avail_index_insert (rl, n);
         }
         i = idset_next (idset, i);
     }
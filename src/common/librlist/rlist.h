@@ -43,6 +43,11 @@ struct rlist {
 
     /*  Opaque Rv1.scheduling key */
     json_t *scheduling;
+
+    /*  Up nodes bucketed by available core count, for allocation.
+     *   Built on first use (see rlist.c)
+     */
+    struct avail_index *avail_index;
 };
 
 struct rlist_alloc_info {
@@ -79,6 +84,9 @@ struct rlist *rlist_copy_ranks (const struct rlist *rl, struct idset *ranks);
 
 struct rlist *rlist_copy_cores (const struct rlist *rl);
 
+/*  Create a copy of rl including only available resources on up nodes */
+struct rlist *rlist_copy_avail (const struct rlist *rl);
+
 /*  Create a copy of rl constrained by an RFC 31 constraint object
  *
  *  Returns a copy of rl with only those resource nodes that match
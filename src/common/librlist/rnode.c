@@ -38,6 +38,35 @@ static struct idset *util_idset_add_check (const struct idset *a,
     return idset_union (a, b);
 }
 
+#define RNODE_MASK_BITS 64
+
+/*  Compute the 64-bit mask of idset 'ids' in 'maskp'.
+ *  Return false if 'ids' contains an id that does not fit.
+ */
+static bool idset_to_mask (const struct idset *ids, uint64_t *maskp)
+{
+    uint64_t mask = 0;
+    unsigned int i = idset_last (ids);
+
+    if (i != IDSET_INVALID_ID && i >= RNODE_MASK_BITS)
+        return false;
+    i = idset_first (ids);
+    while (i != IDSET_INVALID_ID) {
+        mask |= UINT64_C(1) << i;
+        i = idset_next (ids, i);
+    }
+    *maskp = mask;
+    return true;
+}
+
+/*  Recompute the masks of 'c' after its idsets were replaced.
+ */
+static void rnode_child_update_mask (struct rnode_child *c)
+{
+    c->masked = idset_to_mask (c->ids, &c->ids_mask)
+                && idset_to_mask (c->avail, &c->avail_mask);
+}
+
 void rnode_destroy (struct rnode *n)
 {
     if (n) {
@@ -72,6 +101,7 @@ static struct rnode_child *rnode_child_idset (const char *name,
      if (!(c->ids = idset_copy (ids))
         || !(c->avail = idset_copy (avail)))
         goto fail;
+    rnode_child_update_mask (c);
     return c;
 fail:
     rnode_child_destroy (c);
@@ -80,7 +110,20 @@ fail:
 
 static struct rnode_child *rnode_child_copy (const struct rnode_child *c)
 {
-    return rnode_child_idset (c->name, c->ids, c->avail);
+    struct rnode_child *copy = calloc (1, sizeof (*copy));
+    if (!copy)
+        return NULL;
+    if (!(copy->name = strdup (c->name))
+        || !(copy->ids = idset_copy (c->ids))
+        || !(copy->avail = idset_copy (c->avail)))
+        goto fail;
+    copy->masked = c->masked;
+    copy->ids_mask = c->ids_mask;
+    copy->avail_mask = c->avail_mask;
+    return copy;
+fail:
+    rnode_child_destroy (copy);
+    return NULL;
 }
 
 static int rnode_child_clear (struct rnode_child *c)
@@ -94,6 +137,8 @@ static int rnode_child_clear (struct rnode_child *c)
     if (!(c->avail = idset_create (0, IDSET_FLAG_AUTOGROW))
         || !(c->ids = idset_create (0, IDSET_FLAG_AUTOGROW)))
         return -1;
+    c->masked = true;
+    c->ids_mask = c->avail_mask = 0;
     return 0;
 }
 
@@ -130,6 +175,7 @@ static int rnode_child_add_idset (struct rnode_child *c,
     idset_destroy (tmp);
     avail = NULL;
 
+    rnode_child_update_mask (c);
     rc = 0;
 out:
     idset_destroy (ids);
@@ -319,6 +365,7 @@ static int rnode_set_empty (struct rnode *n)
         idset_destroy (c->avail);
         if (!(c->avail = idset_copy (c->ids)))
             return -1;
+        c->avail_mask = c->ids_mask;
         count += idset_count (c->ids);
         c = zhashx_next (n->children);
     }
@@ -340,6 +387,8 @@ static int rnode_set_alloc (struct rnode *n)
         idset_destroy (c->avail);
         if (!(c->avail = idset_copy (c->ids)))
             return -1;
+        c->ids_mask &= ~c->avail_mask;
+        c->avail_mask = c->ids_mask;
         count += idset_count (c->ids);
         c = zhashx_next (n->children);
     }
@@ -359,6 +408,7 @@ static int rnode_set_avail (struct rnode *n)
         idset_destroy (c->ids);
         if (!(c->ids = idset_copy (c->avail)))
             return -1;
+        c->ids_mask = c->avail_mask;
         count += idset_count (c->ids);
         c = zhashx_next (n->children);
     }
@@ -463,7 +513,10 @@ bool rnode_empty (const struct rnode *n)
 
     c = zhashx_first (n->children);
     while (c) {
-        count += idset_count (c->ids);
+        if (c->masked)
+            count += c->ids_mask != 0;
+        else
+            count += idset_count (c->ids);
         c = zhashx_next (n->children);
     }
     return count == 0;
@@ -487,14 +540,31 @@ struct rnode *rnode_diff (const struct rnode *a, const struct rnode *b)
                 if (rnode_child_clear (nc) < 0)
                     goto err;
             }
-            else if (idset_subtract (nc->ids, c->ids) < 0
-                     || idset_subtract (nc->avail, c->avail) < 0)
-                goto err;
+            else if (nc->masked
+                     && c->masked
+                     && !(nc->ids_mask & c->ids_mask)
+                     && !(nc->avail_mask & c->avail_mask)) {
+                /* Nothing to subtract
+                 */
+            }
+            else {
+                if (idset_subtract (nc->ids, c->ids) < 0
+                    || idset_subtract (nc->avail, c->avail) < 0)
+                    goto err;
+                if (nc->masked) {
+                    if (c->masked) {
+                        nc->ids_mask &= ~c->ids_mask;
+                        nc->avail_mask &= ~c->avail_mask;
+                    }
+                    else
+                        rnode_child_update_mask (nc);
+                }
+            }
 
             /*  For non-core resources, remove empty sets:
              */
             if (!streq (nc->name, "core")
-                && idset_count (nc->ids) == 0)
+                && idset_empty (nc->ids))
                 zhashx_delete (n->children, nc->name);
         }
         c = zhashx_next (b->children);
@@ -519,11 +589,25 @@ int rnode_alloc (struct rnode *n, int count, struct idset **setp)
     }
     if (!(ids = idset_create (0, IDSET_FLAG_AUTOGROW)))
         return -1;
-    i = idset_first (n->cores->avail);
-    while (count--) {
-        idset_set (ids, i);
-        idset_clear (n->cores->avail, i);
-        i = idset_next (n->cores->avail, i);
+    if (n->cores->masked) {
+        /*  Take the lowest 'count' available ids from the mask.
+         */
+        uint64_t avail = n->cores->avail_mask;
+        while (count--) {
+            i = __builtin_ctzll (avail);
+            avail &= avail - 1;
+            idset_set (ids, i);
+            idset_clear (n->cores->avail, i);
+        }
+        n->cores->avail_mask = avail;
+    }
+    else {
+        i = idset_first (n->cores->avail);
+        while (count--) {
+            idset_set (ids, i);
+            idset_clear (n->cores->avail, i);
+            i = idset_next (n->cores->avail, i);
+        }
     }
     if (setp != NULL)
         *setp = ids;
@@ -536,7 +620,21 @@ int rnode_alloc (struct rnode *n, int count, struct idset **setp)
  */
 static bool alloc_ids_valid (struct rnode *n, struct idset *ids)
 {
-    unsigned int i = idset_first (ids);
+    uint64_t mask;
+    unsigned int i;
+
+    if (n->cores->masked && idset_to_mask (ids, &mask)) {
+        if (mask & ~n->cores->ids_mask) {
+            errno = ENOENT;
+            return false;
+        }
+        if (mask & ~n->cores->avail_mask) {
+            errno = EEXIST;
+            return false;
+        }
+        return true;
+    }
+    i = idset_first (ids);
     while (i != IDSET_INVALID_ID) {
         if (!idset_test (n->cores->ids, i)) {
             errno = ENOENT;
@@ -563,6 +661,8 @@ int rnode_alloc_idset (struct rnode *n, struct idset *ids)
     i = idset_first (ids);
     while (i != IDSET_INVALID_ID) {
         idset_clear (n->cores->avail, i);
+        if (n->cores->masked)
+            n->cores->avail_mask &= ~(UINT64_C(1) << i);
         i = idset_next (ids, i);
     }
     return 0;
@@ -574,7 +674,21 @@ int rnode_alloc_idset (struct rnode *n, struct idset *ids)
  */
 static bool free_ids_valid (struct rnode *n, struct idset *ids)
 {
-    unsigned int i = idset_first (ids);
+    uint64_t mask;
+    unsigned int i;
+
+    if (n->cores->masked && idset_to_mask (ids, &mask)) {
+        if (mask & ~n->cores->ids_mask) {
+            errno = ENOENT;
+            return false;
+        }
+        if (mask & n->cores->avail_mask) {
+            errno = EEXIST;
+            return false;
+        }
+        return true;
+    }
+    i = idset_first (ids);
     while (i != IDSET_INVALID_ID) {
         if (!idset_test (n->cores->ids, i)) {
             errno = ENOENT;
@@ -601,6 +715,8 @@ int rnode_free_idset (struct rnode *n, struct idset *ids)
     i = idset_first (ids);
     while (i != IDSET_INVALID_ID) {
         idset_set (n->cores->avail, i);
+        if (n->cores->masked)
+            n->cores->avail_mask |= UINT64_C(1) << i;
         i = idset_next (ids, i);
     }
     return 0;
@@ -635,9 +751,11 @@ int rnode_avail_total (const struct rnode *n)
 
 size_t rnode_avail (const struct rnode *n)
 {
-    if (n->up)
-        return (idset_count (n->cores->avail));
-    return 0;
+    if (!n->up)
+        return 0;
+    if (n->cores->masked)
+        return __builtin_popcountll (n->cores->avail_mask);
+    return (idset_count (n->cores->avail));
 }
 
 size_t rnode_count (const struct rnode *n)
@@ -716,8 +834,19 @@ struct rnode_child * rnode_child_intersect (const struct rnode_child *a,
                                             const struct rnode_child *b)
 {
     struct rnode_child *c = NULL;
-    struct idset *ids = idset_intersect (a->ids, b->ids);
-    struct idset *avail = idset_intersect (a->avail, b->avail);
+    struct idset *ids;
+    struct idset *avail;
+
+    /*  Skip building two empty idsets when the masks show that the
+     *   children are disjoint.
+     */
+    if (a->masked
+        && b->masked
+        && !(a->ids_mask & b->ids_mask)
+        && !(a->avail_mask & b->avail_mask))
+        return NULL;
+    ids = idset_intersect (a->ids, b->ids);
+    avail = idset_intersect (a->avail, b->avail);
     if (!ids || !avail)
         goto out;
     if (!idset_count (ids) && !idset_count (avail))
@@ -808,6 +937,7 @@ static int rnode_child_remap (struct rnode_child *c)
         return -1;
     if (idset_range_set (c->ids, 0, count - 1) < 0)
         return -1;
+    rnode_child_update_mask (c);
     return 0;
 }
 
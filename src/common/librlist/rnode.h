@@ -21,10 +21,20 @@
 
 #include "src/common/libczmqcontainers/czmq_containers.h"
 
+/*  The idsets are authoritative.  When every id in 'ids' is below 64,
+ *   which is the common case for cores and gpus, 'masked' is true and
+ *   'ids_mask' and 'avail_mask' mirror the idsets so that hot paths can
+ *   test, select, and count ids with word operations.  Only rnode.c may
+ *   modify a child.
+ */
 struct rnode_child {
     char *name;
     struct idset *ids;
     struct idset *avail;
+
+    bool masked;
+    uint64_t ids_mask;
+    uint64_t avail_mask;
 };
 
 /* Simple resource node object */
@@ -775,6 +775,25 @@ static void test_dumps (void)
         "rlist_dumps with long result");
     free (result);
     rlist_destroy (rl);
+
+    if (!(rl = rlist_create ()))
+        BAIL_OUT ("rlist_dumps: failed to create rlist");
+    rlist_append_rank_cores (rl, "host", 0, "0-3");
+    rlist_append_rank_cores (rl, "host", 1, "0-7");
+    rlist_append_rank_cores (rl, "host", 2, "0-3");
+    rlist_append_rank_cores (rl, "host", 3, "0-7");
+    rlist_append_rank_cores (rl, "host", 4, "0-3");
+    result = rlist_dumps (rl);
+    is (result, "rank[0,2,4]/core[0-3] rank[1,3]/core[0-7]",
+        "rlist_dumps collapses interleaved identical ranks");
+    free (result);
+    ok (rlist_mark_down (rl, "2") == 0,
+        "rlist_mark_down 2");
+    result = rlist_dumps (rl);
+    is (result, "rank[0,4]/core[0-3] rank[1,3]/core[0-7] rank2/core[0-3]",
+        "rlist_dumps does not collapse down ranks with up ranks");
+    free (result);
+    rlist_destroy (rl);
 }
 
 static void test_updown ()
@@ -839,6 +858,58 @@ static void test_updown ()
     rlist_destroy (rl2);
 }
 
+static void check_alloc (struct rlist *rl,
+                         const char *mode,
+                         int slot_size,
+                         const char *expected,
+                         struct rlist **allocp)
+{
+    char *result = NULL;
+    struct rlist *a = rl_alloc (rl, mode, 0, 1, slot_size, 0);
+
+    if (a)
+        result = rlist_dumps (a);
+    is (result, expected,
+        "alloc_index: %s of %d cores allocated %s",
+        mode, slot_size, result ? result : "nothing");
+    free (result);
+    if (allocp)
+        *allocp = a;
+    else
+        rlist_destroy (a);
+}
+
+static void test_alloc_index ()
+{
+    struct rlist *rl = NULL;
+    struct rlist *a = NULL;
+    char *R = R_create ("0-3", "0-3", NULL, "host[0-3]", NULL);
+
+    if (!(rl = rlist_from_R (R)))
+        BAIL_OUT ("rlist_from_R failed");
+    free (R);
+
+    check_alloc (rl, "best-fit", 3, "rank0/core[0-2]", &a);
+    ok (rlist_mark_down (rl, "1") == 0,
+        "alloc_index: rlist_mark_down 1");
+    check_alloc (rl, "best-fit", 1, "rank0/core3", NULL);
+    check_alloc (rl, "first-fit", 2, "rank2/core[0-1]", NULL);
+    check_alloc (rl, "worst-fit", 4, "rank3/core[0-3]", NULL);
+    ok (rl_alloc (rl, "worst-fit", 0, 1, 4, 0) == NULL && errno == ENOSPC,
+        "alloc_index: down node is not allocated");
+    ok (rlist_mark_up (rl, "1") == 0,
+        "alloc_index: rlist_mark_up 1");
+    check_alloc (rl, "worst-fit", 4, "rank1/core[0-3]", NULL);
+    ok (rlist_free (rl, a) == 0,
+        "alloc_index: rlist_free works");
+    rlist_destroy (a);
+    check_alloc (rl, "best-fit", 2, "rank2/core[2-3]", NULL);
+    check_alloc (rl, "first-fit", 3, "rank0/core[0-2]", NULL);
+    ok (rl->avail == 0,
+        "alloc_index: all cores allocated");
+    rlist_destroy (rl);
+}
+
 struct append_test {
     const char *ranksa;
     const char *coresa;
@@ -2162,6 +2233,7 @@ int main (int ac, char *av[])
     test_issue2202 ();
     test_issue2473 ();
     test_updown ();
+    test_alloc_index ();
     test_append ();
     test_add ();
     test_diff ();
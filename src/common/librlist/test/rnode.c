@@ -116,6 +116,48 @@ static void test_intersect ()
     rnode_destroy (c);
 }
 
+static void test_large_ids ()
+{
+    struct idset *ids;
+    struct rnode *a = rnode_create ("foo", 0, "60-67");
+    struct rnode *b = rnode_create ("foo", 0, "0-63");
+    struct rnode *result;
+
+    if (!a || !b)
+        BAIL_OUT ("rnode_create failed");
+    ok (!a->cores->masked && b->cores->masked,
+        "only rnode with ids below 64 is masked");
+
+    rnode_alloc_and_check (a, 6, "60-65");
+    rnode_avail_check (a, "66-67");
+    rnode_alloc_and_check (b, 63, "0-62");
+    rnode_avail_check (b, "63");
+
+    if (!(ids = idset_decode ("61,63")))
+        BAIL_OUT ("idset_decode failed");
+    ok (rnode_free_idset (a, ids) == 0,
+        "rnode_free_idset works on unmasked rnode");
+    rnode_avail_check (a, "61,63,66-67");
+    ok (rnode_free_idset (b, ids) < 0 && errno == EEXIST,
+        "rnode_free_idset of available id fails with EEXIST");
+    idset_destroy (ids);
+
+    result = rnode_intersect (a, b);
+    ok (result != NULL && rnode_count_type (result, "core") == 4,
+        "rnode_intersect of masked and unmasked rnode works");
+    rnode_destroy (result);
+
+    result = rnode_diff (b, a);
+    ok (result != NULL && rnode_count_type (result, "core") == 60,
+        "rnode_diff of masked and unmasked rnode works");
+    ok (result && result->cores->masked && rnode_avail (result) == 0,
+        "diff result is masked and has no available cores");
+    rnode_destroy (result);
+
+    rnode_destroy (a);
+    rnode_destroy (b);
+}
+
 static void test_add_child ()
 {
     struct rnode_child *c;
@@ -351,6 +393,7 @@ int main (int ac, char *av[])
 
     test_diff ();
     test_intersect ();
+    test_large_ids ();
     test_add_child ();
     test_copy ();
     test_properties ();
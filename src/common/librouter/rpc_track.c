@@ -12,22 +12,156 @@
 #include "config.h"
 #endif
 
+#include <string.h>
+#include <stdint.h>
+
 #include "src/common/libczmqcontainers/czmq_containers.h"
+#include "src/common/libutil/hashmap.h"
 #include "src/common/libccan/ccan/str/str.h"
 
 #include "rpc_track.h"
 #include "msg_hash.h"
 
+/* Tracked requests are grouped by sender (first route id, "" if none),
+ * and each sender's requests are kept in a hashmap keyed by matchtag.
+ * Requests and responses need no allocation unless a sender is new,
+ * a disconnect drops one sender's requests without looking at any
+ * others, and a small cache of empty senders absorbs the churn of
+ * clients with one RPC outstanding at a time.
+ */
+#define SPARE_SENDERS_MAX 16
+
+struct sender {
+    char *uuid;
+    struct hashmap *rpcs;       // matchtag => request
+    struct sender *next;        // spare list
+};
+
 struct rpc_track {
-    zhashx_t *hash;
+    zhashx_t *senders;          // uuid => struct sender
+    struct sender *last;        // most recently used sender
+    struct sender *spare;
+    int spare_count;
+    int count;
+    struct rpc_track_stats stats;
     msg_hash_type_t type;
 };
 
+static size_t matchtag_hash (const void *key, size_t keysize)
+{
+    return *(const uint32_t *)key;
+}
+
+static bool matchtag_equal (const void *key1, const void *key2, size_t keysize)
+{
+    return *(const uint32_t *)key1 == *(const uint32_t *)key2;
+}
+
+static void request_destructor (void **item)
+{
+    if (item) {
+        flux_msg_decref (*item);
+        *item = NULL;
+    }
+}
+
+static void sender_destroy (struct sender *s)
+{
+    if (s) {
+        int saved_errno = errno;
+        hashmap_destroy (s->rpcs);
+        free (s->uuid);
+        free (s);
+        errno = saved_errno;
+    }
+}
+
+static struct sender *sender_create (void)
+{
+    struct sender *s;
+
+    if (!(s = calloc (1, sizeof (*s))))
+        return NULL;
+    if (!(s->rpcs = hashmap_create (sizeof (uint32_t),
+                                    matchtag_hash,
+                                    matchtag_equal))) {
+        sender_destroy (s);
+        return NULL;
+    }
+    hashmap_set_destructor (s->rpcs, request_destructor);
+    return s;
+}
+
+static struct sender *sender_lookup (struct rpc_track *rt, const char *uuid)
+{
+    struct sender *s;
+
+    if (rt->last && streq (rt->last->uuid, uuid))
+        return rt->last;
+    if ((s = zhashx_lookup (rt->senders, uuid)))
+        rt->last = s;
+    return s;
+}
+
+static struct sender *sender_add (struct rpc_track *rt, const char *uuid)
+{
+    struct sender *s;
+
+    if ((s = rt->spare)) {
+        rt->spare = s->next;
+        rt->spare_count--;
+        s->next = NULL;
+    }
+    else if (!(s = sender_create ()))
+        return NULL;
+    if (!(s->uuid = strdup (uuid))
+        || zhashx_insert (rt->senders, s->uuid, s) < 0) {
+        sender_destroy (s);
+        return NULL;
+    }
+    rt->last = s;
+    return s;
+}
+
+/* Remove sender 's', dropping any requests it still has.
+ */
+static void sender_remove (struct rpc_track *rt, struct sender *s)
+{
+    zhashx_delete (rt->senders, s->uuid);
+    if (rt->last == s)
+        rt->last = NULL;
+    rt->count -= hashmap_size (s->rpcs);
+    hashmap_purge (s->rpcs);
+    if (rt->spare_count < SPARE_SENDERS_MAX) {
+        free (s->uuid);
+        s->uuid = NULL;
+        s->next = rt->spare;
+        rt->spare = s;
+        rt->spare_count++;
+    }
+    else
+        sender_destroy (s);
+}
+
+static const char *msg_uuid (const flux_msg_t *msg)
+{
+    const char *uuid = flux_msg_route_first (msg);
+    return uuid ? uuid : "";
+}
+
 void rpc_track_destroy (struct rpc_track *rt)
 {
     if (rt) {
         int saved_errno = errno;
-        zhashx_destroy (&rt->hash);
+        if (rt->senders) {
+            rpc_track_purge (rt, NULL, NULL);
+            zhashx_destroy (&rt->senders);
+        }
+        while (rt->spare) {
+            struct sender *s = rt->spare;
+            rt->spare = s->next;
+            sender_destroy (s);
+        }
         free (rt);
         errno = saved_errno;
     }
@@ -37,14 +171,21 @@ struct rpc_track *rpc_track_create (msg_hash_type_t type)
 {
     struct rpc_track *rt;
 
+    if (type != MSG_HASH_TYPE_UUID_MATCHTAG) {
+        errno = EINVAL;
+        return NULL;
+    }
     if (!(rt = calloc (1, sizeof (*rt))))
         return NULL;
     rt->type = type;
-    if (!(rt->hash = msg_hash_create (type)))
-        goto error;
+    if (!(rt->senders = zhashx_new ()))
+        goto nomem;
+    zhashx_set_key_duplicator (rt->senders, NULL);
+    zhashx_set_key_destructor (rt->senders, NULL);
     return rt;
-error:
+nomem:
     rpc_track_destroy (rt);
+    errno = ENOMEM;
     return NULL;
 }
 
@@ -88,20 +229,53 @@ static bool message_is_hashable (const flux_msg_t *msg)
 static void rpc_track_disconnect (struct rpc_track *rt, const flux_msg_t *msg)
 {
     const char *uuid;
-    zlistx_t *values;
-    const flux_msg_t *req;
+    struct sender *s;
 
     if (!(uuid = flux_msg_route_first (msg))
-        || !(values = zhashx_values (rt->hash)))
+        || !(s = sender_lookup (rt, uuid)))
+        return;
+    rt->stats.disconnected += hashmap_size (s->rpcs);
+    sender_remove (rt, s);
+}
+
+static void rpc_track_request (struct rpc_track *rt, const flux_msg_t *msg)
+{
+    const char *uuid = msg_uuid (msg);
+    uint32_t matchtag;
+    struct sender *s;
+
+    if (flux_msg_get_matchtag (msg, &matchtag) < 0)
+        return;
+    if (!(s = sender_lookup (rt, uuid))
+        && !(s = sender_add (rt, uuid)))
+        return;
+    if (hashmap_insert (s->rpcs, &matchtag, (flux_msg_t *)msg) < 0) {
+        if (hashmap_size (s->rpcs) == 0)
+            sender_remove (rt, s);
         return;
-    req = zlistx_first (values);
-    while (req) {
-        const char *uuid2 = flux_msg_route_first (req);
-        if (uuid2 && streq (uuid, uuid2))
-            zhashx_delete (rt->hash, req);
-        req = zlistx_next (values);
     }
-    zlistx_destroy (&values);
+    flux_msg_incref (msg);
+    rt->count++;
+    rt->stats.tracked++;
+}
+
+static void rpc_track_response (struct rpc_track *rt, const flux_msg_t *msg)
+{
+    uint32_t matchtag;
+    struct sender *s;
+    size_t size;
+
+    if (flux_msg_get_matchtag (msg, &matchtag) < 0
+        || !(s = sender_lookup (rt, msg_uuid (msg))))
+        return;
+    size = hashmap_size (s->rpcs);
+    hashmap_delete (s->rpcs, &matchtag);
+    if (hashmap_size (s->rpcs) < size) {
+        rt->count--;
+        rt->stats.completed++;
+        if (size == 1)
+            sender_remove (rt, s);
+    }
 }
 
 void rpc_track_update (struct rpc_track *rt, const flux_msg_t *msg)
@@ -114,12 +288,12 @@ void rpc_track_update (struct rpc_track *rt, const flux_msg_t *msg)
         case FLUX_MSGTYPE_RESPONSE:
             if (message_is_hashable (msg)
                 && (!flux_msg_is_streaming (msg) || response_is_error (msg)))
-                zhashx_delete (rt->hash, msg);
+                rpc_track_response (rt, msg);
             break;
         case FLUX_MSGTYPE_REQUEST:
             if (!flux_msg_is_noresponse (msg)
                 && message_is_hashable (msg))
-                zhashx_insert (rt->hash, msg, (flux_msg_t *)msg);
+                rpc_track_request (rt, msg);
             else if (request_is_disconnect (msg))
                 rpc_track_disconnect (rt, msg);
             break;
@@ -130,22 +304,40 @@ void rpc_track_update (struct rpc_track *rt, const flux_msg_t *msg)
 
 void rpc_track_purge (struct rpc_track *rt, rpc_respond_f fun, void *arg)
 {
-    const flux_msg_t *msg;
+    zlistx_t *values;
+    struct sender *s;
 
-    if (rt) {
-        msg = zhashx_first (rt->hash);
-        while (msg) {
-            if (fun)
+    if (!rt || !(values = zhashx_values (rt->senders)))
+        return;
+    s = zlistx_first (values);
+    while (s) {
+        const flux_msg_t *msg;
+
+        if (fun) {
+            msg = hashmap_first (s->rpcs);
+            while (msg) {
                 fun (msg, arg);
-            msg = zhashx_next (rt->hash);
+                msg = hashmap_next (s->rpcs);
+            }
         }
-        zhashx_purge (rt->hash);
+        rt->stats.purged += hashmap_size (s->rpcs);
+        sender_remove (rt, s);
+        s = zlistx_next (values);
     }
+    zlistx_destroy (&values);
 }
 
 int rpc_track_count (struct rpc_track *rt)
 {
-    return rt ? zhashx_size (rt->hash) : 0;
+    return rt ? rt->count : 0;
+}
+
+void rpc_track_get_stats (struct rpc_track *rt, struct rpc_track_stats *st)
+{
+    if (rt && st) {
+        *st = rt->stats;
+        st->senders = zhashx_size (rt->senders);
+    }
 }
 
 // vi:ts=4 sw=4 expandtab
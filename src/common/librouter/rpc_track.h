@@ -11,12 +11,24 @@
 #ifndef _ROUTER_RPC_TRACK_H
 #define _ROUTER_RPC_TRACK_H
 
+#include <stdint.h>
 #include <flux/core.h>
 
 #include "msg_hash.h"
 
 typedef void (*rpc_respond_f)(const flux_msg_t *msg, void *arg);
 
+/* Cumulative counts of requests added to and removed from the tracker,
+ * by cause, and the current number of distinct senders.
+ */
+struct rpc_track_stats {
+    uint64_t tracked;
+    uint64_t completed;
+    uint64_t disconnected;
+    uint64_t purged;
+    int senders;
+};
+
 /* Create/destroy hash of messages.
  * Set type=MSG_HASH_TYPE_UUID_MATCHTAG.
  */
@@ -39,6 +51,10 @@ void rpc_track_purge (struct rpc_track *rt, rpc_respond_f fun, void *arg);
  */
 int rpc_track_count (struct rpc_track *rt);
 
+/* Get tracker statistics.
+ */
+void rpc_track_get_stats (struct rpc_track *rt, struct rpc_track_stats *st);
+
 #endif /* _ROUTER_RPC_TRACK_H */
 
 // vi:ts=4 sw=4 expandtab
@@ -36,8 +36,15 @@
  * - to decrease small message latency, the iobuf contains a fixed size
  *   static buffer.  When a message requires more than this fixed size for
  *   assembly, a dynamic buffer is allocated temporarily while that message
- *   is assembled, then it is freed.  The static buffer is sized somewhat
- *   arbitrarily at 4K.
+ *   is assembled.  On receive, the dynamic buffer becomes the backing store
+ *   for the message payload rather than being copied and freed.  The static
+ *   buffer is sized somewhat arbitrarily at 4K.
+ *
+ * - sendfd_v() avoids assembling messages in an intermediate buffer.
+ *   It builds an iovec array referencing message frames directly, except
+ *   for frame headers and small frames which are gathered into a single
+ *   allocation, then drains several queued messages per writev(2) call.
+ *   The byte stream is identical to that produced by sendfd().
  *
  * - sendfd/recvfd do not encrypt messages, therefore this transport
  *   is only appropriate for use on AF_LOCAL sockets or on file descriptors
@@ -48,13 +55,23 @@
 #include "config.h"
 #endif
 #include <arpa/inet.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #include <flux/core.h>
 
+#include "src/common/libflux/message_iovec.h"
+#include "src/common/libflux/message_proto.h"
+#include "src/common/libutil/errno_safe.h"
+
 #include "sendfd.h"
 
 #define IOBUF_MAGIC 0xffee0012
 
+/* sendfd_v() copies frames up to this size rather than giving them
+ * their own iovec.
+ */
+#define IOBUFV_COPY_MAX 64
+
 void iobuf_init (struct iobuf *iobuf)
 {
     memset (iobuf, 0, sizeof (*iobuf));
@@ -113,6 +130,208 @@ done:
     return rc;
 }
 
+void iobufv_init (struct iobufv *iobufv)
+{
+    memset (iobufv, 0, sizeof (*iobufv));
+}
+
+void iobufv_clean (struct iobufv *iobufv)
+{
+    int i;
+
+    for (i = 0; i < iobufv->msgcnt; i++)
+        flux_msg_decref (iobufv->msgs[i]);
+    ERRNO_SAFE_WRAP (free, iobufv->storage);
+    iobufv_init (iobufv);
+}
+
+bool iobufv_pending (const struct iobufv *iobufv)
+{
+    return iobufv->iovdone < iobufv->iovcnt;
+}
+
+static size_t frame_header_size (size_t size)
+{
+    return size < 0xff ? 1 : 5;
+}
+
+/* Write frame header in the encoding used by flux_msg_encode().
+ */
+static size_t frame_header (uint8_t *p, size_t size)
+{
+    uint32_t nsize;
+
+    if (size < 0xff) {
+        *p = (uint8_t)size;
+        return 1;
+    }
+    *p++ = 0xff;
+    nsize = htonl (size);
+    memcpy (p, &nsize, sizeof (nsize));
+    return 5;
+}
+
+static void iobufv_add (struct iobufv *io, const void *data, size_t size)
+{
+    if (size > 0) {
+        io->iov[io->iovcnt].iov_base = (void *)data;
+        io->iov[io->iovcnt].iov_len = size;
+        io->iovcnt++;
+    }
+}
+
+struct loadmsg {
+    struct msg_iovec *frames;
+    int count;
+    size_t size;
+    bool copy_all;
+    uint8_t proto[PROTO_SIZE_MAX];
+};
+
+/* Build iovecs for as many of 'msgs' as fit in an idle iobufv.
+ * Returns the number of messages loaded, or -1 on error.
+ */
+static int iobufv_load (struct iobufv *io, const flux_msg_t **msgs, int count)
+{
+    struct loadmsg m[IOBUFV_MSG_MAX];
+    size_t storage_size = 0;
+    int iovcnt = 0;
+    int n = 0;
+    int i, j;
+    uint8_t *p;
+
+    while (n < count && n < IOBUFV_MSG_MAX) {
+        int external = 0;
+        int need;
+
+        if (msg_to_iovec (msgs[n],
+                          m[n].proto,
+                          sizeof (m[n].proto),
+                          &m[n].frames,
+                          &m[n].count) < 0)
+            goto error;
+        for (j = 0; j < m[n].count; j++) {
+            if (m[n].frames[j].size > IOBUFV_COPY_MAX)
+                external++;
+        }
+        /* Each external frame may split the gathered headers, so a
+         * message needs at most two iovecs per external frame plus one.
+         * A message that could never fit is copied in its entirety.
+         */
+        need = 2 * external + 1;
+        m[n].copy_all = (need > IOBUFV_IOV_MAX);
+        if (m[n].copy_all)
+            need = 1;
+        if (iovcnt + need > IOBUFV_IOV_MAX) {
+            free (m[n].frames);
+            break;
+        }
+        m[n].size = 0;
+        for (j = 0; j < m[n].count; j++) {
+            size_t size = m[n].frames[j].size;
+            size_t hdr = frame_header_size (size);
+
+            m[n].size += hdr + size;
+            storage_size += hdr;
+            if (m[n].copy_all || size <= IOBUFV_COPY_MAX)
+                storage_size += size;
+        }
+        storage_size += 8;
+        iovcnt += need;
+        n++;
+    }
+    if (!(io->storage = malloc (storage_size)))
+        goto error;
+    p = io->storage;
+    for (i = 0; i < n; i++) {
+        uint8_t *chunk = p;
+        uint32_t word;
+
+        word = IOBUF_MAGIC;
+        memcpy (p, &word, sizeof (word));
+        word = htonl (m[i].size);
+        memcpy (p + 4, &word, sizeof (word));
+        p += 8;
+        for (j = 0; j < m[i].count; j++) {
+            const struct msg_iovec *f = &m[i].frames[j];
+
+            p += frame_header (p, f->size);
+            if (m[i].copy_all || f->size <= IOBUFV_COPY_MAX) {
+                if (f->size > 0)
+                    memcpy (p, f->data, f->size);
+                p += f->size;
+            }
+            else {
+                iobufv_add (io, chunk, p - chunk);
+                iobufv_add (io, f->data, f->size);
+                chunk = p;
+            }
+        }
+        iobufv_add (io, chunk, p - chunk);
+        io->msgs[io->msgcnt++] = flux_msg_incref (msgs[i]);
+        free (m[i].frames);
+    }
+    return n;
+error:
+    for (i = 0; i < n; i++)
+        ERRNO_SAFE_WRAP (free, m[i].frames);
+    return -1;
+}
+
+/* Write pending iovecs.  Once all are written, release messages.
+ */
+static int iobufv_write (int fd, struct iobufv *io)
+{
+    while (io->iovdone < io->iovcnt) {
+        ssize_t n;
+
+        n = writev (fd, &io->iov[io->iovdone], io->iovcnt - io->iovdone);
+        if (n < 0)
+            return -1;
+        while (n > 0) {
+            struct iovec *v = &io->iov[io->iovdone];
+            if ((size_t)n < v->iov_len) {
+                v->iov_base = (uint8_t *)v->iov_base + n;
+                v->iov_len -= n;
+                n = 0;
+            }
+            else {
+                n -= v->iov_len;
+                io->iovdone++;
+            }
+        }
+    }
+    iobufv_clean (io);
+    return 0;
+}
+
+int sendfd_v (int fd,
+              const flux_msg_t **msgs,
+              int count,
+              struct iobufv *iobufv)
+{
+    int n;
+
+    if (fd < 0 || count < 0 || (count > 0 && !msgs) || !iobufv) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (iobufv_write (fd, iobufv) < 0)
+        goto error;
+    if (count == 0)
+        return 0;
+    if ((n = iobufv_load (iobufv, msgs, count)) < 0)
+        goto error;
+    if (iobufv_write (fd, iobufv) < 0
+        && errno != EAGAIN && errno != EWOULDBLOCK)
+        goto error;
+    return n;
+error:
+    if (errno != EAGAIN && errno != EWOULDBLOCK)
+        iobufv_clean (iobufv);
+    return -1;
+}
+
 flux_msg_t *recvfd (int fd, struct iobuf *iobuf)
 {
     struct iobuf local;
@@ -164,7 +383,16 @@ flux_msg_t *recvfd (int fd, struct iobuf *iobuf)
             io->done += rc;
         }
     } while (io->done < io->size);
-    if (!(msg = flux_msg_decode (io->buf + 8, io->size - 8)))
+    /* A dynamically allocated buffer is handed off to the message
+     * so that a large payload need not be copied.
+     */
+    if (io->buf != io->buf_fixed) {
+        uint8_t *buf = io->buf;
+        io->buf = NULL;
+        if (!(msg = flux_msg_decode_ref (buf + 8, io->size - 8, free, buf)))
+            goto done;
+    }
+    else if (!(msg = flux_msg_decode (io->buf + 8, io->size - 8)))
         goto done;
 done:
     if (iobuf) {
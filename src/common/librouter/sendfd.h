@@ -11,6 +11,8 @@
 #ifndef _ROUTER_SENDFD_H
 #define _ROUTER_SENDFD_H
 
+#include <sys/uio.h>
+#include <stdbool.h>
 #include <flux/core.h>
 
 struct iobuf {
@@ -41,6 +43,43 @@ void iobuf_init (struct iobuf *iobuf);
  */
 void iobuf_clean (struct iobuf *iobuf);
 
+#define IOBUFV_MSG_MAX  64
+#define IOBUFV_IOV_MAX  256
+
+/* Output state for sendfd_v().  Holds a reference on each loaded message
+ * until all of its frames have been written.
+ */
+struct iobufv {
+    struct iovec iov[IOBUFV_IOV_MAX];
+    int iovcnt;
+    int iovdone;
+    const flux_msg_t *msgs[IOBUFV_MSG_MAX];
+    int msgcnt;
+    uint8_t *storage;
+};
+
+/* Send up to 'count' messages to file descriptor with writev(2).
+ * Message headers and small frames are gathered into one buffer while
+ * large frames (i.e. payloads) are written directly from the message.
+ * Output left over from a previous call that failed with EAGAIN or
+ * EWOULDBLOCK is written first, and 'count' may be zero to just flush it.
+ * Returns the number of messages from the front of 'msgs' that were
+ * accepted, which may be fewer than 'count'.  Accepted messages need not
+ * be retained by the caller, but may not have been completely written -
+ * see iobufv_pending().  Returns -1 on failure with errno set.
+ */
+int sendfd_v (int fd,
+              const flux_msg_t **msgs,
+              int count,
+              struct iobufv *iobufv);
+
+void iobufv_init (struct iobufv *iobufv);
+void iobufv_clean (struct iobufv *iobufv);
+
+/* Return true if accepted messages remain to be written.
+ */
+bool iobufv_pending (const struct iobufv *iobufv);
+
 #endif /* !_ROUTER_SENDFD_H */
 
 /*
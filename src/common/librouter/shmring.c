@@ -0,0 +1,609 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* shmring.c - shared memory message rings
+ *
+ * Each ring has a producer-owned 'head' and a consumer-owned 'tail',
+ * both free running byte counts, so used space is (head - tail).
+ * The producer copies data, then publishes 'head' with release
+ * semantics; the consumer loads 'head' with acquire semantics before
+ * copying data out (and vice versa for 'tail').  Each side keeps a
+ * private copy of the indices it owns, so the peer can only lie about
+ * its own index, which is range checked on every load.
+ *
+ * Sleep/wake is a Dekker-style handshake: the sleeper sets its flag,
+ * then checks the rings; the peer publishes an index, then checks the
+ * flag.  A full fence between the store and the load on each side
+ * guarantees at least one of them sees the other, so a wakeup is never
+ * lost, and the eventfd is only written while the peer is blocked.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <flux/core.h>
+
+#include "src/common/libutil/errno_safe.h"
+
+#include "shmring.h"
+
+#define SHMRING_MAGIC       0x73686d72  /* "shmr" */
+#define SHMRING_VERSION     1
+#define SHMRING_HDR_SIZE    4096
+#define SHMRING_CACHELINE   64
+
+struct ring_ctl {
+    uint64_t head __attribute__ ((aligned (SHMRING_CACHELINE)));
+    uint64_t tail __attribute__ ((aligned (SHMRING_CACHELINE)));
+};
+
+struct shmring_hdr {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t size;
+    struct ring_ctl ring[2];    // ring[side] is produced by 'side'
+    uint32_t sleeping[2] __attribute__ ((aligned (SHMRING_CACHELINE)));
+};
+
+struct shmring {
+    int side;
+    int memfd;
+    int efd[2];                 // efd[side] wakes 'side'
+    void *base;
+    size_t mapsize;
+    struct shmring_hdr *hdr;
+    uint8_t *data[2];
+    size_t size;
+    size_t mask;
+    uint64_t tx_head;           // private copy of ring[side].head
+    uint64_t rx_tail;           // private copy of ring[!side].tail
+    bool asleep;
+    bool drain;                 // eventfd may be signaled
+    struct {
+        uint8_t *buf;
+        size_t cap;
+        size_t size;
+        size_t done;
+    } tx;
+    struct {
+        uint32_t len;
+        size_t lendone;
+        uint8_t *buf;
+        size_t cap;
+        size_t done;
+    } rx;
+};
+
+static struct shmring *shmring_alloc (void)
+{
+    struct shmring *r;
+
+    if (!(r = calloc (1, sizeof (*r))))
+        return NULL;
+    r->memfd = -1;
+    r->efd[0] = -1;
+    r->efd[1] = -1;
+    return r;
+}
+
+void shmring_destroy (struct shmring *r)
+{
+    if (r) {
+        int saved_errno = errno;
+        if (r->base)
+            (void)munmap (r->base, r->mapsize);
+        if (r->memfd >= 0)
+            (void)close (r->memfd);
+        if (r->efd[0] >= 0)
+            (void)close (r->efd[0]);
+        if (r->efd[1] >= 0)
+            (void)close (r->efd[1]);
+        free (r->tx.buf);
+        free (r->rx.buf);
+        free (r);
+        errno = saved_errno;
+    }
+}
+
+static bool valid_size (uint64_t size)
+{
+    return size > 0 && size <= UINT32_MAX && (size & (size - 1)) == 0;
+}
+
+static int shmring_map (struct shmring *r, size_t size)
+{
+    r->mapsize = SHMRING_HDR_SIZE + 2 * size;
+    r->base = mmap (NULL,
+                    r->mapsize,
+                    PROT_READ | PROT_WRITE,
+                    MAP_SHARED,
+                    r->memfd,
+                    0);
+    if (r->base == MAP_FAILED) {
+        r->base = NULL;
+        return -1;
+    }
+    r->hdr = r->base;
+    r->data[0] = (uint8_t *)r->base + SHMRING_HDR_SIZE;
+    r->data[1] = r->data[0] + size;
+    r->size = size;
+    r->mask = size - 1;
+    return 0;
+}
+
+struct shmring *shmring_create (size_t size)
+{
+    struct shmring *r;
+    int i;
+
+    if (!valid_size (size)) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(r = shmring_alloc ()))
+        return NULL;
+    r->side = SHMRING_SERVER;
+    if ((r->memfd = memfd_create ("flux-shmring",
+                                  MFD_CLOEXEC | MFD_ALLOW_SEALING)) < 0
+        || ftruncate (r->memfd, SHMRING_HDR_SIZE + 2 * size) < 0
+        || fcntl (r->memfd,
+                  F_ADD_SEALS,
+                  F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) < 0)
+        goto error;
+    for (i = 0; i < 2; i++) {
+        if ((r->efd[i] = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK)) < 0)
+            goto error;
+    }
+    if (shmring_map (r, size) < 0)
+        goto error;
+    r->hdr->size = size;
+    r->hdr->version = SHMRING_VERSION;
+    r->hdr->magic = SHMRING_MAGIC;
+    return r;
+error:
+    shmring_destroy (r);
+    return NULL;
+}
+
+struct shmring *shmring_attach (int fds[3])
+{
+    struct shmring *r;
+    struct stat sb;
+    int seals;
+    uint64_t size;
+
+    if (!fds || fds[0] < 0 || fds[1] < 0 || fds[2] < 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (fstat (fds[0], &sb) < 0)
+        return NULL;
+    if ((seals = fcntl (fds[0], F_GET_SEALS)) < 0)
+        return NULL;
+    if (!(seals & F_SEAL_SHRINK) || sb.st_size <= SHMRING_HDR_SIZE) {
+        errno = EPROTO;
+        return NULL;
+    }
+    size = (sb.st_size - SHMRING_HDR_SIZE) / 2;
+    if (!valid_size (size) || SHMRING_HDR_SIZE + 2 * size != sb.st_size) {
+        errno = EPROTO;
+        return NULL;
+    }
+    if (!(r = shmring_alloc ()))
+        return NULL;
+    r->side = SHMRING_CLIENT;
+    r->memfd = fds[0];
+    if (shmring_map (r, size) < 0)
+        goto error;
+    if (r->hdr->magic != SHMRING_MAGIC
+        || r->hdr->version != SHMRING_VERSION
+        || r->hdr->size != size) {
+        errno = EPROTO;
+        goto error;
+    }
+    r->efd[SHMRING_SERVER] = fds[1];
+    r->efd[SHMRING_CLIENT] = fds[2];
+    /* Pick up where the server left off (normally zero).
+     */
+    r->tx_head = r->hdr->ring[r->side].head;
+    r->rx_tail = r->hdr->ring[!r->side].tail;
+    return r;
+error:
+    r->memfd = -1; // not owned on failure
+    shmring_destroy (r);
+    return NULL;
+}
+
+int shmring_pollfd (struct shmring *r)
+{
+    if (!r) {
+        errno = EINVAL;
+        return -1;
+    }
+    return r->efd[r->side];
+}
+
+/* Wake the peer if it is asleep.  The fence orders the caller's prior
+ * index update before the load of the peer's flag (see above).
+ */
+static void notify_peer (struct shmring *r)
+{
+    int peer = !r->side;
+
+    __atomic_thread_fence (__ATOMIC_SEQ_CST);
+    if (__atomic_load_n (&r->hdr->sleeping[peer], __ATOMIC_RELAXED)) {
+        uint64_t val = 1;
+        if (write (r->efd[peer], &val, sizeof (val)) < 0) {
+            // EAGAIN means the counter is saturated, so peer will wake
+        }
+    }
+}
+
+static ssize_t ring_write (struct shmring *r, const uint8_t *buf, size_t len)
+{
+    struct ring_ctl *ctl = &r->hdr->ring[r->side];
+    uint64_t tail = __atomic_load_n (&ctl->tail, __ATOMIC_ACQUIRE);
+    uint64_t used = r->tx_head - tail;
+    size_t off = r->tx_head & r->mask;
+    size_t n, chunk;
+
+    if (used > r->size) {
+        errno = EPROTO;
+        return -1;
+    }
+    /* A side that is producing is not blocked, so stop asking the peer
+     * for wakeups as it consumes.  The eventfd is reset on next wake.
+     */
+    if (r->asleep) {
+        __atomic_store_n (&r->hdr->sleeping[r->side], 0, __ATOMIC_RELAXED);
+        r->asleep = false;
+        r->drain = true;
+    }
+    n = r->size - used;
+    if (n > len)
+        n = len;
+    chunk = r->size - off;
+    if (chunk > n)
+        chunk = n;
+    memcpy (r->data[r->side] + off, buf, chunk);
+    memcpy (r->data[r->side], buf + chunk, n - chunk);
+    if (n > 0) {
+        r->tx_head += n;
+        __atomic_store_n (&ctl->head, r->tx_head, __ATOMIC_RELEASE);
+    }
+    return n;
+}
+
+static ssize_t ring_read (struct shmring *r, uint8_t *buf, size_t len)
+{
+    int peer = !r->side;
+    struct ring_ctl *ctl = &r->hdr->ring[peer];
+    uint64_t head = __atomic_load_n (&ctl->head, __ATOMIC_ACQUIRE);
+    uint64_t avail = head - r->rx_tail;
+    size_t off = r->rx_tail & r->mask;
+    size_t n, chunk;
+
+    if (avail > r->size) {
+        errno = EPROTO;
+        return -1;
+    }
+    n = avail < len ? avail : len;
+    chunk = r->size - off;
+    if (chunk > n)
+        chunk = n;
+    memcpy (buf, r->data[peer] + off, chunk);
+    memcpy (buf + chunk, r->data[peer], n - chunk);
+    if (n > 0) {
+        r->rx_tail += n;
+        __atomic_store_n (&ctl->tail, r->rx_tail, __ATOMIC_RELEASE);
+    }
+    return n;
+}
+
+static int grow (uint8_t **buf, size_t *cap, size_t size)
+{
+    if (size > *cap) {
+        uint8_t *new;
+        if (!(new = realloc (*buf, size)))
+            return -1;
+        *buf = new;
+        *cap = size;
+    }
+    return 0;
+}
+
+int shmring_flush (struct shmring *r)
+{
+    ssize_t n;
+
+    if (!r) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (r->tx.size == 0)
+        return 0;
+    if ((n = ring_write (r,
+                         r->tx.buf + r->tx.done,
+                         r->tx.size - r->tx.done)) < 0)
+        return -1;
+    if (n > 0)
+        notify_peer (r);
+    r->tx.done += n;
+    if (r->tx.done < r->tx.size) {
+        errno = EAGAIN;
+        return -1;
+    }
+    r->tx.size = r->tx.done = 0;
+    if (r->tx.cap > r->size) {
+        free (r->tx.buf);
+        r->tx.buf = NULL;
+        r->tx.cap = 0;
+    }
+    return 0;
+}
+
+int shmring_send (struct shmring *r, const flux_msg_t *msg)
+{
+    ssize_t size;
+    uint32_t len;
+
+    if (!r || !msg) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (r->tx.size > 0)
+        return shmring_flush (r);
+    if ((size = flux_msg_encode_size (msg)) < 0)
+        return -1;
+    if (size == 0 || size > UINT32_MAX) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+    if (grow (&r->tx.buf, &r->tx.cap, sizeof (len) + size) < 0)
+        return -1;
+    len = size;
+    memcpy (r->tx.buf, &len, sizeof (len));
+    if (flux_msg_encode (msg, r->tx.buf + sizeof (len), size) < 0)
+        return -1;
+    r->tx.size = sizeof (len) + size;
+    r->tx.done = 0;
+    return shmring_flush (r);
+}
+
+flux_msg_t *shmring_recv (struct shmring *r)
+{
+    bool progress = false;
+    flux_msg_t *msg;
+    ssize_t n;
+
+    if (!r) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (r->rx.lendone < sizeof (r->rx.len)) {
+        if ((n = ring_read (r,
+                            (uint8_t *)&r->rx.len + r->rx.lendone,
+                            sizeof (r->rx.len) - r->rx.lendone)) < 0)
+            return NULL;
+        if (n > 0)
+            progress = true;
+        r->rx.lendone += n;
+        if (r->rx.lendone < sizeof (r->rx.len))
+            goto again;
+        if (r->rx.len == 0) {
+            errno = EPROTO;
+            return NULL;
+        }
+        if (grow (&r->rx.buf, &r->rx.cap, r->rx.len) < 0)
+            return NULL;
+        r->rx.done = 0;
+    }
+    if ((n = ring_read (r, r->rx.buf + r->rx.done, r->rx.len - r->rx.done)) < 0)
+        return NULL;
+    if (n > 0)
+        progress = true;
+    r->rx.done += n;
+    if (r->rx.done < r->rx.len)
+        goto again;
+    notify_peer (r);
+    msg = flux_msg_decode (r->rx.buf, r->rx.len);
+    r->rx.lendone = 0;
+    if (r->rx.cap > r->size) {
+        ERRNO_SAFE_WRAP (free, r->rx.buf);
+        r->rx.buf = NULL;
+        r->rx.cap = 0;
+    }
+    return msg;
+again:
+    if (progress)
+        notify_peer (r);
+    errno = EAGAIN;
+    return NULL;
+}
+
+bool shmring_rx_ready (struct shmring *r)
+{
+    uint64_t head;
+
+    if (!r)
+        return false;
+    head = __atomic_load_n (&r->hdr->ring[!r->side].head, __ATOMIC_ACQUIRE);
+    return head != r->rx_tail;
+}
+
+bool shmring_tx_pending (struct shmring *r)
+{
+    return r && r->tx.size > 0;
+}
+
+/* True if a pending message can make progress.
+ */
+static bool tx_ready (struct shmring *r)
+{
+    uint64_t tail;
+
+    if (r->tx.size == 0)
+        return false;
+    tail = __atomic_load_n (&r->hdr->ring[r->side].tail, __ATOMIC_ACQUIRE);
+    return r->tx_head - tail != r->size;
+}
+
+bool shmring_sleep (struct shmring *r)
+{
+    if (!r)
+        return false;
+    if (!r->asleep) {
+        __atomic_store_n (&r->hdr->sleeping[r->side], 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence (__ATOMIC_SEQ_CST);
+        r->asleep = true;
+    }
+    if (shmring_rx_ready (r) || tx_ready (r)) {
+        shmring_wake (r);
+        return false;
+    }
+    return true;
+}
+
+void shmring_wake (struct shmring *r)
+{
+    if (r && (r->asleep || r->drain)) {
+        uint64_t val;
+
+        __atomic_store_n (&r->hdr->sleeping[r->side], 0, __ATOMIC_RELAXED);
+        if (read (r->efd[r->side], &val, sizeof (val)) < 0) {
+            // EAGAIN if peer did not signal
+        }
+        r->asleep = false;
+        r->drain = false;
+    }
+}
+
+static int send_status (int fd, unsigned char status, int *fds, int nfds)
+{
+    union {
+        char buf[CMSG_SPACE (sizeof (int) * 3)];
+        struct cmsghdr align;
+    } u;
+    struct iovec iov = { .iov_base = &status, .iov_len = 1 };
+    struct msghdr mh;
+
+    memset (&mh, 0, sizeof (mh));
+    mh.msg_iov = &iov;
+    mh.msg_iovlen = 1;
+    if (nfds > 0) {
+        struct cmsghdr *cmsg;
+
+        memset (&u, 0, sizeof (u));
+        mh.msg_control = u.buf;
+        mh.msg_controllen = CMSG_SPACE (sizeof (int) * nfds);
+        cmsg = CMSG_FIRSTHDR (&mh);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN (sizeof (int) * nfds);
+        memcpy (CMSG_DATA (cmsg), fds, sizeof (int) * nfds);
+    }
+    while (sendmsg (fd, &mh, MSG_NOSIGNAL) < 0) {
+        if (errno != EINTR)
+            return -1;
+    }
+    return 0;
+}
+
+int shmring_send_fds (int fd, struct shmring *r)
+{
+    int fds[3];
+
+    if (fd < 0 || !r || r->side != SHMRING_SERVER) {
+        errno = EINVAL;
+        return -1;
+    }
+    fds[0] = r->memfd;
+    fds[1] = r->efd[SHMRING_SERVER];
+    fds[2] = r->efd[SHMRING_CLIENT];
+    return send_status (fd, 0, fds, 3);
+}
+
+int shmring_reject (int fd, int errnum)
+{
+    if (fd < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (errnum <= 0 || errnum > 255)
+        errnum = EPERM;
+    return send_status (fd, errnum, NULL, 0);
+}
+
+struct shmring *shmring_recv_fds (int fd)
+{
+    union {
+        char buf[CMSG_SPACE (sizeof (int) * 3)];
+        struct cmsghdr align;
+    } u;
+    unsigned char status;
+    struct iovec iov = { .iov_base = &status, .iov_len = 1 };
+    struct msghdr mh;
+    struct cmsghdr *cmsg;
+    int fds[3] = { -1, -1, -1 };
+    int nfds = 0;
+    struct shmring *r = NULL;
+    ssize_t n;
+    int i;
+
+    memset (&mh, 0, sizeof (mh));
+    mh.msg_iov = &iov;
+    mh.msg_iovlen = 1;
+    mh.msg_control = u.buf;
+    mh.msg_controllen = sizeof (u.buf);
+    while ((n = recvmsg (fd, &mh, MSG_CMSG_CLOEXEC)) < 0) {
+        if (errno != EINTR)
+            return NULL;
+    }
+    if (n == 0) {
+        errno = ECONNRESET;
+        return NULL;
+    }
+    for (cmsg = CMSG_FIRSTHDR (&mh); cmsg; cmsg = CMSG_NXTHDR (&mh, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET
+            && cmsg->cmsg_type == SCM_RIGHTS) {
+            nfds = (cmsg->cmsg_len - CMSG_LEN (0)) / sizeof (int);
+            if (nfds > 3)
+                nfds = 3;
+            memcpy (fds, CMSG_DATA (cmsg), sizeof (int) * nfds);
+            break;
+        }
+    }
+    if (status != 0)
+        errno = status;
+    else if (nfds != 3 || (mh.msg_flags & MSG_CTRUNC))
+        errno = EPROTO;
+    else
+        r = shmring_attach (fds);
+    if (!r) {
+        for (i = 0; i < nfds; i++)
+            ERRNO_SAFE_WRAP (close, fds[i]);
+    }
+    return r;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
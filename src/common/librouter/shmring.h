@@ -0,0 +1,108 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _ROUTER_SHMRING_H
+#define _ROUTER_SHMRING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <flux/core.h>
+
+/* A pair of single-producer, single-consumer byte rings in a sealed
+ * memfd, one per direction, carrying length-prefixed encoded messages.
+ *
+ * The server creates the rings and passes the memfd plus two eventfds to
+ * the client over a unix domain socket with SCM_RIGHTS.  Each side has
+ * an eventfd that the peer writes to wake it, but only if it has
+ * announced that it is about to block with shmring_sleep().  While both
+ * sides are busy, messages move without system calls.
+ *
+ * The server does not trust the client: indices read from shared memory
+ * are validated and message bytes are copied out of the ring before
+ * decoding.  A misbehaving client causes EPROTO on the server side.
+ */
+
+enum {
+    SHMRING_SERVER = 0,
+    SHMRING_CLIENT = 1,
+};
+
+#define SHMRING_DEFAULT_SIZE (256 * 1024)
+
+/* The handshake socket is the local:// socket path plus this suffix.
+ */
+#define SHMRING_SOCKET_SUFFIX "-shmem"
+
+struct shmring;
+
+/* Create rings of 'size' bytes each ('size' must be a power of two).
+ * The caller is the server side.
+ */
+struct shmring *shmring_create (size_t size);
+
+/* Attach to rings created by a server, with the three descriptors
+ * (memfd, server eventfd, client eventfd) as received from the server.
+ * On success the descriptors are owned by the shmring.
+ */
+struct shmring *shmring_attach (int fds[3]);
+
+void shmring_destroy (struct shmring *r);
+
+/* Return the eventfd that is signaled when this side is asleep and the
+ * peer makes progress.
+ */
+int shmring_pollfd (struct shmring *r);
+
+/* Queue 'msg' to the peer.  If the ring is full, as much as fits is
+ * copied and -1 is returned with errno = EAGAIN.  In that case the
+ * remainder is held internally, and the same message must be passed
+ * again (or shmring_flush() called) until the call succeeds.
+ */
+int shmring_send (struct shmring *r, const flux_msg_t *msg);
+
+/* Copy any held remainder of a partially sent message to the ring.
+ * Returns 0 when nothing remains, or -1 with errno = EAGAIN.
+ */
+int shmring_flush (struct shmring *r);
+
+/* Receive one message.  Returns NULL with errno = EAGAIN if a complete
+ * message is not yet available, or EPROTO if the peer corrupted the ring.
+ */
+flux_msg_t *shmring_recv (struct shmring *r);
+
+/* Test whether shmring_recv() can make progress.
+ */
+bool shmring_rx_ready (struct shmring *r);
+
+/* Test whether part of a message is still held by shmring_send().
+ */
+bool shmring_tx_pending (struct shmring *r);
+
+/* Announce that this side is about to block on shmring_pollfd().
+ * Returns false (and stays awake) if there is already work to do, so the
+ * caller must not block.  Call shmring_wake() after waking.
+ */
+bool shmring_sleep (struct shmring *r);
+void shmring_wake (struct shmring *r);
+
+/* Handshake helpers.  The server sends the shmring descriptors on
+ * connected socket 'fd' along with a zero status byte, or rejects the
+ * client by sending 'errnum' as the status byte (like the usock
+ * handshake).  The client receives the descriptors and attaches.
+ */
+int shmring_send_fds (int fd, struct shmring *r);
+int shmring_reject (int fd, int errnum);
+struct shmring *shmring_recv_fds (int fd);
+
+#endif /* !_ROUTER_SHMRING_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -30,6 +30,8 @@
  *
  * subhash_topic_match() can be used to test if a message topic matches any
  * subscription topics for a given subhash, as an aid to event distribution.
+ * Topics are also indexed in a subtrie so this costs O(topic length)
+ * rather than O(subscriptions).
  */
 
 #if HAVE_CONFIG_H
@@ -40,9 +42,9 @@
 
 #include "src/common/libutil/errno_safe.h"
 #include "src/common/libczmqcontainers/czmq_containers.h"
-#include "ccan/str/str.h"
 
 #include "subhash.h"
+#include "subtrie.h"
 
 struct subhash_entry {
     char *topic;
@@ -52,6 +54,7 @@ struct subhash_entry {
 
 struct subhash {
     zhashx_t *subs;
+    struct subtrie *trie;
     subscribe_f unsub;
     void *unsub_arg;
     subscribe_f sub;
@@ -95,21 +98,13 @@ error:
     return NULL;
 }
 
+/* A subscription to "" matches all topics.
+ * A subscription to "foo" matches "foo", "foobar", "foo.bar".
+ */
 bool subhash_topic_match (struct subhash *sh, const char *topic)
 {
-    struct subhash_entry *entry;
-
-    if (sh && topic) {
-        entry = zhashx_first (sh->subs);
-        while (entry) {
-            /* entry->topic="" matches all
-             * entry->topic="foo" matches "foo", "foobar", "foo.bar"
-             */
-            if (strstarts (topic, entry->topic))
-                return true;
-            entry = zhashx_next (sh->subs);
-        }
-    }
+    if (sh && topic)
+        return subtrie_match_any (sh->trie, topic);
     return false;
 }
 
@@ -127,8 +122,13 @@ int subhash_subscribe (struct subhash *sh, const char *topic)
     else {
         if (!(entry = subhash_entry_create (topic)))
             return -1;
+        if (subtrie_insert (sh->trie, topic, sh) < 0) {
+            subhash_entry_destroy (entry);
+            return -1;
+        }
         if (sh->sub) {
             if (sh->sub (topic, sh->sub_arg) < 0) {
+                ERRNO_SAFE_WRAP (subtrie_remove, sh->trie, topic, sh);
                 subhash_entry_destroy (entry);
                 return -1;
             }
@@ -154,8 +154,10 @@ int subhash_unsubscribe (struct subhash *sh, const char *topic)
                 return -1;
             entry->sh = NULL; // prevent destructor from calling unsub()
         }
-        if (--entry->refcount == 0)
+        if (--entry->refcount == 0) {
+            (void)subtrie_remove (sh->trie, topic, sh);
             zhashx_delete (sh->subs, topic);
+        }
     }
     else {
         errno = ENOENT;
@@ -199,6 +201,7 @@ void subhash_destroy (struct subhash *sh)
 {
     if (sh) {
         ERRNO_SAFE_WRAP (zhashx_destroy, &sh->subs);
+        subtrie_destroy (sh->trie);
         ERRNO_SAFE_WRAP (free, sh);
     }
 }
@@ -212,6 +215,8 @@ struct subhash *subhash_create (void)
     if (!(sh->subs = zhashx_new ()))
         goto error;
     zhashx_set_destructor (sh->subs, subhash_entry_destructor);
+    if (!(sh->trie = subtrie_create ()))
+        goto error;
     return sh;
 error:
     subhash_destroy (sh);
@@ -0,0 +1,264 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* subtrie.c - event subscriptions indexed by topic prefix
+ *
+ * Subscription topics are stored in a trie with one node per topic byte.
+ * Each node holds the set of subscribers whose topic ends there.  Since
+ * a subscription matches any topic it is a prefix of, the subscribers
+ * for a topic are found by walking the trie along the topic bytes and
+ * collecting the subscriber sets of the nodes visited, which costs
+ * O(topic length + matching subscribers) regardless of how many other
+ * subscriptions exist.
+ *
+ * Children are kept in an array sorted by byte value.  Nodes that have
+ * neither subscribers nor children are pruned on removal.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "src/common/libutil/errno_safe.h"
+
+#include "subtrie.h"
+
+struct subtrie_node {
+    struct subtrie_node *parent;
+    unsigned char c;
+    struct subtrie_node **children;
+    int nchildren;
+    void **subs;
+    int nsubs;
+};
+
+struct subtrie {
+    struct subtrie_node root;
+};
+
+static void node_destroy (struct subtrie_node *node)
+{
+    if (node) {
+        for (int i = 0; i < node->nchildren; i++)
+            node_destroy (node->children[i]);
+        free (node->children);
+        free (node->subs);
+        free (node);
+    }
+}
+
+/* Find the index of the child for byte 'c', or the index where it
+ * would be inserted, by binary search.
+ */
+static int node_child_index (struct subtrie_node *node, unsigned char c)
+{
+    int lo = 0;
+    int hi = node->nchildren;
+
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (node->children[mid]->c < c)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static struct subtrie_node *node_child (struct subtrie_node *node,
+                                        unsigned char c)
+{
+    int i = node_child_index (node, c);
+
+    if (i < node->nchildren && node->children[i]->c == c)
+        return node->children[i];
+    return NULL;
+}
+
+static struct subtrie_node *node_child_add (struct subtrie_node *node,
+                                            unsigned char c)
+{
+    struct subtrie_node **children;
+    struct subtrie_node *child;
+    int i = node_child_index (node, c);
+
+    if (i < node->nchildren && node->children[i]->c == c)
+        return node->children[i];
+    if (!(child = calloc (1, sizeof (*child))))
+        return NULL;
+    if (!(children = realloc (node->children,
+                              sizeof (children[0]) * (node->nchildren + 1)))) {
+        free (child);
+        errno = ENOMEM;
+        return NULL;
+    }
+    memmove (&children[i + 1],
+             &children[i],
+             sizeof (children[0]) * (node->nchildren - i));
+    child->parent = node;
+    child->c = c;
+    children[i] = child;
+    node->children = children;
+    node->nchildren++;
+    return child;
+}
+
+/* Remove empty nodes from 'node' up toward (but not including) the root.
+ */
+static void node_prune (struct subtrie_node *node)
+{
+    while (node->parent && node->nsubs == 0 && node->nchildren == 0) {
+        struct subtrie_node *parent = node->parent;
+        int i = node_child_index (parent, node->c);
+
+        memmove (&parent->children[i],
+                 &parent->children[i + 1],
+                 sizeof (parent->children[0]) * (parent->nchildren - i - 1));
+        parent->nchildren--;
+        node_destroy (node);
+        node = parent;
+    }
+}
+
+static int node_sub_index (struct subtrie_node *node, void *subscriber)
+{
+    for (int i = 0; i < node->nsubs; i++) {
+        if (node->subs[i] == subscriber)
+            return i;
+    }
+    return -1;
+}
+
+static struct subtrie_node *lookup (struct subtrie *st, const char *topic)
+{
+    struct subtrie_node *node = &st->root;
+    const unsigned char *cp = (const unsigned char *)topic;
+
+    while (node && *cp)
+        node = node_child (node, *cp++);
+    return node;
+}
+
+int subtrie_insert (struct subtrie *st, const char *topic, void *subscriber)
+{
+    struct subtrie_node *node;
+    const unsigned char *cp;
+    void **subs;
+
+    if (!st || !topic || !subscriber) {
+        errno = EINVAL;
+        return -1;
+    }
+    node = &st->root;
+    for (cp = (const unsigned char *)topic; *cp; cp++) {
+        struct subtrie_node *child;
+        if (!(child = node_child_add (node, *cp)))
+            goto error;
+        node = child;
+    }
+    if (node_sub_index (node, subscriber) >= 0) {
+        errno = EEXIST;
+        return -1;
+    }
+    if (!(subs = realloc (node->subs, sizeof (subs[0]) * (node->nsubs + 1)))) {
+        errno = ENOMEM;
+        goto error;
+    }
+    subs[node->nsubs++] = subscriber;
+    node->subs = subs;
+    return 0;
+error:
+    ERRNO_SAFE_WRAP (node_prune, node);
+    return -1;
+}
+
+int subtrie_remove (struct subtrie *st, const char *topic, void *subscriber)
+{
+    struct subtrie_node *node;
+    int i;
+
+    if (!st || !topic || !subscriber) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!(node = lookup (st, topic))
+        || (i = node_sub_index (node, subscriber)) < 0) {
+        errno = ENOENT;
+        return -1;
+    }
+    node->subs[i] = node->subs[--node->nsubs];
+    node_prune (node);
+    return 0;
+}
+
+void subtrie_match (struct subtrie *st,
+                    const char *topic,
+                    subtrie_match_f cb,
+                    void *arg)
+{
+    struct subtrie_node *node;
+    const unsigned char *cp;
+
+    if (!st || !topic || !cb)
+        return;
+    node = &st->root;
+    cp = (const unsigned char *)topic;
+    while (node) {
+        for (int i = 0; i < node->nsubs; i++)
+            cb (node->subs[i], arg);
+        if (*cp == '\0')
+            break;
+        node = node_child (node, *cp++);
+    }
+}
+
+bool subtrie_match_any (struct subtrie *st, const char *topic)
+{
+    struct subtrie_node *node;
+    const unsigned char *cp;
+
+    if (!st || !topic)
+        return false;
+    node = &st->root;
+    cp = (const unsigned char *)topic;
+    while (node) {
+        if (node->nsubs > 0)
+            return true;
+        if (*cp == '\0')
+            break;
+        node = node_child (node, *cp++);
+    }
+    return false;
+}
+
+void subtrie_destroy (struct subtrie *st)
+{
+    if (st) {
+        int saved_errno = errno;
+        for (int i = 0; i < st->root.nchildren; i++)
+            node_destroy (st->root.children[i]);
+        free (st->root.children);
+        free (st->root.subs);
+        free (st);
+        errno = saved_errno;
+    }
+}
+
+struct subtrie *subtrie_create (void)
+{
+    return calloc (1, sizeof (struct subtrie));
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,45 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _ROUTER_SUBTRIE_H
+#define _ROUTER_SUBTRIE_H
+
+#include <stdbool.h>
+
+typedef void (*subtrie_match_f)(void *subscriber, void *arg);
+
+struct subtrie *subtrie_create (void);
+void subtrie_destroy (struct subtrie *st);
+
+/* Add/remove 'subscriber' to/from the set for subscription 'topic'.
+ * Each (topic, subscriber) pair may be inserted once (else EEXIST).
+ * subtrie_remove() fails with ENOENT if the pair is not present.
+ */
+int subtrie_insert (struct subtrie *st, const char *topic, void *subscriber);
+int subtrie_remove (struct subtrie *st, const char *topic, void *subscriber);
+
+/* Call 'cb' for each subscriber to a prefix of 'topic', including "".
+ * A subscriber to more than one such prefix is reported once per prefix.
+ * The trie must not be modified from 'cb'.
+ */
+void subtrie_match (struct subtrie *st,
+                    const char *topic,
+                    subtrie_match_f cb,
+                    void *arg);
+
+/* Return true if any subscription is a prefix of 'topic'.
+ */
+bool subtrie_match_any (struct subtrie *st, const char *topic);
+
+#endif /* !_ROUTER_SUBTRIE_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -198,6 +198,87 @@ void test_disconnect (void)
     flux_msg_decref (dis);
 }
 
+/* Many senders reusing the same matchtags.
+ */
+void test_senders (void)
+{
+    struct rpc_track *rt;
+    struct rpc_track_stats st;
+    flux_msg_t *req[8][4];
+    flux_msg_t *msg;
+    int count;
+    int i, j;
+
+    if (!(rt = rpc_track_create (MSG_HASH_TYPE_UUID_MATCHTAG)))
+        BAIL_OUT ("rpc_track_create failed");
+    for (i = 0; i < ARRAY_SIZE (req); i++) {
+        req[i][0] = create_request (1, 0, true);
+        for (j = 1; j < ARRAY_SIZE (req[i]); j++) {
+            if (!(req[i][j] = flux_msg_copy (req[i][0], true))
+                || flux_msg_set_matchtag (req[i][j], j + 1) < 0)
+                BAIL_OUT ("could not create test message");
+        }
+        for (j = 0; j < ARRAY_SIZE (req[i]); j++)
+            rpc_track_update (rt, req[i][j]);
+    }
+    rpc_track_get_stats (rt, &st);
+    ok (rpc_track_count (rt) == 32 && st.tracked == 32 && st.senders == 8,
+        "rpc_track_update tracks 32 requests from 8 senders");
+
+    rpc_track_update (rt, req[0][0]);
+    ok (rpc_track_count (rt) == 32,
+        "a duplicate request is not tracked twice");
+
+    /* Terminate all requests of sender 0, and one of sender 1.
+     */
+    for (j = 0; j < ARRAY_SIZE (req[0]); j++) {
+        msg = create_response (req[0][j], 0);
+        rpc_track_update (rt, msg);
+        flux_msg_decref (msg);
+    }
+    msg = create_response (req[1][2], 0);
+    rpc_track_update (rt, msg);
+    rpc_track_update (rt, msg);
+    flux_msg_decref (msg);
+    rpc_track_get_stats (rt, &st);
+    ok (rpc_track_count (rt) == 27 && st.completed == 5 && st.senders == 7,
+        "responses terminate only their own requests");
+
+    /* Disconnect senders 1 and 2.
+     */
+    for (i = 1; i < 3; i++) {
+        msg = create_disconnect (req[i][0]);
+        rpc_track_update (rt, msg);
+        flux_msg_decref (msg);
+    }
+    rpc_track_get_stats (rt, &st);
+    ok (rpc_track_count (rt) == 20
+        && st.disconnected == 7
+        && st.senders == 5,
+        "disconnect drops only the sender's requests");
+
+    /* A sender that went away may come back.
+     */
+    rpc_track_update (rt, req[0][1]);
+    ok (rpc_track_count (rt) == 21,
+        "a request from a removed sender is tracked again");
+
+    count = 0;
+    rpc_track_purge (rt, purge, &count);
+    rpc_track_get_stats (rt, &st);
+    ok (count == 21
+        && rpc_track_count (rt) == 0
+        && st.purged == 21
+        && st.senders == 0,
+        "rpc_track_purge called callback 21 times and emptied tracker");
+
+    rpc_track_destroy (rt);
+    for (i = 0; i < ARRAY_SIZE (req); i++) {
+        for (j = 0; j < ARRAY_SIZE (req[i]); j++)
+            flux_msg_decref (req[i][j]);
+    }
+}
+
 void test_badarg (void)
 {
     struct rpc_track *rt;
@@ -334,6 +415,8 @@ void test_nilarg (void)
 
     lives_ok ({rpc_track_purge (rt, NULL, NULL);},
               "rpc_track_purge func=NULL doesn't crash");
+    lives_ok ({rpc_track_get_stats (NULL, NULL);},
+              "rpc_track_get_stats rt=NULL doesn't crash");
     lives_ok ({rpc_track_destroy (NULL);},
               "rpc_track_destroy rt=NULL doesn't crash");
 
@@ -349,6 +432,7 @@ int main (int argc, char *argv[])
     test_basic ();
     test_purge ();
     test_disconnect ();
+    test_senders ();
     test_badarg ();
     test_hashable ();
     test_nilarg ();
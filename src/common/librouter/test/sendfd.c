@@ -124,9 +124,89 @@ void test_eof (void)
     close (pfd[0]);
 }
 
+/* Send several messages, including a large payload and a message with
+ * many routes, in one sendfd_v() call over a blocking pipe.  Ensure each
+ * is received intact by recvfd().
+ */
+void test_writev (void)
+{
+    int pfd[2];
+    const flux_msg_t *msgs[3];
+    flux_msg_t *msg;
+    char buf[8192];
+    const char *topic;
+    const void *buf2;
+    int buf2len;
+    struct iobufv iobufv;
+    char id[16];
+    int i;
+
+    memset (buf, 0x5a, sizeof (buf));
+
+    if (pipe2 (pfd, O_CLOEXEC) < 0)
+        BAIL_OUT ("pipe2 failed");
+    if (!(msgs[0] = flux_request_encode ("foo.small", NULL))
+        || !(msgs[1] = flux_request_encode_raw ("foo.large", buf, sizeof (buf)))
+        || !(msg = flux_request_encode ("foo.routes", NULL)))
+        BAIL_OUT ("flux_request_encode failed");
+    flux_msg_route_enable (msg);
+    for (i = 0; i < 200; i++) {
+        snprintf (id, sizeof (id), "route%d", i);
+        if (flux_msg_route_push (msg, id) < 0)
+            BAIL_OUT ("flux_msg_route_push failed");
+    }
+    msgs[2] = msg;
+
+    iobufv_init (&iobufv);
+    ok (sendfd_v (pfd[1], msgs, 3, &iobufv) == 3,
+        "sendfd_v accepted 3 messages");
+    ok (!iobufv_pending (&iobufv),
+        "no output is pending");
+
+    ok ((msg = recvfd (pfd[0], NULL)) != NULL
+        && flux_request_decode (msg, &topic, NULL) == 0
+        && streq (topic, "foo.small"),
+        "recvfd got small message");
+    flux_msg_destroy (msg);
+    ok ((msg = recvfd (pfd[0], NULL)) != NULL
+        && flux_request_decode_raw (msg, &topic, &buf2, &buf2len) == 0
+        && streq (topic, "foo.large")
+        && buf2len == sizeof (buf)
+        && memcmp (buf2, buf, sizeof (buf)) == 0,
+        "recvfd got large message with intact payload");
+    flux_msg_destroy (msg);
+    ok ((msg = recvfd (pfd[0], NULL)) != NULL
+        && flux_request_decode (msg, &topic, NULL) == 0
+        && streq (topic, "foo.routes")
+        && flux_msg_route_count (msg) == 200
+        && streq (flux_msg_route_last (msg), "route199"),
+        "recvfd got message with 200 routes");
+    flux_msg_destroy (msg);
+
+    ok (sendfd_v (pfd[1], NULL, 0, &iobufv) == 0,
+        "sendfd_v count=0 with nothing pending works");
+
+    errno = 0;
+    ok (sendfd_v (-1, msgs, 1, &iobufv) < 0 && errno == EINVAL,
+        "sendfd_v fd=-1 fails with EINVAL");
+    errno = 0;
+    ok (sendfd_v (pfd[1], NULL, 1, &iobufv) < 0 && errno == EINVAL,
+        "sendfd_v msgs=NULL count=1 fails with EINVAL");
+    errno = 0;
+    ok (sendfd_v (pfd[1], msgs, 1, NULL) < 0 && errno == EINVAL,
+        "sendfd_v iobufv=NULL fails with EINVAL");
+
+    iobufv_clean (&iobufv);
+    for (i = 0; i < 3; i++)
+        flux_msg_decref (msgs[i]);
+    close (pfd[1]);
+    close (pfd[0]);
+}
+
 struct io {
     zlist_t *queue;
     struct iobuf iobuf;
+    struct iobufv iobufv;
     int fd;
     flux_watcher_t *w;
     int max;
@@ -183,6 +263,39 @@ void send_cb (flux_reactor_t *r, flux_watcher_t *w, int revents, void *arg)
     }
 }
 
+void send_v_cb (flux_reactor_t *r, flux_watcher_t *w, int revents, void *arg)
+{
+    struct io *io = arg;
+
+    if ((revents & FLUX_POLLERR))
+        BAIL_OUT ("send_v_cb POLLERR");
+    if ((revents & FLUX_POLLOUT)) {
+        const flux_msg_t *msgs[IOBUFV_MSG_MAX];
+        flux_msg_t *msg;
+        int count = 0;
+        int n;
+
+        msg = zlist_first (io->queue);
+        while (msg && count < IOBUFV_MSG_MAX) {
+            msgs[count++] = msg;
+            msg = zlist_next (io->queue);
+        }
+        if ((n = sendfd_v (io->fd, msgs, count, &io->iobufv)) < 0) {
+            if (errno == EWOULDBLOCK || errno == EAGAIN) {
+                diag ("send EWOULDBLOCK");
+                return;
+            }
+            BAIL_OUT ("sendfd_v error: %s", strerror (errno));
+        }
+        while (n-- > 0)
+            flux_msg_destroy (zlist_pop (io->queue));
+        if (zlist_size (io->queue) == 0 && !iobufv_pending (&io->iobufv)) {
+            diag ("send queue empty, stopping sender");
+            flux_watcher_stop (io->w);
+        }
+    }
+}
+
 void io_destroy (struct io *io)
 {
     if (io) {
@@ -195,6 +308,7 @@ void io_destroy (struct io *io)
         }
         flux_watcher_destroy (io->w);
         iobuf_clean (&io->iobuf);
+        iobufv_clean (&io->iobufv);
         free (io);
         errno = saved_errno;
     }
@@ -209,6 +323,7 @@ struct io *io_create (flux_reactor_t *r,
     if (!(io = calloc (1, sizeof (*io))))
         return NULL;
     iobuf_init (&io->iobuf);
+    iobufv_init (&io->iobufv);
     if (!(io->queue = zlist_new ()))
         goto error;
     io->fd = fd;
@@ -229,8 +344,9 @@ error:
  * - sender sends all enqueued messages
  * - receiver enqueues all received messages
  * Verify that messages are all received intact.
+ * If 'vec' is true, the sender uses sendfd_v() instead of sendfd().
  */
-void test_nonblock (int size, int count)
+void test_nonblock (int size, int count, bool vec)
 {
     int pfd[2];
     struct io *iow;
@@ -249,7 +365,10 @@ void test_nonblock (int size, int count)
         BAIL_OUT ("flux_reactor_create failed");
     if (pipe2 (pfd, O_CLOEXEC) < 0)
         BAIL_OUT ("pipe2 failed");
-    if (!(iow = io_create (r, pfd[1], FLUX_POLLOUT, send_cb)))
+    if (!(iow = io_create (r,
+                           pfd[1],
+                           FLUX_POLLOUT,
+                           vec ? send_v_cb : send_cb)))
         BAIL_OUT ("io_create failed: %s", flux_strerror (errno));
     if (!(ior = io_create (r, pfd[0], FLUX_POLLIN, recv_cb)))
         BAIL_OUT ("io_create failed: %s", flux_strerror (errno));
@@ -265,10 +384,11 @@ void test_nonblock (int size, int count)
     diag ("messages enqueued, starting reactor", count);
 
     ok (flux_reactor_run (r, 0) == 0,
-        "nonblock %d,%d: reactor ran", count, size);
+        "nonblock%s %d,%d: reactor ran", vec ? "-v" : "", count, size);
 
     ok (zlist_size (ior->queue) == count,
-        "nonblock %d,%d: all messages received",
+        "nonblock%s %d,%d: all messages received",
+        vec ? "-v" : "",
         count,
         size);
 
@@ -298,7 +418,8 @@ next:
     }
 
     ok (errors == 0,
-        "nonblock %d,%d: received messages are intact",
+        "nonblock%s %d,%d: received messages are intact",
+        vec ? "-v" : "",
         count,
         size);
 
@@ -338,10 +459,15 @@ int main (int argc, char *argv[])
     test_basic ();
     test_large ();
     test_eof ();
-    test_nonblock (1024, 1024);
-    test_nonblock (4096, 256);
-    test_nonblock (16384, 64);
-    test_nonblock (1048586, 1);
+    test_nonblock (1024, 1024, false);
+    test_nonblock (4096, 256, false);
+    test_nonblock (16384, 64, false);
+    test_nonblock (1048586, 1, false);
+    test_writev ();
+    test_nonblock (1024, 1024, true);
+    test_nonblock (4096, 256, true);
+    test_nonblock (16384, 64, true);
+    test_nonblock (1048586, 1, true);
     test_inval ();
 
     done_testing();
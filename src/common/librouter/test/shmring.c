@@ -0,0 +1,406 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <poll.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+
+#include <flux/core.h>
+
+#include "src/common/librouter/shmring.h"
+#include "src/common/libtap/tap.h"
+#include "ccan/str/str.h"
+
+/* Create a server ring and pass it over a socketpair to a client.
+ */
+static void create_pair (size_t size,
+                         struct shmring **server,
+                         struct shmring **client)
+{
+    int sv[2];
+
+    if (socketpair (AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) < 0)
+        BAIL_OUT ("socketpair failed");
+    if (!(*server = shmring_create (size)))
+        BAIL_OUT ("shmring_create failed");
+    if (shmring_send_fds (sv[0], *server) < 0)
+        BAIL_OUT ("shmring_send_fds failed");
+    if (!(*client = shmring_recv_fds (sv[1])))
+        BAIL_OUT ("shmring_recv_fds failed");
+    close (sv[0]);
+    close (sv[1]);
+}
+
+static bool fd_readable (int fd)
+{
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+
+    return poll (&pfd, 1, 0) == 1 && (pfd.revents & POLLIN);
+}
+
+static void test_badargs (void)
+{
+    int fds[3] = { -1, -1, -1 };
+
+    errno = 0;
+    ok (shmring_create (0) == NULL && errno == EINVAL,
+        "shmring_create size=0 fails with EINVAL");
+    errno = 0;
+    ok (shmring_create (1000) == NULL && errno == EINVAL,
+        "shmring_create size=1000 fails with EINVAL");
+    errno = 0;
+    ok (shmring_attach (fds) == NULL && errno == EINVAL,
+        "shmring_attach with invalid fds fails with EINVAL");
+    errno = 0;
+    ok (shmring_send (NULL, NULL) < 0 && errno == EINVAL,
+        "shmring_send r=NULL fails with EINVAL");
+    errno = 0;
+    ok (shmring_recv (NULL) == NULL && errno == EINVAL,
+        "shmring_recv r=NULL fails with EINVAL");
+    errno = 0;
+    ok (shmring_pollfd (NULL) < 0 && errno == EINVAL,
+        "shmring_pollfd r=NULL fails with EINVAL");
+    lives_ok ({shmring_destroy (NULL);},
+        "shmring_destroy r=NULL doesn't crash");
+}
+
+static void test_basic (void)
+{
+    struct shmring *server;
+    struct shmring *client;
+    flux_msg_t *msg;
+    flux_msg_t *msg2;
+    const char *topic;
+    const char *s;
+
+    create_pair (4096, &server, &client);
+
+    ok (shmring_rx_ready (server) == false
+        && shmring_rx_ready (client) == false,
+        "rings are initially empty");
+    errno = 0;
+    ok (shmring_recv (server) == NULL && errno == EAGAIN,
+        "shmring_recv on empty ring fails with EAGAIN");
+
+    if (!(msg = flux_request_encode ("foo.bar", "baz")))
+        BAIL_OUT ("flux_request_encode failed");
+    ok (shmring_send (client, msg) == 0,
+        "client shmring_send works");
+    ok (shmring_rx_ready (server) == true,
+        "server ring is ready");
+    ok ((msg2 = shmring_recv (server)) != NULL,
+        "server shmring_recv works");
+    ok (flux_request_decode (msg2, &topic, &s) == 0
+        && streq (topic, "foo.bar")
+        && streq (s, "baz"),
+        "server received the expected request");
+    flux_msg_destroy (msg2);
+
+    ok (shmring_send (server, msg) == 0,
+        "server shmring_send works");
+    ok ((msg2 = shmring_recv (client)) != NULL
+        && flux_request_decode (msg2, &topic, NULL) == 0
+        && streq (topic, "foo.bar"),
+        "client received the expected request");
+    flux_msg_destroy (msg2);
+    flux_msg_destroy (msg);
+
+    shmring_destroy (client);
+    shmring_destroy (server);
+}
+
+/* Send a message larger than the ring, alternating between send and
+ * recv, and then many small messages so the indices wrap.
+ */
+static void test_large (void)
+{
+    struct shmring *server;
+    struct shmring *client;
+    flux_msg_t *msg;
+    flux_msg_t *msg2 = NULL;
+    char buf[10000];
+    const void *buf2;
+    int size;
+    int tries = 0;
+    int count = 0;
+    int i;
+
+    create_pair (4096, &server, &client);
+
+    memset (buf, 0x5a, sizeof (buf));
+    if (!(msg = flux_request_encode_raw ("big", buf, sizeof (buf))))
+        BAIL_OUT ("flux_request_encode_raw failed");
+    errno = 0;
+    ok (shmring_send (client, msg) < 0 && errno == EAGAIN,
+        "shmring_send message larger than ring fails with EAGAIN");
+    ok (shmring_tx_pending (client) == true,
+        "part of the message is pending");
+    while (!msg2 && tries++ < 100) {
+        if (!(msg2 = shmring_recv (server)) && errno != EAGAIN)
+            break;
+        if (shmring_send (client, msg) < 0 && errno != EAGAIN)
+            break;
+    }
+    ok (msg2 != NULL && shmring_tx_pending (client) == false,
+        "large message was transferred in pieces");
+    ok (flux_request_decode_raw (msg2, NULL, &buf2, &size) == 0
+        && size == sizeof (buf)
+        && memcmp (buf2, buf, size) == 0,
+        "large message has the expected payload");
+    flux_msg_destroy (msg2);
+    flux_msg_destroy (msg);
+
+    if (!(msg = flux_request_encode ("small", NULL)))
+        BAIL_OUT ("flux_request_encode failed");
+    for (i = 0; i < 1000; i++) {
+        if (shmring_send (server, msg) < 0)
+            break;
+        if (!(msg2 = shmring_recv (client)))
+            break;
+        flux_msg_destroy (msg2);
+        count++;
+    }
+    ok (count == 1000,
+        "1000 small messages were transferred");
+    flux_msg_destroy (msg);
+
+    shmring_destroy (client);
+    shmring_destroy (server);
+}
+
+static void test_sleep (void)
+{
+    struct shmring *server;
+    struct shmring *client;
+    flux_msg_t *msg;
+    flux_msg_t *msg2;
+
+    create_pair (4096, &server, &client);
+    if (!(msg = flux_event_encode ("foo", NULL)))
+        BAIL_OUT ("flux_event_encode failed");
+
+    ok (shmring_send (server, msg) == 0,
+        "server sends a message while client is awake");
+    ok (fd_readable (shmring_pollfd (client)) == false,
+        "client eventfd was not signaled");
+    ok (shmring_sleep (client) == false,
+        "client shmring_sleep returns false with a message pending");
+    ok ((msg2 = shmring_recv (client)) != NULL,
+        "client received message");
+    flux_msg_destroy (msg2);
+
+    ok (shmring_sleep (client) == true,
+        "client shmring_sleep returns true with nothing pending");
+    ok (shmring_send (server, msg) == 0,
+        "server sends a message while client is asleep");
+    ok (fd_readable (shmring_pollfd (client)) == true,
+        "client eventfd was signaled");
+    shmring_wake (client);
+    ok (fd_readable (shmring_pollfd (client)) == false,
+        "shmring_wake reset the eventfd");
+    ok ((msg2 = shmring_recv (client)) != NULL,
+        "client received message");
+    flux_msg_destroy (msg2);
+    ok (fd_readable (shmring_pollfd (server)) == false,
+        "server eventfd was never signaled");
+
+    flux_msg_destroy (msg);
+    shmring_destroy (client);
+    shmring_destroy (server);
+}
+
+struct reader {
+    struct shmring *r;
+    int count;
+};
+
+static void *reader_thread (void *arg)
+{
+    struct reader *rd = arg;
+    struct pollfd pfd = { .fd = shmring_pollfd (rd->r), .events = POLLIN };
+    flux_msg_t *msg;
+
+    while (rd->count < 10000) {
+        if ((msg = shmring_recv (rd->r))) {
+            flux_msg_destroy (msg);
+            rd->count++;
+            continue;
+        }
+        if (errno != EAGAIN)
+            break;
+        if (shmring_sleep (rd->r)) {
+            (void)poll (&pfd, 1, -1);
+            shmring_wake (rd->r);
+        }
+    }
+    return NULL;
+}
+
+/* Producer and consumer in separate threads, both sleeping when
+ * they cannot make progress.  A lost wakeup would hang the test.
+ */
+static void test_threads (void)
+{
+    struct shmring *server;
+    struct shmring *client;
+    struct reader rd;
+    struct pollfd pfd;
+    flux_msg_t *msg;
+    pthread_t t;
+    int e;
+    int i;
+
+    create_pair (4096, &server, &client);
+    if (!(msg = flux_event_encode ("foo", "0123456789abcdef")))
+        BAIL_OUT ("flux_event_encode failed");
+
+    rd.r = server;
+    rd.count = 0;
+    if ((e = pthread_create (&t, NULL, reader_thread, &rd)) != 0)
+        BAIL_OUT ("pthread_create: %s", strerror (e));
+    pfd.fd = shmring_pollfd (client);
+    pfd.events = POLLIN;
+    for (i = 0; i < 10000; i++) {
+        while (shmring_send (client, msg) < 0) {
+            if (errno != EAGAIN)
+                BAIL_OUT ("shmring_send: %s", strerror (errno));
+            if (shmring_sleep (client)) {
+                (void)poll (&pfd, 1, -1);
+                shmring_wake (client);
+            }
+        }
+    }
+    if ((e = pthread_join (t, NULL)) != 0)
+        BAIL_OUT ("pthread_join: %s", strerror (e));
+    ok (rd.count == 10000,
+        "10000 messages were transferred between threads");
+
+    flux_msg_destroy (msg);
+    shmring_destroy (client);
+    shmring_destroy (server);
+}
+
+/* Receive the shmring descriptors like a client would, but return the
+ * raw memfd so the test can scribble on shared memory.
+ */
+static int recv_memfd (int fd)
+{
+    union {
+        char buf[CMSG_SPACE (sizeof (int) * 3)];
+        struct cmsghdr align;
+    } u;
+    unsigned char status;
+    struct iovec iov = { .iov_base = &status, .iov_len = 1 };
+    struct msghdr mh;
+    struct cmsghdr *cmsg;
+    int fds[3];
+
+    memset (&mh, 0, sizeof (mh));
+    mh.msg_iov = &iov;
+    mh.msg_iovlen = 1;
+    mh.msg_control = u.buf;
+    mh.msg_controllen = sizeof (u.buf);
+    if (recvmsg (fd, &mh, MSG_CMSG_CLOEXEC) != 1
+        || !(cmsg = CMSG_FIRSTHDR (&mh))
+        || cmsg->cmsg_len != CMSG_LEN (sizeof (fds)))
+        return -1;
+    memcpy (fds, CMSG_DATA (cmsg), sizeof (fds));
+    close (fds[1]);
+    close (fds[2]);
+    return fds[0];
+}
+
+/* The server must not trust indices written by the client.
+ */
+static void test_corrupt (void)
+{
+    struct shmring *server;
+    int sv[2];
+    int memfd;
+    uint8_t *p;
+
+    if (socketpair (AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) < 0)
+        BAIL_OUT ("socketpair failed");
+    if (!(server = shmring_create (4096)))
+        BAIL_OUT ("shmring_create failed");
+    if (shmring_send_fds (sv[0], server) < 0)
+        BAIL_OUT ("shmring_send_fds failed");
+    if ((memfd = recv_memfd (sv[1])) < 0)
+        BAIL_OUT ("error receiving memfd");
+
+    errno = 0;
+    ok (ftruncate (memfd, 0) < 0 && errno == EPERM,
+        "client cannot shrink the sealed memfd");
+
+    /* Fill the control area after magic/version/size with garbage.
+     */
+    p = mmap (NULL, 4096, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    if (p == MAP_FAILED)
+        BAIL_OUT ("mmap failed");
+    memset (p + 16, 0xff, 4096 - 16);
+    ok (shmring_rx_ready (server) == true,
+        "server sees garbage as pending data");
+    errno = 0;
+    ok (shmring_recv (server) == NULL && errno == EPROTO,
+        "server shmring_recv fails with EPROTO");
+    (void)munmap (p, 4096);
+
+    close (memfd);
+    close (sv[0]);
+    close (sv[1]);
+    shmring_destroy (server);
+}
+
+static void test_reject (void)
+{
+    int sv[2];
+
+    if (socketpair (AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) < 0)
+        BAIL_OUT ("socketpair failed");
+    ok (shmring_reject (sv[0], EPERM) == 0,
+        "shmring_reject works");
+    errno = 0;
+    ok (shmring_recv_fds (sv[1]) == NULL && errno == EPERM,
+        "shmring_recv_fds fails with the rejection errno");
+    close (sv[0]);
+    errno = 0;
+    ok (shmring_recv_fds (sv[1]) == NULL && errno == ECONNRESET,
+        "shmring_recv_fds fails with ECONNRESET on EOF");
+    close (sv[1]);
+}
+
+int main (int argc, char *argv[])
+{
+    plan (NO_PLAN);
+
+    test_badargs ();
+    test_basic ();
+    test_large ();
+    test_sleep ();
+    test_threads ();
+    test_corrupt ();
+    test_reject ();
+
+    done_testing ();
+    return (0);
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
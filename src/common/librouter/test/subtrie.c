@@ -0,0 +1,158 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <errno.h>
+#include <string.h>
+
+#include "src/common/libtap/tap.h"
+#include "src/common/librouter/subtrie.h"
+
+/* Subscribers are single characters; matches are appended to a string.
+ */
+static void match_cb (void *subscriber, void *arg)
+{
+    char *s = arg;
+    int n = strlen (s);
+
+    s[n] = *(char *)subscriber;
+    s[n + 1] = '\0';
+}
+
+static const char *match (struct subtrie *st, const char *topic)
+{
+    static char s[64];
+
+    s[0] = '\0';
+    subtrie_match (st, topic, match_cb, s);
+    return s;
+}
+
+void test_match (void)
+{
+    struct subtrie *st;
+    char a = 'a';
+    char b = 'b';
+    char c = 'c';
+
+    st = subtrie_create ();
+    ok (st != NULL,
+        "subtrie_create works");
+    ok (subtrie_match_any (st, "foo") == false,
+        "subtrie_match_any foo returns false on empty trie");
+    ok (strlen (match (st, "foo")) == 0,
+        "subtrie_match foo matches nothing on empty trie");
+
+    ok (subtrie_insert (st, "foo", &a) == 0,
+        "subtrie_insert foo a works");
+    ok (subtrie_insert (st, "foo", &b) == 0,
+        "subtrie_insert foo b works");
+    ok (subtrie_insert (st, "foo.bar", &c) == 0,
+        "subtrie_insert foo.bar c works");
+    ok (subtrie_insert (st, "fo", &c) == 0,
+        "subtrie_insert fo c works");
+    errno = 0;
+    ok (subtrie_insert (st, "foo", &a) < 0 && errno == EEXIST,
+        "subtrie_insert foo a again fails with EEXIST");
+
+    ok (!strcmp (match (st, "foo"), "cab"),
+        "subtrie_match foo matches fo:c foo:a,b");
+    ok (!strcmp (match (st, "foo.bar"), "cabc"),
+        "subtrie_match foo.bar matches fo:c foo:a,b foo.bar:c");
+    ok (!strcmp (match (st, "foobar"), "cab"),
+        "subtrie_match foobar matches fo:c foo:a,b");
+    ok (strlen (match (st, "f")) == 0,
+        "subtrie_match f matches nothing");
+    ok (strlen (match (st, "bar")) == 0,
+        "subtrie_match bar matches nothing");
+    ok (subtrie_match_any (st, "fox") == true,
+        "subtrie_match_any fox returns true");
+    ok (subtrie_match_any (st, "f") == false,
+        "subtrie_match_any f returns false");
+
+    ok (subtrie_insert (st, "", &b) == 0,
+        "subtrie_insert \"\" b works");
+    ok (!strcmp (match (st, "bar"), "b"),
+        "subtrie_match bar matches \"\":b");
+    ok (subtrie_remove (st, "", &b) == 0,
+        "subtrie_remove \"\" b works");
+
+    ok (subtrie_remove (st, "fo", &c) == 0,
+        "subtrie_remove fo c works");
+    ok (!strcmp (match (st, "foo.bar"), "abc"),
+        "subtrie_match foo.bar matches foo:a,b foo.bar:c");
+    errno = 0;
+    ok (subtrie_remove (st, "fo", &c) < 0 && errno == ENOENT,
+        "subtrie_remove fo c again fails with ENOENT");
+    errno = 0;
+    ok (subtrie_remove (st, "foo.baz", &c) < 0 && errno == ENOENT,
+        "subtrie_remove foo.baz c fails with ENOENT");
+    ok (subtrie_remove (st, "foo", &a) == 0
+        && subtrie_remove (st, "foo", &b) == 0
+        && subtrie_remove (st, "foo.bar", &c) == 0,
+        "subtrie_remove remaining subscriptions works");
+    ok (subtrie_match_any (st, "foo.bar") == false,
+        "subtrie_match_any foo.bar returns false");
+
+    /* leave some entries for destroy to clean up */
+    ok (subtrie_insert (st, "abc", &a) == 0
+        && subtrie_insert (st, "abd", &b) == 0
+        && subtrie_insert (st, "ab", &c) == 0,
+        "subtrie_insert abc, abd, ab works");
+    ok (!strcmp (match (st, "abd"), "cb"),
+        "subtrie_match abd matches ab:c abd:b");
+
+    subtrie_destroy (st);
+}
+
+void test_invalid (void)
+{
+    struct subtrie *st;
+    char a = 'a';
+
+    if (!(st = subtrie_create ()))
+        BAIL_OUT ("subtrie_create failed");
+    errno = 0;
+    ok (subtrie_insert (NULL, "foo", &a) < 0 && errno == EINVAL,
+        "subtrie_insert st=NULL fails with EINVAL");
+    errno = 0;
+    ok (subtrie_insert (st, NULL, &a) < 0 && errno == EINVAL,
+        "subtrie_insert topic=NULL fails with EINVAL");
+    errno = 0;
+    ok (subtrie_insert (st, "foo", NULL) < 0 && errno == EINVAL,
+        "subtrie_insert subscriber=NULL fails with EINVAL");
+    errno = 0;
+    ok (subtrie_remove (NULL, "foo", &a) < 0 && errno == EINVAL,
+        "subtrie_remove st=NULL fails with EINVAL");
+    ok (subtrie_match_any (NULL, "foo") == false,
+        "subtrie_match_any st=NULL returns false");
+    lives_ok ({subtrie_match (NULL, "foo", match_cb, NULL);},
+        "subtrie_match st=NULL doesn't crash");
+    lives_ok ({subtrie_destroy (NULL);},
+        "subtrie_destroy st=NULL doesn't crash");
+    subtrie_destroy (st);
+}
+
+int main (int argc, char *argv[])
+{
+    plan (NO_PLAN);
+
+    test_match ();
+    test_invalid ();
+
+    done_testing ();
+    return 0;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -159,6 +159,88 @@ void conn_invalid (void)
     flux_reactor_destroy (r);
 }
 
+static void sendq_error_cb (struct usock_conn *conn, int errnum, void *arg)
+{
+    int *errp = arg;
+    *errp = errnum;
+    flux_reactor_stop (usock_conn_aux_get (conn, "reactor"));
+}
+
+void conn_sendq (void)
+{
+    flux_reactor_t *r;
+    int fd[2];
+    struct usock_conn *conn;
+    flux_msg_t *msg;
+    const struct usock_conn_stats *stats;
+    struct flux_msg_cred cred = { .userid = 42, .rolemask = FLUX_ROLE_USER };
+    ssize_t size;
+    int errnum = 0;
+
+    if (!(r = flux_reactor_create (0)))
+        BAIL_OUT ("flux_reactor_create failed");
+    if (socketpair (PF_LOCAL, SOCK_STREAM, 0, fd) < 0)
+        BAIL_OUT ("socketpair failed");
+    if (!(conn = usock_conn_create (r, fd[0], fd[0])))
+        BAIL_OUT ("usock_conn_create failed");
+    if (usock_conn_aux_set (conn, "reactor", r, NULL) < 0)
+        BAIL_OUT ("usock_conn_aux_set failed");
+    usock_conn_accept (conn, &cred);
+    if (!(msg = flux_request_encode ("foo.bar", NULL)))
+        BAIL_OUT ("flux_request_encode failed");
+    if ((size = flux_msg_encode_size (msg)) < 0)
+        BAIL_OUT ("flux_msg_encode_size failed");
+
+    ok (usock_conn_set_sendq_limit (NULL, 0, USOCK_SENDQ_DROP) < 0
+        && errno == EINVAL,
+        "usock_conn_set_sendq_limit conn=NULL fails with EINVAL");
+    ok (usock_conn_set_sendq_limit (conn, 0, 0) < 0 && errno == EINVAL,
+        "usock_conn_set_sendq_limit policy=0 fails with EINVAL");
+    ok (usock_conn_get_stats (NULL) == NULL,
+        "usock_conn_get_stats conn=NULL returns NULL");
+    ok (usock_conn_set_sendq_limit (conn, size * 3, USOCK_SENDQ_DROP) == 0,
+        "usock_conn_set_sendq_limit limit=3 messages policy=drop works");
+    for (int i = 0; i < 5; i++) {
+        if (usock_conn_send (conn, msg) < 0)
+            BAIL_OUT ("usock_conn_send failed");
+    }
+    stats = usock_conn_get_stats (conn);
+    ok (stats != NULL
+        && stats->queue_msgs == 3
+        && stats->queue_bytes == size * 3
+        && stats->queue_bytes_max == size * 3
+        && stats->drop_msgs == 2,
+        "sending 5 messages queued 3 and dropped 2");
+
+    ok (flux_reactor_run (r, FLUX_REACTOR_NOWAIT) >= 0,
+        "ran the reactor");
+    ok (stats->queue_msgs == 0
+        && stats->queue_bytes == 0
+        && stats->send_msgs == 3
+        && stats->send_bytes == size * 3,
+        "3 messages were sent");
+
+    usock_conn_set_error_cb (conn, sendq_error_cb, &errnum);
+    ok (usock_conn_set_sendq_limit (conn,
+                                    size * 3,
+                                    USOCK_SENDQ_DISCONNECT) == 0,
+        "usock_conn_set_sendq_limit policy=disconnect works");
+    for (int i = 0; i < 4; i++) {
+        if (usock_conn_send (conn, msg) < 0)
+            BAIL_OUT ("usock_conn_send failed");
+    }
+    ok (stats->queue_msgs == 0 && stats->drop_msgs == 6,
+        "exceeding the limit dropped the queue");
+    ok (flux_reactor_run (r, 0) >= 0 && errnum == ENOBUFS,
+        "error callback was called with ENOBUFS");
+
+    flux_msg_destroy (msg);
+    usock_conn_destroy (conn);
+    close (fd[0]);
+    close (fd[1]);
+    flux_reactor_destroy (r);
+}
+
 void client_invalid (void)
 {
     struct usock_retry_params retry = USOCK_RETRY_NONE;
@@ -237,6 +319,7 @@ int main (int argc, char *argv[])
 
     server_invalid ();
     conn_invalid ();
+    conn_sendq ();
     client_invalid ();
 
     client_connect();
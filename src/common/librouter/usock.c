@@ -31,6 +31,17 @@
  * - usock_conn_send() adds a message to a queue, starts fd (write) watcher.
  * - Register a receive callback to receive complete messages from client.
  * - Register an error callback to be notified when I/O errors occur.
+ *
+ * Send queue limit:
+ * - usock_conn_set_sendq_limit() bounds the bytes queued for a client
+ *   that is not reading.  Reading from the client is paused while the
+ *   queue is over half full, and resumed when it drains to a quarter.
+ * - A message that would exceed the limit is dropped (USOCK_SENDQ_DROP),
+ *   or the queue is dropped and the error callback is called with ENOBUFS
+ *   from the write watcher (USOCK_SENDQ_DISCONNECT).  The error is
+ *   deferred so usock_conn_send() may be called from a context where the
+ *   connection cannot be destroyed, e.g. while the router is iterating.
+ * - A message larger than the limit is accepted when the queue is empty.
  */
 
 #if HAVE_CONFIG_H
@@ -67,6 +78,8 @@ struct usock_server {
     char *sockpath;
     flux_watcher_t *w;
     zlist_t *connections;
+    size_t sendq_limit;
+    enum usock_sendq_policy sendq_policy;
     usock_acceptor_f acceptor;
     void *arg;
 };
@@ -82,6 +95,10 @@ struct usock_conn {
     struct usock_io in;
     struct usock_io out;
     zlist_t *outqueue;
+    struct iobufv outv;
+    size_t sendq_limit;
+    enum usock_sendq_policy sendq_policy;
+    struct usock_conn_stats stats;
 
     usock_conn_close_f close_cb;
     void *close_arg;
@@ -100,12 +117,15 @@ struct usock_conn {
     int refcount;
 
     unsigned char enable_close_on_destroy:1;
+    unsigned char accepted:1;
+    unsigned char throttled:1;
+    unsigned char overflow:1;
 };
 
 struct usock_client {
     int fd;
     struct iobuf in_iobuf;
-    struct iobuf out_iobuf;
+    struct iobufv out_iobufv;
 };
 
 const struct flux_msg_cred *usock_conn_get_cred (struct usock_conn *conn)
@@ -118,6 +138,11 @@ const char *usock_conn_get_uuid (struct usock_conn *conn)
     return conn ? conn->uuid_str : NULL;
 }
 
+const struct usock_conn_stats *usock_conn_get_stats (struct usock_conn *conn)
+{
+    return conn ? &conn->stats : NULL;
+}
+
 void usock_conn_set_error_cb (struct usock_conn *conn,
                               usock_conn_error_f cb,
                               void *arg)
@@ -180,17 +205,116 @@ static void conn_io_error (struct usock_conn *conn, int errnum)
     }
 }
 
+static size_t msg_size (const flux_msg_t *msg)
+{
+    ssize_t size = flux_msg_encode_size (msg);
+    return size > 0 ? size : 0;
+}
+
+/* Pause reading from the client while its send queue is over half full,
+ * so a client that does not read cannot keep generating responses.
+ */
+static void conn_update_throttle (struct usock_conn *conn)
+{
+    size_t limit = conn->sendq_limit;
+
+    if (!conn->accepted || conn->overflow)
+        return;
+    if (!conn->throttled) {
+        if (limit > 0 && conn->stats.queue_bytes > limit / 2) {
+            flux_watcher_stop (conn->in.w);
+            conn->throttled = 1;
+        }
+    }
+    else if (limit == 0 || conn->stats.queue_bytes <= limit / 4) {
+        flux_watcher_start (conn->in.w);
+        conn->throttled = 0;
+    }
+}
+
+static const flux_msg_t *conn_outqueue_pop (struct usock_conn *conn,
+                                            size_t *sizep)
+{
+    const flux_msg_t *msg;
+    size_t size;
+
+    if (!(msg = zlist_pop (conn->outqueue)))
+        return NULL;
+    size = msg_size (msg);
+    conn->stats.queue_msgs--;
+    conn->stats.queue_bytes -= size;
+    if (sizep)
+        *sizep = size;
+    return msg;
+}
+
+static int conn_outqueue_drop (struct usock_conn *conn)
+{
+    const flux_msg_t *msg = conn_outqueue_pop (conn, NULL);
+    if (msg == NULL)
+        return 0;
+    conn->stats.drop_msgs++;
+    flux_msg_decref (msg);
+    return 1;
+}
+
+/* Drop the send queue and let the write watcher report ENOBUFS.
+ */
+static void conn_overflow (struct usock_conn *conn)
+{
+    while (conn_outqueue_drop (conn))
+        ;
+    flux_watcher_stop (conn->in.w);
+    conn->overflow = 1;
+    flux_watcher_start (conn->out.w);
+}
+
+int usock_conn_set_sendq_limit (struct usock_conn *conn,
+                                size_t limit,
+                                enum usock_sendq_policy policy)
+{
+    if (!conn
+        || (policy != USOCK_SENDQ_DROP && policy != USOCK_SENDQ_DISCONNECT)) {
+        errno = EINVAL;
+        return -1;
+    }
+    conn->sendq_limit = limit;
+    conn->sendq_policy = policy;
+    conn_update_throttle (conn);
+    return 0;
+}
+
 int usock_conn_send (struct usock_conn *conn, const flux_msg_t *msg)
 {
+    size_t size;
+
     if (!conn || !msg) {
         errno = EINVAL;
         return -1;
     }
+    if (conn->overflow) { // waiting for write watcher to fail conn
+        conn->stats.drop_msgs++;
+        return 0;
+    }
+    size = msg_size (msg);
+    if (conn->sendq_limit > 0
+        && conn->stats.queue_msgs > 0
+        && conn->stats.queue_bytes + size > conn->sendq_limit) {
+        conn->stats.drop_msgs++;
+        if (conn->sendq_policy == USOCK_SENDQ_DISCONNECT)
+            conn_overflow (conn);
+        return 0;
+    }
     if (zlist_append (conn->outqueue, (void *)flux_msg_incref (msg)) < 0) {
         flux_msg_decref (msg);
         errno = ENOMEM;
         return -1;
     }
+    conn->stats.queue_msgs++;
+    conn->stats.queue_bytes += size;
+    if (conn->stats.queue_bytes_max < conn->stats.queue_bytes)
+        conn->stats.queue_bytes_max = conn->stats.queue_bytes;
+    conn_update_throttle (conn);
     flux_watcher_start (conn->out.w);
     return 0;
 }
@@ -218,6 +342,8 @@ static void conn_read_cb (flux_reactor_t *r,
              */
             if (auth_init_message (msg, &conn->cred) < 0)
                 goto error;
+            conn->stats.recv_msgs++;
+            conn->stats.recv_bytes += msg_size (msg);
 
             if (conn->recv_cb)
                 conn->recv_cb (conn, msg, conn->recv_arg);
@@ -229,15 +355,6 @@ error:
     conn_io_error (conn, errno);
 }
 
-static int conn_outqueue_drop (struct usock_conn *conn)
-{
-    flux_msg_t *msg = zlist_pop (conn->outqueue);
-    if (msg == NULL)
-        return 0;
-    flux_msg_decref (msg);
-    return 1;
-}
-
 static void conn_write_cb (flux_reactor_t *r,
                            flux_watcher_t *w,
                            int revents,
@@ -249,31 +366,54 @@ static void conn_write_cb (flux_reactor_t *r,
         errno = EIO;
         goto error;
     }
+    if (conn->overflow) {
+        errno = ENOBUFS;
+        goto error;
+    }
 
     if ((revents & FLUX_POLLOUT)) {
-        const flux_msg_t *msg = zlist_head (conn->outqueue);
-        if (msg) {
-            if (sendfd (conn->out.fd, msg, &conn->out.iobuf) < 0) {
-                if (errno == EPIPE) {
-                    /* Remote peer has closed connection.
-                     * However, there may still be pending messages sent
-                     * by peer, so do not destroy connection here. Instead,
-                     * drop all pending messages in the output queue, and
-                     * let connection be closed after EOF/ECONNRESET from
-                     * *read* side of connection.
-                     */
-                    while (conn_outqueue_drop (conn))
-                        ;
-                    flux_watcher_stop (conn->out.w);
-                }
-                else if (errno != EWOULDBLOCK && errno != EAGAIN)
-                    goto error;
+        const flux_msg_t *msgs[IOBUFV_MSG_MAX];
+        const flux_msg_t *msg;
+        int count = 0;
+        int n;
+
+        msg = zlist_first (conn->outqueue);
+        while (msg && count < IOBUFV_MSG_MAX) {
+            msgs[count++] = msg;
+            msg = zlist_next (conn->outqueue);
+        }
+        if ((n = sendfd_v (conn->out.fd, msgs, count, &conn->outv)) < 0) {
+            if (errno == EPIPE) {
+                /* Remote peer has closed connection.
+                 * However, there may still be pending messages sent
+                 * by peer, so do not destroy connection here. Instead,
+                 * drop all pending messages in the output queue, and
+                 * let connection be closed after EOF/ECONNRESET from
+                 * *read* side of connection.
+                 */
+                while (conn_outqueue_drop (conn))
+                    ;
+                flux_watcher_stop (conn->out.w);
+                conn_update_throttle (conn);
             }
-            else {
-                (void) conn_outqueue_drop (conn);
-                if (zlist_size (conn->outqueue) == 0)
-                    flux_watcher_stop (conn->out.w);
+            else if (errno != EWOULDBLOCK && errno != EAGAIN)
+                goto error;
+        }
+        else {
+            /* Accepted messages are held by conn->outv until written.
+             */
+            while (n-- > 0) {
+                size_t size;
+                if ((msg = conn_outqueue_pop (conn, &size))) {
+                    conn->stats.send_msgs++;
+                    conn->stats.send_bytes += size;
+                    flux_msg_decref (msg);
+                }
             }
+            conn_update_throttle (conn);
+            if (zlist_size (conn->outqueue) == 0
+                && !iobufv_pending (&conn->outv))
+                flux_watcher_stop (conn->out.w);
         }
     }
     return;
@@ -304,7 +444,9 @@ void usock_conn_accept (struct usock_conn *conn,
                 goto error;
         }
 
+        conn->accepted = 1;
         flux_watcher_start (conn->in.w);
+        conn_update_throttle (conn);
     }
     return;
 error:
@@ -338,7 +480,7 @@ void usock_conn_destroy (struct usock_conn *conn)
             zlist_destroy (&conn->outqueue);
         }
         flux_watcher_destroy (conn->out.w);
-        iobuf_clean (&conn->out.iobuf);
+        iobufv_clean (&conn->outv);
         if (conn->server)
             zlist_remove (conn->server->connections, conn);
         if (conn->enable_close_on_destroy) {
@@ -362,6 +504,37 @@ void usock_server_set_acceptor (struct usock_server *server,
     }
 }
 
+int usock_server_set_sendq_limit (struct usock_server *server,
+                                  size_t limit,
+                                  enum usock_sendq_policy policy)
+{
+    struct usock_conn *conn;
+
+    if (!server
+        || (policy != USOCK_SENDQ_DROP && policy != USOCK_SENDQ_DISCONNECT)) {
+        errno = EINVAL;
+        return -1;
+    }
+    server->sendq_limit = limit;
+    server->sendq_policy = policy;
+    conn = zlist_first (server->connections);
+    while (conn) {
+        (void)usock_conn_set_sendq_limit (conn, limit, policy);
+        conn = zlist_next (server->connections);
+    }
+    return 0;
+}
+
+struct usock_conn *usock_server_first_conn (struct usock_server *server)
+{
+    return server ? zlist_first (server->connections) : NULL;
+}
+
+struct usock_conn *usock_server_next_conn (struct usock_server *server)
+{
+    return server ? zlist_next (server->connections) : NULL;
+}
+
 void usock_server_destroy (struct usock_server *server)
 {
     if (server) {
@@ -425,6 +598,7 @@ struct usock_conn *usock_conn_create (flux_reactor_t *r, int infd, int outfd)
     conn->out.fd = outfd;
     conn->cred.userid = FLUX_USERID_UNKNOWN;
     conn->cred.rolemask = FLUX_ROLE_NONE;
+    conn->sendq_policy = USOCK_SENDQ_DISCONNECT;
 
     if (!(conn->in.w = flux_fd_watcher_create (r,
                                                conn->in.fd,
@@ -440,7 +614,7 @@ struct usock_conn *usock_conn_create (flux_reactor_t *r, int infd, int outfd)
                                                 conn_write_cb,
                                                 conn)))
         goto error;
-    iobuf_init (&conn->out.iobuf);
+    iobufv_init (&conn->outv);
     uuid_generate (conn->uuid);
     uuid_unparse (conn->uuid, conn->uuid_str);
 
@@ -468,6 +642,8 @@ static struct usock_conn *server_accept (struct usock_server *server,
         return NULL;
     }
     conn->enable_close_on_destroy = 1;
+    conn->sendq_limit = server->sendq_limit;
+    conn->sendq_policy = server->sendq_policy;
     return conn;
 }
 
@@ -537,6 +713,7 @@ struct usock_server *usock_server_create (flux_reactor_t *r,
     }
     if (!(server = calloc (1, sizeof (*server))))
         return NULL;
+    server->sendq_policy = USOCK_SENDQ_DISCONNECT;
     if ((server->fd = socket (AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)) < 0)
         goto error;
     if (!(server->sockpath = strdup (sockpath)))
@@ -577,6 +754,54 @@ static bool is_poll_error (int revents)
     return false;
 }
 
+/* Get a file descriptor that can be polled for events.
+ * Upon wakeup, call usock_client_pollevents() to see what events occurred.
+ * N.B. see op->pollfd in libflux/connector.h
+ */
+int usock_client_pollfd (struct usock_client *client)
+{
+    return client->fd;
+}
+
+/* Poll wrapper that blocks until the specified event occurs.
+ * If an error occurs, return -1 with errno set.
+ */
+static int usock_client_poll (int fd, int events)
+{
+    struct pollfd pfd;
+
+    memset (&pfd, 0, sizeof (pfd));
+    pfd.fd = fd;
+    pfd.events = events;
+
+    if (poll (&pfd, 1, -1) < 0)
+        return -1;
+    if (is_poll_error (pfd.revents)) {
+        errno = EIO;
+        return -1;
+    }
+    return 0;
+}
+
+/* Finish writing messages already accepted by sendfd_v().
+ * If flags does not include FLUX_O_NONBLOCK, and sendfd_v fails with
+ * EWOULDBLOCK/EAGAIN, then poll(POLLOUT) and keep trying until done.
+ */
+static int usock_client_flush (struct usock_client *client, int flags)
+{
+    while (iobufv_pending (&client->out_iobufv)) {
+        if (sendfd_v (client->fd, NULL, 0, &client->out_iobufv) < 0) {
+            if (errno != EWOULDBLOCK && errno != EAGAIN)
+                return -1;
+            if ((flags & FLUX_O_NONBLOCK))
+                return -1;
+            if (usock_client_poll (client->fd, POLLOUT) < 0)
+                return -1;
+        }
+    }
+    return 0;
+}
+
 /* Check which events are pending events on client fd (non-blocking).
  * If none are pending, return 0.  If an error occurred, return FLUX_POLLERR.
  * N.B. see op->pollevents in libflux/connector.h
@@ -586,6 +811,10 @@ int usock_client_pollevents (struct usock_client *client)
     struct pollfd pfd;
     int flux_revents = 0;
 
+    if (usock_client_flush (client, FLUX_O_NONBLOCK) < 0
+        && errno != EWOULDBLOCK && errno != EAGAIN)
+        return FLUX_POLLERR;
+
     pfd.fd = client->fd;
     pfd.events = POLLIN | POLLOUT;
     pfd.revents = 0;
@@ -602,51 +831,50 @@ int usock_client_pollevents (struct usock_client *client)
     return flux_revents;
 }
 
-/* Get a file descriptor that can be polled for events.
- * Upon wakeup, call usock_client_pollevents() to see what events occurred.
- * N.B. see op->pollfd in libflux/connector.h
- */
-int usock_client_pollfd (struct usock_client *client)
-{
-    return client->fd;
-}
-
-/* Poll wrapper that blocks until the specified event occurs.
- * If an error occurs, return -1 with errno set.
+/* Try to send messages.  If flags does not include FLUX_O_NONBLOCK,
+ * and sendfd_v fails with EWOULDBLOCK/EAGAIN, then poll(POLLOUT) and
+ * keep trying until all messages are sent.  In non-blocking mode,
+ * a message may be accepted but only partially written.  The remainder
+ * is written by the next send, recv, or pollevents call.
  */
-static int usock_client_poll (int fd, int events)
+int usock_client_send_batch (struct usock_client *client,
+                             const flux_msg_t **msgs,
+                             int count,
+                             int flags)
 {
-    struct pollfd pfd;
-
-    memset (&pfd, 0, sizeof (pfd));
-    pfd.fd = fd;
-    pfd.events = events;
+    int sent = 0;
+    int n;
 
-    if (poll (&pfd, 1, -1) < 0)
-        return -1;
-    if (is_poll_error (pfd.revents)) {
-        errno = EIO;
-        return -1;
+    while (sent < count) {
+        if ((n = sendfd_v (client->fd,
+                           msgs + sent,
+                           count - sent,
+                           &client->out_iobufv)) < 0) {
+            if (errno != EWOULDBLOCK && errno != EAGAIN)
+                goto error;
+            if ((flags & FLUX_O_NONBLOCK))
+                goto error;
+            if (usock_client_poll (client->fd, POLLOUT) < 0)
+                goto error;
+            continue;
+        }
+        sent += n;
     }
-    return 0;
+    if (!(flags & FLUX_O_NONBLOCK)) {
+        if (usock_client_flush (client, flags) < 0)
+            return -1;
+    }
+    return sent;
+error:
+    return sent > 0 ? sent : -1;
 }
 
-/* Try to send message.  If flags does not include FLUX_O_NONBLOCK,
- * and sendfd fails with EWOULDBLOCK/EAGAIN, then poll(POLLOUT) and
- * keep trying until the full message is sent.
- */
 int usock_client_send (struct usock_client *client,
                        const flux_msg_t *msg,
                        int flags)
 {
-    while (sendfd (client->fd, msg, &client->out_iobuf) < 0) {
-        if (errno != EWOULDBLOCK && errno != EAGAIN)
-            return -1;
-        if ((flags & FLUX_O_NONBLOCK))
-            return -1;
-        if (usock_client_poll (client->fd, POLLOUT) < 0)
-            return -1;
-    }
+    if (usock_client_send_batch (client, &msg, 1, flags) < 0)
+        return -1;
     return 0;
 }
 
@@ -658,6 +886,9 @@ flux_msg_t *usock_client_recv (struct usock_client *client, int flags)
 {
     flux_msg_t *msg;
 
+    if (usock_client_flush (client, flags) < 0
+        && errno != EWOULDBLOCK && errno != EAGAIN)
+        return NULL;
     while (!(msg = recvfd (client->fd, &client->in_iobuf))) {
         if (errno != EWOULDBLOCK && errno != EAGAIN)
             return NULL;
@@ -749,7 +980,7 @@ struct usock_client *usock_client_create (int fd)
 
     client->fd = fd;
     iobuf_init (&client->in_iobuf);
-    iobuf_init (&client->out_iobuf);
+    iobufv_init (&client->out_iobufv);
 
     if (usock_client_read_zero (client->fd) < 0)
         goto error;
@@ -765,7 +996,7 @@ void usock_client_destroy (struct usock_client *client)
 {
     if (client) {
         iobuf_clean (&client->in_iobuf);
-        iobuf_clean (&client->out_iobuf);
+        iobufv_clean (&client->out_iobufv);
         ERRNO_SAFE_WRAP (free, client);
     }
 }
@@ -12,6 +12,7 @@
 #define _ROUTER_USOCK_H
 
 #include <sys/types.h>
+#include <stdint.h>
 #include <flux/core.h>
 
 #include "auth.h"
@@ -36,6 +37,26 @@ struct usock_retry_params {
     .max_delay = 0, \
 }
 
+/* Action taken when a message would push a connection's send queue
+ * over its limit.  In either case the connection stops reading new
+ * messages from the client while the queue is over half full.
+ */
+enum usock_sendq_policy {
+    USOCK_SENDQ_DROP = 1,       // drop the message
+    USOCK_SENDQ_DISCONNECT = 2, // drop the queue and fail conn with ENOBUFS
+};
+
+struct usock_conn_stats {
+    uint64_t recv_msgs;
+    uint64_t recv_bytes;
+    uint64_t send_msgs;
+    uint64_t send_bytes;
+    uint64_t drop_msgs;
+    size_t queue_msgs;
+    size_t queue_bytes;
+    size_t queue_bytes_max;     // high water mark
+};
+
 typedef void (*usock_acceptor_f)(struct usock_conn *conn, void *arg);
 
 typedef void (*usock_conn_close_f)(struct usock_conn *conn,
@@ -59,6 +80,18 @@ void usock_server_set_acceptor (struct usock_server *server,
                                 usock_acceptor_f cb,
                                 void *arg);
 
+/* Set the send queue limit in bytes (0 = unlimited) and overflow policy
+ * of current and future connections.
+ */
+int usock_server_set_sendq_limit (struct usock_server *server,
+                                  size_t limit,
+                                  enum usock_sendq_policy policy);
+
+/* Iterate over current connections.
+ */
+struct usock_conn *usock_server_first_conn (struct usock_server *server);
+struct usock_conn *usock_server_next_conn (struct usock_server *server);
+
 /* Server connection for one client
  */
 
@@ -68,6 +101,12 @@ const struct flux_msg_cred *usock_conn_get_cred (struct usock_conn *conn);
 
 const char *usock_conn_get_uuid (struct usock_conn *conn);
 
+const struct usock_conn_stats *usock_conn_get_stats (struct usock_conn *conn);
+
+int usock_conn_set_sendq_limit (struct usock_conn *conn,
+                                size_t limit,
+                                enum usock_sendq_policy policy);
+
 void usock_conn_set_close_cb (struct usock_conn *conn,
                               usock_conn_close_f cb,
                               void *arg);
@@ -104,6 +143,14 @@ int usock_client_pollfd (struct usock_client *client);
 int usock_client_send (struct usock_client *client,
                        const flux_msg_t *msg,
                        int flags);
+
+/* Send up to 'count' messages, coalescing writes.
+ * Returns the number of messages sent, or -1 if none were sent.
+ */
+int usock_client_send_batch (struct usock_client *client,
+                             const flux_msg_t **msgs,
+                             int count,
+                             int flags);
 flux_msg_t *usock_client_recv (struct usock_client *client, int flags);
 
 int usock_client_connect (const char *sockpath,
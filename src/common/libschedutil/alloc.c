@@ -14,12 +14,59 @@
 #include <flux/core.h>
 #include <jansson.h>
 
+#include "src/common/libczmqcontainers/czmq_containers.h"
 #include "src/common/libutil/errno_safe.h"
 #include "schedutil_private.h"
 #include "init.h"
 #include "alloc.h"
 
-static int schedutil_alloc_respond_pack (flux_t *h,
+/* Keep the number of responses in one batched message, and the number
+ * of R objects in one KVS commit, bounded.
+ */
+static const size_t alloc_batch_max = 1024;
+
+int schedutil_alloc_flush (schedutil_t *util)
+{
+    flux_msg_t *msg;
+
+    if (json_array_size (util->alloc_responses) == 0)
+        return 0;
+    if (!(msg = flux_response_derive (util->alloc_batch_msg, 0))
+        || flux_msg_set_topic (msg, "sched.alloc-batch") < 0
+        || flux_msg_pack (msg,
+                          "{s:O}",
+                          "responses", util->alloc_responses) < 0
+        || flux_send (util->h, msg, 0) < 0)
+        goto error;
+    flux_msg_destroy (msg);
+    json_array_clear (util->alloc_responses);
+    return 0;
+error:
+    flux_msg_destroy (msg);
+    json_array_clear (util->alloc_responses);
+    return -1;
+}
+
+/* In batched mode, queue the response to be sent by schedutil_alloc_flush().
+ * All requests come from the job-manager, so any of them may serve as the
+ * template for the batched response.
+ */
+static int alloc_response_append (schedutil_t *util,
+                                  const flux_msg_t *msg,
+                                  json_t *payload)
+{
+    if (!util->alloc_batch_msg)
+        util->alloc_batch_msg = flux_msg_incref (msg);
+    if (json_array_append (util->alloc_responses, payload) < 0) {
+        errno = ENOMEM;
+        return -1;
+    }
+    if (json_array_size (util->alloc_responses) >= alloc_batch_max)
+        return schedutil_alloc_flush (util);
+    return 0;
+}
+
+static int schedutil_alloc_respond_pack (schedutil_t *util,
                                          const flux_msg_t *msg,
                                          int type,
                                          const char *fmt,
@@ -45,7 +92,11 @@ static int schedutil_alloc_respond_pack (flux_t *h,
         }
         json_decref (o);
     }
-    if (flux_respond_pack (h, msg, "O", payload) < 0)
+    if (util->batch) {
+        if (alloc_response_append (util, msg, payload) < 0)
+            goto error;
+    }
+    else if (flux_respond_pack (util->h, msg, "O", payload) < 0)
         goto error;
     json_decref (payload);
     return 0;
@@ -72,7 +123,7 @@ int schedutil_alloc_respond_annotate_pack (schedutil_t *util,
         errno = EINVAL;
         return -1;
     }
-    rc = schedutil_alloc_respond_pack (util->h,
+    rc = schedutil_alloc_respond_pack (util,
                                        msg,
                                        FLUX_SCHED_ALLOC_ANNOTATE,
                                        "{s:O}",
@@ -86,13 +137,13 @@ int schedutil_alloc_respond_deny (schedutil_t *util,
                                   const char *note)
 {
     if (note) {
-        return schedutil_alloc_respond_pack (util->h,
+        return schedutil_alloc_respond_pack (util,
                                              msg,
                                              FLUX_SCHED_ALLOC_DENY,
                                              "{s:s}",
                                              "note", note);
     }
-    return schedutil_alloc_respond_pack (util->h,
+    return schedutil_alloc_respond_pack (util,
                                          msg,
                                          FLUX_SCHED_ALLOC_DENY,
                                          NULL);
@@ -100,7 +151,7 @@ int schedutil_alloc_respond_deny (schedutil_t *util,
 
 int schedutil_alloc_respond_cancel (schedutil_t *util, const flux_msg_t *msg)
 {
-    return schedutil_alloc_respond_pack (util->h,
+    return schedutil_alloc_respond_pack (util,
                                          msg,
                                          FLUX_SCHED_ALLOC_CANCEL,
                                          NULL);
@@ -109,15 +160,21 @@ int schedutil_alloc_respond_cancel (schedutil_t *util, const flux_msg_t *msg)
 struct alloc {
     json_t *annotations;
     const flux_msg_t *msg;
-    flux_kvs_txn_t *txn;
     json_t *R;
 };
 
+/* Successful allocations whose R is committed to the KVS in one
+ * transaction.
+ */
+struct alloc_batch {
+    flux_kvs_txn_t *txn;
+    zlistx_t *allocs;
+};
+
 static void alloc_destroy (struct alloc *ctx)
 {
     if (ctx) {
         int saved_errno = errno;
-        flux_kvs_txn_destroy (ctx->txn);
         flux_msg_decref (ctx->msg);
         json_decref (ctx->annotations);
         json_decref (ctx->R);
@@ -126,21 +183,21 @@ static void alloc_destroy (struct alloc *ctx)
     }
 }
 
+static void alloc_destructor (void **item)
+{
+    if (item) {
+        alloc_destroy (*item);
+        *item = NULL;
+    }
+}
+
 static struct alloc *alloc_create (const flux_msg_t *msg,
                                    const char *R,
                                    const char *fmt,
                                    va_list ap)
 {
     struct alloc *ctx;
-    flux_jobid_t id;
-    char key[64];
 
-    if (flux_request_unpack (msg, NULL, "{s:I}", "id", &id) < 0)
-        return NULL;
-    if (flux_job_kvs_key (key, sizeof (key), id, "R") < 0) {
-        errno = EINVAL;
-        return NULL;
-    }
     if (!(ctx = calloc (1, sizeof (*ctx))))
         return NULL;
     ctx->msg = flux_msg_incref (msg);
@@ -152,55 +209,140 @@ static struct alloc *alloc_create (const flux_msg_t *msg,
         errno = ENOMEM;
         goto error;
     }
-    if (!(ctx->txn = flux_kvs_txn_create ()))
-        goto error;
-    if (flux_kvs_txn_put (ctx->txn, 0, key, R) < 0)
-        goto error;
     return ctx;
 error:
     alloc_destroy (ctx);
     return NULL;
 }
 
-static void alloc_continuation (flux_future_t *f, void *arg)
+void schedutil_alloc_batch_destroy (struct alloc_batch *batch)
 {
-    schedutil_t *util = arg;
-    flux_t *h = util->h;
-    struct alloc *ctx = flux_future_aux_get (f, "flux::alloc_ctx");
-    json_t *payload = NULL;
+    if (batch) {
+        int saved_errno = errno;
+        flux_kvs_txn_destroy (batch->txn);
+        zlistx_destroy (&batch->allocs);
+        free (batch);
+        errno = saved_errno;
+    }
+}
 
-    if (flux_future_get (f, NULL) < 0) {
-        flux_log_error (h, "commit R");
-        goto error;
+static struct alloc_batch *alloc_batch_create (void)
+{
+    struct alloc_batch *batch;
+
+    if (!(batch = calloc (1, sizeof (*batch))))
+        return NULL;
+    if (!(batch->txn = flux_kvs_txn_create ())
+        || !(batch->allocs = zlistx_new ())) {
+        schedutil_alloc_batch_destroy (batch);
+        errno = ENOMEM;
+        return NULL;
     }
-    schedutil_remove_outstanding_future (util, f);
+    zlistx_set_destructor (batch->allocs, alloc_destructor);
+    return batch;
+}
+
+static int alloc_batch_append (struct alloc_batch *batch,
+                               struct alloc *ctx,
+                               const char *R)
+{
+    flux_jobid_t id;
+    char key[64];
+
+    if (flux_request_unpack (ctx->msg, NULL, "{s:I}", "id", &id) < 0)
+        return -1;
+    if (flux_job_kvs_key (key, sizeof (key), id, "R") < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (flux_kvs_txn_put (batch->txn, 0, key, R) < 0)
+        return -1;
+    if (!zlistx_add_end (batch->allocs, ctx)) {
+        errno = ENOMEM;
+        return -1;
+    }
+    return 0;
+}
+
+static int alloc_respond (schedutil_t *util, struct alloc *ctx)
+{
+    json_t *payload;
+
     if (!(payload = json_object ())
         || (ctx->annotations && json_object_set (payload,
                                                  "annotations",
                                                  ctx->annotations) < 0)
         || json_object_set (payload, "R", ctx->R) < 0) {
+        json_decref (payload);
         errno = ENOMEM;
-        flux_log_error (h, "error responding to alloc request");
-        goto error;
+        return -1;
     }
-    if (schedutil_alloc_respond_pack (h,
+    if (schedutil_alloc_respond_pack (util,
                                       ctx->msg,
                                       FLUX_SCHED_ALLOC_SUCCESS,
                                       "O",
                                       payload) < 0) {
-        flux_log_error (h, "error responding to alloc request");
-        goto error;
+        ERRNO_SAFE_WRAP (json_decref, payload);
+        return -1;
     }
     json_decref (payload);
+    return 0;
+}
+
+static void alloc_continuation (flux_future_t *f, void *arg)
+{
+    schedutil_t *util = arg;
+    flux_t *h = util->h;
+    struct alloc_batch *batch = flux_future_aux_get (f, "flux::alloc_batch");
+    struct alloc *ctx;
+
+    if (flux_future_get (f, NULL) < 0) {
+        flux_log_error (h, "commit R");
+        goto error;
+    }
+    schedutil_remove_outstanding_future (util, f);
+    ctx = zlistx_first (batch->allocs);
+    while (ctx) {
+        if (alloc_respond (util, ctx) < 0) {
+            flux_log_error (h, "error responding to alloc request");
+            goto error;
+        }
+        ctx = zlistx_next (batch->allocs);
+    }
     flux_future_destroy (f);
     return;
 error:
     flux_reactor_stop_error (flux_get_reactor (h)); // XXX
-    alloc_destroy (ctx);
-    ERRNO_SAFE_WRAP (json_decref, payload);
     flux_future_destroy (f);
 }
 
+int schedutil_alloc_commit (schedutil_t *util)
+{
+    struct alloc_batch *batch = util->alloc_batch;
+    flux_future_t *f;
+
+    if (!batch)
+        return 0;
+    util->alloc_batch = NULL;
+    if (!(f = flux_kvs_commit (util->h, NULL, 0, batch->txn)))
+        goto error;
+    if (flux_future_aux_set (f,
+                             "flux::alloc_batch",
+                             batch,
+                             (flux_free_f)schedutil_alloc_batch_destroy) < 0)
+        goto error;
+    if (flux_future_then (f, -1, alloc_continuation, util) < 0) {
+        flux_future_destroy (f);
+        return -1;
+    }
+    schedutil_add_outstanding_future (util, f);
+    return 0;
+error:
+    schedutil_alloc_batch_destroy (batch);
+    flux_future_destroy (f);
+    return -1;
+}
+
 int schedutil_alloc_respond_success_pack (schedutil_t *util,
                                           const flux_msg_t *msg,
                                           const char *R,
@@ -208,8 +350,6 @@ int schedutil_alloc_respond_success_pack (schedutil_t *util,
                                           ...)
 {
     struct alloc *ctx;
-    flux_future_t *f;
-    flux_t *h = util->h;
     va_list ap;
 
     va_start (ap, fmt);
@@ -217,21 +357,15 @@ int schedutil_alloc_respond_success_pack (schedutil_t *util,
     va_end (ap);
     if (!ctx)
         return -1;
-    if (!(f = flux_kvs_commit (h, NULL, 0, ctx->txn)))
+    if (!util->alloc_batch && !(util->alloc_batch = alloc_batch_create ()))
         goto error;
-    if (flux_future_aux_set (f,
-                             "flux::alloc_ctx",
-                             ctx,
-                             (flux_free_f)alloc_destroy) < 0) {
+    if (alloc_batch_append (util->alloc_batch, ctx, R) < 0)
         goto error;
-    }
-    if (flux_future_then (f, -1, alloc_continuation, util) < 0)
-        goto error;
-    schedutil_add_outstanding_future (util, f);
+    if (zlistx_size (util->alloc_batch->allocs) >= alloc_batch_max)
+        return schedutil_alloc_commit (util);
     return 0;
 error:
     alloc_destroy (ctx);
-    flux_future_destroy (f);
     return -1;
 }
 
@@ -45,7 +45,8 @@ int schedutil_alloc_respond_deny (schedutil_t *util,
                                   const char *note);
 
 /* Respond to alloc request message - success, allocate R.
- * R is committed to the KVS first, then the response is sent.
+ * R is committed to the KVS first, then the response is sent.  R for all
+ * allocations made in one reactor loop iteration is committed together.
  * If something goes wrong after this function returns, the reactor is stopped.
  */
 int schedutil_alloc_respond_success_pack (schedutil_t *util,
@@ -12,6 +12,7 @@
 #include "config.h"
 #endif
 #include <errno.h>
+#include <jansson.h>
 #include <flux/core.h>
 
 #include "src/common/libczmqcontainers/czmq_containers.h"
@@ -29,6 +30,25 @@ static void future_destructor (void **item)
     }
 }
 
+/* Commit R for new allocations and flush batched alloc responses right
+ * before the reactor blocks, so that all allocations made in one loop
+ * iteration share a KVS commit, and all responses share a message.
+ */
+static void prep_cb (flux_reactor_t *r,
+                     flux_watcher_t *w,
+                     int revents,
+                     void *arg)
+{
+    schedutil_t *util = arg;
+
+    if (schedutil_alloc_commit (util) < 0) {
+        flux_log_error (util->h, "error committing R for allocated jobs");
+        flux_reactor_stop_error (r);
+        return;
+    }
+    if (schedutil_alloc_flush (util) < 0)
+        flux_log_error (util->h, "error sending batched alloc responses");
+}
 
 schedutil_t *schedutil_create (flux_t *h,
                                int flags,
@@ -56,6 +76,15 @@ schedutil_t *schedutil_create (flux_t *h,
     if (!(util->outstanding_futures = zlistx_new ()))
         goto error;
     zlistx_set_destructor (util->outstanding_futures, future_destructor);
+    if (!(util->alloc_responses = json_array ())) {
+        errno = ENOMEM;
+        goto error;
+    }
+    if (!(util->prep = flux_prepare_watcher_create (flux_get_reactor (h),
+                                                    prep_cb,
+                                                    util)))
+        goto error;
+    flux_watcher_start (util->prep);
     if (schedutil_ops_register (util) < 0)
         goto error;
 
@@ -70,6 +99,12 @@ void schedutil_destroy (schedutil_t *util)
 {
     if (util) {
         int saved_errno = errno;
+        if (util->alloc_responses)
+            (void)schedutil_alloc_flush (util);
+        flux_watcher_destroy (util->prep);
+        schedutil_alloc_batch_destroy (util->alloc_batch);
+        json_decref (util->alloc_responses);
+        flux_msg_decref (util->alloc_batch_msg);
         zlistx_destroy (&util->outstanding_futures);
         schedutil_ops_unregister (util);
         free (util);
@@ -23,12 +23,18 @@ typedef struct schedutil_ctx schedutil_t;
 
 enum schedutil_flags {
     SCHEDUTIL_FREE_NOLOOKUP = 1, // now the default so this flag is ignored
+    SCHEDUTIL_BATCH = 2,         // offer batched alloc/free in ready handshake
 };
 
 /* Create a handle for the schedutil convenience library.
  *
  * Used to track outstanding futures and register callbacks relevant for
  * schedulers and simulators.
+ *
+ * If SCHEDUTIL_BATCH is set in 'flags', schedutil_ready() asks the
+ * job-manager to send alloc and free requests in batches.  Callbacks still
+ * see one request message per job, but alloc responses are collected and
+ * sent to the job-manager in a single message once per reactor loop.
  * Return NULL on error.
  */
 schedutil_t *schedutil_create (flux_t *h,
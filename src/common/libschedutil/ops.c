@@ -70,10 +70,78 @@ static void prioritize_cb (flux_t *h,
         util->ops->prioritize (h, msg, util->cb_arg);
 }
 
+/* Unpack a batched request into one request message per job, with the
+ * routes and credentials of the original, and pass each to 'cb'.
+ */
+static void batch_unpack (schedutil_t *util,
+                          const flux_msg_t *msg,
+                          const char *topic,
+                          void (*cb)(schedutil_t *util, const flux_msg_t *msg))
+{
+    json_t *jobs;
+    size_t index;
+    json_t *entry;
+
+    if (flux_request_unpack (msg, NULL, "{s:o}", "jobs", &jobs) < 0
+        || !json_is_array (jobs)) {
+        flux_log (util->h, LOG_ERR, "%s-batch: malformed request", topic);
+        return;
+    }
+    json_array_foreach (jobs, index, entry) {
+        flux_msg_t *job_msg;
+
+        if (!(job_msg = flux_msg_copy (msg, false))
+            || flux_msg_set_topic (job_msg, topic) < 0
+            || flux_msg_pack (job_msg, "O", entry) < 0) {
+            flux_log_error (util->h, "%s-batch: unpacking request", topic);
+            flux_msg_destroy (job_msg);
+            continue;
+        }
+        cb (util, job_msg);
+        flux_msg_decref (job_msg);
+    }
+}
+
+static void alloc_one (schedutil_t *util, const flux_msg_t *msg)
+{
+    util->ops->alloc (util->h, msg, util->cb_arg);
+}
+
+static void free_one (schedutil_t *util, const flux_msg_t *msg)
+{
+    util->ops->free (util->h, msg, NULL, util->cb_arg);
+}
+
+static void alloc_batch_cb (flux_t *h,
+                            flux_msg_handler_t *mh,
+                            const flux_msg_t *msg,
+                            void *arg)
+{
+    schedutil_t *util = arg;
+
+    assert (util);
+
+    batch_unpack (util, msg, "sched.alloc", alloc_one);
+}
+
+static void free_batch_cb (flux_t *h,
+                           flux_msg_handler_t *mh,
+                           const flux_msg_t *msg,
+                           void *arg)
+{
+    schedutil_t *util = arg;
+
+    assert (util);
+
+    batch_unpack (util, msg, "sched.free", free_one);
+}
+
 static const struct flux_msg_handler_spec htab[] = {
     { FLUX_MSGTYPE_REQUEST,  "sched.alloc", alloc_cb, 0},
+    { FLUX_MSGTYPE_REQUEST,  "sched.alloc-batch", alloc_batch_cb, 0},
     { FLUX_MSGTYPE_REQUEST,  "sched.cancel", cancel_cb, 0},
     { FLUX_MSGTYPE_REQUEST,  "sched.free", free_cb, 0},
+    { FLUX_MSGTYPE_REQUEST,  "sched.free-batch", free_batch_cb, 0},
     { FLUX_MSGTYPE_REQUEST,  "sched.prioritize", prioritize_cb, 0},
     FLUX_MSGHANDLER_TABLE_END,
 };
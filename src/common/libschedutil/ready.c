@@ -25,6 +25,7 @@ int schedutil_ready (schedutil_t *util, const char *mode, int *queue_depth)
     flux_future_t *f;
     int limit = 0;
     int count;
+    int batch = 0;
 
     if (!util || !mode) {
         errno = EINVAL;
@@ -44,27 +45,21 @@ int schedutil_ready (schedutil_t *util, const char *mode, int *queue_depth)
         errno = EINVAL;
         return -1;
     }
-    if (limit) {
-        if (!(f = flux_rpc_pack (util->h,
-                                 "job-manager.sched-ready",
-                                 FLUX_NODEID_ANY,
-                                 0,
-                                 "{s:s s:i}",
-                                 "mode", mode,
-                                 "limit", limit)))
-            return -1;
-    }
-    else {
-        if (!(f = flux_rpc_pack (util->h,
-                                 "job-manager.sched-ready",
-                                 FLUX_NODEID_ANY,
-                                 0,
-                                 "{s:s}",
-                                 "mode", mode)))
-            return -1;
-    }
-    if (flux_rpc_get_unpack (f, "{s:i}", "count", &count) < 0)
+    if (!(f = flux_rpc_pack (util->h,
+                             "job-manager.sched-ready",
+                             FLUX_NODEID_ANY,
+                             0,
+                             "{s:s s:i s:b}",
+                             "mode", mode,
+                             "limit", limit,
+                             "batch", (util->flags & SCHEDUTIL_BATCH) ? 1 : 0)))
+        return -1;
+    if (flux_rpc_get_unpack (f,
+                             "{s:i s?b}",
+                             "count", &count,
+                             "batch", &batch) < 0)
         goto error;
+    util->batch = batch ? true : false;
     if (queue_depth)
         *queue_depth = count;
     flux_future_destroy (f);
@@ -26,8 +26,9 @@ extern "C" {
  * "limited=N" (N in range 1 - 2147483647)
  *
  * 'queue_depth', if non-NULL, is set to the number of jobs in SCHED
- * state that have not yet requested resources.  Returns 0 on success,
- * -1 on failure with errno set.
+ * state that have not yet requested resources.  If the handle was created
+ * with SCHEDUTIL_BATCH, batched alloc/free is requested, and used if the
+ * job-manager accepts it.  Returns 0 on success, -1 on failure with errno set.
  */
 int schedutil_ready (schedutil_t *util, const char *mode, int *queue_depth);
 
@@ -11,6 +11,8 @@
 #ifndef HAVE_SCHEDUTIL_PRIVATE_H
 #define HAVE_SCHEDUTIL_PRIVATE_H 1
 
+#include <stdbool.h>
+#include <jansson.h>
 #include <flux/core.h>
 
 #include "src/common/libczmqcontainers/czmq_containers.h"
@@ -18,6 +20,8 @@
 #include "init.h"
 
 
+struct alloc_batch;
+
 struct schedutil_ctx {
     flux_t *h;
     flux_msg_handler_t **handlers;
@@ -25,6 +29,11 @@ struct schedutil_ctx {
     int flags;
     void *cb_arg;
     zlistx_t *outstanding_futures;
+    bool batch;                 // job-manager accepted batched mode
+    json_t *alloc_responses;    // alloc responses pending in batched mode
+    const flux_msg_t *alloc_batch_msg;
+    struct alloc_batch *alloc_batch; // allocations awaiting R commit
+    flux_watcher_t *prep;
 };
 
 /* Track futures that need to be destroyed on scheduler unload.
@@ -34,6 +43,16 @@ int schedutil_add_outstanding_future (schedutil_t *util, flux_future_t *fut);
 int schedutil_remove_outstanding_future (schedutil_t *util,
                                          flux_future_t *fut);
 
+/* Send alloc responses collected in batched mode to the job-manager.
+ */
+int schedutil_alloc_flush (schedutil_t *util);
+
+/* Commit R for all successful allocations since the last call in one
+ * KVS transaction.  Alloc responses are sent when the commit completes.
+ */
+int schedutil_alloc_commit (schedutil_t *util);
+void schedutil_alloc_batch_destroy (struct alloc_batch *batch);
+
 /* (Un-)register callbacks for alloc, free, cancel.
  */
 int schedutil_ops_register (schedutil_t *util);
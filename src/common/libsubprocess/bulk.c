@@ -0,0 +1,303 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* bulk.c - client for <service>.bulk-exec
+ */
+
+#if HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <uuid.h>
+#include <jansson.h>
+#include <flux/core.h>
+#include <flux/idset.h>
+
+#include "src/common/libioencode/ioencode.h"
+#include "src/common/libutil/errno_safe.h"
+
+#include "command_private.h"
+#include "client.h"
+#include "bulk.h"
+
+#ifndef UUID_STR_LEN
+#define UUID_STR_LEN 37     // defined in later libuuid headers
+#endif
+
+struct subprocess_bulk {
+    flux_t *h;
+    char *service_name;
+    uint32_t nodeid;
+    char name[UUID_STR_LEN];
+    struct idset *pending;
+    subprocess_bulk_ops_t ops;
+    void *arg;
+    flux_future_t *f;
+};
+
+static char *service_topic (subprocess_bulk_t *b, const char *method)
+{
+    char *topic;
+
+    if (asprintf (&topic, "%s.%s", b->service_name, method) < 0)
+        return NULL;
+    return topic;
+}
+
+/* Call 'fn' for each group of ranks in 'o', as encoded by group_encode()
+ * in bulk_server.c, and remove them from the pending set.
+ */
+static int bulk_groups (subprocess_bulk_t *b, json_t *o, bool exited)
+{
+    const char *key;
+    json_t *val;
+
+    json_object_foreach (o, key, val) {
+        struct idset *ids;
+        int n = strtol (key, NULL, 10);
+
+        if (!json_is_string (val)
+            || !(ids = idset_decode (json_string_value (val)))) {
+            errno = EPROTO;
+            return -1;
+        }
+        (void)idset_subtract (b->pending, ids);
+        if (exited && b->ops.on_exit)
+            b->ops.on_exit (b, ids, n, b->arg);
+        else if (!exited && b->ops.on_error)
+            b->ops.on_error (b, ids, n, NULL, b->arg);
+        idset_destroy (ids);
+    }
+    return 0;
+}
+
+static int bulk_output (subprocess_bulk_t *b, json_t *output)
+{
+    size_t index;
+    json_t *entry;
+
+    json_array_foreach (output, index, entry) {
+        const char *ranks;
+        const char *stream;
+        const char *data;
+        size_t len;
+        struct idset *ids;
+
+        if (json_unpack (entry, "[s s s%]", &ranks, &stream, &data, &len) < 0
+            || !(ids = idset_decode (ranks))) {
+            errno = EPROTO;
+            return -1;
+        }
+        if (b->ops.on_output)
+            b->ops.on_output (b, ids, stream, data, len, b->arg);
+        idset_destroy (ids);
+    }
+    return 0;
+}
+
+static void bulk_complete (subprocess_bulk_t *b)
+{
+    if (b->ops.on_complete)
+        b->ops.on_complete (b, b->arg);
+}
+
+static void bulk_continuation (flux_future_t *f, void *arg)
+{
+    subprocess_bulk_t *b = arg;
+    const char *started = NULL;
+    json_t *exited = NULL;
+    json_t *failed = NULL;
+    json_t *output = NULL;
+
+    if (flux_rpc_get_unpack (f,
+                             "{s?s s?o s?o s?o}",
+                             "started", &started,
+                             "exited", &exited,
+                             "failed", &failed,
+                             "output", &output) < 0) {
+        if (errno != ENODATA && idset_count (b->pending) > 0) {
+            if (b->ops.on_error) {
+                b->ops.on_error (b,
+                                 b->pending,
+                                 errno,
+                                 flux_future_error_string (f),
+                                 b->arg);
+            }
+            idset_range_clear (b->pending, 0, UINT32_MAX - 1);
+        }
+        bulk_complete (b);
+        return;
+    }
+    if (started && b->ops.on_start) {
+        struct idset *ids;
+        if (!(ids = idset_decode (started)))
+            goto error;
+        b->ops.on_start (b, ids, b->arg);
+        idset_destroy (ids);
+    }
+    if ((output && bulk_output (b, output) < 0)
+        || (exited && bulk_groups (b, exited, true) < 0)
+        || (failed && bulk_groups (b, failed, false) < 0))
+        goto error;
+    flux_future_reset (f);
+    return;
+error:
+    if (b->ops.on_error)
+        b->ops.on_error (b, b->pending, errno, "malformed response", b->arg);
+    idset_range_clear (b->pending, 0, UINT32_MAX - 1);
+    bulk_complete (b);
+}
+
+void subprocess_bulk_destroy (subprocess_bulk_t *b)
+{
+    if (b) {
+        int saved_errno = errno;
+        flux_future_destroy (b->f);
+        idset_destroy (b->pending);
+        free (b->service_name);
+        free (b);
+        errno = saved_errno;
+    }
+}
+
+subprocess_bulk_t *subprocess_bulk_exec (flux_t *h,
+                                         const char *service_name,
+                                         uint32_t nodeid,
+                                         const struct idset *ranks,
+                                         const flux_cmd_t *cmd,
+                                         const subprocess_bulk_ops_t *ops,
+                                         void *arg)
+{
+    subprocess_bulk_t *b;
+    uuid_t uuid;
+    char *s = NULL;
+    char *topic = NULL;
+    json_t *cmd_o = NULL;
+    int flags = 0;
+
+    if (!h || !service_name || !ranks || idset_count (ranks) == 0 || !cmd) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(b = calloc (1, sizeof (*b))))
+        return NULL;
+    b->h = h;
+    b->nodeid = nodeid;
+    b->arg = arg;
+    if (ops)
+        b->ops = *ops;
+    if (b->ops.on_output)
+        flags = SUBPROCESS_REXEC_STDOUT | SUBPROCESS_REXEC_STDERR;
+    uuid_generate (uuid);
+    uuid_unparse (uuid, b->name);
+    if (!(b->service_name = strdup (service_name))
+        || !(b->pending = idset_copy (ranks))
+        || !(s = idset_encode (ranks, IDSET_FLAG_RANGE))
+        || !(cmd_o = cmd_tojson (cmd))
+        || !(topic = service_topic (b, "bulk-exec")))
+        goto error;
+    if (!(b->f = flux_rpc_pack (h,
+                                topic,
+                                nodeid,
+                                FLUX_RPC_STREAMING,
+                                "{s:s s:s s:O s:i}",
+                                "name", b->name,
+                                "ranks", s,
+                                "cmd", cmd_o,
+                                "flags", flags))
+        || flux_future_then (b->f, -1., bulk_continuation, b) < 0)
+        goto error;
+    json_decref (cmd_o);
+    free (topic);
+    free (s);
+    return b;
+error:
+    ERRNO_SAFE_WRAP (json_decref, cmd_o);
+    ERRNO_SAFE_WRAP (free, topic);
+    ERRNO_SAFE_WRAP (free, s);
+    subprocess_bulk_destroy (b);
+    return NULL;
+}
+
+static int bulk_send_io (subprocess_bulk_t *b,
+                         const char *stream,
+                         const char *data,
+                         int len,
+                         bool eof)
+{
+    char *topic;
+    json_t *io = NULL;
+    flux_future_t *f = NULL;
+    int rc = -1;
+
+    if (!b || !stream || len < 0 || (len > 0 && !data)) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!(topic = service_topic (b, "bulk-write"))
+        || !(io = ioencode (stream, "-1", data, len, eof))
+        || !(f = flux_rpc_pack (b->h,
+                                topic,
+                                b->nodeid,
+                                FLUX_RPC_NORESPONSE,
+                                "{s:s s:O}",
+                                "name", b->name,
+                                "io", io)))
+        goto out;
+    rc = 0;
+out:
+    flux_future_destroy (f);
+    ERRNO_SAFE_WRAP (json_decref, io);
+    ERRNO_SAFE_WRAP (free, topic);
+    return rc;
+}
+
+int subprocess_bulk_write (subprocess_bulk_t *b,
+                           const char *stream,
+                           const char *data,
+                           int len)
+{
+    return bulk_send_io (b, stream, data, len, false);
+}
+
+int subprocess_bulk_close (subprocess_bulk_t *b, const char *stream)
+{
+    return bulk_send_io (b, stream, NULL, 0, true);
+}
+
+flux_future_t *subprocess_bulk_kill (subprocess_bulk_t *b, int signum)
+{
+    char *topic;
+    flux_future_t *f;
+
+    if (!b || signum <= 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(topic = service_topic (b, "bulk-kill")))
+        return NULL;
+    f = flux_rpc_pack (b->h,
+                       topic,
+                       b->nodeid,
+                       0,
+                       "{s:s s:i}",
+                       "name", b->name,
+                       "signum", signum);
+    ERRNO_SAFE_WRAP (free, topic);
+    return f;
+}
+
+const struct idset *subprocess_bulk_pending (subprocess_bulk_t *b)
+{
+    return b ? b->pending : NULL;
+}
+
+// vi: ts=4 sw=4 expandtab
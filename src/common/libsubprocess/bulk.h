@@ -0,0 +1,94 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _SUBPROCESS_BULK_H
+#define _SUBPROCESS_BULK_H
+
+#include <stdint.h>
+#include <flux/core.h>
+#include <flux/idset.h>
+
+#include "command.h"
+
+/* Start one command on a set of ranks with a single request to the
+ * subprocess server on 'nodeid', which fans it out over the TBON (see
+ * bulk_server.c).  State changes arrive aggregated by rank, e.g. "started
+ * on ranks 0-1023", "exited with status 0 on ranks 0-1022".
+ *
+ * All output of a rank is delivered before its exit.  Output is line
+ * buffered, and identical lines from many ranks are reported once with
+ * the set of ranks that produced them.  Auxiliary channels are not
+ * supported.
+ */
+
+typedef struct subprocess_bulk subprocess_bulk_t;
+
+typedef struct {
+    void (*on_start) (subprocess_bulk_t *b,
+                      const struct idset *ranks,
+                      void *arg);
+    void (*on_exit) (subprocess_bulk_t *b,
+                     const struct idset *ranks,
+                     int status,
+                     void *arg);
+    /* 'ranks' failed to start or were lost with 'errnum'.
+     * If the whole request fails, 'ranks' is the set of ranks that had not
+     * yet exited and 'errmsg' may be set.
+     */
+    void (*on_error) (subprocess_bulk_t *b,
+                      const struct idset *ranks,
+                      int errnum,
+                      const char *errmsg,
+                      void *arg);
+    /* 'data' is one line of output from 'stream' on each of 'ranks'.
+     */
+    void (*on_output) (subprocess_bulk_t *b,
+                       const struct idset *ranks,
+                       const char *stream,
+                       const char *data,
+                       int len,
+                       void *arg);
+    /* All ranks have exited or failed.
+     */
+    void (*on_complete) (subprocess_bulk_t *b, void *arg);
+} subprocess_bulk_ops_t;
+
+subprocess_bulk_t *subprocess_bulk_exec (flux_t *h,
+                                         const char *service_name,
+                                         uint32_t nodeid,
+                                         const struct idset *ranks,
+                                         const flux_cmd_t *cmd,
+                                         const subprocess_bulk_ops_t *ops,
+                                         void *arg);
+
+/* Write to / close 'stream' of the processes on all ranks.
+ */
+int subprocess_bulk_write (subprocess_bulk_t *b,
+                           const char *stream,
+                           const char *data,
+                           int len);
+int subprocess_bulk_close (subprocess_bulk_t *b, const char *stream);
+
+/* Send 'signum' to the processes on all ranks.
+ */
+flux_future_t *subprocess_bulk_kill (subprocess_bulk_t *b, int signum);
+
+/* Return the ranks that have not yet exited or failed.
+ */
+const struct idset *subprocess_bulk_pending (subprocess_bulk_t *b);
+
+/* Destroying a launch before it is complete does not stop the processes,
+ * but they are killed when the handle used to create it is closed.
+ */
+void subprocess_bulk_destroy (subprocess_bulk_t *b);
+
+#endif /* !_SUBPROCESS_BULK_H */
+
+// vi: ts=4 sw=4 expandtab
@@ -0,0 +1,496 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* bulk_server.c - start one command on many ranks with one request
+ *
+ * A <service>.bulk-exec streaming request
+ *
+ *   {"name":s "ranks":s "cmd":o "flags":i}
+ *
+ * starts 'cmd' on each rank in the idset 'ranks'.  The server forwards the
+ * request to each child in the TBON with ranks of the launch in its
+ * subtree, starts the local process if its own rank is included, and
+ * batches state changes from all of them into one response upstream every
+ * FANOUT_BATCH_TIMEOUT seconds (see fanout.h):
+ *
+ *   {"started"?:s "exited"?:{status:s} "failed"?:{errnum:s}
+ *    "output"?:[[ranks,stream,data],...]}
+ *
+ * where idsets of ranks are grouped by wait status or errno.  Output is
+ * forwarded line by line.  Identical lines from different ranks in a batch
+ * are merged into one entry with an idset of ranks, as long as that keeps
+ * the lines of each rank in order, so output that is the same on every
+ * rank travels up the tree once per batch rather than once per rank.
+ * All output of a rank precedes its exit in the response stream.
+ * ENODATA ends the stream once every rank has exited or failed.
+ *
+ * The client chooses 'name', which must be unique among its launches.
+ * <service>.bulk-write {"name":s "io":o} sends an ioencoded stdin buffer
+ * or EOF to all ranks of a launch and <service>.bulk-kill
+ * {"name":s "signum":i} signals them.  Both are forwarded down the tree.
+ */
+
+#if HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <signal.h>
+#include <jansson.h>
+#include <flux/core.h>
+#include <flux/idset.h>
+
+#include "src/common/libczmqcontainers/czmq_containers.h"
+#include "src/common/libutil/errprintf.h"
+#include "src/common/libioencode/ioencode.h"
+
+#include "subprocess.h"
+#include "client.h"
+#include "server_private.h"
+#include "fanout.h"
+
+static const char *auxkey = "flux::bulk_launch";
+
+struct bulk_server {
+    subprocess_server_t *s;
+    flux_t *h;
+    char *service_name;
+    uint32_t rank;
+    zlistx_t *children;         // see fanout_children_create()
+    zhashx_t *launches;         // struct bulk_launch by name
+    flux_msg_handler_t **handlers;
+};
+
+struct bulk_launch {
+    struct bulk_server *bs;
+    char *name;
+    struct fanout *fo;
+    flux_subprocess_t *p;       // local process, if running
+    bool disconnected;
+};
+
+static void bulk_launch_destroy (struct bulk_launch *l)
+{
+    if (l) {
+        int saved_errno = errno;
+        /* The local process belongs to the subprocess server, which
+         * kills it on destroy.  Just detach it from the launch.
+         */
+        if (l->p)
+            (void)flux_subprocess_aux_set (l->p, auxkey, NULL, NULL);
+        fanout_destroy (l->fo);
+        free (l->name);
+        free (l);
+        errno = saved_errno;
+    }
+}
+
+static void bulk_launch_destructor (void **item)
+{
+    if (item) {
+        bulk_launch_destroy (*item);
+        *item = NULL;
+    }
+}
+
+/* Called from the fanout timer once all ranks are done.
+ */
+static void bulk_launch_done (struct fanout *fo, void *arg)
+{
+    struct bulk_launch *l = arg;
+
+    zhashx_delete (l->bs->launches, l->name);
+}
+
+/* Release the local process once it has exited or failed.
+ */
+static void local_release (struct bulk_launch *l)
+{
+    server_proc_release (l->bs->s, l->p);
+    l->p = NULL;
+}
+
+static void local_state_cb (flux_subprocess_t *p,
+                            flux_subprocess_state_t state)
+{
+    struct bulk_launch *l = flux_subprocess_aux_get (p, auxkey);
+
+    if (!l)
+        return;
+    if (state == FLUX_SUBPROCESS_RUNNING)
+        fanout_started (l->fo, l->bs->rank);
+    else if (state == FLUX_SUBPROCESS_FAILED) {
+        fanout_failed (l->fo, l->bs->rank, flux_subprocess_fail_errno (p));
+        local_release (l);
+    }
+}
+
+static void local_completion_cb (flux_subprocess_t *p)
+{
+    struct bulk_launch *l = flux_subprocess_aux_get (p, auxkey);
+
+    if (l) {
+        fanout_exited (l->fo, l->bs->rank, flux_subprocess_status (p));
+        local_release (l);
+    }
+}
+
+static void local_output_cb (flux_subprocess_t *p, const char *stream)
+{
+    struct bulk_launch *l = flux_subprocess_aux_get (p, auxkey);
+    const char *s;
+    int len;
+
+    if (!l)
+        return;
+    if (!(s = flux_subprocess_getline (p, stream, &len))) {
+        flux_log_error (l->bs->h, "flux_subprocess_getline");
+        return;
+    }
+    if (len > 0)
+        fanout_output (l->fo, l->bs->rank, stream, s, len);
+}
+
+static int local_start (struct bulk_launch *l,
+                        const flux_msg_t *msg,
+                        json_t *cmd,
+                        int flags,
+                        flux_error_t *error)
+{
+    flux_subprocess_ops_t ops = {
+        .on_completion = local_completion_cb,
+        .on_state_change = local_state_cb,
+        .on_channel_out = local_output_cb,
+        .on_stdout = local_output_cb,
+        .on_stderr = local_output_cb,
+    };
+
+    if (!(flags & SUBPROCESS_REXEC_CHANNEL))
+        ops.on_channel_out = NULL;
+    if (!(flags & SUBPROCESS_REXEC_STDOUT))
+        ops.on_stdout = NULL;
+    if (!(flags & SUBPROCESS_REXEC_STDERR))
+        ops.on_stderr = NULL;
+    if (!(l->p = server_exec (l->bs->s, msg, cmd, &ops, error)))
+        return -1;
+    if (flux_subprocess_aux_set (l->p, auxkey, l, NULL) < 0) {
+        errprintf (error, "error saving process: %s", strerror (errno));
+        return -1;
+    }
+    return 0;
+}
+
+/* Send a bulk-write or bulk-kill request 'o' to every child with a
+ * forwarded launch that has not finished.
+ */
+static void forward_control (struct bulk_launch *l,
+                             const char *method,
+                             json_t *o)
+{
+    char topic[128];
+
+    snprintf (topic, sizeof (topic), "%s.%s", l->bs->service_name, method);
+    fanout_forward_control (l->fo, topic, o);
+}
+
+static struct bulk_launch *bulk_launch_create (struct bulk_server *bs,
+                                               const flux_msg_t *msg,
+                                               const char *name,
+                                               const char *ranks)
+{
+    struct bulk_launch *l;
+    char prefix[128];
+
+    if (!(l = calloc (1, sizeof (*l))))
+        return NULL;
+    l->bs = bs;
+    snprintf (prefix, sizeof (prefix), "bulk-exec %s", name);
+    if (!(l->name = strdup (name))
+        || !(l->fo = fanout_create (bs->h,
+                                    msg,
+                                    ranks,
+                                    0,
+                                    prefix,
+                                    bulk_launch_done,
+                                    l)))
+        goto error;
+    return l;
+error:
+    bulk_launch_destroy (l);
+    errno = ENOMEM;
+    return NULL;
+}
+
+static void bulk_exec_cb (flux_t *h,
+                          flux_msg_handler_t *mh,
+                          const flux_msg_t *msg,
+                          void *arg)
+{
+    struct bulk_server *bs = arg;
+    json_t *request;
+    const char *name;
+    const char *ranks;
+    json_t *cmd;
+    int flags;
+    struct bulk_launch *l = NULL;
+    char topic[128];
+    flux_error_t error;
+    const char *errmsg = NULL;
+
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s:s s:s s:o s:i}",
+                             "name", &name,
+                             "ranks", &ranks,
+                             "cmd", &cmd,
+                             "flags", &flags) < 0
+        || flux_msg_unpack (msg, "o", &request) < 0)
+        goto error;
+    if (!flux_msg_is_streaming (msg)) {
+        errno = EPROTO;
+        goto error;
+    }
+    if (server_authorize (bs->s, msg, &error) < 0) {
+        errmsg = error.text;
+        goto error;
+    }
+    if (!(l = bulk_launch_create (bs, msg, name, ranks)))
+        goto error;
+    if (idset_count (fanout_pending (l->fo)) == 0
+        || !fanout_children_cover (bs->children,
+                                   bs->rank,
+                                   fanout_pending (l->fo))) {
+        errmsg = "ranks are not in the subtree of this broker";
+        errno = EINVAL;
+        goto error;
+    }
+    if (zhashx_insert (bs->launches, l->name, l) < 0) {
+        errmsg = "bulk launch name is already in use";
+        errno = EEXIST;
+        goto error;
+    }
+    snprintf (topic, sizeof (topic), "%s.bulk-exec", bs->service_name);
+    fanout_forward (l->fo, bs->children, topic, request);
+    if (idset_test (fanout_pending (l->fo), bs->rank)) {
+        if (local_start (l, msg, cmd, flags, &error) < 0) {
+            int errnum = errno;
+
+            flux_log (h,
+                      LOG_ERR,
+                      "bulk-exec %s: %s",
+                      l->name,
+                      error.text);
+            if (l->p)
+                local_release (l);
+            fanout_failed (l->fo, bs->rank, errnum);
+        }
+    }
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, errmsg) < 0)
+        flux_log_error (h, "error responding to bulk-exec request");
+    if (l && zhashx_lookup (bs->launches, l->name) != l)
+        bulk_launch_destroy (l);
+}
+
+static struct bulk_launch *lookup_launch (struct bulk_server *bs,
+                                          const char *name)
+{
+    struct bulk_launch *l;
+
+    if (!(l = zhashx_lookup (bs->launches, name)))
+        errno = ENOENT;
+    return l;
+}
+
+static void bulk_write_cb (flux_t *h,
+                           flux_msg_handler_t *mh,
+                           const flux_msg_t *msg,
+                           void *arg)
+{
+    struct bulk_server *bs = arg;
+    json_t *request;
+    const char *name;
+    json_t *io;
+    const char *stream;
+    char *data = NULL;
+    int len;
+    bool eof;
+    struct bulk_launch *l;
+    flux_error_t error;
+
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s:s s:o}",
+                             "name", &name,
+                             "io", &io) < 0
+        || flux_msg_unpack (msg, "o", &request) < 0
+        || iodecode (io, &stream, NULL, &data, &len, &eof) < 0
+        || server_authorize (bs->s, msg, &error) < 0
+        || !(l = lookup_launch (bs, name)))
+        goto error;
+    forward_control (l, "bulk-write", request);
+    if (l->p) {
+        if ((data && len > 0
+             && flux_subprocess_write (l->p, stream, data, len) < 0)
+            || (eof && flux_subprocess_close (l->p, stream) < 0))
+            flux_log_error (h,
+                            "bulk-exec %s: error writing to %s",
+                            l->name,
+                            stream);
+    }
+    free (data);
+    return;
+error:
+    /* A launch that has finished here may still get stdin from upstream.
+     */
+    if (errno != ENOENT)
+        flux_log_error (h, "error handling bulk-write request");
+    free (data);
+}
+
+static void bulk_kill_cb (flux_t *h,
+                          flux_msg_handler_t *mh,
+                          const flux_msg_t *msg,
+                          void *arg)
+{
+    struct bulk_server *bs = arg;
+    json_t *request;
+    const char *name;
+    int signum;
+    struct bulk_launch *l;
+    flux_error_t error;
+    const char *errmsg = NULL;
+
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s:s s:i}",
+                             "name", &name,
+                             "signum", &signum) < 0
+        || flux_msg_unpack (msg, "o", &request) < 0)
+        goto error;
+    if (server_authorize (bs->s, msg, &error) < 0) {
+        errmsg = error.text;
+        goto error;
+    }
+    if (!(l = lookup_launch (bs, name)))
+        goto error;
+    forward_control (l, "bulk-kill", request);
+    if (l->p) {
+        flux_future_t *f;
+        if (!(f = flux_subprocess_kill (l->p, signum)))
+            flux_log_error (h, "bulk-exec %s: kill", l->name);
+        flux_future_destroy (f);
+    }
+    if (!flux_msg_is_noresponse (msg)
+        && flux_respond (h, msg, NULL) < 0)
+        flux_log_error (h, "error responding to bulk-kill request");
+    return;
+error:
+    if (!flux_msg_is_noresponse (msg)
+        && flux_respond_error (h, msg, errno, errmsg) < 0)
+        flux_log_error (h, "error responding to bulk-kill request");
+}
+
+void bulk_server_disconnect (struct bulk_server *bs, const flux_msg_t *msg)
+{
+    struct bulk_launch *l;
+
+    if (!bs)
+        return;
+    l = zhashx_first (bs->launches);
+    while (l) {
+        if (!l->disconnected
+            && flux_disconnect_match (msg, fanout_get_msg (l->fo))) {
+            json_t *o;
+
+            /* The local process is killed by the subprocess server.
+             */
+            l->disconnected = true;
+            fanout_mute (l->fo);
+            if (!(o = json_pack ("{s:s s:i}",
+                                 "name", l->name,
+                                 "signum", SIGKILL)))
+                flux_log (bs->h, LOG_ERR, "bulk-exec: out of memory");
+            else
+                forward_control (l, "bulk-kill", o);
+            json_decref (o);
+        }
+        l = zhashx_next (bs->launches);
+    }
+}
+
+int bulk_server_set_topology (struct bulk_server *bs, json_t *topo)
+{
+    zlistx_t *children;
+
+    if (!bs || !topo) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!(children = fanout_children_create (topo)))
+        return -1;
+    zlistx_destroy (&bs->children);
+    bs->children = children;
+    return 0;
+}
+
+static const struct flux_msg_handler_spec htab[] = {
+    { FLUX_MSGTYPE_REQUEST, "bulk-exec", bulk_exec_cb, 0 },
+    { FLUX_MSGTYPE_REQUEST, "bulk-write", bulk_write_cb, 0 },
+    { FLUX_MSGTYPE_REQUEST, "bulk-kill", bulk_kill_cb, 0 },
+    FLUX_MSGHANDLER_TABLE_END,
+};
+
+void bulk_server_destroy (struct bulk_server *bs)
+{
+    if (bs) {
+        int saved_errno = errno;
+        flux_msg_handler_delvec (bs->handlers);
+        zhashx_destroy (&bs->launches);
+        zlistx_destroy (&bs->children);
+        free (bs->service_name);
+        free (bs);
+        errno = saved_errno;
+    }
+}
+
+struct bulk_server *bulk_server_create (subprocess_server_t *s,
+                                        flux_t *h,
+                                        const char *service_name,
+                                        uint32_t rank)
+{
+    struct bulk_server *bs;
+
+    if (!(bs = calloc (1, sizeof (*bs))))
+        return NULL;
+    bs->s = s;
+    bs->h = h;
+    bs->rank = rank;
+    if (!(bs->service_name = strdup (service_name))
+        || !(bs->launches = zhashx_new ()))
+        goto nomem;
+    if (!(bs->children = fanout_children_create (NULL)))
+        goto error;
+    zhashx_set_destructor (bs->launches, bulk_launch_destructor);
+    if (flux_msg_handler_addvec_ex (h,
+                                    service_name,
+                                    htab,
+                                    bs,
+                                    &bs->handlers) < 0)
+        goto error;
+    return bs;
+nomem:
+    errno = ENOMEM;
+error:
+    bulk_server_destroy (bs);
+    return NULL;
+}
+
+// vi: ts=4 sw=4 expandtab
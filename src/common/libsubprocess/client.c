@@ -94,13 +94,14 @@ flux_future_t *subprocess_rexec (flux_t *h,
                                  const char *service_name,
                                  uint32_t rank,
                                  flux_cmd_t *cmd,
-                                 int flags)
+                                 int flags,
+                                 int credit)
 {
     flux_future_t *f = NULL;
     struct rexec_ctx *ctx;
     char *topic;
 
-    if (!h || !cmd || !service_name) {
+    if (!h || !cmd || !service_name || credit < 0) {
         errno = EINVAL;
         return NULL;
     }
@@ -108,13 +109,24 @@ flux_future_t *subprocess_rexec (flux_t *h,
         return NULL;
     if (!(ctx = rexec_ctx_create (cmd, flags)))
         goto error;
-    if (!(f = flux_rpc_pack (h,
-                             topic,
-                             rank,
-                             FLUX_RPC_STREAMING,
-                             "{s:O s:i}",
-                             "cmd", ctx->cmd,
-                             "flags", ctx->flags))
+    if (credit > 0)
+        f = flux_rpc_pack (h,
+                           topic,
+                           rank,
+                           FLUX_RPC_STREAMING,
+                           "{s:O s:i s:i}",
+                           "cmd", ctx->cmd,
+                           "flags", ctx->flags,
+                           "credit", credit);
+    else
+        f = flux_rpc_pack (h,
+                           topic,
+                           rank,
+                           FLUX_RPC_STREAMING,
+                           "{s:O s:i}",
+                           "cmd", ctx->cmd,
+                           "flags", ctx->flags);
+    if (!f
         || flux_future_aux_set (f,
                                 "flux::rexec",
                                 ctx,
@@ -260,6 +272,36 @@ out:
     return rc;
 }
 
+int subprocess_credit (flux_t *h,
+                       const char *service_name,
+                       uint32_t rank,
+                       pid_t pid,
+                       int credit)
+{
+    flux_future_t *f;
+    char *topic;
+
+    if (!h || pid < 0 || credit <= 0 || !service_name) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (asprintf (&topic, "%s.credit", service_name) < 0)
+        return -1;
+    if (!(f = flux_rpc_pack (h,
+                             topic,
+                             rank,
+                             FLUX_RPC_NORESPONSE,
+                             "{s:i s:i}",
+                             "pid", pid,
+                             "credit", credit))) {
+        ERRNO_SAFE_WRAP (free, topic);
+        return -1;
+    }
+    flux_future_destroy (f);
+    free (topic);
+    return 0;
+}
+
 flux_future_t *subprocess_kill (flux_t *h,
                                 const char *service_name,
                                 uint32_t rank,
@@ -24,11 +24,15 @@ enum {
     SUBPROCESS_REXEC_CHANNEL = 4,
 };
 
+/* If credit > 0, the server sends at most 'credit' bytes of output
+ * until more is granted with subprocess_credit().
+ */
 flux_future_t *subprocess_rexec (flux_t *h,
                                  const char *service_name,
                                  uint32_t rank,
                                  flux_cmd_t *cmd,
-                                 int flags);
+                                 int flags,
+                                 int credit);
 
 int subprocess_rexec_get (flux_future_t *f);
 bool subprocess_rexec_is_started (flux_future_t *f, pid_t *pid);
@@ -49,6 +53,12 @@ int subprocess_write (flux_t *h,
                       int len,
                       bool eof);
 
+int subprocess_credit (flux_t *h,
+                       const char *service_name,
+                       uint32_t rank,
+                       pid_t pid,
+                       int credit);
+
 flux_future_t *subprocess_kill (flux_t *h,
                                 const char *service_name,
                                 uint32_t rank,
@@ -0,0 +1,895 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* fanout.c - forward a launch down the TBON and batch its responses
+ *
+ * See fanout.h.
+ */
+
+#if HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <jansson.h>
+#include <flux/core.h>
+#include <flux/idset.h>
+
+#include "src/common/libczmqcontainers/czmq_containers.h"
+#include "src/common/libutil/errno_safe.h"
+#include "ccan/str/str.h"
+
+#include "fanout.h"
+
+/* Flush a batch early once this much output is pending.
+ */
+static const size_t fanout_output_max = 65536;
+
+struct fanout_child {
+    uint32_t rank;
+    struct idset *subtree;      // ranks in the subtree rooted at child
+};
+
+struct fanout_forward {
+    uint32_t rank;
+    struct idset *subset;       // ranks of the launch in the child subtree
+};
+
+struct fanout_output {
+    struct idset *ranks;
+    char *stream;
+    char *data;
+    int len;
+};
+
+struct fanout {
+    flux_t *h;
+    const flux_msg_t *msg;
+    char *prefix;
+    int flags;
+    struct idset *pending;      // ranks in this subtree not yet finished
+    zlistx_t *forwards;         // flux_future_t of requests sent to children
+    bool muted;
+    bool suspended;
+    fanout_done_f cb;
+    void *cb_arg;
+
+    /* state changes not yet sent upstream */
+    struct idset *started;
+    zhashx_t *exited;           // wait status => struct idset
+    zhashx_t *failed;           // errnum => struct idset
+    struct fanout_output **output;
+    int output_count;
+    int output_alloc;
+    zhashx_t *output_index;     // "stream:data" => index + 1 of last entry
+    size_t output_size;
+    flux_watcher_t *timer;
+    bool timer_armed;
+
+    /* all state changes since creation, with FANOUT_HISTORY */
+    struct idset *started_all;
+    zhashx_t *exited_all;
+    zhashx_t *failed_all;
+};
+
+static void child_destroy (struct fanout_child *child)
+{
+    if (child) {
+        int saved_errno = errno;
+        idset_destroy (child->subtree);
+        free (child);
+        errno = saved_errno;
+    }
+}
+
+static void child_destructor (void **item)
+{
+    if (item) {
+        child_destroy (*item);
+        *item = NULL;
+    }
+}
+
+static void idset_destructor (void **item)
+{
+    if (item) {
+        idset_destroy (*item);
+        *item = NULL;
+    }
+}
+
+static void future_destructor (void **item)
+{
+    if (item) {
+        flux_future_destroy (*item);
+        *item = NULL;
+    }
+}
+
+static void forward_destroy (struct fanout_forward *fwd)
+{
+    if (fwd) {
+        int saved_errno = errno;
+        idset_destroy (fwd->subset);
+        free (fwd);
+        errno = saved_errno;
+    }
+}
+
+static void output_destroy (struct fanout_output *out)
+{
+    if (out) {
+        int saved_errno = errno;
+        idset_destroy (out->ranks);
+        free (out->stream);
+        free (out->data);
+        free (out);
+        errno = saved_errno;
+    }
+}
+
+/* Add the ranks of topology object 'topo' (see overlay.topology) and its
+ * descendants to 'ids'.
+ */
+static int topology_add_ranks (json_t *topo, struct idset *ids)
+{
+    int rank;
+    json_t *children = NULL;
+    size_t index;
+    json_t *entry;
+
+    if (json_unpack (topo, "{s:i s?o}", "rank", &rank, "children", &children) < 0
+        || idset_set (ids, rank) < 0) {
+        errno = EPROTO;
+        return -1;
+    }
+    json_array_foreach (children, index, entry) {
+        if (topology_add_ranks (entry, ids) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+zlistx_t *fanout_children_create (json_t *topo)
+{
+    zlistx_t *l;
+    json_t *children = NULL;
+    size_t index;
+    json_t *entry;
+    struct fanout_child *child = NULL;
+
+    if (!(l = zlistx_new ())) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    zlistx_set_destructor (l, child_destructor);
+    if (topo)
+        (void)json_unpack (topo, "{s?o}", "children", &children);
+    json_array_foreach (children, index, entry) {
+        int rank;
+        if (json_unpack (entry, "{s:i}", "rank", &rank) < 0) {
+            errno = EPROTO;
+            goto error;
+        }
+        if (!(child = calloc (1, sizeof (*child)))
+            || !(child->subtree = idset_create (0, IDSET_FLAG_AUTOGROW))
+            || topology_add_ranks (entry, child->subtree) < 0)
+            goto error;
+        child->rank = rank;
+        if (!zlistx_add_end (l, child)) {
+            errno = ENOMEM;
+            goto error;
+        }
+        child = NULL;
+    }
+    return l;
+error:
+    child_destroy (child);
+    ERRNO_SAFE_WRAP (zlistx_destroy, &l);
+    return NULL;
+}
+
+bool fanout_children_cover (zlistx_t *children,
+                            uint32_t rank,
+                            const struct idset *ranks)
+{
+    struct idset *rest;
+    struct fanout_child *child;
+    bool result;
+
+    if (!(rest = idset_copy (ranks)))
+        return false;
+    (void)idset_clear (rest, rank);
+    child = zlistx_first (children);
+    while (child) {
+        (void)idset_subtract (rest, child->subtree);
+        child = zlistx_next (children);
+    }
+    result = idset_count (rest) == 0;
+    idset_destroy (rest);
+    return result;
+}
+
+/* Add 'ranks' to the set for 'key' in 'groups', e.g. exits by status.
+ */
+static int group_add (zhashx_t *groups, int key, const struct idset *ranks)
+{
+    char s[16];
+    struct idset *ids;
+
+    snprintf (s, sizeof (s), "%d", key);
+    if (!(ids = zhashx_lookup (groups, s))) {
+        if (!(ids = idset_create (0, IDSET_FLAG_AUTOGROW)))
+            return -1;
+        (void)zhashx_insert (groups, s, ids);
+    }
+    return idset_add (ids, ranks);
+}
+
+/* Add all groups of 'src' to 'groups'.
+ */
+static int group_add_all (zhashx_t *groups, zhashx_t *src)
+{
+    struct idset *ids;
+
+    ids = zhashx_first (src);
+    while (ids) {
+        const char *key = zhashx_cursor (src);
+        if (group_add (groups, strtol (key, NULL, 10), ids) < 0)
+            return -1;
+        ids = zhashx_next (src);
+    }
+    return 0;
+}
+
+static json_t *group_encode (zhashx_t *groups)
+{
+    json_t *o;
+    struct idset *ids;
+
+    if (!(o = json_object ()))
+        goto nomem;
+    ids = zhashx_first (groups);
+    while (ids) {
+        const char *key = zhashx_cursor (groups);
+        char *s;
+        json_t *val;
+
+        if (!(s = idset_encode (ids, IDSET_FLAG_RANGE)))
+            goto error;
+        if (!(val = json_string (s))
+            || json_object_set_new (o, key, val) < 0) {
+            json_decref (val);
+            free (s);
+            goto nomem;
+        }
+        free (s);
+        ids = zhashx_next (groups);
+    }
+    return o;
+nomem:
+    errno = ENOMEM;
+error:
+    ERRNO_SAFE_WRAP (json_decref, o);
+    return NULL;
+}
+
+/* Record that 'ranks' finished with 'key' in 'groups' and, if kept,
+ * 'all', and remove them from the pending set.
+ */
+static int fanout_finish (struct fanout *fo,
+                          zhashx_t *groups,
+                          zhashx_t *all,
+                          int key,
+                          const struct idset *ranks)
+{
+    if (group_add (groups, key, ranks) < 0
+        || (all && group_add (all, key, ranks) < 0)
+        || idset_subtract (fo->pending, ranks) < 0)
+        return -1;
+    return 0;
+}
+
+/* Merge an object of idsets by key, as produced by group_encode(), with
+ * fanout_finish().
+ */
+static int group_merge (struct fanout *fo,
+                        zhashx_t *groups,
+                        zhashx_t *all,
+                        json_t *o)
+{
+    const char *key;
+    json_t *val;
+
+    json_object_foreach (o, key, val) {
+        struct idset *ids;
+        int rc;
+
+        if (!json_is_string (val)
+            || !(ids = idset_decode (json_string_value (val)))) {
+            errno = EPROTO;
+            return -1;
+        }
+        rc = fanout_finish (fo, groups, all, strtol (key, NULL, 10), ids);
+        idset_destroy (ids);
+        if (rc < 0)
+            return -1;
+    }
+    return 0;
+}
+
+static bool output_match (struct fanout_output *out,
+                          const char *stream,
+                          const char *data,
+                          int len)
+{
+    return out->len == len
+        && streq (out->stream, stream)
+        && memcmp (out->data, data, len) == 0;
+}
+
+/* Queue 'data' from 'stream' of 'ranks' for the next batch.  Merge it
+ * with the last identical entry unless a later entry has output from one
+ * of 'ranks', which would then be out of order.
+ */
+static int output_append (struct fanout *fo,
+                          const struct idset *ranks,
+                          const char *stream,
+                          const char *data,
+                          int len)
+{
+    struct fanout_output *out = NULL;
+    char *key;
+    int index;
+
+    if (asprintf (&key, "%s:%.*s", stream, len, data) < 0)
+        return -1;
+    if ((index = (uintptr_t)zhashx_lookup (fo->output_index, key)) > 0
+        && output_match (fo->output[index - 1], stream, data, len)) {
+        int i;
+        for (i = index; i < fo->output_count; i++) {
+            if (idset_has_intersection (fo->output[i]->ranks, ranks))
+                break;
+        }
+        if (i == fo->output_count) {
+            free (key);
+            return idset_add (fo->output[index - 1]->ranks, ranks);
+        }
+    }
+    if (fo->output_count == fo->output_alloc) {
+        int alloc = fo->output_alloc ? fo->output_alloc * 2 : 16;
+        struct fanout_output **output;
+        if (!(output = realloc (fo->output, alloc * sizeof (*output))))
+            goto error;
+        fo->output = output;
+        fo->output_alloc = alloc;
+    }
+    if (!(out = calloc (1, sizeof (*out)))
+        || !(out->ranks = idset_copy (ranks))
+        || !(out->stream = strdup (stream))
+        || !(out->data = malloc (len > 0 ? len : 1)))
+        goto error;
+    memcpy (out->data, data, len);
+    out->len = len;
+    fo->output[fo->output_count++] = out;
+    zhashx_update (fo->output_index,
+                   key,
+                   (void *)(uintptr_t)fo->output_count);
+    fo->output_size += len;
+    free (key);
+    return 0;
+error:
+    output_destroy (out);
+    ERRNO_SAFE_WRAP (free, key);
+    return -1;
+}
+
+static json_t *output_encode (struct fanout *fo)
+{
+    json_t *a;
+
+    if (!(a = json_array ()))
+        goto nomem;
+    for (int i = 0; i < fo->output_count; i++) {
+        struct fanout_output *out = fo->output[i];
+        json_t *entry;
+        char *s;
+
+        if (!(s = idset_encode (out->ranks, IDSET_FLAG_RANGE)))
+            goto error;
+        if (!(entry = json_pack ("[s s s#]",
+                                 s,
+                                 out->stream,
+                                 out->data,
+                                 out->len))
+            || json_array_append_new (a, entry) < 0) {
+            json_decref (entry);
+            free (s);
+            goto nomem;
+        }
+        free (s);
+    }
+    return a;
+nomem:
+    errno = ENOMEM;
+error:
+    ERRNO_SAFE_WRAP (json_decref, a);
+    return NULL;
+}
+
+static void output_clear (struct fanout *fo)
+{
+    for (int i = 0; i < fo->output_count; i++)
+        output_destroy (fo->output[i]);
+    fo->output_count = 0;
+    fo->output_size = 0;
+    zhashx_purge (fo->output_index);
+}
+
+static bool fanout_done (struct fanout *fo)
+{
+    return idset_count (fo->pending) == 0 && zlistx_size (fo->forwards) == 0;
+}
+
+/* Send state changes collected since the last batch upstream.
+ */
+static int fanout_flush (struct fanout *fo)
+{
+    json_t *o;
+    char *s = NULL;
+    json_t *groups;
+
+    if (fo->suspended)
+        return 0;
+    if (!(o = json_object ()))
+        goto nomem;
+    if (idset_count (fo->started) > 0) {
+        json_t *val;
+        if (!(s = idset_encode (fo->started, IDSET_FLAG_RANGE)))
+            goto error;
+        if (!(val = json_string (s))
+            || json_object_set_new (o, "started", val) < 0) {
+            json_decref (val);
+            goto nomem;
+        }
+        idset_range_clear (fo->started, 0, UINT32_MAX - 1);
+    }
+    if (fo->output_count > 0) {
+        json_t *output;
+        if (!(output = output_encode (fo))
+            || json_object_set_new (o, "output", output) < 0) {
+            json_decref (output);
+            goto nomem;
+        }
+        output_clear (fo);
+    }
+    if (zhashx_size (fo->exited) > 0) {
+        if (!(groups = group_encode (fo->exited))
+            || json_object_set_new (o, "exited", groups) < 0) {
+            json_decref (groups);
+            goto nomem;
+        }
+        zhashx_purge (fo->exited);
+    }
+    if (zhashx_size (fo->failed) > 0) {
+        if (!(groups = group_encode (fo->failed))
+            || json_object_set_new (o, "failed", groups) < 0) {
+            json_decref (groups);
+            goto nomem;
+        }
+        zhashx_purge (fo->failed);
+    }
+    if (json_object_size (o) > 0
+        && !fo->muted
+        && flux_respond_pack (fo->h, fo->msg, "O", o) < 0)
+        goto error;
+    json_decref (o);
+    free (s);
+    return 0;
+nomem:
+    errno = ENOMEM;
+error:
+    ERRNO_SAFE_WRAP (json_decref, o);
+    ERRNO_SAFE_WRAP (free, s);
+    return -1;
+}
+
+/* Flush the batch, and finish the fanout if all ranks are done.
+ * The done callback is only called from here, never from a subprocess
+ * or future callback that references the fanout, so it may destroy it.
+ */
+static void timer_cb (flux_reactor_t *r,
+                      flux_watcher_t *w,
+                      int revents,
+                      void *arg)
+{
+    struct fanout *fo = arg;
+
+    fo->timer_armed = false;
+    if (fo->suspended)
+        return;
+    if (fanout_flush (fo) < 0)
+        flux_log_error (fo->h, "%s: error sending update", fo->prefix);
+    if (fanout_done (fo)) {
+        if (!fo->muted
+            && flux_respond_error (fo->h, fo->msg, ENODATA, NULL) < 0)
+            flux_log_error (fo->h, "%s: error responding", fo->prefix);
+        if (fo->cb)
+            fo->cb (fo, fo->cb_arg);
+    }
+}
+
+static void fanout_update (struct fanout *fo)
+{
+    if (!fo->timer_armed) {
+        flux_timer_watcher_reset (fo->timer, FANOUT_BATCH_TIMEOUT, 0.);
+        flux_watcher_start (fo->timer);
+        fo->timer_armed = true;
+    }
+}
+
+/* Queue output and flush early if too much is pending.
+ */
+static void fanout_output_append (struct fanout *fo,
+                                  const struct idset *ranks,
+                                  const char *stream,
+                                  const char *data,
+                                  int len)
+{
+    if (output_append (fo, ranks, stream, data, len) < 0) {
+        flux_log_error (fo->h, "%s: dropped %s line", fo->prefix, stream);
+        return;
+    }
+    if (fo->output_size >= fanout_output_max) {
+        if (fanout_flush (fo) < 0)
+            flux_log_error (fo->h, "%s: error sending update", fo->prefix);
+    }
+    else
+        fanout_update (fo);
+}
+
+/* Mark 'ranks' as failed with 'errnum'.
+ */
+static void fanout_fail (struct fanout *fo,
+                         const struct idset *ranks,
+                         int errnum)
+{
+    if (fanout_finish (fo, fo->failed, fo->failed_all, errnum, ranks) < 0)
+        flux_log_error (fo->h, "%s: error recording failure", fo->prefix);
+    fanout_update (fo);
+}
+
+void fanout_started (struct fanout *fo, uint32_t rank)
+{
+    if (idset_set (fo->started, rank) < 0
+        || (fo->started_all && idset_set (fo->started_all, rank) < 0))
+        flux_log_error (fo->h, "%s: idset_set", fo->prefix);
+    fanout_update (fo);
+}
+
+static void fanout_finish_rank (struct fanout *fo,
+                                zhashx_t *groups,
+                                zhashx_t *all,
+                                int key,
+                                uint32_t rank)
+{
+    struct idset *ids;
+
+    if (!(ids = idset_create (0, IDSET_FLAG_AUTOGROW))
+        || idset_set (ids, rank) < 0
+        || fanout_finish (fo, groups, all, key, ids) < 0)
+        flux_log_error (fo->h, "%s: error recording exit", fo->prefix);
+    idset_destroy (ids);
+    fanout_update (fo);
+}
+
+void fanout_exited (struct fanout *fo, uint32_t rank, int status)
+{
+    fanout_finish_rank (fo, fo->exited, fo->exited_all, status, rank);
+}
+
+void fanout_failed (struct fanout *fo, uint32_t rank, int errnum)
+{
+    fanout_finish_rank (fo, fo->failed, fo->failed_all, errnum, rank);
+}
+
+void fanout_output (struct fanout *fo,
+                    uint32_t rank,
+                    const char *stream,
+                    const char *data,
+                    int len)
+{
+    struct idset *ids;
+
+    if (!(ids = idset_create (0, IDSET_FLAG_AUTOGROW))
+        || idset_set (ids, rank) < 0) {
+        flux_log_error (fo->h, "%s: dropped %s line", fo->prefix, stream);
+        idset_destroy (ids);
+        return;
+    }
+    fanout_output_append (fo, ids, stream, data, len);
+    idset_destroy (ids);
+}
+
+static void forward_output (struct fanout *fo, json_t *output)
+{
+    size_t index;
+    json_t *entry;
+
+    json_array_foreach (output, index, entry) {
+        const char *ranks;
+        const char *stream;
+        const char *data;
+        size_t len;
+        struct idset *ids;
+
+        if (json_unpack (entry, "[s s s%]", &ranks, &stream, &data, &len) < 0
+            || !(ids = idset_decode (ranks))) {
+            flux_log (fo->h, LOG_ERR, "%s: bad output entry", fo->prefix);
+            continue;
+        }
+        fanout_output_append (fo, ids, stream, data, len);
+        idset_destroy (ids);
+    }
+}
+
+static void forward_continuation (flux_future_t *f, void *arg)
+{
+    struct fanout *fo = arg;
+    struct fanout_forward *fwd = flux_future_aux_get (f, "forward");
+    const char *started = NULL;
+    json_t *exited = NULL;
+    json_t *failed = NULL;
+    json_t *output = NULL;
+
+    if (flux_rpc_get_unpack (f,
+                             "{s?s s?o s?o s?o}",
+                             "started", &started,
+                             "exited", &exited,
+                             "failed", &failed,
+                             "output", &output) < 0) {
+        if (errno != ENODATA) {
+            /* The child broker or its service is gone.  Any ranks in its
+             * subtree that have not finished never will.
+             */
+            struct idset *lost = idset_intersect (fo->pending, fwd->subset);
+            if (lost && idset_count (lost) > 0)
+                fanout_fail (fo, lost, errno);
+            idset_destroy (lost);
+        }
+        if (zlistx_find (fo->forwards, f))
+            zlistx_delete (fo->forwards, NULL);
+        fanout_update (fo);
+        return;
+    }
+    if ((started && idset_decode_add (fo->started, started, -1, NULL) < 0)
+        || (started
+            && fo->started_all
+            && idset_decode_add (fo->started_all, started, -1, NULL) < 0))
+        flux_log_error (fo->h, "%s: bad update", fo->prefix);
+    if (output)
+        forward_output (fo, output);
+    if ((exited && group_merge (fo, fo->exited, fo->exited_all, exited) < 0)
+        || (failed && group_merge (fo, fo->failed, fo->failed_all, failed) < 0))
+        flux_log_error (fo->h, "%s: bad update", fo->prefix);
+    flux_future_reset (f);
+    fanout_update (fo);
+}
+
+static int forward_one (struct fanout *fo,
+                        struct fanout_child *child,
+                        const char *topic,
+                        json_t *request)
+{
+    struct fanout_forward *fwd;
+    char *s = NULL;
+    json_t *o = NULL;
+    flux_future_t *f = NULL;
+
+    if (!(fwd = calloc (1, sizeof (*fwd))))
+        return -1;
+    fwd->rank = child->rank;
+    if (!(fwd->subset = idset_intersect (fo->pending, child->subtree)))
+        goto error;
+    if (idset_count (fwd->subset) == 0) {
+        forward_destroy (fwd);
+        return 0;
+    }
+    if (!(s = idset_encode (fwd->subset, IDSET_FLAG_RANGE))
+        || !(o = json_copy (request))
+        || json_object_set_new (o, "ranks", json_string (s)) < 0)
+        goto error;
+    if (!(f = flux_rpc_pack (fo->h,
+                             topic,
+                             child->rank,
+                             FLUX_RPC_STREAMING,
+                             "O",
+                             o))
+        || flux_future_aux_set (f,
+                                "forward",
+                                fwd,
+                                (flux_free_f)forward_destroy) < 0)
+        goto error;
+    fwd = NULL;
+    if (flux_future_then (f, -1., forward_continuation, fo) < 0
+        || !zlistx_add_end (fo->forwards, f))
+        goto error;
+    json_decref (o);
+    free (s);
+    return 0;
+error:
+    forward_destroy (fwd);
+    flux_future_destroy (f);
+    json_decref (o);
+    free (s);
+    return -1;
+}
+
+void fanout_forward (struct fanout *fo,
+                     zlistx_t *children,
+                     const char *topic,
+                     json_t *request)
+{
+    struct fanout_child *child;
+
+    child = zlistx_first (children);
+    while (child) {
+        if (forward_one (fo, child, topic, request) < 0) {
+            struct idset *subset = idset_intersect (fo->pending,
+                                                    child->subtree);
+            flux_log_error (fo->h,
+                            "%s: forward to rank %lu",
+                            fo->prefix,
+                            (unsigned long)child->rank);
+            if (subset)
+                fanout_fail (fo, subset, errno);
+            idset_destroy (subset);
+        }
+        child = zlistx_next (children);
+    }
+    fanout_update (fo);
+}
+
+void fanout_forward_control (struct fanout *fo, const char *topic, json_t *o)
+{
+    flux_future_t *f;
+
+    f = zlistx_first (fo->forwards);
+    while (f) {
+        struct fanout_forward *fwd = flux_future_aux_get (f, "forward");
+        flux_future_t *f2;
+
+        if (!(f2 = flux_rpc_pack (fo->h,
+                                  topic,
+                                  fwd->rank,
+                                  FLUX_RPC_NORESPONSE,
+                                  "O",
+                                  o)))
+            flux_log_error (fo->h,
+                            "%s: error forwarding %s to rank %lu",
+                            fo->prefix,
+                            topic,
+                            (unsigned long)fwd->rank);
+        flux_future_destroy (f2);
+        f = zlistx_next (fo->forwards);
+    }
+}
+
+const flux_msg_t *fanout_get_msg (struct fanout *fo)
+{
+    return fo->msg;
+}
+
+const struct idset *fanout_pending (struct fanout *fo)
+{
+    return fo->pending;
+}
+
+void fanout_mute (struct fanout *fo)
+{
+    fo->muted = true;
+}
+
+void fanout_suspend (struct fanout *fo)
+{
+    fo->suspended = true;
+}
+
+int fanout_reattach (struct fanout *fo, const flux_msg_t *msg)
+{
+    if (!(fo->flags & FANOUT_HISTORY)) {
+        errno = EINVAL;
+        return -1;
+    }
+    flux_msg_decref (fo->msg);
+    fo->msg = flux_msg_incref (msg);
+    fo->suspended = false;
+    fo->muted = false;
+    fanout_update (fo);
+    if (idset_add (fo->started, fo->started_all) < 0
+        || group_add_all (fo->exited, fo->exited_all) < 0
+        || group_add_all (fo->failed, fo->failed_all) < 0)
+        return -1;
+    return 0;
+}
+
+void fanout_destroy (struct fanout *fo)
+{
+    if (fo) {
+        int saved_errno = errno;
+        zlistx_destroy (&fo->forwards);
+        flux_msg_decref (fo->msg);
+        idset_destroy (fo->pending);
+        idset_destroy (fo->started);
+        zhashx_destroy (&fo->exited);
+        zhashx_destroy (&fo->failed);
+        for (int i = 0; i < fo->output_count; i++)
+            output_destroy (fo->output[i]);
+        free (fo->output);
+        zhashx_destroy (&fo->output_index);
+        idset_destroy (fo->started_all);
+        zhashx_destroy (&fo->exited_all);
+        zhashx_destroy (&fo->failed_all);
+        flux_watcher_destroy (fo->timer);
+        free (fo->prefix);
+        free (fo);
+        errno = saved_errno;
+    }
+}
+
+struct fanout *fanout_create (flux_t *h,
+                              const flux_msg_t *msg,
+                              const char *ranks,
+                              int flags,
+                              const char *prefix,
+                              fanout_done_f cb,
+                              void *arg)
+{
+    struct fanout *fo;
+    flux_reactor_t *r = flux_get_reactor (h);
+
+    if (!(fo = calloc (1, sizeof (*fo))))
+        return NULL;
+    fo->h = h;
+    fo->msg = flux_msg_incref (msg);
+    fo->flags = flags;
+    fo->cb = cb;
+    fo->cb_arg = arg;
+    if (!(fo->prefix = strdup (prefix))
+        || !(fo->pending = idset_decode (ranks))
+        || !(fo->started = idset_create (0, IDSET_FLAG_AUTOGROW))
+        || !(fo->exited = zhashx_new ())
+        || !(fo->failed = zhashx_new ())
+        || !(fo->output_index = zhashx_new ())
+        || !(fo->forwards = zlistx_new ())
+        || !(fo->timer = flux_timer_watcher_create (r,
+                                                    FANOUT_BATCH_TIMEOUT,
+                                                    0.,
+                                                    timer_cb,
+                                                    fo)))
+        goto nomem;
+    zhashx_set_destructor (fo->exited, idset_destructor);
+    zhashx_set_destructor (fo->failed, idset_destructor);
+    zlistx_set_destructor (fo->forwards, future_destructor);
+    if ((flags & FANOUT_HISTORY)) {
+        if (!(fo->started_all = idset_create (0, IDSET_FLAG_AUTOGROW))
+            || !(fo->exited_all = zhashx_new ())
+            || !(fo->failed_all = zhashx_new ()))
+            goto nomem;
+        zhashx_set_destructor (fo->exited_all, idset_destructor);
+        zhashx_set_destructor (fo->failed_all, idset_destructor);
+    }
+    return fo;
+nomem:
+    fanout_destroy (fo);
+    errno = ENOMEM;
+    return NULL;
+}
+
+// vi: ts=4 sw=4 expandtab
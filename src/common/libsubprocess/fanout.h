@@ -0,0 +1,124 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _SUBPROCESS_FANOUT_H
+#define _SUBPROCESS_FANOUT_H
+
+#include <jansson.h>
+#include <flux/core.h>
+#include <flux/idset.h>
+
+#include "src/common/libczmqcontainers/czmq_containers.h"
+
+/* Fan-out of one launch request over the TBON, shared by the bulk launch
+ * service of the subprocess server (bulk_server.c) and the tree launch
+ * service of job-exec (tree-exec.c).
+ *
+ * A fanout tracks the ranks of a launch in the subtree of this broker
+ * that have not finished, forwards the request to the children with
+ * ranks of the launch in their subtree, and batches state changes from
+ * the children and the local process into one streaming response to
+ * the requestor every FANOUT_BATCH_TIMEOUT seconds:
+ *
+ *   {"started"?:s "exited"?:{status:s} "failed"?:{errnum:s}
+ *    "output"?:[[ranks,stream,data],...]}
+ *
+ * where rank sets are RFC 22 idsets grouped by wait status or errno.
+ * Identical output lines from different ranks in a batch are merged into
+ * one entry, as long as that keeps the lines of each rank in order.
+ * Once every rank has exited or failed, ENODATA ends the stream and the
+ * done callback is called, which may destroy the fanout.
+ */
+
+#define FANOUT_BATCH_TIMEOUT 0.01
+
+enum {
+    FANOUT_HISTORY = 1,     // retain all state changes for fanout_reattach()
+};
+
+/* Build the list of children of this broker, with the ranks in each
+ * child's subtree, from its overlay.topology object 'topo'.
+ */
+zlistx_t *fanout_children_create (json_t *topo);
+
+/* Return true if every rank in 'ranks' is 'rank' or in the subtree of
+ * one of 'children'.
+ */
+bool fanout_children_cover (zlistx_t *children,
+                            uint32_t rank,
+                            const struct idset *ranks);
+
+struct fanout;
+
+typedef void (*fanout_done_f)(struct fanout *fo, void *arg);
+
+/* Create a fanout of request 'msg' to 'ranks'.  'prefix' is prepended
+ * to log messages.
+ */
+struct fanout *fanout_create (flux_t *h,
+                              const flux_msg_t *msg,
+                              const char *ranks,
+                              int flags,
+                              const char *prefix,
+                              fanout_done_f cb,
+                              void *arg);
+void fanout_destroy (struct fanout *fo);
+
+const flux_msg_t *fanout_get_msg (struct fanout *fo);
+
+/* Ranks of the launch in this subtree that have not exited or failed.
+ */
+const struct idset *fanout_pending (struct fanout *fo);
+
+/* Send 'request' to 'topic' on each of 'children' with ranks of the
+ * launch in its subtree, with "ranks" set to those ranks.  If that fails,
+ * the ranks fail with errno.
+ */
+void fanout_forward (struct fanout *fo,
+                     zlistx_t *children,
+                     const char *topic,
+                     json_t *request);
+
+/* Send 'o' to 'topic' on each child with a forwarded request that has
+ * not finished, e.g. to write to or signal the processes.  No response
+ * is expected.
+ */
+void fanout_forward_control (struct fanout *fo, const char *topic, json_t *o);
+
+/* Record a state change of the process on 'rank', normally the local
+ * process, for the next batch.
+ */
+void fanout_started (struct fanout *fo, uint32_t rank);
+void fanout_exited (struct fanout *fo, uint32_t rank, int status);
+void fanout_failed (struct fanout *fo, uint32_t rank, int errnum);
+void fanout_output (struct fanout *fo,
+                    uint32_t rank,
+                    const char *stream,
+                    const char *data,
+                    int len);
+
+/* Stop responding to the requestor, e.g. after it disconnected.  The
+ * fanout still finishes once all ranks are done.
+ */
+void fanout_mute (struct fanout *fo);
+
+/* Hold state changes until fanout_reattach() is called, e.g. after the
+ * requestor disconnected while the processes should keep running.
+ */
+void fanout_suspend (struct fanout *fo);
+
+/* Respond to 'msg' from now on, starting with all state changes since
+ * the fanout was created.  Requires FANOUT_HISTORY.
+ */
+int fanout_reattach (struct fanout *fo, const flux_msg_t *msg);
+
+#endif /* !_SUBPROCESS_FANOUT_H */
+
+// vi: ts=4 sw=4 expandtab
@@ -8,36 +8,104 @@
  * SPDX-License-Identifier: LGPL-3.0
 \************************************************************/
 
+/* fbuf.c - buffer for subprocess I/O
+ *
+ * Data is kept in a ring whose memory is mapped twice, back to back,
+ * so the unread data is always contiguous in virtual memory even when
+ * it wraps around the end of the ring.  Reads return a pointer directly
+ * into the ring, and transfers to and from file descriptors are a
+ * single read(2) or write(2).
+ *
+ * Returned data is NUL terminated by temporarily replacing the first
+ * unread byte, if any, with a NUL.  The byte is put back by the next
+ * call that accesses the data.
+ *
+ * If the mirrored mapping cannot be created, a plain buffer is used,
+ * and unread data is moved to the start of it when a write would run
+ * past the end.
+ *
+ * The ring is rewound whenever it becomes empty, so a consumer that
+ * keeps up only touches the first pages of a large buffer.
+ */
+
 #if HAVE_CONFIG_H
 #include "config.h"
 #endif
+#include <sys/mman.h>
 #include <assert.h>
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
 
 #include "fbuf.h"
 
-#include "src/common/liblsd/cbuf.h"
-
-#define FBUF_MIN   4096
-
 struct fbuf {
     int size;
     bool readonly;
-    cbuf_t cbuf;
-    char *buf;                  /* internal buffer for user reads */
-    int buflen;
+    char *base;
+    int cap;                    /* capacity, > size if mirrored */
+    bool mirrored;              /* base maps the ring twice */
+    int tail;                   /* offset of first unread byte */
+    int used;
+    int nul_pos;                /* offset of byte replaced by NUL, or -1 */
+    char nul_saved;
     fbuf_notify_f cb;
     void *cb_arg;
 };
 
+static int mirror_create (struct fbuf *fb)
+{
+    long pagesize = sysconf (_SC_PAGESIZE);
+    void *base;
+    int fd;
+
+    if (pagesize <= 0)
+        pagesize = 4096;
+    fb->cap = ((fb->size + 1 + pagesize - 1) / pagesize) * pagesize;
+
+    if ((fd = memfd_create ("flux-fbuf", MFD_CLOEXEC)) < 0)
+        return -1;
+    if (ftruncate (fd, fb->cap) < 0)
+        goto error;
+    base = mmap (NULL,
+                 2 * fb->cap,
+                 PROT_NONE,
+                 MAP_PRIVATE | MAP_ANONYMOUS,
+                 -1,
+                 0);
+    if (base == MAP_FAILED)
+        goto error;
+    if (mmap (base,
+              fb->cap,
+              PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_FIXED,
+              fd,
+              0) == MAP_FAILED
+        || mmap ((char *)base + fb->cap,
+                 fb->cap,
+                 PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_FIXED,
+                 fd,
+                 0) == MAP_FAILED) {
+        munmap (base, 2 * fb->cap);
+        goto error;
+    }
+    close (fd);
+    fb->base = base;
+    fb->mirrored = true;
+    return 0;
+error:
+    close (fd);
+    return -1;
+}
+
 struct fbuf *fbuf_create (int size)
 {
     struct fbuf *fb = NULL;
-    int minsize = FBUF_MIN;
 
     if (size <= 0) {
         errno = EINVAL;
@@ -48,24 +116,15 @@ struct fbuf *fbuf_create (int size)
         goto cleanup;
 
     fb->size = size;
-    if (size < FBUF_MIN)
-        minsize = size;
-    else
-        minsize = FBUF_MIN;
     fb->readonly = false;
+    fb->nul_pos = -1;
 
-    /* buffer can grow to size specified by user */
-    if (!(fb->cbuf = cbuf_create (minsize, fb->size)))
-        goto cleanup;
-
-    if (cbuf_opt_set (fb->cbuf, CBUF_OPT_OVERWRITE, CBUF_NO_DROP) < 0)
-        goto cleanup;
-
-    /* +1 for possible NUL on line reads */
-    fb->buflen = minsize + 1;
-
-    if (!(fb->buf = malloc (fb->buflen)))
-        goto cleanup;
+    if (mirror_create (fb) < 0) {
+        /* +1 for NUL after a full buffer */
+        fb->cap = size;
+        if (!(fb->base = malloc (fb->cap + 1)))
+            goto cleanup;
+    }
 
     return fb;
 
@@ -87,9 +146,10 @@ void fbuf_destroy (void *data)
     struct fbuf *fb = data;
     if (fb) {
         int saved_errno = errno;
-        if (fb->cbuf)
-            cbuf_destroy (fb->cbuf);
-        free (fb->buf);
+        if (fb->mirrored)
+            munmap (fb->base, 2 * fb->cap);
+        else
+            free (fb->base);
         free (fb);
         errno = saved_errno;
     }
@@ -112,7 +172,7 @@ int fbuf_bytes (struct fbuf *fb)
         return -1;
     }
 
-    return cbuf_used (fb->cbuf);
+    return fb->used;
 }
 
 int fbuf_space (struct fbuf *fb)
@@ -122,7 +182,7 @@ int fbuf_space (struct fbuf *fb)
         return -1;
     }
 
-    return cbuf_free (fb->cbuf);
+    return fb->size - fb->used;
 }
 
 int fbuf_readonly (struct fbuf *fb)
@@ -147,7 +207,7 @@ bool fbuf_is_readonly (struct fbuf *fb)
 
 static void nonempty_transition_check (struct fbuf *fb, bool was_empty)
 {
-    if (was_empty && cbuf_used (fb->cbuf) > 0) {
+    if (was_empty && fb->used > 0) {
         if (fb->cb)
             fb->cb (fb, fb->cb_arg);
     }
@@ -155,77 +215,94 @@ static void nonempty_transition_check (struct fbuf *fb, bool was_empty)
 
 static void nonfull_transition_check (struct fbuf *fb, bool was_full)
 {
-    if (was_full && cbuf_free (fb->cbuf) > 0) {
+    if (was_full && fb->used < fb->size) {
         if (fb->cb)
             fb->cb (fb, fb->cb_arg);
     }
 }
 
-/* check if internal buffer can hold data from user */
-static int return_buffer_check (struct fbuf *fb)
+/* Put back the byte replaced by a NUL on the last read, if any.
+ */
+static void restore_nul (struct fbuf *fb)
 {
-    int used = cbuf_used (fb->cbuf);
-
-    if (used < 0)
-        return -1;
-
-    assert (used <= fb->size);
+    if (fb->nul_pos >= 0) {
+        fb->base[fb->nul_pos] = fb->nul_saved;
+        fb->nul_pos = -1;
+    }
+}
 
-    /* +1 for potential NUL char */
-    if (fb->buflen < (used + 1)) {
-        size_t newsize = fb->buflen;
-        char *newbuf;
+/* Mark [len] bytes at the tail as consumed.
+ */
+static void advance (struct fbuf *fb, int len)
+{
+    fb->used -= len;
+    if (fb->used > 0) {
+        fb->tail += len;
+        if (fb->mirrored && fb->tail >= fb->cap)
+            fb->tail -= fb->cap;
+    }
+    else
+        fb->tail = 0;
+}
 
-        while ((newsize < (used + 1))) {
-            newsize = (newsize - 1) * 2 + 1;
-            if (newsize > (fb->size + 1))
-                newsize = fb->size + 1;
-        }
+/* Mark [len] bytes at the tail as consumed, NUL terminate them, and
+ * return a pointer to them.
+ */
+static char *consume (struct fbuf *fb, int len)
+{
+    char *ptr = fb->base + fb->tail;
 
-        if (!(newbuf = realloc (fb->buf, newsize)))
-            return -1;
-        fb->buf = newbuf;
-        fb->buflen = newsize;
+    advance (fb, len);
+    if (fb->used > 0) {
+        fb->nul_pos = ptr + len - fb->base;
+        fb->nul_saved = ptr[len];
     }
+    ptr[len] = '\0';
+    return ptr;
+}
 
-    return 0;
+/* Return a pointer to [len] bytes of contiguous free space following
+ * the unread data.
+ */
+static char *write_ptr (struct fbuf *fb, int len)
+{
+    if (!fb->mirrored && fb->tail + fb->used + len > fb->cap) {
+        memmove (fb->base, fb->base + fb->tail, fb->used);
+        fb->tail = 0;
+    }
+    return fb->base + fb->tail + fb->used;
 }
 
 const void *fbuf_read (struct fbuf *fb, int len, int *lenp)
 {
-    int ret;
+    bool full;
+    char *ptr;
 
     if (!fb) {
         errno = EINVAL;
         return NULL;
     }
 
-    if (return_buffer_check (fb) < 0)
-        return NULL;
-
-    if (len < 0)
-        len = cbuf_used (fb->cbuf);
+    restore_nul (fb);
 
-    if (len > fb->buflen)
-        len = fb->buflen;
+    if (len < 0 || len > fb->used)
+        len = fb->used;
 
-    bool full = cbuf_free (fb->cbuf) == 0 ? true : false;
+    full = fb->used == fb->size ? true : false;
 
-    if ((ret = cbuf_read (fb->cbuf, fb->buf, len)) < 0)
-        return NULL;
-    fb->buf[ret] = '\0';
+    ptr = consume (fb, len);
 
     if (lenp)
-        (*lenp) = ret;
+        (*lenp) = len;
 
     nonfull_transition_check (fb, full);
 
-    return fb->buf;
+    return ptr;
 }
 
 int fbuf_write (struct fbuf *fb, const void *data, int len)
 {
-    int ret;
+    bool empty;
 
     if (!fb || !data || len < 0) {
         errno = EINVAL;
@@ -237,83 +314,115 @@ int fbuf_write (struct fbuf *fb, const void *data, int len)
         return -1;
     }
 
-    bool empty = cbuf_is_empty (fb->cbuf);
-
-    if ((ret = cbuf_write (fb->cbuf, (void *)data, len, NULL)) < 0)
+    if (len > fb->size - fb->used) {
+        errno = ENOSPC;
         return -1;
+    }
+
+    restore_nul (fb);
+
+    empty = fb->used == 0 ? true : false;
+
+    memcpy (write_ptr (fb, len), data, len);
+    fb->used += len;
 
     nonempty_transition_check (fb, empty);
 
-    return ret;
+    return len;
+}
+
+/* Return the length of the first line in the buffer including the
+ * newline, or 0 if there is no complete line.
+ */
+static int line_length (struct fbuf *fb)
+{
+    char *nl;
+
+    if (fb->used == 0
+        || !(nl = memchr (fb->base + fb->tail, '\n', fb->used)))
+        return 0;
+    return nl - (fb->base + fb->tail) + 1;
 }
 
 bool fbuf_has_line (struct fbuf *fb)
 {
-    char buf[1];
     if (!fb) {
         errno = EINVAL;
         return false;
     }
-    return (cbuf_peek_line (fb->cbuf, buf, 0, 1) > 0);
+    restore_nul (fb);
+    return line_length (fb) > 0;
 }
 
 const void *fbuf_read_line (struct fbuf *fb, int *lenp)
 {
-    int ret;
+    bool full;
+    char *ptr;
+    int len;
 
     if (!fb) {
         errno = EINVAL;
         return NULL;
     }
 
-    if (return_buffer_check (fb) < 0)
-        return NULL;
+    restore_nul (fb);
 
-    bool full = cbuf_free (fb->cbuf) == 0 ? true : false;
+    len = line_length (fb);
 
-    if ((ret = cbuf_read_line (fb->cbuf, fb->buf, fb->buflen, 1)) < 0)
-        return NULL;
+    full = fb->used == fb->size ? true : false;
+
+    ptr = consume (fb, len);
 
     if (lenp)
-        (*lenp) = ret;
+        (*lenp) = len;
 
     nonfull_transition_check (fb, full);
 
-    return fb->buf;
+    return ptr;
 }
 
 const void *fbuf_read_trimmed_line (struct fbuf *fb, int *lenp)
 {
     int tmp_lenp = 0;
+    char *ptr;
 
-    if (!fbuf_read_line (fb, &tmp_lenp))
+    if (!(ptr = (char *)fbuf_read_line (fb, &tmp_lenp)))
         return NULL;
 
     if (tmp_lenp) {
-        if (fb->buf[tmp_lenp - 1] == '\n') {
-            fb->buf[tmp_lenp - 1] = '\0';
+        if (ptr[tmp_lenp - 1] == '\n') {
+            ptr[tmp_lenp - 1] = '\0';
             tmp_lenp--;
         }
     }
     if (lenp)
         (*lenp) = tmp_lenp;
 
-    return fb->buf;
+    return ptr;
 }
 
 int fbuf_read_to_fd (struct fbuf *fb, int fd, int len)
 {
+    bool full;
     int ret;
 
-    if (!fb) {
+    if (!fb || fd < 0) {
         errno = EINVAL;
         return -1;
     }
 
-    bool full = cbuf_free (fb->cbuf) == 0 ? true : false;
+    restore_nul (fb);
+
+    if (len < 0 || len > fb->used)
+        len = fb->used;
+    if (len == 0)
+        return 0;
 
-    if ((ret = cbuf_read_to_fd (fb->cbuf, fd, len)) < 0)
+    full = fb->used == fb->size ? true : false;
+
+    if ((ret = write (fd, fb->base + fb->tail, len)) < 0)
         return -1;
+    advance (fb, ret);
 
     nonfull_transition_check (fb, full);
 
@@ -322,9 +431,11 @@ int fbuf_read_to_fd (struct fbuf *fb, int fd, int len)
 
 int fbuf_write_from_fd (struct fbuf *fb, int fd, int len)
 {
+    bool empty;
+    int space;
     int ret;
 
-    if (!fb) {
+    if (!fb || fd < 0) {
         errno = EINVAL;
         return -1;
     }
@@ -334,10 +445,19 @@ int fbuf_write_from_fd (struct fbuf *fb, int fd, int len)
         return -1;
     }
 
-    bool empty = cbuf_is_empty (fb->cbuf);
+    restore_nul (fb);
+
+    space = fb->size - fb->used;
+    if (len < 0 || len > space)
+        len = space;
+    if (len == 0)
+        return 0;
+
+    empty = fb->used == 0 ? true : false;
 
-    if ((ret = cbuf_write_from_fd (fb->cbuf, fd, len, NULL)) < 0)
+    if ((ret = read (fd, write_ptr (fb, len), len)) < 0)
         return -1;
+    fb->used += ret;
 
     nonempty_transition_check (fb, empty);
 
@@ -13,8 +13,13 @@
 #endif
 
 #include <sys/wait.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #include <errno.h>
+#include <signal.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
 
 #include <flux/core.h>
 
@@ -32,15 +37,16 @@ static int sigmask_unblock_all (void)
     return sigprocmask (SIG_SETMASK, &mask, NULL);
 }
 
+/* N.B. channel fds are not reset to -1 since a vforked child shares
+ * memory with the parent.
+ */
 static void close_parent_fds (flux_subprocess_t *p)
 {
     struct subprocess_channel *c;
     c = zhash_first (p->channels);
     while (c) {
-        if (c->parent_fd >= 0) {
+        if (c->parent_fd >= 0)
             close (c->parent_fd);
-            c->parent_fd = -1;
-        }
         c = zhash_next (p->channels);
     }
 }
@@ -88,24 +94,12 @@ static void local_child_report_exec_failed_errno (flux_subprocess_t *p, int e)
                  strerror (errno));
 }
 
-#if CODE_COVERAGE_ENABLED
-void __gcov_dump (void);
-void __gcov_reset (void);
-#endif
-static int local_child (flux_subprocess_t *p)
+/* Redirect stdio to channels and change working directory in the child.
+ */
+static void child_setup (flux_subprocess_t *p)
 {
     struct subprocess_channel *c;
-    int errnum;
-    char **argv;
     const char *cwd;
-    struct idset *ids;
-
-    /* Throughout this function use _exit() instead of exit(), to
-     * avoid calling any atexit() routines of parent.
-     *
-     * Call fprintf instead of llog_error(), errors in child
-     * should go to parent error streams.
-     */
 
     if (sigmask_unblock_all () < 0)
         fprintf (stderr, "sigprocmask: %s\n", strerror (errno));
@@ -147,10 +141,14 @@ static int local_child (flux_subprocess_t *p)
         if (chdir ("/tmp") < 0)
             _exit (1);
     }
+}
 
-    // Send ready to parent
-    if (local_child_ready (p) < 0)
-        _exit (1);
+/* Close fds the child should not inherit, run the pre_exec hook, and
+ * call setpgrp(2) if requested.
+ */
+static void child_prepare_exec (flux_subprocess_t *p)
+{
+    struct idset *ids;
 
     // Close fds
     if (!(ids = subprocess_childfds (p))
@@ -173,6 +171,31 @@ static int local_child (flux_subprocess_t *p)
             _exit (1);
         }
     }
+}
+
+#if CODE_COVERAGE_ENABLED
+void __gcov_dump (void);
+void __gcov_reset (void);
+#endif
+static int local_child (flux_subprocess_t *p)
+{
+    int errnum;
+    char **argv;
+
+    /* Throughout this function use _exit() instead of exit(), to
+     * avoid calling any atexit() routines of parent.
+     *
+     * Call fprintf instead of llog_error(), errors in child
+     * should go to parent error streams.
+     */
+
+    child_setup (p);
+
+    // Send ready to parent
+    if (local_child_ready (p) < 0)
+        _exit (1);
+
+    child_prepare_exec (p);
 
     environ = cmd_env_expand (p->cmd);
     argv = cmd_argv_expand (p->cmd);
@@ -291,6 +314,135 @@ int create_process_fork (flux_subprocess_t *p)
     return local_exec (p);
 }
 
+#ifdef __linux__
+/* Stack for the vforked child.  Pages are only allocated when touched,
+ * so be generous since pre_exec hooks may run arbitrary plugin code.
+ */
+static const size_t vfork_stack_size = 8 * 1024 * 1024;
+
+struct vfork_arg {
+    flux_subprocess_t *p;
+    char **env;
+    char **argv;
+    int errnum;
+};
+
+/* Reset signal handlers to default in the child, so that a signal
+ * delivered before exec(2) does not run a parent handler on the
+ * shared memory.
+ */
+static void child_reset_signals (void)
+{
+    struct sigaction sa;
+
+    for (int i = 1; i < NSIG; i++) {
+        if (sigaction (i, NULL, &sa) == 0
+            && sa.sa_handler != SIG_IGN
+            && sa.sa_handler != SIG_DFL) {
+            sa.sa_handler = SIG_DFL;
+            sa.sa_flags = 0;
+            (void)sigaction (i, &sa, NULL);
+        }
+    }
+}
+
+/* The child shares memory with the parent, which is suspended until
+ * exec(2) or _exit(2), so it must not modify anything the parent relies
+ * on (e.g. 'environ'), and reports exec failure in 'arg'.
+ */
+static int vfork_child (void *data)
+{
+    struct vfork_arg *arg = data;
+    flux_subprocess_t *p = arg->p;
+
+    child_reset_signals ();
+    child_setup (p);
+    child_prepare_exec (p);
+
+    arg->env = cmd_env_expand (p->cmd);
+    arg->argv = cmd_argv_expand (p->cmd);
+    if (!arg->env || !arg->argv) {
+        arg->errnum = ENOMEM;
+        _exit (1);
+    }
+#if CODE_COVERAGE_ENABLED
+    __gcov_dump ();
+    __gcov_reset ();
+#endif
+    execvpe (arg->argv[0], arg->argv, arg->env);
+    arg->errnum = errno;
+    _exit (1);
+}
+
+int create_process_vfork (flux_subprocess_t *p)
+{
+    struct vfork_arg arg = { .p = p };
+    sigset_t all;
+    sigset_t saved;
+    void *stack;
+    pid_t pid;
+    int saved_errno;
+
+    if ((stack = mmap (NULL,
+                       vfork_stack_size,
+                       PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK,
+                       -1,
+                       0)) == MAP_FAILED)
+        return -1;
+
+    /* Block signals so that no handler runs in the child before it has
+     * reset them.  The child unblocks them in child_setup().
+     */
+    sigfillset (&all);
+    sigprocmask (SIG_BLOCK, &all, &saved);
+    pid = clone (vfork_child,
+                 (char *)stack + vfork_stack_size,
+                 CLONE_VM | CLONE_VFORK | SIGCHLD,
+                 &arg);
+    saved_errno = errno;
+    sigprocmask (SIG_SETMASK, &saved, NULL);
+    munmap (stack, vfork_stack_size);
+
+    /* env and argv were allocated by the child in our memory.
+     */
+    free (arg.env);
+    free (arg.argv);
+
+    if (pid < 0) {
+        errno = saved_errno;
+        return -1;
+    }
+    p->pid = pid;
+    p->pid_set = true;
+
+    /* The child is done with the sync fds, which are only used
+     * by create_process_fork().
+     */
+    close (p->sync_fds[1]);
+    p->sync_fds[1] = -1;
+    close (p->sync_fds[0]);
+    p->sync_fds[0] = -1;
+
+    if (arg.errnum != 0) {
+        int status;
+        /*  Reap child immediately, as in local_exec().
+         */
+        if (waitpid (p->pid, &status, 0) <= 0)
+            return -1;
+        p->status = status;
+        errno = arg.errnum;
+        return -1;
+    }
+    return 0;
+}
+#else
+int create_process_vfork (flux_subprocess_t *p)
+{
+    return create_process_fork (p);
+}
+#endif
+
 /*
  * vi: ts=4 sw=4 expandtab
  */
@@ -15,6 +15,12 @@
 
 int create_process_fork (flux_subprocess_t *p);
 
+/* Like create_process_fork(), but use clone(CLONE_VM|CLONE_VFORK) to avoid
+ * copying the page tables of a large parent.  Falls back to fork(2) where
+ * clone(2) is unavailable.
+ */
+int create_process_vfork (flux_subprocess_t *p);
+
 #endif /* !_SUBPROCESS_FORK_H */
 
 // vi: ts=4 sw=4 expandtab
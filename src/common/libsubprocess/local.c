@@ -418,6 +418,8 @@ static int create_process (flux_subprocess_t *p)
         && !p->hooks.pre_exec
         && !flux_cmd_getcwd (p->cmd))
         return create_process_spawn (p);
+    if ((p->flags & FLUX_SUBPROCESS_FLAGS_VFORK_EXEC))
+        return create_process_vfork (p);
     return create_process_fork (p);
 }
 
@@ -312,6 +312,32 @@ static void remote_out_prep_cb (flux_reactor_t *r,
         flux_watcher_start (c->out_idle_w);
 }
 
+/* Grant the server credit for output the caller has consumed, once
+ * a quarter of the window has been consumed, so the server can keep
+ * sending while the rest of the window drains.
+ */
+static void remote_grant_credit (struct subprocess_channel *c, int consumed)
+{
+    flux_subprocess_t *p = c->p;
+
+    if (p->credit_window == 0 || consumed <= 0)
+        return;
+    p->credit_consumed += consumed;
+    if (p->credit_consumed < p->credit_window / 4)
+        return;
+    if (subprocess_credit (p->h,
+                           p->service_name,
+                           p->rank,
+                           p->pid,
+                           p->credit_consumed) < 0) {
+        llog_debug (p,
+                    "error sending rexec.credit request: %s",
+                    strerror (errno));
+        return;
+    }
+    p->credit_consumed = 0;
+}
+
 static void remote_out_check_cb (flux_reactor_t *r,
                                  flux_watcher_t *w,
                                  int revents,
@@ -326,7 +352,11 @@ static void remote_out_check_cb (flux_reactor_t *r,
              || (c->read_eof_received
                  && fbuf_bytes (c->read_buffer) > 0)))
         || (!c->line_buffered && fbuf_bytes (c->read_buffer) > 0)) {
+        int bytes = fbuf_bytes (c->read_buffer);
+
         c->output_cb (c->p, c->name);
+
+        remote_grant_credit (c, bytes - fbuf_bytes (c->read_buffer));
     }
 
     if (!fbuf_bytes (c->read_buffer)
@@ -646,6 +676,26 @@ error:
     remote_kill_nowait (p, SIGKILL);
 }
 
+/* Limit output in flight to the smallest read buffer, so that the
+ * server stops reading before any buffer can overflow.
+ */
+static int remote_credit_window (flux_subprocess_t *p)
+{
+    struct subprocess_channel *c;
+    int window = 0;
+
+    c = zhash_first (p->channels);
+    while (c) {
+        if (c->read_buffer) {
+            int size = fbuf_size (c->read_buffer);
+            if (window == 0 || window > size)
+                window = size;
+        }
+        c = zhash_next (p->channels);
+    }
+    return window;
+}
+
 int remote_exec (flux_subprocess_t *p)
 {
     flux_future_t *f;
@@ -658,7 +708,15 @@ int remote_exec (flux_subprocess_t *p)
     if (p->ops.on_stderr)
         flags |= SUBPROCESS_REXEC_STDERR;
 
-    if (!(f = subprocess_rexec (p->h, p->service_name, p->rank, p->cmd, flags))
+    p->credit_window = remote_credit_window (p);
+    p->credit_consumed = 0;
+
+    if (!(f = subprocess_rexec (p->h,
+                                p->service_name,
+                                p->rank,
+                                p->cmd,
+                                flags,
+                                p->credit_window))
         || flux_future_then (f, -1., rexec_continuation, p) < 0) {
         llog_debug (p,
                     "error sending rexec.exec request: %s",
@@ -28,6 +28,7 @@
 #include "subprocess_private.h"
 #include "command_private.h"
 #include "server.h"
+#include "server_private.h"
 #include "client.h"
 
 /* Keys used to store subprocess server, rexec.exec request, and
@@ -36,6 +37,13 @@
 static const char *srvkey = "flux::server";
 static const char *msgkey = "flux::request";
 static const char *lstkey = "flux::handle";
+static const char *outkey = "flux::output";
+
+/* Output is coalesced into responses of up to coalesce_size bytes,
+ * held for at most coalesce_delay seconds.
+ */
+static const int coalesce_size = 65536;
+static const double coalesce_delay = 0.005;
 
 struct subprocess_server {
     flux_t *h;
@@ -45,6 +53,7 @@ struct subprocess_server {
     void *llog_data;
     zlistx_t *subprocesses;
     flux_msg_handler_t **handlers;
+    struct bulk_server *bulk;
     subprocess_server_auth_f auth_cb;
     void *arg;
     // The shutdown future is created when user calls shutdown,
@@ -52,7 +61,27 @@ struct subprocess_server {
     flux_future_t *shutdown;
 };
 
+/* Pending output and flow control state for a subprocess.
+ * If the client set "credit" in the rexec.exec request, at most that many
+ * bytes of output are read from the subprocess until more credit is
+ * granted with a rexec.credit request.  Reading stops when credit runs
+ * out, so a fast writer blocks on its pipe rather than filling memory.
+ */
+struct proc_output {
+    subprocess_server_t *s;
+    flux_subprocess_t *p;
+    const flux_msg_t *msg;
+    int credit;                 // -1 = unlimited
+    bool paused;
+    char *stream;               // stream of pending data, if any
+    char *buf;
+    int len;
+    int size;
+    flux_watcher_t *timer;
+};
+
 static void server_kill (flux_subprocess_t *p, int signum);
+static void proc_internal_fatal (flux_subprocess_t *p);
 
 // zlistx_destructor_fn footprint
 static void proc_destructor (void **item)
@@ -151,13 +180,239 @@ static void proc_internal_fatal (flux_subprocess_t *p)
     }
 }
 
+static int proc_output (flux_subprocess_t *p,
+                        const char *stream,
+                        subprocess_server_t *s,
+                        const flux_msg_t *msg,
+                        const char *data,
+                        int len,
+                        bool eof)
+{
+    json_t *io = NULL;
+    char rankstr[64];
+    int rv = -1;
+
+    snprintf (rankstr, sizeof (rankstr), "%d", s->rank);
+    if (!(io = ioencode (stream, rankstr, data, len, eof))) {
+        llog_error (s, "ioencode %s: %s", stream, strerror (errno));
+        goto error;
+    }
+
+    if (flux_respond_pack (s->h,
+                           msg,
+                           "{s:s s:i s:O}",
+                           "type", "output",
+                           "pid", flux_subprocess_pid (p),
+                           "io", io) < 0) {
+        llog_error (s,
+                    "error responding to rexec.exec request: %s",
+                    strerror (errno));
+        goto error;
+    }
+
+    rv = 0;
+error:
+    json_decref (io);
+    return rv;
+}
+
+static void proc_output_destroy (struct proc_output *po)
+{
+    if (po) {
+        int saved_errno = errno;
+        flux_watcher_destroy (po->timer);
+        free (po->stream);
+        free (po->buf);
+        free (po);
+        errno = saved_errno;
+    }
+}
+
+/* Send pending output, if any, with 'eof' if set.
+ */
+static int proc_output_flush (struct proc_output *po,
+                              const char *stream,
+                              bool eof)
+{
+    int rc = 0;
+
+    flux_watcher_stop (po->timer);
+    if (po->stream) {
+        bool same = eof && streq (po->stream, stream);
+
+        rc = proc_output (po->p, po->stream, po->s, po->msg,
+                          po->buf, po->len, same);
+        free (po->stream);
+        po->stream = NULL;
+        po->len = 0;
+        if (same)
+            return rc;
+    }
+    if (eof && rc == 0)
+        rc = proc_output (po->p, stream, po->s, po->msg, NULL, 0, true);
+    return rc;
+}
+
+static void proc_output_timer_cb (flux_reactor_t *r,
+                                  flux_watcher_t *w,
+                                  int revents,
+                                  void *arg)
+{
+    struct proc_output *po = arg;
+
+    if (proc_output_flush (po, NULL, false) < 0)
+        proc_internal_fatal (po->p);
+}
+
+static int proc_output_append (struct proc_output *po,
+                               const char *stream,
+                               const char *data,
+                               int len)
+{
+    if (po->stream && !streq (po->stream, stream)) {
+        if (proc_output_flush (po, NULL, false) < 0)
+            return -1;
+    }
+    if (!po->stream && !(po->stream = strdup (stream)))
+        return -1;
+    if (po->len + len > po->size) {
+        int size = po->len + len;
+        char *buf;
+
+        if (size < coalesce_size)
+            size = coalesce_size;
+        if (!(buf = realloc (po->buf, size)))
+            return -1;
+        po->buf = buf;
+        po->size = size;
+    }
+    memcpy (po->buf + po->len, data, len);
+    po->len += len;
+    return 0;
+}
+
+/* Stop or restart reading all output streams of the subprocess.
+ */
+static void proc_output_pause (struct proc_output *po, bool pause)
+{
+    zlist_t *channels = cmd_channel_list (po->p->cmd);
+    const char *name;
+
+    if (po->paused == pause)
+        return;
+    po->paused = pause;
+    if (pause) {
+        flux_subprocess_stream_stop (po->p, "stdout");
+        flux_subprocess_stream_stop (po->p, "stderr");
+    }
+    else {
+        flux_subprocess_stream_start (po->p, "stdout");
+        flux_subprocess_stream_start (po->p, "stderr");
+    }
+    name = zlist_first (channels);
+    while (name) {
+        if (pause)
+            flux_subprocess_stream_stop (po->p, name);
+        else
+            flux_subprocess_stream_start (po->p, name);
+        name = zlist_next (channels);
+    }
+}
+
+static struct proc_output *proc_output_create (subprocess_server_t *s,
+                                               flux_subprocess_t *p,
+                                               const flux_msg_t *msg,
+                                               int credit)
+{
+    struct proc_output *po;
+
+    if (!(po = calloc (1, sizeof (*po))))
+        return NULL;
+    po->s = s;
+    po->p = p;
+    po->msg = msg;
+    po->credit = credit;
+    if (!(po->timer = flux_timer_watcher_create (flux_get_reactor (s->h),
+                                                 coalesce_delay,
+                                                 0.,
+                                                 proc_output_timer_cb,
+                                                 po))
+        || flux_subprocess_aux_set (p,
+                                    outkey,
+                                    po,
+                                    (flux_free_f)proc_output_destroy) < 0) {
+        proc_output_destroy (po);
+        return NULL;
+    }
+    return po;
+}
+
+static void proc_output_cb (flux_subprocess_t *p, const char *stream)
+{
+    subprocess_server_t *s = flux_subprocess_aux_get (p, srvkey);
+    struct proc_output *po = flux_subprocess_aux_get (p, outkey);
+    const char *ptr;
+    int lenp;
+
+    if (po->credit == 0) {
+        proc_output_pause (po, true);
+        return;
+    }
+    if (!(ptr = flux_subprocess_read (p, stream, po->credit, &lenp))) {
+        llog_error (s,
+                    "error reading from subprocess stream %s: %s",
+                    stream,
+                    strerror (errno));
+        goto error;
+    }
+
+    if (lenp) {
+        if (proc_output_append (po, stream, ptr, lenp) < 0) {
+            llog_error (s,
+                        "error buffering subprocess stream %s: %s",
+                        stream,
+                        strerror (errno));
+            goto error;
+        }
+        if (po->credit > 0) {
+            po->credit -= lenp;
+            if (po->credit == 0)
+                proc_output_pause (po, true);
+        }
+        /* Send now if the buffer is full or the client must consume
+         * it before granting more credit, otherwise after a delay.
+         */
+        if (po->len >= coalesce_size || po->credit == 0) {
+            if (proc_output_flush (po, NULL, false) < 0)
+                goto error;
+        }
+        else
+            flux_watcher_start (po->timer);
+    }
+    else {
+        if (proc_output_flush (po, stream, true) < 0)
+            goto error;
+    }
+
+    return;
+
+error:
+    proc_internal_fatal (p);
+}
+
 static void proc_state_change_cb (flux_subprocess_t *p,
                                   flux_subprocess_state_t state)
 {
     subprocess_server_t *s = flux_subprocess_aux_get (p, srvkey);
     const flux_msg_t *request = flux_subprocess_aux_get (p, msgkey);
+    struct proc_output *po = flux_subprocess_aux_get (p, outkey);
     int rc = 0;
 
+    /* Keep responses in order with any output held for coalescing.
+     * Errors are logged by proc_output().
+     */
+    if (po && state != FLUX_SUBPROCESS_RUNNING)
+        (void)proc_output_flush (po, NULL, false);
     if (state == FLUX_SUBPROCESS_RUNNING) {
         rc = flux_respond_pack (s->h,
                                 request,
@@ -203,70 +458,94 @@ error:
     proc_internal_fatal (p);
 }
 
-static int proc_output (flux_subprocess_t *p,
-                        const char *stream,
-                        subprocess_server_t *s,
-                        const flux_msg_t *msg,
-                        const char *data,
-                        int len,
-                        bool eof)
+flux_subprocess_t *server_exec (subprocess_server_t *s,
+                                 const flux_msg_t *msg,
+                                 json_t *cmd_obj,
+                                 const flux_subprocess_ops_t *ops,
+                                 flux_error_t *error)
 {
-    json_t *io = NULL;
-    char rankstr[64];
-    int rv = -1;
+    flux_cmd_t *cmd = NULL;
+    flux_subprocess_t *p = NULL;
+    char **env = NULL;
 
-    snprintf (rankstr, sizeof (rankstr), "%d", s->rank);
-    if (!(io = ioencode (stream, rankstr, data, len, eof))) {
-        llog_error (s, "ioencode %s: %s", stream, strerror (errno));
+    if (s->shutdown) {
+        errprintf (error, "subprocess server is shutting down");
+        errno = ENOSYS;
+        return NULL;
+    }
+    if (!(cmd = cmd_fromjson (cmd_obj, NULL))) {
+        errprintf (error, "error parsing command string");
         goto error;
     }
 
-    if (flux_respond_pack (s->h,
-                           msg,
-                           "{s:s s:i s:O}",
-                           "type", "output",
-                           "pid", flux_subprocess_pid (p),
-                           "io", io) < 0) {
-        llog_error (s,
-                    "error responding to rexec.exec request: %s",
-                    strerror (errno));
+    if (!flux_cmd_argc (cmd)) {
+        errno = EPROTO;
+        errprintf (error, "command string is empty");
         goto error;
     }
 
-    rv = 0;
-error:
-    json_decref (io);
-    return rv;
-}
+    /* if no environment sent, use local server environment */
+    if (!(env = cmd_env_expand (cmd))
+        || (env[0] == NULL && cmd_set_env (cmd, environ))
+        || flux_cmd_setenvf (cmd, 1, "FLUX_URI", "%s", s->local_uri) < 0) {
+        errprintf (error, "error setting up command environment");
+        goto error;
+    }
 
-static void proc_output_cb (flux_subprocess_t *p, const char *stream)
-{
-    subprocess_server_t *s = flux_subprocess_aux_get (p, srvkey);
-    const flux_msg_t *request = flux_subprocess_aux_get (p, msgkey);
-    const char *ptr;
-    int lenp;
+    /* Never propagate FLUX_PROXY_REMOTE to processes started from
+     * a subprocess server.
+     */
+    flux_cmd_unsetenv (cmd, "FLUX_PROXY_REMOTE");
 
-    if (!(ptr = flux_subprocess_read (p, stream, -1, &lenp))) {
-        llog_error (s,
-                    "error reading from subprocess stream %s: %s",
-                    stream,
-                    strerror (errno));
+    if (!(p = flux_local_exec_ex (flux_get_reactor (s->h),
+                                  FLUX_SUBPROCESS_FLAGS_SETPGRP,
+                                  cmd,
+                                  ops,
+                                  NULL,
+                                  s->llog,
+                                  s->llog_data))) {
+        errprintf (error, "error launching process: %s", strerror (errno));
         goto error;
     }
 
-    if (lenp) {
-        if (proc_output (p, stream, s, request, ptr, lenp, false) < 0)
-            goto error;
-    }
-    else {
-        if (proc_output (p, stream, s, request, NULL, 0, true) < 0)
-            goto error;
+    if (flux_subprocess_aux_set (p,
+                                msgkey,
+                                (void *)flux_msg_incref (msg),
+                                (flux_free_f)flux_msg_decref) < 0) {
+        flux_msg_decref (msg);
+        goto error_nomsg;
     }
+    if (flux_subprocess_aux_set (p, srvkey, s, NULL) < 0
+        || proc_save (s, p) < 0)
+        goto error_nomsg;
 
-    return;
+    flux_cmd_destroy (cmd);
+    free (env);
+    return p;
 
+error_nomsg:
+    errprintf (error, "error saving process: %s", strerror (errno));
 error:
-    proc_internal_fatal (p);
+    ERRNO_SAFE_WRAP (flux_cmd_destroy, cmd);
+    ERRNO_SAFE_WRAP (free, env);
+    subprocess_decref (p);
+    return NULL;
+}
+
+void server_proc_release (subprocess_server_t *s, flux_subprocess_t *p)
+{
+    proc_delete (s, p);
+}
+
+int server_authorize (subprocess_server_t *s,
+                      const flux_msg_t *msg,
+                      flux_error_t *error)
+{
+    if (s->auth_cb && (*s->auth_cb) (msg, s->arg, error) < 0) {
+        errno = EPERM;
+        return -1;
+    }
+    return 0;
 }
 
 static void server_exec_cb (flux_t *h,
@@ -276,8 +555,7 @@ static void server_exec_cb (flux_t *h,
 {
     subprocess_server_t *s = arg;
     json_t *cmd_obj;
-    flux_cmd_t *cmd = NULL;
-    flux_subprocess_t *p = NULL;
+    flux_subprocess_t *p;
     flux_subprocess_ops_t ops = {
         .on_completion = proc_completion_cb,
         .on_state_change = proc_state_change_cb,
@@ -285,25 +563,25 @@ static void server_exec_cb (flux_t *h,
         .on_stdout = proc_output_cb,
         .on_stderr = proc_output_cb,
     };
-    char **env = NULL;
     const char *errmsg = NULL;
     flux_error_t error;
     int flags;
+    int credit = -1;
 
     if (flux_request_unpack (msg,
                              NULL,
-                             "{s:o s:i}",
+                             "{s:o s:i s?i}",
                              "cmd", &cmd_obj,
-                             "flags", &flags) < 0)
+                             "flags", &flags,
+                             "credit", &credit) < 0)
         goto error;
-    if (s->shutdown) {
-        errmsg = "subprocess server is shutting down";
-        errno = ENOSYS;
+    if (credit == 0 || credit < -1) {
+        errno = EPROTO;
+        errmsg = "output credit must be a positive integer";
         goto error;
     }
-    if (s->auth_cb && (*s->auth_cb) (msg, s->arg, &error) < 0) {
+    if (server_authorize (s, msg, &error) < 0) {
         errmsg = error.text;
-        errno = EPERM;
         goto error;
     }
     if (!(flags & SUBPROCESS_REXEC_CHANNEL))
@@ -313,56 +591,15 @@ static void server_exec_cb (flux_t *h,
     if (!(flags & SUBPROCESS_REXEC_STDERR))
         ops.on_stderr = NULL;
 
-    if (!(cmd = cmd_fromjson (cmd_obj, NULL))) {
-        errmsg = "error parsing command string";
-        goto error;
-    }
-
-    if (!flux_cmd_argc (cmd)) {
-        errno = EPROTO;
-        errmsg = "command string is empty";
-        goto error;
-    }
-
-    /* if no environment sent, use local server environment */
-    if (!(env = cmd_env_expand (cmd))
-        || (env[0] == NULL && cmd_set_env (cmd, environ))
-        || flux_cmd_setenvf (cmd, 1, "FLUX_URI", "%s", s->local_uri) < 0) {
-        errmsg = "error setting up command environment";
-        goto error;
-    }
-
-    /* Never propagate FLUX_PROXY_REMOTE to processes started from
-     * a subprocess server.
-     */
-    flux_cmd_unsetenv (cmd, "FLUX_PROXY_REMOTE");
-
-    if (!(p = flux_local_exec_ex (flux_get_reactor (s->h),
-                                  FLUX_SUBPROCESS_FLAGS_SETPGRP,
-                                  cmd,
-                                  &ops,
-                                  NULL,
-                                  s->llog,
-                                  s->llog_data))) {
-        errprintf (&error, "error launching process: %s", strerror (errno));
+    if (!(p = server_exec (s, msg, cmd_obj, &ops, &error))) {
         errmsg = error.text;
         goto error;
     }
-
-    if (flux_subprocess_aux_set (p,
-                                msgkey,
-                                (void *)flux_msg_incref (msg),
-                                (flux_free_f)flux_msg_decref) < 0) {
-        flux_msg_decref (msg);
+    if (!proc_output_create (s, p, msg, credit)) {
+        server_kill (p, SIGKILL);
+        proc_delete (s, p);
         goto error;
     }
-    if (flux_subprocess_aux_set (p, srvkey, s, NULL) < 0)
-        goto error;
-    if (proc_save (s, p) < 0)
-        goto error;
-
-    flux_cmd_destroy (cmd);
-    free (env);
     return;
 
 error:
@@ -371,9 +608,6 @@ error:
                     "error responding to rexec.exec request: %s",
                     strerror (errno));
     }
-    flux_cmd_destroy (cmd);
-    free (env);
-    subprocess_decref (p);
 }
 
 static void server_write_cb (flux_t *h,
@@ -446,6 +680,42 @@ error:
     proc_internal_fatal (p);
 }
 
+static void server_credit_cb (flux_t *h,
+                              flux_msg_handler_t *mh,
+                              const flux_msg_t *msg,
+                              void *arg)
+{
+    subprocess_server_t *s = arg;
+    flux_subprocess_t *p;
+    struct proc_output *po;
+    pid_t pid;
+    int credit;
+    flux_error_t error;
+
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s:i s:i}",
+                             "pid", &pid,
+                             "credit", &credit) < 0
+        || credit <= 0) {
+        llog_error (s, "Error decoding rexec.credit request");
+        return;
+    }
+    if (s->auth_cb && (*s->auth_cb) (msg, s->arg, &error) < 0) {
+        llog_error (s, "rexec.credit: %s", error.text);
+        return;
+    }
+    /* As with rexec.write, credit for a subprocess that is gone or
+     * did not request flow control is silently dropped.
+     */
+    if (!(p = proc_find_bypid (s, pid))
+        || !(po = flux_subprocess_aux_get (p, outkey))
+        || po->credit < 0)
+        return;
+    po->credit += credit;
+    proc_output_pause (po, false);
+}
+
 static void server_kill_cb (flux_t *h,
                             flux_msg_handler_t *mh,
                             const flux_msg_t *msg,
@@ -575,6 +845,7 @@ static void server_disconnect_cb (flux_t *h,
             p = zlistx_next (s->subprocesses);
         }
     }
+    bulk_server_disconnect (s->bulk, msg);
 }
 
 static struct flux_msg_handler_spec htab[] = {
@@ -588,6 +859,11 @@ static struct flux_msg_handler_spec htab[] = {
       server_write_cb,
       0
     },
+    { FLUX_MSGTYPE_REQUEST,
+      "credit",
+      server_credit_cb,
+      0
+    },
     { FLUX_MSGTYPE_REQUEST,
       "kill",
       server_kill_cb,
@@ -639,6 +915,7 @@ void subprocess_server_destroy (subprocess_server_t *s)
     if (s) {
         int saved_errno = errno;
         flux_msg_handler_delvec (s->handlers);
+        bulk_server_destroy (s->bulk);
         server_killall (s, SIGKILL);
         zlistx_destroy (&s->subprocesses);
         flux_future_destroy (s->shutdown);
@@ -681,6 +958,8 @@ subprocess_server_t *subprocess_server_create (flux_t *h,
                                     s,
                                     &s->handlers) < 0)
         goto error;
+    if (!(s->bulk = bulk_server_create (s, h, service_name, s->rank)))
+        goto error;
 
     return s;
 
@@ -697,6 +976,15 @@ void subprocess_server_set_auth_cb (subprocess_server_t *s,
     s->arg = arg;
 }
 
+int subprocess_server_set_topology (subprocess_server_t *s, json_t *topo)
+{
+    if (!s) {
+        errno = EINVAL;
+        return -1;
+    }
+    return bulk_server_set_topology (s->bulk, topo);
+}
+
 flux_future_t *subprocess_server_shutdown (subprocess_server_t *s, int signum)
 {
     flux_future_t *f;
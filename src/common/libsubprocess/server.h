@@ -11,6 +11,8 @@
 #ifndef _SUBPROCESS_SERVER_H
 #define _SUBPROCESS_SERVER_H
 
+#include <jansson.h>
+
 #include "subprocess.h"
 
 typedef struct subprocess_server subprocess_server_t;
@@ -39,6 +41,14 @@ void subprocess_server_set_auth_cb (subprocess_server_t *s,
                                     subprocess_server_auth_f fn,
                                     void *arg);
 
+/* Set the TBON topology (see overlay.topology) of the subtree rooted at
+ * this server's rank, so that <service>.bulk-exec requests may start
+ * processes on ranks in the subtree by forwarding them to the subprocess
+ * servers on child ranks.  Without it, bulk launches may only include the
+ * local rank.
+ */
+int subprocess_server_set_topology (subprocess_server_t *s, json_t *topo);
+
 /* Destroy a subprocess server.  This sends a SIGKILL to any remaining
  * subprocesses, then destroys them.
  */
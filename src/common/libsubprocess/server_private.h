@@ -0,0 +1,65 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _SUBPROCESS_SERVER_PRIVATE_H
+#define _SUBPROCESS_SERVER_PRIVATE_H
+
+#include <jansson.h>
+#include <flux/core.h>
+
+#include "subprocess.h"
+#include "server.h"
+
+/* Interfaces between the subprocess server (server.c) and its bulk
+ * launch service (bulk_server.c).
+ */
+
+/* Start 'cmd_obj' (encoded as by cmd_tojson()) locally on behalf of
+ * request 'msg', and add it to the server's list of subprocesses, so that
+ * it is listed, signaled, and killed on client disconnect or shutdown
+ * like any other.  Call server_proc_release() once it has completed or
+ * failed.  On failure, set errno and 'error', and return NULL.
+ */
+flux_subprocess_t *server_exec (subprocess_server_t *s,
+                                const flux_msg_t *msg,
+                                json_t *cmd_obj,
+                                const flux_subprocess_ops_t *ops,
+                                flux_error_t *error);
+void server_proc_release (subprocess_server_t *s, flux_subprocess_t *p);
+
+/* Apply the server's auth callback, if any, to 'msg'.
+ * On denial, set errno to EPERM and 'error', and return -1.
+ */
+int server_authorize (subprocess_server_t *s,
+                      const flux_msg_t *msg,
+                      flux_error_t *error);
+
+struct bulk_server;
+
+struct bulk_server *bulk_server_create (subprocess_server_t *s,
+                                        flux_t *h,
+                                        const char *service_name,
+                                        uint32_t rank);
+void bulk_server_destroy (struct bulk_server *bs);
+
+/* Set the TBON topology (see overlay.topology) of the subtree rooted at
+ * this server's rank.  Without it, bulk launches may only include this
+ * rank.
+ */
+int bulk_server_set_topology (struct bulk_server *bs, json_t *topo);
+
+/* Signal the launches requested by the sender of disconnect 'msg' on
+ * downstream ranks.
+ */
+void bulk_server_disconnect (struct bulk_server *bs, const flux_msg_t *msg);
+
+#endif /* !_SUBPROCESS_SERVER_PRIVATE_H */
+
+// vi: ts=4 sw=4 expandtab
@@ -463,7 +463,8 @@ flux_subprocess_t *flux_local_exec_ex (flux_reactor_t *r,
     flux_subprocess_t *p = NULL;
     int valid_flags = (FLUX_SUBPROCESS_FLAGS_STDIO_FALLTHROUGH
                        | FLUX_SUBPROCESS_FLAGS_SETPGRP
-                       | FLUX_SUBPROCESS_FLAGS_FORK_EXEC);
+                       | FLUX_SUBPROCESS_FLAGS_FORK_EXEC
+                       | FLUX_SUBPROCESS_FLAGS_VFORK_EXEC);
 
     if (!r || !cmd) {
         errno = EINVAL;
@@ -61,6 +61,12 @@ enum {
     FLUX_SUBPROCESS_FLAGS_SETPGRP = 2,
     /* use fork(2)/exec(2) even if posix_spawn(3) available */
     FLUX_SUBPROCESS_FLAGS_FORK_EXEC = 4,
+    /* when posix_spawn(3) can't be used, e.g. due to a pre_exec hook,
+     * create the child with vfork semantics instead of fork(2).  The
+     * pre_exec hook then runs in the parent's memory while the parent is
+     * suspended, so it must not change state the parent relies on.
+     */
+    FLUX_SUBPROCESS_FLAGS_VFORK_EXEC = 8,
 };
 
 /*
@@ -113,6 +113,8 @@ struct flux_subprocess {
     int failed_errno;           /* Holds errno if FAILED state reached */
     flux_error_t failed_error;  /* Holds detailed message for failed_errno */
     int signal_pending;         /* signal sent while starting */
+    int credit_window;          /* output flow control window, or 0 */
+    int credit_consumed;        /* output consumed since last credit grant */
 };
 
 void subprocess_check_completed (flux_subprocess_t *p);
@@ -0,0 +1,272 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <unistd.h> // environ def
+#include <signal.h>
+#include <sys/wait.h>
+#include <jansson.h>
+#include <flux/core.h>
+#include <flux/idset.h>
+
+#include "ccan/str/str.h"
+#include "src/common/libtap/tap.h"
+#include "src/common/libtestutil/util.h"
+#include "src/common/libsubprocess/bulk.h"
+
+#include "rcmdsrv.h"
+
+#define SERVER_NAME "test-bulk"
+
+struct bulk_ctx {
+    flux_t *h;
+    char *started;
+    char *exited;
+    int status;
+    char *failed;
+    int errnum;
+    char output[256];
+    int killsig;
+    bool complete;
+};
+
+static char *encode (const struct idset *ranks)
+{
+    char *s;
+    if (!(s = idset_encode (ranks, IDSET_FLAG_RANGE)))
+        BAIL_OUT ("idset_encode failed");
+    return s;
+}
+
+static void start_cb (subprocess_bulk_t *b,
+                      const struct idset *ranks,
+                      void *arg)
+{
+    struct bulk_ctx *ctx = arg;
+
+    free (ctx->started);
+    ctx->started = encode (ranks);
+    diag ("started on %s", ctx->started);
+    if (ctx->killsig) {
+        flux_future_t *f = subprocess_bulk_kill (b, ctx->killsig);
+        ok (f != NULL && flux_future_get (f, NULL) == 0,
+            "subprocess_bulk_kill works");
+        flux_future_destroy (f);
+    }
+}
+
+static void exit_cb (subprocess_bulk_t *b,
+                     const struct idset *ranks,
+                     int status,
+                     void *arg)
+{
+    struct bulk_ctx *ctx = arg;
+
+    free (ctx->exited);
+    ctx->exited = encode (ranks);
+    ctx->status = status;
+    diag ("exited on %s with status 0x%x", ctx->exited, status);
+}
+
+static void error_cb (subprocess_bulk_t *b,
+                      const struct idset *ranks,
+                      int errnum,
+                      const char *errmsg,
+                      void *arg)
+{
+    struct bulk_ctx *ctx = arg;
+
+    free (ctx->failed);
+    ctx->failed = encode (ranks);
+    ctx->errnum = errnum;
+    diag ("failed on %s: %s", ctx->failed, errmsg ? errmsg : "");
+}
+
+static void output_cb (subprocess_bulk_t *b,
+                       const struct idset *ranks,
+                       const char *stream,
+                       const char *data,
+                       int len,
+                       void *arg)
+{
+    struct bulk_ctx *ctx = arg;
+    int n = strlen (ctx->output);
+    char *s = encode (ranks);
+
+    snprintf (ctx->output + n,
+              sizeof (ctx->output) - n,
+              "%s:%s:%.*s",
+              s,
+              stream,
+              len,
+              data);
+    free (s);
+}
+
+static void complete_cb (subprocess_bulk_t *b, void *arg)
+{
+    struct bulk_ctx *ctx = arg;
+
+    ctx->complete = true;
+    flux_reactor_stop (flux_get_reactor (ctx->h));
+}
+
+static const subprocess_bulk_ops_t ops = {
+    .on_start = start_cb,
+    .on_exit = exit_cb,
+    .on_error = error_cb,
+    .on_output = output_cb,
+    .on_complete = complete_cb,
+};
+
+static void bulk_ctx_clear (struct bulk_ctx *ctx)
+{
+    free (ctx->started);
+    free (ctx->exited);
+    free (ctx->failed);
+    memset (ctx, 0, sizeof (*ctx));
+}
+
+static subprocess_bulk_t *run (struct bulk_ctx *ctx,
+                               const char *ranks,
+                               char **argv)
+{
+    struct idset *ids;
+    flux_cmd_t *cmd;
+    subprocess_bulk_t *b;
+    int argc = 0;
+
+    while (argv[argc])
+        argc++;
+    if (!(ids = idset_decode (ranks)))
+        BAIL_OUT ("idset_decode failed");
+    if (!(cmd = flux_cmd_create (argc, argv, environ)))
+        BAIL_OUT ("flux_cmd_create failed");
+    b = subprocess_bulk_exec (ctx->h, SERVER_NAME, 0, ids, cmd, &ops, ctx);
+    ok (b != NULL,
+        "subprocess_bulk_exec %s on %s works", argv[0], ranks);
+    idset_destroy (ids);
+    flux_cmd_destroy (cmd);
+    return b;
+}
+
+static void simple_test (flux_t *h)
+{
+    struct bulk_ctx ctx = { .h = h };
+    char *argv[] = { "/bin/sh", "-c", "echo hello; exit 3", NULL };
+    subprocess_bulk_t *b;
+
+    b = run (&ctx, "0", argv);
+    ok (flux_reactor_run (flux_get_reactor (h), 0) >= 0,
+        "reactor ran until launch completed");
+    ok (ctx.complete == true,
+        "launch completed");
+    ok (ctx.started && streq (ctx.started, "0"),
+        "started on rank 0");
+    ok (streq (ctx.output, "0:stdout:hello\n"),
+        "got output from rank 0");
+    ok (ctx.exited && streq (ctx.exited, "0")
+        && WIFEXITED (ctx.status) && WEXITSTATUS (ctx.status) == 3,
+        "exited on rank 0 with exit code 3");
+    ok (ctx.failed == NULL,
+        "no ranks failed");
+    ok (idset_count (subprocess_bulk_pending (b)) == 0,
+        "no ranks are pending");
+    subprocess_bulk_destroy (b);
+    bulk_ctx_clear (&ctx);
+}
+
+static void stdin_test (flux_t *h)
+{
+    struct bulk_ctx ctx = { .h = h };
+    char *argv[] = { "cat", NULL };
+    subprocess_bulk_t *b;
+
+    b = run (&ctx, "0", argv);
+    ok (subprocess_bulk_write (b, "stdin", "foo\n", 4) == 0,
+        "subprocess_bulk_write works");
+    ok (subprocess_bulk_close (b, "stdin") == 0,
+        "subprocess_bulk_close works");
+    ok (flux_reactor_run (flux_get_reactor (h), 0) >= 0 && ctx.complete,
+        "launch completed");
+    ok (streq (ctx.output, "0:stdout:foo\n"),
+        "stdin was copied to stdout");
+    ok (ctx.exited && WIFEXITED (ctx.status) && WEXITSTATUS (ctx.status) == 0,
+        "exited with exit code 0");
+    subprocess_bulk_destroy (b);
+    bulk_ctx_clear (&ctx);
+}
+
+static void kill_test (flux_t *h)
+{
+    struct bulk_ctx ctx = { .h = h, .killsig = SIGTERM };
+    char *argv[] = { "sleep", "30", NULL };
+    subprocess_bulk_t *b;
+
+    b = run (&ctx, "0", argv);
+    ok (flux_reactor_run (flux_get_reactor (h), 0) >= 0 && ctx.complete,
+        "launch completed");
+    ok (ctx.exited && WIFSIGNALED (ctx.status)
+        && WTERMSIG (ctx.status) == SIGTERM,
+        "process was terminated by SIGTERM");
+    subprocess_bulk_destroy (b);
+    bulk_ctx_clear (&ctx);
+}
+
+static void error_test (flux_t *h)
+{
+    struct bulk_ctx ctx = { .h = h };
+    char *argv[] = { "true", NULL };
+    char *argv2[] = { "/nonexistent", NULL };
+    subprocess_bulk_t *b;
+
+    b = run (&ctx, "0-1", argv);
+    ok (flux_reactor_run (flux_get_reactor (h), 0) >= 0 && ctx.complete,
+        "launch completed");
+    ok (ctx.failed && streq (ctx.failed, "0-1") && ctx.errnum == EINVAL,
+        "ranks outside the server subtree fail with EINVAL");
+    ok (ctx.started == NULL && ctx.exited == NULL,
+        "nothing was started");
+    subprocess_bulk_destroy (b);
+    bulk_ctx_clear (&ctx);
+
+    ctx.h = h;
+    b = run (&ctx, "0", argv2);
+    ok (flux_reactor_run (flux_get_reactor (h), 0) >= 0 && ctx.complete,
+        "launch completed");
+    ok (ctx.failed && streq (ctx.failed, "0") && ctx.errnum == ENOENT,
+        "nonexistent command fails with ENOENT");
+    subprocess_bulk_destroy (b);
+    bulk_ctx_clear (&ctx);
+}
+
+int main (int argc, char *argv[])
+{
+    flux_t *h;
+
+    plan (NO_PLAN);
+
+    h = rcmdsrv_create (SERVER_NAME);
+
+    simple_test (h);
+    stdin_test (h);
+    kill_test (h);
+    error_test (h);
+
+    test_server_stop (h);
+    flux_close (h);
+
+    done_testing ();
+    return 0;
+}
+
+// vi: ts=4 sw=4 expandtab
@@ -17,6 +17,7 @@
 #include <unistd.h>
 #include <errno.h>
 
+#include "ccan/str/str.h"
 #include "src/common/libtap/tap.h"
 
 #include "fbuf.h"
@@ -425,6 +426,80 @@ void large_data (void)
     fbuf_destroy (fb);
 }
 
+/* Data that wraps around the end of the ring is returned contiguously,
+ * and the byte replaced by the NUL terminator is put back.
+ */
+void wrap_around (void)
+{
+    struct fbuf *fb;
+    const char *ptr;
+    char buf[64];
+    int pipefds[2];
+    int total = 0;
+    int len;
+    int i;
+
+    if (pipe (pipefds) < 0)
+        BAIL_OUT ("pipe failed");
+
+    ok ((fb = fbuf_create (100)) != NULL,
+        "fbuf_create 100 byte buffer works");
+
+    /* advance the ring without ever emptying it, leaving one newline */
+    ok (fbuf_write (fb, "x", 1) == 1,
+        "fbuf_write 1 byte");
+    for (i = 0; i < 1000; i++) {
+        snprintf (buf, sizeof (buf), "line %d\n", i);
+        if (fbuf_write (fb, buf, strlen (buf)) != strlen (buf))
+            break;
+        total += strlen (buf);
+        if (fbuf_read (fb, strlen (buf), &len) == NULL
+            || len != strlen (buf))
+            break;
+    }
+    ok (i == 1000,
+        "wrote and read 1000 lines through ring");
+
+    ok (fbuf_write (fb, "abc\ndef\n", 8) == 8,
+        "fbuf_write two lines");
+    ok ((ptr = fbuf_read (fb, 1, &len)) != NULL
+        && len == 1
+        && streq (ptr, "\n"),
+        "fbuf_read returns NUL terminated first byte");
+    ok ((ptr = fbuf_read_line (fb, &len)) != NULL
+        && len == 4
+        && streq (ptr, "abc\n"),
+        "fbuf_read_line returns NUL terminated first line");
+    ok (fbuf_has_line (fb),
+        "fbuf_has_line finds second line after NUL was placed");
+    ok ((ptr = fbuf_read_trimmed_line (fb, &len)) != NULL
+        && len == 3
+        && streq (ptr, "def"),
+        "fbuf_read_trimmed_line returns second line intact");
+
+    for (i = 0; i < 10; i++) {
+        ok (fbuf_write (fb, "0123456789", 10) == 10,
+            "fbuf_write 10 bytes");
+    }
+    ok (fbuf_space (fb) == 0,
+        "buffer is full");
+    ok ((ptr = fbuf_read (fb, 5, &len)) != NULL
+        && len == 5
+        && streq (ptr, "01234"),
+        "fbuf_read of partial data works on full buffer");
+    ok (fbuf_read_to_fd (fb, pipefds[1], -1) == 95,
+        "fbuf_read_to_fd writes remaining data");
+    ok (read (pipefds[0], buf, sizeof (buf)) == 64
+        && !memcmp (buf, "56789", 5),
+        "remaining data starts with byte that held NUL");
+    ok (fbuf_bytes (fb) == 0,
+        "buffer is empty");
+
+    fbuf_destroy (fb);
+    close (pipefds[0]);
+    close (pipefds[1]);
+}
+
 int main (int argc, char *argv[])
 {
     plan (NO_PLAN);
@@ -435,6 +510,7 @@ int main (int argc, char *argv[])
     full_buffer ();
     readonly_buffer ();
     large_data ();
+    wrap_around ();
 
     done_testing();
 
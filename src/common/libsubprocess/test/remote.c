@@ -256,6 +256,54 @@ void simple_test (flux_t *h)
     simple_run_check (h, ARRAY_SIZE (echo2_av) - 1, echo2_av, &exp);
 }
 
+/* Output from a fast writer exceeds the client's small stdout buffer,
+ * which would overflow with ENOSPC if the server did not stop reading
+ * when its output credit runs out.
+ */
+void credit_test (flux_t *h)
+{
+    char *av[] = { "/bin/sh", "-c", "seq 1 20000", NULL };
+    flux_subprocess_t *p;
+    flux_cmd_t *cmd;
+    struct simple_ctx ctx;
+    int rc;
+
+    cmd = flux_cmd_create (ARRAY_SIZE (av) - 1, av, environ);
+    if (!cmd
+        || flux_cmd_setopt (cmd, "stdout_BUFSIZE", "8192") < 0)
+        BAIL_OUT ("error creating command");
+
+    memset (&ctx, 0, sizeof (ctx));
+    ctx.h = h;
+    p = flux_rexec_ex (h,
+                       SERVER_NAME,
+                       FLUX_NODEID_ANY,
+                       0,
+                       cmd,
+                       &simple_ops,
+                       tap_logger,
+                       NULL);
+    ok (p != NULL,
+        "credit: created subprocess");
+    if (!p)
+        BAIL_OUT ("flux_rexec_ex failed");
+    if (flux_subprocess_aux_set (p, "ctx", &ctx, NULL) < 0)
+        BAIL_OUT ("flux_subprocess_aux_set failed");
+    rc = flux_reactor_run (flux_get_reactor (h), 0);
+    ok (rc >= 0,
+        "credit: client reactor ran successfully");
+    ok (ctx.scorecard.failed == 0 && ctx.scorecard.stdout_error == 0,
+        "credit: subprocess did not fail");
+    ok (ctx.scorecard.completion == 1 && ctx.scorecard.stdout_eof == 1,
+        "credit: subprocess completed with stdout EOF");
+    ok (ctx.scorecard.stdout_lines == 20000,
+        "credit: got all 20000 lines of output (%d)",
+        ctx.scorecard.stdout_lines);
+
+    flux_subprocess_destroy (p);
+    flux_cmd_destroy (cmd);
+}
+
 /* In SIGSTOP test, a 'cat' subprocess is sent SIGSTOP upon starting.
  * If remote SIGSTOP handling works, the state callback is called again
  * with state == STOPPED, which triggers closure of stdin and natural
@@ -348,6 +396,7 @@ int main (int argc, char *argv[])
     h = rcmdsrv_create (SERVER_NAME);
 
     simple_test (h);
+    credit_test (h);
     sigstop_test (h);
 
     test_server_stop (h);
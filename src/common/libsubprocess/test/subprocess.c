@@ -884,6 +884,59 @@ void count_hook_cb (flux_subprocess_t *p, void *arg)
     (*count)++;
 }
 
+void test_flag_vfork_exec (flux_reactor_t *r)
+{
+    char *av[] = { "/bin/true", NULL };
+    char *av_enoent[] = { "/usr/bin/foobarbaz", NULL };
+    flux_cmd_t *cmd;
+    flux_subprocess_t *p = NULL;
+    int hook_count = 0;
+
+    ok ((cmd = flux_cmd_create (1, av, NULL)) != NULL, "flux_cmd_create");
+
+    flux_subprocess_ops_t ops = {
+        .on_completion = completion_cb,
+    };
+    /* vforked child shares our memory, so no need for shared mapping */
+    flux_subprocess_hooks_t hooks = {
+        .pre_exec = count_hook_cb,
+        .pre_exec_arg = &hook_count
+    };
+    completion_cb_count = 0;
+    p = flux_local_exec_ex (r,
+                            FLUX_SUBPROCESS_FLAGS_VFORK_EXEC,
+                            cmd,
+                            &ops,
+                            &hooks,
+                            NULL,
+                            NULL);
+    ok (p != NULL, "flux_local_exec_ex with VFORK_EXEC");
+    ok (flux_subprocess_state (p) == FLUX_SUBPROCESS_RUNNING,
+        "subprocess state == RUNNING after flux_local_exec_ex");
+    ok (hook_count == 1,
+        "pre_exec hook ran in parent memory");
+
+    int rc = flux_reactor_run (r, 0);
+    ok (rc == 0, "flux_reactor_run returned zero status");
+    ok (completion_cb_count == 1, "completion callback called 1 time");
+    ok (flux_subprocess_exit_code (p) == 0, "subprocess exited with 0");
+    flux_subprocess_destroy (p);
+    flux_cmd_destroy (cmd);
+
+    ok ((cmd = flux_cmd_create (1, av_enoent, NULL)) != NULL,
+        "flux_cmd_create");
+    p = flux_local_exec_ex (r,
+                            FLUX_SUBPROCESS_FLAGS_VFORK_EXEC,
+                            cmd,
+                            &ops,
+                            &hooks,
+                            NULL,
+                            NULL);
+    ok (p == NULL && errno == ENOENT,
+        "flux_local_exec_ex with VFORK_EXEC fails with ENOENT");
+    flux_cmd_destroy (cmd);
+}
+
 void test_post_fork_hook (flux_reactor_t *r)
 {
     char *av[] = { "/bin/true", NULL };
@@ -1109,6 +1162,8 @@ int main (int argc, char *argv[])
     test_refcount (r);
     diag ("pre_exec_hook");
     test_pre_exec_hook (r);
+    diag ("flag_vfork_exec");
+    test_flag_vfork_exec (r);
     diag ("post_fork_hook");
     test_post_fork_hook (r);
     diag ("test_destroy_in_completion");
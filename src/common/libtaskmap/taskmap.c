@@ -13,6 +13,7 @@
 #endif
 
 #include <ctype.h>
+#include <string.h>
 #include <jansson.h>
 
 #include <flux/core.h>
@@ -20,7 +21,6 @@
 
 #include "src/common/libczmqcontainers/czmq_containers.h"
 #include "src/common/libutil/errprintf.h"
-#include "src/common/libutil/lru_cache.h"
 #include "src/common/libutil/errno_safe.h"
 #include "ccan/str/str.h"
 #include "taskmap.h"
@@ -32,9 +32,24 @@ struct taskmap_block {
     int repeat;
 };
 
+/*  Lookup index over the blocklist, built on first use and reset
+ *  whenever the map is modified.  'first[i]' is the first taskid of
+ *  blocks[i], which lets taskmap_nodeid() binary search the blocks.
+ *  Task idsets are computed once per nodeid and kept in 'taskids'.
+ */
+struct taskmap_index {
+    bool valid;
+    int nblocks;
+    struct taskmap_block **blocks;
+    int *first;
+    int total;
+    int nnodes;
+    struct idset **taskids;
+};
+
 struct taskmap {
     zlistx_t *blocklist;
-    lru_cache_t *idsets;
+    struct taskmap_index *index;
 };
 
 static struct taskmap_block * taskmap_block_create (int nodeid,
@@ -108,12 +123,27 @@ static void taskmap_block_destructor (void **item)
     }
 }
 
+static void taskmap_index_reset (struct taskmap_index *idx)
+{
+    if (idx->taskids) {
+        for (int i = 0; i < idx->nnodes; i++)
+            idset_destroy (idx->taskids[i]);
+    }
+    free (idx->taskids);
+    free (idx->blocks);
+    free (idx->first);
+    memset (idx, 0, sizeof (*idx));
+}
+
 void taskmap_destroy (struct taskmap *map)
 {
     if (map) {
         int saved_errno = errno;
         zlistx_destroy (&map->blocklist);
-        lru_cache_destroy (map->idsets);
+        if (map->index) {
+            taskmap_index_reset (map->index);
+            free (map->index);
+        }
         free (map);
         errno = saved_errno;
     }
@@ -125,12 +155,11 @@ struct taskmap *taskmap_create (void)
 
     if (!(map = calloc (1, sizeof (*map)))
         || !(map->blocklist = zlistx_new ())
-        || !(map->idsets = lru_cache_create (16))) {
+        || !(map->index = calloc (1, sizeof (*map->index)))) {
         errno = ENOMEM;
         goto error;
     }
     zlistx_set_destructor (map->blocklist, taskmap_block_destructor);
-    lru_cache_set_free_f (map->idsets, (lru_cache_free_f) idset_destroy);
     return map;
 error:
     taskmap_destroy (map);
@@ -143,27 +172,40 @@ bool taskmap_unknown (const struct taskmap *map)
     return zlistx_size (map->blocklist) == 0;
 }
 
-static char *to_string (int n, char *buf, int len)
-{
-    (void) snprintf (buf, len, "%d", n);
-    return buf;
-}
-
-static void cache_idset (const struct taskmap *map,
-                         int nodeid,
-                         struct idset *idset)
+/*  Return the lookup index of 'map', building it if necessary.
+ */
+static struct taskmap_index *taskmap_index_get (const struct taskmap *map)
 {
-    char id[24];
-    (void) lru_cache_put (map->idsets,
-                          to_string (nodeid, id, sizeof (id)),
-                          idset);
-}
+    struct taskmap_index *idx = map->index;
+    struct taskmap_block *block;
+    int n = 0;
 
-static void decache_idset (struct taskmap *map, int nodeid)
-{
-    char id[24];
-    (void) lru_cache_remove (map->idsets,
-                             to_string (nodeid, id, sizeof (id)));
+    if (idx->valid)
+        return idx;
+    taskmap_index_reset (idx);
+    idx->nblocks = zlistx_size (map->blocklist);
+    if (!(idx->blocks = calloc (idx->nblocks, sizeof (idx->blocks[0])))
+        || !(idx->first = calloc (idx->nblocks, sizeof (idx->first[0]))))
+        goto nomem;
+    block = zlistx_first (map->blocklist);
+    while (block) {
+        int end = block->start + block->nnodes;
+        idx->blocks[n] = block;
+        idx->first[n] = idx->total;
+        idx->total += block->nnodes * block->ppn * block->repeat;
+        if (idx->nnodes < end)
+            idx->nnodes = end;
+        n++;
+        block = zlistx_next (map->blocklist);
+    }
+    if (!(idx->taskids = calloc (idx->nnodes, sizeof (idx->taskids[0]))))
+        goto nomem;
+    idx->valid = true;
+    return idx;
+nomem:
+    taskmap_index_reset (idx);
+    errno = ENOMEM;
+    return NULL;
 }
 
 /*  Wrapper for zlistx_add_end that sets errno.
@@ -208,7 +250,7 @@ int taskmap_append (struct taskmap *map, int nodeid, int nnodes, int ppn)
         errno = EINVAL;
         return -1;
     }
-    decache_idset (map, nodeid);
+    taskmap_index_reset (map->index);
     if ((block = zlistx_tail (map->blocklist))) {
         /*  If previous block ends at nodeid - 1, and has the same ppn
          *  and a repeat of 1, then add nnodes to the previous block
@@ -634,42 +676,42 @@ out:
     return map;
 }
 
-static struct idset *lookup_idset (const struct taskmap *map, int nodeid)
-{
-    char id[24];
-    return lru_cache_get (map->idsets, to_string (nodeid, id, sizeof (id)));
-}
-
 const struct idset *taskmap_taskids (const struct taskmap *map, int nodeid)
 {
-    int current;
-    struct taskmap_block *block;
+    struct taskmap_index *idx;
     struct idset *taskids;
 
     if (!map || nodeid < 0 || taskmap_unknown (map)) {
         errno = EINVAL;
         return NULL;
     }
-
-    if ((taskids = lookup_idset (map, nodeid)))
+    if (!(idx = taskmap_index_get (map)))
+        return NULL;
+    if (nodeid >= idx->nnodes) {
+        errno = ENOENT;
+        return NULL;
+    }
+    if ((taskids = idx->taskids[nodeid]))
         return taskids;
 
     if (!(taskids = idset_create (0, IDSET_FLAG_AUTOGROW)))
         return NULL;
 
-    current = 0;
-    block = zlistx_first (map->blocklist);
-    while (block) {
-        for (int n = 0; n < block->repeat; n++) {
-            int start = block->start;
-            if (nodeid >= start && nodeid <= taskmap_block_end (block)) {
-                int offset = nodeid - start;
-                start = current + (offset * block->ppn);
-                idset_range_set (taskids, start, start + block->ppn - 1);
+    for (int i = 0; i < idx->nblocks; i++) {
+        struct taskmap_block *block = idx->blocks[i];
+        if (nodeid >= block->start && nodeid <= taskmap_block_end (block)) {
+            int span = block->nnodes * block->ppn;
+            int start = idx->first[i] + (nodeid - block->start) * block->ppn;
+            for (int n = 0; n < block->repeat; n++) {
+                if (idset_range_set (taskids,
+                                     start,
+                                     start + block->ppn - 1) < 0) {
+                    idset_destroy (taskids);
+                    return NULL;
+                }
+                start += span;
             }
-            current += block->nnodes * block->ppn;
         }
-        block = zlistx_next (map->blocklist);
     }
 
     if (idset_count (taskids) == 0) {
@@ -678,34 +720,41 @@ const struct idset *taskmap_taskids (const struct taskmap *map, int nodeid)
         return NULL;
     }
 
-    cache_idset (map, nodeid, taskids);
+    idx->taskids[nodeid] = taskids;
     return taskids;
 }
 
 int taskmap_nodeid (const struct taskmap *map, int taskid)
 {
+    struct taskmap_index *idx;
     struct taskmap_block *block;
-    int current = 0;
+    int lo, hi, distance;
 
     if (!map || taskid < 0 || taskmap_unknown (map)) {
         errno = EINVAL;
         return -1;
     }
+    if (!(idx = taskmap_index_get (map)))
+        return -1;
+    if (taskid >= idx->total) {
+        errno = ENOENT;
+        return -1;
+    }
 
-    block = zlistx_first (map->blocklist);
-    while (block) {
-        for (int n = 0; n < block->repeat; n++) {
-            int last = current + block->nnodes * block->ppn - 1;
-            if (taskid <= last) {
-                int distance = taskid - current;
-                return block->start + (distance / block->ppn);
-            }
-            current = last + 1;
-        }
-        block = zlistx_next (map->blocklist);
+    /*  Find the last block whose first taskid is <= taskid.
+     */
+    lo = 0;
+    hi = idx->nblocks - 1;
+    while (lo < hi) {
+        int mid = lo + (hi - lo + 1) / 2;
+        if (idx->first[mid] <= taskid)
+            lo = mid;
+        else
+            hi = mid - 1;
     }
-    errno = ENOENT;
-    return -1;
+    block = idx->blocks[lo];
+    distance = (taskid - idx->first[lo]) % (block->nnodes * block->ppn);
+    return block->start + (distance / block->ppn);
 }
 
 int taskmap_ntasks (const struct taskmap *map, int nodeid)
@@ -718,42 +767,28 @@ int taskmap_ntasks (const struct taskmap *map, int nodeid)
 
 int taskmap_nnodes (const struct taskmap *map)
 {
-    struct taskmap_block *block;
-    int n;
+    struct taskmap_index *idx;
 
     if (!map || taskmap_unknown (map)) {
         errno = EINVAL;
         return -1;
     }
-
-    n = 0;
-    block = zlistx_first (map->blocklist);
-    while (block) {
-        int end = block->start + block->nnodes;
-        if (n < end)
-            n = end;
-        block = zlistx_next (map->blocklist);
-    }
-    return n;
+    if (!(idx = taskmap_index_get (map)))
+        return -1;
+    return idx->nnodes;
 }
 
 int taskmap_total_ntasks (const struct taskmap *map)
 {
-    struct taskmap_block *block;
-    int n;
+    struct taskmap_index *idx;
 
     if (!map || taskmap_unknown (map)) {
         errno = EINVAL;
         return -1;
     }
-
-    n = 0;
-    block = zlistx_first (map->blocklist);
-    while (block) {
-        n += block->nnodes * block->repeat * block->ppn;
-        block = zlistx_next (map->blocklist);
-    }
-    return n;
+    if (!(idx = taskmap_index_get (map)))
+        return -1;
+    return idx->total;
 }
 
 static json_t *taskmap_block_encode (struct taskmap_block *block)
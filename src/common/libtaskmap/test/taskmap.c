@@ -594,6 +594,55 @@ static void test_raw_decode_errors (void)
     }
 }
 
+/*  Check lookups on an irregular map against the order of taskmap_append()
+ *  calls, and again after the map is extended.
+ */
+static void test_lookup_irregular (void)
+{
+    struct taskmap *map;
+    int nodeids[4096];
+    int ntasks = 0;
+    int errors = 0;
+
+    if (!(map = taskmap_create ()))
+        BAIL_OUT ("taskmap_create failed");
+    for (int i = 0; i < 200; i++) {
+        int nodeid = (i * 7) % 50;
+        int ppn = 1 + i % 3;
+        if (taskmap_append (map, nodeid, 1, ppn) < 0)
+            BAIL_OUT ("taskmap_append failed");
+        for (int j = 0; j < ppn; j++)
+            nodeids[ntasks++] = nodeid;
+    }
+    ok (taskmap_total_ntasks (map) == ntasks && taskmap_nnodes (map) == 50,
+        "irregular map has %d tasks on 50 nodes", ntasks);
+    for (int i = 0; i < ntasks; i++) {
+        const struct idset *ids = taskmap_taskids (map, nodeids[i]);
+        if (taskmap_nodeid (map, i) != nodeids[i]
+            || !ids
+            || !idset_test (ids, i))
+            errors++;
+    }
+    ok (errors == 0,
+        "taskmap_nodeid and taskmap_taskids agree for every task");
+
+    if (taskmap_append (map, 60, 2, 4) < 0)
+        BAIL_OUT ("taskmap_append failed");
+    ok (taskmap_nnodes (map) == 62
+        && taskmap_total_ntasks (map) == ntasks + 8,
+        "taskmap_nnodes and taskmap_total_ntasks reflect appended block");
+    ok (taskmap_nodeid (map, ntasks + 5) == 61
+        && taskmap_ntasks (map, 61) == 4,
+        "lookups reflect appended block");
+    errno = 0;
+    ok (taskmap_taskids (map, 55) == NULL && errno == ENOENT,
+        "taskmap_taskids on node without tasks fails with ENOENT");
+    errno = 0;
+    ok (taskmap_nodeid (map, ntasks + 8) < 0 && errno == ENOENT,
+        "taskmap_nodeid past last task fails with ENOENT");
+    taskmap_destroy (map);
+}
+
 int main (int ac, char **av)
 {
     plan (NO_PLAN);
@@ -607,6 +656,7 @@ int main (int ac, char **av)
     test_check ();
     test_deranged ();
     test_raw_decode_errors ();
+    test_lookup_irregular ();
     done_testing ();
 }
 
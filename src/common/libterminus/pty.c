@@ -36,6 +36,11 @@
  *
  *  ENODATA: End of streaming RPC
  *
+ *  Output read from the pty is coalesced for up to 'output_delay'
+ *   seconds or PTY_OUTPUT_MAX bytes before it is sent, so a burst of
+ *   small reads is delivered in a few data messages instead of one per
+ *   read.  Buffered output is always sent before any exit message.
+ *
  */
 
 #if HAVE_CONFIG_H
@@ -65,6 +70,10 @@
 
 #include "pty.h"
 
+#define PTY_OUTPUT_MAX (16*1024)
+
+static const double output_delay = 0.002;
+
 struct pty_client {
     char *uuid;
     const flux_msg_t *req;
@@ -83,6 +92,11 @@ struct flux_pty {
     char *follower;
     flux_watcher_t *fdw;
 
+    flux_watcher_t *flush_w;
+    bool flush_pending;
+    size_t outlen;
+    char outbuf[PTY_OUTPUT_MAX];
+
     bool wait_for_client;
     bool wait_on_close;
     bool exited;
@@ -168,9 +182,14 @@ static int pty_client_send_exit (struct flux_pty *pty,
     return flux_respond_error (pty->h, c->req, ENODATA, NULL);
 }
 
+static void pty_output_flush (struct flux_pty *pty);
+
 static int pty_clients_notify_exit (struct flux_pty *pty)
 {
-    struct pty_client *c = zlist_first (pty->clients);
+    struct pty_client *c;
+
+    pty_output_flush (pty);
+    c = zlist_first (pty->clients);
     while (c) {
         if (pty_client_send_exit (pty, c, "session exiting", pty->status) < 0)
             llog_error (pty, "send_exit: %s", flux_strerror (errno));
@@ -182,6 +201,7 @@ static int pty_clients_notify_exit (struct flux_pty *pty)
 static int pty_client_detach (struct flux_pty *pty, struct pty_client *c)
 {
     if (c) {
+        pty_output_flush (pty);
         pty_client_send_exit (pty, c, "Client requested detach", 0);
         zlist_remove (pty->clients, c);
         pty_client_destroy (c);
@@ -238,6 +258,7 @@ void flux_pty_destroy (struct flux_pty *pty)
     if (pty) {
         flux_watcher_destroy (pty->fdw);
         pty_clients_notify_exit (pty);
+        flux_watcher_destroy (pty->flush_w);
         pty_clients_destroy (pty);
         zlist_destroy (&pty->clients);
         if (pty->leader >= 0)
@@ -254,8 +275,10 @@ static void check_pty_complete (struct flux_pty *pty)
                 pty->wait_for_client, pty->wait_on_close, pty->exited);
     if (!pty->wait_for_client
         && !pty->wait_on_close
-        && pty->exited)
+        && pty->exited) {
+        pty_output_flush (pty);
         (*pty->complete) (pty);
+    }
 }
 
 void flux_pty_exited (struct flux_pty *pty, int status)
@@ -474,6 +497,32 @@ void pty_client_send_data (struct flux_pty *pty, void *data, int len)
     }
 }
 
+/*  Send any buffered output to the monitor and clients.
+ */
+static void pty_output_flush (struct flux_pty *pty)
+{
+    if (pty->flush_pending) {
+        flux_watcher_stop (pty->flush_w);
+        pty->flush_pending = false;
+    }
+    if (pty->outlen > 0) {
+        size_t len = pty->outlen;
+        pty->outlen = 0;
+        pty_client_send_data (pty, pty->outbuf, len);
+    }
+}
+
+static void pty_flush_cb (flux_reactor_t *r,
+                          flux_watcher_t *w,
+                          int revents,
+                          void *arg)
+{
+    struct flux_pty *pty = arg;
+
+    pty->flush_pending = false;
+    pty_output_flush (pty);
+}
+
 void pty_client_monitor_send_eof (struct flux_pty *pty)
 {
     if (pty->monitor)
@@ -487,13 +536,14 @@ static void pty_read (flux_reactor_t *r,
 {
     struct flux_pty *pty = arg;
     ssize_t n;
-    char buf [4096];
 
     /* XXX: notify all clients and exit */
     if (revents & FLUX_POLLERR)
         return;
 
-    n = read (pty->leader, buf, sizeof (buf));
+    n = read (pty->leader,
+              pty->outbuf + pty->outlen,
+              sizeof (pty->outbuf) - pty->outlen);
     if (n < 0) {
         if (errno == EAGAIN || errno == EINTR)
             return;
@@ -504,6 +554,7 @@ static void pty_read (flux_reactor_t *r,
          *   for completion:
          */
         if (errno == EIO) {
+            pty_output_flush (pty);
             flux_watcher_stop (pty->fdw);
             pty->wait_on_close = false;
             check_pty_complete (pty);
@@ -513,8 +564,16 @@ static void pty_read (flux_reactor_t *r,
         llog_error (pty, "read: %s", strerror (errno));
         return;
     }
-    else if (n > 0)
-        pty_client_send_data (pty, buf, n);
+    else if (n > 0) {
+        pty->outlen += n;
+        if (pty->outlen == sizeof (pty->outbuf))
+            pty_output_flush (pty);
+        else if (!pty->flush_pending) {
+            flux_timer_watcher_reset (pty->flush_w, output_delay, 0.);
+            flux_watcher_start (pty->flush_w);
+            pty->flush_pending = true;
+        }
+    }
 }
 
 static int pty_resize (struct flux_pty *pty, const flux_msg_t *msg)
@@ -813,6 +872,12 @@ int flux_pty_set_flux (struct flux_pty *pty, flux_t *h)
                                        pty);
     if (!pty->fdw)
         return -1;
+    if (!(pty->flush_w = flux_timer_watcher_create (flux_get_reactor (h),
+                                                    output_delay,
+                                                    0.,
+                                                    pty_flush_cb,
+                                                    pty)))
+        return -1;
 
     fd_set_nonblocking (pty->leader);
 
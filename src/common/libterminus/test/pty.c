@@ -15,6 +15,9 @@
 #include <stdio.h>
 #include <string.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
 
 #include <flux/core.h>
 #include "src/common/libterminus/pty.h"
@@ -487,6 +490,75 @@ void test_monitor ()
     flux_close (h);
 }
 
+struct coalesce_ctx {
+    int calls;
+    int total;
+};
+
+static void coalesce_monitor_cb (struct flux_pty *pty, void *data, int len)
+{
+    struct coalesce_ctx *ctx = flux_pty_aux_get (pty, "ctx");
+    if (len > 0) {
+        ctx->calls++;
+        ctx->total += len;
+    }
+}
+
+static void stop_cb (flux_reactor_t *r,
+                     flux_watcher_t *w,
+                     int revents,
+                     void *arg)
+{
+    flux_reactor_stop (r);
+}
+
+void test_coalesce ()
+{
+    struct coalesce_ctx ctx = { 0 };
+    flux_t *h = flux_open ("loop://", 0);
+    struct flux_pty *pty = flux_pty_open ();
+    flux_watcher_t *w;
+    struct termios tio;
+    int fd;
+    int i;
+
+    if (!h || !pty)
+        BAIL_OUT ("Unable to create test handle and pty");
+    if ((fd = open (flux_pty_name (pty), O_RDWR | O_NOCTTY)) < 0
+        || tcgetattr (fd, &tio) < 0)
+        BAIL_OUT ("Unable to open pty follower");
+    cfmakeraw (&tio);
+    if (tcsetattr (fd, TCSANOW, &tio) < 0)
+        BAIL_OUT ("Unable to set pty follower to raw mode");
+    if (flux_pty_set_flux (pty, h) < 0
+        || flux_pty_aux_set (pty, "ctx", &ctx, NULL) < 0)
+        BAIL_OUT ("Unable to set up pty");
+    flux_pty_monitor (pty, coalesce_monitor_cb);
+
+    for (i = 0; i < 100; i++) {
+        if (write (fd, "0123456789", 10) != 10)
+            BAIL_OUT ("write to pty follower failed");
+    }
+    if (!(w = flux_timer_watcher_create (flux_get_reactor (h),
+                                         0.5,
+                                         0.,
+                                         stop_cb,
+                                         NULL)))
+        BAIL_OUT ("flux_timer_watcher_create failed");
+    flux_watcher_start (w);
+    ok (flux_reactor_run (flux_get_reactor (h), 0) >= 0,
+        "reactor ran until timeout");
+    ok (ctx.total == 1000,
+        "monitor received all 1000 bytes written");
+    ok (ctx.calls < 100,
+        "output of 100 writes was coalesced into %d chunks", ctx.calls);
+
+    flux_watcher_destroy (w);
+    close (fd);
+    flux_pty_destroy (pty);
+    flux_close (h);
+}
+
 int main (int argc, char *argv[])
 {
     plan (NO_PLAN);
@@ -496,6 +568,7 @@ int main (int argc, char *argv[])
     test_basic_protocol ();
     test_client ();
     test_monitor ();
+    test_coalesce ();
     done_testing ();
     return 0;
 }
@@ -0,0 +1,267 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* b64.c - base64 encoding with a vectorized bulk loop
+ *
+ * The vector loops follow W. Mula and D. Lemire, "Faster Base64 Encoding
+ * and Decoding Using AVX2 Instructions" (2018), restricted to SSSE3:
+ * 12 input bytes are expanded to 16 6-bit values and translated to ASCII
+ * with byte shuffles, and decoding reverses this, flagging invalid
+ * characters with a pair of nibble lookup tables.  When a vector block
+ * contains an invalid character, or near the end of the input, the
+ * scalar code takes over and handles errors and padding.
+ *
+ * As in sha256_hw.c, the vector code is compiled with a target attribute
+ * and selected at runtime after checking the CPU.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+
+#include "b64.h"
+
+static const char enc_map[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static const int8_t dec_map[256] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1, -1, 63,
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+    -1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1,
+    -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#include <cpuid.h>
+
+#define HAVE_B64_SSSE3 1
+
+/* Encode 12 bytes per iteration while 16 bytes may be loaded.
+ * Return the number of bytes consumed.
+ */
+__attribute__((target ("ssse3")))
+static size_t encode_ssse3 (char *dst, const unsigned char *src, size_t len)
+{
+    const __m128i shuf = _mm_set_epi8 (10, 11, 9, 10, 7, 8, 6, 7,
+                                       4, 5, 3, 4, 1, 2, 0, 1);
+    const __m128i lut = _mm_setr_epi8 (65, 71, -4, -4, -4, -4, -4, -4,
+                                       -4, -4, -4, -4, -19, -16, 0, 0);
+    size_t i = 0;
+
+    for (; len - i >= 16; i += 12, dst += 16) {
+        __m128i in = _mm_loadu_si128 ((const __m128i *)(src + i));
+        __m128i t0, t1, idx, off;
+
+        /* split each 3 bytes into four 6-bit values */
+        in = _mm_shuffle_epi8 (in, shuf);
+        t0 = _mm_and_si128 (in, _mm_set1_epi32 (0x0fc0fc00));
+        t0 = _mm_mulhi_epu16 (t0, _mm_set1_epi32 (0x04000040));
+        t1 = _mm_and_si128 (in, _mm_set1_epi32 (0x003f03f0));
+        t1 = _mm_mullo_epi16 (t1, _mm_set1_epi32 (0x01000010));
+        in = _mm_or_si128 (t0, t1);
+
+        /* add the offset from each value to its character */
+        idx = _mm_subs_epu8 (in, _mm_set1_epi8 (51));
+        idx = _mm_sub_epi8 (idx, _mm_cmpgt_epi8 (in, _mm_set1_epi8 (25)));
+        off = _mm_shuffle_epi8 (lut, idx);
+        _mm_storeu_si128 ((__m128i *)dst, _mm_add_epi8 (in, off));
+    }
+    return i;
+}
+
+/* Decode 16 characters per iteration while more than 24 remain, so that
+ * padding is left for the scalar code and 16 bytes may be stored.
+ * Stop early at a block containing an invalid character.
+ * Return the number of characters consumed.
+ */
+__attribute__((target ("ssse3")))
+static size_t decode_ssse3 (char *dst, const unsigned char *src, size_t len)
+{
+    const __m128i lut_lo = _mm_setr_epi8 (0x15, 0x11, 0x11, 0x11,
+                                          0x11, 0x11, 0x11, 0x11,
+                                          0x11, 0x11, 0x13, 0x1a,
+                                          0x1b, 0x1b, 0x1b, 0x1a);
+    const __m128i lut_hi = _mm_setr_epi8 (0x10, 0x10, 0x01, 0x02,
+                                          0x04, 0x08, 0x04, 0x08,
+                                          0x10, 0x10, 0x10, 0x10,
+                                          0x10, 0x10, 0x10, 0x10);
+    const __m128i lut_roll = _mm_setr_epi8 (0, 16, 19, 4, -65, -65, -71, -71,
+                                            0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i pack = _mm_setr_epi8 (2, 1, 0, 6, 5, 4, 10, 9, 8,
+                                        14, 13, 12, -1, -1, -1, -1);
+    const __m128i mask_2f = _mm_set1_epi8 (0x2f);
+    size_t i = 0;
+
+    for (; len - i > 24; i += 16, dst += 12) {
+        __m128i in = _mm_loadu_si128 ((const __m128i *)(src + i));
+        __m128i hi_nibbles = _mm_and_si128 (_mm_srli_epi32 (in, 4), mask_2f);
+        __m128i lo_nibbles = _mm_and_si128 (in, mask_2f);
+        __m128i hi = _mm_shuffle_epi8 (lut_hi, hi_nibbles);
+        __m128i lo = _mm_shuffle_epi8 (lut_lo, lo_nibbles);
+        __m128i roll;
+
+        /* a character is invalid if its nibbles share a class bit */
+        if (_mm_movemask_epi8 (_mm_cmpgt_epi8 (_mm_and_si128 (lo, hi),
+                                               _mm_setzero_si128 ())))
+            break;
+        roll = _mm_add_epi8 (_mm_cmpeq_epi8 (in, mask_2f), hi_nibbles);
+        in = _mm_add_epi8 (in, _mm_shuffle_epi8 (lut_roll, roll));
+
+        /* pack four 6-bit values into 3 bytes in each 32-bit lane */
+        in = _mm_maddubs_epi16 (in, _mm_set1_epi32 (0x01400140));
+        in = _mm_madd_epi16 (in, _mm_set1_epi32 (0x00011000));
+        _mm_storeu_si128 ((__m128i *)dst, _mm_shuffle_epi8 (in, pack));
+    }
+    return i;
+}
+
+static bool have_ssse3 (void)
+{
+    unsigned int eax, ebx, ecx, edx;
+
+    if (__get_cpuid_max (0, NULL) < 1)
+        return false;
+    __cpuid (1, eax, ebx, ecx, edx);
+    return (ecx & (1 << 9)) ? true : false;
+}
+
+/* Return true if the vector code may be used, checking the CPU once.
+ */
+static bool use_vector (void)
+{
+    static int state = 0; // 0 = unknown, 1 = no, 2 = yes
+    int val;
+
+    if (!(val = __atomic_load_n (&state, __ATOMIC_RELAXED))) {
+        val = have_ssse3 () ? 2 : 1;
+        __atomic_store_n (&state, val, __ATOMIC_RELAXED);
+    }
+    return val == 2;
+}
+#endif
+
+size_t b64_encoded_length (size_t srclen)
+{
+    return ((srclen + 2) / 3) * 4;
+}
+
+size_t b64_decoded_length (size_t srclen)
+{
+    return ((srclen + 3) / 4) * 3;
+}
+
+ssize_t b64_encode (char *dst, size_t dstlen, const void *src, size_t srclen)
+{
+    const unsigned char *s = src;
+    char *p = dst;
+    size_t i = 0;
+
+    if (dstlen < b64_encoded_length (srclen) + 1) {
+        errno = EOVERFLOW;
+        return -1;
+    }
+#if HAVE_B64_SSSE3
+    if (use_vector ()) {
+        i = encode_ssse3 (p, s, srclen);
+        p += i / 3 * 4;
+    }
+#endif
+    for (; srclen - i >= 3; i += 3) {
+        uint32_t v = s[i] << 16 | s[i + 1] << 8 | s[i + 2];
+        *p++ = enc_map[v >> 18];
+        *p++ = enc_map[(v >> 12) & 0x3f];
+        *p++ = enc_map[(v >> 6) & 0x3f];
+        *p++ = enc_map[v & 0x3f];
+    }
+    if (i < srclen) {
+        uint32_t v = s[i] << 16;
+        if (srclen - i == 2)
+            v |= s[i + 1] << 8;
+        *p++ = enc_map[v >> 18];
+        *p++ = enc_map[(v >> 12) & 0x3f];
+        *p++ = srclen - i == 2 ? enc_map[(v >> 6) & 0x3f] : '=';
+        *p++ = '=';
+    }
+    *p = '\0';
+    return p - dst;
+}
+
+ssize_t b64_decode (void *dst, size_t dstlen, const char *src, size_t srclen)
+{
+    const unsigned char *s = (const unsigned char *)src;
+    char *p = dst;
+    size_t len = srclen;
+    size_t i = 0;
+    int a, b, c, d;
+
+    if (dstlen < b64_decoded_length (srclen)) {
+        errno = EOVERFLOW;
+        return -1;
+    }
+    if (len > 0 && s[len - 1] == '=')
+        len--;
+    if (len > 0 && s[len - 1] == '=')
+        len--;
+#if HAVE_B64_SSSE3
+    if (use_vector ()) {
+        i = decode_ssse3 (p, s, len);
+        p += i / 4 * 3;
+    }
+#endif
+    for (; len - i >= 4; i += 4) {
+        a = dec_map[s[i]];
+        b = dec_map[s[i + 1]];
+        c = dec_map[s[i + 2]];
+        d = dec_map[s[i + 3]];
+        if ((a | b | c | d) < 0)
+            goto inval;
+        *p++ = a << 2 | b >> 4;
+        *p++ = (b & 0xf) << 4 | c >> 2;
+        *p++ = (c & 0x3) << 6 | d;
+    }
+    if (len - i == 1)
+        goto inval;
+    if (len - i >= 2) {
+        a = dec_map[s[i]];
+        b = dec_map[s[i + 1]];
+        c = len - i == 3 ? dec_map[s[i + 2]] : 0;
+        if ((a | b | c) < 0)
+            goto inval;
+        *p++ = a << 2 | b >> 4;
+        if (len - i == 3)
+            *p++ = (b & 0xf) << 4 | c >> 2;
+    }
+    if (p - (char *)dst < dstlen)
+        *p = '\0';
+    return p - (char *)dst;
+inval:
+    errno = EINVAL;
+    return -1;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,47 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _UTIL_B64_H
+#define _UTIL_B64_H
+
+#include <sys/types.h>
+
+/* Standard (RFC 4648) padded base64, compatible with ccan/base64 but
+ * using SSSE3 instructions on x86-64 CPUs that have them.
+ */
+
+/* Return the length of the base64 encoding of 'srclen' bytes,
+ * not including the NUL terminator.
+ */
+size_t b64_encoded_length (size_t srclen);
+
+/* Return the maximum number of bytes decoded from 'srclen' characters.
+ */
+size_t b64_decoded_length (size_t srclen);
+
+/* Encode 'srclen' bytes of 'src' as a NUL terminated string in 'dst',
+ * which must have room for b64_encoded_length (srclen) + 1 characters.
+ * Return the length of the string, or -1 with errno = EOVERFLOW.
+ */
+ssize_t b64_encode (char *dst, size_t dstlen, const void *src, size_t srclen);
+
+/* Decode 'srclen' characters of 'src' into 'dst', which must have room
+ * for b64_decoded_length (srclen) bytes.  Padding may be omitted.
+ * If there is room, a NUL byte is stored after the decoded data.
+ * Return the number of bytes decoded, or -1 with errno = EOVERFLOW or
+ * EINVAL if 'src' is not valid base64.
+ */
+ssize_t b64_decode (void *dst, size_t dstlen, const char *src, size_t srclen);
+
+#endif /* !_UTIL_B64_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -24,6 +24,9 @@
 #include "blobref.h"
 #include "sha1.h"
 #include "sha256.h"
+#if HAVE_BLAKE3
+#include <blake3.h>
+#endif
 
 #define SHA1_PREFIX_STRING  "sha1-"
 #define SHA1_PREFIX_LENGTH  5
@@ -46,8 +49,24 @@
 #error BLOBREF_MAX_DIGEST_SIZE is too small
 #endif
 
+#if HAVE_BLAKE3
+#define BLAKE3_PREFIX_STRING  "blake3-"
+#define BLAKE3_PREFIX_LENGTH  7
+#define BLAKE3_STRING_SIZE    (BLAKE3_OUT_LEN*2 + BLAKE3_PREFIX_LENGTH + 1)
+
+#if BLOBREF_MAX_STRING_SIZE < BLAKE3_STRING_SIZE
+#error BLOBREF_MAX_STRING_SIZE is too small
+#endif
+#if BLOBREF_MAX_DIGEST_SIZE < BLAKE3_OUT_LEN
+#error BLOBREF_MAX_DIGEST_SIZE is too small
+#endif
+#endif
+
 static void sha1_hash (const void *data, int data_len, void *hash, int hash_len);
 static void sha256_hash (const void *data, int data_len, void *hash, int hash_len);
+#if HAVE_BLAKE3
+static void blake3_hash (const void *data, int data_len, void *hash, int hash_len);
+#endif
 
 struct blobhash {
     char *name;
@@ -64,6 +83,12 @@ static struct blobhash blobtab[] = {
       .hashlen = SHA256_BLOCK_SIZE,
       .hashfun = sha256_hash,
     },
+#if HAVE_BLAKE3
+    { .name = "blake3",
+      .hashlen = BLAKE3_OUT_LEN,
+      .hashfun = blake3_hash,
+    },
+#endif
     { NULL, 0, 0 },
 };
 
@@ -87,6 +112,18 @@ static void sha256_hash (const void *data, int data_len, void *hash, int hash_le
     sha256_final (&ctx, hash);
 }
 
+#if HAVE_BLAKE3
+static void blake3_hash (const void *data, int data_len, void *hash, int hash_len)
+{
+    blake3_hasher hasher;
+
+    assert (hash_len == BLAKE3_OUT_LEN);
+    blake3_hasher_init (&hasher);
+    blake3_hasher_update (&hasher, data, data_len);
+    blake3_hasher_finalize (&hasher, hash, hash_len);
+}
+#endif
+
 /* true if s1 contains "s2-" prefix
  */
 static bool prefixmatch (const char *s1, const char *s2)
@@ -0,0 +1,145 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* bloom.c - bloom filter
+ *
+ * The k bit positions for a key are derived from two 64-bit hashes by
+ * double hashing (Kirsch and Mitzenmacher), h1 + i*h2 for i in [0,k).
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <errno.h>
+
+#include "bloom.h"
+
+struct bloom {
+    uint64_t *bits;
+    size_t nbits;
+    int nhashes;
+    size_t capacity;
+    size_t count;
+};
+
+/* 64-bit FNV-1a */
+static uint64_t hash_fnv1a (const void *key, size_t len)
+{
+    const unsigned char *p = key;
+    uint64_t h = 0xcbf29ce484222325ULL;
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+/* splitmix64 finalizer, to derive a second independent-ish hash */
+static uint64_t hash_mix (uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+static void hash_pair (const void *key, size_t len, uint64_t *h1, uint64_t *h2)
+{
+    *h1 = hash_fnv1a (key, len);
+    *h2 = hash_mix (*h1) | 1;
+}
+
+void bloom_add (struct bloom *b, const void *key, size_t len)
+{
+    uint64_t h1, h2;
+    int i;
+
+    if (!b)
+        return;
+    hash_pair (key, len, &h1, &h2);
+    for (i = 0; i < b->nhashes; i++) {
+        uint64_t bit = (h1 + i * h2) % b->nbits;
+        b->bits[bit / 64] |= 1ULL << (bit % 64);
+    }
+    b->count++;
+}
+
+bool bloom_check (struct bloom *b, const void *key, size_t len)
+{
+    uint64_t h1, h2;
+    int i;
+
+    if (!b)
+        return true;
+    hash_pair (key, len, &h1, &h2);
+    for (i = 0; i < b->nhashes; i++) {
+        uint64_t bit = (h1 + i * h2) % b->nbits;
+        if (!(b->bits[bit / 64] & (1ULL << (bit % 64))))
+            return false;
+    }
+    return true;
+}
+
+size_t bloom_count (struct bloom *b)
+{
+    return b ? b->count : 0;
+}
+
+size_t bloom_capacity (struct bloom *b)
+{
+    return b ? b->capacity : 0;
+}
+
+void bloom_destroy (struct bloom *b)
+{
+    if (b) {
+        int saved_errno = errno;
+        free (b->bits);
+        free (b);
+        errno = saved_errno;
+    }
+}
+
+/* Optimal sizing: m = -n ln(p) / (ln 2)^2 bits, k = (m/n) ln 2 hashes.
+ */
+struct bloom *bloom_create (size_t capacity, double fp_rate)
+{
+    struct bloom *b;
+    double m;
+
+    if (capacity == 0 || !(fp_rate > 0 && fp_rate < 1)) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(b = calloc (1, sizeof (*b))))
+        return NULL;
+    m = ceil (-1. * capacity * log (fp_rate) / (M_LN2 * M_LN2));
+    b->nbits = ((size_t)m + 63) / 64 * 64;
+    b->nhashes = (int)round ((double)b->nbits / capacity * M_LN2);
+    if (b->nhashes < 1)
+        b->nhashes = 1;
+    b->capacity = capacity;
+    if (!(b->bits = calloc (b->nbits / 64, sizeof (b->bits[0])))) {
+        bloom_destroy (b);
+        return NULL;
+    }
+    return b;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,41 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _UTIL_BLOOM_H
+#define _UTIL_BLOOM_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/*  Bloom filter: a set membership test that may return false positives
+ *  but never false negatives.  Keys cannot be removed.
+ *
+ *  The filter is sized for 'capacity' keys with a false positive rate of
+ *  'fp_rate' (0 < fp_rate < 1).  The rate rises if more keys are added.
+ */
+struct bloom *bloom_create (size_t capacity, double fp_rate);
+void bloom_destroy (struct bloom *b);
+
+void bloom_add (struct bloom *b, const void *key, size_t len);
+
+/*  Returns false if 'key' was definitely never added.
+ */
+bool bloom_check (struct bloom *b, const void *key, size_t len);
+
+/*  Return the number of keys added and the capacity.
+ */
+size_t bloom_count (struct bloom *b);
+size_t bloom_capacity (struct bloom *b);
+
+#endif /* !_UTIL_BLOOM_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
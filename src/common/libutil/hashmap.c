@@ -0,0 +1,382 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* hashmap.c - Robin Hood hash table with inline keys
+ *
+ * The table is one array of fixed size slots.  Each slot holds the item,
+ * 32 bits of the key's hash, 'dist', one more than the distance of the
+ * slot from the key's home slot (0 means empty), and the key itself.
+ * On insert, an entry that has probed further than the occupant of a
+ * slot takes the slot, and the occupant continues probing, so a lookup
+ * can stop as soon as it reaches a slot whose occupant is closer to home
+ * than the key would be.  Delete shifts the following entries back, so no
+ * tombstones are needed.  libjob/jobmap.c is a typed wrapper for job ids.
+ *
+ * The stored hash lets most mismatches be rejected without calling the
+ * equal function, and lets the table grow without rehashing keys.  The
+ * user's hash is spread with a multiply by 2^64/phi (Fibonacci hashing),
+ * so a hash function that simply returns some bytes of a key that is
+ * already random, such as a digest, works well.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <sys/types.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include "hashmap.h"
+
+#define HASHMAP_MIN_BITS 6
+#define HASHMAP_MAX_BITS 32
+
+struct slot {
+    void *item;
+    uint32_t hash;
+    uint32_t dist;
+    /* key follows */
+};
+
+struct hashmap {
+    char *slots;
+    struct slot *scratch;       // two slots used while placing entries
+    size_t stride;
+    unsigned int bits;
+    size_t mask;
+    size_t size;
+    size_t cursor;
+    size_t keysize;
+    bool strings;
+    hashmap_hash_f hash;
+    hashmap_equal_f equal;
+    hashmap_destructor_f destructor;
+};
+
+static inline struct slot *slot_at (struct hashmap *map, size_t i)
+{
+    return (struct slot *)(map->slots + i * map->stride);
+}
+
+static inline void *slot_key (struct slot *s)
+{
+    return s + 1;
+}
+
+static inline uint32_t hashmap_hash (struct hashmap *map, const void *key)
+{
+    uint64_t h = map->hash (key, map->keysize);
+    return (uint32_t)((h * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+static inline size_t slot_home (struct hashmap *map, uint32_t hash)
+{
+    return hash >> (32 - map->bits);
+}
+
+/* Grow the table when it is more than 7/8 full.
+ */
+static inline bool hashmap_full (struct hashmap *map)
+{
+    return (map->size + 1) * 8 > (map->mask + 1) * 7;
+}
+
+/* Place the entry in 'entry' (a slot sized buffer), which is clobbered.
+ * 'tmp' is scratch space of the same size.
+ */
+static void slot_place (struct hashmap *map,
+                        struct slot *entry,
+                        struct slot *tmp)
+{
+    size_t i = slot_home (map, entry->hash);
+
+    entry->dist = 1;
+    for (;;) {
+        struct slot *s = slot_at (map, i);
+        if (s->dist == 0) {
+            memcpy (s, entry, map->stride);
+            return;
+        }
+        if (s->dist < entry->dist) {
+            memcpy (tmp, s, map->stride);
+            memcpy (s, entry, map->stride);
+            memcpy (entry, tmp, map->stride);
+        }
+        i = (i + 1) & map->mask;
+        entry->dist++;
+    }
+}
+
+static int hashmap_resize (struct hashmap *map, unsigned int bits)
+{
+    char *old = map->slots;
+    size_t old_count = old ? map->mask + 1 : 0;
+    char *slots;
+    struct slot *entry = map->scratch;
+    struct slot *tmp = (struct slot *)((char *)entry + map->stride);
+    size_t i;
+
+    if (bits > HASHMAP_MAX_BITS) {
+        errno = ENOMEM;
+        return -1;
+    }
+    if (!(slots = calloc ((size_t)1 << bits, map->stride)))
+        return -1;
+    map->slots = slots;
+    map->bits = bits;
+    map->mask = ((size_t)1 << bits) - 1;
+    for (i = 0; i < old_count; i++) {
+        struct slot *s = (struct slot *)(old + i * map->stride);
+        if (s->dist > 0) {
+            memcpy (entry, s, map->stride);
+            slot_place (map, entry, tmp);
+        }
+    }
+    free (old);
+    return 0;
+}
+
+/* Return the index of the slot holding 'key', or -1 if not found.
+ */
+static ssize_t slot_find (struct hashmap *map, const void *key, uint32_t hash)
+{
+    size_t i = slot_home (map, hash);
+    uint32_t dist = 1;
+
+    for (;;) {
+        struct slot *s = slot_at (map, i);
+        if (s->dist < dist)
+            return -1;
+        if (s->hash == hash && map->equal (slot_key (s), key, map->keysize))
+            return i;
+        i = (i + 1) & map->mask;
+        dist++;
+    }
+}
+
+size_t hashmap_size (struct hashmap *map)
+{
+    return map ? map->size : 0;
+}
+
+int hashmap_insert (struct hashmap *map, const void *key, void *item)
+{
+    struct slot *entry;
+    size_t len;
+    uint32_t hash;
+
+    if (!map || !key) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (map->strings) {
+        if ((len = strlen (key) + 1) > map->keysize) {
+            errno = EINVAL;
+            return -1;
+        }
+    }
+    else
+        len = map->keysize;
+    hash = hashmap_hash (map, key);
+    if (slot_find (map, key, hash) >= 0) {
+        errno = EEXIST;
+        return -1;
+    }
+    if (hashmap_full (map) && hashmap_resize (map, map->bits + 1) < 0)
+        return -1;
+    entry = map->scratch;
+    memset (entry, 0, map->stride);
+    entry->item = item;
+    entry->hash = hash;
+    memcpy (slot_key (entry), key, len);
+    slot_place (map, entry, (struct slot *)((char *)entry + map->stride));
+    map->size++;
+    return 0;
+}
+
+void *hashmap_lookup (struct hashmap *map, const void *key)
+{
+    ssize_t i;
+
+    if (!map || !key)
+        return NULL;
+    if ((i = slot_find (map, key, hashmap_hash (map, key))) < 0)
+        return NULL;
+    return slot_at (map, i)->item;
+}
+
+void hashmap_delete (struct hashmap *map, const void *key)
+{
+    ssize_t i;
+    size_t next;
+    void *item;
+
+    if (!map || !key)
+        return;
+    if ((i = slot_find (map, key, hashmap_hash (map, key))) < 0)
+        return;
+    item = slot_at (map, i)->item;
+    next = (i + 1) & map->mask;
+    while (slot_at (map, next)->dist > 1) {
+        memcpy (slot_at (map, i), slot_at (map, next), map->stride);
+        slot_at (map, i)->dist--;
+        i = next;
+        next = (next + 1) & map->mask;
+    }
+    memset (slot_at (map, i), 0, map->stride);
+    map->size--;
+    /* Call the destructor last, in case it reenters the map.
+     */
+    if (map->destructor)
+        map->destructor (&item);
+}
+
+void hashmap_purge (struct hashmap *map)
+{
+    if (map && map->slots) {
+        size_t i;
+        for (i = 0; i <= map->mask; i++) {
+            struct slot *s = slot_at (map, i);
+            if (s->dist > 0) {
+                if (map->destructor)
+                    map->destructor (&s->item);
+                memset (s, 0, map->stride);
+            }
+        }
+        map->size = 0;
+    }
+}
+
+static void *hashmap_scan (struct hashmap *map)
+{
+    while (map->cursor <= map->mask) {
+        struct slot *s = slot_at (map, map->cursor);
+        if (s->dist > 0)
+            return s->item;
+        map->cursor++;
+    }
+    return NULL;
+}
+
+void *hashmap_first (struct hashmap *map)
+{
+    if (!map)
+        return NULL;
+    map->cursor = 0;
+    return hashmap_scan (map);
+}
+
+void *hashmap_next (struct hashmap *map)
+{
+    if (!map || map->cursor > map->mask)
+        return NULL;
+    map->cursor++;
+    return hashmap_scan (map);
+}
+
+const void *hashmap_cursor (struct hashmap *map)
+{
+    if (!map || map->cursor > map->mask)
+        return NULL;
+    return slot_key (slot_at (map, map->cursor));
+}
+
+void hashmap_set_destructor (struct hashmap *map,
+                             hashmap_destructor_f destructor)
+{
+    if (map)
+        map->destructor = destructor;
+}
+
+size_t hashmap_hash_bytes (const void *key, size_t keysize)
+{
+    const unsigned char *p = key;
+    uint64_t h = 0xcbf29ce484222325ULL;
+
+    while (keysize-- > 0) {
+        h ^= *p++;
+        h *= 0x100000001b3ULL;
+    }
+    return (size_t)h;
+}
+
+static bool hashmap_equal_bytes (const void *key1,
+                                 const void *key2,
+                                 size_t keysize)
+{
+    return memcmp (key1, key2, keysize) == 0;
+}
+
+static size_t hashmap_hash_string (const void *key, size_t keysize)
+{
+    return hashmap_hash_bytes (key, strlen (key));
+}
+
+static bool hashmap_equal_string (const void *key1,
+                                  const void *key2,
+                                  size_t keysize)
+{
+    return strcmp (key1, key2) == 0;
+}
+
+void hashmap_destroy (struct hashmap *map)
+{
+    if (map) {
+        int saved_errno = errno;
+        hashmap_purge (map);
+        free (map->slots);
+        free (map->scratch);
+        free (map);
+        errno = saved_errno;
+    }
+}
+
+struct hashmap *hashmap_create (size_t keysize,
+                                hashmap_hash_f hash,
+                                hashmap_equal_f equal)
+{
+    struct hashmap *map;
+    size_t align = sizeof (void *);
+
+    if (keysize == 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(map = calloc (1, sizeof (*map))))
+        return NULL;
+    map->keysize = keysize;
+    map->stride = sizeof (struct slot) + (keysize + align - 1) / align * align;
+    map->hash = hash ? hash : hashmap_hash_bytes;
+    map->equal = equal ? equal : hashmap_equal_bytes;
+    if (!(map->scratch = malloc (map->stride * 2))
+        || hashmap_resize (map, HASHMAP_MIN_BITS) < 0) {
+        hashmap_destroy (map);
+        return NULL;
+    }
+    return map;
+}
+
+struct hashmap *hashmap_create_string (size_t maxlen)
+{
+    struct hashmap *map;
+
+    if (!(map = hashmap_create (maxlen + 1,
+                                hashmap_hash_string,
+                                hashmap_equal_string)))
+        return NULL;
+    map->strings = true;
+    return map;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,89 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/*
+ *  hashmap - open addressing hash table with inline keys
+ *
+ *  Keys have a fixed maximum size chosen when the map is created and are
+ *  copied into the table, so inserting an item allocates nothing unless
+ *  the table grows, and the key need not remain valid for the lifetime of
+ *  the item.  This suits small keys such as hash digests, blobrefs, and
+ *  integer ids.  Items are stored by pointer.
+ *
+ *  The destructor has the same signature as its zhashx counterpart, so
+ *  the same function may be used with either container.
+ */
+
+#ifndef _UTIL_HASHMAP_H
+#define _UTIL_HASHMAP_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef size_t (*hashmap_hash_f) (const void *key, size_t keysize);
+typedef bool (*hashmap_equal_f) (const void *key1,
+                                 const void *key2,
+                                 size_t keysize);
+typedef void (*hashmap_destructor_f) (void **item);
+
+/*  Create a map for keys of exactly 'keysize' bytes.  If 'hash' or 'equal'
+ *  is NULL, hashmap_hash_bytes() or memcmp() is used.
+ */
+struct hashmap *hashmap_create (size_t keysize,
+                                hashmap_hash_f hash,
+                                hashmap_equal_f equal);
+
+/*  Create a map for NUL terminated string keys of at most 'maxlen'
+ *  characters.
+ */
+struct hashmap *hashmap_create_string (size_t maxlen);
+
+void hashmap_destroy (struct hashmap *map);
+
+void hashmap_set_destructor (struct hashmap *map,
+                             hashmap_destructor_f destructor);
+
+size_t hashmap_size (struct hashmap *map);
+
+/*  Insert 'item' under 'key'.  Fail with EEXIST if 'key' is already
+ *  present, or EINVAL if a string key is longer than the maximum.
+ */
+int hashmap_insert (struct hashmap *map, const void *key, void *item);
+
+/*  Return the item stored under 'key', or NULL if not found.
+ */
+void *hashmap_lookup (struct hashmap *map, const void *key);
+
+/*  Remove the item stored under 'key', destroying it with the destructor,
+ *  if any.  This is a no-op if 'key' is not present.
+ */
+void hashmap_delete (struct hashmap *map, const void *key);
+
+/*  Remove all items.
+ */
+void hashmap_purge (struct hashmap *map);
+
+/*  Iterate over items in no particular order.  As with zhashx, the map
+ *  must not be modified during iteration.  hashmap_cursor() returns the
+ *  key of the current item.
+ */
+void *hashmap_first (struct hashmap *map);
+void *hashmap_next (struct hashmap *map);
+const void *hashmap_cursor (struct hashmap *map);
+
+/*  FNV-1a hash of 'keysize' bytes, the default hash function.
+ */
+size_t hashmap_hash_bytes (const void *key, size_t keysize);
+
+#endif /* !_UTIL_HASHMAP_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
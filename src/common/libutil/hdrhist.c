@@ -0,0 +1,193 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* hdrhist.c - mergeable log-linear histogram
+ *
+ * Values below 2^precision have one bucket each.  Above that, each
+ * power of two [2^k, 2^(k+1)) is split into 2^precision equal buckets.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hdrhist.h"
+
+#define MAX_OCTAVE 47
+
+struct hdrhist {
+    int precision;
+    int nbuckets;
+    uint64_t count;
+    double total;
+    double min;
+    double max;
+    uint64_t bucket[];
+};
+
+static int msb (uint64_t v)
+{
+    return 63 - __builtin_clzll (v);
+}
+
+static int value_to_bucket (const struct hdrhist *hist, uint64_t v)
+{
+    int sub_count = 1 << hist->precision;
+    int octave;
+    int b;
+
+    if (v < sub_count)
+        return v;
+    octave = msb (v);
+    b = (octave - hist->precision + 1) * sub_count
+        + ((v >> (octave - hist->precision)) & (sub_count - 1));
+    return b < hist->nbuckets ? b : hist->nbuckets - 1;
+}
+
+/* Return the exclusive upper bound of bucket 'b'.
+ */
+static uint64_t bucket_to_value (const struct hdrhist *hist, int b)
+{
+    int sub_count = 1 << hist->precision;
+    int octave;
+    uint64_t sub;
+
+    if (b < sub_count)
+        return b + 1;
+    octave = b / sub_count + hist->precision - 1;
+    sub = b % sub_count;
+    return (sub_count + sub + 1) << (octave - hist->precision);
+}
+
+struct hdrhist *hdrhist_create (int precision)
+{
+    struct hdrhist *hist;
+    int nbuckets;
+
+    if (precision < 1 || precision > 8) {
+        errno = EINVAL;
+        return NULL;
+    }
+    nbuckets = (MAX_OCTAVE - precision + 2) << precision;
+    if (!(hist = calloc (1, sizeof (*hist) + nbuckets * sizeof (uint64_t))))
+        return NULL;
+    hist->precision = precision;
+    hist->nbuckets = nbuckets;
+    return hist;
+}
+
+void hdrhist_destroy (struct hdrhist *hist)
+{
+    if (hist) {
+        int saved_errno = errno;
+        free (hist);
+        errno = saved_errno;
+    }
+}
+
+void hdrhist_record (struct hdrhist *hist, double value)
+{
+    uint64_t v;
+
+    if (!hist)
+        return;
+    if (value < 0)
+        value = 0;
+    v = value < 0x1p63 ? (uint64_t)value : UINT64_MAX;
+    if (hist->count == 0 || hist->min > value)
+        hist->min = value;
+    if (hist->count == 0 || hist->max < value)
+        hist->max = value;
+    hist->count++;
+    hist->total += value;
+    hist->bucket[value_to_bucket (hist, v)]++;
+}
+
+int hdrhist_merge (struct hdrhist *dst, const struct hdrhist *src)
+{
+    if (!dst || !src || dst->precision != src->precision) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (src->count == 0)
+        return 0;
+    if (dst->count == 0 || dst->min > src->min)
+        dst->min = src->min;
+    if (dst->count == 0 || dst->max < src->max)
+        dst->max = src->max;
+    dst->count += src->count;
+    dst->total += src->total;
+    for (int b = 0; b < dst->nbuckets; b++)
+        dst->bucket[b] += src->bucket[b];
+    return 0;
+}
+
+void hdrhist_clear (struct hdrhist *hist)
+{
+    if (hist) {
+        hist->count = 0;
+        hist->total = 0;
+        hist->min = 0;
+        hist->max = 0;
+        memset (hist->bucket, 0, hist->nbuckets * sizeof (hist->bucket[0]));
+    }
+}
+
+uint64_t hdrhist_count (const struct hdrhist *hist)
+{
+    return hist ? hist->count : 0;
+}
+
+double hdrhist_min (const struct hdrhist *hist)
+{
+    return hist ? hist->min : 0.;
+}
+
+double hdrhist_max (const struct hdrhist *hist)
+{
+    return hist ? hist->max : 0.;
+}
+
+double hdrhist_mean (const struct hdrhist *hist)
+{
+    return hist && hist->count > 0 ? hist->total / hist->count : 0.;
+}
+
+double hdrhist_quantile (const struct hdrhist *hist, double q)
+{
+    uint64_t target;
+    uint64_t sum = 0;
+
+    if (!hist || hist->count == 0)
+        return 0.;
+    /* Find the bucket containing the ceil(q * count)th smallest value.
+     */
+    target = q * hist->count;
+    if (target < q * hist->count || target == 0)
+        target++;
+    for (int b = 0; b < hist->nbuckets; b++) {
+        sum += hist->bucket[b];
+        if (sum >= target) {
+            double value = bucket_to_value (hist, b);
+            if (b == hist->nbuckets - 1 || value > hist->max)
+                value = hist->max;
+            return value;
+        }
+    }
+    return hist->max;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,59 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _UTIL_HDRHIST_H
+#define _UTIL_HDRHIST_H
+
+#include <stdint.h>
+
+/* Mergeable log-linear histogram of non-negative values.
+ *
+ * Each power of two is divided into 2^precision buckets, so a reported
+ * quantile exceeds the true value by at most a factor of 2^-precision.
+ * Values are bucketed by their integer part, so callers should choose a
+ * unit (e.g. microseconds) in which that resolution is acceptable.
+ * Values of 2^48 or more share the top bucket, whose quantile is reported
+ * as the maximum recorded value.
+ */
+
+struct hdrhist;
+
+/* Create a histogram with 'precision' bits (1 to 8) of sub-bucket
+ * resolution.  Returns NULL with errno set on failure.
+ */
+struct hdrhist *hdrhist_create (int precision);
+void hdrhist_destroy (struct hdrhist *hist);
+
+/* Record a value.  Negative values are recorded as zero.
+ */
+void hdrhist_record (struct hdrhist *hist, double value);
+
+/* Add the contents of 'src' to 'dst'.  Fails with EINVAL if the
+ * histograms have different precision.
+ */
+int hdrhist_merge (struct hdrhist *dst, const struct hdrhist *src);
+
+void hdrhist_clear (struct hdrhist *hist);
+
+uint64_t hdrhist_count (const struct hdrhist *hist);
+double hdrhist_min (const struct hdrhist *hist);
+double hdrhist_max (const struct hdrhist *hist);
+double hdrhist_mean (const struct hdrhist *hist);
+
+/* Return the upper bound of the bucket holding the 'q' quantile
+ * (0 < q <= 1), capped at the maximum recorded value, or 0 if empty.
+ */
+double hdrhist_quantile (const struct hdrhist *hist, double q);
+
+#endif /* !_UTIL_HDRHIST_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
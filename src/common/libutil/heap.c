@@ -0,0 +1,321 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* heap.c - binary heap with handles
+ *
+ * Items are held in nodes that record their position in the heap array,
+ * so a node pointer serves as a stable handle for delete and reorder.
+ *
+ * Ordered iteration walks the heap best-first.  The frontier of nodes
+ * not yet returned, whose parents have been, is itself kept as a small
+ * binary heap of array positions in 'cursor'.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdlib.h>
+#include <errno.h>
+
+#include "heap.h"
+
+struct heap_node {
+    void *item;
+    size_t index;
+};
+
+struct heap {
+    struct heap_node **nodes;
+    size_t size;
+    size_t alloc;
+    size_t *cursor;
+    size_t cursor_size;
+    size_t cursor_alloc;
+    heap_comparator_f comparator;
+    heap_destructor_f destructor;
+    heap_duplicator_f duplicator;
+};
+
+static inline int node_cmp (struct heap *h, size_t i, size_t j)
+{
+    return h->comparator (h->nodes[i]->item, h->nodes[j]->item);
+}
+
+static inline void node_swap (struct heap *h, size_t i, size_t j)
+{
+    struct heap_node *tmp = h->nodes[i];
+
+    h->nodes[i] = h->nodes[j];
+    h->nodes[j] = tmp;
+    h->nodes[i]->index = i;
+    h->nodes[j]->index = j;
+}
+
+static void sift_up (struct heap *h, size_t i)
+{
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (node_cmp (h, i, parent) >= 0)
+            break;
+        node_swap (h, i, parent);
+        i = parent;
+    }
+}
+
+static void sift_down (struct heap *h, size_t i)
+{
+    for (;;) {
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+        size_t best = i;
+
+        if (left < h->size && node_cmp (h, left, best) < 0)
+            best = left;
+        if (right < h->size && node_cmp (h, right, best) < 0)
+            best = right;
+        if (best == i)
+            break;
+        node_swap (h, i, best);
+        i = best;
+    }
+}
+
+size_t heap_size (struct heap *h)
+{
+    return h ? h->size : 0;
+}
+
+void *heap_insert (struct heap *h, void *item)
+{
+    struct heap_node *node;
+
+    if (!h) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (h->size == h->alloc) {
+        size_t new_alloc = h->alloc ? h->alloc * 2 : 64;
+        struct heap_node **new_nodes;
+        if (!(new_nodes = realloc (h->nodes,
+                                   new_alloc * sizeof (*new_nodes))))
+            return NULL;
+        h->nodes = new_nodes;
+        h->alloc = new_alloc;
+    }
+    if (!(node = calloc (1, sizeof (*node))))
+        return NULL;
+    if (h->duplicator) {
+        if (!(node->item = h->duplicator (item))) {
+            free (node);
+            return NULL;
+        }
+    }
+    else
+        node->item = item;
+    node->index = h->size;
+    h->nodes[h->size++] = node;
+    sift_up (h, node->index);
+    return node;
+}
+
+int heap_delete (struct heap *h, void *handle)
+{
+    struct heap_node *node = handle;
+    size_t i;
+
+    if (!h
+        || !node
+        || node->index >= h->size
+        || h->nodes[node->index] != node) {
+        errno = EINVAL;
+        return -1;
+    }
+    i = node->index;
+    if (i != h->size - 1) {
+        node_swap (h, i, h->size - 1);
+        h->size--;
+        sift_down (h, i);
+        sift_up (h, i);
+    }
+    else
+        h->size--;
+    if (h->destructor)
+        h->destructor (&node->item);
+    free (node);
+    return 0;
+}
+
+void heap_reorder (struct heap *h, void *handle)
+{
+    struct heap_node *node = handle;
+
+    if (h
+        && node
+        && node->index < h->size
+        && h->nodes[node->index] == node) {
+        size_t i = node->index;
+        sift_up (h, i);
+        if (node->index == i)
+            sift_down (h, i);
+    }
+}
+
+void heap_rebuild (struct heap *h)
+{
+    if (h && h->size > 1) {
+        size_t i = h->size / 2;
+        while (i-- > 0)
+            sift_down (h, i);
+    }
+}
+
+void *heap_handle_item (void *handle)
+{
+    struct heap_node *node = handle;
+    return node ? node->item : NULL;
+}
+
+/* The cursor is a binary heap of positions in h->nodes.
+ */
+static inline int cursor_cmp (struct heap *h, size_t i, size_t j)
+{
+    return node_cmp (h, h->cursor[i], h->cursor[j]);
+}
+
+static inline void cursor_swap (struct heap *h, size_t i, size_t j)
+{
+    size_t tmp = h->cursor[i];
+    h->cursor[i] = h->cursor[j];
+    h->cursor[j] = tmp;
+}
+
+static int cursor_push (struct heap *h, size_t index)
+{
+    size_t i;
+
+    if (h->cursor_size == h->cursor_alloc) {
+        size_t new_alloc = h->cursor_alloc ? h->cursor_alloc * 2 : 16;
+        size_t *new_cursor;
+        if (!(new_cursor = realloc (h->cursor,
+                                    new_alloc * sizeof (*new_cursor))))
+            return -1;
+        h->cursor = new_cursor;
+        h->cursor_alloc = new_alloc;
+    }
+    i = h->cursor_size++;
+    h->cursor[i] = index;
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (cursor_cmp (h, i, parent) >= 0)
+            break;
+        cursor_swap (h, i, parent);
+        i = parent;
+    }
+    return 0;
+}
+
+static size_t cursor_pop (struct heap *h)
+{
+    size_t top = h->cursor[0];
+    size_t i = 0;
+
+    h->cursor[0] = h->cursor[--h->cursor_size];
+    for (;;) {
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+        size_t best = i;
+
+        if (left < h->cursor_size && cursor_cmp (h, left, best) < 0)
+            best = left;
+        if (right < h->cursor_size && cursor_cmp (h, right, best) < 0)
+            best = right;
+        if (best == i)
+            break;
+        cursor_swap (h, i, best);
+        i = best;
+    }
+    return top;
+}
+
+void *heap_first (struct heap *h)
+{
+    if (!h || h->size == 0)
+        return NULL;
+    h->cursor_size = 0;
+    if (cursor_push (h, 0) < 0)
+        return NULL;
+    return h->nodes[0]->item;
+}
+
+void *heap_next (struct heap *h)
+{
+    size_t index;
+    size_t child;
+
+    if (!h || h->cursor_size == 0)
+        return NULL;
+    index = cursor_pop (h);
+    child = 2 * index + 1;
+    if ((child < h->size && cursor_push (h, child) < 0)
+        || (child + 1 < h->size && cursor_push (h, child + 1) < 0)) {
+        h->cursor_size = 0;
+        return NULL;
+    }
+    if (h->cursor_size == 0)
+        return NULL;
+    return h->nodes[h->cursor[0]]->item;
+}
+
+void heap_set_destructor (struct heap *h, heap_destructor_f destructor)
+{
+    if (h)
+        h->destructor = destructor;
+}
+
+void heap_set_duplicator (struct heap *h, heap_duplicator_f duplicator)
+{
+    if (h)
+        h->duplicator = duplicator;
+}
+
+void heap_destroy (struct heap *h)
+{
+    if (h) {
+        int saved_errno = errno;
+        size_t i;
+        for (i = 0; i < h->size; i++) {
+            if (h->destructor)
+                h->destructor (&h->nodes[i]->item);
+            free (h->nodes[i]);
+        }
+        free (h->nodes);
+        free (h->cursor);
+        free (h);
+        errno = saved_errno;
+    }
+}
+
+struct heap *heap_create (heap_comparator_f comparator)
+{
+    struct heap *h;
+
+    if (!comparator) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(h = calloc (1, sizeof (*h))))
+        return NULL;
+    h->comparator = comparator;
+    return h;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,75 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/*
+ *  heap - binary heap with handles, for use as a priority queue
+ *
+ *  Insert, delete, and reorder by handle are O(log N).  The first item
+ *  is found in O(1).  The comparator, destructor, and duplicator have the
+ *  same signatures as their zlistx counterparts, so the same functions
+ *  may be used with either container.
+ */
+
+#ifndef _UTIL_HEAP_H
+#define _UTIL_HEAP_H
+
+#include <stddef.h>
+
+/*  Return < 0 if item1 comes before item2, > 0 if after, 0 if equal.
+ *  Items that compare equal are returned in no particular order, so a
+ *  comparator that needs a stable order must break ties itself.
+ */
+typedef int (*heap_comparator_f) (const void *item1, const void *item2);
+typedef void (*heap_destructor_f) (void **item);
+typedef void *(*heap_duplicator_f) (const void *item);
+
+struct heap *heap_create (heap_comparator_f comparator);
+void heap_destroy (struct heap *h);
+
+void heap_set_destructor (struct heap *h, heap_destructor_f destructor);
+void heap_set_duplicator (struct heap *h, heap_duplicator_f duplicator);
+
+size_t heap_size (struct heap *h);
+
+/*  Insert 'item' and return a handle for it, or NULL on failure.
+ *  The handle remains valid until the item is deleted.
+ */
+void *heap_insert (struct heap *h, void *item);
+
+/*  Remove the item referenced by 'handle', destroying it with the
+ *  destructor, if any.
+ */
+int heap_delete (struct heap *h, void *handle);
+
+/*  Restore order after the key of the item referenced by 'handle' changed.
+ */
+void heap_reorder (struct heap *h, void *handle);
+
+/*  Restore order after the keys of any number of items changed, in O(N).
+ *  Handles remain valid.
+ */
+void heap_rebuild (struct heap *h);
+
+/*  Return the item referenced by 'handle'.
+ */
+void *heap_handle_item (void *handle);
+
+/*  Iterate over items in order.  heap_first() returns the first item
+ *  in O(1).  heap_next() costs O(log K) for the Kth item.  The iteration
+ *  is invalidated by any change to the heap.
+ */
+void *heap_first (struct heap *h);
+void *heap_next (struct heap *h);
+
+#endif /* !_UTIL_HEAP_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
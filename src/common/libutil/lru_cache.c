@@ -14,10 +14,13 @@
 #include "config.h"
 #endif
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <errno.h>
+#include <time.h>
 
 #include "src/common/libczmqcontainers/czmq_containers.h"
+#include "src/common/libutil/monotime.h"
 
 #include "lru_cache.h"
 
@@ -25,6 +28,8 @@ struct lru_entry {
     lru_cache_t *lru;
     char *key;
     void *item;
+    size_t weight;
+    struct timespec t_put;
 
     struct lru_entry *prev;
     struct lru_entry *next;
@@ -33,6 +38,10 @@ struct lru_entry {
 struct lru_cache {
     int maxsize;
     int count;
+    size_t maxweight;
+    size_t weight;
+    double ttl;
+    struct lru_cache_stats stats;
 
     lru_cache_free_f freefn;
 
@@ -42,7 +51,7 @@ struct lru_cache {
 
 
 static struct lru_entry *
-lru_entry_create (lru_cache_t *lru, const char *key, void *item)
+lru_entry_create (lru_cache_t *lru, const char *key, void *item, size_t weight)
 {
     struct lru_entry *l = malloc (sizeof (*l));
     if (!l || !(l->key = strdup (key))) {
@@ -51,6 +60,9 @@ lru_entry_create (lru_cache_t *lru, const char *key, void *item)
     }
     l->lru = lru;
     l->item = item;
+    l->weight = weight;
+    if (lru->ttl > 0.)
+        monotime (&l->t_put);
     l->prev = l->next = NULL;
     return (l);
 }
@@ -101,35 +113,66 @@ static void lru_entry_purge (lru_cache_t *lru, struct lru_entry *l)
     /* Now remove entry from hash, this will result in memory
      *  for `l` being freed.
      */
-    zhash_delete (lru->entries, l->key);
     lru->count--;
+    lru->weight -= l->weight;
+    zhash_delete (lru->entries, l->key);
 }
 
-static void lru_purge_last (lru_cache_t *lru)
+static bool lru_entry_expired (lru_cache_t *lru, struct lru_entry *l)
 {
-    if (lru->last == NULL)
-        return;
-    lru_entry_purge (lru, lru->last);
+    return (lru->ttl > 0. && monotime_since (l->t_put) > lru->ttl * 1000.);
 }
 
-static void *
-lru_entry_enqueue (lru_cache_t *lru, const char *key, void *value)
+/*  Return entry for `key`, purging it and returning NULL if expired.
+ */
+static struct lru_entry *lru_entry_lookup (lru_cache_t *lru, const char *key)
 {
-    struct lru_entry *l = lru_entry_create (lru, key, value);
-    if (!l)
+    struct lru_entry *l;
+
+    if (!(l = zhash_lookup (lru->entries, key)))
+        return (NULL);
+    if (lru_entry_expired (lru, l)) {
+        lru_entry_purge (lru, l);
+        lru->stats.expirations++;
         return (NULL);
+    }
+    return (l);
+}
 
-    if (lru->count == lru->maxsize)
-        lru_purge_last (lru);
+/*  Evict from the end of the list until there is room for an entry
+ *   of `weight`.
+ */
+static void lru_make_room (lru_cache_t *lru, size_t weight)
+{
+    while (lru->last
+           && (lru->count >= lru->maxsize
+               || (lru->maxweight > 0
+                   && lru->weight + weight > lru->maxweight))) {
+        lru_entry_purge (lru, lru->last);
+        lru->stats.evictions++;
+    }
+}
+
+static int lru_entry_enqueue (lru_cache_t *lru,
+                              const char *key,
+                              void *value,
+                              size_t weight)
+{
+    struct lru_entry *l = lru_entry_create (lru, key, value, weight);
+    if (!l)
+        return (-1);
+
+    lru_make_room (lru, weight);
     lru_entry_push (lru, l);
     lru->count++;
+    lru->weight += weight;
 
     /* Place entry on hash, and add cleanup function */
     if (zhash_insert (lru->entries, key, l) < 0)
         abort ();
     zhash_freefn (lru->entries, key, (zhash_free_fn *) lru_entry_destroy);
 
-    return (l->item);
+    return (0);
 }
 
 static void *
@@ -154,6 +197,7 @@ lru_entry_requeue (lru_cache_t *lru, struct lru_entry *l)
 int lru_cache_selfcheck (lru_cache_t *lru)
 {
     int count = 0;
+    size_t weight = 0;
     struct lru_entry *l = lru->first;
 
     /* front of list should never have a prev pointer */
@@ -162,6 +206,7 @@ int lru_cache_selfcheck (lru_cache_t *lru)
 
     while (l) {
         count++;
+        weight += l->weight;
         /* an entry should never point to itself */
         if (l == l->next)
             return (-2);
@@ -172,6 +217,10 @@ int lru_cache_selfcheck (lru_cache_t *lru)
     if (lru->count != count)
         return (-3);
 
+    /* sum of entry weights should equal total weight */
+    if (lru->weight != weight)
+        return (-4);
+
     return (0);
 }
 
@@ -197,6 +246,10 @@ lru_cache_t * lru_cache_create (int maxsize)
     lru->entries = zh;
     lru->first = lru->last = NULL;
     lru->freefn = NULL;
+    lru->maxweight = 0;
+    lru->weight = 0;
+    lru->ttl = 0.;
+    memset (&lru->stats, 0, sizeof (lru->stats));
 
     return (lru);
 }
@@ -206,30 +259,55 @@ void lru_cache_set_free_f (lru_cache_t *lru, lru_cache_free_f fn)
     lru->freefn = fn;
 }
 
+void lru_cache_set_maxweight (lru_cache_t *lru, size_t maxweight)
+{
+    lru->maxweight = maxweight;
+}
+
+void lru_cache_set_ttl (lru_cache_t *lru, double ttl)
+{
+    lru->ttl = ttl;
+}
+
 void *lru_cache_get (lru_cache_t *lru, const char *key)
 {
     struct lru_entry *l;
-    if ((l = zhash_lookup (lru->entries, key)))
+    if ((l = lru_entry_lookup (lru, key))) {
+        lru->stats.hits++;
         return lru_entry_requeue (lru, l);
+    }
+    lru->stats.misses++;
     return (NULL);
 }
 
 bool lru_cache_check (lru_cache_t *lru, const char *key)
 {
-    if (zhash_lookup (lru->entries, key) == NULL)
+    if (lru_entry_lookup (lru, key) == NULL)
         return false;
     return true;
 }
 
-int lru_cache_put (lru_cache_t *lru, const char *key, void *value)
+int lru_cache_put_weighted (lru_cache_t *lru,
+                            const char *key,
+                            void *value,
+                            size_t weight)
 {
-    if (lru_cache_get (lru, key)) {
+    struct lru_entry *l;
+    if ((l = lru_entry_lookup (lru, key))) {
+        lru_entry_requeue (lru, l);
         errno = EEXIST;
         return (-1);
     }
-    if (lru_entry_enqueue (lru, key, value) < 0)
+    if (lru->maxweight > 0 && weight > lru->maxweight) {
+        errno = E2BIG;
         return (-1);
-    return (0);
+    }
+    return lru_entry_enqueue (lru, key, value, weight);
+}
+
+int lru_cache_put (lru_cache_t *lru, const char *key, void *value)
+{
+    return lru_cache_put_weighted (lru, key, value, 0);
 }
 
 int lru_cache_remove (lru_cache_t *lru, const char *key)
@@ -241,11 +319,38 @@ int lru_cache_remove (lru_cache_t *lru, const char *key)
     return (0);
 }
 
+int lru_cache_expire (lru_cache_t *lru)
+{
+    struct lru_entry *l = lru->first;
+    int count = 0;
+
+    while (l) {
+        struct lru_entry *next = l->next;
+        if (lru_entry_expired (lru, l)) {
+            lru_entry_purge (lru, l);
+            lru->stats.expirations++;
+            count++;
+        }
+        l = next;
+    }
+    return (count);
+}
+
 int lru_cache_size (lru_cache_t *lru)
 {
     return (lru->count);
 }
 
+size_t lru_cache_weight (lru_cache_t *lru)
+{
+    return (lru->weight);
+}
+
+void lru_cache_get_stats (lru_cache_t *lru, struct lru_cache_stats *stats)
+{
+    *stats = lru->stats;
+}
+
 /*
  * vi:tabstop=4 shiftwidth=4 expandtab
  */
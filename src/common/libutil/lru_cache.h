@@ -16,10 +16,18 @@
 #define HAVE_LRU_CACHE_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
 typedef struct lru_cache lru_cache_t;
 typedef void (*lru_cache_free_f) (void *data);
 
+struct lru_cache_stats {
+    unsigned long hits;         // successful lru_cache_get()
+    unsigned long misses;       // unsuccessful lru_cache_get()
+    unsigned long evictions;    // entries purged to make room
+    unsigned long expirations;  // entries purged because ttl elapsed
+};
+
 /*  Create a lru cache which holds at maximum `maxsize` objects
  */
 lru_cache_t *lru_cache_create (int maxsize);
@@ -30,10 +38,31 @@ void lru_cache_destroy (lru_cache_t *lru);
  */
 void lru_cache_set_free_f (lru_cache_t *lru, lru_cache_free_f fn);
 
+/*  Limit the total weight of items stored in the cache to `maxweight`,
+ *   in addition to the limit on the number of items.  Items are evicted
+ *   from the end of the LRU list until both limits are met.
+ *   A `maxweight` of 0 (the default) means the weight is not limited.
+ */
+void lru_cache_set_maxweight (lru_cache_t *lru, size_t maxweight);
+
+/*  Expire items `ttl` seconds after they were put in the cache.  An
+ *   expired item is purged the next time it is accessed, or by
+ *   lru_cache_expire().  A `ttl` of 0 (the default) disables expiration.
+ */
+void lru_cache_set_ttl (lru_cache_t *lru, double ttl);
+
 /*  Return current number of items stored in lru cache.
  */
 int lru_cache_size (lru_cache_t *lru);
 
+/*  Return the total weight of items stored in lru cache.
+ */
+size_t lru_cache_weight (lru_cache_t *lru);
+
+/*  Get hit, miss, eviction, and expiration counts.
+ */
+void lru_cache_get_stats (lru_cache_t *lru, struct lru_cache_stats *stats);
+
 /*  Put item `value` into cache, associated by key `key`.
  *  Returns 0 on success, -1 on failure, with EEXIST if item already cached.
  *
@@ -42,6 +71,15 @@ int lru_cache_size (lru_cache_t *lru);
  */
 int lru_cache_put (lru_cache_t *lru, const char *key, void *item);
 
+/*  As above, but the item counts `weight` against the maximum weight
+ *   (lru_cache_put() uses a weight of 0).  Fails with E2BIG if `weight`
+ *   alone exceeds the maximum weight.
+ */
+int lru_cache_put_weighted (lru_cache_t *lru,
+                            const char *key,
+                            void *item,
+                            size_t weight);
+
 /*  Get item associated with key. Returns NULL if item not found.
  *  This will also move the item, if found, to the front of the LRU list.
  */
@@ -57,6 +95,10 @@ bool lru_cache_check (lru_cache_t *lru, const char *key);
  */
 int lru_cache_remove (lru_cache_t *lru, const char *key);
 
+/*  Purge all items whose ttl has elapsed.  Returns the number purged.
+ */
+int lru_cache_expire (lru_cache_t *lru);
+
 /*
  *   Run lru cache self checks on object `lru`. Used in testing.
  *    Returns < 0 if any one of several consistency checks fails.
@@ -16,6 +16,7 @@
 #include <stdlib.h>
 #include <memory.h>
 #include "sha256.h"
+#include "sha256_hw.h"
 
 /****************************** MACROS ******************************/
 #define ROTLEFT(a,b) (((a) << (b)) | ((a) >> (32-(b))))
@@ -41,7 +42,7 @@ static const WORD k[64] = {
 };
 
 /*********************** FUNCTION DEFINITIONS ***********************/
-void sha256_transform(SHA256_CTX *ctx, const BYTE data[])
+static void sha256_transform_state(WORD state[], const BYTE data[])
 {
 	WORD a, b, c, d, e, f, g, h, i, j, t1, t2, m[64];
 
@@ -50,14 +51,14 @@ void sha256_transform(SHA256_CTX *ctx, const BYTE data[])
 	for ( ; i < 64; ++i)
 		m[i] = SIG1(m[i - 2]) + m[i - 7] + SIG0(m[i - 15]) + m[i - 16];
 
-	a = ctx->state[0];
-	b = ctx->state[1];
-	c = ctx->state[2];
-	d = ctx->state[3];
-	e = ctx->state[4];
-	f = ctx->state[5];
-	g = ctx->state[6];
-	h = ctx->state[7];
+	a = state[0];
+	b = state[1];
+	c = state[2];
+	d = state[3];
+	e = state[4];
+	f = state[5];
+	g = state[6];
+	h = state[7];
 
 	for (i = 0; i < 64; ++i) {
 		t1 = h + EP1(e) + CH(e,f,g) + k[i] + m[i];
@@ -72,14 +73,42 @@ void sha256_transform(SHA256_CTX *ctx, const BYTE data[])
 		a = t1 + t2;
 	}
 
-	ctx->state[0] += a;
-	ctx->state[1] += b;
-	ctx->state[2] += c;
-	ctx->state[3] += d;
-	ctx->state[4] += e;
-	ctx->state[5] += f;
-	ctx->state[6] += g;
-	ctx->state[7] += h;
+	state[0] += a;
+	state[1] += b;
+	state[2] += c;
+	state[3] += d;
+	state[4] += e;
+	state[5] += f;
+	state[6] += g;
+	state[7] += h;
+}
+
+static void sha256_blocks_sw(WORD state[], const BYTE data[], size_t nblocks)
+{
+	while (nblocks-- > 0) {
+		sha256_transform_state(state, data);
+		data += 64;
+	}
+}
+
+// Select the block function on first use: CPU SHA instructions if the
+// processor has them, otherwise the portable implementation above.
+static sha256_blocks_f sha256_blocks_get(void)
+{
+	static sha256_blocks_f blocks = NULL;
+	sha256_blocks_f fun;
+
+	if (!(fun = __atomic_load_n(&blocks, __ATOMIC_RELAXED))) {
+		if (!(fun = sha256_hw_blocks()))
+			fun = sha256_blocks_sw;
+		__atomic_store_n(&blocks, fun, __ATOMIC_RELAXED);
+	}
+	return fun;
+}
+
+void sha256_transform(SHA256_CTX *ctx, const BYTE data[])
+{
+	sha256_blocks_get()(ctx->state, data, 1);
 }
 
 void sha256_init(SHA256_CTX *ctx)
@@ -98,17 +127,34 @@ void sha256_init(SHA256_CTX *ctx)
 
 void sha256_update(SHA256_CTX *ctx, const BYTE data[], size_t len)
 {
-	WORD i;
-
-	for (i = 0; i < len; ++i) {
-		ctx->data[ctx->datalen] = data[i];
-		ctx->datalen++;
-		if (ctx->datalen == 64) {
-			sha256_transform(ctx, ctx->data);
-			ctx->bitlen += 512;
-			ctx->datalen = 0;
-		}
+	sha256_blocks_f blocks = sha256_blocks_get();
+	size_t n;
+
+	// Complete a partially filled block first.
+	if (ctx->datalen > 0) {
+		n = 64 - ctx->datalen;
+		if (n > len)
+			n = len;
+		memcpy(ctx->data + ctx->datalen, data, n);
+		ctx->datalen += n;
+		data += n;
+		len -= n;
+		if (ctx->datalen < 64)
+			return;
+		blocks(ctx->state, ctx->data, 1);
+		ctx->bitlen += 512;
+		ctx->datalen = 0;
+	}
+	// Hash whole blocks directly from the caller's buffer.
+	if ((n = len / 64) > 0) {
+		blocks(ctx->state, data, n);
+		ctx->bitlen += n * 512;
+		data += n * 64;
+		len -= n * 64;
 	}
+	// Save the remainder for the next update or final.
+	memcpy(ctx->data, data, len);
+	ctx->datalen = len;
 }
 
 void sha256_final(SHA256_CTX *ctx, BYTE hash[])
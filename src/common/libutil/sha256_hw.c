@@ -0,0 +1,218 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* sha256_hw.c - SHA-256 block function using CPU instructions
+ *
+ * Each message block is processed as 16 groups of 4 rounds.  The message
+ * schedule is kept in four vectors w[0..3], where group i is in w[i % 4],
+ * and each group is computed from the four before it:
+ *
+ *   G(i) = sigma1 (sigma0 (G(i-4), G(i-3)) + G(i-2..i-1), G(i-1))
+ *
+ * The implementations are compiled with target attributes so that the rest
+ * of the library does not require these instructions, and are selected at
+ * runtime after checking the CPU.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdint.h>
+#include <stddef.h>
+
+#include "sha256_hw.h"
+
+#if (defined(__x86_64__) || defined(__aarch64__)) \
+    && (defined(__GNUC__) || defined(__clang__))
+static const uint32_t K[64] __attribute__((aligned (16))) = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+    0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+    0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+    0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+    0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+#endif
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#include <cpuid.h>
+
+#define HAVE_SHA256_HW 1
+
+/* The sha256rnds2 instruction keeps the state as ABEF/CDGH rather than
+ * ABCD/EFGH, so the state is shuffled on entry and exit.
+ */
+__attribute__((target ("sha,sse4.1,ssse3")))
+static void blocks_shani (unsigned int state[8],
+                          const unsigned char *data,
+                          size_t nblocks)
+{
+    const __m128i bswap = _mm_set_epi64x (0x0c0d0e0f08090a0bULL,
+                                          0x0405060700010203ULL);
+    __m128i state0, state1, save0, save1, msg, tmp;
+    __m128i w[4];
+
+    tmp = _mm_loadu_si128 ((const __m128i *)&state[0]);
+    state1 = _mm_loadu_si128 ((const __m128i *)&state[4]);
+    tmp = _mm_shuffle_epi32 (tmp, 0xb1);            // CDAB
+    state1 = _mm_shuffle_epi32 (state1, 0x1b);      // EFGH
+    state0 = _mm_alignr_epi8 (tmp, state1, 8);      // ABEF
+    state1 = _mm_blend_epi16 (state1, tmp, 0xf0);   // CDGH
+
+    while (nblocks-- > 0) {
+        save0 = state0;
+        save1 = state1;
+#pragma GCC unroll 16
+        for (int i = 0; i < 16; i++) {
+            if (i < 4) {
+                msg = _mm_loadu_si128 ((const __m128i *)(data + i * 16));
+                w[i] = _mm_shuffle_epi8 (msg, bswap);
+            }
+            else {
+                msg = _mm_sha256msg1_epu32 (w[i & 3], w[(i + 1) & 3]);
+                msg = _mm_add_epi32 (msg, _mm_alignr_epi8 (w[(i + 3) & 3],
+                                                           w[(i + 2) & 3],
+                                                           4));
+                w[i & 3] = _mm_sha256msg2_epu32 (msg, w[(i + 3) & 3]);
+            }
+            msg = _mm_add_epi32 (w[i & 3],
+                                 _mm_load_si128 ((const __m128i *)&K[i * 4]));
+            state1 = _mm_sha256rnds2_epu32 (state1, state0, msg);
+            msg = _mm_shuffle_epi32 (msg, 0x0e);
+            state0 = _mm_sha256rnds2_epu32 (state0, state1, msg);
+        }
+        state0 = _mm_add_epi32 (state0, save0);
+        state1 = _mm_add_epi32 (state1, save1);
+        data += 64;
+    }
+
+    tmp = _mm_shuffle_epi32 (state0, 0x1b);         // FEBA
+    state1 = _mm_shuffle_epi32 (state1, 0xb1);      // DCHG
+    state0 = _mm_blend_epi16 (tmp, state1, 0xf0);   // DCBA
+    state1 = _mm_alignr_epi8 (state1, tmp, 8);      // HGFE
+    _mm_storeu_si128 ((__m128i *)&state[0], state0);
+    _mm_storeu_si128 ((__m128i *)&state[4], state1);
+}
+
+static const char *hw_name = "sha-ni";
+
+static sha256_blocks_f hw_detect (void)
+{
+    unsigned int eax, ebx, ecx, edx;
+
+    if (__get_cpuid_max (0, NULL) < 7)
+        return NULL;
+    __cpuid (1, eax, ebx, ecx, edx);
+    if (!(ecx & (1 << 9)) || !(ecx & (1 << 19)))    // SSSE3, SSE4.1
+        return NULL;
+    __cpuid_count (7, 0, eax, ebx, ecx, edx);
+    if (!(ebx & (1 << 29)))                         // SHA
+        return NULL;
+    return blocks_shani;
+}
+
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__)) \
+    && defined(__linux__)
+#include <arm_neon.h>
+#include <sys/auxv.h>
+
+#ifndef HWCAP_SHA2
+#define HWCAP_SHA2 (1 << 6)
+#endif
+
+#define HAVE_SHA256_HW 1
+
+#if defined(__clang__)
+#define TARGET_CRYPTO __attribute__((target ("crypto")))
+#else
+#define TARGET_CRYPTO __attribute__((target ("+crypto")))
+#endif
+
+TARGET_CRYPTO
+static void blocks_armv8 (unsigned int state[8],
+                          const unsigned char *data,
+                          size_t nblocks)
+{
+    uint32x4_t state0, state1, save0, save1, wk, tmp;
+    uint32x4_t w[4];
+
+    state0 = vld1q_u32 (&state[0]);
+    state1 = vld1q_u32 (&state[4]);
+
+    while (nblocks-- > 0) {
+        save0 = state0;
+        save1 = state1;
+        for (int i = 0; i < 4; i++) {
+            w[i] = vreinterpretq_u32_u8 (vrev32q_u8 (vld1q_u8 (data + i * 16)));
+        }
+#pragma GCC unroll 16
+        for (int i = 0; i < 16; i++) {
+            wk = vaddq_u32 (w[i & 3], vld1q_u32 (&K[i * 4]));
+            if (i < 12) {
+                w[i & 3] = vsha256su1q_u32 (vsha256su0q_u32 (w[i & 3],
+                                                             w[(i + 1) & 3]),
+                                            w[(i + 2) & 3],
+                                            w[(i + 3) & 3]);
+            }
+            tmp = state0;
+            state0 = vsha256hq_u32 (state0, state1, wk);
+            state1 = vsha256h2q_u32 (state1, tmp, wk);
+        }
+        state0 = vaddq_u32 (state0, save0);
+        state1 = vaddq_u32 (state1, save1);
+        data += 64;
+    }
+
+    vst1q_u32 (&state[0], state0);
+    vst1q_u32 (&state[4], state1);
+}
+
+static const char *hw_name = "armv8-ce";
+
+static sha256_blocks_f hw_detect (void)
+{
+    if (!(getauxval (AT_HWCAP) & HWCAP_SHA2))
+        return NULL;
+    return blocks_armv8;
+}
+#endif
+
+sha256_blocks_f sha256_hw_blocks (void)
+{
+#if HAVE_SHA256_HW
+    return hw_detect ();
+#else
+    return NULL;
+#endif
+}
+
+const char *sha256_hw_name (void)
+{
+#if HAVE_SHA256_HW
+    if (hw_detect ())
+        return hw_name;
+#endif
+    return NULL;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
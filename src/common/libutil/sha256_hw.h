@@ -0,0 +1,37 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _UTIL_SHA256_HW_H
+#define _UTIL_SHA256_HW_H
+
+#include <stddef.h>
+
+/* Update SHA-256 'state' with 'nblocks' consecutive 64 byte blocks.
+ */
+typedef void (*sha256_blocks_f)(unsigned int state[8],
+                                const unsigned char *data,
+                                size_t nblocks);
+
+/* Return an implementation that uses the SHA-256 instructions of the
+ * running CPU (x86 SHA-NI or ARMv8 crypto extensions), or NULL if they
+ * are not available.
+ */
+sha256_blocks_f sha256_hw_blocks (void);
+
+/* Return the name of the implementation returned by sha256_hw_blocks(),
+ * or NULL.
+ */
+const char *sha256_hw_name (void);
+
+#endif /* !_UTIL_SHA256_HW_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
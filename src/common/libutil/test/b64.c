@@ -0,0 +1,153 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "src/common/libtap/tap.h"
+#include "src/common/libutil/b64.h"
+#include "ccan/base64/base64.h"
+#include "ccan/array_size/array_size.h"
+#include "ccan/str/str.h"
+
+struct vec {
+    const char *in;
+    const char *out;
+};
+
+/* RFC 4648 section 10 test vectors */
+static struct vec rfc_vectors[] = {
+    { "", "" },
+    { "f", "Zg==" },
+    { "fo", "Zm8=" },
+    { "foo", "Zm9v" },
+    { "foob", "Zm9vYg==" },
+    { "fooba", "Zm9vYmE=" },
+    { "foobar", "Zm9vYmFy" },
+};
+
+static void test_vectors (void)
+{
+    char enc[64];
+    char dec[64];
+    ssize_t n;
+
+    for (int i = 0; i < ARRAY_SIZE (rfc_vectors); i++) {
+        struct vec *v = &rfc_vectors[i];
+        size_t len = strlen (v->in);
+
+        ok (b64_encode (enc, sizeof (enc), v->in, len) == strlen (v->out)
+            && streq (enc, v->out),
+            "b64_encode \"%s\" = \"%s\"", v->in, enc);
+        n = b64_decode (dec, sizeof (dec), v->out, strlen (v->out));
+        ok (n == len && memcmp (dec, v->in, len) == 0,
+            "b64_decode \"%s\" works", v->out);
+    }
+    n = b64_decode (dec, sizeof (dec), "Zm9vYg", 6);
+    ok (n == 4 && memcmp (dec, "foob", 4) == 0,
+        "b64_decode works without padding");
+    memset (dec, 'x', sizeof (dec));
+    n = b64_decode (dec, sizeof (dec), "Zm9v", 4);
+    ok (n == 3 && streq (dec, "foo"),
+        "b64_decode stores a NUL after the data if there is room");
+}
+
+/* Compare with ccan/base64 for all lengths that exercise the vector
+ * loops and every tail case.
+ */
+static void test_compare (void)
+{
+    unsigned char src[1024];
+    char enc[1400];
+    char ref[1400];
+    char dec[1030];
+    int errors = 0;
+
+    for (int i = 0; i < sizeof (src); i++)
+        src[i] = (i * 7919 + 13) ^ (i >> 3);
+    for (size_t len = 0; len <= sizeof (src); len++) {
+        ssize_t n = b64_encode (enc, sizeof (enc), src, len);
+        ssize_t m = base64_encode (ref, sizeof (ref), (char *)src, len);
+        if (n != m || memcmp (enc, ref, n + 1) != 0) {
+            diag ("encode mismatch at length %zu", len);
+            errors++;
+            continue;
+        }
+        n = b64_decode (dec, sizeof (dec), enc, m);
+        if (n != len || memcmp (dec, src, len) != 0) {
+            diag ("decode mismatch at length %zu", len);
+            errors++;
+        }
+    }
+    ok (errors == 0, "b64 matches ccan/base64 for lengths 0-1024");
+}
+
+static void test_invalid (void)
+{
+    unsigned char src[300];
+    char enc[512];
+    char dec[512];
+    const char bad[] = { '*', '-', '_', '=', ' ', '\n', 0x7f, (char)0x80 };
+    ssize_t n;
+    int errors = 0;
+
+    for (int i = 0; i < sizeof (src); i++)
+        src[i] = i;
+    n = b64_encode (enc, sizeof (enc), src, sizeof (src));
+    if (n != 400)
+        BAIL_OUT ("b64_encode failed");
+
+    /* an invalid character at any position is detected, whether it
+     * falls in a vector block or in the scalar tail
+     */
+    for (int pos = 0; pos < n - 2; pos++) {
+        for (int j = 0; j < ARRAY_SIZE (bad); j++) {
+            char save = enc[pos];
+            enc[pos] = bad[j];
+            errno = 0;
+            if (b64_decode (dec, sizeof (dec), enc, n) >= 0
+                || errno != EINVAL)
+                errors++;
+            enc[pos] = save;
+        }
+    }
+    ok (errors == 0, "b64_decode rejects invalid characters at any position");
+    errno = 0;
+    ok (b64_decode (dec, sizeof (dec), "Zm9vY", 5) < 0 && errno == EINVAL,
+        "b64_decode fails on truncated input with EINVAL");
+    errno = 0;
+    ok (b64_decode (dec, sizeof (dec), "Zg=====", 7) < 0 && errno == EINVAL,
+        "b64_decode fails on extra padding with EINVAL");
+    errno = 0;
+    ok (b64_encode (enc, 4, "foo", 3) < 0 && errno == EOVERFLOW,
+        "b64_encode fails with EOVERFLOW if no room for NUL");
+    errno = 0;
+    ok (b64_decode (dec, 2, "Zm9v", 4) < 0 && errno == EOVERFLOW,
+        "b64_decode fails with EOVERFLOW if buffer is too small");
+}
+
+int main (int argc, char *argv[])
+{
+    plan (NO_PLAN);
+
+    test_vectors ();
+    test_compare ();
+    test_invalid ();
+
+    done_testing ();
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
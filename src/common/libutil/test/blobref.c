@@ -189,6 +189,19 @@ int main(int argc, char** argv)
         "blobref_validate_hashtype sha1 is valid");
     ok (blobref_validate_hashtype ("sha256") == SHA256_BLOCK_SIZE,
         "blobref_validate_hashtype sha256 is valid");
+#if HAVE_BLAKE3
+    ok (blobref_validate_hashtype ("blake3") == 32,
+        "blobref_validate_hashtype blake3 is valid");
+    ok (blobref_hash ("blake3", NULL, 0, ref, sizeof (ref)) == 0
+        && streq (ref, "blake3-af1349b9f5f9a1a6a0404dea36dcc949"
+                       "9bcb25c9adc112b7cc9a93cae41f3262"),
+        "blobref_hash blake3 of zero length data is correct");
+    ok (blobref_strtohash (ref, digest, sizeof (digest)) == 32,
+        "blobref_strtohash blake3 works");
+#else
+    ok (blobref_validate_hashtype ("blake3") == -1,
+        "blobref_validate_hashtype blake3 is invalid without libblake3");
+#endif
     ok (blobref_validate_hashtype ("nerf") == -1,
         "blobref_validate_hashtype nerf is invalid");
     ok (blobref_validate_hashtype (NULL) == -1,
@@ -0,0 +1,100 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <errno.h>
+#include <stdio.h>
+
+#include "src/common/libtap/tap.h"
+#include "src/common/libutil/bloom.h"
+
+#define NKEYS 10000
+
+static void test_basic (void)
+{
+    struct bloom *b;
+    char key[32];
+    int errors;
+    int fp;
+    int i;
+
+    b = bloom_create (NKEYS, 0.01);
+    ok (b != NULL,
+        "bloom_create capacity=%d fp_rate=0.01 works", NKEYS);
+    if (!b)
+        BAIL_OUT ("could not create bloom filter");
+    ok (bloom_capacity (b) == NKEYS && bloom_count (b) == 0,
+        "bloom_capacity and bloom_count return expected values");
+    ok (bloom_check (b, "foo", 3) == false,
+        "bloom_check of empty filter returns false");
+
+    for (i = 0; i < NKEYS; i++) {
+        int n = snprintf (key, sizeof (key), "key-%d", i);
+        bloom_add (b, key, n);
+    }
+    ok (bloom_count (b) == NKEYS,
+        "bloom_count is %d after adding %d keys", NKEYS, NKEYS);
+
+    errors = 0;
+    for (i = 0; i < NKEYS; i++) {
+        int n = snprintf (key, sizeof (key), "key-%d", i);
+        if (!bloom_check (b, key, n))
+            errors++;
+    }
+    ok (errors == 0,
+        "bloom_check returns true for all added keys");
+
+    fp = 0;
+    for (i = 0; i < NKEYS; i++) {
+        int n = snprintf (key, sizeof (key), "other-%d", i);
+        if (bloom_check (b, key, n))
+            fp++;
+    }
+    diag ("%d false positives in %d", fp, NKEYS);
+    ok (fp < NKEYS * 0.03,
+        "false positive rate is near the requested rate");
+
+    bloom_destroy (b);
+}
+
+static void test_inval (void)
+{
+    errno = 0;
+    ok (bloom_create (0, 0.01) == NULL && errno == EINVAL,
+        "bloom_create capacity=0 fails with EINVAL");
+    errno = 0;
+    ok (bloom_create (100, 0.) == NULL && errno == EINVAL,
+        "bloom_create fp_rate=0 fails with EINVAL");
+    errno = 0;
+    ok (bloom_create (100, 1.) == NULL && errno == EINVAL,
+        "bloom_create fp_rate=1 fails with EINVAL");
+    ok (bloom_check (NULL, "foo", 3) == true,
+        "bloom_check b=NULL returns true");
+    lives_ok ({bloom_add (NULL, "foo", 3);},
+        "bloom_add b=NULL doesn't crash");
+    lives_ok ({bloom_destroy (NULL);},
+        "bloom_destroy b=NULL doesn't crash");
+}
+
+int main (int argc, char *argv[])
+{
+    plan (NO_PLAN);
+
+    test_basic ();
+    test_inval ();
+
+    done_testing ();
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,260 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <errno.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "src/common/libtap/tap.h"
+#include "src/common/libutil/hashmap.h"
+#include "ccan/str/str.h"
+
+#define NITEMS 10000
+
+struct item {
+    uint64_t key;
+    int refcount;
+};
+
+static void item_destructor (void **arg)
+{
+    if (arg) {
+        struct item *item = *arg;
+        item->refcount--;
+        *arg = NULL;
+    }
+}
+
+/* Keys are already random, so hash them by value.
+ */
+static size_t key_hash (const void *key, size_t keysize)
+{
+    return *(const uint64_t *)key;
+}
+
+/* A poor hash that puts every key in the same probe sequence.
+ */
+static size_t bad_hash (const void *key, size_t keysize)
+{
+    return 0;
+}
+
+static bool key_equal (const void *key1, const void *key2, size_t keysize)
+{
+    return *(const uint64_t *)key1 == *(const uint64_t *)key2;
+}
+
+static void test_badargs (void)
+{
+    struct hashmap *map;
+    int dummy;
+
+    errno = 0;
+    ok (hashmap_create (0, NULL, NULL) == NULL && errno == EINVAL,
+        "hashmap_create keysize=0 fails with EINVAL");
+    if (!(map = hashmap_create (sizeof (uint64_t), NULL, NULL)))
+        BAIL_OUT ("hashmap_create failed");
+    errno = 0;
+    ok (hashmap_insert (NULL, "x", &dummy) < 0 && errno == EINVAL,
+        "hashmap_insert map=NULL fails with EINVAL");
+    errno = 0;
+    ok (hashmap_insert (map, NULL, &dummy) < 0 && errno == EINVAL,
+        "hashmap_insert key=NULL fails with EINVAL");
+    ok (hashmap_lookup (NULL, "x") == NULL,
+        "hashmap_lookup map=NULL returns NULL");
+    ok (hashmap_lookup (map, NULL) == NULL,
+        "hashmap_lookup key=NULL returns NULL");
+    ok (hashmap_size (NULL) == 0,
+        "hashmap_size map=NULL returns 0");
+    ok (hashmap_first (NULL) == NULL && hashmap_next (NULL) == NULL,
+        "hashmap_first/next map=NULL return NULL");
+    ok (hashmap_cursor (NULL) == NULL,
+        "hashmap_cursor map=NULL returns NULL");
+    lives_ok ({hashmap_delete (NULL, "x");},
+              "hashmap_delete map=NULL doesn't crash");
+    lives_ok ({hashmap_purge (NULL);},
+              "hashmap_purge map=NULL doesn't crash");
+    lives_ok ({hashmap_destroy (NULL);},
+              "hashmap_destroy map=NULL doesn't crash");
+    hashmap_destroy (map);
+}
+
+static void test_basic (hashmap_hash_f hash, const char *name, int nitems)
+{
+    struct hashmap *map;
+    struct item *items;
+    struct item *item;
+    int errors;
+    int count;
+    int i;
+
+    if (!(items = calloc (nitems, sizeof (items[0]))))
+        BAIL_OUT ("out of memory");
+    if (!(map = hashmap_create (sizeof (uint64_t), hash, key_equal)))
+        BAIL_OUT ("hashmap_create failed");
+    hashmap_set_destructor (map, item_destructor);
+
+    errors = 0;
+    for (i = 0; i < nitems; i++) {
+        items[i].key = (uint64_t)rand () << 32 | (uint64_t)i;
+        items[i].refcount = 1;
+        if (hashmap_insert (map, &items[i].key, &items[i]) < 0)
+            errors++;
+    }
+    ok (errors == 0 && hashmap_size (map) == nitems,
+        "%s: inserted %d items", name, nitems);
+    errno = 0;
+    ok (hashmap_insert (map, &items[0].key, &items[0]) < 0 && errno == EEXIST,
+        "%s: inserting a duplicate key fails with EEXIST", name);
+
+    errors = 0;
+    for (i = 0; i < nitems; i++) {
+        uint64_t key = items[i].key;    // copy: key need not be the same
+        if (hashmap_lookup (map, &key) != &items[i])
+            errors++;
+    }
+    ok (errors == 0,
+        "%s: all items can be looked up", name);
+    uint64_t missing = (uint64_t)1 << 63;
+    ok (hashmap_lookup (map, &missing) == NULL,
+        "%s: lookup of a missing key returns NULL", name);
+
+    count = 0;
+    errors = 0;
+    item = hashmap_first (map);
+    while (item) {
+        const uint64_t *key = hashmap_cursor (map);
+        if (!key || *key != item->key)
+            errors++;
+        count++;
+        item = hashmap_next (map);
+    }
+    ok (count == nitems && errors == 0,
+        "%s: iteration visits every item with its key", name);
+
+    /* Delete every other item.
+     */
+    for (i = 0; i < nitems; i += 2)
+        hashmap_delete (map, &items[i].key);
+    hashmap_delete (map, &missing);
+    ok (hashmap_size (map) == nitems / 2,
+        "%s: deleted half of the items", name);
+    errors = 0;
+    for (i = 0; i < nitems; i++) {
+        void *expected = i % 2 == 0 ? NULL : &items[i];
+        int refcount = i % 2 == 0 ? 0 : 1;
+        if (hashmap_lookup (map, &items[i].key) != expected
+            || items[i].refcount != refcount)
+            errors++;
+    }
+    ok (errors == 0,
+        "%s: deleted items are gone and were destroyed", name);
+
+    /* Put them back.
+     */
+    errors = 0;
+    for (i = 0; i < nitems; i += 2) {
+        items[i].refcount = 1;
+        if (hashmap_insert (map, &items[i].key, &items[i]) < 0)
+            errors++;
+    }
+    for (i = 0; i < nitems; i++) {
+        if (hashmap_lookup (map, &items[i].key) != &items[i])
+            errors++;
+    }
+    ok (errors == 0,
+        "%s: deleted items can be reinserted", name);
+
+    hashmap_purge (map);
+    errors = 0;
+    for (i = 0; i < nitems; i++) {
+        if (items[i].refcount != 0)
+            errors++;
+    }
+    ok (hashmap_size (map) == 0 && errors == 0,
+        "%s: hashmap_purge destroyed all items", name);
+    ok (hashmap_first (map) == NULL,
+        "%s: hashmap_first returns NULL on an empty map", name);
+
+    hashmap_destroy (map);
+    free (items);
+}
+
+static void test_string (void)
+{
+    struct hashmap *map;
+    char key[16];
+    char longkey[] = "0123456789abcdefg";
+    int errors;
+    int i;
+
+    if (!(map = hashmap_create_string (15)))
+        BAIL_OUT ("hashmap_create_string failed");
+    errors = 0;
+    for (i = 0; i < 1000; i++) {
+        snprintf (key, sizeof (key), "key-%d", i);
+        if (hashmap_insert (map, key, (void *)(uintptr_t)(i + 1)) < 0)
+            errors++;
+    }
+    ok (errors == 0 && hashmap_size (map) == 1000,
+        "string: inserted 1000 items");
+    errors = 0;
+    for (i = 0; i < 1000; i++) {
+        snprintf (key, sizeof (key), "key-%d", i);
+        if (hashmap_lookup (map, key) != (void *)(uintptr_t)(i + 1))
+            errors++;
+    }
+    ok (errors == 0,
+        "string: all items can be looked up");
+    ok (hashmap_lookup (map, "key-1000") == NULL,
+        "string: lookup of a missing key returns NULL");
+    ok (hashmap_lookup (map, "key-") == NULL,
+        "string: lookup of a prefix of a key returns NULL");
+    errno = 0;
+    ok (hashmap_insert (map, longkey, longkey) < 0 && errno == EINVAL,
+        "string: inserting a key that is too long fails with EINVAL");
+    ok (hashmap_lookup (map, longkey) == NULL,
+        "string: lookup of a key that is too long returns NULL");
+    ok (hashmap_insert (map, "0123456789abcde", longkey) == 0
+        && hashmap_lookup (map, "0123456789abcde") == longkey,
+        "string: a key of the maximum length works");
+    hashmap_delete (map, "key-0");
+    ok (hashmap_lookup (map, "key-0") == NULL
+        && hashmap_size (map) == 1000,
+        "string: hashmap_delete works");
+    ok (hashmap_first (map) != NULL
+        && (strstarts (hashmap_cursor (map), "key-")
+            || streq (hashmap_cursor (map), "0123456789abcde")),
+        "string: hashmap_cursor returns a string key");
+    hashmap_destroy (map);
+}
+
+int main (int argc, char *argv[])
+{
+    plan (NO_PLAN);
+
+    test_badargs ();
+    test_basic (NULL, "default hash", NITEMS);
+    test_basic (key_hash, "key hash", NITEMS);
+    test_basic (bad_hash, "bad hash", 500);
+    test_string ();
+
+    done_testing ();
+    return 0;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,162 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <errno.h>
+#include <stdbool.h>
+
+#include "src/common/libtap/tap.h"
+#include "src/common/libutil/hdrhist.h"
+
+static bool within (double value, double expected, double error)
+{
+    return value >= expected && value <= expected * (1. + error);
+}
+
+static void test_basic (void)
+{
+    struct hdrhist *h;
+
+    ok ((h = hdrhist_create (3)) != NULL,
+        "hdrhist_create works");
+    ok (hdrhist_count (h) == 0
+        && hdrhist_quantile (h, 0.5) == 0.
+        && hdrhist_mean (h) == 0.,
+        "empty histogram has no count, quantiles, or mean");
+
+    /* 1..1000 */
+    for (int i = 1; i <= 1000; i++)
+        hdrhist_record (h, i);
+    ok (hdrhist_count (h) == 1000,
+        "count is correct");
+    ok (hdrhist_min (h) == 1. && hdrhist_max (h) == 1000.,
+        "min and max are correct");
+    ok (hdrhist_mean (h) == 500.5,
+        "mean is correct");
+    ok (within (hdrhist_quantile (h, 0.50), 500., 0.125),
+        "p50 is within 12.5%% of 500 (%g)", hdrhist_quantile (h, 0.50));
+    ok (within (hdrhist_quantile (h, 0.95), 950., 0.125),
+        "p95 is within 12.5%% of 950 (%g)", hdrhist_quantile (h, 0.95));
+    ok (within (hdrhist_quantile (h, 0.99), 990., 0.125),
+        "p99 is within 12.5%% of 990 (%g)", hdrhist_quantile (h, 0.99));
+    ok (hdrhist_quantile (h, 1.0) == 1000.,
+        "p100 is capped at max");
+
+    hdrhist_clear (h);
+    ok (hdrhist_count (h) == 0,
+        "hdrhist_clear works");
+
+    hdrhist_record (h, -1);
+    hdrhist_record (h, 1E300);
+    ok (hdrhist_count (h) == 2 && hdrhist_min (h) == 0.,
+        "out of range values are recorded");
+    ok (hdrhist_quantile (h, 1.0) == 1E300,
+        "huge value is reported as max");
+
+    hdrhist_destroy (h);
+}
+
+static void test_small (void)
+{
+    struct hdrhist *h;
+
+    if (!(h = hdrhist_create (2)))
+        BAIL_OUT ("hdrhist_create failed");
+    hdrhist_record (h, 0);
+    hdrhist_record (h, 1);
+    hdrhist_record (h, 2);
+    hdrhist_record (h, 3);
+    ok (hdrhist_quantile (h, 0.25) == 1.
+        && hdrhist_quantile (h, 0.50) == 2.
+        && hdrhist_quantile (h, 0.75) == 3.
+        && hdrhist_quantile (h, 1.0) == 3.,
+        "values below 2^precision have unit resolution");
+    hdrhist_destroy (h);
+}
+
+static void test_merge (void)
+{
+    struct hdrhist *a = NULL;
+    struct hdrhist *b = NULL;
+    struct hdrhist *c = NULL;
+
+    if (!(a = hdrhist_create (3))
+        || !(b = hdrhist_create (3))
+        || !(c = hdrhist_create (4)))
+        BAIL_OUT ("hdrhist_create failed");
+
+    /* 90 x 1000, 10 x 100000 split across two histograms */
+    for (int i = 0; i < 90; i++)
+        hdrhist_record (a, 1000);
+    for (int i = 0; i < 10; i++)
+        hdrhist_record (b, 100000);
+    ok (hdrhist_merge (a, b) == 0,
+        "hdrhist_merge works");
+    ok (hdrhist_count (a) == 100
+        && hdrhist_min (a) == 1000.
+        && hdrhist_max (a) == 100000.,
+        "merged count, min and max are correct");
+    ok (within (hdrhist_quantile (a, 0.90), 1000., 0.125),
+        "merged p90 is within 12.5%% of 1000 (%g)",
+        hdrhist_quantile (a, 0.90));
+    ok (within (hdrhist_quantile (a, 0.95), 100000., 0.125),
+        "merged p95 is within 12.5%% of 100000 (%g)",
+        hdrhist_quantile (a, 0.95));
+    ok (hdrhist_count (b) == 10,
+        "merge source is unchanged");
+
+    hdrhist_clear (b);
+    ok (hdrhist_merge (a, b) == 0 && hdrhist_count (a) == 100,
+        "merging an empty histogram is a no-op");
+
+    errno = 0;
+    ok (hdrhist_merge (a, c) < 0 && errno == EINVAL,
+        "hdrhist_merge fails with EINVAL on precision mismatch");
+
+    hdrhist_destroy (a);
+    hdrhist_destroy (b);
+    hdrhist_destroy (c);
+}
+
+static void test_inval (void)
+{
+    errno = 0;
+    ok (hdrhist_create (0) == NULL && errno == EINVAL,
+        "hdrhist_create precision=0 fails with EINVAL");
+    errno = 0;
+    ok (hdrhist_create (9) == NULL && errno == EINVAL,
+        "hdrhist_create precision=9 fails with EINVAL");
+    errno = 0;
+    ok (hdrhist_merge (NULL, NULL) < 0 && errno == EINVAL,
+        "hdrhist_merge NULL fails with EINVAL");
+    lives_ok ({hdrhist_record (NULL, 1.);},
+        "hdrhist_record hist=NULL doesn't crash");
+    lives_ok ({hdrhist_destroy (NULL);},
+        "hdrhist_destroy hist=NULL doesn't crash");
+}
+
+int main (int argc, char *argv[])
+{
+    plan (NO_PLAN);
+
+    test_basic ();
+    test_small ();
+    test_merge ();
+    test_inval ();
+
+    done_testing ();
+    return 0;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,206 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <errno.h>
+#include <stdlib.h>
+
+#include "src/common/libtap/tap.h"
+#include "src/common/libutil/heap.h"
+
+#define NITEMS 1000
+
+struct item {
+    int priority;
+    int id;
+    void *handle;
+    int refcount;
+};
+
+/* Order by priority (high to low), then id (low to high).
+ */
+static int item_cmp (const void *a1, const void *a2)
+{
+    const struct item *i1 = a1;
+    const struct item *i2 = a2;
+
+    if (i1->priority != i2->priority)
+        return i1->priority > i2->priority ? -1 : 1;
+    return i1->id < i2->id ? -1 : i1->id > i2->id ? 1 : 0;
+}
+
+static void item_destructor (void **item)
+{
+    if (item) {
+        ((struct item *)*item)->refcount--;
+        *item = NULL;
+    }
+}
+
+static void *item_duplicator (const void *item)
+{
+    struct item *i = (struct item *)item;
+    i->refcount++;
+    return i;
+}
+
+/* Return 0 if iteration returns items in comparator order.
+ */
+static int check_order (struct heap *h)
+{
+    struct item *prev = NULL;
+    struct item *i;
+    size_t count = 0;
+
+    i = heap_first (h);
+    while (i) {
+        if (prev && item_cmp (prev, i) >= 0)
+            return -1;
+        prev = i;
+        count++;
+        i = heap_next (h);
+    }
+    return count == heap_size (h) ? 0 : -1;
+}
+
+void test_badargs (void)
+{
+    struct heap *h;
+
+    errno = 0;
+    ok (heap_create (NULL) == NULL && errno == EINVAL,
+        "heap_create comparator=NULL fails with EINVAL");
+    if (!(h = heap_create (item_cmp)))
+        BAIL_OUT ("heap_create failed");
+    errno = 0;
+    ok (heap_delete (h, NULL) < 0 && errno == EINVAL,
+        "heap_delete handle=NULL fails with EINVAL");
+    ok (heap_first (h) == NULL && heap_next (h) == NULL,
+        "heap_first/next on empty heap return NULL");
+    ok (heap_size (h) == 0 && heap_size (NULL) == 0,
+        "heap_size is 0");
+    lives_ok ({heap_reorder (h, NULL);},
+        "heap_reorder handle=NULL doesn't crash");
+    heap_destroy (h);
+    lives_ok ({heap_destroy (NULL);},
+        "heap_destroy h=NULL doesn't crash");
+}
+
+void test_order (void)
+{
+    struct heap *h;
+    struct item items[NITEMS];
+    struct item *i;
+    int errors;
+    int n;
+
+    if (!(h = heap_create (item_cmp)))
+        BAIL_OUT ("heap_create failed");
+    heap_set_destructor (h, item_destructor);
+    heap_set_duplicator (h, item_duplicator);
+
+    srand (42);
+    errors = 0;
+    for (n = 0; n < NITEMS; n++) {
+        items[n].priority = rand () % 16; // many ties broken by id
+        items[n].id = n;
+        items[n].refcount = 0;
+        if (!(items[n].handle = heap_insert (h, &items[n]))
+            || heap_handle_item (items[n].handle) != &items[n])
+            errors++;
+    }
+    ok (errors == 0 && heap_size (h) == NITEMS,
+        "heap_insert %d items works", NITEMS);
+    ok (items[0].refcount == 1,
+        "heap_insert calls the duplicator");
+    ok (check_order (h) == 0,
+        "heap_first/next iterate in order");
+
+    for (n = 0; n < NITEMS; n += 3) {
+        items[n].priority = rand () % 16;
+        heap_reorder (h, items[n].handle);
+    }
+    ok (check_order (h) == 0,
+        "heap_reorder restores order");
+
+    for (n = 0; n < NITEMS; n++)
+        items[n].priority = rand () % 16;
+    heap_rebuild (h);
+    ok (check_order (h) == 0,
+        "heap_rebuild restores order");
+
+    errors = 0;
+    for (n = 0; n < NITEMS; n += 2) {
+        if (heap_delete (h, items[n].handle) < 0 || items[n].refcount != 0)
+            errors++;
+    }
+    ok (errors == 0 && heap_size (h) == NITEMS / 2,
+        "heap_delete of every other item works and calls destructor");
+    ok (check_order (h) == 0,
+        "order is preserved after deletions");
+
+    errors = 0;
+    while ((i = heap_first (h))) {
+        struct item *next = heap_next (h);
+        if (next && item_cmp (i, next) >= 0)
+            errors++;
+        if (heap_delete (h, i->handle) < 0)
+            errors++;
+    }
+    ok (errors == 0 && heap_size (h) == 0,
+        "deleting the first item until empty returns items in order");
+    heap_destroy (h);
+}
+
+void test_destroy (void)
+{
+    struct heap *h;
+    struct item items[10];
+    int n;
+
+    if (!(h = heap_create (item_cmp)))
+        BAIL_OUT ("heap_create failed");
+    heap_set_destructor (h, item_destructor);
+    heap_set_duplicator (h, item_duplicator);
+    for (n = 0; n < 10; n++) {
+        items[n].priority = n;
+        items[n].id = n;
+        items[n].refcount = 0;
+        if (!heap_insert (h, &items[n]))
+            BAIL_OUT ("heap_insert failed");
+    }
+    ok (((struct item *)heap_first (h))->id == 9,
+        "heap_first returns highest priority item");
+    heap_destroy (h);
+    for (n = 0; n < 10; n++) {
+        if (items[n].refcount != 0)
+            break;
+    }
+    ok (n == 10,
+        "heap_destroy calls destructor on remaining items");
+}
+
+int main (int argc, char *argv[])
+{
+    plan (NO_PLAN);
+
+    test_badargs ();
+    test_order ();
+    test_destroy ();
+
+    done_testing ();
+    return (0);
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
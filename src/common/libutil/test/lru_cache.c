@@ -12,6 +12,7 @@
 #include "config.h"
 #endif
 #include <errno.h>
+#include <unistd.h>
 
 #include "src/common/libtap/tap.h"
 #include "src/common/libutil/lru_cache.h"
@@ -114,6 +115,84 @@ void test_corruption ()
     lru_cache_destroy (lru);
 }
 
+void test_weight ()
+{
+    int a = 1, b = 2, c = 3, d = 4;
+    lru_cache_t *lru = lru_cache_create (100);
+    lru_cache_set_free_f (lru, (lru_cache_free_f) fake_int_free);
+    lru_cache_set_maxweight (lru, 100);
+
+    ok (lru_cache_put_weighted (lru, "a", &a, 40) == 0,
+        "lru_cache_put_weighted (a, 40)");
+    ok (lru_cache_put_weighted (lru, "b", &b, 40) == 0,
+        "lru_cache_put_weighted (b, 40)");
+    ok (lru_cache_weight (lru) == 80,
+        "lru_cache_weight == 80");
+    ok (lru_cache_get (lru, "a") != NULL, "move a to front of list");
+    ok (lru_cache_put_weighted (lru, "c", &c, 40) == 0,
+        "lru_cache_put_weighted (c, 40)");
+    ok (b == -1 && lru_cache_check (lru, "b") == false,
+        "b was evicted to make room");
+    ok (a == 1 && c == 3 && lru_cache_weight (lru) == 80,
+        "a and c are still cached, weight == 80");
+    errno = 0;
+    ok (lru_cache_put_weighted (lru, "d", &d, 101) < 0 && errno == E2BIG,
+        "lru_cache_put_weighted of item heavier than maxweight fails");
+    ok (a == 1 && c == 3 && d == 4 && lru_cache_size (lru) == 2,
+        "nothing was evicted by failed put");
+    ok (lru_cache_put (lru, "d", &d) == 0 && lru_cache_size (lru) == 3,
+        "lru_cache_put of unweighted item works");
+    ok (lru_cache_remove (lru, "a") == 0 && lru_cache_weight (lru) == 40,
+        "lru_cache_remove reduces weight");
+    ok (lru_cache_selfcheck (lru) == 0, "lru_cache_selfcheck ()");
+
+    lru_cache_destroy (lru);
+}
+
+void test_ttl ()
+{
+    int a = 1, b = 2;
+    lru_cache_t *lru = lru_cache_create (10);
+    lru_cache_set_free_f (lru, (lru_cache_free_f) fake_int_free);
+    lru_cache_set_ttl (lru, 0.1);
+
+    ok (lru_cache_put (lru, "a", &a) == 0, "lru_cache_put (a)");
+    ok (lru_cache_check (lru, "a"), "a is cached");
+    usleep (200000);
+    ok (lru_cache_put (lru, "b", &b) == 0, "lru_cache_put (b)");
+    ok (lru_cache_get (lru, "a") == NULL && a == -1,
+        "a expired after ttl");
+    ok (lru_cache_get (lru, "b") != NULL, "b is cached");
+    ok (lru_cache_expire (lru) == 0, "lru_cache_expire purged nothing");
+    usleep (200000);
+    ok (lru_cache_expire (lru) == 1 && b == -1 && lru_cache_size (lru) == 0,
+        "lru_cache_expire purged b after ttl");
+    ok (lru_cache_selfcheck (lru) == 0, "lru_cache_selfcheck ()");
+
+    lru_cache_destroy (lru);
+}
+
+void test_stats ()
+{
+    struct lru_cache_stats stats;
+    int a = 1, b = 2;
+    lru_cache_t *lru = lru_cache_create (1);
+
+    lru_cache_get_stats (lru, &stats);
+    ok (stats.hits == 0 && stats.misses == 0
+        && stats.evictions == 0 && stats.expirations == 0,
+        "stats are initially zero");
+    ok (lru_cache_put (lru, "a", &a) == 0, "lru_cache_put (a)");
+    ok (lru_cache_get (lru, "a") != NULL, "lru_cache_get (a)");
+    ok (lru_cache_get (lru, "b") == NULL, "lru_cache_get (b) fails");
+    ok (lru_cache_put (lru, "b", &b) == 0, "lru_cache_put (b)");
+    lru_cache_get_stats (lru, &stats);
+    ok (stats.hits == 1 && stats.misses == 1
+        && stats.evictions == 1 && stats.expirations == 0,
+        "stats count 1 hit, 1 miss, and 1 eviction");
+
+    lru_cache_destroy (lru);
+}
 
 int main (int argc, char *argv[])
 {
@@ -121,6 +200,9 @@ int main (int argc, char *argv[])
     test_basic ();
     test_free_fn ();
     test_corruption ();
+    test_weight ();
+    test_ttl ();
+    test_stats ();
     done_testing ();
     return (0);
 }
@@ -16,8 +16,10 @@
 #include <stdio.h>
 #include <memory.h>
 #include <string.h>
+#include <stdlib.h>
 #include "src/common/libtap/tap.h"
 #include "src/common/libutil/sha256.h"
+#include "src/common/libutil/sha256_hw.h"
 
 /*********************** FUNCTION DEFINITIONS ***********************/
 void sha256_test()
@@ -55,10 +57,50 @@ void sha256_test()
 	    "text3 OK");
 }
 
+// Hash the text3 message (one million 'a') in a single update and in
+// uneven pieces, so that whole blocks are hashed from the caller's buffer
+// as well as through the context buffer.
+void sha256_bulk_test()
+{
+	BYTE hash3[SHA256_BLOCK_SIZE] = {0xcd,0xc7,0x6e,0x5c,0x99,0x14,0xfb,0x92,0x81,0xa1,0xc7,0xe2,0x84,0xd7,0x3e,0x67,
+	                                 0xf1,0x80,0x9a,0x48,0xa4,0x97,0x20,0x0e,0x04,0x6d,0x39,0xcc,0xc7,0x11,0x2c,0xd0};
+	size_t len = 1000000;
+	BYTE buf[SHA256_BLOCK_SIZE];
+	SHA256_CTX ctx;
+	BYTE *text;
+	size_t off, n;
+	size_t step;
+
+	diag ("sha256 implementation: %s",
+	      sha256_hw_name() ? sha256_hw_name() : "software");
+
+	if (!(text = malloc(len)))
+		BAIL_OUT ("out of memory");
+	memset(text, 'a', len);
+
+	sha256_init(&ctx);
+	sha256_update(&ctx, text, len);
+	sha256_final(&ctx, buf);
+	ok (!memcmp(hash3, buf, SHA256_BLOCK_SIZE),
+	    "text3 in one update OK");
+
+	sha256_init(&ctx);
+	for (off = 0, step = 1; off < len; off += n, step = step * 7 % 1021) {
+		n = len - off < step ? len - off : step;
+		sha256_update(&ctx, text + off, n);
+	}
+	sha256_final(&ctx, buf);
+	ok (!memcmp(hash3, buf, SHA256_BLOCK_SIZE),
+	    "text3 in uneven updates OK");
+
+	free(text);
+}
+
 int main()
 {
 	plan (NO_PLAN);
 	sha256_test ();
+	sha256_bulk_test ();
 	done_testing ();
 	return(0);
 }
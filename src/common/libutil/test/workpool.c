@@ -0,0 +1,146 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <poll.h>
+#include <pthread.h>
+#include <errno.h>
+
+#include "src/common/libtap/tap.h"
+#include "src/common/libutil/workpool.h"
+
+#define NITEMS 64
+
+struct item {
+    pthread_t worker;
+    int worked;
+    int done;
+};
+
+static int done_count;
+
+static void work_cb (void *arg)
+{
+    struct item *item = arg;
+    item->worker = pthread_self ();
+    item->worked++;
+}
+
+static void done_cb (void *arg)
+{
+    struct item *item = arg;
+    item->done++;
+    done_count++;
+}
+
+static void test_basic (void)
+{
+    struct workpool *wp;
+    struct item items[NITEMS] = { 0 };
+    struct pollfd pfd;
+    int errors;
+    int i;
+
+    wp = workpool_create (4);
+    ok (wp != NULL,
+        "workpool_create nthreads=4 works");
+    if (!wp)
+        BAIL_OUT ("could not create workpool");
+    pfd.fd = workpool_get_fd (wp);
+    pfd.events = POLLIN;
+    ok (pfd.fd >= 0,
+        "workpool_get_fd works");
+
+    errors = 0;
+    for (i = 0; i < NITEMS; i++) {
+        if (workpool_submit (wp, work_cb, done_cb, &items[i]) < 0)
+            errors++;
+    }
+    ok (errors == 0,
+        "workpool_submit %d items works", NITEMS);
+
+    done_count = 0;
+    while (done_count < NITEMS) {
+        if (poll (&pfd, 1, 10000) != 1)
+            break;
+        if (workpool_run_done (wp) < 0)
+            break;
+    }
+    ok (done_count == NITEMS,
+        "all done callbacks ran after fd became readable");
+    errors = 0;
+    for (i = 0; i < NITEMS; i++) {
+        if (items[i].worked != 1
+            || items[i].done != 1
+            || pthread_equal (items[i].worker, pthread_self ()))
+            errors++;
+    }
+    ok (errors == 0,
+        "each item was worked once in a pool thread and done once");
+    ok (poll (&pfd, 1, 0) == 0,
+        "fd is not readable after done callbacks are run");
+    ok (workpool_run_done (wp) == 0,
+        "workpool_run_done returns 0 when nothing is pending");
+
+    workpool_destroy (wp);
+}
+
+static void test_destroy (void)
+{
+    struct workpool *wp;
+    struct item items[NITEMS] = { 0 };
+    int i;
+
+    if (!(wp = workpool_create (1)))
+        BAIL_OUT ("could not create workpool");
+    for (i = 0; i < NITEMS; i++) {
+        if (workpool_submit (wp, work_cb, done_cb, &items[i]) < 0)
+            BAIL_OUT ("workpool_submit failed");
+    }
+    done_count = 0;
+    workpool_destroy (wp);
+    ok (done_count == NITEMS,
+        "workpool_destroy finished queued work and ran done callbacks");
+}
+
+static void test_inval (void)
+{
+    errno = 0;
+    ok (workpool_create (0) == NULL && errno == EINVAL,
+        "workpool_create nthreads=0 fails with EINVAL");
+    errno = 0;
+    ok (workpool_submit (NULL, work_cb, done_cb, NULL) < 0 && errno == EINVAL,
+        "workpool_submit wp=NULL fails with EINVAL");
+    errno = 0;
+    ok (workpool_get_fd (NULL) < 0 && errno == EINVAL,
+        "workpool_get_fd wp=NULL fails with EINVAL");
+    errno = 0;
+    ok (workpool_run_done (NULL) < 0 && errno == EINVAL,
+        "workpool_run_done wp=NULL fails with EINVAL");
+    lives_ok ({workpool_destroy (NULL);},
+        "workpool_destroy wp=NULL doesn't crash");
+}
+
+int main (int argc, char *argv[])
+{
+    plan (NO_PLAN);
+
+    test_basic ();
+    test_destroy ();
+    test_inval ();
+
+    done_testing ();
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,233 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* workpool.c - fixed pool of threads for blocking work
+ *
+ * Work items move from the 'queue' list to the 'done' list under 'lock'.
+ * A byte is written to the notify pipe when the 'done' list goes from
+ * empty to non-empty, and the pipe is drained by workpool_run_done(),
+ * so the read end is level-triggered for as long as callbacks are pending.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+
+#include "errno_safe.h"
+#include "workpool.h"
+
+struct work {
+    workpool_f work;
+    workpool_f done;
+    void *arg;
+    struct work *next;
+};
+
+struct worklist {
+    struct work *head;
+    struct work *tail;
+};
+
+struct workpool {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    struct worklist queue;
+    struct worklist done;
+    bool shutdown;
+    int nthreads;
+    pthread_t *threads;
+    int fds[2];
+};
+
+static void worklist_append (struct worklist *l, struct work *w)
+{
+    w->next = NULL;
+    if (l->tail)
+        l->tail->next = w;
+    else
+        l->head = w;
+    l->tail = w;
+}
+
+static struct work *worklist_pop (struct worklist *l)
+{
+    struct work *w;
+
+    if ((w = l->head)) {
+        if (!(l->head = w->next))
+            l->tail = NULL;
+    }
+    return w;
+}
+
+static void *workpool_thread (void *arg)
+{
+    struct workpool *wp = arg;
+    struct work *w;
+
+    pthread_mutex_lock (&wp->lock);
+    for (;;) {
+        while (!wp->queue.head && !wp->shutdown)
+            pthread_cond_wait (&wp->cond, &wp->lock);
+        if (!(w = worklist_pop (&wp->queue)))
+            break; // shutdown and queue is empty
+        pthread_mutex_unlock (&wp->lock);
+
+        if (w->work)
+            w->work (w->arg);
+
+        pthread_mutex_lock (&wp->lock);
+        if (!wp->done.head) {
+            char c = 0;
+            /* EAGAIN means the pipe is full, so the reader will wake anyway.
+             */
+            if (write (wp->fds[1], &c, 1) < 0 && errno != EAGAIN) {
+                fprintf (stderr,
+                         "workpool: write to notify pipe failed: %s\n",
+                         strerror (errno));
+            }
+        }
+        worklist_append (&wp->done, w);
+    }
+    pthread_mutex_unlock (&wp->lock);
+    return NULL;
+}
+
+int workpool_run_done (struct workpool *wp)
+{
+    struct worklist done;
+    struct work *w;
+    char buf[64];
+    int count = 0;
+
+    if (!wp) {
+        errno = EINVAL;
+        return -1;
+    }
+    pthread_mutex_lock (&wp->lock);
+    while (read (wp->fds[0], buf, sizeof (buf)) > 0)
+        ;
+    done = wp->done;
+    wp->done.head = wp->done.tail = NULL;
+    pthread_mutex_unlock (&wp->lock);
+
+    while ((w = worklist_pop (&done))) {
+        if (w->done)
+            w->done (w->arg);
+        free (w);
+        count++;
+    }
+    return count;
+}
+
+int workpool_submit (struct workpool *wp,
+                     workpool_f work,
+                     workpool_f done,
+                     void *arg)
+{
+    struct work *w;
+
+    if (!wp) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!(w = calloc (1, sizeof (*w))))
+        return -1;
+    w->work = work;
+    w->done = done;
+    w->arg = arg;
+
+    pthread_mutex_lock (&wp->lock);
+    worklist_append (&wp->queue, w);
+    pthread_cond_signal (&wp->cond);
+    pthread_mutex_unlock (&wp->lock);
+    return 0;
+}
+
+int workpool_get_fd (struct workpool *wp)
+{
+    if (!wp) {
+        errno = EINVAL;
+        return -1;
+    }
+    return wp->fds[0];
+}
+
+void workpool_destroy (struct workpool *wp)
+{
+    if (wp) {
+        int saved_errno = errno;
+        int i;
+
+        pthread_mutex_lock (&wp->lock);
+        wp->shutdown = true;
+        pthread_cond_broadcast (&wp->cond);
+        pthread_mutex_unlock (&wp->lock);
+        for (i = 0; i < wp->nthreads; i++)
+            pthread_join (wp->threads[i], NULL);
+        if (wp->fds[0] >= 0)
+            (void)workpool_run_done (wp);
+        free (wp->threads);
+        if (wp->fds[0] >= 0)
+            close (wp->fds[0]);
+        if (wp->fds[1] >= 0)
+            close (wp->fds[1]);
+        pthread_cond_destroy (&wp->cond);
+        pthread_mutex_destroy (&wp->lock);
+        free (wp);
+        errno = saved_errno;
+    }
+}
+
+struct workpool *workpool_create (int nthreads)
+{
+    struct workpool *wp;
+    int e;
+
+    if (nthreads < 1) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(wp = calloc (1, sizeof (*wp))))
+        return NULL;
+    pthread_mutex_init (&wp->lock, NULL);
+    pthread_cond_init (&wp->cond, NULL);
+    wp->fds[0] = wp->fds[1] = -1;
+    if (pipe2 (wp->fds, O_CLOEXEC | O_NONBLOCK) < 0)
+        goto error;
+    if (!(wp->threads = calloc (nthreads, sizeof (wp->threads[0]))))
+        goto error;
+    while (wp->nthreads < nthreads) {
+        if ((e = pthread_create (&wp->threads[wp->nthreads],
+                                 NULL,
+                                 workpool_thread,
+                                 wp))) {
+            errno = e;
+            goto error;
+        }
+        wp->nthreads++;
+    }
+    return wp;
+error:
+    workpool_destroy (wp);
+    return NULL;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
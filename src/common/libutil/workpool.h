@@ -0,0 +1,50 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _UTIL_WORKPOOL_H
+#define _UTIL_WORKPOOL_H
+
+/*  workpool: run blocking work on a fixed pool of threads.
+ *
+ *  Work is run in submission order by the first available thread.  When
+ *  it finishes, its 'done' callback is queued to be run by the thread
+ *  that owns the pool (e.g. a reactor thread) in workpool_run_done().
+ *  The file descriptor returned by workpool_get_fd() becomes readable when
+ *  'done' callbacks are pending, so it can be watched by an event loop.
+ */
+
+typedef void (*workpool_f)(void *arg);
+
+struct workpool *workpool_create (int nthreads);
+
+/*  Wait for all submitted work to finish, run pending 'done' callbacks,
+ *  then destroy the pool.
+ */
+void workpool_destroy (struct workpool *wp);
+
+/*  Submit 'work' to be run by a pool thread, and then 'done' to be run
+ *  by workpool_run_done().  Either may be NULL.
+ */
+int workpool_submit (struct workpool *wp,
+                     workpool_f work,
+                     workpool_f done,
+                     void *arg);
+
+/*  Run 'done' callbacks of finished work.  Returns the number run.
+ */
+int workpool_run_done (struct workpool *wp);
+
+int workpool_get_fd (struct workpool *wp);
+
+#endif /* !_UTIL_WORKPOOL_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -13,6 +13,7 @@
 #endif
 #include <errno.h>
 #include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 #include <assert.h>
 #include <inttypes.h>
@@ -31,7 +32,7 @@ int zmqutil_msg_send_ex (void *sock, const flux_msg_t *msg, bool nonblock)
     int flags = ZMQ_SNDMORE;
     struct msg_iovec *iov = NULL;
     int iovcnt;
-    uint8_t proto[PROTO_SIZE];
+    uint8_t proto[PROTO_SIZE_MAX];
     int count = 0;
     int rc = -1;
 
@@ -40,7 +41,7 @@ int zmqutil_msg_send_ex (void *sock, const flux_msg_t *msg, bool nonblock)
         return -1;
     }
 
-    if (msg_to_iovec (msg, proto, PROTO_SIZE, &iov, &iovcnt) < 0)
+    if (msg_to_iovec (msg, proto, sizeof (proto), &iov, &iovcnt) < 0)
         goto error;
 
     if (nonblock)
@@ -67,6 +68,100 @@ int zmqutil_msg_send (void *sock, const flux_msg_t *msg)
     return zmqutil_msg_send_ex (sock, msg, false);
 }
 
+struct zmqutil_mcast {
+    int count;
+    zmq_msg_t frames[];
+};
+
+void zmqutil_mcast_destroy (struct zmqutil_mcast *mc)
+{
+    if (mc) {
+        int saved_errno = errno;
+        int i;
+        for (i = 0; i < mc->count; i++)
+            zmq_msg_close (&mc->frames[i]);
+        free (mc);
+        errno = saved_errno;
+    }
+}
+
+struct zmqutil_mcast *zmqutil_mcast_create (const flux_msg_t *msg)
+{
+    struct zmqutil_mcast *mc = NULL;
+    struct msg_iovec *iov = NULL;
+    int iovcnt;
+    uint8_t proto[PROTO_SIZE_MAX];
+    int i;
+
+    if (!msg || !flux_msg_has_flag (msg, FLUX_MSGFLAG_ROUTE)) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (msg_to_iovec (msg, proto, sizeof (proto), &iov, &iovcnt) < 0)
+        return NULL;
+    if (!(mc = calloc (1, sizeof (*mc) + iovcnt * sizeof (mc->frames[0]))))
+        goto error;
+    for (i = 0; i < iovcnt; i++) {
+        if (zmq_msg_init_size (&mc->frames[i], iov[i].size) < 0)
+            goto error;
+        mc->count++;
+        if (iov[i].size > 0)
+            memcpy (zmq_msg_data (&mc->frames[i]), iov[i].data, iov[i].size);
+    }
+    free (iov);
+    return mc;
+error:
+    ERRNO_SAFE_WRAP (free, iov);
+    zmqutil_mcast_destroy (mc);
+    return NULL;
+}
+
+int zmqutil_mcast_send (void *sock,
+                        struct zmqutil_mcast *mc,
+                        const char *identity,
+                        bool nonblock)
+{
+    int flags = ZMQ_SNDMORE;
+    int i;
+
+    if (!sock || !mc || !identity) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (nonblock)
+        flags |= ZMQ_DONTWAIT;
+    if (zmq_send (sock, identity, strlen (identity), flags) < 0)
+        return -1;
+    /* zmq_msg_copy() shares the frame content by reference count
+     * (small frames are simply copied), and zmq_msg_send() consumes
+     * the copy, leaving mc->frames intact for the next peer.
+     */
+    for (i = 0; i < mc->count; i++) {
+        zmq_msg_t part;
+
+        if ((i + 1) == mc->count)
+            flags &= ~ZMQ_SNDMORE;
+        zmq_msg_init (&part);
+        if (zmq_msg_copy (&part, &mc->frames[i]) < 0
+            || zmq_msg_send (&part, sock, flags) < 0) {
+            ERRNO_SAFE_WRAP (zmq_msg_close, &part);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void part_destroy (void *arg)
+{
+    zmq_msg_t *msgdata = arg;
+    if (msgdata) {
+        int saved_errno = errno;
+        zmq_msg_close (msgdata);
+        free (msgdata);
+        errno = saved_errno;
+    }
+}
+
 flux_msg_t *zmqutil_msg_recv (void *sock)
 {
     struct msg_iovec *iov = NULL;
@@ -83,7 +178,8 @@ flux_msg_t *zmqutil_msg_recv (void *sock)
     /* N.B. we need to store a zmq_msg_t for each iovec entry so that
      * the memory is available during the call to iovec_to_msg().  We
      * use the msg_iovec's "transport_data" field to store the entry
-     * and then clear/free it later.
+     * and then clear/free it later.  A large payload frame is handed off
+     * to the message instead of being copied (transport_data is cleared).
      */
     while (true) {
         zmq_msg_t *msgdata;
@@ -116,18 +212,15 @@ flux_msg_t *zmqutil_msg_recv (void *sock)
             break;
     }
 
-    if (!(msg = iovec_to_msg (iov, iovcnt)))
+    if (!(msg = iovec_to_msg_borrow (iov, iovcnt, part_destroy)))
         goto error;
     rv = msg;
 error:
     if (iov) {
         int save_errno = errno;
         int i;
-        for (i = 0; i < iovcnt; i++) {
-            zmq_msg_t *msgdata = iov[i].transport_data;
-            zmq_msg_close (msgdata);
-            free (msgdata);
-        }
+        for (i = 0; i < iovcnt; i++)
+            part_destroy (iov[i].transport_data);
         free (iov);
         errno = save_errno;
     }
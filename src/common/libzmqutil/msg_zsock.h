@@ -26,6 +26,19 @@ extern "C" {
 int zmqutil_msg_send (void *dest, const flux_msg_t *msg);
 int zmqutil_msg_send_ex (void *dest, const flux_msg_t *msg, bool nonblock);
 
+/* Encode a message once for delivery to many ROUTER socket peers.
+ * The message must have routing enabled.  zmqutil_mcast_send() sends
+ * 'identity' as the first frame, followed by the pre-encoded frames,
+ * which are shared by reference rather than copied for each peer.
+ * Returns 0 (or object) on success, -1 (or NULL) on failure with errno set.
+ */
+struct zmqutil_mcast *zmqutil_mcast_create (const flux_msg_t *msg);
+void zmqutil_mcast_destroy (struct zmqutil_mcast *mc);
+int zmqutil_mcast_send (void *dest,
+                        struct zmqutil_mcast *mc,
+                        const char *identity,
+                        bool nonblock);
+
 /* Receive a message from zeromq socket.
  * Returns message on success, NULL on failure with errno set.
  */
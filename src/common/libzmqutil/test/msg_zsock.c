@@ -84,6 +84,88 @@ void check_sendzsock (void)
     zmq_close (zsock[1]);
 }
 
+void check_mcast (void)
+{
+    void *router;
+    void *dealer[2];
+    const char *id[2] = { "child0", "child1" };
+    const char *uri = "inproc://test-mcast";
+    struct zmqutil_mcast *mc;
+    flux_msg_t *msg, *msg2;
+    const char *topic;
+    const char *s;
+    int i;
+
+    if (!(router = zmq_socket (zctx, ZMQ_ROUTER))
+        || zsetsockopt_int (router, ZMQ_LINGER, 5) < 0
+        || zsetsockopt_int (router, ZMQ_ROUTER_MANDATORY, 1) < 0
+        || zmq_bind (router, uri) < 0)
+        BAIL_OUT ("could not create ROUTER socket");
+    for (i = 0; i < 2; i++) {
+        if (!(dealer[i] = zmq_socket (zctx, ZMQ_DEALER))
+            || zsetsockopt_int (dealer[i], ZMQ_LINGER, 5) < 0
+            || zsetsockopt_str (dealer[i], ZMQ_IDENTITY, id[i]) < 0
+            || zmq_connect (dealer[i], uri) < 0)
+            BAIL_OUT ("could not create DEALER socket");
+    }
+    /* Ensure the ROUTER knows both peers before sending to them.
+     */
+    for (i = 0; i < 2; i++) {
+        char buf[16];
+        if (zmq_send (dealer[i], "", 0, 0) < 0
+            || zmq_recv (router, buf, sizeof (buf), 0) < 0
+            || zmq_recv (router, buf, sizeof (buf), 0) < 0)
+            BAIL_OUT ("could not exchange greeting with DEALER");
+    }
+
+    if (!(msg = flux_msg_create (FLUX_MSGTYPE_EVENT))
+        || flux_msg_set_topic (msg, "foo.bar") < 0
+        || flux_msg_set_string (msg, "hello world") < 0)
+        BAIL_OUT ("could not create test message");
+
+    errno = 0;
+    ok (zmqutil_mcast_create (msg) == NULL && errno == EINVAL,
+        "zmqutil_mcast_create fails with EINVAL if routing is not enabled");
+    errno = 0;
+    ok (zmqutil_mcast_create (NULL) == NULL && errno == EINVAL,
+        "zmqutil_mcast_create msg=NULL fails with EINVAL");
+
+    flux_msg_route_enable (msg);
+    ok ((mc = zmqutil_mcast_create (msg)) != NULL,
+        "zmqutil_mcast_create works");
+    errno = 0;
+    ok (zmqutil_mcast_send (NULL, mc, id[0], false) < 0 && errno == EINVAL,
+        "zmqutil_mcast_send dest=NULL fails with EINVAL");
+    errno = 0;
+    ok (zmqutil_mcast_send (router, mc, "nobody", true) < 0
+        && errno == EHOSTUNREACH,
+        "zmqutil_mcast_send to unknown peer fails with EHOSTUNREACH");
+    for (i = 0; i < 2; i++) {
+        ok (zmqutil_mcast_send (router, mc, id[i], false) == 0,
+            "zmqutil_mcast_send %s works", id[i]);
+    }
+    zmqutil_mcast_destroy (mc);
+    flux_msg_destroy (msg);
+
+    for (i = 0; i < 2; i++) {
+        ok ((msg2 = zmqutil_msg_recv (dealer[i])) != NULL
+            && flux_msg_route_count (msg2) == 0
+            && flux_msg_get_topic (msg2, &topic) == 0
+            && streq (topic, "foo.bar")
+            && flux_msg_get_string (msg2, &s) == 0
+            && streq (s, "hello world"),
+            "%s received the message intact", id[i]);
+        flux_msg_destroy (msg2);
+    }
+
+    lives_ok ({zmqutil_mcast_destroy (NULL);},
+              "zmqutil_mcast_destroy NULL doesn't crash");
+
+    for (i = 0; i < 2; i++)
+        zmq_close (dealer[i]);
+    zmq_close (router);
+}
+
 int main (int argc, char *argv[])
 {
     plan (NO_PLAN);
@@ -92,6 +174,7 @@ int main (int argc, char *argv[])
         BAIL_OUT ("could not create zeromq context");
 
     check_sendzsock ();
+    check_mcast ();
 
     zmq_ctx_term (zctx);
 
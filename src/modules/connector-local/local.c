@@ -27,12 +27,18 @@
 #include <ctype.h>
 #include <inttypes.h>
 #include <flux/core.h>
+#include <jansson.h>
 
+#include "ccan/str/str.h"
 #include "src/common/libczmqcontainers/czmq_containers.h"
 #include "src/common/libutil/cleanup.h"
 #include "src/common/libutil/errprintf.h"
+#include "src/common/libutil/parse_size.h"
 #include "src/common/librouter/usock.h"
 #include "src/common/librouter/router.h"
+#include "src/common/librouter/shmring.h"
+
+#include "shmem.h"
 
 enum {
     DEBUG_AUTHFAIL_ONESHOT = 1, /* force auth to fail one time */
@@ -41,14 +47,20 @@ enum {
 
 struct connector_local {
     struct usock_server *server;
+    struct shmem_server *shmem;
     struct router *router;
     flux_t *h;
     uid_t instance_owner;
     int allow_guest_user;
     int allow_root_owner;
+    size_t sendq_limit;
+    enum usock_sendq_policy sendq_policy;
+    uint64_t sendq_disconnects;
     flux_msg_handler_t **handlers;
 };
 
+static const char *default_sendq_limit = "128M";
+
 /* A 'struct route_entry' is attached to the 'struct usock_conn' aux hash
  * so that when the client is destroyed, its route is also destroyed.
  * This also helps bridge uconn_recv() to router_entry_recv().
@@ -111,13 +123,30 @@ error:
     return -1;
 }
 
+static int shmem_authenticate (uid_t cuid,
+                               struct flux_msg_cred *cred,
+                               void *arg)
+{
+    return client_authenticate (arg, cuid, cred);
+}
+
 /* Usock client encounters an error.
  */
 static void uconn_error (struct usock_conn *uconn, int errnum, void *arg)
 {
     struct connector_local *ctx = arg;
 
-    if (errnum != EPIPE && errnum != EPROTO && errnum != ECONNRESET) {
+    if (errnum == ENOBUFS) {
+        const struct flux_msg_cred *cred = usock_conn_get_cred (uconn);
+        flux_log (ctx->h,
+                  LOG_ERR,
+                  "client=%.5s userid=%u disconnected:"
+                  " send queue limit exceeded",
+                  usock_conn_get_uuid (uconn),
+                  (unsigned int)cred->userid);
+        ctx->sendq_disconnects++;
+    }
+    else if (errnum != EPIPE && errnum != EPROTO && errnum != ECONNRESET) {
         const struct flux_msg_cred *cred = usock_conn_get_cred (uconn);
         errno = errnum;
         flux_log_error (ctx->h,
@@ -207,6 +236,15 @@ error:
  *
  * Missing [access] keys are interpreted as false.
  * [access] keys other than the above are not allowed.
+ *
+ * Also parse the [connector-local] table, which bounds the per-client
+ * send queue:
+ *
+ * send-queue-limit = "128M"
+ *   Bytes queued for one client before the policy applies, 0 = unlimited
+ *
+ * send-queue-policy = "disconnect" | "drop"
+ *   Disconnect the client, or drop messages while the queue is full
  */
 int parse_config (struct connector_local *ctx,
                   const flux_conf_t *conf,
@@ -215,6 +253,10 @@ int parse_config (struct connector_local *ctx,
     flux_error_t error;
     int allow_guest_user = 0;
     int allow_root_owner = 0;
+    const char *limit = default_sendq_limit;
+    const char *policy = "disconnect";
+    uint64_t size;
+    enum usock_sendq_policy sendq_policy;
 
     if (flux_conf_unpack (conf,
                           &error,
@@ -229,8 +271,46 @@ int parse_config (struct connector_local *ctx,
                    error.text);
         return -1;
     }
+    if (flux_conf_unpack (conf,
+                          &error,
+                          "{s?{s?s s?s !}}",
+                          "connector-local",
+                            "send-queue-limit", &limit,
+                            "send-queue-policy", &policy) < 0) {
+        errprintf (errp,
+                   "error parsing [connector-local] configuration: %s",
+                   error.text);
+        return -1;
+    }
+    if (parse_size (limit, &size) < 0 || size > SIZE_MAX) {
+        errprintf (errp,
+                   "invalid connector-local.send-queue-limit: '%s'",
+                   limit);
+        errno = EINVAL;
+        return -1;
+    }
+    if (streq (policy, "disconnect"))
+        sendq_policy = USOCK_SENDQ_DISCONNECT;
+    else if (streq (policy, "drop"))
+        sendq_policy = USOCK_SENDQ_DROP;
+    else {
+        errprintf (errp,
+                   "invalid connector-local.send-queue-policy: '%s'",
+                   policy);
+        errno = EINVAL;
+        return -1;
+    }
+    if (ctx->server
+        && usock_server_set_sendq_limit (ctx->server,
+                                         size,
+                                         sendq_policy) < 0) {
+        errprintf (errp, "error setting send queue limit");
+        return -1;
+    }
     ctx->allow_guest_user = allow_guest_user;
     ctx->allow_root_owner = allow_root_owner;
+    ctx->sendq_limit = size;
+    ctx->sendq_policy = sendq_policy;
     flux_log (ctx->h,
               LOG_DEBUG,
               "allow-guest-user=%s",
@@ -270,8 +350,70 @@ error:
         flux_log_error (h, "error responding to config-reload request");
 }
 
+static json_t *conn_stats (struct usock_conn *uconn)
+{
+    const struct usock_conn_stats *stats = usock_conn_get_stats (uconn);
+    const struct flux_msg_cred *cred = usock_conn_get_cred (uconn);
+
+    return json_pack ("{s:i s:I s:I s:I s:I s:I s:I s:I s:I}",
+                      "userid", (int)cred->userid,
+                      "recv_msgs", (json_int_t)stats->recv_msgs,
+                      "recv_bytes", (json_int_t)stats->recv_bytes,
+                      "send_msgs", (json_int_t)stats->send_msgs,
+                      "send_bytes", (json_int_t)stats->send_bytes,
+                      "drop_msgs", (json_int_t)stats->drop_msgs,
+                      "queue_msgs", (json_int_t)stats->queue_msgs,
+                      "queue_bytes", (json_int_t)stats->queue_bytes,
+                      "queue_bytes_max", (json_int_t)stats->queue_bytes_max);
+}
+
+static void stats_cb (flux_t *h,
+                      flux_msg_handler_t *mh,
+                      const flux_msg_t *msg,
+                      void *arg)
+{
+    struct connector_local *ctx = arg;
+    struct usock_conn *uconn;
+    json_t *clients;
+
+    if (flux_request_decode (msg, NULL, NULL) < 0)
+        goto error;
+    if (!(clients = json_object ()))
+        goto nomem;
+    uconn = usock_server_first_conn (ctx->server);
+    while (uconn) {
+        json_t *o;
+        if (!(o = conn_stats (uconn))
+            || json_object_set_new (clients,
+                                    usock_conn_get_uuid (uconn),
+                                    o) < 0) {
+            json_decref (o);
+            json_decref (clients);
+            goto nomem;
+        }
+        uconn = usock_server_next_conn (ctx->server);
+    }
+    if (flux_respond_pack (h,
+                           msg,
+                           "{s:I s:s s:I s:o}",
+                           "send_queue_limit", (json_int_t)ctx->sendq_limit,
+                           "send_queue_policy",
+                           ctx->sendq_policy == USOCK_SENDQ_DROP
+                               ? "drop" : "disconnect",
+                           "disconnects", (json_int_t)ctx->sendq_disconnects,
+                           "clients", clients) < 0)
+        flux_log_error (h, "error responding to stats-get request");
+    return;
+nomem:
+    errno = ENOMEM;
+error:
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        flux_log_error (h, "error responding to stats-get request");
+}
+
 static const struct flux_msg_handler_spec htab[] = {
     { FLUX_MSGTYPE_REQUEST,  "connector-local.config-reload", reload_cb, 0 },
+    { FLUX_MSGTYPE_REQUEST,  "connector-local.stats-get", stats_cb, 0 },
     FLUX_MSGHANDLER_TABLE_END,
 };
 
@@ -281,6 +423,7 @@ int mod_main (flux_t *h, int argc, char **argv)
     const char *local_uri = NULL;
     char *tmpdir;
     const char *sockpath;
+    char *shmem_sockpath = NULL;
     flux_error_t error;
     int rc = -1;
 
@@ -323,6 +466,35 @@ int mod_main (flux_t *h, int argc, char **argv)
     }
     cleanup_push_string (cleanup_file, sockpath);
     usock_server_set_acceptor (ctx.server, acceptor_cb, &ctx);
+    if (usock_server_set_sendq_limit (ctx.server,
+                                      ctx.sendq_limit,
+                                      ctx.sendq_policy) < 0) {
+        flux_log_error (h, "error setting send queue limit");
+        goto done;
+    }
+
+    /* Create listen socket for shmem:// clients next to the local one.
+     * This is optional since local:// clients are unaffected without it,
+     * e.g. if the longer path does not fit in sun_path.
+     */
+    if (asprintf (&shmem_sockpath,
+                  "%s%s",
+                  sockpath,
+                  SHMRING_SOCKET_SUFFIX) < 0) {
+        shmem_sockpath = NULL;
+        goto done;
+    }
+    if (!(ctx.shmem = shmem_server_create (h,
+                                           shmem_sockpath,
+                                           ctx.router,
+                                           shmem_authenticate,
+                                           &ctx))) {
+        flux_log_error (h,
+                        "%s: shmem:// connector is unavailable",
+                        shmem_sockpath);
+    }
+    else
+        cleanup_push_string (cleanup_file, shmem_sockpath);
 
     if (flux_msg_handler_addvec (h, htab, &ctx, &ctx.handlers) < 0)
         goto done;
@@ -339,6 +511,8 @@ int mod_main (flux_t *h, int argc, char **argv)
 done:
     flux_msg_handler_delvec (ctx.handlers);
     usock_server_destroy (ctx.server); // destroy before router
+    shmem_server_destroy (ctx.shmem);
+    free (shmem_sockpath);
     router_destroy (ctx.router);
     return rc;
 }
@@ -0,0 +1,431 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* shmem.c - serve shmem:// clients
+ *
+ * A client connects to a unix domain socket next to the local:// socket
+ * and is authenticated with SO_PEERCRED exactly like a local client.
+ * The server then creates a shmring and passes its descriptors to the
+ * client.  From then on, messages move through shared memory, and the
+ * socket is only watched for EOF, which signals client disconnect.
+ *
+ * Each connection uses prepare/check watchers to poll the rings once per
+ * reactor loop, and only arms its eventfd when the rings are idle, so
+ * a busy client is serviced without any system calls.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <uuid.h>
+#include <flux/core.h>
+
+#include "src/common/libczmqcontainers/czmq_containers.h"
+#include "src/common/libutil/fdutils.h"
+#include "src/common/librouter/auth.h"
+#include "src/common/librouter/router.h"
+#include "src/common/librouter/shmring.h"
+
+#include "shmem.h"
+
+#ifndef UUID_STR_LEN
+#define UUID_STR_LEN 37     // defined in later libuuid headers
+#endif
+
+#define LISTEN_BACKLOG 5
+
+/* Limit the number of messages handled from one client per reactor
+ * loop so that a chatty client cannot starve the others.
+ */
+static const int shmem_recv_batch = 256;
+
+struct shmem_server {
+    flux_t *h;
+    struct router *router;
+    shmem_auth_f auth;
+    void *auth_arg;
+    int fd;
+    char *sockpath;
+    flux_watcher_t *w;
+    zlist_t *conns;
+};
+
+struct shmem_conn {
+    struct shmem_server *ss;
+    int fd;
+    struct shmring *ring;
+    struct flux_msg_cred cred;
+    char uuid[UUID_STR_LEN];
+    struct router_entry *entry;
+    zlist_t *outqueue;
+    flux_watcher_t *fd_w;
+    flux_watcher_t *efd_w;
+    flux_watcher_t *prep_w;
+    flux_watcher_t *check_w;
+    flux_watcher_t *idle_w;
+};
+
+static void conn_destroy (struct shmem_conn *conn)
+{
+    if (conn) {
+        int saved_errno = errno;
+        flux_msg_t *msg;
+
+        if (conn->ss)
+            zlist_remove (conn->ss->conns, conn);
+        router_entry_delete (conn->entry);
+        flux_watcher_destroy (conn->fd_w);
+        flux_watcher_destroy (conn->efd_w);
+        flux_watcher_destroy (conn->prep_w);
+        flux_watcher_destroy (conn->check_w);
+        flux_watcher_destroy (conn->idle_w);
+        if (conn->outqueue) {
+            while ((msg = zlist_pop (conn->outqueue)))
+                flux_msg_decref (msg);
+            zlist_destroy (&conn->outqueue);
+        }
+        shmring_destroy (conn->ring);
+        if (conn->fd >= 0)
+            (void)close (conn->fd);
+        free (conn);
+        errno = saved_errno;
+    }
+}
+
+static void conn_error (struct shmem_conn *conn, int errnum)
+{
+    if (errnum != EPIPE && errnum != EPROTO && errnum != ECONNRESET) {
+        errno = errnum;
+        flux_log_error (conn->ss->h,
+                        "shmem client=%.5s userid=%u",
+                        conn->uuid,
+                        (unsigned int)conn->cred.userid);
+    }
+    conn_destroy (conn);
+}
+
+/* Move queued messages to the ring until it is full.  A message that
+ * was partially copied is held by the shmring and completed first.
+ */
+static int conn_flush (struct shmem_conn *conn)
+{
+    flux_msg_t *msg;
+
+    if (shmring_flush (conn->ring) < 0)
+        return errno == EAGAIN ? 0 : -1;
+    while ((msg = zlist_first (conn->outqueue))) {
+        if (shmring_send (conn->ring, msg) < 0 && errno != EAGAIN)
+            return -1;
+        (void)zlist_pop (conn->outqueue);
+        flux_msg_decref (msg);
+        if (shmring_tx_pending (conn->ring))
+            break;
+    }
+    return 0;
+}
+
+static int conn_recv (struct shmem_conn *conn)
+{
+    flux_msg_t *msg;
+    int count;
+
+    for (count = 0; count < shmem_recv_batch; count++) {
+        if (!(msg = shmring_recv (conn->ring)))
+            return errno == EAGAIN ? 0 : -1;
+        /* Update message credentials based on connected creds.
+         */
+        if (auth_init_message (msg, &conn->cred) < 0) {
+            flux_msg_destroy (msg);
+            return -1;
+        }
+        router_entry_recv (conn->entry, msg);
+        flux_msg_destroy (msg);
+    }
+    return 0;
+}
+
+/* Router sends message to a shmem client.
+ * If event is private, ensure user's credentials allow delivery.
+ */
+static int conn_send (const flux_msg_t *msg, void *arg)
+{
+    struct shmem_conn *conn = arg;
+    int type;
+
+    if (flux_msg_get_type (msg, &type) < 0)
+        return -1;
+    if (type == FLUX_MSGTYPE_EVENT) {
+        if (auth_check_event_privacy (msg, &conn->cred) < 0)
+            return -1;
+    }
+    if (zlist_size (conn->outqueue) == 0
+        && !shmring_tx_pending (conn->ring)) {
+        if (shmring_send (conn->ring, msg) < 0 && errno != EAGAIN)
+            return -1;
+        return 0;
+    }
+    if (zlist_append (conn->outqueue, (void *)flux_msg_incref (msg)) < 0) {
+        flux_msg_decref (msg);
+        errno = ENOMEM;
+        return -1;
+    }
+    return 0;
+}
+
+/* The client never writes to the socket after the handshake, so
+ * readability means EOF (disconnect) or a protocol error.
+ */
+static void conn_fd_cb (flux_reactor_t *r,
+                        flux_watcher_t *w,
+                        int revents,
+                        void *arg)
+{
+    struct shmem_conn *conn = arg;
+    char c;
+    ssize_t n;
+
+    if ((n = read (conn->fd, &c, 1)) < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return;
+        conn_error (conn, errno);
+        return;
+    }
+    conn_error (conn, n == 0 ? ECONNRESET : EPROTO);
+}
+
+/* The client made progress while we were asleep.  Reset the eventfd
+ * here, so a stale signal cannot keep the reactor spinning; the check
+ * watcher does the actual work.
+ */
+static void conn_efd_cb (flux_reactor_t *r,
+                         flux_watcher_t *w,
+                         int revents,
+                         void *arg)
+{
+    struct shmem_conn *conn = arg;
+
+    shmring_wake (conn->ring);
+}
+
+static void conn_prep_cb (flux_reactor_t *r,
+                          flux_watcher_t *w,
+                          int revents,
+                          void *arg)
+{
+    struct shmem_conn *conn = arg;
+
+    if (!shmring_sleep (conn->ring))
+        flux_watcher_start (conn->idle_w);
+}
+
+static void conn_check_cb (flux_reactor_t *r,
+                           flux_watcher_t *w,
+                           int revents,
+                           void *arg)
+{
+    struct shmem_conn *conn = arg;
+
+    flux_watcher_stop (conn->idle_w);
+    if (shmring_sleep (conn->ring))
+        return;
+    if (conn_flush (conn) < 0 || conn_recv (conn) < 0)
+        conn_error (conn, errno);
+}
+
+static struct shmem_conn *conn_create (struct shmem_server *ss,
+                                       int fd,
+                                       const struct flux_msg_cred *cred)
+{
+    flux_reactor_t *r = flux_get_reactor (ss->h);
+    struct shmem_conn *conn;
+    uuid_t uuid;
+
+    if (!(conn = calloc (1, sizeof (*conn))))
+        return NULL;
+    conn->fd = -1;
+    conn->cred = *cred;
+    uuid_generate (uuid);
+    uuid_unparse (uuid, conn->uuid);
+    if (!(conn->ring = shmring_create (SHMRING_DEFAULT_SIZE))
+        || !(conn->outqueue = zlist_new ()))
+        goto error;
+    if (!(conn->entry = router_entry_add (ss->router,
+                                          conn->uuid,
+                                          conn_send,
+                                          conn)))
+        goto error;
+    if (!(conn->fd_w = flux_fd_watcher_create (r,
+                                               fd,
+                                               FLUX_POLLIN,
+                                               conn_fd_cb,
+                                               conn))
+        || !(conn->efd_w = flux_fd_watcher_create (r,
+                                                   shmring_pollfd (conn->ring),
+                                                   FLUX_POLLIN,
+                                                   conn_efd_cb,
+                                                   conn))
+        || !(conn->prep_w = flux_prepare_watcher_create (r,
+                                                         conn_prep_cb,
+                                                         conn))
+        || !(conn->check_w = flux_check_watcher_create (r,
+                                                        conn_check_cb,
+                                                        conn))
+        || !(conn->idle_w = flux_idle_watcher_create (r, NULL, NULL)))
+        goto error;
+    if (zlist_append (ss->conns, conn) < 0) {
+        errno = ENOMEM;
+        goto error;
+    }
+    conn->ss = ss;
+    conn->fd = fd;
+    flux_watcher_start (conn->fd_w);
+    flux_watcher_start (conn->efd_w);
+    flux_watcher_start (conn->prep_w);
+    flux_watcher_start (conn->check_w);
+    return conn;
+error:
+    conn_destroy (conn);
+    return NULL;
+}
+
+static int get_peer_uid (int fd, uid_t *uid)
+{
+    struct ucred ucred;
+    socklen_t crlen = sizeof (ucred);
+
+    if (getsockopt (fd, SOL_SOCKET, SO_PEERCRED, &ucred, &crlen) < 0)
+        return -1;
+    if (crlen != sizeof (ucred)) {
+        errno = EPERM;
+        return -1;
+    }
+    *uid = ucred.uid;
+    return 0;
+}
+
+static void server_cb (flux_reactor_t *r,
+                       flux_watcher_t *w,
+                       int revents,
+                       void *arg)
+{
+    struct shmem_server *ss = arg;
+    struct flux_msg_cred cred;
+    struct shmem_conn *conn;
+    uid_t uid;
+    int fd;
+
+    if ((fd = accept4 (ss->fd, NULL, NULL, SOCK_CLOEXEC)) < 0) {
+        flux_log_error (ss->h, "shmem: accept");
+        return;
+    }
+    if (get_peer_uid (fd, &uid) < 0
+        || ss->auth (uid, &cred, ss->auth_arg) < 0)
+        goto reject;
+    if (!(conn = conn_create (ss, fd, &cred))) {
+        flux_log_error (ss->h, "shmem: error creating connection");
+        goto reject;
+    }
+    if (shmring_send_fds (fd, conn->ring) < 0
+        || fd_set_nonblocking (fd) < 0) {
+        flux_log_error (ss->h, "shmem: error sending ring to client");
+        conn_destroy (conn);
+    }
+    return;
+reject:
+    (void)shmring_reject (fd, errno);
+    (void)close (fd);
+}
+
+void shmem_server_destroy (struct shmem_server *ss)
+{
+    if (ss) {
+        int saved_errno = errno;
+        struct shmem_conn *conn;
+
+        if (ss->conns) {
+            while ((conn = zlist_first (ss->conns)))
+                conn_destroy (conn);
+            zlist_destroy (&ss->conns);
+        }
+        flux_watcher_destroy (ss->w);
+        if (ss->fd >= 0)
+            (void)close (ss->fd);
+        free (ss->sockpath);
+        free (ss);
+        errno = saved_errno;
+    }
+}
+
+struct shmem_server *shmem_server_create (flux_t *h,
+                                          const char *sockpath,
+                                          struct router *router,
+                                          shmem_auth_f auth,
+                                          void *arg)
+{
+    struct shmem_server *ss;
+    struct sockaddr_un addr;
+
+    if (!h || !sockpath || !router || !auth) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(ss = calloc (1, sizeof (*ss))))
+        return NULL;
+    ss->h = h;
+    ss->router = router;
+    ss->auth = auth;
+    ss->auth_arg = arg;
+    if ((ss->fd = socket (AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)) < 0)
+        goto error;
+    if (!(ss->sockpath = strdup (sockpath)))
+        goto error;
+    if (remove (sockpath) < 0 && errno != ENOENT)
+        goto error;
+
+    memset (&addr, 0, sizeof (addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen (sockpath) >= sizeof (addr.sun_path)) {
+        errno = EINVAL;
+        goto error;
+    }
+    strncpy (addr.sun_path, sockpath, sizeof (addr.sun_path) - 1);
+
+    if (bind (ss->fd, (struct sockaddr *)&addr, sizeof (addr)) < 0)
+        goto error;
+    if (chmod (sockpath, 0777) < 0)
+        goto error;
+    if (listen (ss->fd, LISTEN_BACKLOG) < 0)
+        goto error;
+    if (!(ss->w = flux_fd_watcher_create (flux_get_reactor (h),
+                                          ss->fd,
+                                          FLUX_POLLIN,
+                                          server_cb,
+                                          ss)))
+        goto error;
+    if (!(ss->conns = zlist_new ()))
+        goto error;
+    flux_watcher_start (ss->w);
+    return ss;
+error:
+    shmem_server_destroy (ss);
+    return NULL;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,40 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _CONNECTOR_LOCAL_SHMEM_H
+#define _CONNECTOR_LOCAL_SHMEM_H
+
+#include <sys/types.h>
+#include <flux/core.h>
+
+#include "src/common/librouter/router.h"
+
+/* Assign credentials to a connecting uid, or return -1 with errno set
+ * to reject the connection.
+ */
+typedef int (*shmem_auth_f)(uid_t uid,
+                            struct flux_msg_cred *cred,
+                            void *arg);
+
+/* Listen on 'sockpath' for shmem:// clients.  Each accepted client is
+ * handed a shmring and attached to 'router' like a local:// client.
+ */
+struct shmem_server *shmem_server_create (flux_t *h,
+                                          const char *sockpath,
+                                          struct router *router,
+                                          shmem_auth_f auth,
+                                          void *arg);
+void shmem_server_destroy (struct shmem_server *ss);
+
+#endif /* !_CONNECTOR_LOCAL_SHMEM_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -10,10 +10,28 @@
 
 /* content-files.c - content addressable storage with files back end
  *
- * This is mainly for demo/experimentation purposes.
- * The "store" is a flat directory with blobrefs as filenames.
- * As such, it is hungry for inodes and may run the file system out of them
- * if used in anger!
+ * The store layout is selected with the layout=NAME module option:
+ *
+ * flat
+ *   One directory with blobrefs as filenames.
+ *
+ * sharded (default)
+ *   Blobrefs are filenames in 256 subdirectories named by the first two
+ *   hex digits of the hash digest, so directories stay small.
+ *
+ * pack
+ *   Blobs are appended to large segment files in the "pack" subdirectory
+ *   (see packdb.c), so the store is not hungry for inodes or directory
+ *   operations.  Online gc is not supported with this layout.
+ *
+ * With the sharded and pack layouts, blobs stored by an instance that used
+ * a different layout are still found:  loads fall back to the sharded, then
+ * the flat location.
+ *
+ * By default a store is acknowledged once it is written.  With the 'sync'
+ * option, responses are held until the blob is on stable storage.  Stores
+ * that complete while a sync is in progress are batched into the next one,
+ * so a single syncfs(2) or fdatasync(2) covers many blobs.
  *
  * There are four main operations (RPC handlers):
  *
@@ -30,6 +48,9 @@
  * Given a string key and string value, store it and return.
  * If the key exists, overwrite.
  *
+ * In addition, content-backing.gc-begin, gc-mark, gc-sweep, and gc-end
+ * support online garbage collection of unreachable blobs.
+ *
  * The content operations are per RFC 10 and are the main storage behind
  * the Flux KVS.
  *
@@ -52,18 +73,37 @@
 #if HAVE_CONFIG_H
 #include "config.h"
 #endif
+#include <ctype.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include <flux/core.h>
 #include <jansson.h>
 
+#include "src/common/libczmqcontainers/czmq_containers.h"
 #include "src/common/libutil/blobref.h"
 #include "src/common/libutil/log.h"
 #include "src/common/libutil/dirwalk.h"
 #include "src/common/libutil/unlink_recursive.h"
+#include "src/common/libutil/workpool.h"
+#include "src/common/libutil/parse_size.h"
+#include "src/common/libutil/errno_safe.h"
+#include "ccan/array_size/array_size.h"
 #include "ccan/str/str.h"
 
 #include "src/common/libcontent/content-util.h"
 
 #include "filedb.h"
+#include "packdb.h"
+
+enum {
+    LAYOUT_FLAT,
+    LAYOUT_SHARDED,
+    LAYOUT_PACK,
+};
+
+static const char *layout_names[] = { "flat", "sharded", "pack" };
 
 struct content_files {
     flux_msg_handler_t **handlers;
@@ -71,8 +111,33 @@ struct content_files {
     flux_t *h;
     char *hashfun;
     int hash_size;
+    zhashx_t *gc_marks;         // blobrefs marked during gc, NULL if inactive
+    DIR *gc_dir;                // sweep position
+    int gc_deleted;
+    struct workpool *wp;        // I/O threads, NULL if disabled
+    flux_watcher_t *wp_w;
+    bool shutdown;              // I/O threads are being destroyed
+    int layout;
+    struct packdb *pack;        // segment store if layout=pack
+    int dbfd;                   // dbpath directory, for syncfs(2)
+    bool sync;                  // respond to stores when durable
+    zlistx_t *sync_pending;     // store requests waiting for next sync
+    bool sync_active;           // a sync is in progress
+    DIR *gc_subdir;             // sweep position in shard directory
 };
 
+struct options {
+    bool testing;
+    bool truncate;
+    bool sync;
+    int io_threads;
+    int layout;
+    uint64_t pack_segment_size;
+};
+
+static const int default_io_threads = 4;
+static const uint64_t default_pack_segment_size = 64*1024*1024;
+
 static int file_count_cb (dirwalk_t *d, void *arg)
 {
     int *count = arg;
@@ -98,10 +163,16 @@ static void stats_get_cb (flux_t *h,
     struct content_files *ctx = arg;
     int count;
 
-    if ((count = get_object_count (ctx->dbpath)) < 0)
+    if (ctx->pack)
+        count = packdb_count (ctx->pack);
+    else if ((count = get_object_count (ctx->dbpath)) < 0)
         goto error;
 
-    if (flux_respond_pack (h, msg, "{s:i}", "object_count", count) < 0)
+    if (flux_respond_pack (h,
+                           msg,
+                           "{s:i s:s}",
+                           "object_count", count,
+                           "layout", layout_names[ctx->layout]) < 0)
         flux_log_error (h, "error responding to stats-get request");
     return;
 error:
@@ -109,6 +180,182 @@ error:
         flux_log_error (h, "error responding to stats-get request");
 }
 
+/* Set 'buf' to the shard directory for 'blobref', named by the first two
+ * hex digits of its hash digest.
+ */
+static int shard_path (struct content_files *ctx,
+                       const char *blobref,
+                       char *buf,
+                       size_t size)
+{
+    const char *hex;
+
+    if (!(hex = strchr (blobref, '-')) || strlen (hex + 1) < 2) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (snprintf (buf, size, "%s/%.2s", ctx->dbpath, hex + 1) >= size) {
+        errno = EOVERFLOW;
+        return -1;
+    }
+    return 0;
+}
+
+static bool is_shard_name (const char *name)
+{
+    return strlen (name) == 2 && isxdigit (name[0]) && isxdigit (name[1]);
+}
+
+static int shards_create (struct content_files *ctx)
+{
+    char path[1024];
+    int i;
+
+    for (i = 0; i < 256; i++) {
+        if (snprintf (path, sizeof (path), "%s/%02x", ctx->dbpath, i)
+            >= sizeof (path)) {
+            errno = EOVERFLOW;
+            return -1;
+        }
+        if (mkdir (path, 0700) < 0 && errno != EEXIST)
+            return -1;
+    }
+    return 0;
+}
+
+/* Blocking file I/O for load and store requests is run in the I/O
+ * thread pool.  The request message and blobref are prepared and the
+ * response is sent in the reactor thread;  only the filedb/packdb calls
+ * and syncs run in a pool thread, and they must not touch the flux handle.
+ */
+struct io_request {
+    struct content_files *ctx;
+    const flux_msg_t *msg;
+    char blobref[BLOBREF_MAX_STRING_SIZE];
+    char hash[BLOBREF_MAX_DIGEST_SIZE];
+    int hash_size;
+    const void *data;
+    size_t size;
+    void *result;
+    int errnum;
+    const char *errstr;
+};
+
+static void io_request_destroy (struct io_request *req)
+{
+    if (req) {
+        int saved_errno = errno;
+        flux_msg_decref (req->msg);
+        free (req->result);
+        free (req);
+        errno = saved_errno;
+    }
+}
+
+static void io_request_destructor (void **item)
+{
+    if (item) {
+        io_request_destroy (*item);
+        *item = NULL;
+    }
+}
+
+static struct io_request *io_request_create (struct content_files *ctx,
+                                             const flux_msg_t *msg)
+{
+    struct io_request *req;
+
+    if (!(req = calloc (1, sizeof (*req))))
+        return NULL;
+    req->ctx = ctx;
+    req->msg = flux_msg_incref (msg);
+    return req;
+}
+
+static void io_request_respond_error (struct io_request *req,
+                                      const char *name)
+{
+    flux_t *h = req->ctx->h;
+
+    if (flux_respond_error (h, req->msg, req->errnum, req->errstr) < 0)
+        flux_log_error (h, "error responding to %s request", name);
+}
+
+/* Submit work to the I/O thread pool, or if the pool was not configured
+ * or is being destroyed, run it synchronously.
+ */
+static int io_submit (struct content_files *ctx,
+                      workpool_f work,
+                      workpool_f done,
+                      void *arg)
+{
+    if (!ctx->wp || ctx->shutdown) {
+        work (arg);
+        done (arg);
+        return 0;
+    }
+    return workpool_submit (ctx->wp, work, done, arg);
+}
+
+static int io_request_submit (struct io_request *req,
+                              workpool_f work,
+                              workpool_f done)
+{
+    return io_submit (req->ctx, work, done, req);
+}
+
+/* Look for the blob in the current layout, then fall back to the
+ * locations used by the other file layouts.
+ */
+static void load_work (void *arg)
+{
+    struct io_request *req = arg;
+    struct content_files *ctx = req->ctx;
+    char path[1024];
+
+    if (ctx->pack) {
+        if (packdb_get (ctx->pack,
+                        req->hash,
+                        req->hash_size,
+                        &req->result,
+                        &req->size,
+                        &req->errstr) == 0
+            || errno != ENOENT)
+            goto done;
+    }
+    if (ctx->layout != LAYOUT_FLAT) {
+        if (shard_path (ctx, req->blobref, path, sizeof (path)) < 0)
+            goto done;
+        if (filedb_get (path,
+                        req->blobref,
+                        &req->result,
+                        &req->size,
+                        &req->errstr) == 0
+            || errno != ENOENT)
+            goto done;
+    }
+    if (filedb_get (ctx->dbpath,
+                    req->blobref,
+                    &req->result,
+                    &req->size,
+                    &req->errstr) == 0)
+        return;
+done:
+    if (!req->result)
+        req->errnum = errno;
+}
+
+static void load_done (void *arg)
+{
+    struct io_request *req = arg;
+    flux_t *h = req->ctx->h;
+
+    if (req->errnum != 0)
+        io_request_respond_error (req, "load");
+    else if (flux_respond_raw (h, req->msg, req->result, req->size) < 0)
+        flux_log_error (h, "error responding to load request");
+    io_request_destroy (req);
+}
 
 /* Handle a content-backing.load request from the rank 0 broker's
  * content-cache service.  The raw request payload is a hash digest.
@@ -121,12 +368,9 @@ static void load_cb (flux_t *h,
                      void *arg)
 {
     struct content_files *ctx = arg;
+    struct io_request *req = NULL;
     const void *hash;
     int hash_size;
-    char blobref[BLOBREF_MAX_STRING_SIZE];
-    void *data = NULL;
-    size_t size;
-    const char *errstr = NULL;
 
     if (flux_request_decode_raw (msg, NULL, &hash, &hash_size) < 0)
         goto error;
@@ -134,28 +378,179 @@ static void load_cb (flux_t *h,
         errno = EPROTO;
         goto error;
     }
+    if (!(req = io_request_create (ctx, msg)))
+        goto error;
+    memcpy (req->hash, hash, hash_size);
+    req->hash_size = hash_size;
     if (blobref_hashtostr (ctx->hashfun,
                            hash,
                            hash_size,
-                           blobref,
-                           sizeof (blobref)) < 0)
+                           req->blobref,
+                           sizeof (req->blobref)) < 0)
         goto error;
-    if (filedb_get (ctx->dbpath, blobref, &data, &size, &errstr) < 0)
+    if (io_request_submit (req, load_work, load_done) < 0)
         goto error;
-    if (flux_respond_raw (h, msg, data, size) < 0)
-        flux_log_error (h, "error responding to load request");
-    free (data);
     return;
 error:
-    if (flux_respond_error (h, msg, errno, errstr) < 0)
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
         flux_log_error (h, "error responding to load request");
-    free (data);
+    io_request_destroy (req);
+}
+
+static void store_work (void *arg)
+{
+    struct io_request *req = arg;
+    struct content_files *ctx = req->ctx;
+    char path[1024];
+    int rc;
+
+    if (ctx->pack) {
+        rc = packdb_put (ctx->pack,
+                         req->hash,
+                         req->hash_size,
+                         req->data,
+                         req->size,
+                         &req->errstr);
+    }
+    else if (ctx->layout == LAYOUT_SHARDED) {
+        if ((rc = shard_path (ctx, req->blobref, path, sizeof (path))) == 0)
+            rc = filedb_put (path,
+                             req->blobref,
+                             req->data,
+                             req->size,
+                             &req->errstr);
+    }
+    else {
+        rc = filedb_put (ctx->dbpath,
+                         req->blobref,
+                         req->data,
+                         req->size,
+                         &req->errstr);
+    }
+    if (rc < 0)
+        req->errnum = errno;
+}
+
+static void store_respond (struct io_request *req)
+{
+    flux_t *h = req->ctx->h;
+
+    if (req->errnum != 0)
+        io_request_respond_error (req, "store");
+    else if (flux_respond_raw (h, req->msg, req->hash, req->hash_size) < 0)
+        flux_log_error (h, "error responding to store request");
+}
+
+/* Stores waiting for durability are collected in ctx->sync_pending.
+ * When no sync is running, the pending list is taken as a batch and
+ * synced, and the batch is answered when the sync completes.
+ */
+struct sync_batch {
+    struct content_files *ctx;
+    zlistx_t *reqs;
+    int errnum;
+};
+
+static int store_sync (struct content_files *ctx)
+{
+    if (ctx->pack)
+        return packdb_sync (ctx->pack);
+    return syncfs (ctx->dbfd);
+}
+
+static void sync_work (void *arg)
+{
+    struct sync_batch *batch = arg;
+
+    if (store_sync (batch->ctx) < 0)
+        batch->errnum = errno;
+}
+
+static void sync_respond (zlistx_t *reqs, int errnum)
+{
+    struct io_request *req;
+
+    while ((req = zlistx_detach (reqs, NULL))) {
+        if (errnum != 0 && req->errnum == 0) {
+            req->errnum = errnum;
+            req->errstr = NULL;
+        }
+        store_respond (req);
+        io_request_destroy (req);
+    }
+}
+
+static int sync_start (struct content_files *ctx);
+
+static void sync_done (void *arg)
+{
+    struct sync_batch *batch = arg;
+    struct content_files *ctx = batch->ctx;
+
+    if (batch->errnum != 0) {
+        errno = batch->errnum;
+        flux_log_error (ctx->h, "error syncing content store");
+    }
+    sync_respond (batch->reqs, batch->errnum);
+    zlistx_destroy (&batch->reqs);
+    free (batch);
+    ctx->sync_active = false;
+    if (sync_start (ctx) < 0)
+        sync_respond (ctx->sync_pending, errno);
+}
+
+static int sync_start (struct content_files *ctx)
+{
+    struct sync_batch *batch;
+    zlistx_t *reqs;
+
+    if (ctx->sync_active || zlistx_size (ctx->sync_pending) == 0)
+        return 0;
+    if (!(batch = calloc (1, sizeof (*batch))))
+        return -1;
+    if (!(reqs = zlistx_new ())) {
+        free (batch);
+        errno = ENOMEM;
+        return -1;
+    }
+    zlistx_set_destructor (reqs, io_request_destructor);
+    batch->ctx = ctx;
+    batch->reqs = ctx->sync_pending;
+    ctx->sync_pending = reqs;
+    ctx->sync_active = true;
+    if (io_submit (ctx, sync_work, sync_done, batch) < 0) {
+        batch->errnum = errno;
+        sync_done (batch);
+    }
+    return 0;
+}
+
+static void store_done (void *arg)
+{
+    struct io_request *req = arg;
+    struct content_files *ctx = req->ctx;
+
+    if (req->errnum == 0 && ctx->sync) {
+        if (!zlistx_add_end (ctx->sync_pending, req)) {
+            req->errnum = ENOMEM;
+            goto respond;
+        }
+        if (sync_start (ctx) < 0)
+            sync_respond (ctx->sync_pending, errno);
+        return;
+    }
+respond:
+    store_respond (req);
+    io_request_destroy (req);
 }
 
 /* Handle a content-backing.store request from the rank 0 broker's
  * content-cache service.  The raw request payload is the blob content.
  * The raw response payload is hash digest.
  * These payloads are specified in RFC 10.
+ *
+ * N.B. the blob is marked for gc here rather than on completion, so that
+ * a sweep cannot remove it while the write is in progress.
  */
 void store_cb (flux_t *h,
                flux_msg_handler_t *mh,
@@ -163,35 +558,37 @@ void store_cb (flux_t *h,
                void *arg)
 {
     struct content_files *ctx = arg;
+    struct io_request *req = NULL;
     const void *data;
     int size;
-    char blobref[BLOBREF_MAX_STRING_SIZE];
-    char hash[BLOBREF_MAX_DIGEST_SIZE];
-    int hash_size;
-    const char *errstr = NULL;
 
     if (flux_request_decode_raw (msg, NULL, &data, &size) < 0)
         goto error;
-    if ((hash_size = blobref_hash_raw (ctx->hashfun,
-                                       data,
-                                       size,
-                                       hash,
-                                       sizeof (hash))) < 0)
+    if (!(req = io_request_create (ctx, msg)))
+        goto error;
+    req->data = data;
+    req->size = size;
+    if ((req->hash_size = blobref_hash_raw (ctx->hashfun,
+                                            data,
+                                            size,
+                                            req->hash,
+                                            sizeof (req->hash))) < 0)
         goto error;
     if (blobref_hashtostr (ctx->hashfun,
-                           hash,
-                           hash_size,
-                           blobref,
-                           sizeof (blobref)) < 0)
+                           req->hash,
+                           req->hash_size,
+                           req->blobref,
+                           sizeof (req->blobref)) < 0)
         goto error;
-    if (filedb_put (ctx->dbpath, blobref, data, size, &errstr) < 0)
+    if (ctx->gc_marks)
+        (void)zhashx_insert (ctx->gc_marks, req->blobref, (void *)1);
+    if (io_request_submit (req, store_work, store_done) < 0)
         goto error;
-    if (flux_respond_raw (h, msg, hash, hash_size) < 0)
-        flux_log_error (h, "error responding to store request");
     return;
 error:
-    if (flux_respond_error (h, msg, errno, errstr) < 0)
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
         flux_log_error (h, "error responding to store request");
+    io_request_destroy (req);
 }
 
 /* Handle a content-backing.checkpoint-get request from the rank 0 kvs module.
@@ -269,6 +666,8 @@ void checkpoint_put_cb (flux_t *h,
     }
     if (filedb_put (ctx->dbpath, key, value, strlen (value), &errstr) < 0)
         goto error;
+    if (ctx->sync && syncfs (ctx->dbfd) < 0)
+        goto error;
     if (flux_respond (h, msg, NULL) < 0)
         flux_log_error (h, "error responding to checkpoint-put request");
     free (value);
@@ -279,13 +678,213 @@ error:
     free (value);
 }
 
+static void gc_reset (struct content_files *ctx)
+{
+    zhashx_destroy (&ctx->gc_marks);
+    if (ctx->gc_subdir) {
+        closedir (ctx->gc_subdir);
+        ctx->gc_subdir = NULL;
+    }
+    if (ctx->gc_dir) {
+        closedir (ctx->gc_dir);
+        ctx->gc_dir = NULL;
+    }
+}
+
+/* Return the next directory entry to be swept, descending into shard
+ * directories, or NULL when the sweep is complete.  Set 'dfd' to the
+ * directory containing the entry.
+ */
+static struct dirent *gc_readdir (struct content_files *ctx, int *dfd)
+{
+    struct dirent *dent;
+    int fd;
+
+    for (;;) {
+        if (ctx->gc_subdir) {
+            if ((dent = readdir (ctx->gc_subdir))) {
+                *dfd = dirfd (ctx->gc_subdir);
+                return dent;
+            }
+            closedir (ctx->gc_subdir);
+            ctx->gc_subdir = NULL;
+        }
+        if (!(dent = readdir (ctx->gc_dir)))
+            return NULL;
+        if (!is_shard_name (dent->d_name)) {
+            *dfd = dirfd (ctx->gc_dir);
+            return dent;
+        }
+        if ((fd = openat (dirfd (ctx->gc_dir),
+                          dent->d_name,
+                          O_RDONLY | O_DIRECTORY | O_CLOEXEC)) < 0)
+            continue;
+        if (!(ctx->gc_subdir = fdopendir (fd)))
+            close (fd);
+    }
+}
+
+/* Handle a content-backing.gc-begin request from the rank 0 broker's
+ * content-cache service.  Until gc-end, blobs that are marked or stored
+ * are protected from gc-sweep.
+ */
+static void gc_begin_cb (flux_t *h,
+                         flux_msg_handler_t *mh,
+                         const flux_msg_t *msg,
+                         void *arg)
+{
+    struct content_files *ctx = arg;
+
+    if (flux_request_decode (msg, NULL, NULL) < 0)
+        goto error;
+    if (ctx->pack) {
+        errno = ENOSYS;
+        goto error;
+    }
+    gc_reset (ctx);
+    if (!(ctx->gc_marks = zhashx_new ())) {
+        errno = ENOMEM;
+        goto error;
+    }
+    if (!(ctx->gc_dir = opendir (ctx->dbpath))) {
+        gc_reset (ctx);
+        goto error;
+    }
+    ctx->gc_deleted = 0;
+    if (flux_respond (h, msg, NULL) < 0)
+        flux_log_error (h, "error responding to gc-begin request");
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        flux_log_error (h, "error responding to gc-begin request");
+}
+
+/* Handle a content-backing.gc-mark request.  The raw request payload is
+ * a sequence of hash digests.
+ */
+static void gc_mark_cb (flux_t *h,
+                        flux_msg_handler_t *mh,
+                        const flux_msg_t *msg,
+                        void *arg)
+{
+    struct content_files *ctx = arg;
+    const char *hashes;
+    int len;
+    int offset;
+
+    if (flux_request_decode_raw (msg, NULL, (const void **)&hashes, &len) < 0)
+        goto error;
+    if (!ctx->gc_marks) {
+        errno = EINVAL;
+        goto error;
+    }
+    if (len % ctx->hash_size != 0) {
+        errno = EPROTO;
+        goto error;
+    }
+    for (offset = 0; offset < len; offset += ctx->hash_size) {
+        char blobref[BLOBREF_MAX_STRING_SIZE];
+
+        if (blobref_hashtostr (ctx->hashfun,
+                               hashes + offset,
+                               ctx->hash_size,
+                               blobref,
+                               sizeof (blobref)) < 0)
+            goto error;
+        (void)zhashx_insert (ctx->gc_marks, blobref, (void *)1);
+    }
+    if (flux_respond (h, msg, NULL) < 0)
+        flux_log_error (h, "error responding to gc-mark request");
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        flux_log_error (h, "error responding to gc-mark request");
+}
+
+/* Handle a content-backing.gc-sweep request.  Examine the next 'count'
+ * directory entries and unlink unmarked blobs.  Files that are not named
+ * by a blobref, such as checkpoints, are skipped.
+ */
+static void gc_sweep_cb (flux_t *h,
+                         flux_msg_handler_t *mh,
+                         const flux_msg_t *msg,
+                         void *arg)
+{
+    struct content_files *ctx = arg;
+    struct dirent *dent = NULL;
+    int count;
+    int deleted = 0;
+    int dfd;
+
+    if (flux_request_unpack (msg, NULL, "{s:i}", "count", &count) < 0)
+        goto error;
+    if (!ctx->gc_marks || count <= 0) {
+        errno = EINVAL;
+        goto error;
+    }
+    while (count-- > 0 && (dent = gc_readdir (ctx, &dfd))) {
+        if (blobref_validate (dent->d_name) < 0
+            || zhashx_lookup (ctx->gc_marks, dent->d_name))
+            continue;
+        if (unlinkat (dfd, dent->d_name, 0) < 0) {
+            flux_log_error (h, "gc-sweep: unlink %s", dent->d_name);
+            continue;
+        }
+        deleted++;
+    }
+    ctx->gc_deleted += deleted;
+    if (flux_respond_pack (h,
+                           msg,
+                           "{s:i s:b}",
+                           "deleted", deleted,
+                           "done", dent == NULL) < 0)
+        flux_log_error (h, "error responding to gc-sweep request");
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        flux_log_error (h, "error responding to gc-sweep request");
+}
+
+/* Handle a content-backing.gc-end request.
+ */
+static void gc_end_cb (flux_t *h,
+                       flux_msg_handler_t *mh,
+                       const flux_msg_t *msg,
+                       void *arg)
+{
+    struct content_files *ctx = arg;
+
+    if (flux_request_decode (msg, NULL, NULL) < 0)
+        goto error;
+    if (!ctx->gc_marks) {
+        errno = EINVAL;
+        goto error;
+    }
+    flux_log (h, LOG_DEBUG, "gc: deleted %d objects", ctx->gc_deleted);
+    gc_reset (ctx);
+    if (flux_respond (h, msg, NULL) < 0)
+        flux_log_error (h, "error responding to gc-end request");
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        flux_log_error (h, "error responding to gc-end request");
+}
+
 /* Destroy module context.
  */
 static void content_files_destroy (struct content_files *ctx)
 {
     if (ctx) {
         int saved_errno = errno;
+        flux_watcher_destroy (ctx->wp_w);
+        ctx->shutdown = true;
+        workpool_destroy (ctx->wp); // responds to in-flight requests
         flux_msg_handler_delvec (ctx->handlers);
+        gc_reset (ctx);
+        zlistx_destroy (&ctx->sync_pending);
+        packdb_close (ctx->pack);
+        if (ctx->dbfd >= 0)
+            close (ctx->dbfd);
         free (ctx->dbpath);
         free (ctx->hashfun);
         free (ctx);
@@ -301,22 +900,48 @@ static const struct flux_msg_handler_spec htab[] = {
     { FLUX_MSGTYPE_REQUEST, "content-backing.store",   store_cb, 0 },
     { FLUX_MSGTYPE_REQUEST, "content-backing.checkpoint-get", checkpoint_get_cb, 0 },
     { FLUX_MSGTYPE_REQUEST, "content-backing.checkpoint-put", checkpoint_put_cb, 0 },
+    { FLUX_MSGTYPE_REQUEST, "content-backing.gc-begin", gc_begin_cb, 0 },
+    { FLUX_MSGTYPE_REQUEST, "content-backing.gc-mark", gc_mark_cb, 0 },
+    { FLUX_MSGTYPE_REQUEST, "content-backing.gc-sweep", gc_sweep_cb, 0 },
+    { FLUX_MSGTYPE_REQUEST, "content-backing.gc-end", gc_end_cb, 0 },
     { FLUX_MSGTYPE_REQUEST, "content-files.stats-get",
       stats_get_cb, FLUX_ROLE_USER },
     FLUX_MSGHANDLER_TABLE_END,
 };
 
+static void workpool_cb (flux_reactor_t *r,
+                         flux_watcher_t *w,
+                         int revents,
+                         void *arg)
+{
+    struct content_files *ctx = arg;
+
+    if (workpool_run_done (ctx->wp) < 0)
+        flux_log_error (ctx->h, "error running I/O completions");
+}
+
 /* Create module context and perform some initialization.
  */
-static struct content_files *content_files_create (flux_t *h, bool truncate)
+static struct content_files *content_files_create (flux_t *h,
+                                                   struct options *opt)
 {
     struct content_files *ctx;
     const char *dbdir;
     const char *s;
+    char *packpath = NULL;
+    const char *errstr = NULL;
 
     if (!(ctx = calloc (1, sizeof (*ctx))))
         return NULL;
     ctx->h = h;
+    ctx->dbfd = -1;
+    ctx->layout = opt->layout;
+    ctx->sync = opt->sync;
+    if (!(ctx->sync_pending = zlistx_new ())) {
+        errno = ENOMEM;
+        goto error;
+    }
+    zlistx_set_destructor (ctx->sync_pending, io_request_destructor);
 
     /* Some tunables:
      * - the hash function, e.g. sha1, sha256
@@ -341,32 +966,108 @@ static struct content_files *content_files_create (flux_t *h, bool truncate)
     }
     if (asprintf (&ctx->dbpath, "%s/content.files", dbdir) < 0)
         goto error;
-    if (truncate)
+    if (opt->truncate)
         (void)unlink_recursive (ctx->dbpath);
     if (mkdir (ctx->dbpath, 0700) < 0 && errno != EEXIST) {
         flux_log_error (h, "could not create %s", ctx->dbpath);
         goto error;
     }
+    if ((ctx->dbfd = open (ctx->dbpath, O_RDONLY | O_DIRECTORY | O_CLOEXEC))
+        < 0) {
+        flux_log_error (h, "could not open %s", ctx->dbpath);
+        goto error;
+    }
+    if (ctx->layout == LAYOUT_SHARDED && shards_create (ctx) < 0) {
+        flux_log_error (h, "could not create %s shards", ctx->dbpath);
+        goto error;
+    }
+    if (ctx->layout == LAYOUT_PACK) {
+        if (asprintf (&packpath, "%s/pack", ctx->dbpath) < 0)
+            goto error;
+        if (!(ctx->pack = packdb_open (packpath,
+                                       ctx->hash_size,
+                                       opt->pack_segment_size,
+                                       &errstr))) {
+            flux_log (h,
+                      LOG_ERR,
+                      "could not open %s: %s",
+                      packpath,
+                      errstr ? errstr : strerror (errno));
+            goto error;
+        }
+        free (packpath);
+        packpath = NULL;
+    }
+    if (opt->io_threads > 0) {
+        if (!(ctx->wp = workpool_create (opt->io_threads))
+            || !(ctx->wp_w = flux_fd_watcher_create (flux_get_reactor (h),
+                                                     workpool_get_fd (ctx->wp),
+                                                     FLUX_POLLIN,
+                                                     workpool_cb,
+                                                     ctx))) {
+            flux_log_error (h, "could not create I/O thread pool");
+            goto error;
+        }
+        flux_watcher_start (ctx->wp_w);
+    }
     if (flux_msg_handler_addvec (h, htab, ctx, &ctx->handlers) < 0)
         goto error;
     return ctx;
 error:
+    ERRNO_SAFE_WRAP (free, packpath);
     content_files_destroy (ctx);
     return NULL;
 }
 
+static int parse_layout (const char *s)
+{
+    int i;
+
+    for (i = 0; i < ARRAY_SIZE (layout_names); i++) {
+        if (streq (s, layout_names[i]))
+            return i;
+    }
+    return -1;
+}
+
 static int parse_args (flux_t *h,
                        int argc,
                        char **argv,
-                       bool *testing,
-                       bool *truncate)
+                       struct options *opt)
 {
     int i;
     for (i = 0; i < argc; i++) {
         if (streq (argv[i], "testing"))
-            *testing = true;
+            opt->testing = true;
         else if (streq (argv[i], "truncate"))
-            *truncate = true;
+            opt->truncate = true;
+        else if (streq (argv[i], "sync"))
+            opt->sync = true;
+        else if (strstarts (argv[i], "io-threads=")) {
+            char *endptr;
+            errno = 0;
+            opt->io_threads = strtol (argv[i] + 11, &endptr, 10);
+            if (errno != 0 || *endptr != '\0' || opt->io_threads < 0) {
+                flux_log (h, LOG_ERR, "Invalid value for %s", argv[i]);
+                errno = EINVAL;
+                return -1;
+            }
+        }
+        else if (strstarts (argv[i], "layout=")) {
+            if ((opt->layout = parse_layout (argv[i] + 7)) < 0) {
+                flux_log (h, LOG_ERR, "Invalid value for %s", argv[i]);
+                errno = EINVAL;
+                return -1;
+            }
+        }
+        else if (strstarts (argv[i], "pack-segment-size=")) {
+            if (parse_size (argv[i] + 18, &opt->pack_segment_size) < 0
+                || opt->pack_segment_size == 0) {
+                flux_log (h, LOG_ERR, "Invalid value for %s", argv[i]);
+                errno = EINVAL;
+                return -1;
+            }
+        }
         else {
             flux_log (h, LOG_ERR, "Unknown module option: %s", argv[i]);
             errno = EINVAL;
@@ -391,19 +1092,22 @@ static int parse_args (flux_t *h,
 int mod_main (flux_t *h, int argc, char **argv)
 {
     struct content_files *ctx;
-    bool testing = false;
-    bool truncate = false;
+    struct options opt = {
+        .io_threads = default_io_threads,
+        .layout = LAYOUT_SHARDED,
+        .pack_segment_size = default_pack_segment_size,
+    };
     int rc = -1;
 
-    if (parse_args (h, argc, argv, &testing, &truncate) < 0)
+    if (parse_args (h, argc, argv, &opt) < 0)
         return -1;
-    if (!(ctx = content_files_create (h, truncate))) {
+    if (!(ctx = content_files_create (h, &opt))) {
         flux_log_error (h, "content_files_create failed");
         return -1;
     }
     if (content_register_service (h, "content-backing") < 0)
         goto done;
-    if (!testing) {
+    if (!opt.testing) {
         if (content_register_backing_store (h, "content-files") < 0)
             goto done;
     }
@@ -413,7 +1117,7 @@ int mod_main (flux_t *h, int argc, char **argv)
     }
     rc = 0;
 done_unreg:
-    if (!testing)
+    if (!opt.testing)
         (void)content_unregister_backing_store (h);
 done:
     content_files_destroy (ctx);
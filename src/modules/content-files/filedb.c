@@ -66,6 +66,9 @@ int filedb_get (const char *dbpath,
     return 0;
 }
 
+/* Write to a temporary file and rename it into place, so that concurrent
+ * readers and writers of the same key never observe a partial file.
+ */
 int filedb_put (const char *dbpath,
                 const char *key,
                 const void *data,
@@ -73,6 +76,7 @@ int filedb_put (const char *dbpath,
                 const char **errstr)
 {
     char path[1024];
+    char tmppath[1024];
     int fd;
 
     if (strlen (key) == 0 || strchr (key, '/') || streq (key, "..")
@@ -82,21 +86,31 @@ int filedb_put (const char *dbpath,
             *errstr = "invalid key";
         return -1;
     }
-    if (snprintf (path, sizeof (path), "%s/%s", dbpath, key) >= sizeof (path)) {
+    if (snprintf (path, sizeof (path), "%s/%s", dbpath, key) >= sizeof (path)
+        || snprintf (tmppath,
+                     sizeof (tmppath),
+                     "%s/.%s.XXXXXX",
+                     dbpath,
+                     key) >= sizeof (tmppath)) {
         errno = EOVERFLOW;
         if (errstr)
             *errstr = "key name too long for internal buffer";
         return -1;
     }
-    if ((fd = open (path, O_WRONLY | O_CREAT | O_TRUNC, 0666)) < 0)
+    if ((fd = mkstemp (tmppath)) < 0)
         return -1;
     if (write_all (fd, data, size) < 0) {
         ERRNO_SAFE_WRAP (close, fd);
-        return -1;
+        goto error;
     }
     if (close (fd) < 0)
-        return -1;
+        goto error;
+    if (rename (tmppath, path) < 0)
+        goto error;
     return 0;
+error:
+    ERRNO_SAFE_WRAP (unlink, tmppath);
+    return -1;
 }
 
 /*
@@ -0,0 +1,446 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* packdb.c - log-structured blob store
+ *
+ * Segment files are named seg.NNNNNN and consist of records:
+ *
+ *   struct record | hash digest | blob data
+ *
+ * Records are written in host byte order since the store is local.
+ *
+ * Appends are serialized by 'wlock', which is held across the write so a
+ * failed write can be truncated away before anything follows it.  'lock'
+ * protects the index and segment table and is held only briefly, so loads
+ * are not blocked by writes in progress.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <stdio.h>
+#include <pthread.h>
+
+#include "src/common/libczmqcontainers/czmq_containers.h"
+#include "src/common/libutil/errno_safe.h"
+
+#include "packdb.h"
+
+#define PACKDB_MAGIC 0x666c7862     // "flxb"
+
+struct record {
+    uint32_t magic;
+    uint32_t hash_size;
+    uint64_t size;
+};
+
+struct entry {
+    uint32_t seg;
+    uint64_t offset;                // offset of blob data in segment
+    uint64_t size;
+    char hash[];
+};
+
+struct packdb {
+    char *path;
+    int dirfd;
+    int hash_size;
+    size_t segment_size;
+    pthread_mutex_t lock;
+    pthread_mutex_t wlock;
+    zhashx_t *index;
+    int *fds;                       // segment fds, indexed by seg number
+    uint32_t nsegs;
+    uint64_t woffset;               // append offset in segment nsegs - 1
+    uint32_t sync_seg;              // first segment with unsynced data
+    bool sync_dir;                  // a segment was created since last sync
+};
+
+/* zhashx comparators take no argument, so like the content cache, use a
+ * global for the hash size.  All packdbs in a process must agree on it.
+ */
+static int hash_size_global;
+
+static size_t entry_hasher (const void *key)
+{
+    size_t h;
+    memcpy (&h, key, sizeof (h));
+    return h;
+}
+
+static int entry_comparator (const void *item1, const void *item2)
+{
+    return memcmp (item1, item2, hash_size_global);
+}
+
+static int segment_open (struct packdb *db, uint32_t seg, int flags)
+{
+    char name[64];
+    int fd;
+    int *fds;
+
+    snprintf (name, sizeof (name), "seg.%06u", (unsigned int)seg);
+    if ((fd = openat (db->dirfd, name, O_RDWR | O_CLOEXEC | flags, 0600)) < 0)
+        return -1;
+    if (!(fds = realloc (db->fds, sizeof (fds[0]) * (seg + 1)))) {
+        ERRNO_SAFE_WRAP (close, fd);
+        return -1;
+    }
+    db->fds = fds;
+    db->fds[seg] = fd;
+    db->nsegs = seg + 1;
+    return fd;
+}
+
+/* Discard a failed append.  This is best effort since the next append
+ * overwrites it, and a torn record at the end is truncated on open.
+ */
+static void segment_truncate (int fd, uint64_t offset)
+{
+    int saved_errno = errno;
+    if (ftruncate (fd, offset) < 0) {
+    }
+    errno = saved_errno;
+}
+
+static int index_insert (struct packdb *db,
+                         const void *hash,
+                         uint32_t seg,
+                         uint64_t offset,
+                         uint64_t size)
+{
+    struct entry *e;
+
+    if (zhashx_lookup (db->index, hash))
+        return 0;
+    if (!(e = malloc (sizeof (*e) + db->hash_size)))
+        return -1;
+    e->seg = seg;
+    e->offset = offset;
+    e->size = size;
+    memcpy (e->hash, hash, db->hash_size);
+    (void)zhashx_insert (db->index, e->hash, e);
+    return 0;
+}
+
+/* Add the records of segment 'seg' to the index.  A record that is
+ * incomplete or invalid ends the segment, and the segment is truncated
+ * there.  Return the offset of the end of the last good record.
+ */
+static int segment_scan (struct packdb *db, uint32_t seg, uint64_t *endp)
+{
+    int fd = db->fds[seg];
+    struct stat sb;
+    struct record rec;
+    char hash[64];
+    uint64_t offset = 0;
+
+    if (fstat (fd, &sb) < 0)
+        return -1;
+    while (offset + sizeof (rec) <= sb.st_size) {
+        uint64_t data_offset = offset + sizeof (rec) + db->hash_size;
+
+        if (pread (fd, &rec, sizeof (rec), offset) != sizeof (rec)
+            || rec.magic != PACKDB_MAGIC
+            || rec.hash_size != db->hash_size
+            || data_offset + rec.size > sb.st_size
+            || pread (fd, hash, db->hash_size, offset + sizeof (rec))
+                != db->hash_size)
+            break;
+        if (index_insert (db, hash, seg, data_offset, rec.size) < 0)
+            return -1;
+        offset = data_offset + rec.size;
+    }
+    if (offset < sb.st_size && ftruncate (fd, offset) < 0)
+        return -1;
+    *endp = offset;
+    return 0;
+}
+
+static int packdb_load (struct packdb *db)
+{
+    uint32_t seg = 0;
+    uint64_t end = 0;
+
+    while (segment_open (db, seg, 0) >= 0) {
+        if (segment_scan (db, seg, &end) < 0)
+            return -1;
+        seg++;
+    }
+    if (errno != ENOENT)
+        return -1;
+    if (db->nsegs == 0) {
+        if (segment_open (db, 0, O_CREAT | O_EXCL) < 0)
+            return -1;
+        db->sync_dir = true;
+    }
+    db->woffset = end;
+    db->sync_seg = db->nsegs - 1;
+    return 0;
+}
+
+int packdb_get (struct packdb *db,
+                const void *hash,
+                int hash_size,
+                void **datap,
+                size_t *sizep,
+                const char **errstr)
+{
+    struct entry *e;
+    uint64_t offset;
+    size_t size;
+    int fd;
+    void *data;
+    ssize_t n;
+
+    if (!db || !hash || hash_size != db->hash_size || !datap || !sizep) {
+        errno = EINVAL;
+        return -1;
+    }
+    pthread_mutex_lock (&db->lock);
+    if (!(e = zhashx_lookup (db->index, hash))) {
+        pthread_mutex_unlock (&db->lock);
+        errno = ENOENT;
+        return -1;
+    }
+    fd = db->fds[e->seg];
+    offset = e->offset;
+    size = e->size;
+    pthread_mutex_unlock (&db->lock);
+
+    if (!(data = malloc (size > 0 ? size : 1)))
+        return -1;
+    if ((n = pread (fd, data, size, offset)) != size) {
+        if (n >= 0) {
+            errno = EIO;
+            if (errstr)
+                *errstr = "short read from pack segment";
+        }
+        ERRNO_SAFE_WRAP (free, data);
+        return -1;
+    }
+    *datap = data;
+    *sizep = size;
+    return 0;
+}
+
+int packdb_put (struct packdb *db,
+                const void *hash,
+                int hash_size,
+                const void *data,
+                size_t size,
+                const char **errstr)
+{
+    struct record rec = {
+        .magic = PACKDB_MAGIC,
+        .hash_size = hash_size,
+        .size = size,
+    };
+    struct iovec iov[3] = {
+        { .iov_base = &rec, .iov_len = sizeof (rec) },
+        { .iov_base = (void *)hash, .iov_len = hash_size },
+        { .iov_base = (void *)data, .iov_len = size },
+    };
+    size_t len = sizeof (rec) + hash_size + size;
+    uint32_t seg;
+    uint64_t offset;
+    int fd;
+    bool found;
+    ssize_t n;
+
+    if (!db || !hash || hash_size != db->hash_size || (!data && size > 0)) {
+        errno = EINVAL;
+        return -1;
+    }
+    pthread_mutex_lock (&db->wlock);
+
+    pthread_mutex_lock (&db->lock);
+    found = zhashx_lookup (db->index, hash) ? true : false;
+    if (!found
+        && db->woffset > 0
+        && db->woffset + len > db->segment_size) {
+        if (segment_open (db, db->nsegs, O_CREAT | O_EXCL) < 0) {
+            pthread_mutex_unlock (&db->lock);
+            goto error;
+        }
+        db->woffset = 0;
+        db->sync_dir = true;
+    }
+    seg = db->nsegs - 1;
+    fd = db->fds[seg];
+    offset = db->woffset;
+    pthread_mutex_unlock (&db->lock);
+
+    if (found) {
+        pthread_mutex_unlock (&db->wlock);
+        return 0;
+    }
+    if ((n = pwritev (fd, iov, 3, offset)) != len) {
+        if (n >= 0) {
+            errno = ENOSPC;
+            if (errstr)
+                *errstr = "short write to pack segment";
+        }
+        segment_truncate (fd, offset);
+        goto error;
+    }
+
+    pthread_mutex_lock (&db->lock);
+    if (index_insert (db, hash, seg, offset + sizeof (rec) + hash_size, size)
+        < 0) {
+        pthread_mutex_unlock (&db->lock);
+        segment_truncate (fd, offset);
+        goto error;
+    }
+    db->woffset = offset + len;
+    pthread_mutex_unlock (&db->lock);
+
+    pthread_mutex_unlock (&db->wlock);
+    return 0;
+error:
+    pthread_mutex_unlock (&db->wlock);
+    return -1;
+}
+
+int packdb_sync (struct packdb *db)
+{
+    uint32_t first, seg, last;
+    bool sync_dir;
+    int rc = 0;
+
+    if (!db) {
+        errno = EINVAL;
+        return -1;
+    }
+    pthread_mutex_lock (&db->lock);
+    first = db->sync_seg;
+    last = db->nsegs - 1;
+    sync_dir = db->sync_dir;
+    db->sync_seg = last;
+    db->sync_dir = false;
+    pthread_mutex_unlock (&db->lock);
+
+    for (seg = first; seg <= last; seg++) {
+        if (fdatasync (db->fds[seg]) < 0)
+            rc = -1;
+    }
+    if (sync_dir && fsync (db->dirfd) < 0)
+        rc = -1;
+    if (rc < 0) { // try again next time
+        int saved_errno = errno;
+        pthread_mutex_lock (&db->lock);
+        if (db->sync_seg > first)
+            db->sync_seg = first;
+        db->sync_dir |= sync_dir;
+        pthread_mutex_unlock (&db->lock);
+        errno = saved_errno;
+    }
+    return rc;
+}
+
+int packdb_count (struct packdb *db)
+{
+    int count;
+
+    if (!db)
+        return 0;
+    pthread_mutex_lock (&db->lock);
+    count = zhashx_size (db->index);
+    pthread_mutex_unlock (&db->lock);
+    return count;
+}
+
+void packdb_close (struct packdb *db)
+{
+    if (db) {
+        int saved_errno = errno;
+        for (uint32_t seg = 0; seg < db->nsegs; seg++)
+            close (db->fds[seg]);
+        free (db->fds);
+        if (db->dirfd >= 0)
+            close (db->dirfd);
+        zhashx_destroy (&db->index);
+        pthread_mutex_destroy (&db->lock);
+        pthread_mutex_destroy (&db->wlock);
+        free (db->path);
+        free (db);
+        errno = saved_errno;
+    }
+}
+
+static void entry_destructor (void **item)
+{
+    if (item) {
+        free (*item);
+        *item = NULL;
+    }
+}
+
+struct packdb *packdb_open (const char *path,
+                            int hash_size,
+                            size_t segment_size,
+                            const char **errstr)
+{
+    struct packdb *db;
+
+    if (!path
+        || hash_size < sizeof (size_t)
+        || hash_size > 64
+        || (hash_size_global != 0 && hash_size != hash_size_global)
+        || segment_size == 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+    hash_size_global = hash_size;
+    if (mkdir (path, 0700) < 0 && errno != EEXIST)
+        return NULL;
+    if (!(db = calloc (1, sizeof (*db))))
+        return NULL;
+    db->dirfd = -1;
+    pthread_mutex_init (&db->lock, NULL);
+    pthread_mutex_init (&db->wlock, NULL);
+    db->hash_size = hash_size;
+    db->segment_size = segment_size;
+    if (!(db->path = strdup (path))
+        || !(db->index = zhashx_new ()))
+        goto nomem;
+    zhashx_set_destructor (db->index, entry_destructor);
+    zhashx_set_key_hasher (db->index, entry_hasher);
+    zhashx_set_key_comparator (db->index, entry_comparator);
+    zhashx_set_key_destructor (db->index, NULL); // key is part of entry
+    zhashx_set_key_duplicator (db->index, NULL); // key is part of entry
+    if ((db->dirfd = open (path, O_RDONLY | O_DIRECTORY | O_CLOEXEC)) < 0)
+        goto error;
+    if (packdb_load (db) < 0) {
+        if (errstr)
+            *errstr = "error reading pack segments";
+        goto error;
+    }
+    return db;
+nomem:
+    errno = ENOMEM;
+error:
+    packdb_close (db);
+    return NULL;
+}
+
+/*
+ * vi:ts=4 sw=4 expandtab
+ */
@@ -0,0 +1,74 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _CONTENT_FILES_PACKDB_H
+#define _CONTENT_FILES_PACKDB_H
+
+#include <stddef.h>
+
+/* A packdb is a log-structured blob store: blobs are appended to segment
+ * files in the 'path' directory, and an in-memory index from hash digest
+ * to segment location is rebuilt by scanning the record headers when the
+ * packdb is opened.  A torn record left at the end of a segment by a crash
+ * is truncated away on open.
+ *
+ * All functions may be called concurrently from multiple threads.
+ *
+ * Where present, pass '*errstr' in pre-set to NULL and if a human readable
+ * error message is appropriate, it is assigned on error (do not free).
+ */
+
+/* Open or create the packdb in directory 'path'.  Segments are started
+ * anew when an append would grow the current one beyond 'segment_size'.
+ * Returns packdb on success, or NULL on failure with errno set.
+ */
+struct packdb *packdb_open (const char *path,
+                            int hash_size,
+                            size_t segment_size,
+                            const char **errstr);
+
+void packdb_close (struct packdb *db);
+
+/* Look up 'hash' and assign a copy of its blob to 'datap' and 'sizep'
+ * (*datap must be freed).  Returns 0 on success, or -1 on failure with
+ * errno set (ENOENT if not found).
+ */
+int packdb_get (struct packdb *db,
+                const void *hash,
+                int hash_size,
+                void **datap,
+                size_t *sizep,
+                const char **errstr);
+
+/* Append blob 'data' of length 'size' named by 'hash', unless it is
+ * already stored.  The blob is not durable until packdb_sync().
+ * Returns 0 on success, or -1 on failure with errno set.
+ */
+int packdb_put (struct packdb *db,
+                const void *hash,
+                int hash_size,
+                const void *data,
+                size_t size,
+                const char **errstr);
+
+/* Flush all appended blobs to stable storage.
+ * Returns 0 on success, or -1 on failure with errno set.
+ */
+int packdb_sync (struct packdb *db);
+
+/* Return the number of blobs stored.
+ */
+int packdb_count (struct packdb *db);
+
+#endif /* !_CONTENT_FILES_PACKDB_H */
+
+/*
+ * vi:ts=4 sw=4 expandtab
+ */
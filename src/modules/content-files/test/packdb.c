@@ -0,0 +1,234 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "src/common/libtap/tap.h"
+#include "src/modules/content-files/packdb.h"
+#include "src/common/libutil/unlink_recursive.h"
+
+#define HASH_SIZE 20
+
+static void make_hash (char *hash, int i)
+{
+    memset (hash, 0, HASH_SIZE);
+    snprintf (hash, HASH_SIZE, "hash-%d", i);
+}
+
+static int check_blob (struct packdb *db, int i)
+{
+    char hash[HASH_SIZE];
+    char val[64];
+    void *data;
+    size_t size;
+    int n;
+    int rc = -1;
+
+    make_hash (hash, i);
+    n = snprintf (val, sizeof (val), "value-%d", i);
+    if (packdb_get (db, hash, HASH_SIZE, &data, &size, NULL) < 0)
+        return -1;
+    if (size == n && memcmp (data, val, n) == 0)
+        rc = 0;
+    free (data);
+    return rc;
+}
+
+static int put_blob (struct packdb *db, int i)
+{
+    char hash[HASH_SIZE];
+    char val[64];
+    int n;
+
+    make_hash (hash, i);
+    n = snprintf (val, sizeof (val), "value-%d", i);
+    return packdb_put (db, hash, HASH_SIZE, val, n, NULL);
+}
+
+void test_badargs (const char *dir)
+{
+    struct packdb *db;
+    char hash[HASH_SIZE];
+    void *data;
+    size_t size;
+
+    errno = 0;
+    ok (packdb_open (NULL, HASH_SIZE, 1024, NULL) == NULL && errno == EINVAL,
+        "packdb_open path=NULL fails with EINVAL");
+    errno = 0;
+    ok (packdb_open (dir, 2, 1024, NULL) == NULL && errno == EINVAL,
+        "packdb_open hash_size=2 fails with EINVAL");
+    errno = 0;
+    ok (packdb_open (dir, HASH_SIZE, 0, NULL) == NULL && errno == EINVAL,
+        "packdb_open segment_size=0 fails with EINVAL");
+
+    if (!(db = packdb_open (dir, HASH_SIZE, 1024, NULL)))
+        BAIL_OUT ("packdb_open failed");
+    make_hash (hash, 0);
+    errno = 0;
+    ok (packdb_get (db, hash, HASH_SIZE, &data, &size, NULL) < 0
+        && errno == ENOENT,
+        "packdb_get of unknown hash fails with ENOENT");
+    errno = 0;
+    ok (packdb_get (db, hash, 4, &data, &size, NULL) < 0 && errno == EINVAL,
+        "packdb_get with wrong hash size fails with EINVAL");
+    errno = 0;
+    ok (packdb_put (db, hash, 4, "x", 1, NULL) < 0 && errno == EINVAL,
+        "packdb_put with wrong hash size fails with EINVAL");
+    ok (packdb_count (db) == 0,
+        "packdb_count is 0");
+    packdb_close (db);
+
+    lives_ok ({packdb_close (NULL);},
+        "packdb_close db=NULL doesn't crash");
+}
+
+void test_simple (const char *dir)
+{
+    struct packdb *db;
+    char hash[HASH_SIZE];
+    void *data;
+    size_t size;
+    int errors;
+    int i;
+
+    /* small segment size forces many segments */
+    if (!(db = packdb_open (dir, HASH_SIZE, 256, NULL)))
+        BAIL_OUT ("packdb_open failed");
+
+    errors = 0;
+    for (i = 0; i < 100; i++) {
+        if (put_blob (db, i) < 0)
+            errors++;
+    }
+    ok (errors == 0,
+        "packdb_put of 100 blobs works");
+    ok (put_blob (db, 42) == 0 && packdb_count (db) == 100,
+        "packdb_put of a duplicate blob is not stored twice");
+    make_hash (hash, 100);
+    ok (packdb_put (db, hash, HASH_SIZE, NULL, 0, NULL) == 0
+        && packdb_get (db, hash, HASH_SIZE, &data, &size, NULL) == 0
+        && size == 0,
+        "packdb_put/get of an empty blob works");
+    free (data);
+    ok (packdb_sync (db) == 0,
+        "packdb_sync works");
+
+    errors = 0;
+    for (i = 0; i < 100; i++) {
+        if (check_blob (db, i) < 0)
+            errors++;
+    }
+    ok (errors == 0,
+        "packdb_get returns all 100 blobs");
+    packdb_close (db);
+
+    /* reopen rebuilds the index from the segments */
+    if (!(db = packdb_open (dir, HASH_SIZE, 256, NULL)))
+        BAIL_OUT ("packdb_open failed");
+    ok (packdb_count (db) == 101,
+        "packdb_count is 101 after reopen");
+    errors = 0;
+    for (i = 0; i < 100; i++) {
+        if (check_blob (db, i) < 0)
+            errors++;
+    }
+    ok (errors == 0,
+        "packdb_get returns all 100 blobs after reopen");
+    packdb_close (db);
+}
+
+void test_torn (const char *dir)
+{
+    struct packdb *db;
+    char path[1024];
+    int fd;
+
+    if (!(db = packdb_open (dir, HASH_SIZE, 1024 * 1024, NULL)))
+        BAIL_OUT ("packdb_open failed");
+    ok (put_blob (db, 1) == 0 && put_blob (db, 2) == 0,
+        "packdb_put of 2 blobs works");
+    packdb_close (db);
+
+    /* simulate a crash during an append */
+    snprintf (path, sizeof (path), "%s/seg.000000", dir);
+    if ((fd = open (path, O_WRONLY | O_APPEND)) < 0
+        || write (fd, "garbage", 7) != 7
+        || close (fd) < 0)
+        BAIL_OUT ("could not append to %s", path);
+
+    if (!(db = packdb_open (dir, HASH_SIZE, 1024 * 1024, NULL)))
+        BAIL_OUT ("packdb_open failed");
+    ok (packdb_count (db) == 2
+        && check_blob (db, 1) == 0
+        && check_blob (db, 2) == 0,
+        "packdb_open ignores a torn record");
+    ok (put_blob (db, 3) == 0,
+        "packdb_put works after torn record");
+    packdb_close (db);
+
+    if (!(db = packdb_open (dir, HASH_SIZE, 1024 * 1024, NULL)))
+        BAIL_OUT ("packdb_open failed");
+    ok (packdb_count (db) == 3 && check_blob (db, 3) == 0,
+        "blob appended after torn record survives reopen");
+    packdb_close (db);
+}
+
+static int make_dir (char *dir, size_t size, const char *name)
+{
+    const char *tmp = getenv ("TMPDIR");
+
+    if (!tmp)
+        tmp = "/tmp";
+    if (snprintf (dir, size, "%s/%s.XXXXXX", tmp, name) >= size
+        || !mkdtemp (dir))
+        return -1;
+    diag ("mkdir %s", dir);
+    return 0;
+}
+
+int main (int argc, char *argv[])
+{
+    char dir[1024];
+
+    plan (NO_PLAN);
+
+    if (make_dir (dir, sizeof (dir), "packdb") < 0)
+        BAIL_OUT ("mkdtemp failed");
+    test_badargs (dir);
+    if (unlink_recursive (dir) < 0)
+        BAIL_OUT ("unlink_recursive failed");
+
+    if (make_dir (dir, sizeof (dir), "packdb") < 0)
+        BAIL_OUT ("mkdtemp failed");
+    test_simple (dir);
+    if (unlink_recursive (dir) < 0)
+        BAIL_OUT ("unlink_recursive failed");
+
+    if (make_dir (dir, sizeof (dir), "packdb") < 0)
+        BAIL_OUT ("mkdtemp failed");
+    test_torn (dir);
+    if (unlink_recursive (dir) < 0)
+        BAIL_OUT ("unlink_recursive failed");
+
+    done_testing ();
+    return (0);
+}
+
+// vi: ts=4 sw=4 expandtab
@@ -13,11 +13,14 @@
 #endif
 #include <jansson.h>
 #include <flux/core.h>
+#include <limits.h>
 #include <assert.h>
 
 #include "src/common/libutil/blobref.h"
 #include "src/common/libutil/log.h"
 #include "src/common/libutil/errprintf.h"
+#include "src/common/libutil/workpool.h"
+#include "src/common/libczmqcontainers/czmq_containers.h"
 
 #include "src/common/libcontent/content-util.h"
 
@@ -29,14 +32,41 @@
 
 #include "s3.h"
 
+/* Blobs smaller than pack-threshold are not stored as individual objects.
+ * Instead they are appended to a pack, which is written as one object
+ * named "pack.<seq>" once it reaches pack-size or after pack_timeout
+ * seconds.  The pack index, a JSON array of [blobref, offset, size] tuples,
+ * is then written as "packidx.<seq>".  Store requests are answered once
+ * both writes complete.  All pack indices are read in when the module
+ * is loaded.
+ */
+struct pack_ref {
+    unsigned int seq;
+    size_t offset;
+    size_t size;
+};
+
 struct content_s3 {
     flux_msg_handler_t **handlers;
     struct s3_config *cfg;
     flux_t *h;
     char *hashfun;
     int hash_size;
+    struct workpool *wp;        // I/O threads, NULL if synchronous
+    flux_watcher_t *wp_w;
+    zhashx_t *packidx;          // blobref => struct pack_ref
+    unsigned int pack_seq;      // highest pack sequence number in use
+    struct pack *pack;          // pack being filled, NULL if none
+    flux_watcher_t *pack_timer;
 };
 
+static const int default_concurrency = 16;
+static const int default_pack_size = 1024*1024*4;
+static const double pack_timeout = 0.01;
+
+static const char *pack_prefix = "pack.";
+static const char *packidx_prefix = "packidx.";
+
 static void s3_config_destroy (struct s3_config *ctx)
 {
     if (ctx) {
@@ -50,22 +80,6 @@ static void s3_config_destroy (struct s3_config *ctx)
     }
 }
 
-/* Destroy module context.
- */
-static void content_s3_destroy (struct content_s3 *ctx)
-{
-    if (ctx) {
-        int saved_errno = errno;
-        flux_msg_handler_delvec (ctx->handlers);
-        s3_config_destroy (ctx->cfg);
-        free (ctx->hashfun);
-        free (ctx);
-        errno = saved_errno;
-    }
-
-    s3_cleanup ();
-}
-
 static int parse_credentials (struct s3_config *cfg,
                               const char *cred_file,
                               flux_error_t *errp)
@@ -153,10 +167,13 @@ static struct s3_config *parse_config (const flux_conf_t *conf,
 
     cfg->retries = 5;
     cfg->is_secure = 0;
+    cfg->concurrency = default_concurrency;
+    cfg->pack_threshold = 0;
+    cfg->pack_size = default_pack_size;
 
     if (flux_conf_unpack (conf,
                           &error,
-                          "{s:{s:s, s:s, s:s, s?b !} }",
+                          "{s:{s:s, s:s, s:s, s?b, s?i, s?i, s?i !} }",
                           "content-s3",
                           "credential-file",
                           &cred_file,
@@ -165,10 +182,26 @@ static struct s3_config *parse_config (const flux_conf_t *conf,
                           "uri",
                           &uri,
                           "virtual-host-style",
-                          &is_virtual_host) < 0) {
+                          &is_virtual_host,
+                          "concurrency",
+                          &cfg->concurrency,
+                          "pack-threshold",
+                          &cfg->pack_threshold,
+                          "pack-size",
+                          &cfg->pack_size) < 0) {
         errprintf (errp, "%s", error.text);
         goto error;
     }
+    if (cfg->concurrency < 0) {
+        errprintf (errp, "concurrency must be >= 0");
+        errno = EINVAL;
+        goto error;
+    }
+    if (cfg->pack_threshold < 0 || cfg->pack_size <= 0) {
+        errprintf (errp, "pack-threshold must be >= 0 and pack-size > 0");
+        errno = EINVAL;
+        goto error;
+    }
 
     if (!(cpy = strdup (uri)))
         goto error;
@@ -247,19 +280,454 @@ error:
         flux_log_error (h, "error responding to config-reload request");
 }
 
+/* Blocking S3 requests for load and store are run in the I/O thread pool,
+ * allowing up to 'concurrency' requests in flight.  The request message and
+ * key are prepared and the response is sent in the reactor thread;  only
+ * s3_get()/s3_put() run in a pool thread, and they must not touch the
+ * flux handle.
+ */
+struct io_request {
+    struct content_s3 *ctx;
+    const flux_msg_t *msg;
+    char key[BLOBREF_MAX_STRING_SIZE];
+    bool packed;                // load: blob is at 'ref' in pack 'key'
+    struct pack_ref ref;
+    uint8_t hash[BLOBREF_MAX_DIGEST_SIZE];
+    int hash_size;
+    const void *data;
+    size_t size;
+    void *result;
+    int errnum;
+    const char *errstr;
+};
+
+struct pack {
+    struct content_s3 *ctx;
+    unsigned int seq;
+    char *data;
+    size_t size;
+    size_t alloc;
+    json_t *index;              // array of [blobref, offset, size]
+    char *index_str;
+    zlistx_t *requests;         // store requests answered on completion
+    int errnum;
+    const char *errstr;
+};
+
+static void io_request_destroy (struct io_request *req)
+{
+    if (req) {
+        int saved_errno = errno;
+        flux_msg_decref (req->msg);
+        free (req->result);
+        free (req);
+        errno = saved_errno;
+    }
+}
+
+/* zlistx_destructor_fn footprint
+ */
+static void io_request_destructor (void **item)
+{
+    if (item) {
+        io_request_destroy (*item);
+        *item = NULL;
+    }
+}
+
+static struct io_request *io_request_create (struct content_s3 *ctx,
+                                             const flux_msg_t *msg)
+{
+    struct io_request *req;
+
+    if (!(req = calloc (1, sizeof (*req))))
+        return NULL;
+    req->ctx = ctx;
+    req->msg = flux_msg_incref (msg);
+    return req;
+}
+
+static void io_request_respond_error (struct io_request *req,
+                                      const char *name)
+{
+    flux_t *h = req->ctx->h;
+
+    if (flux_respond_error (h, req->msg, req->errnum, req->errstr) < 0)
+        flux_log_error (h, "error responding to %s request", name);
+}
+
+/* Submit 'work' to the I/O thread pool, or if the pool was not configured,
+ * run it synchronously.
+ */
+static int io_submit (struct content_s3 *ctx,
+                      workpool_f work,
+                      workpool_f done,
+                      void *arg)
+{
+    if (!ctx->wp) {
+        work (arg);
+        done (arg);
+        return 0;
+    }
+    return workpool_submit (ctx->wp, work, done, arg);
+}
+
+static void pack_key (char *buf,
+                      size_t size,
+                      const char *prefix,
+                      unsigned int seq)
+{
+    snprintf (buf, size, "%s%u", prefix, seq);
+}
+
+/* zhashx_destructor_fn footprint
+ */
+static void pack_ref_destructor (void **item)
+{
+    if (item) {
+        free (*item);
+        *item = NULL;
+    }
+}
+
+static int packidx_add (struct content_s3 *ctx,
+                        const char *blobref,
+                        unsigned int seq,
+                        json_int_t offset,
+                        json_int_t size)
+{
+    struct pack_ref *ref;
+
+    if (zhashx_lookup (ctx->packidx, blobref))
+        return 0;
+    if (!(ref = calloc (1, sizeof (*ref))))
+        return -1;
+    ref->seq = seq;
+    ref->offset = offset;
+    ref->size = size;
+    if (zhashx_insert (ctx->packidx, blobref, ref) < 0) {
+        free (ref);
+        errno = ENOMEM;
+        return -1;
+    }
+    return 0;
+}
+
+/* Add the entries of a pack index to ctx->packidx.
+ */
+static int packidx_add_index (struct content_s3 *ctx,
+                              unsigned int seq,
+                              json_t *index)
+{
+    size_t i;
+    json_t *entry;
+
+    if (!json_is_array (index)) {
+        errno = EPROTO;
+        return -1;
+    }
+    json_array_foreach (index, i, entry) {
+        const char *blobref;
+        json_int_t offset;
+        json_int_t size;
+
+        if (json_unpack (entry, "[sII]", &blobref, &offset, &size) < 0
+            || offset < 0
+            || size < 0) {
+            errno = EPROTO;
+            return -1;
+        }
+        if (packidx_add (ctx, blobref, seq, offset, size) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+static void string_destructor (void **item)
+{
+    if (item) {
+        free (*item);
+        *item = NULL;
+    }
+}
+
+static int packidx_list_cb (const char *key, void *arg)
+{
+    zlistx_t *keys = arg;
+    char *cpy;
+
+    if (!(cpy = strdup (key)))
+        return -1;
+    if (!zlistx_add_end (keys, cpy)) {
+        free (cpy);
+        return -1;
+    }
+    return 0;
+}
+
+/* Read all pack indices from the bucket into ctx->packidx, and
+ * set ctx->pack_seq to the highest pack sequence number found.
+ */
+static int packidx_load (struct content_s3 *ctx, const char **errstr)
+{
+    zlistx_t *keys;
+    const char *key;
+    int rc = -1;
+
+    if (!(keys = zlistx_new ())) {
+        errno = ENOMEM;
+        return -1;
+    }
+    zlistx_set_destructor (keys, string_destructor);
+    if (s3_list (ctx->cfg, packidx_prefix, packidx_list_cb, keys, errstr) < 0)
+        goto done;
+    key = zlistx_first (keys);
+    while (key) {
+        unsigned long seq;
+        char *endptr;
+        void *data;
+        size_t size;
+        json_t *index;
+
+        errno = 0;
+        seq = strtoul (key + strlen (packidx_prefix), &endptr, 10);
+        if (errno == 0 && *endptr == '\0' && seq <= UINT_MAX) {
+            if (s3_get (ctx->cfg, key, &data, &size, errstr) < 0)
+                goto done;
+            index = json_loadb (data, size, 0, NULL);
+            free (data);
+            if (packidx_add_index (ctx, seq, index) < 0) {
+                json_decref (index);
+                flux_log (ctx->h, LOG_ERR, "%s: invalid pack index", key);
+                *errstr = "invalid pack index";
+                goto done;
+            }
+            json_decref (index);
+            if (ctx->pack_seq < seq)
+                ctx->pack_seq = seq;
+        }
+        key = zlistx_next (keys);
+    }
+    rc = 0;
+done:
+    zlistx_destroy (&keys);
+    return rc;
+}
+
+static void pack_destroy (struct pack *pack)
+{
+    if (pack) {
+        int saved_errno = errno;
+        free (pack->data);
+        json_decref (pack->index);
+        free (pack->index_str);
+        zlistx_destroy (&pack->requests);
+        free (pack);
+        errno = saved_errno;
+    }
+}
+
+static struct pack *pack_create (struct content_s3 *ctx)
+{
+    struct pack *pack;
+
+    if (!(pack = calloc (1, sizeof (*pack))))
+        return NULL;
+    pack->ctx = ctx;
+    pack->seq = ctx->pack_seq + 1;
+    if (!(pack->index = json_array ())
+        || !(pack->requests = zlistx_new ())) {
+        pack_destroy (pack);
+        errno = ENOMEM;
+        return NULL;
+    }
+    zlistx_set_destructor (pack->requests, io_request_destructor);
+    ctx->pack_seq = pack->seq;
+    return pack;
+}
+
+static void pack_work (void *arg)
+{
+    struct pack *pack = arg;
+    char key[64];
+
+    pack_key (key, sizeof (key), pack_prefix, pack->seq);
+    if (s3_put (pack->ctx->cfg,
+                key,
+                pack->data,
+                pack->size,
+                &pack->errstr) < 0)
+        goto error;
+    pack_key (key, sizeof (key), packidx_prefix, pack->seq);
+    if (s3_put (pack->ctx->cfg,
+                key,
+                pack->index_str,
+                strlen (pack->index_str),
+                &pack->errstr) < 0)
+        goto error;
+    return;
+error:
+    pack->errnum = errno;
+}
+
+static void pack_done (void *arg)
+{
+    struct pack *pack = arg;
+    struct content_s3 *ctx = pack->ctx;
+    struct io_request *req;
+
+    if (pack->errnum == 0
+        && packidx_add_index (ctx, pack->seq, pack->index) < 0) {
+        pack->errnum = errno;
+        pack->errstr = "error updating pack index";
+    }
+    req = zlistx_first (pack->requests);
+    while (req) {
+        if (pack->errnum != 0) {
+            req->errnum = pack->errnum;
+            req->errstr = pack->errstr;
+            io_request_respond_error (req, "store");
+        }
+        else if (flux_respond_raw (ctx->h,
+                                   req->msg,
+                                   req->hash,
+                                   req->hash_size) < 0)
+            flux_log_error (ctx->h, "error responding to store request");
+        req = zlistx_next (pack->requests);
+    }
+    pack_destroy (pack);
+}
+
+/* Write out the pack being filled.
+ */
+static void pack_submit (struct content_s3 *ctx)
+{
+    struct pack *pack = ctx->pack;
+
+    ctx->pack = NULL;
+    flux_watcher_stop (ctx->pack_timer);
+    if (!(pack->index_str = json_dumps (pack->index, JSON_COMPACT))) {
+        pack->errnum = ENOMEM;
+        pack->errstr = "error encoding pack index";
+        pack_done (pack);
+        return;
+    }
+    if (io_submit (ctx, pack_work, pack_done, pack) < 0) {
+        pack->errnum = errno;
+        pack_done (pack);
+    }
+}
+
+static void pack_timer_cb (flux_reactor_t *r,
+                           flux_watcher_t *w,
+                           int revents,
+                           void *arg)
+{
+    struct content_s3 *ctx = arg;
+
+    if (ctx->pack)
+        pack_submit (ctx);
+}
+
+/* Add a store request to the pack being filled, creating one if needed.
+ * The request is answered when the pack is written.
+ */
+static int pack_append (struct content_s3 *ctx, struct io_request *req)
+{
+    struct pack *pack;
+    json_t *entry;
+
+    if (!ctx->pack) {
+        if (!(ctx->pack = pack_create (ctx)))
+            return -1;
+        flux_timer_watcher_reset (ctx->pack_timer, pack_timeout, 0.);
+        flux_watcher_start (ctx->pack_timer);
+    }
+    pack = ctx->pack;
+    if (pack->size + req->size > pack->alloc) {
+        size_t alloc = pack->alloc ? pack->alloc : 4096;
+        char *data;
+
+        while (alloc < pack->size + req->size)
+            alloc *= 2;
+        if (!(data = realloc (pack->data, alloc)))
+            return -1;
+        pack->data = data;
+        pack->alloc = alloc;
+    }
+    if (!(entry = json_pack ("[sII]",
+                             req->key,
+                             (json_int_t)pack->size,
+                             (json_int_t)req->size))
+        || json_array_append_new (pack->index, entry) < 0) {
+        errno = ENOMEM;
+        return -1;
+    }
+    if (!zlistx_add_end (pack->requests, req)) {
+        json_array_remove (pack->index, json_array_size (pack->index) - 1);
+        errno = ENOMEM;
+        return -1;
+    }
+    if (req->size > 0)
+        memcpy (pack->data + pack->size, req->data, req->size);
+    pack->size += req->size;
+    if (pack->size >= ctx->cfg->pack_size)
+        pack_submit (ctx);
+    return 0;
+}
+
+static void load_work (void *arg)
+{
+    struct io_request *req = arg;
+    int rc;
+
+    if (req->packed) {
+        rc = s3_get_range (req->ctx->cfg,
+                           req->key,
+                           req->ref.offset,
+                           req->ref.size,
+                           &req->result,
+                           &req->size,
+                           &req->errstr);
+    }
+    else {
+        rc = s3_get (req->ctx->cfg,
+                     req->key,
+                     &req->result,
+                     &req->size,
+                     &req->errstr);
+    }
+    if (rc < 0)
+        req->errnum = errno;
+}
+
+static void load_done (void *arg)
+{
+    struct io_request *req = arg;
+    flux_t *h = req->ctx->h;
+
+    if (req->errnum != 0)
+        io_request_respond_error (req, "load");
+    else if (flux_respond_raw (h, req->msg, req->result, req->size) < 0)
+        flux_log_error (h, "error responding to load request");
+    io_request_destroy (req);
+}
+
 /* Handle a content-backing.load request from the rank 0 broker's
  * content-cache service.  The raw request payload is a hash digest,
  * The raw response payload is the blob content.  These payloads are specified
  * in RFC 10.
  */
-static void load_cb (flux_t *h, flux_msg_handler_t *mh, const flux_msg_t *msg, void *arg)
+static void load_cb (flux_t *h,
+                     flux_msg_handler_t *mh,
+                     const flux_msg_t *msg,
+                     void *arg)
 {
     struct content_s3 *ctx = arg;
+    struct io_request *req = NULL;
+    struct pack_ref *ref;
     const void *hash;
     int hash_size;
-    char blobref[BLOBREF_MAX_STRING_SIZE];
-    void *data = NULL;
-    size_t size;
     const char *errstr = NULL;
 
     if (flux_request_decode_raw (msg, NULL, &hash, &hash_size) < 0)
@@ -269,23 +737,57 @@ static void load_cb (flux_t *h, flux_msg_handler_t *mh, const flux_msg_t *msg, v
         errstr = "incorrect hash size";
         goto error;
     }
+    if (!(req = io_request_create (ctx, msg)))
+        goto error;
     if (blobref_hashtostr (ctx->hashfun,
                            hash,
                            hash_size,
-                           blobref,
-                           sizeof (blobref)) < 0)
+                           req->key,
+                           sizeof (req->key)) < 0)
         goto error;
-    if (s3_get (ctx->cfg, blobref, &data, &size, &errstr) < 0)
+    if ((ref = zhashx_lookup (ctx->packidx, req->key))) {
+        if (ref->size == 0) {
+            if (flux_respond_raw (h, msg, NULL, 0) < 0)
+                flux_log_error (h, "error responding to load request");
+            io_request_destroy (req);
+            return;
+        }
+        req->packed = true;
+        req->ref = *ref;
+        pack_key (req->key, sizeof (req->key), pack_prefix, ref->seq);
+    }
+    if (io_submit (ctx, load_work, load_done, req) < 0)
         goto error;
-    if (flux_respond_raw (h, msg, data, size) < 0)
-        flux_log_error (h, "error responding to load request");
-    free (data);
     return;
 
 error:
     if (flux_respond_error (h, msg, errno, errstr) < 0)
         flux_log_error (h, "error responding to load request");
-    free (data);
+    io_request_destroy (req);
+}
+
+static void store_work (void *arg)
+{
+    struct io_request *req = arg;
+
+    if (s3_put (req->ctx->cfg,
+                req->key,
+                req->data,
+                req->size,
+                &req->errstr) < 0)
+        req->errnum = errno;
+}
+
+static void store_done (void *arg)
+{
+    struct io_request *req = arg;
+    flux_t *h = req->ctx->h;
+
+    if (req->errnum != 0)
+        io_request_respond_error (req, "store");
+    else if (flux_respond_raw (h, req->msg, req->hash, req->hash_size) < 0)
+        flux_log_error (h, "error responding to store request");
+    io_request_destroy (req);
 }
 
 /* Handle a content-backing.store request from the rank 0 broker's
@@ -299,36 +801,41 @@ void store_cb (flux_t *h,
                void *arg)
 {
     struct content_s3 *ctx = arg;
+    struct io_request *req = NULL;
     const void *data;
     int size;
-    char blobref[BLOBREF_MAX_STRING_SIZE];
-    uint8_t hash[BLOBREF_MAX_DIGEST_SIZE];
-    int hash_size;
-    const char *errstr = NULL;
 
     if (flux_request_decode_raw (msg, NULL, &data, &size) < 0)
         goto error;
-    if ((hash_size = blobref_hash_raw (ctx->hashfun,
-                                       data,
-                                       size,
-                                       hash,
-                                       sizeof (hash))) < 0
+    if (!(req = io_request_create (ctx, msg)))
+        goto error;
+    req->data = data;
+    req->size = size;
+    if ((req->hash_size = blobref_hash_raw (ctx->hashfun,
+                                            data,
+                                            size,
+                                            req->hash,
+                                            sizeof (req->hash))) < 0
         || blobref_hashtostr (ctx->hashfun,
-                              hash,
-                              hash_size,
-                              blobref,
-                              sizeof (blobref)) < 0)
+                              req->hash,
+                              req->hash_size,
+                              req->key,
+                              sizeof (req->key)) < 0)
         goto error;
-    assert (hash_size == ctx->hash_size);
-    if (s3_put (ctx->cfg, blobref, data, size, &errstr) < 0)
+    assert (req->hash_size == ctx->hash_size);
+    if (size < ctx->cfg->pack_threshold) {
+        if (pack_append (ctx, req) < 0)
+            goto error;
+        return;
+    }
+    if (io_submit (ctx, store_work, store_done, req) < 0)
         goto error;
-    if (flux_respond_raw (h, msg, hash, hash_size) < 0)
-        flux_log_error (h, "error responding to store request");
     return;
 
 error:
-    if (flux_respond_error (h, msg, errno, errstr) < 0)
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
         flux_log_error (h, "error responding to store request");
+    io_request_destroy (req);
 }
 
 /* Handle a content-backing.checkpoint-get request from the rank 0 kvs module.
@@ -423,6 +930,28 @@ error:
     free (value);
 }
 
+/* Destroy module context.
+ */
+static void content_s3_destroy (struct content_s3 *ctx)
+{
+    if (ctx) {
+        int saved_errno = errno;
+        if (ctx->pack)
+            pack_submit (ctx);
+        flux_watcher_destroy (ctx->pack_timer);
+        flux_watcher_destroy (ctx->wp_w);
+        workpool_destroy (ctx->wp); // responds to in-flight requests
+        flux_msg_handler_delvec (ctx->handlers);
+        zhashx_destroy (&ctx->packidx);
+        s3_config_destroy (ctx->cfg);
+        free (ctx->hashfun);
+        free (ctx);
+        errno = saved_errno;
+    }
+
+    s3_cleanup ();
+}
+
 /* Table of message handler callbacks registered below.
  * The topic strings in the table consist of <service name>.<method>.
  */
@@ -437,8 +966,19 @@ static const struct flux_msg_handler_spec htab[] = {
     FLUX_MSGHANDLER_TABLE_END,
 };
 
-/* Create the s3 context, initialize the connection, and
- * create the working bucket
+static void workpool_cb (flux_reactor_t *r,
+                         flux_watcher_t *w,
+                         int revents,
+                         void *arg)
+{
+    struct content_s3 *ctx = arg;
+
+    if (workpool_run_done (ctx->wp) < 0)
+        flux_log_error (ctx->h, "error running I/O completions");
+}
+
+/* Create the s3 context, initialize the connection,
+ * create the working bucket, and read in pack indices.
  */
 static struct content_s3 *content_s3_create (flux_t *h)
 {
@@ -474,6 +1014,32 @@ static struct content_s3 *content_s3_create (flux_t *h)
         goto error;
     }
 
+    if (!(ctx->packidx = zhashx_new ()))
+        goto error;
+    zhashx_set_destructor (ctx->packidx, pack_ref_destructor);
+    if (packidx_load (ctx, &errstr) < 0) {
+        flux_log (h, LOG_ERR, "content-s3 load pack index: %s", errstr);
+        goto error;
+    }
+    if (!(ctx->pack_timer = flux_timer_watcher_create (flux_get_reactor (h),
+                                                       pack_timeout,
+                                                       0.,
+                                                       pack_timer_cb,
+                                                       ctx)))
+        goto error;
+    if (ctx->cfg->concurrency > 0) {
+        if (!(ctx->wp = workpool_create (ctx->cfg->concurrency))
+            || !(ctx->wp_w = flux_fd_watcher_create (flux_get_reactor (h),
+                                                     workpool_get_fd (ctx->wp),
+                                                     FLUX_POLLIN,
+                                                     workpool_cb,
+                                                     ctx))) {
+            flux_log_error (h, "could not create I/O thread pool");
+            goto error;
+        }
+        flux_watcher_start (ctx->wp_w);
+    }
+
     if (flux_msg_handler_addvec (h, htab, ctx, &ctx->handlers) < 0)
         goto error;
 
@@ -12,6 +12,7 @@
 #include "config.h"
 #endif
 #include <sys/types.h>
+#include <stdint.h>
 #include <string.h>
 #include <errno.h>
 #include <stdio.h>
@@ -35,6 +36,8 @@
     S3_put_object(ctx, key, size, prop, req, 0, cb, data)
 #define S3_get_object(ctx, key, cond, start, cnt, req, cb, data) \
     S3_get_object(ctx, key, cond, start, cnt, req, 0, cb, data)
+#define S3_list_bucket(ctx, prefix, marker, delim, max, req, cb, data) \
+    S3_list_bucket(ctx, prefix, marker, delim, max, req, 0, cb, data)
 #endif
 
 static S3Protocol protocol = S3ProtocolHTTP;
@@ -49,6 +52,16 @@ struct cb_data {
     S3Status status;
 };
 
+/* Data needed by the list bucket callback function
+ */
+struct list_data {
+    s3_list_f cb;
+    void *arg;
+    int is_truncated;
+    char marker[1024];
+    S3Status status;
+};
+
 static S3Status response_props_cb (const S3ResponseProperties *properties,
                                    void *data)
 {
@@ -221,6 +234,7 @@ int s3_put (struct s3_config *cfg,
     };
 
     do {
+        ctx.count = 0;
         S3_put_object (&bucket_ctx,
                        key,
                        size,
@@ -242,11 +256,43 @@ int s3_put (struct s3_config *cfg,
     return 0;
 }
 
-int s3_get (struct s3_config *cfg,
-            const char *key,
-            void **datap,
-            size_t *sizep,
-            const char **errstr)
+static S3Status list_bucket_cb (int is_truncated,
+                                const char *next_marker,
+                                int contents_count,
+                                const S3ListBucketContent *contents,
+                                int common_prefixes_count,
+                                const char **common_prefixes,
+                                void *data)
+{
+    struct list_data *ctx = data;
+
+    for (int i = 0; i < contents_count; i++) {
+        if (ctx->cb (contents[i].key, ctx->arg) < 0)
+            return S3StatusAbortedByCallback;
+    }
+    ctx->is_truncated = is_truncated;
+    if (!next_marker && contents_count > 0)
+        next_marker = contents[contents_count - 1].key;
+    if (next_marker)
+        snprintf (ctx->marker, sizeof (ctx->marker), "%s", next_marker);
+    return S3StatusOK;
+}
+
+static void list_complete_cb (S3Status status,
+                              const S3ErrorDetails *error,
+                              void *data)
+{
+    struct list_data *ctx = data;
+    ctx->status = status;
+}
+
+static int get_object (struct s3_config *cfg,
+                       const char *key,
+                       uint64_t offset,
+                       uint64_t count,
+                       void **datap,
+                       size_t *sizep,
+                       const char **errstr)
 {
     int retries = cfg->retries;
     size_t size = 0;
@@ -291,13 +337,17 @@ int s3_get (struct s3_config *cfg,
     }
 
     do {
+        free (ctx.data);
+        ctx.data = NULL;
+        ctx.size = 0;
         S3_get_object (&bucket_ctx,
                        key,
-                       NULL, // getConditions (NULL for none)
-                       0,    // startByte
-                       0,    // byteCount (0 indicates the entire object
-                             //  should be read)
-                       NULL, // requestContext (NULL for synchronous operation)
+                       NULL,   // getConditions (NULL for none)
+                       offset, // startByte
+                       count,  // byteCount (0 indicates the entire object
+                               //  should be read)
+                       NULL,   // requestContext (NULL for synchronous
+                               //  operation)
                        &get_obj_hndl, &ctx);
         retries--;
     } while (S3_status_is_retryable (ctx.status) && retries > 0);
@@ -321,6 +371,99 @@ int s3_get (struct s3_config *cfg,
     return 0;
 }
 
+int s3_get (struct s3_config *cfg,
+            const char *key,
+            void **datap,
+            size_t *sizep,
+            const char **errstr)
+{
+    return get_object (cfg, key, 0, 0, datap, sizep, errstr);
+}
+
+int s3_get_range (struct s3_config *cfg,
+                  const char *key,
+                  size_t offset,
+                  size_t size,
+                  void **datap,
+                  size_t *sizep,
+                  const char **errstr)
+{
+    if (size == 0) {
+        errno = EINVAL;
+        if (errstr)
+            *errstr = "invalid range";
+        return -1;
+    }
+    if (get_object (cfg, key, offset, size, datap, sizep, errstr) < 0)
+        return -1;
+    if (*sizep != size) {
+        free (*datap);
+        errno = EREMOTEIO;
+        if (errstr)
+            *errstr = "short read";
+        return -1;
+    }
+    return 0;
+}
+
+int s3_list (struct s3_config *cfg,
+             const char *prefix,
+             s3_list_f cb,
+             void *arg,
+             const char **errstr)
+{
+    S3ListBucketHandler list_hndl = {
+        .responseHandler = {
+            .propertiesCallback = &response_props_cb,
+            .completeCallback = &list_complete_cb
+        },
+        .listBucketCallback = &list_bucket_cb
+    };
+
+    S3BucketContext bucket_ctx = {
+        .hostName = NULL,
+        .bucketName = cfg->bucket,
+        .protocol = protocol,
+        .uriStyle = uri_style,
+        .accessKeyId = cfg->access_key,
+        .secretAccessKey = cfg->secret_key
+    };
+
+    struct list_data ctx = {
+        .cb = cb,
+        .arg = arg,
+        .status = S3StatusOK,
+    };
+
+    do {
+        int retries = cfg->retries;
+
+        ctx.is_truncated = 0;
+        do {
+            S3_list_bucket (&bucket_ctx,
+                            prefix,
+                            ctx.marker[0] ? ctx.marker : NULL,
+                            NULL, // delimiter
+                            0,    // maxkeys (0 for the server default)
+                            NULL, // requestContext (NULL for synchronous
+                                  //  operation)
+                            &list_hndl,
+                            &ctx);
+            retries--;
+        } while (S3_status_is_retryable (ctx.status) && retries > 0);
+
+        if (ctx.status != S3StatusOK) {
+            errno = ctx.status == S3StatusAbortedByCallback ? ECANCELED
+                                                            : EREMOTEIO;
+            if (errstr)
+                *errstr = S3_get_status_name (ctx.status);
+            return -1;
+        }
+    } while (ctx.is_truncated);
+
+    return 0;
+}
+
 /*
  * vi:ts=4 sw=4 expandtab
  */
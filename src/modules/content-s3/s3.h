@@ -11,6 +11,8 @@
 #ifndef _CONTENT_S3_S3_H
 #define _CONTENT_S3_S3_H
 
+#include <stddef.h>
+
 /* Configuration info needed for all s3 calls
  */
 struct s3_config {
@@ -21,11 +23,21 @@ struct s3_config {
     char *access_key;   // access key id string
     char *secret_key;   // secret access key id string
     char *hostname;     // hostname string
+
+    /* Module tunables, not used by the functions below.
+     */
+    int concurrency;    // max operations in flight (0=synchronous)
+    int pack_threshold; // pack blobs smaller than this (0=disabled)
+    int pack_size;      // target size of a pack object
 };
 
 /* All int-returning functions below return 0 on success.  On failure,
  * they return -1 with errno set.  In addition, if 'errstr' is non-NULL
  * on failure, it is assigned an S3 status string.
+ *
+ * Once s3_init() has been called, put/get/list may be called concurrently
+ * from multiple threads.  libs3 keeps a cache of curl handles, so their
+ * connections are kept alive and reused between requests.
  */
 
 /* Initialize the s3 connection.
@@ -56,6 +68,28 @@ int s3_get (struct s3_config *cfg,
             size_t *sizep,
             const char **errstr);
 
+/* Read 'size' bytes at 'offset' from object named 'key'.
+ * It is an error if fewer bytes are available.
+ */
+int s3_get_range (struct s3_config *cfg,
+                  const char *key,
+                  size_t offset,
+                  size_t size,
+                  void **datap,
+                  size_t *sizep,
+                  const char **errstr);
+
+/* Call 'cb' with the name of each object whose name begins with 'prefix'.
+ * If 'cb' returns -1, listing stops and s3_list() fails with ECANCELED.
+ */
+typedef int (*s3_list_f)(const char *key, void *arg);
+
+int s3_list (struct s3_config *cfg,
+             const char *prefix,
+             s3_list_f cb,
+             void *arg,
+             const char **errstr);
+
 #endif
 
 /*
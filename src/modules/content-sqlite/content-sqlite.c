@@ -17,35 +17,85 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <unistd.h>
+#include <string.h>
+#include <strings.h>
 #include <sys/statvfs.h>
 #include <sqlite3.h>
 #include <lz4.h>
+#if HAVE_ZSTD
+#include <zstd.h>
+#include <zdict.h>
+#endif
 #include <flux/core.h>
 #include <jansson.h>
 #include <assert.h>
+#include <pthread.h>
 
 #include "src/common/libutil/blobref.h"
 #include "src/common/libutil/log.h"
 #include "src/common/libutil/errno_safe.h"
 #include "src/common/libutil/tstat.h"
 #include "src/common/libutil/monotime.h"
+#include "src/common/libutil/fsd.h"
+#include "src/common/libutil/parse_size.h"
+#include "src/common/libutil/errprintf.h"
+#include "src/common/libutil/workpool.h"
+#include "src/common/libutil/bloom.h"
 
 #include "src/common/libcontent/content-util.h"
 #include "ccan/str/str.h"
 
 const size_t lzo_buf_chunksize = 1024*1024;
-const size_t compression_threshold = 256; /* compress blobs >= this size */
+
+/* Compression defaults, see flux-config-content-sqlite(5).
+ */
+const int default_compression_threshold = 256; /* compress blobs >= size */
+const int default_compression_level = 3;
+const int default_dict_samples = 10000;
+const int default_dict_size = 112640;
+
+/* The bloom filter of stored hashes is sized for twice the object count
+ * (but at least bloom_min_capacity), and rebuilt when that is exceeded.
+ */
+const size_t bloom_min_capacity = 65536;
+const double bloom_fp_rate = 0.01;
+
+/* Group commit defaults, see flux-config-content-sqlite(5).
+ * Batching is disabled unless batch-timeout is set.
+ */
+const int default_batch_max_count = 256;
+const uint64_t default_batch_max_size = 16*1024*1024;
+
+/* Schema version 1 adds the objects 'dict' column and the dicts table.
+ * When an object's 'size' is not -1, 'object' is compressed, and 'dict'
+ * selects the codec: NULL for LZ4, 0 for zstd without a dictionary, or
+ * the id of the dicts table row used for zstd compression.
+ */
+const int schema_version = 1;
 
 const char *sql_create_table = "CREATE TABLE if not exists objects("
                                "  hash BLOB PRIMARY KEY,"
                                "  size INT,"
-                               "  object BLOB"
+                               "  object BLOB,"
+                               "  dict INT"
                                ");";
-const char *sql_load = "SELECT object,size FROM objects"
+const char *sql_check_dict_column = "SELECT dict FROM objects LIMIT 0";
+const char *sql_add_dict_column = "ALTER TABLE objects ADD COLUMN dict INT";
+const char *sql_load = "SELECT object,size,dict FROM objects"
                        "  WHERE hash = ?1 LIMIT 1";
-const char *sql_store = "INSERT INTO objects (hash,size,object) "
-                        "  values (?1, ?2, ?3)";
+const char *sql_store = "INSERT INTO objects (hash,size,object,dict) "
+                        "  values (?1, ?2, ?3, ?4)";
+
+const char *sql_create_table_dicts = "CREATE TABLE if not exists dicts("
+                                     "  id INTEGER PRIMARY KEY,"
+                                     "  dict BLOB"
+                                     ");";
+const char *sql_dicts_get = "SELECT id,dict FROM dicts ORDER BY id";
+const char *sql_dict_put = "INSERT INTO dicts (dict) values (?1)";
+const char *sql_dict_samples = "SELECT object,size,dict FROM objects"
+                               "  ORDER BY random() LIMIT ?1";
 const char *sql_objects_count = "SELECT count(1) FROM objects";
+const char *sql_objects_hashes = "SELECT hash FROM objects";
 
 const char *sql_create_table_checkpt = "CREATE TABLE if not exists checkpt("
                                        "  key TEXT UNIQUE,"
@@ -56,9 +106,102 @@ const char *sql_checkpt_get = "SELECT value FROM checkpt"
 const char *sql_checkpt_put = "REPLACE INTO checkpt (key,value) "
                               "  values (?1, ?2)";
 
+/* Online garbage collection (see gc_begin_cb() below).
+ * N.B. hashes are bound as text in the objects table, so they must be
+ * bound as text in the gcmark table as well for comparisons to match.
+ */
+const char *sql_gc_create_table = "CREATE TEMP TABLE if not exists gcmark("
+                                  "  hash BLOB PRIMARY KEY"
+                                  ");"
+                                  "DELETE FROM gcmark;";
+const char *sql_gc_drop_table = "DROP TABLE if exists gcmark";
+const char *sql_gc_max_rowid = "SELECT ifnull(max(rowid),0) FROM objects";
+const char *sql_gc_mark = "INSERT OR IGNORE INTO gcmark (hash) values (?1)";
+const char *sql_gc_sweep = "DELETE FROM objects"
+                           "  WHERE rowid > ?1 AND rowid <= ?2"
+                           "  AND hash NOT IN (SELECT hash FROM gcmark)";
+
 struct content_stats {
     tstat_t load;
     tstat_t store;
+    tstat_t batch;      // blobs per group commit
+};
+
+/* Store requests accumulated for the next group commit.
+ */
+struct store_batch {
+    double timeout;     // 0 = batching disabled
+    int max_count;
+    uint64_t max_size;
+    struct flux_msglist *requests;
+    uint64_t size;
+    flux_watcher_t *timer;
+};
+
+enum {
+    COMPRESS_LZ4,
+    COMPRESS_ZSTD,
+};
+
+/* A zstd dictionary from the dicts table.
+ */
+struct zdict {
+    int id;
+    void *data;
+    size_t size;
+#if HAVE_ZSTD
+    ZSTD_DDict *ddict;
+#endif
+};
+
+/* Compression of stored blobs.  Dictionaries are only added by the
+ * reactor thread, but they are looked up by load threads, so 'dicts'
+ * is protected by 'lock'.  The last dictionary is used for compression.
+ */
+struct compress {
+    int method;
+    int level;
+    int threshold;
+    struct zdict **dicts;
+    int dict_count;
+    pthread_mutex_t lock;
+#if HAVE_ZSTD
+    ZSTD_CCtx *cctx;
+    ZSTD_CDict *cdict;
+    int cdict_id;
+    int cdict_level;
+#endif
+};
+
+/* Per-thread state for uncompressing loaded blobs.
+ */
+struct decoder {
+    size_t bufsize;
+    void *buf;
+#if HAVE_ZSTD
+    ZSTD_DCtx *dctx;
+#endif
+};
+
+/* A read-only database connection for use by a load thread.
+ */
+struct reader {
+    sqlite3 *db;
+    sqlite3_stmt *load_stmt;
+    struct decoder dec;
+};
+
+/* Load threads, enabled with the load-threads=N module option.
+ * Each thread borrows a reader from 'idle' while it runs a load.
+ */
+struct load_pool {
+    int nthreads;
+    struct workpool *wp;
+    flux_watcher_t *w;
+    struct reader *readers;
+    struct reader **idle;
+    int idle_count;
+    pthread_mutex_t lock;
 };
 
 struct content_sqlite {
@@ -69,17 +212,33 @@ struct content_sqlite {
     sqlite3_stmt *store_stmt;
     sqlite3_stmt *checkpt_get_stmt;
     sqlite3_stmt *checkpt_put_stmt;
+    sqlite3_stmt *gc_mark_stmt;
+    sqlite3_stmt *gc_sweep_stmt;
+    sqlite3_int64 gc_cursor;        // last rowid swept
+    sqlite3_int64 gc_max_rowid;     // last rowid present at gc-begin
+    int gc_deleted;
     flux_t *h;
     char *hashfun;
     int hash_size;
     size_t lzo_bufsize;
     void *lzo_buf;
+    struct decoder dec;
+    struct compress compress;
     struct content_stats stats;
+    struct store_batch batch;
+    struct load_pool pool;
+    struct bloom *bloom;        // stored hashes, NULL if disabled
+    bool bloom_enable;
+    unsigned long bloom_negatives;
     const char *journal_mode;
     const char *synchronous;
     bool truncate;
+    bool gc_active;
 };
 
+static void store_batch_commit (struct content_sqlite *ctx);
+static int bloom_rebuild (struct content_sqlite *ctx);
+
 static void log_sqlite_error (struct content_sqlite *ctx, const char *fmt, ...)
 {
     char buf[64];
@@ -102,9 +261,9 @@ static void log_sqlite_error (struct content_sqlite *ctx, const char *fmt, ...)
         flux_log (ctx->h, LOG_ERR, "%s: unknown error, no sqlite3 handle", buf);
 }
 
-static void set_errno_from_sqlite_error (struct content_sqlite *ctx)
+static void set_errno_from_sqlite_errcode (int errcode)
 {
-    switch (sqlite3_errcode (ctx->db)) {
+    switch (errcode) {
         case SQLITE_IOERR:      /* os io error */
             errno = EIO;
             break;
@@ -128,91 +287,373 @@ static void set_errno_from_sqlite_error (struct content_sqlite *ctx)
     }
 }
 
-static int grow_lzo_buf (struct content_sqlite *ctx, size_t size)
+static void set_errno_from_sqlite_error (struct content_sqlite *ctx)
+{
+    set_errno_from_sqlite_errcode (sqlite3_errcode (ctx->db));
+}
+
+static int grow_buf (void **bufp, size_t *bufsizep, size_t size)
 {
-    size_t newsize = ctx->lzo_bufsize;
+    size_t newsize = *bufsizep;
     void *newbuf;
     while (newsize < size)
         newsize += lzo_buf_chunksize;
-    if (!(newbuf = realloc (ctx->lzo_buf, newsize))) {
+    if (!(newbuf = realloc (*bufp, newsize))) {
         errno = ENOMEM;
         return -1;
     }
-    ctx->lzo_bufsize = newsize;
-    ctx->lzo_buf = newbuf;
+    *bufsizep = newsize;
+    *bufp = newbuf;
     return 0;
 }
 
-/* Load blob from objects table, uncompressing if necessary.
- * Returns 0 on success, -1 on error with errno set.
- * On successful return, must call sqlite3_reset (ctx->load_stmt),
- * which invalidates returned data.
+static int grow_lzo_buf (struct content_sqlite *ctx, size_t size)
+{
+    return grow_buf (&ctx->lzo_buf, &ctx->lzo_bufsize, size);
+}
+
+static void decoder_clear (struct decoder *dec)
+{
+    free (dec->buf);
+    dec->buf = NULL;
+    dec->bufsize = 0;
+#if HAVE_ZSTD
+    ZSTD_freeDCtx (dec->dctx);
+    dec->dctx = NULL;
+#endif
+}
+
+static void zdict_destroy (struct zdict *zd)
+{
+    if (zd) {
+        int saved_errno = errno;
+#if HAVE_ZSTD
+        ZSTD_freeDDict (zd->ddict);
+#endif
+        free (zd->data);
+        free (zd);
+        errno = saved_errno;
+    }
+}
+
+static struct zdict *zdict_create (int id, const void *data, size_t size)
+{
+    struct zdict *zd;
+
+    if (!(zd = calloc (1, sizeof (*zd)))
+        || !(zd->data = malloc (size)))
+        goto nomem;
+    memcpy (zd->data, data, size);
+    zd->size = size;
+    zd->id = id;
+#if HAVE_ZSTD
+    if (!(zd->ddict = ZSTD_createDDict (zd->data, zd->size)))
+        goto nomem;
+#endif
+    return zd;
+nomem:
+    zdict_destroy (zd);
+    errno = ENOMEM;
+    return NULL;
+}
+
+static void compress_clear (struct compress *c)
+{
+    int i;
+
+    for (i = 0; i < c->dict_count; i++)
+        zdict_destroy (c->dicts[i]);
+    free (c->dicts);
+    c->dicts = NULL;
+    c->dict_count = 0;
+#if HAVE_ZSTD
+    ZSTD_freeCDict (c->cdict);
+    c->cdict = NULL;
+    ZSTD_freeCCtx (c->cctx);
+    c->cctx = NULL;
+#endif
+}
+
+static int compress_add_dict (struct compress *c, struct zdict *zd)
+{
+    struct zdict **dicts;
+
+    pthread_mutex_lock (&c->lock);
+    dicts = realloc (c->dicts, sizeof (dicts[0]) * (c->dict_count + 1));
+    if (!dicts) {
+        pthread_mutex_unlock (&c->lock);
+        errno = ENOMEM;
+        return -1;
+    }
+    dicts[c->dict_count++] = zd;
+    c->dicts = dicts;
+    pthread_mutex_unlock (&c->lock);
+    return 0;
+}
+
+/* Return the id of the dictionary used for compression, or 0 if none.
+ * Called from the reactor thread only, so no lock is needed.
  */
-static int content_sqlite_load (struct content_sqlite *ctx,
-                                const void *hash,
-                                int hash_size,
-                                const void **datap,
-                                int *sizep)
+static int compress_dict_id (struct compress *c)
+{
+    return c->dict_count > 0 ? c->dicts[c->dict_count - 1]->id : 0;
+}
+
+#if HAVE_ZSTD
+static const ZSTD_DDict *compress_lookup_ddict (struct compress *c, int id)
+{
+    const ZSTD_DDict *ddict = NULL;
+    int i;
+
+    pthread_mutex_lock (&c->lock);
+    for (i = c->dict_count - 1; i >= 0; i--) {
+        if (c->dicts[i]->id == id) {
+            ddict = c->dicts[i]->ddict;
+            break;
+        }
+    }
+    pthread_mutex_unlock (&c->lock);
+    return ddict;
+}
+
+/* Uncompress zstd 'data' to 'dst' using dictionary 'id' (0 = none).
+ */
+static int zstd_decode (struct content_sqlite *ctx,
+                        struct decoder *dec,
+                        int id,
+                        const void *data,
+                        int size,
+                        void *dst,
+                        int dstsize,
+                        const char **errstr)
+{
+    const ZSTD_DDict *ddict = NULL;
+    size_t r;
+
+    if (!dec->dctx && !(dec->dctx = ZSTD_createDCtx ())) {
+        errno = ENOMEM;
+        return -1;
+    }
+    if (id != 0 && !(ddict = compress_lookup_ddict (&ctx->compress, id))) {
+        *errstr = "unknown compression dictionary";
+        errno = EINVAL;
+        return -1;
+    }
+    if (ddict)
+        r = ZSTD_decompress_usingDDict (dec->dctx,
+                                        dst,
+                                        dstsize,
+                                        data,
+                                        size,
+                                        ddict);
+    else
+        r = ZSTD_decompressDCtx (dec->dctx, dst, dstsize, data, size);
+    if (ZSTD_isError (r)) {
+        *errstr = ZSTD_getErrorName (r);
+        errno = EINVAL;
+        return -1;
+    }
+    return r;
+}
+#endif
+
+/* Decode the current row of a statement that selects object,size,dict,
+ * uncompressing into 'dec' if necessary.  This does not log, so it may be
+ * called from a load thread.  Returns 0 on success, -1 on error with errno
+ * set and '*errstr' set if the error should be logged.
+ */
+static int decode_row (struct content_sqlite *ctx,
+                       sqlite3_stmt *stmt,
+                       struct decoder *dec,
+                       const void **datap,
+                       int *sizep,
+                       const char **errstr)
 {
     const void *data = NULL;
     int size = 0;
     int uncompressed_size;
+    int r;
 
-    if (sqlite3_bind_text (ctx->load_stmt,
-                           1,
-                           (char *)hash,
-                           hash_size,
-                           SQLITE_STATIC) != SQLITE_OK) {
-        log_sqlite_error (ctx, "load: binding key");
-        set_errno_from_sqlite_error (ctx);
-        goto error;
-    }
-    if (sqlite3_step (ctx->load_stmt) != SQLITE_ROW) {
-        //log_sqlite_error (ctx, "load: executing stmt");
-        errno = ENOENT;
-        goto error;
-    }
-    size = sqlite3_column_bytes (ctx->load_stmt, 0);
-    if (sqlite3_column_type (ctx->load_stmt, 0) != SQLITE_BLOB && size > 0) {
-        flux_log (ctx->h, LOG_ERR, "load: selected value is not a blob");
+    size = sqlite3_column_bytes (stmt, 0);
+    if (sqlite3_column_type (stmt, 0) != SQLITE_BLOB && size > 0) {
+        *errstr = "selected value is not a blob";
         errno = EINVAL;
-        goto error;
+        return -1;
     }
-    data = sqlite3_column_blob (ctx->load_stmt, 0);
-    if (sqlite3_column_type (ctx->load_stmt, 1) != SQLITE_INTEGER) {
-        flux_log (ctx->h, LOG_ERR, "load: selected value is not an integer");
+    data = sqlite3_column_blob (stmt, 0);
+    if (sqlite3_column_type (stmt, 1) != SQLITE_INTEGER) {
+        *errstr = "selected value is not an integer";
         errno = EINVAL;
-        goto error;
+        return -1;
     }
-    uncompressed_size = sqlite3_column_int (ctx->load_stmt, 1);
+    uncompressed_size = sqlite3_column_int (stmt, 1);
     if (uncompressed_size != -1) {
-        if (ctx->lzo_bufsize < uncompressed_size
-                                && grow_lzo_buf (ctx, uncompressed_size) < 0)
-            goto error;
-        int r = LZ4_decompress_safe (data,
-                                     ctx->lzo_buf,
-                                     size,
-                                     uncompressed_size);
-        if (r < 0) {
-            errno = EINVAL;
-            goto error;
+        if (dec->bufsize < uncompressed_size
+            && grow_buf (&dec->buf, &dec->bufsize, uncompressed_size) < 0)
+            return -1;
+        if (sqlite3_column_type (stmt, 2) == SQLITE_NULL) {
+            if ((r = LZ4_decompress_safe (data,
+                                          dec->buf,
+                                          size,
+                                          uncompressed_size)) < 0) {
+                errno = EINVAL;
+                return -1;
+            }
+        }
+        else {
+#if HAVE_ZSTD
+            if ((r = zstd_decode (ctx,
+                                  dec,
+                                  sqlite3_column_int (stmt, 2),
+                                  data,
+                                  size,
+                                  dec->buf,
+                                  uncompressed_size,
+                                  errstr)) < 0)
+                return -1;
+#else
+            *errstr = "zstd compression is not supported";
+            errno = ENOTSUP;
+            return -1;
+#endif
         }
         if (r != uncompressed_size) {
-            flux_log (ctx->h, LOG_ERR, "load: blob size mismatch");
+            *errstr = "blob size mismatch";
             errno = EINVAL;
-            goto error;
+            return -1;
         }
-        data = ctx->lzo_buf;
+        data = dec->buf;
         size = uncompressed_size;
     }
     *datap = data;
     *sizep = size;
     return 0;
+}
+
+/* Load blob using prepared sql_load statement 'stmt', uncompressing into
+ * 'dec' if necessary.  This does not log, so it may be called from a
+ * load thread.  Returns 0 on success, -1 on error with errno set and
+ * '*errstr' set if the error should be logged.
+ * On successful return, must call sqlite3_reset (stmt),
+ * which invalidates returned data.
+ */
+static int load_blob (struct content_sqlite *ctx,
+                      sqlite3_stmt *stmt,
+                      struct decoder *dec,
+                      const void *hash,
+                      int hash_size,
+                      const void **datap,
+                      int *sizep,
+                      const char **errstr)
+{
+    int rc;
+
+    if ((rc = sqlite3_bind_text (stmt,
+                                 1,
+                                 (char *)hash,
+                                 hash_size,
+                                 SQLITE_STATIC)) != SQLITE_OK) {
+        *errstr = "binding key";
+        set_errno_from_sqlite_errcode (rc);
+        goto error;
+    }
+    if (sqlite3_step (stmt) != SQLITE_ROW) {
+        errno = ENOENT;
+        goto error;
+    }
+    if (decode_row (ctx, stmt, dec, datap, sizep, errstr) < 0)
+        goto error;
+    return 0;
 error:
-    ERRNO_SAFE_WRAP (sqlite3_reset, ctx->load_stmt);
+    ERRNO_SAFE_WRAP (sqlite3_reset, stmt);
     return -1;
 }
 
+/* Load blob from objects table, uncompressing if necessary.
+ * Returns 0 on success, -1 on error with errno set.
+ * On successful return, must call sqlite3_reset (ctx->load_stmt),
+ * which invalidates returned data.
+ */
+static int content_sqlite_load (struct content_sqlite *ctx,
+                                const void *hash,
+                                int hash_size,
+                                const void **datap,
+                                int *sizep)
+{
+    const char *errstr = NULL;
+
+    if (load_blob (ctx,
+                   ctx->load_stmt,
+                   &ctx->dec,
+                   hash,
+                   hash_size,
+                   datap,
+                   sizep,
+                   &errstr) < 0) {
+        if (errstr)
+            flux_log (ctx->h, LOG_ERR, "load: %s", errstr);
+        return -1;
+    }
+    return 0;
+}
+
+#if HAVE_ZSTD
+/* Compress 'data' to ctx->lzo_buf with zstd, using the most recently
+ * trained dictionary, if any.  Set '*dict_id' to its id (0 = none).
+ * Returns compressed size on success, -1 on error with errno set.
+ */
+static int zstd_encode (struct content_sqlite *ctx,
+                        const void *data,
+                        int size,
+                        int *dict_id)
+{
+    struct compress *c = &ctx->compress;
+    size_t bound = ZSTD_compressBound (size);
+    int id = compress_dict_id (c);
+    size_t r;
+
+    if (ctx->lzo_bufsize < bound && grow_lzo_buf (ctx, bound) < 0)
+        return -1;
+    if (!c->cctx && !(c->cctx = ZSTD_createCCtx ())) {
+        errno = ENOMEM;
+        return -1;
+    }
+    if (id > 0 && (!c->cdict
+                   || c->cdict_id != id
+                   || c->cdict_level != c->level)) {
+        struct zdict *zd = c->dicts[c->dict_count - 1];
+        ZSTD_freeCDict (c->cdict);
+        if (!(c->cdict = ZSTD_createCDict (zd->data, zd->size, c->level))) {
+            errno = ENOMEM;
+            return -1;
+        }
+        c->cdict_id = id;
+        c->cdict_level = c->level;
+    }
+    if (id > 0)
+        r = ZSTD_compress_usingCDict (c->cctx,
+                                      ctx->lzo_buf,
+                                      ctx->lzo_bufsize,
+                                      data,
+                                      size,
+                                      c->cdict);
+    else
+        r = ZSTD_compressCCtx (c->cctx,
+                               ctx->lzo_buf,
+                               ctx->lzo_bufsize,
+                               data,
+                               size,
+                               c->level);
+    if (ZSTD_isError (r)) {
+        flux_log (ctx->h, LOG_ERR, "store: %s", ZSTD_getErrorName (r));
+        errno = EINVAL;
+        return -1;
+    }
+    *dict_id = id;
+    return r;
+}
+#endif
+
 /* Store blob to objects table, compressing if necessary.
  * hash over 'data' is stored to 'hash'.
  * Returns hash size on success, -1 on error with errno set.
@@ -224,6 +665,7 @@ static int content_sqlite_store (struct content_sqlite *ctx,
                                  int hash_len)
 {
     int uncompressed_size = -1;
+    int dict_id = -1;
     int hash_size;
 
     if ((hash_size = blobref_hash_raw (ctx->hashfun,
@@ -233,7 +675,25 @@ static int content_sqlite_store (struct content_sqlite *ctx,
                                        hash_len)) < 0)
         return -1;
     assert (hash_size == ctx->hash_size);
-    if (size >= compression_threshold) {
+#if HAVE_ZSTD
+    if (size >= ctx->compress.threshold
+        && ctx->compress.method == COMPRESS_ZSTD) {
+        int r;
+        if ((r = zstd_encode (ctx, data, size, &dict_id)) < 0)
+            return -1;
+        /* Small blobs may not compress.  Store them as is.
+         */
+        if (r < size) {
+            uncompressed_size = size;
+            size = r;
+            data = ctx->lzo_buf;
+        }
+        else
+            dict_id = -1;
+    }
+    else
+#endif
+    if (size >= ctx->compress.threshold) {
         int r;
         int out_len = LZ4_compressBound(size);
         if (ctx->lzo_bufsize < out_len && grow_lzo_buf (ctx, out_len) < 0)
@@ -272,6 +732,12 @@ static int content_sqlite_store (struct content_sqlite *ctx,
         set_errno_from_sqlite_error (ctx);
         goto error;
     }
+    if ((dict_id >= 0 ? sqlite3_bind_int (ctx->store_stmt, 4, dict_id)
+                      : sqlite3_bind_null (ctx->store_stmt, 4)) != SQLITE_OK) {
+        log_sqlite_error (ctx, "store: binding dict");
+        set_errno_from_sqlite_error (ctx);
+        goto error;
+    }
     /* N.B. ignore SQLITE_CONSTRAINT errors - it means the insert failed
      * because it violated the implicit primary key uniqueness constraint.
      * Blob and blobref are indeed stored and storage is conserved - success!
@@ -283,63 +749,364 @@ static int content_sqlite_store (struct content_sqlite *ctx,
         goto error;
     }
     sqlite3_reset (ctx->store_stmt);
+    if (ctx->bloom && !bloom_check (ctx->bloom, hash, hash_size)) {
+        bloom_add (ctx->bloom, hash, hash_size);
+        if (bloom_count (ctx->bloom) > bloom_capacity (ctx->bloom))
+            (void)bloom_rebuild (ctx);
+    }
     return hash_size;
 error:
     ERRNO_SAFE_WRAP (sqlite3_reset, ctx->store_stmt);
     return -1;
 }
 
-static void load_cb (flux_t *h,
-                     flux_msg_handler_t *mh,
-                     const flux_msg_t *msg,
-                     void *arg)
+/* Mark a blob as reachable during garbage collection.
+ */
+static int content_sqlite_gc_mark (struct content_sqlite *ctx,
+                                   const void *hash,
+                                   int hash_size)
 {
-    struct content_sqlite *ctx = arg;
-    const void *hash;
-    int hash_size;
-    const void *data;
-    int size;
-    struct timespec t0;
-
-    if (flux_request_decode_raw (msg,
-                                 NULL,
-                                 &hash,
-                                 &hash_size) < 0)
-        goto error;
-    if (hash_size != ctx->hash_size) {
-        errno = EPROTO;
+    if (sqlite3_bind_text (ctx->gc_mark_stmt,
+                           1,
+                           (char *)hash,
+                           hash_size,
+                           SQLITE_STATIC) != SQLITE_OK) {
+        log_sqlite_error (ctx, "gc-mark: binding key");
+        set_errno_from_sqlite_error (ctx);
         goto error;
     }
-    monotime (&t0);
-    if (content_sqlite_load (ctx, hash, hash_size, &data, &size) < 0)
+    if (sqlite3_step (ctx->gc_mark_stmt) != SQLITE_DONE) {
+        log_sqlite_error (ctx, "gc-mark: executing stmt");
+        set_errno_from_sqlite_error (ctx);
         goto error;
-    tstat_push (&ctx->stats.load, monotime_since (t0));
-    if (flux_respond_raw (h, msg, data, size) < 0)
-        flux_log_error (h, "load: flux_respond_raw");
-    (void )sqlite3_reset (ctx->load_stmt);
-    return;
+    }
+    sqlite3_reset (ctx->gc_mark_stmt);
+    return 0;
 error:
-    if (flux_respond_error (h, msg, errno, NULL) < 0)
-        flux_log_error (h, "load: flux_respond_error");
+    ERRNO_SAFE_WRAP (sqlite3_reset, ctx->gc_mark_stmt);
+    return -1;
 }
 
-void store_cb (flux_t *h,
-               flux_msg_handler_t *mh,
-               const flux_msg_t *msg,
-               void *arg)
-{
-    struct content_sqlite *ctx = arg;
-    const void *data;
-    int size;
-    uint8_t hash[BLOBREF_MAX_DIGEST_SIZE];
+/* A load request that is run by a load thread.  Only load_work() runs
+ * in the thread, and it must not touch the flux handle or the main
+ * database connection.  The blob is copied out of the reader's buffer
+ * so that the reader may be returned to the pool before the response
+ * is sent from the reactor thread.
+ */
+struct load_request {
+    struct content_sqlite *ctx;
+    const flux_msg_t *msg;
+    const void *hash;
     int hash_size;
-    struct timespec t0;
+    void *data;
+    int size;
+    int errnum;
+    const char *errstr;
+    double t;
+};
 
-    if (flux_request_decode_raw (msg, NULL, &data, &size) < 0) {
-        flux_log_error (h, "store: request decode failed");
-        goto error;
-    }
-    monotime (&t0);
+static void load_request_destroy (struct load_request *req)
+{
+    if (req) {
+        int saved_errno = errno;
+        flux_msg_decref (req->msg);
+        free (req->data);
+        free (req);
+        errno = saved_errno;
+    }
+}
+
+static struct reader *load_pool_get_reader (struct load_pool *pool)
+{
+    struct reader *r;
+
+    pthread_mutex_lock (&pool->lock);
+    assert (pool->idle_count > 0); // there are as many readers as threads
+    r = pool->idle[--pool->idle_count];
+    pthread_mutex_unlock (&pool->lock);
+    return r;
+}
+
+static void load_pool_put_reader (struct load_pool *pool, struct reader *r)
+{
+    pthread_mutex_lock (&pool->lock);
+    pool->idle[pool->idle_count++] = r;
+    pthread_mutex_unlock (&pool->lock);
+}
+
+static void load_work (void *arg)
+{
+    struct load_request *req = arg;
+    struct reader *r = load_pool_get_reader (&req->ctx->pool);
+    const void *data;
+    struct timespec t0;
+
+    monotime (&t0);
+    if (load_blob (req->ctx,
+                   r->load_stmt,
+                   &r->dec,
+                   req->hash,
+                   req->hash_size,
+                   &data,
+                   &req->size,
+                   &req->errstr) < 0) {
+        req->errnum = errno;
+        goto done;
+    }
+    if (req->size > 0) {
+        if (!(req->data = malloc (req->size)))
+            req->errnum = ENOMEM;
+        else
+            memcpy (req->data, data, req->size);
+    }
+    (void)sqlite3_reset (r->load_stmt);
+done:
+    req->t = monotime_since (t0);
+    load_pool_put_reader (&req->ctx->pool, r);
+}
+
+static void load_done (void *arg)
+{
+    struct load_request *req = arg;
+    struct content_sqlite *ctx = req->ctx;
+    flux_t *h = ctx->h;
+    const void *data;
+    int size;
+
+    if (req->errnum == 0) {
+        tstat_push (&ctx->stats.load, req->t);
+        if (flux_respond_raw (h, req->msg, req->data, req->size) < 0)
+            flux_log_error (h, "load: flux_respond_raw");
+    }
+    /* The blob may be waiting for the next group commit, which is not
+     * yet visible to readers.  Commit and retry on the main connection.
+     */
+    else if (req->errnum == ENOENT
+             && flux_msglist_count (ctx->batch.requests) > 0) {
+        store_batch_commit (ctx);
+        if (content_sqlite_load (ctx,
+                                 req->hash,
+                                 req->hash_size,
+                                 &data,
+                                 &size) < 0) {
+            if (flux_respond_error (h, req->msg, errno, NULL) < 0)
+                flux_log_error (h, "load: flux_respond_error");
+        }
+        else {
+            if (flux_respond_raw (h, req->msg, data, size) < 0)
+                flux_log_error (h, "load: flux_respond_raw");
+            (void )sqlite3_reset (ctx->load_stmt);
+        }
+    }
+    else {
+        if (req->errstr)
+            flux_log (h, LOG_ERR, "load: %s", req->errstr);
+        if (flux_respond_error (h, req->msg, req->errnum, NULL) < 0)
+            flux_log_error (h, "load: flux_respond_error");
+    }
+    load_request_destroy (req);
+}
+
+static int load_pool_submit (struct content_sqlite *ctx,
+                             const flux_msg_t *msg,
+                             const void *hash,
+                             int hash_size)
+{
+    struct load_request *req;
+
+    if (!(req = calloc (1, sizeof (*req))))
+        return -1;
+    req->ctx = ctx;
+    req->msg = flux_msg_incref (msg);
+    req->hash = hash;
+    req->hash_size = hash_size;
+    if (workpool_submit (ctx->pool.wp, load_work, load_done, req) < 0) {
+        load_request_destroy (req);
+        return -1;
+    }
+    return 0;
+}
+
+static void load_cb (flux_t *h,
+                     flux_msg_handler_t *mh,
+                     const flux_msg_t *msg,
+                     void *arg)
+{
+    struct content_sqlite *ctx = arg;
+    const void *hash;
+    int hash_size;
+    const void *data;
+    int size;
+    struct timespec t0;
+
+    if (flux_request_decode_raw (msg,
+                                 NULL,
+                                 &hash,
+                                 &hash_size) < 0)
+        goto error;
+    if (hash_size != ctx->hash_size) {
+        errno = EPROTO;
+        goto error;
+    }
+    /* Answer definite misses without a database lookup.  Batched stores
+     * are not added to the filter until they are committed.
+     */
+    if (!bloom_check (ctx->bloom, hash, hash_size)
+        && flux_msglist_count (ctx->batch.requests) == 0) {
+        ctx->bloom_negatives++;
+        errno = ENOENT;
+        goto error;
+    }
+    if (ctx->pool.wp) {
+        if (load_pool_submit (ctx, msg, hash, hash_size) < 0)
+            goto error;
+        return;
+    }
+    monotime (&t0);
+    if (content_sqlite_load (ctx, hash, hash_size, &data, &size) < 0) {
+        /* The blob may be waiting for the next group commit.
+         */
+        if (errno != ENOENT || flux_msglist_count (ctx->batch.requests) == 0)
+            goto error;
+        store_batch_commit (ctx);
+        if (content_sqlite_load (ctx, hash, hash_size, &data, &size) < 0)
+            goto error;
+    }
+    tstat_push (&ctx->stats.load, monotime_since (t0));
+    if (flux_respond_raw (h, msg, data, size) < 0)
+        flux_log_error (h, "load: flux_respond_raw");
+    (void )sqlite3_reset (ctx->load_stmt);
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        flux_log_error (h, "load: flux_respond_error");
+}
+
+/* Store the blobs of all batched store requests in one transaction, then
+ * respond to the requests.  If a store or the commit fails, the transaction
+ * is rolled back and all requests receive the error.
+ */
+static void store_batch_commit (struct content_sqlite *ctx)
+{
+    struct store_batch *batch = &ctx->batch;
+    int count = flux_msglist_count (batch->requests);
+    uint8_t *hashes = NULL;
+    const flux_msg_t *msg;
+    int errnum;
+    int i;
+
+    flux_watcher_stop (batch->timer);
+    if (count == 0)
+        return;
+    if (!(hashes = malloc (count * ctx->hash_size)))
+        goto error;
+    if (sqlite3_exec (ctx->db, "BEGIN", NULL, NULL, NULL) != SQLITE_OK) {
+        log_sqlite_error (ctx, "store: begin transaction");
+        set_errno_from_sqlite_error (ctx);
+        goto error;
+    }
+    i = 0;
+    msg = flux_msglist_first (batch->requests);
+    while (msg) {
+        uint8_t *hash = hashes + i++ * ctx->hash_size;
+        const void *data;
+        int size;
+        struct timespec t0;
+
+        if (flux_request_decode_raw (msg, NULL, &data, &size) < 0)
+            goto error_rollback;
+        monotime (&t0);
+        if (content_sqlite_store (ctx, data, size, hash, ctx->hash_size) < 0)
+            goto error_rollback;
+        tstat_push (&ctx->stats.store, monotime_since (t0));
+        if (ctx->gc_active
+            && content_sqlite_gc_mark (ctx, hash, ctx->hash_size) < 0)
+            goto error_rollback;
+        msg = flux_msglist_next (batch->requests);
+    }
+    if (sqlite3_exec (ctx->db, "COMMIT", NULL, NULL, NULL) != SQLITE_OK) {
+        log_sqlite_error (ctx, "store: commit transaction");
+        set_errno_from_sqlite_error (ctx);
+        goto error_rollback;
+    }
+    tstat_push (&ctx->stats.batch, count);
+    i = 0;
+    while ((msg = flux_msglist_pop (batch->requests))) {
+        if (flux_respond_raw (ctx->h,
+                              msg,
+                              hashes + i++ * ctx->hash_size,
+                              ctx->hash_size) < 0)
+            flux_log_error (ctx->h, "store: flux_respond_raw");
+        flux_msg_decref (msg);
+    }
+    batch->size = 0;
+    free (hashes);
+    return;
+error_rollback:
+    ERRNO_SAFE_WRAP (sqlite3_exec, ctx->db, "ROLLBACK", NULL, NULL, NULL);
+error:
+    errnum = errno;
+    while ((msg = flux_msglist_pop (batch->requests))) {
+        if (flux_respond_error (ctx->h, msg, errnum, NULL) < 0)
+            flux_log_error (ctx->h, "store: flux_respond_error");
+        flux_msg_decref (msg);
+    }
+    batch->size = 0;
+    free (hashes);
+}
+
+static void store_batch_timer_cb (flux_reactor_t *r,
+                                  flux_watcher_t *w,
+                                  int revents,
+                                  void *arg)
+{
+    store_batch_commit (arg);
+}
+
+/* Queue a store request for the next group commit.  The batch is
+ * committed when its timeout expires, or sooner if it is full.
+ */
+static int store_batch_append (struct content_sqlite *ctx,
+                               const flux_msg_t *msg,
+                               int size)
+{
+    struct store_batch *batch = &ctx->batch;
+
+    if (flux_msglist_append (batch->requests, msg) < 0)
+        return -1;
+    batch->size += size;
+    if (flux_msglist_count (batch->requests) >= batch->max_count
+        || batch->size >= batch->max_size)
+        store_batch_commit (ctx);
+    else if (flux_msglist_count (batch->requests) == 1) {
+        flux_timer_watcher_reset (batch->timer, batch->timeout, 0.);
+        flux_watcher_start (batch->timer);
+    }
+    return 0;
+}
+
+void store_cb (flux_t *h,
+               flux_msg_handler_t *mh,
+               const flux_msg_t *msg,
+               void *arg)
+{
+    struct content_sqlite *ctx = arg;
+    const void *data;
+    int size;
+    uint8_t hash[BLOBREF_MAX_DIGEST_SIZE];
+    int hash_size;
+    struct timespec t0;
+
+    if (flux_request_decode_raw (msg, NULL, &data, &size) < 0) {
+        flux_log_error (h, "store: request decode failed");
+        goto error;
+    }
+    if (ctx->batch.timeout > 0.) {
+        if (store_batch_append (ctx, msg, size) < 0)
+            goto error;
+        return;
+    }
+    monotime (&t0);
     if ((hash_size = content_sqlite_store (ctx,
                                            data,
                                            size,
@@ -347,6 +1114,8 @@ void store_cb (flux_t *h,
                                            sizeof (hash))) < 0)
         goto error;
     tstat_push (&ctx->stats.store, monotime_since (t0));
+    if (ctx->gc_active && content_sqlite_gc_mark (ctx, hash, hash_size) < 0)
+        goto error;
     if (flux_respond_raw (h, msg, hash, hash_size) < 0)
         flux_log_error (h, "store: flux_respond_raw");
     return;
@@ -355,132 +1124,619 @@ error:
         flux_log_error (h, "store: flux_respond_error");
 }
 
-void checkpoint_get_cb (flux_t *h,
-                        flux_msg_handler_t *mh,
-                        const flux_msg_t *msg,
-                        void *arg)
+void checkpoint_get_cb (flux_t *h,
+                        flux_msg_handler_t *mh,
+                        const flux_msg_t *msg,
+                        void *arg)
+{
+    struct content_sqlite *ctx = arg;
+    const char *key;
+    char *s;
+    json_t *o = NULL;
+    const char *errstr = NULL;
+    json_error_t error;
+
+    if (flux_request_unpack (msg, NULL, "{s:s}", "key", &key) < 0)
+        goto error;
+    if (sqlite3_bind_text (ctx->checkpt_get_stmt,
+                           1,
+                           (char *)key,
+                           strlen (key),
+                           SQLITE_STATIC) != SQLITE_OK) {
+        log_sqlite_error (ctx, "checkpt_get: binding key");
+        set_errno_from_sqlite_error (ctx);
+        goto error;
+    }
+    if (sqlite3_step (ctx->checkpt_get_stmt) != SQLITE_ROW) {
+        errno = ENOENT;
+        goto error;
+    }
+    s = (char *)sqlite3_column_text (ctx->checkpt_get_stmt, 0);
+    if (!(o = json_loads (s, 0, &error))) {
+        if (blobref_validate (s) < 0) {
+            errstr = error.text;
+            errno = EINVAL;
+            goto error;
+        }
+        /* assume "version 0" if value is a bare blobref and return it
+         * in a json envelope */
+        if (!(o = json_pack ("{s:i s:s s:i s:f}",
+                             "version", 0,
+                             "rootref", s,
+                             "sequence", 0,
+                             "timestamp", 0.))) {
+            errstr = "failed to encode blobref in json envelope";
+            errno = EINVAL;
+            goto error;
+        }
+    }
+    if (flux_respond_pack (h,
+                           msg,
+                           "{s:O}",
+                           "value",
+                           o) < 0)
+        flux_log_error (h, "flux_respond_pack");
+    (void )sqlite3_reset (ctx->checkpt_get_stmt);
+    json_decref (o);
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, errstr) < 0)
+        flux_log_error (h, "flux_respond_error");
+    (void )sqlite3_reset (ctx->checkpt_get_stmt);
+    json_decref (o);
+}
+
+void checkpoint_put_cb (flux_t *h,
+                        flux_msg_handler_t *mh,
+                        const flux_msg_t *msg,
+                        void *arg)
+{
+    struct content_sqlite *ctx = arg;
+    const char *key;
+    json_t *o;
+    char *value = NULL;
+    const char *errstr = NULL;
+
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s:s s:o}",
+                             "key",
+                             &key,
+                             "value",
+                             &o) < 0)
+        goto error;
+    /* Commit batched stores first, so the checkpoint cannot reference
+     * blobs that are not yet in the database.
+     */
+    store_batch_commit (ctx);
+    if (!(value = json_dumps (o, JSON_COMPACT))) {
+        errstr = "failed to encode checkpoint value";
+        errno = EINVAL;
+        goto error;
+    }
+    if (sqlite3_bind_text (ctx->checkpt_put_stmt,
+                           1,
+                           (char *)key,
+                           strlen (key),
+                           SQLITE_STATIC) != SQLITE_OK) {
+        log_sqlite_error (ctx, "checkpt_put: binding key");
+        set_errno_from_sqlite_error (ctx);
+        goto error;
+    }
+    if (sqlite3_bind_text (ctx->checkpt_put_stmt,
+                           2,
+                           value,
+                           strlen (value),
+                           SQLITE_STATIC) != SQLITE_OK) {
+        log_sqlite_error (ctx, "checkpt_put: binding value");
+        set_errno_from_sqlite_error (ctx);
+        goto error;
+    }
+    if (sqlite3_step (ctx->checkpt_put_stmt) != SQLITE_DONE
+                    && sqlite3_errcode (ctx->db) != SQLITE_CONSTRAINT) {
+        log_sqlite_error (ctx, "checkpt_put: executing stmt");
+        set_errno_from_sqlite_error (ctx);
+        goto error;
+    }
+    if (flux_respond (h, msg, NULL) < 0)
+        flux_log_error (h, "flux_respond");
+    (void )sqlite3_reset (ctx->checkpt_put_stmt);
+    free (value);
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, errstr) < 0)
+        flux_log_error (h, "flux_respond_error");
+    (void )sqlite3_reset (ctx->checkpt_put_stmt);
+    free (value);
+}
+
+static void content_sqlite_gc_finalize (struct content_sqlite *ctx)
+{
+    if (ctx->gc_mark_stmt) {
+        if (sqlite3_finalize (ctx->gc_mark_stmt) != SQLITE_OK)
+            log_sqlite_error (ctx, "sqlite_finalize gc_mark_stmt");
+        ctx->gc_mark_stmt = NULL;
+    }
+    if (ctx->gc_sweep_stmt) {
+        if (sqlite3_finalize (ctx->gc_sweep_stmt) != SQLITE_OK)
+            log_sqlite_error (ctx, "sqlite_finalize gc_sweep_stmt");
+        ctx->gc_sweep_stmt = NULL;
+    }
+    ctx->gc_active = false;
+}
+
+/* sqlite3_exec() callback from sql_gc_max_rowid query.
+ */
+static int set_rowid (void *arg, int ncols, char **cols, char **col_names)
+{
+    sqlite3_int64 *result = arg;
+
+    if (ncols != 1 || !cols[0])
+        return -1;
+    errno = 0;
+    *result = strtoll (cols[0], NULL, 10);
+    return errno == 0 ? 0 : -1;
+}
+
+/* Begin garbage collection.  Until gc-end, blobs that are marked with
+ * gc-mark or stored are protected from gc-sweep.  Blobs stored after
+ * gc-begin are never swept.
+ */
+void gc_begin_cb (flux_t *h,
+                  flux_msg_handler_t *mh,
+                  const flux_msg_t *msg,
+                  void *arg)
+{
+    struct content_sqlite *ctx = arg;
+
+    if (flux_request_decode (msg, NULL, NULL) < 0)
+        goto error;
+    content_sqlite_gc_finalize (ctx);
+    if (sqlite3_exec (ctx->db,
+                      sql_gc_create_table,
+                      NULL,
+                      NULL,
+                      NULL) != SQLITE_OK) {
+        log_sqlite_error (ctx, "gc-begin: creating gcmark table");
+        goto error_sqlite;
+    }
+    if (sqlite3_exec (ctx->db,
+                      sql_gc_max_rowid,
+                      set_rowid,
+                      &ctx->gc_max_rowid,
+                      NULL) != SQLITE_OK) {
+        log_sqlite_error (ctx, "gc-begin: querying max rowid");
+        goto error_sqlite;
+    }
+    if (sqlite3_prepare_v2 (ctx->db,
+                            sql_gc_mark,
+                            -1,
+                            &ctx->gc_mark_stmt,
+                            NULL) != SQLITE_OK) {
+        log_sqlite_error (ctx, "preparing gc_mark stmt");
+        goto error_sqlite;
+    }
+    if (sqlite3_prepare_v2 (ctx->db,
+                            sql_gc_sweep,
+                            -1,
+                            &ctx->gc_sweep_stmt,
+                            NULL) != SQLITE_OK) {
+        log_sqlite_error (ctx, "preparing gc_sweep stmt");
+        goto error_sqlite;
+    }
+    ctx->gc_cursor = 0;
+    ctx->gc_deleted = 0;
+    ctx->gc_active = true;
+    if (flux_respond (h, msg, NULL) < 0)
+        flux_log_error (h, "gc-begin: flux_respond");
+    return;
+error_sqlite:
+    set_errno_from_sqlite_error (ctx);
+    content_sqlite_gc_finalize (ctx);
+error:
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        flux_log_error (h, "gc-begin: flux_respond_error");
+}
+
+/* Mark blobs as reachable.  The request payload is a sequence of
+ * hash digests.
+ */
+void gc_mark_cb (flux_t *h,
+                 flux_msg_handler_t *mh,
+                 const flux_msg_t *msg,
+                 void *arg)
+{
+    struct content_sqlite *ctx = arg;
+    const uint8_t *hashes;
+    int len;
+    int offset;
+
+    if (flux_request_decode_raw (msg, NULL, (const void **)&hashes, &len) < 0)
+        goto error;
+    if (!ctx->gc_active) {
+        errno = EINVAL;
+        goto error;
+    }
+    if (len % ctx->hash_size != 0) {
+        errno = EPROTO;
+        goto error;
+    }
+    for (offset = 0; offset < len; offset += ctx->hash_size) {
+        if (content_sqlite_gc_mark (ctx,
+                                    hashes + offset,
+                                    ctx->hash_size) < 0)
+            goto error;
+    }
+    if (flux_respond (h, msg, NULL) < 0)
+        flux_log_error (h, "gc-mark: flux_respond");
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        flux_log_error (h, "gc-mark: flux_respond_error");
+}
+
+/* Delete unmarked blobs among the next 'count' objects present at
+ * gc-begin.  The response indicates how many were deleted, and whether
+ * the sweep is complete.
+ */
+void gc_sweep_cb (flux_t *h,
+                  flux_msg_handler_t *mh,
+                  const flux_msg_t *msg,
+                  void *arg)
+{
+    struct content_sqlite *ctx = arg;
+    sqlite3_int64 end;
+    int count;
+    int deleted;
+
+    if (flux_request_unpack (msg, NULL, "{s:i}", "count", &count) < 0)
+        goto error;
+    if (!ctx->gc_active || count <= 0) {
+        errno = EINVAL;
+        goto error;
+    }
+    end = ctx->gc_cursor + count;
+    if (end > ctx->gc_max_rowid)
+        end = ctx->gc_max_rowid;
+    if (sqlite3_bind_int64 (ctx->gc_sweep_stmt,
+                            1,
+                            ctx->gc_cursor) != SQLITE_OK
+        || sqlite3_bind_int64 (ctx->gc_sweep_stmt, 2, end) != SQLITE_OK) {
+        log_sqlite_error (ctx, "gc-sweep: binding rowid");
+        set_errno_from_sqlite_error (ctx);
+        goto error_reset;
+    }
+    if (sqlite3_step (ctx->gc_sweep_stmt) != SQLITE_DONE) {
+        log_sqlite_error (ctx, "gc-sweep: executing stmt");
+        set_errno_from_sqlite_error (ctx);
+        goto error_reset;
+    }
+    deleted = sqlite3_changes (ctx->db);
+    sqlite3_reset (ctx->gc_sweep_stmt);
+    ctx->gc_cursor = end;
+    ctx->gc_deleted += deleted;
+    if (flux_respond_pack (h,
+                           msg,
+                           "{s:i s:b}",
+                           "deleted", deleted,
+                           "done", ctx->gc_cursor >= ctx->gc_max_rowid) < 0)
+        flux_log_error (h, "gc-sweep: flux_respond_pack");
+    return;
+error_reset:
+    ERRNO_SAFE_WRAP (sqlite3_reset, ctx->gc_sweep_stmt);
+error:
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        flux_log_error (h, "gc-sweep: flux_respond_error");
+}
+
+/* End garbage collection and discard marks.
+ */
+void gc_end_cb (flux_t *h,
+                flux_msg_handler_t *mh,
+                const flux_msg_t *msg,
+                void *arg)
+{
+    struct content_sqlite *ctx = arg;
+
+    if (flux_request_decode (msg, NULL, NULL) < 0)
+        goto error;
+    if (!ctx->gc_active) {
+        errno = EINVAL;
+        goto error;
+    }
+    flux_log (h,
+              LOG_DEBUG,
+              "gc: deleted %d objects",
+              ctx->gc_deleted);
+    /* Drop deleted hashes from the bloom filter.
+     */
+    if (ctx->bloom && ctx->gc_deleted > 0)
+        (void)bloom_rebuild (ctx);
+    content_sqlite_gc_finalize (ctx);
+    if (sqlite3_exec (ctx->db,
+                      sql_gc_drop_table,
+                      NULL,
+                      NULL,
+                      NULL) != SQLITE_OK) {
+        log_sqlite_error (ctx, "gc-end: dropping gcmark table");
+        set_errno_from_sqlite_error (ctx);
+        goto error;
+    }
+    if (flux_respond (h, msg, NULL) < 0)
+        flux_log_error (h, "gc-end: flux_respond");
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        flux_log_error (h, "gc-end: flux_respond_error");
+}
+
+#if HAVE_ZSTD
+/* Sample up to 'count' objects and train a zstd dictionary of up to
+ * 'capacity' bytes from them.  On success, return the new dictionary,
+ * not yet saved, and set '*samplesp' to the number of samples used.
+ */
+static struct zdict *train_dict (struct content_sqlite *ctx,
+                                 int count,
+                                 size_t capacity,
+                                 int *samplesp,
+                                 const char **errstr)
+{
+    sqlite3_stmt *stmt = NULL;
+    char *samples = NULL;
+    size_t *sizes = NULL;
+    size_t total = 0;
+    int n = 0;
+    void *dict = NULL;
+    struct zdict *zd = NULL;
+    size_t r;
+
+    if (sqlite3_prepare_v2 (ctx->db,
+                            sql_dict_samples,
+                            -1,
+                            &stmt,
+                            NULL) != SQLITE_OK
+        || sqlite3_bind_int (stmt, 1, count) != SQLITE_OK) {
+        log_sqlite_error (ctx, "dict-train: preparing sample stmt");
+        set_errno_from_sqlite_error (ctx);
+        goto done;
+    }
+    if (!(sizes = calloc (count, sizeof (sizes[0]))))
+        goto done;
+    while (n < count && sqlite3_step (stmt) == SQLITE_ROW) {
+        const void *data;
+        int size;
+        char *p;
+
+        if (decode_row (ctx, stmt, &ctx->dec, &data, &size, errstr) < 0)
+            goto done;
+        if (size == 0)
+            continue;
+        if (!(p = realloc (samples, total + size)))
+            goto done;
+        samples = p;
+        memcpy (samples + total, data, size);
+        sizes[n++] = size;
+        total += size;
+    }
+    if (n == 0) {
+        *errstr = "there are no objects to sample";
+        errno = EINVAL;
+        goto done;
+    }
+    if (!(dict = malloc (capacity)))
+        goto done;
+    r = ZDICT_trainFromBuffer (dict, capacity, samples, sizes, n);
+    if (ZDICT_isError (r)) {
+        *errstr = ZDICT_getErrorName (r);
+        errno = EINVAL;
+        goto done;
+    }
+    if (!(zd = zdict_create (0, dict, r)))
+        goto done;
+    *samplesp = n;
+done:
+    ERRNO_SAFE_WRAP (sqlite3_finalize, stmt);
+    ERRNO_SAFE_WRAP (free, samples);
+    ERRNO_SAFE_WRAP (free, sizes);
+    ERRNO_SAFE_WRAP (free, dict);
+    return zd;
+}
+
+/* Save dictionary to the dicts table and set zd->id.
+ */
+static int save_dict (struct content_sqlite *ctx, struct zdict *zd)
+{
+    sqlite3_stmt *stmt = NULL;
+
+    if (sqlite3_prepare_v2 (ctx->db,
+                            sql_dict_put,
+                            -1,
+                            &stmt,
+                            NULL) != SQLITE_OK
+        || sqlite3_bind_blob (stmt,
+                              1,
+                              zd->data,
+                              zd->size,
+                              SQLITE_STATIC) != SQLITE_OK
+        || sqlite3_step (stmt) != SQLITE_DONE) {
+        log_sqlite_error (ctx, "saving compression dictionary");
+        set_errno_from_sqlite_error (ctx);
+        ERRNO_SAFE_WRAP (sqlite3_finalize, stmt);
+        return -1;
+    }
+    sqlite3_finalize (stmt);
+    zd->id = sqlite3_last_insert_rowid (ctx->db);
+    return 0;
+}
+#endif
+
+/* Train a zstd dictionary from a random sample of stored objects and use
+ * it for subsequent zstd compression.  Earlier dictionaries are retained
+ * so that objects compressed with them can still be loaded.
+ * N.B. this runs synchronously and may take some time on a large database.
+ */
+void dict_train_cb (flux_t *h,
+                    flux_msg_handler_t *mh,
+                    const flux_msg_t *msg,
+                    void *arg)
 {
     struct content_sqlite *ctx = arg;
-    const char *key;
-    char *s;
-    json_t *o = NULL;
+    int count = default_dict_samples;
+    int capacity = default_dict_size;
     const char *errstr = NULL;
-    json_error_t error;
+#if HAVE_ZSTD
+    struct zdict *zd;
+    int samples = 0;
+#endif
 
-    if (flux_request_unpack (msg, NULL, "{s:s}", "key", &key) < 0)
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s?i s?i}",
+                             "samples", &count,
+                             "size", &capacity) < 0)
         goto error;
-    if (sqlite3_bind_text (ctx->checkpt_get_stmt,
-                           1,
-                           (char *)key,
-                           strlen (key),
-                           SQLITE_STATIC) != SQLITE_OK) {
-        log_sqlite_error (ctx, "checkpt_get: binding key");
-        set_errno_from_sqlite_error (ctx);
+    if (count < 1 || capacity < 256) {
+        errstr = "samples must be > 0 and size must be >= 256";
+        errno = EPROTO;
         goto error;
     }
-    if (sqlite3_step (ctx->checkpt_get_stmt) != SQLITE_ROW) {
-        errno = ENOENT;
+    /* Include batched stores in the sample.
+     */
+    store_batch_commit (ctx);
+#if HAVE_ZSTD
+    if (!(zd = train_dict (ctx, count, capacity, &samples, &errstr)))
+        goto error;
+    if (save_dict (ctx, zd) < 0 || compress_add_dict (&ctx->compress, zd) < 0) {
+        zdict_destroy (zd);
         goto error;
     }
-    s = (char *)sqlite3_column_text (ctx->checkpt_get_stmt, 0);
-    if (!(o = json_loads (s, 0, &error))) {
-        if (blobref_validate (s) < 0) {
-            errstr = error.text;
-            errno = EINVAL;
-            goto error;
-        }
-        /* assume "version 0" if value is a bare blobref and return it
-         * in a json envelope */
-        if (!(o = json_pack ("{s:i s:s s:i s:f}",
-                             "version", 0,
-                             "rootref", s,
-                             "sequence", 0,
-                             "timestamp", 0.))) {
-            errstr = "failed to encode blobref in json envelope";
-            errno = EINVAL;
-            goto error;
-        }
-    }
+    flux_log (h,
+              LOG_INFO,
+              "trained compression dictionary %d (%zu bytes, %d samples)",
+              zd->id,
+              zd->size,
+              samples);
     if (flux_respond_pack (h,
                            msg,
-                           "{s:O}",
-                           "value",
-                           o) < 0)
-        flux_log_error (h, "flux_respond_pack");
-    (void )sqlite3_reset (ctx->checkpt_get_stmt);
-    json_decref (o);
+                           "{s:i s:i s:i}",
+                           "id", zd->id,
+                           "size", (int)zd->size,
+                           "samples", samples) < 0)
+        flux_log_error (h, "dict-train: flux_respond_pack");
     return;
+#else
+    errstr = "zstd compression is not supported by this build";
+    errno = ENOTSUP;
+#endif
 error:
     if (flux_respond_error (h, msg, errno, errstr) < 0)
-        flux_log_error (h, "flux_respond_error");
-    (void )sqlite3_reset (ctx->checkpt_get_stmt);
-    json_decref (o);
+        flux_log_error (h, "dict-train: flux_respond_error");
 }
 
-void checkpoint_put_cb (flux_t *h,
-                        flux_msg_handler_t *mh,
-                        const flux_msg_t *msg,
-                        void *arg)
+static void load_pool_cb (flux_reactor_t *r,
+                          flux_watcher_t *w,
+                          int revents,
+                          void *arg)
 {
     struct content_sqlite *ctx = arg;
-    const char *key;
-    json_t *o;
-    char *value = NULL;
-    const char *errstr = NULL;
 
-    if (flux_request_unpack (msg,
-                             NULL,
-                             "{s:s s:o}",
-                             "key",
-                             &key,
-                             "value",
-                             &o) < 0)
-        goto error;
-    if (!(value = json_dumps (o, JSON_COMPACT))) {
-        errstr = "failed to encode checkpoint value";
-        errno = EINVAL;
-        goto error;
-    }
-    if (sqlite3_bind_text (ctx->checkpt_put_stmt,
-                           1,
-                           (char *)key,
-                           strlen (key),
-                           SQLITE_STATIC) != SQLITE_OK) {
-        log_sqlite_error (ctx, "checkpt_put: binding key");
-        set_errno_from_sqlite_error (ctx);
-        goto error;
+    if (workpool_run_done (ctx->pool.wp) < 0)
+        flux_log_error (ctx->h, "error running load completions");
+}
+
+/* Stop load threads, responding to any loads in progress, then close
+ * reader connections.
+ */
+static void load_pool_destroy (struct content_sqlite *ctx)
+{
+    struct load_pool *pool = &ctx->pool;
+    int saved_errno = errno;
+    int i;
+
+    flux_watcher_destroy (pool->w);
+    pool->w = NULL;
+    workpool_destroy (pool->wp);
+    pool->wp = NULL;
+    if (pool->readers) {
+        for (i = 0; i < pool->nthreads; i++) {
+            struct reader *r = &pool->readers[i];
+            if (r->load_stmt)
+                (void)sqlite3_finalize (r->load_stmt);
+            if (r->db) {
+                if (sqlite3_close (r->db) != SQLITE_OK)
+                    flux_log (ctx->h, LOG_ERR, "sqlite3_close reader");
+            }
+            decoder_clear (&r->dec);
+        }
+        free (pool->readers);
+        pool->readers = NULL;
     }
-    if (sqlite3_bind_text (ctx->checkpt_put_stmt,
-                           2,
-                           value,
-                           strlen (value),
-                           SQLITE_STATIC) != SQLITE_OK) {
-        log_sqlite_error (ctx, "checkpt_put: binding value");
-        set_errno_from_sqlite_error (ctx);
-        goto error;
+    free (pool->idle);
+    pool->idle = NULL;
+    pool->idle_count = 0;
+    errno = saved_errno;
+}
+
+/* Open pool->nthreads read-only connections and start the load threads.
+ * This requires journal_mode=WAL with normal locking so that readers
+ * may proceed concurrently with the main (writer) connection.
+ */
+static int load_pool_create (struct content_sqlite *ctx)
+{
+    struct load_pool *pool = &ctx->pool;
+    int flags = SQLITE_OPEN_READONLY;
+    int i;
+
+    if (!(pool->readers = calloc (pool->nthreads, sizeof (pool->readers[0])))
+        || !(pool->idle = calloc (pool->nthreads, sizeof (pool->idle[0]))))
+        goto nomem;
+    for (i = 0; i < pool->nthreads; i++) {
+        struct reader *r = &pool->readers[i];
+        if (sqlite3_open_v2 (ctx->dbfile, &r->db, flags, NULL) != SQLITE_OK
+            || sqlite3_prepare_v2 (r->db,
+                                   sql_load,
+                                   -1,
+                                   &r->load_stmt,
+                                   NULL) != SQLITE_OK) {
+            flux_log (ctx->h,
+                      LOG_ERR,
+                      "opening reader: %s",
+                      r->db ? sqlite3_errmsg (r->db) : "out of memory");
+            if (r->db)
+                set_errno_from_sqlite_errcode (sqlite3_errcode (r->db));
+            else
+                errno = ENOMEM;
+            goto error;
+        }
+        if (!(r->dec.buf = calloc (1, lzo_buf_chunksize)))
+            goto nomem;
+        r->dec.bufsize = lzo_buf_chunksize;
+        pool->idle[pool->idle_count++] = r;
     }
-    if (sqlite3_step (ctx->checkpt_put_stmt) != SQLITE_DONE
-                    && sqlite3_errcode (ctx->db) != SQLITE_CONSTRAINT) {
-        log_sqlite_error (ctx, "checkpt_put: executing stmt");
-        set_errno_from_sqlite_error (ctx);
+    if (!(pool->wp = workpool_create (pool->nthreads))
+        || !(pool->w = flux_fd_watcher_create (flux_get_reactor (ctx->h),
+                                               workpool_get_fd (pool->wp),
+                                               FLUX_POLLIN,
+                                               load_pool_cb,
+                                               ctx))) {
+        flux_log_error (ctx->h, "could not create load threads");
         goto error;
     }
-    if (flux_respond (h, msg, NULL) < 0)
-        flux_log_error (h, "flux_respond");
-    (void )sqlite3_reset (ctx->checkpt_put_stmt);
-    free (value);
-    return;
+    flux_watcher_start (pool->w);
+    return 0;
+nomem:
+    errno = ENOMEM;
 error:
-    if (flux_respond_error (h, msg, errno, errstr) < 0)
-        flux_log_error (h, "flux_respond_error");
-    (void )sqlite3_reset (ctx->checkpt_put_stmt);
-    free (value);
+    load_pool_destroy (ctx);
+    return -1;
 }
 
 static void content_sqlite_closedb (struct content_sqlite *ctx)
 {
     if (ctx) {
         int saved_errno = errno;
+        load_pool_destroy (ctx);
+        content_sqlite_gc_finalize (ctx);
         if (ctx->store_stmt) {
             if (sqlite3_finalize (ctx->store_stmt) != SQLITE_OK)
                 log_sqlite_error (ctx, "sqlite_finalize store_stmt");
@@ -526,6 +1782,64 @@ static int set_count (void *arg, int ncols, char **cols, char **col_names)
     return rc; // returning -1 causes SQLITE_ABORT
 }
 
+/* Build a new bloom filter from the hashes in the objects table and
+ * replace ctx->bloom with it.  This is called at startup, after gc, and
+ * when the filter has grown past its capacity.  On failure, the filter is
+ * disabled so that all loads go to the database.
+ */
+static int bloom_rebuild (struct content_sqlite *ctx)
+{
+    sqlite3_stmt *stmt = NULL;
+    struct bloom *bloom = NULL;
+    size_t capacity = bloom_min_capacity;
+    int count;
+    int rc;
+
+    if (sqlite3_exec (ctx->db,
+                      sql_objects_count,
+                      set_count,
+                      &count,
+                      NULL) != SQLITE_OK) {
+        log_sqlite_error (ctx, "bloom: querying objects count");
+        goto error;
+    }
+    while (capacity < count * 2UL)
+        capacity *= 2;
+    if (!(bloom = bloom_create (capacity, bloom_fp_rate))) {
+        flux_log_error (ctx->h, "bloom: could not create filter");
+        goto error;
+    }
+    if (sqlite3_prepare_v2 (ctx->db,
+                            sql_objects_hashes,
+                            -1,
+                            &stmt,
+                            NULL) != SQLITE_OK) {
+        log_sqlite_error (ctx, "bloom: preparing hashes stmt");
+        goto error;
+    }
+    while ((rc = sqlite3_step (stmt)) == SQLITE_ROW) {
+        bloom_add (bloom,
+                   sqlite3_column_blob (stmt, 0),
+                   sqlite3_column_bytes (stmt, 0));
+    }
+    if (rc != SQLITE_DONE) {
+        log_sqlite_error (ctx, "bloom: reading hashes");
+        goto error;
+    }
+    sqlite3_finalize (stmt);
+    bloom_destroy (ctx->bloom);
+    ctx->bloom = bloom;
+    return 0;
+error:
+    flux_log (ctx->h, LOG_ERR, "bloom filter disabled");
+    if (stmt)
+        sqlite3_finalize (stmt);
+    bloom_destroy (bloom);
+    bloom_destroy (ctx->bloom);
+    ctx->bloom = NULL;
+    return -1;
+}
+
 static json_t *pack_tstat (tstat_t *ts)
 {
     json_t *o;
@@ -567,8 +1881,11 @@ void stats_get_cb (flux_t *h,
     struct content_sqlite *ctx = arg;
     int count;
     const char *errmsg = NULL;
+    json_int_t bloom_cap = bloom_capacity (ctx->bloom);
+    json_int_t bloom_cnt = bloom_count (ctx->bloom);
     json_t *load_time = NULL;
     json_t *store_time = NULL;
+    json_t *store_batch = NULL;
 
     if (sqlite3_exec (ctx->db,
                       sql_objects_count,
@@ -580,25 +1897,258 @@ void stats_get_cb (flux_t *h,
         goto error;
     }
     if (!(load_time = pack_tstat (&ctx->stats.load))
-        || !(store_time = pack_tstat (&ctx->stats.store)))
+        || !(store_time = pack_tstat (&ctx->stats.store))
+        || !(store_batch = pack_tstat (&ctx->stats.batch)))
         goto error;
     if (flux_respond_pack (h,
                            msg,
-                           "{s:i s:I s:I s:O s:O}",
+                           "{s:i s:I s:I s:O s:O s:O s:s s:i"
+                           " s:{s:b s:I s:I s:I}}",
                            "object_count", count,
                            "dbfile_size", get_file_size (ctx->dbfile),
                            "dbfile_free", get_fs_free (ctx->dbfile),
                            "load_time", load_time,
-                           "store_time", store_time) < 0)
+                           "store_time", store_time,
+                           "store_batch", store_batch,
+                           "compression",
+                           ctx->compress.method == COMPRESS_ZSTD
+                               ? "zstd" : "lz4",
+                           "dict_id", compress_dict_id (&ctx->compress),
+                           "bloom",
+                             "enabled", ctx->bloom ? 1 : 0,
+                             "capacity", bloom_cap,
+                             "count", bloom_cnt,
+                             "negatives", (json_int_t)ctx->bloom_negatives) < 0)
         flux_log_error (h, "error responding to stats-get request");
     json_decref (load_time);
     json_decref (store_time);
+    json_decref (store_batch);
     return;
 error:
     if (flux_respond_error (h, msg, errno, errmsg) < 0)
         flux_log_error (h, "error responding to stats-get request");
     json_decref (load_time);
     json_decref (store_time);
+    json_decref (store_batch);
+}
+
+/* Parse the [content-sqlite] table, which configures group commit of
+ * store requests and compression.
+ */
+static int parse_config (struct content_sqlite *ctx,
+                         const flux_conf_t *conf,
+                         flux_error_t *errp)
+{
+    flux_error_t error;
+    const char *timeout = NULL;
+    const char *max_size = NULL;
+    int max_count = default_batch_max_count;
+    double t = 0.;
+    uint64_t size = default_batch_max_size;
+    const char *compression = "lz4";
+    int method;
+    int level = default_compression_level;
+    int threshold = default_compression_threshold;
+    int bloom_enable = 1;
+
+    if (flux_conf_unpack (conf,
+                          &error,
+                          "{s?{s?s s?i s?s s?s s?i s?i s?b !}}",
+                          "content-sqlite",
+                            "batch-timeout", &timeout,
+                            "batch-max-count", &max_count,
+                            "batch-max-size", &max_size,
+                            "compression", &compression,
+                            "compression-level", &level,
+                            "compression-threshold", &threshold,
+                            "bloom-filter", &bloom_enable) < 0) {
+        errprintf (errp,
+                   "error reading config for content-sqlite: %s",
+                   error.text);
+        return -1;
+    }
+    if (timeout && fsd_parse_duration (timeout, &t) < 0) {
+        errprintf (errp, "invalid content-sqlite.batch-timeout: '%s'", timeout);
+        errno = EINVAL;
+        return -1;
+    }
+    if (max_count < 1) {
+        errprintf (errp,
+                   "invalid content-sqlite.batch-max-count: %d",
+                   max_count);
+        errno = EINVAL;
+        return -1;
+    }
+    if (max_size && (parse_size (max_size, &size) < 0 || size == 0)) {
+        errprintf (errp,
+                   "invalid content-sqlite.batch-max-size: '%s'",
+                   max_size);
+        errno = EINVAL;
+        return -1;
+    }
+    if (streq (compression, "lz4"))
+        method = COMPRESS_LZ4;
+    else if (streq (compression, "zstd")) {
+#if HAVE_ZSTD
+        method = COMPRESS_ZSTD;
+        if (level < 1 || level > ZSTD_maxCLevel ()) {
+            errprintf (errp,
+                       "invalid content-sqlite.compression-level: %d",
+                       level);
+            errno = EINVAL;
+            return -1;
+        }
+#else
+        errprintf (errp,
+                   "content-sqlite.compression: zstd is not supported"
+                   " by this build");
+        errno = EINVAL;
+        return -1;
+#endif
+    }
+    else {
+        errprintf (errp,
+                   "invalid content-sqlite.compression: '%s'",
+                   compression);
+        errno = EINVAL;
+        return -1;
+    }
+    if (threshold < 0) {
+        errprintf (errp,
+                   "invalid content-sqlite.compression-threshold: %d",
+                   threshold);
+        errno = EINVAL;
+        return -1;
+    }
+    /* Commit anything batched under the old settings.
+     */
+    store_batch_commit (ctx);
+    ctx->batch.timeout = t;
+    ctx->batch.max_count = max_count;
+    ctx->batch.max_size = size;
+    ctx->compress.method = method;
+    ctx->compress.level = level;
+    ctx->compress.threshold = threshold;
+    /* If the database is open (config reload), apply the change now.
+     * Otherwise the filter is built when the database is opened.
+     */
+    ctx->bloom_enable = bloom_enable ? true : false;
+    if (ctx->db) {
+        if (!ctx->bloom_enable) {
+            bloom_destroy (ctx->bloom);
+            ctx->bloom = NULL;
+        }
+        else if (!ctx->bloom)
+            (void)bloom_rebuild (ctx);
+    }
+    return 0;
+}
+
+static void config_reload_cb (flux_t *h,
+                              flux_msg_handler_t *mh,
+                              const flux_msg_t *msg,
+                              void *arg)
+{
+    struct content_sqlite *ctx = arg;
+    const flux_conf_t *conf;
+    flux_error_t error;
+    const char *errstr = NULL;
+
+    if (flux_conf_reload_decode (msg, &conf) < 0)
+        goto error;
+    if (parse_config (ctx, conf, &error) < 0) {
+        errstr = error.text;
+        goto error;
+    }
+    if (flux_set_conf (h, flux_conf_incref (conf)) < 0) {
+        errstr = "error updating cached configuration";
+        goto error;
+    }
+    if (flux_respond (h, msg, NULL) < 0)
+        flux_log_error (h, "error responding to config-reload request");
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, errstr) < 0)
+        flux_log_error (h, "error responding to config-reload request");
+}
+
+/* Upgrade a version 0 database (no objects 'dict' column) in place.
+ * Existing rows have 'dict' NULL, which indicates LZ4 as before.
+ */
+static int content_sqlite_upgrade_schema (struct content_sqlite *ctx)
+{
+    sqlite3_stmt *stmt;
+    char s[64];
+
+    if (sqlite3_prepare_v2 (ctx->db,
+                            sql_check_dict_column,
+                            -1,
+                            &stmt,
+                            NULL) == SQLITE_OK)
+        sqlite3_finalize (stmt);
+    else if (sqlite3_exec (ctx->db,
+                           sql_add_dict_column,
+                           NULL,
+                           NULL,
+                           NULL) != SQLITE_OK) {
+        log_sqlite_error (ctx, "adding objects dict column");
+        return -1;
+    }
+    if (sqlite3_exec (ctx->db,
+                      sql_create_table_dicts,
+                      NULL,
+                      NULL,
+                      NULL) != SQLITE_OK) {
+        log_sqlite_error (ctx, "creating dicts table");
+        return -1;
+    }
+    snprintf (s, sizeof (s), "PRAGMA user_version=%d", schema_version);
+    if (sqlite3_exec (ctx->db,
+                      s,
+                      NULL,
+                      NULL,
+                      NULL) != SQLITE_OK) {
+        log_sqlite_error (ctx, "setting sqlite 'user_version' pragma");
+        return -1;
+    }
+    return 0;
+}
+
+/* Load compression dictionaries from the dicts table.
+ */
+static int content_sqlite_load_dicts (struct content_sqlite *ctx)
+{
+    sqlite3_stmt *stmt;
+    int rc;
+
+    if (sqlite3_prepare_v2 (ctx->db,
+                            sql_dicts_get,
+                            -1,
+                            &stmt,
+                            NULL) != SQLITE_OK) {
+        log_sqlite_error (ctx, "preparing dicts_get stmt");
+        return -1;
+    }
+    while ((rc = sqlite3_step (stmt)) == SQLITE_ROW) {
+        struct zdict *zd;
+
+        if (!(zd = zdict_create (sqlite3_column_int (stmt, 0),
+                                 sqlite3_column_blob (stmt, 1),
+                                 sqlite3_column_bytes (stmt, 1)))
+            || compress_add_dict (&ctx->compress, zd) < 0) {
+            flux_log_error (ctx->h, "loading compression dictionary");
+            zdict_destroy (zd);
+            sqlite3_finalize (stmt);
+            return -1;
+        }
+    }
+    if (rc != SQLITE_DONE) {
+        log_sqlite_error (ctx, "loading compression dictionaries");
+        sqlite3_finalize (stmt);
+        return -1;
+    }
+    sqlite3_finalize (stmt);
+    return 0;
 }
 
 /* Open the database file ctx->dbfile and set up the database.
@@ -634,8 +2184,15 @@ static int content_sqlite_opendb (struct content_sqlite *ctx, bool truncate)
         log_sqlite_error (ctx, "setting sqlite 'synchronous' pragma");
         goto error;
     }
+    /* Exclusive locking is faster, but load threads use their own
+     * connections, so they require normal locking.
+     */
+    snprintf (s,
+              sizeof (s),
+              "PRAGMA locking_mode=%s",
+              ctx->pool.nthreads > 0 ? "NORMAL" : "EXCLUSIVE");
     if (sqlite3_exec (ctx->db,
-                      "PRAGMA locking_mode=EXCLUSIVE",
+                      s,
                       NULL,
                       NULL,
                       NULL) != SQLITE_OK) {
@@ -666,6 +2223,9 @@ static int content_sqlite_opendb (struct content_sqlite *ctx, bool truncate)
         log_sqlite_error (ctx, "creating checkpt table");
         goto error;
     }
+    if (content_sqlite_upgrade_schema (ctx) < 0
+        || content_sqlite_load_dicts (ctx) < 0)
+        goto error;
     if (sqlite3_prepare_v2 (ctx->db,
                             sql_load,
                             -1,
@@ -706,13 +2266,18 @@ static int content_sqlite_opendb (struct content_sqlite *ctx, bool truncate)
         log_sqlite_error (ctx, "querying objects count");
         goto error;
     }
+    if (ctx->bloom_enable)
+        (void)bloom_rebuild (ctx);
+    if (ctx->pool.nthreads > 0 && load_pool_create (ctx) < 0)
+        return -1;
     flux_log (ctx->h,
               LOG_DEBUG,
-              "%s (%d objects) journal_mode=%s synchronous=%s",
+              "%s (%d objects) journal_mode=%s synchronous=%s load-threads=%d",
               ctx->dbfile,
               count,
               ctx->journal_mode,
-              ctx->synchronous);
+              ctx->synchronous,
+              ctx->pool.nthreads);
     return 0;
 error:
     set_errno_from_sqlite_error (ctx);
@@ -724,6 +2289,13 @@ static void content_sqlite_destroy (struct content_sqlite *ctx)
     if (ctx) {
         int saved_errno = errno;
         flux_msg_handler_delvec (ctx->handlers);
+        pthread_mutex_destroy (&ctx->pool.lock);
+        compress_clear (&ctx->compress);
+        bloom_destroy (ctx->bloom);
+        pthread_mutex_destroy (&ctx->compress.lock);
+        decoder_clear (&ctx->dec);
+        flux_watcher_destroy (ctx->batch.timer);
+        flux_msglist_destroy (ctx->batch.requests);
         free (ctx->dbfile);
         free (ctx->lzo_buf);
         free (ctx->hashfun);
@@ -739,8 +2311,15 @@ static const struct flux_msg_handler_spec htab[] = {
                             checkpoint_get_cb, 0 },
     { FLUX_MSGTYPE_REQUEST, "content-backing.checkpoint-put",
                             checkpoint_put_cb, 0 },
+    { FLUX_MSGTYPE_REQUEST, "content-backing.gc-begin", gc_begin_cb, 0 },
+    { FLUX_MSGTYPE_REQUEST, "content-backing.gc-mark", gc_mark_cb, 0 },
+    { FLUX_MSGTYPE_REQUEST, "content-backing.gc-sweep", gc_sweep_cb, 0 },
+    { FLUX_MSGTYPE_REQUEST, "content-backing.gc-end", gc_end_cb, 0 },
+    { FLUX_MSGTYPE_REQUEST, "content-backing.dict-train", dict_train_cb, 0 },
     { FLUX_MSGTYPE_REQUEST, "content-sqlite.stats-get",
                             stats_get_cb, FLUX_ROLE_USER },
+    { FLUX_MSGTYPE_REQUEST, "content-sqlite.config-reload",
+                            config_reload_cb, 0 },
     FLUX_MSGHANDLER_TABLE_END,
 };
 
@@ -752,12 +2331,27 @@ static struct content_sqlite *content_sqlite_create (flux_t *h)
 
     if (!(ctx = calloc (1, sizeof (*ctx))))
         return NULL;
-    if (!(ctx->lzo_buf = calloc (1, lzo_buf_chunksize)))
+    pthread_mutex_init (&ctx->pool.lock, NULL);
+    pthread_mutex_init (&ctx->compress.lock, NULL);
+    ctx->compress.method = COMPRESS_LZ4;
+    ctx->compress.level = default_compression_level;
+    ctx->compress.threshold = default_compression_threshold;
+    ctx->bloom_enable = true;
+    if (!(ctx->lzo_buf = calloc (1, lzo_buf_chunksize))
+        || !(ctx->dec.buf = calloc (1, lzo_buf_chunksize)))
         goto error;
     ctx->lzo_bufsize = lzo_buf_chunksize;
+    ctx->dec.bufsize = lzo_buf_chunksize;
     ctx->h = h;
     ctx->journal_mode = "WAL";
     ctx->synchronous = "NORMAL";
+    if (!(ctx->batch.requests = flux_msglist_create ())
+        || !(ctx->batch.timer = flux_timer_watcher_create (flux_get_reactor (h),
+                                                           0.,
+                                                           0.,
+                                                           store_batch_timer_cb,
+                                                           ctx)))
+        goto error;
 
     /* Some tunables:
      * - the hash function, e.g. sha1, sha256
@@ -822,12 +2416,27 @@ static int process_args (struct content_sqlite *ctx,
         else if (streq ("truncate", argv[i])) {
             *truncate = true;
         }
+        else if (strstarts (argv[i], "load-threads=")) {
+            char *endptr;
+            errno = 0;
+            ctx->pool.nthreads = strtol (argv[i] + 13, &endptr, 10);
+            if (errno != 0 || *endptr != '\0' || ctx->pool.nthreads < 0) {
+                flux_log (ctx->h, LOG_ERR, "Invalid value for %s", argv[i]);
+                errno = EINVAL;
+                return -1;
+            }
+        }
         else {
             flux_log (ctx->h, LOG_ERR, "Unknown module option: '%s'", argv[i]);
             errno = EINVAL;
             return -1;
         }
     }
+    if (ctx->pool.nthreads > 0 && strcasecmp (ctx->journal_mode, "WAL") != 0) {
+        flux_log (ctx->h, LOG_ERR, "load-threads requires journal_mode=WAL");
+        errno = EINVAL;
+        return -1;
+    }
     return 0;
 }
 
@@ -835,6 +2444,7 @@ int mod_main (flux_t *h, int argc, char **argv)
 {
     struct content_sqlite *ctx;
     bool truncate = false;
+    flux_error_t error;
     int rc = -1;
 
     if (!(ctx = content_sqlite_create (h))) {
@@ -844,6 +2454,10 @@ int mod_main (flux_t *h, int argc, char **argv)
     // override pragmas set above
     if (process_args (ctx, argc, argv, &truncate) < 0)
         goto done;
+    if (parse_config (ctx, flux_get_conf (h), &error) < 0) {
+        flux_log (h, LOG_ERR, "%s", error.text);
+        goto done;
+    }
     if (content_sqlite_opendb (ctx, truncate) < 0)
         goto done;
     if (content_register_service (h, "content-backing") < 0)
@@ -856,6 +2470,7 @@ int mod_main (flux_t *h, int argc, char **argv)
     }
     rc = 0;
 done_unreg:
+    store_batch_commit (ctx);
     (void)content_unregister_backing_store (h);
 done:
     content_sqlite_closedb (ctx);
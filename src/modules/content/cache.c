@@ -14,25 +14,34 @@
 #include "config.h"
 #endif
 #include <inttypes.h>
+#include <arpa/inet.h>
 #include <assert.h>
 #include <flux/core.h>
+#include <flux/idset.h>
+#include <jansson.h>
 
-#include "src/common/libczmqcontainers/czmq_containers.h"
 #include "src/common/libccan/ccan/list/list.h"
 #include "src/common/libutil/errno_safe.h"
 #include "src/common/libutil/blobref.h"
+#include "src/common/libutil/hashmap.h"
 #include "src/common/libutil/iterators.h"
 #include "src/common/libutil/log.h"
+#include "src/common/libutil/monotime.h"
 #include "src/common/libcontent/content.h"
 #include "ccan/str/str.h"
+#include "ccan/array_size/array_size.h"
 
 #include "cache.h"
 #include "checkpoint.h"
+#include "gc.h"
 #include "mmap.h"
+#include "parent.h"
 
-/* A periodic callback purges the cache of least recently used entries.
- * The callback is synchronized with the instance heartbeat, with a
- * sync period upper bound set to 'sync_max' seconds.
+/* A periodic callback purges the cache of entries that have not been used
+ * recently.  The callback is synchronized with the instance heartbeat, with a
+ * sync period upper bound set to 'sync_max' seconds.  It is delayed by a
+ * random fraction of the heartbeat period so that brokers do not all purge
+ * at the same instant.
  */
 static double sync_max = 10.;
 
@@ -41,6 +50,18 @@ static const char *default_hash = "sha1";
 static const uint32_t default_cache_purge_target_size = 1024*1024*16;
 static const uint32_t default_cache_purge_old_entry = 10; // seconds
 
+/* If the cache grows past purge-max-size between heartbeats, entries are
+ * evicted as new ones are added, regardless of age.
+ */
+static const uint32_t default_cache_purge_max_size = 1024*1024*64;
+
+/* Hashes of entries evicted from the probation list are remembered so that
+ * a blob that is reloaded soon after eviction goes straight to the protected
+ * list.  The ghosts represent at most half the purge target size in blob
+ * bytes, and are limited in number in case blobs are tiny.
+ */
+static const int ghost_max_count = 65536;
+
 /* Raise the max blob size value to 1GB so that large KVS values
  * (including KVS directories) can be supported while the KVS transitions
  * to the RFC 11 treeobj data representation.
@@ -50,8 +71,24 @@ static const uint32_t default_blob_size_limit = 1048576*1024;
 
 static const uint32_t default_flush_batch_limit = 256;
 
-/* Hash digests are used as zhashx keys.  The digest size needs to be
- * available to zhashx comparator so make this global.
+/* A content.load request may carry prefetch hints, the hashes of blobs
+ * the requestor expects to load soon.  At most this many are honored.
+ */
+static const int prefetch_max = 1024;
+
+/* Garbage collection is disabled unless gc-interval (seconds) is set.
+ * Up to gc-batch-size blobs are marked or swept per backing store request.
+ */
+static const uint32_t default_gc_interval = 0;
+static const uint32_t default_gc_batch_size = 1024;
+
+/* Load responses at least this large reference cache entry data directly
+ * rather than copying it into the response message.
+ */
+static const int zero_copy_min = 4096;
+
+/* Hash digests are used as hashmap keys.  The digest size is fixed by
+ * the content.hash attribute, so make this global.
  */
 static int content_hash_size;
 
@@ -60,6 +97,18 @@ struct msgstack {
     struct msgstack *next;
 };
 
+/* Unless mmapped, entry data is contained in a message, wrapped in an
+ * atomically refcounted holder so load responses can borrow the data.
+ * Those responses may be destroyed in other threads, possibly after the
+ * entry is gone.  The holder must remain the only reference on the message
+ * once the entry (and its request stacks) has been destroyed, so that the
+ * message refcount is never manipulated concurrently.
+ */
+struct blob_holder {
+    int refcount;
+    const flux_msg_t *msg;
+};
+
 struct cache_entry {
     const void *data;
     int len;
@@ -72,11 +121,20 @@ struct cache_entry {
     uint8_t load_pending:1;
     uint8_t store_pending:1;
     uint8_t mmapped:1;
+    uint8_t promoted:1;             // entry is on the protected list
     struct msgstack *load_requests;
     struct msgstack *store_requests;
     double lastused;
+    uint64_t dirty_seq;             // value of cache->dirty_seq when dirtied
 
     struct list_node list;
+    struct list_node dirty_list;
+};
+
+struct ghost {
+    void *hash;                     // key storage is contiguous with struct
+    int len;
+    struct list_node list;
 };
 
 struct content_cache {
@@ -85,14 +143,24 @@ struct content_cache {
     flux_msg_handler_t **handlers;
     flux_future_t *f_sync;
     uint32_t rank;
-    zhashx_t *entries;
+    struct hashmap *entries;
     uint8_t backing:1;              // 'content.backing' service available
     char *backing_name;
     char *hash_name;
     struct msgstack *flush_requests;
 
-    struct list_head lru;           // LRU is for valid, clean entries only
+    /* Valid, clean entries are on one of these lists, most recently used
+     * first.  See cache_entry_lru_add().
+     */
+    struct list_head probation;     // entries not referenced since added
+    struct list_head protected;     // entries referenced again while cached
+    struct list_head pinned;        // entries backed by an mmapped region
     struct list_head flush;         // dirties queued due to batch limit
+    struct list_head dirty;         // all dirties, oldest first
+    uint64_t dirty_seq;             // count of entries made dirty
+
+    struct hashmap *ghosts;         // hashes recently evicted from probation
+    struct list_head ghost_list;
 
     uint32_t blob_size_limit;
     uint32_t flush_batch_limit;
@@ -100,18 +168,88 @@ struct content_cache {
 
     uint32_t purge_target_size;
     uint32_t purge_old_entry;
+    uint32_t purge_max_size;
 
-    uint64_t acct_size;             // total size of all cache entries
+    uint64_t acct_size;             // total size of cache entries, not pinned
     uint32_t acct_valid;            // count of valid cache entries
     uint32_t acct_dirty;            // count of dirty cache entries
+    uint64_t acct_probation_size;   // total size of probation entries
+    uint64_t acct_protected_size;   // total size of protected entries
+    uint64_t acct_pinned_size;      // total size of pinned entries
+    uint32_t acct_pinned;           // count of pinned entries
+    uint64_t acct_ghost_size;       // total blob size represented by ghosts
+    uint64_t acct_prefetch;         // count of loads started by hints
+    uint64_t acct_parent_load;      // count of blobs copied from parent
+    uint64_t acct_parent_map;       // count of blobs mapped via parent
+    uint64_t acct_home_load;        // count of loads sent to a home rank
+
+    uint32_t *home_ranks;           // content.home-ranks, if set
+    int home_count;
+    struct idset *subtree;          // descendants of this rank, once known
+    flux_future_t *f_topology;
+
+    uint32_t gc_interval;
+    uint32_t gc_batch_size;
 
     struct content_checkpoint *checkpoint;
+    struct content_gc *gc;
     struct content_mmap *mmap;
+    struct content_parent *parent;
 };
 
 static void flush_respond (struct content_cache *cache);
 static int cache_flush (struct content_cache *cache);
 
+static struct blob_holder *blob_holder_create (const flux_msg_t *msg)
+{
+    struct blob_holder *bh;
+
+    if (!(bh = malloc (sizeof (*bh))))
+        return NULL;
+    bh->refcount = 1;
+    bh->msg = flux_msg_incref (msg);
+    return bh;
+}
+
+static struct blob_holder *blob_holder_incref (struct blob_holder *bh)
+{
+    __atomic_add_fetch (&bh->refcount, 1, __ATOMIC_RELAXED);
+    return bh;
+}
+
+/* flux_free_f footprint
+ */
+static void blob_holder_decref (void *arg)
+{
+    struct blob_holder *bh = arg;
+
+    if (bh && __atomic_sub_fetch (&bh->refcount, 1, __ATOMIC_ACQ_REL) == 0) {
+        int saved_errno = errno;
+        flux_msg_decref (bh->msg);
+        free (bh);
+        errno = saved_errno;
+    }
+}
+
+/* Set response payload to the entry's data, avoiding a copy if possible.
+ */
+static int set_payload_entry (flux_msg_t *response, struct cache_entry *e)
+{
+    if (!e->mmapped && e->len >= zero_copy_min) {
+        struct blob_holder *bh = blob_holder_incref (e->data_container);
+        if (flux_msg_set_payload_ref (response,
+                                      e->data,
+                                      e->len,
+                                      blob_holder_decref,
+                                      bh) < 0) {
+            blob_holder_decref (bh);
+            return -1;
+        }
+        return 0;
+    }
+    return flux_msg_set_payload (response, e->data, e->len);
+}
+
 static int msgstack_push (struct msgstack **msp, const flux_msg_t *msg)
 {
     struct msgstack *ms;
@@ -168,6 +306,26 @@ static void request_list_respond_raw (struct msgstack **l,
     }
 }
 
+/* Respond to a list of load requests with entry data.
+ */
+static void request_list_respond_load (struct msgstack **l,
+                                       flux_t *h,
+                                       int flag,
+                                       struct cache_entry *e)
+{
+    const flux_msg_t *msg;
+    while ((msg = msgstack_pop (l))) {
+        flux_msg_t *response;
+        if (!(response = flux_response_derive (msg, 0))
+            || set_payload_entry (response, e) < 0
+            || flux_msg_set_flag (response, flag) < 0
+            || flux_send (h, response, 0) < 0)
+            flux_log_error (h, "%s:", __FUNCTION__);
+        flux_msg_decref (response);
+        flux_msg_decref (msg);
+    }
+}
+
 /* Same as above only send errnum, errmsg response
  */
 static void request_list_respond_error (struct msgstack **l,
@@ -195,13 +353,13 @@ static void cache_entry_destroy (struct cache_entry *e)
         if (e->mmapped)
             content_mmap_region_decref (e->data_container);
         else
-            flux_msg_decref (e->data_container);
+            blob_holder_decref (e->data_container);
         free (e);
         errno = saved_errno;
     }
 }
 
-/* zhashx_destructor_fn footprint
+/* hashmap_destructor_f footprint
  */
 static void cache_entry_destructor (void **item)
 {
@@ -210,17 +368,14 @@ static void cache_entry_destructor (void **item)
         *item = NULL;
     }
 }
-/* zhashx_hash_fn footprint
+/* hashmap_hash_f footprint
+ * The key is a hash digest, so its leading bytes are already random.
  */
-static size_t cache_entry_hasher (const void *key)
+static size_t cache_entry_hasher (const void *key, size_t keysize)
 {
-    return *(size_t *)key;
-}
-/* zhashx_comparator_fn footprint
- */
-static int cache_entry_comparator (const void *item1, const void *item2)
-{
-    return memcmp (item1, item2, content_hash_size);
+    size_t h;
+    memcpy (&h, key, sizeof (h));
+    return h;
 }
 
 /* Create a cache entry.
@@ -239,16 +394,146 @@ static struct cache_entry *cache_entry_create (const void *hash)
     return e;
 }
 
+/* hashmap_destructor_f footprint
+ */
+static void ghost_destructor (void **item)
+{
+    if (item) {
+        free (*item);
+        *item = NULL;
+    }
+}
+
+static void ghost_delete (struct content_cache *cache, struct ghost *g)
+{
+    list_del (&g->list);
+    cache->acct_ghost_size -= g->len;
+    hashmap_delete (cache->ghosts, g->hash);
+}
+
+/* Remember the hash of an entry evicted from probation, then trim the
+ * oldest ghosts.  This is best effort, so errors are ignored.
+ */
+static void ghost_add (struct content_cache *cache, struct cache_entry *e)
+{
+    struct ghost *g;
+
+    if (!(g = calloc (1, sizeof (*g) + content_hash_size)))
+        return;
+    g->hash = (char *)(g + 1);
+    memcpy (g->hash, e->hash, content_hash_size);
+    g->len = e->len;
+    if (hashmap_insert (cache->ghosts, g->hash, g) < 0) {
+        free (g);
+        return;
+    }
+    list_add (&cache->ghost_list, &g->list);
+    cache->acct_ghost_size += g->len;
+
+    while (cache->acct_ghost_size > cache->purge_target_size / 2
+           || hashmap_size (cache->ghosts) > ghost_max_count) {
+        g = list_tail (&cache->ghost_list, struct ghost, list);
+        ghost_delete (cache, g);
+    }
+}
+
+/* Remove ghost for 'hash' if there is one.
+ * Returns true if a ghost was found.
+ */
+static bool ghost_remove (struct content_cache *cache, const void *hash)
+{
+    struct ghost *g;
+
+    if (!(g = hashmap_lookup (cache->ghosts, hash)))
+        return false;
+    ghost_delete (cache, g);
+    return true;
+}
+
+/* Add an entry that has just become valid and clean to the replacement
+ * lists.  This is 2Q with byte-weighted lists: entries start on probation
+ * and are promoted if referenced again while cached, so a scan that
+ * references many blobs once can only displace other probationary entries.
+ * An entry that was recently evicted from probation (a ghost) is promoted
+ * immediately.  Entries backed by an mmapped region are pinned: their data
+ * belongs to the region, so they are accounted separately and do not count
+ * towards the purge target.
+ */
+static void cache_entry_lru_add (struct content_cache *cache,
+                                 struct cache_entry *e)
+{
+    e->lastused = flux_reactor_now (cache->reactor);
+    if (e->mmapped)
+        list_add (&cache->pinned, &e->list);
+    else if (ghost_remove (cache, e->hash)) {
+        e->promoted = 1;
+        cache->acct_protected_size += e->len;
+        list_add (&cache->protected, &e->list);
+    }
+    else {
+        cache->acct_probation_size += e->len;
+        list_add (&cache->probation, &e->list);
+    }
+}
+
+static void cache_entry_lru_del (struct content_cache *cache,
+                                 struct cache_entry *e)
+{
+    list_del_init (&e->list);
+    if (!e->mmapped) {
+        if (e->promoted)
+            cache->acct_protected_size -= e->len;
+        else
+            cache->acct_probation_size -= e->len;
+    }
+    e->promoted = 0;
+}
+
+/* Move a valid, clean entry to the front of its list because it was
+ * referenced, promoting it if it was on probation.
+ */
+static void cache_entry_lru_touch (struct content_cache *cache,
+                                   struct cache_entry *e)
+{
+    list_del (&e->list);
+    if (e->mmapped)
+        list_add (&cache->pinned, &e->list);
+    else {
+        if (!e->promoted) {
+            cache->acct_probation_size -= e->len;
+            cache->acct_protected_size += e->len;
+            e->promoted = 1;
+        }
+        list_add (&cache->protected, &e->list);
+    }
+    e->lastused = flux_reactor_now (cache->reactor);
+}
+
+static void cache_evict_on_insert (struct content_cache *cache);
+
+/* Dirty entries are numbered in the order they became dirty, so that
+ * content_cache_durable_seq() can tell when all entries dirtied before
+ * some point have been stored.
+ */
+static void cache_entry_dirty_set (struct content_cache *cache,
+                                   struct cache_entry *e)
+{
+    e->dirty = 1;
+    e->dirty_seq = ++cache->dirty_seq;
+    list_add_tail (&cache->dirty, &e->dirty_list);
+    cache->acct_dirty++;
+}
+
 static void cache_entry_dirty_clear (struct content_cache *cache,
                                      struct cache_entry *e)
 {
     if (e->dirty) {
         cache->acct_dirty--;
         e->dirty = 0;
+        list_del (&e->dirty_list);
 
         assert (e->valid);
-        list_add (&cache->lru, &e->list);
-        e->lastused = flux_reactor_now (cache->reactor);
+        cache_entry_lru_add (cache, e);
 
         request_list_respond_raw (&e->store_requests,
                                   cache->h,
@@ -256,6 +541,7 @@ static void cache_entry_dirty_clear (struct content_cache *cache,
                                   e->hash,
                                   content_hash_size,
                                   "store");
+        cache_evict_on_insert (cache);
     }
 }
 
@@ -275,7 +561,7 @@ static struct cache_entry *cache_entry_insert (struct content_cache *cache,
     }
     if (!(e = cache_entry_create (hash)))
         return NULL;
-    if (zhashx_insert (cache->entries, e->hash, e) < 0) {
+    if (hashmap_insert (cache->entries, e->hash, e) < 0) {
         errno = EEXIST;
         cache_entry_destroy (e);
         return NULL;
@@ -284,7 +570,8 @@ static struct cache_entry *cache_entry_insert (struct content_cache *cache,
 }
 
 /* Look up a cache entry.
- * Move to front of LRU because it was looked up.
+ * If valid and clean, move to the front of the protected list because it
+ * was looked up.
  * Returns entry on success, NULL on failure.
  * N.B. errno is not set
  */
@@ -296,14 +583,11 @@ static struct cache_entry *cache_entry_lookup (struct content_cache *cache,
 
     if (hash_size != content_hash_size)
         return NULL;
-    if (!(e = zhashx_lookup (cache->entries, hash)))
+    if (!(e = hashmap_lookup (cache->entries, hash)))
         return NULL;
 
-    if (e->valid && !e->dirty) {
-        list_del_from (&cache->lru, &e->list);
-        list_add (&cache->lru, &e->list);
-        e->lastused = flux_reactor_now (cache->reactor);
-    }
+    if (e->valid && !e->dirty)
+        cache_entry_lru_touch (cache, e);
 
     return e;
 }
@@ -316,12 +600,85 @@ static void cache_entry_remove (struct content_cache *cache,
     assert (e->load_requests == NULL);
     assert (e->store_requests == NULL);
     assert (!e->dirty);
-    list_del (&e->list);
     if (e->valid) {
-        cache->acct_size -= e->len;
+        cache_entry_lru_del (cache, e);
+        if (e->mmapped) {
+            cache->acct_pinned_size -= e->len;
+            cache->acct_pinned--;
+        }
+        else
+            cache->acct_size -= e->len;
         cache->acct_valid--;
     }
-    zhashx_delete (cache->entries, e->hash);
+    else
+        list_del (&e->list);
+    hashmap_delete (cache->entries, e->hash);
+}
+
+/* Return the least recently used entry on list 'l' if it was last used at
+ * or before 'cutoff'.  Skip entries that were filled by a store while a load
+ * was pending, since the load continuation still refers to them.
+ */
+static struct cache_entry *lru_tail (struct list_head *l, double cutoff)
+{
+    struct cache_entry *e;
+
+    list_for_each_rev (l, e, list) {
+        if (e->lastused > cutoff)
+            break;
+        if (!e->load_pending)
+            return e;
+    }
+    return NULL;
+}
+
+/* Return the next entry to evict among those last used at or before
+ * 'cutoff'.  As in 2Q, take from the probation list while it holds more
+ * than a quarter of the purge target size, or if there is nothing eligible
+ * on the protected list.
+ */
+static struct cache_entry *cache_victim (struct content_cache *cache,
+                                         double cutoff)
+{
+    struct cache_entry *p;
+    struct cache_entry *q;
+
+    p = lru_tail (&cache->probation, cutoff);
+    q = lru_tail (&cache->protected, cutoff);
+    if (p && (!q || cache->acct_probation_size > cache->purge_target_size / 4))
+        return p;
+    return q;
+}
+
+/* Evict entries until the cache size is at or below 'target_size',
+ * or there is nothing left that may be evicted.
+ */
+static void cache_evict (struct content_cache *cache,
+                         uint64_t target_size,
+                         double cutoff)
+{
+    struct cache_entry *e;
+
+    while (cache->acct_size > target_size
+           && (e = cache_victim (cache, cutoff))) {
+        assert (e->valid);
+        assert (!e->dirty);
+        if (!e->promoted)
+            ghost_add (cache, e);
+        cache_entry_remove (cache, e);
+    }
+}
+
+/* Called after an entry has been made valid and clean, once the caller
+ * is done with it, to keep the cache size bounded between heartbeats.
+ */
+static void cache_evict_on_insert (struct content_cache *cache)
+{
+    if (cache->acct_size > cache->purge_max_size) {
+        cache_evict (cache,
+                     cache->purge_max_size,
+                     flux_reactor_now (cache->reactor));
+    }
 }
 
 /* Load operation
@@ -333,50 +690,151 @@ static void cache_entry_remove (struct content_cache *cache,
  * Once the response is received, identical responses are sent to all
  * parked requests, and cache entry is made valid or removed if there was
  * an error such as ENOENT.
+ *
+ * The request payload is a hash, optionally followed by prefetch hints
+ * (more hashes).  A load is started for each hinted entry that is not
+ * cached, with no request parked on it.  A request sent with the
+ * NORESPONSE flag consists only of hints.
  */
 
+static int cache_load_parent (struct content_cache *cache,
+                              struct cache_entry *e);
+static int cache_load_upstream (struct content_cache *cache,
+                                struct cache_entry *e);
+
+/* Make entry valid with the blob contained in load response 'msg' and
+ * respond to parked load requests.  Returns 0 on success, -1 on failure
+ * with errno set.
+ */
+static int cache_entry_fill (struct content_cache *cache,
+                             struct cache_entry *e,
+                             const flux_msg_t *msg,
+                             bool ephemeral)
+{
+    /* N.B. the entry may already be valid if a store filled it while
+     * we were waiting for this load completion.  Do nothing in that case.
+     * Any pending load requests would have been answered already.
+     */
+    if (!e->valid) {
+        assert (!e->data_container);
+        assert (!e->dirty);
+        if (flux_response_decode_raw (msg, NULL, &e->data, &e->len) < 0
+            || !(e->data_container = blob_holder_create (msg)))
+            return -1;
+        e->valid = 1;
+        if (ephemeral || flux_msg_has_flag (msg, FLUX_MSGFLAG_USER1))
+            e->ephemeral = 1;
+        cache->acct_valid++;
+        cache->acct_size += e->len;
+        cache_entry_lru_add (cache, e);
+        request_list_respond_load (&e->load_requests,
+                                   cache->h,
+                                   e->ephemeral ? FLUX_MSGFLAG_USER1 : 0,
+                                   e);
+        cache_evict_on_insert (cache);
+    }
+    return 0;
+}
+
+/* Make entry valid with blob 'data' of length 'len' in mapped 'region'.
+ * The entry takes a reference on the region.
+ */
+static void cache_entry_set_region (struct content_cache *cache,
+                                    struct cache_entry *e,
+                                    struct content_region *region,
+                                    const void *data,
+                                    int len)
+{
+    e->data_container = content_mmap_region_incref (region);
+    e->data = data;
+    e->len = len;
+    e->valid = 1;
+    e->ephemeral = 1;
+    e->mmapped = 1;
+    cache->acct_valid++;
+    cache->acct_pinned_size += e->len;
+    cache->acct_pinned++;
+    cache_entry_lru_add (cache, e);
+}
+
+/* When stats are enabled, stash the start time of a backing store or
+ * upstream RPC in the future so its latency can be reported on completion.
+ */
+static void stats_timing_start (struct content_cache *cache, flux_future_t *f)
+{
+    struct timespec *t0;
+
+    if (!flux_stats_enabled (cache->h, NULL) || !(t0 = malloc (sizeof (*t0))))
+        return;
+    monotime (t0);
+    if (flux_future_aux_set (f, "t0", t0, free) < 0)
+        free (t0);
+}
+
+static void stats_timing_end (struct content_cache *cache,
+                              flux_future_t *f,
+                              const char *name)
+{
+    struct timespec *t0 = flux_future_aux_get (f, "t0");
+
+    if (t0)
+        flux_stats_timing (cache->h, name, monotime_since (*t0));
+}
+
 static void cache_load_continuation (flux_future_t *f, void *arg)
 {
     struct content_cache *cache = arg;
     struct cache_entry *e = flux_future_aux_get (f, "entry");
+    bool from_parent = flux_future_aux_get (f, "parent") != NULL;
+    bool from_home = flux_future_aux_get (f, "home") != NULL;
     const flux_msg_t *msg;
     const char *errmsg = NULL;
 
     e->load_pending = 0;
+    stats_timing_end (cache, f, "content-cache.load");
     if (flux_future_get (f, (const void **)&msg) < 0) {
         if (errno == ENOSYS && cache->rank == 0)
             errno = ENOENT;
+        if (from_parent) {
+            if (errno != ENOENT) {
+                flux_log (cache->h,
+                          LOG_DEBUG,
+                          "content load from parent: %s",
+                          strerror (errno));
+                errno = ENOENT;
+            }
+        }
+        else if (from_home && errno != ENOENT) {
+            /* The home rank may be down or unreachable.  Its subtree
+             * stays usable if misses fall back to the usual route.
+             */
+            flux_log (cache->h,
+                      LOG_DEBUG,
+                      "content load from home rank: %s",
+                      strerror (errno));
+            if (cache_load_upstream (cache, e) == 0) {
+                flux_future_destroy (f);
+                return;
+            }
+        }
+        else if (errno == ENOENT && cache->parent) {
+            if (cache_load_parent (cache, e) == 0) {
+                flux_future_destroy (f);
+                return;
+            }
+            errno = ENOENT;
+        }
         if (errno != ENOENT)
             flux_log_error (cache->h, "content load");
         errmsg = flux_future_error_string (f);
         goto error;
     }
-    /* N.B. the entry may already be valid if a store filled it while
-     * we were waiting for this load completion.  Do nothing in that case.
-     * Any pending load requests would have been answered already.
-     */
-    if (!e->valid) {
-        assert (!e->data_container);
-        assert (!e->dirty);
-        if (flux_response_decode_raw (msg, NULL, &e->data, &e->len) < 0) {
-            flux_log_error (cache->h, "content load");
-            goto error;
-        }
-        e->data_container = (void *)flux_msg_incref (msg);
-        e->valid = 1;
-        if (flux_msg_has_flag (msg, FLUX_MSGFLAG_USER1))
-            e->ephemeral = 1;
-        cache->acct_valid++;
-        cache->acct_size += e->len;
-        list_add (&cache->lru, &e->list);
-        e->lastused = flux_reactor_now (cache->reactor);
-        request_list_respond_raw (&e->load_requests,
-                                  cache->h,
-                                  e->ephemeral ? FLUX_MSGFLAG_USER1 : 0,
-                                  e->data,
-                                  e->len,
-                                  "load");
+    if (cache_entry_fill (cache, e, msg, from_parent) < 0) {
+        flux_log_error (cache->h, "content load");
+        goto error;
     }
+    if (from_parent && e->valid)
+        cache->acct_parent_load++;
     flux_future_destroy (f);
     return;
 error:
@@ -389,13 +847,73 @@ error:
     flux_future_destroy (f);
 }
 
-static int cache_load (struct content_cache *cache, struct cache_entry *e)
+/* Jump consistent hash (Lamping and Veach): map 'key' to one of 'buckets'
+ * such that growing the number of buckets moves only the keys that land
+ * in the new ones.
+ */
+static int jump_hash (uint64_t key, int buckets)
+{
+    int64_t b = -1;
+    int64_t j = 0;
+
+    while (j < buckets) {
+        b = j;
+        key = key * 2862933555777941757ULL + 1;
+        j = (b + 1) * ((double)(1LL << 31) / (double)((key >> 33) + 1));
+    }
+    return b;
+}
+
+/* Return the home rank of 'hash' if a miss should be sent there instead
+ * of upstream, or FLUX_NODEID_UPSTREAM.  A home that is this rank, rank 0,
+ * or a descendant of this rank is skipped, since the home forwards its
+ * own misses upstream, and a request that comes back to a rank that is
+ * waiting on it would never be answered.
+ */
+static uint32_t cache_home_rank (struct content_cache *cache, const void *hash)
+{
+    uint64_t key;
+    uint32_t home;
+
+    if (cache->home_count == 0 || !cache->subtree)
+        return FLUX_NODEID_UPSTREAM;
+    memcpy (&key, hash, sizeof (key));
+    home = cache->home_ranks[jump_hash (key, cache->home_count)];
+    if (home == cache->rank || home == 0 || idset_test (cache->subtree, home))
+        return FLUX_NODEID_UPSTREAM;
+    return home;
+}
+
+static int cache_load_home (struct content_cache *cache,
+                            struct cache_entry *e,
+                            uint32_t home)
+{
+    flux_future_t *f;
+
+    if (!(f = flux_rpc_raw (cache->h,
+                            "content.load",
+                            e->hash,
+                            content_hash_size,
+                            home,
+                            0))
+        || flux_future_aux_set (f, "entry", e, NULL) < 0
+        || flux_future_aux_set (f, "home", cache, NULL) < 0
+        || flux_future_then (f, -1., cache_load_continuation, cache) < 0) {
+        flux_future_destroy (f);
+        return -1;
+    }
+    stats_timing_start (cache, f);
+    e->load_pending = 1;
+    cache->acct_home_load++;
+    return 0;
+}
+
+static int cache_load_upstream (struct content_cache *cache,
+                                struct cache_entry *e)
 {
     flux_future_t *f;
     int flags = CONTENT_FLAG_UPSTREAM;
 
-    if (e->load_pending)
-        return 0;
     if (cache->rank == 0)
         flags = CONTENT_FLAG_CACHE_BYPASS;
     if (!(f = content_load_byhash (cache->h, e->hash, content_hash_size, flags))
@@ -405,59 +923,202 @@ static int cache_load (struct content_cache *cache, struct cache_entry *e)
         flux_future_destroy (f);
         return -1;
     }
+    stats_timing_start (cache, f);
+    e->load_pending = 1;
+    return 0;
+}
+
+static int cache_load (struct content_cache *cache, struct cache_entry *e)
+{
+    uint32_t home;
+
+    if (e->load_pending)
+        return 0;
+    if (cache->rank == 0) {
+        if (!cache->backing && cache->parent)
+            return cache_load_parent (cache, e);
+    }
+    else if ((home = cache_home_rank (cache, e->hash)) != FLUX_NODEID_UPSTREAM
+        && cache_load_home (cache, e, home) == 0)
+        return 0;
+    return cache_load_upstream (cache, e);
+}
+
+/* Load a blob that is missing from the backing store (rank 0) from the
+ * parent instance.  If the parent broker is on this node, first ask if the
+ * blob is in a file it has mapped, and if so, map it here too.
+ */
+static int cache_load_parent_copy (struct content_cache *cache,
+                                   struct cache_entry *e)
+{
+    flux_future_t *f;
+
+    if (!(f = content_parent_load (cache->parent, e->hash, content_hash_size))
+        || flux_future_aux_set (f, "entry", e, NULL) < 0
+        || flux_future_aux_set (f, "parent", cache->parent, NULL) < 0
+        || flux_future_then (f, -1., cache_load_continuation, cache) < 0) {
+        flux_log_error (cache->h, "content load from parent");
+        flux_future_destroy (f);
+        return -1;
+    }
+    e->load_pending = 1;
+    return 0;
+}
+
+static void cache_map_continuation (flux_future_t *f, void *arg)
+{
+    struct content_cache *cache = arg;
+    struct cache_entry *e = flux_future_aux_get (f, "entry");
+    struct content_region *region;
+    const char *path;
+    off_t offset;
+    const void *data;
+    int len;
+
+    e->load_pending = 0;
+    if (e->valid)
+        goto done;
+    if (content_parent_mmap_lookup_get (f, &path, &offset, &len) < 0
+        || !(region = content_mmap_region_map (cache->mmap,
+                                               path,
+                                               offset,
+                                               len,
+                                               e->hash,
+                                               content_hash_size,
+                                               &data))) {
+        if (cache_load_parent_copy (cache, e) < 0) {
+            request_list_respond_error (&e->load_requests,
+                                        cache->h,
+                                        ENOENT,
+                                        NULL,
+                                        "load");
+            cache_entry_remove (cache, e);
+        }
+        goto done;
+    }
+    cache_entry_set_region (cache, e, region, data, len);
+    content_mmap_region_decref (region);
+    cache->acct_parent_map++;
+    request_list_respond_load (&e->load_requests,
+                               cache->h,
+                               FLUX_MSGFLAG_USER1,
+                               e);
+done:
+    flux_future_destroy (f);
+}
+
+static int cache_load_parent (struct content_cache *cache,
+                              struct cache_entry *e)
+{
+    flux_future_t *f;
+
+    if (!content_parent_is_local (cache->parent))
+        return cache_load_parent_copy (cache, e);
+    if (!(f = content_parent_mmap_lookup (cache->parent,
+                                          e->hash,
+                                          content_hash_size))
+        || flux_future_aux_set (f, "entry", e, NULL) < 0
+        || flux_future_then (f, -1., cache_map_continuation, cache) < 0) {
+        flux_log_error (cache->h, "content load from parent");
+        flux_future_destroy (f);
+        return -1;
+    }
     e->load_pending = 1;
     return 0;
 }
 
+/* Look up 'hash', creating an invalid entry if not found.  On rank 0,
+ * an entry for content of a mapped file is made valid immediately.
+ * Returns entry on success, or NULL with errno set (ENOENT if the blob
+ * cannot be found because there is no backing store).
+ */
+static struct cache_entry *cache_entry_fetch (struct content_cache *cache,
+                                              const void *hash,
+                                              int hash_size)
+{
+    struct cache_entry *e;
+    struct content_region *region = NULL;
+    const void *data = NULL;
+    int len = 0;
+
+    if ((e = cache_entry_lookup (cache, hash, hash_size)))
+        return e;
+    if (cache->rank == 0) {
+        region = content_mmap_region_lookup (cache->mmap,
+                                             hash,
+                                             hash_size,
+                                             &data,
+                                             &len);
+        if (!region && !cache->backing && !cache->parent) {
+            errno = ENOENT;
+            return NULL;
+        }
+    }
+    if (!(e = cache_entry_insert (cache, hash, hash_size)))
+        return NULL;
+    if (region)
+        cache_entry_set_region (cache, e, region, data, len);
+    return e;
+}
+
+/* Start loading hinted entries that are not cached.  Errors are ignored
+ * since the requestor will ask for the blobs again if it needs them.
+ */
+static void cache_prefetch (struct content_cache *cache,
+                            const uint8_t *hashes,
+                            int count)
+{
+    struct cache_entry *e;
+    int i;
+
+    if (count > prefetch_max)
+        count = prefetch_max;
+    for (i = 0; i < count; i++) {
+        const void *hash = hashes + i * content_hash_size;
+
+        // N.B. a hint is not a use, so don't touch cached entries
+        if (hashmap_lookup (cache->entries, hash))
+            continue;
+        if ((e = cache_entry_fetch (cache, hash, content_hash_size))
+            && !e->valid) {
+            if (cache_load (cache, e) < 0) {
+                if (!e->load_requests)
+                    cache_entry_remove (cache, e);
+                continue;
+            }
+            cache->acct_prefetch++;
+        }
+    }
+}
+
 static void content_load_request (flux_t *h,
                                   flux_msg_handler_t *mh,
                                   const flux_msg_t *msg,
                                   void *arg)
 {
     struct content_cache *cache = arg;
-    const void *hash;
+    const uint8_t *hash;
     int hash_size;
+    int hint_count;
     struct cache_entry *e;
     const char *errmsg = NULL;
 
-    if (flux_request_decode_raw (msg, NULL, &hash, &hash_size) < 0)
+    if (flux_request_decode_raw (msg, NULL, (const void **)&hash, &hash_size)
+        < 0)
         goto error;
-    if (hash_size != content_hash_size) {
+    if (hash_size == 0 || hash_size % content_hash_size != 0) {
         errno = EPROTO;
         goto error;
     }
-    if (!(e = cache_entry_lookup (cache, hash, hash_size))) {
-        struct content_region *region = NULL;
-        const void *data = NULL;
-        int len = 0;
-
-        if (cache->rank == 0) {
-            region = content_mmap_region_lookup (cache->mmap,
-                                                 hash,
-                                                 hash_size,
-                                                 &data,
-                                                 &len);
-            if (!region && !cache->backing) {
-                errno = ENOENT;
-                goto error;
-            }
-        }
-        if (!(e = cache_entry_insert (cache, hash, hash_size))) {
+    hint_count = hash_size / content_hash_size - 1;
+    if (flux_msg_is_noresponse (msg)) {
+        cache_prefetch (cache, hash, hint_count + 1);
+        return;
+    }
+    if (!(e = cache_entry_fetch (cache, hash, content_hash_size))) {
+        if (errno != ENOENT)
             flux_log_error (h, "content load");
-            goto error;
-        }
-        if (region) {
-            e->data_container = content_mmap_region_incref (region);
-            e->data = data;
-            e->len = len;
-            e->valid = 1;
-            e->ephemeral = 1;
-            e->mmapped = 1;
-            cache->acct_valid++;
-            cache->acct_size += e->len;
-            list_add (&cache->lru, &e->list);
-            e->lastused = flux_reactor_now (cache->reactor);
-        }
+        goto error;
     }
     if (!e->valid) {
         if (cache_load (cache, e) < 0)
@@ -466,8 +1127,12 @@ static void content_load_request (flux_t *h,
             flux_log_error (h, "content load");
             goto error;
         }
+        if (hint_count > 0)
+            cache_prefetch (cache, hash + content_hash_size, hint_count);
         return; /* RPC continuation will respond to msg */
     }
+    if (hint_count > 0)
+        cache_prefetch (cache, hash + content_hash_size, hint_count);
     if (e->valid && e->mmapped) { // rank 0 only
         if (!content_mmap_validate (e->data_container,
                                     e->hash,
@@ -485,7 +1150,7 @@ static void content_load_request (flux_t *h,
      */
     flux_msg_t *response;
     if (!(response = flux_response_derive (msg, 0))
-        || flux_msg_set_payload (response, e->data, e->len) < 0
+        || set_payload_entry (response, e) < 0
         || (e->ephemeral
             && flux_msg_set_flag (response, FLUX_MSGFLAG_USER1) < 0)
         || flux_send (h, response, 0) < 0) {
@@ -523,6 +1188,7 @@ error:
  */
 static void cache_resume_flush (struct content_cache *cache)
 {
+    checkpoints_durable (cache->checkpoint);
     if (cache->acct_dirty == 0 || (cache->rank == 0 && !cache->backing))
         flush_respond (cache);
     else
@@ -539,6 +1205,7 @@ static void cache_store_continuation (flux_future_t *f, void *arg)
     e->store_pending = 0;
     assert (cache->flush_batch_count > 0);
     cache->flush_batch_count--;
+    stats_timing_end (cache, f, "content-cache.store");
     if (content_store_get_hash (f, &hash, &hash_size) < 0) {
         if (cache->rank == 0 && errno == ENOSYS) {
             flux_log (cache->h,
@@ -608,35 +1275,26 @@ static int cache_store (struct content_cache *cache, struct cache_entry *e)
         flux_future_destroy (f);
         return -1;
     }
+    stats_timing_start (cache, f);
     e->store_pending = 1;
     cache->flush_batch_count++;
     return 0;
 }
 
-static void content_store_request (flux_t *h,
-                                   flux_msg_handler_t *mh,
-                                   const flux_msg_t *msg,
-                                   void *arg)
+/* Find or create the cache entry for 'data' (contained in request 'msg'),
+ * and fill it if it is not yet valid.  The holder for 'msg' is created on
+ * first use and shared by all entries filled from the same message.
+ */
+static struct cache_entry *cache_store_entry (struct content_cache *cache,
+                                              const flux_msg_t *msg,
+                                              struct blob_holder **bhp,
+                                              const void *data,
+                                              int len,
+                                              const void *hash,
+                                              int hash_size)
 {
-    struct content_cache *cache = arg;
-    const void *data;
-    int len;
-    struct cache_entry *e = NULL;
-    uint8_t hash[BLOBREF_MAX_DIGEST_SIZE];
-    int hash_size;
+    struct cache_entry *e;
 
-    if (flux_request_decode_raw (msg, NULL, &data, &len) < 0)
-        goto error;
-    if (len > cache->blob_size_limit) {
-        errno = EFBIG;
-        goto error;
-    }
-    if ((hash_size = blobref_hash_raw (cache->hash_name,
-                                       data,
-                                       len,
-                                       hash,
-                                       sizeof (hash))) < 0)
-        goto error;
     /* If existing entry has the ephemeral bit set, remove it and let it be
      * replaced with a new entry.  N.B. it can be assumed that an entry with
      * the ephemeral bit set is valid and not dirty.
@@ -648,7 +1306,7 @@ static void content_store_request (flux_t *h,
     }
     if (!e) {
         if (!(e = cache_entry_insert (cache, hash, hash_size)))
-            goto error;
+            return NULL;
     }
     /* Fill invalid cache entry, which may have been just created above,
      * or could be there because a load was requested and it still awaits
@@ -657,21 +1315,56 @@ static void content_store_request (flux_t *h,
      */
     if (!e->valid) {
         assert (!e->data_container);
+        if (*bhp)
+            e->data_container = blob_holder_incref (*bhp);
+        else if (!(e->data_container = *bhp = blob_holder_create (msg)))
+            return NULL;
         e->data = data;
         e->len = len;
-        e->data_container = (void *)flux_msg_incref (msg);
         e->valid = 1;
-        e->dirty = 1;
         cache->acct_valid++;
         cache->acct_size += e->len;
-        cache->acct_dirty++;
-        request_list_respond_raw (&e->load_requests,
-                                  cache->h,
-                                  0,
-                                  e->data,
-                                  e->len,
-                                  "load");
+        cache_entry_dirty_set (cache, e);
+        request_list_respond_load (&e->load_requests, cache->h, 0, e);
+    }
+    /* While garbage collection is in progress, the blob may be about to be
+     * swept from the backing store even though it is referenced again.
+     * Store it again so the backing store protects it.
+     */
+    else if (!e->dirty && content_gc_active (cache->gc)) {
+        cache_entry_lru_del (cache, e);
+        cache_entry_dirty_set (cache, e);
+    }
+    return e;
+}
+
+static void content_store_request (flux_t *h,
+                                   flux_msg_handler_t *mh,
+                                   const flux_msg_t *msg,
+                                   void *arg)
+{
+    struct content_cache *cache = arg;
+    const void *data;
+    int len;
+    struct cache_entry *e = NULL;
+    struct blob_holder *bh = NULL;
+    uint8_t hash[BLOBREF_MAX_DIGEST_SIZE];
+    int hash_size;
+
+    if (flux_request_decode_raw (msg, NULL, &data, &len) < 0)
+        goto error;
+    if (len > cache->blob_size_limit) {
+        errno = EFBIG;
+        goto error;
     }
+    if ((hash_size = blobref_hash_raw (cache->hash_name,
+                                       data,
+                                       len,
+                                       hash,
+                                       sizeof (hash))) < 0)
+        goto error;
+    if (!(e = cache_store_entry (cache, msg, &bh, data, len, hash, hash_size)))
+        goto error;
     if (e->dirty) {
         if (cache->rank > 0 || cache->backing) {
             if (cache_store (cache, e) < 0)
@@ -697,6 +1390,106 @@ error:
         flux_log_error (h, "content store: flux_respond_error");
 }
 
+/* Store many blobs with one request (rank 0 only).  The request payload
+ * is a sequence of blobs, each preceded by its length as a 4 byte integer
+ * in network byte order.  The response payload is the concatenated hash
+ * digests of the blobs, in request order.  Like content.store on rank 0,
+ * the response is sent as soon as the blobs are in the cache.
+ */
+static void content_store_batch_request (flux_t *h,
+                                         flux_msg_handler_t *mh,
+                                         const flux_msg_t *msg,
+                                         void *arg)
+{
+    struct content_cache *cache = arg;
+    const char *errstr = NULL;
+    const uint8_t *payload;
+    int payload_len;
+    struct blob_holder *bh = NULL;
+    uint8_t *hashes = NULL;
+    int count = 0;
+    int offset;
+
+    if (flux_request_decode_raw (msg,
+                                 NULL,
+                                 (const void **)&payload,
+                                 &payload_len) < 0)
+        goto error;
+    if (cache->rank != 0) {
+        errno = EINVAL;
+        errstr = "content.store-batch is only available on rank 0";
+        goto error;
+    }
+    /* First pass: validate lengths and count blobs.
+     */
+    offset = 0;
+    while (offset < payload_len) {
+        uint32_t len;
+
+        if (payload_len - offset < sizeof (len)) {
+            errno = EPROTO;
+            goto error;
+        }
+        memcpy (&len, payload + offset, sizeof (len));
+        len = ntohl (len);
+        offset += sizeof (len);
+        if (len > payload_len - offset) {
+            errno = EPROTO;
+            goto error;
+        }
+        if (len > cache->blob_size_limit) {
+            errno = EFBIG;
+            goto error;
+        }
+        offset += len;
+        count++;
+    }
+    if (count > 0 && !(hashes = malloc (count * content_hash_size)))
+        goto error;
+    /* Second pass: store blobs.
+     */
+    offset = 0;
+    for (int i = 0; i < count; i++) {
+        uint8_t *hash = hashes + i * content_hash_size;
+        struct cache_entry *e;
+        uint32_t len;
+
+        memcpy (&len, payload + offset, sizeof (len));
+        len = ntohl (len);
+        offset += sizeof (len);
+        if (blobref_hash_raw (cache->hash_name,
+                              payload + offset,
+                              len,
+                              hash,
+                              content_hash_size) < 0
+            || !(e = cache_store_entry (cache,
+                                        msg,
+                                        &bh,
+                                        payload + offset,
+                                        len,
+                                        hash,
+                                        content_hash_size)))
+            goto error;
+        if (e->dirty) {
+            if (cache->backing) {
+                if (cache_store (cache, e) < 0)
+                    goto error;
+            }
+            else
+                flush_list_append (cache, e);
+        }
+        offset += len;
+    }
+    if (flux_respond_raw (h, msg, hashes, count * content_hash_size) < 0)
+        flux_log_error (h, "content store-batch: flux_respond_raw");
+    free (hashes);
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, errstr) < 0)
+        flux_log_error (h, "content store-batch: flux_respond_error");
+    free (hashes);
+}
+
 /* Backing store is enabled/disabled by modules that provide the
  * 'content.backing' service.  At module load time, the backing module
  * informs the content service of its availability, and entries are
@@ -808,6 +1601,10 @@ static void content_unregister_backing_request (flux_t *h,
                                     NULL,
                                     "flush");
     }
+    /* Checkpoints waiting for blobs to become durable are kept in the
+     * cache, as when no backing store is loaded.
+     */
+    checkpoints_durable (cache->checkpoint);
     return;
 error:
     if (flux_respond_error (h, msg, errno, errstr) < 0)
@@ -815,8 +1612,8 @@ error:
 }
 
 /* Forcibly drop all entries from the cache that can be dropped
- * without data loss.  Use the LRU for this since all entries are
- * valid and clean.
+ * without data loss.  Use the replacement lists for this since all
+ * entries on them are valid and clean.
  */
 
 static void content_dropcache_request (flux_t *h,
@@ -829,14 +1626,23 @@ static void content_dropcache_request (flux_t *h,
     struct cache_entry *e = NULL;
     struct cache_entry *next;
 
-    orig_size = zhashx_size (cache->entries);
+    struct list_head *lists[] = {
+        &cache->probation,
+        &cache->protected,
+        &cache->pinned,
+    };
 
-    list_for_each_safe (&cache->lru, e, next, list) {
-        cache_entry_remove (cache, e);
+    orig_size = hashmap_size (cache->entries);
+
+    for (int i = 0; i < ARRAY_SIZE (lists); i++) {
+        list_for_each_safe (lists[i], e, next, list) {
+            if (!e->load_pending)
+                cache_entry_remove (cache, e);
+        }
     }
 
     flux_log (h, LOG_DEBUG, "content dropcache %d/%d",
-              orig_size - (int)zhashx_size (cache->entries), orig_size);
+              orig_size - (int)hashmap_size (cache->entries), orig_size);
     if (flux_respond (h, msg, NULL) < 0)
         flux_log_error (h, "content dropcache");
 }
@@ -854,11 +1660,21 @@ static void content_stats_request (flux_t *h,
 
     if (flux_respond_pack (h,
                            msg,
-                           "{s:i s:i s:i s:I s:i s:O}",
-                           "count", zhashx_size (cache->entries),
+                           "{s:i s:i s:i s:I s:I s:I s:i s:I s:i"
+                           " s:I s:I s:I s:I s:i s:O}",
+                           "count", (int)hashmap_size (cache->entries),
                            "valid", cache->acct_valid,
                            "dirty", cache->acct_dirty,
                            "size", cache->acct_size,
+                           "probation-size", cache->acct_probation_size,
+                           "protected-size", cache->acct_protected_size,
+                           "pinned", cache->acct_pinned,
+                           "pinned-size", cache->acct_pinned_size,
+                           "ghosts", (int)hashmap_size (cache->ghosts),
+                           "prefetch", cache->acct_prefetch,
+                           "parent-load", cache->acct_parent_load,
+                           "parent-map", cache->acct_parent_map,
+                           "home-load", cache->acct_home_load,
                            "flush-batch-count", cache->flush_batch_count,
                            "mmap", o ? o : json_null ()) < 0)
         flux_log_error (h, "content stats");
@@ -926,30 +1742,30 @@ error:
 
 static void cache_purge (struct content_cache *cache)
 {
-    double now = flux_reactor_now (cache->reactor);
-    struct cache_entry *e = NULL;
-    struct cache_entry *next;
+    double cutoff = flux_reactor_now (cache->reactor) - cache->purge_old_entry;
+    struct cache_entry *e;
 
-    list_for_each_rev_safe (&cache->lru, e, next, list) {
-        if (cache->acct_size <= cache->purge_target_size
-            || now - e->lastused < cache->purge_old_entry)
-            break;
-        assert (e->valid);
-        assert (!e->dirty);
+    cache_evict (cache, cache->purge_target_size, cutoff);
+
+    /* Pinned entries do not count towards the purge target, but they hold
+     * a reference on their region, so drop them once they are old.
+     */
+    while ((e = lru_tail (&cache->pinned, cutoff)))
         cache_entry_remove (cache, e);
-    }
 }
 
 static void update_stats (struct content_cache *cache)
 {
     flux_stats_gauge_set (cache->h, "content-cache.count",
-        (int) zhashx_size (cache->entries));
+        (int) hashmap_size (cache->entries));
     flux_stats_gauge_set (cache->h, "content-cache.valid",
         cache->acct_valid);
     flux_stats_gauge_set (cache->h, "content-cache.dirty",
         cache->acct_dirty);
     flux_stats_gauge_set (cache->h, "content-cache.size",
         cache->acct_size);
+    flux_stats_gauge_set (cache->h, "content-cache.pinned-size",
+        cache->acct_pinned_size);
     flux_stats_gauge_set (cache->h, "content-cache.flush-batch-count",
         cache->flush_batch_count);
 }
@@ -971,6 +1787,20 @@ bool content_cache_backing_loaded (struct content_cache *cache)
     return cache->backing;
 }
 
+uint64_t content_cache_dirty_seq (struct content_cache *cache)
+{
+    return cache->dirty_seq;
+}
+
+uint64_t content_cache_durable_seq (struct content_cache *cache)
+{
+    struct cache_entry *e;
+
+    if ((e = list_top (&cache->dirty, struct cache_entry, dirty_list)))
+        return e->dirty_seq - 1;
+    return cache->dirty_seq;
+}
+
 /* Initialization
  */
 
@@ -987,6 +1817,12 @@ static const struct flux_msg_handler_spec htab[] = {
         content_store_request,
         0
     },
+    {
+        FLUX_MSGTYPE_REQUEST,
+        "content.store-batch",
+        content_store_batch_request,
+        0
+    },
     {
         FLUX_MSGTYPE_REQUEST,
         "content.unregister-backing",
@@ -1038,6 +1874,28 @@ static int get_hash_name (struct content_cache *cache)
     return 0;
 }
 
+/* If the content.parent-fallback attribute is set and this instance was
+ * run as a job, blobs missing from the backing store are loaded from the
+ * parent instance.  A parent that cannot be reached is logged and ignored.
+ */
+static void get_parent (struct content_cache *cache)
+{
+    const char *s;
+    const char *uri;
+
+    if (!(s = flux_attr_get (cache->h, "content.parent-fallback"))
+        || streq (s, "0")
+        || !(uri = flux_attr_get (cache->h, "parent-uri")))
+        return;
+    if (!(cache->parent = content_parent_create (cache->h,
+                                                 uri,
+                                                 cache->hash_name))) {
+        flux_log_error (cache->h,
+                        "content.parent-fallback: error connecting to %s",
+                        uri);
+    }
+}
+
 static int parse_u32 (const char *s, uint32_t *val)
 {
     unsigned long u;
@@ -1070,6 +1928,13 @@ int parse_args (struct content_cache *cache, int argc, char **argv)
             }
             cache->purge_old_entry = val;
         }
+        else if (strstarts (argv[i], "purge-max-size=")) {
+            if (parse_u32 (argv[i] + 15, &val) < 0) {
+                flux_log (cache->h, LOG_ERR, "error parsing %s", argv[i]);
+                return -1;
+            }
+            cache->purge_max_size = val;
+        }
         else if (strstarts (argv[i], "flush-batch-limit=")) {
             if (parse_u32 (argv[i] + 18, &val) < 0) {
                 flux_log (cache->h, LOG_ERR, "error parsing %s", argv[i]);
@@ -1077,6 +1942,20 @@ int parse_args (struct content_cache *cache, int argc, char **argv)
             }
             cache->purge_old_entry = val;
         }
+        else if (strstarts (argv[i], "gc-interval=")) {
+            if (parse_u32 (argv[i] + 12, &val) < 0) {
+                flux_log (cache->h, LOG_ERR, "error parsing %s", argv[i]);
+                return -1;
+            }
+            cache->gc_interval = val;
+        }
+        else if (strstarts (argv[i], "gc-batch-size=")) {
+            if (parse_u32 (argv[i] + 14, &val) < 0 || val == 0) {
+                flux_log (cache->h, LOG_ERR, "error parsing %s", argv[i]);
+                return -1;
+            }
+            cache->gc_batch_size = val;
+        }
         else if (strstarts (argv[i], "blob-size-limit=")) {
             if (parse_u32 (argv[i] + 16, &val) < 0) {
                 flux_log (cache->h, LOG_ERR, "error parsing %s", argv[i]);
@@ -1099,49 +1978,160 @@ void content_cache_destroy (struct content_cache *cache)
         flux_future_destroy (cache->f_sync);
         flux_msg_handler_delvec (cache->handlers);
         free (cache->backing_name);
-        zhashx_destroy (&cache->entries);
+        hashmap_destroy (cache->entries);
+        hashmap_destroy (cache->ghosts);
         msgstack_destroy (&cache->flush_requests);
+        content_gc_destroy (cache->gc);
         content_checkpoint_destroy (cache->checkpoint);
+        content_parent_destroy (cache->parent);
         content_mmap_destroy (cache->mmap);
+        flux_future_destroy (cache->f_topology);
+        idset_destroy (cache->subtree);
+        free (cache->home_ranks);
         free (cache->hash_name);
         free (cache);
         errno = saved_errno;
     }
 }
 
+/* Add the ranks of the descendants of topology object 'topo' (see
+ * overlay.topology) to 'ids'.
+ */
+static int topology_add_descendants (json_t *topo, struct idset *ids)
+{
+    json_t *children = NULL;
+    size_t index;
+    json_t *entry;
+
+    (void)json_unpack (topo, "{s?o}", "children", &children);
+    json_array_foreach (children, index, entry) {
+        int rank;
+        if (json_unpack (entry, "{s:i}", "rank", &rank) < 0) {
+            errno = EPROTO;
+            return -1;
+        }
+        if (idset_set (ids, rank) < 0
+            || topology_add_descendants (entry, ids) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/* Home ranks are not used until the subtree of this rank is known.
+ */
+static void topology_continuation (flux_future_t *f, void *arg)
+{
+    struct content_cache *cache = arg;
+    json_t *topo;
+    struct idset *ids;
+
+    if (flux_rpc_get_unpack (f, "o", &topo) < 0
+        || !(ids = idset_create (0, IDSET_FLAG_AUTOGROW))) {
+        flux_log_error (cache->h, "content.home-ranks: overlay.topology");
+        return;
+    }
+    if (topology_add_descendants (topo, ids) < 0) {
+        flux_log_error (cache->h, "content.home-ranks: overlay.topology");
+        idset_destroy (ids);
+        return;
+    }
+    cache->subtree = ids;
+}
+
+/* If the content.home-ranks attribute is set to an idset, e.g. the
+ * interior ranks of the TBON, each blob is assigned a home among those
+ * ranks by consistent hashing of its digest, and ranks > 0 send misses
+ * to the home rank rather than upstream.  The home caches the blob and
+ * loads its own misses upstream as usual, spreading the load that would
+ * otherwise fall on rank 0 across the tree.
+ */
+static int get_home_ranks (struct content_cache *cache)
+{
+    const char *s;
+    struct idset *ids;
+    unsigned int id;
+
+    if (cache->rank == 0
+        || !(s = flux_attr_get (cache->h, "content.home-ranks"))
+        || strlen (s) == 0)
+        return 0;
+    if (!(ids = idset_decode (s))) {
+        flux_log (cache->h, LOG_ERR, "content.home-ranks: invalid idset");
+        errno = EINVAL;
+        return -1;
+    }
+    if (!(cache->home_ranks = calloc (idset_count (ids) + 1,
+                                      sizeof (cache->home_ranks[0])))) {
+        idset_destroy (ids);
+        return -1;
+    }
+    id = idset_first (ids);
+    while (id != IDSET_INVALID_ID) {
+        cache->home_ranks[cache->home_count++] = id;
+        id = idset_next (ids, id);
+    }
+    idset_destroy (ids);
+    if (cache->home_count > 0) {
+        if (!(cache->f_topology = flux_rpc_pack (cache->h,
+                                                 "overlay.topology",
+                                                 FLUX_NODEID_ANY,
+                                                 0,
+                                                 "{s:i}",
+                                                 "rank", cache->rank))
+            || flux_future_then (cache->f_topology,
+                                 -1.,
+                                 topology_continuation,
+                                 cache) < 0)
+            return -1;
+    }
+    return 0;
+}
+
 struct content_cache *content_cache_create (flux_t *h, int argc, char **argv)
 {
     struct content_cache *cache;
 
     if (!(cache = calloc (1, sizeof (*cache))))
         return NULL;
-    if (!(cache->entries = zhashx_new ()))
-        goto nomem;
     cache->h = h;
     cache->reactor = flux_get_reactor (h);
-
-    zhashx_set_destructor (cache->entries, cache_entry_destructor);
-    zhashx_set_key_hasher (cache->entries, cache_entry_hasher);
-    zhashx_set_key_comparator (cache->entries, cache_entry_comparator);
-    zhashx_set_key_destructor (cache->entries, NULL); // key is part of entry
-    zhashx_set_key_duplicator (cache->entries, NULL); // key is part of entry
-
     cache->rank = FLUX_NODEID_ANY;
     cache->blob_size_limit = default_blob_size_limit;
     cache->flush_batch_limit = default_flush_batch_limit;
     cache->purge_target_size = default_cache_purge_target_size;
     cache->purge_old_entry = default_cache_purge_old_entry;
+    cache->purge_max_size = default_cache_purge_max_size;
+    cache->gc_interval = default_gc_interval;
+    cache->gc_batch_size = default_gc_batch_size;
     /* Some tunables may be set on the module command line (mainly for test).
      */
     if (parse_args (cache, argc, argv) < 0) {
         errno = EINVAL;
         goto error;
     }
+    if (cache->purge_max_size < cache->purge_target_size)
+        cache->purge_max_size = cache->purge_target_size;
     if (get_hash_name (cache) < 0)
         goto error;
 
-    list_head_init (&cache->lru);
+    /* Keys are hash digests, copied into the table.
+     */
+    if (!(cache->entries = hashmap_create (content_hash_size,
+                                           cache_entry_hasher,
+                                           NULL))
+        || !(cache->ghosts = hashmap_create (content_hash_size,
+                                             cache_entry_hasher,
+                                             NULL)))
+        goto nomem;
+    hashmap_set_destructor (cache->entries, cache_entry_destructor);
+    hashmap_set_destructor (cache->ghosts, ghost_destructor);
+
+    list_head_init (&cache->probation);
+    list_head_init (&cache->protected);
+    list_head_init (&cache->pinned);
     list_head_init (&cache->flush);
+    list_head_init (&cache->dirty);
+    list_head_init (&cache->ghost_list);
 
     if (flux_get_rank (h, &cache->rank) < 0)
         goto error;
@@ -1155,10 +2145,20 @@ struct content_cache *content_cache_create (flux_t *h, int argc, char **argv)
                                                  cache->hash_name,
                                                  content_hash_size)))
             goto error;
+        get_parent (cache);
+        if (!(cache->gc = content_gc_create (h,
+                                             content_hash_size,
+                                             cache->checkpoint,
+                                             cache->gc_batch_size,
+                                             cache->gc_interval)))
+            goto error;
     }
+    if (get_home_ranks (cache) < 0)
+        goto error;
     if (flux_msg_handler_addvec (h, htab, cache, &cache->handlers) < 0)
         goto error;
     if (!(cache->f_sync = flux_sync_create (h, 0))
+        || flux_sync_set_jitter (cache->f_sync, sync_max) < 0
         || flux_future_then (cache->f_sync, sync_max, sync_cb, cache) < 0)
         goto error;
     return cache;
@@ -17,6 +17,13 @@ struct content_cache *content_cache_create (flux_t *h, int argc, char **argv);
 void content_cache_destroy (struct content_cache *cache);
 bool content_cache_backing_loaded (struct content_cache *cache);
 
+/* Entries are numbered as they become dirty.  Return the number of the
+ * most recently dirtied entry, and the number at or below which all
+ * entries have been stored (upstream, or to the backing store on rank 0).
+ */
+uint64_t content_cache_dirty_seq (struct content_cache *cache);
+uint64_t content_cache_durable_seq (struct content_cache *cache);
+
 #endif /* !_CONTENT_CACHE_H */
 
 /*
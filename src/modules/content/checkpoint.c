@@ -19,6 +19,7 @@
 #include <flux/core.h>
 
 #include "src/common/libczmqcontainers/czmq_containers.h"
+#include "ccan/str/str.h"
 
 #include "checkpoint.h"
 #include "cache.h"
@@ -30,6 +31,18 @@ struct content_checkpoint {
     struct content_cache *cache;
     zhashx_t *hash;
     unsigned int hash_dirty;
+    zlist_t *deferred;          // durable puts waiting for blobs to be stored
+};
+
+/* A checkpoint-put request with the "durable" flag is deferred on rank 0
+ * until all blobs that were dirty when it arrived have been stored to the
+ * backing store, so the checkpoint never refers to a blob that could be
+ * lost, yet no flush is needed.  Blobs stored after the request arrived
+ * do not hold it up.
+ */
+struct deferred_put {
+    const flux_msg_t *msg;
+    uint64_t seq;
 };
 
 struct checkpoint_data {
@@ -271,13 +284,63 @@ error:
     return -1;
 }
 
-void content_checkpoint_put_request (flux_t *h, flux_msg_handler_t *mh,
-                                     const flux_msg_t *msg, void *arg)
+static void deferred_put_destroy (struct deferred_put *dp)
+{
+    if (dp) {
+        int saved_errno = errno;
+        flux_msg_decref (dp->msg);
+        free (dp);
+        errno = saved_errno;
+    }
+}
+
+static int checkpoint_defer (struct content_checkpoint *checkpoint,
+                             const flux_msg_t *msg)
+{
+    struct deferred_put *dp;
+
+    if (!(dp = calloc (1, sizeof (*dp))))
+        return -1;
+    dp->msg = flux_msg_incref (msg);
+    dp->seq = content_cache_dirty_seq (checkpoint->cache);
+    if (zlist_append (checkpoint->deferred, dp) < 0) {
+        deferred_put_destroy (dp);
+        errno = ENOMEM;
+        return -1;
+    }
+    return 0;
+}
+
+/* A put without the durable flag supersedes deferred puts to the same
+ * key, which would otherwise overwrite it with an older checkpoint.
+ * Their requestors are told they succeeded, since the newer checkpoint
+ * covers theirs.
+ */
+static void checkpoint_supersede (struct content_checkpoint *checkpoint,
+                                  const char *key)
+{
+    struct deferred_put *dp = zlist_first (checkpoint->deferred);
+
+    while (dp) {
+        const char *k;
+        if (flux_request_unpack (dp->msg, NULL, "{s:s}", "key", &k) == 0
+            && streq (k, key)) {
+            if (flux_respond (checkpoint->h, dp->msg, NULL) < 0)
+                flux_log_error (checkpoint->h,
+                                "error responding to checkpoint-put");
+            zlist_remove (checkpoint->deferred, dp);
+            deferred_put_destroy (dp);
+        }
+        dp = zlist_next (checkpoint->deferred);
+    }
+}
+
+static int checkpoint_put (struct content_checkpoint *checkpoint,
+                           const flux_msg_t *msg,
+                           const char **errstr)
 {
-    struct content_checkpoint *checkpoint = arg;
     const char *key;
     json_t *value;
-    const char *errstr = NULL;
 
     if (flux_request_unpack (msg,
                              NULL,
@@ -286,24 +349,83 @@ void content_checkpoint_put_request (flux_t *h, flux_msg_handler_t *mh,
                              &key,
                              "value",
                              &value) < 0)
-        goto error;
+        return -1;
 
     if (checkpoint->rank == 0) {
         if (checkpoint_data_update (checkpoint, key, value) < 0)
-            goto error;
+            return -1;
 
         if (!content_cache_backing_loaded (checkpoint->cache)) {
-            if (flux_respond (h, msg, NULL) < 0)
+            if (flux_respond (checkpoint->h, msg, NULL) < 0)
                 flux_log_error (checkpoint->h, "error responding to checkpoint-put");
+            return 0;
+        }
+    }
+
+    return checkpoint_put_forward (checkpoint, msg, key, value, errstr);
+}
+
+/* Called when blobs have been stored, or the backing store unloaded.
+ * Deferred puts are in order of 'seq', so stop at the first one whose
+ * blobs are not all stored yet.
+ */
+void checkpoints_durable (struct content_checkpoint *checkpoint)
+{
+    struct deferred_put *dp;
+    uint64_t durable_seq;
+
+    if (!checkpoint)
+        return;
+    durable_seq = content_cache_durable_seq (checkpoint->cache);
+    while ((dp = zlist_first (checkpoint->deferred))
+           && (dp->seq <= durable_seq
+               || !content_cache_backing_loaded (checkpoint->cache))) {
+        const char *errstr = NULL;
+
+        zlist_remove (checkpoint->deferred, dp);
+        if (checkpoint_put (checkpoint, dp->msg, &errstr) < 0) {
+            if (flux_respond_error (checkpoint->h, dp->msg, errno, errstr) < 0)
+                flux_log_error (checkpoint->h,
+                                "error responding to checkpoint-put request");
+        }
+        deferred_put_destroy (dp);
+    }
+}
+
+void content_checkpoint_put_request (flux_t *h, flux_msg_handler_t *mh,
+                                     const flux_msg_t *msg, void *arg)
+{
+    struct content_checkpoint *checkpoint = arg;
+    const char *key;
+    json_t *value;
+    int durable = 0;
+    const char *errstr = NULL;
+
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s:s s:o s?b}",
+                             "key",
+                             &key,
+                             "value",
+                             &value,
+                             "durable",
+                             &durable) < 0)
+        goto error;
+
+    if (checkpoint->rank == 0) {
+        if (durable
+            && content_cache_backing_loaded (checkpoint->cache)
+            && content_cache_durable_seq (checkpoint->cache)
+               < content_cache_dirty_seq (checkpoint->cache)) {
+            if (checkpoint_defer (checkpoint, msg) < 0)
+                goto error;
             return;
         }
+        if (!durable)
+            checkpoint_supersede (checkpoint, key);
     }
 
-    if (checkpoint_put_forward (checkpoint,
-                                msg,
-                                key,
-                                value,
-                                &errstr) < 0)
+    if (checkpoint_put (checkpoint, msg, &errstr) < 0)
         goto error;
 
     return;
@@ -379,6 +501,35 @@ int checkpoints_flush (struct content_checkpoint *checkpoint)
     return rc;
 }
 
+/* Return an array of the rootrefs of all checkpoints known to the cache,
+ * including those not yet flushed to the backing store.
+ */
+json_t *checkpoints_get_rootrefs (struct content_checkpoint *checkpoint)
+{
+    struct checkpoint_data *data;
+    json_t *rootrefs;
+
+    if (!(rootrefs = json_array ()))
+        goto nomem;
+    data = zhashx_first (checkpoint->hash);
+    while (data) {
+        const char *rootref;
+        json_t *o;
+
+        if (json_unpack (data->value, "{s:s}", "rootref", &rootref) == 0) {
+            if (!(o = json_string (rootref))
+                || json_array_append_new (rootrefs, o) < 0)
+                goto nomem;
+        }
+        data = zhashx_next (checkpoint->hash);
+    }
+    return rootrefs;
+nomem:
+    json_decref (rootrefs);
+    errno = ENOMEM;
+    return NULL;
+}
+
 static const struct flux_msg_handler_spec htab[] = {
     {
         FLUX_MSGTYPE_REQUEST,
@@ -400,6 +551,19 @@ void content_checkpoint_destroy (struct content_checkpoint *checkpoint)
     if (checkpoint) {
         int saved_errno = errno;
         flux_msg_handler_delvec (checkpoint->handlers);
+        if (checkpoint->deferred) {
+            struct deferred_put *dp;
+            while ((dp = zlist_pop (checkpoint->deferred))) {
+                if (flux_respond_error (checkpoint->h,
+                                        dp->msg,
+                                        ENOSYS,
+                                        "content module is unloading") < 0)
+                    flux_log_error (checkpoint->h,
+                                    "error responding to checkpoint-put");
+                deferred_put_destroy (dp);
+            }
+            zlist_destroy (&checkpoint->deferred);
+        }
         zhashx_destroy (&checkpoint->hash);
         free (checkpoint);
         errno = saved_errno;
@@ -419,7 +583,8 @@ struct content_checkpoint *content_checkpoint_create (
     checkpoint->rank = rank;
     checkpoint->cache = cache;
 
-    if (!(checkpoint->hash = zhashx_new ()))
+    if (!(checkpoint->hash = zhashx_new ())
+        || !(checkpoint->deferred = zlist_new ()))
         goto nomem;
     zhashx_set_destructor (checkpoint->hash, checkpoint_data_decref_wrapper);
 
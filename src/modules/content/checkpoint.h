@@ -11,6 +11,8 @@
 #ifndef _CONTENT_CHECKPOINT_H
 #define _CONTENT_CHECKPOINT_H 1
 
+#include <jansson.h>
+
 #include "cache.h"
 
 struct content_checkpoint *content_checkpoint_create (
@@ -21,6 +23,12 @@ void content_checkpoint_destroy (struct content_checkpoint *checkpoint);
 
 int checkpoints_flush (struct content_checkpoint *checkpoint);
 
+/* Send deferred "durable" checkpoints whose blobs have been stored.
+ */
+void checkpoints_durable (struct content_checkpoint *checkpoint);
+
+json_t *checkpoints_get_rootrefs (struct content_checkpoint *checkpoint);
+
 #endif /* !_CONTENT_CHECKPOINT_H */
 
 /*
@@ -0,0 +1,735 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* gc.c - online garbage collection of the content backing store (rank 0)
+ *
+ * A pass is started by a content.gc request, or periodically if the
+ * gc-interval module option is set.  It proceeds as follows:
+ *
+ * 1) content-backing.gc-begin: from now on, the backing store protects
+ *    any blob it is asked to store from the sweep.
+ * 2) kvs.gc-begin: from now on, KVS transactions store blobs even if they
+ *    are already in the KVS cache.  The KVS responds once transactions
+ *    started before that have finished.
+ * 3) Roots are collected: the rootrefs of checkpoints known to the cache,
+ *    the default KVS checkpoint on the backing store, and the current root
+ *    of each KVS namespace.
+ * 4) content.flush: dirty cache entries, such as roots that have not been
+ *    written back yet, are stored (and thus protected).
+ * 5) Mark: KVS directories reachable from the roots are loaded directly
+ *    from the backing store, bypassing the cache, and the blobrefs they
+ *    reference are sent to the backing store in content-backing.gc-mark
+ *    batches.  At most gc_load_window loads are in flight at once.
+ * 6) Sweep: content-backing.gc-sweep is sent one batch at a time until
+ *    the backing store reports that the sweep is complete.
+ * 7) kvs.gc-end and content-backing.gc-end.
+ *
+ * Blobs that become referenced again while the pass is underway, for
+ * example by a KVS commit that stores a duplicate of an old value, are
+ * protected because the KVS stores them again and the cache re-stores
+ * clean entries while content_gc_active() is true.  Any error before the
+ * sweep aborts the pass without deleting anything.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <jansson.h>
+#include <flux/core.h>
+
+#include "src/common/libczmqcontainers/czmq_containers.h"
+#include "src/common/libutil/blobref.h"
+#include "src/common/libcontent/content.h"
+#include "src/common/libkvs/treeobj.h"
+#include "src/common/libkvs/kvs_checkpoint.h"
+
+#include "gc.h"
+
+static const int gc_load_window = 4;
+
+enum gc_phase {
+    GC_IDLE,
+    GC_BEGIN,
+    GC_KVS,
+    GC_ROOTS,
+    GC_FLUSH,
+    GC_MARK,
+    GC_SWEEP,
+    GC_END,
+};
+
+struct content_gc {
+    flux_t *h;
+    flux_msg_handler_t **handlers;
+    flux_watcher_t *timer;
+    struct content_checkpoint *checkpoint;
+    int hash_size;
+    int batch_size;
+
+    struct flux_msglist *requests;  // content.gc requests awaiting result
+    zlistx_t *futures;              // RPCs in flight for current pass
+    enum gc_phase phase;
+    int roots_pending;              // root collection RPCs in flight
+    zhashx_t *visited;              // dirrefs already queued for mark
+    zlistx_t *pending;              // dirrefs awaiting load
+    int loads;                      // loads in flight
+    void *marks;                    // hash digests awaiting gc-mark
+    int mark_count;
+    int marks_pending;              // gc-mark RPCs in flight
+    int marked;
+    int deleted;
+    double t_start;
+};
+
+static void gc_walk (struct content_gc *gc);
+static void gc_sweep (struct content_gc *gc);
+
+/* zlistx_destructor_fn footprint
+ */
+static void future_destructor (void **item)
+{
+    if (item) {
+        flux_future_destroy (*item);
+        *item = NULL;
+    }
+}
+
+/* zlistx_destructor_fn footprint
+ */
+static void string_destructor (void **item)
+{
+    if (item) {
+        free (*item);
+        *item = NULL;
+    }
+}
+
+bool content_gc_active (struct content_gc *gc)
+{
+    return gc && gc->phase != GC_IDLE;
+}
+
+static void gc_reset (struct content_gc *gc)
+{
+    zlistx_purge (gc->futures);
+    zlistx_purge (gc->pending);
+    zhashx_purge (gc->visited);
+    gc->phase = GC_IDLE;
+    gc->roots_pending = 0;
+    gc->loads = 0;
+    gc->mark_count = 0;
+    gc->marks_pending = 0;
+}
+
+/* Abort the pass and fail any content.gc requests.  If the backing store
+ * has begun garbage collection, tell it to stop.  Nothing is deleted
+ * unless the sweep was already underway.
+ */
+static void gc_fail (struct content_gc *gc, int errnum, const char *errstr)
+{
+    const flux_msg_t *msg;
+
+    if (!errstr)
+        errstr = strerror (errnum);
+    flux_log (gc->h, LOG_ERR, "gc: %s", errstr);
+    if (gc->phase > GC_BEGIN) {
+        flux_future_destroy (flux_rpc (gc->h,
+                                       "kvs.gc-end",
+                                       NULL,
+                                       0,
+                                       FLUX_RPC_NORESPONSE));
+        flux_future_destroy (flux_rpc (gc->h,
+                                       "content-backing.gc-end",
+                                       NULL,
+                                       0,
+                                       FLUX_RPC_NORESPONSE));
+    }
+    while ((msg = flux_msglist_pop (gc->requests))) {
+        if (flux_respond_error (gc->h, msg, errnum, errstr) < 0)
+            flux_log_error (gc->h, "error responding to content.gc request");
+        flux_msg_decref (msg);
+    }
+    gc_reset (gc);
+}
+
+/* Send an RPC on behalf of the current pass.  Futures are tracked so that
+ * gc_fail() can cancel everything in flight.
+ */
+static int gc_then (struct content_gc *gc,
+                    flux_future_t *f,
+                    flux_continuation_f cb)
+{
+    void *handle;
+
+    if (!f)
+        return -1;
+    if (!(handle = zlistx_add_end (gc->futures, f))) {
+        flux_future_destroy (f);
+        errno = ENOMEM;
+        return -1;
+    }
+    if (flux_future_aux_set (f, "handle", handle, NULL) < 0
+        || flux_future_then (f, -1., cb, gc) < 0) {
+        zlistx_delete (gc->futures, handle);
+        return -1;
+    }
+    return 0;
+}
+
+/* Destroy a completed future.
+ */
+static void gc_done (struct content_gc *gc, flux_future_t *f)
+{
+    zlistx_delete (gc->futures, flux_future_aux_get (f, "handle"));
+}
+
+static void gc_end_continuation (flux_future_t *f, void *arg)
+{
+    struct content_gc *gc = arg;
+    const flux_msg_t *msg;
+
+    if (flux_rpc_get (f, NULL) < 0) {
+        gc_fail (gc, errno, future_strerror (f, errno));
+        return;
+    }
+    gc_done (gc, f);
+    flux_log (gc->h,
+              LOG_INFO,
+              "gc: marked %d, deleted %d objects in %.3fs",
+              gc->marked,
+              gc->deleted,
+              flux_reactor_now (flux_get_reactor (gc->h)) - gc->t_start);
+    while ((msg = flux_msglist_pop (gc->requests))) {
+        if (flux_respond_pack (gc->h,
+                               msg,
+                               "{s:i s:i}",
+                               "marked", gc->marked,
+                               "deleted", gc->deleted) < 0)
+            flux_log_error (gc->h, "error responding to content.gc request");
+        flux_msg_decref (msg);
+    }
+    gc_reset (gc);
+}
+
+static void gc_end (struct content_gc *gc)
+{
+    gc->phase = GC_END;
+    flux_future_destroy (flux_rpc (gc->h,
+                                   "kvs.gc-end",
+                                   NULL,
+                                   0,
+                                   FLUX_RPC_NORESPONSE));
+    if (gc_then (gc,
+                 flux_rpc (gc->h, "content-backing.gc-end", NULL, 0, 0),
+                 gc_end_continuation) < 0)
+        gc_fail (gc, errno, "error sending gc-end request");
+}
+
+static void gc_sweep_continuation (flux_future_t *f, void *arg)
+{
+    struct content_gc *gc = arg;
+    int deleted;
+    int done;
+
+    if (flux_rpc_get_unpack (f,
+                             "{s:i s:b}",
+                             "deleted", &deleted,
+                             "done", &done) < 0) {
+        gc_fail (gc, errno, future_strerror (f, errno));
+        return;
+    }
+    gc_done (gc, f);
+    gc->deleted += deleted;
+    if (done)
+        gc_end (gc);
+    else
+        gc_sweep (gc);
+}
+
+/* Sweep one batch at a time so the backing store can interleave
+ * other requests.
+ */
+static void gc_sweep (struct content_gc *gc)
+{
+    gc->phase = GC_SWEEP;
+    if (gc_then (gc,
+                 flux_rpc_pack (gc->h,
+                                "content-backing.gc-sweep",
+                                0,
+                                0,
+                                "{s:i}",
+                                "count", gc->batch_size),
+                 gc_sweep_continuation) < 0)
+        gc_fail (gc, errno, "error sending gc-sweep request");
+}
+
+static void gc_mark_continuation (flux_future_t *f, void *arg)
+{
+    struct content_gc *gc = arg;
+
+    if (flux_rpc_get (f, NULL) < 0) {
+        gc_fail (gc, errno, future_strerror (f, errno));
+        return;
+    }
+    gc_done (gc, f);
+    gc->marks_pending--;
+    gc_walk (gc);
+}
+
+static int gc_send_marks (struct content_gc *gc)
+{
+    if (gc->mark_count == 0)
+        return 0;
+    if (gc_then (gc,
+                 flux_rpc_raw (gc->h,
+                               "content-backing.gc-mark",
+                               gc->marks,
+                               gc->mark_count * gc->hash_size,
+                               0,
+                               0),
+                 gc_mark_continuation) < 0)
+        return -1;
+    gc->mark_count = 0;
+    gc->marks_pending++;
+    return 0;
+}
+
+static int gc_mark (struct content_gc *gc, const char *blobref)
+{
+    char *hash = (char *)gc->marks + gc->mark_count * gc->hash_size;
+
+    if (blobref_strtohash (blobref, hash, gc->hash_size) != gc->hash_size) {
+        errno = EPROTO;
+        return -1;
+    }
+    gc->mark_count++;
+    gc->marked++;
+    if (gc->mark_count == gc->batch_size)
+        return gc_send_marks (gc);
+    return 0;
+}
+
+/* Mark a directory and queue it to be loaded, unless already seen.
+ */
+static int gc_queue_dirref (struct content_gc *gc, const char *blobref)
+{
+    char *cpy;
+
+    if (zhashx_lookup (gc->visited, blobref))
+        return 0;
+    if (zhashx_insert (gc->visited, blobref, (void *)1) < 0
+        || !(cpy = strdup (blobref))
+        || !zlistx_add_end (gc->pending, cpy)) {
+        errno = ENOMEM;
+        return -1;
+    }
+    return gc_mark (gc, blobref);
+}
+
+static int gc_walk_treeobj (struct content_gc *gc, json_t *treeobj)
+{
+    const char *name;
+    json_t *entry;
+    int count;
+
+    if (treeobj_is_valref (treeobj) || treeobj_is_dirref (treeobj)) {
+        if ((count = treeobj_get_count (treeobj)) < 0)
+            return -1;
+        for (int i = 0; i < count; i++) {
+            const char *blobref = treeobj_get_blobref (treeobj, i);
+            if (!blobref)
+                return -1;
+            if (treeobj_is_dirref (treeobj)) {
+                if (gc_queue_dirref (gc, blobref) < 0)
+                    return -1;
+            }
+            else if (gc_mark (gc, blobref) < 0)
+                return -1;
+        }
+    }
+    else if (treeobj_is_dir (treeobj)) {
+        json_object_foreach (treeobj_get_data (treeobj), name, entry) {
+            if (gc_walk_treeobj (gc, entry) < 0) // recurse
+                return -1;
+        }
+    }
+    else if (treeobj_is_dirshard (treeobj)) {
+        json_object_foreach (treeobj_dirshard_get_buckets (treeobj),
+                             name,
+                             entry) {
+            if (gc_walk_treeobj (gc, entry) < 0) // recurse
+                return -1;
+        }
+    }
+    return 0;
+}
+
+static void gc_load_continuation (flux_future_t *f, void *arg)
+{
+    struct content_gc *gc = arg;
+    const void *buf;
+    int len;
+    json_t *treeobj;
+
+    if (content_load_get (f, &buf, &len) < 0) {
+        gc_fail (gc, errno, future_strerror (f, errno));
+        return;
+    }
+    if (!(treeobj = treeobj_decodeb (buf, len))
+        || (!treeobj_is_dir (treeobj) && !treeobj_is_dirshard (treeobj))) {
+        json_decref (treeobj);
+        gc_fail (gc, EPROTO, "dirref references non-directory");
+        return;
+    }
+    if (gc_walk_treeobj (gc, treeobj) < 0) {
+        json_decref (treeobj);
+        gc_fail (gc, errno, "error marking directory");
+        return;
+    }
+    json_decref (treeobj);
+    gc_done (gc, f);
+    gc->loads--;
+    gc_walk (gc);
+}
+
+/* Keep up to gc_load_window directory loads in flight.  When the walk is
+ * complete and all marks have been acknowledged, start the sweep.
+ */
+static void gc_walk (struct content_gc *gc)
+{
+    const char *blobref;
+
+    if (gc->phase != GC_MARK)
+        return;
+    while (gc->loads < gc_load_window
+           && (blobref = zlistx_first (gc->pending))) {
+        if (gc_then (gc,
+                     content_load_byblobref (gc->h,
+                                             blobref,
+                                             CONTENT_FLAG_CACHE_BYPASS),
+                     gc_load_continuation) < 0) {
+            gc_fail (gc, errno, "error sending load request");
+            return;
+        }
+        zlistx_delete (gc->pending, zlistx_cursor (gc->pending));
+        gc->loads++;
+    }
+    if (gc->loads == 0) {
+        if (gc_send_marks (gc) < 0) {
+            gc_fail (gc, errno, "error sending gc-mark request");
+            return;
+        }
+        if (gc->marks_pending == 0)
+            gc_sweep (gc);
+    }
+}
+
+static void gc_flush_continuation (flux_future_t *f, void *arg)
+{
+    struct content_gc *gc = arg;
+
+    if (flux_rpc_get (f, NULL) < 0) {
+        gc_fail (gc, errno, future_strerror (f, errno));
+        return;
+    }
+    gc_done (gc, f);
+    gc->phase = GC_MARK;
+    gc_walk (gc);
+}
+
+/* Called as each root collection RPC completes.  When all are done,
+ * flush the cache so every root is on the backing store.
+ */
+static void gc_roots_check (struct content_gc *gc)
+{
+    if (gc->roots_pending > 0)
+        return;
+    /* Refuse to sweep everything if no roots could be found, e.g.
+     * if the KVS has never been loaded.
+     */
+    if (zhashx_size (gc->visited) == 0) {
+        gc_fail (gc, ENOENT, "no KVS roots found");
+        return;
+    }
+    gc->phase = GC_FLUSH;
+    if (gc_then (gc,
+                 flux_rpc (gc->h, "content.flush", NULL, 0, 0),
+                 gc_flush_continuation) < 0)
+        gc_fail (gc, errno, "error sending flush request");
+}
+
+static void gc_getroot_continuation (flux_future_t *f, void *arg)
+{
+    struct content_gc *gc = arg;
+    const char *rootref;
+
+    if (flux_rpc_get_unpack (f, "{s:s}", "rootref", &rootref) < 0) {
+        if (errno != ENOTSUP) { // namespace was removed
+            gc_fail (gc, errno, future_strerror (f, errno));
+            return;
+        }
+    }
+    else if (gc_queue_dirref (gc, rootref) < 0) {
+        gc_fail (gc, errno, "error marking KVS root");
+        return;
+    }
+    gc_done (gc, f);
+    gc->roots_pending--;
+    gc_roots_check (gc);
+}
+
+static void gc_nslist_continuation (flux_future_t *f, void *arg)
+{
+    struct content_gc *gc = arg;
+    json_t *namespaces;
+    size_t index;
+    json_t *entry;
+
+    if (flux_rpc_get_unpack (f, "{s:o}", "namespaces", &namespaces) < 0) {
+        if (errno != ENOSYS) { // KVS is not loaded
+            gc_fail (gc, errno, future_strerror (f, errno));
+            return;
+        }
+        namespaces = NULL;
+    }
+    json_array_foreach (namespaces, index, entry) {
+        const char *ns;
+
+        if (json_unpack (entry, "{s:s}", "namespace", &ns) < 0) {
+            gc_fail (gc, EPROTO, "error decoding namespace list");
+            return;
+        }
+        if (gc_then (gc,
+                     flux_rpc_pack (gc->h,
+                                    "kvs.getroot",
+                                    0,
+                                    0,
+                                    "{s:s}",
+                                    "namespace", ns),
+                     gc_getroot_continuation) < 0) {
+            gc_fail (gc, errno, "error sending getroot request");
+            return;
+        }
+        gc->roots_pending++;
+    }
+    gc_done (gc, f);
+    gc->roots_pending--;
+    gc_roots_check (gc);
+}
+
+static void gc_checkpoint_continuation (flux_future_t *f, void *arg)
+{
+    struct content_gc *gc = arg;
+    const char *rootref;
+
+    if (flux_rpc_get_unpack (f,
+                             "{s:{s:s}}",
+                             "value",
+                             "rootref", &rootref) < 0) {
+        if (errno != ENOENT) {
+            gc_fail (gc, errno, future_strerror (f, errno));
+            return;
+        }
+    }
+    else if (gc_queue_dirref (gc, rootref) < 0) {
+        gc_fail (gc, errno, "error marking checkpoint root");
+        return;
+    }
+    gc_done (gc, f);
+    gc->roots_pending--;
+    gc_roots_check (gc);
+}
+
+static void gc_kvs_begin_continuation (flux_future_t *f, void *arg)
+{
+    struct content_gc *gc = arg;
+    json_t *rootrefs;
+    size_t index;
+    json_t *entry;
+
+    if (flux_rpc_get (f, NULL) < 0) {
+        if (errno != ENOSYS) { // KVS is not loaded
+            gc_fail (gc, errno, future_strerror (f, errno));
+            return;
+        }
+    }
+    gc_done (gc, f);
+    gc->phase = GC_ROOTS;
+
+    if (!(rootrefs = checkpoints_get_rootrefs (gc->checkpoint))) {
+        gc_fail (gc, errno, "error getting checkpoints");
+        return;
+    }
+    json_array_foreach (rootrefs, index, entry) {
+        if (gc_queue_dirref (gc, json_string_value (entry)) < 0) {
+            json_decref (rootrefs);
+            gc_fail (gc, errno, "error marking checkpoint root");
+            return;
+        }
+    }
+    json_decref (rootrefs);
+
+    if (gc_then (gc,
+                 flux_rpc_pack (gc->h,
+                                "content-backing.checkpoint-get",
+                                0,
+                                0,
+                                "{s:s}",
+                                "key", KVS_DEFAULT_CHECKPOINT),
+                 gc_checkpoint_continuation) < 0) {
+        gc_fail (gc, errno, "error sending checkpoint-get request");
+        return;
+    }
+    gc->roots_pending++;
+    if (gc_then (gc,
+                 flux_rpc (gc->h, "kvs.namespace-list", NULL, 0, 0),
+                 gc_nslist_continuation) < 0) {
+        gc_fail (gc, errno, "error sending namespace-list request");
+        return;
+    }
+    gc->roots_pending++;
+}
+
+static void gc_begin_continuation (flux_future_t *f, void *arg)
+{
+    struct content_gc *gc = arg;
+
+    if (flux_rpc_get (f, NULL) < 0) {
+        if (errno == ENOSYS)
+            gc_fail (gc, errno, "backing store does not support gc");
+        else
+            gc_fail (gc, errno, future_strerror (f, errno));
+        return;
+    }
+    gc_done (gc, f);
+    gc->phase = GC_KVS;
+    if (gc_then (gc,
+                 flux_rpc (gc->h, "kvs.gc-begin", NULL, 0, 0),
+                 gc_kvs_begin_continuation) < 0)
+        gc_fail (gc, errno, "error sending kvs gc-begin request");
+}
+
+static void gc_start (struct content_gc *gc)
+{
+    gc->phase = GC_BEGIN;
+    gc->marked = 0;
+    gc->deleted = 0;
+    gc->t_start = flux_reactor_now (flux_get_reactor (gc->h));
+    if (gc_then (gc,
+                 flux_rpc (gc->h, "content-backing.gc-begin", NULL, 0, 0),
+                 gc_begin_continuation) < 0)
+        gc_fail (gc, errno, "error sending gc-begin request");
+}
+
+/* Start a garbage collection pass, or join the one in progress.
+ * The response is sent when the pass is complete.
+ */
+static void content_gc_request (flux_t *h,
+                                flux_msg_handler_t *mh,
+                                const flux_msg_t *msg,
+                                void *arg)
+{
+    struct content_gc *gc = arg;
+
+    if (flux_request_decode (msg, NULL, NULL) < 0)
+        goto error;
+    if (flux_msglist_append (gc->requests, msg) < 0)
+        goto error;
+    if (gc->phase == GC_IDLE)
+        gc_start (gc);
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        flux_log_error (h, "error responding to content.gc request");
+}
+
+static void gc_timer_cb (flux_reactor_t *r,
+                         flux_watcher_t *w,
+                         int revents,
+                         void *arg)
+{
+    struct content_gc *gc = arg;
+
+    if (gc->phase == GC_IDLE)
+        gc_start (gc);
+}
+
+static const struct flux_msg_handler_spec htab[] = {
+    {
+        FLUX_MSGTYPE_REQUEST,
+        "content.gc",
+        content_gc_request,
+        0
+    },
+    FLUX_MSGHANDLER_TABLE_END,
+};
+
+void content_gc_destroy (struct content_gc *gc)
+{
+    if (gc) {
+        int saved_errno = errno;
+        flux_msg_handler_delvec (gc->handlers);
+        flux_watcher_destroy (gc->timer);
+        zlistx_destroy (&gc->futures);
+        zlistx_destroy (&gc->pending);
+        zhashx_destroy (&gc->visited);
+        flux_msglist_destroy (gc->requests);
+        free (gc->marks);
+        free (gc);
+        errno = saved_errno;
+    }
+}
+
+struct content_gc *content_gc_create (flux_t *h,
+                                      int hash_size,
+                                      struct content_checkpoint *checkpoint,
+                                      int batch_size,
+                                      double interval)
+{
+    struct content_gc *gc;
+
+    if (batch_size <= 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(gc = calloc (1, sizeof (*gc))))
+        return NULL;
+    gc->h = h;
+    gc->hash_size = hash_size;
+    gc->checkpoint = checkpoint;
+    gc->batch_size = batch_size;
+    if (!(gc->marks = malloc (batch_size * hash_size))
+        || !(gc->requests = flux_msglist_create ())
+        || !(gc->futures = zlistx_new ())
+        || !(gc->pending = zlistx_new ())
+        || !(gc->visited = zhashx_new ()))
+        goto nomem;
+    zlistx_set_destructor (gc->futures, future_destructor);
+    zlistx_set_destructor (gc->pending, string_destructor);
+    if (interval > 0) {
+        if (!(gc->timer = flux_timer_watcher_create (flux_get_reactor (h),
+                                                     interval,
+                                                     interval,
+                                                     gc_timer_cb,
+                                                     gc)))
+            goto error;
+        flux_watcher_start (gc->timer);
+    }
+    if (flux_msg_handler_addvec (h, htab, gc, &gc->handlers) < 0)
+        goto error;
+    return gc;
+nomem:
+    errno = ENOMEM;
+error:
+    content_gc_destroy (gc);
+    return NULL;
+}
+
+// vi:ts=4 sw=4 expandtab
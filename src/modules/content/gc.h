@@ -0,0 +1,32 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _CONTENT_GC_H
+#define _CONTENT_GC_H 1
+
+#include <stdbool.h>
+
+#include "cache.h"
+#include "checkpoint.h"
+
+struct content_gc *content_gc_create (flux_t *h,
+                                      int hash_size,
+                                      struct content_checkpoint *checkpoint,
+                                      int batch_size,
+                                      double interval);
+void content_gc_destroy (struct content_gc *gc);
+
+/* Returns true while a garbage collection pass is in progress.
+ */
+bool content_gc_active (struct content_gc *gc);
+
+#endif /* !_CONTENT_GC_H */
+
+// vi:ts=4 sw=4 expandtab
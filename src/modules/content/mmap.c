@@ -54,6 +54,12 @@
  * limit the calls to stat(2) to avoid a "stat storm" when a file with many
  * blobrefs is accessed, which increases the window where it could have
  * changed.  But it's likely better than not checking at all.
+ *
+ * Sharing with child instances:
+ * A child instance on the same node may ask where a blob is found with
+ * content.mmap-lookup, then map just that part of the file itself with
+ * content_mmap_region_map().  Such a region is not tagged or placed in
+ * mm->cache.  It belongs to the content-cache entry that requested it.
  */
 
 #if HAVE_CONFIG_H
@@ -96,6 +102,7 @@ struct content_region {
 
     struct content_mmap *mm;
 
+    off_t offset;                           // file offset of mapinfo.base
     char *fullpath;                         // full path for stat(2) checking
     struct timespec last_check;             // rate limit stat(2) checking
 };
@@ -345,7 +352,7 @@ bool content_mmap_validate (struct content_region *reg,
         struct stat sb;
 
         if (stat (reg->fullpath, &sb) < 0
-            || sb.st_size < reg->mapinfo.size)
+            || sb.st_size < reg->offset + reg->mapinfo.size)
             return false;
 
         monotime (&reg->last_check);
@@ -426,6 +433,63 @@ error:
     return NULL;
 }
 
+struct content_region *content_mmap_region_map (struct content_mmap *mm,
+                                                const char *path,
+                                                off_t offset,
+                                                int size,
+                                                const void *hash,
+                                                int hash_size,
+                                                const void **data)
+{
+    struct content_region *reg;
+    long pagesize = sysconf (_SC_PAGESIZE);
+    off_t pageoff = offset % pagesize;
+    struct stat sb;
+    int fd = -1;
+
+    if (path[0] != '/' || offset < 0 || size <= 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(reg = calloc (1, sizeof (*reg))))
+        return NULL;
+    reg->refcount = 1;
+    reg->mm = mm;
+    reg->mapinfo.base = MAP_FAILED;
+    if (!(reg->fullpath = strdup (path)))
+        goto error;
+    if ((fd = open (path, O_RDONLY)) < 0 || fstat (fd, &sb) < 0)
+        goto error;
+    if (!S_ISREG (sb.st_mode) || sb.st_size < offset + size) {
+        errno = EINVAL;
+        goto error;
+    }
+    reg->offset = offset - pageoff;
+    reg->mapinfo.size = pageoff + size;
+    reg->mapinfo.base = mmap (NULL,
+                              reg->mapinfo.size,
+                              PROT_READ,
+                              MAP_SHARED,
+                              fd,
+                              reg->offset);
+    if (reg->mapinfo.base == MAP_FAILED)
+        goto error;
+    close (fd);
+    fd = -1;
+    monotime (&reg->last_check);
+    *data = reg->mapinfo.base + pageoff;
+    if (!content_mmap_validate (reg, hash, hash_size, *data, size)) {
+        errno = EINVAL;
+        goto error;
+    }
+    return reg;
+error:
+    if (fd >= 0)
+        ERRNO_SAFE_WRAP (close, fd);
+    content_mmap_region_decref (reg);
+    return NULL;
+}
+
 static void content_mmap_add_cb (flux_t *h,
                                  flux_msg_handler_t *mh,
                                  const flux_msg_t *msg,
@@ -507,6 +571,40 @@ error:
         flux_log_error (h, "error responding to content.mmap-remove request");
 }
 
+static void content_mmap_lookup_cb (flux_t *h,
+                                    flux_msg_handler_t *mh,
+                                    const flux_msg_t *msg,
+                                    void *arg)
+{
+    struct content_mmap *mm = arg;
+    const char *blobref;
+    char hash[BLOBREF_MAX_DIGEST_SIZE];
+    struct cache_entry *e;
+
+    if (flux_request_unpack (msg, NULL, "{s:s}", "blobref", &blobref) < 0)
+        goto error;
+    if (blobref_strtohash (blobref, hash, sizeof (hash)) != content_hash_size) {
+        errno = EPROTO;
+        goto error;
+    }
+    if (!(e = zhashx_lookup (mm->cache, hash))) {
+        errno = ENOENT;
+        goto error;
+    }
+    if (flux_respond_pack (h,
+                           msg,
+                           "{s:s s:I s:i}",
+                           "path", e->reg->fullpath,
+                           "offset",
+                           (json_int_t)(e->data - e->reg->mapinfo.base),
+                           "size", (int)e->size) < 0)
+        flux_log_error (h, "error responding to content.mmap-lookup request");
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        flux_log_error (h, "error responding to content.mmap-lookup request");
+}
+
 static const struct flux_msg_handler_spec htab[] = {
     {
         FLUX_MSGTYPE_REQUEST,
@@ -520,6 +618,12 @@ static const struct flux_msg_handler_spec htab[] = {
         content_mmap_remove_cb,
         0
     },
+    {
+        FLUX_MSGTYPE_REQUEST,
+        "content.mmap-lookup",
+        content_mmap_lookup_cb,
+        0
+    },
     FLUX_MSGHANDLER_TABLE_END,
 };
 
@@ -12,6 +12,7 @@
 #define _CONTENT_MMAP_H 1
 
 #include <stdbool.h>
+#include <sys/types.h>
 #include <jansson.h>
 
 #include "cache.h"
@@ -29,6 +30,19 @@ struct content_region *content_mmap_region_lookup (struct content_mmap *mm,
                                                    const void **data,
                                                    int *data_size);
 
+/* Map the 'size' byte blob at 'offset' in file 'path', e.g. as located
+ * by a parent instance's content.mmap-lookup, and verify that it matches
+ * 'hash'.  The region is returned with one reference and '*data' is set
+ * to the blob.  Returns NULL with errno set on failure.
+ */
+struct content_region *content_mmap_region_map (struct content_mmap *mm,
+                                                const char *path,
+                                                off_t offset,
+                                                int size,
+                                                const void *hash,
+                                                int hash_size,
+                                                const void **data);
+
 bool content_mmap_validate (struct content_region *reg,
                             const void *hash,
                             int hash_size,
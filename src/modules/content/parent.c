@@ -0,0 +1,133 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* parent.c - read-through to the enclosing instance's content (rank 0)
+ *
+ * When an instance is run as a job (e.g. flux batch), it often loads blobs
+ * that already exist in the parent instance, such as the content of files
+ * archived for the job.  If the content.parent-fallback attribute is set,
+ * rank 0 of the cache opens a connection to the parent-uri and consults the
+ * parent's content service for blobs that are missing from the local
+ * backing store.
+ *
+ * If the parent broker runs on the same node and serves a blob from a file
+ * it has mapped (see mmap.c), the parent is asked for the file location
+ * with content.mmap-lookup and the cache maps the blob from the same file
+ * rather than transferring a copy.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include <jansson.h>
+#include <flux/core.h>
+
+#include "src/common/libutil/errno_safe.h"
+#include "src/common/libutil/blobref.h"
+#include "src/common/libcontent/content.h"
+#include "ccan/str/str.h"
+
+#include "parent.h"
+
+struct content_parent {
+    flux_t *parent_h;
+    char *hash_name;
+    bool local;
+};
+
+void content_parent_destroy (struct content_parent *cp)
+{
+    if (cp) {
+        int saved_errno = errno;
+        flux_close (cp->parent_h);
+        free (cp->hash_name);
+        free (cp);
+        errno = saved_errno;
+    }
+}
+
+struct content_parent *content_parent_create (flux_t *h,
+                                              const char *uri,
+                                              const char *hash_name)
+{
+    struct content_parent *cp;
+    const char *s;
+
+    if (!(cp = calloc (1, sizeof (*cp))))
+        return NULL;
+    if (!(cp->hash_name = strdup (hash_name)))
+        goto error;
+    if (!(cp->parent_h = flux_open (uri, 0))
+        || flux_set_reactor (cp->parent_h, flux_get_reactor (h)) < 0)
+        goto error;
+    if (!(s = flux_attr_get (cp->parent_h, "content.hash"))
+        || !streq (s, hash_name)) {
+        errno = EINVAL;
+        goto error;
+    }
+    cp->local = strstarts (uri, "local://");
+    return cp;
+error:
+    content_parent_destroy (cp);
+    return NULL;
+}
+
+bool content_parent_is_local (struct content_parent *cp)
+{
+    return cp->local;
+}
+
+flux_future_t *content_parent_load (struct content_parent *cp,
+                                    const void *hash,
+                                    int hash_size)
+{
+    return content_load_byhash (cp->parent_h, hash, hash_size, 0);
+}
+
+flux_future_t *content_parent_mmap_lookup (struct content_parent *cp,
+                                           const void *hash,
+                                           int hash_size)
+{
+    char blobref[BLOBREF_MAX_STRING_SIZE];
+
+    if (blobref_hashtostr (cp->hash_name,
+                           hash,
+                           hash_size,
+                           blobref,
+                           sizeof (blobref)) < 0)
+        return NULL;
+    return flux_rpc_pack (cp->parent_h,
+                          "content.mmap-lookup",
+                          FLUX_NODEID_ANY,
+                          0,
+                          "{s:s}",
+                          "blobref", blobref);
+}
+
+int content_parent_mmap_lookup_get (flux_future_t *f,
+                                    const char **path,
+                                    off_t *offset,
+                                    int *size)
+{
+    json_int_t off;
+
+    if (flux_rpc_get_unpack (f,
+                             "{s:s s:I s:i}",
+                             "path", path,
+                             "offset", &off,
+                             "size", size) < 0)
+        return -1;
+    *offset = off;
+    return 0;
+}
+
+// vi:ts=4 sw=4 expandtab
@@ -0,0 +1,52 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _CONTENT_PARENT_H
+#define _CONTENT_PARENT_H 1
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+#include "cache.h"
+
+/* Connect to the content service of the enclosing instance at 'uri'.
+ * The connection shares the reactor of 'h'.  Returns NULL with errno set
+ * on failure, including EINVAL if the parent uses a different hash type.
+ */
+struct content_parent *content_parent_create (flux_t *h,
+                                              const char *uri,
+                                              const char *hash_name);
+void content_parent_destroy (struct content_parent *cp);
+
+/* Returns true if the parent broker runs on this node, so its mapped
+ * files may be mapped here too.
+ */
+bool content_parent_is_local (struct content_parent *cp);
+
+/* Send a content.load request for 'hash' to the parent.  The future is
+ * fulfilled with the response message, as with content_load_byhash().
+ */
+flux_future_t *content_parent_load (struct content_parent *cp,
+                                    const void *hash,
+                                    int hash_size);
+
+/* Ask the parent where 'hash' is found in a file it has mapped.
+ */
+flux_future_t *content_parent_mmap_lookup (struct content_parent *cp,
+                                           const void *hash,
+                                           int hash_size);
+int content_parent_mmap_lookup_get (flux_future_t *f,
+                                    const char **path,
+                                    off_t *offset,
+                                    int *size);
+
+#endif /* !_CONTENT_PARENT_H */
+
+// vi:ts=4 sw=4 expandtab
@@ -38,6 +38,7 @@
 #include "ccan/str/str.h"
 
 #include "task.h"
+#include "timerq.h"
 #include "entry.h"
 #include "types.h"
 
@@ -53,6 +54,8 @@ struct cron_ctx {
                                                number of seconds after last-
                                                sync before deferring         */
     char *                 cwd;             /* cwd to avoid constant lookups */
+    struct timerq *        interval_q;      /* timers for interval entries  */
+    struct timerq *        datetime_q;      /* timers for datetime entries  */
 };
 
 /**************************************************************************
@@ -76,6 +79,11 @@ void *cron_entry_type_data (cron_entry_t *e)
     return e->data;
 }
 
+struct timerq *cron_entry_timerq (cron_entry_t *e, bool realtime)
+{
+    return realtime ? e->ctx->datetime_q : e->ctx->interval_q;
+}
+
 double get_timestamp (void)
 {
     struct timespec tm;
@@ -490,6 +498,8 @@ static void cron_ctx_destroy (cron_ctx_t *ctx)
     }
     if (ctx->deferred)
         zlist_destroy (&ctx->deferred);
+    timerq_destroy (ctx->interval_q);
+    timerq_destroy (ctx->datetime_q);
     free (ctx->cwd);
     free (ctx);
 }
@@ -541,6 +551,11 @@ static cron_ctx_t * cron_ctx_create (flux_t *h)
         flux_log_error (h, "cron_ctx_create: zlist_new");
         goto error;
     }
+    if (!(ctx->interval_q = timerq_create (flux_get_reactor (h), false))
+        || !(ctx->datetime_q = timerq_create (flux_get_reactor (h), true))) {
+        flux_log_error (h, "cron_ctx_create: timerq_create");
+        goto error;
+    }
 
     if (!(ctx->cwd = get_current_dir_name ())) {
         flux_log_error (h, "cron_ctx_create: get_get_current_dir_name");
@@ -23,14 +23,15 @@
 
 struct datetime_entry {
     flux_t *h;
-    flux_watcher_t *w;
+    cron_entry_t *e;
+    struct timerq_item *item;
     cronodate_t *d;
 };
 
 void datetime_entry_destroy (struct datetime_entry *dt)
 {
     dt->h = NULL;
-    flux_watcher_destroy (dt->w);
+    timerq_item_destroy (dt->item);
     cronodate_destroy (dt->d);
     free (dt);
 }
@@ -83,31 +84,16 @@ static struct datetime_entry * datetime_entry_from_json (json_t *o)
     return (dt);
 }
 
-static void cron_datetime_start (void *arg)
-{
-    struct datetime_entry *dt = arg;
-    flux_watcher_start (dt->w);
-}
-
-static void cron_datetime_stop (void *arg)
-{
-    struct datetime_entry *dt = arg;
-    flux_watcher_stop (dt->w);
-}
-
-void datetime_cb (flux_reactor_t *r, flux_watcher_t *w, int revents, void *arg)
-{
-    cron_entry_t *e = arg;
-    cron_entry_schedule_task (e);
-}
-
-static double reschedule_cb (flux_watcher_t *w, double now, void *arg)
+/* Arm the entry for the next matching date and time after now.
+ */
+static void datetime_arm (struct datetime_entry *dt)
 {
-    cron_entry_t *e = arg;
-    struct datetime_entry *dt = cron_entry_type_data (e);
+    cron_entry_t *e = dt->e;
+    double now = timerq_now (cron_entry_timerq (e, true));
     double next = now + cronodate_remaining (dt->d, now);
-    /* If we failed to get next timestamp, push timeout far into the future
-     *  and stop the cron entry in an ev_prepare callback. See ev(7).
+
+    /* If we failed to get next timestamp, stop the cron entry in an
+     *  ev_prepare callback.
      */
     if (next < now) {
         /*  Only issue an error if this entry has more than one repeat:
@@ -117,9 +103,27 @@ static double reschedule_cb (flux_watcher_t *w, double now, void *arg)
                     "cron-%ju: Unable to get next wakeup. Stopping.", e->id);
         }
         cron_entry_stop_safe (e);
-        return now + 1.e19;
+        return;
     }
-    return (next);
+    timerq_item_arm (dt->item, next);
+}
+
+static void cron_datetime_start (void *arg)
+{
+    datetime_arm (arg);
+}
+
+static void cron_datetime_stop (void *arg)
+{
+    struct datetime_entry *dt = arg;
+    timerq_item_disarm (dt->item);
+}
+
+static void datetime_cb (struct timerq_item *item, void *arg)
+{
+    struct datetime_entry *dt = arg;
+    datetime_arm (dt);
+    cron_entry_schedule_task (dt->e);
 }
 
 static void *cron_datetime_create (flux_t *h, cron_entry_t *e, json_t *arg)
@@ -128,12 +132,12 @@ static void *cron_datetime_create (flux_t *h, cron_entry_t *e, json_t *arg)
     if (dt == NULL)
         return (NULL);
     dt->h = h;
-    dt->w = flux_periodic_watcher_create (flux_get_reactor (h),
-                                         0., 0.,
-                                         reschedule_cb,
-                                         datetime_cb, (void *) e);
-    if (dt->w == NULL) {
-        flux_log_error (h, "periodic_watcher_create");
+    dt->e = e;
+    dt->item = timerq_item_create (cron_entry_timerq (e, true),
+                                   datetime_cb,
+                                   dt);
+    if (dt->item == NULL) {
+        flux_log_error (h, "timerq_item_create");
         datetime_entry_destroy (dt);
         return (NULL);
     }
@@ -145,8 +149,8 @@ static json_t *cron_datetime_to_json (void *arg)
     int i;
     struct datetime_entry *dt = arg;
     json_t *o = json_object ();
-    if (dt->w) {
-        json_t *x = json_real (flux_watcher_next_wakeup (dt->w));
+    if (dt->item) {
+        json_t *x = json_real (timerq_item_next_wakeup (dt->item));
         if (x)
             json_object_set_new (o, "next_wakeup", x);
     }
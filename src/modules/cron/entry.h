@@ -16,6 +16,8 @@
 
 #include "src/common/libczmqcontainers/czmq_containers.h"
 
+#include "timerq.h"
+
 typedef struct cron_ctx cron_ctx_t;
 typedef struct cron_entry cron_entry_t;
 
@@ -86,6 +88,11 @@ struct cron_entry {
  */
 void *cron_entry_type_data (cron_entry_t *e);
 
+/* Return the cron module's shared timer queue for entry types that fire
+ *  at a date and time (realtime = true) or after an interval (false).
+ */
+struct timerq *cron_entry_timerq (cron_entry_t *e, bool realtime);
+
 /* Schedule the task corresponding to cron entry `e` to run as soon as allowed
  */
 int cron_entry_schedule_task (cron_entry_t *e);
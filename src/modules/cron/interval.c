@@ -20,16 +20,32 @@
 #include "entry.h"
 
 struct cron_interval {
-    flux_watcher_t *w;
+    cron_entry_t *  e;
+    struct timerq_item *item;
     double          after;   /* initial timeout */
     double          seconds; /* repeat interval */
+    double          next;    /* scheduled wakeup on the monotonic clock */
 };
 
 
-static void interval_handler (flux_reactor_t *r, flux_watcher_t *w,
-                              int revents, void *arg)
+static void interval_handler (struct timerq_item *item, void *arg)
 {
-    cron_entry_schedule_task ((cron_entry_t *)arg);
+    struct cron_interval *iv = arg;
+    struct timerq *q = cron_entry_timerq (iv->e, false);
+    double now = timerq_now (q);
+
+    /*  Like a repeating reactor timer, an interval of zero fires once,
+     *   and the next wakeup is relative to the scheduled one so that
+     *   intervals do not drift.  Rearm before scheduling the task, which
+     *   may stop the entry.
+     */
+    if (iv->seconds > 0.) {
+        iv->next += iv->seconds;
+        if (iv->next <= now)
+            iv->next = now + iv->seconds;
+        timerq_item_arm (item, iv->next);
+    }
+    cron_entry_schedule_task (iv->e);
 }
 
 static void *cron_interval_create (flux_t *h, cron_entry_t *e, json_t *arg)
@@ -52,13 +68,14 @@ static void *cron_interval_create (flux_t *h, cron_entry_t *e, json_t *arg)
         flux_log_error (h, "cron interval");
         return NULL;
     }
+    iv->e = e;
     iv->seconds = i;
     iv->after = after;
-    iv->w = flux_timer_watcher_create (flux_get_reactor (h),
-                                       after, i, interval_handler,
-                                       (void *) e);
-    if (!iv->w) {
-        flux_log_error (h, "cron_interval: flux_timer_watcher_create");
+    iv->item = timerq_item_create (cron_entry_timerq (e, false),
+                                   interval_handler,
+                                   iv);
+    if (!iv->item) {
+        flux_log_error (h, "cron_interval: timerq_item_create");
         free (iv);
         return (NULL);
     }
@@ -69,18 +86,21 @@ static void *cron_interval_create (flux_t *h, cron_entry_t *e, json_t *arg)
 static void cron_interval_destroy (void *arg)
 {
     struct cron_interval *iv = arg;
-    flux_watcher_destroy (iv->w);
+    timerq_item_destroy (iv->item);
     free (iv);
 }
 
 static void cron_interval_start (void *arg)
 {
-    flux_watcher_start (((struct cron_interval *)arg)->w);
+    struct cron_interval *iv = arg;
+    struct timerq *q = cron_entry_timerq (iv->e, false);
+    iv->next = timerq_now (q) + iv->after;
+    timerq_item_arm (iv->item, iv->next);
 }
 
 static void cron_interval_stop (void *arg)
 {
-    flux_watcher_stop (((struct cron_interval *)arg)->w);
+    timerq_item_disarm (((struct cron_interval *)arg)->item);
 }
 
 static json_t *cron_interval_to_json (void *arg)
@@ -89,7 +109,7 @@ static json_t *cron_interval_to_json (void *arg)
     return json_pack ("{ s:f, s:f, s:f }",
                       "interval",    iv->seconds,
                       "after",       iv->after,
-                      "next_wakeup", flux_watcher_next_wakeup (iv->w));
+                      "next_wakeup", timerq_item_next_wakeup (iv->item));
 }
 
 struct cron_entry_ops cron_interval_operations = {
@@ -0,0 +1,221 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* timerq.c - drive many cron entries from one reactor watcher */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <time.h>
+#include <flux/core.h>
+
+#include "src/common/libutil/heap.h"
+
+#include "timerq.h"
+
+struct timerq {
+    flux_watcher_t *w;
+    struct heap *heap;
+    bool realtime;
+    bool dispatching;       /* defer rearm until all due items are called */
+};
+
+struct timerq_item {
+    struct timerq *q;
+    double wakeup;
+    void *handle;           /* heap handle, or NULL if not armed */
+    timerq_f cb;
+    void *arg;
+};
+
+static double clock_now (clockid_t id)
+{
+    struct timespec ts;
+    clock_gettime (id, &ts);
+    return ((double) ts.tv_sec + (ts.tv_nsec/1.0e9));
+}
+
+double timerq_now (struct timerq *q)
+{
+    return clock_now (q->realtime ? CLOCK_REALTIME : CLOCK_MONOTONIC);
+}
+
+static int item_cmp (const void *a, const void *b)
+{
+    const struct timerq_item *i1 = a;
+    const struct timerq_item *i2 = b;
+
+    if (i1->wakeup < i2->wakeup)
+        return -1;
+    return i1->wakeup > i2->wakeup ? 1 : 0;
+}
+
+/* libev calls this to place the periodic watcher of a realtime queue,
+ *  including after the system clock has been changed.  It must not
+ *  return a time in the past.
+ */
+static double reschedule_cb (flux_watcher_t *w, double now, void *arg)
+{
+    struct timerq *q = arg;
+    struct timerq_item *first = heap_first (q->heap);
+
+    if (!first)
+        return now + 1.e19;
+    return first->wakeup > now ? first->wakeup : now;
+}
+
+/* Arm the watcher for the earliest item, or stop it if there is none.
+ */
+static void timerq_rearm (struct timerq *q)
+{
+    struct timerq_item *first;
+
+    if (q->dispatching)
+        return;
+    if (!(first = heap_first (q->heap))) {
+        flux_watcher_stop (q->w);
+        return;
+    }
+    if (q->realtime)
+        flux_periodic_watcher_reset (q->w, 0., 0., reschedule_cb);
+    else {
+        double after = first->wakeup - timerq_now (q);
+        flux_timer_watcher_reset (q->w, after > 0. ? after : 0., 0.);
+        flux_watcher_start (q->w);
+    }
+}
+
+/* Call back every item that is due, earliest first.
+ */
+static void timerq_dispatch (struct timerq *q)
+{
+    double now = timerq_now (q);
+    struct timerq_item *item;
+
+    q->dispatching = true;
+    while ((item = heap_first (q->heap)) && item->wakeup <= now) {
+        heap_delete (q->heap, item->handle);
+        item->handle = NULL;
+        item->cb (item, item->arg);
+    }
+    q->dispatching = false;
+    timerq_rearm (q);
+}
+
+static void timer_cb (flux_reactor_t *r,
+                      flux_watcher_t *w,
+                      int revents,
+                      void *arg)
+{
+    timerq_dispatch (arg);
+}
+
+void timerq_destroy (struct timerq *q)
+{
+    if (q) {
+        int saved_errno = errno;
+        flux_watcher_destroy (q->w);
+        heap_destroy (q->heap);
+        free (q);
+        errno = saved_errno;
+    }
+}
+
+struct timerq *timerq_create (flux_reactor_t *r, bool realtime)
+{
+    struct timerq *q;
+
+    if (!(q = calloc (1, sizeof (*q))))
+        return NULL;
+    q->realtime = realtime;
+    if (!(q->heap = heap_create (item_cmp)))
+        goto error;
+    if (realtime)
+        q->w = flux_periodic_watcher_create (r,
+                                             0.,
+                                             0.,
+                                             reschedule_cb,
+                                             timer_cb,
+                                             q);
+    else
+        q->w = flux_timer_watcher_create (r, 0., 0., timer_cb, q);
+    if (!q->w)
+        goto error;
+    return q;
+error:
+    timerq_destroy (q);
+    return NULL;
+}
+
+void timerq_item_disarm (struct timerq_item *item)
+{
+    if (item && item->handle) {
+        heap_delete (item->q->heap, item->handle);
+        item->handle = NULL;
+        timerq_rearm (item->q);
+    }
+}
+
+int timerq_item_arm (struct timerq_item *item, double wakeup)
+{
+    if (!item) {
+        errno = EINVAL;
+        return -1;
+    }
+    item->wakeup = wakeup;
+    if (item->handle)
+        heap_reorder (item->q->heap, item->handle);
+    else if (!(item->handle = heap_insert (item->q->heap, item))) {
+        errno = ENOMEM;
+        return -1;
+    }
+    timerq_rearm (item->q);
+    return 0;
+}
+
+double timerq_item_next_wakeup (struct timerq_item *item)
+{
+    if (!item || !item->handle)
+        return -1.;
+    if (item->q->realtime)
+        return item->wakeup;
+    return clock_now (CLOCK_REALTIME) + (item->wakeup - timerq_now (item->q));
+}
+
+void timerq_item_destroy (struct timerq_item *item)
+{
+    if (item) {
+        int saved_errno = errno;
+        timerq_item_disarm (item);
+        free (item);
+        errno = saved_errno;
+    }
+}
+
+struct timerq_item *timerq_item_create (struct timerq *q,
+                                        timerq_f cb,
+                                        void *arg)
+{
+    struct timerq_item *item;
+
+    if (!q || !cb) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(item = calloc (1, sizeof (*item))))
+        return NULL;
+    item->q = q;
+    item->cb = cb;
+    item->arg = arg;
+    return item;
+}
+
+/* vi: ts=4 sw=4 expandtab
+ */
@@ -0,0 +1,56 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef HAVE_CRON_TIMERQ_H
+#define HAVE_CRON_TIMERQ_H
+
+#include <stdbool.h>
+#include <flux/core.h>
+
+/*  A timer queue drives any number of items from a single reactor
+ *   watcher.  Items are kept in a heap ordered by wakeup time, and the
+ *   watcher is armed for the earliest.  When it fires, every item that
+ *   is due is called back in the same pass.
+ *
+ *  A realtime queue follows the system clock, so that items scheduled
+ *   for a date and time fire on time after the clock is changed.  Other
+ *   queues use the monotonic clock, for items that fire after an interval.
+ */
+struct timerq;
+struct timerq_item;
+
+typedef void (*timerq_f) (struct timerq_item *item, void *arg);
+
+struct timerq *timerq_create (flux_reactor_t *r, bool realtime);
+void timerq_destroy (struct timerq *q);
+
+/*  Return the current time on the clock used by 'q'.
+ */
+double timerq_now (struct timerq *q);
+
+struct timerq_item *timerq_item_create (struct timerq *q,
+                                        timerq_f cb,
+                                        void *arg);
+void timerq_item_destroy (struct timerq_item *item);
+
+/*  Arm 'item' to be called back at 'wakeup' on the queue's clock,
+ *   replacing any previous wakeup.  Items are disarmed before they are
+ *   called back, so a repeating item must arm itself again from its
+ *   callback, for a time after timerq_now().
+ */
+int timerq_item_arm (struct timerq_item *item, double wakeup);
+void timerq_item_disarm (struct timerq_item *item);
+
+/*  Return the wakeup time of 'item' as a system clock timestamp,
+ *   or -1. if it is not armed.
+ */
+double timerq_item_next_wakeup (struct timerq_item *item);
+
+#endif /* !HAVE_CRON_TIMERQ_H */
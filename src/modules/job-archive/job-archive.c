@@ -8,7 +8,13 @@
  * SPDX-License-Identifier: LGPL-3.0
 \************************************************************/
 
-/* job-archive: archive job data service for flux */
+/* job-archive: archive job data service for flux
+ *
+ * Jobs are tracked from the job manager's events journal.  When a job
+ * becomes inactive, it is queued for archival.  Queued jobs' eventlog,
+ * jobspec, and R are fetched with a single job-info.lookup-batch request,
+ * and the rows are inserted in a single transaction as responses arrive.
+ */
 
 #if HAVE_CONFIG_H
 #include "config.h"
@@ -24,15 +30,29 @@
 #include <jansson.h>
 #include <sqlite3.h>
 
+#include "src/common/libczmqcontainers/czmq_containers.h"
 #include "src/common/libutil/log.h"
 #include "src/common/libutil/fsd.h"
 #include "src/common/libutil/tstat.h"
 #include "src/common/libutil/monotime.h"
 #include "src/common/libjob/idf58.h"
+#include "src/common/libjob/job_hash.h"
+#include "src/common/libidset/idset.h"
+#include "ccan/str/str.h"
 
 #define BUSY_TIMEOUT_DEFAULT 50
 #define BUFSIZE              1024
 
+/* Maximum number of jobs archived per job-info.lookup-batch request
+ * and sqlite transaction.
+ */
+#define ARCHIVE_BATCH_MAX    1024
+
+/* Default delay before retrying jobs whose lookup could not be
+ * completed.  It may be set with the 'period' configuration key.
+ */
+#define ARCHIVE_RETRY_DELAY  1.0
+
 const char *sql_create_table = "CREATE TABLE if not exists jobs("
                                "  id CHAR(16) PRIMARY KEY,"
                                "  userid INT,"
@@ -58,6 +78,15 @@ const char *sql_store =                               \
 
 const char *sql_since = "SELECT MAX(t_inactive) FROM jobs;";
 
+struct archive_job {
+    flux_jobid_t id;
+    uint32_t userid;
+    double t_submit;
+    double t_run;
+    double t_cleanup;
+    double t_inactive;
+};
+
 struct job_archive_ctx {
     flux_t *h;
     double period;
@@ -67,10 +96,18 @@ struct job_archive_ctx {
     sqlite3 *db;
     sqlite3_stmt *store_stmt;
     double since;
-    int kvs_lookup_count;
     tstat_t sqlstore;
+    flux_future_t *journal_f;
+    zhashx_t *active;           /* jobs not yet inactive */
+    zlistx_t *ready_run;        /* inactive jobs that ran */
+    zlistx_t *ready_norun;      /* inactive jobs that did not run */
+    zhashx_t *batch;            /* jobs in current lookup batch */
+    flux_future_t *lookup_f;
+    bool retry_pending;
 };
 
+static void archive_start (struct job_archive_ctx *ctx);
+
 static void log_sqlite_error (struct job_archive_ctx *ctx, const char *fmt, ...)
 {
     char buf[128];
@@ -93,11 +130,39 @@ static void log_sqlite_error (struct job_archive_ctx *ctx, const char *fmt, ...)
         flux_log (ctx->h, LOG_ERR, "%s: unknown error, no sqlite3 handle", buf);
 }
 
+static void archive_job_destructor (void **item)
+{
+    if (item) {
+        free (*item);
+        *item = NULL;
+    }
+}
+
+/* Jobs move between hashes, so the hashes do not own them.
+ */
+static void archive_job_hash_destroy (zhashx_t **hp)
+{
+    if (*hp) {
+        struct archive_job *job;
+        while ((job = zhashx_first (*hp))) {
+            zhashx_delete (*hp, &job->id);
+            free (job);
+        }
+        zhashx_destroy (hp);
+    }
+}
+
 static void job_archive_ctx_destroy (struct job_archive_ctx *ctx)
 {
     if (ctx) {
         free (ctx->dbpath);
         flux_watcher_destroy (ctx->w);
+        flux_future_destroy (ctx->journal_f);
+        flux_future_destroy (ctx->lookup_f);
+        archive_job_hash_destroy (&ctx->active);
+        zlistx_destroy (&ctx->ready_run);
+        zlistx_destroy (&ctx->ready_norun);
+        archive_job_hash_destroy (&ctx->batch);
         if (ctx->store_stmt) {
             if (sqlite3_finalize (ctx->store_stmt) != SQLITE_OK)
                 log_sqlite_error (ctx, "sqlite_finalize store_stmt");
@@ -120,9 +185,19 @@ static struct job_archive_ctx * job_archive_ctx_create (flux_t *h)
     }
 
     ctx->h = h;
-    ctx->period = 0.0;
+    ctx->period = ARCHIVE_RETRY_DELAY;
     ctx->busy_timeout = BUSY_TIMEOUT_DEFAULT;
 
+    if (!(ctx->active = job_hash_create ())
+        || !(ctx->ready_run = zlistx_new ())
+        || !(ctx->ready_norun = zlistx_new ())
+        || !(ctx->batch = job_hash_create ())) {
+        flux_log_error (h, "job_archive_ctx_create");
+        goto error;
+    }
+    zlistx_set_destructor (ctx->ready_run, archive_job_destructor);
+    zlistx_set_destructor (ctx->ready_norun, archive_job_destructor);
+
     return ctx;
  error:
     job_archive_ctx_destroy (ctx);
@@ -228,83 +303,87 @@ error:
     return rc;
 }
 
-int append_key (struct job_archive_ctx *ctx, json_t *keys, const char *key)
+/* Execute a statement that takes no parameters, e.g. BEGIN or COMMIT.
+ */
+static int job_archive_exec (struct job_archive_ctx *ctx, const char *sql)
 {
-    json_t *s = NULL;
-    int rc = -1;
+    int rc;
 
-    if (!(s = json_string (key))) {
-        flux_log_error (ctx->h, "%s: json_string", __FUNCTION__);
-        goto error;
-    }
-    if (json_array_append_new (keys, s) < 0) {
-        flux_log_error (ctx->h, "%s: json_array_append_new", __FUNCTION__);
-        goto error;
+    while ((rc = sqlite3_exec (ctx->db, sql, NULL, NULL, NULL)) != SQLITE_OK) {
+        if (rc == SQLITE_BUSY) {
+            /* see comment on SQLITE_BUSY in job_archive_store() */
+            flux_log (ctx->h, LOG_DEBUG, "%s: BUSY", __FUNCTION__);
+            usleep (1000);
+            continue;
+        }
+        log_sqlite_error (ctx, "executing %s", sql);
+        return -1;
     }
     return 0;
-error:
-    json_decref (s);
-    return rc;
-}
-
-void json_decref_wrapper (void *arg)
-{
-    json_decref ((json_t *)arg);
 }
 
-void job_info_lookup_continuation (flux_future_t *f, void *arg)
+/* Return the ranks in R_lite of 'R' as an idset string, or NULL if
+ * they cannot be determined.  Caller must free.
+ */
+static char *get_ranks (struct job_archive_ctx *ctx,
+                        flux_jobid_t id,
+                        const char *R)
 {
-    struct job_archive_ctx *ctx = arg;
-    json_t *job;
-    flux_jobid_t id;
-    uint32_t userid;
-    const char *ranks = NULL;
-    double t_submit = 0.0;
-    double t_run = 0.0;
-    double t_cleanup = 0.0;
-    double t_inactive = 0.0;
-    const char *eventlog = NULL;
-    const char *jobspec = NULL;
-    const char *R = NULL;
-    char idbuf[64];
-    struct timespec t0;
+    json_t *o = NULL;
+    json_t *R_lite;
+    json_t *entry;
+    size_t index;
+    struct idset *ids = NULL;
+    char *ranks = NULL;
     json_error_t error;
 
-    monotime (&t0);
-
-    if (flux_rpc_get_unpack (f, "{s:s s:s s?s}",
-                             "eventlog", &eventlog,
-                             "jobspec", &jobspec,
-                             "R", &R) < 0) {
-        flux_log_error (ctx->h, "%s: flux_rpc_get_unpack", __FUNCTION__);
+    if (!(o = json_loads (R, 0, &error))
+        || json_unpack_ex (o, &error, 0,
+                           "{s:{s:o}}",
+                           "execution",
+                             "R_lite", &R_lite) < 0
+        || !json_is_array (R_lite)) {
+        flux_log (ctx->h, LOG_ERR, "%s: job %s: invalid R",
+                  __FUNCTION__, idf58 (id));
         goto out;
     }
-
-    if (!(job = flux_future_aux_get (f, "job"))) {
-        flux_log_error (ctx->h, "%s: flux_future_aux_get", __FUNCTION__);
+    if (!(ids = idset_create (0, IDSET_FLAG_AUTOGROW)))
         goto out;
+    json_array_foreach (R_lite, index, entry) {
+        const char *rank;
+        idset_error_t err;
+
+        if (json_unpack (entry, "{s:s}", "rank", &rank) < 0
+            || idset_decode_add (ids, rank, -1, &err) < 0) {
+            flux_log (ctx->h, LOG_ERR, "%s: job %s: invalid R_lite rank",
+                      __FUNCTION__, idf58 (id));
+            goto out;
+        }
     }
+    ranks = idset_encode (ids, IDSET_FLAG_BRACKETS | IDSET_FLAG_RANGE);
+out:
+    idset_destroy (ids);
+    json_decref (o);
+    return ranks;
+}
 
-    if (json_unpack_ex (job, &error, 0, "{s:I}", "id", &id) < 0) {
-        flux_log (ctx->h, LOG_ERR, "%s: can't parse job id: %s",
-                  __FUNCTION__, error.text);
-        goto out;
-    }
+static int job_archive_store (struct job_archive_ctx *ctx,
+                              struct archive_job *job,
+                              const char *eventlog,
+                              const char *jobspec,
+                              const char *R)
+{
+    char *ranks = NULL;
+    char idbuf[64];
+    struct timespec t0;
+    int rc = -1;
 
-    if (json_unpack_ex (job, &error, 0,
-                        "{s:i s?s s:f s?f s?f s:f}",
-                        "userid", &userid,
-                        "ranks", &ranks,
-                        "t_submit", &t_submit,
-                        "t_run", &t_run,
-                        "t_cleanup", &t_cleanup,
-                        "t_inactive", &t_inactive) < 0) {
-        flux_log (ctx->h, LOG_ERR, "%s: parse job %s error: %s",
-                  __FUNCTION__, idf58 (id), error.text);
-        goto out;
-    }
+    monotime (&t0);
+
+    if (R)
+        ranks = get_ranks (ctx, job->id, R);
 
-    snprintf (idbuf, 64, "%llu", (unsigned long long)id);
+    snprintf (idbuf, 64, "%llu", (unsigned long long)job->id);
     if (sqlite3_bind_text (ctx->store_stmt,
                            1,
                            idbuf,
@@ -315,7 +394,7 @@ void job_info_lookup_continuation (flux_future_t *f, void *arg)
     }
     if (sqlite3_bind_int (ctx->store_stmt,
                           2,
-                          userid) != SQLITE_OK) {
+                          job->userid) != SQLITE_OK) {
         log_sqlite_error (ctx, "store: binding userid");
         goto out;
     }
@@ -329,25 +408,25 @@ void job_info_lookup_continuation (flux_future_t *f, void *arg)
     }
     if (sqlite3_bind_double (ctx->store_stmt,
                              4,
-                             t_submit) != SQLITE_OK) {
+                             job->t_submit) != SQLITE_OK) {
         log_sqlite_error (ctx, "store: binding t_submit");
         goto out;
     }
     if (sqlite3_bind_double (ctx->store_stmt,
                              5,
-                             t_run) != SQLITE_OK) {
+                             job->t_run) != SQLITE_OK) {
         log_sqlite_error (ctx, "store: binding t_run");
         goto out;
     }
     if (sqlite3_bind_double (ctx->store_stmt,
                              6,
-                             t_cleanup) != SQLITE_OK) {
+                             job->t_cleanup) != SQLITE_OK) {
         log_sqlite_error (ctx, "store: binding t_cleanup");
         goto out;
     }
     if (sqlite3_bind_double (ctx->store_stmt,
                              7,
-                             t_inactive) != SQLITE_OK) {
+                             job->t_inactive) != SQLITE_OK) {
         log_sqlite_error (ctx, "store: binding t_inactive");
         goto out;
     }
@@ -397,101 +476,305 @@ void job_info_lookup_continuation (flux_future_t *f, void *arg)
         }
     }
 
-    if (t_inactive > ctx->since)
-        ctx->since = t_inactive;
-
     tstat_push (&ctx->sqlstore, monotime_since (t0));
-
+    rc = 0;
 out:
     sqlite3_reset (ctx->store_stmt);
-    flux_future_destroy (f);
-    if (ctx->kvs_lookup_count
-        && (--(ctx->kvs_lookup_count)) == 0) {
+    free (ranks);
+    return rc;
+}
+
+/* Requeue jobs left in the batch and try them again later.
+ */
+static void archive_retry (struct job_archive_ctx *ctx)
+{
+    struct archive_job *job;
+
+    while ((job = zhashx_first (ctx->batch))) {
+        zlistx_t *l = job->t_run > 0. ? ctx->ready_run : ctx->ready_norun;
+
+        zhashx_delete (ctx->batch, &job->id);
+        if (!zlistx_add_end (l, job)) {
+            flux_log_error (ctx->h, "%s: job %s dropped", __FUNCTION__,
+                            idf58 (job->id));
+            free (job);
+        }
+    }
+    if (!ctx->retry_pending) {
         flux_timer_watcher_reset (ctx->w, ctx->period, 0.);
         flux_watcher_start (ctx->w);
+        ctx->retry_pending = true;
     }
 }
 
-int job_info_lookup (struct job_archive_ctx *ctx, json_t *job)
+static void batch_delete (struct job_archive_ctx *ctx, struct archive_job *job)
 {
-    const char *topic = "job-info.lookup";
-    flux_future_t *f = NULL;
+    zhashx_delete (ctx->batch, &job->id);
+    free (job);
+}
+
+static void lookup_batch_continuation (flux_future_t *f, void *arg)
+{
+    struct job_archive_ctx *ctx = arg;
+    struct archive_job *job;
     flux_jobid_t id;
-    json_t *keys = NULL;
-    double t_run = 0.0;
+    const char *eventlog = NULL;
+    const char *jobspec = NULL;
+    const char *R = NULL;
+    int errnum = 0;
 
-    if (json_unpack (job, "{s:I s?f}", "id", &id, "t_run", &t_run) < 0) {
-        flux_log (ctx->h, LOG_ERR, "%s: parse t_run", __FUNCTION__);
-        goto error;
+    if (flux_rpc_get_unpack (f, "{s:I s?i s?s s?s s?s}",
+                             "id", &id,
+                             "errnum", &errnum,
+                             "eventlog", &eventlog,
+                             "jobspec", &jobspec,
+                             "R", &R) < 0) {
+        if (errno != ENODATA)
+            flux_log_error (ctx->h, "%s: job-info.lookup-batch", __FUNCTION__);
+        goto done;
     }
+    if (!(job = zhashx_lookup (ctx->batch, &id))) {
+        flux_log (ctx->h, LOG_ERR, "%s: unexpected job %s",
+                  __FUNCTION__, idf58 (id));
+        goto next;
+    }
+    if (errnum != 0 || !eventlog || !jobspec) {
+        if (errnum == 0)
+            errnum = EPROTO;
+        flux_log (ctx->h, LOG_ERR, "%s: job %s: %s",
+                  __FUNCTION__, idf58 (id), strerror (errnum));
+        batch_delete (ctx, job);
+        goto next;
+    }
+    if (job_archive_store (ctx, job, eventlog, jobspec, R) < 0)
+        flux_log (ctx->h, LOG_ERR, "%s: job %s not archived",
+                  __FUNCTION__, idf58 (id));
+    batch_delete (ctx, job);
+next:
+    flux_future_reset (f);
+    return;
+done:
+    if (job_archive_exec (ctx, "COMMIT") < 0)
+        flux_log (ctx->h, LOG_ERR, "failed to commit archived jobs");
+    flux_future_destroy (f);
+    ctx->lookup_f = NULL;
+    /* jobs with no response, e.g. if job-info is not loaded, are retried */
+    if (zhashx_size (ctx->batch) > 0)
+        archive_retry (ctx);
+    else
+        archive_start (ctx);
+}
 
-    if (!(keys = json_array ())) {
-        flux_log_error (ctx->h, "%s: json_array", __FUNCTION__);
-        goto error;
+/* Fetch the data for up to ARCHIVE_BATCH_MAX ready jobs in a single
+ * request, and store them in a single transaction.  Jobs that did not
+ * run have no R, so they are batched separately.
+ */
+static void archive_start (struct job_archive_ctx *ctx)
+{
+    zlistx_t *l;
+    struct archive_job *job;
+    json_t *ids = NULL;
+    json_t *keys = NULL;
+    json_t *o;
+
+    if (ctx->lookup_f || ctx->retry_pending)
+        return;
+    if (zlistx_size (ctx->ready_run) > 0) {
+        l = ctx->ready_run;
+        keys = json_pack ("[sss]", "eventlog", "jobspec", "R");
     }
-    if (append_key (ctx, keys, "eventlog") < 0)
-        goto error;
-    if (append_key (ctx, keys, "jobspec") < 0)
-        goto error;
-    if (t_run > 0.0) {
-        if (append_key (ctx, keys, "R") < 0)
-            goto error;
+    else if (zlistx_size (ctx->ready_norun) > 0) {
+        l = ctx->ready_norun;
+        keys = json_pack ("[ss]", "eventlog", "jobspec");
     }
+    else
+        return;
 
-    if (!(f = flux_rpc_pack (ctx->h, topic, FLUX_NODEID_ANY, 0,
-                             "{s:I s:O s:i}",
-                             "id", id,
-                             "keys", keys,
-                             "flags", 0))) {
-        flux_log_error (ctx->h, "%s: flux_rpc_pack", __FUNCTION__);
-        goto error;
+    if (!keys || !(ids = json_array ()))
+        goto nomem;
+    while (zhashx_size (ctx->batch) < ARCHIVE_BATCH_MAX
+           && (job = zlistx_first (l))) {
+        if (zhashx_lookup (ctx->batch, &job->id)) {
+            flux_log (ctx->h, LOG_ERR, "%s: duplicate job %s",
+                      __FUNCTION__, idf58 (job->id));
+            zlistx_delete (l, NULL);
+            continue;
+        }
+        if (!(o = json_integer (job->id))
+            || json_array_append_new (ids, o) < 0) {
+            json_decref (o);
+            goto nomem;
+        }
+        if (zhashx_insert (ctx->batch, &job->id, job) < 0)
+            goto nomem;
+        zlistx_detach (l, NULL);
     }
-    if (flux_future_then (f,
-                          -1.,
-                          job_info_lookup_continuation,
-                          ctx) < 0) {
-        flux_log_error (ctx->h, "%s: flux_future_then", __FUNCTION__);
+    if (job_archive_exec (ctx, "BEGIN") < 0)
         goto error;
-    }
-    if (flux_future_aux_set (f,
-                             "job",
-                             json_incref (job),
-                             json_decref_wrapper) < 0) {
-        flux_log_error (ctx->h, "%s: flux_future_aux_set", __FUNCTION__);
+    if (!(ctx->lookup_f = flux_rpc_pack (ctx->h,
+                                         "job-info.lookup-batch",
+                                         FLUX_NODEID_ANY,
+                                         FLUX_RPC_STREAMING,
+                                         "{s:O s:O s:i}",
+                                         "ids", ids,
+                                         "keys", keys,
+                                         "flags", 0))
+        || flux_future_then (ctx->lookup_f,
+                             -1.,
+                             lookup_batch_continuation,
+                             ctx) < 0) {
+        flux_log_error (ctx->h, "%s: job-info.lookup-batch", __FUNCTION__);
+        flux_future_destroy (ctx->lookup_f);
+        ctx->lookup_f = NULL;
+        (void)job_archive_exec (ctx, "ROLLBACK");
         goto error;
     }
-
+    json_decref (ids);
     json_decref (keys);
-    ctx->kvs_lookup_count++;
-    return 0;
-
+    return;
+nomem:
+    errno = ENOMEM;
+    flux_log_error (ctx->h, "%s", __FUNCTION__);
 error:
-    flux_future_destroy (f);
+    json_decref (ids);
     json_decref (keys);
-    return -1;
+    archive_retry (ctx);
+}
+
+/* Track the job times that are archived from events.  The times are
+ * those of the job state transitions reported by job-list.
+ */
+static int journal_process_event (struct job_archive_ctx *ctx,
+                                  flux_jobid_t id,
+                                  json_t *entry)
+{
+    struct archive_job *job;
+    double timestamp;
+    const char *name;
+    json_t *context = NULL;
+
+    if (json_unpack (entry, "{s:F s:s s?o}",
+                     "timestamp", &timestamp,
+                     "name", &name,
+                     "context", &context) < 0) {
+        flux_log (ctx->h, LOG_ERR, "%s: error parsing job %s event",
+                  __FUNCTION__, idf58 (id));
+        errno = EPROTO;
+        return -1;
+    }
+    if (streq (name, "submit")) {
+        int userid;
+        if (zhashx_lookup (ctx->active, &id))
+            return 0;
+        if (!context || json_unpack (context, "{s:i}", "userid", &userid) < 0) {
+            flux_log (ctx->h, LOG_ERR, "%s: error parsing job %s submit event",
+                      __FUNCTION__, idf58 (id));
+            errno = EPROTO;
+            return -1;
+        }
+        if (!(job = calloc (1, sizeof (*job))))
+            return -1;
+        job->id = id;
+        job->userid = userid;
+        job->t_submit = timestamp;
+        if (zhashx_insert (ctx->active, &job->id, job) < 0) {
+            free (job);
+            errno = EEXIST;
+            return -1;
+        }
+        return 0;
+    }
+    if (!(job = zhashx_lookup (ctx->active, &id)))
+        return 0;
+    if (streq (name, "alloc"))
+        job->t_run = timestamp;
+    else if (streq (name, "finish")) {
+        if (job->t_cleanup == 0.)
+            job->t_cleanup = timestamp;
+    }
+    else if (streq (name, "exception")) {
+        int severity;
+        if (context
+            && json_unpack (context, "{s:i}", "severity", &severity) == 0
+            && severity == 0
+            && job->t_cleanup == 0.)
+            job->t_cleanup = timestamp;
+    }
+    else if (streq (name, "clean")) {
+        job->t_inactive = timestamp;
+        zhashx_delete (ctx->active, &id);
+        /* jobs that were inactive before the most recently archived job
+         * have already been archived */
+        if (job->t_inactive <= ctx->since) {
+            free (job);
+            return 0;
+        }
+        if (!zlistx_add_end (job->t_run > 0. ? ctx->ready_run
+                                             : ctx->ready_norun,
+                             job)) {
+            free (job);
+            errno = ENOMEM;
+            return -1;
+        }
+    }
+    return 0;
 }
 
-void job_list_inactive_continuation (flux_future_t *f, void *arg)
+static void journal_continuation (flux_future_t *f, void *arg)
 {
     struct job_archive_ctx *ctx = arg;
-    json_t *jobs;
+    flux_jobid_t id;
+    json_t *events;
     size_t index;
-    json_t *value;
-
-    if (flux_rpc_get_unpack (f, "{s:o}", "jobs", &jobs) < 0) {
-        flux_log_error (ctx->h, "%s: flux_rpc_get_unpack", __FUNCTION__);
+    json_t *entry;
+
+    if (flux_rpc_get_unpack (f, "{s:I s:o}",
+                             "id", &id,
+                             "events", &events) < 0) {
+        flux_log_error (ctx->h, "%s: job-manager.events-journal",
+                        __FUNCTION__);
+        flux_reactor_stop_error (flux_get_reactor (ctx->h));
         return;
     }
-    json_array_foreach (jobs, index, value) {
-        if (job_info_lookup (ctx, value) < 0)
-            break;
+    /* ignore the sentinel that ends the backlog */
+    if (id != FLUX_JOBID_ANY) {
+        json_array_foreach (events, index, entry) {
+            if (journal_process_event (ctx, id, entry) < 0) {
+                flux_log_error (ctx->h, "%s: job %s", __FUNCTION__, idf58 (id));
+                break;
+            }
+        }
+        archive_start (ctx);
     }
-    /* If no new inactive jobs, still need to reset timer */
-    if (!ctx->kvs_lookup_count) {
-        flux_timer_watcher_reset (ctx->w, ctx->period, 0.);
-        flux_watcher_start (ctx->w);
+    flux_future_reset (f);
+}
+
+static int journal_start (struct job_archive_ctx *ctx)
+{
+    if (!(ctx->journal_f = flux_rpc_pack (ctx->h,
+                                          "job-manager.events-journal",
+                                          FLUX_NODEID_ANY,
+                                          FLUX_RPC_STREAMING,
+                                          "{s:b s:b s:{s:i s:i s:i s:i s:i}}",
+                                          "full", 1,
+                                          "coalesce", 1,
+                                          "allow",
+                                            "submit", 1,
+                                            "alloc", 1,
+                                            "finish", 1,
+                                            "exception", 1,
+                                            "clean", 1))) {
+        flux_log_error (ctx->h, "%s: flux_rpc_pack", __FUNCTION__);
+        return -1;
     }
-    flux_future_destroy (f);
+    if (flux_future_then (ctx->journal_f,
+                          -1.,
+                          journal_continuation,
+                          ctx) < 0) {
+        flux_log_error (ctx->h, "%s: flux_future_then", __FUNCTION__);
+        return -1;
+    }
+    return 0;
 }
 
 void job_archive_cb (flux_reactor_t *r,
@@ -500,31 +783,9 @@ void job_archive_cb (flux_reactor_t *r,
                      void *arg)
 {
     struct job_archive_ctx *ctx = arg;
-    flux_future_t *f;
-
-    if (!(f = flux_rpc_pack (ctx->h,
-                             "job-list.list",
-                             FLUX_NODEID_ANY,
-                             0,
-                             "{s:i s:f s:[ssssss] s:{s:[i]}}",
-                             "max_entries", 0,
-                             "since", ctx->since,
-                             "attrs",
-                               "userid",
-                               "ranks",
-                               "t_submit",
-                               "t_run",
-                               "t_cleanup",
-                               "t_inactive",
-                             "constraint",
-                               "states", FLUX_JOB_STATE_INACTIVE))) {
-        flux_log_error (ctx->h, "%s: flux_rpc_pack", __FUNCTION__);
-        return;
-    }
-    if (flux_future_then (f, -1, job_list_inactive_continuation, ctx) < 0) {
-        flux_log_error (ctx->h, "%s: flux_future_then", __FUNCTION__);
-        return;
-    }
+
+    ctx->retry_pending = false;
+    archive_start (ctx);
 }
 
 void stats_get_cb (flux_t *h,
@@ -533,10 +794,14 @@ void stats_get_cb (flux_t *h,
                    void *arg)
 {
     struct job_archive_ctx *ctx = arg;
+    int pending = zlistx_size (ctx->ready_run)
+                  + zlistx_size (ctx->ready_norun)
+                  + zhashx_size (ctx->batch);
 
     if (flux_respond_pack (h,
                            msg,
-                           "{s:i s:f s:f s:f s:f}",
+                           "{s:i s:i s:f s:f s:f s:f}",
+                           "pending", pending,
                            "count", tstat_count (&ctx->sqlstore),
                            "min", tstat_min (&ctx->sqlstore),
                            "max", tstat_max (&ctx->sqlstore),
@@ -567,8 +832,11 @@ static int process_config (struct job_archive_ctx *ctx)
     }
 
     if (period) {
-        if (fsd_parse_duration (period, &ctx->period) < 0)
-            flux_log_error (ctx->h, "period not configured");
+        if (fsd_parse_duration (period, &ctx->period) < 0
+            || ctx->period == 0.0) {
+            flux_log (ctx->h, LOG_ERR, "invalid period: %s", period);
+            return -1;
+        }
     }
     if (dbpath) {
         if (!(ctx->dbpath = strdup (dbpath)))
@@ -593,12 +861,6 @@ static int process_config (struct job_archive_ctx *ctx)
         else
             ctx->busy_timeout = (int)(1000 * tmp);
     }
-
-    /* period is required to be set */
-    if (ctx->period == 0.0) {
-        flux_log_error (ctx->h, "period not set");
-        return -1;
-    }
     return 0;
 }
 
@@ -632,13 +894,14 @@ int mod_main (flux_t *h, int ac, char **av)
         goto done;
     }
 
-    flux_watcher_start (ctx->w);
-
     if (flux_msg_handler_addvec (h, htab, ctx, &handlers) < 0) {
         flux_log_error (h, "flux_msg_handler_addvec");
         goto done;
     }
 
+    if (journal_start (ctx) < 0)
+        goto done;
+
     if ((rc = flux_reactor_run (flux_get_reactor (h), 0)) < 0)
         flux_log_error (h, "flux_reactor_run");
 
@@ -20,6 +20,7 @@
 #include <flux/idset.h>
 
 #include "src/common/libczmqcontainers/czmq_containers.h"
+#include "src/common/libsubprocess/command_private.h"
 #include "src/common/libutil/aux.h"
 #include "src/common/libjob/idf58.h"
 #include "ccan/str/str.h"
@@ -31,6 +32,16 @@ struct exec_cmd {
     int flags;
 };
 
+/*  A command launched with job-exec.tree-exec (see tree-exec.h).
+ */
+struct tree_launch {
+    struct bulk_exec *exec;
+    struct idset *ranks;     /* All ranks the command was launched on */
+    struct idset *pending;   /* Ranks that have not exited or failed */
+    flux_cmd_t *cmd;
+    flux_future_t *f;
+};
+
 struct bulk_exec {
     flux_t *h;
 
@@ -42,12 +53,15 @@ struct bulk_exec {
 
     int max_start_per_loop;  /* Max subprocess started per event loop cb */
     int total;               /* Total processes expected to run */
+    int launched;            /* Number of processes launched */
     int started;             /* Number of processes that have reached start */
     int complete;            /* Number of processes that have completed */
 
     int exit_status;         /* Largest wait status of all complete procs */
 
     unsigned int active:1;
+    unsigned int tree:1;
+    unsigned int reattach:1;
 
     flux_watcher_t *prep;
     flux_watcher_t *check;
@@ -60,6 +74,8 @@ struct bulk_exec {
 
     zlist_t *commands;
     zlist_t *processes;
+    zlist_t *tree_launches;  /* struct tree_launch */
+    zhashx_t *tree_status;   /* wait status => idset of ranks (tree mode) */
 
     struct bulk_exec_ops *handlers;
     void *arg;
@@ -74,7 +90,7 @@ int bulk_exec_rc (struct bulk_exec *exec)
 
 int bulk_exec_current (struct bulk_exec *exec)
 {
-    return zlist_size (exec->processes);
+    return exec->launched;
 }
 
 int bulk_exec_total (struct bulk_exec *exec)
@@ -82,10 +98,60 @@ int bulk_exec_total (struct bulk_exec *exec)
     return exec->total;
 }
 
+/*  Send job-exec.tree-write with 'data' and/or 'eof' for every active
+ *   tree launch.
+ */
+static int tree_write (struct bulk_exec *exec,
+                       const char *stream,
+                       const char *buf,
+                       size_t len,
+                       bool eof)
+{
+    struct tree_launch *l = zlist_first (exec->tree_launches);
+    while (l) {
+        if (idset_count (l->pending) > 0) {
+            json_t *o;
+            flux_future_t *f;
+
+            if (!(o = json_pack ("{s:I s:s s:s s:b}",
+                                 "id", exec->id,
+                                 "name", exec->name,
+                                 "stream", stream,
+                                 "eof", eof)))
+                goto nomem;
+            if (buf && json_object_set_new (o,
+                                            "data",
+                                            json_stringn (buf, len)) < 0) {
+                json_decref (o);
+                goto nomem;
+            }
+            f = flux_rpc_pack (exec->h,
+                               "job-exec.tree-write",
+                               FLUX_NODEID_ANY,
+                               FLUX_RPC_NORESPONSE,
+                               "O",
+                               o);
+            json_decref (o);
+            if (!f)
+                return -1;
+            flux_future_destroy (f);
+        }
+        l = zlist_next (exec->tree_launches);
+    }
+    return 0;
+nomem:
+    errno = ENOMEM;
+    return -1;
+}
+
 int bulk_exec_write (struct bulk_exec *exec, const char *stream,
                      const char *buf, size_t len)
 {
-    flux_subprocess_t *p = zlist_first (exec->processes);
+    flux_subprocess_t *p;
+
+    if (exec->tree)
+        return tree_write (exec, stream, buf, len, false);
+    p = zlist_first (exec->processes);
     while (p) {
         if (flux_subprocess_write (p, stream, buf, len) < len)
             return -1;
@@ -96,7 +162,11 @@ int bulk_exec_write (struct bulk_exec *exec, const char *stream,
 
 int bulk_exec_close (struct bulk_exec *exec, const char *stream)
 {
-    flux_subprocess_t *p = zlist_first (exec->processes);
+    flux_subprocess_t *p;
+
+    if (exec->tree)
+        return tree_write (exec, stream, NULL, 0, true);
+    p = zlist_first (exec->processes);
     while (p) {
         if (flux_subprocess_close (p, stream) < 0)
             return -1;
@@ -126,7 +196,7 @@ static void exit_batch_cb (flux_reactor_t *r,
     exec_exit_notify (exec);
 }
 
-/*  Append completed subprocess 'p' to the current batch for exit
+/*  Append the completed process on 'rank' to the current batch for exit
  *   notification. If this is the first exited process in the batch,
  *   then start a timer which will fire and call the function to
  *   notify bulk_exec user of the batch of subprocess exits.
@@ -134,9 +204,8 @@ static void exit_batch_cb (flux_reactor_t *r,
  *  This approach avoids unnecessarily calling into user's callback
  *   multiple times when all tasks exit within 0.01s.
  */
-static void exit_batch_append (struct bulk_exec *exec, flux_subprocess_t *p)
+static void exit_batch_append (struct bulk_exec *exec, int rank)
 {
-    int rank = flux_subprocess_rank (p);
     if (idset_set (exec->exit_batch, rank) < 0) {
         flux_log_error (exec->h, "exit_batch_append:idset_set");
         return;
@@ -156,10 +225,10 @@ static void exit_batch_append (struct bulk_exec *exec, flux_subprocess_t *p)
     }
 }
 
-static void exec_add_completed (struct bulk_exec *exec, flux_subprocess_t *p)
+static void exec_add_completed (struct bulk_exec *exec, int rank)
 {
     /* Append this process to the current batch for notification */
-    exit_batch_append (exec, p);
+    exit_batch_append (exec, rank);
 
     if (++exec->complete == exec->total) {
         exec_exit_notify (exec);
@@ -176,7 +245,31 @@ static void exec_complete_cb (flux_subprocess_t *p)
     if (status > exec->exit_status)
         exec->exit_status = status;
 
-    exec_add_completed (exec, p);
+    exec_add_completed (exec, flux_subprocess_rank (p));
+}
+
+/*  Map an exec failure to a wait status for bulk_exec_rc().
+ */
+static int exec_fail_code (int errnum)
+{
+    int code = EXIT_CODE(1);
+
+    if (errnum == EPERM || errnum == EACCES)
+        code = EXIT_CODE(126);
+    else if (errnum == ENOENT)
+        code = EXIT_CODE(127);
+    else if (errnum == EHOSTUNREACH) {
+        /*  Do not set a "failure" exit code for a lost job shell.
+         *  This is because if the child job is an instance of Flux
+         *  that wants to continue running after losing a broker, then
+         *  we don't want to force a nonzero instance exit code which
+         *  would make the job appear to have failed. If the instance
+         *  does exit due to a node failure, then a nonzero exit code
+         *  will be set later anyway by the resultant job exception.
+         */
+        code = 0;
+    }
+    return code;
 }
 
 static void exec_state_cb (flux_subprocess_t *p, flux_subprocess_state_t state)
@@ -190,31 +283,16 @@ static void exec_state_cb (flux_subprocess_t *p, flux_subprocess_state_t state)
     }
     else if (state == FLUX_SUBPROCESS_FAILED) {
         int errnum = flux_subprocess_fail_errno (p);
-        int code = EXIT_CODE(1);
-
-        if (errnum == EPERM || errnum == EACCES)
-            code = EXIT_CODE(126);
-        else if (errnum == ENOENT)
-            code = EXIT_CODE(127);
-        else if (errnum == EHOSTUNREACH) {
-            /*  Do not set a "failure" exit code for a lost job shell.
-             *  This is because if the child job is an instance of Flux
-             *  that wants to continue running after losing a broker, then
-             *  we don't want to force a nonzero instance exit code which
-             *  would make the job appear to have failed. If the instance
-             *  does exit due to a node failure, then a nonzero exit code
-             *  will be set later anyway by the resultant job exception.
-             */
-            code = 0;
-        }
+        int rank = flux_subprocess_rank (p);
+        int code = exec_fail_code (errnum);
 
         if (code > exec->exit_status)
             exec->exit_status = code;
 
         if (exec->handlers->on_error)
-            (*exec->handlers->on_error) (exec, p, exec->arg);
+            (*exec->handlers->on_error) (exec, p, rank, errnum, exec->arg);
 
-        exec_add_completed (exec, p);
+        exec_add_completed (exec, rank);
     }
 }
 
@@ -231,7 +309,13 @@ static void exec_output_cb (flux_subprocess_t *p, const char *stream)
     if (len) {
         int rank = flux_subprocess_rank (p);
         if (exec->handlers->on_output)
-            (*exec->handlers->on_output) (exec, p, stream, s, len, exec->arg);
+            (*exec->handlers->on_output) (exec,
+                                          p,
+                                          rank,
+                                          stream,
+                                          s,
+                                          len,
+                                          exec->arg);
         else
             flux_log (exec->h, LOG_INFO, "rank %d: %s: %s", rank, stream, s);
     }
@@ -349,6 +433,7 @@ static int exec_start_cmd (struct bulk_exec *exec,
         zlist_freefn (exec->processes, p,
                      (zlist_free_fn *) flux_subprocess_destroy,
                      true);
+        exec->launched++;
 
         idset_clear (cmd->ranks, rank);
         rank = idset_next (cmd->ranks, rank);
@@ -357,6 +442,256 @@ static int exec_start_cmd (struct bulk_exec *exec,
     return count;
 }
 
+static void tree_launch_destroy (void *arg)
+{
+    struct tree_launch *l = arg;
+    if (l) {
+        int saved_errno = errno;
+        flux_future_destroy (l->f);
+        idset_destroy (l->ranks);
+        idset_destroy (l->pending);
+        flux_cmd_destroy (l->cmd);
+        free (l);
+        errno = saved_errno;
+    }
+}
+
+static void idset_destructor (void **item)
+{
+    if (item) {
+        idset_destroy (*item);
+        *item = NULL;
+    }
+}
+
+/*  Call 'fn' for each rank of each idset in an object of RFC 22 idsets
+ *   keyed by integer, as sent in the "exited" and "failed" members of
+ *   job-exec.tree-exec responses.
+ */
+static int tree_foreach_rank (struct tree_launch *l,
+                              json_t *o,
+                              void (*fn)(struct tree_launch *, int, int))
+{
+    const char *key;
+    json_t *val;
+
+    json_object_foreach (o, key, val) {
+        struct idset *ids;
+        int n = strtol (key, NULL, 10);
+        unsigned int rank;
+
+        if (!json_is_string (val)
+            || !(ids = idset_decode (json_string_value (val)))) {
+            errno = EPROTO;
+            return -1;
+        }
+        rank = idset_first (ids);
+        while (rank != IDSET_INVALID_ID) {
+            /*  Ignore ranks that were already reported */
+            if (idset_test (l->pending, rank)) {
+                (void)idset_clear (l->pending, rank);
+                fn (l, rank, n);
+            }
+            rank = idset_next (ids, rank);
+        }
+        idset_destroy (ids);
+    }
+    return 0;
+}
+
+static void tree_exited (struct tree_launch *l, int rank, int status)
+{
+    struct bulk_exec *exec = l->exec;
+    char key[16];
+    struct idset *ids;
+
+    if (status > exec->exit_status)
+        exec->exit_status = status;
+
+    snprintf (key, sizeof (key), "%d", status);
+    if (!(ids = zhashx_lookup (exec->tree_status, key))) {
+        if (!(ids = idset_create (0, IDSET_FLAG_AUTOGROW))) {
+            flux_log_error (exec->h, "tree_exited: idset_create");
+            goto out;
+        }
+        (void)zhashx_insert (exec->tree_status, key, ids);
+    }
+    if (idset_set (ids, rank) < 0)
+        flux_log_error (exec->h, "tree_exited: idset_set");
+out:
+    exec_add_completed (exec, rank);
+}
+
+static void tree_failed (struct tree_launch *l, int rank, int errnum)
+{
+    struct bulk_exec *exec = l->exec;
+    int code = exec_fail_code (errnum);
+
+    if (code > exec->exit_status)
+        exec->exit_status = code;
+
+    if (exec->handlers->on_error)
+        (*exec->handlers->on_error) (exec, NULL, rank, errnum, exec->arg);
+
+    exec_add_completed (exec, rank);
+}
+
+static void tree_output (struct tree_launch *l, json_t *output)
+{
+    struct bulk_exec *exec = l->exec;
+    size_t index;
+    json_t *entry;
+
+    json_array_foreach (output, index, entry) {
+        const char *ranks;
+        const char *stream;
+        const char *data;
+        size_t len;
+        struct idset *ids;
+        unsigned int rank;
+
+        if (json_unpack (entry, "[s s s%]", &ranks, &stream, &data, &len) < 0
+            || !(ids = idset_decode (ranks))) {
+            flux_log (exec->h, LOG_ERR, "tree-exec: malformed output entry");
+            continue;
+        }
+        /*  Lines merged from several ranks are delivered once per rank.
+         */
+        rank = idset_first (ids);
+        while (rank != IDSET_INVALID_ID) {
+            if (exec->handlers->on_output)
+                (*exec->handlers->on_output) (exec,
+                                              NULL,
+                                              rank,
+                                              stream,
+                                              data,
+                                              len,
+                                              exec->arg);
+            else
+                flux_log (exec->h,
+                          LOG_INFO,
+                          "rank %u: %s: %s",
+                          rank,
+                          stream,
+                          data);
+            rank = idset_next (ids, rank);
+        }
+        idset_destroy (ids);
+    }
+}
+
+static void tree_launch_continuation (flux_future_t *f, void *arg)
+{
+    struct tree_launch *l = arg;
+    struct bulk_exec *exec = l->exec;
+    const char *started = NULL;
+    json_t *exited = NULL;
+    json_t *failed = NULL;
+    json_t *output = NULL;
+
+    if (flux_rpc_get_unpack (f,
+                             "{s?s s?o s?o s?o}",
+                             "started", &started,
+                             "exited", &exited,
+                             "failed", &failed,
+                             "output", &output) < 0) {
+        /*  The stream has ended.  Any ranks not accounted for by now
+         *  (which should only happen on error) are failed with errnum.
+         */
+        int errnum = errno == ENODATA ? EPROTO : errno;
+        unsigned int rank;
+
+        if (errno != ENODATA)
+            flux_log (exec->h,
+                      LOG_ERR,
+                      "%s: tree-exec: %s",
+                      idf58 (exec->id),
+                      future_strerror (f, errno));
+        while ((rank = idset_first (l->pending)) != IDSET_INVALID_ID) {
+            (void)idset_clear (l->pending, rank);
+            tree_failed (l, rank, errnum);
+        }
+        return;
+    }
+    if (output)
+        tree_output (l, output);
+    if (started) {
+        struct idset *ids = idset_decode (started);
+        if (!ids)
+            flux_log_error (exec->h, "tree-exec: error decoding started");
+        else {
+            exec->started += idset_count (ids);
+            idset_destroy (ids);
+            if (exec->started == exec->total && exec->handlers->on_start)
+                (*exec->handlers->on_start) (exec, exec->arg);
+        }
+    }
+    if ((exited && tree_foreach_rank (l, exited, tree_exited) < 0)
+        || (failed && tree_foreach_rank (l, failed, tree_failed) < 0))
+        flux_log_error (exec->h, "tree-exec: error decoding response");
+    flux_future_reset (f);
+}
+
+/*  Launch all ranks of 'cmd' with one job-exec.tree-exec request, or
+ *   in reattach mode, rebind to a previous launch of it with
+ *   job-exec.tree-reattach.
+ */
+static int tree_start_cmd (struct bulk_exec *exec, struct exec_cmd *cmd)
+{
+    struct tree_launch *l;
+    char *ranks = NULL;
+    json_t *cmd_o = NULL;
+    int count = idset_count (cmd->ranks);
+
+    if (!(l = calloc (1, sizeof (*l))))
+        return -1;
+    l->exec = exec;
+    if (!(l->ranks = idset_copy (cmd->ranks))
+        || !(l->pending = idset_copy (cmd->ranks))
+        || !(l->cmd = flux_cmd_copy (cmd->cmd))
+        || !(ranks = idset_encode (cmd->ranks, IDSET_FLAG_RANGE)))
+        goto error;
+    if (exec->reattach)
+        l->f = flux_rpc_pack (exec->h,
+                              "job-exec.tree-reattach",
+                              FLUX_NODEID_ANY,
+                              FLUX_RPC_STREAMING,
+                              "{s:I s:s s:s}",
+                              "id", exec->id,
+                              "name", exec->name,
+                              "ranks", ranks);
+    else if ((cmd_o = cmd_tojson (cmd->cmd)))
+        l->f = flux_rpc_pack (exec->h,
+                              "job-exec.tree-exec",
+                              FLUX_NODEID_ANY,
+                              FLUX_RPC_STREAMING,
+                              "{s:I s:s s:s s:i s:s s:O}",
+                              "id", exec->id,
+                              "name", exec->name,
+                              "service", exec->service,
+                              "flags", cmd->flags,
+                              "ranks", ranks,
+                              "cmd", cmd_o);
+    if (!l->f
+        || flux_future_then (l->f, -1., tree_launch_continuation, l) < 0)
+        goto error;
+    if (zlist_append (exec->tree_launches, l) < 0) {
+        errno = ENOMEM;
+        goto error;
+    }
+    zlist_freefn (exec->tree_launches, l, tree_launch_destroy, true);
+    idset_range_clear (cmd->ranks, 0, INT_MAX);
+    exec->launched += count;
+    json_decref (cmd_o);
+    free (ranks);
+    return count;
+error:
+    tree_launch_destroy (l);
+    json_decref (cmd_o);
+    free (ranks);
+    return -1;
+}
+
 void bulk_exec_stop (struct bulk_exec *exec)
 {
     flux_watcher_stop (exec->prep);
@@ -367,7 +702,11 @@ static int exec_start_cmds (struct bulk_exec *exec, int max)
 {
     while (zlist_size (exec->commands) && (max != 0)) {
         struct exec_cmd *cmd = zlist_first (exec->commands);
-        int rc = exec_start_cmd (exec, cmd, max);
+        int rc;
+        if (exec->tree)
+            rc = tree_start_cmd (exec, cmd);
+        else
+            rc = exec_start_cmd (exec, cmd, max);
         if (rc < 0) {
             flux_log_error (exec->h, "exec_start_cmd failed");
             return -1;
@@ -375,7 +714,7 @@ static int exec_start_cmds (struct bulk_exec *exec, int max)
         if (idset_count (cmd->ranks) == 0)
             zlist_remove (exec->commands, cmd);
         if (max > 0)
-            max -= rc;
+            max = rc < max ? max - rc : 0;
 
     }
     return 0;
@@ -405,7 +744,7 @@ static void check_cb (flux_reactor_t *r, flux_watcher_t *w,
     if (exec_start_cmds (exec, exec->max_start_per_loop) < 0) {
         bulk_exec_stop (exec);
         if (exec->handlers->on_error)
-            (*exec->handlers->on_error) (exec, NULL, exec->arg);
+            (*exec->handlers->on_error) (exec, NULL, -1, errno, exec->arg);
     }
 }
 
@@ -413,6 +752,8 @@ void bulk_exec_destroy (struct bulk_exec *exec)
 {
     if (exec) {
         int saved_errno = errno;
+        zlist_destroy (&exec->tree_launches);
+        zhashx_destroy (&exec->tree_status);
         zlist_destroy (&exec->processes);
         zlist_destroy (&exec->commands);
         idset_destroy (exec->exit_batch);
@@ -452,7 +793,16 @@ struct bulk_exec * bulk_exec_create (struct bulk_exec_ops *ops,
     exec->arg = arg;
     exec->processes = zlist_new ();
     exec->commands = zlist_new ();
+    exec->tree_launches = zlist_new ();
+    exec->tree_status = zhashx_new ();
     exec->exit_batch = idset_create (0, IDSET_FLAG_AUTOGROW);
+    if (!exec->processes
+        || !exec->commands
+        || !exec->tree_launches
+        || !exec->tree_status
+        || !exec->exit_batch)
+        goto error;
+    zhashx_set_destructor (exec->tree_status, idset_destructor);
     exec->max_start_per_loop = 1;
 
     return exec;
@@ -471,6 +821,26 @@ int bulk_exec_set_max_per_loop (struct bulk_exec *exec, int max)
     return 0;
 }
 
+void bulk_exec_set_tree (struct bulk_exec *exec, bool tree)
+{
+    exec->tree = tree;
+}
+
+bool bulk_exec_is_tree (struct bulk_exec *exec)
+{
+    return exec->tree;
+}
+
+int bulk_exec_set_reattach (struct bulk_exec *exec, bool reattach)
+{
+    if (reattach && !exec->tree) {
+        errno = ENOTSUP;
+        return -1;
+    }
+    exec->reattach = reattach;
+    return 0;
+}
+
 int bulk_exec_push_cmd (struct bulk_exec *exec,
                        const struct idset *ranks,
                        flux_cmd_t *cmd,
@@ -563,11 +933,76 @@ void bulk_exec_kill_log_error (flux_future_t *f, flux_jobid_t id)
     }
 }
 
+/*  Send job-exec.tree-kill for every active tree launch.  If 'imp_path'
+ *   is set, the signal is delivered with "flux-imp kill" on each rank.
+ */
+static flux_future_t *tree_kill (struct bulk_exec *exec,
+                                 const char *imp_path,
+                                 int signum)
+{
+    struct tree_launch *l;
+    flux_future_t *cf = NULL;
+    int count = 0;
+
+    if (!(cf = flux_future_wait_all_create ()))
+        return NULL;
+    flux_future_set_flux (cf, exec->h);
+
+    l = zlist_first (exec->tree_launches);
+    while (l) {
+        if (idset_count (l->pending) > 0) {
+            flux_future_t *f;
+            json_t *o;
+            char s[64];
+
+            if (!(o = json_pack ("{s:I s:s s:i}",
+                                 "id", exec->id,
+                                 "name", exec->name,
+                                 "signum", signum))
+                || (imp_path
+                    && json_object_set_new (o,
+                                            "imp",
+                                            json_string (imp_path)) < 0)) {
+                json_decref (o);
+                errno = ENOMEM;
+                goto error;
+            }
+            f = flux_rpc_pack (exec->h,
+                               "job-exec.tree-kill",
+                               FLUX_NODEID_ANY,
+                               0,
+                               "O",
+                               o);
+            json_decref (o);
+            if (!f)
+                goto error;
+            (void) snprintf (s, sizeof (s), "%d", count++);
+            if (flux_future_push (cf, s, f) < 0) {
+                flux_future_destroy (f);
+                goto error;
+            }
+        }
+        l = zlist_next (exec->tree_launches);
+    }
+    if (!flux_future_first_child (cf)) {
+        flux_future_destroy (cf);
+        errno = ENOENT;
+        return NULL;
+    }
+    return cf;
+error:
+    flux_future_destroy (cf);
+    return NULL;
+}
+
 flux_future_t *bulk_exec_kill (struct bulk_exec *exec, int signum)
 {
     flux_subprocess_t *p = zlist_first (exec->processes);
     flux_future_t *cf = NULL;
 
+    if (exec->tree)
+        return tree_kill (exec, NULL, signum);
+
     if (!(cf = flux_future_wait_all_create ()))
         return NULL;
     flux_future_set_flux (cf, exec->h);
@@ -609,12 +1044,12 @@ flux_future_t *bulk_exec_kill (struct bulk_exec *exec, int signum)
 
 static void imp_kill_output (struct bulk_exec *kill,
                              flux_subprocess_t *p,
+                             int rank,
                              const char *stream,
                              const char *data,
                              int len,
                              void *arg)
 {
-    int rank = flux_subprocess_rank (p);
     flux_log (kill->h, LOG_INFO,
               "%s (rank %d): imp kill: %s",
               flux_get_hostbyrank (kill->h, rank),
@@ -633,9 +1068,11 @@ static void imp_kill_complete (struct bulk_exec *kill, void *arg)
 
 static void imp_kill_error (struct bulk_exec *kill,
                             flux_subprocess_t *p,
+                            int rank,
+                            int errnum,
                             void *arg)
 {
-    int rank = flux_subprocess_rank (p);
+    errno = errnum;
     flux_log_error (kill->h,
                     "imp kill on %s (rank %d) failed",
                     flux_get_hostbyrank (kill->h, rank),
@@ -678,6 +1115,9 @@ flux_future_t *bulk_exec_imp_kill (struct bulk_exec *exec,
     flux_future_t *f = NULL;
     int count = 0;
 
+    if (exec->tree)
+        return tree_kill (exec, imp_path, signum);
+
     /* Empty future for return value
      */
     if (!(f = flux_future_create (NULL, NULL))) {
@@ -772,5 +1212,48 @@ flux_subprocess_t *bulk_exec_get_subprocess (struct bulk_exec *exec, int rank)
     return NULL;
 }
 
+const flux_cmd_t *bulk_exec_get_cmd (struct bulk_exec *exec, int rank)
+{
+    if (exec->tree) {
+        struct tree_launch *l = zlist_first (exec->tree_launches);
+        while (l) {
+            if (rank >= 0 && idset_test (l->ranks, rank))
+                return l->cmd;
+            l = zlist_next (exec->tree_launches);
+        }
+    }
+    else {
+        flux_subprocess_t *p = bulk_exec_get_subprocess (exec, rank);
+        if (p)
+            return flux_subprocess_get_cmd (p);
+    }
+    errno = ENOENT;
+    return NULL;
+}
+
+int bulk_exec_signaled (struct bulk_exec *exec, int rank)
+{
+    if (exec->tree) {
+        struct idset *ids = zhashx_first (exec->tree_status);
+        while (ids) {
+            if (idset_test (ids, rank)) {
+                int status = strtol (zhashx_cursor (exec->tree_status),
+                                     NULL,
+                                     10);
+                if (WIFSIGNALED (status))
+                    return WTERMSIG (status);
+                break;
+            }
+            ids = zhashx_next (exec->tree_status);
+        }
+    }
+    else {
+        flux_subprocess_t *p = bulk_exec_get_subprocess (exec, rank);
+        if (p)
+            return flux_subprocess_signaled (p);
+    }
+    return -1;
+}
+
 /* vi: ts=4 sw=4 expandtab
  */
@@ -22,8 +22,12 @@ typedef void (*exec_cb_f)   (struct bulk_exec *, void *arg);
 typedef void (*exec_exit_f) (struct bulk_exec *, void *arg,
                              const struct idset *ranks);
 
+/*  In tree launch mode there is no local subprocess handle and the
+ *   flux_subprocess_t argument to the callbacks below is NULL.
+ */
 typedef void (*exec_io_f)   (struct bulk_exec *,
                              flux_subprocess_t *,
+                             int rank,
                              const char *stream,
                              const char *data,
                              int data_len,
@@ -31,6 +35,8 @@ typedef void (*exec_io_f)   (struct bulk_exec *,
 
 typedef void (*exec_error_f) (struct bulk_exec *,
                               flux_subprocess_t *,
+                              int rank,
+                              int errnum,
                               void *arg);
 
 struct bulk_exec_ops {
@@ -59,6 +65,21 @@ int bulk_exec_aux_set (struct bulk_exec *exec,
  */
 int bulk_exec_set_max_per_loop (struct bulk_exec *exec, int max);
 
+/*  Launch each command with a single job-exec.tree-exec request that is
+ *   fanned out over the TBON, instead of one rexec per rank.  Exits,
+ *   failures, and output are reported in batches by rank set.
+ *   The job-exec module must be loaded on all ranks.
+ */
+void bulk_exec_set_tree (struct bulk_exec *exec, bool tree);
+
+bool bulk_exec_is_tree (struct bulk_exec *exec);
+
+/*  In tree launch mode, reattach to shells started by a previous
+ *   instance of the job-exec module instead of launching new ones.
+ *   Fails with ENOTSUP if tree launch mode is not set.
+ */
+int bulk_exec_set_reattach (struct bulk_exec *exec, bool reattach);
+
 void bulk_exec_destroy (struct bulk_exec *exec);
 
 int bulk_exec_push_cmd (struct bulk_exec *exec,
@@ -97,9 +118,19 @@ int bulk_exec_total (struct bulk_exec *exec);
 /* Get subprocess remote exec service name (never returns NULL) */
 const char *bulk_exec_service_name (struct bulk_exec *exec);
 
-/*  Get the subprocess handle for a rank
+/*  Get the subprocess handle for a rank.  Fails with ENOENT in tree
+ *   launch mode.
  */
 flux_subprocess_t *bulk_exec_get_subprocess (struct bulk_exec *exec,
                                              int rank);
 
+/*  Get the command run on a rank, or NULL if none.
+ */
+const flux_cmd_t *bulk_exec_get_cmd (struct bulk_exec *exec, int rank);
+
+/*  Return the signal that terminated the process on rank, or -1 if
+ *   it did not exit due to a signal or has not exited.
+ */
+int bulk_exec_signaled (struct bulk_exec *exec, int rank);
+
 #endif /* !HAVE_JOB_EXEC_BULK_EXEC_H */
@@ -22,7 +22,9 @@
  * OPERATION
  *
  * Get the KVS rootrefs for all running jobs and commit to
- * "job-exec.kvs-namespaces".
+ * "job-exec.kvs-namespaces", along with any state the job's exec
+ * implementation provides for reattaching to it (see the checkpoint
+ * method in job-exec.h).
  *
  */
 
@@ -52,13 +54,17 @@ flux_future_t *checkpoint_get_rootrefs (flux_t *h)
                             "job-exec.kvs-namespaces");
 }
 
-char *checkpoint_find_rootref (flux_future_t *f,
-                               flux_jobid_t id,
-                               uint32_t owner)
+/*  Find the checkpoint entry for job 'id' and decode it as {kvsroot, exec}.
+ */
+static int find_entry (flux_future_t *f,
+                       flux_jobid_t id,
+                       uint32_t owner,
+                       char **rootrefp,
+                       json_t **execp)
 {
     int saved_errno;
     flux_t *h = flux_future_get_flux (f);
-    char *rv = NULL;
+    int rv = -1;
     const char *rootrefs;
     json_error_t error;
     json_t *o = NULL;
@@ -79,18 +85,25 @@ char *checkpoint_find_rootref (flux_future_t *f,
         flux_jobid_t l_id;
         uint32_t l_owner;
         const char *rootref;
+        json_t *exec = NULL;
 
-        if (json_unpack (value,
-                         "{s:I s:i s:s}",
-                         "id", &l_id,
-                         "owner", &l_owner,
-                         "kvsroot", &rootref) < 0) {
+        if (json_unpack_ex (value,
+                            &error,
+                            0,
+                            "{s:I s:i s:s s?o}",
+                            "id", &l_id,
+                            "owner", &l_owner,
+                            "kvsroot", &rootref,
+                            "exec", &exec) < 0) {
             flux_log (h, LOG_ERR, "json_unpack rootref: %s", error.text);
             goto cleanup;
         }
         if (l_id == id && l_owner == owner) {
-            if (!(rv = strdup (rootref)))
+            if (rootrefp && !(*rootrefp = strdup (rootref)))
                 goto cleanup;
+            if (execp)
+                *execp = json_incref (exec);
+            rv = 0;
             break;
         }
     }
@@ -102,6 +115,24 @@ cleanup:
     return rv;
 }
 
+char *checkpoint_find_rootref (flux_future_t *f,
+                               flux_jobid_t id,
+                               uint32_t owner)
+{
+    char *rootref = NULL;
+    (void)find_entry (f, id, owner, &rootref, NULL);
+    return rootref;
+}
+
+json_t *checkpoint_find_exec_state (flux_future_t *f,
+                                    flux_jobid_t id,
+                                    uint32_t owner)
+{
+    json_t *exec = NULL;
+    (void)find_entry (f, id, owner, NULL, &exec);
+    return exec;
+}
+
 static int lookup_nsroots (flux_t *h, zhashx_t *jobs, flux_future_t **fp)
 {
     struct jobinfo *job = zhashx_first (jobs);
@@ -165,6 +196,18 @@ static json_t *get_nsroots (flux_t *h, flux_future_t *fall)
             errno = ENOMEM;
             goto cleanup;
         }
+        if (job->impl && job->impl->checkpoint) {
+            json_t *state = NULL;
+            if ((*job->impl->checkpoint) (job, &state) < 0)
+                flux_log_error (h, "checkpoint exec state");
+            else if (state
+                     && json_object_set_new (o, "exec", state) < 0) {
+                json_decref (state);
+                json_decref (o);
+                errno = ENOMEM;
+                goto cleanup;
+            }
+        }
         if (json_array_append (nsdata, o) < 0) {
             json_decref (o);
             errno = ENOMEM;
@@ -22,6 +22,13 @@ char *checkpoint_find_rootref (flux_future_t *f,
                                flux_jobid_t id,
                                uint32_t owner);
 
+/*  Return the exec implementation state saved for job 'id', or NULL if
+ *  there is none.  The caller must json_decref() the result.
+ */
+json_t *checkpoint_find_exec_state (flux_future_t *f,
+                                    flux_jobid_t id,
+                                    uint32_t owner);
+
 void checkpoint_running (flux_t *h, zhashx_t *jobs);
 
 #endif /* !HAVE_JOB_EXEC_CHECKPOINT_EXEC_H */
@@ -92,7 +92,10 @@ static const char * exec_mock_exception (struct bulk_exec *exec)
 static void start_cb (struct bulk_exec *exec, void *arg)
 {
     struct jobinfo *job = arg;
-    jobinfo_started (job);
+    if (job->reattach)
+        jobinfo_reattached (job);
+    else
+        jobinfo_started (job);
 }
 
 static void complete_cb (struct bulk_exec *exec, void *arg)
@@ -130,13 +133,14 @@ static int exec_barrier_enter (struct bulk_exec *exec)
 
 static void output_cb (struct bulk_exec *exec,
                        flux_subprocess_t *p,
+                       int rank,
                        const char *stream,
                        const char *data,
                        int len,
                        void *arg)
 {
     struct jobinfo *job = arg;
-    const char *cmd = flux_cmd_arg (flux_subprocess_get_cmd (p), 0);
+    const char *cmd = flux_cmd_arg (bulk_exec_get_cmd (exec, rank), 0);
 
     if (streq (stream, "stdout")) {
         if (streq (data, "enter\n")
@@ -148,8 +152,8 @@ static void output_cb (struct bulk_exec *exec,
         return;
     }
     jobinfo_log_output (job,
-                        flux_subprocess_rank (p),
-                        basename (cmd),
+                        rank,
+                        cmd ? basename (cmd) : "unknown",
                         stream,
                         data,
                         len);
@@ -223,12 +227,14 @@ static bool is_critical_rank (struct jobinfo *job, int shell_rank)
     return idset_test (job->critical_ranks, shell_rank);
 }
 
-static void error_cb (struct bulk_exec *exec, flux_subprocess_t *p, void *arg)
+static void error_cb (struct bulk_exec *exec,
+                      flux_subprocess_t *p,
+                      int rank,
+                      int errnum,
+                      void *arg)
 {
     struct jobinfo *job = arg;
-    flux_cmd_t *cmd = flux_subprocess_get_cmd (p);
-    int errnum = flux_subprocess_fail_errno (p);
-    int rank = flux_subprocess_rank (p);
+    const flux_cmd_t *cmd = bulk_exec_get_cmd (exec, rank);
     int shell_rank = resource_set_rank_index (job->R, rank);
     const char *hostname = flux_get_hostbyrank (job->h, rank);
 
@@ -280,7 +286,7 @@ static void error_cb (struct bulk_exec *exec, flux_subprocess_t *p, void *arg)
     }
     else
         jobinfo_fatal_error (job,
-                             flux_subprocess_fail_errno (p),
+                             errnum,
                              "job shell exec error on %s (rank %d)",
                              hostname,
                              rank);
@@ -341,10 +347,9 @@ static void exit_cb (struct bulk_exec *exec,
      */
     unsigned int rank = idset_first (ranks);
     while (rank != IDSET_INVALID_ID) {
-        flux_subprocess_t *p = bulk_exec_get_subprocess (exec, rank);
-        int signo = flux_subprocess_signaled (p);
+        int signo = bulk_exec_signaled (exec, rank);
         int shell_rank = resource_set_rank_index (job->R, rank);
-        if (p && signo > 0) {
+        if (signo > 0) {
             if (shell_rank != 0)
                 lost_shell (job,
                             is_critical_rank (job, shell_rank),
@@ -418,6 +423,38 @@ static struct bulk_exec_ops exec_ops = {
     .on_error =     error_cb
 };
 
+/*  Restore state saved by exec_checkpoint() and reattach to the job's
+ *   shells.  Only jobs launched in tree mode can be reattached, since
+ *   shells started directly with rexec are terminated when job-exec is
+ *   unloaded.  Otherwise, the shells are started again as before.
+ */
+static int exec_reattach_init (struct jobinfo *job,
+                               struct bulk_exec *exec,
+                               struct exec_ctx *ctx)
+{
+    int tree = 0;
+
+    if (!job->exec_state
+        || json_unpack (job->exec_state,
+                        "{s:b s:i s:i}",
+                        "tree", &tree,
+                        "barriers", &ctx->barrier_completion_count,
+                        "exits", &ctx->exit_count) < 0
+        || !tree) {
+        flux_log (job->h,
+                  LOG_INFO,
+                  "%s: no tree launch to reattach, restarting shells",
+                  idf58 (job->id));
+        return 0;
+    }
+    bulk_exec_set_tree (exec, true);
+    if (bulk_exec_set_reattach (exec, true) < 0) {
+        flux_log_error (job->h, "exec_init: bulk_exec_set_reattach");
+        return -1;
+    }
+    return 0;
+}
+
 static int exec_init (struct jobinfo *job)
 {
     flux_cmd_t *cmd = NULL;
@@ -450,6 +487,7 @@ static int exec_init (struct jobinfo *job)
         flux_log_error (job->h, "exec_init: bulk_exec_create");
         goto err;
     }
+    bulk_exec_set_tree (exec, config_get_tree_launch ());
     if (!(ctx = exec_ctx_create (job->jobspec))) {
         flux_log_error (job->h, "exec_init: exec_ctx_create");
         goto err;
@@ -460,6 +498,8 @@ static int exec_init (struct jobinfo *job)
         flux_log_error (job->h, "exec_init: bulk_exec_aux_set");
         goto err;
     }
+    if (job->reattach && exec_reattach_init (job, exec, ctx) < 0)
+        goto err;
     if (!(cmd = flux_cmd_create (0, NULL, environ))) {
         flux_log_error (job->h, "exec_init: flux_cmd_create");
         goto err;
@@ -609,6 +649,27 @@ static void exec_exit (struct jobinfo *job)
     job->data = NULL;
 }
 
+static int exec_checkpoint (struct jobinfo *job, json_t **state)
+{
+    struct bulk_exec *exec = job->data;
+    struct exec_ctx *ctx;
+    json_t *o;
+
+    if (!exec || !(ctx = bulk_exec_aux_get (exec, "ctx"))) {
+        *state = NULL;
+        return 0;
+    }
+    if (!(o = json_pack ("{s:b s:i s:i}",
+                         "tree", bulk_exec_is_tree (exec),
+                         "barriers", ctx->barrier_completion_count,
+                         "exits", ctx->exit_count))) {
+        errno = ENOMEM;
+        return -1;
+    }
+    *state = o;
+    return 0;
+}
+
 static int exec_config (flux_t *h,
                         const flux_conf_t *conf,
                         int argc,
@@ -652,6 +713,7 @@ struct exec_implementation bulkexec = {
     .kill =     exec_kill,
     .cancel =   exec_cancel,
     .stats =    exec_stats,
+    .checkpoint = exec_checkpoint,
 };
 
 /* vi: ts=4 sw=4 expandtab
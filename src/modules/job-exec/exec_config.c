@@ -34,6 +34,7 @@ struct exec_config {
     const char *exec_service;
     int exec_service_override;
     json_t *sdexec_properties;
+    int tree_launch;
 };
 
 /* Global configs initialized in config_init() */
@@ -104,6 +105,11 @@ json_t *config_get_sdexec_properties (void)
     return exec_conf.sdexec_properties;
 }
 
+bool config_get_tree_launch (void)
+{
+    return exec_conf.tree_launch;
+}
+
 static int config_add_stats_string (json_t *o,
                                     const char *key,
                                     const char *value)
@@ -167,7 +173,10 @@ int config_get_stats (json_t **config_stats)
 
     if (config_add_stats_int (o,
                               "exec_service_override",
-                              exec_conf.exec_service_override) < 0)
+                              exec_conf.exec_service_override) < 0
+        || config_add_stats_int (o,
+                                 "tree_launch",
+                                 exec_conf.tree_launch) < 0)
         goto error;
 
     if (exec_conf.sdexec_properties) {
@@ -192,6 +201,7 @@ static void exec_config_init (struct exec_config *ec)
     ec->exec_service = "rexec";
     ec->exec_service_override = 0;
     ec->sdexec_properties = NULL;
+    ec->tree_launch = 0;
 }
 
 /*  Initialize configurations for use by job-exec bulk-exec
@@ -254,6 +264,18 @@ int config_setup (flux_t *h,
         return -1;
     }
 
+    /*  Check configuration for exec.tree-launch */
+    if (flux_conf_unpack (conf,
+                          &err,
+                          "{s?{s?b}}",
+                          "exec",
+                            "tree-launch", &tmpconf.tree_launch) < 0) {
+        errprintf (errp,
+                   "error reading config value exec.tree-launch: %s",
+                   err.text);
+        return -1;
+    }
+
     /*  Check configuration for exec.sdexec-properties */
     if (flux_conf_unpack (conf,
                           &err,
@@ -295,6 +317,8 @@ int config_setup (flux_t *h,
                 tmpconf.flux_imp_path = argv[i]+4;
             else if (strstarts (argv[i], "service="))
                 tmpconf.exec_service = argv[i]+8;
+            else if (streq (argv[i], "tree-launch"))
+                tmpconf.tree_launch = 1;
         }
     }
 
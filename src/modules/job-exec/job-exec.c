@@ -56,8 +56,8 @@
  * the following tasks:
  *
  *  - terminating "done" event is posted to the exec.eventlog
- *  - the guest namespace, now quiesced, is copied to the primary namespace
- *  - the guest namespace is removed
+ *  - the guest namespace, now quiesced, is linked into the primary
+ *    namespace by its root reference, and removed
  *  - the final "release final=true" response is sent to the job manager
  *  - the local job object is destroyed
  *
@@ -105,6 +105,7 @@
 #include "job-exec.h"
 #include "checkpoint.h"
 #include "exec_config.h"
+#include "tree-exec.h"
 
 static double kill_timeout=5.0;
 
@@ -150,6 +151,7 @@ void jobinfo_decref (struct jobinfo *job)
         resource_set_destroy (job->R);
         json_decref (job->jobspec);
         free (job->rootref);
+        json_decref (job->exec_state);
         free (job);
         errno = saved_errno;
     }
@@ -686,25 +688,64 @@ static void namespace_delete (flux_future_t *f, void *arg)
     flux_future_destroy (f);
 }
 
-static void namespace_copy (flux_future_t *f, void *arg)
+static void namespace_getroot (flux_future_t *f, void *arg)
 {
     struct jobinfo *job = arg;
     flux_t *h = job->ctx->h;
-    flux_future_t *fnext = NULL;
+    flux_future_t *fnext = flux_kvs_getroot (h, job->ns, 0);
+    if (!fnext)
+        flux_future_continue_error (f, errno, NULL);
+    else
+        flux_future_continue (f, fnext);
+    flux_future_destroy (f);
+}
+
+/*  Graft the guest namespace root into the primary namespace by linking
+ *   its root directory reference at the job's "guest" key, so nothing is
+ *   copied.  The blobs it refers to stay in the content store after the
+ *   guest namespace is gone, so the namespace is removed concurrently
+ *   with the primary namespace commit, saving a round trip.
+ */
+static void namespace_graft (flux_future_t *f, void *arg)
+{
+    struct jobinfo *job = arg;
+    flux_t *h = job->ctx->h;
+    flux_kvs_txn_t *txn = NULL;
+    flux_future_t *fall = NULL;
+    flux_future_t *fnext;
+    const char *treeobj;
     char dst [256];
 
-    if (flux_job_kvs_key (dst, sizeof (dst), job->id, "guest") < 0) {
-        flux_log_error (h, "namespace_move: flux_job_kvs_key");
-        goto done;
+    if (flux_kvs_getroot_get_treeobj (f, &treeobj) < 0
+        || flux_job_kvs_key (dst, sizeof (dst), job->id, "guest") < 0
+        || !(txn = flux_kvs_txn_create ())
+        || flux_kvs_txn_put_treeobj (txn, 0, dst, treeobj) < 0
+        || !(fall = flux_future_wait_all_create ())) {
+        flux_log_error (h, "namespace_move: %s", idf58 (job->id));
+        goto error;
     }
-    if (!(fnext = flux_kvs_copy (h, job->ns, ".", NULL, dst, 0)))
-        flux_log_error (h, "namespace_move: flux_kvs_copy");
-done:
-    if (fnext)
-        flux_future_continue (f, fnext);
-    else
-        flux_future_continue_error (f, errno, NULL);
+    flux_future_set_flux (fall, h);
+    if (!(fnext = flux_kvs_commit (h, NULL, 0, txn))
+        || flux_future_push (fall, "graft", fnext) < 0) {
+        flux_log_error (h, "namespace_move: flux_kvs_commit");
+        flux_future_destroy (fnext);
+        goto error;
+    }
+    if (!(fnext = flux_kvs_namespace_remove (h, job->ns))
+        || flux_future_push (fall, "remove", fnext) < 0) {
+        flux_log_error (h, "namespace_move: flux_kvs_namespace_remove");
+        flux_future_destroy (fnext);
+        goto error;
+    }
+    flux_future_continue (f, fall);
     flux_future_destroy (f);
+    flux_kvs_txn_destroy (txn);
+    return;
+error:
+    flux_future_destroy (fall);
+    flux_kvs_txn_destroy (txn);
+    /* Don't leave the guest namespace behind */
+    namespace_delete (f, job);
 }
 
 /*  Move the guest namespace for `job` into the primary namespace first
@@ -712,8 +753,9 @@ done:
  *
  *  The process is split into a chained future of 3 parts:
  *   1. Issue the final write into the exec.eventlog
- *   2. Copy the namespace into the primary
- *   3. Delete the guest namespace
+ *   2. Get the root reference of the guest namespace
+ *   3. Link the root into the primary namespace and remove the
+ *      guest namespace, concurrently
  */
 static flux_future_t * namespace_move (struct jobinfo *job)
 {
@@ -734,9 +776,9 @@ static flux_future_t * namespace_move (struct jobinfo *job)
         flux_log_error (h, "namespace_move: jobinfo_emit_event");
         goto error;
     }
-    if (!(f1 = flux_future_and_then (f, namespace_copy, job))
-        || !(f1 = flux_future_or_then (f, namespace_copy, job))
-        || !(f2 = flux_future_and_then (f1, namespace_delete, job))
+    if (!(f1 = flux_future_and_then (f, namespace_getroot, job))
+        || !(f1 = flux_future_or_then (f, namespace_getroot, job))
+        || !(f2 = flux_future_and_then (f1, namespace_graft, job))
         || !(f2 = flux_future_or_then (f1, namespace_delete, job))) {
         flux_log_error (h, "namespace_move: flux_future_and_then");
         goto error;
@@ -994,6 +1036,9 @@ static void get_rootref_cb (flux_future_t *fprev, void *arg)
                   LOG_DEBUG,
                   "checkpoint rootref not found: %s",
                   idf58 (job->id));
+    job->exec_state = checkpoint_find_exec_state (fprev,
+                                                  job->id,
+                                                  job->userid);
 
     /* if rootref not found, still create namespace */
     if (!(f = ns_create_and_link (h, job, 0)))
@@ -1540,12 +1585,39 @@ static const struct flux_msg_handler_spec htab[]  = {
     FLUX_MSGHANDLER_TABLE_END
 };
 
+/*  On ranks other than 0, job-exec only provides the tree-exec service
+ *  used to launch job shells over the TBON.  See tree-exec.h.
+ */
+static int mod_main_tree_exec (flux_t *h)
+{
+    struct tree_exec_server *srv;
+    int rc;
+
+    if (!(srv = tree_exec_server_create (h))) {
+        flux_log_error (h, "job-exec: error creating tree-exec service");
+        return -1;
+    }
+    rc = flux_reactor_run (flux_get_reactor (h), 0);
+    tree_exec_server_destroy (srv);
+    return rc;
+}
+
 int mod_main (flux_t *h, int argc, char **argv)
 {
     int saved_errno = 0;
     int rc = -1;
-    struct job_exec_ctx *ctx = job_exec_ctx_create (h, argc, argv);
+    uint32_t rank;
+    struct job_exec_ctx *ctx;
+    struct tree_exec_server *srv = NULL;
 
+    if (flux_get_rank (h, &rank) < 0) {
+        flux_log_error (h, "flux_get_rank");
+        return -1;
+    }
+    if (rank > 0)
+        return mod_main_tree_exec (h);
+
+    ctx = job_exec_ctx_create (h, argc, argv);
     if (job_exec_initialize (h, argc, argv) < 0
         || configure_implementations (h, argc, argv) < 0) {
         flux_log_error (h, "job-exec: module initialization failed");
@@ -1559,12 +1631,17 @@ int mod_main (flux_t *h, int argc, char **argv)
         flux_log_error (h, "flux_event_subscribe");
         goto out;
     }
+    if (!(srv = tree_exec_server_create (h))) {
+        flux_log_error (h, "job-exec: error creating tree-exec service");
+        goto out;
+    }
     if (exec_hello (h, "job-exec") < 0)
         goto out;
 
     rc = flux_reactor_run (flux_get_reactor (h), 0);
 out:
     unload_implementations (ctx);
+    tree_exec_server_destroy (srv);
 
     saved_errno = errno;
     if (flux_event_unsubscribe (h, "job-exception") < 0)
@@ -47,6 +47,10 @@ struct jobinfo;
  *
  *   - stats:   (optional) get json object of exec implementation stats
  *
+ *   - checkpoint: (optional) get json object of job state to save when
+ *              job-exec is unloaded.  It is restored to job->exec_state
+ *              when the job is reattached.
+ *
  */
 struct exec_implementation {
     const char *name;
@@ -62,6 +66,7 @@ struct exec_implementation {
     int  (*kill)    (struct jobinfo *job, int signum);
     int  (*cancel)  (struct jobinfo *job);
     int  (*stats)   (json_t **stats);
+    int  (*checkpoint) (struct jobinfo *job, json_t **state);
 };
 
 /*  Exec job information */
@@ -70,6 +75,7 @@ struct jobinfo {
     flux_jobid_t          id;
     char                  ns [64];   /* namespace string */
     char                * rootref;   /* ns rootref if restart */
+    json_t              * exec_state; /* impl checkpoint if restart */
     const flux_msg_t *    req;       /* initial request */
     uint32_t              userid;    /* requesting userid */
     int                   flags;     /* job flags */
@@ -0,0 +1,580 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* tree-exec.c - per-broker service for hierarchical job shell launch
+ *
+ * See tree-exec.h for the protocol.  One tree_launch object exists on
+ * each broker in the path of a launch.  It holds the local subprocess and
+ * a fanout (see libsubprocess/fanout.h), which forwards the launch to the
+ * children and batches state changes from them and the local subprocess
+ * into one response upstream, as for the subprocess server's bulk-exec.
+ *
+ * If the upstream job-exec goes away (e.g. the module is reloaded on
+ * rank 0), the launch is orphaned rather than destroyed, so that shells
+ * keep running and their exit status is retained until a
+ * job-exec.tree-reattach request rebinds the launch to a new upstream.
+ */
+
+#if HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <signal.h>
+#include <jansson.h>
+#include <flux/core.h>
+#include <flux/idset.h>
+
+#include "src/common/libczmqcontainers/czmq_containers.h"
+#include "src/common/libsubprocess/command_private.h"
+#include "src/common/libsubprocess/fanout.h"
+#include "src/common/libjob/idf58.h"
+#include "ccan/str/str.h"
+
+#include "tree-exec.h"
+
+extern char **environ;
+
+struct tree_exec_server {
+    flux_t *h;
+    uint32_t rank;
+    zlistx_t *children;         // see fanout_children_create()
+    zhashx_t *launches;         // struct tree_launch by "id.name"
+    flux_msg_handler_t **handlers;
+};
+
+struct tree_launch {
+    struct tree_exec_server *srv;
+    char *key;
+    flux_jobid_t id;
+    char *name;
+    struct fanout *fo;
+    flux_subprocess_t *p;       // local process, if any
+    bool local_done;
+};
+
+static int server_get_children (struct tree_exec_server *srv)
+{
+    flux_future_t *f;
+    json_t *topo;
+
+    if (!(f = flux_rpc_pack (srv->h,
+                             "overlay.topology",
+                             FLUX_NODEID_ANY,
+                             0,
+                             "{s:i}",
+                             "rank", srv->rank))
+        || flux_rpc_get_unpack (f, "o", &topo) < 0
+        || !(srv->children = fanout_children_create (topo))) {
+        flux_future_destroy (f);
+        return -1;
+    }
+    flux_future_destroy (f);
+    return 0;
+}
+
+static void tree_launch_destroy (struct tree_launch *l)
+{
+    if (l) {
+        int saved_errno = errno;
+        fanout_destroy (l->fo);
+        flux_subprocess_destroy (l->p);
+        free (l->name);
+        free (l->key);
+        free (l);
+        errno = saved_errno;
+    }
+}
+
+static void tree_launch_destructor (void **item)
+{
+    if (item) {
+        tree_launch_destroy (*item);
+        *item = NULL;
+    }
+}
+
+/* Called from the fanout timer once all ranks are done.
+ */
+static void tree_launch_done (struct fanout *fo, void *arg)
+{
+    struct tree_launch *l = arg;
+
+    zhashx_delete (l->srv->launches, l->key);
+}
+
+static void local_state_cb (flux_subprocess_t *p,
+                            flux_subprocess_state_t state)
+{
+    struct tree_launch *l = flux_subprocess_aux_get (p, "tree_launch");
+
+    if (state == FLUX_SUBPROCESS_RUNNING)
+        fanout_started (l->fo, l->srv->rank);
+    else if (state == FLUX_SUBPROCESS_FAILED) {
+        l->local_done = true;
+        fanout_failed (l->fo, l->srv->rank, flux_subprocess_fail_errno (p));
+    }
+}
+
+static void local_completion_cb (flux_subprocess_t *p)
+{
+    struct tree_launch *l = flux_subprocess_aux_get (p, "tree_launch");
+
+    l->local_done = true;
+    fanout_exited (l->fo, l->srv->rank, flux_subprocess_status (p));
+}
+
+static void local_output_cb (flux_subprocess_t *p, const char *stream)
+{
+    struct tree_launch *l = flux_subprocess_aux_get (p, "tree_launch");
+    const char *s;
+    int len;
+
+    if (!(s = flux_subprocess_getline (p, stream, &len))) {
+        flux_log_error (l->srv->h, "flux_subprocess_getline");
+        return;
+    }
+    if (len > 0)
+        fanout_output (l->fo, l->srv->rank, stream, s, len);
+}
+
+static int local_start (struct tree_launch *l,
+                        const char *service,
+                        int flags,
+                        flux_cmd_t *cmd)
+{
+    flux_subprocess_ops_t ops = {
+        .on_completion = local_completion_cb,
+        .on_state_change = local_state_cb,
+        .on_channel_out = local_output_cb,
+        .on_stdout = local_output_cb,
+        .on_stderr = local_output_cb,
+    };
+    flux_t *h = l->srv->h;
+
+    /* See exec_start_cmd() in bulk-exec.c.
+     */
+    if (streq (service, "sdexec")) {
+        char idbuf[21];
+        char name[128];
+        if (flux_job_id_encode (l->id, "f58plain", idbuf, sizeof (idbuf)) < 0)
+            return -1;
+        snprintf (name,
+                  sizeof (name),
+                  "%s-%lu-%s.service",
+                  l->name,
+                  (unsigned long)l->srv->rank,
+                  idbuf);
+        if (flux_cmd_setopt (cmd, "SDEXEC_NAME", name) < 0
+            || flux_cmd_setopt (cmd,
+                                "SDEXEC_PROP_Description",
+                                "User workload") < 0)
+            return -1;
+    }
+    if (!(l->p = flux_rexec_ex (h,
+                                service,
+                                l->srv->rank,
+                                flags,
+                                cmd,
+                                &ops,
+                                flux_llog,
+                                h)))
+        return -1;
+    if (flux_subprocess_aux_set (l->p, "tree_launch", l, NULL) < 0)
+        return -1;
+    return 0;
+}
+
+static struct tree_launch *tree_launch_create (struct tree_exec_server *srv,
+                                               const flux_msg_t *msg,
+                                               flux_jobid_t id,
+                                               const char *name,
+                                               const char *ranks)
+{
+    struct tree_launch *l;
+    char prefix[128];
+
+    if (!(l = calloc (1, sizeof (*l))))
+        return NULL;
+    l->srv = srv;
+    l->id = id;
+    if (asprintf (&l->key, "%s.%s", idf58 (id), name) < 0
+        || !(l->name = strdup (name)))
+        goto error;
+    snprintf (prefix, sizeof (prefix), "%s: tree-exec", l->key);
+    if (!(l->fo = fanout_create (srv->h,
+                                 msg,
+                                 ranks,
+                                 FANOUT_HISTORY,
+                                 prefix,
+                                 tree_launch_done,
+                                 l)))
+        goto error;
+    return l;
+error:
+    tree_launch_destroy (l);
+    errno = ENOMEM;
+    return NULL;
+}
+
+static void tree_exec_cb (flux_t *h,
+                          flux_msg_handler_t *mh,
+                          const flux_msg_t *msg,
+                          void *arg)
+{
+    struct tree_exec_server *srv = arg;
+    json_t *request;
+    flux_jobid_t id;
+    const char *name;
+    const char *service;
+    int flags;
+    const char *ranks;
+    json_t *cmd_o;
+    flux_cmd_t *cmd = NULL;
+    struct tree_launch *l = NULL;
+    const char *errmsg = NULL;
+
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s:I s:s s:s s:i s:s s:o}",
+                             "id", &id,
+                             "name", &name,
+                             "service", &service,
+                             "flags", &flags,
+                             "ranks", &ranks,
+                             "cmd", &cmd_o) < 0
+        || flux_msg_unpack (msg, "o", &request) < 0)
+        goto error;
+    if (!flux_msg_is_streaming (msg)) {
+        errno = EPROTO;
+        goto error;
+    }
+    if (!(cmd = cmd_fromjson (cmd_o, NULL))) {
+        errmsg = "error decoding command";
+        errno = EPROTO;
+        goto error;
+    }
+    if (!(l = tree_launch_create (srv, msg, id, name, ranks)))
+        goto error;
+    if (!fanout_children_cover (srv->children,
+                                srv->rank,
+                                fanout_pending (l->fo))) {
+        errmsg = "ranks are not in the subtree of this broker";
+        errno = EINVAL;
+        goto error;
+    }
+    if (zhashx_insert (srv->launches, l->key, l) < 0) {
+        errno = EEXIST;
+        goto error;
+    }
+    fanout_forward (l->fo, srv->children, "job-exec.tree-exec", request);
+    if (idset_test (fanout_pending (l->fo), srv->rank)) {
+        if (local_start (l, service, flags, cmd) < 0) {
+            int errnum = errno;
+            flux_subprocess_destroy (l->p);
+            l->p = NULL;
+            l->local_done = true;
+            fanout_failed (l->fo, srv->rank, errnum);
+        }
+    }
+    flux_cmd_destroy (cmd);
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, errmsg) < 0)
+        flux_log_error (h, "error responding to tree-exec request");
+    if (l && zhashx_lookup (srv->launches, l->key) != l)
+        tree_launch_destroy (l);
+    flux_cmd_destroy (cmd);
+}
+
+static struct tree_launch *lookup_launch (struct tree_exec_server *srv,
+                                          const flux_msg_t *msg)
+{
+    flux_jobid_t id;
+    const char *name;
+    char *key;
+    struct tree_launch *l;
+
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s:I s:s}",
+                             "id", &id,
+                             "name", &name) < 0)
+        return NULL;
+    if (asprintf (&key, "%s.%s", idf58 (id), name) < 0)
+        return NULL;
+    if (!(l = zhashx_lookup (srv->launches, key)))
+        errno = ENOENT;
+    free (key);
+    return l;
+}
+
+/* Rebind an existing launch to a new upstream, or if there is none on
+ * this broker (e.g. it was lost when job-exec was reloaded here), create
+ * an empty one that forwards the reattach request to the children and
+ * reports the local shell as lost.
+ */
+static void tree_reattach_cb (flux_t *h,
+                              flux_msg_handler_t *mh,
+                              const flux_msg_t *msg,
+                              void *arg)
+{
+    struct tree_exec_server *srv = arg;
+    json_t *request;
+    flux_jobid_t id;
+    const char *name;
+    const char *ranks;
+    struct tree_launch *l = NULL;
+    const char *errmsg = NULL;
+
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s:I s:s s:s}",
+                             "id", &id,
+                             "name", &name,
+                             "ranks", &ranks) < 0
+        || flux_msg_unpack (msg, "o", &request) < 0)
+        goto error;
+    if (!flux_msg_is_streaming (msg)) {
+        errno = EPROTO;
+        goto error;
+    }
+    if ((l = lookup_launch (srv, msg))) {
+        if (fanout_reattach (l->fo, msg) < 0)
+            flux_log_error (h, "%s: tree-exec: error replaying state", l->key);
+        return;
+    }
+    if (!(l = tree_launch_create (srv, msg, id, name, ranks)))
+        goto error;
+    if (!fanout_children_cover (srv->children,
+                                srv->rank,
+                                fanout_pending (l->fo))) {
+        errmsg = "ranks are not in the subtree of this broker";
+        errno = EINVAL;
+        goto error;
+    }
+    if (zhashx_insert (srv->launches, l->key, l) < 0) {
+        errno = EEXIST;
+        goto error;
+    }
+    fanout_forward (l->fo, srv->children, "job-exec.tree-reattach", request);
+    if (idset_test (fanout_pending (l->fo), srv->rank)) {
+        l->local_done = true;
+        fanout_failed (l->fo, srv->rank, EHOSTUNREACH);
+    }
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, errmsg) < 0)
+        flux_log_error (h, "error responding to tree-reattach request");
+    if (l && zhashx_lookup (srv->launches, l->key) != l)
+        tree_launch_destroy (l);
+}
+
+/* When the upstream of a launch disconnects, orphan the launch so that
+ * it survives until reattached.
+ */
+static void disconnect_cb (flux_t *h,
+                           flux_msg_handler_t *mh,
+                           const flux_msg_t *msg,
+                           void *arg)
+{
+    struct tree_exec_server *srv = arg;
+    struct tree_launch *l;
+
+    l = zhashx_first (srv->launches);
+    while (l) {
+        if (flux_disconnect_match (msg, fanout_get_msg (l->fo)))
+            fanout_suspend (l->fo);
+        l = zhashx_next (srv->launches);
+    }
+}
+
+/* Forward a tree-write or tree-kill request unchanged to the children
+ * that the launch was forwarded to.
+ */
+static void forward_control (struct tree_launch *l, const flux_msg_t *msg)
+{
+    flux_t *h = l->srv->h;
+    const char *topic;
+    json_t *o;
+
+    if (flux_msg_get_topic (msg, &topic) < 0
+        || flux_msg_unpack (msg, "o", &o) < 0) {
+        flux_log_error (h, "%s: tree-exec: error decoding request", l->key);
+        return;
+    }
+    fanout_forward_control (l->fo, topic, o);
+}
+
+static void tree_write_cb (flux_t *h,
+                           flux_msg_handler_t *mh,
+                           const flux_msg_t *msg,
+                           void *arg)
+{
+    struct tree_exec_server *srv = arg;
+    struct tree_launch *l;
+    const char *stream;
+    const char *data = NULL;
+    int eof = 0;
+
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s:s s?s s?b}",
+                             "stream", &stream,
+                             "data", &data,
+                             "eof", &eof) < 0
+        || !(l = lookup_launch (srv, msg)))
+        return;
+    forward_control (l, msg);
+    if (l->p && !l->local_done) {
+        if (data && flux_subprocess_write (l->p,
+                                           stream,
+                                           data,
+                                           strlen (data)) < 0)
+            flux_log_error (h, "%s: tree-exec: write %s", l->key, stream);
+        if (eof && flux_subprocess_close (l->p, stream) < 0)
+            flux_log_error (h, "%s: tree-exec: close %s", l->key, stream);
+    }
+}
+
+static void kill_continuation (flux_future_t *f, void *arg)
+{
+    flux_t *h = flux_future_get_flux (f);
+    const char *key = arg;
+
+    if (flux_future_get (f, NULL) < 0 && errno != ESRCH)
+        flux_log (h,
+                  LOG_ERR,
+                  "%s: exec_kill: %s",
+                  key,
+                  future_strerror (f, errno));
+    flux_future_destroy (f);
+}
+
+/* Signal the local process with "flux-imp kill", for processes running
+ * as another user.  See bulk_exec_imp_kill().
+ */
+static flux_future_t *imp_kill (struct tree_launch *l,
+                                const char *imp_path,
+                                int signum)
+{
+    flux_t *h = l->srv->h;
+    flux_cmd_t *cmd;
+    flux_subprocess_t *p = NULL;
+    flux_future_t *f;
+
+    if (!(f = flux_future_create (NULL, NULL)))
+        return NULL;
+    flux_future_set_flux (f, h);
+    if (!(cmd = flux_cmd_create (0, NULL, environ))
+        || flux_cmd_argv_append (cmd, imp_path) < 0
+        || flux_cmd_argv_append (cmd, "kill") < 0
+        || flux_cmd_argv_appendf (cmd, "%d", signum) < 0
+        || flux_cmd_argv_appendf (cmd,
+                                  "%ld",
+                                  (long)flux_subprocess_pid (l->p)) < 0
+        || !(p = flux_rexec_ex (h, "rexec", l->srv->rank, 0, cmd,
+                                NULL, flux_llog, h))
+        || flux_future_aux_set (f,
+                                NULL,
+                                p,
+                                (flux_free_f)flux_subprocess_destroy) < 0) {
+        flux_subprocess_destroy (p);
+        flux_cmd_destroy (cmd);
+        flux_future_destroy (f);
+        return NULL;
+    }
+    flux_cmd_destroy (cmd);
+    flux_future_fulfill (f, NULL, NULL);
+    return f;
+}
+
+static void tree_kill_cb (flux_t *h,
+                          flux_msg_handler_t *mh,
+                          const flux_msg_t *msg,
+                          void *arg)
+{
+    struct tree_exec_server *srv = arg;
+    struct tree_launch *l;
+    int signum;
+    const char *imp = NULL;
+    flux_future_t *f;
+
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s:i s?s}",
+                             "signum", &signum,
+                             "imp", &imp) < 0
+        || !(l = lookup_launch (srv, msg)))
+        goto error;
+    forward_control (l, msg);
+    if (l->p && !l->local_done) {
+        if (imp)
+            f = imp_kill (l, imp, signum);
+        else
+            f = flux_subprocess_kill (l->p, signum);
+        if (!f || flux_future_then (f, 3., kill_continuation, l->key) < 0) {
+            flux_log_error (h, "%s: exec_kill", l->key);
+            flux_future_destroy (f);
+        }
+    }
+    if (flux_respond (h, msg, NULL) < 0)
+        flux_log_error (h, "error responding to tree-kill request");
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        flux_log_error (h, "error responding to tree-kill request");
+}
+
+static const struct flux_msg_handler_spec htab[] = {
+    { FLUX_MSGTYPE_REQUEST, "job-exec.tree-exec", tree_exec_cb, 0 },
+    { FLUX_MSGTYPE_REQUEST, "job-exec.tree-write", tree_write_cb, 0 },
+    { FLUX_MSGTYPE_REQUEST, "job-exec.tree-kill", tree_kill_cb, 0 },
+    { FLUX_MSGTYPE_REQUEST, "job-exec.tree-reattach", tree_reattach_cb, 0 },
+    { FLUX_MSGTYPE_REQUEST, "job-exec.disconnect", disconnect_cb, 0 },
+    FLUX_MSGHANDLER_TABLE_END
+};
+
+void tree_exec_server_destroy (struct tree_exec_server *srv)
+{
+    if (srv) {
+        int saved_errno = errno;
+        flux_msg_handler_delvec (srv->handlers);
+        zhashx_destroy (&srv->launches);
+        zlistx_destroy (&srv->children);
+        free (srv);
+        errno = saved_errno;
+    }
+}
+
+struct tree_exec_server *tree_exec_server_create (flux_t *h)
+{
+    struct tree_exec_server *srv;
+
+    if (!(srv = calloc (1, sizeof (*srv))))
+        return NULL;
+    srv->h = h;
+    if (flux_get_rank (h, &srv->rank) < 0)
+        goto error;
+    if (!(srv->launches = zhashx_new ())) {
+        errno = ENOMEM;
+        goto error;
+    }
+    zhashx_set_destructor (srv->launches, tree_launch_destructor);
+    if (server_get_children (srv) < 0
+        || flux_msg_handler_addvec (h, htab, srv, &srv->handlers) < 0)
+        goto error;
+    return srv;
+error:
+    tree_exec_server_destroy (srv);
+    return NULL;
+}
+
+/* vi: ts=4 sw=4 expandtab
+ */
@@ -0,0 +1,62 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* Hierarchical launch of one command on many ranks over the TBON.
+ *
+ * job-exec.tree-exec (streaming):
+ *   request  {id:I name:s service:s flags:i ranks:s cmd:o}
+ *   response {started?:s exited?:{status:ranks} failed?:{errnum:ranks}
+ *             output?:[[ranks,stream,data],...]}
+ *   ENODATA once every rank in 'ranks' has exited or failed.
+ *
+ * Each broker forwards the request to the children whose subtree
+ * contains ranks in 'ranks', starts the command locally with 'service'
+ * (rexec or sdexec) if its own rank is included, and merges the
+ * responses from its subtree with its own into batches sent upstream.
+ * All rank sets are RFC 22 idsets.  Exit statuses are wait(2) statuses.
+ * Identical output lines from several ranks may be merged into one entry.
+ * The batching is shared with the subprocess server's bulk-exec service
+ * (see libsubprocess/fanout.h).
+ *
+ * job-exec.tree-write (no response):
+ *   request  {id:I name:s stream:s data?:s eof?:b}
+ * job-exec.tree-kill:
+ *   request  {id:I name:s signum:i imp?:s}
+ *   response {}
+ *
+ * Both are forwarded down the tree the same way and act on the local
+ * process of the launch identified by 'id' and 'name'.  If 'imp' is set,
+ * the signal is delivered with "imp kill" instead of the exec service.
+ *
+ * job-exec.tree-reattach (streaming):
+ *   request  {id:I name:s ranks:s}
+ *   response as for job-exec.tree-exec
+ *
+ * Rebinds a launch whose upstream disconnected to the new requestor and
+ * replays all state changes since launch.  Brokers with no record of
+ * the launch forward the request to their children and report the local
+ * rank as failed with EHOSTUNREACH.
+ */
+
+#ifndef HAVE_JOB_EXEC_TREE_EXEC_H
+#define HAVE_JOB_EXEC_TREE_EXEC_H 1
+
+#include <flux/core.h>
+
+struct tree_exec_server;
+
+struct tree_exec_server *tree_exec_server_create (flux_t *h);
+
+void tree_exec_server_destroy (struct tree_exec_server *srv);
+
+#endif /* !HAVE_JOB_EXEC_TREE_EXEC_H */
+
+/* vi: ts=4 sw=4 expandtab
+ */
@@ -23,30 +23,31 @@
 #include "ccan/str/str.h"
 
 /* Parse the submit userid from the event log.
- * Assume "submit" is the first event.
+ * Assume "submit" is the first event, so only that entry is decoded.
  */
 static int eventlog_get_userid (struct info_ctx *ctx, const char *s,
                                 uint32_t *useridp)
 {
-    json_t *a = NULL;
     json_t *entry = NULL;
+    size_t offset = 0;
     const char *name = NULL;
     json_t *context = NULL;
     int userid;
     int rv = -1;
-
-    if (!(a = eventlog_decode (s))) {
-        flux_log_error (ctx->h, "%s: eventlog_decode", __FUNCTION__);
-        /* if eventlog improperly formatted, we'll consider this a
-         * protocol error */
-        if (errno == EINVAL)
+    int rc;
+
+    if ((rc = eventlog_decode_next (s, strlen (s), &offset, &entry)) <= 0) {
+        if (rc < 0) {
+            flux_log_error (ctx->h, "%s: eventlog_decode", __FUNCTION__);
+            /* if eventlog improperly formatted, we'll consider this a
+             * protocol error */
+            if (errno == EINVAL)
+                errno = EPROTO;
+        }
+        else
             errno = EPROTO;
         goto error;
     }
-    if (!(entry = json_array_get (a, 0))) {
-        errno = EPROTO;
-        goto error;
-    }
     if (eventlog_entry_parse (entry, NULL, &name, &context) < 0) {
         flux_log_error (ctx->h, "%s: eventlog_decode", __FUNCTION__);
         goto error;
@@ -63,7 +64,7 @@ static int eventlog_get_userid (struct info_ctx *ctx, const char *s,
     (*useridp) = userid;
     rv = 0;
 error:
-    json_decref (a);
+    json_decref (entry);
     return rv;
 }
 
@@ -118,6 +118,7 @@ struct guest_watch_ctx {
 
     /* data from guest namespace */
     int offset;
+    struct eventlog_filter filter;
 };
 
 static int get_main_eventlog (struct guest_watch_ctx *gw);
@@ -145,11 +146,13 @@ static void guest_watch_ctx_destroy (void *data)
     }
 }
 
-static struct guest_watch_ctx *guest_watch_ctx_create (struct info_ctx *ctx,
-                                                       const flux_msg_t *msg,
-                                                       flux_jobid_t id,
-                                                       const char *path,
-                                                       int flags)
+static struct guest_watch_ctx *guest_watch_ctx_create (
+    struct info_ctx *ctx,
+    const flux_msg_t *msg,
+    flux_jobid_t id,
+    const char *path,
+    int flags,
+    struct eventlog_filter *filter)
 {
     struct guest_watch_ctx *gw = calloc (1, sizeof (*gw));
 
@@ -163,6 +166,7 @@ static struct guest_watch_ctx *guest_watch_ctx_create (struct info_ctx *ctx,
         goto error;
     }
     gw->flags = flags;
+    gw->filter = *filter;
     gw->state = GUEST_WATCH_STATE_INIT;
 
     gw->msg = flux_msg_incref (msg);
@@ -549,11 +553,14 @@ static int guest_namespace_watch (struct guest_watch_ctx *gw)
 
     if (!(msg = cred_msg_pack (topic,
                                gw->cred,
-                               "{s:I s:b s:s s:i}",
+                               "{s:I s:b s:s s:i s:i s:i s:f}",
                                "id", gw->id,
                                "guest", true,
                                "path", gw->path,
-                               "flags", gw->flags)))
+                               "flags", gw->flags,
+                               "skip", gw->filter.skip,
+                               "tail", gw->filter.tail,
+                               "since", gw->filter.since)))
         goto error;
 
     if (!(gw->guest_namespace_watch_f = flux_rpc_message (gw->ctx->h,
@@ -642,6 +649,16 @@ static void guest_namespace_watch_continuation (flux_future_t *f, void *arg)
         goto error_cancel;
     }
 
+    /* With a filter, the watcher may have passed over some events,
+     * so it reports the offset of each event it sends.
+     */
+    if (eventlog_filter_active (&gw->filter)) {
+        json_int_t offset;
+        if (flux_rpc_get_unpack (f, "{s:I}", "offset", &offset) < 0)
+            goto error_cancel;
+        gw->offset = offset;
+        gw->filter.started = true;
+    }
     gw->offset += strlen (event);
     flux_future_reset (f);
     return;
@@ -756,8 +773,13 @@ static void main_namespace_lookup_continuation (flux_future_t *f, void *arg)
         goto cleanup;
     }
 
+    gw->offset += eventlog_filter_start (&gw->filter,
+                                         s + gw->offset,
+                                         strlen (s + gw->offset));
     input = s + gw->offset;
     while (get_next_eventlog_entry (&input, &tok, &toklen)) {
+        if (!eventlog_filter_match (&gw->filter, tok, toklen))
+            continue;
         if (flux_respond_pack (ctx->h, gw->msg,
                                "{s:s#}",
                                "event", tok, toklen) < 0) {
@@ -784,11 +806,12 @@ int guest_watch (struct info_ctx *ctx,
                  const flux_msg_t *msg,
                  flux_jobid_t id,
                  const char *path,
-                 int flags)
+                 int flags,
+                 struct eventlog_filter *filter)
 {
     struct guest_watch_ctx *gw = NULL;
 
-    if (!(gw = guest_watch_ctx_create (ctx, msg, id, path, flags)))
+    if (!(gw = guest_watch_ctx_create (ctx, msg, id, path, flags, filter)))
         goto error;
 
     if (get_main_eventlog (gw) < 0)
@@ -14,12 +14,14 @@
 #include <flux/core.h>
 
 #include "job-info.h"
+#include "util.h"
 
 int guest_watch (struct info_ctx *ctx,
                  const flux_msg_t *msg,
                  flux_jobid_t id,
                  const char *path,
-                 int flags);
+                 int flags,
+                 struct eventlog_filter *filter);
 
 /* Cancel all lookups that match msg.
  * match credentials & matchtag if cancel true
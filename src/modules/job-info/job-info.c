@@ -21,11 +21,13 @@
 #include "watch.h"
 #include "guest_watch.h"
 #include "update.h"
+#include "tail.h"
 
 static void disconnect_cb (flux_t *h, flux_msg_handler_t *mh,
                            const flux_msg_t *msg, void *arg)
 {
     struct info_ctx *ctx = arg;
+    lookup_batches_cancel (ctx, msg, false);
     watchers_cancel (ctx, msg, false);
     guest_watchers_cancel (ctx, msg, false);
     update_watchers_cancel (ctx, msg, false);
@@ -36,16 +38,30 @@ static void stats_cb (flux_t *h, flux_msg_handler_t *mh,
 {
     struct info_ctx *ctx = arg;
     int lookups = zlist_size (ctx->lookups);
-    int watchers = zlist_size (ctx->watchers);
+    int lookup_batches = zlist_size (ctx->lookup_batches);
+    int watchers = zlistx_size (ctx->watchers);
+    int watch_sources = zlistx_size (ctx->watch_sources);
     int guest_watchers = zlist_size (ctx->guest_watchers);
     int update_lookups = 0;     /* no longer supported */
     int update_watchers = update_watch_count (ctx);
-    if (flux_respond_pack (h, msg, "{s:i s:i s:i s:i s:i}",
+    struct lru_cache_stats owner_stats;
+
+    lru_cache_get_stats (ctx->owner_lru, &owner_stats);
+    if (flux_respond_pack (h, msg, "{s:i s:i s:i s:i s:i s:i s:i"
+                           " s:{s:i s:I s:I s:I}}",
                            "lookups", lookups,
+                           "lookup_batches", lookup_batches,
                            "watchers", watchers,
+                           "watch_sources", watch_sources,
                            "guest_watchers", guest_watchers,
                            "update_lookups", update_lookups,
-                           "update_watchers", update_watchers) < 0) {
+                           "update_watchers", update_watchers,
+                           "owner_cache",
+                             "size", lru_cache_size (ctx->owner_lru),
+                             "hits", (json_int_t)owner_stats.hits,
+                             "misses", (json_int_t)owner_stats.misses,
+                             "evictions",
+                             (json_int_t)owner_stats.evictions) < 0) {
         flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
         goto error;
     }
@@ -62,6 +78,21 @@ static const struct flux_msg_handler_spec htab[] = {
       .cb           = lookup_cb,
       .rolemask     = FLUX_ROLE_USER
     },
+    { .typemask     = FLUX_MSGTYPE_REQUEST,
+      .topic_glob   = "job-info.lookup-batch",
+      .cb           = lookup_batch_cb,
+      .rolemask     = FLUX_ROLE_USER
+    },
+    { .typemask     = FLUX_MSGTYPE_REQUEST,
+      .topic_glob   = "job-info.lookup-batch-cancel",
+      .cb           = lookup_batch_cancel_cb,
+      .rolemask     = FLUX_ROLE_USER
+    },
+    { .typemask     = FLUX_MSGTYPE_REQUEST,
+      .topic_glob   = "job-info.eventlog-tail",
+      .cb           = tail_cb,
+      .rolemask     = FLUX_ROLE_USER
+    },
     { .typemask     = FLUX_MSGTYPE_REQUEST,
       .topic_glob   = "job-info.eventlog-watch",
       .cb           = watch_cb,
@@ -109,10 +140,17 @@ static void info_ctx_destroy (struct info_ctx *ctx)
         /* freefn set on lookup entries will destroy list entries */
         if (ctx->lookups)
             zlist_destroy (&ctx->lookups);
-        if (ctx->watchers) {
-            watch_cleanup (ctx);
-            zlist_destroy (&ctx->watchers);
+        if (ctx->lookup_batches)
+            zlist_destroy (&ctx->lookup_batches);
+        if (ctx->tails) {
+            tail_cleanup (ctx);
+            zlist_destroy (&ctx->tails);
         }
+        if (ctx->watchers && ctx->watch_sources && ctx->index_ws)
+            watch_cleanup (ctx);
+        zlistx_destroy (&ctx->watchers);
+        zlistx_destroy (&ctx->watch_sources);
+        zhashx_destroy (&ctx->index_ws);
         if (ctx->guest_watchers) {
             guest_watch_cleanup (ctx);
             zlist_destroy (&ctx->guest_watchers);
@@ -141,7 +179,17 @@ static struct info_ctx *info_ctx_create (flux_t *h)
     lru_cache_set_free_f (ctx->owner_lru, (lru_cache_free_f)free);
     if (!(ctx->lookups = zlist_new ()))
         goto error;
-    if (!(ctx->watchers = zlist_new ()))
+    if (!(ctx->lookup_batches = zlist_new ()))
+        goto error;
+    if (!(ctx->tails = zlist_new ()))
+        goto error;
+    /* no destructors for watchers, watch_sources, or index_ws,
+     * destruction handled in watch.c */
+    if (!(ctx->watchers = zlistx_new ()))
+        goto error;
+    if (!(ctx->watch_sources = zlistx_new ()))
+        goto error;
+    if (!(ctx->index_ws = zhashx_new ()))
         goto error;
     if (!(ctx->guest_watchers = zlist_new ()))
         goto error;
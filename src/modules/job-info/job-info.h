@@ -24,7 +24,11 @@ struct info_ctx {
     flux_msg_handler_t **handlers;
     lru_cache_t *owner_lru; /* jobid -> owner LRU */
     zlist_t *lookups;
-    zlist_t *watchers;
+    zlist_t *lookup_batches;
+    zlist_t *tails;
+    zlistx_t *watchers;
+    zlistx_t *watch_sources;
+    zhashx_t *index_ws;        /* watch_sources lookup */
     zlist_t *guest_watchers;
     zlist_t *update_watchers;
     zhashx_t *index_uw;        /* update_watchers lookup */
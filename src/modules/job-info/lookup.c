@@ -28,6 +28,23 @@
 #include "allow.h"
 #include "util.h"
 
+/* A batch lookup streams one response per job id, keeping at most
+ * LOOKUP_BATCH_WINDOW jobs' lookups in flight at a time.
+ */
+#define LOOKUP_BATCH_WINDOW 64
+
+struct lookup_batch {
+    struct info_ctx *ctx;
+    const flux_msg_t *msg;
+    json_t *ids;
+    size_t index;
+    json_t *keys;
+    int flags;
+    int pending;
+    bool canceled;
+    bool cancel;
+};
+
 struct lookup_ctx {
     struct info_ctx *ctx;
     const flux_msg_t *msg;
@@ -37,9 +54,14 @@ struct lookup_ctx {
     int flags;
     flux_future_t *f;
     bool allow;
+    struct lookup_batch *batch;
 };
 
 static void info_lookup_continuation (flux_future_t *fall, void *arg);
+static void lookup_batch_respond_error (struct lookup_batch *b,
+                                        flux_jobid_t id,
+                                        int errnum);
+static void lookup_batch_done (struct lookup_batch *b);
 
 static void lookup_ctx_destroy (void *data)
 {
@@ -84,6 +106,16 @@ error:
     return NULL;
 }
 
+static void lookup_respond_error (struct lookup_ctx *l, int errnum)
+{
+    if (l->batch)
+        lookup_batch_respond_error (l->batch, l->id, errnum);
+    else {
+        if (flux_respond_error (l->ctx->h, l->msg, errnum, NULL) < 0)
+            flux_log_error (l->ctx->h, "%s: flux_respond_error", __FUNCTION__);
+    }
+}
+
 static int lookup_key (struct lookup_ctx *l,
                        flux_future_t *fall,
                        const char *key)
@@ -244,6 +276,7 @@ static void info_lookup_continuation (flux_future_t *fall, void *arg)
     json_t *o = NULL;
     json_t *tmp = NULL;
     char *data = NULL;
+    struct lookup_batch *batch;
 
     if (!l->allow) {
         flux_future_t *f;
@@ -334,7 +367,8 @@ static void info_lookup_continuation (flux_future_t *fall, void *arg)
     if (!(data = json_dumps (o, JSON_COMPACT)))
         goto enomem;
 
-    if (flux_respond (ctx->h, l->msg, data) < 0) {
+    if (!(l->batch && l->batch->canceled)
+        && flux_respond (ctx->h, l->msg, data) < 0) {
         flux_log_error (ctx->h, "%s: flux_respond", __FUNCTION__);
         goto error;
     }
@@ -344,8 +378,7 @@ static void info_lookup_continuation (flux_future_t *fall, void *arg)
 enomem:
     errno = ENOMEM;
 error:
-    if (flux_respond_error (ctx->h, l->msg, errno, NULL) < 0)
-        flux_log_error (ctx->h, "%s: flux_respond_error", __FUNCTION__);
+    lookup_respond_error (l, errno);
 
 done:
     /* flux future destroyed in lookup_ctx_destroy, which is called
@@ -353,7 +386,10 @@ done:
     json_decref (o);
     free (data);
     free (current_value);
+    batch = l->batch;
     zlist_remove (ctx->lookups, l);
+    if (batch)
+        lookup_batch_done (batch);
 }
 
 /* Check if lookup allowed, either b/c message is from instance owner
@@ -501,13 +537,15 @@ static int lookup (flux_t *h,
                    struct info_ctx *ctx,
                    flux_jobid_t id,
                    json_t *keys,
-                   int flags)
+                   int flags,
+                   struct lookup_batch *batch)
 {
     struct lookup_ctx *l = NULL;
     int ret;
 
     if (!(l = lookup_ctx_create (ctx, msg, id, keys, flags)))
         goto error;
+    l->batch = batch;
 
     if (check_allow (l) < 0)
         goto error;
@@ -531,6 +569,8 @@ static int lookup (flux_t *h,
         goto error;
     }
     zlist_freefn (ctx->lookups, l, lookup_ctx_destroy, true);
+    if (batch)
+        batch->pending++;
     return 0;
 
 error:
@@ -577,9 +617,154 @@ void lookup_cb (flux_t *h, flux_msg_handler_t *mh,
         }
     }
 
-    if (lookup (h, msg, ctx, id, keys, flags) < 0)
+    if (lookup (h, msg, ctx, id, keys, flags, NULL) < 0)
+        goto error;
+
+    return;
+
+error:
+    if (flux_respond_error (h, msg, errno, errmsg) < 0)
+        flux_log_error (h, "%s: flux_respond_error", __FUNCTION__);
+}
+
+static void lookup_batch_destroy (void *data)
+{
+    if (data) {
+        struct lookup_batch *b = data;
+        int saved_errno = errno;
+        flux_msg_decref (b->msg);
+        json_decref (b->ids);
+        json_decref (b->keys);
+        free (b);
+        errno = saved_errno;
+    }
+}
+
+static struct lookup_batch *lookup_batch_create (struct info_ctx *ctx,
+                                                 const flux_msg_t *msg,
+                                                 json_t *ids,
+                                                 json_t *keys,
+                                                 int flags)
+{
+    struct lookup_batch *b = calloc (1, sizeof (*b));
+
+    if (!b)
+        return NULL;
+    b->ctx = ctx;
+    b->ids = json_incref (ids);
+    b->keys = json_incref (keys);
+    b->flags = flags;
+    b->msg = flux_msg_incref (msg);
+    return b;
+}
+
+/* A failed lookup within a batch is reported in a response
+ * identifying the job, and the batch carries on.
+ */
+static void lookup_batch_respond_error (struct lookup_batch *b,
+                                        flux_jobid_t id,
+                                        int errnum)
+{
+    if (b->canceled)
+        return;
+    if (flux_respond_pack (b->ctx->h, b->msg, "{s:I s:i}",
+                           "id", id,
+                           "errnum", errnum) < 0)
+        flux_log_error (b->ctx->h, "%s: flux_respond_pack", __FUNCTION__);
+}
+
+/* Start lookups until the window is full or all ids have been
+ * looked up.  Once the last lookup completes, terminate the stream.
+ */
+static void lookup_batch_continue (struct lookup_batch *b)
+{
+    struct info_ctx *ctx = b->ctx;
+
+    while (!b->canceled
+           && b->pending < LOOKUP_BATCH_WINDOW
+           && b->index < json_array_size (b->ids)) {
+        json_t *o = json_array_get (b->ids, b->index++);
+        flux_jobid_t id = json_integer_value (o);
+
+        if (lookup (ctx->h, b->msg, ctx, id, b->keys, b->flags, b) < 0)
+            lookup_batch_respond_error (b, id, errno);
+    }
+    if (b->pending == 0
+        && (b->canceled || b->index == json_array_size (b->ids))) {
+        if (!b->canceled || b->cancel) {
+            if (flux_respond_error (ctx->h, b->msg, ENODATA, NULL) < 0)
+                flux_log_error (ctx->h, "%s: flux_respond_error", __FUNCTION__);
+        }
+        zlist_remove (ctx->lookup_batches, b);
+    }
+}
+
+static void lookup_batch_done (struct lookup_batch *b)
+{
+    b->pending--;
+    lookup_batch_continue (b);
+}
+
+void lookup_batch_cb (flux_t *h, flux_msg_handler_t *mh,
+                      const flux_msg_t *msg, void *arg)
+{
+    struct info_ctx *ctx = arg;
+    struct lookup_batch *b = NULL;
+    size_t index;
+    json_t *o;
+    json_t *ids;
+    json_t *keys;
+    int flags;
+    int valid_flags = FLUX_JOB_LOOKUP_JSON_DECODE | FLUX_JOB_LOOKUP_CURRENT;
+    const char *errmsg = NULL;
+
+    if (flux_request_unpack (msg, NULL, "{s:o s:o s:i}",
+                             "ids", &ids,
+                             "keys", &keys,
+                             "flags", &flags) < 0) {
+        flux_log_error (h, "%s: flux_request_unpack", __FUNCTION__);
+        goto error;
+    }
+    if (flags & ~valid_flags) {
+        errno = EPROTO;
+        errmsg = "lookup-batch request rejected with invalid flag";
+        goto error;
+    }
+    if (!flux_msg_is_streaming (msg)) {
+        errno = EPROTO;
+        errmsg = "lookup-batch request rejected without streaming RPC flag";
+        goto error;
+    }
+
+    /* validate ids and keys are arrays of integers and strings */
+    if (!json_is_array (ids) || !json_is_array (keys)) {
+        errno = EPROTO;
+        goto error;
+    }
+    json_array_foreach (ids, index, o) {
+        if (!json_is_integer (o)) {
+            errno = EPROTO;
+            goto error;
+        }
+    }
+    json_array_foreach (keys, index, o) {
+        if (!json_is_string (o)) {
+            errno = EPROTO;
+            goto error;
+        }
+    }
+
+    if (!(b = lookup_batch_create (ctx, msg, ids, keys, flags)))
+        goto error;
+    if (zlist_append (ctx->lookup_batches, b) < 0) {
+        flux_log_error (h, "%s: zlist_append", __FUNCTION__);
+        lookup_batch_destroy (b);
+        errno = ENOMEM;
         goto error;
+    }
+    zlist_freefn (ctx->lookup_batches, b, lookup_batch_destroy, true);
 
+    lookup_batch_continue (b);
     return;
 
 error:
@@ -587,6 +772,38 @@ error:
         flux_log_error (h, "%s: flux_respond_error", __FUNCTION__);
 }
 
+/* Stop issuing lookups for batches that match msg.  Lookups already
+ * in flight complete, but their results are not sent.  The stream is
+ * terminated when the last one completes.
+ */
+void lookup_batches_cancel (struct info_ctx *ctx,
+                            const flux_msg_t *msg,
+                            bool cancel)
+{
+    struct lookup_batch *b;
+
+    b = zlist_first (ctx->lookup_batches);
+    while (b) {
+        bool match;
+        if (cancel)
+            match = flux_cancel_match (msg, b->msg);
+        else
+            match = flux_disconnect_match (msg, b->msg);
+        if (match && !b->canceled) {
+            b->canceled = true;
+            b->cancel = cancel;
+        }
+        b = zlist_next (ctx->lookup_batches);
+    }
+}
+
+void lookup_batch_cancel_cb (flux_t *h, flux_msg_handler_t *mh,
+                             const flux_msg_t *msg, void *arg)
+{
+    struct info_ctx *ctx = arg;
+    lookup_batches_cancel (ctx, msg, true);
+}
+
 /* legacy rpc target */
 void update_lookup_cb (flux_t *h, flux_msg_handler_t *mh,
                        const flux_msg_t *msg, void *arg)
@@ -627,7 +844,8 @@ void update_lookup_cb (flux_t *h, flux_msg_handler_t *mh,
                 ctx,
                 id,
                 keys,
-                FLUX_JOB_LOOKUP_JSON_DECODE | FLUX_JOB_LOOKUP_CURRENT) < 0)
+                FLUX_JOB_LOOKUP_JSON_DECODE | FLUX_JOB_LOOKUP_CURRENT,
+                NULL) < 0)
         goto error;
 
     return;
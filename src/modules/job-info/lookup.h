@@ -16,6 +16,20 @@
 void lookup_cb (flux_t *h, flux_msg_handler_t *mh,
                 const flux_msg_t *msg, void *arg);
 
+void lookup_batch_cb (flux_t *h, flux_msg_handler_t *mh,
+                      const flux_msg_t *msg, void *arg);
+
+void lookup_batch_cancel_cb (flux_t *h, flux_msg_handler_t *mh,
+                             const flux_msg_t *msg, void *arg);
+
+/* Cancel all batch lookups that match msg.
+ * match credentials & matchtag if cancel true
+ * match credentials if cancel false
+ */
+void lookup_batches_cancel (struct info_ctx *ctx,
+                            const flux_msg_t *msg,
+                            bool cancel);
+
 /* legacy rpc target */
 void update_lookup_cb (flux_t *h, flux_msg_handler_t *mh,
                        const flux_msg_t *msg, void *arg);
@@ -0,0 +1,308 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* tail.c - return the last entries of a job eventlog
+ *
+ * An eventlog built with FLUX_KVS_APPEND, such as guest.output, is
+ * stored as a valref: a list of blobrefs, at least one per append.
+ * Instead of fetching and decoding the whole eventlog, look up the
+ * valref and load blobs from the end until 'count' complete entries
+ * are available.
+ *
+ * job-info.eventlog-tail:
+ *   request  {id:I key:s count:i}
+ *   response {id:I key:s}
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <string.h>
+#include <jansson.h>
+#include <flux/core.h>
+
+#include "src/common/libczmqcontainers/czmq_containers.h"
+#include "src/common/libkvs/treeobj.h"
+#include "src/common/libcontent/content.h"
+
+#include "job-info.h"
+#include "tail.h"
+#include "allow.h"
+
+struct tail_ctx {
+    struct info_ctx *ctx;
+    const flux_msg_t *msg;
+    flux_jobid_t id;
+    char *key;
+    int count;
+    flux_future_t *f;
+    json_t *treeobj;
+    int index;          /* next blob to load, -1 if none remain */
+    char *buf;          /* contents of blobs after 'index' */
+    size_t len;
+};
+
+static void tail_eventlog_continuation (flux_future_t *f, void *arg);
+static void tail_treeobj_continuation (flux_future_t *f, void *arg);
+static void tail_load_continuation (flux_future_t *f, void *arg);
+
+static void tail_ctx_destroy (void *data)
+{
+    if (data) {
+        struct tail_ctx *t = data;
+        int saved_errno = errno;
+        flux_msg_decref (t->msg);
+        free (t->key);
+        flux_future_destroy (t->f);
+        json_decref (t->treeobj);
+        free (t->buf);
+        free (t);
+        errno = saved_errno;
+    }
+}
+
+static struct tail_ctx *tail_ctx_create (struct info_ctx *ctx,
+                                         const flux_msg_t *msg,
+                                         flux_jobid_t id,
+                                         const char *key,
+                                         int count)
+{
+    struct tail_ctx *t;
+
+    if (!(t = calloc (1, sizeof (*t))))
+        return NULL;
+    t->ctx = ctx;
+    t->id = id;
+    t->count = count;
+    t->index = -1;
+    if (!(t->key = strdup (key))) {
+        tail_ctx_destroy (t);
+        return NULL;
+    }
+    t->msg = flux_msg_incref (msg);
+    return t;
+}
+
+/* Respond (with success or error) and retire 't'.
+ */
+static void tail_finish (struct tail_ctx *t, int errnum, size_t offset)
+{
+    flux_t *h = t->ctx->h;
+    const char *s = t->buf ? t->buf + offset : "";
+
+    if (errnum) {
+        if (flux_respond_error (h, t->msg, errnum, NULL) < 0)
+            flux_log_error (h, "%s: flux_respond_error", __FUNCTION__);
+    }
+    else if (flux_respond_pack (h,
+                                t->msg,
+                                "{s:I s:s%}",
+                                "id", t->id,
+                                t->key, s, t->len - offset) < 0)
+        flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
+    zlist_remove (t->ctx->tails, t);
+}
+
+/* Find the offset of the last 'count' entries in the buffer.  Each entry
+ * ends in a newline, so an entry starts after every newline but the last.
+ * The first line is only known to be complete if no blobs precede it.
+ * Return true if the offset was found.
+ */
+static bool tail_find (struct tail_ctx *t, size_t *offsetp)
+{
+    int n = 0;
+
+    for (ssize_t i = (ssize_t)t->len - 2; i >= 0; i--) {
+        if (t->buf[i] == '\n' && ++n == t->count) {
+            *offsetp = i + 1;
+            return true;
+        }
+    }
+    if (t->index < 0) {
+        *offsetp = 0;
+        return true;
+    }
+    return false;
+}
+
+static int tail_prepend (struct tail_ctx *t, const void *data, size_t len)
+{
+    char *buf;
+
+    if (len == 0)
+        return 0;
+    if (!(buf = malloc (len + t->len)))
+        return -1;
+    memcpy (buf, data, len);
+    if (t->len > 0)
+        memcpy (buf + len, t->buf, t->len);
+    free (t->buf);
+    t->buf = buf;
+    t->len += len;
+    return 0;
+}
+
+/* Load the next blob toward the start of the valref, or respond if
+ * enough entries have been loaded.
+ */
+static void tail_continue (struct tail_ctx *t)
+{
+    flux_t *h = t->ctx->h;
+    const char *blobref;
+    size_t offset;
+
+    if (tail_find (t, &offset)) {
+        tail_finish (t, 0, offset);
+        return;
+    }
+    flux_future_destroy (t->f);
+    t->f = NULL;
+    if (!(blobref = treeobj_get_blobref (t->treeobj, t->index--))
+        || !(t->f = content_load_byblobref (h, blobref, 0))
+        || flux_future_then (t->f, -1, tail_load_continuation, t) < 0) {
+        flux_log_error (h, "%s: content_load", __FUNCTION__);
+        tail_finish (t, errno, 0);
+    }
+}
+
+static void tail_load_continuation (flux_future_t *f, void *arg)
+{
+    struct tail_ctx *t = arg;
+    const void *data;
+    int len;
+
+    if (content_load_get (f, &data, &len) < 0
+        || tail_prepend (t, data, len) < 0) {
+        flux_log_error (t->ctx->h, "%s: content_load_get", __FUNCTION__);
+        tail_finish (t, errno, 0);
+        return;
+    }
+    tail_continue (t);
+}
+
+static void tail_treeobj_continuation (flux_future_t *f, void *arg)
+{
+    struct tail_ctx *t = arg;
+    const char *s;
+    void *data = NULL;
+    int len;
+
+    if (flux_kvs_lookup_get_treeobj (f, &s) < 0
+        || !(t->treeobj = treeobj_decode (s)))
+        goto error;
+    if (treeobj_is_val (t->treeobj)) {
+        if (treeobj_decode_val (t->treeobj, &data, &len) < 0)
+            goto error;
+        t->buf = data;
+        t->len = len;
+    }
+    else if (treeobj_is_valref (t->treeobj))
+        t->index = treeobj_get_count (t->treeobj) - 1;
+    else {
+        errno = EISDIR;
+        goto error;
+    }
+    tail_continue (t);
+    return;
+error:
+    if (errno != ENOENT && errno != EISDIR)
+        flux_log_error (t->ctx->h, "%s: lookup", __FUNCTION__);
+    tail_finish (t, errno, 0);
+}
+
+static int tail_lookup (struct tail_ctx *t,
+                        const char *key,
+                        int flags,
+                        flux_continuation_f cb)
+{
+    char path[64];
+
+    flux_future_destroy (t->f);
+    t->f = NULL;
+    if (flux_job_kvs_key (path, sizeof (path), t->id, key) < 0
+        || !(t->f = flux_kvs_lookup (t->ctx->h, NULL, flags, path))
+        || flux_future_then (t->f, -1, cb, t) < 0)
+        return -1;
+    return 0;
+}
+
+/* Guest access check, if the owner of the job is not cached.
+ */
+static void tail_eventlog_continuation (flux_future_t *f, void *arg)
+{
+    struct tail_ctx *t = arg;
+    const char *s;
+
+    if (flux_kvs_lookup_get (f, &s) < 0
+        || eventlog_allow (t->ctx, t->msg, t->id, s) < 0
+        || tail_lookup (t,
+                        t->key,
+                        FLUX_KVS_TREEOBJ,
+                        tail_treeobj_continuation) < 0)
+        tail_finish (t, errno, 0);
+}
+
+void tail_cb (flux_t *h, flux_msg_handler_t *mh,
+              const flux_msg_t *msg, void *arg)
+{
+    struct info_ctx *ctx = arg;
+    struct tail_ctx *t = NULL;
+    flux_jobid_t id;
+    const char *key;
+    int count;
+    int allow = 1;
+    int rc;
+
+    if (flux_request_unpack (msg, NULL, "{s:I s:s s:i}",
+                             "id", &id,
+                             "key", &key,
+                             "count", &count) < 0)
+        goto error;
+    if (count <= 0) {
+        errno = EPROTO;
+        goto error;
+    }
+    if (flux_msg_authorize (msg, FLUX_USERID_UNKNOWN) < 0
+        && (allow = eventlog_allow_lru (ctx, msg, id)) < 0)
+        goto error;
+    if (!(t = tail_ctx_create (ctx, msg, id, key, count)))
+        goto error;
+    if (allow)
+        rc = tail_lookup (t, key, FLUX_KVS_TREEOBJ, tail_treeobj_continuation);
+    else
+        rc = tail_lookup (t, "eventlog", 0, tail_eventlog_continuation);
+    if (rc < 0)
+        goto error;
+    if (zlist_append (ctx->tails, t) < 0) {
+        errno = ENOMEM;
+        goto error;
+    }
+    zlist_freefn (ctx->tails, t, tail_ctx_destroy, true);
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        flux_log_error (h, "%s: flux_respond_error", __FUNCTION__);
+    tail_ctx_destroy (t);
+}
+
+void tail_cleanup (struct info_ctx *ctx)
+{
+    struct tail_ctx *t;
+
+    while ((t = zlist_pop (ctx->tails))) {
+        if (flux_respond_error (ctx->h, t->msg, ENOSYS, NULL) < 0)
+            flux_log_error (ctx->h, "%s: flux_respond_error", __FUNCTION__);
+        tail_ctx_destroy (t);
+    }
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
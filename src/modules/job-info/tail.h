@@ -0,0 +1,27 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _FLUX_JOB_INFO_TAIL_H
+#define _FLUX_JOB_INFO_TAIL_H
+
+#include <flux/core.h>
+
+#include "job-info.h"
+
+void tail_cb (flux_t *h, flux_msg_handler_t *mh,
+              const flux_msg_t *msg, void *arg);
+
+void tail_cleanup (struct info_ctx *ctx);
+
+#endif /* ! _FLUX_JOB_INFO_TAIL_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
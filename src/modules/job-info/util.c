@@ -21,6 +21,8 @@
 
 #include "ccan/str/str.h"
 
+#include "util.h"
+
 flux_msg_t *cred_msg_pack (const char *topic,
                            struct flux_msg_cred cred,
                            const char *fmt,
@@ -101,6 +103,83 @@ error:
     return rc;
 }
 
+int eventlog_filter_decode (const flux_msg_t *msg,
+                            struct eventlog_filter *filter,
+                            const char **errmsg)
+{
+    memset (filter, 0, sizeof (*filter));
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s?i s?i s?f}",
+                             "skip", &filter->skip,
+                             "tail", &filter->tail,
+                             "since", &filter->since) < 0)
+        return -1;
+    if (filter->skip < 0 || filter->tail < 0 || filter->since < 0.) {
+        *errmsg = "eventlog-watch skip, tail, and since must be >= 0";
+        errno = EPROTO;
+        return -1;
+    }
+    return 0;
+}
+
+bool eventlog_filter_active (struct eventlog_filter *filter)
+{
+    return filter->skip > 0 || filter->tail > 0 || filter->since > 0.;
+}
+
+size_t eventlog_filter_start (struct eventlog_filter *filter,
+                              const char *s,
+                              size_t len)
+{
+    const char *end = s + len;
+    const char *p = s;
+
+    if (filter->started || len == 0)
+        return 0;
+    filter->started = true;
+    if (filter->skip > 0) {
+        int n = filter->skip;
+        while (n-- > 0 && p < end) {
+            const char *nl = memchr (p, '\n', end - p);
+            p = nl ? nl + 1 : end;
+        }
+    }
+    if (filter->tail > 0) {
+        const char *q = end;
+        int n = 0;
+        /* walk back over complete entries from the end */
+        while (q > p && n < filter->tail) {
+            const char *r = q - 1;
+            while (r > p && r[-1] != '\n')
+                r--;
+            q = r;
+            n++;
+        }
+        p = q;
+    }
+    return p - s;
+}
+
+bool eventlog_filter_match (struct eventlog_filter *filter,
+                            const char *tok,
+                            size_t toklen)
+{
+    json_t *o;
+    double timestamp;
+    bool match = true;
+
+    if (filter->since == 0.)
+        return true;
+    if ((o = json_loadb (tok, toklen, 0, NULL))) {
+        if (json_unpack (o, "{s:F}", "timestamp", &timestamp) == 0
+            && timestamp < filter->since)
+            match = false;
+        json_decref (o);
+    }
+    return match;
+}
+
 void apply_updates_R (flux_t *h,
                       flux_jobid_t id,
                       const char *key,
@@ -35,6 +35,37 @@ int parse_eventlog_entry (flux_t *h,
                           const char **name,
                           json_t **context);
 
+/* Optional eventlog-watch request fields that limit which entries
+ * are sent.  'skip' and 'tail' apply to the entries already present
+ * when the watch starts, 'since' to every entry.
+ */
+struct eventlog_filter {
+    int skip;           /* skip the first 'skip' entries */
+    int tail;           /* then send only the last 'tail' entries */
+    double since;       /* skip entries with timestamp < since */
+    bool started;       /* skip and tail have been applied */
+};
+
+/* decode filter fields from an eventlog-watch request */
+int eventlog_filter_decode (const flux_msg_t *msg,
+                            struct eventlog_filter *filter,
+                            const char **errmsg);
+
+bool eventlog_filter_active (struct eventlog_filter *filter);
+
+/* Return the number of bytes of eventlog data 's' of length 'len' to
+ * pass over according to 'skip' and 'tail'.  This returns 0 after
+ * the first call with len > 0.
+ */
+size_t eventlog_filter_start (struct eventlog_filter *filter,
+                              const char *s,
+                              size_t len);
+
+/* Return true if the entry should be sent according to 'since' */
+bool eventlog_filter_match (struct eventlog_filter *filter,
+                            const char *tok,
+                            size_t toklen);
+
 /* apply context updates to the R object */
 void apply_updates_R (flux_t *h,
                       flux_jobid_t id,
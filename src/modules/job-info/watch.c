@@ -27,6 +27,30 @@
 #include "allow.h"
 #include "util.h"
 
+/* Watchers of the same eventlog (job id, namespace, path, and flags)
+ * share a single upstream KVS watch, a "watch source".  The source
+ * accumulates the eventlog as it is received and each watcher tracks
+ * its own offset into it, so a watcher that joins late is first sent
+ * what the others have already seen.
+ */
+struct watch_source {
+    struct info_ctx *ctx;
+    flux_jobid_t id;
+    bool guest;
+    char *path;
+    int flags;
+    char *index_key;
+    flux_future_t *watch_f;
+    char *data;                 /* eventlog received so far */
+    size_t len;
+    size_t alloc;
+    size_t scanned;             /* offset checked for "clean" event */
+    zlistx_t *clients;          /* struct watch_ctx, not owned */
+    bool ended;                 /* main eventlog reached "clean" */
+    bool stopped;               /* upstream watch canceled or terminated */
+    void *handle;               /* in ctx->watch_sources */
+};
+
 struct watch_ctx {
     struct info_ctx *ctx;
     const flux_msg_t *msg;
@@ -35,15 +59,77 @@ struct watch_ctx {
     char *path;
     int flags;
     flux_future_t *check_f;
-    flux_future_t *watch_f;
+    struct watch_source *src;
+    void *src_handle;
+    size_t offset;              /* offset into src->data sent to caller */
+    struct eventlog_filter filter;
     bool allow;
-    bool kvs_watch_canceled;
+    bool canceled;
     bool cancel;
+    void *handle;               /* in ctx->watchers */
 };
 
 static void watch_continuation (flux_future_t *f, void *arg);
 static void check_eventlog_continuation (flux_future_t *f, void *arg);
 
+static void watch_source_destroy (struct watch_source *src)
+{
+    if (src) {
+        int save_errno = errno;
+        free (src->path);
+        free (src->index_key);
+        flux_future_destroy (src->watch_f);
+        free (src->data);
+        zlistx_destroy (&src->clients);
+        free (src);
+        errno = save_errno;
+    }
+}
+
+static char *get_index_key (flux_jobid_t id,
+                            bool guest,
+                            const char *path,
+                            int flags)
+{
+    char *s;
+    if (asprintf (&s,
+                  "%ju-%s-%d-%s",
+                  (uintmax_t)id,
+                  guest ? "guest" : "main",
+                  flags,
+                  path) < 0)
+        return NULL;
+    return s;
+}
+
+static struct watch_source *watch_source_create (struct info_ctx *ctx,
+                                                 flux_jobid_t id,
+                                                 bool guest,
+                                                 const char *path,
+                                                 int flags)
+{
+    struct watch_source *src = calloc (1, sizeof (*src));
+
+    if (!src)
+        return NULL;
+
+    src->ctx = ctx;
+    src->id = id;
+    src->guest = guest;
+    src->flags = flags;
+    if (!(src->path = strdup (path))
+        || !(src->index_key = get_index_key (id, guest, path, flags))
+        || !(src->clients = zlistx_new ())) {
+        errno = ENOMEM;
+        goto error;
+    }
+    return src;
+
+error:
+    watch_source_destroy (src);
+    return NULL;
+}
+
 static void watch_ctx_destroy (void *data)
 {
     if (data) {
@@ -52,7 +138,6 @@ static void watch_ctx_destroy (void *data)
         flux_msg_decref (ctx->msg);
         free (ctx->path);
         flux_future_destroy (ctx->check_f);
-        flux_future_destroy (ctx->watch_f);
         free (ctx);
         errno = save_errno;
     }
@@ -63,7 +148,8 @@ static struct watch_ctx *watch_ctx_create (struct info_ctx *ctx,
                                            flux_jobid_t id,
                                            bool guest,
                                            const char *path,
-                                           int flags)
+                                           int flags,
+                                           struct eventlog_filter *filter)
 {
     struct watch_ctx *w = calloc (1, sizeof (*w));
 
@@ -78,6 +164,7 @@ static struct watch_ctx *watch_ctx_create (struct info_ctx *ctx,
         goto error;
     }
     w->flags = flags;
+    w->filter = *filter;
 
     w->msg = flux_msg_incref (msg);
 
@@ -88,6 +175,57 @@ error:
     return NULL;
 }
 
+/* Cancel the upstream watch once no watchers remain.  The source is
+ * destroyed when the watch terminates, but a new source for the same
+ * eventlog may be created in the meantime.
+ */
+static void watch_source_cancel (struct watch_source *src)
+{
+    struct info_ctx *ctx = src->ctx;
+
+    if (src->stopped)
+        return;
+    if (flux_kvs_lookup_cancel (src->watch_f) < 0)
+        flux_log_error (ctx->h, "%s: flux_kvs_lookup_cancel", __FUNCTION__);
+    src->stopped = true;
+    if (zhashx_lookup (ctx->index_ws, src->index_key) == src)
+        zhashx_delete (ctx->index_ws, src->index_key);
+}
+
+static void watch_source_remove (struct watch_source *src)
+{
+    struct info_ctx *ctx = src->ctx;
+
+    if (zhashx_lookup (ctx->index_ws, src->index_key) == src)
+        zhashx_delete (ctx->index_ws, src->index_key);
+    zlistx_detach (ctx->watch_sources, src->handle);
+    watch_source_destroy (src);
+}
+
+/* Remove watcher 'w', detaching it from its watch source, if any.
+ */
+static void watch_remove (struct watch_ctx *w)
+{
+    struct info_ctx *ctx = w->ctx;
+    struct watch_source *src = w->src;
+
+    if (src) {
+        zlistx_detach (src->clients, w->src_handle);
+        if (zlistx_size (src->clients) == 0)
+            watch_source_cancel (src);
+    }
+    zlistx_detach (ctx->watchers, w->handle);
+    watch_ctx_destroy (w);
+}
+
+static void watch_respond_error (struct watch_ctx *w,
+                                 int errnum,
+                                 const char *errmsg)
+{
+    if (flux_respond_error (w->ctx->h, w->msg, errnum, errmsg) < 0)
+        flux_log_error (w->ctx->h, "%s: flux_respond_error", __FUNCTION__);
+}
+
 static int check_eventlog (struct watch_ctx *w)
 {
     char key[64];
@@ -111,7 +249,7 @@ static int check_eventlog (struct watch_ctx *w)
     return 0;
 }
 
-static int watch_key (struct watch_ctx *w)
+static int watch_key (struct watch_source *src)
 {
     char fullpath[128];
     char ns[128];
@@ -119,40 +257,143 @@ static int watch_key (struct watch_ctx *w)
     char *pathptr = NULL;
     int flags = (FLUX_KVS_WATCH | FLUX_KVS_WATCH_APPEND);
 
-    if (w->flags & FLUX_JOB_EVENT_WATCH_WAITCREATE)
+    if (src->flags & FLUX_JOB_EVENT_WATCH_WAITCREATE)
         flags |= FLUX_KVS_WAITCREATE;
 
-    if (w->guest) {
-        if (flux_job_kvs_namespace (ns, sizeof (ns), w->id) < 0) {
-            flux_log_error (w->ctx->h, "%s: flux_job_kvs_namespace",
+    if (src->guest) {
+        if (flux_job_kvs_namespace (ns, sizeof (ns), src->id) < 0) {
+            flux_log_error (src->ctx->h, "%s: flux_job_kvs_namespace",
                             __FUNCTION__);
             return -1;
         }
         nsptr = ns;
-        pathptr = w->path;
+        pathptr = src->path;
     }
     else {
-        if (flux_job_kvs_key (fullpath, sizeof (fullpath), w->id, w->path) < 0) {
-            flux_log_error (w->ctx->h, "%s: flux_job_kvs_key", __FUNCTION__);
+        if (flux_job_kvs_key (fullpath,
+                              sizeof (fullpath),
+                              src->id,
+                              src->path) < 0) {
+            flux_log_error (src->ctx->h, "%s: flux_job_kvs_key", __FUNCTION__);
             return -1;
         }
         pathptr = fullpath;
     }
 
-    if (!(w->watch_f = flux_kvs_lookup (w->ctx->h, nsptr, flags, pathptr))) {
-        flux_log_error (w->ctx->h, "%s: flux_kvs_lookup", __FUNCTION__);
+    if (!(src->watch_f = flux_kvs_lookup (src->ctx->h, nsptr, flags, pathptr))) {
+        flux_log_error (src->ctx->h, "%s: flux_kvs_lookup", __FUNCTION__);
         return -1;
     }
 
-    if (flux_future_then (w->watch_f, -1, watch_continuation, w) < 0) {
-        /* future cleanup handled in context destruction */
-        flux_log_error (w->ctx->h, "%s: flux_future_then", __FUNCTION__);
+    if (flux_future_then (src->watch_f, -1, watch_continuation, src) < 0) {
+        /* future cleanup handled in source destruction */
+        flux_log_error (src->ctx->h, "%s: flux_future_then", __FUNCTION__);
         return -1;
     }
 
     return 0;
 }
 
+/* Send the events 'w' has not yet seen.  If 'w' has a filter, each
+ * response also carries the offset of the event in the eventlog, so
+ * the guest watcher can track what it has been sent.
+ */
+static int watch_send (struct watch_ctx *w)
+{
+    struct watch_source *src = w->src;
+    struct info_ctx *ctx = w->ctx;
+    const char *input;
+    const char *tok;
+    size_t toklen;
+
+    if (src->len == 0)
+        return 0;
+
+    if (!w->allow) {
+        if (eventlog_allow (ctx, w->msg, w->id, src->data) < 0)
+            return -1;
+        w->allow = true;
+    }
+
+    w->offset += eventlog_filter_start (&w->filter,
+                                        src->data + w->offset,
+                                        src->len - w->offset);
+    input = src->data + w->offset;
+    while (get_next_eventlog_entry (&input, &tok, &toklen)) {
+        int rc;
+        if (!eventlog_filter_match (&w->filter, tok, toklen))
+            continue;
+        if (eventlog_filter_active (&w->filter))
+            rc = flux_respond_pack (ctx->h, w->msg,
+                                    "{s:s# s:I}",
+                                    "event", tok, toklen,
+                                    "offset", (json_int_t)(tok - src->data));
+        else
+            rc = flux_respond_pack (ctx->h, w->msg,
+                                    "{s:s#}",
+                                    "event", tok, toklen);
+        if (rc < 0) {
+            flux_log_error (ctx->h, "%s: flux_respond_pack",
+                            __FUNCTION__);
+            return -1;
+        }
+    }
+    w->offset = input - src->data;
+    return 0;
+}
+
+/* Attach 'w' to the watch source for its eventlog, starting one if
+ * necessary, and catch it up on events already received.
+ */
+static int watch_attach (struct watch_ctx *w)
+{
+    struct info_ctx *ctx = w->ctx;
+    struct watch_source *src;
+    char *index_key;
+
+    if (!(index_key = get_index_key (w->id, w->guest, w->path, w->flags))) {
+        errno = ENOMEM;
+        return -1;
+    }
+    src = zhashx_lookup (ctx->index_ws, index_key);
+    free (index_key);
+
+    if (!src) {
+        if (!(src = watch_source_create (ctx,
+                                         w->id,
+                                         w->guest,
+                                         w->path,
+                                         w->flags)))
+            return -1;
+        if (watch_key (src) < 0) {
+            watch_source_destroy (src);
+            return -1;
+        }
+        if (!(src->handle = zlistx_add_end (ctx->watch_sources, src))) {
+            watch_source_destroy (src);
+            errno = ENOMEM;
+            return -1;
+        }
+        if (zhashx_insert (ctx->index_ws, src->index_key, src) < 0) {
+            flux_log_error (ctx->h, "%s: zhashx_insert", __FUNCTION__);
+            /* matchtag is in use, destroy on ENODATA */
+            watch_source_cancel (src);
+            errno = ENOMEM;
+            return -1;
+        }
+    }
+
+    if (!(w->src_handle = zlistx_add_end (src->clients, w))) {
+        if (zlistx_size (src->clients) == 0)
+            watch_source_cancel (src);
+        errno = ENOMEM;
+        return -1;
+    }
+    w->src = src;
+
+    return watch_send (w);
+}
+
 static void check_eventlog_continuation (flux_future_t *f, void *arg)
 {
     struct watch_ctx *w = arg;
@@ -173,29 +414,26 @@ static void check_eventlog_continuation (flux_future_t *f, void *arg)
 
     /* There is a chance user canceled before we began legitimately
      * "watching" the desired eventlog */
-    if (w->kvs_watch_canceled) {
-        if (w->cancel) {
-            if (flux_respond_error (ctx->h, w->msg, ENODATA, NULL) < 0)
-                flux_log_error (ctx->h, "%s: flux_respond_error", __FUNCTION__);
-        }
+    if (w->canceled) {
+        if (w->cancel)
+            watch_respond_error (w, ENODATA, NULL);
         goto done;
     }
 
-    if (watch_key (w) < 0)
+    if (watch_attach (w) < 0)
         goto error;
 
     return;
 
 error:
-    if (flux_respond_error (ctx->h, w->msg, errno, NULL) < 0)
-        flux_log_error (ctx->h, "%s: flux_respond_error", __FUNCTION__);
+    watch_respond_error (w, errno, NULL);
 done:
     /* flux future destroyed in watch_ctx_destroy, which is called
-     * via zlist_remove() */
-    zlist_remove (ctx->watchers, w);
+     * via watch_remove() */
+    watch_remove (w);
 }
 
-static int check_eventlog_end (struct watch_ctx *w,
+static int check_eventlog_end (struct info_ctx *ctx,
                                const char *tok,
                                size_t toklen)
 {
@@ -203,7 +441,7 @@ static int check_eventlog_end (struct watch_ctx *w,
     json_t *entry = NULL;
     int rc = 0;
 
-    if (parse_eventlog_entry (w->ctx->h, tok, toklen, &entry, &name, NULL) < 0)
+    if (parse_eventlog_entry (ctx->h, tok, toklen, &entry, &name, NULL) < 0)
         return -1;
 
     if (streq (name, "clean"))
@@ -212,24 +450,71 @@ static int check_eventlog_end (struct watch_ctx *w,
     return rc;
 }
 
-static void watch_continuation (flux_future_t *f, void *arg)
+static int watch_source_append (struct watch_source *src, const char *s)
 {
-    struct watch_ctx *w = arg;
-    struct info_ctx *ctx = w->ctx;
-    const char *s;
+    size_t n = strlen (s);
     const char *input;
     const char *tok;
     size_t toklen;
+
+    if (src->len + n + 1 > src->alloc) {
+        size_t new_alloc = src->alloc ? src->alloc : 1024;
+        char *new_data;
+        while (src->len + n + 1 > new_alloc)
+            new_alloc *= 2;
+        if (!(new_data = realloc (src->data, new_alloc)))
+            return -1;
+        src->data = new_data;
+        src->alloc = new_alloc;
+    }
+    memcpy (src->data + src->len, s, n + 1);
+    src->len += n;
+
+    /* When watching the main job eventlog, we return ENODATA back
+     * to the user when the eventlog has reached the end.
+     *
+     * An alternate main KVS namespace eventlog does not have a
+     * known ruleset, so it will hang.
+     */
+    if (!src->guest && streq (src->path, "eventlog")) {
+        input = src->data + src->scanned;
+        while (get_next_eventlog_entry (&input, &tok, &toklen)) {
+            if (check_eventlog_end (src->ctx, tok, toklen) > 0) {
+                /* If by small chance there is an event after "clean"
+                 * (e.g. user appended), we won't send it */
+                src->len = input - src->data;
+                src->data[src->len] = '\0';
+                src->ended = true;
+                break;
+            }
+        }
+        src->scanned = input - src->data;
+    }
+    return 0;
+}
+
+static void watch_continuation (flux_future_t *f, void *arg)
+{
+    struct watch_source *src = arg;
+    struct info_ctx *ctx = src->ctx;
+    struct watch_ctx *w;
+    const char *s;
     const char *errmsg = NULL;
+    int errnum;
 
     if (flux_kvs_lookup_get (f, &s) < 0) {
         if (errno != ENOENT && errno != ENODATA && errno != ENOTSUP)
             flux_log_error (ctx->h, "%s: flux_kvs_lookup_get", __FUNCTION__);
-        if (errno == ENODATA && w->kvs_watch_canceled && !w->cancel)
-            goto cleanup;
         goto error;
     }
 
+    /* All watchers have gone away, wait for the cancellation to
+     * terminate the stream */
+    if (src->stopped) {
+        flux_future_reset (f);
+        return;
+    }
+
     /* Issue #4612 - zero length append illegal for an eventlog.  This
      * most likely occurred through an illegal overwrite of the whole
      * eventlog.
@@ -237,75 +522,61 @@ static void watch_continuation (flux_future_t *f, void *arg)
     if (!s) {
         errmsg = "illegal append of zero bytes";
         errno = EINVAL;
-        goto error;
+        goto error_cancel;
     }
 
-    if (w->kvs_watch_canceled) {
-        if (w->cancel) {
-            errno = ENODATA;
-            goto error;
-        }
-        goto cleanup;
-    }
+    if (watch_source_append (src, s) < 0)
+        goto error_cancel;
 
-    if (!w->allow) {
-        if (eventlog_allow (ctx, w->msg, w->id, s) < 0)
-            goto error_cancel;
-        w->allow = true;
+    if (src->ended) {
+        if (flux_kvs_lookup_cancel (f) < 0)
+            flux_log_error (ctx->h, "%s: flux_kvs_lookup_cancel",
+                            __FUNCTION__);
+        src->stopped = true;
     }
 
-    input = s;
-    while (get_next_eventlog_entry (&input, &tok, &toklen)) {
-        if (flux_respond_pack (ctx->h, w->msg,
-                               "{s:s#}",
-                               "event", tok, toklen) < 0) {
-            flux_log_error (ctx->h, "%s: flux_respond_pack",
-                            __FUNCTION__);
-            goto error_cancel;
+    w = zlistx_first (src->clients);
+    while (w) {
+        if (watch_send (w) < 0) {
+            watch_respond_error (w, errno, NULL);
+            watch_remove (w);
         }
-
-        /* When watching the main job eventlog, we return ENODATA back
-         * to the user when the eventlog has reached the end.
-         *
-         * An alternate main KVS namespace eventlog does not have a
-         * known ruleset, so it will hang.
-         */
-        if (!w->guest && streq (w->path, "eventlog")) {
-            if (check_eventlog_end (w, tok, toklen) > 0) {
-                if (flux_kvs_lookup_cancel (w->watch_f) < 0) {
-                    flux_log_error (ctx->h, "%s: flux_kvs_lookup_cancel",
-                                    __FUNCTION__);
-                    goto error;
-                }
-                /* If by small chance there is an event after "clean"
-                 * (e.g. user appended), we won't send it */
-                errno = ENODATA;
-                goto error;
-            }
+        else if (src->ended) {
+            watch_respond_error (w, ENODATA, NULL);
+            watch_remove (w);
         }
+        w = zlistx_next (src->clients);
     }
 
-    flux_future_reset (f);
+    if (src->ended)
+        watch_source_remove (src);
+    else
+        flux_future_reset (f);
     return;
 
 error_cancel:
     /* If we haven't sent a cancellation yet, must do so so that
      * the future's matchtag will eventually be freed */
-    if (!w->kvs_watch_canceled) {
+    if (!src->stopped) {
         int save_errno = errno;
-        if (flux_kvs_lookup_cancel (w->watch_f) < 0)
+        if (flux_kvs_lookup_cancel (f) < 0)
             flux_log_error (ctx->h, "%s: flux_kvs_lookup_cancel",
                             __FUNCTION__);
         errno = save_errno;
     }
 
 error:
-    if (flux_respond_error (ctx->h, w->msg, errno, errmsg) < 0)
-        flux_log_error (ctx->h, "%s: flux_respond_error", __FUNCTION__);
-cleanup:
-    /* flux future destroyed in watch_ctx_destroy, which is called
-     * via zlist_remove() */
-    zlist_remove (ctx->watchers, w);
+    errnum = errno;
+    src->stopped = true;
+    w = zlistx_first (src->clients);
+    while (w) {
+        watch_respond_error (w, errnum, errmsg);
+        watch_remove (w);
+        w = zlistx_next (src->clients);
+    }
+    /* flux future destroyed in watch_source_destroy, which is called
+     * via watch_source_remove() */
+    watch_source_remove (src);
 }
 
 static int watch (struct info_ctx *ctx,
@@ -313,13 +584,21 @@ static int watch (struct info_ctx *ctx,
                   flux_jobid_t id,
                   const char *path,
                   int flags,
-                  bool guest)
+                  bool guest,
+                  struct eventlog_filter *filter)
 {
     struct watch_ctx *w = NULL;
     uint32_t rolemask;
 
-    if (!(w = watch_ctx_create (ctx, msg, id, guest, path, flags)))
-        goto error;
+    if (!(w = watch_ctx_create (ctx, msg, id, guest, path, flags, filter)))
+        return -1;
+
+    if (!(w->handle = zlistx_add_end (ctx->watchers, w))) {
+        flux_log_error (ctx->h, "%s: zlistx_add_end", __FUNCTION__);
+        watch_ctx_destroy (w);
+        errno = ENOMEM;
+        return -1;
+    }
 
     /* if user requested an alternate path and that alternate path is
      * not the main eventlog, we have to check the main eventlog for
@@ -340,7 +619,7 @@ static int watch (struct info_ctx *ctx,
         if ((ret = eventlog_allow_lru (w->ctx,
                                        w->msg,
                                        w->id)) < 0)
-            return -1;
+            goto error;
 
         if (ret)
             w->allow = true;
@@ -353,21 +632,14 @@ static int watch (struct info_ctx *ctx,
             goto error;
     }
     else {
-        if (watch_key (w) < 0)
+        if (watch_attach (w) < 0)
             goto error;
     }
 
-    if (zlist_append (ctx->watchers, w) < 0) {
-        flux_log_error (ctx->h, "%s: zlist_append", __FUNCTION__);
-        goto error;
-    }
-    zlist_freefn (ctx->watchers, w, watch_ctx_destroy, true);
-    w = NULL;
-
     return 0;
 
 error:
-    watch_ctx_destroy (w);
+    watch_remove (w);
     return -1;
 }
 
@@ -375,12 +647,12 @@ void watch_cb (flux_t *h, flux_msg_handler_t *mh,
                const flux_msg_t *msg, void *arg)
 {
     struct info_ctx *ctx = arg;
-    struct watch_ctx *w = NULL;
     flux_jobid_t id;
     int guest = 0;
     const char *path = NULL;
     int flags;
     int valid_flags = FLUX_JOB_EVENT_WATCH_WAITCREATE;
+    struct eventlog_filter filter;
     const char *errmsg = NULL;
 
     if (flux_request_unpack (msg, NULL, "{s:I s:s s:i}",
@@ -400,17 +672,19 @@ void watch_cb (flux_t *h, flux_msg_handler_t *mh,
         errmsg = "eventlog-watch request rejected without streaming RPC flag";
         goto error;
     }
+    if (eventlog_filter_decode (msg, &filter, &errmsg) < 0)
+        goto error;
     /* guest flag indicates to read path from guest namespace */
     (void)flux_request_unpack (msg, NULL, "{s:b}", "guest", &guest);
 
     /* if watching a "guest" path, forward to guest watcher for
      * handling */
     if (strstarts (path, "guest.")) {
-        if (guest_watch (ctx, msg, id, path + 6, flags) < 0)
+        if (guest_watch (ctx, msg, id, path + 6, flags, &filter) < 0)
             goto error;
     }
     else {
-        if (watch (ctx, msg, id, path, flags, guest) < 0)
+        if (watch (ctx, msg, id, path, flags, guest, &filter) < 0)
             goto error;
     }
 
@@ -419,15 +693,13 @@ void watch_cb (flux_t *h, flux_msg_handler_t *mh,
 error:
     if (flux_respond_error (h, msg, errno, errmsg) < 0)
         flux_log_error (h, "%s: flux_respond_error", __FUNCTION__);
-    watch_ctx_destroy (w);
 }
 
 /* Cancel watch 'w' if it matches message.
  */
-static void send_kvs_watch_cancel (struct info_ctx *ctx,
-                                   struct watch_ctx *w,
-                                   const flux_msg_t *msg,
-                                   bool cancel)
+static void watch_cancel (struct watch_ctx *w,
+                          const flux_msg_t *msg,
+                          bool cancel)
 {
     bool match;
     if (cancel)
@@ -435,15 +707,16 @@ static void send_kvs_watch_cancel (struct info_ctx *ctx,
     else
         match = flux_disconnect_match (msg, w->msg);
     if (match) {
-        w->kvs_watch_canceled = true;
-        w->cancel = cancel;
-
-        /* if the watching hasn't started yet, no need to cancel */
-        if (w->watch_f) {
-            if (flux_kvs_lookup_cancel (w->watch_f) < 0)
-                flux_log_error (ctx->h, "%s: flux_kvs_lookup_cancel",
-                                __FUNCTION__);
+        /* if the watching hasn't started yet, the access check
+         * continuation completes the cancellation */
+        if (!w->src) {
+            w->canceled = true;
+            w->cancel = cancel;
+            return;
         }
+        if (cancel)
+            watch_respond_error (w, ENODATA, NULL);
+        watch_remove (w);
     }
 }
 
@@ -451,10 +724,10 @@ void watchers_cancel (struct info_ctx *ctx, const flux_msg_t *msg, bool cancel)
 {
     struct watch_ctx *w;
 
-    w = zlist_first (ctx->watchers);
+    w = zlistx_first (ctx->watchers);
     while (w) {
-        send_kvs_watch_cancel (ctx, w, msg, cancel);
-        w = zlist_next (ctx->watchers);
+        watch_cancel (w, msg, cancel);
+        w = zlistx_next (ctx->watchers);
     }
 }
 
@@ -468,18 +741,21 @@ void watch_cancel_cb (flux_t *h, flux_msg_handler_t *mh,
 
 void watch_cleanup (struct info_ctx *ctx)
 {
+    struct watch_source *src;
     struct watch_ctx *w;
 
-    while ((w = zlist_pop (ctx->watchers))) {
-        if (w->watch_f) {
-            if (flux_kvs_lookup_cancel (w->watch_f) < 0)
+    while ((w = zlistx_detach (ctx->watchers, NULL))) {
+        watch_respond_error (w, ENOSYS, NULL);
+        watch_ctx_destroy (w);
+    }
+    zhashx_purge (ctx->index_ws);
+    while ((src = zlistx_detach (ctx->watch_sources, NULL))) {
+        if (!src->stopped) {
+            if (flux_kvs_lookup_cancel (src->watch_f) < 0)
                 flux_log_error (ctx->h, "%s: flux_kvs_lookup_cancel",
                                 __FUNCTION__);
         }
-        if (flux_respond_error (ctx->h, w->msg, ENOSYS, NULL) < 0)
-            flux_log_error (ctx->h, "%s: flux_respond_error",
-                            __FUNCTION__);
-        watch_ctx_destroy (w);
+        watch_source_destroy (src);
     }
 }
 
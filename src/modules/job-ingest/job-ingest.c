@@ -13,6 +13,7 @@
 #endif
 #include <time.h>
 #include <unistd.h>
+#include <sys/uio.h>
 #include <jansson.h>
 #include <flux/core.h>
 #if HAVE_FLUX_SECURITY
@@ -24,14 +25,20 @@
 #include "src/common/libutil/fluid.h"
 #include "src/common/libutil/jpath.h"
 #include "src/common/libutil/errprintf.h"
+#include "src/common/libutil/errno_safe.h"
 #include "src/common/libutil/parse_size.h"
+#include "src/common/libutil/monotime.h"
 #include "src/common/libjob/job_hash.h"
+#include "src/common/libkvs/treeobj.h"
+#include "src/common/libcontent/content.h"
 #include "src/common/libfluxutil/policy.h"
+#include "src/common/libfluxutil/batcher.h"
 #include "ccan/str/str.h"
 
 #include "util.h"
 #include "job.h"
 #include "pipeline.h"
+#include "signcache.h"
 
 /* job-ingest takes in signed jobspec submitted through flux_job_submit(),
  * performing the following tasks for each job:
@@ -42,9 +49,9 @@
  * 4) commit job data to KVS per RFC 16 (KVS Job Schema)
  * 5) make "job-manager.submit" request announcing new jobid
  *
- * For performance, the above actions are batched, so that if job requests
- * arrive within the 'batch_timeout' window, they are combined into one
- * KVS transaction and one job-manager request.
+ * For performance, the above actions are batched, so that job requests
+ * that arrive while a batch is being committed are combined into one
+ * KVS transaction and one job-manager request (see libfluxutil/batcher.h).
  *
  * The jobid is returned to the user in response to the job-ingest.submit RPC.
  * Responses are sent after the job has been successfully ingested.
@@ -64,16 +71,22 @@
  * need to authenticate the signature.  It merely unwraps the contents,
  * and checks that the security envelope claims the same userid as the
  * userid stamped on the request message, which was authenticated by the
- * connector.
+ * connector.  Since a user's envelope header is the same from job to job,
+ * decoded headers are cached (see signcache.h).
  */
 
 
-/* The batch_timeout (seconds) is the maximum length of time
- * any given job request is delayed before initiating a KVS commit.
- * Too large, and individual job submit latency will suffer.
- * Too small, and KVS commit overhead will increase.
+/* A batch is committed as soon as no earlier batch is in flight, so a
+ * job submitted while idle is not delayed.  Under load, a batch grows
+ * while earlier ones are committed, up to these limits.
  */
-static const double batch_timeout = 0.01;
+static const int batch_max_count = 1024;
+static const size_t batch_max_bytes = 16 * 1024 * 1024;
+
+/* Maximum number of decoded J headers to cache, roughly one per active
+ * submitting user and signing mechanism.
+ */
+static const int signcache_max_size = 1024;
 
 /* There can be 2^14 FLUID generators per RFC 19.
  * Reserve the top 16 for future use.
@@ -89,13 +102,15 @@ struct job_ingest_ctx {
 #else
     void *sec;
 #endif
+    struct signcache *signcache;
     struct fluid_generator gen;
     flux_msg_handler_t **handlers;
+    const char *hash_name;
 
     struct batch *batch;
-    flux_watcher_t *timer;
+    struct batcher *batcher;
 
-    int batch_count;            // if nonzero, batch by count not timer
+    int batch_count;            // if nonzero, batch by count only
     const char *buffer_size;
 
     bool shutdown;
@@ -106,6 +121,9 @@ struct batch {
     flux_kvs_txn_t *txn;
     zlist_t *jobs;
     json_t *joblist;
+    zhashx_t *blobs;            // jobspec_ref => job, for jobspec blobs
+    bool flushed;
+    double t_start;
 };
 
 struct batch_response {
@@ -122,6 +140,8 @@ static void batch_destroy (struct batch *batch)
 {
     if (batch) {
         int saved_errno = errno;
+        if (batch->flushed)
+            batcher_commit_finish (batch->ctx->batcher, batch->t_start);
         if (batch->jobs) {
             struct job *job;
             while ((job = zlist_pop (batch->jobs)))
@@ -130,6 +150,7 @@ static void batch_destroy (struct batch *batch)
             json_decref (batch->joblist);
             flux_kvs_txn_destroy (batch->txn);
         }
+        zhashx_destroy (&batch->blobs);
         free (batch);
         errno = saved_errno;
     }
@@ -151,6 +172,10 @@ static struct batch *batch_create (struct job_ingest_ctx *ctx)
         goto error;
     if (!(batch->joblist = json_array ()))
         goto nomem;
+    if (!(batch->blobs = zhashx_new ()))
+        goto nomem;
+    zhashx_set_key_duplicator (batch->blobs, NULL);
+    zhashx_set_key_destructor (batch->blobs, NULL);
     batch->ctx = ctx;
     return batch;
 nomem:
@@ -261,6 +286,7 @@ static void batch_respond (struct batch *batch, struct batch_response *br)
     flux_t *h = batch->ctx->h;
     const char *errmsg;
     struct job *job = zlist_first (batch->jobs);
+    bool timing = flux_stats_enabled (h, NULL);
 
     if (br->batch_failed) {
         batch_respond_error (batch, br->errnum, br->errmsg);
@@ -272,8 +298,15 @@ static void batch_respond (struct batch *batch, struct batch_response *br)
             if (flux_respond_error (h, job->msg, EINVAL, errmsg) < 0)
                 flux_log_error (h, "batch_respond: flux_respond_error");
         }
-        else if (flux_respond_pack (h, job->msg, "{s:I}", "id", job->id) < 0)
-            flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
+        else {
+            if (flux_respond_pack (h, job->msg, "{s:I}", "id", job->id) < 0)
+                flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
+            if (timing) {
+                flux_stats_timing (h,
+                                   "job-ingest.submit",
+                                   monotime_since (job->t_recv));
+            }
+        }
         job = zlist_next (batch->jobs);
     }
 }
@@ -393,19 +426,13 @@ static void batch_flush_continuation (flux_future_t *f, void *arg)
     flux_future_destroy (f);
 }
 
-/*
- * Replace ctx->batch with a NULL, and pass 'batch' off to a chain of
- * continuations that commit its data to the KVS, respond to requestors,
- * and announce the new jobids.
+/* Commit the batch's KVS transaction.
  */
-static void batch_flush (struct job_ingest_ctx *ctx)
+static void batch_commit (struct batch *batch)
 {
-    struct batch *batch;
+    struct job_ingest_ctx *ctx = batch->ctx;
     flux_future_t *f;
 
-    batch = ctx->batch;
-    ctx->batch = NULL;
-
     if (!(f = flux_kvs_commit (ctx->h, NULL, 0, batch->txn))) {
         batch_respond_error (batch, errno, "flux_kvs_commit failed");
         goto error;
@@ -422,14 +449,86 @@ error:
     batch_destroy (batch);
 }
 
-/* batch timer - expires 'batch_timeout' seconds after batch was created.
+/* Jobspec blobs referenced by the KVS transaction have been stored.
  */
-static void batch_timer_cb (flux_reactor_t *r,
-                            flux_watcher_t *w,
-                            int revents,
-                            void *arg)
+static void batch_store_continuation (flux_future_t *f, void *arg)
 {
-    batch_flush ((struct job_ingest_ctx *) arg);
+    struct batch *batch = arg;
+
+    if (flux_rpc_get (f, NULL) < 0) {
+        batch_respond_error (batch, errno, "error storing jobspec");
+        batch_destroy (batch);
+    }
+    else
+        batch_commit (batch);
+    flux_future_destroy (f);
+}
+
+/* Store each distinct jobspec of the batch with one content.store-batch
+ * request, so the KVS transaction may refer to it by blobref.
+ */
+static flux_future_t *batch_store (struct batch *batch)
+{
+    struct iovec *iov;
+    struct job *job;
+    int count = 0;
+    flux_future_t *f;
+
+    if (!(iov = calloc (zhashx_size (batch->blobs), sizeof (iov[0]))))
+        return NULL;
+    job = zhashx_first (batch->blobs);
+    while (job) {
+        iov[count].iov_base = job->jobspec_enc;
+        iov[count].iov_len = strlen (job->jobspec_enc);
+        count++;
+        job = zhashx_next (batch->blobs);
+    }
+    f = content_store_batch (batch->ctx->h, iov, count);
+    ERRNO_SAFE_WRAP (free, iov);
+    return f;
+}
+
+/*
+ * Replace ctx->batch with a NULL, and pass 'batch' off to a chain of
+ * continuations that store jobspecs, commit its data to the KVS, respond
+ * to requestors, and announce the new jobids.
+ */
+static void batch_flush (struct job_ingest_ctx *ctx)
+{
+    struct batch *batch;
+    flux_future_t *f;
+
+    batch = ctx->batch;
+    ctx->batch = NULL;
+    batch->t_start = batcher_commit_start (ctx->batcher);
+    batch->flushed = true;
+
+    if (zhashx_size (batch->blobs) == 0) {
+        batch_commit (batch);
+        return;
+    }
+    if (!(f = batch_store (batch))) {
+        batch_respond_error (batch, errno, "error storing jobspec");
+        goto error;
+    }
+    if (flux_future_then (f, -1., batch_store_continuation, batch) < 0) {
+        batch_respond_error (batch, errno, "flux_future_then (content) failed");
+        flux_future_destroy (f);
+        goto error;
+    }
+    return;
+error:
+    batch_destroy (batch);
+}
+
+static void batcher_cb (struct batcher *b, void *arg)
+{
+    struct job_ingest_ctx *ctx = arg;
+
+    if (ctx->batch)
+        batch_flush (ctx);
+    else
+        batcher_reset (b);
 }
 
 /* Format key within the KVS directory of 'job'.
@@ -454,6 +553,36 @@ static double get_timestamp_now (void)
     return now;
 }
 
+/* Put the jobspec of 'job' to 'key' in the batch transaction.
+ * A jobspec too large to be stored in the KVS directory is put by
+ * reference to its blob, which is stored ahead of the commit by batch_flush().
+ * This spares the KVS from decoding and hashing it once per job when many
+ * identical jobs are submitted together.
+ */
+static int batch_put_jobspec (struct batch *batch, const char *key,
+                              struct job *job)
+{
+    json_t *valref;
+    char *s;
+    int rc;
+
+    if (job_encode_jobspec (job, batch->ctx->hash_name) < 0
+        || strlen (job->jobspec_enc) <= BLOBREF_MAX_STRING_SIZE) {
+        job_jobspec_changed (job);
+        return flux_kvs_txn_pack (batch->txn, 0, key, "O", job->jobspec);
+    }
+    if (!(valref = treeobj_create_valref (job->jobspec_ref)))
+        return -1;
+    if (!(s = treeobj_encode (valref))) {
+        json_decref (valref);
+        return -1;
+    }
+    rc = flux_kvs_txn_put_treeobj (batch->txn, 0, key, s);
+    ERRNO_SAFE_WRAP (free, s);
+    ERRNO_SAFE_WRAP (json_decref, valref);
+    return rc;
+}
+
 /* Add 'job' to 'batch'.
  * On error, ensure that no remnants of job made into KVS transaction.
  */
@@ -478,7 +607,7 @@ static int batch_add_job (struct batch *batch, struct job *job)
      * See also flux-framework/flux-core#4520
      */
     jpath_del (job->jobspec, "attributes.system.environment");
-    if (flux_kvs_txn_pack (batch->txn, 0, key, "O", job->jobspec) < 0)
+    if (batch_put_jobspec (batch, key, job) < 0)
         goto error;
     if (!(jobentry = json_pack ("{s:I s:I s:i s:f s:i, s:O}",
                                 "id", job->id,
@@ -492,6 +621,10 @@ static int batch_add_job (struct batch *batch, struct job *job)
         json_decref (jobentry);
         goto nomem;
     }
+    /* Identical jobspecs in the batch share one blob.
+     */
+    if (job->jobspec_enc && !zhashx_lookup (batch->blobs, job->jobspec_ref))
+        (void)zhashx_insert (batch->blobs, job->jobspec_ref, job);
     return 0;
 nomem:
     errno = ENOMEM;
@@ -510,22 +643,25 @@ static int ingest_add_job (struct job_ingest_ctx *ctx, struct job *job)
         return -1;
 
     /* Add job to the current "batch" of new jobs, creating the batch if
-     * one doesn't exist already.  Submit is finalized upon timer expiration.
+     * one doesn't exist already.  The batcher decides when it is flushed.
      */
     if (!ctx->batch) {
         if (!(ctx->batch = batch_create (ctx)))
             return -1;
-        if (!ctx->batch_count) {
-            flux_timer_watcher_reset (ctx->timer, batch_timeout, 0.);
-            flux_watcher_start (ctx->timer);
-        }
     }
     if (batch_add_job (ctx->batch, job) < 0)
         return -1;
 
-    if (ctx->batch_count
-        && zlist_size (ctx->batch->jobs) == ctx->batch_count)
-        batch_flush (ctx);
+    if (ctx->batch_count) {
+        if (zlist_size (ctx->batch->jobs) == ctx->batch_count)
+            batch_flush (ctx);
+    }
+    else {
+        size_t bytes = strlen (job->J);
+        if (job->jobspec_enc)
+            bytes += strlen (job->jobspec_enc);
+        batcher_add (ctx->batcher, 1, bytes);
+    }
     return 0;
 }
 
@@ -543,6 +679,7 @@ void pipeline_continuation (flux_future_t *f, void *arg)
         goto error;
     }
 
+    pipeline_job_validated (ctx->pipeline, job);
     if (ingest_add_job (ctx, job) < 0)
         goto error;
 
@@ -570,10 +707,14 @@ static void submit_cb (flux_t *h, flux_msg_handler_t *mh,
         errno = ENOSYS;
         goto error;
     }
-    if (!(job = job_create_from_request (msg, ctx->sec, &error))) {
+    if (!(job = job_create_from_request (msg,
+                                         ctx->sec,
+                                         ctx->signcache,
+                                         &error))) {
         errmsg = error.text;
         goto error;
     }
+    monotime (&job->t_recv);
     if (pipeline_process_job (ctx->pipeline, job, &f, &error) < 0) {
         errmsg = error.text;
         goto error;
@@ -760,16 +901,24 @@ static void stats_get_cb (flux_t *h,
 {
     struct job_ingest_ctx *ctx = arg;
     json_t *pstats = NULL;
+    json_t *bstats = NULL;
+    json_t *sstats = NULL;
 
     if (flux_request_decode (msg, NULL, NULL) < 0)
         goto error;
     pstats = pipeline_stats_get (ctx->pipeline);
+    bstats = batcher_stats (ctx->batcher);
+    sstats = signcache_stats (ctx->signcache);
     if (flux_respond_pack (h,
                            msg,
-                           "{s:O}",
-                           "pipeline", pstats) < 0)
+                           "{s:O s:O s:O}",
+                           "pipeline", pstats,
+                           "batch", bstats,
+                           "signcache", sstats) < 0)
         flux_log_error (h, "error responding to stats-get request");
     json_decref (pstats);
+    json_decref (bstats);
+    json_decref (sstats);
     return;
 error:
     if (flux_respond_error (h, msg, errno, NULL) < 0)
@@ -800,6 +949,11 @@ int job_ingest_ctx_init (struct job_ingest_ctx *ctx,
     /*  Default worker input buffer size is 10MB */
     ctx->buffer_size = "10M";
 
+    if (!(ctx->hash_name = flux_attr_get (h, "content.hash"))) {
+        flux_log_error (h, "getattr content.hash");
+        return -1;
+    }
+
     if (!(ctx->pipeline = pipeline_create (h))) {
         flux_log_error (h, "error initializing job preprocessing pipeline");
         return -1;
@@ -819,16 +973,19 @@ int job_ingest_ctx_init (struct job_ingest_ctx *ctx,
         return -1;
     }
 #endif
+    if (!(ctx->signcache = signcache_create (signcache_max_size))) {
+        flux_log_error (h, "error creating signature cache");
+        return -1;
+    }
     if (flux_msg_handler_addvec (h, htab, ctx, &ctx->handlers) < 0) {
         flux_log_error (h, "flux_msghandler_add");
         return -1;
     }
-    if (!(ctx->timer = flux_timer_watcher_create (r, 0., 0.,
-                                                  batch_timer_cb,
-                                                  ctx))) {
-        flux_log_error (h, "flux_timer_watcher_create");
+    if (!(ctx->batcher = batcher_create (r, batcher_cb, ctx))) {
+        flux_log_error (h, "error creating batcher");
         return -1;
     }
+    batcher_set_limits (ctx->batcher, batch_max_count, batch_max_bytes);
     return 0;
 }
 
@@ -918,10 +1075,11 @@ int mod_main (flux_t *h, int argc, char **argv)
     rc = 0;
 done:
     flux_msg_handler_delvec (ctx.handlers);
-    flux_watcher_destroy (ctx.timer);
+    batcher_destroy (ctx.batcher);
 #if HAVE_FLUX_SECURITY
     flux_security_destroy (ctx.sec);
 #endif
+    signcache_destroy (ctx.signcache);
     pipeline_destroy (ctx.pipeline);
     return rc;
 }
@@ -15,14 +15,9 @@
 #include <unistd.h>
 #include <jansson.h>
 #include <flux/core.h>
-#if HAVE_FLUX_SECURITY
-#include <flux/security/context.h>
-#include <flux/security/sign.h>
-#endif
 
 #include "src/common/libutil/errprintf.h"
 #include "src/common/libutil/errno_safe.h"
-#include "src/common/libjob/sign_none.h"
 #include "ccan/str/str.h"
 
 #include "job.h"
@@ -33,6 +28,7 @@ void job_destroy (struct job *job)
         int saved_errno = errno;
         flux_msg_decref (job->msg);
         json_decref (job->jobspec);
+        free (job->jobspec_enc);
         free (job);
         errno = saved_errno;
     }
@@ -50,13 +46,13 @@ static int valid_flags (int flags)
 
 struct job *job_create_from_request (const flux_msg_t *msg,
                                      void *security_context,
+                                     struct signcache *sc,
                                      flux_error_t *error)
 {
     struct job *job;
     int64_t userid_signer;
     const char *mech_type;
     json_error_t json_error;
-    const char *jobspec_str;
     int jobspec_strsize;
     char *jobspec_buf = NULL;
 
@@ -106,39 +102,21 @@ struct job *job_create_from_request (const flux_msg_t *msg,
                    "only the instance owner can submit with FLUX_JOB_WAITABLE");
         goto inval;
     }
-    /* Validate jobspec signature, and unwrap(J) -> jobspec_str, _strsize.
-     * Userid claimed by signature must match authenticated job->cred.userid.
-     * If not the instance owner, a strong signature is required
-     * to give the IMP permission to launch processes on behalf of the user.
-     */
-#if HAVE_FLUX_SECURITY
-    if (flux_sign_unwrap_anymech (security_context,
-                                  job->J,
-                                  (const void **)&jobspec_str,
-                                  &jobspec_strsize,
-                                  &mech_type,
-                                  &userid_signer,
-                                  FLUX_SIGN_NOVERIFY) < 0) {
-        errprintf (error, "%s", flux_security_last_error (security_context));
-        goto error;
-    }
-#else
-    uint32_t userid_signer_u32;
-    /* Simplified unwrap only understands mech=none.
-     * Unlike flux-security version, returned payload must be freed,
-     * and returned userid is a uint32_t.
+    /* Unwrap(J) -> jobspec_buf, _strsize.  The signature is verified
+     * by the IMP.  Userid claimed by signature must match authenticated
+     * job->cred.userid.  If not the instance owner, a strong signature
+     * is required to give the IMP permission to launch processes on
+     * behalf of the user.
      */
-    if (sign_none_unwrap (job->J,
-                          (void **)&jobspec_buf,
+    if (signcache_unwrap (sc,
+                          security_context,
+                          job->J,
+                          &jobspec_buf,
                           &jobspec_strsize,
-                          &userid_signer_u32) < 0) {
-        errprintf (error, "could not unwrap jobspec: %s", strerror (errno));
+                          &mech_type,
+                          &userid_signer,
+                          error) < 0)
         goto error;
-    }
-    jobspec_str = jobspec_buf;
-    mech_type = "none";
-    userid_signer = userid_signer_u32;
-#endif
     if (userid_signer != job->cred.userid) {
         errprintf (error,
                   "signer=%lu != requestor=%lu",
@@ -153,7 +131,7 @@ struct job *job_create_from_request (const flux_msg_t *msg,
         errno = EPERM;
         goto error;
     }
-    if (!(job->jobspec = json_loadb (jobspec_str,
+    if (!(job->jobspec = json_loadb (jobspec_buf,
                                      jobspec_strsize,
                                      0,
                                      &json_error))) {
@@ -191,4 +169,50 @@ json_t *job_json_object (struct job *job, flux_error_t *error)
     return o;
 }
 
+int job_encode_jobspec (struct job *job, const char *hashtype)
+{
+    json_t *system;
+    json_t *env = NULL;
+    char *s;
+
+    if (job->jobspec_enc)
+        return 0;
+    /* Set the environment aside temporarily rather than copying jobspec.
+     */
+    if ((system = json_object_get (json_object_get (job->jobspec,
+                                                    "attributes"),
+                                   "system"))
+        && (env = json_object_get (system, "environment"))) {
+        json_incref (env);
+        (void)json_object_del (system, "environment");
+    }
+    s = json_dumps (job->jobspec, JSON_COMPACT | JSON_SORT_KEYS);
+    if (env && json_object_set_new (system, "environment", env) < 0) {
+        json_decref (env);
+        free (s);
+        errno = ENOMEM;
+        return -1;
+    }
+    if (!s) {
+        errno = ENOMEM;
+        return -1;
+    }
+    if (blobref_hash (hashtype,
+                      s,
+                      strlen (s),
+                      job->jobspec_ref,
+                      sizeof (job->jobspec_ref)) < 0) {
+        ERRNO_SAFE_WRAP (free, s);
+        return -1;
+    }
+    job->jobspec_enc = s;
+    return 0;
+}
+
+void job_jobspec_changed (struct job *job)
+{
+    free (job->jobspec_enc);
+    job->jobspec_enc = NULL;
+}
+
 // vi:tabstop=4 shiftwidth=4 expandtab
@@ -11,9 +11,14 @@
 #ifndef _JOB_INGEST_JOB_H_
 #define _JOB_INGEST_JOB_H_
 
+#include <time.h>
 #include <jansson.h>
 #include <flux/core.h>
 
+#include "src/common/libutil/blobref.h"
+
+#include "signcache.h"
+
 struct job {
     flux_jobid_t id;
 
@@ -23,17 +28,36 @@ struct job {
     int urgency;        // requested job urgency
     int flags;          // submit flags
     json_t *jobspec;    // jobspec modified after unwrap from J
+
+    char *jobspec_enc;  // normalized jobspec without environment
+    char jobspec_ref[BLOBREF_MAX_STRING_SIZE]; // blobref of jobspec_enc
+
+    struct timespec t_recv; // when the submit request was received
 };
 
 
 void job_destroy (struct job *job);
 
+/* Decode a job-ingest.submit request and unwrap its J.  If 'sc' is
+ * non-NULL, decoded J headers are cached there.
+ */
 struct job *job_create_from_request (const flux_msg_t *msg,
                                      void *security_context,
+                                     struct signcache *sc,
                                      flux_error_t *error);
 
 json_t *job_json_object (struct job *job, flux_error_t *error);
 
+/* Encode job->jobspec without attributes.system.environment, with sorted
+ * keys, so that identical jobspecs have identical encodings, and compute
+ * its blobref with 'hashtype'.  The result is cached in job->jobspec_enc
+ * and job->jobspec_ref until job_jobspec_changed() is called.
+ * Returns 0 on success, -1 on failure with errno set.
+ */
+int job_encode_jobspec (struct job *job, const char *hashtype);
+
+void job_jobspec_changed (struct job *job);
+
 #endif /* !_JOB_INGEST_JOB_H */
 
 // vi:ts=4 sw=4 expandtab
@@ -16,6 +16,7 @@
 
 #include <flux/core.h>
 
+#include "src/common/libczmqcontainers/czmq_containers.h"
 #include "src/common/libutil/errprintf.h"
 #include "src/common/libutil/errno_safe.h"
 #include "ccan/str/str.h"
@@ -23,6 +24,7 @@
 #include "util.h"
 #include "workcrew.h"
 #include "pipeline.h"
+#include "validate.h"
 
 struct pipeline {
     flux_t *h;
@@ -31,12 +33,22 @@ struct pipeline {
     int process_count;
     flux_watcher_t *shutdown_timer;
     bool validator_bypass;
+    bool validator_native;
     bool frobnicate_enable;
+    int64_t native_validated;
+    int64_t native_deferred;
+    const char *hash_name;
+    zhashx_t *validated;        // blobrefs of jobspecs known to be valid
+    int64_t validated_hits;
 };
 
 static const char *cmd_validator = "job-validator";
 static const char *cmd_frobnicator = "job-frobnicator";
 
+/* Remember up to this many valid jobspecs.  The set is cleared when full.
+ */
+static const int validated_max = 8192;
+
 
 /* Timeout (seconds) to wait for workers to terminate when
  * stopped by closing their stdin.  If the timer expires, stop the reactor
@@ -88,6 +100,66 @@ static bool validator_bypass (struct pipeline *pl, struct job *job)
     return false;
 }
 
+/* The 'jobspec' plugin's verdict depends only on jobspec, so when it is
+ * the only validator and jobspec is not frobnicated, the blobrefs of valid
+ * jobspecs can be remembered.  The environment is excluded from the
+ * blobref, and it is only checked to be an object (if present).
+ */
+static bool validated_cacheable (struct pipeline *pl, struct job *job)
+{
+    json_t *env = NULL;
+
+    if (!pl->validator_native || pl->frobnicate_enable)
+        return false;
+    if (json_unpack (job->jobspec,
+                     "{s:{s:{s:o}}}",
+                     "attributes",
+                       "system",
+                         "environment", &env) == 0
+        && !json_is_object (env))
+        return false;
+    if (job_encode_jobspec (job, pl->hash_name) < 0)
+        return false;
+    return true;
+}
+
+static void validated_insert (struct pipeline *pl, struct job *job)
+{
+    if (zhashx_size (pl->validated) >= validated_max)
+        zhashx_purge (pl->validated);
+    (void)zhashx_insert (pl->validated, job->jobspec_ref, pl);
+}
+
+void pipeline_job_validated (struct pipeline *pl, struct job *job)
+{
+    if (validated_cacheable (pl, job))
+        validated_insert (pl, job);
+}
+
+/* If the validator is configured with only the default 'jobspec' plugin,
+ * try to validate the job in-process and skip the validator workcrew.
+ */
+static bool validate_job_native (struct pipeline *pl, struct job *job)
+{
+    bool cacheable;
+
+    if (!pl->validator_native)
+        return false;
+    cacheable = validated_cacheable (pl, job);
+    if (cacheable && zhashx_lookup (pl->validated, job->jobspec_ref)) {
+        pl->validated_hits++;
+        return true;
+    }
+    if (!validate_jobspec (job->jobspec)) {
+        pl->native_deferred++;
+        return false;
+    }
+    pl->native_validated++;
+    if (cacheable)
+        validated_insert (pl, job);
+    return true;
+}
+
 static flux_future_t *validate_job (struct pipeline *pl,
                                     struct job *job,
                                     flux_error_t *error)
@@ -149,8 +221,9 @@ static void frobnicate_continuation (flux_future_t *f1, void *arg)
     }
     json_decref (job->jobspec);
     job->jobspec = jobspec;
+    job_jobspec_changed (job);
 
-    if (!validator_bypass (pl, job)) {
+    if (!validator_bypass (pl, job) && !validate_job_native (pl, job)) {
         flux_future_t *f2;
 
         if (!(f2 = validate_job (pl, job, &error))) {
@@ -197,7 +270,7 @@ int pipeline_process_job (struct pipeline *pl,
     else {
         flux_future_t *f;
 
-        if (validator_bypass (pl, job))
+        if (validator_bypass (pl, job) || validate_job_native (pl, job))
             *fp = NULL;
         else {
             if (!(f = validate_job (pl, job, error)))
@@ -357,6 +430,14 @@ int pipeline_configure (struct pipeline *pl,
         goto error;
     }
 
+    /* The 'jobspec' plugin is the default when no plugins are configured.
+     * Its checks are duplicated in-process unless it has arguments.
+     */
+    pl->validator_native = (!validator_plugins
+                            || streq (validator_plugins, "jobspec"))
+                           && (!validator_args || strlen (validator_args) == 0);
+    zhashx_purge (pl->validated);
+
     // Checked for by t2111-job-ingest-config.t
     flux_log (pl->h,
               LOG_DEBUG,
@@ -389,9 +470,14 @@ json_t *pipeline_stats_get (struct pipeline *pl)
     if (pl) {
         json_t *fo = workcrew_stats_get (pl->frobnicate);
         json_t *vo = workcrew_stats_get (pl->validate);
-        o = json_pack ("{s:O s:O}",
+        o = json_pack ("{s:O s:O s:{s:b s:I s:I s:I}}",
                        "frobnicator", fo,
-                       "validator", vo);
+                       "validator", vo,
+                       "native",
+                         "enabled", pl->validator_native,
+                         "validated", pl->native_validated,
+                         "deferred", pl->native_deferred,
+                         "cache-hits", pl->validated_hits);
         json_decref (fo);
         json_decref (vo);
     }
@@ -405,6 +491,7 @@ void pipeline_destroy (struct pipeline *pl)
         workcrew_destroy (pl->validate);
         workcrew_destroy (pl->frobnicate);
         flux_watcher_destroy (pl->shutdown_timer);
+        zhashx_destroy (&pl->validated);
         free (pl);
         errno = saved_errno;
     }
@@ -418,6 +505,12 @@ struct pipeline *pipeline_create (flux_t *h)
     if (!(pl = calloc (1, sizeof (*pl))))
         return NULL;
     pl->h = h;
+    if (!(pl->hash_name = flux_attr_get (h, "content.hash")))
+        goto error;
+    if (!(pl->validated = zhashx_new ())) {
+        errno = ENOMEM;
+        goto error;
+    }
     if (!(pl->shutdown_timer = flux_timer_watcher_create (r,
                                                           0.,
                                                           0.,
@@ -33,6 +33,11 @@ int pipeline_process_job (struct pipeline *pl,
                           flux_future_t **fp,
                           flux_error_t *error);
 
+/* Notify the pipeline that the future from pipeline_process_job() was
+ * fulfilled successfully, so the result may be remembered.
+ */
+void pipeline_job_validated (struct pipeline *pl, struct job *job);
+
 json_t *pipeline_stats_get (struct pipeline *pl);
 
 #endif /* !_JOB_INGEST_PIPELINE_H */
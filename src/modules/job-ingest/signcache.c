@@ -0,0 +1,263 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* signcache.c - cache decoded J headers
+ *
+ * job-ingest unwraps J with FLUX_SIGN_NOVERIFY (the IMP verifies the
+ * signature at launch), so the per-job work is decoding the header and
+ * the payload.  The header is keyed by its encoded form, which covers
+ * every claim in it, so a hit yields exactly the userid and mechanism
+ * that decoding it again would.  A hit still checks that J is well formed
+ * and decodes the payload, which differs for every job.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <string.h>
+#include <jansson.h>
+#include <flux/core.h>
+#if HAVE_FLUX_SECURITY
+#include <flux/security/context.h>
+#include <flux/security/sign.h>
+#endif
+
+#include "src/common/libutil/errprintf.h"
+#include "src/common/libutil/errno_safe.h"
+#include "src/common/libutil/lru_cache.h"
+#include "src/common/libjob/sign_none.h"
+#include "ccan/base64/base64.h"
+#include "ccan/str/str.h"
+
+#include "signcache.h"
+
+struct signcache {
+    lru_cache_t *lru;           // encoded header => struct claims
+};
+
+struct claims {
+    int64_t userid;
+    char *mech_type;
+};
+
+static void claims_destroy (struct claims *c)
+{
+    if (c) {
+        int saved_errno = errno;
+        free (c->mech_type);
+        free (c);
+        errno = saved_errno;
+    }
+}
+
+static struct claims *claims_create (int64_t userid, const char *mech_type)
+{
+    struct claims *c;
+
+    if (!(c = calloc (1, sizeof (*c)))
+        || !(c->mech_type = strdup (mech_type))) {
+        claims_destroy (c);
+        return NULL;
+    }
+    c->userid = userid;
+    return c;
+}
+
+/* Decode J in full and return a malloc'd copy of the payload.
+ */
+static int unwrap_full (void *security_context,
+                        const char *J,
+                        char **payload,
+                        int *payloadsz,
+                        const char **mech_type,
+                        int64_t *userid,
+                        flux_error_t *error)
+{
+#if HAVE_FLUX_SECURITY
+    const void *buf;
+    int bufsz;
+    char *cpy;
+
+    if (flux_sign_unwrap_anymech (security_context,
+                                  J,
+                                  &buf,
+                                  &bufsz,
+                                  mech_type,
+                                  userid,
+                                  FLUX_SIGN_NOVERIFY) < 0) {
+        errprintf (error, "%s", flux_security_last_error (security_context));
+        return -1;
+    }
+    if (!(cpy = malloc (bufsz + 1))) {
+        errprintf (error, "out of memory decoding jobspec");
+        return -1;
+    }
+    memcpy (cpy, buf, bufsz);
+    cpy[bufsz] = '\0';
+    *payload = cpy;
+    *payloadsz = bufsz;
+#else
+    uint32_t userid_u32;
+    /* Simplified unwrap only understands mech=none.
+     * The returned userid is a uint32_t.
+     */
+    if (sign_none_unwrap (J, (void **)payload, payloadsz, &userid_u32) < 0) {
+        errprintf (error, "could not unwrap jobspec: %s", strerror (errno));
+        return -1;
+    }
+    *mech_type = "none";
+    *userid = userid_u32;
+#endif
+    return 0;
+}
+
+/* Decode only the payload of J, whose header has already been decoded
+ * to 'c'.  The signature is not verified, but it must be present, and
+ * must be "none" if the mechanism is.
+ */
+static int unwrap_payload (const char *payload_start,
+                           const struct claims *c,
+                           char **payload,
+                           int *payloadsz,
+                           flux_error_t *error)
+{
+    const char *sig;
+    size_t bufsz;
+    ssize_t len;
+    char *buf;
+
+    if (!(sig = strchr (payload_start, '.'))
+        || sig[1] == '\0'
+        || strchr (sig + 1, '.')
+        || (streq (c->mech_type, "none") && !streq (sig + 1, "none"))) {
+        errprintf (error, "could not unwrap jobspec: J is malformed");
+        errno = EINVAL;
+        return -1;
+    }
+    bufsz = base64_decoded_length (sig - payload_start) + 1;
+    if (!(buf = malloc (bufsz))) {
+        errprintf (error, "out of memory decoding jobspec");
+        return -1;
+    }
+    if ((len = base64_decode (buf,
+                              bufsz,
+                              payload_start,
+                              sig - payload_start)) < 0) {
+        free (buf);
+        errprintf (error, "could not unwrap jobspec: invalid payload");
+        errno = EINVAL;
+        return -1;
+    }
+    *payload = buf;
+    *payloadsz = len;
+    return 0;
+}
+
+int signcache_unwrap (struct signcache *sc,
+                      void *security_context,
+                      const char *J,
+                      char **payload,
+                      int *payloadsz,
+                      const char **mech_type,
+                      int64_t *userid,
+                      flux_error_t *error)
+{
+    const char *dot;
+    char *header = NULL;
+    struct claims *c;
+
+    if (!J || !payload || !payloadsz || !mech_type || !userid) {
+        errprintf (error, "could not unwrap jobspec: invalid argument");
+        errno = EINVAL;
+        return -1;
+    }
+    if (!sc || !(dot = strchr (J, '.')))
+        return unwrap_full (security_context,
+                            J,
+                            payload,
+                            payloadsz,
+                            mech_type,
+                            userid,
+                            error);
+    if (!(header = strndup (J, dot - J))) {
+        errprintf (error, "out of memory decoding jobspec");
+        return -1;
+    }
+    if ((c = lru_cache_get (sc->lru, header))) {
+        if (unwrap_payload (dot + 1, c, payload, payloadsz, error) < 0)
+            goto error;
+        *mech_type = c->mech_type;
+        *userid = c->userid;
+        free (header);
+        return 0;
+    }
+    if (unwrap_full (security_context,
+                     J,
+                     payload,
+                     payloadsz,
+                     mech_type,
+                     userid,
+                     error) < 0)
+        goto error;
+    /* Failing to cache the header is not an error.
+     */
+    if ((c = claims_create (*userid, *mech_type))
+        && lru_cache_put (sc->lru, header, c) < 0)
+        claims_destroy (c);
+    free (header);
+    return 0;
+error:
+    ERRNO_SAFE_WRAP (free, header);
+    return -1;
+}
+
+json_t *signcache_stats (struct signcache *sc)
+{
+    struct lru_cache_stats stats = { 0 };
+    json_t *o;
+
+    if (sc)
+        lru_cache_get_stats (sc->lru, &stats);
+    if (!(o = json_pack ("{s:i s:I s:I s:I}",
+                         "size", sc ? lru_cache_size (sc->lru) : 0,
+                         "hits", (json_int_t)stats.hits,
+                         "misses", (json_int_t)stats.misses,
+                         "evictions", (json_int_t)stats.evictions))) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    return o;
+}
+
+void signcache_destroy (struct signcache *sc)
+{
+    if (sc) {
+        int saved_errno = errno;
+        lru_cache_destroy (sc->lru);
+        free (sc);
+        errno = saved_errno;
+    }
+}
+
+struct signcache *signcache_create (int maxsize)
+{
+    struct signcache *sc;
+
+    if (!(sc = calloc (1, sizeof (*sc))))
+        return NULL;
+    if (!(sc->lru = lru_cache_create (maxsize))) {
+        signcache_destroy (sc);
+        return NULL;
+    }
+    lru_cache_set_free_f (sc->lru, (lru_cache_free_f)claims_destroy);
+    return sc;
+}
+
+// vi:tabstop=4 shiftwidth=4 expandtab
@@ -0,0 +1,50 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _JOB_INGEST_SIGNCACHE_H_
+#define _JOB_INGEST_SIGNCACHE_H_
+
+#include <stdint.h>
+#include <jansson.h>
+#include <flux/core.h>
+
+/* Cache of decoded J headers.
+ *
+ * J is HEADER.PAYLOAD.SIGNATURE.  The header carries the signer's userid,
+ * the signing mechanism, and any per-user credential material such as
+ * a public certificate, so it is the same for every job a user submits
+ * with a given mechanism.  Once a header has been decoded, later jobs
+ * with the same header only need their payload decoded.
+ */
+struct signcache *signcache_create (int maxsize);
+void signcache_destroy (struct signcache *sc);
+
+/* Unwrap J without verifying the signature.  On success, '*payload' is
+ * set to a malloc'd copy of the payload, which the caller must free,
+ * and '*mech_type' to a string that is valid until the next call.
+ * If 'sc' is NULL, J is always decoded in full.
+ * Returns 0 on success, -1 on failure with errno set and 'error' filled in.
+ */
+int signcache_unwrap (struct signcache *sc,
+                      void *security_context,
+                      const char *J,
+                      char **payload,
+                      int *payloadsz,
+                      const char **mech_type,
+                      int64_t *userid,
+                      flux_error_t *error);
+
+/* Return {"size":i "hits":i "misses":i "evictions":i}.
+ */
+json_t *signcache_stats (struct signcache *sc);
+
+#endif /* !_JOB_INGEST_SIGNCACHE_H */
+
+// vi:ts=4 sw=4 expandtab
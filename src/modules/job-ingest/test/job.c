@@ -61,7 +61,7 @@ void test_job_flags_guest (void *sec, const char *J_signed)
                         "urgency", FLUX_JOB_URGENCY_DEFAULT,
                         "flags", FLUX_JOB_WAITABLE);
     errno = 0;
-    if (!(job = job_create_from_request (msg, sec, &error)))
+    if (!(job = job_create_from_request (msg, sec, NULL, &error)))
         diag ("%s", error.text);
     ok (job == NULL && errno == EINVAL,
         "job_create_from_request flags=WAITABLE fails with EINVAL for guest");
@@ -76,7 +76,7 @@ void test_job_flags_guest (void *sec, const char *J_signed)
                         "urgency", FLUX_JOB_URGENCY_DEFAULT,
                         "flags", FLUX_JOB_NOVALIDATE);
     errno = 0;
-    if (!(job = job_create_from_request (msg, sec, &error)))
+    if (!(job = job_create_from_request (msg, sec, NULL, &error)))
         diag ("%s", error.text);
     ok (job == NULL && errno == EPERM,
         "job_create_from_request flags=NOVALIDATE fails with EPERM for guest");
@@ -96,7 +96,7 @@ void test_job_flags_owner (void *sec, const char *J_none)
                         "urgency", FLUX_JOB_URGENCY_DEFAULT,
                         "flags", 0xffff);
     errno = 0;
-    if (!(job = job_create_from_request (msg, sec, &error)))
+    if (!(job = job_create_from_request (msg, sec, NULL, &error)))
         diag ("%s", error.text);
     ok (job == NULL && errno == EPROTO,
         "job_create_from_request flags=0xffff fails with EPROTO");
@@ -108,7 +108,7 @@ void test_job_flags_owner (void *sec, const char *J_none)
                         "urgency", FLUX_JOB_URGENCY_DEFAULT,
                         "flags", FLUX_JOB_WAITABLE);
     errno = 0;
-    if (!(job = job_create_from_request (msg, sec, &error)))
+    if (!(job = job_create_from_request (msg, sec, NULL, &error)))
         diag ("%s", error.text);
     ok (job != NULL,
         "job_create_from_request flags=WAITABLE works for owner");
@@ -121,7 +121,7 @@ void test_job_flags_owner (void *sec, const char *J_none)
                         "urgency", FLUX_JOB_URGENCY_DEFAULT,
                         "flags", FLUX_JOB_NOVALIDATE);
     errno = 0;
-    if (!(job = job_create_from_request (msg, sec, &error)))
+    if (!(job = job_create_from_request (msg, sec, NULL, &error)))
         diag ("%s", error.text);
     ok (job != NULL,
         "job_create_from_request flags=NOVALIDATE works for owner");
@@ -143,7 +143,7 @@ void test_job_urgency_guest (void *sec, const char *J_signed)
                         "urgency", FLUX_JOB_URGENCY_MAX,
                         "flags", 0);
     errno = 0;
-    if (!(job = job_create_from_request (msg, sec, &error)))
+    if (!(job = job_create_from_request (msg, sec, NULL, &error)))
         diag ("%s", error.text);
     ok (job == NULL && errno == EINVAL,
         "job_create_from_request urgency=MAX fails with EINVAL for guest");
@@ -163,7 +163,7 @@ void test_job_urgency_owner (void *sec, const char *J_none)
                         "urgency", 9999,
                         "flags", 0);
     errno = 0;
-    if (!(job = job_create_from_request (msg, sec, &error)))
+    if (!(job = job_create_from_request (msg, sec, NULL, &error)))
         diag ("%s", error.text);
     ok (job == NULL && errno == EINVAL,
         "job_create_from_request urgency=9999 fails with EINVAL");
@@ -174,7 +174,7 @@ void test_job_urgency_owner (void *sec, const char *J_none)
                         "J", J_none,
                         "urgency", FLUX_JOB_URGENCY_MAX,
                         "flags", 0);
-    if (!(job = job_create_from_request (msg, sec, &error)))
+    if (!(job = job_create_from_request (msg, sec, NULL, &error)))
         diag ("%s", error.text);
     ok (job != NULL,
         "job_create_from_request urgency=MAX works for owner");
@@ -195,7 +195,7 @@ void test_job_basic_guest (void *sec, const char *J_signed, const char *J_none)
                         "J", J_signed,
                         "urgency", FLUX_JOB_URGENCY_DEFAULT,
                         "flags", 0);
-    if (!(job = job_create_from_request (msg, sec, &error)))
+    if (!(job = job_create_from_request (msg, sec, NULL, &error)))
         diag ("%s", error.text);
     ok (job != NULL,
         "job_create_from_request works for guest");
@@ -209,7 +209,7 @@ void test_job_basic_guest (void *sec, const char *J_signed, const char *J_none)
                         "urgency", FLUX_JOB_URGENCY_DEFAULT,
                         "flags", 0);
     errno = 0;
-    if (!(job = job_create_from_request (msg, sec, &error)))
+    if (!(job = job_create_from_request (msg, sec, NULL, &error)))
         diag ("%s", error.text);
     ok (job == NULL && errno == EPERM,
         "job_create_from_request sign_type=none fails for guest");
@@ -224,7 +224,7 @@ void test_job_basic_owner (void *sec, const char *J_none, const char *J_bad)
     json_t *o;
 
     errno = 0;
-    if (!(job = job_create_from_request (NULL, sec, &error)))
+    if (!(job = job_create_from_request (NULL, sec, NULL, &error)))
         diag ("%s", error.text);
     ok (job == NULL && errno == EINVAL,
         "job_create_from_request msg=NULL fails with EINVAL");
@@ -232,7 +232,7 @@ void test_job_basic_owner (void *sec, const char *J_none, const char *J_bad)
     if (!(msg = flux_request_encode ("topic", "xyz")))
         BAIL_OUT ("could not create message");
     errno = 0;
-    if (!(job = job_create_from_request (msg, sec, &error)))
+    if (!(job = job_create_from_request (msg, sec, NULL, &error)))
         diag ("%s", error.text);
     ok (job == NULL && errno == EPROTO,
         "job_create_from_request non-json-payload fails with EPROTO");
@@ -243,7 +243,7 @@ void test_job_basic_owner (void *sec, const char *J_none, const char *J_bad)
                         "J", J_none,
                         "urgency", FLUX_JOB_URGENCY_DEFAULT,
                         "flags", 0);
-    if (!(job = job_create_from_request (msg, sec, &error)))
+    if (!(job = job_create_from_request (msg, sec, NULL, &error)))
         diag ("%s", error.text);
     ok (job != NULL,
         "job_create_from_request works for owner");
@@ -274,7 +274,7 @@ void test_job_basic_owner (void *sec, const char *J_none, const char *J_bad)
     if (flux_msg_set_cred (msg, cred) < 0)
         BAIL_OUT ("could not override message cred");
     errno = 0;
-    if (!(job = job_create_from_request (msg, sec, &error)))
+    if (!(job = job_create_from_request (msg, sec, NULL, &error)))
         diag ("%s", error.text);
     ok (job == NULL && errno == EPERM,
         "job_create_from_request submitter != signer fails with EPERM");
@@ -286,7 +286,7 @@ void test_job_basic_owner (void *sec, const char *J_none, const char *J_bad)
                         "urgency", FLUX_JOB_URGENCY_DEFAULT,
                         "flags", 0);
     errno = 0;
-    if (!(job = job_create_from_request (msg, sec, &error)))
+    if (!(job = job_create_from_request (msg, sec, NULL, &error)))
         diag ("%s", error.text);
     ok (job == NULL && errno == EINVAL,
         "job_create_from_request J=damaged fails with EINVAL");
@@ -298,7 +298,7 @@ void test_job_basic_owner (void *sec, const char *J_none, const char *J_bad)
                         "urgency", FLUX_JOB_URGENCY_DEFAULT,
                         "flags", 0);
     errno = 0;
-    if (!(job = job_create_from_request (msg, sec, &error)))
+    if (!(job = job_create_from_request (msg, sec, NULL, &error)))
         diag ("%s", error.text);
     ok (job == NULL && errno == EINVAL,
         "job_create_from_request J=bad-contents fails with EINVAL");
@@ -0,0 +1,257 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <jansson.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#if HAVE_FLUX_SECURITY
+#include <flux/security/sign.h>
+#endif
+
+#include "src/common/libtap/tap.h"
+#include "src/common/libjob/sign_none.h"
+#include "ccan/str/str.h"
+
+#include "signcache.h"
+
+static char *wrap (const char *s, uint32_t userid)
+{
+    char *J;
+
+    if (!(J = sign_none_wrap (s, strlen (s), userid)))
+        BAIL_OUT ("sign_none_wrap failed");
+    return J;
+}
+
+static void check_stats (struct signcache *sc,
+                         int size,
+                         int hits,
+                         int misses,
+                         int evictions,
+                         const char *name)
+{
+    json_t *o;
+    int s, h, m, e;
+
+    if (!(o = signcache_stats (sc)))
+        BAIL_OUT ("signcache_stats failed");
+    ok (json_unpack (o,
+                     "{s:i s:i s:i s:i}",
+                     "size", &s,
+                     "hits", &h,
+                     "misses", &m,
+                     "evictions", &e) == 0
+        && s == size
+        && h == hits
+        && m == misses
+        && e == evictions,
+        "%s: size=%d hits=%d misses=%d evictions=%d",
+        name, size, hits, misses, evictions);
+    json_decref (o);
+}
+
+static void check_unwrap (struct signcache *sc,
+                          void *sec,
+                          const char *J,
+                          const char *expected,
+                          uint32_t expected_userid,
+                          const char *name)
+{
+    char *payload = NULL;
+    int payloadsz;
+    const char *mech_type = NULL;
+    int64_t userid;
+    flux_error_t error;
+    int rc;
+
+    rc = signcache_unwrap (sc,
+                           sec,
+                           J,
+                           &payload,
+                           &payloadsz,
+                           &mech_type,
+                           &userid,
+                           &error);
+    if (rc < 0)
+        diag ("%s", error.text);
+    ok (rc == 0
+        && payloadsz == strlen (expected)
+        && memcmp (payload, expected, payloadsz) == 0
+        && mech_type != NULL
+        && streq (mech_type, "none")
+        && userid == expected_userid,
+        "%s", name);
+    free (payload);
+}
+
+static void check_unwrap_fails (struct signcache *sc,
+                                void *sec,
+                                const char *J,
+                                const char *name)
+{
+    char *payload = NULL;
+    int payloadsz;
+    const char *mech_type;
+    int64_t userid;
+    flux_error_t error;
+    int rc;
+
+    errno = 0;
+    rc = signcache_unwrap (sc,
+                           sec,
+                           J,
+                           &payload,
+                           &payloadsz,
+                           &mech_type,
+                           &userid,
+                           &error);
+    if (rc < 0)
+        diag ("%s", error.text);
+    ok (rc < 0 && errno == EINVAL, "%s", name);
+    if (rc == 0)
+        free (payload);
+}
+
+static void test_basic (void *sec)
+{
+    struct signcache *sc;
+    uint32_t uid = getuid ();
+    char *J1 = wrap ("{\"a\":1}", uid);
+    char *J2 = wrap ("{\"b\":2}", uid);
+    char *J3 = wrap ("{\"c\":3}", uid + 1);
+    char *J_nosig;
+    char *J_badsig;
+    char *J_extra;
+
+    if (!(sc = signcache_create (16)))
+        BAIL_OUT ("signcache_create failed");
+    check_stats (sc, 0, 0, 0, 0, "new cache");
+
+    check_unwrap (sc, sec, J1, "{\"a\":1}", uid, "first J is unwrapped");
+    check_stats (sc, 1, 0, 1, 0, "first J");
+    check_unwrap (sc, sec, J2, "{\"b\":2}", uid,
+                  "second J from the same user is unwrapped");
+    check_stats (sc, 1, 1, 1, 0, "second J");
+    check_unwrap (sc, sec, J1, "{\"a\":1}", uid, "first J is unwrapped again");
+    check_unwrap (sc, sec, J3, "{\"c\":3}", uid + 1,
+                  "J from another user returns that user's userid");
+    check_stats (sc, 2, 2, 2, 0, "another user");
+
+    /* Damage J2 in ways that leave the cached header intact.
+     */
+    J_nosig = strdup (J2);
+    J_badsig = strdup (J2);
+    if (!J_nosig || !J_badsig
+        || asprintf (&J_extra, "%s.none", J2) < 0)
+        BAIL_OUT ("out of memory");
+    J_nosig[strlen (J_nosig) - 4] = '\0';
+    J_badsig[strlen (J_badsig) - 1] = 'x';
+    check_unwrap_fails (sc, sec, J_nosig,
+                        "cached header with empty signature fails");
+    check_unwrap_fails (sc, sec, J_badsig,
+                        "cached header with mech=none and bad signature fails");
+    check_unwrap_fails (sc, sec, J_extra,
+                        "cached header with extra field fails");
+
+    check_unwrap (NULL, sec, J1, "{\"a\":1}", uid,
+                  "unwrap works without a cache");
+    check_unwrap_fails (NULL, sec, J_nosig,
+                        "unwrap without a cache fails on bad J");
+
+    signcache_destroy (sc);
+    free (J_extra);
+    free (J_badsig);
+    free (J_nosig);
+    free (J3);
+    free (J2);
+    free (J1);
+}
+
+static void test_evict (void *sec)
+{
+    struct signcache *sc;
+    uint32_t uid = getuid ();
+    char *J[3];
+    int i;
+
+    if (!(sc = signcache_create (2)))
+        BAIL_OUT ("signcache_create failed");
+    for (i = 0; i < 3; i++) {
+        J[i] = wrap ("{}", uid + i);
+        check_unwrap (sc, sec, J[i], "{}", uid + i, "unwrap J for new user");
+    }
+    check_stats (sc, 2, 0, 3, 1, "cache with maxsize=2");
+    check_unwrap (sc, sec, J[0], "{}", uid,
+                  "J for evicted user is unwrapped");
+    for (i = 0; i < 3; i++)
+        free (J[i]);
+    signcache_destroy (sc);
+}
+
+static void test_badargs (void *sec)
+{
+    struct signcache *sc;
+    char *payload;
+    int payloadsz;
+    const char *mech_type;
+    int64_t userid;
+    flux_error_t error;
+
+    if (!(sc = signcache_create (16)))
+        BAIL_OUT ("signcache_create failed");
+    errno = 0;
+    ok (signcache_unwrap (sc,
+                          sec,
+                          NULL,
+                          &payload,
+                          &payloadsz,
+                          &mech_type,
+                          &userid,
+                          &error) < 0 && errno == EINVAL,
+        "signcache_unwrap J=NULL fails with EINVAL");
+    check_unwrap_fails (sc, sec, "foo", "signcache_unwrap J=foo fails");
+    check_stats (NULL, 0, 0, 0, 0, "NULL cache");
+    lives_ok ({signcache_destroy (NULL);},
+              "signcache_destroy NULL doesn't crash");
+    signcache_destroy (sc);
+}
+
+int main (int argc, char *argv[])
+{
+#if HAVE_FLUX_SECURITY
+    flux_security_t *sec;
+#else
+    void *sec = NULL;
+#endif
+
+    plan (NO_PLAN);
+
+#if HAVE_FLUX_SECURITY
+    if (!(sec = flux_security_create (0)))
+        BAIL_OUT ("flux_security_create: %s", strerror (errno));
+    if (flux_security_configure (sec, NULL) < 0)
+        BAIL_OUT ("security config %s", flux_security_last_error (sec));
+#endif
+
+    test_basic (sec);
+    test_evict (sec);
+    test_badargs (sec);
+
+#if HAVE_FLUX_SECURITY
+    flux_security_destroy (sec);
+#endif
+    done_testing ();
+}
+
+// vi:ts=4 sw=4 expandtab
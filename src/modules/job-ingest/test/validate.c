@@ -0,0 +1,148 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <jansson.h>
+#include <string.h>
+#include <errno.h>
+#include <flux/core.h>
+
+#include "src/common/libtap/tap.h"
+
+#include "validate.h"
+
+static json_t *jobspec_create (void)
+{
+    flux_jobspec1_t *js;
+    char *argv[] = { "hostname", NULL };
+    char *s = NULL;
+    json_t *o = NULL;
+
+    if (!(js = flux_jobspec1_from_command (1, argv, NULL, 2, 1, 0, 0, 0.))
+        || !(s = flux_jobspec1_encode (js, 0))
+        || !(o = json_loads (s, 0, NULL)))
+        BAIL_OUT ("could not create jobspec");
+    free (s);
+    flux_jobspec1_destroy (js);
+    return o;
+}
+
+static json_t *jobspec_with_constraint (const char *constraint)
+{
+    json_t *o = jobspec_create ();
+    json_t *c;
+
+    if (!(c = json_loads (constraint, 0, NULL))
+        || json_object_set_new (json_object_get (json_object_get (o,
+                                                 "attributes"),
+                                                 "system"),
+                                "constraints",
+                                c) < 0)
+        BAIL_OUT ("could not set constraints");
+    return o;
+}
+
+struct constraint_test {
+    const char *constraint;
+    bool valid;
+};
+
+static struct constraint_test constraint_tests[] = {
+    { "{}", true },
+    { "{\"properties\":[\"foo\",\"^bar\"]}", true },
+    { "{\"hostlist\":[\"host[0-3]\"]}", true },
+    { "{\"ranks\":[\"0-3,5\"]}", true },
+    { "{\"and\":[{\"properties\":[\"a\"]},{\"not\":[{\"ranks\":[\"1\"]}]}]}",
+      true },
+    { "{\"properties\":[\"a|b\"]}", false },
+    { "{\"properties\":[42]}", false },
+    { "{\"properties\":\"foo\"}", false },
+    { "{\"hostlist\":[\"host[0-\"]}", false },
+    { "{\"ranks\":[\"x\"]}", false },
+    { "{\"foo\":[\"bar\"]}", false },
+    { "{\"or\":[\"foo\"]}", false },
+    { "[]", false },
+    { NULL, false },
+};
+
+void test_constraints (void)
+{
+    for (int i = 0; constraint_tests[i].constraint != NULL; i++) {
+        json_t *o = jobspec_with_constraint (constraint_tests[i].constraint);
+        ok (validate_jobspec (o) == constraint_tests[i].valid,
+            "validate_jobspec constraints=%s returns %s",
+            constraint_tests[i].constraint,
+            constraint_tests[i].valid ? "true" : "false");
+        json_decref (o);
+    }
+}
+
+void test_jobspec (void)
+{
+    json_t *o;
+    json_t *tasks;
+
+    o = jobspec_create ();
+    ok (validate_jobspec (o) == true,
+        "validate_jobspec works on jobspec from flux_jobspec1_from_command");
+
+    if (json_object_set_new (o, "version", json_integer (2)) < 0)
+        BAIL_OUT ("could not set version");
+    ok (validate_jobspec (o) == false,
+        "validate_jobspec fails with version 2");
+    json_decref (o);
+
+    o = jobspec_create ();
+    if (json_object_set_new (o, "foo", json_integer (1)) < 0)
+        BAIL_OUT ("could not set foo");
+    ok (validate_jobspec (o) == false,
+        "validate_jobspec fails with extra top level key");
+    json_decref (o);
+
+    o = jobspec_create ();
+    tasks = json_object_get (o, "tasks");
+    if (json_array_append (tasks, json_array_get (tasks, 0)) < 0)
+        BAIL_OUT ("could not append task");
+    ok (validate_jobspec (o) == false,
+        "validate_jobspec fails with two tasks");
+    json_decref (o);
+
+    o = jobspec_create ();
+    if (json_object_del (json_object_get (json_object_get (o, "attributes"),
+                                          "system"),
+                         "duration") < 0)
+        BAIL_OUT ("could not delete duration");
+    ok (validate_jobspec (o) == false,
+        "validate_jobspec fails without duration");
+    json_decref (o);
+
+    o = json_pack ("{s:s}", "foo", "bar");
+    ok (validate_jobspec (o) == false,
+        "validate_jobspec fails on non-jobspec object");
+    json_decref (o);
+
+    ok (validate_jobspec (NULL) == false,
+        "validate_jobspec jobspec=NULL returns false");
+}
+
+int main (int argc, char *argv[])
+{
+    plan (NO_PLAN);
+
+    test_jobspec ();
+    test_constraints ();
+
+    done_testing ();
+    return 0;
+}
+
+// vi:ts=4 sw=4 expandtab
@@ -0,0 +1,121 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* validate.c - in-process jobspec validation
+ *
+ * The default job-validator plugin ('jobspec') validates RFC 25 jobspec
+ * with the Python Jobspec classes, which costs a round trip to a worker
+ * process per job.  Most jobspec can be checked here instead with
+ * flux_jobspec1_check(), which is stricter than the plugin, plus the
+ * RFC 31 constraint checks the plugin performs.  Jobspec that fails
+ * these checks is passed on to the plugin, so the plugin still decides
+ * which jobs are rejected and with what error.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <string.h>
+#include <jansson.h>
+#include <flux/core.h>
+#include <flux/idset.h>
+#include <flux/hostlist.h>
+
+#include "src/common/libjob/jobspec1.h"
+#include "src/common/libjob/jobspec1_private.h"
+#include "ccan/str/str.h"
+
+#include "validate.h"
+
+/* Constraints nested deeper than this are left to the plugin.
+ */
+static const int constraint_max_depth = 16;
+
+static bool constraint_check (json_t *constraint, int depth);
+
+static bool constraint_arg_check (const char *op, json_t *arg, int depth)
+{
+    const char *s;
+
+    if (streq (op, "and") || streq (op, "or") || streq (op, "not"))
+        return constraint_check (arg, depth + 1);
+    if (!(s = json_string_value (arg)))
+        return false;
+    if (streq (op, "properties"))
+        return strpbrk (s, "&'\"`|()") == NULL;
+    if (streq (op, "hostlist")) {
+        struct hostlist *hl;
+
+        if (!(hl = hostlist_decode (s)))
+            return false;
+        hostlist_destroy (hl);
+        return true;
+    }
+    if (streq (op, "ranks")) {
+        struct idset *ids;
+
+        if (!(ids = idset_decode (s)))
+            return false;
+        idset_destroy (ids);
+        return true;
+    }
+    return false;
+}
+
+static bool constraint_check (json_t *constraint, int depth)
+{
+    const char *op;
+    json_t *args;
+
+    if (depth > constraint_max_depth || !json_is_object (constraint))
+        return false;
+    json_object_foreach (constraint, op, args) {
+        size_t index;
+        json_t *arg;
+
+        if (!json_is_array (args))
+            return false;
+        json_array_foreach (args, index, arg) {
+            if (!constraint_arg_check (op, arg, depth))
+                return false;
+        }
+    }
+    return true;
+}
+
+bool validate_jobspec (json_t *jobspec)
+{
+    flux_jobspec1_t *js;
+    json_t *constraints = NULL;
+    bool valid = false;
+
+    if (!(js = jobspec1_from_json (jobspec)))
+        return false;
+    /* flux_jobspec1_check() only looks at the first entry of each array.
+     */
+    if (json_array_size (json_object_get (jobspec, "resources")) != 1
+        || json_array_size (json_object_get (jobspec, "tasks")) != 1
+        || flux_jobspec1_check (js, NULL) < 0)
+        goto done;
+    if (json_unpack (jobspec,
+                     "{s:{s:{s?o}}}",
+                     "attributes",
+                       "system",
+                         "constraints", &constraints) < 0)
+        goto done;
+    if (constraints && !constraint_check (constraints, 0))
+        goto done;
+    valid = true;
+done:
+    flux_jobspec1_destroy (js);
+    return valid;
+}
+
+// vi:ts=4 sw=4 expandtab
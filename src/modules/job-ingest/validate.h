@@ -0,0 +1,25 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _JOB_INGEST_VALIDATE_H_
+#define _JOB_INGEST_VALIDATE_H_
+
+#include <stdbool.h>
+#include <jansson.h>
+
+/* Return true if 'jobspec' passes the in-process V1 jobspec checks.
+ * The checks are at least as strict as the job-validator 'jobspec' plugin,
+ * so false means "ask the plugin", not necessarily "invalid".
+ */
+bool validate_jobspec (json_t *jobspec);
+
+#endif /* !_JOB_INGEST_VALIDATE_H */
+
+// vi:ts=4 sw=4 expandtab
@@ -0,0 +1,556 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* checkpoint.c - save job-list state so a reload need not replay history
+ *
+ * Jobs are saved in buckets of up to bucket_size jobs under
+ * checkpoint_dir.jobs.N, followed by checkpoint_dir.header, which
+ * records the journal sequence number, so a checkpoint without a
+ * header is incomplete and is ignored.
+ *
+ * Jobs are saved oldest first within each list, so that each restored
+ * job is inserted at the head of its sorted list.
+ *
+ * Compacted inactive jobs are saved with their strings.  Active jobs are
+ * saved with their jobspec and R, which are parsed again on restore as
+ * the events that brought the job to its current state would have.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <jansson.h>
+#include <flux/core.h>
+
+#include "src/common/libczmqcontainers/czmq_containers.h"
+#include "src/common/libutil/errno_safe.h"
+#include "src/common/libutil/errprintf.h"
+#include "src/common/libutil/grudgeset.h"
+#include "src/common/libjob/idf58.h"
+
+#include "job_state.h"
+#include "job_data.h"
+#include "checkpoint.h"
+
+#define CHECKPOINT_VERSION 1
+
+static const char *checkpoint_dir = "checkpoint.job-list";
+
+static const int bucket_size = 1000;        // max jobs per bucket
+static const int buckets_per_txn = 16;      // max buckets per commit
+static const int lookups_max = 8;           // max bucket lookups in flight
+
+static int set_string (json_t *o, const char *key, const char *s)
+{
+    json_t *val;
+
+    if (!s)
+        return 0;
+    if (!(val = json_string (s)) || json_object_set_new (o, key, val) < 0) {
+        json_decref (val);
+        return -1;
+    }
+    return 0;
+}
+
+static int set_object (json_t *o, const char *key, json_t *val)
+{
+    if (!val)
+        return 0;
+    return json_object_set (o, key, val);
+}
+
+static json_t *job_encode (struct job *job)
+{
+    json_t *o;
+
+    if (!(o = json_pack ("{s:I s:i s:i s:I s:f s:f s:f s:f s:f s:i s:i s:i"
+                         " s:i s:i s:i s:i s:f s:i s:f s:i s:b s:b s:i s:i}",
+                         "id", (json_int_t)job->id,
+                         "userid", (int)job->userid,
+                         "urgency", job->urgency,
+                         "priority", (json_int_t)job->priority,
+                         "t_submit", job->t_submit,
+                         "t_depend", job->t_depend,
+                         "t_run", job->t_run,
+                         "t_cleanup", job->t_cleanup,
+                         "t_inactive", job->t_inactive,
+                         "state", job->state,
+                         "states_mask", job->states_mask,
+                         "states_events_mask", job->states_events_mask,
+                         "submit_version", job->submit_version,
+                         "ntasks", job->ntasks,
+                         "ntasks_per_core_on_node_count",
+                         job->ntasks_per_core_on_node_count,
+                         "ncores", job->ncores,
+                         "duration", job->duration,
+                         "nnodes", job->nnodes,
+                         "expiration", job->expiration,
+                         "wait_status", job->wait_status,
+                         "success", job->success ? 1 : 0,
+                         "exception_occurred", job->exception_occurred ? 1 : 0,
+                         "exception_severity", job->exception_severity,
+                         "result", job->result)))
+        goto nomem;
+    if (set_object (o, "annotations", job->annotations) < 0
+        || set_object (o,
+                       "dependencies",
+                       grudgeset_tojson (job->dependencies)) < 0)
+        goto nomem;
+    if (job->pool) {
+        if (set_string (o, "name", job->name) < 0
+            || set_string (o, "queue", job->queue) < 0
+            || set_string (o, "cwd", job->cwd) < 0
+            || set_string (o, "project", job->project) < 0
+            || set_string (o, "bank", job->bank) < 0
+            || set_string (o, "exception_type", job->exception_type) < 0
+            || set_string (o, "exception_note", job->exception_note) < 0
+            || set_string (o, "ranks", job->ranks) < 0
+            || set_string (o, "nodelist", job->nodelist) < 0)
+            goto nomem;
+    }
+    else {
+        if (set_object (o, "jobspec", job->jobspec) < 0
+            || set_object (o, "R", job->R) < 0
+            || set_object (o, "exception_context", job->exception_context) < 0)
+            goto nomem;
+    }
+    return o;
+nomem:
+    json_decref (o);
+    errno = ENOMEM;
+    return NULL;
+}
+
+static int restore_strings (struct job *job,
+                            struct strpool *pool,
+                            json_t *o)
+{
+    const char *name = NULL;
+    const char *queue = NULL;
+    const char *cwd = NULL;
+    const char *project = NULL;
+    const char *bank = NULL;
+    const char *exception_type = NULL;
+    const char *exception_note = NULL;
+    const char *ranks = NULL;
+    const char *nodelist = NULL;
+
+    if (json_unpack (o,
+                     "{s?s s?s s?s s?s s?s s?s s?s s?s s?s}",
+                     "name", &name,
+                     "queue", &queue,
+                     "cwd", &cwd,
+                     "project", &project,
+                     "bank", &bank,
+                     "exception_type", &exception_type,
+                     "exception_note", &exception_note,
+                     "ranks", &ranks,
+                     "nodelist", &nodelist) < 0) {
+        errno = EPROTO;
+        return -1;
+    }
+    if ((ranks && !(job->ranks = strdup (ranks)))
+        || (nodelist && !(job->nodelist = strdup (nodelist))))
+        return -1;
+
+    /* Borrow the strings from 'o', then intern them as for any
+     * inactive job.
+     */
+    job->name = name;
+    job->queue = queue;
+    job->cwd = cwd;
+    job->project = project;
+    job->bank = bank;
+    job->exception_type = exception_type;
+    job->exception_note = exception_note;
+    if (job_compact (job, pool) < 0) {
+        job->name = job->queue = job->cwd = job->project = job->bank = NULL;
+        job->exception_type = job->exception_note = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+static int restore_parsed (struct job *job, json_t *o)
+{
+    json_t *jobspec = NULL;
+    json_t *R = NULL;
+    json_t *exception_context = NULL;
+
+    if (json_unpack (o,
+                     "{s?o s?o s?o}",
+                     "jobspec", &jobspec,
+                     "R", &R,
+                     "exception_context", &exception_context) < 0) {
+        errno = EPROTO;
+        return -1;
+    }
+    job->jobspec = json_incref (jobspec);
+    job->R = json_incref (R);
+    job->exception_context = json_incref (exception_context);
+
+    /* Updates were applied to jobspec and R in place, so parsing them
+     * again yields the same job data.  Errors were logged the first time.
+     */
+    if ((job->states_mask & FLUX_JOB_STATE_DEPEND) && job->jobspec)
+        (void)job_parse_jobspec_cached (job, NULL);
+    if ((job->states_mask & FLUX_JOB_STATE_RUN) && job->R)
+        (void)job_parse_R_cached (job, NULL);
+    if (job->exception_context)
+        (void)json_unpack (job->exception_context,
+                           "{s:s s:s}",
+                           "type", &job->exception_type,
+                           "note", &job->exception_note);
+    return 0;
+}
+
+static struct job *job_decode (struct job_state_ctx *jsctx, json_t *o)
+{
+    struct job *job;
+    json_int_t id;
+    json_int_t priority;
+    int userid;
+    int state;
+    int states_mask;
+    int states_events_mask;
+    int success;
+    int exception_occurred;
+    int result;
+    json_t *annotations = NULL;
+    json_t *deps = NULL;
+
+    if (json_unpack (o, "{s:I}", "id", &id) < 0) {
+        errno = EPROTO;
+        return NULL;
+    }
+    if (!(job = job_create (jsctx->h, id)))
+        return NULL;
+    if (json_unpack (o,
+                     "{s:i s:i s:I s:f s:f s:f s:f s:f s:i s:i s:i s:i"
+                     " s:i s:i s:i s:f s:i s:f s:i s:b s:b s:i s:i"
+                     " s?o s?o}",
+                     "userid", &userid,
+                     "urgency", &job->urgency,
+                     "priority", &priority,
+                     "t_submit", &job->t_submit,
+                     "t_depend", &job->t_depend,
+                     "t_run", &job->t_run,
+                     "t_cleanup", &job->t_cleanup,
+                     "t_inactive", &job->t_inactive,
+                     "state", &state,
+                     "states_mask", &states_mask,
+                     "states_events_mask", &states_events_mask,
+                     "submit_version", &job->submit_version,
+                     "ntasks", &job->ntasks,
+                     "ntasks_per_core_on_node_count",
+                     &job->ntasks_per_core_on_node_count,
+                     "ncores", &job->ncores,
+                     "duration", &job->duration,
+                     "nnodes", &job->nnodes,
+                     "expiration", &job->expiration,
+                     "wait_status", &job->wait_status,
+                     "success", &success,
+                     "exception_occurred", &exception_occurred,
+                     "exception_severity", &job->exception_severity,
+                     "result", &result,
+                     "annotations", &annotations,
+                     "dependencies", &deps) < 0) {
+        errno = EPROTO;
+        goto error;
+    }
+    job->userid = userid;
+    job->priority = priority;
+    job->state = state;
+    job->states_mask = states_mask;
+    job->states_events_mask = states_events_mask;
+    job->success = success ? true : false;
+    job->exception_occurred = exception_occurred ? true : false;
+    job->result = result;
+    job->annotations = json_incref (annotations);
+    if (deps) {
+        size_t index;
+        json_t *val;
+
+        json_array_foreach (deps, index, val) {
+            const char *s = json_string_value (val);
+            if (s && grudgeset_add (&job->dependencies, s) < 0)
+                goto error;
+        }
+    }
+    if (job->state == FLUX_JOB_STATE_INACTIVE
+        && !json_object_get (o, "jobspec")) {
+        if (restore_strings (job, jsctx->strings, o) < 0)
+            goto error;
+    }
+    else {
+        if (restore_parsed (job, o) < 0)
+            goto error;
+        if (job->state == FLUX_JOB_STATE_INACTIVE
+            && job_compact (job, jsctx->strings) < 0)
+            goto error;
+    }
+    return job;
+error:
+    job_destroy (job);
+    return NULL;
+}
+
+static int lookup_get_bucket (struct job_state_ctx *jsctx,
+                              flux_future_t *f,
+                              flux_error_t *errp)
+{
+    json_t *jobs;
+    size_t index;
+    json_t *o;
+
+    if (flux_kvs_lookup_get_unpack (f, "o", &jobs) < 0) {
+        errprintf (errp,
+                   "%s: %s",
+                   flux_kvs_lookup_get_key (f),
+                   future_strerror (f, errno));
+        return -1;
+    }
+    if (!json_is_array (jobs)) {
+        errprintf (errp, "%s: invalid bucket", flux_kvs_lookup_get_key (f));
+        errno = EPROTO;
+        return -1;
+    }
+    json_array_foreach (jobs, index, o) {
+        struct job *job;
+
+        if (!(job = job_decode (jsctx, o))) {
+            errprintf (errp,
+                       "%s: error decoding job: %s",
+                       flux_kvs_lookup_get_key (f),
+                       strerror (errno));
+            return -1;
+        }
+        if (job_state_restore_job (jsctx, job) < 0) {
+            errprintf (errp,
+                       "error restoring job %s: %s",
+                       idf58 (job->id),
+                       strerror (errno));
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static flux_future_t *lookup_bucket (flux_t *h, int id)
+{
+    char key[128];
+
+    snprintf (key, sizeof (key), "%s.jobs.%d", checkpoint_dir, id);
+    return flux_kvs_lookup (h, NULL, 0, key);
+}
+
+static void future_destructor (void **item)
+{
+    if (item) {
+        flux_future_destroy (*item);
+        *item = NULL;
+    }
+}
+
+int checkpoint_restore (struct job_state_ctx *jsctx,
+                        const struct checkpoint_header *hdr,
+                        flux_error_t *errp)
+{
+    zlistx_t *lookups;
+    flux_future_t *f;
+    int next = 0;
+    int rc = -1;
+
+    if (!(lookups = zlistx_new ())) {
+        errprintf (errp, "out of memory");
+        errno = ENOMEM;
+        return -1;
+    }
+    zlistx_set_destructor (lookups, future_destructor);
+
+    /* Keep a few lookups in flight, and restore buckets in order.
+     */
+    while (next < hdr->buckets || zlistx_size (lookups) > 0) {
+        while (next < hdr->buckets && zlistx_size (lookups) < lookups_max) {
+            if (!(f = lookup_bucket (jsctx->h, next))
+                || !zlistx_add_end (lookups, f)) {
+                errprintf (errp, "error sending lookup request");
+                flux_future_destroy (f);
+                goto done;
+            }
+            next++;
+        }
+        f = zlistx_first (lookups);
+        if (lookup_get_bucket (jsctx, f, errp) < 0)
+            goto done;
+        zlistx_delete (lookups, zlistx_cursor (lookups));
+    }
+    rc = 0;
+done:
+    ERRNO_SAFE_WRAP (zlistx_destroy, &lookups);
+    return rc;
+}
+
+int checkpoint_read_header (flux_t *h,
+                            struct checkpoint_header *hdr,
+                            flux_error_t *errp)
+{
+    char key[128];
+    flux_future_t *f;
+    int version;
+    json_int_t seq;
+
+    snprintf (key, sizeof (key), "%s.header", checkpoint_dir);
+    if (!(f = flux_kvs_lookup (h, NULL, 0, key))
+        || flux_kvs_lookup_get_unpack (f,
+                                       "{s:i s:I s:i s:i}",
+                                       "version", &version,
+                                       "seq", &seq,
+                                       "buckets", &hdr->buckets,
+                                       "count", &hdr->count) < 0) {
+        errprintf (errp, "%s: %s", key, future_strerror (f, errno));
+        goto error;
+    }
+    if (version != CHECKPOINT_VERSION || seq < 0 || hdr->buckets < 0) {
+        errprintf (errp, "%s: unsupported version %d", key, version);
+        errno = EINVAL;
+        goto error;
+    }
+    hdr->seq = seq;
+    flux_future_destroy (f);
+    return 0;
+error:
+    flux_future_destroy (f);
+    return -1;
+}
+
+static int commit_txn (flux_t *h, flux_kvs_txn_t *txn)
+{
+    flux_future_t *f;
+    int rc;
+
+    if (!(f = flux_kvs_commit (h, NULL, 0, txn)))
+        return -1;
+    rc = flux_future_get (f, NULL);
+    ERRNO_SAFE_WRAP (flux_future_destroy, f);
+    return rc;
+}
+
+struct saver {
+    flux_t *h;
+    flux_kvs_txn_t *txn;
+    json_t *bucket;
+    int buckets;
+    int count;
+};
+
+static int saver_flush_bucket (struct saver *sv)
+{
+    char key[128];
+
+    if (!sv->bucket || json_array_size (sv->bucket) == 0)
+        return 0;
+    snprintf (key, sizeof (key), "%s.jobs.%d", checkpoint_dir, sv->buckets);
+    if (flux_kvs_txn_pack (sv->txn, 0, key, "O", sv->bucket) < 0)
+        return -1;
+    json_decref (sv->bucket);
+    sv->bucket = NULL;
+    if (++sv->buckets % buckets_per_txn == 0) {
+        if (commit_txn (sv->h, sv->txn) < 0)
+            return -1;
+        flux_kvs_txn_destroy (sv->txn);
+        if (!(sv->txn = flux_kvs_txn_create ()))
+            return -1;
+    }
+    return 0;
+}
+
+static int saver_add (struct saver *sv, struct job *job)
+{
+    json_t *o;
+
+    if (!sv->bucket && !(sv->bucket = json_array ()))
+        goto nomem;
+    if (!(o = job_encode (job))
+        || json_array_append_new (sv->bucket, o) < 0) {
+        json_decref (o);
+        goto nomem;
+    }
+    sv->count++;
+    if (json_array_size (sv->bucket) == bucket_size)
+        return saver_flush_bucket (sv);
+    return 0;
+nomem:
+    errno = ENOMEM;
+    return -1;
+}
+
+static int saver_add_list (struct saver *sv, zlistx_t *l, bool reverse)
+{
+    struct job *job;
+
+    job = reverse ? zlistx_last (l) : zlistx_first (l);
+    while (job) {
+        if (saver_add (sv, job) < 0)
+            return -1;
+        job = reverse ? zlistx_prev (l) : zlistx_next (l);
+    }
+    return 0;
+}
+
+int checkpoint_save (struct job_state_ctx *jsctx, flux_error_t *errp)
+{
+    struct saver sv = { .h = jsctx->h };
+    char key[128];
+    int rc = -1;
+
+    /* Removing the old checkpoint and writing the new header go in
+     * separate commits, so a partly written checkpoint has no header.
+     */
+    if (!(sv.txn = flux_kvs_txn_create ())
+        || flux_kvs_txn_unlink (sv.txn, 0, checkpoint_dir) < 0
+        || saver_add_list (&sv, jsctx->processing, false) < 0
+        || saver_add_list (&sv, jsctx->pending, true) < 0
+        || saver_add_list (&sv, jsctx->running, true) < 0
+        || saver_add_list (&sv, jsctx->inactive, true) < 0
+        || saver_flush_bucket (&sv) < 0
+        || commit_txn (sv.h, sv.txn) < 0) {
+        errprintf (errp, "error saving jobs: %s", strerror (errno));
+        goto done;
+    }
+    flux_kvs_txn_destroy (sv.txn);
+    snprintf (key, sizeof (key), "%s.header", checkpoint_dir);
+    if (!(sv.txn = flux_kvs_txn_create ())
+        || flux_kvs_txn_pack (sv.txn,
+                              0,
+                              key,
+                              "{s:i s:I s:i s:i}",
+                              "version", CHECKPOINT_VERSION,
+                              "seq", (json_int_t)jsctx->seq,
+                              "buckets", sv.buckets,
+                              "count", sv.count) < 0
+        || commit_txn (sv.h, sv.txn) < 0) {
+        errprintf (errp, "error saving header: %s", strerror (errno));
+        goto done;
+    }
+    rc = 0;
+done:
+    ERRNO_SAFE_WRAP (json_decref, sv.bucket);
+    ERRNO_SAFE_WRAP (flux_kvs_txn_destroy, sv.txn);
+    return rc;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,50 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _FLUX_JOB_LIST_CHECKPOINT_H
+#define _FLUX_JOB_LIST_CHECKPOINT_H
+
+#include <stdint.h>
+#include <flux/core.h>
+
+struct job_state_ctx;
+
+/* The checkpoint holds every job known to job-list and the journal
+ * sequence number of the last event applied to them.  On load, the
+ * journal is resumed after that sequence number, and only if the job
+ * manager can resume it are the jobs restored.
+ */
+struct checkpoint_header {
+    uint64_t seq;
+    int buckets;
+    int count;
+};
+
+/* Look up the checkpoint header.  Fail with ENOENT if there is none.
+ */
+int checkpoint_read_header (flux_t *h,
+                            struct checkpoint_header *hdr,
+                            flux_error_t *errp);
+
+/* Restore the jobs described by 'hdr' into 'jsctx'.
+ */
+int checkpoint_restore (struct job_state_ctx *jsctx,
+                        const struct checkpoint_header *hdr,
+                        flux_error_t *errp);
+
+/* Replace the checkpoint with the current state of 'jsctx'.
+ */
+int checkpoint_save (struct job_state_ctx *jsctx, flux_error_t *errp);
+
+#endif /* ! _FLUX_JOB_LIST_CHECKPOINT_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
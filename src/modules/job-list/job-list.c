@@ -58,7 +58,14 @@ static void stats_cb (flux_t *h,
     int idsync_lookups = zlistx_size (ctx->isctx->lookups);
     int idsync_waits = zhashx_size (ctx->isctx->waits);
     int stats_watchers = job_stats_watchers (ctx->jsctx->statsctx);
-    if (flux_respond_pack (h, msg, "{s:{s:i s:i s:i} s:{s:i s:i} s:i}",
+    int watchers = watch_count (ctx->wctx);
+    int strings = strpool_count (ctx->jsctx->strings);
+    json_t *cache;
+
+    if (!(cache = job_cache_stats (ctx->jsctx->cache)))
+        goto error;
+    if (flux_respond_pack (h, msg,
+                           "{s:{s:i s:i s:i} s:{s:i s:i} s:i s:i s:o s:i}",
                            "jobs",
                            "pending", pending,
                            "running", running,
@@ -66,7 +73,10 @@ static void stats_cb (flux_t *h,
                            "idsync",
                            "lookups", idsync_lookups,
                            "waits", idsync_waits,
-                           "stats_watchers", stats_watchers) < 0)
+                           "stats_watchers", stats_watchers,
+                           "watchers", watchers,
+                           "cache", cache,
+                           "strings", strings) < 0)
         flux_log_error (h, "error responding to stats-get request");
     return;
 error:
@@ -91,13 +101,10 @@ static void purge_cb (flux_t *h,
         flux_jobid_t id = json_integer_value (entry);
         struct job *job;
 
-        if ((job = zhashx_lookup (ctx->jsctx->index, &id))) {
+        if ((job = jobmap_lookup (ctx->jsctx->index, id))) {
             if (job->state != FLUX_JOB_STATE_INACTIVE)
                 continue;
-            job_stats_purge (ctx->jsctx->statsctx, job);
-            if (job->list_handle)
-                zlistx_delete (ctx->jsctx->inactive, job->list_handle);
-            zhashx_delete (ctx->jsctx->index, &id);
+            job_state_purge_job (ctx->jsctx, job);
             count++;
         }
     }
@@ -122,6 +129,7 @@ static void disconnect_cb (flux_t *h,
 {
     struct list_ctx *ctx = arg;
     job_stats_disconnect (ctx->jsctx->statsctx, msg);
+    watch_disconnect (ctx->wctx, msg);
 }
 
 static void config_reload_cb (flux_t *h,
@@ -210,6 +218,7 @@ static void list_ctx_destroy (struct list_ctx *ctx)
         flux_msglist_destroy (ctx->deferred_requests);
         if (ctx->jsctx)
             job_state_destroy (ctx->jsctx);
+        watch_ctx_destroy (ctx->wctx);
         if (ctx->isctx)
             idsync_ctx_destroy (ctx->isctx);
         if (ctx->mctx)
@@ -231,6 +240,8 @@ static struct list_ctx *list_ctx_create (flux_t *h)
         goto error;
     if (!(ctx->isctx = idsync_ctx_create (ctx->h)))
         goto error;
+    if (!(ctx->wctx = watch_ctx_create (ctx)))
+        goto error;
     if (!(ctx->jsctx = job_state_create (ctx)))
         goto error;
     if (!(ctx->deferred_requests = flux_msglist_create ()))
@@ -254,6 +265,11 @@ int mod_main (flux_t *h, int argc, char **argv)
     }
     if (flux_reactor_run (flux_get_reactor (h), 0) < 0)
         goto done;
+    if (ctx->jsctx->initialized) {
+        flux_error_t error;
+        if (checkpoint_save (ctx->jsctx, &error) < 0)
+            flux_log (h, LOG_ERR, "checkpoint: %s", error.text);
+    }
     rc = 0;
 done:
     list_ctx_destroy (ctx);
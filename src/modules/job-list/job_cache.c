@@ -0,0 +1,214 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* job_cache.c - cache JSON objects of inactive jobs
+ *
+ * A signature is the compact encoding of an attrs array.  Signatures
+ * are interned so that a job's cached object can be checked against a
+ * request with a pointer comparison.  Only a few distinct signatures
+ * are kept, since in practice most requests come from a handful of
+ * tools, and requests with other attrs arrays are not cached.
+ *
+ * Cached jobs are kept on an LRU list, most recently used first.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdlib.h>
+#include <errno.h>
+#include <flux/core.h>
+
+#include "src/common/libczmqcontainers/czmq_containers.h"
+#include "src/common/libutil/errprintf.h"
+
+#include "job_cache.h"
+#include "job_util.h"
+
+#define CACHE_SIZE_DEFAULT      10000
+#define CACHE_SIGNATURES_MAX    8
+
+struct job_cache {
+    flux_t *h;
+    int size;
+    zhashx_t *signatures;       // signature => interned signature
+    zlistx_t *lru;
+    uint64_t hits;
+    uint64_t misses;
+};
+
+static void drop (struct job_cache *cache, struct job *job)
+{
+    zlistx_delete (cache->lru, job->cache_handle);
+    job->cache_handle = NULL;
+    json_decref (job->cache);
+    job->cache = NULL;
+    job->cache_sig = NULL;
+}
+
+static void trim (struct job_cache *cache)
+{
+    struct job *job;
+
+    while (zlistx_size (cache->lru) > cache->size
+           && (job = zlistx_tail (cache->lru)))
+        drop (cache, job);
+}
+
+static void signature_destructor (void **item)
+{
+    if (item) {
+        free (*item);
+        *item = NULL;
+    }
+}
+
+void job_cache_remove (struct job_cache *cache, struct job *job)
+{
+    if (cache && job && job->cache_handle)
+        drop (cache, job);
+}
+
+const char *job_cache_signature (struct job_cache *cache, json_t *attrs)
+{
+    char *s;
+    char *sig;
+
+    if (!cache || cache->size == 0)
+        return NULL;
+    if (!(s = json_dumps (attrs, JSON_COMPACT)))
+        return NULL;
+    if (!(sig = zhashx_lookup (cache->signatures, s))
+        && zhashx_size (cache->signatures) < CACHE_SIGNATURES_MAX) {
+        if (zhashx_insert (cache->signatures, s, s) == 0)
+            sig = s;
+        else
+            free (s);
+    }
+    else
+        free (s);
+    return sig;
+}
+
+json_t *job_cache_to_json (struct job_cache *cache,
+                           struct job *job,
+                           json_t *attrs,
+                           const char *sig,
+                           flux_error_t *errp)
+{
+    json_t *o;
+
+    if (!cache || !sig || job->state != FLUX_JOB_STATE_INACTIVE)
+        return job_to_json (job, attrs, errp);
+    if (job->cache && job->cache_sig == sig) {
+        zlistx_move_start (cache->lru, job->cache_handle);
+        cache->hits++;
+        return json_incref (job->cache);
+    }
+    if (!(o = job_to_json (job, attrs, errp)))
+        return NULL;
+    cache->misses++;
+    if (job->cache_handle)
+        zlistx_move_start (cache->lru, job->cache_handle);
+    else if (!(job->cache_handle = zlistx_add_start (cache->lru, job)))
+        return o; // not cached, but not an error
+    json_decref (job->cache);
+    job->cache = json_incref (o);
+    job->cache_sig = sig;
+    trim (cache);
+    return o;
+}
+
+json_t *job_cache_stats (struct job_cache *cache)
+{
+    json_t *o;
+
+    if (!(o = json_pack ("{s:i s:i s:I s:I}",
+                         "size", cache->size,
+                         "count", (int)zlistx_size (cache->lru),
+                         "hits", (json_int_t)cache->hits,
+                         "misses", (json_int_t)cache->misses))) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    return o;
+}
+
+int job_cache_config_reload (struct job_cache *cache,
+                             const flux_conf_t *conf,
+                             flux_error_t *errp)
+{
+    int size = CACHE_SIZE_DEFAULT;
+    flux_error_t error;
+
+    if (flux_conf_unpack (conf,
+                          &error,
+                          "{s?{s?i}}",
+                          "job-list",
+                            "cache_size", &size) < 0) {
+        errprintf (errp,
+                   "error reading config for job-list: %s",
+                   error.text);
+        return -1;
+    }
+    if (size < 0) {
+        errprintf (errp, "job-list.cache_size must be >= 0");
+        return -1;
+    }
+    cache->size = size;
+    trim (cache);
+    return 0;
+}
+
+void job_cache_destroy (struct job_cache *cache)
+{
+    if (cache) {
+        int saved_errno = errno;
+        struct job *job;
+        while ((job = zlistx_first (cache->lru)))
+            drop (cache, job);
+        zlistx_destroy (&cache->lru);
+        zhashx_destroy (&cache->signatures);
+        free (cache);
+        errno = saved_errno;
+    }
+}
+
+struct job_cache *job_cache_create (flux_t *h)
+{
+    struct job_cache *cache;
+    flux_error_t error;
+
+    if (!(cache = calloc (1, sizeof (*cache))))
+        return NULL;
+    cache->h = h;
+    if (!(cache->signatures = zhashx_new ())
+        || !(cache->lru = zlistx_new ()))
+        goto nomem;
+    /* The interned signature is both key and value.  zhashx duplicates
+     * the key, so free only the value.
+     */
+    zhashx_set_destructor (cache->signatures, signature_destructor);
+    if (job_cache_config_reload (cache, flux_get_conf (h), &error) < 0) {
+        flux_log (h, LOG_ERR, "%s", error.text);
+        errno = EINVAL;
+        goto error;
+    }
+    return cache;
+nomem:
+    errno = ENOMEM;
+error:
+    job_cache_destroy (cache);
+    return NULL;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
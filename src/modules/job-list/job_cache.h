@@ -0,0 +1,57 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _FLUX_JOB_LIST_JOB_CACHE_H
+#define _FLUX_JOB_LIST_JOB_CACHE_H
+
+#include <flux/core.h>
+#include <jansson.h>
+
+#include "job_data.h"
+
+/* Cache of the JSON objects built by job_to_json() for inactive jobs,
+ * which do not change.  Each job caches the object for one attrs array
+ * at a time, and the least recently used objects are dropped once
+ * more than job-list.cache_size jobs are cached.
+ */
+struct job_cache *job_cache_create (flux_t *h);
+void job_cache_destroy (struct job_cache *cache);
+
+int job_cache_config_reload (struct job_cache *cache,
+                             const flux_conf_t *conf,
+                             flux_error_t *errp);
+
+/* Return a signature for 'attrs' to pass to job_cache_to_json(), or
+ * NULL if objects for 'attrs' are not cached.  The signature is valid
+ * until the cache is destroyed.
+ */
+const char *job_cache_signature (struct job_cache *cache, json_t *attrs);
+
+/* Like job_to_json(), but return the cached object if 'job' is inactive
+ * and has one for 'sig', and cache the new one otherwise.  The caller
+ * must not modify the returned object.
+ */
+json_t *job_cache_to_json (struct job_cache *cache,
+                           struct job *job,
+                           json_t *attrs,
+                           const char *sig,
+                           flux_error_t *errp);
+
+/* Drop any cached object for 'job', e.g. when it is purged.
+ */
+void job_cache_remove (struct job_cache *cache, struct job *job);
+
+json_t *job_cache_stats (struct job_cache *cache);
+
+#endif /* ! _FLUX_JOB_LIST_JOB_CACHE_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -39,7 +39,18 @@ void job_destroy (void *data)
         grudgeset_destroy (job->dependencies);
         json_decref (job->jobspec);
         json_decref (job->R);
+        json_decref (job->R_summary);
         json_decref (job->exception_context);
+        json_decref (job->cache);
+        if (job->pool) {
+            strpool_release (job->pool, job->name);
+            strpool_release (job->pool, job->queue);
+            strpool_release (job->pool, job->cwd);
+            strpool_release (job->pool, job->project);
+            strpool_release (job->pool, job->bank);
+            strpool_release (job->pool, job->exception_type);
+            strpool_release (job->pool, job->exception_note);
+        }
         free (job);
         errno = save_errno;
     }
@@ -290,11 +301,9 @@ static int parse_jobspec_ntasks (struct job *job, struct jj_counts *jj)
         }
     }
 
-    if (json_unpack_ex (job->jobspec, NULL, 0,
-                        "{s:[{s:{s:i}}]}",
-                        "tasks",
-                        "count",
-                        "total", &job->ntasks) < 0)
+    if (jj->ntasks > 0)
+        job->ntasks = jj->ntasks;
+    else
         job->ntasks = jj->nslots;
     return 0;
 }
@@ -397,6 +406,50 @@ static int load_R (struct job *job, const char *s, bool allow_nonfatal)
     return 0;
 }
 
+/* Set values from the R summary computed by the job manager, avoiding
+ * the cost of building an rlist and encoding the nodelist for each job.
+ * Return -1 if the summary is not available or invalid.
+ */
+static int parse_R_summary (struct job *job)
+{
+    const char *ranks;
+    const char *nodelist;
+    int nnodes;
+    int ncores;
+    double expiration = 0.;
+    char *ranks_cpy;
+    char *nodelist_cpy;
+
+    if (!job->R_summary
+        || json_unpack (job->R_summary,
+                        "{s:i s:i s:s s:s}",
+                        "nnodes", &nnodes,
+                        "ncores", &ncores,
+                        "ranks", &ranks,
+                        "nodelist", &nodelist) < 0
+        || json_unpack (job->R,
+                        "{s:{s?F}}",
+                        "execution",
+                          "expiration", &expiration) < 0)
+        return -1;
+    if (!(ranks_cpy = strdup (ranks)))
+        return -1;
+    if (!(nodelist_cpy = strdup (nodelist))) {
+        free (ranks_cpy);
+        return -1;
+    }
+    job->expiration = expiration;
+    job->nnodes = nnodes;
+    free (job->ranks);
+    job->ranks = ranks_cpy;
+    free (job->nodelist);
+    job->nodelist = nodelist_cpy;
+    job->ncores = ncores;
+    if (job->ntasks_per_core_on_node_count > 0)
+        job->ntasks = ncores * job->ntasks_per_core_on_node_count;
+    return 0;
+}
+
 static int parse_R (struct job *job, bool allow_nonfatal)
 {
     struct rlist *rl = NULL;
@@ -409,6 +462,9 @@ static int parse_R (struct job *job, bool allow_nonfatal)
     int saved_errno, rc = -1;
     char *tmp;
 
+    if (parse_R_summary (job) == 0)
+        return 0;
+
     if (!(rl = rlist_from_json (job->R, &error))) {
         flux_log_error (job->h, "rlist_from_json: %s", error.text);
         goto nonfatal_error;
@@ -544,6 +600,75 @@ int job_R_update (struct job *job, json_t *updates)
     return parse_R (job, false);
 }
 
+static int intern (struct strpool *pool, const char **sp)
+{
+    if (*sp && !(*sp = strpool_intern (pool, *sp)))
+        return -1;
+    return 0;
+}
+
+int job_compact (struct job *job, struct strpool *pool)
+{
+    struct job tmp;
+
+    if (!job || !pool) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (job->pool)
+        return 0;
+
+    /* Intern into a copy so that on failure the job is left unchanged.
+     */
+    tmp = *job;
+    tmp.pool = pool;
+    if (intern (pool, &tmp.name) < 0
+        || intern (pool, &tmp.queue) < 0
+        || intern (pool, &tmp.cwd) < 0
+        || intern (pool, &tmp.project) < 0
+        || intern (pool, &tmp.bank) < 0
+        || intern (pool, &tmp.exception_type) < 0
+        || intern (pool, &tmp.exception_note) < 0)
+        goto error;
+
+    job->name = tmp.name;
+    job->queue = tmp.queue;
+    job->cwd = tmp.cwd;
+    job->project = tmp.project;
+    job->bank = tmp.bank;
+    job->exception_type = tmp.exception_type;
+    job->exception_note = tmp.exception_note;
+    job->pool = pool;
+
+    json_decref (job->jobspec);
+    job->jobspec = NULL;
+    json_decref (job->R);
+    job->R = NULL;
+    json_decref (job->R_summary);
+    job->R_summary = NULL;
+    json_decref (job->exception_context);
+    job->exception_context = NULL;
+    return 0;
+error:
+    /* release only the strings that were interned */
+    if (tmp.name != job->name)
+        strpool_release (pool, tmp.name);
+    if (tmp.queue != job->queue)
+        strpool_release (pool, tmp.queue);
+    if (tmp.cwd != job->cwd)
+        strpool_release (pool, tmp.cwd);
+    if (tmp.project != job->project)
+        strpool_release (pool, tmp.project);
+    if (tmp.bank != job->bank)
+        strpool_release (pool, tmp.bank);
+    if (tmp.exception_type != job->exception_type)
+        strpool_release (pool, tmp.exception_type);
+    if (tmp.exception_note != job->exception_note)
+        strpool_release (pool, tmp.exception_note);
+    errno = ENOMEM;
+    return -1;
+}
+
 /*
  * vi:tabstop=4 shiftwidth=4 expandtab
  */
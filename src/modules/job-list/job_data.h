@@ -17,6 +17,8 @@
 #include "src/common/libutil/grudgeset.h"
 #include "src/common/libczmqcontainers/czmq_containers.h"
 
+#include "strpool.h"
+
 /* timestamp of when we enter the state
  *
  * associated eventlog entries when restarting
@@ -68,6 +70,7 @@ struct job {
     /* cache of job information */
     json_t *jobspec;
     json_t *R;
+    json_t *R_summary;          /* from job manager, see parse_R() */
     json_t *exception_context;
 
     /* Track which states we have seen and have completed transition
@@ -77,8 +80,17 @@ struct job {
     unsigned int states_mask;
     unsigned int states_events_mask;
     void *list_handle;
+    void *index_handle[3];      /* see job_index.c */
+
+    /* see job_cache.c */
+    json_t *cache;
+    const char *cache_sig;
+    void *cache_handle;
 
     int submit_version;         /* version number in submit context */
+
+    /* set once job_compact() has moved strings into this pool */
+    struct strpool *pool;
 };
 
 void job_destroy (void *data);
@@ -115,6 +127,9 @@ int job_jobspec_update (struct job *job, json_t *updates);
  * - nodelist
  * - ncores
  * - ntasks (if necessary)
+ *
+ * If job->R_summary was set from the job manager's journal, nnodes,
+ * ranks, nodelist, and ncores are taken from it instead of R.
  */
 int job_parse_R (struct job *job, const char *s, json_t *updates);
 int job_parse_R_cached (struct job *job, json_t *updates);
@@ -129,6 +144,14 @@ int job_parse_R_fatal (struct job *job, const char *s, json_t *updates);
  */
 int job_R_update (struct job *job, json_t *updates);
 
+/* Release memory an inactive job no longer needs.  The name, queue,
+ * cwd, project, bank, and exception type and note strings are interned
+ * in 'pool', and the cached jobspec, R, and exception context they
+ * pointed into are dropped.  The job must not be parsed or updated
+ * after this call.
+ */
+int job_compact (struct job *job, struct strpool *pool);
+
 #endif /* ! _FLUX_JOB_LIST_JOB_DATA_H */
 
 /*
@@ -0,0 +1,281 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* job_index.c - secondary indexes of inactive jobs
+ *
+ * Only top level conjuncts of a constraint are considered when selecting
+ * an index, i.e. the constraint itself or the terms of a top level "and".
+ * A term qualifies if it names exactly one userid, one queue, or one
+ * result.  "or" and "not" terms are never used.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <flux/core.h>
+
+#include "ccan/str/str.h"
+
+#include "job_index.h"
+
+enum {
+    INDEX_USERID = 0,
+    INDEX_QUEUE = 1,
+    INDEX_RESULT = 2,
+    INDEX_COUNT = 3,
+};
+
+struct job_index {
+    zhashx_t *hash[INDEX_COUNT];    // key => zlistx_t of jobs
+    zlistx_t *empty;
+};
+
+#define NUMCMP(a,b) ((a)==(b)?0:((a)<(b)?-1:1))
+
+/* Same order as the inactive list: later t_inactive first.
+ */
+static int job_inactive_cmp (const void *a1, const void *a2)
+{
+    const struct job *j1 = a1;
+    const struct job *j2 = a2;
+
+    return NUMCMP (j2->t_inactive, j1->t_inactive);
+}
+
+static void list_destructor (void **item)
+{
+    if (item) {
+        zlistx_t *l = *item;
+        zlistx_destroy (&l);
+        *item = NULL;
+    }
+}
+
+static zlistx_t *list_create (void)
+{
+    zlistx_t *l;
+
+    if (!(l = zlistx_new ()))
+        return NULL;
+    zlistx_set_comparator (l, job_inactive_cmp);
+    return l;
+}
+
+/* Return the key of 'job' in index 'i' in 'buf', or NULL if the job
+ * does not belong in the index.
+ */
+static const char *job_key (struct job *job, int i, char *buf, size_t size)
+{
+    switch (i) {
+        case INDEX_USERID:
+            snprintf (buf, size, "%u", (unsigned int)job->userid);
+            return buf;
+        case INDEX_QUEUE:
+            return job->queue;
+        case INDEX_RESULT:
+            snprintf (buf, size, "%d", (int)job->result);
+            return buf;
+    }
+    return NULL;
+}
+
+int job_index_add (struct job_index *idx, struct job *job)
+{
+    char buf[32];
+    int i;
+
+    for (i = 0; i < INDEX_COUNT; i++) {
+        const char *key;
+        zlistx_t *l;
+
+        if (job->index_handle[i]
+            || !(key = job_key (job, i, buf, sizeof (buf))))
+            continue;
+        if (!(l = zhashx_lookup (idx->hash[i], key))) {
+            if (!(l = list_create ()))
+                goto nomem;
+            (void)zhashx_insert (idx->hash[i], key, l);
+        }
+        if (!(job->index_handle[i] = zlistx_insert (l, job, true)))
+            goto nomem;
+    }
+    return 0;
+nomem:
+    job_index_remove (idx, job);
+    errno = ENOMEM;
+    return -1;
+}
+
+void job_index_remove (struct job_index *idx, struct job *job)
+{
+    char buf[32];
+    int i;
+
+    for (i = 0; i < INDEX_COUNT; i++) {
+        const char *key;
+        zlistx_t *l;
+
+        if (!job->index_handle[i])
+            continue;
+        if ((key = job_key (job, i, buf, sizeof (buf)))
+            && (l = zhashx_lookup (idx->hash[i], key))) {
+            zlistx_detach (l, job->index_handle[i]);
+            if (zlistx_size (l) == 0)
+                zhashx_delete (idx->hash[i], key);
+        }
+        job->index_handle[i] = NULL;
+    }
+}
+
+/* If 'values' holds exactly one result, by name or as a single bit,
+ * set 'result' and return 0.  Otherwise return -1.
+ */
+static int single_result (json_t *values, int *result)
+{
+    json_t *entry = json_array_get (values, 0);
+    flux_job_result_t r;
+
+    if (json_array_size (values) != 1)
+        return -1;
+    if (json_is_string (entry)) {
+        if (flux_job_strtoresult (json_string_value (entry), &r) < 0)
+            return -1;
+        *result = r;
+        return 0;
+    }
+    if (json_is_integer (entry)) {
+        json_int_t val = json_integer_value (entry);
+        if (val <= 0 || (val & (val - 1)) != 0)
+            return -1;
+        *result = val;
+        return 0;
+    }
+    return -1;
+}
+
+/* Return the index list for term 'key':'values' in 'best' if it
+ * is shorter than the current one.
+ */
+static void select_term (struct job_index *idx,
+                         const char *op,
+                         json_t *values,
+                         zlistx_t **best)
+{
+    json_t *entry = json_array_get (values, 0);
+    char buf[32];
+    const char *key;
+    int i;
+    zlistx_t *l;
+
+    if (!json_is_array (values) || json_array_size (values) != 1)
+        return;
+    if (streq (op, "userid")) {
+        if (!json_is_integer (entry)
+            || (uint32_t)json_integer_value (entry) == FLUX_USERID_UNKNOWN)
+            return;
+        snprintf (buf, sizeof (buf), "%u",
+                  (unsigned int)json_integer_value (entry));
+        key = buf;
+        i = INDEX_USERID;
+    }
+    else if (streq (op, "queue")) {
+        if (!(key = json_string_value (entry)))
+            return;
+        i = INDEX_QUEUE;
+    }
+    else if (streq (op, "results")) {
+        int result;
+        if (single_result (values, &result) < 0)
+            return;
+        snprintf (buf, sizeof (buf), "%d", result);
+        key = buf;
+        i = INDEX_RESULT;
+    }
+    else
+        return;
+    if (!(l = zhashx_lookup (idx->hash[i], key)))
+        l = idx->empty;
+    if (!*best || zlistx_size (l) < zlistx_size (*best))
+        *best = l;
+}
+
+static void select_object (struct job_index *idx,
+                           json_t *o,
+                           zlistx_t **best)
+{
+    const char *op;
+    json_t *values;
+
+    if (!json_is_object (o) || json_object_size (o) != 1)
+        return;
+    json_object_foreach (o, op, values) {
+        if (streq (op, "and")) {
+            size_t index;
+            json_t *entry;
+
+            if (!json_is_array (values))
+                return;
+            json_array_foreach (values, index, entry)
+                select_object (idx, entry, best);
+        }
+        else
+            select_term (idx, op, values, best);
+    }
+}
+
+zlistx_t *job_index_select (struct job_index *idx, json_t *constraint)
+{
+    zlistx_t *best = NULL;
+
+    if (idx && constraint)
+        select_object (idx, constraint, &best);
+    return best;
+}
+
+void job_index_destroy (struct job_index *idx)
+{
+    if (idx) {
+        int saved_errno = errno;
+        int i;
+        for (i = 0; i < INDEX_COUNT; i++)
+            zhashx_destroy (&idx->hash[i]);
+        zlistx_destroy (&idx->empty);
+        free (idx);
+        errno = saved_errno;
+    }
+}
+
+struct job_index *job_index_create (void)
+{
+    struct job_index *idx;
+    int i;
+
+    if (!(idx = calloc (1, sizeof (*idx))))
+        return NULL;
+    for (i = 0; i < INDEX_COUNT; i++) {
+        if (!(idx->hash[i] = zhashx_new ()))
+            goto nomem;
+        zhashx_set_destructor (idx->hash[i], list_destructor);
+    }
+    if (!(idx->empty = list_create ()))
+        goto nomem;
+    return idx;
+nomem:
+    job_index_destroy (idx);
+    errno = ENOMEM;
+    return NULL;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,48 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _FLUX_JOB_LIST_JOB_INDEX_H
+#define _FLUX_JOB_LIST_JOB_INDEX_H
+
+#include <jansson.h>
+
+#include "src/common/libczmqcontainers/czmq_containers.h"
+
+#include "job_data.h"
+
+/* Secondary indexes of inactive jobs by userid, queue, and result.
+ * Each index maps a key to a list of jobs sorted like the inactive
+ * list, so a query constrained to one userid, queue, or result can walk
+ * only the jobs that may match instead of all inactive jobs.
+ */
+struct job_index *job_index_create (void);
+void job_index_destroy (struct job_index *idx);
+
+/* Add 'job' to the indexes once its userid, queue, result, and t_inactive
+ * are final, i.e. when it becomes inactive.
+ */
+int job_index_add (struct job_index *idx, struct job *job);
+
+/* Remove 'job' from the indexes, e.g. when it is purged.
+ */
+void job_index_remove (struct job_index *idx, struct job *job);
+
+/* Return the smallest index list that contains every inactive job that
+ * can match 'constraint', or NULL if no index applies and the whole
+ * inactive list must be scanned.  Jobs on the returned list must still
+ * be checked against the full constraint.
+ */
+zlistx_t *job_index_select (struct job_index *idx, json_t *constraint);
+
+#endif /* ! _FLUX_JOB_LIST_JOB_INDEX_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
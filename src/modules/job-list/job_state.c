@@ -23,7 +23,8 @@
 #include "src/common/libutil/fsd.h"
 #include "src/common/libutil/jpath.h"
 #include "src/common/libutil/grudgeset.h"
-#include "src/common/libjob/job_hash.h"
+#include "src/common/libutil/errno_safe.h"
+#include "src/common/libjob/jobmap.h"
 #include "src/common/libjob/idf58.h"
 #include "src/common/libidset/idset.h"
 #include "ccan/str/str.h"
@@ -33,6 +34,7 @@
 #include "job_data.h"
 #include "idsync.h"
 #include "job_util.h"
+#include "watch.h"
 
 #define NUMCMP(a,b) ((a)==(b)?0:((a)<(b)?-1:1))
 
@@ -176,6 +178,8 @@ static int job_insert_list (struct job_state_ctx *jsctx,
     else { /* newstate == FLUX_JOB_STATE_INACTIVE */
         if (!(job->list_handle = zlistx_insert (jsctx->inactive, job, true)))
             goto enomem;
+        if (job_index_add (jsctx->inactive_index, job) < 0)
+            goto enomem;
     }
 
     return 0;
@@ -314,6 +318,13 @@ static void process_state_transition_update (struct job_state_ctx *jsctx,
             eventlog_inactive_complete (job);
 
         update_job_state_and_list (jsctx, job, state, timestamp);
+
+        if (state == FLUX_JOB_STATE_INACTIVE
+            && job_compact (job, jsctx->strings) < 0) {
+            flux_log_error (jsctx->h,
+                            "%s: error compacting inactive job",
+                            idf58 (job->id));
+        }
     }
 }
 
@@ -492,7 +503,7 @@ static int journal_submit_event (struct job_state_ctx *jsctx,
     if (!job) {
         if (!(job = job_create (jsctx->h, id)))
             return -1;
-        if (zhashx_insert (jsctx->index, &job->id, job) < 0) {
+        if (jobmap_insert (jsctx->index, job->id, job) < 0) {
             job_destroy (job);
             errno = EEXIST;
             return -1;
@@ -839,7 +850,8 @@ static int journal_process_event (struct job_state_ctx *jsctx,
                                   flux_jobid_t id,
                                   json_t *event,
                                   json_t *jobspec,
-                                  json_t *R)
+                                  json_t *R,
+                                  json_t *R_summary)
 {
     double timestamp;
     const char *name;
@@ -853,12 +865,14 @@ static int journal_process_event (struct job_state_ctx *jsctx,
         return -1;
     }
 
-    job = zhashx_lookup (jsctx->index, &id);
+    job = jobmap_lookup (jsctx->index, id);
     if (job) {
         if (!job->jobspec && jobspec)
             job->jobspec = json_incref (jobspec);
         if (!job->R && R)
             job->R = json_incref (R);
+        if (!job->R_summary && R_summary)
+            job->R_summary = json_incref (R_summary);
     }
 
     /* The "submit" event is now posted before the job transitions out of NEW
@@ -871,7 +885,7 @@ static int journal_process_event (struct job_state_ctx *jsctx,
             zlistx_detach (jsctx->processing, job->list_handle);
             job->list_handle = NULL;
         }
-        zhashx_delete (jsctx->index, &job->id);
+        jobmap_delete (jsctx->index, job->id);
         /* N.B. since invalid job ids are not released to the submitter, there
          * should be no pending ctx->isctx->lookups requests to clean up here.
          * A test in t2212-job-manager-plugins.t does query invalid ids, but
@@ -1003,23 +1017,53 @@ static int journal_process_events (struct job_state_ctx *jsctx,
     json_t *value;
     json_t *jobspec = NULL;
     json_t *R = NULL;
+    json_t *R_summary = NULL;
+    json_int_t seq = -1;
+    int purged = 0;
 
     if (flux_msg_unpack (msg,
-                        "{s:I s:o s?o s?o}",
+                        "{s:I s:o s?o s?o s?o s?I s?b}",
                         "id", &id,
                         "events", &events,
                         "jobspec", &jobspec,
-                        "R", &R) < 0)
+                        "R", &R,
+                        "R_summary", &R_summary,
+                        "seq", &seq,
+                        "purged", &purged) < 0)
         return -1;
     if (!json_is_array (events)) {
         errno = EPROTO;
         return -1;
     }
     json_array_foreach (events, index, value) {
-        if (journal_process_event (jsctx, id, value, jobspec, R) < 0)
+        if (journal_process_event (jsctx,
+                                   id,
+                                   value,
+                                   jobspec,
+                                   R,
+                                   R_summary) < 0)
             return -1;
     }
 
+    /* Purges are only sent when resuming from a checkpoint, in place of
+     * the job-purge-inactive events that were missed.
+     */
+    if (purged) {
+        struct job *job = jobmap_lookup (jsctx->index, id);
+        if (job && job->state == FLUX_JOB_STATE_INACTIVE)
+            job_state_purge_job (jsctx, job);
+    }
+    if (seq >= 0)
+        jsctx->seq = seq;
+
+    /* Send changes to job-list.watch streams, which are not accepted
+     * until the backlog has been processed.
+     */
+    if (jsctx->initialized)
+        watch_job_update (jsctx->ctx->wctx,
+                          id,
+                          jobmap_lookup (jsctx->index, id));
+
     return 0;
 }
 
@@ -1028,8 +1072,14 @@ static void job_events_journal_continuation (flux_future_t *f, void *arg)
     struct job_state_ctx *jsctx = arg;
     const flux_msg_t *msg;
     flux_jobid_t id;
-
-    if (flux_rpc_get_unpack (f, "{s:I}", "id", &id) < 0
+    json_int_t seq = -1;
+    int resumed = 0;
+
+    if (flux_rpc_get_unpack (f,
+                             "{s:I s?I s?b}",
+                             "id", &id,
+                             "seq", &seq,
+                             "resumed", &resumed) < 0
         || flux_future_get (f, (const void **)&msg) < 0) {
         if (errno == ENODATA) {
             flux_log (jsctx->h, LOG_INFO, "journal: EOF (exiting)");
@@ -1045,6 +1095,35 @@ static void job_events_journal_continuation (flux_future_t *f, void *arg)
      * as they arrive.
      */
     if (id == FLUX_JOBID_ANY) {
+        /* If the journal resumed after the checkpoint, the backlog holds
+         * only events since it was saved, so restore it first.
+         * Otherwise the backlog holds everything and it is not needed.
+         */
+        if (jsctx->have_checkpoint) {
+            if (resumed) {
+                flux_error_t error;
+                if (checkpoint_restore (jsctx,
+                                        &jsctx->checkpoint,
+                                        &error) < 0) {
+                    flux_log (jsctx->h,
+                              LOG_ERR,
+                              "checkpoint: %s",
+                              error.text);
+                    goto error;
+                }
+                flux_log (jsctx->h,
+                          LOG_INFO,
+                          "checkpoint: restored %d jobs",
+                          jsctx->checkpoint.count);
+            }
+            else {
+                flux_log (jsctx->h,
+                          LOG_INFO,
+                          "checkpoint: journal cannot be resumed,"
+                          " replaying backlog");
+            }
+            jsctx->have_checkpoint = false;
+        }
         while ((msg = flux_msglist_pop (jsctx->backlog))) {
             int rc = journal_process_events (jsctx, msg);
             flux_msg_decref (msg);
@@ -1053,6 +1132,8 @@ static void job_events_journal_continuation (flux_future_t *f, void *arg)
                 goto error;
             }
         }
+        if (seq >= 0)
+            jsctx->seq = seq;
         jsctx->initialized = true;
         requeue_deferred_requests (jsctx->ctx);
         flux_future_reset (f);
@@ -1082,17 +1163,29 @@ error:
 
 static flux_future_t *job_events_journal (struct job_state_ctx *jsctx)
 {
-    flux_future_t *f;
+    flux_future_t *f = NULL;
+    json_t *payload;
 
     /* Set full=true so that inactive jobs are included.
      * Don't set allow/deny so that we receive all events.
+     * With a checkpoint, ask to resume after its sequence number.
      */
+    if (!(payload = json_pack ("{s:b s:b}",
+                               "full", 1,
+                               "coalesce", 1))
+        || (jsctx->have_checkpoint
+            && json_object_set_new (payload,
+                                    "since",
+                                    json_integer (jsctx->checkpoint.seq)) < 0)) {
+        errno = ENOMEM;
+        goto error;
+    }
     if (!(f = flux_rpc_pack (jsctx->h,
                              "job-manager.events-journal",
                              FLUX_NODEID_ANY,
-                             FLUX_RPC_STREAMING,
-                             "{s:b}",
-                             "full", 1))
+                             FLUX_RPC_STREAMING | FLUX_RPC_CBOR,
+                             "O",
+                             payload))
         || flux_future_then (f,
                              -1,
                              job_events_journal_continuation,
@@ -1103,8 +1196,10 @@ static flux_future_t *job_events_journal (struct job_state_ctx *jsctx)
                   future_strerror (f, errno));
         goto error;
     }
+    json_decref (payload);
     return f;
 error:
+    ERRNO_SAFE_WRAP (json_decref, payload);
     flux_future_destroy (f);
     return NULL;
 }
@@ -1112,6 +1207,7 @@ error:
 struct job_state_ctx *job_state_create (struct list_ctx *ctx)
 {
     struct job_state_ctx *jsctx = NULL;
+    flux_error_t error;
 
     if (!(jsctx = calloc (1, sizeof (*jsctx)))) {
         flux_log_error (ctx->h, "calloc");
@@ -1125,9 +1221,9 @@ struct job_state_ctx *job_state_create (struct list_ctx *ctx)
      * contain desired sort of jobs.
      */
 
-    if (!(jsctx->index = job_hash_create ()))
+    if (!(jsctx->index = jobmap_create ()))
         goto error;
-    zhashx_set_destructor (jsctx->index, job_destroy_wrapper);
+    jobmap_set_destructor (jsctx->index, job_destroy_wrapper);
 
     if (!(jsctx->pending = zlistx_new ()))
         goto error;
@@ -1144,12 +1240,26 @@ struct job_state_ctx *job_state_create (struct list_ctx *ctx)
     if (!(jsctx->processing = zlistx_new ()))
         goto error;
 
+    if (!(jsctx->inactive_index = job_index_create ()))
+        goto error;
+
+    if (!(jsctx->cache = job_cache_create (jsctx->h)))
+        goto error;
+
+    if (!(jsctx->strings = strpool_create ()))
+        goto error;
+
     if (!(jsctx->statsctx = job_stats_ctx_create (jsctx->h)))
         goto error;
 
     if (!(jsctx->backlog = flux_msglist_create ()))
         goto error;
 
+    if (checkpoint_read_header (jsctx->h, &jsctx->checkpoint, &error) == 0)
+        jsctx->have_checkpoint = true;
+    else if (errno != ENOENT)
+        flux_log (jsctx->h, LOG_ERR, "checkpoint: %s", error.text);
+
     if (!(jsctx->events = job_events_journal (jsctx)))
         goto error;
 
@@ -1166,12 +1276,16 @@ void job_state_destroy (void *data)
     if (jsctx) {
         int saved_errno = errno;
         /* Destroy index last, as it is the one that will actually
-         * destroy the job objects */
+         * destroy the job objects, except for the string pool they
+         * may hold references on */
+        job_cache_destroy (jsctx->cache);
+        job_index_destroy (jsctx->inactive_index);
         zlistx_destroy (&jsctx->processing);
         zlistx_destroy (&jsctx->inactive);
         zlistx_destroy (&jsctx->running);
         zlistx_destroy (&jsctx->pending);
-        zhashx_destroy (&jsctx->index);
+        jobmap_destroy (jsctx->index);
+        strpool_destroy (jsctx->strings);
         job_stats_ctx_destroy (jsctx->statsctx);
         flux_msglist_destroy (jsctx->backlog);
         flux_future_destroy (jsctx->events);
@@ -1180,10 +1294,50 @@ void job_state_destroy (void *data)
     }
 }
 
+int job_state_restore_job (struct job_state_ctx *jsctx, struct job *job)
+{
+    flux_job_state_t state = job->state;
+
+    if (jobmap_insert (jsctx->index, job->id, job) < 0) {
+        job_destroy (job);
+        errno = EEXIST;
+        return -1;
+    }
+    if (state == FLUX_JOB_STATE_NEW) {
+        if (!(job->list_handle = zlistx_add_end (jsctx->processing, job)))
+            goto nomem;
+    }
+    else if (job_insert_list (jsctx, job, state) < 0)
+        goto nomem;
+
+    /* count the job as if it went from NEW straight to its state */
+    job->state = FLUX_JOB_STATE_NEW;
+    job_stats_update (jsctx->statsctx, job, state);
+    job->state = state;
+    return 0;
+nomem:
+    jobmap_delete (jsctx->index, job->id);
+    errno = ENOMEM;
+    return -1;
+}
+
+void job_state_purge_job (struct job_state_ctx *jsctx, struct job *job)
+{
+    watch_job_update (jsctx->ctx->wctx, job->id, NULL);
+    job_stats_purge (jsctx->statsctx, job);
+    job_index_remove (jsctx->inactive_index, job);
+    job_cache_remove (jsctx->cache, job);
+    if (job->list_handle)
+        zlistx_delete (jsctx->inactive, job->list_handle);
+    jobmap_delete (jsctx->index, job->id);
+}
+
 int job_state_config_reload (struct job_state_ctx *jsctx,
                              const flux_conf_t *conf,
                              flux_error_t *errp)
 {
+    if (job_cache_config_reload (jsctx->cache, conf, errp) < 0)
+        return -1;
     return job_stats_config_reload (jsctx->statsctx, conf, errp);
 }
 
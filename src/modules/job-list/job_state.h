@@ -15,8 +15,13 @@
 #include <jansson.h>
 
 #include "src/common/libczmqcontainers/czmq_containers.h"
+#include "src/common/libjob/jobmap.h"
 
 #include "idsync.h"
+#include "job_index.h"
+#include "job_cache.h"
+#include "strpool.h"
+#include "checkpoint.h"
 #include "stats.h"
 
 /* To handle the common case of user queries on job state, we will
@@ -34,17 +39,27 @@
  *
  * There is also an additional list `processing` that stores jobs that
  * cannot yet be stored on one of the lists above.
+ *
+ * Inactive jobs are also indexed by userid, queue, and result in
+ * `inactive_index`, so queries on those need not scan every inactive job.
  */
 
 struct job_state_ctx {
     flux_t *h;
     struct list_ctx *ctx;
 
-    zhashx_t *index;
+    struct jobmap *index;
     zlistx_t *pending;
     zlistx_t *running;
     zlistx_t *inactive;
     zlistx_t *processing;
+    struct job_index *inactive_index;
+
+    /* JSON objects of inactive jobs */
+    struct job_cache *cache;
+
+    /* strings shared by inactive jobs, see job_compact() */
+    struct strpool *strings;
 
     /*  Job statistics: */
     struct job_stats_ctx *statsctx;
@@ -56,6 +71,14 @@ struct job_state_ctx {
     /* stream of job events from the job-manager */
     flux_future_t *events;
 
+    /* journal sequence number of the last event applied */
+    uint64_t seq;
+
+    /* checkpoint to restore if the journal can be resumed after its
+     * sequence number, see checkpoint.c */
+    struct checkpoint_header checkpoint;
+    bool have_checkpoint;
+
     bool initialized;
 };
 
@@ -69,6 +92,15 @@ void job_state_pause_cb (flux_t *h, flux_msg_handler_t *mh,
 void job_state_unpause_cb (flux_t *h, flux_msg_handler_t *mh,
                            const flux_msg_t *msg, void *arg);
 
+/* Add a job restored from a checkpoint to the job lists and statistics.
+ * The job is destroyed on failure.
+ */
+int job_state_restore_job (struct job_state_ctx *jsctx, struct job *job);
+
+/* Remove an inactive job that has been purged.
+ */
+void job_state_purge_job (struct job_state_ctx *jsctx, struct job *job);
+
 int job_state_config_reload (struct job_state_ctx *jsctx,
                              const flux_conf_t *conf,
                              flux_error_t *errp);
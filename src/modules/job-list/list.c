@@ -13,6 +13,9 @@
 #if HAVE_CONFIG_H
 #include "config.h"
 #endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
 #include <jansson.h>
 #include <flux/core.h>
 #include <assert.h>
@@ -26,6 +29,7 @@
 #include "idsync.h"
 #include "list.h"
 #include "job_util.h"
+#include "job_cache.h"
 #include "job_data.h"
 #include "match.h"
 #include "state_match.h"
@@ -38,23 +42,178 @@ json_t *get_job_by_id (struct job_state_ctx *jsctx,
                        flux_job_state_t state,
                        bool *stall);
 
-/* Put jobs from list onto jobs array, breaking if max_entries has
- * been reached. Returns 1 if jobs array is full, 0 if continue, -1
- * one error with errno set:
+/* Lists in the order get_jobs() returns them.
+ */
+enum {
+    LIST_PENDING = 0,
+    LIST_RUNNING = 1,
+    LIST_INACTIVE = 2,
+    LIST_COUNT = 3,
+};
+
+/* A position in the job listing, after job 'id' on list 'list'.  The
+ * sort key of the job is kept, in case the job leaves the list before
+ * the listing resumes: 'priority' for the pending list, 't_run' for
+ * the running list, and 't_inactive' for the inactive list, in 't'.
+ *
+ * Cursors are passed to and from clients as opaque strings.
+ */
+struct list_cursor {
+    int list;
+    flux_jobid_t id;
+    int64_t priority;
+    double t;
+};
+
+static int list_of_state (flux_job_state_t state)
+{
+    if (state & FLUX_JOB_STATE_PENDING)
+        return LIST_PENDING;
+    if (state & FLUX_JOB_STATE_RUNNING)
+        return LIST_RUNNING;
+    if (state == FLUX_JOB_STATE_INACTIVE)
+        return LIST_INACTIVE;
+    return -1;
+}
+
+static void list_cursor_set (struct list_cursor *cursor,
+                             int list,
+                             const struct job *job)
+{
+    cursor->list = list;
+    cursor->id = job->id;
+    cursor->priority = job->priority;
+    if (list == LIST_RUNNING)
+        cursor->t = job->t_run;
+    else if (list == LIST_INACTIVE)
+        cursor->t = job->t_inactive;
+    else
+        cursor->t = 0.;
+}
+
+static void list_cursor_encode (const struct list_cursor *cursor,
+                                char *buf,
+                                size_t size)
+{
+    /* %a keeps timestamps exact */
+    snprintf (buf,
+              size,
+              "%d:%ju:%jd:%a",
+              cursor->list,
+              (uintmax_t)cursor->id,
+              (intmax_t)cursor->priority,
+              cursor->t);
+}
+
+static int list_cursor_decode (struct list_cursor *cursor, const char *s)
+{
+    char *endptr;
+
+    errno = 0;
+    cursor->list = strtol (s, &endptr, 10);
+    if (errno != 0
+        || *endptr != ':'
+        || cursor->list < 0
+        || cursor->list >= LIST_COUNT)
+        goto inval;
+    cursor->id = strtoull (endptr + 1, &endptr, 10);
+    if (errno != 0 || *endptr != ':')
+        goto inval;
+    cursor->priority = strtoll (endptr + 1, &endptr, 10);
+    if (errno != 0 || *endptr != ':')
+        goto inval;
+    cursor->t = strtod (endptr + 1, &endptr);
+    if (errno != 0 || *endptr != '\0')
+        goto inval;
+    return 0;
+inval:
+    errno = EINVAL;
+    return -1;
+}
+
+/* Return < 0 if 'job' sorts before 'cursor' on the cursor list, > 0 if
+ * after, and 0 if the order cannot be told from the sort key.
+ */
+static int list_cursor_cmp (const struct list_cursor *cursor,
+                            const struct job *job)
+{
+    if (cursor->list == LIST_PENDING) {
+        if (job->priority != cursor->priority)
+            return job->priority > cursor->priority ? -1 : 1;
+        if (job->id != cursor->id)
+            return job->id < cursor->id ? -1 : 1;
+        return 0;
+    }
+    else {
+        double t = cursor->list == LIST_RUNNING ? job->t_run
+                                                : job->t_inactive;
+        if (t != cursor->t)
+            return t > cursor->t ? -1 : 1;
+        return 0;
+    }
+}
+
+/* Return the first job on 'list' after 'cursor', and leave the list
+ * cursor there so zlistx_next() continues the listing.
+ *
+ * If the cursor job is still on 'list', resume right after it.
+ * Otherwise, skip jobs that sort before the cursor.  If the cursor job
+ * has since left the list, jobs that share its sort key may be
+ * repeated, but none are skipped.
+ */
+static struct job *list_seek (struct job_state_ctx *jsctx,
+                              zlistx_t *list,
+                              zlistx_t *home,
+                              const struct list_cursor *cursor)
+{
+    struct job *job;
+    void *tie = NULL;
+
+    if (list == home
+        && (job = jobmap_lookup (jsctx->index, cursor->id))
+        && job->list_handle
+        && list_of_state (job->state) == cursor->list) {
+        zlistx_seek (list, job->list_handle);
+        return zlistx_next (list);
+    }
+    job = zlistx_first (list);
+    while (job) {
+        int cmp = list_cursor_cmp (cursor, job);
+        if (cmp > 0)
+            break;
+        if (cmp == 0) {
+            if (job->id == cursor->id)
+                return zlistx_next (list);
+            if (!tie)
+                tie = zlistx_cursor (list);
+        }
+        job = zlistx_next (list);
+    }
+    if (tie)
+        return zlistx_seek (list, tie);
+    return job;
+}
+
+/* Put jobs from list onto jobs array, starting with 'job', breaking if
+ * max_entries has been reached.  Inactive job objects are taken from
+ * 'cache' for attrs signature 'sig'.  Set 'last' to the last job added.
+ * Returns 1 if jobs array is full, 0 if continue, -1 one error with
+ * errno set:
  *
  * ENOMEM - out of memory
  */
 int get_jobs_from_list (json_t *jobs,
                         flux_error_t *errp,
                         zlistx_t *list,
+                        struct job *job,
                         int max_entries,
                         json_t *attrs,
+                        struct job_cache *cache,
+                        const char *sig,
                         double since,
-                        struct list_constraint *c)
+                        struct list_constraint *c,
+                        struct job **last)
 {
-    struct job *job;
-
-    job = zlistx_first (list);
     while (job) {
         int ret;
 
@@ -73,13 +232,14 @@ int get_jobs_from_list (json_t *jobs,
             return -1;
         if (ret) {
             json_t *o;
-            if (!(o = job_to_json (job, attrs, errp)))
+            if (!(o = job_cache_to_json (cache, job, attrs, sig, errp)))
                 return -1;
             if (json_array_append_new (jobs, o) < 0) {
                 json_decref (o);
                 errno = ENOMEM;
                 return -1;
             }
+            *last = job;
             if (json_array_size (jobs) == max_entries)
                 return 1;
         }
@@ -91,10 +251,15 @@ int get_jobs_from_list (json_t *jobs,
 
 /* Create a JSON array of 'job' objects.  'max_entries' determines the
  * max number of jobs to return, 0=unlimited. 'since' limits jobs returned
- * to those with t_inactive greater than timestamp.  Returns JSON object
- * which the caller must free.  On error, return NULL with errno set:
+ * to those with t_inactive greater than timestamp.  'constraint' is
+ * used to select an inactive job index, if any.  If 'cursor' is non-NULL,
+ * the listing resumes after it.  If the array is full, a cursor for the
+ * next page is written to 'next', otherwise 'next' is set to the empty
+ * string.  Returns JSON object which the caller must free.  On error,
+ * return NULL with errno set:
  *
- * EPROTO - malformed or empty attrs array, max_entries out of range
+ * EPROTO - malformed or empty attrs array, max_entries out of range,
+ *          invalid cursor
  * ENOMEM - out of memory
  */
 json_t *get_jobs (struct job_state_ctx *jsctx,
@@ -102,53 +267,77 @@ json_t *get_jobs (struct job_state_ctx *jsctx,
                   int max_entries,
                   double since,
                   json_t *attrs,
+                  json_t *constraint,
                   struct list_constraint *c,
-                  struct state_constraint *statec)
+                  struct state_constraint *statec,
+                  const char *cursor,
+                  char *next,
+                  size_t next_size)
 {
     json_t *jobs = NULL;
+    struct list_cursor pos = {0};
+    struct job *last = NULL;
+    const char *sig;
     int saved_errno;
     int ret = 0;
+    int i;
+    struct {
+        flux_job_state_t state;
+        zlistx_t *home;
+        double since;
+    } lists[] = {
+        { FLUX_JOB_STATE_PENDING, jsctx->pending, 0. },
+        { FLUX_JOB_STATE_RUNNING, jsctx->running, 0. },
+        { FLUX_JOB_STATE_INACTIVE, jsctx->inactive, since },
+    };
+
+    next[0] = '\0';
+    if (cursor && list_cursor_decode (&pos, cursor) < 0) {
+        errprintf (errp, "invalid cursor");
+        errno = EPROTO;
+        return NULL;
+    }
 
     if (!(jobs = json_array ()))
         goto error_nomem;
 
+    sig = job_cache_signature (jsctx->cache, attrs);
+
     /* We return jobs in the following order, pending, running,
      * inactive */
 
-    if (state_match (FLUX_JOB_STATE_PENDING, statec)) {
+    for (i = 0; i < LIST_COUNT && !ret; i++) {
+        zlistx_t *list = lists[i].home;
+        struct job *job;
+
+        if (cursor && i < pos.list)
+            continue;
+        if (!state_match (lists[i].state, statec))
+            continue;
+        if (i == LIST_INACTIVE) {
+            zlistx_t *l;
+            if ((l = job_index_select (jsctx->inactive_index, constraint)))
+                list = l;
+        }
+        if (cursor && i == pos.list)
+            job = list_seek (jsctx, list, lists[i].home, &pos);
+        else
+            job = zlistx_first (list);
         if ((ret = get_jobs_from_list (jobs,
                                        errp,
-                                       jsctx->pending,
+                                       list,
+                                       job,
                                        max_entries,
                                        attrs,
-                                       0.,
-                                       c)) < 0)
+                                       jsctx->cache,
+                                       sig,
+                                       lists[i].since,
+                                       c,
+                                       &last)) < 0)
             goto error;
-    }
-
-    if (state_match (FLUX_JOB_STATE_RUNNING, statec)) {
-        if (!ret) {
-            if ((ret = get_jobs_from_list (jobs,
-                                           errp,
-                                           jsctx->running,
-                                           max_entries,
-                                           attrs,
-                                           0.,
-                                           c)) < 0)
-                goto error;
-        }
-    }
-
-    if (state_match (FLUX_JOB_STATE_INACTIVE, statec)) {
-        if (!ret) {
-            if ((ret = get_jobs_from_list (jobs,
-                                           errp,
-                                           jsctx->inactive,
-                                           max_entries,
-                                           attrs,
-                                           since,
-                                           c)) < 0)
-                goto error;
+        if (ret) {
+            list_cursor_set (&pos, i, last);
+            list_cursor_encode (&pos, next, next_size);
         }
     }
 
@@ -265,6 +454,8 @@ void list_cb (flux_t *h,
     double since = 0.;
     json_t *constraint = NULL;
     json_t *legacy_constraint = NULL;
+    const char *cursor = NULL;
+    char next[128];
     struct list_constraint *c = NULL;
     struct state_constraint *statec = NULL;
     flux_error_t error;
@@ -276,11 +467,12 @@ void list_cb (flux_t *h,
     }
     if (flux_request_unpack (msg,
                              NULL,
-                             "{s:i s:o s?F s?o}",
+                             "{s:i s:o s?F s?o s?s}",
                              "max_entries", &max_entries,
                              "attrs", &attrs,
                              "since", &since,
-                             "constraint", &constraint) < 0) {
+                             "constraint", &constraint,
+                             "cursor", &cursor) < 0) {
         errprintf (&err, "invalid payload: %s", flux_msg_last_error (msg));
         errno = EPROTO;
         goto error;
@@ -336,10 +528,19 @@ void list_cb (flux_t *h,
     }
 
     if (!(jobs = get_jobs (ctx->jsctx, &err, max_entries, since,
-                           attrs, c, statec)))
+                           attrs, constraint, c, statec,
+                           cursor, next, sizeof (next))))
         goto error;
 
-    if (flux_respond_pack (h, msg, "{s:O}", "jobs", jobs) < 0)
+    if (strlen (next) > 0) {
+        if (flux_respond_pack (h,
+                               msg,
+                               "{s:O s:s}",
+                               "jobs", jobs,
+                               "cursor", next) < 0)
+            flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
+    }
+    else if (flux_respond_pack (h, msg, "{s:O}", "jobs", jobs) < 0)
         flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
 
     json_decref (jobs);
@@ -372,7 +573,7 @@ void check_id_valid_continuation (flux_future_t *f, void *arg)
         /* Job ID is legal.  Chance job-list has seen ID since this
          * lookup was done */
         struct job *job;
-        if (!(job = zhashx_lookup (jsctx->index, &isd->id))
+        if (!(job = jobmap_lookup (jsctx->index, isd->id))
             || job->state == FLUX_JOB_STATE_NEW) {
             /* Must wait for job-list to see state change */
             if (idsync_wait_valid (jsctx->ctx->isctx, isd) < 0)
@@ -453,7 +654,7 @@ json_t *get_job_by_id (struct job_state_ctx *jsctx,
 {
     struct job *job;
 
-    if (!(job = zhashx_lookup (jsctx->index, &id))) {
+    if (!(job = jobmap_lookup (jsctx->index, id))) {
         if (stall) {
             if (check_id_valid (jsctx, msg, id, attrs, state) < 0) {
                 flux_log_error (jsctx->h, "%s: check_id_valid", __FUNCTION__);
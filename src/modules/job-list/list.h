@@ -12,6 +12,11 @@
 #define _FLUX_JOB_LIST_LIST_H
 
 #include <flux/core.h>
+#include <jansson.h>
+
+#include "job_state.h"
+#include "match.h"
+#include "state_match.h"
 
 void list_cb (flux_t *h, flux_msg_handler_t *mh,
               const flux_msg_t *msg, void *arg);
@@ -22,6 +27,20 @@ void list_id_cb (flux_t *h, flux_msg_handler_t *mh,
 void list_attrs_cb (flux_t *h, flux_msg_handler_t *mh,
                     const flux_msg_t *msg, void *arg);
 
+/* Return array of jobs matching 'c' and 'statec', as for job-list.list.
+ */
+json_t *get_jobs (struct job_state_ctx *jsctx,
+                  flux_error_t *errp,
+                  int max_entries,
+                  double since,
+                  json_t *attrs,
+                  json_t *constraint,
+                  struct list_constraint *c,
+                  struct state_constraint *statec,
+                  const char *cursor,
+                  char *next,
+                  size_t next_size);
+
 #endif /* ! _FLUX_JOB_LIST_LIST_H */
 
 /*
@@ -24,17 +24,40 @@
 #include "match_util.h"
 #include "job_util.h"
 
-typedef int (*match_f) (struct list_constraint *,
-                        const struct job *,
-                        unsigned int *,
-                        flux_error_t *);
+/* Constraints are parsed into a tree of match_node, simplified, then
+ * compiled into a flat program of match_insn that job_match() runs
+ * for each job.
+ *
+ * Simplification flattens nested "and" and "or", folds constant
+ * terms, merges "states" and "results" terms into one bitmask test,
+ * merges "userid", "name", and "queue" terms under "or" into one set,
+ * and orders terms so cheap tests run first.
+ *
+ * In the program, each test sets a result register.  "and" and "or"
+ * compile to tests separated by conditional jumps to the end of the
+ * term, and "not" to its negated terms.  One comparison is counted
+ * against max_comparisons per test evaluated, regardless of how many
+ * values the test holds.
+ */
 
-struct list_constraint {
-    struct match_ctx *mctx;
-    zlistx_t *values;
-    match_f match;
-    unsigned int comparisons;   /* total across multiple calls to job_match() */
-};
+typedef enum {
+    MATCH_OP_TRUE = 0,
+    MATCH_OP_FALSE = 1,
+    MATCH_OP_STATES = 2,
+    MATCH_OP_RESULTS = 3,
+    MATCH_OP_USERID = 4,
+    MATCH_OP_TIMESTAMP = 5,
+    MATCH_OP_NAME = 6,
+    MATCH_OP_QUEUE = 7,
+    /* tree only */
+    MATCH_OP_AND = 8,
+    MATCH_OP_OR = 9,
+    MATCH_OP_NOT = 10,
+    /* program only */
+    MATCH_OP_JUMP_FALSE = 11,
+    MATCH_OP_JUMP_TRUE = 12,
+    MATCH_OP_NEGATE = 13,
+} match_op_t;
 
 typedef enum {
     MATCH_T_SUBMIT = 1,
@@ -57,8 +80,39 @@ struct timestamp_value {
     match_comparison_t t_comp;
 };
 
+struct match_node {
+    match_op_t op;
+    int bitmask;                    /* states, results */
+    struct timestamp_value tv;      /* timestamp */
+    uint32_t *userids;              /* userid, sorted after folding */
+    char **strings;                 /* name, queue */
+    struct match_node **children;   /* and, or, not */
+    int count;                      /* number of userids, strings, children */
+};
+
+struct match_insn {
+    match_op_t op;
+    int count;                      /* number of values, or jump target */
+    int bitmask;
+    struct timestamp_value tv;
+    uint32_t *userids;
+    char **strings;
+};
+
+struct list_constraint {
+    struct match_ctx *mctx;
+    struct match_insn *prog;
+    int len;
+    unsigned int comparisons;   /* total across multiple calls to job_match() */
+};
+
 #define CONSTRAINT_COMPARISON_MAX 1000000
 
+#define MATCH_ALL_STATES (FLUX_JOB_STATE_NEW \
+                          | FLUX_JOB_STATE_PENDING \
+                          | FLUX_JOB_STATE_RUNNING \
+                          | FLUX_JOB_STATE_INACTIVE)
+
 static inline int inc_check_comparison (struct match_ctx *mctx,
                                         unsigned int *comparisons,
                                         flux_error_t *errp)
@@ -73,308 +127,198 @@ static inline int inc_check_comparison (struct match_ctx *mctx,
     return 0;
 }
 
-static void timestamp_value_destroy (void *data)
+static void strings_destroy (char **strings, int count)
 {
-    if (data) {
-        int save_errno = errno;
-        free (data);
-        errno = save_errno;
+    if (strings) {
+        int i;
+        for (i = 0; i < count; i++)
+            free (strings[i]);
+        free (strings);
     }
 }
 
-/* zlistx_set_destructor */
-static void wrap_timestamp_value_destroy (void **item)
-{
-    if (item) {
-        struct timestamp_value *tv = *item;
-        timestamp_value_destroy (tv);
-        (*item) = NULL;
-    }
-}
+static void match_node_destroy (struct match_node *n);
 
-static struct timestamp_value *timestamp_value_create (
-    double t_value,
-    const char *type,
-    match_comparison_t comp)
+static void match_node_clear (struct match_node *n)
 {
-    struct timestamp_value *tv;
+    int i;
 
-    if (!(tv = calloc (1, sizeof (*tv))))
-        return NULL;
-    tv->t_value = t_value;
-
-    if (streq (type, "t_submit"))
-        tv->t_type = MATCH_T_SUBMIT;
-    else if (streq (type, "t_depend"))
-        tv->t_type = MATCH_T_DEPEND;
-    else if (streq (type, "t_run"))
-        tv->t_type = MATCH_T_RUN;
-    else if (streq (type, "t_cleanup"))
-        tv->t_type = MATCH_T_CLEANUP;
-    else if (streq (type, "t_inactive"))
-        tv->t_type = MATCH_T_INACTIVE;
-    else
-        goto cleanup;
-
-    tv->t_comp = comp;
-    return tv;
-
-cleanup:
-    timestamp_value_destroy (tv);
-    return NULL;
+    if (n->op == MATCH_OP_AND
+        || n->op == MATCH_OP_OR
+        || n->op == MATCH_OP_NOT) {
+        for (i = 0; i < n->count; i++)
+            match_node_destroy (n->children[i]);
+    }
+    else if (n->op == MATCH_OP_NAME || n->op == MATCH_OP_QUEUE)
+        strings_destroy (n->strings, n->count);
+    free (n->children);
+    free (n->userids);
+    memset (n, 0, sizeof (*n));
 }
 
-static struct timestamp_value *timestamp_value_create_str (
-    const char *t_value,
-    const char *type,
-    match_comparison_t comp,
-    flux_error_t *errp)
+static void match_node_destroy (struct match_node *n)
 {
-    double t;
-    char *endptr;
-    errno = 0;
-    t = strtod (t_value, &endptr);
-    if (errno != 0 || *endptr != '\0') {
-        errprintf (errp, "Invalid timestamp value specified");
-        return NULL;
-    }
-    if (t < 0.0) {
-        errprintf (errp, "timestamp value must be >= 0.0");
-        return NULL;
+    if (n) {
+        int saved_errno = errno;
+        match_node_clear (n);
+        free (n);
+        errno = saved_errno;
     }
-    return timestamp_value_create (t, type, comp);
 }
 
-static int match_true (struct list_constraint *c,
-                       const struct job *job,
-                       unsigned int *comparisons,
-                       flux_error_t *errp)
+static struct match_node *match_node_create (match_op_t op,
+                                             flux_error_t *errp)
 {
-    if (inc_check_comparison (c->mctx, comparisons, errp) < 0)
-        return -1;
-    return 1;
-}
+    struct match_node *n;
 
-static struct list_constraint *list_constraint_new (struct match_ctx *mctx,
-                                                    match_f match_cb,
-                                                    destructor_f destructor_cb,
-                                                    flux_error_t *errp)
-{
-    struct list_constraint *c;
-    if (!(c = calloc (1, sizeof (*c)))
-        || !(c->values = zlistx_new ())) {
-        list_constraint_destroy (c);
+    if (!(n = calloc (1, sizeof (*n)))) {
         errprintf (errp, "Out of memory");
         return NULL;
     }
-    c->mctx = mctx;
-    c->match = match_cb;
-    if (destructor_cb)
-        zlistx_set_destructor (c->values, destructor_cb);
-    return c;
+    n->op = op;
+    return n;
 }
 
-static void list_constraint_destructor (void **item)
+/* Turn 'n' into a constant in place, dropping its contents.
+ */
+static struct match_node *match_node_const (struct match_node *n, bool value)
 {
-    if (item) {
-        list_constraint_destroy (*item);
-        *item = NULL;
-    }
+    match_node_clear (n);
+    n->op = value ? MATCH_OP_TRUE : MATCH_OP_FALSE;
+    return n;
 }
 
-/* zlistx_set_destructor */
-static void wrap_free (void **item)
+static int append (void **array, int *count, size_t size, const void *item)
 {
-    if (item) {
-        free (*item);
-        (*item) = NULL;
-    }
+    void *new;
+
+    if (!(new = realloc (*array, (*count + 1) * size)))
+        return -1;
+    memcpy ((char *)new + *count * size, item, size);
+    *array = new;
+    (*count)++;
+    return 0;
 }
 
-static int match_userid (struct list_constraint *c,
-                         const struct job *job,
-                         unsigned int *comparisons,
-                         flux_error_t *errp)
+static int node_add_child (struct match_node *n, struct match_node *child)
 {
-    uint32_t *userid = zlistx_first (c->values);
-    while (userid) {
-        if (inc_check_comparison (c->mctx, comparisons, errp) < 0)
-            return -1;
-        if ((*userid) == FLUX_USERID_UNKNOWN)
-            return 1;
-        if ((*userid) == job->userid)
-            return 1;
-        userid = zlistx_next (c->values);
+    return append ((void **)&n->children,
+                   &n->count,
+                   sizeof (child),
+                   &child);
+}
+
+static int timestamp_value_parse (struct timestamp_value *tv,
+                                  const char *type,
+                                  const char *t_value,
+                                  match_comparison_t comp,
+                                  flux_error_t *errp)
+{
+    double t;
+    char *endptr;
+
+    errno = 0;
+    t = strtod (t_value, &endptr);
+    if (errno != 0 || *endptr != '\0') {
+        errprintf (errp, "Invalid timestamp value specified");
+        return -1;
+    }
+    if (t < 0.0) {
+        errprintf (errp, "timestamp value must be >= 0.0");
+        return -1;
     }
+    tv->t_value = t;
+    if (streq (type, "t_submit"))
+        tv->t_type = MATCH_T_SUBMIT;
+    else if (streq (type, "t_depend"))
+        tv->t_type = MATCH_T_DEPEND;
+    else if (streq (type, "t_run"))
+        tv->t_type = MATCH_T_RUN;
+    else if (streq (type, "t_cleanup"))
+        tv->t_type = MATCH_T_CLEANUP;
+    else /* streq (type, "t_inactive") */
+        tv->t_type = MATCH_T_INACTIVE;
+    tv->t_comp = comp;
     return 0;
 }
 
-static struct list_constraint *create_userid_constraint (struct match_ctx *mctx,
-                                                         json_t *values,
-                                                         flux_error_t *errp)
+static struct match_node *create_userid_node (json_t *values,
+                                              flux_error_t *errp)
 {
-    struct list_constraint *c;
+    struct match_node *n;
     json_t *entry;
     size_t index;
 
-    if (!(c = list_constraint_new (mctx, match_userid, wrap_free, errp)))
+    if (!(n = match_node_create (MATCH_OP_USERID, errp)))
         return NULL;
     json_array_foreach (values, index, entry) {
-        uint32_t *userid;
+        uint32_t userid;
         if (!json_is_integer (entry)) {
             errprintf (errp, "userid value must be an integer");
             goto error;
         }
-        if (!(userid = malloc (sizeof (*userid))))
-            goto error;
-        (*userid) = json_integer_value (entry);
-        if (!zlistx_add_end (c->values, userid)) {
-            free (userid);
+        userid = json_integer_value (entry);
+        if (append ((void **)&n->userids,
+                    &n->count,
+                    sizeof (userid),
+                    &userid) < 0) {
+            errprintf (errp, "Out of memory");
             goto error;
         }
     }
-    return c;
- error:
-    list_constraint_destroy (c);
+    return n;
+error:
+    match_node_destroy (n);
     return NULL;
 }
 
-static struct list_constraint *create_string_constraint (struct match_ctx *mctx,
-                                                         const char *op,
-                                                         json_t *values,
-                                                         match_f match_cb,
-                                                         flux_error_t *errp)
+static struct match_node *create_string_node (match_op_t op,
+                                              const char *opstr,
+                                              json_t *values,
+                                              flux_error_t *errp)
 {
-    struct list_constraint *c;
+    struct match_node *n;
     json_t *entry;
     size_t index;
 
-    if (!(c = list_constraint_new (mctx, match_cb, wrap_free, errp)))
+    if (!(n = match_node_create (op, errp)))
         return NULL;
     json_array_foreach (values, index, entry) {
-        char *s = NULL;
+        char *s;
         if (!json_is_string (entry)) {
-            errprintf (errp, "%s value must be a string", op);
+            errprintf (errp, "%s value must be a string", opstr);
             goto error;
         }
-        if (!(s = strdup (json_string_value (entry))))
-            return NULL;
-        if (!zlistx_add_end (c->values, s)) {
+        if (!(s = strdup (json_string_value (entry)))
+            || append ((void **)&n->strings,
+                       &n->count,
+                       sizeof (s),
+                       &s) < 0) {
             free (s);
+            errprintf (errp, "Out of memory");
             goto error;
         }
     }
-    return c;
- error:
-    list_constraint_destroy (c);
+    return n;
+error:
+    match_node_destroy (n);
     return NULL;
 }
 
-static int match_name (struct list_constraint *c,
-                       const struct job *job,
-                       unsigned int *comparisons,
-                       flux_error_t *errp)
-{
-    const char *name = zlistx_first (c->values);
-    while (name) {
-        if (inc_check_comparison (c->mctx, comparisons, errp) < 0)
-            return -1;
-        if (job->name && streq (name, job->name))
-            return 1;
-        name = zlistx_next (c->values);
-    }
-    return 0;
-}
-
-static struct list_constraint *create_name_constraint (struct match_ctx *mctx,
-                                                       json_t *values,
-                                                       flux_error_t *errp)
-{
-    return create_string_constraint (mctx, "name", values, match_name, errp);
-}
-
-static int match_queue (struct list_constraint *c,
-                        const struct job *job,
-                        unsigned int *comparisons,
-                        flux_error_t *errp)
-{
-    const char *queue = zlistx_first (c->values);
-    while (queue) {
-        if (inc_check_comparison (c->mctx, comparisons, errp) < 0)
-            return -1;
-        if (job->queue && streq (queue, job->queue))
-            return 1;
-        queue = zlistx_next (c->values);
-    }
-    return 0;
-}
-
-static struct list_constraint *create_queue_constraint (struct match_ctx *mctx,
-                                                        json_t *values,
-                                                        flux_error_t *errp)
+static struct match_node *create_bitmask_node (match_op_t op,
+                                               json_t *values,
+                                               array_to_bitmask_f cb,
+                                               flux_error_t *errp)
 {
-    return create_string_constraint (mctx, "queue", values, match_queue, errp);
-}
+    struct match_node *n;
+    int bitmask;
 
-static struct list_constraint *create_bitmask_constraint (
-    struct match_ctx *mctx,
-    const char *op,
-    json_t *values,
-    match_f match_cb,
-    array_to_bitmask_f array_to_bitmask_cb,
-    flux_error_t *errp)
-{
-    struct list_constraint *c;
-    int *bitmask = NULL;
-    int tmp;
-    if ((tmp = array_to_bitmask_cb (values, errp)) < 0)
-        return NULL;
-    if (!(bitmask = malloc (sizeof (*bitmask))))
+    if ((bitmask = cb (values, errp)) < 0)
         return NULL;
-    (*bitmask) = tmp;
-    if (!(c = list_constraint_new (mctx, match_cb, wrap_free, errp))
-        || !zlistx_add_end (c->values, bitmask)) {
-        list_constraint_destroy (c);
-        free (bitmask);
+    if (!(n = match_node_create (op, errp)))
         return NULL;
-    }
-    return c;
-}
-
-static int match_states (struct list_constraint *c,
-                         const struct job *job,
-                         unsigned int *comparisons,
-                         flux_error_t *errp)
-{
-    int *states = zlistx_first (c->values);
-    if (inc_check_comparison (c->mctx, comparisons, errp) < 0)
-        return -1;
-    return ((*states) & job->state) ? 1 : 0;
-}
-
-static struct list_constraint *create_states_constraint (struct match_ctx *mctx,
-                                                         json_t *values,
-                                                         flux_error_t *errp)
-{
-    return create_bitmask_constraint (mctx,
-                                      "states",
-                                      values,
-                                      match_states,
-                                      array_to_states_bitmask,
-                                      errp);
-}
-
-static int match_results (struct list_constraint *c,
-                          const struct job *job,
-                          unsigned int *comparisons,
-                          flux_error_t *errp)
-{
-    int *results = zlistx_first (c->values);
-    if (inc_check_comparison (c->mctx, comparisons, errp) < 0)
-        return -1;
-    if (job->state != FLUX_JOB_STATE_INACTIVE)
-        return 0;
-    return ((*results) & job->result) ? 1 : 0;
+    n->bitmask = bitmask;
+    return n;
 }
 
 static int array_to_results_bitmask (json_t *values, flux_error_t *errp)
@@ -416,75 +360,15 @@ static int array_to_results_bitmask (json_t *values, flux_error_t *errp)
     return results;
 }
 
-static struct list_constraint *create_results_constraint (struct match_ctx *mctx,
-                                                          json_t *values,
-                                                          flux_error_t *errp)
-{
-    return create_bitmask_constraint (mctx,
-                                      "results",
-                                      values,
-                                      match_results,
-                                      array_to_results_bitmask,
-                                      errp);
-}
-
-static int match_timestamp (struct list_constraint *c,
-                            const struct job *job,
-                            unsigned int *comparisons,
-                            flux_error_t *errp)
-{
-    struct timestamp_value *tv = zlistx_first (c->values);
-    double t;
-
-    if (inc_check_comparison (c->mctx, comparisons, errp) < 0)
-        return -1;
-
-    if (tv->t_type == MATCH_T_SUBMIT)
-        t = job->t_submit;
-    else if (tv->t_type == MATCH_T_DEPEND) {
-        /* if submit_version < 1, it means it was not set.  This is
-         * before the introduction of event `validate` after 0.41.1.
-         * Before the introduction of this event, t_submit and
-         * t_depend are the same.
-         */
-        if (job->submit_version < 1)
-            t = job->t_submit;
-        else if (job->states_mask & FLUX_JOB_STATE_DEPEND)
-            t = job->t_depend;
-        else
-            return 0;
-    }
-    else if (tv->t_type == MATCH_T_RUN
-             && (job->states_mask & FLUX_JOB_STATE_RUN))
-        t = job->t_run;
-    else if (tv->t_type == MATCH_T_CLEANUP
-             && (job->states_mask & FLUX_JOB_STATE_CLEANUP))
-        t = job->t_cleanup;
-    else if (tv->t_type == MATCH_T_INACTIVE
-             && (job->states_mask & FLUX_JOB_STATE_INACTIVE))
-        t = job->t_inactive;
-    else
-        return 0;
-
-    if (tv->t_comp == MATCH_GREATER_THAN_EQUAL)
-        return t >= tv->t_value;
-    else if (tv->t_comp == MATCH_LESS_THAN_EQUAL)
-        return t <= tv->t_value;
-    else if (tv->t_comp == MATCH_GREATER_THAN)
-        return t > tv->t_value;
-    else /* tv->t_comp == MATCH_LESS_THAN */
-        return t < tv->t_value;
-}
-
-static struct list_constraint *create_timestamp_constraint (struct match_ctx *mctx,
-                                                            const char *type,
-                                                            json_t *values,
-                                                            flux_error_t *errp)
+static struct match_node *create_timestamp_node (const char *type,
+                                                 json_t *values,
+                                                 flux_error_t *errp)
 {
-    struct timestamp_value *tv = NULL;
-    struct list_constraint *c;
+    struct match_node *n;
+    struct timestamp_value tv;
     const char *str;
     json_t *v = json_array_get (values, 0);
+    int rc;
 
     if (!v) {
         errprintf (errp, "timestamp value not specified");
@@ -496,151 +380,91 @@ static struct list_constraint *create_timestamp_constraint (struct match_ctx *mc
     }
     str = json_string_value (v);
     if (strstarts (str, ">="))
-        tv = timestamp_value_create_str (str + 2,
-                                         type,
-                                         MATCH_GREATER_THAN_EQUAL,
-                                         errp);
+        rc = timestamp_value_parse (&tv,
+                                    type,
+                                    str + 2,
+                                    MATCH_GREATER_THAN_EQUAL,
+                                    errp);
     else if (strstarts (str, "<="))
-        tv = timestamp_value_create_str (str + 2,
-                                         type,
-                                         MATCH_LESS_THAN_EQUAL,
-                                         errp);
+        rc = timestamp_value_parse (&tv,
+                                    type,
+                                    str + 2,
+                                    MATCH_LESS_THAN_EQUAL,
+                                    errp);
     else if (strstarts (str, ">"))
-        tv = timestamp_value_create_str (str + 1,
-                                         type,
-                                         MATCH_GREATER_THAN,
-                                         errp);
+        rc = timestamp_value_parse (&tv,
+                                    type,
+                                    str + 1,
+                                    MATCH_GREATER_THAN,
+                                    errp);
     else if (strstarts (str, "<"))
-        tv = timestamp_value_create_str (str + 1,
-                                         type,
-                                         MATCH_LESS_THAN,
-                                         errp);
-    else
+        rc = timestamp_value_parse (&tv,
+                                    type,
+                                    str + 1,
+                                    MATCH_LESS_THAN,
+                                    errp);
+    else {
         errprintf (errp, "timestamp comparison operator not specified");
-
-    if (!tv)
+        rc = -1;
+    }
+    if (rc < 0)
         return NULL;
-
-    if (!(c = list_constraint_new (mctx,
-                                   match_timestamp,
-                                   wrap_timestamp_value_destroy,
-                                   errp))
-        || !zlistx_add_end (c->values, tv)) {
-        list_constraint_destroy (c);
-        timestamp_value_destroy (tv);
+    if (!(n = match_node_create (MATCH_OP_TIMESTAMP, errp)))
         return NULL;
-    }
-    return c;
-}
-
-static int match_and (struct list_constraint *c,
-                      const struct job *job,
-                      unsigned int *comparisons,
-                      flux_error_t *errp)
-{
-    struct list_constraint *cp = zlistx_first (c->values);
-    while (cp) {
-        int ret = cp->match (cp, job, comparisons, errp);
-        /* i.e. return immediately if false or error */
-        if (ret != 1)
-            return ret;
-        cp = zlistx_next (c->values);
-    }
-    return 1;
-}
-
-static int match_or (struct list_constraint *c,
-                     const struct job *job,
-                     unsigned int *comparisons,
-                     flux_error_t *errp)
-{
-    struct list_constraint *cp = zlistx_first (c->values);
-    /* no values in "or" defined as true per RFC31 */
-    if (!cp)
-        return 1;
-    while (cp) {
-        int ret = cp->match (cp, job, comparisons, errp);
-        /* i.e. return immediately if true or error */
-        if (ret != 0)
-            return ret;
-        cp = zlistx_next (c->values);
-    }
-    return 0;
+    n->tv = tv;
+    return n;
 }
 
-static int match_not (struct list_constraint *c,
-                      const struct job *job,
-                      unsigned int *comparisons,
-                      flux_error_t *errp)
-{
-    int ret;
-    if ((ret = match_and (c, job, comparisons, errp)) < 0)
-        return -1;
-    return ret ? 0 : 1;
-}
+static struct match_node *parse_constraint (json_t *constraint,
+                                            flux_error_t *errp);
 
-static struct list_constraint *conditional_constraint (struct match_ctx *mctx,
-                                                       const char *type,
-                                                       json_t *values,
-                                                       flux_error_t *errp)
+/* "not" is the negation of the "and" of its terms.
+ */
+static struct match_node *create_conditional_node (const char *type,
+                                                   json_t *values,
+                                                   flux_error_t *errp)
 {
+    struct match_node *n;
+    struct match_node *conj = NULL;
     json_t *entry;
     size_t index;
-    struct list_constraint *c;
-    match_f match_cb;
-
-    if (streq (type, "and"))
-        match_cb = match_and;
-    else if (streq (type, "or"))
-        match_cb = match_or;
-    else /* streq (type, "not") */
-        match_cb = match_not;
-
-    if (!(c = list_constraint_new (mctx,
-                                   match_cb,
-                                   list_constraint_destructor,
-                                   errp)))
-        return NULL;
 
+    if (!(n = match_node_create (streq (type, "or") ?
+                                 MATCH_OP_OR : MATCH_OP_AND,
+                                 errp)))
+        return NULL;
     json_array_foreach (values, index, entry) {
-        struct list_constraint *cp = list_constraint_create (mctx, entry, errp);
-        if (!cp)
+        struct match_node *child;
+        if (!(child = parse_constraint (entry, errp)))
             goto error;
-        if (!zlistx_add_end (c->values, cp)) {
+        if (node_add_child (n, child) < 0) {
             errprintf (errp, "Out of memory");
-            list_constraint_destroy (cp);
+            match_node_destroy (child);
             goto error;
         }
     }
-    return c;
-
- error:
-    list_constraint_destroy (c);
-    return NULL;
-}
-
-void list_constraint_destroy (struct list_constraint *constraint)
-{
-    if (constraint) {
-        int saved_errno = errno;
-        zlistx_destroy (&constraint->values);
-        free (constraint);
-        errno = saved_errno;
+    if (streq (type, "not")) {
+        conj = n;
+        if (!(n = match_node_create (MATCH_OP_NOT, errp)))
+            goto error;
+        if (node_add_child (n, conj) < 0) {
+            errprintf (errp, "Out of memory");
+            goto error;
+        }
     }
+    return n;
+error:
+    match_node_destroy (conj);
+    match_node_destroy (n);
+    return NULL;
 }
 
-struct list_constraint *list_constraint_create (struct match_ctx *mctx,
-                                                json_t *constraint,
-                                                flux_error_t *errp)
+static struct match_node *parse_constraint (json_t *constraint,
+                                            flux_error_t *errp)
 {
     const char *op;
     json_t *values;
 
-    if (!mctx) {
-        errno = EINVAL;
-        return NULL;
-    }
-
     if (constraint) {
         if (!json_is_object (constraint)) {
             errprintf (errp, "constraint must be JSON object");
@@ -656,41 +480,532 @@ struct list_constraint *list_constraint_create (struct match_ctx *mctx,
                 return NULL;
             }
             if (streq (op, "userid"))
-                return create_userid_constraint (mctx, values, errp);
+                return create_userid_node (values, errp);
             else if (streq (op, "name"))
-                return create_name_constraint (mctx, values, errp);
+                return create_string_node (MATCH_OP_NAME,
+                                           "name",
+                                           values,
+                                           errp);
             else if (streq (op, "queue"))
-                return create_queue_constraint (mctx, values, errp);
+                return create_string_node (MATCH_OP_QUEUE,
+                                           "queue",
+                                           values,
+                                           errp);
             else if (streq (op, "states"))
-                return create_states_constraint (mctx, values, errp);
+                return create_bitmask_node (MATCH_OP_STATES,
+                                            values,
+                                            array_to_states_bitmask,
+                                            errp);
             else if (streq (op, "results"))
-                return create_results_constraint (mctx, values, errp);
+                return create_bitmask_node (MATCH_OP_RESULTS,
+                                            values,
+                                            array_to_results_bitmask,
+                                            errp);
             else if (streq (op, "t_submit")
                      || streq (op, "t_depend")
                      || streq (op, "t_run")
                      || streq (op, "t_cleanup")
                      || streq (op, "t_inactive"))
-                return create_timestamp_constraint (mctx, op, values, errp);
+                return create_timestamp_node (op, values, errp);
             else if (streq (op, "or") || streq (op, "and") || streq (op, "not"))
-                return conditional_constraint (mctx, op, values, errp);
+                return create_conditional_node (op, values, errp);
             else {
                 errprintf (errp, "unknown constraint operator: %s", op);
                 return NULL;
             }
         }
     }
-    return list_constraint_new (mctx, match_true, NULL, errp);
+    return match_node_create (MATCH_OP_TRUE, errp);
+}
+
+static int userid_cmp (const void *a, const void *b)
+{
+    uint32_t u1 = *(const uint32_t *)a;
+    uint32_t u2 = *(const uint32_t *)b;
+
+    return u1 < u2 ? -1 : u1 > u2 ? 1 : 0;
+}
+
+/* Fold a test into a constant where its outcome doesn't depend on the
+ * job, and sort userids for binary search.
+ */
+static struct match_node *fold_test (struct match_node *n)
+{
+    int i, j;
+
+    switch (n->op) {
+        case MATCH_OP_STATES:
+            if (n->bitmask == 0)
+                return match_node_const (n, false);
+            if ((n->bitmask & MATCH_ALL_STATES) == MATCH_ALL_STATES)
+                return match_node_const (n, true);
+            break;
+        case MATCH_OP_RESULTS:
+            if (n->bitmask == 0)
+                return match_node_const (n, false);
+            break;
+        case MATCH_OP_USERID:
+            if (n->count == 0)
+                return match_node_const (n, false);
+            for (i = 0; i < n->count; i++) {
+                if (n->userids[i] == FLUX_USERID_UNKNOWN)
+                    return match_node_const (n, true);
+            }
+            qsort (n->userids, n->count, sizeof (n->userids[0]), userid_cmp);
+            for (i = 1, j = 1; i < n->count; i++) {
+                if (n->userids[i] != n->userids[j - 1])
+                    n->userids[j++] = n->userids[i];
+            }
+            n->count = j;
+            break;
+        case MATCH_OP_NAME:
+        case MATCH_OP_QUEUE:
+            if (n->count == 0)
+                return match_node_const (n, false);
+            break;
+        default:
+            break;
+    }
+    return n;
+}
+
+/* Merge test 'src' into 'dst' of the same type under conjunction 'op'.
+ * Return true if 'src' was consumed.
+ */
+static bool merge_test (match_op_t op,
+                        struct match_node *dst,
+                        struct match_node *src)
+{
+    switch (dst->op) {
+        case MATCH_OP_STATES:
+        case MATCH_OP_RESULTS:
+            if (op == MATCH_OP_AND)
+                dst->bitmask &= src->bitmask;
+            else
+                dst->bitmask |= src->bitmask;
+            return true;
+        case MATCH_OP_USERID:
+            if (op == MATCH_OP_OR) {
+                uint32_t *new;
+                if (!(new = realloc (dst->userids,
+                                     (dst->count + src->count)
+                                     * sizeof (*new))))
+                    return false;
+                memcpy (new + dst->count,
+                        src->userids,
+                        src->count * sizeof (*new));
+                dst->userids = new;
+                dst->count += src->count;
+                return true;
+            }
+            return false;
+        case MATCH_OP_NAME:
+        case MATCH_OP_QUEUE:
+            if (op == MATCH_OP_OR) {
+                char **new;
+                if (!(new = realloc (dst->strings,
+                                     (dst->count + src->count)
+                                     * sizeof (*new))))
+                    return false;
+                memcpy (new + dst->count,
+                        src->strings,
+                        src->count * sizeof (*new));
+                dst->strings = new;
+                dst->count += src->count;
+                /* strings now belong to 'dst' */
+                src->count = 0;
+                return true;
+            }
+            return false;
+        default:
+            return false;
+    }
+}
+
+/* Relative cost of evaluating a term, for ordering.
+ */
+static int term_cost (const struct match_node *n)
+{
+    switch (n->op) {
+        case MATCH_OP_STATES:
+        case MATCH_OP_RESULTS:
+            return 0;
+        case MATCH_OP_USERID:
+            return 1;
+        case MATCH_OP_TIMESTAMP:
+            return 2;
+        case MATCH_OP_NAME:
+        case MATCH_OP_QUEUE:
+            return 3;
+        default:
+            return 4;
+    }
+}
+
+static struct match_node *fold (struct match_node *n);
+
+static struct match_node *fold_conjunction (struct match_node *n)
+{
+    bool is_and = (n->op == MATCH_OP_AND);
+    struct match_node **children;
+    int total = 0;
+    int i, j, k;
+
+    /* An empty "or" is true per RFC 31, as is an empty "and".
+     */
+    if (n->count == 0)
+        return match_node_const (n, true);
+
+    /* Fold each term, and hoist the terms of nested conjunctions of
+     * the same type into this one.  Hoisting is skipped if out of
+     * memory, as the nested form is equivalent.
+     */
+    for (i = 0; i < n->count; i++) {
+        n->children[i] = fold (n->children[i]);
+        total += n->children[i]->op == n->op ? n->children[i]->count : 1;
+    }
+    if (total > n->count
+        && (children = calloc (total, sizeof (children[0])))) {
+        for (i = 0, k = 0; i < n->count; i++) {
+            struct match_node *child = n->children[i];
+            if (child->op == n->op) {
+                for (j = 0; j < child->count; j++)
+                    children[k++] = child->children[j];
+                child->count = 0;
+                match_node_destroy (child);
+            }
+            else
+                children[k++] = child;
+        }
+        free (n->children);
+        n->children = children;
+        n->count = total;
+    }
+
+    /* Merge tests of the same type, then fold constants.
+     * A true term is dropped from "and", a false one from "or".
+     * A false term makes "and" false, a true one makes "or" true.
+     */
+    for (i = 0; i < n->count; i++) {
+        for (j = i + 1; j < n->count; j++) {
+            if (n->children[j]->op == n->children[i]->op
+                && merge_test (n->op, n->children[i], n->children[j])) {
+                match_node_destroy (n->children[j]);
+                memmove (&n->children[j],
+                         &n->children[j + 1],
+                         (n->count - j - 1) * sizeof (n->children[0]));
+                n->count--;
+                j--;
+            }
+        }
+    }
+    for (i = 0, j = 0; i < n->count; i++) {
+        struct match_node *child = fold_test (n->children[i]);
+        n->children[i] = NULL;
+        if (child->op == (is_and ? MATCH_OP_FALSE : MATCH_OP_TRUE)) {
+            match_node_destroy (child);
+            return match_node_const (n, !is_and);
+        }
+        if (child->op == (is_and ? MATCH_OP_TRUE : MATCH_OP_FALSE))
+            match_node_destroy (child);
+        else
+            n->children[j++] = child;
+    }
+    n->count = j;
+    if (n->count == 0)
+        return match_node_const (n, is_and);
+    if (n->count == 1) {
+        struct match_node *child = n->children[0];
+        n->count = 0;
+        match_node_destroy (n);
+        return child;
+    }
+
+    /* Order terms by cost, keeping the given order among equals.
+     */
+    for (i = 1; i < n->count; i++) {
+        struct match_node *child = n->children[i];
+        for (j = i; j > 0 && term_cost (n->children[j - 1])
+                             > term_cost (child); j--)
+            n->children[j] = n->children[j - 1];
+        n->children[j] = child;
+    }
+    return n;
+}
+
+static struct match_node *fold (struct match_node *n)
+{
+    switch (n->op) {
+        case MATCH_OP_AND:
+        case MATCH_OP_OR:
+            return fold_conjunction (n);
+        case MATCH_OP_NOT: {
+            struct match_node *child = fold (n->children[0]);
+            n->children[0] = child;
+            if (child->op == MATCH_OP_TRUE)
+                return match_node_const (n, false);
+            if (child->op == MATCH_OP_FALSE)
+                return match_node_const (n, true);
+            if (child->op == MATCH_OP_NOT) {
+                struct match_node *grandchild = child->children[0];
+                child->children[0] = NULL;
+                child->count = 0;
+                match_node_destroy (n);
+                return grandchild;
+            }
+            return n;
+        }
+        default:
+            return fold_test (n);
+    }
+}
+
+static int program_size (const struct match_node *n)
+{
+    int size = 0;
+    int i;
+
+    switch (n->op) {
+        case MATCH_OP_AND:
+        case MATCH_OP_OR:
+            for (i = 0; i < n->count; i++)
+                size += program_size (n->children[i]);
+            return size + n->count - 1;
+        case MATCH_OP_NOT:
+            return program_size (n->children[0]) + 1;
+        default:
+            return 1;
+    }
+}
+
+/* Emit 'n' at the end of 'c->prog', moving any values from 'n' to the
+ * program.  Jumps out of a conjunction are chained through their
+ * target field until the end of the conjunction is known.
+ */
+static void program_emit (struct list_constraint *c, struct match_node *n)
+{
+    struct match_insn *insn;
+    int chain = -1;
+    int i;
+
+    switch (n->op) {
+        case MATCH_OP_AND:
+        case MATCH_OP_OR:
+            for (i = 0; i < n->count; i++) {
+                program_emit (c, n->children[i]);
+                if (i < n->count - 1) {
+                    insn = &c->prog[c->len];
+                    insn->op = n->op == MATCH_OP_AND ?
+                               MATCH_OP_JUMP_FALSE : MATCH_OP_JUMP_TRUE;
+                    insn->count = chain;
+                    chain = c->len++;
+                }
+            }
+            while (chain >= 0) {
+                insn = &c->prog[chain];
+                chain = insn->count;
+                insn->count = c->len;
+            }
+            break;
+        case MATCH_OP_NOT:
+            program_emit (c, n->children[0]);
+            c->prog[c->len++].op = MATCH_OP_NEGATE;
+            break;
+        default:
+            insn = &c->prog[c->len++];
+            insn->op = n->op;
+            insn->count = n->count;
+            insn->bitmask = n->bitmask;
+            insn->tv = n->tv;
+            insn->userids = n->userids;
+            insn->strings = n->strings;
+            n->userids = NULL;
+            n->strings = NULL;
+            n->count = 0;
+            break;
+    }
+}
+
+void list_constraint_destroy (struct list_constraint *constraint)
+{
+    if (constraint) {
+        int saved_errno = errno;
+        int i;
+        for (i = 0; i < constraint->len; i++) {
+            struct match_insn *insn = &constraint->prog[i];
+            free (insn->userids);
+            if (insn->op == MATCH_OP_NAME || insn->op == MATCH_OP_QUEUE)
+                strings_destroy (insn->strings, insn->count);
+        }
+        free (constraint->prog);
+        free (constraint);
+        errno = saved_errno;
+    }
+}
+
+struct list_constraint *list_constraint_create (struct match_ctx *mctx,
+                                                json_t *constraint,
+                                                flux_error_t *errp)
+{
+    struct list_constraint *c = NULL;
+    struct match_node *n;
+
+    if (!mctx) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(n = parse_constraint (constraint, errp)))
+        return NULL;
+    n = fold (n);
+    if (!(c = calloc (1, sizeof (*c)))
+        || !(c->prog = calloc (program_size (n), sizeof (c->prog[0])))) {
+        errprintf (errp, "Out of memory");
+        goto error;
+    }
+    c->mctx = mctx;
+    program_emit (c, n);
+    match_node_destroy (n);
+    return c;
+error:
+    list_constraint_destroy (c);
+    match_node_destroy (n);
+    return NULL;
+}
+
+static bool match_timestamp (const struct timestamp_value *tv,
+                             const struct job *job)
+{
+    double t;
+
+    if (tv->t_type == MATCH_T_SUBMIT)
+        t = job->t_submit;
+    else if (tv->t_type == MATCH_T_DEPEND) {
+        /* if submit_version < 1, it means it was not set.  This is
+         * before the introduction of event `validate` after 0.41.1.
+         * Before the introduction of this event, t_submit and
+         * t_depend are the same.
+         */
+        if (job->submit_version < 1)
+            t = job->t_submit;
+        else if (job->states_mask & FLUX_JOB_STATE_DEPEND)
+            t = job->t_depend;
+        else
+            return false;
+    }
+    else if (tv->t_type == MATCH_T_RUN
+             && (job->states_mask & FLUX_JOB_STATE_RUN))
+        t = job->t_run;
+    else if (tv->t_type == MATCH_T_CLEANUP
+             && (job->states_mask & FLUX_JOB_STATE_CLEANUP))
+        t = job->t_cleanup;
+    else if (tv->t_type == MATCH_T_INACTIVE
+             && (job->states_mask & FLUX_JOB_STATE_INACTIVE))
+        t = job->t_inactive;
+    else
+        return false;
+
+    if (tv->t_comp == MATCH_GREATER_THAN_EQUAL)
+        return t >= tv->t_value;
+    else if (tv->t_comp == MATCH_LESS_THAN_EQUAL)
+        return t <= tv->t_value;
+    else if (tv->t_comp == MATCH_GREATER_THAN)
+        return t > tv->t_value;
+    else /* tv->t_comp == MATCH_LESS_THAN */
+        return t < tv->t_value;
+}
+
+static bool match_userid (const struct match_insn *insn, uint32_t userid)
+{
+    int lo = 0;
+    int hi = insn->count - 1;
+
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (insn->userids[mid] == userid)
+            return true;
+        if (insn->userids[mid] < userid)
+            lo = mid + 1;
+        else
+            hi = mid - 1;
+    }
+    return false;
+}
+
+static bool match_string (const struct match_insn *insn, const char *s)
+{
+    int i;
+
+    if (!s)
+        return false;
+    for (i = 0; i < insn->count; i++) {
+        if (streq (insn->strings[i], s))
+            return true;
+    }
+    return false;
 }
 
 int job_match (const struct job *job,
                struct list_constraint *constraint,
                flux_error_t *errp)
 {
+    const struct match_insn *insn;
+    int pc = 0;
+    bool r = true;
+
     if (!job || !constraint) {
         errno = EINVAL;
         return -1;
     }
-    return constraint->match (constraint, job, &constraint->comparisons, errp);
+    while (pc < constraint->len) {
+        insn = &constraint->prog[pc++];
+        switch (insn->op) {
+            case MATCH_OP_JUMP_FALSE:
+                if (!r)
+                    pc = insn->count;
+                continue;
+            case MATCH_OP_JUMP_TRUE:
+                if (r)
+                    pc = insn->count;
+                continue;
+            case MATCH_OP_NEGATE:
+                r = !r;
+                continue;
+            default:
+                break;
+        }
+        if (inc_check_comparison (constraint->mctx,
+                                  &constraint->comparisons,
+                                  errp) < 0)
+            return -1;
+        switch (insn->op) {
+            case MATCH_OP_TRUE:
+                r = true;
+                break;
+            case MATCH_OP_STATES:
+                r = (insn->bitmask & job->state) != 0;
+                break;
+            case MATCH_OP_RESULTS:
+                r = job->state == FLUX_JOB_STATE_INACTIVE
+                    && (insn->bitmask & job->result) != 0;
+                break;
+            case MATCH_OP_USERID:
+                r = match_userid (insn, job->userid);
+                break;
+            case MATCH_OP_TIMESTAMP:
+                r = match_timestamp (&insn->tv, job);
+                break;
+            case MATCH_OP_NAME:
+                r = match_string (insn, job->name);
+                break;
+            case MATCH_OP_QUEUE:
+                r = match_string (insn, job->queue);
+                break;
+            default: /* MATCH_OP_FALSE */
+                r = false;
+                break;
+        }
+    }
+    return r ? 1 : 0;
 }
 
 static int config_parse_max_comparisons (struct match_ctx *mctx,
@@ -0,0 +1,119 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* strpool.c - reference counted string interning
+ *
+ * Each entry holds its string inline, and the hash is keyed by that
+ * same string, so an interned string costs one allocation.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <errno.h>
+
+#include "src/common/libczmqcontainers/czmq_containers.h"
+
+#include "strpool.h"
+
+struct strpool {
+    zhashx_t *entries;          // string => struct entry
+};
+
+struct entry {
+    size_t refs;
+    char s[];
+};
+
+static struct entry *entry_of (const char *s)
+{
+    return (struct entry *)(s - offsetof (struct entry, s));
+}
+
+static void entry_destructor (void **item)
+{
+    if (item) {
+        free (*item);
+        *item = NULL;
+    }
+}
+
+const char *strpool_intern (struct strpool *sp, const char *s)
+{
+    struct entry *e;
+    size_t len;
+
+    if (!sp || !s)
+        return NULL;
+    if ((e = zhashx_lookup (sp->entries, s))) {
+        e->refs++;
+        return e->s;
+    }
+    len = strlen (s);
+    if (!(e = malloc (sizeof (*e) + len + 1)))
+        return NULL;
+    e->refs = 1;
+    memcpy (e->s, s, len + 1);
+    if (zhashx_insert (sp->entries, e->s, e) < 0) {
+        free (e);
+        errno = ENOMEM;
+        return NULL;
+    }
+    return e->s;
+}
+
+void strpool_release (struct strpool *sp, const char *s)
+{
+    if (sp && s) {
+        struct entry *e = entry_of (s);
+        if (--e->refs == 0)
+            zhashx_delete (sp->entries, e->s);
+    }
+}
+
+size_t strpool_count (struct strpool *sp)
+{
+    return sp ? zhashx_size (sp->entries) : 0;
+}
+
+void strpool_destroy (struct strpool *sp)
+{
+    if (sp) {
+        int saved_errno = errno;
+        zhashx_destroy (&sp->entries);
+        free (sp);
+        errno = saved_errno;
+    }
+}
+
+struct strpool *strpool_create (void)
+{
+    struct strpool *sp;
+
+    if (!(sp = calloc (1, sizeof (*sp))))
+        return NULL;
+    if (!(sp->entries = zhashx_new ())) {
+        free (sp);
+        errno = ENOMEM;
+        return NULL;
+    }
+    /* keys point into entries, so are neither copied nor freed */
+    zhashx_set_key_duplicator (sp->entries, NULL);
+    zhashx_set_key_destructor (sp->entries, NULL);
+    zhashx_set_destructor (sp->entries, entry_destructor);
+    return sp;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,41 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _FLUX_JOB_LIST_STRPOOL_H
+#define _FLUX_JOB_LIST_STRPOOL_H
+
+#include <stddef.h>
+
+/* Reference counted pool of interned strings.  Strings such as queue,
+ * project, bank, and job name repeat across many jobs, so inactive jobs
+ * share one copy of each instead of holding their own.
+ */
+struct strpool *strpool_create (void);
+void strpool_destroy (struct strpool *sp);
+
+/* Return the interned copy of 's', taking a reference on it.
+ * Returns NULL if 's' is NULL or on allocation failure.
+ */
+const char *strpool_intern (struct strpool *sp, const char *s);
+
+/* Drop a reference on 's', which must have been returned by
+ * strpool_intern().  NULL is ignored.
+ */
+void strpool_release (struct strpool *sp, const char *s);
+
+/* Return the number of distinct strings in the pool.
+ */
+size_t strpool_count (struct strpool *sp);
+
+#endif /* ! _FLUX_JOB_LIST_STRPOOL_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -16,6 +16,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <errno.h>
 
 #include "src/common/libtap/tap.h"
 #include "src/common/libutil/read_all.h"
@@ -866,6 +867,93 @@ static void test_R_update (void)
     free (data);
 }
 
+static void test_R_summary (void)
+{
+    struct job *job = job_create (NULL, FLUX_JOBID_ANY);
+    const char *filename = TEST_SRCDIR "/R/4node_4core.R";
+    char *data;
+
+    if (!job)
+        BAIL_OUT ("job_create failed");
+
+    /* Use values that differ from R to show the summary is preferred.
+     */
+    if (!(job->R_summary = json_pack ("{s:i s:i s:s s:s}",
+                                      "nnodes", 3,
+                                      "ncores", 7,
+                                      "ranks", "[5-7]",
+                                      "nodelist", "bar[5-7]")))
+        BAIL_OUT ("json_pack failed");
+    read_file (filename, (void **)&data);
+    ok (job_parse_R_fatal (job, data, NULL) == 0,
+        "job_parse_R works with R_summary");
+    ok (job->nnodes == 3
+        && job->ncores == 7
+        && job->ranks && streq (job->ranks, "[5-7]")
+        && job->nodelist && streq (job->nodelist, "bar[5-7]"),
+        "job_parse_R took nnodes, ncores, ranks, nodelist from R_summary");
+    job_destroy (job);
+
+    if (!(job = job_create (NULL, FLUX_JOBID_ANY)))
+        BAIL_OUT ("job_create failed");
+    if (!(job->R_summary = json_pack ("{s:i}", "nnodes", 3)))
+        BAIL_OUT ("json_pack failed");
+    ok (job_parse_R_fatal (job, data, NULL) == 0,
+        "job_parse_R works with invalid R_summary");
+    ok (job->nnodes == 4
+        && job->ncores == 16
+        && job->nodelist && streq (job->nodelist, "node[1-4]"),
+        "job_parse_R ignored invalid R_summary");
+    job_destroy (job);
+
+    free (data);
+}
+
+static void test_compact (void)
+{
+    const char *filename = TEST_SRCDIR "/jobspec/1slot_project_bank.jobspec";
+    struct strpool *pool;
+    struct job *job1, *job2;
+
+    if (!(pool = strpool_create ()))
+        BAIL_OUT ("strpool_create failed");
+    if (!(job1 = job_create (NULL, FLUX_JOBID_ANY))
+        || !(job2 = job_create (NULL, FLUX_JOBID_ANY)))
+        BAIL_OUT ("job_create failed");
+    if (parse_jobspec (job1, filename) < 0
+        || parse_jobspec (job2, filename) < 0)
+        BAIL_OUT ("parse_jobspec failed");
+
+    ok (job_compact (job1, pool) == 0,
+        "job_compact works");
+    ok (job1->jobspec == NULL && job1->R == NULL,
+        "job_compact dropped jobspec and R");
+    ok (job1->pool == pool
+        && job1->project && streq (job1->project, "myproject")
+        && job1->bank && streq (job1->bank, "mybank"),
+        "job_compact kept project and bank");
+    ok (job_compact (job1, pool) == 0,
+        "job_compact is a no-op on a compacted job");
+    ok (job_compact (job2, pool) == 0,
+        "job_compact works on second job");
+    ok (job1->project == job2->project
+        && job1->bank == job2->bank
+        && job1->name == job2->name,
+        "compacted jobs share interned strings");
+    ok (strpool_count (pool) > 0,
+        "strpool holds interned strings");
+    job_destroy (job1);
+    job_destroy (job2);
+    ok (strpool_count (pool) == 0,
+        "strings were released when jobs were destroyed");
+
+    errno = 0;
+    ok (job_compact (NULL, pool) < 0 && errno == EINVAL,
+        "job_compact job=NULL fails with EINVAL");
+
+    strpool_destroy (pool);
+}
+
 int main (int argc, char *argv[])
 {
     plan (NO_PLAN);
@@ -884,6 +972,8 @@ int main (int argc, char *argv[])
     test_ncores ();
     test_jobspec_update ();
     test_R_update ();
+    test_R_summary ();
+    test_compact ();
 
     done_testing ();
 }
@@ -0,0 +1,174 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <jansson.h>
+#include <flux/core.h>
+
+#include "src/common/libtap/tap.h"
+#include "src/modules/job-list/job_data.h"
+#include "src/modules/job-list/job_index.h"
+
+#define NJOBS 12
+
+static struct job *jobs[NJOBS];
+
+/* Job i belongs to userid 100 + i % 3, queue "q<i % 2>", and
+ * alternates between COMPLETED and FAILED, except job 0 which was
+ * CANCELED.  Later jobs became inactive later.
+ */
+static void create_jobs (struct job_index *idx)
+{
+    int i;
+
+    for (i = 0; i < NJOBS; i++) {
+        if (!(jobs[i] = job_create (NULL, i + 1)))
+            BAIL_OUT ("job_create failed");
+        jobs[i]->userid = 100 + i % 3;
+        jobs[i]->queue = i % 2 ? "q1" : "q0";
+        if (i == 0)
+            jobs[i]->result = FLUX_JOB_RESULT_CANCELED;
+        else if (i % 2)
+            jobs[i]->result = FLUX_JOB_RESULT_COMPLETED;
+        else
+            jobs[i]->result = FLUX_JOB_RESULT_FAILED;
+        jobs[i]->t_inactive = 1000. + i;
+        if (job_index_add (idx, jobs[i]) < 0)
+            BAIL_OUT ("job_index_add failed");
+    }
+}
+
+static zlistx_t *select_str (struct job_index *idx, const char *s)
+{
+    json_t *constraint;
+    zlistx_t *l;
+
+    if (!(constraint = json_loads (s, 0, NULL)))
+        BAIL_OUT ("failed to parse constraint %s", s);
+    l = job_index_select (idx, constraint);
+    json_decref (constraint);
+    return l;
+}
+
+static void test_select (struct job_index *idx)
+{
+    struct {
+        const char *constraint;
+        int size;               // -1 = no index
+    } tests[] = {
+        { "{}", -1 },
+        { "{\"name\":[\"foo\"]}", -1 },
+        { "{\"userid\":[100]}", 4 },
+        { "{\"userid\":[100, 101]}", -1 },
+        { "{\"userid\":[4294967295]}", -1 },
+        { "{\"userid\":[-1]}", -1 },
+        { "{\"userid\":[42]}", 0 },
+        { "{\"queue\":[\"q0\"]}", 6 },
+        { "{\"queue\":[\"nosuch\"]}", 0 },
+        { "{\"results\":[\"completed\"]}", 6 },
+        { "{\"results\":[\"canceled\"]}", 1 },
+        { "{\"results\":[2]}", 5 },
+        { "{\"results\":[3]}", -1 },
+        { "{\"results\":[\"completed\", \"failed\"]}", -1 },
+        { "{\"and\":[{\"queue\":[\"q1\"]},{\"userid\":[101]}]}", 4 },
+        { "{\"and\":[{\"queue\":[\"q0\"]},{\"results\":[\"canceled\"]}]}", 1 },
+        { "{\"and\":[{\"name\":[\"foo\"]},{\"and\":[{\"userid\":[102]}]}]}", 4 },
+        { "{\"or\":[{\"userid\":[100]},{\"userid\":[101]}]}", -1 },
+        { "{\"not\":[{\"userid\":[100]}]}", -1 },
+        { NULL, 0 },
+    };
+    int i;
+
+    for (i = 0; tests[i].constraint; i++) {
+        zlistx_t *l = select_str (idx, tests[i].constraint);
+        if (tests[i].size < 0)
+            ok (l == NULL,
+                "job_index_select %s uses no index",
+                tests[i].constraint);
+        else
+            ok (l != NULL && zlistx_size (l) == tests[i].size,
+                "job_index_select %s returns %d jobs",
+                tests[i].constraint,
+                tests[i].size);
+    }
+    ok (job_index_select (idx, NULL) == NULL,
+        "job_index_select constraint=NULL uses no index");
+}
+
+static void test_order (struct job_index *idx)
+{
+    zlistx_t *l;
+    struct job *job;
+    double t = 1E9;
+    bool sorted = true;
+
+    l = select_str (idx, "{\"queue\":[\"q1\"]}");
+    job = zlistx_first (l);
+    while (job) {
+        if (job->t_inactive >= t)
+            sorted = false;
+        t = job->t_inactive;
+        job = zlistx_next (l);
+    }
+    ok (sorted, "index list is sorted by t_inactive, latest first");
+}
+
+static void test_remove (struct job_index *idx)
+{
+    zlistx_t *l;
+    int i;
+
+    job_index_remove (idx, jobs[0]);
+    ok (jobs[0]->index_handle[0] == NULL
+        && jobs[0]->index_handle[1] == NULL
+        && jobs[0]->index_handle[2] == NULL,
+        "job_index_remove clears index handles");
+    l = select_str (idx, "{\"results\":[\"canceled\"]}");
+    ok (l != NULL && zlistx_size (l) == 0,
+        "removing last job with key empties its list");
+    l = select_str (idx, "{\"userid\":[100]}");
+    ok (l != NULL && zlistx_size (l) == 3,
+        "removed job is no longer in userid index");
+    job_index_remove (idx, jobs[0]);
+    pass ("job_index_remove on unindexed job is a no-op");
+
+    for (i = 1; i < NJOBS; i++)
+        job_index_remove (idx, jobs[i]);
+    l = select_str (idx, "{\"queue\":[\"q1\"]}");
+    ok (l != NULL && zlistx_size (l) == 0,
+        "all jobs removed from index");
+}
+
+int main (int argc, char *argv[])
+{
+    struct job_index *idx;
+    int i;
+
+    plan (NO_PLAN);
+
+    if (!(idx = job_index_create ()))
+        BAIL_OUT ("job_index_create failed");
+    create_jobs (idx);
+    test_select (idx);
+    test_order (idx);
+    test_remove (idx);
+    job_index_destroy (idx);
+
+    for (i = 0; i < NJOBS; i++)
+        job_destroy (jobs[i]);
+
+    done_testing ();
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -1542,6 +1542,128 @@ static void test_realworld (void)
     }
 }
 
+/* Constraints that are simplified before evaluation must still give
+ * the same result as the constraint as written.
+ */
+struct simplify_test {
+    const char *constraint;
+    uint32_t userid;
+    const char *queue;
+    flux_job_state_t state;
+    flux_job_result_t result;
+    bool expected;
+};
+
+struct simplify_test simplify_tests[] = {
+    { "{\"or\":[]}", 42, "q", FLUX_JOB_STATE_RUN, 0, true },
+    { "{\"and\":[]}", 42, "q", FLUX_JOB_STATE_RUN, 0, true },
+    { "{\"not\":[]}", 42, "q", FLUX_JOB_STATE_RUN, 0, false },
+    { "{\"or\":[{\"states\":[]}]}", 42, "q", FLUX_JOB_STATE_RUN, 0, false },
+    { "{\"or\":[{\"userid\":[]},{\"name\":[]}]}",
+      42, "q", FLUX_JOB_STATE_RUN, 0, false },
+    { "{\"or\":[{\"userid\":[1]},{\"userid\":[42]}]}",
+      42, "q", FLUX_JOB_STATE_RUN, 0, true },
+    { "{\"or\":[{\"userid\":[1]},{\"or\":[{\"userid\":[2]}]}]}",
+      42, "q", FLUX_JOB_STATE_RUN, 0, false },
+    { "{\"or\":[{\"userid\":[42, 1, 42]},{\"queue\":[\"x\"]}]}",
+      42, "q", FLUX_JOB_STATE_RUN, 0, true },
+    { "{\"or\":[{\"queue\":[\"x\"]},{\"queue\":[\"q\"]}]}",
+      42, "q", FLUX_JOB_STATE_RUN, 0, true },
+    { "{\"and\":[{\"userid\":[42]},{\"userid\":[1]}]}",
+      42, "q", FLUX_JOB_STATE_RUN, 0, false },
+    { "{\"and\":[{\"userid\":[4294967295]},{\"queue\":[\"q\"]}]}",
+      42, "q", FLUX_JOB_STATE_RUN, 0, true },
+    { "{\"and\":[{\"states\":[\"pending\",\"running\"]},"
+      "{\"states\":[\"running\",\"inactive\"]}]}",
+      42, "q", FLUX_JOB_STATE_RUN, 0, true },
+    { "{\"and\":[{\"states\":[\"pending\"]},"
+      "{\"states\":[\"running\"]}]}",
+      42, "q", FLUX_JOB_STATE_RUN, 0, false },
+    { "{\"and\":[{\"queue\":[\"q\"]},"
+      "{\"and\":[{\"states\":[\"pending\"]},"
+      "{\"states\":[\"running\"]}]}]}",
+      42, "q", FLUX_JOB_STATE_RUN, 0, false },
+    { "{\"or\":[{\"results\":[\"failed\"]},"
+      "{\"results\":[\"completed\"]}]}",
+      42, "q", FLUX_JOB_STATE_INACTIVE, FLUX_JOB_RESULT_COMPLETED, true },
+    { "{\"or\":[{\"results\":[\"failed\"]},"
+      "{\"results\":[\"completed\"]}]}",
+      42, "q", FLUX_JOB_STATE_RUN, FLUX_JOB_RESULT_COMPLETED, false },
+    { "{\"and\":[{\"results\":[\"failed\",\"completed\"]},"
+      "{\"results\":[\"completed\"]}]}",
+      42, "q", FLUX_JOB_STATE_INACTIVE, FLUX_JOB_RESULT_COMPLETED, true },
+    { "{\"not\":[{\"not\":[{\"userid\":[42]}]}]}",
+      42, "q", FLUX_JOB_STATE_RUN, 0, true },
+    { "{\"not\":[{\"userid\":[42]},{\"queue\":[\"q\"]}]}",
+      42, "q", FLUX_JOB_STATE_RUN, 0, false },
+    { "{\"not\":[{\"userid\":[42]},{\"queue\":[\"x\"]}]}",
+      42, "q", FLUX_JOB_STATE_RUN, 0, true },
+    { "{\"or\":[{\"and\":[{\"userid\":[1]},{\"queue\":[\"q\"]}]},"
+      "{\"and\":[{\"userid\":[42]},{\"not\":[{\"queue\":[\"x\"]}]}]}]}",
+      42, "q", FLUX_JOB_STATE_RUN, 0, true },
+    { "{\"and\":[{\"or\":[{\"userid\":[1]},{\"queue\":[\"q\"]}]},"
+      "{\"or\":[{\"userid\":[2]},{\"states\":[\"pending\"]}]}]}",
+      42, "q", FLUX_JOB_STATE_RUN, 0, false },
+    { NULL, 0, NULL, 0, 0, false },
+};
+
+static void test_simplify (void)
+{
+    struct simplify_test *t;
+
+    for (t = simplify_tests; t->constraint; t++) {
+        struct list_constraint *c;
+        struct job *job;
+        flux_error_t error;
+        int rv;
+
+        c = create_list_constraint (t->constraint);
+        job = setup_job (t->userid,
+                         NULL,
+                         t->queue,
+                         t->state,
+                         t->result,
+                         0.0,
+                         0.0,
+                         0.0,
+                         0.0,
+                         0.0);
+        rv = job_match (job, c, &error);
+        ok (rv == t->expected,
+            "simplified %s returns %s",
+            t->constraint,
+            t->expected ? "true" : "false");
+        job_destroy (job);
+        list_constraint_destroy (c);
+    }
+}
+
+static void test_comparisons (void)
+{
+    struct match_ctx limit_mctx = { .h = NULL, .max_comparisons = 2 };
+    struct job *job = setup_job (42, NULL, "q", FLUX_JOB_STATE_RUN, 0,
+                                 0.0, 0.0, 0.0, 0.0, 0.0);
+    struct list_constraint *c;
+    flux_error_t error;
+    json_t *jc;
+
+    if (!(jc = json_loads ("{\"userid\":[1, 2, 3, 4, 42]}", 0, NULL)))
+        BAIL_OUT ("json constraint invalid");
+    if (!(c = list_constraint_create (&limit_mctx, jc, &error)))
+        BAIL_OUT ("list constraint create fail: %s", error.text);
+    ok (job_match (job, c, &error) == 1,
+        "userid test with many values counts one comparison");
+    ok (job_match (job, c, &error) == 1,
+        "second match is within max_comparisons");
+    ok (job_match (job, c, &error) < 0,
+        "third match exceeds max_comparisons");
+    like (error.text, "Excessive comparisons",
+          "error is as expected");
+    list_constraint_destroy (c);
+    json_decref (jc);
+    job_destroy (job);
+}
+
 int main (int argc, char *argv[])
 {
     plan (NO_PLAN);
@@ -1556,6 +1678,8 @@ int main (int argc, char *argv[])
     test_basic_timestamp ();
     test_basic_conditionals ();
     test_realworld ();
+    test_simplify ();
+    test_comparisons ();
 
     done_testing ();
 }
@@ -0,0 +1,331 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* watch.c - stream changes to a job listing
+ *
+ * A job-list.watch request takes the same "attrs" and "constraint" as
+ * job-list.list, and an optional "max_entries" limit for the snapshot:
+ *   {"attrs":[...], "constraint"?o, "max_entries"?i}
+ *
+ * The first response is a snapshot of matching jobs, in the same order
+ * as job-list.list:
+ *   {"jobs":[...]}
+ *
+ * Each following response describes one change to the watcher's view,
+ * which is the set of jobs it has been sent:
+ *   {"op":"insert", "job":{...}}   a job now matches the constraint
+ *   {"op":"update", "job":{...}}   a job in the view has changed
+ *   {"op":"remove", "job":{"id":I}} a job no longer matches, or is gone
+ *
+ * If the snapshot was limited by max_entries, a matching job that was
+ * left out is inserted the next time it changes.
+ *
+ * Changes are driven by the journal events applied in job_state.c, and
+ * the constraint is only evaluated against the job that changed, so the
+ * cost is proportional to the rate of change rather than the number of
+ * jobs.  The stream ends when the request is canceled with
+ * job-list.watch-cancel or the client disconnects.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <jansson.h>
+#include <flux/core.h>
+
+#include "src/common/libutil/errno_safe.h"
+#include "src/common/libutil/errprintf.h"
+#include "src/common/libjob/jobmap.h"
+
+#include "job-list.h"
+#include "list.h"
+#include "job_cache.h"
+#include "match.h"
+#include "state_match.h"
+#include "watch.h"
+
+struct watch_ctx {
+    struct list_ctx *ctx;
+    flux_msg_handler_t **handlers;
+    struct flux_msglist *watchers;
+};
+
+struct watcher {                // stored as aux item in request message
+    json_t *attrs;              // owned by message
+    const char *sig;            // interned by job cache
+    struct list_constraint *c;
+    struct jobmap *view;        // ids of jobs sent to the client
+};
+
+static char in_view;            // jobmap value, only its address is used
+
+static void watcher_destroy (struct watcher *w)
+{
+    if (w) {
+        int saved_errno = errno;
+        list_constraint_destroy (w->c);
+        jobmap_destroy (w->view);
+        free (w);
+        errno = saved_errno;
+    }
+}
+
+static int view_add_jobs (struct watcher *w, json_t *jobs)
+{
+    size_t index;
+    json_t *entry;
+
+    json_array_foreach (jobs, index, entry) {
+        flux_jobid_t id;
+
+        if (json_unpack (entry, "{s:I}", "id", &id) < 0) {
+            errno = EPROTO;
+            return -1;
+        }
+        if (jobmap_insert (w->view, id, &in_view) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+static int watch_respond (struct watch_ctx *wctx,
+                          const flux_msg_t *msg,
+                          const char *op,
+                          json_t *job)
+{
+    return flux_respond_pack (wctx->ctx->h,
+                              msg,
+                              "{s:s s:O}",
+                              "op", op,
+                              "job", job);
+}
+
+/* Send the change to 'job' (NULL if it is gone) to one watcher, if it
+ * affects the watcher's view.
+ */
+static int watch_job_check (struct watch_ctx *wctx,
+                            const flux_msg_t *msg,
+                            struct watcher *w,
+                            flux_jobid_t id,
+                            struct job *job)
+{
+    bool known = jobmap_lookup (w->view, id) != NULL;
+    flux_error_t error;
+    json_t *o;
+    int match = 0;
+    int rc;
+
+    if (job && (match = job_match (job, w->c, &error)) < 0) {
+        flux_log (wctx->ctx->h,
+                  LOG_ERR,
+                  "job-list.watch: %s",
+                  error.text);
+        return -1;
+    }
+    if (!match) {
+        if (!known)
+            return 0;
+        jobmap_delete (w->view, id);
+        if (!(o = json_pack ("{s:I}", "id", id))) {
+            errno = ENOMEM;
+            return -1;
+        }
+        rc = watch_respond (wctx, msg, "remove", o);
+        ERRNO_SAFE_WRAP (json_decref, o);
+        return rc;
+    }
+    if (!known && jobmap_insert (w->view, id, &in_view) < 0)
+        return -1;
+    if (!(o = job_cache_to_json (wctx->ctx->jsctx->cache,
+                                 job,
+                                 w->attrs,
+                                 w->sig,
+                                 &error)))
+        return -1;
+    rc = watch_respond (wctx, msg, known ? "update" : "insert", o);
+    ERRNO_SAFE_WRAP (json_decref, o);
+    return rc;
+}
+
+void watch_job_update (struct watch_ctx *wctx,
+                       flux_jobid_t id,
+                       struct job *job)
+{
+    const flux_msg_t *msg;
+
+    /* Jobs still being processed are not yet on any job list.
+     */
+    if (job && job->state == FLUX_JOB_STATE_NEW)
+        return;
+    msg = flux_msglist_first (wctx->watchers);
+    while (msg) {
+        struct watcher *w = flux_msg_aux_get (msg, "watcher");
+
+        if (watch_job_check (wctx, msg, w, id, job) < 0) {
+            if (flux_respond_error (wctx->ctx->h, msg, errno, NULL) < 0)
+                flux_log_error (wctx->ctx->h,
+                                "error responding to job-list.watch");
+            flux_msglist_delete (wctx->watchers);
+        }
+        msg = flux_msglist_next (wctx->watchers);
+    }
+}
+
+static void watch_cb (flux_t *h,
+                      flux_msg_handler_t *mh,
+                      const flux_msg_t *msg,
+                      void *arg)
+{
+    struct watch_ctx *wctx = arg;
+    struct list_ctx *ctx = wctx->ctx;
+    struct watcher *w = NULL;
+    json_t *attrs;
+    json_t *constraint = NULL;
+    int max_entries = 0;
+    struct state_constraint *statec = NULL;
+    json_t *jobs = NULL;
+    char next[128];
+    flux_error_t error;
+    flux_error_t err = {{0}};
+
+    if (!ctx->jsctx->initialized) {
+        if (flux_msglist_append (ctx->deferred_requests, msg) < 0)
+            goto error;
+        return;
+    }
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s:o s?o s?i}",
+                             "attrs", &attrs,
+                             "constraint", &constraint,
+                             "max_entries", &max_entries) < 0) {
+        errprintf (&err, "invalid payload: %s", flux_msg_last_error (msg));
+        errno = EPROTO;
+        goto error;
+    }
+    if (!flux_msg_is_streaming (msg)) {
+        errprintf (&err, "job-list.watch requires streaming RPC flag");
+        errno = EPROTO;
+        goto error;
+    }
+    if (max_entries < 0) {
+        errprintf (&err, "invalid payload: max_entries < 0 not allowed");
+        errno = EPROTO;
+        goto error;
+    }
+    if (!json_is_array (attrs)) {
+        errprintf (&err, "invalid payload: attrs must be an array");
+        errno = EPROTO;
+        goto error;
+    }
+    if (!(w = calloc (1, sizeof (*w)))
+        || !(w->view = jobmap_create ()))
+        goto error;
+    w->attrs = attrs;
+    w->sig = job_cache_signature (ctx->jsctx->cache, attrs);
+    if (!(w->c = list_constraint_create (ctx->mctx, constraint, &error))
+        || !(statec = state_constraint_create (constraint, &error))) {
+        errprintf (&err,
+                   "invalid payload: constraint object invalid: %s",
+                   error.text);
+        errno = EPROTO;
+        goto error;
+    }
+    if (!(jobs = get_jobs (ctx->jsctx, &err, max_entries, 0.,
+                           attrs, constraint, w->c, statec,
+                           NULL, next, sizeof (next)))
+        || view_add_jobs (w, jobs) < 0
+        || flux_msg_aux_set (msg,
+                             "watcher",
+                             w,
+                             (flux_free_f)watcher_destroy) < 0)
+        goto error;
+    w = NULL; // now owned by msg
+    if (flux_respond_pack (h, msg, "{s:O}", "jobs", jobs) < 0)
+        flux_log_error (h, "error responding to job-list.watch");
+    else if (flux_msglist_append (wctx->watchers, msg) < 0)
+        goto error;
+    json_decref (jobs);
+    state_constraint_destroy (statec);
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, err.text[0] ? err.text : NULL) < 0)
+        flux_log_error (h, "error responding to job-list.watch");
+    ERRNO_SAFE_WRAP (json_decref, jobs);
+    state_constraint_destroy (statec);
+    watcher_destroy (w);
+}
+
+static void watch_cancel_cb (flux_t *h,
+                             flux_msg_handler_t *mh,
+                             const flux_msg_t *msg,
+                             void *arg)
+{
+    struct watch_ctx *wctx = arg;
+
+    if (flux_msglist_cancel (h, wctx->watchers, msg) < 0)
+        flux_log_error (h, "error handling job-list.watch-cancel");
+}
+
+void watch_disconnect (struct watch_ctx *wctx, const flux_msg_t *msg)
+{
+    flux_msglist_disconnect (wctx->watchers, msg);
+}
+
+int watch_count (struct watch_ctx *wctx)
+{
+    return flux_msglist_count (wctx->watchers);
+}
+
+static const struct flux_msg_handler_spec htab[] = {
+    { .typemask     = FLUX_MSGTYPE_REQUEST,
+      .topic_glob   = "job-list.watch",
+      .cb           = watch_cb,
+      .rolemask     = FLUX_ROLE_USER
+    },
+    { .typemask     = FLUX_MSGTYPE_REQUEST,
+      .topic_glob   = "job-list.watch-cancel",
+      .cb           = watch_cancel_cb,
+      .rolemask     = FLUX_ROLE_USER
+    },
+    FLUX_MSGHANDLER_TABLE_END,
+};
+
+struct watch_ctx *watch_ctx_create (struct list_ctx *ctx)
+{
+    struct watch_ctx *wctx;
+
+    if (!(wctx = calloc (1, sizeof (*wctx))))
+        return NULL;
+    wctx->ctx = ctx;
+    if (!(wctx->watchers = flux_msglist_create ())
+        || flux_msg_handler_addvec (ctx->h,
+                                    htab,
+                                    wctx,
+                                    &wctx->handlers) < 0)
+        goto error;
+    return wctx;
+error:
+    watch_ctx_destroy (wctx);
+    return NULL;
+}
+
+void watch_ctx_destroy (struct watch_ctx *wctx)
+{
+    if (wctx) {
+        int saved_errno = errno;
+        flux_msg_handler_delvec (wctx->handlers);
+        flux_msglist_destroy (wctx->watchers);
+        free (wctx);
+        errno = saved_errno;
+    }
+}
+
+// vi: ts=4 sw=4 expandtab
@@ -0,0 +1,41 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _FLUX_JOB_LIST_WATCH_H
+#define _FLUX_JOB_LIST_WATCH_H
+
+#include <flux/core.h>
+
+struct list_ctx;
+struct job;
+
+struct watch_ctx *watch_ctx_create (struct list_ctx *ctx);
+
+void watch_ctx_destroy (struct watch_ctx *wctx);
+
+/* Job 'id' has changed.  Send insert, update, or remove responses to
+ * job-list.watch streams as needed.  'job' is NULL if it was removed.
+ */
+void watch_job_update (struct watch_ctx *wctx,
+                       flux_jobid_t id,
+                       struct job *job);
+
+/* A client has disconnected from job-list.
+ * Cancel streaming job-list.watch requests, if any.
+ */
+void watch_disconnect (struct watch_ctx *wctx, const flux_msg_t *msg);
+
+/* Return the number of job-list.watch streaming clients.
+ */
+int watch_count (struct watch_ctx *wctx);
+
+#endif /* ! _FLUX_JOB_LIST_WATCH_H */
+
+// vi: ts=4 sw=4 expandtab
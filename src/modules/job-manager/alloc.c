@@ -28,6 +28,9 @@
 #include "src/common/libjob/idf58.h"
 #include "src/common/librlist/rlist.h"
 #include "src/common/libutil/errprintf.h"
+#include "src/common/libutil/errno_safe.h"
+#include "src/common/libutil/heap.h"
+#include "src/common/libutil/monotime.h"
 #include "ccan/str/str.h"
 
 #include "job.h"
@@ -41,8 +44,8 @@
 struct alloc {
     struct job_manager *ctx;
     flux_msg_handler_t **handlers;
-    zlistx_t *queue;
-    zlistx_t *pending_jobs;
+    struct heap *queue;         // jobs awaiting alloc, in priority order
+    zlistx_t *pending_jobs;     // jobs with alloc pending (limited mode)
     bool ready;
     bool stopped;
     char *stopped_reason;
@@ -54,12 +57,19 @@ struct alloc {
     // e.g. for mode limited w/ limit=1, max of 1
     unsigned int alloc_pending_count;
     char *sched_sender; // for disconnect
+    int defer;          // reorder deferred while > 0
+    bool reorder;       // reorder needed when no longer deferred
+    bool batch;         // scheduler accepted batched alloc/free
+    json_t *free_batch; // free requests not yet sent in batched mode
 };
 
+/* Max number of jobs in one sched.alloc-batch or sched.free-batch request.
+ */
+static const size_t batch_max = 1024;
+
 static void requeue_pending (struct alloc *alloc, struct job *job)
 {
     struct job_manager *ctx = alloc->ctx;
-    bool fwd = job->priority > (FLUX_JOB_PRIORITY_MAX / 2);
 
     assert (job->alloc_pending);
     if (job->handle) {
@@ -69,7 +79,7 @@ static void requeue_pending (struct alloc *alloc, struct job *job)
     }
     job->alloc_pending = 0;
     if (queue_started (alloc->ctx->queue, job)) {
-        if (!(job->handle = zlistx_insert (alloc->queue, job, fwd)))
+        if (!(job->handle = heap_insert (alloc->queue, job)))
             flux_log (ctx->h, LOG_ERR, "failed to enqueue job for scheduling");
         job->alloc_queued = 1;
     }
@@ -88,30 +98,68 @@ static void interface_teardown (struct alloc *alloc, char *s, int errnum)
         flux_log (ctx->h, LOG_DEBUG, "alloc: stop due to %s: %s",
                   s, flux_strerror (errnum));
 
-        job = zhashx_first (ctx->active_jobs);
+        job = jobmap_first (ctx->active_jobs);
         while (job) {
             /* jobs with alloc request pending need to go back in the queue
              * so they will automatically send alloc again.
              */
             if (job->alloc_pending)
                 requeue_pending (alloc, job);
-            job = zhashx_next (ctx->active_jobs);
+            job = jobmap_next (ctx->active_jobs);
         }
         alloc->ready = false;
         alloc->alloc_pending_count = 0;
+        alloc->batch = false;
+        json_array_clear (alloc->free_batch);
         free (alloc->sched_sender);
         alloc->sched_sender = NULL;
         drain_check (alloc->ctx->drain);
     }
 }
 
-/* Send sched.free request for job.
+/* Send queued free requests in one sched.free-batch request.
+ */
+static int free_batch_flush (struct alloc *alloc)
+{
+    flux_msg_t *msg;
+
+    if (json_array_size (alloc->free_batch) == 0)
+        return 0;
+    if (!(msg = flux_request_encode ("sched.free-batch", NULL)))
+        return -1;
+    if (flux_msg_pack (msg, "{s:O}", "jobs", alloc->free_batch) < 0)
+        goto error;
+    if (flux_send (alloc->ctx->h, msg, 0) < 0)
+        goto error;
+    flux_msg_destroy (msg);
+    json_array_clear (alloc->free_batch);
+    return 0;
+error:
+    flux_msg_destroy (msg);
+    json_array_clear (alloc->free_batch);
+    return -1;
+}
+
+/* Send sched.free request for job, or queue it in batched mode.
  * Update flags.
  */
 int free_request (struct alloc *alloc, flux_jobid_t id, json_t *R)
 {
     flux_msg_t *msg;
 
+    if (alloc->batch) {
+        json_t *o;
+
+        if (!(o = json_pack ("{s:I s:O}", "id", id, "R", R))
+            || json_array_append_new (alloc->free_batch, o) < 0) {
+            json_decref (o);
+            errno = ENOMEM;
+            return -1;
+        }
+        if (json_array_size (alloc->free_batch) >= batch_max)
+            return free_batch_flush (alloc);
+        return 0;
+    }
     if (!(msg = flux_request_encode ("sched.free", NULL)))
         return -1;
     if (flux_msg_pack (msg,
@@ -148,44 +196,56 @@ int cancel_request (struct alloc *alloc, struct job *job)
     return 0;
 }
 
-/* Handle a sched.alloc response.
- * Update flags.
+/* When stats are enabled, note when the alloc request for 'job' was sent
+ * so the scheduler's response time can be reported.
  */
-static void alloc_response_cb (flux_t *h,
-                               flux_msg_handler_t *mh,
-                               const flux_msg_t *msg,
-                               void *arg)
+static void alloc_timing_start (struct alloc *alloc, struct job *job)
+{
+    struct timespec *t0;
+
+    if (!flux_stats_enabled (alloc->ctx->h, NULL)
+        || !(t0 = malloc (sizeof (*t0))))
+        return;
+    monotime (t0);
+    if (job_aux_set (job, "alloc-t0", t0, free) < 0)
+        free (t0);
+}
+
+static void alloc_timing_end (struct alloc *alloc, struct job *job)
+{
+    struct timespec *t0 = job_aux_get (job, "alloc-t0");
+
+    if (t0) {
+        flux_stats_timing (alloc->ctx->h,
+                           "job-manager.alloc",
+                           monotime_since (*t0));
+        job_aux_delete (job, t0);
+    }
+}
+
+/* Process one alloc response from the scheduler.
+ * Update flags.  Return -1 if the interface should be torn down.
+ */
+static int alloc_response (struct job_manager *ctx,
+                           flux_jobid_t id,
+                           int type,
+                           const char *note,
+                           json_t *annotations,
+                           json_t *R)
 {
-    struct job_manager *ctx = arg;
     struct alloc *alloc = ctx->alloc;
-    flux_jobid_t id;
-    int type;
-    char *note = NULL;
-    json_t *annotations = NULL;
-    json_t *R = NULL;
     struct job *job;
 
-    if (flux_response_decode (msg, NULL, NULL) < 0)
-        goto teardown; // ENOSYS here if scheduler not loaded/shutting down
-    if (flux_msg_unpack (msg,
-                         "{s:I s:i s?s s?o s?o}",
-                         "id", &id,
-                         "type", &type,
-                         "note", &note,
-                         "annotations", &annotations,
-                         "R", &R) < 0)
-        goto teardown;
-
-    job = zhashx_lookup (ctx->active_jobs, &id);
+    job = jobmap_lookup (ctx->active_jobs, id);
     if (job && !job->alloc_pending)
         job = NULL;
 
     switch (type) {
     case FLUX_SCHED_ALLOC_SUCCESS:
         if (!R) {
-            flux_log (h, LOG_ERR, "sched.alloc-response: protocol error");
+            flux_log (ctx->h, LOG_ERR, "sched.alloc-response: protocol error");
             errno = EPROTO;
-            goto teardown;
+            return -1;
         }
         (void)json_object_del (R, "scheduling");
         alloc->alloc_pending_count--;
@@ -200,16 +260,17 @@ static void alloc_response_cb (flux_t *h,
             job->handle = NULL;
         }
         if (job->has_resources || job->R_redacted) {
-            flux_log (h,
+            flux_log (ctx->h,
                       LOG_ERR,
                       "sched.alloc-response: id=%s already allocated",
                       idf58 (id));
             errno = EEXIST;
-            goto teardown;
+            return -1;
         }
         job->R_redacted = json_incref (R);
+        alloc_timing_end (alloc, job);
         if (annotations_update_and_publish (ctx, job, annotations) < 0)
-            flux_log_error (h, "annotations_update: id=%s", idf58 (id));
+            flux_log_error (ctx->h, "annotations_update: id=%s", idf58 (id));
 
         /*  Only modify job state after annotation event is published
          */
@@ -221,22 +282,22 @@ static void alloc_response_cb (flux_t *h,
                                      0,
                                      "{s:O}",
                                      "annotations", job->annotations) < 0)
-                goto teardown;
+                return -1;
         }
         else {
             if (event_job_post_pack (ctx->event, job, "alloc", 0, NULL) < 0)
-                goto teardown;
+                return -1;
         }
         break;
     case FLUX_SCHED_ALLOC_ANNOTATE: // annotation
         if (!annotations) {
             errno = EPROTO;
-            goto teardown;
+            return -1;
         }
         if (!job)
             break;
         if (annotations_update_and_publish (ctx, job, annotations) < 0)
-            flux_log_error (h, "annotations_update: id=%s", idf58 (id));
+            flux_log_error (ctx->h, "annotations_update: id=%s", idf58 (id));
         break;
     case FLUX_SCHED_ALLOC_DENY: // error
         alloc->alloc_pending_count--;
@@ -255,7 +316,7 @@ static void alloc_response_cb (flux_t *h,
                                  0,
                                  ctx->owner,
                                  note) < 0)
-            goto teardown;
+            return -1;
         break;
     case FLUX_SCHED_ALLOC_CANCEL:
         alloc->alloc_pending_count--;
@@ -274,39 +335,166 @@ static void alloc_response_cb (flux_t *h,
         job->alloc_pending = 0;
         if (queue_started (alloc->ctx->queue, job)) {
             if (event_job_action (ctx->event, job) < 0) {
-                flux_log_error (h,
+                flux_log_error (ctx->h,
                                 "event_job_action id=%s on alloc cancel",
                                 idf58 (id));
-                goto teardown;
+                return -1;
             }
         }
         drain_check (alloc->ctx->drain);
         break;
     default:
         errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
+
+/* Handle a sched.alloc response.
+ */
+static void alloc_response_cb (flux_t *h,
+                               flux_msg_handler_t *mh,
+                               const flux_msg_t *msg,
+                               void *arg)
+{
+    struct job_manager *ctx = arg;
+    flux_jobid_t id;
+    int type;
+    const char *note = NULL;
+    json_t *annotations = NULL;
+    json_t *R = NULL;
+
+    if (flux_response_decode (msg, NULL, NULL) < 0)
+        goto teardown; // ENOSYS here if scheduler not loaded/shutting down
+    if (flux_msg_unpack (msg,
+                         "{s:I s:i s?s s?o s?o}",
+                         "id", &id,
+                         "type", &type,
+                         "note", &note,
+                         "annotations", &annotations,
+                         "R", &R) < 0)
         goto teardown;
+    if (alloc_response (ctx, id, type, note, annotations, R) < 0)
+        goto teardown;
+    return;
+teardown:
+    interface_teardown (ctx->alloc, "alloc response error", errno);
+}
+
+/* Handle a sched.alloc-batch response, which contains an array of
+ * sched.alloc response payloads in the order they were generated.
+ */
+static void alloc_batch_response_cb (flux_t *h,
+                                     flux_msg_handler_t *mh,
+                                     const flux_msg_t *msg,
+                                     void *arg)
+{
+    struct job_manager *ctx = arg;
+    json_t *responses;
+    size_t index;
+    json_t *entry;
+
+    if (flux_response_decode (msg, NULL, NULL) < 0)
+        goto teardown;
+    if (flux_msg_unpack (msg, "{s:o}", "responses", &responses) < 0)
+        goto teardown;
+    if (!json_is_array (responses)) {
+        errno = EPROTO;
+        goto teardown;
+    }
+    json_array_foreach (responses, index, entry) {
+        flux_jobid_t id;
+        int type;
+        const char *note = NULL;
+        json_t *annotations = NULL;
+        json_t *R = NULL;
+
+        if (json_unpack (entry,
+                         "{s:I s:i s?s s?o s?o}",
+                         "id", &id,
+                         "type", &type,
+                         "note", &note,
+                         "annotations", &annotations,
+                         "R", &R) < 0) {
+            errno = EPROTO;
+            goto teardown;
+        }
+        /* As with individual responses, an error tears down the interface
+         * but the remaining responses must still be processed.
+         */
+        if (alloc_response (ctx, id, type, note, annotations, R) < 0)
+            interface_teardown (ctx->alloc, "alloc response error", errno);
     }
     return;
 teardown:
-    interface_teardown (alloc, "alloc response error", errno);
+    interface_teardown (ctx->alloc, "alloc response error", errno);
+}
+
+/* Payload of one request in a sched.alloc-batch request.
+ */
+static json_t *alloc_request_payload (struct job *job)
+{
+    json_t *o;
+
+    if (!(o = json_pack ("{s:I s:I s:I s:f s:O}",
+                         "id", job->id,
+                         "priority", (json_int_t)job->priority,
+                         "userid", (json_int_t) job->userid,
+                         "t_submit", job->t_submit,
+                         "jobspec", job->jobspec_redacted))) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    return o;
 }
 
 /* Send sched.alloc request for job.
  * Update flags.
  */
 int alloc_request (struct alloc *alloc, struct job *job)
+{
+    flux_msg_t *msg = NULL;
+    const char *jobspec;
+    json_t *o;
+    char *s = NULL;
+
+    if (!(jobspec = job_jobspec_str (job)))
+        return -1;
+    if (!(o = json_pack ("{s:I s:I s:I s:f}",
+                         "id", job->id,
+                         "priority", (json_int_t)job->priority,
+                         "userid", (json_int_t) job->userid,
+                         "t_submit", job->t_submit))) {
+        errno = ENOMEM;
+        return -1;
+    }
+    if (!(s = job_dumps_with (o, "jobspec", jobspec)))
+        goto error;
+    if (!(msg = flux_request_encode ("sched.alloc", s)))
+        goto error;
+    if (flux_send (alloc->ctx->h, msg, 0) < 0)
+        goto error;
+    flux_msg_destroy (msg);
+    json_decref (o);
+    free (s);
+    return 0;
+error:
+    flux_msg_destroy (msg);
+    ERRNO_SAFE_WRAP (json_decref, o);
+    ERRNO_SAFE_WRAP (free, s);
+    return -1;
+}
+
+/* Send sched.alloc-batch request for the jobs in 'jobs', an array of
+ * sched.alloc request payloads.
+ */
+static int alloc_batch_request (struct alloc *alloc, json_t *jobs)
 {
     flux_msg_t *msg;
 
-    if (!(msg = flux_request_encode ("sched.alloc", NULL)))
+    if (!(msg = flux_request_encode ("sched.alloc-batch", NULL)))
         return -1;
-    if (flux_msg_pack (msg,
-                       "{s:I s:I s:I s:f s:O}",
-                       "id", job->id,
-                       "priority", (json_int_t)job->priority,
-                       "userid", (json_int_t) job->userid,
-                       "t_submit", job->t_submit,
-                       "jobspec", job->jobspec_redacted) < 0)
+    if (flux_msg_pack (msg, "{s:O}", "jobs", jobs) < 0)
         goto error;
     if (flux_send (alloc->ctx->h, msg, 0) < 0)
         goto error;
@@ -338,7 +526,7 @@ static void hello_cb (flux_t *h,
         goto error;
     }
     flux_log (h, LOG_DEBUG, "scheduler: hello");
-    job = zhashx_first (ctx->active_jobs);
+    job = jobmap_first (ctx->active_jobs);
     while (job) {
         if (job->has_resources) {
             if (flux_respond_pack (h,
@@ -350,7 +538,7 @@ static void hello_cb (flux_t *h,
                                    "t_submit", job->t_submit) < 0)
                 goto error;
         }
-        job = zhashx_next (ctx->active_jobs);
+        job = jobmap_next (ctx->active_jobs);
     }
     if (flux_respond_error (h, msg, ENODATA, NULL) < 0)
         flux_log_error (h, "%s: flux_respond_error", __FUNCTION__);
@@ -373,15 +561,17 @@ static void ready_cb (flux_t *h,
     struct job_manager *ctx = arg;
     const char *mode;
     int limit = 0;
+    int batch = 0;
     int count;
     struct job *job;
     const char *sender;
 
     if (flux_request_unpack (msg,
                              NULL,
-                             "{s:s s?i}",
+                             "{s:s s?i s?b}",
                              "mode", &mode,
-                             "limit", &limit) < 0)
+                             "limit", &limit,
+                             "batch", &batch) < 0)
         goto error;
     if (streq (mode, "limited")) {
         if (limit <= 0) {
@@ -406,23 +596,32 @@ static void ready_cb (flux_t *h,
             goto error;
     }
     ctx->alloc->ready = true;
-    flux_log (h, LOG_DEBUG, "scheduler: ready %s", mode);
-    count = zlistx_size (ctx->alloc->queue);
-    if (flux_respond_pack (h, msg, "{s:i}", "count", count) < 0)
+    ctx->alloc->batch = batch ? true : false;
+    flux_log (h,
+              LOG_DEBUG,
+              "scheduler: ready %s%s",
+              mode,
+              batch ? " batch" : "");
+    count = heap_size (ctx->alloc->queue);
+    if (flux_respond_pack (h,
+                           msg,
+                           "{s:i s:b}",
+                           "count", count,
+                           "batch", batch) < 0)
         flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
     /* Restart any free requests that might have been interrupted
      * when scheduler was last unloaded.
      */
-    job = zhashx_first (ctx->active_jobs);
+    job = jobmap_first (ctx->active_jobs);
     while (job) {
         /* N.B. first/next are NOT deletion safe but event_job_action()
-         * won't call zhashx_delete() for jobs in FLUX_JOB_STATE_CLEANUP state.
+         * won't call jobmap_delete() for jobs in FLUX_JOB_STATE_CLEANUP state.
          */
         if (job->state == FLUX_JOB_STATE_CLEANUP && job->has_resources) {
             if (event_job_action (ctx->event, job) < 0)
                 flux_log_error (h, "%s: event_job_action", __FUNCTION__);
         }
-        job = zhashx_next (ctx->active_jobs);
+        job = jobmap_next (ctx->active_jobs);
     }
     return;
 error:
@@ -437,12 +636,12 @@ static bool alloc_work_available (struct job_manager *ctx)
 
     if (!ctx->alloc->ready) // scheduler protocol is not ready for alloc
         return false;
-    if (!(job = zlistx_first (ctx->alloc->queue))) // queue is empty
+    if (!(job = heap_first (ctx->alloc->queue))) // queue is empty
         return false;
     if (ctx->alloc->alloc_limit > 0 // alloc limit reached
         && ctx->alloc->alloc_pending_count >= ctx->alloc->alloc_limit)
         return false;
-    /* The alloc->queue is sorted from highest to lowest priority, so if the
+    /* The alloc->queue is ordered from highest to lowest priority, so if the
      * first job has priority=MIN (held), all other jobs must have the same
      * priority, and no alloc requests can be sent.
      */
@@ -453,6 +652,7 @@ static bool alloc_work_available (struct job_manager *ctx)
 
 /* prep:
  * Runs right before reactor calls poll(2).
+ * Send any batched free requests.
  * If a job can be scheduled, start idle watcher.
  */
 static void prep_cb (flux_reactor_t *r,
@@ -462,10 +662,74 @@ static void prep_cb (flux_reactor_t *r,
 {
     struct job_manager *ctx = arg;
 
+    if (free_batch_flush (ctx->alloc) < 0)
+        flux_log_error (ctx->h, "error sending sched.free-batch request");
     if (alloc_work_available (ctx))
         flux_watcher_start (ctx->alloc->idle);
 }
 
+/* Update job and alloc state after an alloc request for 'job' was sent.
+ */
+static void alloc_request_sent (struct alloc *alloc, struct job *job)
+{
+    heap_delete (alloc->queue, job->handle);
+    job->handle = NULL;
+    job->alloc_pending = 1;
+    job->alloc_queued = 0;
+    alloc->alloc_pending_count++;
+    alloc_timing_start (alloc, job);
+    /* Add job to alloc->pending_jobs if there is an alloc limit, so
+     * that those requests can be canceled if the queue is reprioritized
+     * and higher priority requests need to preempt lower priority ones.
+     */
+    if (alloc->alloc_limit) {
+        bool fwd = job->priority > (FLUX_JOB_PRIORITY_MAX / 2);
+        if (!(job->handle = zlistx_insert (alloc->pending_jobs, job, fwd)))
+            flux_log (alloc->ctx->h, LOG_ERR, "failed to enqueue pending job");
+    }
+    /* Post event for debugging if job was submitted FLUX_JOB_DEBUG flag.
+     */
+    if ((job->flags & FLUX_JOB_DEBUG))
+        (void)event_job_post_pack (alloc->ctx->event,
+                                   job,
+                                   "debug.alloc-request",
+                                   0,
+                                   NULL);
+}
+
+/* In batched mode, send alloc requests for as many jobs as the alloc
+ * limit allows in one message.  A send failure is fatal, so job state
+ * may be updated as the batch is built.
+ */
+static int alloc_batch_send (struct alloc *alloc)
+{
+    json_t *jobs;
+    json_t *o;
+    struct job *job;
+
+    if (!(jobs = json_array ()))
+        goto nomem;
+    while (json_array_size (jobs) < batch_max
+           && alloc_work_available (alloc->ctx)) {
+        job = heap_first (alloc->queue);
+        if (!(o = alloc_request_payload (job))
+            || json_array_append_new (jobs, o) < 0) {
+            json_decref (o);
+            goto nomem;
+        }
+        alloc_request_sent (alloc, job);
+    }
+    if (alloc_batch_request (alloc, jobs) < 0)
+        goto error;
+    json_decref (jobs);
+    return 0;
+nomem:
+    errno = ENOMEM;
+error:
+    ERRNO_SAFE_WRAP (json_decref, jobs);
+    return -1;
+}
+
 /* check:
  * Runs right after reactor calls poll(2).
  * Stop idle watcher, and send next alloc request, if available.
@@ -484,35 +748,22 @@ static void check_cb (flux_reactor_t *r,
     if (!alloc_work_available (ctx))
         return;
 
-    job = zlistx_first (alloc->queue);
+    if (alloc->batch) {
+        if (alloc_batch_send (alloc) < 0) {
+            flux_log_error (ctx->h, "alloc_batch_send fatal error");
+            flux_reactor_stop_error (flux_get_reactor (ctx->h));
+        }
+        return;
+    }
+
+    job = heap_first (alloc->queue);
 
     if (alloc_request (alloc, job) < 0) {
         flux_log_error (ctx->h, "alloc_request fatal error");
         flux_reactor_stop_error (flux_get_reactor (ctx->h));
         return;
     }
-    zlistx_delete (alloc->queue, job->handle);
-    job->handle = NULL;
-    job->alloc_pending = 1;
-    job->alloc_queued = 0;
-    alloc->alloc_pending_count++;
-    /* Add job to alloc->pending_jobs if there is an alloc limit, so
-     * that those requests can be canceled if the queue is reprioritized
-     * and higher priority requests need to preempt lower priority ones.
-     */
-    if (alloc->alloc_limit) {
-        bool fwd = job->priority > (FLUX_JOB_PRIORITY_MAX / 2);
-        if (!(job->handle = zlistx_insert (alloc->pending_jobs, job, fwd)))
-            flux_log (ctx->h, LOG_ERR, "failed to enqueue pending job");
-    }
-    /* Post event for debugging if job was submitted FLUX_JOB_DEBUG flag.
-     */
-    if ((job->flags & FLUX_JOB_DEBUG))
-        (void)event_job_post_pack (ctx->event,
-                                   job,
-                                   "debug.alloc-request",
-                                   0,
-                                   NULL);
+    alloc_request_sent (alloc, job);
 }
 
 /* called from event_job_action() FLUX_JOB_STATE_CLEANUP */
@@ -541,9 +792,8 @@ int alloc_enqueue_alloc_request (struct alloc *alloc, struct job *job)
         && !job->alloc_pending
         && job->priority != FLUX_JOB_PRIORITY_MIN
         && queue_started (alloc->ctx->queue, job)) {
-        bool fwd = job->priority > (FLUX_JOB_PRIORITY_MAX / 2);
         assert (job->handle == NULL);
-        if (!(job->handle = zlistx_insert (alloc->queue, job, fwd)))
+        if (!(job->handle = heap_insert (alloc->queue, job)))
             return -1;
         job->alloc_queued = 1;
     }
@@ -556,7 +806,7 @@ int alloc_enqueue_alloc_request (struct alloc *alloc, struct job *job)
 void alloc_dequeue_alloc_request (struct alloc *alloc, struct job *job)
 {
     if (job->alloc_queued) {
-        zlistx_delete (alloc->queue, job->handle);
+        heap_delete (alloc->queue, job->handle);
         job->handle = NULL;
         job->alloc_queued = 0;
     }
@@ -600,24 +850,30 @@ int alloc_cancel_alloc_request (struct alloc *alloc,
 /* called from list_handle_request() */
 struct job *alloc_queue_first (struct alloc *alloc)
 {
-    return zlistx_first (alloc->queue);
+    return heap_first (alloc->queue);
 }
 
 struct job *alloc_queue_next (struct alloc *alloc)
 {
-    return zlistx_next (alloc->queue);
+    return heap_next (alloc->queue);
 }
 
 /* called from reprioritize_job() */
 void alloc_queue_reorder (struct alloc *alloc, struct job *job)
 {
-    bool fwd = job->priority > (FLUX_JOB_PRIORITY_MAX / 2);
-
-    zlistx_reorder (alloc->queue, job->handle, fwd);
+    if (alloc->defer > 0) {
+        alloc->reorder = true;
+        return;
+    }
+    heap_reorder (alloc->queue, job->handle);
 }
 
 void alloc_pending_reorder (struct alloc *alloc, struct job *job)
 {
+    if (alloc->defer > 0) {
+        alloc->reorder = true;
+        return;
+    }
     if (alloc->alloc_limit) {
         bool fwd = job->priority > (FLUX_JOB_PRIORITY_MAX / 2);
         zlistx_reorder (alloc->pending_jobs, job->handle, fwd);
@@ -627,19 +883,15 @@ void alloc_pending_reorder (struct alloc *alloc, struct job *job)
 int alloc_queue_reprioritize (struct alloc *alloc)
 {
     struct job *job;
-    zlistx_sort (alloc->queue);
+
+    /*  Heap handles remain valid across a rebuild.
+     */
+    heap_rebuild (alloc->queue);
 
     /*  N.B.: zlistx_sort() invalidates all list handles since
      *   the sort swaps contents of nodes, not the nodes themselves.
      *   Therefore, job handles into the list must be re-acquired here:
      */
-
-    job = zlistx_first (alloc->queue);
-    while (job) {
-        job->handle = zlistx_cursor (alloc->queue);
-        job = zlistx_next (alloc->queue);
-    }
-
     zlistx_sort (alloc->pending_jobs);
 
     job = zlistx_first (alloc->pending_jobs);
@@ -657,8 +909,15 @@ int alloc_queue_reprioritize (struct alloc *alloc)
 /* called if highest priority job may have changed */
 int alloc_queue_recalc_pending (struct alloc *alloc)
 {
-    struct job *head = zlistx_first (alloc->queue);
-    struct job *tail = zlistx_last (alloc->pending_jobs);
+    struct job *head;
+    struct job *tail;
+
+    if (alloc->defer > 0) {
+        alloc->reorder = true;
+        return 0;
+    }
+    head = heap_first (alloc->queue);
+    tail = zlistx_last (alloc->pending_jobs);
     while (alloc->alloc_limit
            && head
            && tail) {
@@ -672,15 +931,29 @@ int alloc_queue_recalc_pending (struct alloc *alloc)
         }
         else
             break;
-        head = zlistx_next (alloc->queue);
+        head = heap_next (alloc->queue);
         tail = zlistx_prev (alloc->pending_jobs);
     }
     return 0;
 }
 
+void alloc_queue_defer (struct alloc *alloc)
+{
+    alloc->defer++;
+}
+
+int alloc_queue_undefer (struct alloc *alloc)
+{
+    if (alloc->defer > 0 && --alloc->defer == 0 && alloc->reorder) {
+        alloc->reorder = false;
+        return alloc_queue_reprioritize (alloc);
+    }
+    return 0;
+}
+
 int alloc_queue_count (struct alloc *alloc)
 {
-    return zlistx_size (alloc->queue);
+    return heap_size (alloc->queue);
 }
 
 int alloc_pending_count (struct alloc *alloc)
@@ -704,7 +977,7 @@ static void alloc_query_cb (flux_t *h,
     if (flux_respond_pack (h,
                            msg,
                            "{s:i s:i s:i}",
-                           "queue_length", zlistx_size (alloc->queue),
+                           "queue_length", (int)heap_size (alloc->queue),
                            "alloc_pending", alloc->alloc_pending_count,
                            "running", alloc->ctx->running_jobs) < 0)
         flux_log_error (h, "%s: flux_respond", __FUNCTION__);
@@ -727,7 +1000,7 @@ static void resource_status_cb (flux_t *h,
         errprintf (&error, "error creating rlist object");
         goto error;
     }
-    job = zhashx_first (alloc->ctx->active_jobs);
+    job = jobmap_first (alloc->ctx->active_jobs);
     while (job) {
         if (job->has_resources && job->R_redacted && !job->alloc_bypass) {
             struct rlist *rl2;
@@ -747,7 +1020,7 @@ static void resource_status_cb (flux_t *h,
             }
             rlist_destroy (rl2);
         }
-        job = zhashx_next (alloc->ctx->active_jobs);
+        job = jobmap_next (alloc->ctx->active_jobs);
     }
     if (!(R = rlist_to_R (rl))) {
         errprintf (&error, "error converting rlist to JSON");
@@ -789,8 +1062,9 @@ void alloc_ctx_destroy (struct alloc *alloc)
         flux_watcher_destroy (alloc->prep);
         flux_watcher_destroy (alloc->check);
         flux_watcher_destroy (alloc->idle);
-        zlistx_destroy (&alloc->queue);
+        heap_destroy (alloc->queue);
         zlistx_destroy (&alloc->pending_jobs);
+        json_decref (alloc->free_batch);
         free (alloc->stopped_reason);
         free (alloc->sched_sender);
         free (alloc);
@@ -824,6 +1098,11 @@ static const struct flux_msg_handler_spec htab[] = {
         alloc_response_cb,
         0
     },
+    {   FLUX_MSGTYPE_RESPONSE,
+        "sched.alloc-batch",
+        alloc_batch_response_cb,
+        0
+    },
     FLUX_MSGHANDLER_TABLE_END,
 };
 
@@ -835,11 +1114,10 @@ struct alloc *alloc_ctx_create (struct job_manager *ctx)
     if (!(alloc = calloc (1, sizeof (*alloc))))
         return NULL;
     alloc->ctx = ctx;
-    if (!(alloc->queue = zlistx_new()))
+    if (!(alloc->queue = heap_create (job_priority_comparator)))
         goto error;
-    zlistx_set_destructor (alloc->queue, job_destructor);
-    zlistx_set_comparator (alloc->queue, job_priority_comparator);
-    zlistx_set_duplicator (alloc->queue, job_duplicator);
+    heap_set_destructor (alloc->queue, job_destructor);
+    heap_set_duplicator (alloc->queue, job_duplicator);
 
     if (!(alloc->pending_jobs = zlistx_new()))
         goto error;
@@ -847,6 +1125,11 @@ struct alloc *alloc_ctx_create (struct job_manager *ctx)
     zlistx_set_comparator (alloc->pending_jobs, job_priority_comparator);
     zlistx_set_duplicator (alloc->pending_jobs, job_duplicator);
 
+    if (!(alloc->free_batch = json_array ())) {
+        errno = ENOMEM;
+        goto error;
+    }
+
     if (flux_msg_handler_addvec (ctx->h, htab, ctx, &alloc->handlers) < 0)
         goto error;
     alloc->prep = flux_prepare_watcher_create (r, prep_cb, ctx);
@@ -73,6 +73,13 @@ int alloc_queue_reprioritize (struct alloc *alloc);
 /* Recalculate pending job, e.g. after urgency change */
 int alloc_queue_recalc_pending (struct alloc *alloc);
 
+/* Defer reordering of the alloc queue and pending jobs, e.g. while
+ * changing the priority of many jobs.  Calls may nest.  When the last
+ * deferral ends, the queue is re-sorted once if any reorder was requested.
+ */
+void alloc_queue_defer (struct alloc *alloc);
+int alloc_queue_undefer (struct alloc *alloc);
+
 void alloc_disconnect_rpc (flux_t *h,
                            flux_msg_handler_t *mh,
                            const flux_msg_t *msg,
@@ -57,6 +57,28 @@ int update_annotation_recursive (json_t *orig, const char *path, json_t *new)
     return 0;
 }
 
+bool annotations_changed (json_t *orig, json_t *new)
+{
+    const char *key;
+    json_t *value;
+
+    json_object_foreach (new, key, value) {
+        json_t *orig_value = json_object_get (orig, key);
+
+        if (json_is_null (value)) {
+            if (orig_value)
+                return true;
+        }
+        else if (json_is_object (value) && json_is_object (orig_value)) {
+            if (annotations_changed (orig_value, value))
+                return true;
+        }
+        else if (!orig_value || !json_equal (orig_value, value))
+            return true;
+    }
+    return false;
+}
+
 int annotations_update (struct job *job, const char *path, json_t *annotations)
 {
     if (!json_is_object (annotations)) {
@@ -116,6 +138,12 @@ int annotations_update_and_publish (struct job_manager *ctx,
     int rc = -1;
     json_t *tmp = NULL;
 
+    /* Schedulers may repeat annotations on every pass over the queue.
+     * Don't publish an event if nothing would change.
+     */
+    if (json_is_object (annotations)
+        && !annotations_changed (job->annotations, annotations))
+        return 0;
     if (annotations_update (job, ".", annotations) < 0)
         return -1;
     if (job->annotations) {
@@ -161,8 +189,8 @@ void annotate_memo_request (flux_t *h,
                              "memo", &memo) < 0
         || flux_msg_get_cred (msg, &cred) < 0)
         goto error;
-    if (!(job = zhashx_lookup (ctx->active_jobs, &id))) {
-        if (!(job = zhashx_lookup (ctx->inactive_jobs, &id)))
+    if (!(job = jobmap_lookup (ctx->active_jobs, id))) {
+        if (!(job = jobmap_lookup (ctx->inactive_jobs, id)))
             errstr = "unknown job id";
         else
             errstr = "job is inactive";
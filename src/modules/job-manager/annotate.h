@@ -12,6 +12,7 @@
 #define _FLUX_JOB_MANAGER_ANNOTATE_H
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #include "job.h"
 #include "job-manager.h"
@@ -24,6 +25,11 @@ void annotate_ctx_destroy (struct annotate *annotate);
 /* exposed for unit testing only */
 int update_annotation_recursive (json_t *orig, const char *path, json_t *new);
 
+/* Return true if merging 'new' into 'orig' (which may be NULL) with
+ * update_annotation_recursive() would change 'orig'.
+ */
+bool annotations_changed (json_t *orig, json_t *new);
+
 int annotations_update_and_publish (struct job_manager *ctx,
                                     struct job *job,
                                     json_t *annotations);
@@ -0,0 +1,281 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* bulk - apply one operation to many jobs
+ *
+ * Purpose:
+ *   Handle job-manager.bulk RPC, so that tools acting on many jobs
+ *   need not send one raise or urgency request per job.
+ *
+ * Input:
+ * - op: "cancel", "raise", or "urgency"
+ * - ids: array of job ids, or
+ *   userid, states: select active jobs as job-manager.raiseall does
+ * - type, severity, note (optional): for "raise"
+ * - note (optional): for "cancel"
+ * - urgency: for "urgency"
+ *
+ * Output:
+ * - count: number of jobs the operation was applied to
+ * - errors: array of [id, errstr] for jobs on which it failed
+ *
+ * Caveats:
+ * - Eventlog updates are batched by the event code as usual, so posting
+ *   events for all jobs in one pass results in few KVS commits.
+ * - Alloc queue reordering is deferred until all jobs are processed.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <string.h>
+#include <flux/core.h>
+
+#include "src/common/libczmqcontainers/czmq_containers.h"
+#include "ccan/str/str.h"
+
+#include "job.h"
+#include "alloc.h"
+#include "raise.h"
+#include "urgency.h"
+#include "job-manager.h"
+
+#include "bulk.h"
+
+enum bulk_op {
+    BULK_CANCEL,
+    BULK_RAISE,
+    BULK_URGENCY,
+};
+
+struct bulk_args {
+    enum bulk_op op;
+    const char *type;
+    int severity;
+    const char *note;
+    int urgency;
+};
+
+static int error_append (json_t *errors, flux_jobid_t id, const char *errstr)
+{
+    json_t *entry;
+
+    if (!(entry = json_pack ("[Is]", (json_int_t)id, errstr))
+        || json_array_append_new (errors, entry) < 0) {
+        json_decref (entry);
+        errno = ENOMEM;
+        return -1;
+    }
+    return 0;
+}
+
+/* Build a list of jobs from an array of job ids.  Ids that do not
+ * refer to an active job are added to 'errors'.
+ */
+static zlistx_t *lookup_jobs (struct job_manager *ctx,
+                              json_t *ids,
+                              json_t *errors)
+{
+    zlistx_t *l;
+    size_t index;
+    json_t *value;
+
+    if (!(l = zlistx_new ()))
+        goto nomem;
+    zlistx_set_destructor (l, job_destructor);
+    zlistx_set_duplicator (l, job_duplicator);
+
+    json_array_foreach (ids, index, value) {
+        flux_jobid_t id;
+        struct job *job;
+
+        if (!json_is_integer (value)) {
+            errno = EPROTO;
+            goto error;
+        }
+        id = json_integer_value (value);
+        if (!(job = jobmap_lookup (ctx->active_jobs, id))) {
+            const char *errstr = "unknown job";
+            if (jobmap_lookup (ctx->inactive_jobs, id))
+                errstr = "job is inactive";
+            if (error_append (errors, id, errstr) < 0)
+                goto error;
+            continue;
+        }
+        if (!zlistx_add_end (l, job))
+            goto nomem;
+    }
+    return l;
+nomem:
+    errno = ENOMEM;
+error:
+    zlistx_destroy (&l);
+    return NULL;
+}
+
+static int bulk_apply (struct job_manager *ctx,
+                       struct job *job,
+                       struct flux_msg_cred cred,
+                       struct bulk_args *args,
+                       const char **errstr)
+{
+    switch (args->op) {
+        case BULK_CANCEL:
+        case BULK_RAISE:
+            if (flux_msg_cred_authorize (cred, job->userid) < 0) {
+                *errstr = "guests can only raise exceptions on their own jobs";
+                return -1;
+            }
+            /* N.B. job may be destroyed here, but 'l' holds a reference.
+             */
+            return raise_job_exception (ctx,
+                                        job,
+                                        args->type,
+                                        args->severity,
+                                        cred.userid,
+                                        args->note);
+        case BULK_URGENCY:
+            return urgency_set_job (ctx, job, cred, args->urgency, errstr);
+    }
+    errno = EINVAL;
+    return -1;
+}
+
+static int bulk_parse_op (const char *op,
+                          struct bulk_args *args,
+                          const char **errstr)
+{
+    if (streq (op, "cancel")) {
+        args->op = BULK_CANCEL;
+        args->type = "cancel";
+        args->severity = 0;
+    }
+    else if (streq (op, "raise")) {
+        args->op = BULK_RAISE;
+        if (!args->type || raise_check_type (args->type) < 0) {
+            *errstr = "invalid exception type";
+            goto error;
+        }
+        if (raise_check_severity (args->severity) < 0) {
+            *errstr = "invalid exception severity";
+            goto error;
+        }
+    }
+    else if (streq (op, "urgency")) {
+        args->op = BULK_URGENCY;
+        if (args->urgency < FLUX_JOB_URGENCY_MIN
+            || args->urgency > FLUX_JOB_URGENCY_MAX) {
+            *errstr = "urgency value is out of range";
+            goto error;
+        }
+    }
+    else {
+        *errstr = "unknown bulk operation";
+        goto error;
+    }
+    return 0;
+error:
+    errno = EPROTO;
+    return -1;
+}
+
+void bulk_handle_request (flux_t *h,
+                          flux_msg_handler_t *mh,
+                          const flux_msg_t *msg,
+                          void *arg)
+{
+    struct job_manager *ctx = arg;
+    struct flux_msg_cred cred;
+    struct bulk_args args = { .severity = -1, .urgency = -1 };
+    const char *op;
+    json_t *ids = NULL;
+    uint32_t userid = FLUX_USERID_UNKNOWN;
+    int state_mask = 0;
+    const char *errstr = NULL;
+    zlistx_t *l = NULL;
+    json_t *errors = NULL;
+    struct job *job;
+    int count = 0;
+
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s:s s?o s?i s?i s?s s?i s?s s?i}",
+                             "op", &op,
+                             "ids", &ids,
+                             "userid", &userid,
+                             "states", &state_mask,
+                             "type", &args.type,
+                             "severity", &args.severity,
+                             "note", &args.note,
+                             "urgency", &args.urgency) < 0
+        || flux_msg_get_cred (msg, &cred) < 0)
+        goto error;
+    if (bulk_parse_op (op, &args, &errstr) < 0)
+        goto error;
+    if (!(errors = json_array ())) {
+        errno = ENOMEM;
+        goto error;
+    }
+    if (ids) {
+        if (!json_is_array (ids)) {
+            errno = EPROTO;
+            goto error;
+        }
+        if (!(l = lookup_jobs (ctx, ids, errors)))
+            goto error;
+    }
+    else {
+        /* Only the instance owner gets to use the userid wildcard.
+         */
+        if (flux_msg_cred_authorize (cred, userid) < 0) {
+            errstr = "guests can only select their own jobs";
+            goto error;
+        }
+        if (find_jobs (ctx, userid, state_mask, &l) < 0)
+            goto error;
+    }
+
+    alloc_queue_defer (ctx->alloc);
+    job = zlistx_first (l);
+    while (job) {
+        const char *job_errstr = NULL;
+
+        if (bulk_apply (ctx, job, cred, &args, &job_errstr) < 0) {
+            if (error_append (errors,
+                              job->id,
+                              job_errstr ? job_errstr : strerror (errno)) < 0)
+                flux_log_error (h, "%s: error_append", __FUNCTION__);
+        }
+        else
+            count++;
+        job = zlistx_next (l);
+    }
+    if (alloc_queue_undefer (ctx->alloc) < 0)
+        flux_log_error (h, "%s: alloc_queue_undefer", __FUNCTION__);
+
+    if (flux_respond_pack (h,
+                           msg,
+                           "{s:i s:O}",
+                           "count", count,
+                           "errors", errors) < 0)
+        flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
+    json_decref (errors);
+    zlistx_destroy (&l);
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, errstr) < 0)
+        flux_log_error (h, "%s: flux_respond_error", __FUNCTION__);
+    json_decref (errors);
+    zlistx_destroy (&l);
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
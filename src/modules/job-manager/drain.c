@@ -47,7 +47,7 @@ void drain_check (struct drain *drain)
 
     /* Drained - no active jobs
      */
-    if (zhashx_size (drain->ctx->active_jobs) == 0) {
+    if (jobmap_size (drain->ctx->active_jobs) == 0) {
         while ((msg = zlist_pop (drain->drain_requests))) {
             if (!(rsp = flux_response_derive (msg, 0))
                 || event_batch_respond (drain->ctx->event, rsp) < 0)
@@ -62,7 +62,7 @@ void drain_check (struct drain *drain)
      */
     if (alloc_pending_count (drain->ctx->alloc) == 0
         && drain->ctx->running_jobs == 0) {
-        int pending = zhashx_size (drain->ctx->active_jobs)
+        int pending = jobmap_size (drain->ctx->active_jobs)
                                  - drain->ctx->running_jobs;
         while ((msg = zlist_pop (drain->idle_requests))) {
             if (!(rsp = flux_response_derive (msg, 0))
@@ -25,7 +25,9 @@
  *
  * The function event_job_post_pack() posts an event to a job, running
  * event_job_update(), event_job_action(), and committing the event to
- * the job eventlog, in a delayed batch.
+ * the job eventlog, in a delayed batch.  A batch is committed as soon
+ * as no earlier batch is in flight, or when it reaches a size limit
+ * (see libfluxutil/batcher.h).
  *
  * Notes:
  * - A KVS commit failure is handled as fatal to the job-manager
@@ -38,12 +40,14 @@
 #endif
 #include <jansson.h>
 #include <flux/core.h>
+#include <string.h>
 #include <time.h>
 
 #include "src/common/libczmqcontainers/czmq_containers.h"
 #include "src/common/libeventlog/eventlog.h"
 #include "src/common/libutil/errno_safe.h"
 #include "src/common/libjob/idf58.h"
+#include "src/common/libfluxutil/batcher.h"
 #include "ccan/ptrint/ptrint.h"
 #include "ccan/str/str.h"
 
@@ -55,6 +59,7 @@
 #include "prioritize.h"
 #include "annotate.h"
 #include "purge.h"
+#include "snapshot.h"
 #include "jobtap-internal.h"
 
 #include "event.h"
@@ -62,18 +67,24 @@
 struct event {
     struct job_manager *ctx;
     flux_msg_handler_t **handlers;
-    double batch_timeout;
     struct event_batch *batch;
-    flux_watcher_t *timer;
+    struct batcher *batcher;
     zlist_t *pending;
     zhashx_t *evindex;
 };
 
+/* Commit a batch early, even with a commit in flight, at these sizes.
+ */
+static const int batch_max_count = 1024;
+static const size_t batch_max_bytes = 1024 * 1024;
+
 struct event_batch {
     struct event *event;
     flux_kvs_txn_t *txn;
     flux_future_t *f;
+    double t_start;
     json_t *state_trans;
+    json_t *ids;        // IDs of jobs with eventlog updates in 'txn'
     zlist_t *responses; // responses deferred until batch complete
     zlist_t *jobs;      // jobs held until batch complete
 };
@@ -96,6 +107,7 @@ static void commit_continuation (flux_future_t *f, void *arg)
         flux_log_error (ctx->h, "%s: eventlog update failed", __FUNCTION__);
         flux_reactor_stop_error (flux_get_reactor (ctx->h));
     }
+    batcher_commit_finish (event->batcher, batch->t_start);
     zlist_remove (event->pending, batch);
     event_batch_destroy (batch);
 }
@@ -109,7 +121,16 @@ static void event_batch_commit (struct event *event)
 
     if (batch) {
         event->batch = NULL;
+        if (!batch->txn
+            && snapshot_pending (ctx->snapshot)
+            && !(batch->txn = flux_kvs_txn_create ()))
+            goto error;
         if (batch->txn) {
+            if (snapshot_update_txn (ctx->snapshot,
+                                     batch->txn,
+                                     batch->ids) < 0)
+                goto error;
+            batch->t_start = batcher_commit_start (event->batcher);
             if (!(batch->f = flux_kvs_commit (ctx->h, NULL, 0, batch->txn)))
                 goto error;
             if (flux_future_then (batch->f, -1., commit_continuation, batch) < 0)
@@ -118,22 +139,29 @@ static void event_batch_commit (struct event *event)
                 goto nomem;
         }
         else { // just send responses and be done
+            batcher_reset (event->batcher);
             event_batch_destroy (batch);
         }
+        /* Continue writing a snapshot that did not fit in this batch.
+         */
+        if (snapshot_pending (ctx->snapshot)
+            && event_batch_open (event) < 0)
+            goto error_nobatch;
     }
     return;
 nomem:
     errno = ENOMEM;
 error: // unlikely (e.g. ENOMEM)
+    event_batch_destroy (batch);
+error_nobatch:
     flux_log_error (ctx->h, "%s: aborting reactor", __FUNCTION__);
     flux_reactor_stop_error (flux_get_reactor (ctx->h));
-    event_batch_destroy (batch);
 }
 
-static void timer_cb (flux_reactor_t *r, flux_watcher_t *w, int revents, void *arg)
+static void batcher_cb (struct batcher *b, void *arg)
 {
-    struct job_manager *ctx = arg;
-    event_batch_commit (ctx->event);
+    struct event *event = arg;
+    event_batch_commit (event);
 }
 
 /* Besides cleaning up, this function has the following side effects:
@@ -147,6 +175,7 @@ static void event_batch_destroy (struct event_batch *batch)
         int saved_errno = errno;
 
         flux_kvs_txn_destroy (batch->txn);
+        json_decref (batch->ids);
         if (batch->f)
             (void)flux_future_wait_for (batch->f, -1);
         if (batch->jobs) {
@@ -186,16 +215,40 @@ static struct event_batch *event_batch_create (struct event *event)
     return batch;
 }
 
-/* Create a new "batch" if there is none.
- * No-op if batch already started.
+/* Create a new "batch" if there is none, and account for 'bytes' of
+ * eventlog update added to it.
  */
-static int event_batch_start (struct event *event)
+static int event_batch_start (struct event *event, size_t bytes)
 {
     if (!event->batch) {
         if (!(event->batch = event_batch_create (event)))
             return -1;
-        flux_timer_watcher_reset (event->timer, event->batch_timeout, 0.);
-        flux_watcher_start (event->timer);
+    }
+    batcher_add (event->batcher, 1, bytes);
+    return 0;
+}
+
+int event_batch_open (struct event *event)
+{
+    return event_batch_start (event, 0);
+}
+
+/* Record that 'id' has an eventlog update in the batch, for the snapshot.
+ * Successive updates to the same job are recorded once.
+ */
+static int event_batch_log_id (struct event_batch *batch, flux_jobid_t id)
+{
+    size_t size = json_array_size (batch->ids);
+    json_t *o;
+
+    if (size > 0
+        && json_integer_value (json_array_get (batch->ids, size - 1)) == id)
+        return 0;
+    if ((!batch->ids && !(batch->ids = json_array ()))
+        || !(o = json_integer (id))
+        || json_array_append_new (batch->ids, o) < 0) {
+        errno = ENOMEM;
+        return -1;
     }
     return 0;
 }
@@ -207,14 +260,16 @@ static int event_batch_commit_event (struct event *event,
     char key[64];
     char *entrystr = NULL;
 
-    if (event_batch_start (event) < 0)
-        return -1;
     if (flux_job_kvs_key (key, sizeof (key), job->id, "eventlog") < 0)
         return -1;
-    if (!event->batch->txn && !(event->batch->txn = flux_kvs_txn_create ()))
-        return -1;
     if (!(entrystr = eventlog_entry_encode (entry)))
         return -1;
+    if (event_batch_start (event, strlen (entrystr)) < 0
+        || (!event->batch->txn
+            && !(event->batch->txn = flux_kvs_txn_create ()))) {
+        ERRNO_SAFE_WRAP (free, entrystr);
+        return -1;
+    }
     if (flux_kvs_txn_put (event->batch->txn,
                           FLUX_KVS_APPEND,
                           key,
@@ -223,12 +278,12 @@ static int event_batch_commit_event (struct event *event,
         return -1;
     }
     free (entrystr);
-    return 0;
+    return event_batch_log_id (event->batch, job->id);
 }
 
 int event_batch_add_job (struct event *event, struct job *job)
 {
-    if (event_batch_start (event) < 0)
+    if (event_batch_start (event, 0) < 0)
         return -1;
     if (!(event->batch->jobs)) {
         if (!(event->batch->jobs = zlist_new ()))
@@ -245,7 +300,7 @@ nomem:
 
 int event_batch_respond (struct event *event, const flux_msg_t *msg)
 {
-    if (event_batch_start (event) < 0)
+    if (event_batch_start (event, 0) < 0)
         return -1;
     if (!event->batch->responses) {
         if (!(event->batch->responses = zlist_new ()))
@@ -356,8 +411,14 @@ int event_job_action (struct event *event, struct job *job)
              * for a job + state, therefore zhashx_insert() may fail here and
              * not be indicative of a problem.
              */
-            if (zhashx_insert (ctx->inactive_jobs, &job->id, job) == 0) {
+            if (jobmap_insert (ctx->inactive_jobs, job->id, job) == 0) {
                 (void)jobtap_call (ctx->jobtap, job, "job.inactive-add", NULL);
+                if (snapshot_job_inactive (ctx->snapshot, job) < 0) {
+                    flux_log (event->ctx->h,
+                              LOG_ERR,
+                              "%s: error adding inactive job to snapshot",
+                              idf58 (job->id));
+                }
                 if (purge_enqueue_job (ctx->purge, job) < 0) {
                     flux_log (event->ctx->h,
                               LOG_ERR,
@@ -367,7 +428,7 @@ int event_job_action (struct event *event, struct job *job)
             }
             (void) jobtap_call (ctx->jobtap, job, "job.destroy", NULL);
             job_aux_destroy (job);
-            zhashx_delete (ctx->active_jobs, &job->id);
+            jobmap_delete (ctx->active_jobs, job->id);
             drain_check (ctx->drain);
             break;
     }
@@ -816,13 +877,10 @@ int event_job_process_entry (struct event *event,
         return -1;
     }
 
-    if (journal_process_event (event->ctx->journal,
-                               job->id,
-                               name,
-                               entry) < 0)
-        return -1;
     if (event_job_update (job, entry) < 0) // modifies job->state
         return -1;
+    if (journal_process_event (event->ctx->journal, job, name, entry) < 0)
+        return -1;
     if (event_job_cache (event, job, name) < 0)
         return -1;
     if (!(flags & EVENT_NO_COMMIT)
@@ -939,14 +997,15 @@ void event_ctx_destroy (struct event *event)
 {
     if (event) {
         int saved_errno = errno;
-        flux_watcher_destroy (event->timer);
         flux_msg_handler_delvec (event->handlers);
         event_batch_commit (event);
+        event_batch_destroy (event->batch); // opened for a partial snapshot
         if (event->pending) {
             struct event_batch *batch;
             while ((batch = zlist_pop (event->pending)))
                 event_batch_destroy (batch);
         }
+        batcher_destroy (event->batcher);
         zlist_destroy (&event->pending);
         zhashx_destroy (&event->evindex);
         free (event);
@@ -954,17 +1013,21 @@ void event_ctx_destroy (struct event *event)
     }
 }
 
+json_t *event_stats (struct event *event)
+{
+    return batcher_stats (event->batcher);
+}
+
 static void set_timeout_cb (flux_t *h,
                             flux_msg_handler_t *mh,
                             const flux_msg_t *msg,
                             void *arg)
 {
     struct event *event = arg;
+    double timeout;
 
-    if (flux_request_unpack (msg,
-                             NULL,
-                             "{s:F}",
-                             "timeout", &event->batch_timeout) < 0)
+    if (flux_request_unpack (msg, NULL, "{s:F}", "timeout", &timeout) < 0
+        || batcher_set_delay (event->batcher, timeout) < 0)
         goto error;
     if (flux_respond (h, msg, NULL) < 0)
         goto error;
@@ -990,13 +1053,11 @@ struct event *event_ctx_create (struct job_manager *ctx)
     if (!(event = calloc (1, sizeof (*event))))
         return NULL;
     event->ctx = ctx;
-    event->batch_timeout = 0.01;
-    if (!(event->timer = flux_timer_watcher_create (flux_get_reactor (ctx->h),
-                                                    0.,
-                                                    0.,
-                                                    timer_cb,
-                                                    ctx)))
+    if (!(event->batcher = batcher_create (flux_get_reactor (ctx->h),
+                                           batcher_cb,
+                                           event)))
         goto error;
+    batcher_set_limits (event->batcher, batch_max_count, batch_max_bytes);
     if (!(event->pending = zlist_new ()))
         goto nomem;
     if (!(event->evindex = zhashx_new ()))
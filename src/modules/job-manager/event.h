@@ -51,6 +51,11 @@ int event_batch_respond (struct event *event, const flux_msg_t *msg);
  */
 int event_batch_add_job (struct event *event, struct job *job);
 
+/* Open a batch, if none, to be committed on the usual schedule even
+ * if no events are added to it.
+ */
+int event_batch_open (struct event *event);
+
 /* Post event 'name' and optionally 'context' to 'job'.
  * Internally, calls event_job_update(), then event_job_action(), then commits
  * the event to job KVS eventlog.  The KVS commit completes asynchronously.
@@ -75,6 +80,10 @@ int event_job_post_entry (struct event *event,
                           int flags,
                           json_t *entry);
 
+/* Return an object with eventlog commit batching statistics.
+ */
+json_t *event_stats (struct event *event);
+
 void event_ctx_destroy (struct event *event);
 struct event *event_ctx_create (struct job_manager *ctx);
 
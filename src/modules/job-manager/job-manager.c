@@ -15,17 +15,19 @@
 #include <sys/types.h>
 #include <flux/core.h>
 
-#include "src/common/libjob/job_hash.h"
+#include "src/common/libjob/jobmap.h"
 #include "src/common/libczmqcontainers/czmq_containers.h"
 
 #include "job.h"
 #include "conf.h"
 #include "submit.h"
 #include "restart.h"
+#include "snapshot.h"
 #include "raise.h"
 #include "kill.h"
 #include "list.h"
 #include "urgency.h"
+#include "bulk.h"
 #include "alloc.h"
 #include "start.h"
 #include "event.h"
@@ -79,14 +81,32 @@ static void stats_cb (flux_t *h, flux_msg_handler_t *mh,
 {
     struct job_manager *ctx = arg;
     int journal_listeners = journal_listeners_count (ctx->journal);
+    json_t *batch;
+    json_t *snapshot;
+    json_t *purge;
+
+    if (!(batch = event_stats (ctx->event)))
+        goto error;
+    if (!(snapshot = snapshot_stats (ctx->snapshot))) {
+        json_decref (batch);
+        goto error;
+    }
+    if (!(purge = purge_stats (ctx->purge))) {
+        json_decref (batch);
+        json_decref (snapshot);
+        goto error;
+    }
     if (flux_respond_pack (h,
                            msg,
-                           "{s:{s:i} s:i s:i s:I}",
+                           "{s:{s:i} s:i s:i s:I s:o s:o s:o}",
                            "journal",
                              "listeners", journal_listeners,
-                           "active_jobs", zhashx_size (ctx->active_jobs),
-                           "inactive_jobs", zhashx_size (ctx->inactive_jobs),
-                           "max_jobid", ctx->max_jobid) < 0) {
+                           "active_jobs", jobmap_size (ctx->active_jobs),
+                           "inactive_jobs", jobmap_size (ctx->inactive_jobs),
+                           "max_jobid", ctx->max_jobid,
+                           "batch", batch,
+                           "snapshot", snapshot,
+                           "purge", purge) < 0) {
         flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
         goto error;
     }
@@ -110,6 +130,12 @@ static const struct flux_msg_handler_spec htab[] = {
         urgency_handle_request,
         FLUX_ROLE_USER
     },
+    {
+        FLUX_MSGTYPE_REQUEST,
+        "job-manager.bulk",
+        bulk_handle_request,
+        FLUX_ROLE_USER
+    },
     {
         FLUX_MSGTYPE_REQUEST,
         "job-manager.getattr",
@@ -161,15 +187,15 @@ int mod_main (flux_t *h, int argc, char **argv)
     ctx.h = h;
     ctx.owner = getuid ();
 
-    if (!(ctx.active_jobs = job_hash_create ())
-        || !(ctx.inactive_jobs = job_hash_create ())) {
+    if (!(ctx.active_jobs = jobmap_create ())
+        || !(ctx.inactive_jobs = jobmap_create ())) {
         flux_log_error (h, "error creating jobs hash");
         goto done;
     }
-    zhashx_set_destructor (ctx.active_jobs, job_destructor);
-    zhashx_set_duplicator (ctx.active_jobs, job_duplicator);
-    zhashx_set_destructor (ctx.inactive_jobs, job_destructor);
-    zhashx_set_duplicator (ctx.inactive_jobs, job_duplicator);
+    jobmap_set_destructor (ctx.active_jobs, job_destructor);
+    jobmap_set_duplicator (ctx.active_jobs, job_duplicator);
+    jobmap_set_destructor (ctx.inactive_jobs, job_destructor);
+    jobmap_set_duplicator (ctx.inactive_jobs, job_duplicator);
     if (!(ctx.conf = conf_create (&ctx, &error))) {
         flux_log (h, LOG_ERR, "config: %s", error.text);
         goto done;
@@ -182,6 +208,10 @@ int mod_main (flux_t *h, int argc, char **argv)
         flux_log_error (h, "error creating purge context");
         goto done;
     }
+    if (!(ctx.snapshot = snapshot_create (&ctx))) {
+        flux_log_error (h, "error creating snapshot context");
+        goto done;
+    }
     if (!(ctx.queue = queue_create (&ctx))) {
         flux_log_error (h, "error creating queue context");
         goto done;
@@ -259,16 +289,17 @@ done:
     alloc_ctx_destroy (ctx.alloc);
     submit_ctx_destroy (ctx.submit);
     event_ctx_destroy (ctx.event);
+    snapshot_destroy (ctx.snapshot);
     update_ctx_destroy (ctx.update);
     /* job aux containers may call destructors in jobtap plugins, so destroy
      * jobs before unloading plugins; but don't destroy job hashes until after.
      */
-    zhashx_purge (ctx.active_jobs);
-    zhashx_purge (ctx.inactive_jobs);
+    jobmap_purge (ctx.active_jobs);
+    jobmap_purge (ctx.inactive_jobs);
     jobtap_destroy (ctx.jobtap);
     conf_destroy (ctx.conf);
-    zhashx_destroy (&ctx.active_jobs);
-    zhashx_destroy (&ctx.inactive_jobs);
+    jobmap_destroy (ctx.active_jobs);
+    jobmap_destroy (ctx.inactive_jobs);
     return rc;
 }
 
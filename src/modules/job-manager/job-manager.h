@@ -12,12 +12,13 @@
 #define _FLUX_JOB_MANAGER_H
 
 #include "src/common/libczmqcontainers/czmq_containers.h"
+#include "src/common/libjob/jobmap.h"
 
 struct job_manager {
     flux_t *h;
     flux_msg_handler_t **handlers;
-    zhashx_t *active_jobs;
-    zhashx_t *inactive_jobs;
+    struct jobmap *active_jobs;
+    struct jobmap *inactive_jobs;
     int running_jobs; // count of jobs in RUN | CLEANUP state
     flux_jobid_t max_jobid; // largest jobid allocated thus far
     uid_t owner;
@@ -33,6 +34,7 @@ struct job_manager {
     struct annotate *annotate;
     struct journal *journal;
     struct purge *purge;
+    struct snapshot *snapshot;
     struct queue *queue;
     struct update *update;
     struct jobtap *jobtap;
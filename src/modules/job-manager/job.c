@@ -12,11 +12,14 @@
 #include "config.h"
 #endif
 #include <stdlib.h>
+#include <string.h>
 #include <flux/core.h>
 #include <jansson.h>
 #include <assert.h>
 
 #include "src/common/libczmqcontainers/czmq_containers.h"
+#include "src/common/librlist/rlist.h"
+#include "src/common/librlist/rnode.h"
 #include "src/common/libeventlog/eventlog.h"
 #include "src/common/libutil/grudgeset.h"
 #include "src/common/libutil/jpath.h"
@@ -39,6 +42,9 @@ void job_decref (struct job *job)
         flux_msg_decref (job->waiter);
         json_decref (job->jobspec_redacted);
         json_decref (job->R_redacted);
+        free (job->jobspec_str);
+        free (job->R_str);
+        json_decref (job->R_summary);
         json_decref (job->eventlog);
         json_decref (job->annotations);
         grudgeset_destroy (job->dependencies);
@@ -192,45 +198,15 @@ static int jobspec_redacted_parse_queue (struct job *job)
     return 0;
 }
 
-struct job *job_create_from_eventlog (flux_jobid_t id,
-                                      const char *eventlog,
-                                      const char *jobspec,
-                                      const char *R,
-                                      flux_error_t *error)
+/* Recreate job state by applying each entry of job->eventlog.
+ * Returns 0 on success, or -1 with errno set and 'error' filled in.
+ */
+static int job_replay_eventlog (struct job *job, flux_error_t *error)
 {
-    struct job *job;
     size_t index;
     json_t *event;
     int version = -1; // invalid
 
-    if (!(job = job_alloc()))
-        return NULL;
-    job->id = id;
-
-    if (!(job->jobspec_redacted = json_loads (jobspec, 0, NULL))) {
-        errprintf (error, "failed to decode jobspec");
-        goto inval;
-    }
-    jpath_del (job->jobspec_redacted, "attributes.system.environment");
-
-    if (jobspec_redacted_parse_queue (job) < 0) {
-        errprintf (error, "failed to decode jobspec queue");
-        goto inval;
-    }
-
-    if (R) {
-        if (!(job->R_redacted = json_loads (R, 0, NULL))) {
-            errprintf (error, "failed to decode R");
-            goto inval;
-        }
-        (void)json_object_del (job->R_redacted, "scheduling");
-    }
-
-    if (!(job->eventlog = eventlog_decode (eventlog))) {
-        errprintf (error, "failed to decode eventlog");
-        goto error;
-    }
-
     json_array_foreach (job->eventlog, index, event) {
         const char *name = "unknown";
         json_t *context;
@@ -238,7 +214,7 @@ struct job *job_create_from_eventlog (flux_jobid_t id,
         if (index == 0) {
             if (eventlog_entry_parse (event, NULL, &name, &context) < 0) {
                 errprintf (error, "eventlog parse error on line %zu", index);
-                goto error;
+                return -1;
             }
             if (!streq (name, "submit")) {
                 errprintf (error, "first event is %s not submit", name);
@@ -257,7 +233,7 @@ struct job *job_create_from_eventlog (flux_jobid_t id,
 
         if (event_job_update (job, event) < 0) {
             errprintf (error, "could not apply %s", name);
-            goto error;
+            return -1;
         }
 
         /* Work around flux-framework/flux-core#4398.
@@ -275,7 +251,49 @@ struct job *job_create_from_eventlog (flux_jobid_t id,
                    flux_job_statetostr (job->state, "L"));
         goto inval;
     }
+    return 0;
+inval:
+    errno = EINVAL;
+    return -1;
+}
+
+struct job *job_create_from_eventlog (flux_jobid_t id,
+                                      const char *eventlog,
+                                      const char *jobspec,
+                                      const char *R,
+                                      flux_error_t *error)
+{
+    struct job *job;
+
+    if (!(job = job_alloc()))
+        return NULL;
+    job->id = id;
+
+    if (!(job->jobspec_redacted = json_loads (jobspec, 0, NULL))) {
+        errprintf (error, "failed to decode jobspec");
+        goto inval;
+    }
+    jpath_del (job->jobspec_redacted, "attributes.system.environment");
+
+    if (jobspec_redacted_parse_queue (job) < 0) {
+        errprintf (error, "failed to decode jobspec queue");
+        goto inval;
+    }
+
+    if (R) {
+        if (!(job->R_redacted = json_loads (R, 0, NULL))) {
+            errprintf (error, "failed to decode R");
+            goto inval;
+        }
+        (void)json_object_del (job->R_redacted, "scheduling");
+    }
 
+    if (!(job->eventlog = eventlog_decode (eventlog))) {
+        errprintf (error, "failed to decode eventlog");
+        goto error;
+    }
+    if (job_replay_eventlog (job, error) < 0)
+        goto error;
     return job;
 inval:
     errno = EINVAL;
@@ -284,6 +302,56 @@ error:
     return NULL;
 }
 
+struct job *job_create_from_snapshot (json_t *o, flux_error_t *error)
+{
+    struct job *job;
+
+    if (!(job = job_alloc ()))
+        return NULL;
+    if (json_unpack (o,
+                     "{s:I s:O s:O s?O}",
+                     "id", &job->id,
+                     "eventlog", &job->eventlog,
+                     "jobspec", &job->jobspec_redacted,
+                     "R", &job->R_redacted) < 0
+        || !json_is_array (job->eventlog)) {
+        errprintf (error, "malformed snapshot entry");
+        errno = EPROTO;
+        goto error;
+    }
+    if (jobspec_redacted_parse_queue (job) < 0) {
+        errprintf (error, "failed to decode jobspec queue");
+        errno = EINVAL;
+        goto error;
+    }
+    if (job_replay_eventlog (job, error) < 0)
+        goto error;
+    return job;
+error:
+    job_decref (job);
+    return NULL;
+}
+
+json_t *job_snapshot (struct job *job)
+{
+    json_t *o;
+
+    if (!(o = json_pack ("{s:I s:O s:O}",
+                         "id", job->id,
+                         "eventlog", job->eventlog,
+                         "jobspec", job->jobspec_redacted)))
+        goto nomem;
+    if (job->R_redacted
+        && json_object_set (o, "R", job->R_redacted) < 0) {
+        json_decref (o);
+        goto nomem;
+    }
+    return o;
+nomem:
+    errno = ENOMEM;
+    return NULL;
+}
+
 struct job *job_create_from_json (json_t *o)
 {
     struct job *job;
@@ -644,8 +712,108 @@ static int jobspec_apply_updates (json_t *jobspec, json_t *updates)
     return 0;
 }
 
+static const char *job_dumps (json_t *o, char **cache)
+{
+    if (!o) {
+        errno = EAGAIN;
+        return NULL;
+    }
+    if (!*cache && !(*cache = json_dumps (o, JSON_COMPACT))) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    return *cache;
+}
+
+const char *job_jobspec_str (struct job *job)
+{
+    return job_dumps (job->jobspec_redacted, &job->jobspec_str);
+}
+
+const char *job_R_str (struct job *job)
+{
+    return job_dumps (job->R_redacted, &job->R_str);
+}
+
+json_t *job_R_summary (struct job *job)
+{
+    struct rlist *rl = NULL;
+    struct idset *ranks = NULL;
+    struct hostlist *hl = NULL;
+    char *ranks_str = NULL;
+    char *nodelist = NULL;
+    struct rnode *n;
+    int ncores = 0;
+    json_error_t error;
+    int saved_errno;
+
+    if (job->R_summary)
+        return job->R_summary;
+    if (!job->R_redacted) {
+        errno = EAGAIN;
+        return NULL;
+    }
+    if (!(rl = rlist_from_json (job->R_redacted, &error))) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(ranks = rlist_ranks (rl))
+        || !(ranks_str = idset_encode (ranks,
+                                       IDSET_FLAG_BRACKETS
+                                       | IDSET_FLAG_RANGE))
+        || !(hl = rlist_nodelist (rl))
+        || !(nodelist = hostlist_encode (hl)))
+        goto done;
+    n = zlistx_first (rl->nodes);
+    while (n) {
+        ncores += idset_count (n->cores->ids);
+        n = zlistx_next (rl->nodes);
+    }
+    if (!(job->R_summary = json_pack ("{s:i s:i s:s s:s}",
+                                      "nnodes", (int)idset_count (ranks),
+                                      "ncores", ncores,
+                                      "ranks", ranks_str,
+                                      "nodelist", nodelist))) {
+        errno = ENOMEM;
+        goto done;
+    }
+done:
+    saved_errno = errno;
+    free (nodelist);
+    hostlist_destroy (hl);
+    free (ranks_str);
+    idset_destroy (ranks);
+    rlist_destroy (rl);
+    errno = saved_errno;
+    return job->R_summary;
+}
+
+char *job_dumps_with (json_t *o, const char *key, const char *val)
+{
+    char *s;
+    char *result;
+    size_t len;
+
+    if (!(s = json_dumps (o, JSON_COMPACT))) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    len = strlen (s);
+    if (len < 3 || s[len - 1] != '}') { // must be a non-empty object
+        free (s);
+        errno = EINVAL;
+        return NULL;
+    }
+    if (asprintf (&result, "%.*s,\"%s\":%s}", (int)len - 1, s, key, val) < 0)
+        result = NULL;
+    free (s);
+    return result;
+}
+
 int job_apply_jobspec_updates (struct job *job, json_t *updates)
 {
+    free (job->jobspec_str);
+    job->jobspec_str = NULL;
     if (jobspec_apply_updates (job->jobspec_redacted, updates) < 0
         || jobspec_redacted_parse_queue (job) < 0)
         return -1;
@@ -694,6 +862,8 @@ int job_apply_resource_updates (struct job *job, json_t *updates)
     }
     /*  Update redacted copy of R in place.
      */
+    free (job->R_str);
+    job->R_str = NULL;
     return jpath_set (job->R_redacted, "execution.expiration", val);
 }
 
@@ -30,11 +30,15 @@ struct job {
     int flags;
     json_t *jobspec_redacted;
     json_t *R_redacted;
+    char *jobspec_str;      // cached serialization of jobspec_redacted
+    char *R_str;            // cached serialization of R_redacted
+    json_t *R_summary;      // cached result of job_R_summary()
     json_t *eventlog;
     flux_job_state_t state;
     json_t *event_queue;
     json_t *end_event;      // event that caused transition to CLEANUP state
     const flux_msg_t *waiter; // flux_job_wait() request
+    void *waiter_handle;    // zlistx_t handle in list of jobs with a waiter
     double t_clean;
 
     uint8_t depend_posted:1;// depend event already posted
@@ -77,6 +81,12 @@ struct job *job_create_from_eventlog (flux_jobid_t id,
                                       flux_error_t *error);
 struct job *job_create_from_json (json_t *o);
 
+/* Encode an inactive job for the restart snapshot, and recreate it by
+ * replaying the encoded eventlog, without any KVS lookups.
+ */
+json_t *job_snapshot (struct job *job);
+struct job *job_create_from_snapshot (json_t *o, flux_error_t *error);
+
 /* N.B. aux items are destroyed when job transitions to inactive.
  */
 int job_aux_set (struct job *job,
@@ -146,6 +156,29 @@ json_t *job_jobspec_with_updates (struct job *job, json_t *updates);
  */
 int job_apply_resource_updates (struct job *job, json_t *updates);
 
+/* Return jobspec_redacted or R_redacted serialized as compact JSON.
+ * The string is cached until the object is updated by one of the
+ * job_apply_*_updates() functions above, so it may be sent repeatedly
+ * without re-encoding.  Fails with EAGAIN if the object is not set.
+ */
+const char *job_jobspec_str (struct job *job);
+const char *job_R_str (struct job *job);
+
+/* Return an object summarizing the resources in R_redacted:
+ *   {"nnodes":i, "ncores":i, "ranks":s, "nodelist":s}
+ * so consumers of R need not parse it for these common values.
+ * The result is computed once and cached, since resource updates do
+ * not change the assigned resources.  Fails with EAGAIN if R_redacted
+ * is not set.
+ */
+json_t *job_R_summary (struct job *job);
+
+/* Serialize 'o', a non-empty JSON object, with 'key' added and set to
+ * 'val', which is already serialized JSON such as job_jobspec_str().
+ * Caller must free the result.
+ */
+char *job_dumps_with (json_t *o, const char *key, const char *val);
+
 #endif /* _FLUX_JOB_MANAGER_JOB_H */
 
 /*
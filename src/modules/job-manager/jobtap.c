@@ -83,6 +83,7 @@ struct jobtap {
     zlistx_t *builtins_ex;
     zlistx_t *plugins;
     zhashx_t *plugins_byuuid;
+    zhashx_t *topics;       // topic => list of plugins with a handler for it
     zlistx_t *jobstack;
     json_t *jobspec_update;
     bool configured;
@@ -307,7 +308,7 @@ static flux_plugin_t * jobtap_load_plugin (struct jobtap *jobtap,
 
     /*  Make plugin aware of all active jobs.
      */
-    if (!(jobs = zhashx_values (ctx->active_jobs))) {
+    if (!(jobs = jobmap_values (ctx->active_jobs))) {
         errprintf (errp, "zhashx_values() failed");
         goto error;
     }
@@ -373,7 +374,7 @@ static void jobtap_finalize (struct jobtap *jobtap, flux_plugin_t *p)
 {
     zlistx_t *jobs;
 
-    if ((jobs = zhashx_values (jobtap->ctx->active_jobs))) {
+    if ((jobs = jobmap_values (jobtap->ctx->active_jobs))) {
         struct job *job;
 
         job = zlistx_first (jobs);
@@ -406,6 +407,7 @@ static int jobtap_remove (struct jobtap *jobtap,
             jobtap_finalize (jobtap, p);
             zhashx_delete (jobtap->plugins_byuuid, flux_plugin_get_uuid (p));
             zlistx_detach_cur (jobtap->plugins);
+            zhashx_purge (jobtap->topics);
             flux_plugin_destroy (p);
             count++;
         }
@@ -594,6 +596,16 @@ static int load_builtins (struct jobtap *jobtap)
     return 0;
 }
 
+// zhashx_destructor_fn footprint
+static void topic_plugins_destructor (void **item)
+{
+    if (item) {
+        zlistx_t *l = *item;
+        zlistx_destroy (&l);
+        *item = NULL;
+    }
+}
+
 struct jobtap *jobtap_create (struct job_manager *ctx)
 {
     const char *path;
@@ -607,6 +619,7 @@ struct jobtap *jobtap_create (struct job_manager *ctx)
         goto error;
     if (!(jobtap->plugins = zlistx_new ())
         || !(jobtap->plugins_byuuid = zhashx_new ())
+        || !(jobtap->topics = zhashx_new ())
         || !(jobtap->jobstack = zlistx_new ())
         || !(jobtap->builtins_ex = zlistx_new ())) {
         errno = ENOMEM;
@@ -616,6 +629,7 @@ struct jobtap *jobtap_create (struct job_manager *ctx)
     zlistx_set_comparator (jobtap->plugins, plugin_byname);
     zhashx_set_key_duplicator (jobtap->plugins_byuuid, NULL);
     zhashx_set_key_destructor (jobtap->plugins_byuuid, NULL);
+    zhashx_set_destructor (jobtap->topics, topic_plugins_destructor);
     zlistx_set_destructor (jobtap->jobstack, job_destructor);
     zlistx_set_duplicator (jobtap->jobstack, job_duplicator);
     zlistx_set_destructor (jobtap->builtins_ex, builtin_ex_destructor);
@@ -645,6 +659,7 @@ void jobtap_destroy (struct jobtap *jobtap)
     if (jobtap) {
         int saved_errno = errno;
         conf_unregister_callback (jobtap->ctx->conf, jobtap_parse_config);
+        zhashx_destroy (&jobtap->topics);
         zlistx_destroy (&jobtap->plugins);
         zhashx_destroy (&jobtap->plugins_byuuid);
         zlistx_destroy (&jobtap->jobstack);
@@ -656,17 +671,48 @@ void jobtap_destroy (struct jobtap *jobtap)
     }
 }
 
-static int jobtap_topic_match_count (struct jobtap *jobtap,
-                                     const char *topic)
+/* Return the list of plugins with a handler matching 'topic', in load
+ * order.  The list is built on first use and cached until a plugin is
+ * loaded or removed, so repeated calls for a topic do no glob matching.
+ * N.B. plugins are expected to register their handlers when loaded.
+ */
+static zlistx_t *jobtap_topic_plugins (struct jobtap *jobtap,
+                                       const char *topic)
 {
-    int count = 0;
-    flux_plugin_t *p = zlistx_first (jobtap->plugins);
+    zlistx_t *l;
+    flux_plugin_t *p;
+
+    if ((l = zhashx_lookup (jobtap->topics, topic)))
+        return l;
+    if (!(l = zlistx_new ()))
+        goto nomem;
+    p = zlistx_first (jobtap->plugins);
     while (p) {
-        if (flux_plugin_match_handler (p, topic))
-            count++;
+        if (flux_plugin_match_handler (p, topic)
+            && !zlistx_add_end (l, p)) {
+            zlistx_destroy (&l);
+            goto nomem;
+        }
         p = zlistx_next (jobtap->plugins);
     }
-    return count;
+    if (zhashx_insert (jobtap->topics, topic, l) < 0) {
+        zlistx_destroy (&l);
+        goto nomem;
+    }
+    return l;
+nomem:
+    errno = ENOMEM;
+    return NULL;
+}
+
+static int jobtap_topic_match_count (struct jobtap *jobtap,
+                                     const char *topic)
+{
+    zlistx_t *l;
+
+    if (!(l = jobtap_topic_plugins (jobtap, topic)))
+        return -1;
+    return zlistx_size (l);
 }
 
 static int jobtap_post_jobspec_updates (struct jobtap *jobtap,
@@ -762,7 +808,7 @@ int jobtap_get_priority (struct jobtap *jobtap,
         return -1;
 
     rc = jobtap_stack_call (jobtap,
-                            jobtap->plugins,
+                            jobtap_topic_plugins (jobtap, "job.priority.get"),
                             job,
                             "job.priority.get",
                             args);
@@ -855,7 +901,7 @@ static int jobtap_call_early (struct jobtap *jobtap,
         return -1;
 
     rc = jobtap_stack_call (jobtap,
-                            jobtap->plugins,
+                            jobtap_topic_plugins (jobtap, topic),
                             job,
                             topic,
                             args);
@@ -963,7 +1009,11 @@ static int jobtap_check_dependency (struct jobtap *jobtap,
     if (p)
         rc = flux_plugin_call (p, topic, args);
     else
-        rc = jobtap_stack_call (jobtap, jobtap->plugins, job, topic, args);
+        rc = jobtap_stack_call (jobtap,
+                                jobtap_topic_plugins (jobtap, topic),
+                                job,
+                                topic,
+                                args);
 
     if (rc == 0) {
         /*  No handler for job.dependency.<scheme>. return an error.
@@ -1157,7 +1207,11 @@ int jobtap_call (struct jobtap *jobtap,
     if (!args)
         return -1;
 
-    rc = jobtap_stack_call (jobtap, jobtap->plugins, job, topic, args);
+    rc = jobtap_stack_call (jobtap,
+                            jobtap_topic_plugins (jobtap, topic),
+                            job,
+                            topic,
+                            args);
     if (rc < 0) {
         flux_log (jobtap->ctx->h,
                   LOG_ERR,
@@ -1503,6 +1557,7 @@ flux_plugin_t * jobtap_load (struct jobtap *jobtap,
         errno = ENOMEM;
         goto error;
     }
+    zhashx_purge (jobtap->topics);
     return p;
 error:
     if (errp && errp->text[0] == '\0')
@@ -1812,6 +1867,40 @@ int flux_jobtap_reprioritize_job (flux_plugin_t *p,
     return reprioritize_id (jobtap->ctx, id, priority);
 }
 
+int flux_jobtap_reprioritize_jobs (flux_plugin_t *p,
+                                   const flux_jobid_t *ids,
+                                   const unsigned int *priority,
+                                   int count)
+{
+    struct jobtap *jobtap = flux_plugin_aux_get (p, "flux::jobtap");
+    int64_t *pri = NULL;
+    int rc;
+
+    if (!jobtap || count < 0 || (count > 0 && (!ids || !priority))) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (count > 0) {
+        if (!(pri = calloc (count, sizeof (pri[0]))))
+            return -1;
+        for (int i = 0; i < count; i++)
+            pri[i] = priority[i];
+    }
+    rc = reprioritize_jobs (jobtap->ctx, ids, pri, count);
+    ERRNO_SAFE_WRAP (free, pri);
+    return rc;
+}
+
+int flux_jobtap_reprioritize_user (flux_plugin_t *p, uint32_t userid)
+{
+    struct jobtap *jobtap = flux_plugin_aux_get (p, "flux::jobtap");
+    if (!jobtap) {
+        errno = EINVAL;
+        return -1;
+    }
+    return reprioritize_user (jobtap->ctx, userid);
+}
+
 int flux_jobtap_priority_unavail (flux_plugin_t *p, flux_plugin_arg_t *args)
 {
     struct jobtap *jobtap = flux_plugin_aux_get (p, "flux::jobtap");
@@ -1883,7 +1972,7 @@ int flux_jobtap_reject_job (flux_plugin_t *p,
 static struct job *lookup_active_job (struct job_manager *ctx,
                                       flux_jobid_t id)
 {
-    struct job *job = zhashx_lookup (ctx->active_jobs, &id);
+    struct job *job = jobmap_lookup (ctx->active_jobs, id);
     if (!job)
         errno = ENOENT;
     return job;
@@ -1893,7 +1982,7 @@ static struct job *lookup_job (struct job_manager *ctx, flux_jobid_t id)
 {
     struct job *job;
     if (!(job = lookup_active_job (ctx, id))
-        && !(job = zhashx_lookup (ctx->inactive_jobs, &id)))
+        && !(job = jobmap_lookup (ctx->inactive_jobs, id)))
         errno = ENOENT;
     return job;
 }
@@ -2495,7 +2584,11 @@ int jobtap_job_update (struct jobtap *jobtap,
         flux_plugin_arg_destroy (args);
         return -1;
     }
-    rc = jobtap_stack_call (jobtap, jobtap->plugins, job, topic, args);
+    rc = jobtap_stack_call (jobtap,
+                            jobtap_topic_plugins (jobtap, topic),
+                            job,
+                            topic,
+                            args);
     if (rc == 0) {
         /* No plugin handles update of this jobspec key, reject the update.
          */
@@ -2589,7 +2682,7 @@ int jobtap_validate_updates (struct jobtap *jobtap,
     /*  Call validation stack
      */
     rc = jobtap_stack_call (jobtap,
-                            jobtap->plugins,
+                            jobtap_topic_plugins (jobtap, "job.validate"),
                             job,
                             "job.validate",
                             args);
@@ -60,6 +60,22 @@ int flux_jobtap_reprioritize_job (flux_plugin_t *p,
                                   flux_jobid_t id,
                                   unsigned int priority);
 
+/*  Set the priorities of 'count' jobs at once, where priority[i] is the
+ *   new priority of job ids[i].  Only the affected jobs are reordered in
+ *   the job manager queue, and the scheduler is sent one batched priority
+ *   update.  Jobs that are inactive or not in the PRIORITY or SCHED states
+ *   are skipped.
+ */
+int flux_jobtap_reprioritize_jobs (flux_plugin_t *p,
+                                   const flux_jobid_t *ids,
+                                   const unsigned int *priority,
+                                   int count);
+
+/*  Like flux_jobtap_reprioritize_all(), but only the jobs owned by
+ *   'userid' are reprioritized, as a batch.
+ */
+int flux_jobtap_reprioritize_user (flux_plugin_t *p, uint32_t userid);
+
 /*  Convenience function to return unavailable priority in PRIORITY state
  */
 int flux_jobtap_priority_unavail (flux_plugin_t *p,
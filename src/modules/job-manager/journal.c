@@ -12,37 +12,67 @@
  *
  * This allows another service to track detailed information about
  * all jobs.  The journal consumer makes a job-manager.events-journal
- * request with optional allow/deny filter and boolean 'full' flag:
- *   {"full"?b, "allow"?{"name":1, ...}, "deny"?{"name:1, ...}}
+ * request with optional filters, a resume point, and boolean 'full' and
+ * 'coalesce' flags:
+ *   {"full"?b, "coalesce"?b, "allow"?{"name":1, ...}, "deny"?{"name:1, ...},
+ *    "userid"?i, "queue"?s, "ids"?[I,I], "states"?i, "since"?I}
  *
  * If "full" is true, the journal begins with all the inactive jobs.
  * If "full" is false, the journal begins with all the active jobs.
  * If "full" is unspecified, it is assumed to be false.
  * If allow/deny rules are specified, they filter the job events by name.
+ * If "userid", "queue", "ids" (an inclusive [min, max] range of job IDs),
+ * or "states" (a mask of job states) are specified, only jobs that match
+ * all of them are included.  For "states", an event matches if the job is
+ * in one of the states after the event is applied.
+ *
+ * Each real time response includes a sequence number "seq".  If "since" is
+ * set to a sequence number received earlier, and all events after it are
+ * still in the journal history, the backlog is replaced by those events.
+ * Otherwise the backlog is sent as usual.  Sequence numbers start at the
+ * time the job manager was loaded, in microseconds since the epoch, so a
+ * number from before a restart is never mistaken for a recent one.
  *
  * The journal consumer receives a stream of responses until the job
  * manager is unloaded or the request is canceled.  Each response consists of
  * an object containing a jobid, an array of events, and optional data:
- *   {"id":I, "events":[], "jobspec"?s, "R"?s}
+ *   {"id":I, "events":[], "jobspec"?s, "R"?s, "R_summary"?o}
  *
  * During processing of the initial backlog, the events array will contain
  * all the events posted so far for each job, plus R and jobspec if available.
  * The jobs are returned in hash traversal order.  Once backlog processing
  * is complete, a sentinel response is transmitted with id of FLUX_JOBID_ANY
- * and an empty events array:
- *   {"id":-1, "events":[]}
+ * and an empty events array, plus the sequence number of the most recent
+ * event, and whether the backlog was replaced by history after "since":
+ *   {"id":-1, "events":[], "seq":I, "resumed":b}
  *
  * The sentinel informs the consumer that it is now caught up and that future
  * responses will be for events that are are posted in real time.
  *
- * Additional responses contain at most one event.  The redacted jobspec is
- * included with the "validate" event.  The redacted R object is included
- * with the "alloc" event.
+ * Additional responses contain at most one event, and its sequence number:
+ *   {"id":I, "events":[], "seq":I, "jobspec"?s, "R"?s, "R_summary"?o}
+ * The redacted jobspec is included with the "validate" event.  The
+ * redacted R object is included with the "alloc" event, along with
+ * R_summary, the node and core counts, rank idset, and nodelist of R
+ * from job_R_summary(), so consumers need not parse R for them.
+ *
+ * Purged jobs also take a sequence number and a place in the history,
+ * under the name "purge".  They are only sent when resuming after "since",
+ * as consumers that are connected learn of purges from the
+ * job-purge-inactive event:
+ *   {"id":I, "events":[], "seq":I, "purged":true}
+ *
+ * If "coalesce" is true, responses generated during one reactor loop
+ * iteration (e.g. the backlog, or a burst of events) are collected and
+ * sent with flux_respond_batch(), up to JOURNAL_BATCH_MAX per message.
+ * The consumer's streaming RPC future sees them as individual responses.
  */
 
 #if HAVE_CONFIG_H
 #include "config.h"
 #endif
+#include <sys/time.h>
+#include <string.h>
 #include <jansson.h>
 #include <flux/core.h>
 
@@ -58,15 +88,38 @@
 #include "job.h"
 #include "journal.h"
 
+#define JOURNAL_BATCH_MAX 256
+#define JOURNAL_HISTORY_MAX 10000
+
+struct journal_entry {
+    uint64_t seq;
+    struct job *job;
+    char *name;
+    json_t *o;          // response object
+};
+
 struct journal {
     struct job_manager *ctx;
     flux_msg_handler_t **handlers;
     struct flux_msglist *listeners;
+    flux_watcher_t *prep;
+    uint64_t seq;       // sequence number of the most recent event
+    struct journal_entry history[JOURNAL_HISTORY_MAX]; // ring buffer
+    int history_start;
+    int history_count;
 };
 
 struct journal_filter { // stored as aux item in request message
-    json_t *allow;      // allow, deny are owned by message
+    json_t *allow;      // allow, deny, queue are owned by message
     json_t *deny;
+    int coalesce;
+    uint32_t userid;
+    const char *queue;
+    flux_jobid_t id_min;
+    flux_jobid_t id_max;
+    int states;
+    char *pending[JOURNAL_BATCH_MAX];
+    int pending_count;
 };
 
 static bool allow_deny_check (const flux_msg_t *msg, const char *name)
@@ -88,6 +141,23 @@ static bool allow_deny_check (const flux_msg_t *msg, const char *name)
     return add_entry;
 }
 
+/* Return true if 'job' matches the job filters in the request.
+ */
+static bool job_check (const flux_msg_t *msg, struct job *job)
+{
+    struct journal_filter *filter = flux_msg_aux_get (msg, "filter");
+
+    if (job->id < filter->id_min || job->id > filter->id_max)
+        return false;
+    if (filter->userid != FLUX_USERID_UNKNOWN && filter->userid != job->userid)
+        return false;
+    if (filter->queue && (!job->queue || !streq (filter->queue, job->queue)))
+        return false;
+    if (filter->states && !(filter->states & job->state))
+        return false;
+    return true;
+}
+
 static bool allow_all (const flux_msg_t *msg)
 {
     struct journal_filter *filter = flux_msg_aux_get (msg, "filter");
@@ -96,37 +166,200 @@ static bool allow_all (const flux_msg_t *msg)
     return true;
 }
 
+static int journal_flush (flux_t *h, const flux_msg_t *msg)
+{
+    struct journal_filter *filter = flux_msg_aux_get (msg, "filter");
+    int rc = 0;
+    int i;
+
+    if (filter && filter->pending_count > 0) {
+        rc = flux_respond_batch (h,
+                                 msg,
+                                 (const char **)filter->pending,
+                                 filter->pending_count);
+        for (i = 0; i < filter->pending_count; i++)
+            ERRNO_SAFE_WRAP (free, filter->pending[i]);
+        filter->pending_count = 0;
+    }
+    return rc;
+}
+
+static void journal_flush_all (struct journal *journal)
+{
+    flux_t *h = journal->ctx->h;
+    const flux_msg_t *msg;
+
+    msg = flux_msglist_first (journal->listeners);
+    while (msg) {
+        if (journal_flush (h, msg) < 0) {
+            flux_log_error (h,
+                            "error responding to"
+                            " job-manager.events-journal request");
+        }
+        msg = flux_msglist_next (journal->listeners);
+    }
+    flux_watcher_stop (journal->prep);
+}
+
+/* Hold serialized response 's' until the end of this reactor loop
+ * iteration.  The string is freed when it is sent.
+ */
+static int journal_pending_add (struct journal *journal,
+                                const flux_msg_t *msg,
+                                char *s)
+{
+    struct journal_filter *filter = flux_msg_aux_get (msg, "filter");
+
+    filter->pending[filter->pending_count++] = s;
+    if (filter->pending_count == JOURNAL_BATCH_MAX)
+        return journal_flush (journal->ctx->h, msg);
+    flux_watcher_start (journal->prep);
+    return 0;
+}
+
+/* Send one journal response, or if the consumer asked for coalesced
+ * responses, hold it until the end of this reactor loop iteration.
+ */
+static int journal_respond (struct journal *journal,
+                            const flux_msg_t *msg,
+                            json_t *o)
+{
+    struct journal_filter *filter = flux_msg_aux_get (msg, "filter");
+    char *s;
+
+    if (!filter->coalesce)
+        return flux_respond_pack (journal->ctx->h, msg, "O", o);
+    if (!(s = json_dumps (o, JSON_COMPACT))) {
+        errno = ENOMEM;
+        return -1;
+    }
+    return journal_pending_add (journal, msg, s);
+}
+
+/* Like journal_respond(), with a response that is already serialized.
+ */
+static int journal_respond_str (struct journal *journal,
+                                const flux_msg_t *msg,
+                                const char *s)
+{
+    struct journal_filter *filter = flux_msg_aux_get (msg, "filter");
+    char *cpy;
+
+    if (!filter->coalesce)
+        return flux_respond (journal->ctx->h, msg, s);
+    if (!(cpy = strdup (s)))
+        return -1;
+    return journal_pending_add (journal, msg, cpy);
+}
+
+static void prep_cb (flux_reactor_t *r,
+                     flux_watcher_t *w,
+                     int revents,
+                     void *arg)
+{
+    struct journal *journal = arg;
+
+    journal_flush_all (journal);
+}
+
+static void history_entry_clear (struct journal_entry *e)
+{
+    job_decref (e->job);
+    free (e->name);
+    json_decref (e->o);
+    memset (e, 0, sizeof (*e));
+}
+
+/* Add an event to the history, replacing the oldest if the history is full.
+ */
+static int history_append (struct journal *journal,
+                           struct job *job,
+                           const char *name,
+                           json_t *o)
+{
+    struct journal_entry *e;
+    char *cpy;
+
+    if (!(cpy = strdup (name)))
+        return -1;
+    if (journal->history_count == JOURNAL_HISTORY_MAX) {
+        e = &journal->history[journal->history_start];
+        history_entry_clear (e);
+        journal->history_start = (journal->history_start + 1)
+                                 % JOURNAL_HISTORY_MAX;
+    }
+    else {
+        int i = (journal->history_start + journal->history_count)
+                % JOURNAL_HISTORY_MAX;
+        e = &journal->history[i];
+        journal->history_count++;
+    }
+    e->seq = journal->seq;
+    e->job = job_incref (job);
+    e->name = cpy;
+    e->o = json_incref (o);
+    return 0;
+}
+
 int journal_process_event (struct journal *journal,
-                           flux_jobid_t id,
+                           struct job *job,
                            const char *name,
                            json_t *entry)
 {
     struct job_manager *ctx = journal->ctx;
     const flux_msg_t *msg;
     json_t *o;
+    char *s = NULL;
 
-    if (!(o = json_pack ("{s:I s:[O]}",
-                         "id", id,
-                         "events", entry)))
+    journal->seq++;
+    if (!(o = json_pack ("{s:I s:[O] s:I}",
+                         "id", job->id,
+                         "events", entry,
+                         "seq", (json_int_t)journal->seq)))
         goto error;
+    /* Serialize the response once for all listeners, splicing in the
+     * job's cached jobspec or R rather than re-encoding it.
+     */
+    if (streq (name, "alloc")) {
+        json_t *summary;
+
+        if ((summary = job_R_summary (job))
+            && json_object_set (o, "R_summary", summary) < 0)
+            goto error;
+    }
+    if (flux_msglist_count (journal->listeners) > 0) {
+        const char *val;
+
+        if (streq (name, "validate")) {
+            if (!(val = job_jobspec_str (job))
+                || !(s = job_dumps_with (o, "jobspec", val)))
+                goto error;
+        }
+        else if (streq (name, "alloc")) {
+            if (!(val = job_R_str (job))
+                || !(s = job_dumps_with (o, "R", val)))
+                goto error;
+        }
+        else if (!(s = json_dumps (o, JSON_COMPACT)))
+            goto error;
+    }
     if (streq (name, "validate")) {
-        struct job *job;
-        if (!(job = zhashx_lookup (ctx->active_jobs, &id))
-            || !job->jobspec_redacted
+        if (!job->jobspec_redacted
             || json_object_set (o, "jobspec", job->jobspec_redacted) < 0)
             goto error;
     }
     else if (streq (name, "alloc")) {
-        struct job *job;
-        if (!(job = zhashx_lookup (ctx->active_jobs, &id))
-            || !job->R_redacted
+        if (!job->R_redacted
             || json_object_set (o, "R", job->R_redacted) < 0)
             goto error;
     }
+    if (history_append (journal, job, name, o) < 0)
+        goto error;
     msg = flux_msglist_first (journal->listeners);
     while (msg) {
         if (allow_deny_check (msg, name)
-            && flux_respond_pack (ctx->h, msg, "O", o) < 0) {
+            && job_check (msg, job)
+            && journal_respond_str (journal, msg, s) < 0) {
             flux_log_error (ctx->h,
                             "error responding to"
                             " job-manager.events-journal request");
@@ -134,19 +367,47 @@ int journal_process_event (struct journal *journal,
         msg = flux_msglist_next (journal->listeners);
     }
     json_decref (o);
+    free (s);
     return 0;
 error:
     flux_log_error (ctx->h,
                     "error preparing journal response for %s %s",
-                    idf58 (id),
+                    idf58 (job->id),
                     name);
     json_decref (o);
+    free (s);
+    return 0;
+}
+
+int journal_process_purge (struct journal *journal, struct job *job)
+{
+    json_t *o;
+
+    journal->seq++;
+    if (!(o = json_pack ("{s:I s:[] s:I s:b}",
+                         "id", job->id,
+                         "events",
+                         "seq", (json_int_t)journal->seq,
+                         "purged", 1))
+        || history_append (journal, job, "purge", o) < 0) {
+        flux_log_error (journal->ctx->h,
+                        "error adding purge of %s to journal history",
+                        idf58 (job->id));
+    }
+    json_decref (o);
     return 0;
 }
 
 static void filter_destroy (struct journal_filter *filter)
 {
-    ERRNO_SAFE_WRAP (free, filter);
+    if (filter) {
+        int saved_errno = errno;
+        int i;
+        for (i = 0; i < filter->pending_count; i++)
+            free (filter->pending[i]);
+        free (filter);
+        errno = saved_errno;
+    }
 }
 
 static int send_job_events (struct job_manager *ctx,
@@ -156,6 +417,8 @@ static int send_job_events (struct job_manager *ctx,
     json_t *eventlog;
     json_t *o = NULL;
 
+    if (!job_check (msg, job))
+        return 0;
     if (allow_all (msg)) {
         eventlog = json_incref (job->eventlog);
     }
@@ -184,10 +447,15 @@ static int send_job_events (struct job_manager *ctx,
             goto nomem;
     }
     if (job->R_redacted) {
+        json_t *summary;
+
         if (json_object_set (o, "R", job->R_redacted) < 0)
             goto nomem;
+        if ((summary = job_R_summary (job))
+            && json_object_set (o, "R_summary", summary) < 0)
+            goto nomem;
     }
-    if (flux_respond_pack (ctx->h, msg, "O", o) < 0)
+    if (journal_respond (ctx->journal, msg, o) < 0)
         goto error;
     json_decref (o);
     json_decref (eventlog);
@@ -200,18 +468,70 @@ static int send_job_events (struct job_manager *ctx,
     return -1;
 }
 
+/* If the history holds every event after 'since', send those events
+ * that pass the filters and set 'resumed' to true.  History entries hold
+ * a reference on their job, so purged jobs may linger until their events
+ * age out of the history.
+ */
+static int send_history (struct journal *journal,
+                         const flux_msg_t *msg,
+                         uint64_t since,
+                         bool *resumed)
+{
+    int i;
+
+    *resumed = false;
+    if (since > journal->seq)
+        return 0;
+    if (since < journal->seq) {
+        struct journal_entry *oldest;
+
+        if (journal->history_count == 0)
+            return 0;
+        oldest = &journal->history[journal->history_start];
+        if (oldest->seq > since + 1)
+            return 0;
+    }
+    for (i = 0; i < journal->history_count; i++) {
+        struct journal_entry *e;
+
+        e = &journal->history[(journal->history_start + i)
+                              % JOURNAL_HISTORY_MAX];
+        if (e->seq <= since
+            || !allow_deny_check (msg, e->name)
+            || !job_check (msg, e->job))
+            continue;
+        if (journal_respond (journal, msg, e->o) < 0)
+            return -1;
+    }
+    *resumed = true;
+    return 0;
+}
+
 /* The entire backlog must be sent to a journal consumer before
  * any new events can be generated, event if it's large.
  */
 static int send_backlog (struct job_manager *ctx,
                          const flux_msg_t *msg,
-                         bool full)
+                         bool full,
+                         bool since_set,
+                         uint64_t since)
 {
+    struct journal *journal = ctx->journal;
     struct job *job;
-    int job_count = zhashx_size (ctx->active_jobs);
+    int job_count = jobmap_size (ctx->active_jobs);
+    bool resumed = false;
+    json_t *o;
+    int rc;
 
+    if (since_set) {
+        if (send_history (journal, msg, since, &resumed) < 0)
+            return -1;
+        if (resumed)
+            goto sentinel;
+    }
     if (full)
-        job_count += zhashx_size (ctx->inactive_jobs);
+        job_count += jobmap_size (ctx->inactive_jobs);
 
     if (job_count > 0) {
         flux_log (ctx->h,
@@ -221,18 +541,18 @@ static int send_backlog (struct job_manager *ctx,
     }
 
     if (full) {
-        job = zhashx_first (ctx->inactive_jobs);
+        job = jobmap_first (ctx->inactive_jobs);
         while (job) {
             if (send_job_events (ctx, msg, job) < 0)
                 return -1;
-            job = zhashx_next (ctx->inactive_jobs);
+            job = jobmap_next (ctx->inactive_jobs);
         }
     }
-    job = zhashx_first (ctx->active_jobs);
+    job = jobmap_first (ctx->active_jobs);
     while (job) {
         if (send_job_events (ctx, msg, job) < 0)
             return -1;
-        job = zhashx_next (ctx->active_jobs);
+        job = jobmap_next (ctx->active_jobs);
     }
 
     if (job_count > 0) {
@@ -240,16 +560,21 @@ static int send_backlog (struct job_manager *ctx,
                   LOG_DEBUG,
                   "finished sending journal backlog");
     }
+sentinel:
     /* Send a special response with id = FLUX_JOB_ANY to demarcate the
      * backlog from ongoing events.  The consumer may ignore this message.
      */
-    if (flux_respond_pack (ctx->h,
-                           msg,
-                           "{s:I s:[]}",
-                           "id", FLUX_JOBID_ANY,
-                           "events") < 0)
+    if (!(o = json_pack ("{s:I s:[] s:I s:b}",
+                         "id", FLUX_JOBID_ANY,
+                         "events",
+                         "seq", (json_int_t)journal->seq,
+                         "resumed", resumed))) {
+        errno = ENOMEM;
         return -1;
-    return 0;
+    }
+    rc = journal_respond (ctx->journal, msg, o);
+    ERRNO_SAFE_WRAP (json_decref, o);
+    return rc;
 }
 
 static void journal_handle_request (flux_t *h,
@@ -262,16 +587,25 @@ static void journal_handle_request (flux_t *h,
     struct journal *journal = ctx->journal;
     struct journal_filter *filter;
     int full = 0;
+    json_int_t since = -1;
     const char *errstr = NULL;
 
     if (!(filter = calloc (1, sizeof (*filter))))
         goto error;
+    filter->userid = FLUX_USERID_UNKNOWN;
+    filter->id_max = FLUX_JOBID_ANY;
     if (flux_request_unpack (msg,
                              &topic,
-                             "{s?o s?o s?b}",
+                             "{s?o s?o s?b s?b s?i s?s s?[II] s?i s?I}",
                              "allow", &filter->allow,
                              "deny", &filter->deny,
-                             "full", &full) < 0
+                             "full", &full,
+                             "coalesce", &filter->coalesce,
+                             "userid", &filter->userid,
+                             "queue", &filter->queue,
+                             "ids", &filter->id_min, &filter->id_max,
+                             "states", &filter->states,
+                             "since", &since) < 0
         || flux_msg_aux_set (msg, "filter", filter,
                              (flux_free_f)filter_destroy) < 0) {
         filter_destroy (filter);
@@ -295,7 +629,7 @@ static void journal_handle_request (flux_t *h,
         goto error;
     }
 
-    if (send_backlog (ctx, msg, full) < 0) {
+    if (send_backlog (ctx, msg, full, since >= 0, since) < 0) {
         flux_log_error (h, "error responding to %s", topic);
         return;
     }
@@ -303,6 +637,7 @@ static void journal_handle_request (flux_t *h,
         goto error;
     return;
 error:
+    (void)journal_flush (h, msg);
     if (flux_respond_error (h, msg, errno, errstr) < 0)
         flux_log_error (h, "error responding to %s", topic);
 }
@@ -312,6 +647,7 @@ static void journal_cancel_request (flux_t *h, flux_msg_handler_t *mh,
 {
     struct job_manager *ctx = arg;
 
+    journal_flush_all (ctx->journal);
     if (flux_msglist_cancel (h, ctx->journal->listeners, msg) < 0)
         flux_log_error (h, "error handling job-manager.events-journal-cancel");
 }
@@ -332,11 +668,13 @@ void journal_ctx_destroy (struct journal *journal)
     if (journal) {
         int saved_errno = errno;
         flux_t *h = journal->ctx->h;
+        int i;
 
         flux_msg_handler_delvec (journal->handlers);
         if (journal->listeners) {
             const flux_msg_t *msg;
 
+            journal_flush_all (journal);
             msg = flux_msglist_first (journal->listeners);
             while (msg) {
                 if (flux_respond_error (h, msg, ENODATA, NULL) < 0)
@@ -346,6 +684,11 @@ void journal_ctx_destroy (struct journal *journal)
             }
             flux_msglist_destroy (journal->listeners);
         }
+        flux_watcher_destroy (journal->prep);
+        for (i = 0; i < journal->history_count; i++) {
+            int j = (journal->history_start + i) % JOURNAL_HISTORY_MAX;
+            history_entry_clear (&journal->history[j]);
+        }
         free (journal);
         errno = saved_errno;
     }
@@ -367,17 +710,29 @@ static const struct flux_msg_handler_spec htab[] = {
     FLUX_MSGHANDLER_TABLE_END,
 };
 
+static uint64_t journal_seq_start (void)
+{
+    struct timeval tv;
+
+    gettimeofday (&tv, NULL);
+    return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
 struct journal *journal_ctx_create (struct job_manager *ctx)
 {
+    flux_reactor_t *r = flux_get_reactor (ctx->h);
     struct journal *journal;
 
     if (!(journal = calloc (1, sizeof (*journal))))
         return NULL;
     journal->ctx = ctx;
+    journal->seq = journal_seq_start ();
     if (flux_msg_handler_addvec (ctx->h, htab, ctx, &journal->handlers) < 0)
         goto error;
     if (!(journal->listeners = flux_msglist_create ()))
         goto error;
+    if (!(journal->prep = flux_prepare_watcher_create (r, prep_cb, journal)))
+        goto error;
     return journal;
 error:
     journal_ctx_destroy (journal);
@@ -17,15 +17,21 @@
 #include <jansson.h>
 
 #include "job-manager.h"
+#include "job.h"
 
 /* Process the event by sending to any listeners that request the
  * event and append to the journal history.
  */
 int journal_process_event (struct journal *journal,
-                           flux_jobid_t id,
+                           struct job *job,
                            const char *name,
                            json_t *entry);
 
+/* Append the purge of 'job' to the journal history, so that consumers
+ * resuming after an earlier sequence number learn of it.
+ */
+int journal_process_purge (struct journal *journal, struct job *job);
+
 void journal_ctx_destroy (struct journal *journal);
 struct journal *journal_ctx_create (struct job_manager *ctx);
 
@@ -85,8 +85,8 @@ void kill_handle_request (flux_t *h,
         errno = EINVAL;
         goto error;
     }
-    if (!(job = zhashx_lookup (ctx->active_jobs, &id))) {
-        if (!(job = zhashx_lookup (ctx->inactive_jobs, &id)))
+    if (!(job = jobmap_lookup (ctx->active_jobs, id))) {
+        if (!(job = jobmap_lookup (ctx->inactive_jobs, id)))
             errstr = "unknown job id";
         else
             errstr = "job is inactive";
@@ -157,7 +157,7 @@ void killall_handle_request (flux_t *h,
         errno = EINVAL;
         goto error;
     }
-    job = zhashx_first (ctx->active_jobs);
+    job = jobmap_first (ctx->active_jobs);
     while (job) {
         if (!(job->state & FLUX_JOB_STATE_RUNNING))
             goto next;
@@ -180,7 +180,7 @@ void killall_handle_request (flux_t *h,
             flux_future_destroy (f);
         }
 next:
-        job = zhashx_next (ctx->active_jobs);
+        job = jobmap_next (ctx->active_jobs);
     }
     if (flux_respond_pack (h,
                            msg,
@@ -110,13 +110,13 @@ void list_handle_request (flux_t *h,
     /* Then list remaining active jobs - DEPEND (D), RUN (R), CLEANUP (C)
      * (random order).
      */
-    job = zhashx_first (ctx->active_jobs);
+    job = jobmap_first (ctx->active_jobs);
     while (job && (max_entries == 0 || json_array_size (jobs) < max_entries)) {
         if (!job->alloc_queued) {
             if (list_append_job (jobs, job) < 0)
                 goto error;
         }
-        job = zhashx_next (ctx->active_jobs);
+        job = jobmap_next (ctx->active_jobs);
     }
     /* Finally list any zombies - INACTIVE (I)
      * (random order)
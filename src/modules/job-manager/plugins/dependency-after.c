@@ -10,6 +10,18 @@
 
 /* dependency-simple.c - don't start a job until after another starts,
  *   completes, or fails.
+ *
+ * The dependency graph is stored as adjacency lists embedded in jobs:
+ *   - each requisite job has a list of after_info entries, one per
+ *     dependent job (its out-edges), and
+ *   - each dependent job has a list of after_ref entries, one per
+ *     requisite job (its in-edges), each pointing at the matching
+ *     after_info.
+ * The two are cross-linked with list handles, so releasing a requisite
+ *   job is O(dependents), and dropping a dependent job's references is
+ *   O(requisites), no matter how many edges other jobs have.  The count of
+ *   unmet dependencies per job is kept by the job manager itself (see
+ *   flux_jobtap_dependency_add(3)).
  */
 
 #if HAVE_CONFIG_H
@@ -39,6 +51,7 @@ struct after_info {
     enum after_type type;
     flux_jobid_t depid;
     char *description;
+    struct after_ref *ref;      /* reference held by dependent job, if any */
 };
 
 /*  Reference to an after_info object on another job's dependency list
@@ -46,7 +59,9 @@ struct after_info {
 struct after_ref {
     flux_jobid_t id;
     zlistx_t *list;
-    struct after_info *info;
+    struct after_info *info;    /* NULL once info has been released */
+    void *info_handle;          /* handle of info in list */
+    void *reflist_handle;       /* handle of this ref in global_reflist */
 };
 
 static const char * after_typestr (enum after_type type)
@@ -82,6 +97,10 @@ static int after_type_parse (const char *s, enum after_type *tp)
 static void after_info_destroy (struct after_info *after)
 {
     if (after) {
+        if (after->ref) {
+            after->ref->info = NULL;
+            after->ref->info_handle = NULL;
+        }
         free (after->description);
         free (after);
     }
@@ -118,7 +137,13 @@ error:
 
 static void after_ref_destroy (struct after_ref *ref)
 {
-    free (ref);
+    if (ref) {
+        if (ref->info)
+            ref->info->ref = NULL;
+        if (global_reflist && ref->reflist_handle)
+            zlistx_delete (global_reflist, ref->reflist_handle);
+        free (ref);
+    }
 }
 
 /*  zlistx_destructor_fn for after_ref objects
@@ -126,17 +151,18 @@ static void after_ref_destroy (struct after_ref *ref)
 static void after_ref_destructor (void **item)
 {
     if (*item) {
-        void *handle = zlistx_find (global_reflist, *item);
-        if (handle)
-            zlistx_delete (global_reflist, handle);
         after_ref_destroy (*item);
         *item = NULL;
     }
 }
 
+/*  Create a reference to 'after', which is stored in list 'l' of job 'id'
+ *   under 'handle'.
+ */
 static struct after_ref * after_ref_create (flux_jobid_t id,
                                             zlistx_t *l,
-                                            struct after_info *after)
+                                            struct after_info *after,
+                                            void *handle)
 {
     struct after_ref *ref = calloc (1, sizeof (*ref));
     if (!ref)
@@ -144,7 +170,12 @@ static struct after_ref * after_ref_create (flux_jobid_t id,
     ref->id = id;
     ref->list = l;
     ref->info = after;
-    zlistx_add_end (global_reflist, ref);
+    ref->info_handle = handle;
+    if (!(ref->reflist_handle = zlistx_add_end (global_reflist, ref))) {
+        free (ref);
+        return NULL;
+    }
+    after->ref = ref;
     return ref;
 }
 
@@ -298,6 +329,8 @@ static int dependency_after_cb (flux_plugin_t *p,
     struct after_info *after;
     struct after_ref *ref;
     zlistx_t *l;
+    zlistx_t *refs;
+    void *handle;
 
     if (flux_plugin_arg_unpack (args,
                                 FLUX_PLUGIN_ARG_IN,
@@ -389,7 +422,7 @@ static int dependency_after_cb (flux_plugin_t *p,
     /*  Append this dependency to the deplist in the target jobid:
      */
     if (!(l = after_list_get (p, afterid))
-        || !zlistx_add_end (l, after)) {
+        || !(handle = zlistx_add_end (l, after))) {
         after_info_destroy (after);
         return flux_jobtap_reject_job (p,
                                        args,
@@ -398,12 +431,13 @@ static int dependency_after_cb (flux_plugin_t *p,
 
     /*  Create a reference in the current job to the depednency, so it can
      *   be removed if this job terminates before PRIORITY state.
+     *  N.B. deleting 'after' from the target list destroys it.
      */
-    if (!(ref = after_ref_create (afterid, l, after))
-        || !(l = after_refs_get (p, id))
-        || !zlistx_add_end (l, ref)) {
-        after_info_destroy (after);
+    if (!(ref = after_ref_create (afterid, l, after, handle))
+        || !(refs = after_refs_get (p, id))
+        || !zlistx_add_end (refs, ref)) {
         after_ref_destroy (ref);
+        zlistx_delete (l, handle);
         return flux_jobtap_reject_job (p, args, "failed to create ref");
     }
 
@@ -413,8 +447,7 @@ static int dependency_after_cb (flux_plugin_t *p,
      */
     if (type == AFTER_START
         && flux_jobtap_job_subscribe (p, afterid) < 0) {
-        after_info_destroy (after);
-        after_ref_destroy (ref);
+        zlistx_delete (l, handle); // ref is left with info=NULL
         return flux_jobtap_reject_job (p, args, "failed to subscribe to %s",
                                        idf58 (id));
     }
@@ -509,18 +542,16 @@ static void release_dependency_references (flux_plugin_t *p)
     if ((l = after_refs_check (p))) {
         struct after_ref *ref = zlistx_first (l);
         while (ref) {
-            /*  For each after_ref entry, check to ensure the job and its
-             *   after dependencies list still exists. If so, remove this
-             *   job's entry from the list.
+            /*  For each after_ref entry whose dependency has not yet been
+             *   released, remove this job's entry from the requisite job's
+             *   list.  If the requisite job or its list is gone, so is the
+             *   entry, and ref->info was cleared when it was destroyed.
              */
-            zlistx_t *after_list = after_list_check (p, ref->id);
-            if (after_list == ref->list) {
-                void *handle = zlistx_find (after_list, ref->info);
-                if (handle && zlistx_delete (ref->list, handle) < 0) {
-                    flux_log_error (h, "%s: %s: zlistx_delete",
-                                    "dependency-after",
-                                    "release_references");
-                }
+            if (ref->info
+                && zlistx_delete (ref->list, ref->info_handle) < 0) {
+                flux_log_error (h, "%s: %s: zlistx_delete",
+                                "dependency-after",
+                                "release_references");
             }
             ref = zlistx_next (l);
         }
@@ -639,6 +670,12 @@ static json_t *deps_to_json (flux_plugin_t *p)
             struct after_info *info = ref->info;
             json_t *entry = NULL;
 
+            /*  Skip dependencies that have already been released
+             */
+            if (!info) {
+                ref = zlistx_next (l);
+                continue;
+            }
             if (!(entry = json_pack ("{s:I s:I s:s s:s}",
                                      "id", ref->id,
                                      "depid", info->depid,
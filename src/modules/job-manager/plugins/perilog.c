@@ -32,6 +32,17 @@
  *     [job-manager.prolog]
  *     command = [ "command", "arg1", "arg2" ]
  *
+ *  - If per-rank = true is set in either table, the command is instead
+ *    run on every rank of the job's allocation with one bulk remote
+ *    exec request that is fanned out over the TBON.  Results are
+ *    aggregated by rank: the finish status is the first nonzero wait
+ *    status, ranks that fail are drained (unless the prolog was killed
+ *    due to a job exception), and a "perilog-timing" event
+ *    with the time to start and to complete on all ranks is posted to
+ *    the job eventlog.  Since each job's commands run only on its own
+ *    ranks, an epilog and the next job's prolog on disjoint nodes run
+ *    concurrently.
+ *
  *  - The queue should be idle before unloading/reloading this
  *     plugin. Otherwise jobs may become stuck because a prolog
  *     or epilog in progress will result in a missing -finish
@@ -51,12 +62,15 @@
 
 #include <jansson.h>
 #include <flux/core.h>
+#include <flux/idset.h>
 #include <flux/jobtap.h>
 
 #include "src/common/libjob/job_hash.h"
 #include "src/common/libjob/idf58.h"
 #include "src/common/libczmqcontainers/czmq_containers.h"
 #include "src/common/libutil/errprintf.h"
+#include "src/common/libsubprocess/bulk.h"
+#include "src/common/librlist/rlist.h"
 #include "ccan/str/str.h"
 #include "src/broker/state_machine.h" // for STATE_CLEANUP
 
@@ -68,6 +82,8 @@ static struct perilog_conf {
     double prolog_kill_timeout;/*  Time between SIGTERM/SIGKILL for prolog  */
     flux_cmd_t *prolog_cmd;    /*  Configured prolog command                */
     flux_cmd_t *epilog_cmd;    /*  Configured epilog command                */
+    int prolog_per_rank;       /*  Run prolog on all ranks of the job       */
+    int epilog_per_rank;       /*  Run epilog on all ranks of the job       */
     zhashx_t *processes;       /*  List of outstanding perilog_proc objects */
     zlistx_t *log_ignore;      /*  List of regex patterns to ignore in logs */
     flux_future_t *watch_f;    /*  Watch for broker entering CLEANUP state */
@@ -84,6 +100,15 @@ struct perilog_proc {
     flux_subprocess_t *sp;
     flux_future_t *kill_f;
     flux_watcher_t *kill_timer;
+
+    /*  per-rank mode only:
+     */
+    subprocess_bulk_t *bulk;
+    struct idset *ranks;       /*  Ranks of the job                         */
+    struct idset *failed;      /*  Ranks that failed or exited nonzero      */
+    int status;                /*  First nonzero wait status, or 0          */
+    double t_start;            /*  Time the bulk exec was sent              */
+    double t_started;          /*  Time the last rank started               */
 };
 
 static struct perilog_proc * perilog_proc_create (flux_plugin_t *p,
@@ -110,6 +135,9 @@ static void perilog_proc_destroy (struct perilog_proc *proc)
 {
     if (proc) {
         flux_subprocess_destroy (proc->sp);
+        subprocess_bulk_destroy (proc->bulk);
+        idset_destroy (proc->ranks);
+        idset_destroy (proc->failed);
         flux_future_destroy (proc->kill_f);
         flux_watcher_destroy (proc->kill_timer);
         free (proc);
@@ -145,10 +173,16 @@ static void perilog_proc_delete (struct perilog_proc *proc)
     }
 }
 
+/*  Post the finish event for 'proc'.  'status' is a wait status, and
+ *   'code' and 'sig' are the exit code and signal derived from it, or -1.
+ *   In per-rank mode, 'ranks' is the set of ranks that failed.
+ */
 static void emit_finish_event (struct perilog_proc *proc,
-                               flux_subprocess_t *sp)
+                               int status,
+                               int code,
+                               int sig,
+                               const char *ranks)
 {
-    int status = flux_subprocess_status (sp);
     if (proc->prolog) {
         /*
          *  If prolog failed, raise job exception before prolog-finish
@@ -156,24 +190,25 @@ static void emit_finish_event (struct perilog_proc *proc,
          *   the exception is raised:
          */
         if (status != 0) {
-            int code = flux_subprocess_exit_code (sp);
             int rc;
-            int sig;
             char *errmsg;
 
-            if ((sig = flux_subprocess_signaled (sp)) > 0
-                || (sig = (code - 128)) > 0) {
+            if (sig > 0 || (sig = (code - 128)) > 0) {
                 rc = asprintf (&errmsg,
-                               "prolog killed by signal %d%s",
+                               "prolog killed by signal %d%s%s%s",
                                sig,
                                sig == SIGTERM ?
                                " (timeout or job canceled)" :
-                               "");
+                               "",
+                               ranks ? " on rank " : "",
+                               ranks ? ranks : "");
             }
             else
                 rc = asprintf (&errmsg,
-                               "prolog exited with exit code=%d",
-                               flux_subprocess_exit_code (sp));
+                               "prolog exited with exit code=%d%s%s",
+                               code,
+                               ranks ? " on rank " : "",
+                               ranks ? ranks : "");
             if (rc < 0)
                 errmsg = NULL;
             if (flux_jobtap_raise_exception (proc->p,
@@ -216,15 +251,38 @@ static void emit_finish_event (struct perilog_proc *proc,
     }
 }
 
+static void emit_finish_event_sp (struct perilog_proc *proc,
+                                  flux_subprocess_t *sp)
+{
+    emit_finish_event (proc,
+                       flux_subprocess_status (sp),
+                       flux_subprocess_exit_code (sp),
+                       flux_subprocess_signaled (sp),
+                       NULL);
+}
+
 static void completion_cb (flux_subprocess_t *sp)
 {
     struct perilog_proc *proc = flux_subprocess_aux_get (sp, "perilog_proc");
     if (proc) {
-        emit_finish_event (proc, sp);
+        emit_finish_event_sp (proc, sp);
         perilog_proc_delete (proc);
     }
 }
 
+/*  Map the errno of a failure to start a command to a wait status
+ */
+static int errno_to_status (int errnum)
+{
+    if (errnum == EPERM || errnum == EACCES)
+        return EXIT_CODE(126);
+    else if (errnum == ENOENT)
+        return EXIT_CODE(127);
+    else if (errnum == EHOSTUNREACH)
+        return EXIT_CODE(68);
+    return EXIT_CODE(1);
+}
+
 static void state_cb (flux_subprocess_t *sp, flux_subprocess_state_t state)
 {
     struct perilog_proc *proc;
@@ -235,15 +293,7 @@ static void state_cb (flux_subprocess_t *sp, flux_subprocess_state_t state)
         /*  If subprocess failed or execution failed, then we still
          *   must be sure to emit a finish event.
          */
-        int errnum = flux_subprocess_fail_errno (sp);
-        int code = EXIT_CODE(1);
-
-        if (errnum == EPERM || errnum == EACCES)
-            code = EXIT_CODE(126);
-        else if (errnum == ENOENT)
-            code = EXIT_CODE(127);
-        else if (errnum == EHOSTUNREACH)
-            code = EXIT_CODE(68);
+        int code = errno_to_status (flux_subprocess_fail_errno (sp));
 
         flux_log (flux_jobtap_get_flux (proc->p),
                   LOG_ERR,
@@ -252,7 +302,7 @@ static void state_cb (flux_subprocess_t *sp, flux_subprocess_state_t state)
                   flux_subprocess_state_string (flux_subprocess_state (sp)),
                   code);
 
-        emit_finish_event (proc, sp);
+        emit_finish_event_sp (proc, sp);
         perilog_proc_delete (proc);
     }
 }
@@ -298,6 +348,244 @@ static void io_cb (flux_subprocess_t *sp, const char *stream)
     }
 }
 
+static const char *perilog_name (struct perilog_proc *proc)
+{
+    return proc->prolog ? "prolog" : "epilog";
+}
+
+static void bulk_start_cb (subprocess_bulk_t *b,
+                           const struct idset *ranks,
+                           void *arg)
+{
+    struct perilog_proc *proc = arg;
+    flux_t *h = flux_jobtap_get_flux (proc->p);
+
+    proc->t_started = flux_reactor_now (flux_get_reactor (h));
+}
+
+/*  Record that 'ranks' failed with wait status 'status'
+ */
+static void bulk_fail (struct perilog_proc *proc,
+                       const struct idset *ranks,
+                       int status)
+{
+    if (idset_add (proc->failed, ranks) < 0)
+        flux_log_error (flux_jobtap_get_flux (proc->p),
+                        "%s: %s: idset_add",
+                        idf58 (proc->id),
+                        perilog_name (proc));
+    if (proc->status == 0)
+        proc->status = status;
+}
+
+static void bulk_exit_cb (subprocess_bulk_t *b,
+                          const struct idset *ranks,
+                          int status,
+                          void *arg)
+{
+    struct perilog_proc *proc = arg;
+
+    if (status != 0)
+        bulk_fail (proc, ranks, status);
+}
+
+static void bulk_error_cb (subprocess_bulk_t *b,
+                           const struct idset *ranks,
+                           int errnum,
+                           const char *errmsg,
+                           void *arg)
+{
+    struct perilog_proc *proc = arg;
+    char *s = idset_encode (ranks, IDSET_FLAG_RANGE);
+
+    flux_log (flux_jobtap_get_flux (proc->p),
+              LOG_ERR,
+              "%s: %s: rank %s: %s",
+              idf58 (proc->id),
+              perilog_name (proc),
+              s ? s : "?",
+              errmsg ? errmsg : strerror (errnum));
+    free (s);
+    bulk_fail (proc, ranks, errno_to_status (errnum));
+}
+
+static void bulk_output_cb (subprocess_bulk_t *b,
+                            const struct idset *ranks,
+                            const char *stream,
+                            const char *data,
+                            int len,
+                            void *arg)
+{
+    struct perilog_proc *proc = arg;
+    char *line;
+    char *s;
+
+    if (len > 0 && data[len - 1] == '\n')
+        len--;
+    if (!(line = strndup (data, len)))
+        return;
+    if (!perilog_log_ignore (&perilog_config, line)
+        && (s = idset_encode (ranks, IDSET_FLAG_RANGE))) {
+        flux_log (flux_jobtap_get_flux (proc->p),
+                  streq (stream, "stderr") ? LOG_ERR : LOG_INFO,
+                  "%s: %s: rank %s: %s: %s",
+                  idf58 (proc->id),
+                  perilog_name (proc),
+                  s,
+                  stream,
+                  line);
+        free (s);
+    }
+    free (line);
+}
+
+/*  Drain ranks on which the prolog or epilog failed, as flux-perilog-run
+ *   does with --exec-per-rank.
+ */
+static void bulk_drain (struct perilog_proc *proc, const char *ranks)
+{
+    flux_t *h = flux_jobtap_get_flux (proc->p);
+    char reason[128];
+    flux_future_t *f;
+
+    (void)snprintf (reason,
+                    sizeof (reason),
+                    "%s failed for jobid %s",
+                    perilog_name (proc),
+                    idf58 (proc->id));
+    if (!(f = flux_rpc_pack (h,
+                             "resource.drain",
+                             0,
+                             FLUX_RPC_NORESPONSE,
+                             "{s:s s:s s:s}",
+                             "targets", ranks,
+                             "reason", reason,
+                             "mode", "update")))
+        flux_log_error (h, "%s: failed to drain %s", idf58 (proc->id), ranks);
+    flux_future_destroy (f);
+}
+
+static void bulk_complete_cb (subprocess_bulk_t *b, void *arg)
+{
+    struct perilog_proc *proc = arg;
+    flux_t *h = flux_jobtap_get_flux (proc->p);
+    double now = flux_reactor_now (flux_get_reactor (h));
+    char *ranks = NULL;
+    char *failed = NULL;
+    int status = proc->status;
+
+    if (!(ranks = idset_encode (proc->ranks, IDSET_FLAG_RANGE))
+        || (idset_count (proc->failed) > 0
+            && !(failed = idset_encode (proc->failed, IDSET_FLAG_RANGE))))
+        flux_log_error (h, "%s: idset_encode", idf58 (proc->id));
+
+    if (flux_jobtap_event_post_pack (proc->p,
+                                     proc->id,
+                                     "perilog-timing",
+                                     "{s:s s:s s:f s:f s:s}",
+                                     "name", perilog_name (proc),
+                                     "ranks", ranks ? ranks : "",
+                                     "start",
+                                     proc->t_started > 0. ?
+                                     proc->t_started - proc->t_start : 0.,
+                                     "total", now - proc->t_start,
+                                     "failed", failed ? failed : "") < 0)
+        flux_log_error (h,
+                        "%s: %s: failed to post perilog-timing event",
+                        idf58 (proc->id),
+                        perilog_name (proc));
+    /*  Ranks are not drained if the prolog was killed due to an
+     *   exception, e.g. the job was canceled.
+     */
+    if (failed && !proc->kill_f) {
+        flux_log (h,
+                  LOG_ERR,
+                  "%s: rank %s failed %s, draining",
+                  idf58 (proc->id),
+                  failed,
+                  perilog_name (proc));
+        bulk_drain (proc, failed);
+    }
+    emit_finish_event (proc,
+                       status,
+                       WIFEXITED (status) ? WEXITSTATUS (status) : -1,
+                       WIFSIGNALED (status) ? WTERMSIG (status) : -1,
+                       failed);
+    free (ranks);
+    free (failed);
+    perilog_proc_delete (proc);
+}
+
+static struct idset *ranks_from_R (json_t *R)
+{
+    struct rlist *rl;
+    struct idset *ranks;
+
+    if (!R || !(rl = rlist_from_json (R, NULL))) {
+        errno = EINVAL;
+        return NULL;
+    }
+    ranks = rlist_ranks (rl);
+    rlist_destroy (rl);
+    return ranks;
+}
+
+static int run_command_per_rank (flux_plugin_t *p,
+                                 flux_jobid_t id,
+                                 int prolog,
+                                 flux_cmd_t *cmd,
+                                 json_t *R)
+{
+    flux_t *h = flux_jobtap_get_flux (p);
+    struct perilog_proc *proc;
+    subprocess_bulk_ops_t ops = {
+        .on_start = bulk_start_cb,
+        .on_exit = bulk_exit_cb,
+        .on_error = bulk_error_cb,
+        .on_output = bulk_output_cb,
+        .on_complete = bulk_complete_cb,
+    };
+
+    if (!(proc = perilog_proc_create (p, id, prolog, NULL))) {
+        flux_log_error (h, "%s: proc_create", prolog ? "prolog" : "epilog");
+        return -1;
+    }
+    if (!(proc->ranks = ranks_from_R (R))
+        || !(proc->failed = idset_create (0, IDSET_FLAG_AUTOGROW))) {
+        flux_log_error (h, "%s: failed to get job ranks",
+                        prolog ? "prolog" : "epilog");
+        goto error;
+    }
+    proc->t_start = flux_reactor_now (flux_get_reactor (h));
+    if (!(proc->bulk = subprocess_bulk_exec (h,
+                                             "rexec",
+                                             0,
+                                             proc->ranks,
+                                             cmd,
+                                             &ops,
+                                             proc))) {
+        flux_log_error (h, "%s: subprocess_bulk_exec",
+                        prolog ? "prolog" : "epilog");
+        goto error;
+    }
+    if (subprocess_bulk_close (proc->bulk, "stdin") < 0)
+        flux_log_error (h, "%s: failed to close stdin",
+                        prolog ? "prolog" : "epilog");
+    if (flux_jobtap_job_aux_set (p,
+                                 FLUX_JOBTAP_CURRENT_JOB,
+                                 "perilog_proc",
+                                 proc,
+                                 NULL) < 0) {
+        flux_log_error (h, "%s: flux_jobtap_job_aux_set",
+                        prolog ? "prolog" : "epilog");
+        goto error;
+    }
+    return 0;
+error:
+    perilog_proc_delete (proc);
+    return -1;
+}
+
 static int run_command (flux_plugin_t *p,
                         flux_plugin_arg_t *args,
                         int prolog,
@@ -307,6 +595,7 @@ static int run_command (flux_plugin_t *p,
     struct perilog_proc *proc;
     flux_jobid_t id;
     uint32_t userid;
+    json_t *R = NULL;
     flux_subprocess_t *sp = NULL;
     flux_subprocess_ops_t ops = {
         .on_completion = completion_cb,
@@ -317,9 +606,10 @@ static int run_command (flux_plugin_t *p,
 
     if (flux_plugin_arg_unpack (args,
                                 FLUX_PLUGIN_ARG_IN,
-                                "{s:I s:i}",
+                                "{s:I s:i s?o}",
                                 "id", &id,
-                                "userid", &userid) < 0) {
+                                "userid", &userid,
+                                "R", &R) < 0) {
         flux_log_error (h, "flux_plugin_arg_unpack");
         return -1;
     }
@@ -330,6 +620,10 @@ static int run_command (flux_plugin_t *p,
         return -1;
     }
 
+    if (prolog ? perilog_config.prolog_per_rank
+               : perilog_config.epilog_per_rank)
+        return run_command_per_rank (p, id, prolog, cmd, R);
+
     if (!(sp = flux_rexec_ex (h, "rexec", 0, 0, cmd, &ops, flux_llog, h))) {
         flux_log_error (h, "%s: flux_rexec", prolog ? "prolog" : "epilog");
         return -1;
@@ -446,7 +740,11 @@ static int prolog_kill (struct perilog_proc *proc)
     if (proc->kill_timer)
         return 0;
 
-    if (!(proc->kill_f = flux_subprocess_kill (proc->sp, SIGTERM)))
+    if (proc->bulk)
+        proc->kill_f = subprocess_bulk_kill (proc->bulk, SIGTERM);
+    else
+        proc->kill_f = flux_subprocess_kill (proc->sp, SIGTERM);
+    if (!proc->kill_f)
         return -1;
 
     if (flux_future_then (proc->kill_f, -1., prolog_kill_cb, proc) < 0) {
@@ -471,7 +769,11 @@ static void prolog_kill_timer_cb (flux_reactor_t *r,
     if (!proc || !(h = flux_jobtap_get_flux (proc->p)))
         return;
 
-    if (!(f = flux_subprocess_kill (proc->sp, SIGKILL))) {
+    if (proc->bulk)
+        f = subprocess_bulk_kill (proc->bulk, SIGKILL);
+    else
+        f = flux_subprocess_kill (proc->sp, SIGKILL);
+    if (!f) {
         flux_log_error (h,
                         "%s: failed to send SIGKILL to prolog",
                         idf58 (proc->id));
@@ -525,7 +827,9 @@ static int exception_cb (flux_plugin_t *p,
                                            FLUX_JOBTAP_CURRENT_JOB,
                                            "perilog_proc"))
         && proc->prolog
-        && flux_subprocess_state (proc->sp) == FLUX_SUBPROCESS_RUNNING) {
+        && (proc->bulk ?
+            idset_count (subprocess_bulk_pending (proc->bulk)) > 0 :
+            flux_subprocess_state (proc->sp) == FLUX_SUBPROCESS_RUNNING)) {
 
        if (prolog_kill (proc) < 0
             || prolog_kill_timer_start (proc,
@@ -692,13 +996,15 @@ static int conf_init (flux_plugin_t *p, struct perilog_conf *conf)
     }
     if (flux_conf_unpack (flux_get_conf (h),
                           &error,
-                          "{s?{s?{s?o s?F !} s?{s?o !} s?{s?o}}}",
+                          "{s?{s?{s?o s?F s?b !} s?{s?o s?b !} s?{s?o}}}",
                           "job-manager",
                             "prolog",
                               "command", &prolog,
                               "kill-timeout", &conf->prolog_kill_timeout,
+                              "per-rank", &conf->prolog_per_rank,
                             "epilog",
                               "command", &epilog,
+                              "per-rank", &conf->epilog_per_rank,
                             "perilog",
                               "log-ignore", &log_ignore) < 0) {
         flux_log (h, LOG_ERR,
@@ -160,7 +160,7 @@ int reprioritize_id (struct job_manager *ctx,
                      flux_jobid_t id,
                      int64_t priority)
 {
-    struct job *job = zhashx_lookup (ctx->active_jobs, &id);
+    struct job *job = jobmap_lookup (ctx->active_jobs, id);
     if (!job) {
         errno = ENOENT;
         return -1;
@@ -168,20 +168,148 @@ int reprioritize_id (struct job_manager *ctx,
     return reprioritize_job (ctx, job, priority);
 }
 
+/*  Apply 'priority' to one job of a batch.  Only this job's entry in the
+ *   alloc queue or pending list is reordered.  If the job has an outstanding
+ *   alloc request, its new priority is appended to 'priorities' so the
+ *   scheduler can be updated with a single sched.prioritize RPC.
+ */
+static int reprioritize_batch_one (struct job_manager *ctx,
+                                   struct job *job,
+                                   int64_t priority,
+                                   json_t *priorities)
+{
+    int64_t orig_priority = job->priority;
+
+    if (job->state != FLUX_JOB_STATE_PRIORITY
+        && job->state != FLUX_JOB_STATE_SCHED)
+        return 0;
+    if (reprioritize_one (ctx, job, priority, false) < 0)
+        return -1;
+    if (job->priority == orig_priority || !ctx->alloc)
+        return 0;
+    if (job->alloc_queued)
+        alloc_queue_reorder (ctx->alloc, job);
+    else if (job->alloc_pending && job->priority > FLUX_JOB_PRIORITY_MIN) {
+        json_t *entry = json_pack ("[II]", job->id, job->priority);
+        if (!entry || json_array_append_new (priorities, entry) < 0) {
+            json_decref (entry);
+            errno = ENOMEM;
+            return -1;
+        }
+        alloc_pending_reorder (ctx->alloc, job);
+    }
+    return 0;
+}
+
+/*  Finish a batch: cancel pending alloc requests that may have been
+ *   overtaken by queued jobs, then update the scheduler with all changed
+ *   priorities at once.  Steals the reference on 'priorities'.
+ */
+static int reprioritize_batch_finish (struct job_manager *ctx,
+                                      json_t *priorities)
+{
+    size_t count = json_array_size (priorities);
+
+    if (ctx->alloc && alloc_queue_recalc_pending (ctx->alloc) < 0)
+        goto error;
+    if (sched_prioritize (ctx->h, priorities) < 0) {
+        flux_log_error (ctx->h,
+                        "reprioritize: sched.priority: failed for %zu jobs",
+                        count);
+        goto error;
+    }
+    return 0;
+error:
+    json_decref (priorities);
+    return -1;
+}
+
+int reprioritize_jobs (struct job_manager *ctx,
+                       const flux_jobid_t *ids,
+                       const int64_t *priority,
+                       int count)
+{
+    json_t *priorities;
+
+    if (count < 0 || (count > 0 && (!ids || !priority))) {
+        errno = EINVAL;
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        if (priority[i] < FLUX_JOB_PRIORITY_MIN
+            || priority[i] > FLUX_JOB_PRIORITY_MAX) {
+            errno = EINVAL;
+            return -1;
+        }
+    }
+    if (!(priorities = json_array ())) {
+        errno = ENOMEM;
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        struct job *job;
+
+        /*  Jobs that are no longer active are silently skipped, since
+         *   the caller may be working from a stale list.
+         */
+        if (!(job = jobmap_lookup (ctx->active_jobs, ids[i])))
+            continue;
+        if (reprioritize_batch_one (ctx, job, priority[i], priorities) < 0) {
+            flux_log_error (ctx->h, "reprioritize: %s", idf58 (job->id));
+            json_decref (priorities);
+            return -1;
+        }
+    }
+    return reprioritize_batch_finish (ctx, priorities);
+}
+
+int reprioritize_user (struct job_manager *ctx, uint32_t userid)
+{
+    struct job *job;
+    json_t *priorities;
+
+    if (!(priorities = json_array ())) {
+        errno = ENOMEM;
+        return -1;
+    }
+    for (job = jobmap_first (ctx->active_jobs); job;
+         job = jobmap_next (ctx->active_jobs)) {
+        int64_t priority;
+
+        if (job->userid != userid
+            || (job->state != FLUX_JOB_STATE_PRIORITY
+                && job->state != FLUX_JOB_STATE_SCHED))
+            continue;
+        if (jobtap_get_priority (ctx->jobtap, job, &priority) < 0) {
+            flux_log_error (ctx->h, "jobtap_get_priority: %s",
+                            idf58 (job->id));
+            continue;
+        }
+        if (priority < 0 || priority == job->priority)
+            continue;
+        if (reprioritize_batch_one (ctx, job, priority, priorities) < 0) {
+            flux_log_error (ctx->h, "reprioritize: %s", idf58 (job->id));
+            json_decref (priorities);
+            return -1;
+        }
+    }
+    return reprioritize_batch_finish (ctx, priorities);
+}
+
 /*  Request reprioritization of all jobs
  */
 int reprioritize_all (struct job_manager *ctx)
 {
     int64_t priority;
     flux_t *h = ctx->h;
-    struct job *job = zhashx_first (ctx->active_jobs);
+    struct job *job = jobmap_first (ctx->active_jobs);
     json_t *priorities = json_array ();
 
     if (!priorities)
         return -1;
 
-    for (job = zhashx_first (ctx->active_jobs); job;
-         job = zhashx_next (ctx->active_jobs)) {
+    for (job = jobmap_first (ctx->active_jobs); job;
+         job = jobmap_next (ctx->active_jobs)) {
         /*
          *  Only process jobs between PRIORITY and SCHED states:
          */
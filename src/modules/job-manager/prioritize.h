@@ -31,6 +31,23 @@ int reprioritize_id (struct job_manager *ctx,
                      flux_jobid_t id,
                      int64_t priority);
 
+/*  Set the priority of a batch of jobs.  Unlike reprioritize_all(), only
+ *   the queue entries of the affected jobs are reordered, and changed
+ *   priorities of jobs with outstanding alloc requests are sent to the
+ *   scheduler in one sched.prioritize RPC.  Jobs that are not active are
+ *   skipped.
+ */
+int reprioritize_jobs (struct job_manager *ctx,
+                       const flux_jobid_t *ids,
+                       const int64_t *priority,
+                       int count);
+
+/*  Like reprioritize_all(), but only call the job.priority.get plugin
+ *   callback for jobs owned by 'userid', and update them as a batch as in
+ *   reprioritize_jobs().
+ */
+int reprioritize_user (struct job_manager *ctx, uint32_t userid);
+
 #endif /* ! _FLUX_JOB_MANAGER_PRIORITIZE_H */
 
 /*
@@ -9,6 +9,13 @@
 \************************************************************/
 
 /* purge.c - remove old inactive jobs
+ *
+ * Jobs that exceed the configured limits are purged in the background,
+ * one KVS commit at a time, with at most 'batch' jobs per commit.  Each
+ * heartbeat notes whether jobs may be eligible.  The next commit is then
+ * started from a check watcher, with an idle watcher keeping the reactor
+ * from blocking in between.  If 'rate' is set, commits are spaced so that
+ * no more than 'rate' jobs per second are purged on average.
  */
 
 #if HAVE_CONFIG_H
@@ -28,6 +35,8 @@
 #include "conf.h"
 #include "jobtap-internal.h"
 #include "restart.h"
+#include "snapshot.h"
+#include "journal.h"
 
 #define INACTIVE_NUM_UNLIMITED  (-1)
 #define INACTIVE_AGE_UNLIMITED  (-1.)
@@ -36,15 +45,29 @@ struct purge {
     struct job_manager *ctx;
     double age_limit;
     int num_limit;
+    double rate;            // max jobs purged per second, or 0 for no limit
+    int batch;              // max jobs per background purge commit
     zlistx_t *queue;
     flux_future_t *f_sync;
     flux_future_t *f_purge;
 
+    flux_watcher_t *prep;
+    flux_watcher_t *check;
+    flux_watcher_t *idle;
+    flux_watcher_t *timer;
+    bool timer_armed;
+    bool backlog;           // there may be eligible jobs
+    double tokens;          // jobs that may be purged now under 'rate'
+    double t_refill;
+    int purged;             // jobs purged in the background
+    int commits;
+
     flux_msg_handler_t **handlers;
     struct flux_msglist *requests;
 };
 
-static const int purge_batch_max = 100; // max KVS ops per txn
+static const int purge_batch_max = 100; // max KVS ops per txn (RPC)
+static const int purge_batch_default = 100; // background purge batch
 
 /* Add an inactive job to the "purge queue".
  * The queue is ordered by the time the job became inactive, so
@@ -115,7 +138,7 @@ static int purge_eligible_count (struct purge *purge,
  * - check if max_jobid needs to be updated
  * - add job id to jobs array for later publishing
  * - jobtap call "job.inactive-remove"
- * - delete job from purge->queue and purge->ctx->inactive_jobs
+ * - delete job from purge->queue, the snapshot, and purge->ctx->inactive_jobs
  */
 static int process_job_purge (struct purge *purge,
                               struct job *job,
@@ -149,9 +172,12 @@ static int process_job_purge (struct purge *purge,
                        "job.inactive-remove",
                        NULL);
 
+    (void)journal_process_purge (purge->ctx->journal, job);
+
     (void)zlistx_delete (purge->queue, job->handle);
     job->handle = NULL;
-    zhashx_delete (purge->ctx->inactive_jobs, &job->id);
+    snapshot_job_purged (purge->ctx->snapshot, job);
+    jobmap_delete (purge->ctx->inactive_jobs, job->id);
     return 0;
 }
 
@@ -166,7 +192,7 @@ static struct job *find_purge_candidate (struct purge *purge,
         job = zlistx_next (purge->queue);
     }
     if (!job) {
-        if (!(job = zhashx_lookup (purge->ctx->active_jobs, &id))) {
+        if (!(job = jobmap_lookup (purge->ctx->active_jobs, id))) {
             (*errmsg) = "id not found";
             errno = ENOENT;
         }
@@ -262,7 +288,8 @@ static flux_future_t *purge_inactive_jobs (struct purge *purge,
             goto error;
         count = 1;
     }
-    if (!(f = flux_kvs_commit (purge->ctx->h, NULL, 0, txn))
+    if (snapshot_log_to_txn (purge->ctx->snapshot, txn, jobs) < 0
+        || !(f = flux_kvs_commit (purge->ctx->h, NULL, 0, txn))
         || flux_future_aux_set (f, "count", int2ptr (count), NULL) < 0
         || purge_publish (purge, jobs) < 0)
         goto error;
@@ -281,6 +308,21 @@ error:
     return NULL;
 }
 
+/* Return true if the oldest inactive job is eligible for purging.
+ */
+static bool purge_backlog (struct purge *purge)
+{
+    double now = flux_reactor_now (flux_get_reactor (purge->ctx->h));
+    struct job *job;
+
+    if (!(job = zlistx_first (purge->queue)))
+        return false;
+    return purge_eligible (now - job->t_clean,
+                           purge->age_limit,
+                           zlistx_size (purge->queue),
+                           purge->num_limit);
+}
+
 /* Complete periodic purge.
  */
 static void purge_continuation (flux_future_t *f, void *arg)
@@ -296,11 +338,104 @@ static void purge_continuation (flux_future_t *f, void *arg)
                   future_strerror (f, errno));
         goto done;
     }
+    purge->purged += count;
     flux_log (h, LOG_DEBUG, "purged %d inactive jobs", count);
 done:
     if (purge->f_purge == f)
         purge->f_purge = NULL;
     flux_future_destroy (f);
+    purge->backlog = purge_backlog (purge);
+}
+
+/* Return true if a background purge commit may be started now.
+ * If only the rate limit prevents it, arm a timer to wake the reactor
+ * when it will be allowed.
+ */
+static bool purge_ready (struct purge *purge)
+{
+    if (!purge->backlog || purge->f_purge)
+        return false;
+    if (purge->rate > 0) {
+        double now = flux_reactor_now (flux_get_reactor (purge->ctx->h));
+        double need = purge->rate < purge->batch ? purge->rate : purge->batch;
+
+        if (need < 1)
+            need = 1;
+        purge->tokens += (now - purge->t_refill) * purge->rate;
+        if (purge->tokens > purge->batch)
+            purge->tokens = purge->batch;
+        purge->t_refill = now;
+        if (purge->tokens < need) {
+            if (!purge->timer_armed) {
+                double timeout = (need - purge->tokens) / purge->rate;
+                flux_timer_watcher_reset (purge->timer, timeout, 0.);
+                flux_watcher_start (purge->timer);
+                purge->timer_armed = true;
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+static void purge_next (struct purge *purge)
+{
+    flux_t *h = purge->ctx->h;
+    int max = purge->batch;
+    flux_future_t *f;
+
+    if (purge->rate > 0 && max > purge->tokens)
+        max = purge->tokens;
+    if (!(f = purge_inactive_jobs (purge,
+                                   purge->age_limit,
+                                   purge->num_limit,
+                                   max,
+                                   0,
+                                   NULL)) /* 0 == do not purge single job id */
+        || flux_future_then (f, -1, purge_continuation, purge) < 0) {
+        flux_future_destroy (f);
+        if (errno != ENODATA)
+            flux_log_error (h, "error creating purge KVS transaction");
+        purge->backlog = false;
+        return;
+    }
+    purge->tokens -= ptr2int (flux_future_aux_get (f, "count"));
+    purge->commits++;
+    purge->f_purge = f;
+}
+
+static void prep_cb (flux_reactor_t *r,
+                     flux_watcher_t *w,
+                     int revents,
+                     void *arg)
+{
+    struct purge *purge = arg;
+
+    if (purge_ready (purge))
+        flux_watcher_start (purge->idle);
+}
+
+static void check_cb (flux_reactor_t *r,
+                      flux_watcher_t *w,
+                      int revents,
+                      void *arg)
+{
+    struct purge *purge = arg;
+
+    flux_watcher_stop (purge->idle);
+    if (purge_ready (purge))
+        purge_next (purge);
+}
+
+static void timer_cb (flux_reactor_t *r,
+                      flux_watcher_t *w,
+                      int revents,
+                      void *arg)
+{
+    struct purge *purge = arg;
+
+    // wakes the reactor so check_cb can start the next commit
+    purge->timer_armed = false;
 }
 
 /* Periodically check for inactive jobs that meet purge criteria, if
@@ -317,23 +452,7 @@ static void sync_cb (flux_future_t *f_sync, void *arg)
                   "purge synchronization error: %s",
                   future_strerror (f_sync, errno));
     }
-    if (!(purge->f_purge)) {
-        flux_future_t *f;
-        if (!(f = purge_inactive_jobs (purge,
-                                       purge->age_limit,
-                                       purge->num_limit,
-                                       purge_batch_max,
-                                       0,
-                                       NULL)) /* 0 == do not purge single job id */
-            || flux_future_then (f, -1, purge_continuation, purge) < 0) {
-            flux_future_destroy (f);
-            if (errno != ENODATA)
-                flux_log_error (h, "error creating purge KVS transaction");
-            goto done;
-        }
-        purge->f_purge = f;
-    }
-done:
+    purge->backlog = purge_backlog (purge);
     flux_future_reset (f_sync);
 }
 
@@ -357,10 +476,30 @@ int purge_sync_update (struct purge *purge)
             flux_future_destroy (purge->f_sync);
             purge->f_sync = NULL;
         }
+        purge->backlog = false;
     }
     return 0;
 }
 
+json_t *purge_stats (struct purge *purge)
+{
+    json_t *o;
+
+    if (!(o = json_pack ("{s:f s:i s:b s:i s:i s:i}",
+                         "rate", purge->rate,
+                         "batch", purge->batch,
+                         "backlog", purge->backlog,
+                         "eligible", purge_eligible_count (purge,
+                                                           purge->age_limit,
+                                                           purge->num_limit),
+                         "purged", purge->purged,
+                         "commits", purge->commits))) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    return o;
+}
+
 /* Locate the message containing 'f'.
  * Side effect: cursor is parked on this message, so flux_msglist_delete()
  * can be used to delete it later.
@@ -540,13 +679,17 @@ static int purge_parse_config (const flux_conf_t *conf,
     const char *fsd = NULL;
     double age_limit = INACTIVE_AGE_UNLIMITED;
     int num_limit = INACTIVE_NUM_UNLIMITED;
+    double rate = 0.;
+    int batch = purge_batch_default;
 
     if (flux_conf_unpack (conf,
                           &e,
-                          "{s?{s?s s?i}}",
+                          "{s?{s?s s?i s?F s?i}}",
                           "job-manager",
                             "inactive-age-limit", &fsd,
-                            "inactive-num-limit", &num_limit) < 0)
+                            "inactive-num-limit", &num_limit,
+                            "inactive-purge-rate", &rate,
+                            "inactive-purge-batch", &batch) < 0)
         return errprintf (error, "job-manager.max-inactive-*: %s", e.text);
     if (fsd) {
         double t;
@@ -560,8 +703,16 @@ static int purge_parse_config (const flux_conf_t *conf,
             return errprintf (error,
                               "job-manager.inactive-num-limit: must be >= 0");
     }
+    if (rate < 0)
+        return errprintf (error,
+                          "job-manager.inactive-purge-rate: must be >= 0");
+    if (batch < 1)
+        return errprintf (error,
+                          "job-manager.inactive-purge-batch: must be >= 1");
     purge->age_limit = age_limit;
     purge->num_limit = num_limit;
+    purge->rate = rate;
+    purge->batch = batch;
 
     if (purge_sync_update (purge) < 0)
         flux_log_error (purge->ctx->h, "could not start purge sync callbacks");
@@ -584,6 +735,10 @@ void purge_destroy (struct purge *purge)
         conf_unregister_callback (purge->ctx->conf, purge_parse_config);
         flux_future_destroy (purge->f_sync);
         flux_future_destroy (purge->f_purge);
+        flux_watcher_destroy (purge->prep);
+        flux_watcher_destroy (purge->check);
+        flux_watcher_destroy (purge->idle);
+        flux_watcher_destroy (purge->timer);
         free (purge);
         errno = saved_errno;
     }
@@ -591,6 +746,7 @@ void purge_destroy (struct purge *purge)
 
 struct purge *purge_create (struct job_manager *ctx)
 {
+    flux_reactor_t *r = flux_get_reactor (ctx->h);
     struct purge *purge;
     flux_error_t error;
 
@@ -599,6 +755,8 @@ struct purge *purge_create (struct job_manager *ctx)
     purge->ctx = ctx;
     purge->age_limit = INACTIVE_AGE_UNLIMITED;
     purge->num_limit = INACTIVE_NUM_UNLIMITED;
+    purge->batch = purge_batch_default;
+    purge->t_refill = flux_reactor_now (r);
 
     if (!(purge->queue = zlistx_new()))
         goto error;
@@ -620,6 +778,17 @@ struct purge *purge_create (struct job_manager *ctx)
         goto error;
     if (!(purge->requests = flux_msglist_create ()))
         goto error;
+    if (!(purge->prep = flux_prepare_watcher_create (r, prep_cb, purge))
+        || !(purge->check = flux_check_watcher_create (r, check_cb, purge))
+        || !(purge->idle = flux_idle_watcher_create (r, NULL, NULL))
+        || !(purge->timer = flux_timer_watcher_create (r,
+                                                       0.,
+                                                       0.,
+                                                       timer_cb,
+                                                       purge)))
+        goto error;
+    flux_watcher_start (purge->prep);
+    flux_watcher_start (purge->check);
     return purge;
 error:
     purge_destroy (purge);
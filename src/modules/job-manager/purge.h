@@ -12,6 +12,7 @@
 #define _FLUX_JOB_MANAGER_PURGE_H
 
 #include <stdbool.h>
+#include <jansson.h>
 #include <flux/core.h>
 
 #include "job-manager.h"
@@ -21,6 +22,10 @@ void purge_destroy (struct purge *purge);
 
 int purge_enqueue_job (struct purge *purge, struct job *job);
 
+/* Return an object with background purge settings and progress.
+ */
+json_t *purge_stats (struct purge *purge);
+
 #endif /* ! _FLUX_JOB_MANAGER_PURGE_H */
 
 // vi:ts=4 sw=4 expandtab
@@ -638,7 +638,7 @@ error:
 
 static int queue_start (struct queue *queue, const char *name)
 {
-    struct job *job = zhashx_first (queue->ctx->active_jobs);
+    struct job *job = jobmap_first (queue->ctx->active_jobs);
     while (job) {
         if (!name || (job->queue && streq (job->queue, name))) {
             if (!job->alloc_queued
@@ -650,7 +650,7 @@ static int queue_start (struct queue *queue, const char *name)
                     return -1;
             }
         }
-        job = zhashx_next (queue->ctx->active_jobs);
+        job = jobmap_next (queue->ctx->active_jobs);
     }
     return 0;
 }
@@ -659,7 +659,7 @@ static void queue_stop (struct queue *queue, const char *name)
 {
     if (alloc_queue_count (queue->ctx->alloc) > 0
         || alloc_pending_count (queue->ctx->alloc) > 0) {
-        struct job *job = zhashx_first (queue->ctx->active_jobs);
+        struct job *job = jobmap_first (queue->ctx->active_jobs);
         while (job) {
             if (!name || (job->queue && streq (job->queue, name))) {
                 if (job->alloc_queued)
@@ -667,7 +667,7 @@ static void queue_stop (struct queue *queue, const char *name)
                 else if (job->alloc_pending)
                     alloc_cancel_alloc_request (queue->ctx->alloc, job, false);
             }
-            job = zhashx_next (queue->ctx->active_jobs);
+            job = jobmap_next (queue->ctx->active_jobs);
         }
     }
 }
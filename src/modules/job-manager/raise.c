@@ -149,8 +149,8 @@ void raise_handle_request (flux_t *h,
         errno = EPROTO;
         goto error;
     }
-    if (!(job = zhashx_lookup (ctx->active_jobs, &id))) {
-        if (!(job = zhashx_lookup (ctx->inactive_jobs, &id)))
+    if (!(job = jobmap_lookup (ctx->active_jobs, id))) {
+        if (!(job = jobmap_lookup (ctx->inactive_jobs, id)))
             errstr = "unknown job id";
         else
             errstr = "job is inactive";
@@ -191,7 +191,7 @@ int find_jobs (struct job_manager *ctx,
     zlistx_set_destructor (l, job_destructor);
     zlistx_set_duplicator (l, job_duplicator);
 
-    job = zhashx_first (ctx->active_jobs);
+    job = jobmap_first (ctx->active_jobs);
     while (job) {
         if (!(job->state & state_mask))
             goto next;
@@ -200,7 +200,7 @@ int find_jobs (struct job_manager *ctx,
         if (!zlistx_add_end (l, job))
             goto nomem;
 next:
-        job = zhashx_next (ctx->active_jobs);
+        job = jobmap_next (ctx->active_jobs);
     }
     *lp = l;
     return 0;
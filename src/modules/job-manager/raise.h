@@ -13,11 +13,21 @@
 
 #include <stdint.h>
 
+#include "src/common/libczmqcontainers/czmq_containers.h"
+
 #include "job-manager.h"
 
 struct raise *raise_ctx_create (struct job_manager *ctx);
 void raise_ctx_destroy (struct raise *raise);
 
+/* Create a list of active jobs matching userid, state_mask criteria.
+ * FLUX_USERID_UNKNOWN is a wildcard that matches any user.
+ */
+int find_jobs (struct job_manager *ctx,
+               uint32_t userid,
+               int state_mask,
+               zlistx_t **lp);
+
 /* exposed for unit testing only */
 int raise_check_type (const char *type);
 int raise_check_severity (int severity);
@@ -8,7 +8,13 @@
  * SPDX-License-Identifier: LGPL-3.0
 \************************************************************/
 
-/* restart - reload active jobs from the KVS */
+/* restart - reload active jobs from the KVS
+ *
+ * If a snapshot is available, inactive jobs are restored from it, and
+ * only jobs that were active or modified since it was written are
+ * replayed from their eventlogs (see snapshot.c).  Otherwise, the job
+ * directory is walked and every job is replayed.
+ */
 
 #if HAVE_CONFIG_H
 #include "config.h"
@@ -23,6 +29,7 @@
 
 #include "job.h"
 #include "restart.h"
+#include "snapshot.h"
 #include "event.h"
 #include "wait.h"
 #include "queue.h"
@@ -132,35 +139,28 @@ done:
 /* Create a 'struct job' from the KVS, using synchronous KVS RPCs.
  * Return 1 on success, 0 on non-fatal error, or -1 on a fatal error,
  * where a fatal error will prevent flux from starting.
+ * If 'purged_ok' is true, a job without an eventlog is silently skipped,
+ * since it was purged after the snapshot that refers to it.
  */
-static int depthfirst_map_one (flux_t *h,
-                               const char *key,
-                               int dirskip,
-                               restart_map_f cb,
-                               void *arg,
-                               flux_error_t *error)
+static int replay_job (flux_t *h,
+                       flux_jobid_t id,
+                       bool purged_ok,
+                       restart_map_f cb,
+                       void *arg,
+                       flux_error_t *error)
 {
-    flux_jobid_t id;
     struct job *job = NULL;
-    int rc = -1;
-
-    if (strlen (key) <= dirskip) {
-        errprintf (error, "internal error key=%s dirskip=%d", key, dirskip);
-        errno = EINVAL;
-        return -1;
-    }
-    if (fluid_decode (key + dirskip + 1, &id, FLUID_STRING_DOTHEX) < 0) {
-        errprintf (error, "could not decode %s to job ID", key + dirskip + 1);
-        return -1;
-    }
-
     flux_error_t lookup_error;
     bool fatal = false;
+    int rc = -1;
+
     if (!(job = lookup_job (h, id, &lookup_error, &fatal))) {
         if (fatal) {
             errprintf (error, "%s", lookup_error.text);
             return -1;
         }
+        if (purged_ok && errno == ENOENT)
+            return 0;
         flux_log (h,
                   LOG_ERR,
                   "job %s not replayed: %s",
@@ -177,6 +177,27 @@ done:
     return rc;
 }
 
+static int depthfirst_map_one (flux_t *h,
+                               const char *key,
+                               int dirskip,
+                               restart_map_f cb,
+                               void *arg,
+                               flux_error_t *error)
+{
+    flux_jobid_t id;
+
+    if (strlen (key) <= dirskip) {
+        errprintf (error, "internal error key=%s dirskip=%d", key, dirskip);
+        errno = EINVAL;
+        return -1;
+    }
+    if (fluid_decode (key + dirskip + 1, &id, FLUID_STRING_DOTHEX) < 0) {
+        errprintf (error, "could not decode %s to job ID", key + dirskip + 1);
+        return -1;
+    }
+    return replay_job (h, id, false, cb, arg, error);
+}
+
 static int depthfirst_map (flux_t *h,
                            const char *key,
                            int dirskip,
@@ -261,7 +282,7 @@ static int restart_map_cb (struct job *job, void *arg, flux_error_t *error)
     struct job_manager *ctx = arg;
     flux_job_state_t state = job->state;
 
-    if (zhashx_insert (ctx->active_jobs, &job->id, job) < 0) {
+    if (jobmap_insert (ctx->active_jobs, job->id, job) < 0) {
         errprintf (error,
                    "could not insert job %s into active job hash",
                    idf58 (job->id));
@@ -307,6 +328,10 @@ int restart_save_state (struct job_manager *ctx)
     flux_kvs_txn_t *txn;
     int rc = -1;
 
+    /* The snapshot is committed with the final eventlog batch.
+     */
+    if (snapshot_flush (ctx->snapshot) < 0)
+        return -1;
     if (!(txn = flux_kvs_txn_create ())
         || restart_save_state_to_txn (ctx, txn) < 0
         || !(f = flux_kvs_commit (ctx->h, NULL, 0, txn))
@@ -352,22 +377,72 @@ error:
     return -1;
 }
 
+/* Restore jobs from the snapshot, then replay the jobs it lists from
+ * the KVS.  Return the number of jobs, or -1 on a fatal error.
+ */
+static int restart_from_snapshot (struct job_manager *ctx,
+                                  zlistx_t *restored,
+                                  json_t *replay,
+                                  flux_error_t *error)
+{
+    struct job *job;
+    size_t index;
+    json_t *o;
+    int count = 0;
+
+    job = zlistx_first (restored);
+    while (job) {
+        if (restart_map_cb (job, ctx, error) < 0)
+            return -1;
+        count++;
+        job = zlistx_next (restored);
+    }
+    json_array_foreach (replay, index, o) {
+        int n;
+        if ((n = replay_job (ctx->h,
+                             json_integer_value (o),
+                             true,
+                             restart_map_cb,
+                             ctx,
+                             error)) < 0)
+            return -1;
+        count += n;
+    }
+    return count;
+}
+
 int restart_from_kvs (struct job_manager *ctx)
 {
     const char *dirname = "job";
     int dirskip = strlen (dirname);
     int count;
     struct job *job;
+    zlistx_t *restored;
+    json_t *replay;
     flux_error_t error;
 
     /* Load any active jobs present in the KVS at startup.
      */
-    count = depthfirst_map (ctx->h,
-                            dirname,
-                            dirskip,
-                            restart_map_cb,
-                            ctx,
-                            &error);
+    if (snapshot_load (ctx->snapshot, &restored, &replay, &error) >= 0) {
+        count = restart_from_snapshot (ctx, restored, replay, &error);
+        flux_log (ctx->h,
+                  LOG_INFO,
+                  "restart: %zu jobs from snapshot, %zu replayed",
+                  zlistx_size (restored),
+                  json_array_size (replay));
+        zlistx_destroy (&restored);
+        json_decref (replay);
+    }
+    else {
+        if (errno != ENOENT)
+            flux_log (ctx->h, LOG_ERR, "restart: snapshot: %s", error.text);
+        count = depthfirst_map (ctx->h,
+                                dirname,
+                                dirskip,
+                                restart_map_cb,
+                                ctx,
+                                &error);
+    }
     if (count < 0) {
         flux_log (ctx->h, LOG_ERR, "restart failed: %s", error.text);
         return -1;
@@ -378,7 +453,7 @@ int restart_from_kvs (struct job_manager *ctx)
      *
      * Initialize the count of "running" jobs
      */
-    job = zhashx_first (ctx->active_jobs);
+    job = jobmap_first (ctx->active_jobs);
     while (job) {
         if (job->state == FLUX_JOB_STATE_NEW
             || job->state == FLUX_JOB_STATE_DEPEND) {
@@ -443,14 +518,14 @@ int restart_from_kvs (struct job_manager *ctx)
                                     __FUNCTION__, idf58 (job->id));
             }
         }
-        job = zhashx_next (ctx->active_jobs);
+        job = jobmap_next (ctx->active_jobs);
     }
     flux_log (ctx->h, LOG_INFO, "restart: %d running jobs", ctx->running_jobs);
 
-    job = zhashx_first (ctx->inactive_jobs);
+    job = jobmap_first (ctx->inactive_jobs);
     while (job) {
         (void)jobtap_call (ctx->jobtap, job, "job.inactive-add", NULL);
-        job = zhashx_next (ctx->active_jobs);
+        job = jobmap_next (ctx->inactive_jobs);
     }
 
     /* Restore misc state.
@@ -462,6 +537,13 @@ int restart_from_kvs (struct job_manager *ctx)
         }
         flux_log (ctx->h, LOG_INFO, "restart: %s not found", checkpoint_key);
     }
+    /* Start writing a new snapshot, if one is needed.
+     */
+    if (snapshot_pending (ctx->snapshot)
+        && event_batch_open (ctx->event) < 0) {
+        flux_log_error (ctx->h, "restart: error starting snapshot");
+        return -1;
+    }
     flux_log (ctx->h,
               LOG_DEBUG,
               "restart: max_jobid=%s",
@@ -0,0 +1,671 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* snapshot.c - save inactive jobs so restart need not replay them
+ *
+ * Replaying a job from the KVS costs several lookups, which dominates
+ * restart time when many inactive jobs are retained.  Inactive jobs never
+ * change except to be purged, so they are saved in buckets of up to
+ * bucket_size jobs under snapshot_dir.inactive.N.  A bucket is rewritten
+ * only when a job is added to it or purged from it.
+ *
+ * Each eventlog commit also appends the IDs of the jobs it modified to
+ * snapshot_dir.log, in the same KVS transaction, as does each purge.
+ * Once enough IDs have been logged, dirty buckets are written a few at a
+ * time with subsequent eventlog commits.  When none remain, the list of
+ * active jobs is written to snapshot_dir.index and the log is cleared.
+ *
+ * On restart, jobs in the index or the log are replayed from the KVS
+ * as before, and all other jobs are restored from the buckets.  If there
+ * is no index, all jobs are replayed and the snapshot is rewritten.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <jansson.h>
+#include <flux/core.h>
+
+#include "src/common/libczmqcontainers/czmq_containers.h"
+#include "src/common/libjob/jobmap.h"
+#include "src/common/libjob/idf58.h"
+#include "src/common/libutil/errno_safe.h"
+#include "src/common/libutil/errprintf.h"
+
+#include "job-manager.h"
+#include "job.h"
+#include "event.h"
+#include "snapshot.h"
+
+#define SNAPSHOT_VERSION 1
+
+static const char *snapshot_dir = "checkpoint.job-manager-snapshot";
+
+static const int bucket_size = 1000;        // max jobs per bucket
+static const int buckets_per_txn = 4;       // max buckets per eventlog commit
+static const int log_limit = 10000;         // IDs logged before a snapshot
+
+struct bucket {
+    int id;
+    struct jobmap *jobs;
+    bool dirty;
+};
+
+struct snapshot {
+    struct job_manager *ctx;
+    zlistx_t *buckets;
+    struct jobmap *index;       // job id => bucket
+    struct bucket *open;        // bucket receiving newly inactive jobs
+    int next_id;
+    int logged;                 // IDs logged since the index was written
+    bool due;                   // snapshot should be written
+    bool flush;                 // write all of it in the next commit
+    bool reset;                 // remove stale buckets in the next commit
+    int restored;
+    int replayed;
+};
+
+static void bucket_destroy (struct bucket *b)
+{
+    if (b) {
+        int saved_errno = errno;
+        jobmap_destroy (b->jobs);
+        free (b);
+        errno = saved_errno;
+    }
+}
+
+// zlistx_destructor_fn footprint
+static void bucket_destructor (void **item)
+{
+    if (item) {
+        bucket_destroy (*item);
+        *item = NULL;
+    }
+}
+
+static struct bucket *snapshot_add_bucket (struct snapshot *snapshot, int id)
+{
+    struct bucket *b;
+
+    if (!(b = calloc (1, sizeof (*b))))
+        return NULL;
+    b->id = id;
+    if (!(b->jobs = jobmap_create ())
+        || !zlistx_add_end (snapshot->buckets, b)) {
+        bucket_destroy (b);
+        errno = ENOMEM;
+        return NULL;
+    }
+    if (snapshot->next_id <= id)
+        snapshot->next_id = id + 1;
+    return b;
+}
+
+static int bucket_add_job (struct snapshot *snapshot,
+                           struct bucket *b,
+                           struct job *job)
+{
+    if (jobmap_insert (b->jobs, job->id, job) < 0
+        || jobmap_insert (snapshot->index, job->id, b) < 0) {
+        jobmap_delete (b->jobs, job->id);
+        errno = EEXIST;
+        return -1;
+    }
+    return 0;
+}
+
+int snapshot_job_inactive (struct snapshot *snapshot, struct job *job)
+{
+    struct bucket *b = snapshot->open;
+
+    if (jobmap_lookup (snapshot->index, job->id))
+        return 0;
+    if (!b || jobmap_size (b->jobs) >= bucket_size) {
+        if (!(b = snapshot_add_bucket (snapshot, snapshot->next_id)))
+            return -1;
+        snapshot->open = b;
+    }
+    if (bucket_add_job (snapshot, b, job) < 0)
+        return -1;
+    b->dirty = true;
+    return 0;
+}
+
+void snapshot_job_purged (struct snapshot *snapshot, struct job *job)
+{
+    struct bucket *b;
+
+    if ((b = jobmap_lookup (snapshot->index, job->id))) {
+        jobmap_delete (b->jobs, job->id);
+        jobmap_delete (snapshot->index, job->id);
+        b->dirty = true;
+    }
+}
+
+/* Write 'b' to 'txn', or unlink it if it is empty.
+ */
+static int bucket_save_to_txn (struct bucket *b, flux_kvs_txn_t *txn)
+{
+    char key[128];
+    struct job *job;
+    json_t *jobs;
+
+    snprintf (key, sizeof (key), "%s.inactive.%d", snapshot_dir, b->id);
+    if (jobmap_size (b->jobs) == 0)
+        return flux_kvs_txn_unlink (txn, 0, key);
+    if (!(jobs = json_array ()))
+        goto nomem;
+    job = jobmap_first (b->jobs);
+    while (job) {
+        json_t *o;
+        if (!(o = job_snapshot (job))
+            || json_array_append_new (jobs, o) < 0) {
+            json_decref (o);
+            json_decref (jobs);
+            goto nomem;
+        }
+        job = jobmap_next (b->jobs);
+    }
+    if (flux_kvs_txn_pack (txn, 0, key, "O", jobs) < 0) {
+        ERRNO_SAFE_WRAP (json_decref, jobs);
+        return -1;
+    }
+    json_decref (jobs);
+    return 0;
+nomem:
+    errno = ENOMEM;
+    return -1;
+}
+
+static int index_save_to_txn (struct snapshot *snapshot, flux_kvs_txn_t *txn)
+{
+    char key[128];
+    json_t *active;
+    struct job *job;
+
+    if (!(active = json_array ()))
+        goto nomem;
+    job = jobmap_first (snapshot->ctx->active_jobs);
+    while (job) {
+        json_t *o;
+        if (!(o = json_integer (job->id))
+            || json_array_append_new (active, o) < 0) {
+            json_decref (o);
+            json_decref (active);
+            goto nomem;
+        }
+        job = jobmap_next (snapshot->ctx->active_jobs);
+    }
+    snprintf (key, sizeof (key), "%s.index", snapshot_dir);
+    if (flux_kvs_txn_pack (txn,
+                           0,
+                           key,
+                           "{s:i s:O}",
+                           "version", SNAPSHOT_VERSION,
+                           "active", active) < 0) {
+        ERRNO_SAFE_WRAP (json_decref, active);
+        return -1;
+    }
+    json_decref (active);
+    snprintf (key, sizeof (key), "%s.log", snapshot_dir);
+    if (flux_kvs_txn_unlink (txn, 0, key) < 0)
+        return -1;
+    return 0;
+nomem:
+    errno = ENOMEM;
+    return -1;
+}
+
+int snapshot_log_to_txn (struct snapshot *snapshot,
+                         flux_kvs_txn_t *txn,
+                         json_t *ids)
+{
+    char key[128];
+    size_t index;
+    json_t *o;
+    char *s = NULL;
+    size_t len = 0;
+    FILE *fp;
+
+    if (json_array_size (ids) == 0)
+        return 0;
+    if (!(fp = open_memstream (&s, &len)))
+        return -1;
+    json_array_foreach (ids, index, o)
+        fprintf (fp, "%ju\n", (uintmax_t)json_integer_value (o));
+    if (fclose (fp) != 0) {
+        ERRNO_SAFE_WRAP (free, s);
+        return -1;
+    }
+    snprintf (key, sizeof (key), "%s.log", snapshot_dir);
+    if (flux_kvs_txn_put (txn, FLUX_KVS_APPEND, key, s) < 0) {
+        ERRNO_SAFE_WRAP (free, s);
+        return -1;
+    }
+    free (s);
+    snapshot->logged += json_array_size (ids);
+    if (snapshot->logged >= log_limit)
+        snapshot->due = true;
+    return 0;
+}
+
+int snapshot_update_txn (struct snapshot *snapshot,
+                         flux_kvs_txn_t *txn,
+                         json_t *ids)
+{
+    struct bucket *b;
+    int count = 0;
+
+    if (snapshot->due) {
+        if (snapshot->reset) {
+            char key[128];
+            snprintf (key, sizeof (key), "%s.inactive", snapshot_dir);
+            if (flux_kvs_txn_unlink (txn, 0, key) < 0)
+                return -1;
+            snapshot->reset = false;
+        }
+        b = zlistx_first (snapshot->buckets);
+        while (b) {
+            if (b->dirty) {
+                if (!snapshot->flush && count == buckets_per_txn)
+                    break;
+                if (bucket_save_to_txn (b, txn) < 0)
+                    return -1;
+                b->dirty = false;
+                count++;
+                if (jobmap_size (b->jobs) == 0 && b != snapshot->open) {
+                    zlistx_delete (snapshot->buckets,
+                                   zlistx_cursor (snapshot->buckets));
+                }
+            }
+            b = zlistx_next (snapshot->buckets);
+        }
+        /* All buckets are up to date, so this commit completes the
+         * snapshot, and modifications in it need not be logged.
+         */
+        if (!b) {
+            if (index_save_to_txn (snapshot, txn) < 0)
+                return -1;
+            snapshot->logged = 0;
+            snapshot->due = false;
+            snapshot->flush = false;
+            return 0;
+        }
+    }
+    return snapshot_log_to_txn (snapshot, txn, ids);
+}
+
+bool snapshot_pending (struct snapshot *snapshot)
+{
+    return snapshot->due;
+}
+
+int snapshot_flush (struct snapshot *snapshot)
+{
+    snapshot->due = true;
+    snapshot->flush = true;
+    return event_batch_open (snapshot->ctx->event);
+}
+
+static int jobid_cmp (const void *a, const void *b)
+{
+    flux_jobid_t id1 = *(const flux_jobid_t *)a;
+    flux_jobid_t id2 = *(const flux_jobid_t *)b;
+
+    return id1 < id2 ? -1 : id1 > id2 ? 1 : 0;
+}
+
+/* Build a sorted, unique array of the IDs in the index 'active' array
+ * and in the newline-separated 'log'.
+ */
+static flux_jobid_t *replay_ids_create (json_t *active,
+                                        const char *log,
+                                        size_t *countp)
+{
+    flux_jobid_t *ids;
+    size_t count = 0;
+    size_t n;
+    size_t index;
+    json_t *o;
+    const char *cp;
+
+    n = json_array_size (active) + 1;
+    for (cp = log; cp && *cp; cp++)
+        if (*cp == '\n')
+            n++;
+    if (!(ids = calloc (n, sizeof (ids[0]))))
+        return NULL;
+    json_array_foreach (active, index, o)
+        ids[count++] = json_integer_value (o);
+    cp = log;
+    while (cp && *cp) {
+        unsigned long long id;
+        char *endptr;
+
+        errno = 0;
+        id = strtoull (cp, &endptr, 10);
+        if (errno != 0 || endptr == cp || (*endptr && *endptr != '\n')) {
+            free (ids);
+            errno = EPROTO;
+            return NULL;
+        }
+        if (count < n)
+            ids[count++] = id;
+        cp = *endptr ? endptr + 1 : endptr;
+    }
+    qsort (ids, count, sizeof (ids[0]), jobid_cmp);
+    if (count > 1) {
+        size_t i, j = 0;
+        for (i = 1; i < count; i++) {
+            if (ids[i] != ids[j])
+                ids[++j] = ids[i];
+        }
+        count = j + 1;
+    }
+    *countp = count;
+    return ids;
+}
+
+static bool replay_ids_find (flux_jobid_t *ids, size_t count, flux_jobid_t id)
+{
+    return bsearch (&id, ids, count, sizeof (ids[0]), jobid_cmp) != NULL;
+}
+
+static json_t *replay_ids_encode (flux_jobid_t *ids, size_t count)
+{
+    json_t *a;
+    size_t i;
+
+    if (!(a = json_array ()))
+        goto nomem;
+    for (i = 0; i < count; i++) {
+        json_t *o;
+        if (!(o = json_integer (ids[i]))
+            || json_array_append_new (a, o) < 0) {
+            json_decref (o);
+            json_decref (a);
+            goto nomem;
+        }
+    }
+    return a;
+nomem:
+    errno = ENOMEM;
+    return NULL;
+}
+
+/* Decode the jobs in bucket 'b' from 'jobs', except those that must be
+ * replayed, and append them to 'restored'.  Mark the bucket dirty if any
+ * were skipped, since it no longer matches the KVS.
+ */
+static int bucket_restore (struct snapshot *snapshot,
+                           struct bucket *b,
+                           json_t *jobs,
+                           flux_jobid_t *ids,
+                           size_t count,
+                           zlistx_t *restored,
+                           flux_error_t *error)
+{
+    size_t index;
+    json_t *o;
+
+    json_array_foreach (jobs, index, o) {
+        struct job *job;
+        flux_error_t e;
+        json_int_t id = 0;
+
+        (void)json_unpack (o, "{s:I}", "id", &id);
+        if (replay_ids_find (ids, count, id)) {
+            b->dirty = true;
+            continue;
+        }
+        if (!(job = job_create_from_snapshot (o, &e))) {
+            errprintf (error,
+                       "bucket %d: job %s: %s",
+                       b->id,
+                       idf58 (id),
+                       e.text);
+            return -1;
+        }
+        if (!zlistx_add_end (restored, job)) {
+            job_decref (job);
+            errprintf (error, "out of memory");
+            errno = ENOMEM;
+            return -1;
+        }
+        job_decref (job);
+        if (bucket_add_job (snapshot, b, job) < 0) {
+            errprintf (error, "job %s appears twice", idf58 (id));
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// zlistx_destructor_fn footprint
+static void future_destructor (void **item)
+{
+    if (item) {
+        flux_future_destroy (*item);
+        *item = NULL;
+    }
+}
+
+static flux_future_t *lookup_key (flux_t *h, int flags, const char *name)
+{
+    char key[128];
+
+    snprintf (key, sizeof (key), "%s.%s", snapshot_dir, name);
+    return flux_kvs_lookup (h, NULL, flags, key);
+}
+
+static void snapshot_clear (struct snapshot *snapshot)
+{
+    jobmap_purge (snapshot->index);
+    zlistx_purge (snapshot->buckets);
+    snapshot->open = NULL;
+    snapshot->next_id = 0;
+}
+
+int snapshot_load (struct snapshot *snapshot,
+                   zlistx_t **restoredp,
+                   json_t **replayp,
+                   flux_error_t *error)
+{
+    flux_t *h = snapshot->ctx->h;
+    flux_future_t *f_index = NULL;
+    flux_future_t *f_log = NULL;
+    flux_future_t *f_dir = NULL;
+    zlistx_t *lookups = NULL;
+    zlistx_t *restored = NULL;
+    int version;
+    json_t *active;
+    const char *log = NULL;
+    const flux_kvsdir_t *dir;
+    flux_kvsitr_t *itr;
+    const char *name;
+    flux_jobid_t *ids = NULL;
+    size_t count = 0;
+    json_t *replay = NULL;
+    flux_future_t *f;
+
+    /* Any failure leaves a snapshot to be rewritten from scratch.
+     */
+    snapshot->due = true;
+    snapshot->reset = true;
+
+    if (!(f_index = lookup_key (h, 0, "index"))
+        || !(f_log = lookup_key (h, 0, "log"))
+        || !(f_dir = lookup_key (h, FLUX_KVS_READDIR, "inactive"))
+        || !(lookups = zlistx_new ())
+        || !(restored = zlistx_new ())) {
+        errprintf (error,
+                   "error sending lookup requests: %s",
+                   strerror (errno));
+        goto error;
+    }
+    zlistx_set_destructor (lookups, future_destructor);
+    zlistx_set_destructor (restored, job_destructor);
+    zlistx_set_duplicator (restored, job_duplicator);
+
+    if (flux_kvs_lookup_get_unpack (f_index,
+                                    "{s:i s:o}",
+                                    "version", &version,
+                                    "active", &active) < 0) {
+        errprintf (error, "index: %s", strerror (errno));
+        goto error;
+    }
+    if (version != SNAPSHOT_VERSION || !json_is_array (active)) {
+        errprintf (error, "index: unsupported version %d", version);
+        errno = EINVAL;
+        goto error;
+    }
+    if (flux_kvs_lookup_get (f_log, &log) < 0 && errno != ENOENT) {
+        errprintf (error, "log: %s", strerror (errno));
+        goto error;
+    }
+    if (!(ids = replay_ids_create (active, log, &count))) {
+        errprintf (error, "log: %s", strerror (errno));
+        goto error;
+    }
+    if (flux_kvs_lookup_get_dir (f_dir, &dir) < 0) {
+        if (errno != ENOENT) {
+            errprintf (error, "inactive: %s", strerror (errno));
+            goto error;
+        }
+        dir = NULL;
+    }
+    if (dir) {
+        if (!(itr = flux_kvsitr_create (dir))) {
+            errprintf (error, "inactive: %s", strerror (errno));
+            goto error;
+        }
+        while ((name = flux_kvsitr_next (itr))) {
+            char key[64];
+            snprintf (key, sizeof (key), "inactive.%s", name);
+            if (!(f = lookup_key (h, 0, key))
+                || !zlistx_add_end (lookups, f)) {
+                flux_future_destroy (f);
+                flux_kvsitr_destroy (itr);
+                errprintf (error, "error sending lookup requests");
+                goto error;
+            }
+        }
+        flux_kvsitr_destroy (itr);
+    }
+    f = zlistx_first (lookups);
+    while (f) {
+        const char *key = flux_kvs_lookup_get_key (f);
+        const char *cp = strrchr (key, '.');
+        struct bucket *b;
+        json_t *jobs;
+        char *endptr;
+        int id;
+
+        errno = 0;
+        id = strtol (cp + 1, &endptr, 10);
+        if (errno != 0 || *endptr != '\0' || id < 0) {
+            errprintf (error, "%s: invalid bucket name", key);
+            errno = EINVAL;
+            goto error;
+        }
+        if (flux_kvs_lookup_get_unpack (f, "o", &jobs) < 0
+            || !json_is_array (jobs)) {
+            errprintf (error, "%s: %s", key, strerror (errno));
+            goto error;
+        }
+        if (!(b = snapshot_add_bucket (snapshot, id))
+            || bucket_restore (snapshot,
+                               b,
+                               jobs,
+                               ids,
+                               count,
+                               restored,
+                               error) < 0)
+            goto error;
+        f = zlistx_next (lookups);
+    }
+    if (!(replay = replay_ids_encode (ids, count))) {
+        errprintf (error, "out of memory");
+        goto error;
+    }
+    snapshot->logged = count - json_array_size (active);
+    snapshot->restored = zlistx_size (restored);
+    snapshot->replayed = count;
+    snapshot->due = false;
+    snapshot->reset = false;
+    free (ids);
+    flux_future_destroy (f_index);
+    flux_future_destroy (f_log);
+    flux_future_destroy (f_dir);
+    zlistx_destroy (&lookups);
+    *restoredp = restored;
+    *replayp = replay;
+    return zlistx_size (restored);
+error:
+    ERRNO_SAFE_WRAP (snapshot_clear, snapshot);
+    ERRNO_SAFE_WRAP (free, ids);
+    flux_future_destroy (f_index);
+    flux_future_destroy (f_log);
+    flux_future_destroy (f_dir);
+    zlistx_destroy (&lookups);
+    zlistx_destroy (&restored);
+    return -1;
+}
+
+json_t *snapshot_stats (struct snapshot *snapshot)
+{
+    json_t *o;
+
+    if (!(o = json_pack ("{s:i s:i s:i s:i s:b}",
+                         "buckets", (int)zlistx_size (snapshot->buckets),
+                         "logged", snapshot->logged,
+                         "restored", snapshot->restored,
+                         "replayed", snapshot->replayed,
+                         "pending", snapshot->due))) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    return o;
+}
+
+void snapshot_destroy (struct snapshot *snapshot)
+{
+    if (snapshot) {
+        int saved_errno = errno;
+        zlistx_destroy (&snapshot->buckets);
+        jobmap_destroy (snapshot->index);
+        free (snapshot);
+        errno = saved_errno;
+    }
+}
+
+struct snapshot *snapshot_create (struct job_manager *ctx)
+{
+    struct snapshot *snapshot;
+
+    if (!(snapshot = calloc (1, sizeof (*snapshot))))
+        return NULL;
+    snapshot->ctx = ctx;
+    if (!(snapshot->buckets = zlistx_new ())
+        || !(snapshot->index = jobmap_create ()))
+        goto nomem;
+    zlistx_set_destructor (snapshot->buckets, bucket_destructor);
+    return snapshot;
+nomem:
+    errno = ENOMEM;
+    snapshot_destroy (snapshot);
+    return NULL;
+}
+
+// vi:ts=4 sw=4 expandtab
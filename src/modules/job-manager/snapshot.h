@@ -0,0 +1,66 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _FLUX_JOB_MANAGER_SNAPSHOT_H
+#define _FLUX_JOB_MANAGER_SNAPSHOT_H
+
+#include <stdbool.h>
+#include <jansson.h>
+#include <flux/core.h>
+
+#include "job-manager.h"
+#include "job.h"
+
+struct snapshot *snapshot_create (struct job_manager *ctx);
+void snapshot_destroy (struct snapshot *snapshot);
+
+/* Load the snapshot from the KVS.  On success, set 'restored' to a list
+ * of inactive jobs recreated from the snapshot, set 'replay' to an array
+ * of IDs of jobs that must be replayed from their eventlogs, and return
+ * the number of restored jobs.  Fail with errno=ENOENT if there is no
+ * snapshot.  On failure, the snapshot is rewritten from scratch as jobs
+ * are replayed.
+ */
+int snapshot_load (struct snapshot *snapshot,
+                   zlistx_t **restored,
+                   json_t **replay,
+                   flux_error_t *error);
+
+/* Track inactive jobs that are added to or purged from ctx->inactive_jobs.
+ */
+int snapshot_job_inactive (struct snapshot *snapshot, struct job *job);
+void snapshot_job_purged (struct snapshot *snapshot, struct job *job);
+
+/* Log the job IDs in 'ids' as modified in 'txn'.
+ */
+int snapshot_log_to_txn (struct snapshot *snapshot,
+                         flux_kvs_txn_t *txn,
+                         json_t *ids);
+
+/* Log the job IDs in 'ids' as modified in 'txn', the next eventlog commit,
+ * and, if a snapshot is pending, add some or all of it to 'txn'.
+ */
+int snapshot_update_txn (struct snapshot *snapshot,
+                         flux_kvs_txn_t *txn,
+                         json_t *ids);
+
+/* Return true if a snapshot should be added to the next eventlog commit.
+ */
+bool snapshot_pending (struct snapshot *snapshot);
+
+/* Add a complete snapshot to the next eventlog commit, e.g. on shutdown.
+ */
+int snapshot_flush (struct snapshot *snapshot);
+
+json_t *snapshot_stats (struct snapshot *snapshot);
+
+#endif /* ! _FLUX_JOB_MANAGER_SNAPSHOT_H */
+
+// vi:ts=4 sw=4 expandtab
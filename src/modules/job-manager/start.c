@@ -56,7 +56,9 @@
  * If an ENOSYS (or other "normal RPC error" response is returned to an
  * alloc request, it is assumed that the current service is unloading
  * or a fatal error has occurred.  Start requests are paused waiting
- * for another hello.
+ * for another hello.  Jobs that had already started are flagged for
+ * reattach, so the next exec service may reconnect to their job shells
+ * instead of starting new ones.
  *
  * No attempt is made to restart the interface with a previously overridden
  * exec service.
@@ -118,13 +120,13 @@ static void hello_cb (flux_t *h,
      * allowing new exec service to override.
      */
     if (start->topic) {
-        job = zhashx_first (ctx->active_jobs);
+        job = jobmap_first (ctx->active_jobs);
         while (job) {
             if (job->start_pending) {
                 errno = EINVAL;
                 goto error;
             }
-            job = zhashx_next (ctx->active_jobs);
+            job = jobmap_next (ctx->active_jobs);
         }
         free (start->topic);
         free (start->update_topic);
@@ -138,7 +140,7 @@ static void hello_cb (flux_t *h,
         flux_log_error (h, "%s: flux_respond", __FUNCTION__);
     /* Response has been sent, now take action on jobs in run state.
      */
-    job = zhashx_first (ctx->active_jobs);
+    job = jobmap_first (ctx->active_jobs);
     while (job) {
         if (job->state == FLUX_JOB_STATE_RUN) {
             if (event_job_action (ctx->event, job) < 0)
@@ -147,7 +149,7 @@ static void hello_cb (flux_t *h,
                                 __FUNCTION__,
                                 idf58 (job->id));
         }
-        job = zhashx_next (ctx->active_jobs);
+        job = jobmap_next (ctx->active_jobs);
     }
     return;
 error:
@@ -170,7 +172,7 @@ static void interface_teardown (struct start *start, char *s, int errnum)
         free (start->topic);
         start->topic = NULL;
 
-        job = zhashx_first (ctx->active_jobs);
+        job = jobmap_first (ctx->active_jobs);
         while (job) {
             if (job->start_pending) {
                 if ((job->flags & FLUX_JOB_DEBUG))
@@ -181,8 +183,11 @@ static void interface_teardown (struct start *start, char *s, int errnum)
                                                "{s:s}",
                                                "note", s);
                 job->start_pending = 0;
+                if (job_event_id_test (job,
+                                       event_index (ctx->event, "start")))
+                    job->reattach = 1;
             }
-            job = zhashx_next (ctx->active_jobs);
+            job = jobmap_next (ctx->active_jobs);
         }
     }
 }
@@ -214,7 +219,7 @@ static void start_response_cb (flux_t *h,
         flux_log_error (h, "start response payload");
         goto error;
     }
-    if (!(job = zhashx_lookup (ctx->active_jobs, &id))) {
+    if (!(job = jobmap_lookup (ctx->active_jobs, id))) {
         flux_log (h,
                   LOG_ERR,
                   "start response: id=%s not active",
@@ -327,16 +332,28 @@ int start_send_request (struct start *start, struct job *job)
 
     assert (job->state == FLUX_JOB_STATE_RUN);
     if (!job->start_pending && start->topic != NULL) {
-        if (!(msg = flux_request_encode (start->topic, NULL)))
+        const char *jobspec;
+        const char *R;
+        char *s;
+
+        /* Send the job's cached jobspec and R without re-encoding them.
+         */
+        if (!(jobspec = job_jobspec_str (job))
+            || !(R = job_R_str (job)))
+            return -1;
+        if (asprintf (&s,
+                      "{\"id\":%ju,\"userid\":%ju,\"jobspec\":%s,"
+                      "\"reattach\":%s,\"R\":%s}",
+                      (uintmax_t)job->id,
+                      (uintmax_t)job->userid,
+                      jobspec,
+                      job->reattach ? "true" : "false",
+                      R) < 0)
+            return -1;
+        msg = flux_request_encode (start->topic, s);
+        free (s);
+        if (!msg)
             return -1;
-        if (flux_msg_pack (msg,
-                           "{s:I s:I s:O s:b s:O}",
-                           "id", job->id,
-                           "userid", (json_int_t) job->userid,
-                           "jobspec", job->jobspec_redacted,
-                           "reattach", job->reattach,
-                           "R", job->R_redacted) < 0)
-            goto error;
         if (flux_send (ctx->h, msg, 0) < 0)
             goto error;
         flux_msg_destroy (msg);
@@ -86,7 +86,7 @@ static int submit_job (struct job_manager *ctx,
         set_errorf (errors, job->id, "%s", e.text);
         return -1;
     }
-    if (zhashx_insert (ctx->active_jobs, &job->id, job) < 0) {
+    if (jobmap_insert (ctx->active_jobs, job->id, job) < 0) {
         set_errorf (errors, job->id, "hash insert failed");
         return -1;
     }
@@ -148,7 +148,7 @@ error_post_invalid:
                                NULL);
     (void) jobtap_call (ctx->jobtap, job, "job.destroy", NULL);
 error:
-    zhashx_delete (ctx->active_jobs, &job->id);
+    jobmap_delete (ctx->active_jobs, job->id);
     return -1;
 }
 
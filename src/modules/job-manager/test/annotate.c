@@ -244,6 +244,60 @@ void overwrite (void)
     json_decref (orig);
 }
 
+void changed (void)
+{
+    json_t *orig;
+    json_t *new;
+
+    if (!(orig = json_pack ("{s:{s:s s:i}}",
+                            "sched",
+                              "reason_pending", "insufficient resources",
+                              "jobs_ahead", 2)))
+        BAIL_OUT ("json_pack() failed");
+
+    if (!(new = json_object ()))
+        BAIL_OUT ("json_object() failed");
+    ok (annotations_changed (orig, new) == false,
+        "annotations_changed returns false for empty update");
+    ok (annotations_changed (NULL, new) == false,
+        "annotations_changed returns false for empty update of NULL");
+    json_decref (new);
+
+    if (!(new = json_pack ("{s:{s:i}}", "sched", "jobs_ahead", 2)))
+        BAIL_OUT ("json_pack() failed");
+    ok (annotations_changed (orig, new) == false,
+        "annotations_changed returns false for repeated value");
+    ok (annotations_changed (NULL, new) == true,
+        "annotations_changed returns true for update of NULL");
+    json_decref (new);
+
+    if (!(new = json_pack ("{s:{s:i}}", "sched", "jobs_ahead", 1)))
+        BAIL_OUT ("json_pack() failed");
+    ok (annotations_changed (orig, new) == true,
+        "annotations_changed returns true for changed value");
+    json_decref (new);
+
+    if (!(new = json_pack ("{s:{s:n}}", "sched", "t_estimate")))
+        BAIL_OUT ("json_pack() failed");
+    ok (annotations_changed (orig, new) == false,
+        "annotations_changed returns false removing non-existent key");
+    json_decref (new);
+
+    if (!(new = json_pack ("{s:{s:n}}", "sched", "jobs_ahead")))
+        BAIL_OUT ("json_pack() failed");
+    ok (annotations_changed (orig, new) == true,
+        "annotations_changed returns true removing existing key");
+    json_decref (new);
+
+    if (!(new = json_pack ("{s:s}", "sched", "foo")))
+        BAIL_OUT ("json_pack() failed");
+    ok (annotations_changed (orig, new) == true,
+        "annotations_changed returns true replacing object with non-object");
+    json_decref (new);
+
+    json_decref (orig);
+}
+
 int main (int argc, char *argv[])
 {
     plan (NO_PLAN);
@@ -251,6 +305,7 @@ int main (int argc, char *argv[])
     basic ();
     recursive ();
     overwrite ();
+    changed ();
 
     done_testing ();
 }
@@ -11,6 +11,7 @@
 #if HAVE_CONFIG_H
 #include "config.h"
 #endif
+#include <string.h>
 #include <jansson.h>
 #include <flux/core.h>
 
@@ -860,6 +861,118 @@ static void test_resource_update ()
     job_decref (job);
 }
 
+static void test_cached_str (void)
+{
+    struct job *job;
+    const char *s;
+    const char *s2;
+    json_t *update;
+    json_t *o;
+    char *str;
+
+    if (!(job = job_create ()))
+        BAIL_OUT ("failed to create empty job");
+    errno = 0;
+    ok (job_R_str (job) == NULL && errno == EAGAIN,
+        "job_R_str fails with EAGAIN on job without R_redacted");
+    errno = 0;
+    ok (job_jobspec_str (job) == NULL && errno == EAGAIN,
+        "job_jobspec_str fails with EAGAIN on job without jobspec_redacted");
+
+    if (!(job->R_redacted = json_pack ("{s:i s:{s:f}}",
+                                       "version", 1,
+                                       "execution",
+                                         "expiration", 2.)))
+        BAIL_OUT ("failed to create fake R_redacted");
+    s = job_R_str (job);
+    ok (s != NULL && strstr (s, "\"expiration\":2.0") != NULL,
+        "job_R_str returns serialized R");
+    s2 = job_R_str (job);
+    ok (s2 == s,
+        "job_R_str returns cached string on second call");
+
+    if (!(update = json_pack ("{s:f}", "expiration", 100.)))
+        BAIL_OUT ("failed to create update");
+    ok (job_apply_resource_updates (job, update) == 0,
+        "job_apply_resource_updates works");
+    json_decref (update);
+    s = job_R_str (job);
+    ok (s != NULL && strstr (s, "\"expiration\":100.0") != NULL,
+        "job_R_str reflects resource update");
+
+    if (!(o = json_pack ("{s:i}", "id", 42)))
+        BAIL_OUT ("failed to create object");
+    str = job_dumps_with (o, "R", "{\"version\":1}");
+    is (str, "{\"id\":42,\"R\":{\"version\":1}}",
+        "job_dumps_with adds serialized value to object");
+    free (str);
+    json_decref (o);
+
+    if (!(o = json_object ()))
+        BAIL_OUT ("failed to create object");
+    errno = 0;
+    ok (job_dumps_with (o, "R", "{}") == NULL && errno == EINVAL,
+        "job_dumps_with fails with EINVAL on empty object");
+    json_decref (o);
+
+    job_decref (job);
+}
+
+static void test_R_summary (void)
+{
+    struct job *job;
+    json_t *summary;
+    const char *ranks = NULL;
+    const char *nodelist = NULL;
+    int nnodes = 0;
+    int ncores = 0;
+
+    if (!(job = job_create ()))
+        BAIL_OUT ("failed to create empty job");
+    errno = 0;
+    ok (job_R_summary (job) == NULL && errno == EAGAIN,
+        "job_R_summary fails with EAGAIN on job without R_redacted");
+
+    if (!(job->R_redacted = json_pack ("{s:i s:{s:[{s:s s:{s:s}}] s:[s]}}",
+                                       "version", 1,
+                                       "execution",
+                                         "R_lite",
+                                           "rank", "0-1",
+                                           "children",
+                                             "core", "0-3",
+                                         "nodelist",
+                                           "foo[0-1]")))
+        BAIL_OUT ("failed to create fake R_redacted");
+    summary = job_R_summary (job);
+    ok (summary != NULL
+        && json_unpack (summary,
+                        "{s:i s:i s:s s:s}",
+                        "nnodes", &nnodes,
+                        "ncores", &ncores,
+                        "ranks", &ranks,
+                        "nodelist", &nodelist) == 0,
+        "job_R_summary works");
+    ok (nnodes == 2 && ncores == 8,
+        "job_R_summary counted 2 nodes and 8 cores");
+    is (ranks, "[0-1]",
+        "job_R_summary encoded ranks");
+    is (nodelist, "foo[0-1]",
+        "job_R_summary encoded nodelist");
+    ok (job_R_summary (job) == summary,
+        "job_R_summary returns cached object on second call");
+
+    job_decref (job);
+
+    if (!(job = job_create ()))
+        BAIL_OUT ("failed to create empty job");
+    if (!(job->R_redacted = json_pack ("{s:i}", "version", 42)))
+        BAIL_OUT ("failed to create bad R_redacted");
+    errno = 0;
+    ok (job_R_summary (job) == NULL && errno == EINVAL,
+        "job_R_summary fails with EINVAL on invalid R");
+    job_decref (job);
+}
+
 int main (int argc, char *argv[])
 {
     plan (NO_PLAN);
@@ -872,6 +985,8 @@ int main (int argc, char *argv[])
     test_event_queue ();
     test_jobspec_update ();
     test_resource_update ();
+    test_cached_str ();
+    test_R_summary ();
 
     done_testing ();
 }
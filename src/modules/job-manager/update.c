@@ -544,8 +544,8 @@ static void update_handle_request (flux_t *h,
     }
     /*  Verify jobid exists and is not inactive
      */
-    if (!(job = zhashx_lookup (ctx->active_jobs, &id))) {
-        if (!(job = zhashx_lookup (ctx->inactive_jobs, &id))) {
+    if (!(job = jobmap_lookup (ctx->active_jobs, id))) {
+        if (!(job = jobmap_lookup (ctx->inactive_jobs, id))) {
             errstr = "unknown job id";
             errno = ENOENT;
         }
@@ -668,7 +668,7 @@ static void resource_update_cb (flux_future_t *f, void *arg)
     /*  Otherwise, check each running job to determine if an adjustment
      *  of its expiration is required:
      */
-    job = zhashx_first (update->ctx->active_jobs);
+    job = jobmap_first (update->ctx->active_jobs);
     while (job) {
         if (job->state == FLUX_JOB_STATE_RUN) {
             double expiration = -1.;
@@ -721,7 +721,7 @@ static void resource_update_cb (flux_future_t *f, void *arg)
                               "failed to pack resource-update event");
             }
         }
-        job = zhashx_next (update->ctx->active_jobs);
+        job = jobmap_next (update->ctx->active_jobs);
     }
 }
 
@@ -39,6 +39,44 @@
 
 #define MAXOF(a,b)   ((a)>(b)?(a):(b))
 
+int urgency_set_job (struct job_manager *ctx,
+                     struct job *job,
+                     struct flux_msg_cred cred,
+                     int urgency,
+                     const char **errstr)
+{
+    /* Security: guests can only adjust jobs that they submitted.
+     */
+    if (flux_msg_cred_authorize (cred, job->userid) < 0) {
+        *errstr = "guests can only reprioritize their own jobs";
+        return -1;
+    }
+    /* Security: guests can only reduce urgency, or increase up to default.
+     */
+    if (!(cred.rolemask & FLUX_ROLE_OWNER)
+        && urgency > MAXOF (FLUX_JOB_URGENCY_DEFAULT, job->urgency)) {
+        *errstr = "guests can only adjust urgency <= default";
+        errno = EPERM;
+        return -1;
+    }
+    if (job->has_resources) {
+        *errstr = "urgency cannot be changed once resources are allocated";
+        errno = EINVAL;
+        return -1;
+    }
+    /* Post event: this will update job->urgency, which will then result
+     *  in a call to recalculate priority, which reprioritize job if there
+     *  was a priority change.
+     */
+    return event_job_post_pack (ctx->event,
+                                job,
+                                "urgency",
+                                0,
+                                "{s:I s:i}",
+                                "userid", (json_int_t) cred.userid,
+                                "urgency", urgency);
+}
+
 void urgency_handle_request (flux_t *h,
                              flux_msg_handler_t *mh,
                              const flux_msg_t *msg,
@@ -64,45 +102,16 @@ void urgency_handle_request (flux_t *h,
         errno = EINVAL;
         goto error;
     }
-    if (!(job = zhashx_lookup (ctx->active_jobs, &id))) {
-        if (!(job = zhashx_lookup (ctx->inactive_jobs, &id)))
+    if (!(job = jobmap_lookup (ctx->active_jobs, id))) {
+        if (!(job = jobmap_lookup (ctx->inactive_jobs, id)))
             errstr = "unknown job";
         else
             errstr = "job is inactive";
         errno = EINVAL;
         goto error;
     }
-    /* Security: guests can only adjust jobs that they submitted.
-     */
-    if (flux_msg_cred_authorize (cred, job->userid) < 0) {
-        errstr = "guests can only reprioritize their own jobs";
-        goto error;
-    }
-    /* Security: guests can only reduce urgency, or increase up to default.
-     */
-    if (!(cred.rolemask & FLUX_ROLE_OWNER)
-        && urgency > MAXOF (FLUX_JOB_URGENCY_DEFAULT, job->urgency)) {
-        errstr = "guests can only adjust urgency <= default";
-        errno = EPERM;
-        goto error;
-    }
-    if (job->has_resources) {
-        errstr = "urgency cannot be changed once resources are allocated";
-        errno = EINVAL;
-        goto error;
-    }
-    /* Post event: this will update job->urgency, which will then result
-     *  in a call to recalculate priority, which reprioritize job if there
-     *  was a priority change.
-     */
     orig_urgency = job->urgency;
-    if (event_job_post_pack (ctx->event,
-                             job,
-                             "urgency",
-                             0,
-                             "{s:I s:i}",
-                             "userid", (json_int_t) cred.userid,
-                             "urgency", urgency) < 0)
+    if (urgency_set_job (ctx, job, cred, urgency, &errstr) < 0)
         goto error;
     if (flux_respond_pack (h, msg, "{s:i}", "old_urgency", orig_urgency) < 0) {
         flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
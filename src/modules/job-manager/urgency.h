@@ -14,6 +14,16 @@
 #include <flux/core.h>
 #include "job-manager.h"
 
+/* Set the urgency of 'job' on behalf of 'cred', subject to the same
+ * checks as an urgency request.  On failure, set 'errstr' if there is
+ * a more specific reason than errno.
+ */
+int urgency_set_job (struct job_manager *ctx,
+                     struct job *job,
+                     struct flux_msg_cred cred,
+                     int urgency,
+                     const char **errstr);
+
 /* Handle a 'urgency' request - job urgency adjustment
  */
 void urgency_handle_request (flux_t *h,
@@ -43,6 +43,16 @@
  *     without a waiter on the specific ID
  * (3) ECHILD error if no waitable jobs are available, or there are
  *     more waiters than jobs
+ *
+ * A FLUX_JOBID_ANY request with the streaming flag set receives the
+ * results of all waitable jobs without a waiter on the specific ID,
+ * several per response:
+ *   {"jobs":[{"id":I, "success":b, "errstr":s}, ...]}
+ * Zombies are returned right away.  Jobs that become inactive later are
+ * collected and sent together just before the reactor next blocks.  The
+ * stream ends with ENODATA once no more waitable jobs can be returned.
+ * Jobs with a specific waiter are kept on a list so that disconnect and
+ * teardown do not have to scan all active jobs.
  */
 
 #if HAVE_CONFIG_H
@@ -71,8 +81,14 @@ struct waitjob {
     int waiters; // count of waiters blocked on specific active jobs
     int waitables; // count of active waitable jobs
     struct flux_msglist *requests; // requests to wait in FLUX_JOBID_ANY
+    zlistx_t *waiting; // active jobs with a waiter on the specific ID
+    struct flux_msglist *streams; // streaming FLUX_JOBID_ANY requests
+    zlistx_t *pending; // inactive jobs not yet sent to a stream
+    flux_watcher_t *prep;
 };
 
+#define WAIT_STREAM_BATCH_MAX 1024
+
 static int decode_job_result (struct job *job,
                               bool *success,
                               flux_error_t *errp)
@@ -119,36 +135,161 @@ static int decode_job_result (struct job *job,
     return 0;
 }
 
-/* Respond to wait request 'msg' with completion info from 'job'.
+/* Build the wait response object for 'job'.
  */
-static void wait_respond (struct waitjob *wait,
-                          const flux_msg_t *msg,
-                          struct job *job)
+static json_t *wait_result (struct waitjob *wait, struct job *job)
 {
-    flux_t *h = wait->ctx->h;
     flux_error_t error;
     bool success;
+    json_t *o;
 
     if (decode_job_result (job, &success, &error) < 0) {
-        flux_log (h,
+        flux_log (wait->ctx->h,
                   LOG_ERR,
                   "wait_respond id=%s: result decode failure",
                   idf58 (job->id));
-        goto error;
+        return NULL;
+    }
+    if (!(o = json_pack ("{s:I s:b s:s}",
+                         "id", job->id,
+                         "success", success ? 1 : 0,
+                         "errstr", error.text))) {
+        errno = ENOMEM;
+        return NULL;
     }
-    if (flux_respond_pack (h,
-                           msg,
-                           "{s:I s:b s:s}",
-                           "id", job->id,
-                           "success", success ? 1 : 0,
-                           "errstr", error.text) < 0)
+    return o;
+}
+
+/* Respond to wait request 'msg' with completion info from 'job'.
+ */
+static void wait_respond (struct waitjob *wait,
+                          const flux_msg_t *msg,
+                          struct job *job)
+{
+    flux_t *h = wait->ctx->h;
+    json_t *o;
+
+    if (!(o = wait_result (wait, job)))
+        goto error;
+    if (flux_respond_pack (h, msg, "O", o) < 0)
         flux_log_error (h, "wait_respond id=%s", idf58 (job->id));
+    json_decref (o);
     return;
 error:
     if (flux_respond_error (h, msg, errno, "Flux job wait internal error") < 0)
         flux_log_error (h, "wait_respond id=%s", idf58 (job->id));
 }
 
+/* Add the result of 'job' to array 'jobs'.  A job whose result cannot
+ * be decoded is logged and skipped, like a wait_respond() failure.
+ */
+static int wait_result_append (struct waitjob *wait,
+                               json_t *jobs,
+                               struct job *job)
+{
+    json_t *o;
+
+    if (!(o = wait_result (wait, job)))
+        return 0;
+    if (json_array_append_new (jobs, o) < 0) {
+        json_decref (o);
+        errno = ENOMEM;
+        return -1;
+    }
+    return 0;
+}
+
+static void wait_stream_respond (struct waitjob *wait,
+                                 const flux_msg_t *msg,
+                                 json_t *jobs)
+{
+    if (json_array_size (jobs) > 0
+        && flux_respond_pack (wait->ctx->h, msg, "{s:O}", "jobs", jobs) < 0)
+        flux_log_error (wait->ctx->h, "error responding to wait stream");
+}
+
+/* End all wait streams if no more waitable jobs can be sent to them.
+ * Jobs with a waiter on the specific ID, or claimed by pending
+ * FLUX_JOBID_ANY requests, are not available to streams.
+ */
+static void wait_streams_check_end (struct waitjob *wait)
+{
+    const flux_msg_t *msg;
+
+    if (flux_msglist_count (wait->streams) == 0
+        || zlistx_size (wait->pending) > 0
+        || zhashx_size (wait->zombies) > 0
+        || wait->waitables - wait->waiters
+           - flux_msglist_count (wait->requests) > 0)
+        return;
+    while ((msg = flux_msglist_pop (wait->streams))) {
+        if (flux_respond_error (wait->ctx->h, msg, ENODATA, NULL) < 0)
+            flux_log_error (wait->ctx->h, "error responding to wait stream");
+        flux_msg_decref (msg);
+    }
+}
+
+/* Send jobs that became inactive since the last call to the first
+ * wait stream, in batches.  If the streams have gone away in the
+ * meantime, the jobs become zombies.
+ */
+static void wait_pending_flush (struct waitjob *wait)
+{
+    const flux_msg_t *msg = flux_msglist_first (wait->streams);
+    json_t *jobs = NULL;
+    struct job *job;
+
+    while ((job = zlistx_first (wait->pending))) {
+        if (!msg) {
+            if (zhashx_insert (wait->zombies, &job->id, job) < 0)
+                flux_log (wait->ctx->h,
+                          LOG_ERR,
+                          "zhashx_insert into zombies hash failed");
+        }
+        else {
+            if (!jobs && !(jobs = json_array ()))
+                goto nomem;
+            if (wait_result_append (wait, jobs, job) < 0)
+                goto nomem;
+            if (json_array_size (jobs) == WAIT_STREAM_BATCH_MAX) {
+                wait_stream_respond (wait, msg, jobs);
+                json_array_clear (jobs);
+            }
+        }
+        zlistx_delete (wait->pending, zlistx_cursor (wait->pending));
+    }
+    if (msg)
+        wait_stream_respond (wait, msg, jobs);
+    json_decref (jobs);
+    wait_streams_check_end (wait);
+    return;
+nomem:
+    flux_log (wait->ctx->h, LOG_ERR, "out of memory responding to wait stream");
+    json_decref (jobs);
+}
+
+static void prep_cb (flux_reactor_t *r,
+                     flux_watcher_t *w,
+                     int revents,
+                     void *arg)
+{
+    struct waitjob *wait = arg;
+
+    flux_watcher_stop (wait->prep);
+    wait_pending_flush (wait);
+}
+
+static void wait_clear_waiter (struct waitjob *wait, struct job *job)
+{
+    void *handle = job->waiter_handle;
+
+    flux_msg_decref (job->waiter);
+    job->waiter = NULL;
+    job->waiter_handle = NULL;
+    wait->waiters--;
+    zlistx_delete (wait->waiting, handle); // decrefs job
+}
+
 /* Callback from event_job_action().  The 'job' has entered INACTIVE state.
  * Respond to a pending waiter, if any.  Otherwise insert into zombies
  * hash for a future wait request.
@@ -162,14 +303,19 @@ void wait_notify_inactive (struct waitjob *wait, struct job *job)
 
     if (job->waiter) {
         wait_respond (wait, job->waiter, job);
-        flux_msg_decref (job->waiter);
-        job->waiter = NULL;
-        wait->waiters--;
+        wait_clear_waiter (wait, job);
     }
     else if ((req = flux_msglist_first (wait->requests))) {
         wait_respond (wait, req, job);
         flux_msglist_delete (wait->requests);
     }
+    else if (flux_msglist_count (wait->streams) > 0) {
+        if (!zlistx_add_end (wait->pending, job_incref (job))) {
+            job_decref (job);
+            flux_log (h, LOG_ERR, "error queuing job for wait stream");
+        }
+        flux_watcher_start (wait->prep);
+    }
     else {
         if (zhashx_insert (wait->zombies, &job->id, job) < 0) // increfs job
             flux_log (h, LOG_ERR, "zhashx_insert into zombies hash failed");
@@ -201,6 +347,27 @@ static void wait_rpc (flux_t *h,
         errstr = "malformed wait request";
         goto error;
     }
+    if (flux_msg_is_streaming (msg)) {
+        if (id != FLUX_JOBID_ANY) {
+            errstr = "streaming wait requires FLUX_JOBID_ANY";
+            errno = EPROTO;
+            goto error;
+        }
+        if (flux_msglist_append (wait->streams, msg) < 0)
+            goto error;
+        /* Move zombies to the pending list and send them now.
+         */
+        while ((job = zhashx_first (wait->zombies))) {
+            if (!zlistx_add_end (wait->pending, job_incref (job))) {
+                job_decref (job);
+                errno = ENOMEM;
+                goto error;
+            }
+            zhashx_delete (wait->zombies, &job->id);
+        }
+        wait_pending_flush (wait);
+        return;
+    }
     if (id == FLUX_JOBID_ANY) {
         /* If there's a zombie, respond and destroy it.
          */
@@ -224,7 +391,7 @@ static void wait_rpc (flux_t *h,
         }
         /* If job is still active, enqueue the request.
          */
-        else if ((job = zhashx_lookup (ctx->active_jobs, &id))) {
+        else if ((job = jobmap_lookup (ctx->active_jobs, id))) {
             if (job->waiter) {
                 errstr = "job id already has a waiter";
                 goto error_nojob;
@@ -233,8 +400,15 @@ static void wait_rpc (flux_t *h,
                 errstr = "job was not submitted with FLUX_JOB_WAITABLE";
                 goto error_nojob;
             }
+            if (!(job->waiter_handle = zlistx_add_end (wait->waiting,
+                                                       job_incref (job)))) {
+                job_decref (job);
+                errno = ENOMEM;
+                goto error;
+            }
             job->waiter = flux_msg_incref (msg);
             wait->waiters++;
+            wait_streams_check_end (wait);
             return;
         }
         /* Invalid jobid, not waitable, or already waited on.
@@ -262,6 +436,7 @@ static void wait_rpc (flux_t *h,
             flux_msglist_delete (wait->requests);
         }
     }
+    wait_streams_check_end (wait);
     return;
 
 error_nojob:
@@ -282,19 +457,19 @@ void wait_disconnect_rpc (flux_t *h,
     struct waitjob *wait = ctx->wait;
     struct job *job;
 
-    job = zhashx_first (ctx->active_jobs);
-    while (job && wait->waiters > 0) {
-        if (job->waiter) {
-            if (flux_msg_route_match_first (job->waiter, msg)) {
-                flux_msg_decref (job->waiter);
-                job->waiter = NULL;
-                wait->waiters--;
-            }
-        }
-        job = zhashx_next (ctx->active_jobs);
+    job = zlistx_first (wait->waiting);
+    while (job) {
+        struct job *next = zlistx_next (wait->waiting);
+
+        if (flux_msg_route_match_first (job->waiter, msg))
+            wait_clear_waiter (wait, job);
+        job = next;
     }
 
     flux_msglist_disconnect (wait->requests, msg);
+    flux_msglist_disconnect (wait->streams, msg);
+    if (zlistx_size (wait->pending) > 0)
+        flux_watcher_start (wait->prep);
 }
 
 struct job *wait_zombie_first (struct waitjob *wait)
@@ -322,19 +497,15 @@ void wait_ctx_destroy (struct waitjob *wait)
         int saved_errno = errno;
         flux_msg_handler_delvec (wait->handlers);
 
-        /* Iterate through active jobs, sending ENOSYS response to
-         * any pending wait requests, indicating that the module is unloading.
-         * Use wait->waiters count to avoid unnecessary scanning.
+        /* Send ENOSYS response to any pending wait requests on specific
+         * jobs, indicating that the module is unloading.
          */
-        job = zhashx_first (wait->ctx->active_jobs);
-        while (job && wait->waiters > 0) {
-            if (job->waiter) {
+        if (wait->waiting) {
+            while ((job = zlistx_first (wait->waiting))) {
                 respond_unloading (h, job->waiter);
-                flux_msg_decref (job->waiter);
-                job->waiter = NULL;
-                wait->waiters--;
+                wait_clear_waiter (wait, job);
             }
-            job = zhashx_next (wait->ctx->active_jobs);
+            zlistx_destroy (&wait->waiting);
         }
 
         /* Send ENOSYS to any pending FLUX_JOBID_ANY wait requests,
@@ -350,6 +521,17 @@ void wait_ctx_destroy (struct waitjob *wait)
             }
             flux_msglist_destroy (wait->requests);
         }
+        if (wait->streams) {
+            const flux_msg_t *msg;
+
+            while ((msg = flux_msglist_pop (wait->streams))) {
+                respond_unloading (h, msg);
+                flux_msg_decref (msg);
+            }
+            flux_msglist_destroy (wait->streams);
+        }
+        zlistx_destroy (&wait->pending);
+        flux_watcher_destroy (wait->prep);
 
         zhashx_destroy (&wait->zombies);
         free (wait);
@@ -380,8 +562,16 @@ struct waitjob *wait_ctx_create (struct job_manager *ctx)
     zhashx_set_destructor (wait->zombies, job_destructor);
     zhashx_set_duplicator (wait->zombies, job_duplicator);
 
-    if (!(wait->requests = flux_msglist_create ()))
+    if (!(wait->requests = flux_msglist_create ())
+        || !(wait->streams = flux_msglist_create ())
+        || !(wait->waiting = zlistx_new ())
+        || !(wait->pending = zlistx_new ())
+        || !(wait->prep = flux_prepare_watcher_create (flux_get_reactor (ctx->h),
+                                                       prep_cb,
+                                                       wait)))
         goto error;
+    zlistx_set_destructor (wait->waiting, job_destructor);
+    zlistx_set_destructor (wait->pending, job_destructor);
 
     if (flux_msg_handler_addvec (ctx->h, htab, ctx, &wait->handlers) < 0)
         goto error;
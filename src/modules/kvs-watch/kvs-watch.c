@@ -21,6 +21,7 @@
 #include "src/common/libkvs/treeobj.h"
 #include "src/common/libkvs/kvs_util_private.h"
 #include "src/common/libutil/blobref.h"
+#include "src/common/libutil/errno_safe.h"
 
 /* State for one watcher */
 struct watcher {
@@ -36,14 +37,27 @@ struct watcher {
     int initial_rootseq;        // initial rootseq returned by initial rpc
     char *key;                  // lookup key
     int flags;                  // kvs_lookup flags
-    zlist_t *lookups;           // list of futures, in commit order
+    zlist_t *lookups;           // list of struct lookup, in commit order
 
     struct ns_monitor *nsm;     // back pointer for removal
     json_t *prev;               // previous watch value for KVS_WATCH_FULL/UNIQ
-    int append_offset;          // offset for KVS_WATCH_APPEND
+    int append_index;           // blobs sent for KVS_WATCH_APPEND
     void *handle;               // zlistx_t handle
 };
 
+/* A kvs.lookup-plus RPC shared by watchers that would otherwise send
+ * identical requests for the same commit.
+ */
+struct lookup {
+    flux_future_t *f;
+    int refcount;
+    char *id;                   // hash key in nsm->lookups, if shared
+    struct ns_monitor *nsm;     // back pointer for removal, if shared
+    zlist_t *watchers;          // watchers waiting on this lookup
+    json_t *val;                // lookup response val
+    char *payload;              // encoded watcher response for 'val'
+};
+
 /* Current KVS root.
  */
 struct commit {
@@ -65,6 +79,7 @@ struct ns_monitor {
     int errnum;                 // if non-zero, error pending for all watchers
     struct watch_ctx *ctx;      // back-pointer to watch_ctx
     zlistx_t *watchers;         // list of watchers of this namespace
+    zhash_t *lookups;           // lookups in flight that can be shared
     char *topic;                // topic string for subscription
     bool subscribed;            // subscription active
     flux_future_t *getrootf;    // initial getroot future
@@ -76,8 +91,54 @@ struct watch_ctx {
     flux_t *h;
     flux_msg_handler_t **handlers;
     zhash_t *namespaces;        // hash of monitored namespaces
+    int shared_lookups;         // watcher lookups satisfied by another's
 };
 
+static void lookup_unshare (struct lookup *lk)
+{
+    if (lk->nsm) {
+        zhash_delete (lk->nsm->lookups, lk->id);
+        lk->nsm = NULL;
+    }
+}
+
+static void lookup_decref (struct lookup *lk)
+{
+    if (lk && --lk->refcount == 0) {
+        int saved_errno = errno;
+        lookup_unshare (lk);
+        flux_future_destroy (lk->f);
+        zlist_destroy (&lk->watchers);
+        free (lk->payload);
+        free (lk->id);
+        free (lk);
+        errno = saved_errno;
+    }
+}
+
+static struct lookup *lookup_incref (struct lookup *lk)
+{
+    if (lk)
+        lk->refcount++;
+    return lk;
+}
+
+static struct lookup *lookup_create (flux_future_t *f)
+{
+    struct lookup *lk;
+
+    if (!(lk = calloc (1, sizeof (*lk))))
+        return NULL;
+    if (!(lk->watchers = zlist_new ())) {
+        free (lk);
+        errno = ENOMEM;
+        return NULL;
+    }
+    lk->f = f;
+    lk->refcount = 1;
+    return lk;
+}
+
 static void watcher_destroy (struct watcher *w)
 {
     if (w) {
@@ -85,9 +146,11 @@ static void watcher_destroy (struct watcher *w)
         flux_msg_decref (w->request);
         free (w->key);
         if (w->lookups) {
-            flux_future_t *f;
-            while ((f = zlist_pop (w->lookups)))
-                flux_future_destroy (f);
+            struct lookup *lk;
+            while ((lk = zlist_pop (w->lookups))) {
+                zlist_remove (lk->watchers, w);
+                lookup_decref (lk);
+            }
             zlist_destroy (&w->lookups);
         }
         json_decref (w->prev);
@@ -154,6 +217,7 @@ static void namespace_destroy (struct ns_monitor *nsm)
         int saved_errno = errno;
         commit_destroy (nsm->commit);
         zlistx_destroy (&nsm->watchers);
+        zhash_destroy (&nsm->lookups);
         if (nsm->subscribed)
             (void)flux_event_unsubscribe (nsm->ctx->h, nsm->topic);
         free (nsm->topic);
@@ -182,6 +246,8 @@ static struct ns_monitor *namespace_create (struct watch_ctx *ctx,
     if (!(nsm->watchers = zlistx_new ()))
         goto error;
     zlistx_set_destructor (nsm->watchers, watcher_destructor);
+    if (!(nsm->lookups = zhash_new ()))
+        goto error;
     if (!(nsm->ns_name = strdup (ns)))
         goto error;
     /* We are subscribing to the kvs.namespace-<NS> substring.
@@ -247,15 +313,6 @@ static int handle_initial_response (flux_t *h,
         || (w->flags & FLUX_KVS_WATCH_UNIQ))
         w->prev = json_incref (val);
 
-    if ((w->flags & FLUX_KVS_WATCH_APPEND)) {
-        if (treeobj_decode_val (val,
-                                NULL,
-                                &w->append_offset) < 0) {
-            flux_log_error (h, "%s: treeobj_decode_val", __FUNCTION__);
-            return -1;
-        }
-    }
-
     if (flux_respond_pack (h, w->request, "{ s:O }", "val", val) < 0) {
         flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
         return -1;
@@ -266,7 +323,42 @@ static int handle_initial_response (flux_t *h,
     return 0;
 }
 
+/* The response to a shared lookup is usually the same for all of its
+ * watchers, so encode it once.  An append tail that skips data is
+ * specific to the watcher and is encoded separately.
+ */
+static int respond_val (flux_t *h,
+                        struct lookup *lk,
+                        struct watcher *w,
+                        json_t *val)
+{
+    if (val != lk->val) {
+        if (flux_respond_pack (h, w->request, "{ s:O }", "val", val) < 0) {
+            flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
+            return -1;
+        }
+        return 0;
+    }
+    if (!lk->payload) {
+        json_t *o;
+
+        if (!(o = json_pack ("{ s:O }", "val", val))
+            || !(lk->payload = json_dumps (o, JSON_COMPACT))) {
+            json_decref (o);
+            errno = ENOMEM;
+            return -1;
+        }
+        json_decref (o);
+    }
+    if (flux_respond (h, w->request, lk->payload) < 0) {
+        flux_log_error (h, "%s: flux_respond", __FUNCTION__);
+        return -1;
+    }
+    return 0;
+}
+
 static int handle_compare_response (flux_t *h,
+                                    struct lookup *lk,
                                     struct watcher *w,
                                     json_t *val)
 {
@@ -276,10 +368,8 @@ static int handle_compare_response (flux_t *h,
          * ENOENT case */
         w->prev = json_incref (val);
 
-        if (flux_respond_pack (h, w->request, "{ s:O }", "val", val) < 0) {
-            flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
+        if (respond_val (h, lk, w, val) < 0)
             return -1;
-        }
 
         w->responded = true;
     }
@@ -292,89 +382,75 @@ static int handle_compare_response (flux_t *h,
         json_decref (w->prev);
         w->prev = json_incref (val);
 
-        if (flux_respond_pack (h, w->request, "{ s:O }", "val", val) < 0) {
-            flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
+        if (respond_val (h, lk, w, val) < 0)
             return -1;
-        }
     }
 
     return 0;
 }
 
-static int handle_append_response (flux_t *h,
-                                    struct watcher *w,
-                                    json_t *val)
+/* Get the part of an appended value that has not yet been sent to
+ * watcher 'w'.  Lookups are pipelined, so the KVS returns the data
+ * after the append index known when the lookup was sent, which may be
+ * behind w->append_index.  The KVS also returns the size of each blob,
+ * so the overlap can be skipped without any comparison.
+ *
+ * Note that this does not ensure that the key was not "fake" appended
+ * to, i.e. the key overwritten with more blobs than the original.
+ */
+static json_t *append_tail (flux_future_t *f, struct watcher *w, json_t *val)
 {
-    if (!w->responded) {
-        /* this is the first response case, store the first response
-         * info.  This is here b/c initial response could have been
-         * ENOENT case */
-        if (treeobj_decode_val (val,
-                                NULL,
-                                &w->append_offset) < 0) {
-            flux_log_error (h, "%s: treeobj_decode_val", __FUNCTION__);
-            return -1;
-        }
-
-        if (flux_respond_pack (h, w->request, "{ s:O }", "val", val) < 0) {
-            flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
-            return -1;
-        }
-
-        w->responded = true;
+    const int *start = flux_future_aux_get (f, "append_index");
+    json_t *sizes;
+    json_t *o;
+    size_t index;
+    void *data;
+    int skip;
+    int offset = 0;
+    int len;
+
+    if (!start || flux_rpc_get_unpack (f, "{ s:o }", "sizes", &sizes) < 0) {
+        errno = EPROTO;
+        return NULL;
     }
-    else {
-        json_t *new_val = NULL;
-        void *new_data = NULL;
-        int new_offset;
-
-        if (treeobj_decode_val (val,
-                                &new_data,
-                                &new_offset) < 0) {
-            flux_log_error (h, "%s: treeobj_decode_val", __FUNCTION__);
-            return -1;
-        }
-
-        /* check length to determine if append actually happened, note
-         * that zero length append is legal
-         *
-         * Note that this check does not ensure that the key was not
-         * "fake" appended to.  i.e. the key overwritten with data
-         * longer than the original.
-         */
-        if (new_offset < w->append_offset) {
-            free (new_data);
-            errno = EINVAL;
-            return -1;
-        }
-
-        if (!(new_val = treeobj_create_val (new_data + w->append_offset,
-                                            new_offset - w->append_offset))) {
-            free (new_data);
-            return -1;
-        }
-
-        free (new_data);
-        w->append_offset = new_offset;
-
-        if (flux_respond_pack (h, w->request, "{ s:o }", "val", new_val) < 0) {
-            json_decref (new_val);
-            flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
-            return -1;
-        }
+    skip = w->append_index - *start;
+    if (skip < 0) {
+        errno = EPROTO;
+        return NULL;
     }
-
-    return 0;
+    /* fewer blobs than already sent, the key was overwritten */
+    if ((size_t)skip > json_array_size (sizes)) {
+        errno = EINVAL;
+        return NULL;
+    }
+    w->append_index = *start + json_array_size (sizes);
+    if (skip == 0)
+        return json_incref (val);
+
+    json_array_foreach (sizes, index, o) {
+        if (index == (size_t)skip)
+            break;
+        offset += json_integer_value (o);
+    }
+    if (treeobj_decode_val (val, &data, &len) < 0)
+        return NULL;
+    if (offset > len) {
+        free (data);
+        errno = EPROTO;
+        return NULL;
+    }
+    o = treeobj_create_val ((char *)data + offset, len - offset);
+    ERRNO_SAFE_WRAP (free, data);
+    return o;
 }
 
 static int handle_normal_response (flux_t *h,
+                                   struct lookup *lk,
                                    struct watcher *w,
                                    json_t *val)
 {
-    if (flux_respond_pack (h, w->request, "{ s:O }", "val", val) < 0) {
-        flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
+    if (respond_val (h, lk, w, val) < 0)
         return -1;
-    }
 
     w->responded = true;
     return 0;
@@ -385,15 +461,17 @@ static int handle_normal_response (flux_t *h,
  * Return 0 on success, -1 on error (caller should destroy watcher).
  *
  * Special handling done for FLUX_KVS_WATCH_FULL/UNIQ/APPEND, must do
- * some comparisons before returning.
+ * some comparisons or trim data already sent before returning.
  */
-static void handle_lookup_response (flux_future_t *f,
+static void handle_lookup_response (struct lookup *lk,
                                     struct watcher *w)
 {
+    flux_future_t *f = lk->f;
     flux_t *h = flux_future_get_flux (f);
     int errnum;
     int root_seq;
     json_t *val;
+    json_t *tail = NULL;
 
     if (flux_future_aux_get (f, "initial")) {
 
@@ -436,6 +514,12 @@ static void handle_lookup_response (flux_future_t *f,
             goto error;
         }
 
+        if ((w->flags & FLUX_KVS_WATCH_APPEND)) {
+            if (!(tail = append_tail (f, w, val)))
+                goto error;
+            val = tail;
+        }
+
         if (handle_initial_response (h, w, val, root_seq) < 0)
             goto error;
     }
@@ -453,51 +537,57 @@ static void handle_lookup_response (flux_future_t *f,
                                  "val", &val,
                                  "rootseq", &root_seq) < 0)
             goto error;
+        lk->val = val;
 
         /* if we got some setroots before the initial rpc returned,
          * toss them */
         if (root_seq <= w->initial_rootseq)
             return;
 
+        if ((w->flags & FLUX_KVS_WATCH_APPEND)) {
+            if (!(tail = append_tail (f, w, val)))
+                goto error;
+            val = tail;
+        }
+
         if (!w->mute) {
             if ((w->flags & FLUX_KVS_WATCH_FULL)
                 || (w->flags & FLUX_KVS_WATCH_UNIQ)) {
-                if (handle_compare_response (h, w, val) < 0)
-                    goto error;
-            }
-            else if (w->flags & FLUX_KVS_WATCH_APPEND) {
-                if (handle_append_response (h, w, val) < 0)
+                if (handle_compare_response (h, lk, w, val) < 0)
                     goto error;
             }
             else {
-                if (handle_normal_response (h, w, val) < 0)
+                if (handle_normal_response (h, lk, w, val) < 0)
                     goto error;
             }
         }
     }
+    json_decref (tail);
     return;
 error:
     if (!w->mute) {
         if (flux_respond_error (h, w->request, errno, NULL) < 0)
             flux_log_error (h, "%s: flux_respond_error", __FUNCTION__);
     }
+    json_decref (tail);
     w->finished = true;
 }
 
-/* One lookup has completed.
- * Pop ready futures off w->lookups and send responses, until
- * the list is empty, or a non-ready future is encountered.
+/* A lookup has completed for watcher 'w'.
+ * Pop ready lookups off w->lookups and send responses, until
+ * the list is empty, or a non-ready lookup is encountered.
  */
-static void lookup_continuation (flux_future_t *f, void *arg)
+static void watcher_lookup_ready (struct watcher *w)
 {
-    struct watcher *w = arg;
     struct ns_monitor *nsm = w->nsm;
+    struct lookup *lk;
 
-    while ((f = zlist_first (w->lookups)) && flux_future_is_ready (f)) {
-        f = zlist_pop (w->lookups);
+    while ((lk = zlist_first (w->lookups)) && flux_future_is_ready (lk->f)) {
+        lk = zlist_pop (w->lookups);
+        zlist_remove (lk->watchers, w);
         if (!w->finished)
-            handle_lookup_response (f, w);
-        flux_future_destroy (f);
+            handle_lookup_response (lk, w);
+        lookup_decref (lk);
         /* if WAITCREATE and !WATCH, then we only care about sending
          * one response and being done.  We can use the responded flag
          * to indicate that condition.
@@ -511,12 +601,37 @@ static void lookup_continuation (flux_future_t *f, void *arg)
         watcher_cleanup (nsm, w);
 }
 
+/* A lookup has completed.  Stop sharing it, since a later commit will
+ * need a new lookup, then notify its watchers.  Each watcher may only
+ * destroy itself (or the namespace, after the last watcher), so a copy
+ * of the watcher list can be walked safely.
+ */
+static void lookup_continuation (flux_future_t *f, void *arg)
+{
+    struct lookup *lk = arg;
+    zlist_t *watchers;
+    struct watcher *w;
+
+    lookup_unshare (lk);
+    if (!(watchers = zlist_dup (lk->watchers))) {
+        flux_log (flux_future_get_flux (f), LOG_ERR, "out of memory");
+        return;
+    }
+    lookup_incref (lk);
+    while ((w = zlist_pop (watchers)))
+        watcher_lookup_ready (w);
+    lookup_decref (lk);
+    zlist_destroy (&watchers);
+}
+
 /* Like flux_kvs_lookupat() except:
  * - targets kvs.lookup-plus, so root_ref & root_seq are available in
  *   response
  * - blobref param replaces treeobj
  * - namespace param (ignores namespace associated with flux_t handle)
  * - cred params (see N.B. below)
+ * - for FLUX_KVS_WATCH_APPEND, only data after w->append_index blobs
+ *   is requested, see append_tail()
  * Use flux_rpc_get() not flux_kvs_lookup_get() to access the response.
  */
 static flux_future_t *lookupat (flux_t *h,
@@ -527,28 +642,41 @@ static flux_future_t *lookupat (flux_t *h,
 {
     flux_msg_t *msg;
     json_t *o = NULL;
+    json_t *payload = NULL;
     flux_future_t *f;
+    int *append_index = NULL;
     int saved_errno;
 
     if (!(msg = flux_request_encode ("kvs.lookup-plus", NULL)))
         return NULL;
     if (!w->initial_rpc_sent) {
-        if (flux_msg_pack (msg, "{s:s s:s s:i}",
-                           "key", w->key,
-                           "namespace", ns,
-                           "flags", w->flags) < 0)
-            goto error;
+        if (!(payload = json_pack ("{s:s s:s s:i}",
+                                   "key", w->key,
+                                   "namespace", ns,
+                                   "flags", w->flags)))
+            goto error_nomem;
     }
     else {
         if (!(o = treeobj_create_dirref (blobref)))
             goto error;
-        if (flux_msg_pack (msg, "{s:s s:i s:i s:O}",
-                           "key", w->key,
-                           "flags", w->flags,
-                           "rootseq", root_seq,
-                           "rootdir", o) < 0)
+        if (!(payload = json_pack ("{s:s s:i s:i s:O}",
+                                   "key", w->key,
+                                   "flags", w->flags,
+                                   "rootseq", root_seq,
+                                   "rootdir", o)))
+            goto error_nomem;
+    }
+    if ((w->flags & FLUX_KVS_WATCH_APPEND)) {
+        if (!(append_index = malloc (sizeof (*append_index))))
             goto error;
+        *append_index = w->append_index;
+        if (json_object_set_new (payload,
+                                 "append_index",
+                                 json_integer (*append_index)) < 0)
+            goto error_nomem;
     }
+    if (flux_msg_pack (msg, "O", payload) < 0)
+        goto error;
     /* N.B. Since this module is authenticated to the shmem:// connector
      * with FLUX_ROLE_OWNER, we are allowed to switch the message credentials
      * in this request message, and not be overridden at the connector,
@@ -566,40 +694,112 @@ static flux_future_t *lookupat (flux_t *h,
             goto error;
         }
     }
+    if (append_index) {
+        if (flux_future_aux_set (f, "append_index", append_index, free) < 0) {
+            flux_future_destroy (f);
+            goto error;
+        }
+        append_index = NULL;
+    }
     w->initial_rpc_sent = true;
     flux_msg_destroy (msg);
+    json_decref (payload);
     json_decref (o);
     return f;
+error_nomem:
+    errno = ENOMEM;
 error:
     saved_errno = errno;
+    free (append_index);
+    json_decref (payload);
     json_decref (o);
     flux_msg_destroy (msg);
     errno = saved_errno;
     return NULL;
 }
 
-static int process_lookup_response (struct ns_monitor *nsm, struct watcher *w)
+/* Watchers that send the same request at the same commit share one
+ * lookup.  Initial lookups are not shared since they are made against
+ * the namespace rather than a specific root.
+ */
+static char *lookup_id (struct ns_monitor *nsm, struct watcher *w)
+{
+    char *id;
+
+    if (asprintf (&id,
+                  "%d:%d:%d:%ju:%ju:%s",
+                  nsm->commit->rootseq,
+                  w->flags,
+                  (w->flags & FLUX_KVS_WATCH_APPEND) ? w->append_index : 0,
+                  (uintmax_t)w->cred.userid,
+                  (uintmax_t)w->cred.rolemask,
+                  w->key) < 0)
+        return NULL;
+    return id;
+}
+
+static struct lookup *lookup_start (struct ns_monitor *nsm,
+                                    struct watcher *w,
+                                    char *id)
 {
     flux_future_t *f;
+    struct lookup *lk;
+
     if (!(f = lookupat (nsm->ctx->h,
                         w,
                         nsm->commit->rootref,
                         nsm->commit->rootseq,
                         nsm->ns_name))) {
         flux_log_error (nsm->ctx->h, "%s: lookupat", __FUNCTION__);
-        return -1;
+        return NULL;
     }
-    if (zlist_append (w->lookups, f) < 0) {
+    if (!(lk = lookup_create (f))) {
         flux_future_destroy (f);
-        errno = ENOMEM;
-        return -1;
+        return NULL;
     }
-    if (flux_future_then (f, -1., lookup_continuation, w) < 0) {
-        flux_future_destroy (f);
-        return -1;
+    if (flux_future_then (f, -1., lookup_continuation, lk) < 0)
+        goto error;
+    if (id) {
+        if (!(lk->id = strdup (id)))
+            goto error;
+        if (zhash_insert (nsm->lookups, id, lk) < 0) {
+            errno = EEXIST;
+            goto error;
+        }
+        lk->nsm = nsm;
+    }
+    return lk;
+error:
+    lookup_decref (lk);
+    return NULL;
+}
+
+static int process_lookup_response (struct ns_monitor *nsm, struct watcher *w)
+{
+    struct lookup *lk = NULL;
+    char *id = NULL;
+
+    if (w->initial_rpc_sent) {
+        if (!(id = lookup_id (nsm, w)))
+            return -1;
+        if ((lk = lookup_incref (zhash_lookup (nsm->lookups, id))))
+            nsm->ctx->shared_lookups++;
+    }
+    if (!lk && !(lk = lookup_start (nsm, w, id)))
+        goto error;
+    if (zlist_append (w->lookups, lk) < 0
+        || zlist_append (lk->watchers, w) < 0) {
+        zlist_remove (w->lookups, lk);
+        lookup_decref (lk);
+        errno = ENOMEM;
+        goto error;
     }
     w->rootseq = nsm->commit->rootseq;
+    free (id);
     return 0;
+error:
+    ERRNO_SAFE_WRAP (free, id);
+    return -1;
 }
 
 /* Respond to watcher request, if appropriate.
@@ -1057,8 +1257,9 @@ static void stats_cb (flux_t *h, flux_msg_handler_t *mh,
         watchers += zlistx_size (nsm->watchers);
         nsm = zhash_next (ctx->namespaces);
     }
-    if (flux_respond_pack (h, msg, "{s:i s:i s:O}",
+    if (flux_respond_pack (h, msg, "{s:i s:i s:i s:O}",
                            "watchers", watchers,
+                           "shared-lookups", ctx->shared_lookups,
                            "namespace-count", (int)zhash_size (ctx->namespaces),
                            "namespaces", stats) < 0)
         flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
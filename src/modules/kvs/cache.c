@@ -29,9 +29,9 @@
 #include "src/common/libccan/ccan/list/list.h"
 #include "src/common/libkvs/treeobj.h"
 #include "src/common/libutil/blobref.h"
+#include "src/common/libutil/hashmap.h"
 #include "src/common/libutil/tstat.h"
 #include "src/common/libutil/log.h"
-#include "src/common/libutil/iterators.h"
 #include "src/common/libkvs/kvs_util_private.h"
 
 #include "waitqueue.h"
@@ -49,29 +49,95 @@ struct cache_entry {
                              * zero length data can be valid */
     bool dirty;
     int errnum;
-    char *blobref;
+    char blobref[BLOBREF_MAX_STRING_SIZE];
     int refcount;
     struct list_node entries_node;
     struct list_head *notdirty_list;
     struct list_node notdirty_node;
     struct list_head *valid_list;
     struct list_node valid_node;
+    struct cache *cache;    /* set while entry is in a cache */
+    size_t size;            /* bytes charged to cache->resident */
 };
 
 struct cache {
     flux_reactor_t *r;
     double fake_time;       /* -1. for invalid */
-    zhashx_t *zhx;
+    struct hashmap *entries;    /* entries by blobref */
     /* entries_list is for fast iteration through entries, faster than
-     * using zhashx iterators or zhashx_keys() */
+     * using hashmap iterators */
     struct list_head entries_list;
     /* list of entries with notdirty & valid waitqueue's with messages
      * on them.  These lists are used to avoid excess iteration
-     * through zhx */
+     * through entries */
     struct list_head notdirty_list;
     struct list_head valid_list;
+    /* entries_list is kept in LRU order (most recently used at the head)
+     * so entries can be evicted from the tail when 'resident' exceeds
+     * 'max_size'.  A max_size of zero means unlimited.
+     */
+    size_t resident;
+    size_t max_size;
+    struct cache_counters counters;
+    /* resolved directory references keyed by "root_ref/path".  Since a
+     * root reference names an immutable snapshot, entries never become
+     * stale.  The table is purged when it reaches path_max entries.
+     */
+    zhashx_t *paths;
+    int path_max;
 };
 
+/* Limit the number of entries examined by one eviction pass, so that an
+ * insert stays cheap when the tail of the LRU list is pinned by dirty,
+ * incomplete, or referenced entries.
+ */
+static const int evict_scan_max = 64;
+
+/* Rough estimate of the memory used by a decoded json object.  The
+ * constant approximates the jansson allocation for each value.
+ */
+static size_t json_size_estimate (json_t *o)
+{
+    size_t size = 64;
+
+    switch (json_typeof (o)) {
+        case JSON_OBJECT: {
+            const char *key;
+            json_t *value;
+            json_object_foreach (o, key, value)
+                size += strlen (key) + 32 + json_size_estimate (value);
+            break;
+        }
+        case JSON_ARRAY: {
+            size_t index;
+            json_t *value;
+            json_array_foreach (o, index, value)
+                size += sizeof (json_t *) + json_size_estimate (value);
+            break;
+        }
+        case JSON_STRING:
+            size += json_string_length (o);
+            break;
+        default:
+            break;
+    }
+    return size;
+}
+
+/* Recompute the bytes held by 'entry' and update the resident total of
+ * the cache it belongs to, if any.
+ */
+static void cache_entry_account (struct cache_entry *entry)
+{
+    size_t size = entry->len;
+
+    if (entry->o)
+        size += json_size_estimate (entry->o);
+    if (entry->cache)
+        entry->cache->resident += size - entry->size;
+    entry->size = size;
+}
+
 static double cache_now (struct cache *cache)
 {
     if (cache->fake_time >= 0.)
@@ -85,7 +151,7 @@ struct cache_entry *cache_entry_create (const char *ref)
 {
     struct cache_entry *entry;
 
-    if (!ref) {
+    if (!ref || strlen (ref) >= sizeof (entry->blobref)) {
         errno = EINVAL;
         return NULL;
     }
@@ -93,10 +159,7 @@ struct cache_entry *cache_entry_create (const char *ref)
     if (!(entry = calloc (1, sizeof (*entry))))
         return NULL;
 
-    if (!(entry->blobref = strdup (ref))) {
-        cache_entry_destroy (entry);
-        return NULL;
-    }
+    strcpy (entry->blobref, ref);
 
     list_node_init (&entry->entries_node);
     list_node_init (&entry->notdirty_node);
@@ -216,6 +279,7 @@ int cache_entry_set_raw (struct cache_entry *entry, const void *data, int len)
     entry->data = cpy;
     entry->len = len;
     entry->valid = true;
+    cache_entry_account (entry);
     if (entry->waitlist_valid) {
         if (wait_runqueue (entry->waitlist_valid) < 0)
             goto reset_invalid;
@@ -228,6 +292,7 @@ reset_invalid:
     entry->data = NULL;
     entry->len = 0;
     entry->valid = false;
+    cache_entry_account (entry);
     return -1;
 }
 
@@ -288,6 +353,7 @@ const json_t *cache_entry_get_treeobj (struct cache_entry *entry)
     if (!entry->o) {
         if (!(entry->o = treeobj_decodeb (entry->data, entry->len)))
             return NULL;
+        cache_entry_account (entry);
     }
     return entry->o;
 }
@@ -307,7 +373,6 @@ void cache_entry_destroy (void *arg)
             wait_queue_destroy (entry->waitlist_valid);
             list_del (&entry->valid_node);
         }
-        free (entry->blobref);
         free (entry);
         errno = saved_errno;
     }
@@ -356,20 +421,74 @@ int cache_entry_wait_valid (struct cache_entry *entry, wait_t *wait)
 
 struct cache_entry *cache_lookup (struct cache *cache, const char *ref)
 {
-    struct cache_entry *entry = zhashx_lookup (cache->zhx, ref);
+    struct cache_entry *entry = hashmap_lookup (cache->entries, ref);
     double current_time = cache_now (cache);
-    if (entry && current_time > entry->lastuse_time)
-        entry->lastuse_time = current_time;
+
+    if (entry) {
+        if (current_time > entry->lastuse_time)
+            entry->lastuse_time = current_time;
+        if (entry->valid)
+            cache->counters.hits++;
+        else
+            cache->counters.misses++;
+        /* move to the head of the LRU list */
+        list_del (&entry->entries_node);
+        list_add (&cache->entries_list, &entry->entries_node);
+    }
+    else
+        cache->counters.misses++;
     return entry;
 }
 
-int cache_insert (struct cache *cache, struct cache_entry *entry)
+static void cache_entry_remove (struct cache *cache, struct cache_entry *entry)
 {
-    int rc;
+    list_del (&entry->entries_node);
+    cache->resident -= entry->size;
+    entry->cache = NULL;
+    hashmap_delete (cache->entries, entry->blobref);
+}
+
+static bool cache_entry_evictable (struct cache_entry *entry)
+{
+    return (entry->valid
+            && !entry->dirty
+            && !entry->refcount
+            && (!entry->waitlist_notdirty
+                || !wait_queue_length (entry->waitlist_notdirty))
+            && (!entry->waitlist_valid
+                || !wait_queue_length (entry->waitlist_valid)));
+}
+
+/* Evict least recently used entries until the cache is within its
+ * budget, skipping 'keep' and any entry that is not evictable.
+ */
+static void cache_evict (struct cache *cache, struct cache_entry *keep)
+{
+    struct cache_entry *entry = NULL;
+    struct cache_entry *prev = NULL;
+    int scanned = 0;
+
+    if (cache->max_size == 0)
+        return;
+    list_for_each_rev_safe (&cache->entries_list, entry, prev, entries_node) {
+        if (cache->resident <= cache->max_size
+            || scanned++ >= evict_scan_max)
+            break;
+        if (entry != keep && cache_entry_evictable (entry)) {
+            cache_entry_remove (cache, entry);
+            cache->counters.evictions++;
+        }
+    }
+}
 
+int cache_insert (struct cache *cache, struct cache_entry *entry)
+{
     if (cache && entry) {
-        rc = zhashx_insert (cache->zhx, entry->blobref, entry);
+        if (hashmap_insert (cache->entries, entry->blobref, entry) < 0)
+            return -1;
         list_add (&cache->entries_list, &entry->entries_node);
+        entry->cache = cache;
+        cache->resident += entry->size;
         entry->notdirty_list = &cache->notdirty_list;
         entry->valid_list = &cache->valid_list;
         if (entry->waitlist_notdirty
@@ -378,14 +497,14 @@ int cache_insert (struct cache *cache, struct cache_entry *entry)
         if (entry->waitlist_valid
             && wait_queue_msgs_count (entry->waitlist_valid) > 0)
             list_add (entry->valid_list, &entry->valid_node);
-        assert (rc == 0);
+        cache_evict (cache, entry);
     }
     return 0;
 }
 
 int cache_remove_entry (struct cache *cache, const char *ref)
 {
-    struct cache_entry *entry = zhashx_lookup (cache->zhx, ref);
+    struct cache_entry *entry = hashmap_lookup (cache->entries, ref);
 
     if (entry
         && !entry->dirty
@@ -393,8 +512,7 @@ int cache_remove_entry (struct cache *cache, const char *ref)
             || !wait_queue_length (entry->waitlist_notdirty))
         && (!entry->waitlist_valid
             || !wait_queue_length (entry->waitlist_valid))) {
-        list_del (&entry->entries_node);
-        zhashx_delete (cache->zhx, ref);
+        cache_entry_remove (cache, entry);
         return 1;
     }
     return 0;
@@ -402,7 +520,7 @@ int cache_remove_entry (struct cache *cache, const char *ref)
 
 int cache_count_entries (struct cache *cache)
 {
-    return zhashx_size (cache->zhx);
+    return hashmap_size (cache->entries);
 }
 
 static int cache_entry_age (struct cache_entry *entry, struct cache *cache)
@@ -427,11 +545,13 @@ int cache_expire_entries (struct cache *cache, double thresh)
             && !entry->refcount
             && (thresh == 0.
                     || cache_entry_age (entry, cache) > thresh)) {
-                list_del (&entry->entries_node);
-                zhashx_delete (cache->zhx, entry->blobref);
+                cache_entry_remove (cache, entry);
                 count++;
         }
     }
+    if (thresh == 0.)
+        zhashx_purge (cache->paths);
+    cache->counters.expirations += count;
     return count;
 }
 
@@ -439,12 +559,11 @@ int cache_get_stats (struct cache *cache, tstat_t *ts, int *sizep,
                      int *incompletep, int *dirtyp)
 {
     struct cache_entry *entry;
-    const char *key;
     int size = 0;
     int incomplete = 0;
     int dirty = 0;
 
-    FOREACH_ZHASHX (cache->zhx, key, entry) {
+    list_for_each (&cache->entries_list, entry, entries_node) {
         if (cache_entry_get_valid (entry)) {
             int obj_size = 0;
 
@@ -490,6 +609,111 @@ done:
     return rc;
 }
 
+void cache_set_max_size (struct cache *cache, size_t max_size)
+{
+    if (cache) {
+        cache->max_size = max_size;
+        cache_evict (cache, NULL);
+    }
+}
+
+size_t cache_get_max_size (struct cache *cache)
+{
+    return cache ? cache->max_size : 0;
+}
+
+size_t cache_get_resident_size (struct cache *cache)
+{
+    return cache ? cache->resident : 0;
+}
+
+void cache_get_counters (struct cache *cache, struct cache_counters *counters)
+{
+    if (cache && counters)
+        *counters = cache->counters;
+}
+
+void cache_clear_counters (struct cache *cache)
+{
+    if (cache)
+        memset (&cache->counters, 0, sizeof (cache->counters));
+}
+
+static char *path_key (const char *root_ref, const char *path, int len)
+{
+    char *key;
+
+    if (asprintf (&key, "%s/%.*s", root_ref, len, path) < 0)
+        return NULL;
+    return key;
+}
+
+const char *cache_path_lookup (struct cache *cache,
+                               const char *root_ref,
+                               const char *path,
+                               int len)
+{
+    char *key;
+    const char *ref;
+
+    if (!cache || !root_ref || !path || len < 0)
+        return NULL;
+    if (!(key = path_key (root_ref, path, len)))
+        return NULL;
+    if ((ref = zhashx_lookup (cache->paths, key)))
+        cache->counters.path_hits++;
+    free (key);
+    return ref;
+}
+
+int cache_path_insert (struct cache *cache,
+                       const char *root_ref,
+                       const char *path,
+                       int len,
+                       const char *ref)
+{
+    char *key;
+    char *cpy;
+
+    if (!cache || !root_ref || !path || len < 0 || !ref) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (cache->path_max == 0)
+        return 0;
+    if (!(key = path_key (root_ref, path, len)))
+        return -1;
+    if (!(cpy = strdup (ref))) {
+        free (key);
+        return -1;
+    }
+    if (zhashx_size (cache->paths) >= cache->path_max)
+        zhashx_purge (cache->paths);
+    zhashx_update (cache->paths, key, cpy);
+    free (key);
+    return 0;
+}
+
+void cache_path_set_max (struct cache *cache, int max)
+{
+    if (cache && max >= 0) {
+        cache->path_max = max;
+        if (zhashx_size (cache->paths) > max)
+            zhashx_purge (cache->paths);
+    }
+}
+
+void cache_path_purge (struct cache *cache)
+{
+    if (cache)
+        zhashx_purge (cache->paths);
+}
+
+int cache_path_count (struct cache *cache)
+{
+    return cache ? zhashx_size (cache->paths) : 0;
+}
+
 const char *cache_entry_get_blobref (struct cache_entry *entry)
 {
     return entry ? entry->blobref : NULL;
@@ -503,22 +727,35 @@ static void cache_entry_destroy_wrapper (void **arg)
     }
 }
 
+static void path_ref_destroy (void **item)
+{
+    if (item) {
+        free (*item);
+        *item = NULL;
+    }
+}
+
 struct cache *cache_create (flux_reactor_t *r)
 {
     struct cache *cache = calloc (1, sizeof (*cache));
     if (!cache)
         return NULL;
-    if (!(cache->zhx = zhashx_new ())) {
+    cache->entries = hashmap_create_string (BLOBREF_MAX_STRING_SIZE - 1);
+    if (!cache->entries) {
+        free (cache);
+        return NULL;
+    }
+    if (!(cache->paths = zhashx_new ())) {
+        hashmap_destroy (cache->entries);
         free (cache);
         errno = ENOMEM;
         return NULL;
     }
+    zhashx_set_destructor (cache->paths, path_ref_destroy);
+    cache->path_max = CACHE_PATH_MAX_DEFAULT;
     cache->r = r;
     cache->fake_time = -1.;
-    /* do not duplicate hash keys, use blobrefs stored in cache entry */
-    zhashx_set_key_destructor (cache->zhx, NULL);
-    zhashx_set_key_duplicator (cache->zhx, NULL);
-    zhashx_set_destructor (cache->zhx, cache_entry_destroy_wrapper);
+    hashmap_set_destructor (cache->entries, cache_entry_destroy_wrapper);
     list_head_init (&cache->entries_list);
     list_head_init (&cache->notdirty_list);
     list_head_init (&cache->valid_list);
@@ -528,7 +765,8 @@ struct cache *cache_create (flux_reactor_t *r)
 void cache_destroy (struct cache *cache)
 {
     if (cache) {
-        zhashx_destroy (&cache->zhx);
+        hashmap_destroy (cache->entries);
+        zhashx_destroy (&cache->paths);
         free (cache);
     }
 }
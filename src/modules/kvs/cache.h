@@ -19,6 +19,16 @@
 struct cache_entry;
 struct cache;
 
+struct cache_counters {
+    unsigned long hits;         /* lookups that found a valid entry */
+    unsigned long misses;       /* lookups that found no or an invalid entry */
+    unsigned long evictions;    /* entries removed to stay within max size */
+    unsigned long expirations;  /* entries removed by cache_expire_entries() */
+    unsigned long path_hits;    /* successful cache_path_lookup() calls */
+};
+
+#define CACHE_PATH_MAX_DEFAULT 8192
+
 
 /* Create/destroy cache entry.
  *
@@ -117,13 +127,16 @@ struct cache *cache_create (flux_reactor_t *r);
 void cache_destroy (struct cache *cache);
 
 /* Look up a cache entry.
- * Update the cache entry's "last used" time.
+ * Update the cache entry's "last used" time and LRU position.
  */
 struct cache_entry *cache_lookup (struct cache *cache, const char *ref);
 
 /* Insert entry in the cache.  Reference for entry created during
  * cache_entry_create() time.  Ownership of the cache entry is
- * transferred to the cache.
+ * transferred to the cache.  If the cache is over its maximum size,
+ * least recently used entries that are valid, not dirty, unreferenced,
+ * and have no waiters are evicted.  The inserted entry is never evicted
+ * by the insert itself.
  */
 int cache_insert (struct cache *cache, struct cache_entry *entry);
 
@@ -140,7 +153,7 @@ int cache_count_entries (struct cache *cache);
 
 /* Expire cache entries that are not dirty, not incomplete, and last
  * used more than 'max_age' seconds ago.  If max_age == 0, expire all
- * entries that are not dirty/incomplete.
+ * entries that are not dirty/incomplete, and drop all path mappings.
  * Returns -1 on error, expired count on success.
  */
 int cache_expire_entries (struct cache *cache, double max_age);
@@ -151,6 +164,44 @@ int cache_expire_entries (struct cache *cache, double max_age);
 int cache_get_stats (struct cache *cache, tstat_t *ts, int *size,
                      int *incomplete, int *dirty);
 
+/* Set the maximum number of bytes (raw data plus estimated decoded
+ * treeobj size) the cache should hold, evicting entries if necessary.
+ * Zero means unlimited, which is the default.  Entries that cannot be
+ * evicted may cause the cache to temporarily exceed this size.
+ */
+void cache_set_max_size (struct cache *cache, size_t max_size);
+size_t cache_get_max_size (struct cache *cache);
+
+/* Return the number of bytes currently charged to the cache.
+ */
+size_t cache_get_resident_size (struct cache *cache);
+
+/* Get/clear lookup and removal counters.
+ */
+void cache_get_counters (struct cache *cache, struct cache_counters *counters);
+void cache_clear_counters (struct cache *cache);
+
+/* Map the first 'len' bytes of 'path' under 'root_ref' to the blobref
+ * of the directory it resolves to, so later lookups under the same root
+ * can skip walking the leading path components.  Only paths that resolve
+ * without following symlinks should be inserted, since a symlink may
+ * point into another namespace.  When the table holds the maximum number
+ * of mappings (default CACHE_PATH_MAX_DEFAULT, 0 disables) it is purged.
+ * cache_path_lookup() returns NULL if there is no mapping.
+ */
+const char *cache_path_lookup (struct cache *cache,
+                               const char *root_ref,
+                               const char *path,
+                               int len);
+int cache_path_insert (struct cache *cache,
+                       const char *root_ref,
+                       const char *path,
+                       int len,
+                       const char *ref);
+void cache_path_set_max (struct cache *cache, int max);
+void cache_path_purge (struct cache *cache);
+int cache_path_count (struct cache *cache);
+
 /* Destroy wait_t's on the waitqueue_t of any cache entry
  * if they meet match criteria.
  */
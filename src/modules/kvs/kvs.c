@@ -25,11 +25,13 @@
 
 #include "src/common/libczmqcontainers/czmq_containers.h"
 #include "src/common/libccan/ccan/list/list.h"
+#include "src/common/libccan/ccan/base64/base64.h"
 #include "src/common/libutil/blobref.h"
 #include "src/common/libutil/monotime.h"
 #include "src/common/libutil/tstat.h"
 #include "src/common/libutil/timestamp.h"
 #include "src/common/libutil/errprintf.h"
+#include "src/common/libutil/parse_size.h"
 #include "src/common/libkvs/treeobj.h"
 #include "src/common/libkvs/kvs_checkpoint.h"
 #include "src/common/libkvs/kvs_txn_private.h"
@@ -46,11 +48,13 @@
 #include "kvsroot.h"
 #include "kvs_wait_version.h"
 #include "kvs_checkpoint.h"
+#include "topn.h"
 
 /* heartbeat_sync_cb() is called periodically to manage cached content
  * and namespaces.  Synchronize with the system heartbeat if possible,
  * but keep the time between checks bounded by 'heartbeat_sync_min'
- * and 'heartbeat_sync_max' seconds.
+ * and 'heartbeat_sync_max' seconds.  Each call is delayed by a random
+ * fraction of the heartbeat period to spread the work across ranks.
  */
 const double heartbeat_sync_min = 1.;
 const double heartbeat_sync_max = 30.;
@@ -63,6 +67,55 @@ const double max_lastuse_age = 10.;
  */
 const double max_namespace_age = 3600.;
 
+/* Dirty cache entries are flushed to the content store in batches of up
+ * to 'store_batch_max_count' blobs or 'store_batch_max_size' bytes, with
+ * at most 'store_window' batch requests in flight.
+ */
+#define STORE_BATCH_MAX_COUNT 256
+const size_t store_batch_max_size = 4*1024*1024;
+const int store_window = 8;
+
+/* Each pass of transaction_check_cb() gives every namespace with a ready
+ * transaction one turn, round robin, but yields to the reactor once
+ * 'transaction_pass_budget' seconds have elapsed, so requests keep being
+ * serviced when many namespaces (e.g. guest namespaces of running jobs)
+ * are committing at once.  The remaining namespaces go first next pass.
+ */
+const double transaction_pass_budget = 0.01;
+
+/* Up to 'PREFETCH_MAX' blobs of a listed directory's entries are hinted
+ * to the content cache.
+ */
+#define PREFETCH_MAX 256
+
+/* A kvs.lookup-stream request hints up to 'STREAM_PREFETCH_MAX' blobs
+ * ahead of the one being sent.
+ */
+#define STREAM_PREFETCH_MAX 8
+
+/* Fence participants relayed through a non-zero rank are merged by
+ * namespace and name for up to 'relayfence_delay' seconds, or until all
+ * of the fence's participants have arrived, then sent upstream as one
+ * kvs.relayfence request, so rank 0 receives O(fanout) requests per fence.
+ */
+const double relayfence_delay = 0.001;
+
+/* One in 'top-sample' lookups and commits handled by this broker is
+ * counted in approximate top-N tables of namespaces, key prefixes (the
+ * key's parent directory), and userids, each holding up to 'top-size'
+ * entries, to help find the source of heavy KVS load.  See topn.h.
+ */
+#define TOP_SIZE_DEFAULT 32
+#define TOP_SAMPLE_DEFAULT 16
+
+struct store_batch {
+    int count;
+    size_t size;
+    struct iovec iov[STORE_BATCH_MAX_COUNT];
+    const char *blobref[STORE_BATCH_MAX_COUNT];
+    struct list_node node;
+};
+
 struct kvs_ctx {
     struct cache *cache;    /* blobref => cache_entry */
     kvsroot_mgr_t *krm;
@@ -72,12 +125,58 @@ struct kvs_ctx {
     flux_watcher_t *prep_w;
     flux_watcher_t *idle_w;
     flux_watcher_t *check_w;
+    struct flux_msglist *gc_requests;   /* kvs.gc-begin awaiting drain */
     int transaction_merge;
     bool events_init;            /* flag */
+    bool subscribe_all;          /* one subscription for all namespaces */
     char *hash_name;
     unsigned int seq;           /* for commit transactions */
     kvs_checkpoint_t *kcp;
     struct list_head work_queue;
+    struct list_head store_queue;   /* batches not yet sent */
+    int store_inflight;             /* batches sent, awaiting response */
+    struct list_head getroot_pending;   /* getroot RPCs in flight */
+    struct getroot_stats {
+        uint64_t rpcs;          /* kvs.getroot RPCs sent upstream */
+        uint64_t coalesced;     /* requests that joined one in flight */
+        uint64_t prefetched;    /* roots created from namespace events */
+    } getroot_stats;
+    struct list_head relayfence_pending;    /* merged, not yet sent */
+    flux_watcher_t *relayfence_w;
+    struct relayfence_stats {
+        uint64_t participants;  /* fence participants relayed upstream */
+        uint64_t rpcs;          /* kvs.relayfence RPCs sent upstream */
+    } relayfence_stats;
+    struct top {
+        int size;               /* 0 = disabled */
+        int sample;
+        unsigned int counter;
+        struct topn *ns;
+        struct topn *prefix;
+        struct topn *userid;
+    } top;
+};
+
+/* Fence participants from this broker's subtree awaiting relay upstream.
+ */
+struct relayfence {
+    char *ns;
+    char *name;
+    int flags;
+    int nprocs;
+    int count;                  /* participants merged */
+    json_t *ops;
+    struct flux_msg_cred cred;  /* of the last participant */
+    struct list_node node;
+};
+
+/* Requests for a namespace unknown on this rank wait on one getroot RPC.
+ */
+struct getroot_pending {
+    char *ns;
+    flux_future_t *f;
+    struct flux_msglist *requests;  /* copies of the waiting requests */
+    struct list_node node;
 };
 
 struct kvs_cb_data {
@@ -96,32 +195,50 @@ static void start_root_remove (struct kvs_ctx *ctx, const char *ns);
 static void work_queue_check_append (struct kvs_ctx *ctx,
                                      struct kvsroot *root);
 static void kvstxn_apply (kvstxn_t *kt);
+static void gc_begin_check (struct kvs_ctx *ctx);
 
 /*
  * kvs_ctx functions
  */
+static void getroot_pending_destroy (struct getroot_pending *gp);
+static void relayfence_destroy (struct relayfence *rf);
+
 static void kvs_ctx_destroy (struct kvs_ctx *ctx)
 {
     if (ctx) {
         int saved_errno = errno;
+        struct store_batch *batch, *next;
+        struct getroot_pending *gp, *gp_next;
+        struct relayfence *rf, *rf_next;
+        list_for_each_safe (&ctx->getroot_pending, gp, gp_next, node)
+            getroot_pending_destroy (gp);
+        list_for_each_safe (&ctx->relayfence_pending, rf, rf_next, node)
+            relayfence_destroy (rf);
+        flux_watcher_destroy (ctx->relayfence_w);
+        topn_destroy (ctx->top.ns);
+        topn_destroy (ctx->top.prefix);
+        topn_destroy (ctx->top.userid);
         cache_destroy (ctx->cache);
         kvsroot_mgr_destroy (ctx->krm);
         flux_watcher_destroy (ctx->prep_w);
         flux_watcher_destroy (ctx->check_w);
         flux_watcher_destroy (ctx->idle_w);
+        flux_msglist_destroy (ctx->gc_requests);
         kvs_checkpoint_destroy (ctx->kcp);
         free (ctx->hash_name);
+        list_for_each_safe (&ctx->store_queue, batch, next, node) {
+            list_del (&batch->node);
+            free (batch);
+        }
         free (ctx);
         errno = saved_errno;
     }
 }
 
-static void work_queue_check_append_wrapper (struct kvsroot *root,
-                                             void *arg)
-{
-    struct kvs_ctx *ctx = arg;
-    work_queue_check_append (ctx, root);
-}
+static void relayfence_timer_cb (flux_reactor_t *r,
+                                 flux_watcher_t *w,
+                                 int revents,
+                                 void *arg);
 
 static struct kvs_ctx *kvs_ctx_create (flux_t *h)
 {
@@ -132,6 +249,10 @@ static struct kvs_ctx *kvs_ctx_create (flux_t *h)
     if (!(ctx = calloc (1, sizeof (*ctx))))
         return NULL;
     ctx->h = h;
+    list_head_init (&ctx->work_queue);
+    list_head_init (&ctx->store_queue);
+    list_head_init (&ctx->getroot_pending);
+    list_head_init (&ctx->relayfence_pending);
     if (!(s = flux_attr_get (h, "content.hash"))
         || !(ctx->hash_name = strdup (s))) {
         flux_log_error (h, "getattr content.hash");
@@ -141,8 +262,19 @@ static struct kvs_ctx *kvs_ctx_create (flux_t *h)
         goto error;
     if (!(ctx->krm = kvsroot_mgr_create (ctx->h, ctx)))
         goto error;
+    if (!(ctx->gc_requests = flux_msglist_create ()))
+        goto error;
     if (flux_get_rank (ctx->h, &ctx->rank) < 0)
         goto error;
+    /* Unless the overlay prunes events that have no subscribers below a
+     * broker, namespace events reach every broker anyway, so followers
+     * may as well subscribe to all of them once, like rank 0, instead of
+     * paying for a synchronous subscribe and unsubscribe per namespace.
+     */
+    if (ctx->rank == 0
+        || !(s = flux_attr_get (h, "tbon.event_filter"))
+        || streq (s, "0"))
+        ctx->subscribe_all = true;
     if (ctx->rank == 0) {
         ctx->prep_w = flux_prepare_watcher_create (r, transaction_prep_cb, ctx);
         if (!ctx->prep_w)
@@ -157,14 +289,20 @@ static struct kvs_ctx *kvs_ctx_create (flux_t *h)
         flux_watcher_start (ctx->check_w);
         ctx->kcp = kvs_checkpoint_create (h,
                                           NULL, /* set later */
-                                          0.0,  /* default 0.0, set later */
-                                          work_queue_check_append_wrapper,
-                                          ctx);
+                                          0.0); /* default 0.0, set later */
         if (!ctx->kcp)
             goto error;
     }
+    else {
+        ctx->relayfence_w = flux_timer_watcher_create (r,
+                                                       relayfence_delay,
+                                                       0.,
+                                                       relayfence_timer_cb,
+                                                       ctx);
+        if (!ctx->relayfence_w)
+            goto error;
+    }
     ctx->transaction_merge = 1;
-    list_head_init (&ctx->work_queue);
     return ctx;
 error:
     kvs_ctx_destroy (ctx);
@@ -190,9 +328,10 @@ static int event_subscribe (struct kvs_ctx *ctx, const char *ns)
      * kvs.namespace-<NS>-removed
      * kvs.namespace-<NS>-created
      *
-     * This module publishes all the above events, but only has
-     * callbacks for the "setroot", "error", and "removed"
-     * events. "created" events are dropped.
+     * This module publishes all the above events, and has callbacks
+     * for all of them.  "created" events are only used by followers
+     * that subscribe to all namespace events, to create roots ahead of
+     * their first use.
      *
      * While dropped events are "bad" performance wise, it is a net
      * win on performance to limit the number of calls to the
@@ -218,8 +357,10 @@ static int event_subscribe (struct kvs_ctx *ctx, const char *ns)
 
         /* On rank 0, we need to listen for all of these namespace
          * events, all of the time.  So subscribe to them just once on
-         * rank 0. */
-        if (ctx->rank == 0) {
+         * rank 0.  Followers do the same unless events are filtered
+         * (see kvs_ctx_create()), and discard events for namespaces
+         * they don't have. */
+        if (ctx->subscribe_all) {
             if (flux_event_subscribe (ctx->h, "kvs.namespace") < 0) {
                 flux_log_error (ctx->h, "flux_event_subscribe");
                 goto cleanup;
@@ -229,7 +370,7 @@ static int event_subscribe (struct kvs_ctx *ctx, const char *ns)
         ctx->events_init = true;
     }
 
-    if (ctx->rank != 0) {
+    if (!ctx->subscribe_all) {
         if (asprintf (&topic, "kvs.namespace-%s", ns) < 0)
             goto cleanup;
 
@@ -250,7 +391,7 @@ static int event_unsubscribe (struct kvs_ctx *ctx, const char *ns)
     char *topic = NULL;
     int rc = -1;
 
-    if (ctx->rank != 0) {
+    if (!ctx->subscribe_all) {
         if (asprintf (&topic, "kvs.namespace-%s", ns) < 0)
             goto cleanup;
 
@@ -293,23 +434,106 @@ static void setroot (struct kvs_ctx *ctx, struct kvsroot *root,
     if (rootseq == 0 || rootseq > root->seq) {
         kvsroot_setroot (ctx->krm, root, rootref, rootseq);
         kvs_wait_version_process (root, false);
-        root->last_update_time = flux_reactor_now (flux_get_reactor (ctx->h));
+        kvsroot_set_update_time (ctx->krm,
+                                 root,
+                                 flux_reactor_now (flux_get_reactor (ctx->h)));
+    }
+}
+
+static void getroot_pending_destroy (struct getroot_pending *gp)
+{
+    if (gp) {
+        int saved_errno = errno;
+        list_del_init (&gp->node);
+        flux_future_destroy (gp->f);
+        flux_msglist_destroy (gp->requests);
+        free (gp->ns);
+        free (gp);
+        errno = saved_errno;
     }
 }
 
+static struct getroot_pending *getroot_pending_lookup (struct kvs_ctx *ctx,
+                                                       const char *ns)
+{
+    struct getroot_pending *gp;
+
+    list_for_each (&ctx->getroot_pending, gp, node) {
+        if (streq (gp->ns, ns))
+            return gp;
+    }
+    return NULL;
+}
+
+/* Requeue the requests waiting on 'gp', or if 'errnum' is nonzero,
+ * fail them.  Requeued requests find the root or, if it could not be
+ * created, fail the same way the first one would have.
+ */
+static void getroot_pending_finish (struct kvs_ctx *ctx,
+                                    struct getroot_pending *gp,
+                                    int errnum)
+{
+    const flux_msg_t *msg;
+
+    while ((msg = flux_msglist_pop (gp->requests))) {
+        if (errnum == 0) {
+            if (flux_requeue (ctx->h, msg, FLUX_RQ_HEAD) < 0) {
+                flux_log_error (ctx->h, "%s: flux_requeue", __FUNCTION__);
+                if (flux_respond_error (ctx->h, msg, errno, NULL) < 0)
+                    flux_log_error (ctx->h,
+                                    "%s: flux_respond_error",
+                                    __FUNCTION__);
+            }
+        }
+        else if (flux_respond_error (ctx->h, msg, errnum, NULL) < 0)
+            flux_log_error (ctx->h, "%s: flux_respond_error", __FUNCTION__);
+        flux_msg_decref (msg);
+    }
+    getroot_pending_destroy (gp);
+}
+
+/* Create root 'ns' on this rank, as learned from the getroot response or
+ * namespace-created event.  If another message has already done so, use
+ * that root.
+ */
+static struct kvsroot *getroot_create (struct kvs_ctx *ctx,
+                                       const char *ns,
+                                       uint32_t owner,
+                                       int flags)
+{
+    struct kvsroot *root;
+    int save_errno;
+
+    if ((root = kvsroot_mgr_lookup_root (ctx->krm, ns)))
+        return root;
+    if (!(root = kvsroot_mgr_create_root (ctx->krm,
+                                          ctx->cache,
+                                          ctx->hash_name,
+                                          ns,
+                                          owner,
+                                          flags))) {
+        flux_log_error (ctx->h, "%s: kvsroot_mgr_create_root", __FUNCTION__);
+        return NULL;
+    }
+    if (event_subscribe (ctx, ns) < 0) {
+        save_errno = errno;
+        kvsroot_mgr_remove_root (ctx->krm, ns);
+        errno = save_errno;
+        flux_log_error (ctx->h, "%s: event_subscribe", __FUNCTION__);
+        return NULL;
+    }
+    return root;
+}
+
 static void getroot_completion (flux_future_t *f, void *arg)
 {
     struct kvs_ctx *ctx = arg;
-    flux_msg_t *msg = NULL;
+    struct getroot_pending *gp = flux_future_aux_get (f, "pending");
     const char *ns;
     int rootseq, flags;
     uint32_t owner;
     const char *ref;
     struct kvsroot *root;
-    int save_errno;
-
-    msg = flux_future_aux_get (f, "msg");
-    assert (msg);
 
     /* N.B. owner read into uint32_t */
     if (flux_rpc_get_unpack (f, "{ s:i s:i s:s s:i s:s }",
@@ -325,26 +549,8 @@ static void getroot_completion (flux_future_t *f, void *arg)
 
     /* possible root initialized by another message before we got this
      * response.  Not relevant if namespace in process of being removed. */
-    if (!(root = kvsroot_mgr_lookup_root (ctx->krm, ns))) {
-
-        if (!(root = kvsroot_mgr_create_root (ctx->krm,
-                                              ctx->cache,
-                                              ctx->hash_name,
-                                              ns,
-                                              owner,
-                                              flags))) {
-            flux_log_error (ctx->h, "%s: kvsroot_mgr_create_root", __FUNCTION__);
-            goto error;
-        }
-
-        if (event_subscribe (ctx, ns) < 0) {
-            save_errno = errno;
-            kvsroot_mgr_remove_root (ctx->krm, ns);
-            errno = save_errno;
-            flux_log_error (ctx->h, "%s: event_subscribe", __FUNCTION__);
-            goto error;
-        }
-    }
+    if (!(root = getroot_create (ctx, ns, owner, flags)))
+        goto error;
 
     /* if root now in process of being removed, error will be handled via
      * the original callback
@@ -352,37 +558,28 @@ static void getroot_completion (flux_future_t *f, void *arg)
     if (!root->remove)
         setroot (ctx, root, ref, rootseq);
 
-    if (flux_requeue (ctx->h, msg, FLUX_RQ_HEAD) < 0) {
-        flux_log_error (ctx->h, "%s: flux_requeue", __FUNCTION__);
-        goto error;
-    }
-
-    flux_msg_destroy (msg);
-    flux_future_destroy (f);
+    getroot_pending_finish (ctx, gp, 0);
     return;
 
 error:
-    if (flux_respond_error (ctx->h, msg, errno, NULL) < 0)
-        flux_log_error (ctx->h, "%s: flux_respond_error", __FUNCTION__);
-    flux_msg_destroy (msg);
-    flux_future_destroy (f);
+    getroot_pending_finish (ctx, gp, errno);
 }
 
+/* Send a getroot RPC upstream for 'ns' on behalf of 'msg', or if one is
+ * already in flight, wait on that one.  Many clients of a new namespace
+ * on a leaf broker, e.g. the shells and tasks of a starting job, thus
+ * cost one upstream RPC.
+ */
 static int getroot_request_send (struct kvs_ctx *ctx,
                                  const char *ns,
                                  flux_msg_handler_t *mh,
                                  const flux_msg_t *msg,
                                  lookup_t *lh)
 {
-    flux_future_t *f = NULL;
+    struct getroot_pending *gp = NULL;
     flux_msg_t *msgcpy = NULL;
     int saved_errno;
 
-    if (!(f = flux_rpc_pack (ctx->h, "kvs.getroot", FLUX_NODEID_UPSTREAM, 0,
-                             "{ s:s }",
-                             "namespace", ns)))
-        goto error;
-
     if (!(msgcpy = flux_msg_copy (msg, true))) {
         flux_log_error (ctx->h, "%s: flux_msg_copy", __FUNCTION__);
         goto error;
@@ -394,20 +591,39 @@ static int getroot_request_send (struct kvs_ctx *ctx,
         goto error;
     }
 
-    /* we will manage destruction of the 'msg' on errors */
-    if (flux_future_aux_set (f, "msg", msgcpy, NULL) < 0) {
-        flux_log_error (ctx->h, "%s: flux_future_aux_set", __FUNCTION__);
-        goto error;
+    if ((gp = getroot_pending_lookup (ctx, ns))) {
+        if (flux_msglist_append (gp->requests, msgcpy) < 0)
+            goto error;
+        flux_msg_destroy (msgcpy);
+        ctx->getroot_stats.coalesced++;
+        return 0;
     }
 
-    if (flux_future_then (f, -1., getroot_completion, ctx) < 0)
+    if (!(gp = calloc (1, sizeof (*gp))))
         goto error;
-
+    list_node_init (&gp->node);
+    if (!(gp->ns = strdup (ns))
+        || !(gp->requests = flux_msglist_create ())
+        || flux_msglist_append (gp->requests, msgcpy) < 0)
+        goto error;
+    if (!(gp->f = flux_rpc_pack (ctx->h,
+                                 "kvs.getroot",
+                                 FLUX_NODEID_UPSTREAM,
+                                 0,
+                                 "{ s:s }",
+                                 "namespace", ns))
+        || flux_future_aux_set (gp->f, "pending", gp, NULL) < 0
+        || flux_future_then (gp->f, -1., getroot_completion, ctx) < 0)
+        goto error;
+    list_add_tail (&ctx->getroot_pending, &gp->node);
+    flux_msg_destroy (msgcpy);
+    ctx->getroot_stats.rpcs++;
     return 0;
 error:
     saved_errno = errno;
     flux_msg_destroy (msgcpy);
-    flux_future_destroy (f);
+    if (gp && !getroot_pending_lookup (ctx, ns))
+        getroot_pending_destroy (gp);
     errno = saved_errno;
     return -1;
 }
@@ -602,18 +818,19 @@ static int load (struct kvs_ctx *ctx, const char *ref, wait_t *wait, bool *stall
  * store/write
  */
 
-static void content_store_completion (flux_future_t *f, void *arg)
+/* Complete the store of cache entry 'cache_blobref', that the content
+ * store returned as 'blobref' or failed to store with 'errnum'.
+ */
+static void content_store_complete (struct kvs_ctx *ctx,
+                                    const char *cache_blobref,
+                                    const char *blobref,
+                                    int errnum)
 {
-    struct kvs_ctx *ctx = arg;
     struct cache_entry *entry;
-    const char *cache_blobref, *blobref;
     int ret;
 
-    cache_blobref = flux_future_aux_get (f, "cache_blobref");
-    assert (cache_blobref);
-
-    if (content_store_get_blobref (f, ctx->hash_name, &blobref) < 0) {
-        flux_log_error (ctx->h, "%s: content_store_get_blobref", __FUNCTION__);
+    if (errnum) {
+        errno = errnum;
         goto error;
     }
 
@@ -651,13 +868,9 @@ static void content_store_completion (flux_future_t *f, void *arg)
                         __FUNCTION__);
         goto error;
     }
-
-    flux_future_destroy (f);
     return;
 
 error:
-    flux_future_destroy (f);
-
     /* failure on store, inform all waiters, must destroy entry
      * afterwards, as future loads/stores may believe content is ok.
      * cache_remove_entry() will not work if a waiter is still there.
@@ -693,30 +906,105 @@ error:
         flux_log (ctx->h, LOG_ERR, "%s: cache_remove_entry", __FUNCTION__);
 }
 
-static int content_store_request_send (struct kvs_ctx *ctx, const char *blobref,
-                                       const void *data, int len)
+static void store_batch_flush (struct kvs_ctx *ctx);
+
+static void content_store_batch_completion (flux_future_t *f, void *arg)
 {
-    flux_future_t *f;
-    int saved_errno, rc = -1;
+    struct kvs_ctx *ctx = arg;
+    struct store_batch *batch = flux_future_aux_get (f, "batch");
+    int errnum = 0;
 
-    if (!(f = content_store (ctx->h, data, len, 0)))
-        goto error;
-    if (flux_future_aux_set (f, "cache_blobref", (void *)blobref, NULL) < 0) {
-        saved_errno = errno;
-        flux_future_destroy (f);
-        errno = saved_errno;
-        goto error;
+    if (flux_rpc_get (f, NULL) < 0) {
+        flux_log_error (ctx->h, "%s: content.store-batch", __FUNCTION__);
+        errnum = errno;
+    }
+    for (int i = 0; i < batch->count; i++) {
+        char blobref[BLOBREF_MAX_STRING_SIZE];
+        const void *hash;
+        int hash_len;
+        int rc = errnum;
+
+        if (!rc
+            && (content_store_batch_get_hash (f, i, &hash, &hash_len) < 0
+                || blobref_hashtostr (ctx->hash_name,
+                                      hash,
+                                      hash_len,
+                                      blobref,
+                                      sizeof (blobref)) < 0)) {
+            flux_log_error (ctx->h, "%s: content_store_batch_get_hash",
+                            __FUNCTION__);
+            rc = errno;
+        }
+        content_store_complete (ctx, batch->blobref[i], blobref, rc);
     }
-    if (flux_future_then (f, -1., content_store_completion, ctx) < 0) {
-        saved_errno = errno;
-        flux_future_destroy (f);
-        errno = saved_errno;
-        goto error;
+    flux_future_destroy (f);
+    ctx->store_inflight--;
+    store_batch_flush (ctx);
+}
+
+static void store_batch_fail (struct kvs_ctx *ctx,
+                              struct store_batch *batch,
+                              int errnum)
+{
+    for (int i = 0; i < batch->count; i++)
+        content_store_complete (ctx, batch->blobref[i], NULL, errnum);
+}
+
+/* Send queued store batches, up to the in-flight window.  This is called
+ * from the prepare watcher and store completions, never from within
+ * kvstxn_apply(), since failing a batch runs cache entry waiters.
+ */
+static void store_batch_flush (struct kvs_ctx *ctx)
+{
+    struct store_batch *batch;
+
+    while (ctx->store_inflight < store_window
+           && (batch = list_pop (&ctx->store_queue, struct store_batch, node))) {
+        flux_future_t *f;
+
+        if (!(f = content_store_batch (ctx->h, batch->iov, batch->count))
+            || flux_future_aux_set (f, "batch", batch, free) < 0) {
+            flux_log_error (ctx->h, "%s: content_store_batch", __FUNCTION__);
+            store_batch_fail (ctx, batch, errno);
+            free (batch);
+            flux_future_destroy (f);
+            continue;
+        }
+        if (flux_future_then (f, -1., content_store_batch_completion, ctx) < 0) {
+            flux_log_error (ctx->h, "%s: flux_future_then", __FUNCTION__);
+            store_batch_fail (ctx, batch, errno);
+            flux_future_destroy (f); // frees batch
+            continue;
+        }
+        ctx->store_inflight++;
     }
+}
 
-    rc = 0;
-error:
-    return rc;
+/* Queue dirty cache 'entry' for storing to the content store.  The store
+ * request is sent later by store_batch_flush().
+ */
+static int store_batch_append (struct kvs_ctx *ctx, struct cache_entry *entry)
+{
+    struct store_batch *batch;
+    const void *data;
+    int len;
+
+    if (cache_entry_get_raw (entry, &data, &len) < 0)
+        return -1;
+    batch = list_tail (&ctx->store_queue, struct store_batch, node);
+    if (!batch
+        || batch->count == STORE_BATCH_MAX_COUNT
+        || (batch->count > 0 && batch->size + len > store_batch_max_size)) {
+        if (!(batch = calloc (1, sizeof (*batch))))
+            return -1;
+        list_add_tail (&ctx->store_queue, &batch->node);
+    }
+    batch->iov[batch->count].iov_base = (void *)data;
+    batch->iov[batch->count].iov_len = len;
+    batch->blobref[batch->count] = cache_entry_get_blobref (entry);
+    batch->count++;
+    batch->size += len;
+    return 0;
 }
 
 static int kvstxn_load_cb (kvstxn_t *kt, const char *ref, void *data)
@@ -734,43 +1022,28 @@ static int kvstxn_load_cb (kvstxn_t *kt, const char *ref, void *data)
     return 0;
 }
 
-/* Flush to content cache asynchronously and push wait onto cache
- * object's wait queue.
+/* Queue for flush to content cache asynchronously and push wait onto
+ * cache object's wait queue.
  */
 static int kvstxn_cache_cb (kvstxn_t *kt, struct cache_entry *entry, void *data)
 {
     struct kvs_cb_data *cbd = data;
-    const char *blobref;
-    const void *storedata;
-    int storedatalen = 0;
 
     assert (cache_entry_get_dirty (entry));
 
-    if (cache_entry_get_raw (entry, &storedata, &storedatalen) < 0) {
-        flux_log_error (cbd->ctx->h, "%s: cache_entry_get_raw",
-                        __FUNCTION__);
-        kvstxn_cleanup_dirty_cache_entry (kt, entry);
-        return -1;
-    }
-
-    /* must be true, otherwise we didn't insert entry in cache */
-    blobref = cache_entry_get_blobref (entry);
-    assert (blobref);
-
-    if (content_store_request_send (cbd->ctx,
-                                    blobref,
-                                    storedata,
-                                    storedatalen) < 0) {
+    if (store_batch_append (cbd->ctx, entry) < 0) {
         cbd->errnum = errno;
-        flux_log_error (cbd->ctx->h, "%s: content_store_request_send",
+        flux_log_error (cbd->ctx->h, "%s: store_batch_append",
                         __FUNCTION__);
         kvstxn_cleanup_dirty_cache_entry (kt, entry);
         return -1;
     }
+    /* N.B. once queued, the entry is completed by its store batch and
+     * must not be cleaned up here.
+     */
     if (cache_entry_wait_notdirty (entry, cbd->wait) < 0) {
         cbd->errnum = errno;
         flux_log_error (cbd->ctx->h, "cache_entry_wait_notdirty");
-        kvstxn_cleanup_dirty_cache_entry (kt, entry);
         return -1;
     }
     return 0;
@@ -782,8 +1055,12 @@ static void flux_msg_destroy_wrapper (void *arg)
     flux_msg_destroy (msg);
 }
 
+/* If 'delta' is non-NULL, it is an object mapping blobrefs to the
+ * encoded dir objects that were stored by the transaction (see
+ * kvstxn_get_delta()).  Other ranks add them to their caches.
+ */
 static int setroot_event_send (struct kvs_ctx *ctx, struct kvsroot *root,
-                               json_t *names, json_t *keys)
+                               json_t *names, json_t *keys, json_t *delta)
 {
     flux_msg_t *msg = NULL;
     char *setroot_topic = NULL;
@@ -797,14 +1074,26 @@ static int setroot_event_send (struct kvs_ctx *ctx, struct kvsroot *root,
         goto done;
     }
 
-    if (!(msg = flux_event_pack (setroot_topic,
-                                 "{ s:s s:i s:s s:O s:O s:i}",
-                                 "namespace", root->ns_name,
-                                 "rootseq", root->seq,
-                                 "rootref", root->ref,
-                                 "names", names,
-                                 "keys", keys,
-                                 "owner", root->owner))) {
+    if (delta)
+        msg = flux_event_pack (setroot_topic,
+                               "{ s:s s:i s:s s:O s:O s:i s:O }",
+                               "namespace", root->ns_name,
+                               "rootseq", root->seq,
+                               "rootref", root->ref,
+                               "names", names,
+                               "keys", keys,
+                               "owner", root->owner,
+                               "delta", delta);
+    else
+        msg = flux_event_pack (setroot_topic,
+                               "{ s:s s:i s:s s:O s:O s:i}",
+                               "namespace", root->ns_name,
+                               "rootseq", root->seq,
+                               "rootref", root->ref,
+                               "names", names,
+                               "keys", keys,
+                               "owner", root->owner);
+    if (!msg) {
         saved_errno = errno;
         flux_log_error (ctx->h, "%s: flux_event_pack", __FUNCTION__);
         goto done;
@@ -1071,7 +1360,11 @@ done:
         }
         if (!(internal_flags & KVSTXN_INTERNAL_FLAG_NO_PUBLISH)) {
             setroot (ctx, root, kvstxn_get_newroot_ref (kt), root->seq + 1);
-            setroot_event_send (ctx, root, names, kvstxn_get_keys (kt));
+            setroot_event_send (ctx,
+                                root,
+                                names,
+                                kvstxn_get_keys (kt),
+                                kvstxn_get_delta (kt));
         }
     } else {
         fallback = kvstxn_fallback_mergeable (kt);
@@ -1110,6 +1403,9 @@ static void transaction_prep_cb (flux_reactor_t *r, flux_watcher_t *w,
 {
     struct kvs_ctx *ctx = arg;
 
+    store_batch_flush (ctx);
+    if (flux_msglist_count (ctx->gc_requests) > 0)
+        gc_begin_check (ctx);
     if (!list_empty (&ctx->work_queue))
         flux_watcher_start (ctx->idle_w);
 }
@@ -1146,13 +1442,28 @@ static void transaction_check_cb (flux_reactor_t *r, flux_watcher_t *w,
                                   int revents, void *arg)
 {
     struct kvs_ctx *ctx = arg;
-    struct kvsroot *root = NULL;
-    struct kvsroot *next = NULL;
+    struct kvsroot *root;
+    struct kvsroot *last;
+    struct timespec t0;
 
     flux_watcher_stop (ctx->idle_w);
 
-    list_for_each_safe (&ctx->work_queue, root, next, work_queue_node)
+    /* Pop each root off the head of the queue.  kvstxn_apply() appends
+     * it to the tail again if it has another ready transaction, so stop
+     * after the root that was last when the pass began.
+     */
+    if (!(last = list_tail (&ctx->work_queue, struct kvsroot, work_queue_node)))
+        return;
+    monotime (&t0);
+    while ((root = list_top (&ctx->work_queue,
+                             struct kvsroot,
+                             work_queue_node))) {
+        work_queue_remove (root);
         kvstxn_check_root_cb (root, ctx);
+        if (root == last
+            || monotime_since (t0) > transaction_pass_budget * 1000.)
+            break;
+    }
 }
 
 /*
@@ -1237,19 +1548,28 @@ static int heartbeat_root_cb (struct kvsroot *root, void *arg)
          */
         start_root_remove (ctx, root->ns_name);
     }
-    else /* "touch" root */
-        (void)cache_lookup (ctx->cache, root->ref);
 
     return 0;
 }
 
+/* Only namespaces being removed and, on followers, namespaces that may
+ * have expired are visited, so the cost doesn't grow with the number of
+ * idle namespaces.  Their root directories age out of the cache like
+ * any other object.  The primary root is kept in the cache.
+ */
 static void heartbeat_sync_cb (flux_future_t *f, void *arg)
 {
     struct kvs_ctx *ctx = arg;
+    double now = flux_reactor_now (flux_get_reactor (ctx->h));
+    double before = ctx->rank == 0 ? 0. : now - max_namespace_age;
+    struct kvsroot *root;
 
     /* don't error return, fallthrough to deal with rest as necessary */
-    if (kvsroot_mgr_iter_roots (ctx->krm, heartbeat_root_cb, ctx) < 0)
-        flux_log_error (ctx->h, "%s: kvsroot_mgr_iter_roots", __FUNCTION__);
+    if (kvsroot_mgr_iter_aged (ctx->krm, before, heartbeat_root_cb, ctx) < 0)
+        flux_log_error (ctx->h, "%s: kvsroot_mgr_iter_aged", __FUNCTION__);
+
+    if ((root = kvsroot_mgr_lookup_root (ctx->krm, KVS_PRIMARY_NAMESPACE)))
+        (void)cache_lookup (ctx->cache, root->ref);
 
     if (cache_expire_entries (ctx->cache, max_lastuse_age) < 0)
         flux_log_error (ctx->h, "%s: cache_expire_entries", __FUNCTION__);
@@ -1272,15 +1592,246 @@ static int lookup_load_cb (lookup_t *lh, const char *ref, void *data)
     return 0;
 }
 
+/* When stats are enabled, record the arrival time of a request in the
+ * message so its latency can be reported when it is finally answered.
+ * Stalled requests are replayed with the same message, so only the first
+ * call sets the time.
+ */
+static void stats_timing_start (struct kvs_ctx *ctx, const flux_msg_t *msg)
+{
+    struct timespec *t0;
+
+    if (!flux_stats_enabled (ctx->h, NULL)
+        || flux_msg_aux_get (msg, "t0")
+        || !(t0 = malloc (sizeof (*t0))))
+        return;
+    monotime (t0);
+    if (flux_msg_aux_set (msg, "t0", t0, free) < 0)
+        free (t0);
+}
+
+static void stats_timing_end (struct kvs_ctx *ctx,
+                              const flux_msg_t *msg,
+                              const char *name)
+{
+    struct timespec *t0 = flux_msg_aux_get (msg, "t0");
+
+    if (t0)
+        flux_stats_timing (ctx->h, name, monotime_since (*t0));
+}
+
+/* Start timing 'msg' if it is sampled for the top-N tables.
+ * As above, a replayed request keeps its original start time.
+ */
+static void top_start (struct kvs_ctx *ctx, const flux_msg_t *msg)
+{
+    struct timespec *t0;
+
+    if (ctx->top.size == 0
+        || flux_msg_aux_get (msg, "top-t0")
+        || ctx->top.counter++ % ctx->top.sample != 0
+        || !(t0 = malloc (sizeof (*t0))))
+        return;
+    monotime (t0);
+    if (flux_msg_aux_set (msg, "top-t0", t0, free) < 0)
+        free (t0);
+}
+
+/* Approximate size of the value stored in a val treeobj.
+ * Values stored by reference are not loaded here, so count as zero.
+ */
+static size_t top_val_size (json_t *obj)
+{
+    json_t *data;
+
+    if (!obj
+        || !treeobj_is_val (obj)
+        || !(data = treeobj_get_data (obj))
+        || !json_is_string (data))
+        return 0;
+    return json_string_length (data) / 4 * 3; // base64
+}
+
+/* Add an operation on 'key' to the prefix table, under the key's parent
+ * directory, or "." for a key in the root directory.
+ */
+static void top_add_prefix (struct kvs_ctx *ctx,
+                            const char *key,
+                            bool commit,
+                            size_t bytes,
+                            double latency)
+{
+    const char *dot;
+    char *prefix;
+
+    while (*key == '.')
+        key++;
+    if ((dot = strrchr (key, '.')) && dot > key)
+        prefix = strndup (key, dot - key);
+    else
+        prefix = strdup (".");
+    if (!prefix)
+        return;
+    if (commit)
+        (void)topn_add_commit (ctx->top.prefix,
+                               prefix,
+                               ctx->top.sample,
+                               bytes,
+                               latency);
+    else
+        (void)topn_add_lookup (ctx->top.prefix,
+                               prefix,
+                               ctx->top.sample,
+                               bytes,
+                               latency);
+    free (prefix);
+}
+
+static void top_add_ns_userid (struct kvs_ctx *ctx,
+                               const char *ns,
+                               uint32_t userid,
+                               bool commit,
+                               size_t bytes,
+                               double latency)
+{
+    char user[16];
+
+    snprintf (user, sizeof (user), "%ju", (uintmax_t)userid);
+    if (commit) {
+        (void)topn_add_commit (ctx->top.ns,
+                               ns,
+                               ctx->top.sample,
+                               bytes,
+                               latency);
+        (void)topn_add_commit (ctx->top.userid,
+                               user,
+                               ctx->top.sample,
+                               bytes,
+                               latency);
+    }
+    else {
+        (void)topn_add_lookup (ctx->top.ns,
+                               ns,
+                               ctx->top.sample,
+                               bytes,
+                               latency);
+        (void)topn_add_lookup (ctx->top.userid,
+                               user,
+                               ctx->top.sample,
+                               bytes,
+                               latency);
+    }
+}
+
+/* Count a sampled lookup as it is responded to.  'val' is the value
+ * returned, if any.
+ */
+static void top_lookup_end (struct kvs_ctx *ctx,
+                            const flux_msg_t *msg,
+                            json_t *val)
+{
+    struct timespec *t0;
+    const char *key;
+    const char *ns = NULL;
+    struct flux_msg_cred cred;
+    size_t bytes;
+    double latency;
+
+    if (ctx->top.size == 0
+        || !(t0 = flux_msg_aux_get (msg, "top-t0"))
+        || flux_request_unpack (msg, NULL, "{s:s s?s}",
+                                "key", &key,
+                                "namespace", &ns) < 0
+        || flux_msg_get_cred (msg, &cred) < 0)
+        return;
+    latency = monotime_since (*t0) / 1000.;
+    bytes = top_val_size (val);
+    top_add_ns_userid (ctx, ns ? ns : "-", cred.userid, false, bytes, latency);
+    top_add_prefix (ctx, key, false, bytes, latency);
+}
+
+/* Count a sampled commit or fence as it is responded to.
+ */
+static void top_commit_end (struct kvs_ctx *ctx, const flux_msg_t *msg)
+{
+    struct timespec *t0;
+    json_t *ops;
+    const char *ns;
+    struct flux_msg_cred cred;
+    size_t total = 0;
+    double latency;
+    size_t index;
+    json_t *op;
+
+    if (ctx->top.size == 0
+        || !(t0 = flux_msg_aux_get (msg, "top-t0"))
+        || flux_request_unpack (msg, NULL, "{s:o s:s}",
+                                "ops", &ops,
+                                "namespace", &ns) < 0
+        || flux_msg_get_cred (msg, &cred) < 0)
+        return;
+    latency = monotime_since (*t0) / 1000.;
+    json_array_foreach (ops, index, op) {
+        const char *key;
+        json_t *dirent = NULL;
+        size_t bytes;
+
+        if (json_unpack (op, "{s:s s?o}", "key", &key, "dirent", &dirent) < 0)
+            continue;
+        bytes = top_val_size (dirent);
+        top_add_prefix (ctx, key, true, bytes, latency);
+        total += bytes;
+    }
+    top_add_ns_userid (ctx, ns, cred.userid, true, total, latency);
+}
+
+/* Get the top-N tables for stats-get.  They name other users' keys and
+ * namespaces, so are only filled in for the instance owner.
+ */
+static json_t *top_get (struct kvs_ctx *ctx, const flux_msg_t *msg)
+{
+    json_t *ns = NULL;
+    json_t *prefix = NULL;
+    json_t *userid = NULL;
+    json_t *o = NULL;
+
+    if (ctx->top.size == 0
+        || flux_msg_authorize (msg, FLUX_USERID_UNKNOWN) < 0) {
+        if (!(o = json_pack ("{s:[] s:[] s:[]}",
+                             "namespace",
+                             "prefix",
+                             "userid")))
+            errno = ENOMEM;
+        return o;
+    }
+    if (!(ns = topn_get (ctx->top.ns))
+        || !(prefix = topn_get (ctx->top.prefix))
+        || !(userid = topn_get (ctx->top.userid)))
+        goto done;
+    if (!(o = json_pack ("{s:O s:O s:O}",
+                         "namespace", ns,
+                         "prefix", prefix,
+                         "userid", userid)))
+        errno = ENOMEM;
+done:
+    json_decref (ns);
+    json_decref (prefix);
+    json_decref (userid);
+    return o;
+}
+
 static void lookup_wait_error_cb (wait_t *w, int errnum, void *arg)
 {
     lookup_t *lh = arg;
     lookup_set_aux_errnum (lh, errnum);
 }
 
+/* 'addflags' are added to the lookup flags from the request.
+ */
 static lookup_t *lookup_common (flux_t *h, flux_msg_handler_t *mh,
                                 const flux_msg_t *msg, void *arg,
                                 flux_msg_handler_f replay_cb,
+                                int addflags,
                                 bool *stall)
 {
     struct kvs_ctx *ctx = arg;
@@ -1300,6 +1851,7 @@ static lookup_t *lookup_common (flux_t *h, flux_msg_handler_t *mh,
     if (!lh) {
         struct flux_msg_cred cred;
         int root_seq = -1;
+        int append_index = -1;
 
         if (flux_request_unpack (msg, NULL, "{ s:s s:i }",
                                  "key", &key,
@@ -1320,6 +1872,11 @@ static lookup_t *lookup_common (flux_t *h, flux_msg_handler_t *mh,
         (void)flux_request_unpack (msg, NULL, "{ s:i }",
                                    "rootseq", &root_seq);
 
+        /* append_index is optional, used by kvs-watch to follow
+         * FLUX_KVS_WATCH_APPEND keys */
+        (void)flux_request_unpack (msg, NULL, "{ s:i }",
+                                   "append_index", &append_index);
+
         /* either namespace or rootdir must be specified */
         if (!ns && !root_dirent) {
             errno = EPROTO;
@@ -1350,9 +1907,12 @@ static lookup_t *lookup_common (flux_t *h, flux_msg_handler_t *mh,
                                   root_seq,
                                   key,
                                   cred,
-                                  flags,
+                                  flags | addflags,
                                   h)))
             goto done;
+        if (append_index >= 0
+            && lookup_set_append_index (lh, append_index) < 0)
+            goto done;
     }
     else {
         int err;
@@ -1434,6 +1994,41 @@ stall:
     return NULL;
 }
 
+/* A caller that lists a directory often looks up its entries next, e.g.
+ * job-manager and job-list scanning the job directory at startup.  Hint
+ * the content cache to start loading entry blobs that are not in the KVS
+ * cache, so that those lookups don't each wait on the backing store.
+ */
+static void prefetch_dir_entries (struct kvs_ctx *ctx, json_t *dir)
+{
+    uint8_t hashes[PREFETCH_MAX * BLOBREF_MAX_DIGEST_SIZE];
+    int hash_size = 0;
+    int count = 0;
+    const char *name;
+    json_t *entry;
+
+    json_object_foreach (treeobj_get_data (dir), name, entry) {
+        int n;
+
+        if (!treeobj_is_dirref (entry) && !treeobj_is_valref (entry))
+            continue;
+        n = treeobj_get_count (entry);
+        for (int i = 0; i < n && count < PREFETCH_MAX; i++) {
+            const char *ref = treeobj_get_blobref (entry, i);
+
+            if (!ref || cache_lookup (ctx->cache, ref))
+                continue;
+            if ((hash_size = blobref_strtohash (ref,
+                                                hashes + count * hash_size,
+                                                BLOBREF_MAX_DIGEST_SIZE)) < 0)
+                return;
+            count++;
+        }
+    }
+    if (count > 0 && content_prefetch (ctx->h, hashes, hash_size, count) < 0)
+        flux_log_error (ctx->h, "%s: content_prefetch", __FUNCTION__);
+}
+
 static void lookup_request_cb (flux_t *h, flux_msg_handler_t *mh,
                                const flux_msg_t *msg, void *arg)
 {
@@ -1441,7 +2036,9 @@ static void lookup_request_cb (flux_t *h, flux_msg_handler_t *mh,
     json_t *val;
     bool stall = false;
 
-    if (!(lh = lookup_common (h, mh, msg, arg, lookup_request_cb,
+    stats_timing_start (arg, msg);
+    top_start (arg, msg);
+    if (!(lh = lookup_common (h, mh, msg, arg, lookup_request_cb, 0,
                               &stall))) {
         if (stall)
             return;
@@ -1454,12 +2051,18 @@ static void lookup_request_cb (flux_t *h, flux_msg_handler_t *mh,
     }
     if (flux_respond_pack (h, msg, "{ s:O }", "val", val) < 0)
         flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
+    stats_timing_end (arg, msg, "kvs.lookup");
+    top_lookup_end (arg, msg, val);
+    if (treeobj_is_dir (val))
+        prefetch_dir_entries (arg, val);
     lookup_destroy (lh);
     json_decref (val);
     return;
 error:
     if (flux_respond_error (h, msg, errno, NULL) < 0)
         flux_log_error (h, "%s: flux_respond_error", __FUNCTION__);
+    stats_timing_end (arg, msg, "kvs.lookup");
+    top_lookup_end (arg, msg, NULL);
     lookup_destroy (lh);
 }
 
@@ -1469,17 +2072,21 @@ error:
  * kvs-watch module.  The kvs-watch module requires root information
  * on lookups (including ENOENT failed lookups) to determine what
  * lookups can be considered to be read-your-writes consistency safe.
+ * If an append_index is specified, only the data stored after that
+ * many blobs is returned, along with the size of each returned blob.
  */
 static void lookup_plus_request_cb (flux_t *h, flux_msg_handler_t *mh,
                                     const flux_msg_t *msg, void *arg)
 {
     lookup_t *lh;
     json_t *val = NULL;
+    json_t *sizes = NULL;
     const char *root_ref;
     int root_seq;
     bool stall = false;
 
-    if (!(lh = lookup_common (h, mh, msg, arg, lookup_plus_request_cb,
+    top_start (arg, msg);
+    if (!(lh = lookup_common (h, mh, msg, arg, lookup_plus_request_cb, 0,
                               &stall))) {
         if (stall)
             return;
@@ -1498,22 +2105,439 @@ static void lookup_plus_request_cb (flux_t *h, flux_msg_handler_t *mh,
                                "rootref", root_ref) < 0)
             flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
     }
-    else {
-        if (flux_respond_pack (h, msg, "{ s:O s:i s:s }",
-                               "val", val,
-                               "rootseq", root_seq,
-                               "rootref", root_ref) < 0)
-            flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
+    else if ((sizes = lookup_get_append_sizes (lh))) {
+        if (flux_respond_pack (h, msg, "{ s:O s:O s:i s:s }",
+                               "val", val,
+                               "sizes", sizes,
+                               "rootseq", root_seq,
+                               "rootref", root_ref) < 0)
+            flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
+    }
+    else {
+        if (flux_respond_pack (h, msg, "{ s:O s:i s:s }",
+                               "val", val,
+                               "rootseq", root_seq,
+                               "rootref", root_ref) < 0)
+            flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
+    }
+    top_lookup_end (arg, msg, val);
+    lookup_destroy (lh);
+    json_decref (val);
+    json_decref (sizes);
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        flux_log_error (h, "%s: flux_respond_error", __FUNCTION__);
+    top_lookup_end (arg, msg, NULL);
+}
+
+/* kvs.lookup-stream takes the same payload as kvs.lookup and must be
+ * a streaming RPC.  The value is sent as a sequence of raw responses,
+ * one per blob of a valref, or one for a val, terminated by ENODATA.
+ * Blobs are loaded one at a time, so neither this module nor the
+ * client need to hold the whole value at once.  State is kept in the
+ * request message aux across replays.
+ */
+struct lookup_stream {
+    json_t *val;
+    int index;
+    int count;
+    int errnum;                 /* load error */
+};
+
+static void lookup_stream_destroy (struct lookup_stream *ls)
+{
+    if (ls) {
+        int saved_errno = errno;
+        json_decref (ls->val);
+        free (ls);
+        errno = saved_errno;
+    }
+}
+
+static struct lookup_stream *lookup_stream_create (json_t *val)
+{
+    struct lookup_stream *ls;
+
+    if (!treeobj_is_val (val) && !treeobj_is_valref (val)) {
+        errno = treeobj_is_dir (val) || treeobj_is_dirref (val)
+            ? EISDIR : EINVAL;
+        return NULL;
+    }
+    if (!(ls = calloc (1, sizeof (*ls))))
+        return NULL;
+    ls->val = json_incref (val);
+    ls->count = treeobj_is_valref (val) ? treeobj_get_count (val) : 1;
+    return ls;
+}
+
+static void lookup_stream_wait_error_cb (wait_t *w, int errnum, void *arg)
+{
+    struct lookup_stream *ls = arg;
+    ls->errnum = errnum;
+}
+
+/* Hint the content cache to start loading the blobs that follow the
+ * one being waited for, so they are ready by the time they are sent.
+ */
+static void lookup_stream_prefetch (struct kvs_ctx *ctx,
+                                    struct lookup_stream *ls)
+{
+    uint8_t hashes[STREAM_PREFETCH_MAX * BLOBREF_MAX_DIGEST_SIZE];
+    int hash_size = 0;
+    int count = 0;
+
+    for (int i = ls->index + 1;
+         i < ls->count && count < STREAM_PREFETCH_MAX;
+         i++) {
+        const char *ref = treeobj_get_blobref (ls->val, i);
+
+        if (!ref || cache_lookup (ctx->cache, ref))
+            continue;
+        if ((hash_size = blobref_strtohash (ref,
+                                            hashes + count * hash_size,
+                                            BLOBREF_MAX_DIGEST_SIZE)) < 0)
+            return;
+        count++;
+    }
+    if (count > 0 && content_prefetch (ctx->h, hashes, hash_size, count) < 0)
+        flux_log_error (ctx->h, "%s: content_prefetch", __FUNCTION__);
+}
+
+static void lookup_stream_request_cb (flux_t *h, flux_msg_handler_t *mh,
+                                      const flux_msg_t *msg, void *arg)
+{
+    struct kvs_ctx *ctx = arg;
+    struct lookup_stream *ls;
+    lookup_t *lh = NULL;
+    json_t *val = NULL;
+    wait_t *wait = NULL;
+
+    if (!(ls = flux_msg_aux_get (msg, "lookup_stream"))) {
+        bool stall = false;
+
+        if (!flux_msg_is_streaming (msg)) {
+            errno = EPROTO;
+            goto error;
+        }
+        if (!(lh = lookup_common (h, mh, msg, arg, lookup_stream_request_cb,
+                                  FLUX_KVS_TREEOBJ, &stall))) {
+            if (stall)
+                return;
+            goto error;
+        }
+        if (!(val = lookup_get_value (lh))) {
+            errno = ENOENT;
+            goto error;
+        }
+        if (!(ls = lookup_stream_create (val))
+            || flux_msg_aux_set (msg,
+                                 "lookup_stream",
+                                 ls,
+                                 (flux_free_f)lookup_stream_destroy) < 0) {
+            lookup_stream_destroy (ls);
+            goto error;
+        }
+        lookup_destroy (lh);
+        lh = NULL;
+        json_decref (val);
+        val = NULL;
+    }
+    else if (ls->errnum) {
+        errno = ls->errnum;
+        goto error;
+    }
+    if (treeobj_is_val (ls->val) && ls->index == 0) {
+        void *data;
+        int len;
+        int rc;
+
+        if (treeobj_decode_val (ls->val, &data, &len) < 0)
+            goto error;
+        rc = flux_respond_raw (h, msg, data, len);
+        free (data);
+        if (rc < 0)
+            goto error_respond;
+        ls->index++;
+    }
+    while (ls->index < ls->count) {
+        const char *ref = treeobj_get_blobref (ls->val, ls->index);
+        struct cache_entry *entry;
+        const void *data;
+        int len;
+
+        if (!ref)
+            goto error;
+        if (!(entry = cache_lookup (ctx->cache, ref))
+            || !cache_entry_get_valid (entry)) {
+            bool stall = false;
+
+            if (!(wait = wait_create_msg_handler (h,
+                                                  mh,
+                                                  msg,
+                                                  ctx,
+                                                  lookup_stream_request_cb))
+                || wait_set_error_cb (wait,
+                                      lookup_stream_wait_error_cb,
+                                      ls) < 0
+                || load (ctx, ref, wait, &stall) < 0)
+                goto error;
+            if (stall) {
+                lookup_stream_prefetch (ctx, ls);
+                return;
+            }
+            wait_destroy (wait);
+            wait = NULL;
+            continue;
+        }
+        if (cache_entry_get_raw (entry, &data, &len) < 0)
+            goto error;
+        if (flux_respond_raw (h, msg, data, len) < 0)
+            goto error_respond;
+        ls->index++;
+    }
+    errno = ENODATA;
+error:
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        flux_log_error (h, "%s: flux_respond_error", __FUNCTION__);
+    wait_destroy (wait);
+    lookup_destroy (lh);
+    json_decref (val);
+    return;
+error_respond:
+    flux_log_error (h, "%s: flux_respond_raw", __FUNCTION__);
+}
+
+/* State of a kvs.lookup-batch request, kept in the request message aux
+ * across replays.  Each key's lookup handle is destroyed, and set to
+ * NULL, once its response has been sent.
+ */
+struct lookup_batch {
+    int count;
+    int pending;
+    int errnum;                 /* load error, fails all pending keys */
+    lookup_t **lh;
+};
+
+static void lookup_batch_destroy (struct lookup_batch *batch)
+{
+    if (batch) {
+        int saved_errno = errno;
+        for (int i = 0; i < batch->count; i++)
+            lookup_destroy (batch->lh[i]);
+        free (batch->lh);
+        free (batch);
+        errno = saved_errno;
+    }
+}
+
+/* All keys are looked up against the root of 'ns' at the time of the
+ * request, so that the results are consistent with each other.
+ */
+static struct lookup_batch *lookup_batch_create (struct kvs_ctx *ctx,
+                                                 const flux_msg_t *msg,
+                                                 const char *ns,
+                                                 struct kvsroot *root,
+                                                 json_t *keys,
+                                                 int flags)
+{
+    struct lookup_batch *batch;
+    struct flux_msg_cred cred;
+    size_t index;
+    json_t *key;
+
+    if (flux_msg_get_cred (msg, &cred) < 0)
+        return NULL;
+    if (!(batch = calloc (1, sizeof (*batch)))
+        || !(batch->lh = calloc (json_array_size (keys),
+                                 sizeof (batch->lh[0])))) {
+        lookup_batch_destroy (batch);
+        errno = ENOMEM;
+        return NULL;
+    }
+    json_array_foreach (keys, index, key) {
+        if (!json_is_string (key)) {
+            errno = EPROTO;
+            goto error;
+        }
+        if (!(batch->lh[index] = lookup_create (ctx->cache,
+                                                ctx->krm,
+                                                ns,
+                                                root->ref,
+                                                root->seq,
+                                                json_string_value (key),
+                                                cred,
+                                                flags,
+                                                ctx->h)))
+            goto error;
+        batch->count++;
+        batch->pending++;
+    }
+    return batch;
+error:
+    lookup_batch_destroy (batch);
+    return NULL;
+}
+
+static void lookup_batch_wait_error_cb (wait_t *w, int errnum, void *arg)
+{
+    struct lookup_batch *batch = arg;
+    batch->errnum = errnum;
+}
+
+static void lookup_batch_respond (flux_t *h,
+                                  const flux_msg_t *msg,
+                                  struct lookup_batch *batch,
+                                  int index,
+                                  int errnum)
+{
+    lookup_t *lh = batch->lh[index];
+    json_t *val = NULL;
+    int rc;
+
+    if (!errnum && !(val = lookup_get_value (lh)))
+        errnum = ENOENT;
+    if (errnum) {
+        rc = flux_respond_pack (h, msg, "{ s:i s:i }",
+                                "index", index,
+                                "errno", errnum);
+    }
+    else {
+        rc = flux_respond_pack (h, msg, "{ s:i s:O }",
+                                "index", index,
+                                "val", val);
+    }
+    if (rc < 0)
+        flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
+    json_decref (val);
+    lookup_destroy (lh);
+    batch->lh[index] = NULL;
+    batch->pending--;
+}
+
+/* Look up many keys in one request, streaming one response per key in
+ * completion order and ending with ENODATA.  Failed lookups of single
+ * keys are reported in successful responses with an "errno" field.
+ * Keys whose lookups stall share one wait_t, so the request is replayed
+ * once all the refs loaded on its behalf are in the cache.
+ *
+ * N.B. a symlink into a namespace not yet known to this rank fails
+ * with ENOTSUP rather than stalling the whole batch.
+ */
+static void lookup_batch_request_cb (flux_t *h, flux_msg_handler_t *mh,
+                                     const flux_msg_t *msg, void *arg)
+{
+    struct kvs_ctx *ctx = arg;
+    struct lookup_batch *batch;
+    wait_t *wait = NULL;
+    struct kvs_cb_data cbd;
+
+    if (!(batch = flux_msg_aux_get (msg, "lookup_batch"))) {
+        const char *ns;
+        json_t *keys;
+        int flags;
+        struct kvsroot *root;
+        bool stall;
+
+        if (flux_request_unpack (msg, NULL, "{ s:o s:s s:i }",
+                                 "keys", &keys,
+                                 "namespace", &ns,
+                                 "flags", &flags) < 0)
+            goto error;
+        if (!flux_msg_is_streaming (msg)
+            || !json_is_array (keys)
+            || json_array_size (keys) == 0) {
+            errno = EPROTO;
+            goto error;
+        }
+        if (!(root = getroot (ctx, ns, mh, msg, NULL, &stall))) {
+            if (stall)
+                return;
+            goto error;
+        }
+        if (!(batch = lookup_batch_create (ctx, msg, ns, root, keys, flags)))
+            goto error;
+    }
+
+    for (int i = 0; i < batch->count; i++) {
+        lookup_process_t lret;
+
+        if (!batch->lh[i])
+            continue;
+        if (batch->errnum) {
+            lookup_batch_respond (h, msg, batch, i, batch->errnum);
+            continue;
+        }
+        lret = lookup (batch->lh[i]);
+        if (lret == LOOKUP_PROCESS_FINISHED)
+            lookup_batch_respond (h, msg, batch, i, 0);
+        else if (lret == LOOKUP_PROCESS_ERROR) {
+            lookup_batch_respond (h,
+                                  msg,
+                                  batch,
+                                  i,
+                                  lookup_get_errnum (batch->lh[i]));
+        }
+        else if (lret == LOOKUP_PROCESS_LOAD_MISSING_NAMESPACE)
+            lookup_batch_respond (h, msg, batch, i, ENOTSUP);
+        else {
+            assert (lret == LOOKUP_PROCESS_LOAD_MISSING_REFS);
+            if (!wait) {
+                if (!(wait = wait_create_msg_handler (h,
+                                                      mh,
+                                                      msg,
+                                                      ctx,
+                                                      lookup_batch_request_cb))
+                    || wait_set_error_cb (wait,
+                                          lookup_batch_wait_error_cb,
+                                          batch) < 0) {
+                    lookup_batch_respond (h, msg, batch, i, errno);
+                    wait_destroy (wait);
+                    wait = NULL;
+                    continue;
+                }
+                cbd.ctx = ctx;
+                cbd.wait = wait;
+            }
+            cbd.errnum = 0;
+            if (lookup_iter_missing_refs (batch->lh[i],
+                                          lookup_load_cb,
+                                          &cbd) < 0) {
+                /* loads already in flight for this key complete, but
+                 * remaining iterations of the lookup are abandoned */
+                lookup_batch_respond (h, msg, batch, i, cbd.errnum);
+            }
+        }
+    }
+    if (wait) {
+        if (wait_get_usecount (wait) > 0) {
+            if (wait_msg_aux_set (wait, "lookup_batch", batch, NULL) < 0) {
+                flux_log_error (h, "%s: wait_msg_aux_set", __FUNCTION__);
+                /* replay will start over, responses would be repeated */
+                batch->errnum = errno;
+            }
+            else
+                return;
+        }
+        wait_destroy (wait);
     }
-    lookup_destroy (lh);
-    json_decref (val);
-    return;
+    /* every key was answered, or a failure prevents stalling */
+    for (int i = 0; i < batch->count; i++) {
+        if (batch->lh[i]) {
+            lookup_batch_respond (h,
+                                  msg,
+                                  batch,
+                                  i,
+                                  batch->errnum ? batch->errnum : EPROTO);
+        }
+    }
+    lookup_batch_destroy (batch);
+    errno = ENODATA;
 error:
     if (flux_respond_error (h, msg, errno, NULL) < 0)
         flux_log_error (h, "%s: flux_respond_error", __FUNCTION__);
 }
 
-
 static int finalize_transaction_req (treq_t *tr,
                                      const flux_msg_t *req,
                                      void *data)
@@ -1530,6 +2554,8 @@ static int finalize_transaction_req (treq_t *tr,
                                "rootseq", cbd->root->seq) < 0)
             flux_log_error (cbd->ctx->h, "%s: flux_respond_pack", __FUNCTION__);
     }
+    stats_timing_end (cbd->ctx, req, "kvs.commit");
+    top_commit_end (cbd->ctx, req);
 
     return 0;
 }
@@ -1596,6 +2622,25 @@ static int guest_commit_authorize (json_t *ops, flux_error_t *error)
     return 0;
 }
 
+/* Queue a transaction on the root's kvstxn manager.  Transactions
+ * requested by guests are queued separately from the instance owner's
+ * so that guest load cannot starve owner commits (see kvstxn.c).
+ */
+static int transaction_add (struct kvsroot *root,
+                            const char *name,
+                            json_t *ops,
+                            int flags,
+                            struct flux_msg_cred cred)
+{
+    if ((cred.rolemask & FLUX_ROLE_OWNER))
+        return kvstxn_mgr_add_transaction (root->ktm, name, ops, flags, 0);
+    return kvstxn_mgr_add_guest_transaction (root->ktm,
+                                             name,
+                                             ops,
+                                             flags,
+                                             cred.userid);
+}
+
 /* kvs.relaycommit (rank 0 only, no response).
  */
 static void relaycommit_request_cb (flux_t *h, flux_msg_handler_t *mh,
@@ -1607,12 +2652,17 @@ static void relaycommit_request_cb (flux_t *h, flux_msg_handler_t *mh,
     const char *name;
     int flags;
     json_t *ops = NULL;
+    struct flux_msg_cred cred = { .userid = 0, .rolemask = FLUX_ROLE_OWNER };
 
-    if (flux_request_unpack (msg, NULL, "{ s:o s:s s:s s:i }",
+    /* The relay carries the credentials of the original requestor.
+     */
+    if (flux_request_unpack (msg, NULL, "{ s:o s:s s:s s:i s?i s?i }",
                              "ops", &ops,
                              "name", &name,
                              "namespace", &ns,
-                             "flags", &flags) < 0) {
+                             "flags", &flags,
+                             "userid", &cred.userid,
+                             "rolemask", &cred.rolemask) < 0) {
         flux_log_error (h, "%s: flux_request_unpack", __FUNCTION__);
         return;
     }
@@ -1623,7 +2673,7 @@ static void relaycommit_request_cb (flux_t *h, flux_msg_handler_t *mh,
         goto error;
     }
 
-    if (kvstxn_mgr_add_transaction (root->ktm, name, ops, flags, 0) < 0) {
+    if (transaction_add (root, name, ops, flags, cred) < 0) {
         flux_log_error (h, "%s: kvstxn_mgr_add_transaction",
                         __FUNCTION__);
         goto error;
@@ -1656,7 +2706,10 @@ static void commit_request_cb (flux_t *h, flux_msg_handler_t *mh,
     treq_t *tr;
     flux_error_t error;
     const char *errmsg = NULL;
+    struct flux_msg_cred cred;
 
+    stats_timing_start (ctx, msg);
+    top_start (ctx, msg);
     if (flux_request_unpack (msg, NULL, "{ s:o s:s s:i }",
                              "ops", &ops,
                              "namespace", &ns,
@@ -1664,6 +2717,8 @@ static void commit_request_cb (flux_t *h, flux_msg_handler_t *mh,
         flux_log_error (h, "%s: flux_request_unpack", __FUNCTION__);
         goto error;
     }
+    if (flux_msg_get_cred (msg, &cred) < 0)
+        goto error;
     if (flux_msg_authorize (msg, FLUX_USERID_UNKNOWN) < 0
         && guest_commit_authorize (ops, &error) < 0) {
         errmsg = error.text;
@@ -1702,11 +2757,11 @@ static void commit_request_cb (flux_t *h, flux_msg_handler_t *mh,
          */
         treq_set_processed (tr, true);
 
-        if (kvstxn_mgr_add_transaction (root->ktm,
-                                        treq_get_name (tr),
-                                        ops,
-                                        flags,
-                                        0) < 0) {
+        if (transaction_add (root,
+                             treq_get_name (tr),
+                             ops,
+                             flags,
+                             cred) < 0) {
             flux_log_error (h, "%s: kvstxn_mgr_add_transaction",
                             __FUNCTION__);
             goto error;
@@ -1719,11 +2774,13 @@ static void commit_request_cb (flux_t *h, flux_msg_handler_t *mh,
 
         /* route to rank 0 as instance owner */
         if (!(f = flux_rpc_pack (h, "kvs.relaycommit", 0, FLUX_RPC_NORESPONSE,
-                                 "{ s:O s:s s:s s:i }",
+                                 "{ s:O s:s s:s s:i s:i s:i }",
                                  "ops", ops,
                                  "name", treq_get_name (tr),
                                  "namespace", ns,
-                                 "flags", flags))) {
+                                 "flags", flags,
+                                 "userid", cred.userid,
+                                 "rolemask", cred.rolemask))) {
             flux_log_error (h, "%s: flux_rpc_pack", __FUNCTION__);
             goto error;
         }
@@ -1737,7 +2794,139 @@ error:
 }
 
 
-/* kvs.relayfence (rank 0 only, no response).
+static void relayfence_destroy (struct relayfence *rf)
+{
+    if (rf) {
+        int saved_errno = errno;
+        list_del (&rf->node);
+        free (rf->ns);
+        free (rf->name);
+        json_decref (rf->ops);
+        free (rf);
+        errno = saved_errno;
+    }
+}
+
+static struct relayfence *relayfence_lookup (struct kvs_ctx *ctx,
+                                             const char *ns,
+                                             const char *name)
+{
+    struct relayfence *rf;
+
+    list_for_each (&ctx->relayfence_pending, rf, node) {
+        if (streq (rf->name, name) && streq (rf->ns, ns))
+            return rf;
+    }
+    return NULL;
+}
+
+/* Send merged participants upstream.  On failure, fail the fence as
+ * rank 0 would, since its participants would otherwise hang.
+ */
+static void relayfence_send (struct kvs_ctx *ctx, struct relayfence *rf)
+{
+    flux_future_t *f;
+
+    /* route to rank 0 as instance owner, via the parent */
+    if (!(f = flux_rpc_pack (ctx->h,
+                             "kvs.relayfence",
+                             FLUX_NODEID_UPSTREAM,
+                             FLUX_RPC_NORESPONSE,
+                             "{ s:O s:s s:s s:i s:i s:i s:i s:i }",
+                             "ops", rf->ops,
+                             "name", rf->name,
+                             "namespace", rf->ns,
+                             "flags", rf->flags,
+                             "nprocs", rf->nprocs,
+                             "count", rf->count,
+                             "userid", rf->cred.userid,
+                             "rolemask", rf->cred.rolemask))) {
+        flux_log_error (ctx->h, "%s: flux_rpc_pack", __FUNCTION__);
+        if (error_event_send_to_name (ctx, rf->ns, rf->name, errno) < 0)
+            flux_log_error (ctx->h,
+                            "%s: error_event_send_to_name",
+                            __FUNCTION__);
+    }
+    else {
+        ctx->relayfence_stats.rpcs++;
+        ctx->relayfence_stats.participants += rf->count;
+    }
+    flux_future_destroy (f);
+    relayfence_destroy (rf);
+}
+
+static void relayfence_timer_cb (flux_reactor_t *r,
+                                 flux_watcher_t *w,
+                                 int revents,
+                                 void *arg)
+{
+    struct kvs_ctx *ctx = arg;
+    struct relayfence *rf;
+
+    while ((rf = list_top (&ctx->relayfence_pending,
+                           struct relayfence,
+                           node)))
+        relayfence_send (ctx, rf);
+}
+
+/* Merge 'count' participants of fence 'name' into any pending relay,
+ * sending it at once if that completes the fence.
+ */
+static int relayfence_add (struct kvs_ctx *ctx,
+                           const char *ns,
+                           const char *name,
+                           int flags,
+                           int nprocs,
+                           int count,
+                           json_t *ops,
+                           struct flux_msg_cred cred)
+{
+    struct relayfence *rf;
+
+    if (!(rf = relayfence_lookup (ctx, ns, name))) {
+        if (!(rf = calloc (1, sizeof (*rf))))
+            return -1;
+        list_node_init (&rf->node);
+        if (!(rf->ns = strdup (ns))
+            || !(rf->name = strdup (name))
+            || !(rf->ops = json_array ())) {
+            relayfence_destroy (rf);
+            errno = ENOMEM;
+            return -1;
+        }
+        rf->flags = flags;
+        rf->nprocs = nprocs;
+        list_add_tail (&ctx->relayfence_pending, &rf->node);
+    }
+    if (rf->flags != flags || rf->nprocs != nprocs) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (count <= 0 || (ops && !json_is_array (ops))) {
+        errno = EPROTO;
+        return -1;
+    }
+    if (count > nprocs - rf->count) {
+        errno = EOVERFLOW;
+        return -1;
+    }
+    if (ops && json_array_extend (rf->ops, ops) < 0) {
+        errno = ENOMEM;
+        return -1;
+    }
+    rf->count += count;
+    rf->cred = cred;
+    if (rf->count == rf->nprocs)
+        relayfence_send (ctx, rf);
+    else
+        flux_watcher_start (ctx->relayfence_w);
+    return 0;
+}
+
+/* kvs.relayfence (no response).
+ * Sent upstream by the kvs module on a child broker, carrying the
+ * merged ops of 'count' participants.  Rank 0 adds them to the fence,
+ * other ranks merge them into their own relay.
  */
 static void relayfence_request_cb (flux_t *h, flux_msg_handler_t *mh,
                                    const flux_msg_t *msg, void *arg)
@@ -1747,19 +2936,40 @@ static void relayfence_request_cb (flux_t *h, flux_msg_handler_t *mh,
     const char *ns;
     const char *name;
     int saved_errno, nprocs, flags;
+    int count = 1;
     json_t *ops = NULL;
     treq_t *tr;
+    struct flux_msg_cred cred = { .userid = 0, .rolemask = FLUX_ROLE_OWNER };
 
-    if (flux_request_unpack (msg, NULL, "{ s:o s:s s:s s:i s:i }",
+    /* The relay carries the credentials of the original requestor.
+     * A fence is queued according to those of its last participant.
+     */
+    if (flux_request_unpack (msg, NULL, "{ s:o s:s s:s s:i s:i s?i s?i s?i }",
                              "ops", &ops,
                              "name", &name,
                              "namespace", &ns,
                              "flags", &flags,
-                             "nprocs", &nprocs) < 0) {
+                             "nprocs", &nprocs,
+                             "count", &count,
+                             "userid", &cred.userid,
+                             "rolemask", &cred.rolemask) < 0) {
         flux_log_error (h, "%s: flux_request_unpack", __FUNCTION__);
         return;
     }
 
+    if (ctx->rank > 0) {
+        if (relayfence_add (ctx,
+                            ns,
+                            name,
+                            flags,
+                            nprocs,
+                            count,
+                            ops,
+                            cred) < 0)
+            goto error;
+        return;
+    }
+
     /* namespace must exist given we are on rank 0 */
     if (!(root = kvsroot_mgr_lookup_root_safe (ctx->krm, ns))) {
         errno = ENOTSUP;
@@ -1786,8 +2996,8 @@ static void relayfence_request_cb (flux_t *h, flux_msg_handler_t *mh,
         goto error;
     }
 
-    if (treq_add_request_ops (tr, ops) < 0) {
-        flux_log_error (h, "%s: treq_add_request_ops", __FUNCTION__);
+    if (treq_add_request_ops_count (tr, ops, count) < 0) {
+        flux_log_error (h, "%s: treq_add_request_ops_count", __FUNCTION__);
         goto error;
     }
 
@@ -1801,11 +3011,11 @@ static void relayfence_request_cb (flux_t *h, flux_msg_handler_t *mh,
          * the ready queue */
         treq_set_processed (tr, true);
 
-        if (kvstxn_mgr_add_transaction (root->ktm,
-                                        treq_get_name (tr),
-                                        treq_get_ops (tr),
-                                        treq_get_flags (tr),
-                                        0) < 0) {
+        if (transaction_add (root,
+                             treq_get_name (tr),
+                             treq_get_ops (tr),
+                             treq_get_flags (tr),
+                             cred) < 0) {
             flux_log_error (h, "%s: kvstxn_mgr_add_transaction",
                             __FUNCTION__);
             goto error;
@@ -1841,7 +3051,9 @@ static void fence_request_cb (flux_t *h, flux_msg_handler_t *mh,
     treq_t *tr;
     flux_error_t error;
     const char *errmsg = NULL;
+    struct flux_msg_cred cred;
 
+    top_start (ctx, msg);
     if (flux_request_unpack (msg, NULL, "{ s:o s:s s:s s:i s:i }",
                              "ops", &ops,
                              "name", &name,
@@ -1851,6 +3063,8 @@ static void fence_request_cb (flux_t *h, flux_msg_handler_t *mh,
         flux_log_error (h, "%s: flux_request_unpack", __FUNCTION__);
         goto error;
     }
+    if (flux_msg_get_cred (msg, &cred) < 0)
+        goto error;
     if (flux_msg_authorize (msg, FLUX_USERID_UNKNOWN) < 0
         && guest_commit_authorize (ops, &error) < 0) {
         errno = EPERM;
@@ -1911,11 +3125,11 @@ static void fence_request_cb (flux_t *h, flux_msg_handler_t *mh,
              * the ready queue */
             treq_set_processed (tr, true);
 
-            if (kvstxn_mgr_add_transaction (root->ktm,
-                                            treq_get_name (tr),
-                                            treq_get_ops (tr),
-                                            treq_get_flags (tr),
-                                            0) < 0) {
+            if (transaction_add (root,
+                                 treq_get_name (tr),
+                                 treq_get_ops (tr),
+                                 treq_get_flags (tr),
+                                 cred) < 0) {
                 flux_log_error (h, "%s: kvstxn_mgr_add_transaction",
                                 __FUNCTION__);
                 goto error;
@@ -1925,20 +3139,8 @@ static void fence_request_cb (flux_t *h, flux_msg_handler_t *mh,
         }
     }
     else {
-        flux_future_t *f;
-
-        /* route to rank 0 as instance owner */
-        if (!(f = flux_rpc_pack (h, "kvs.relayfence", 0, FLUX_RPC_NORESPONSE,
-                                 "{ s:O s:s s:s s:i s:i }",
-                                 "ops", ops,
-                                 "name", name,
-                                 "namespace", ns,
-                                 "flags", flags,
-                                 "nprocs", nprocs))) {
-            flux_log_error (h, "%s: flux_rpc_pack", __FUNCTION__);
+        if (relayfence_add (ctx, ns, name, flags, nprocs, 1, ops, cred) < 0)
             goto error;
-        }
-        flux_future_destroy (f);
     }
     return;
 
@@ -2077,11 +3279,59 @@ static void error_event_cb (flux_t *h, flux_msg_handler_t *mh,
     finalize_transaction_bynames (ctx, root, names, errnum);
 }
 
+/* Add dir objects from a setroot event delta to the cache, so that
+ * lookups under the new root need not load them from the content store.
+ * Objects already in the cache, including those still being loaded, are
+ * left alone.  This is only an optimization, so errors are logged and
+ * otherwise ignored.
+ */
+static void setroot_delta_insert (struct kvs_ctx *ctx, json_t *delta)
+{
+    const char *ref;
+    json_t *o;
+
+    json_object_foreach (delta, ref, o) {
+        struct cache_entry *entry;
+        const char *xdata;
+        size_t xlen, databuflen;
+        ssize_t datalen;
+        char *data;
+
+        if (!(xdata = json_string_value (o))
+            || (xlen = strlen (xdata)) == 0
+            || cache_lookup (ctx->cache, ref))
+            continue;
+        databuflen = base64_decoded_length (xlen);
+        if (!(data = malloc (databuflen))) {
+            flux_log_error (ctx->h, "%s: malloc", __FUNCTION__);
+            return;
+        }
+        if ((datalen = base64_decode (data, databuflen, xdata, xlen)) <= 0) {
+            flux_log (ctx->h, LOG_ERR, "%s: invalid delta", __FUNCTION__);
+            free (data);
+            return;
+        }
+        if (!(entry = cache_entry_create (ref))
+            || cache_entry_set_raw (entry, data, datalen) < 0) {
+            flux_log_error (ctx->h, "%s: cache_entry_create", __FUNCTION__);
+            cache_entry_destroy (entry);
+            free (data);
+            return;
+        }
+        free (data);
+        if (cache_insert (ctx->cache, entry) < 0) {
+            flux_log_error (ctx->h, "%s: cache_insert", __FUNCTION__);
+            cache_entry_destroy (entry);
+            return;
+        }
+    }
+}
+
 /* Alter the (rootref, rootseq) in response to a setroot event.
  */
 static void setroot_event_process (struct kvs_ctx *ctx, struct kvsroot *root,
                                    json_t *names, const char *rootref,
-                                   int rootseq)
+                                   int rootseq, json_t *delta)
 {
     int errnum = 0;
 
@@ -2096,6 +3346,9 @@ static void setroot_event_process (struct kvs_ctx *ctx, struct kvsroot *root,
     if (errnum)
         return;
 
+    if (delta && rootseq > root->seq)
+        setroot_delta_insert (ctx, delta);
+
     setroot (ctx, root, rootref, rootseq);
 }
 
@@ -2108,12 +3361,14 @@ static void setroot_event_cb (flux_t *h, flux_msg_handler_t *mh,
     int rootseq;
     const char *rootref;
     json_t *names = NULL;
+    json_t *delta = NULL;
 
-    if (flux_event_unpack (msg, NULL, "{ s:s s:i s:s s:o }",
+    if (flux_event_unpack (msg, NULL, "{ s:s s:i s:s s:o s?o }",
                            "namespace", &ns,
                            "rootseq", &rootseq,
                            "rootref", &rootref,
-                           "names", &names) < 0) {
+                           "names", &names,
+                           "delta", &delta) < 0) {
         flux_log_error (ctx->h, "%s: flux_event_unpack", __FUNCTION__);
         return;
     }
@@ -2149,7 +3404,7 @@ static void setroot_event_cb (flux_t *h, flux_msg_handler_t *mh,
         return;
     }
 
-    setroot_event_process (ctx, root, names, rootref, rootseq);
+    setroot_event_process (ctx, root, names, rootref, rootseq, delta);
 }
 
 static bool disconnect_cmp (const flux_msg_t *msg, void *arg)
@@ -2194,7 +3449,7 @@ static int stats_get_root_cb (struct kvsroot *root, void *arg)
     json_t *nsstats = arg;
     json_t *s;
 
-    if (!(s = json_pack ("{ s:i s:i s:i s:i s:i }",
+    if (!(s = json_pack ("{ s:i s:i s:i s:i s:i s:i s:i }",
                          "#versionwaiters",
                          zlist_size (root->wait_version_list),
                          "#no-op stores",
@@ -2203,6 +3458,10 @@ static int stats_get_root_cb (struct kvsroot *root, void *arg)
                          treq_mgr_transactions_count (root->trm),
                          "#readytransactions",
                          kvstxn_mgr_ready_transaction_count (root->ktm),
+                         "#ownerpending",
+                         kvstxn_mgr_owner_pending_count (root->ktm),
+                         "#guestpending",
+                         kvstxn_mgr_guest_pending_count (root->ktm),
                          "store revision", root->seq))) {
         errno = ENOMEM;
         return -1;
@@ -2219,10 +3478,13 @@ static void stats_get_cb (flux_t *h, flux_msg_handler_t *mh,
     json_t *tstats = NULL;
     json_t *cstats = NULL;
     json_t *nsstats = NULL;
+    json_t *top = NULL;
     tstat_t ts = { .min = 0.0, .max = 0.0, .M = 0.0, .S = 0.0, .newM = 0.0,
                    .newS = 0.0, .n = 0 };
     int size = 0, incomplete = 0, dirty = 0;
     double scale = 1E-3;
+    struct cache_counters cc;
+    double hit_rate = 0.;
 
     if (flux_request_decode (msg, NULL, NULL) < 0)
         goto error;
@@ -2232,6 +3494,9 @@ static void stats_get_cb (flux_t *h, flux_msg_handler_t *mh,
         if (cache_get_stats (ctx->cache, &ts, &size, &incomplete, &dirty) < 0)
             goto error;
     }
+    cache_get_counters (ctx->cache, &cc);
+    if (cc.hits + cc.misses > 0)
+        hit_rate = (double)cc.hits / (cc.hits + cc.misses);
 
     if (!(tstats = json_pack ("{ s:i s:f s:f s:f s:f }",
                               "count", tstat_count (&ts),
@@ -2241,12 +3506,24 @@ static void stats_get_cb (flux_t *h, flux_msg_handler_t *mh,
                               "max", tstat_max (&ts)*scale)))
         goto nomem;
 
-    if (!(cstats = json_pack ("{ s:f s:O s:i s:i s:i }",
+    if (!(cstats = json_pack ("{ s:f s:O s:i s:i s:i"
+                              "  s:I s:I s:I s:I s:f s:I s:I s:I s:i }",
                               "obj size total (MiB)", (double)size/1048576,
                               "obj size (KiB)", tstats,
                               "#obj dirty", dirty,
                               "#obj incomplete", incomplete,
-                              "#faults", ctx->faults)))
+                              "#faults", ctx->faults,
+                              "#hits", (json_int_t)cc.hits,
+                              "#misses", (json_int_t)cc.misses,
+                              "#evictions", (json_int_t)cc.evictions,
+                              "#expirations", (json_int_t)cc.expirations,
+                              "hit rate", hit_rate,
+                              "resident bytes",
+                              (json_int_t)cache_get_resident_size (ctx->cache),
+                              "max bytes",
+                              (json_int_t)cache_get_max_size (ctx->cache),
+                              "#path hits", (json_int_t)cc.path_hits,
+                              "#paths", cache_path_count (ctx->cache))))
         goto nomem;
 
     if (!(nsstats = json_object ()))
@@ -2275,14 +3552,35 @@ static void stats_get_cb (flux_t *h, flux_msg_handler_t *mh,
         }
     }
 
+    if (!(top = top_get (ctx, msg)))
+        goto error;
+
     if (flux_respond_pack (h, msg,
-                           "{ s:O s:O }",
+                           "{ s:O s:O s:{s:I s:I s:I} s:{s:I s:I} s:O"
+                           " s:{s:b} }",
                            "cache", cstats,
-                           "namespace", nsstats) < 0)
+                           "namespace", nsstats,
+                           "getroot",
+                             "#rpcs",
+                             (json_int_t)ctx->getroot_stats.rpcs,
+                             "#coalesced",
+                             (json_int_t)ctx->getroot_stats.coalesced,
+                             "#prefetched",
+                             (json_int_t)ctx->getroot_stats.prefetched,
+                           "relayfence",
+                             "#rpcs",
+                             (json_int_t)ctx->relayfence_stats.rpcs,
+                             "#participants",
+                             (json_int_t)ctx->relayfence_stats.participants,
+                           "top", top,
+                           "gc",
+                             "active", kvstxn_get_gc_active ())
+        < 0)
         flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
     json_decref (tstats);
     json_decref (cstats);
     json_decref (nsstats);
+    json_decref (top);
     return;
 nomem:
     errno = ENOMEM;
@@ -2292,6 +3590,7 @@ error:
     json_decref (tstats);
     json_decref (cstats);
     json_decref (nsstats);
+    json_decref (top);
 }
 
 static int stats_clear_root_cb (struct kvsroot *root, void *arg)
@@ -2303,6 +3602,12 @@ static int stats_clear_root_cb (struct kvsroot *root, void *arg)
 static void stats_clear (struct kvs_ctx *ctx)
 {
     ctx->faults = 0;
+    memset (&ctx->getroot_stats, 0, sizeof (ctx->getroot_stats));
+    memset (&ctx->relayfence_stats, 0, sizeof (ctx->relayfence_stats));
+    cache_clear_counters (ctx->cache);
+    topn_clear (ctx->top.ns);
+    topn_clear (ctx->top.prefix);
+    topn_clear (ctx->top.userid);
 
     if (kvsroot_mgr_iter_roots (ctx->krm, stats_clear_root_cb, NULL) < 0)
         flux_log_error (ctx->h, "%s: kvsroot_mgr_iter_roots", __FUNCTION__);
@@ -2368,11 +3673,12 @@ static int namespace_create (struct kvs_ctx *ctx, const char *ns,
         goto cleanup;
 
     if (!(msg = flux_event_pack (topic,
-                                 "{ s:s s:i s:s s:i }",
+                                 "{ s:s s:i s:s s:i s:i }",
                                  "namespace", root->ns_name,
                                  "rootseq", root->seq,
                                  "rootref", root->ref,
-                                 "owner", root->owner))) {
+                                 "owner", root->owner,
+                                 "flags", root->flags))) {
         flux_log_error (ctx->h, "%s: flux_event_pack", __FUNCTION__);
         goto cleanup;
     }
@@ -2463,7 +3769,7 @@ static void start_root_remove (struct kvs_ctx *ctx, const char *ns)
     if ((root = kvsroot_mgr_lookup_root_safe (ctx->krm, ns))) {
         struct kvs_cb_data cbd = { .ctx = ctx, .root = root };
 
-        root->remove = true;
+        kvsroot_mark_remove (ctx->krm, root);
 
         work_queue_remove (root);
 
@@ -2566,6 +3872,43 @@ error:
         flux_log_error (h, "%s: flux_respond_error", __FUNCTION__);
 }
 
+/* A follower that receives namespace events for all namespaces (see
+ * kvs_ctx_create()) creates the root of a new namespace when it is
+ * announced, so the first clients of the namespace on this rank, e.g.
+ * those of a job that is starting, need not wait for a getroot RPC.
+ * The root is kept current by setroot events like any other, and
+ * expires after 'max_namespace_age' seconds without an update.
+ */
+static void namespace_created_event_cb (flux_t *h, flux_msg_handler_t *mh,
+                                        const flux_msg_t *msg, void *arg)
+{
+    struct kvs_ctx *ctx = arg;
+    const char *ns;
+    int rootseq;
+    const char *ref;
+    uint32_t owner;
+    int flags = 0;
+    struct kvsroot *root;
+
+    if (ctx->rank == 0 || !ctx->subscribe_all)
+        return;
+    if (flux_event_unpack (msg, NULL, "{ s:s s:i s:s s:i s?i }",
+                           "namespace", &ns,
+                           "rootseq", &rootseq,
+                           "rootref", &ref,
+                           "owner", &owner,
+                           "flags", &flags) < 0) {
+        flux_log_error (ctx->h, "%s: flux_event_unpack", __FUNCTION__);
+        return;
+    }
+    if (kvsroot_mgr_lookup_root (ctx->krm, ns))
+        return;
+    if (!(root = getroot_create (ctx, ns, owner, flags)))
+        return;
+    setroot (ctx, root, ref, rootseq);
+    ctx->getroot_stats.prefetched++;
+}
+
 static void namespace_removed_event_cb (flux_t *h, flux_msg_handler_t *mh,
                                         const flux_msg_t *msg, void *arg)
 {
@@ -2685,17 +4028,19 @@ static void setroot_unpause_process_msg (struct kvs_ctx *ctx,
     int rootseq;
     const char *rootref;
     json_t *names = NULL;
+    json_t *delta = NULL;
 
-    if (flux_event_unpack (msg, NULL, "{ s:s s:i s:s s:o }",
+    if (flux_event_unpack (msg, NULL, "{ s:s s:i s:s s:o s?o }",
                            "namespace", &ns,
                            "rootseq", &rootseq,
                            "rootref", &rootref,
-                           "names", &names) < 0) {
+                           "names", &names,
+                           "delta", &delta) < 0) {
         flux_log_error (ctx->h, "%s: flux_event_unpack", __FUNCTION__);
         return;
     }
 
-    setroot_event_process (ctx, root, names, rootref, rootseq);
+    setroot_event_process (ctx, root, names, rootref, rootseq, delta);
     return;
 }
 
@@ -2742,6 +4087,255 @@ error:
         flux_log_error (h, "%s: flux_respond_error", __FUNCTION__);
 }
 
+static int gc_pending_root_cb (struct kvsroot *root, void *arg)
+{
+    bool *pending = arg;
+
+    if (kvstxn_mgr_gc_pending (root->ktm)) {
+        *pending = true;
+        return 1;
+    }
+    return 0;
+}
+
+/* Respond to kvs.gc-begin requests once no transaction started before
+ * gc became active is still being processed.  Such a transaction may have
+ * skipped stores of cached blobs, so its new root must be visible to the
+ * garbage collector.  Called from the prep watcher until drained.
+ */
+static void gc_begin_check (struct kvs_ctx *ctx)
+{
+    const flux_msg_t *msg;
+    bool pending = false;
+
+    if (kvsroot_mgr_iter_roots (ctx->krm, gc_pending_root_cb, &pending) < 0) {
+        flux_log_error (ctx->h, "%s: kvsroot_mgr_iter_roots", __FUNCTION__);
+        return;
+    }
+    if (pending)
+        return;
+    while ((msg = flux_msglist_pop (ctx->gc_requests))) {
+        if (flux_respond (ctx->h, msg, NULL) < 0)
+            flux_log_error (ctx->h, "%s: flux_respond", __FUNCTION__);
+        flux_msg_decref (msg);
+    }
+}
+
+/* The content module sends this when a garbage collection pass begins,
+ * before it collects KVS roots.  From now on, transactions store blobs
+ * even if they are already cached, so that blobs that become referenced
+ * again during the pass are protected from the sweep.
+ */
+static void gc_begin_request_cb (flux_t *h, flux_msg_handler_t *mh,
+                                 const flux_msg_t *msg, void *arg)
+{
+    struct kvs_ctx *ctx = arg;
+
+    if (flux_request_decode (msg, NULL, NULL) < 0)
+        goto error;
+    if (flux_msglist_append (ctx->gc_requests, msg) < 0)
+        goto error;
+    kvstxn_set_gc_active (true);
+    gc_begin_check (ctx);
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        flux_log_error (h, "%s: flux_respond_error", __FUNCTION__);
+}
+
+/* The content module sends this when a garbage collection pass ends
+ * or is aborted.
+ */
+static void gc_end_request_cb (flux_t *h, flux_msg_handler_t *mh,
+                               const flux_msg_t *msg, void *arg)
+{
+    if (flux_request_decode (msg, NULL, NULL) < 0)
+        goto error;
+    kvstxn_set_gc_active (false);
+    if (flux_respond (h, msg, NULL) < 0)
+        flux_log_error (h, "%s: flux_respond", __FUNCTION__);
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        flux_log_error (h, "%s: flux_respond_error", __FUNCTION__);
+}
+
+/* Parse [kvs] cache-max-size, a byte count with optional suffix
+ * (see parse_size()).  If unset, the cache size is unlimited.
+ */
+static int cache_config_parse (struct kvs_ctx *ctx,
+                               const flux_conf_t *conf,
+                               flux_error_t *errp)
+{
+    flux_error_t error;
+    const char *str = NULL;
+    uint64_t size = 0;
+
+    if (flux_conf_unpack (conf,
+                          &error,
+                          "{s?{s?s}}",
+                          "kvs",
+                          "cache-max-size", &str) < 0) {
+        errprintf (errp,
+                   "error reading config for kvs: %s",
+                   error.text);
+        return -1;
+    }
+    if (str) {
+        if (parse_size (str, &size) < 0 || size > SIZE_MAX) {
+            errprintf (errp, "invalid kvs.cache-max-size: '%s'", str);
+            errno = EINVAL;
+            return -1;
+        }
+    }
+    cache_set_max_size (ctx->cache, size);
+    return 0;
+}
+
+/* Parse [kvs] dirshard-threshold, the number of entries a directory may
+ * hold before it is stored as a sharded directory.  Zero disables
+ * sharding.
+ */
+static int dirshard_config_parse (const flux_conf_t *conf, flux_error_t *errp)
+{
+    flux_error_t error;
+    int threshold = KVSTXN_DIRSHARD_THRESHOLD_DEFAULT;
+
+    if (flux_conf_unpack (conf,
+                          &error,
+                          "{s?{s?i}}",
+                          "kvs",
+                          "dirshard-threshold", &threshold) < 0) {
+        errprintf (errp,
+                   "error reading config for kvs: %s",
+                   error.text);
+        return -1;
+    }
+    if (threshold < 0) {
+        errprintf (errp, "invalid kvs.dirshard-threshold: %d", threshold);
+        errno = EINVAL;
+        return -1;
+    }
+    kvstxn_set_dirshard_threshold (threshold);
+    return 0;
+}
+
+/* Parse [kvs] treeobj-format, either "json" (the default) or "binary".
+ */
+static int treeobj_config_parse (const flux_conf_t *conf, flux_error_t *errp)
+{
+    flux_error_t error;
+    const char *str = "json";
+
+    if (flux_conf_unpack (conf,
+                          &error,
+                          "{s?{s?s}}",
+                          "kvs",
+                          "treeobj-format", &str) < 0) {
+        errprintf (errp,
+                   "error reading config for kvs: %s",
+                   error.text);
+        return -1;
+    }
+    if (!streq (str, "json") && !streq (str, "binary")) {
+        errprintf (errp, "invalid kvs.treeobj-format: '%s'", str);
+        errno = EINVAL;
+        return -1;
+    }
+    kvstxn_set_treeobj_binary (streq (str, "binary"));
+    return 0;
+}
+
+/* Parse [kvs] setroot-delta-max-size, a byte count with optional suffix
+ * (see parse_size()).  If unset, setroot events carry no delta.
+ */
+static int delta_config_parse (const flux_conf_t *conf, flux_error_t *errp)
+{
+    flux_error_t error;
+    const char *str = NULL;
+    uint64_t size = 0;
+
+    if (flux_conf_unpack (conf,
+                          &error,
+                          "{s?{s?s}}",
+                          "kvs",
+                          "setroot-delta-max-size", &str) < 0) {
+        errprintf (errp,
+                   "error reading config for kvs: %s",
+                   error.text);
+        return -1;
+    }
+    if (str) {
+        if (parse_size (str, &size) < 0 || size > SIZE_MAX) {
+            errprintf (errp, "invalid kvs.setroot-delta-max-size: '%s'", str);
+            errno = EINVAL;
+            return -1;
+        }
+    }
+    kvstxn_set_delta_max_size (size);
+    return 0;
+}
+
+/* Parse [kvs] top-size, the number of entries in each top-N table
+ * (zero disables tracking), and top-sample, the sampling period.
+ * The tables are reset if their size changes.
+ */
+static int top_config_parse (struct kvs_ctx *ctx,
+                             const flux_conf_t *conf,
+                             flux_error_t *errp)
+{
+    flux_error_t error;
+    int size = TOP_SIZE_DEFAULT;
+    int sample = TOP_SAMPLE_DEFAULT;
+    struct topn *ns = NULL;
+    struct topn *prefix = NULL;
+    struct topn *userid = NULL;
+
+    if (flux_conf_unpack (conf,
+                          &error,
+                          "{s?{s?i s?i}}",
+                          "kvs",
+                            "top-size", &size,
+                            "top-sample", &sample) < 0) {
+        errprintf (errp,
+                   "error reading config for kvs: %s",
+                   error.text);
+        return -1;
+    }
+    if (size < 0) {
+        errprintf (errp, "invalid kvs.top-size: %d", size);
+        errno = EINVAL;
+        return -1;
+    }
+    if (sample < 1) {
+        errprintf (errp, "invalid kvs.top-sample: %d", sample);
+        errno = EINVAL;
+        return -1;
+    }
+    ctx->top.sample = sample;
+    if (size == ctx->top.size)
+        return 0;
+    if (size > 0) {
+        if (!(ns = topn_create (size))
+            || !(prefix = topn_create (size))
+            || !(userid = topn_create (size))) {
+            errprintf (errp, "error creating kvs top-N tables");
+            topn_destroy (ns);
+            topn_destroy (prefix);
+            topn_destroy (userid);
+            return -1;
+        }
+    }
+    topn_destroy (ctx->top.ns);
+    topn_destroy (ctx->top.prefix);
+    topn_destroy (ctx->top.userid);
+    ctx->top.ns = ns;
+    ctx->top.prefix = prefix;
+    ctx->top.userid = userid;
+    ctx->top.size = size;
+    return 0;
+}
+
 static void config_reload_cb (flux_t *h,
                               flux_msg_handler_t *mh,
                               const flux_msg_t *msg,
@@ -2754,7 +4348,12 @@ static void config_reload_cb (flux_t *h,
 
     if (flux_conf_reload_decode (msg, &conf) < 0)
         goto error;
-    if (kvs_checkpoint_reload (ctx->kcp, conf, &error) < 0) {
+    if (kvs_checkpoint_reload (ctx->kcp, conf, &error) < 0
+        || cache_config_parse (ctx, conf, &error) < 0
+        || dirshard_config_parse (conf, &error) < 0
+        || delta_config_parse (conf, &error) < 0
+        || treeobj_config_parse (conf, &error) < 0
+        || top_config_parse (ctx, conf, &error) < 0) {
         errstr = error.text;
         goto error;
     }
@@ -2783,8 +4382,12 @@ static const struct flux_msg_handler_spec htab[] = {
                             wait_version_request_cb, FLUX_ROLE_USER },
     { FLUX_MSGTYPE_REQUEST, "kvs.lookup",
                             lookup_request_cb, FLUX_ROLE_USER },
+    { FLUX_MSGTYPE_REQUEST, "kvs.lookup-stream",
+                            lookup_stream_request_cb, FLUX_ROLE_USER },
     { FLUX_MSGTYPE_REQUEST, "kvs.lookup-plus",
                             lookup_plus_request_cb, FLUX_ROLE_USER },
+    { FLUX_MSGTYPE_REQUEST, "kvs.lookup-batch",
+                            lookup_batch_request_cb, FLUX_ROLE_USER },
     { FLUX_MSGTYPE_REQUEST, "kvs.commit",
                             commit_request_cb, FLUX_ROLE_USER },
     { FLUX_MSGTYPE_REQUEST, "kvs.relaycommit", relaycommit_request_cb, 0 },
@@ -2795,6 +4398,8 @@ static const struct flux_msg_handler_spec htab[] = {
                             namespace_create_request_cb, 0 },
     { FLUX_MSGTYPE_REQUEST, "kvs.namespace-remove",
                             namespace_remove_request_cb, 0 },
+    { FLUX_MSGTYPE_EVENT,   "kvs.namespace-*-created",
+                            namespace_created_event_cb, 0 },
     { FLUX_MSGTYPE_EVENT,   "kvs.namespace-*-removed",
                             namespace_removed_event_cb, 0 },
     { FLUX_MSGTYPE_REQUEST, "kvs.namespace-list",
@@ -2803,6 +4408,8 @@ static const struct flux_msg_handler_spec htab[] = {
                             setroot_pause_request_cb, FLUX_ROLE_USER },
     { FLUX_MSGTYPE_REQUEST, "kvs.setroot-unpause",
                             setroot_unpause_request_cb, FLUX_ROLE_USER },
+    { FLUX_MSGTYPE_REQUEST, "kvs.gc-begin", gc_begin_request_cb, 0 },
+    { FLUX_MSGTYPE_REQUEST, "kvs.gc-end", gc_end_request_cb, 0 },
     { FLUX_MSGTYPE_REQUEST, "kvs.config-reload", config_reload_cb, 0 },
     FLUX_MSGHANDLER_TABLE_END,
 };
@@ -2816,6 +4423,14 @@ static int process_config (struct kvs_ctx *ctx)
         flux_log (ctx->h, LOG_ERR, "%s", error.text);
         return -1;
     }
+    if (cache_config_parse (ctx, flux_get_conf (ctx->h), &error) < 0
+        || dirshard_config_parse (flux_get_conf (ctx->h), &error) < 0
+        || delta_config_parse (flux_get_conf (ctx->h), &error) < 0
+        || treeobj_config_parse (flux_get_conf (ctx->h), &error) < 0
+        || top_config_parse (ctx, flux_get_conf (ctx->h), &error) < 0) {
+        flux_log (ctx->h, LOG_ERR, "%s", error.text);
+        return -1;
+    }
     return 0;
 }
 
@@ -3034,6 +4649,7 @@ int mod_main (flux_t *h, int argc, char **argv)
         goto done;
     }
     if (!(f_heartbeat_sync = flux_sync_create (h, heartbeat_sync_min))
+            || flux_sync_set_jitter (f_heartbeat_sync, heartbeat_sync_max) < 0
             || flux_future_then (f_heartbeat_sync,
                                  heartbeat_sync_max,
                                  heartbeat_sync_cb,
@@ -21,6 +21,7 @@
 
 #include "src/common/libutil/errprintf.h"
 #include "src/common/libutil/fsd.h"
+#include "src/common/libkvs/kvs_checkpoint.h"
 
 #include "kvs_checkpoint.h"
 #include "kvsroot.h"
@@ -30,8 +31,7 @@ struct kvs_checkpoint {
     struct kvsroot *root_primary;
     double checkpoint_period;   /* in seconds */
     flux_watcher_t *checkpoint_w;
-    kvs_checkpoint_txn_cb txn_cb;
-    void *txn_cb_arg;
+    flux_future_t *f_checkpoint;    /* checkpoint in progress */
     int last_checkpoint_seq;
 };
 
@@ -106,65 +106,57 @@ int kvs_checkpoint_reload (kvs_checkpoint_t *kcp,
 }
 
 
+static void checkpoint_continuation (flux_future_t *f, void *arg)
+{
+    kvs_checkpoint_t *kcp = arg;
+
+    if (flux_rpc_get (f, NULL) < 0)
+        flux_log_error (kcp->h, "checkpoint-period checkpoint failed");
+    flux_future_destroy (f);
+    kcp->f_checkpoint = NULL;
+}
+
+/* Checkpoint the current root.  Its blobs have all been stored to the
+ * content cache, since a root is only set once its stores complete, so
+ * the content cache can write the checkpoint as soon as those blobs reach
+ * the backing store, without a flush.  Commits proceed in the meantime.
+ */
 static void checkpoint_cb (flux_reactor_t *r,
                            flux_watcher_t *w,
                            int revents,
                            void *arg)
 {
     kvs_checkpoint_t *kcp = arg;
-    char name[64];
-    json_t *ops = NULL;
+    flux_future_t *f;
 
-    /* if no changes to root since last checkpoint-period, do
-     * nothing */
-    if (kcp->last_checkpoint_seq == kcp->root_primary->seq)
+    /* if no changes to root since last checkpoint-period, or the last
+     * checkpoint is still waiting for its blobs, do nothing */
+    if (kcp->last_checkpoint_seq == kcp->root_primary->seq
+        || kcp->f_checkpoint)
         return;
 
-    snprintf (name,
-              sizeof (name),
-              "checkpoint-period.%u",
-              kcp->root_primary->seq);
-
-    if (!(ops = json_array ())) {
-        errno = ENOMEM;
-        flux_log_error (kcp->h, "checkpoint-period setup failure");
-        goto done;
-    }
-
-    /* Set FLUX_KVS_SYNC, to perform the checkpoint.
-     *
-     * Set KVSTXN_INTERNAL_FLAG_NO_PUBLISH, this is an internal KVS
-     * module transaction to checkpoint.  It has no operations so the
-     * KVS data will not change.  Therefore no setroot() needs to be
-     * called after this is done.
-     */
-    if (kvstxn_mgr_add_transaction (kcp->root_primary->ktm,
-                                    name,
-                                    ops,
-                                    FLUX_KVS_SYNC,
-                                    KVSTXN_INTERNAL_FLAG_NO_PUBLISH) < 0) {
-        flux_log_error (kcp->h, "%s: kvstxn_mgr_add_transaction",
-                        __FUNCTION__);
-        goto done;
+    if (!(f = kvs_checkpoint_commit (kcp->h,
+                                     NULL,
+                                     kcp->root_primary->ref,
+                                     kcp->root_primary->seq,
+                                     0,
+                                     KVS_CHECKPOINT_FLAG_DURABLE))
+        || flux_future_then (f, -1., checkpoint_continuation, kcp) < 0) {
+        flux_log_error (kcp->h, "checkpoint-period checkpoint failed");
+        flux_future_destroy (f);
+        return;
     }
-
-    if (kcp->txn_cb)
-        kcp->txn_cb (kcp->root_primary, kcp->txn_cb_arg);
+    kcp->f_checkpoint = f;
 
     /* N.B. "last_checkpoint_seq" protects against unnecessary
      * checkpointing when there is no activity in the primary KVS.
      */
     kcp->last_checkpoint_seq = kcp->root_primary->seq;
-
-done:
-    json_decref (ops);
 }
 
 kvs_checkpoint_t *kvs_checkpoint_create (flux_t *h,
                                          struct kvsroot *root_primary,
-                                         double checkpoint_period,
-                                         kvs_checkpoint_txn_cb txn_cb,
-                                         void *txn_cb_arg)
+                                         double checkpoint_period)
 {
     kvs_checkpoint_t *kcp = NULL;
 
@@ -174,8 +166,6 @@ kvs_checkpoint_t *kvs_checkpoint_create (flux_t *h,
     kcp->h = h;
     kcp->root_primary = root_primary; /* can be NULL initially */
     kcp->checkpoint_period = checkpoint_period;
-    kcp->txn_cb = txn_cb;
-    kcp->txn_cb_arg = txn_cb_arg;
 
     /* create regardless of checkpoint-period value, in case user
      * reconfigures later.
@@ -223,6 +213,7 @@ void kvs_checkpoint_destroy (kvs_checkpoint_t *kcp)
     if (kcp) {
         int save_errno = errno;
         flux_watcher_destroy (kcp->checkpoint_w);
+        flux_future_destroy (kcp->f_checkpoint);
         free (kcp);
         errno = save_errno;
     }
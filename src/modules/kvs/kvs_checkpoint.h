@@ -26,22 +26,20 @@
 
 typedef struct kvs_checkpoint kvs_checkpoint_t;
 
-/* callback after sync/checkpoint transaction submitted */
-typedef void (*kvs_checkpoint_txn_cb)(struct kvsroot *root, void *arg);
-
-/* root_primary - root of primary namespace, will be passed to txn_cb
+/* root_primary - root of primary namespace to checkpoint
  *              - can be NULL if not available at creation time, use
  *                kvs_checkpoint_update_root_primary() to set later.
  * checkpoint_period - timer will trigger a checkpoint every X seconds,
  *                   - no timer will be done if <= 0.0.
- * txn_cb - callback after each checkpoint transaction submitted
- * txn_cb_arg - passed to txn_cb
+ *
+ * Periodic checkpoints do not flush the content cache.  The content
+ * cache writes the checkpoint once the blobs stored before it are
+ * durable (see KVS_CHECKPOINT_FLAG_DURABLE), so commits are not held
+ * up while dirty blobs are written out.
  */
 kvs_checkpoint_t *kvs_checkpoint_create (flux_t *h,
                                          struct kvsroot *root_primary,
-                                         double checkpoint_period,
-                                         kvs_checkpoint_txn_cb txn_cb,
-                                         void *txn_cb_arg);
+                                         double checkpoint_period);
 
 /* update internal checkpoint_period setting as needed */
 int kvs_checkpoint_config_parse (kvs_checkpoint_t *kcp,
@@ -27,8 +27,12 @@
 
 #include "kvsroot.h"
 
+/* 'age_list' holds all roots: those marked for removal first, then the
+ * rest in order of last_update_time.
+ */
 struct kvsroot_mgr {
     zhash_t *roothash;
+    struct list_head age_list;
     zlist_t *removelist;
     bool iterating_roots;
     flux_t *h;
@@ -52,6 +56,7 @@ kvsroot_mgr_t *kvsroot_mgr_create (flux_t *h, void *arg)
         saved_errno = ENOMEM;
         goto error;
     }
+    list_head_init (&krm->age_list);
     krm->iterating_roots = false;
     krm->h = h;
     krm->arg = arg;
@@ -83,6 +88,7 @@ static void kvsroot_destroy (void *data)
 {
     if (data) {
         struct kvsroot *root = data;
+        list_del (&root->age_node);
         if (root->ns_name)
             free (root->ns_name);
         if (root->ktm)
@@ -97,6 +103,22 @@ static void kvsroot_destroy (void *data)
     }
 }
 
+/* Return the node after which a root that has never been updated belongs,
+ * that is, the last root marked for removal, or the list head.
+ */
+static struct list_node *last_removed (kvsroot_mgr_t *krm)
+{
+    struct list_node *n = &krm->age_list.n;
+    struct kvsroot *root;
+
+    list_for_each (&krm->age_list, root, age_node) {
+        if (!root->remove)
+            break;
+        n = &root->age_node;
+    }
+    return n;
+}
+
 struct kvsroot *kvsroot_mgr_create_root (kvsroot_mgr_t *krm,
                                          struct cache *cache,
                                          const char *hash_name,
@@ -117,6 +139,7 @@ struct kvsroot *kvsroot_mgr_create_root (kvsroot_mgr_t *krm,
         flux_log_error (krm->h, "calloc");
         return NULL;
     }
+    list_node_init (&root->age_node);
 
     if (!(root->ns_name = strdup (ns))) {
         flux_log_error (krm->h, "strdup");
@@ -164,6 +187,7 @@ struct kvsroot *kvsroot_mgr_create_root (kvsroot_mgr_t *krm,
     }
 
     list_node_init (&root->work_queue_node);
+    list_add_after (&krm->age_list, last_removed (krm), &root->age_node);
     return root;
 
  error:
@@ -214,10 +238,59 @@ struct kvsroot *kvsroot_mgr_lookup_root_safe (kvsroot_mgr_t *krm,
     return root;
 }
 
+static void iter_finish (kvsroot_mgr_t *krm)
+{
+    char *ns;
+
+    krm->iterating_roots = false;
+
+    while ((ns = zlist_pop (krm->removelist))) {
+        kvsroot_mgr_remove_root (krm, ns);
+        free (ns);
+    }
+}
+
+static void iter_abort (kvsroot_mgr_t *krm)
+{
+    char *ns;
+
+    while ((ns = zlist_pop (krm->removelist)))
+        free (ns);
+    krm->iterating_roots = false;
+}
+
+int kvsroot_mgr_iter_aged (kvsroot_mgr_t *krm,
+                           double before,
+                           kvsroot_root_f cb,
+                           void *arg)
+{
+    struct kvsroot *root;
+    struct kvsroot *next;
+
+    krm->iterating_roots = true;
+
+    list_for_each_safe (&krm->age_list, root, next, age_node) {
+        int ret;
+
+        if (!root->remove && root->last_update_time >= before)
+            break;
+
+        if ((ret = cb (root, arg)) < 0) {
+            iter_abort (krm);
+            return -1;
+        }
+
+        if (ret == 1)
+            break;
+    }
+
+    iter_finish (krm);
+    return 0;
+}
+
 int kvsroot_mgr_iter_roots (kvsroot_mgr_t *krm, kvsroot_root_f cb, void *arg)
 {
     struct kvsroot *root;
-    char *ns;
 
     krm->iterating_roots = true;
 
@@ -234,19 +307,11 @@ int kvsroot_mgr_iter_roots (kvsroot_mgr_t *krm, kvsroot_root_f cb, void *arg)
         root = zhash_next (krm->roothash);
     }
 
-    krm->iterating_roots = false;
-
-    while ((ns = zlist_pop (krm->removelist))) {
-        kvsroot_mgr_remove_root (krm, ns);
-        free (ns);
-    }
-
+    iter_finish (krm);
     return 0;
 
 error:
-    while ((ns = zlist_pop (krm->removelist)))
-        free (ns);
-    krm->iterating_roots = false;
+    iter_abort (krm);
     return -1;
 }
 
@@ -265,6 +330,28 @@ void kvsroot_setroot (kvsroot_mgr_t *krm, struct kvsroot *root,
     root->seq = root_seq;
 }
 
+void kvsroot_set_update_time (kvsroot_mgr_t *krm,
+                              struct kvsroot *root,
+                              double now)
+{
+    if (!root)
+        return;
+    root->last_update_time = now;
+    if (!root->remove) {
+        list_del (&root->age_node);
+        list_add_tail (&krm->age_list, &root->age_node);
+    }
+}
+
+void kvsroot_mark_remove (kvsroot_mgr_t *krm, struct kvsroot *root)
+{
+    if (!root || root->remove)
+        return;
+    root->remove = true;
+    list_del (&root->age_node);
+    list_add (&krm->age_list, &root->age_node);
+}
+
 int kvsroot_check_user (kvsroot_mgr_t *krm, struct kvsroot *root,
                         struct flux_msg_cred cred)
 {
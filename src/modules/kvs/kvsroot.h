@@ -39,6 +39,7 @@ struct kvsroot {
     bool setroot_pause;
     zlist_t *setroot_queue;
     struct list_node work_queue_node;
+    struct list_node age_node;
 };
 
 /* return -1 on error, 0 on success, 1 on success & to stop iterating */
@@ -72,12 +73,33 @@ struct kvsroot *kvsroot_mgr_lookup_root_safe (kvsroot_mgr_t *krm,
 
 int kvsroot_mgr_iter_roots (kvsroot_mgr_t *krm, kvsroot_root_f cb, void *arg);
 
+/* Like kvsroot_mgr_iter_roots(), but only visit roots marked for
+ * removal and roots whose last_update_time is before 'before'.  Roots
+ * are kept in update order, so the cost is proportional to the number
+ * of roots visited, not the total.
+ */
+int kvsroot_mgr_iter_aged (kvsroot_mgr_t *krm,
+                           double before,
+                           kvsroot_root_f cb,
+                           void *arg);
+
 /* Convenience functions on struct kvsroot
  */
 
 void kvsroot_setroot (kvsroot_mgr_t *krm, struct kvsroot *root,
                       const char *root_ref, int root_seq);
 
+/* Set root's last_update_time to 'now', which must not be earlier than
+ * that of any other root.
+ */
+void kvsroot_set_update_time (kvsroot_mgr_t *krm,
+                              struct kvsroot *root,
+                              double now);
+
+/* Set root's remove flag.
+ */
+void kvsroot_mark_remove (kvsroot_mgr_t *krm, struct kvsroot *root);
+
 int kvsroot_check_user (kvsroot_mgr_t *krm,struct kvsroot *root,
                         struct flux_msg_cred cred);
 
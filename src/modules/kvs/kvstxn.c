@@ -24,8 +24,10 @@
 
 #include "src/common/libczmqcontainers/czmq_containers.h"
 #include "src/common/libccan/ccan/base64/base64.h"
+#include "src/common/libccan/ccan/list/list.h"
 #include "src/common/libutil/macros.h"
 #include "src/common/libutil/blobref.h"
+#include "src/common/libutil/errno_safe.h"
 #include "src/common/libkvs/treeobj.h"
 #include "src/common/libkvs/kvs_checkpoint.h"
 #include "src/common/libkvs/kvs_commit.h"
@@ -35,12 +37,54 @@
 
 #include "kvstxn.h"
 
+/* Directories (other than the root) with more entries than this are
+ * stored as sharded directories.  Zero disables sharding.
+ */
+static int dirshard_threshold = KVSTXN_DIRSHARD_THRESHOLD_DEFAULT;
+
+/* Maximum size of the setroot delta.  Zero disables the delta.
+ */
+static size_t delta_max_size = 0;
+
+/* Store directories in the compact binary encoding rather than JSON.
+ */
+static bool treeobj_binary = false;
+
+/* While the content store is being garbage collected, blobs that are
+ * already valid in the cache are stored again, so the content store
+ * protects them from the sweep.  The generation counts gc passes, so that
+ * transactions started before the current one can be identified.
+ */
+static bool gc_active = false;
+static unsigned int gc_generation = 0;
+
+/* While guest transactions are waiting, transactions are held in per-class
+ * pending queues and moved to the ready queue in batches each time it
+ * drains.  Owner batches get KVSTXN_OWNER_WEIGHT turns for each guest
+ * batch, and guests take turns round robin by userid, so a busy guest
+ * cannot delay owner (e.g. job-manager) commits by more than one batch.
+ * A batch holds up to KVSTXN_BATCH_MAX transactions, which may then be
+ * merged as usual.
+ */
+#define KVSTXN_OWNER_WEIGHT 4
+#define KVSTXN_BATCH_MAX 64
+
+struct guest_queue {
+    uint32_t userid;
+    zlist_t *txns;
+    struct list_node node;
+};
+
 struct kvstxn_mgr {
     struct cache *cache;
     const char *ns_name;
     const char *hash_name;
     int noop_stores;            /* for kvs.stats-get, etc.*/
     zlist_t *ready;
+    zlist_t *owner_pending;
+    struct list_head guests;    /* guest_queues in round robin order */
+    int guest_pending;
+    int owner_credit;
     flux_t *h;
     void *aux;
 };
@@ -52,6 +96,8 @@ struct kvstxn {
     json_t *ops;
     json_t *keys;
     json_t *names;
+    json_t *delta;              /* blobref => encoded new dir objects */
+    size_t delta_size;
     int flags;                  /* kvs flags from request caller */
     int internal_flags;         /* special kvstxn api internal flags */
     json_t *rootcpy;   /* working copy of root dir */
@@ -61,6 +107,8 @@ struct kvstxn {
     char newroot[BLOBREF_MAX_STRING_SIZE];
     zlist_t *missing_refs_list;
     zlist_t *dirty_cache_entries_list;
+    zlist_t *gc_entries_list;   /* clean entries made dirty for gc */
+    unsigned int gc_generation; /* gc pass kvstxn started in, or 0 */
     flux_future_t *f_sync_content_flush;
     flux_future_t *f_sync_checkpoint;
     bool processing;            /* kvstxn is being processed */
@@ -109,6 +157,7 @@ static void kvstxn_destroy (kvstxn_t *kt)
         json_decref (kt->ops);
         json_decref (kt->keys);
         json_decref (kt->names);
+        json_decref (kt->delta);
         json_decref (kt->rootcpy);
         cache_entry_decref (kt->entry);
         cache_entry_decref (kt->newroot_entry);
@@ -116,6 +165,8 @@ static void kvstxn_destroy (kvstxn_t *kt)
             zlist_destroy (&kt->missing_refs_list);
         if (kt->dirty_cache_entries_list)
             zlist_destroy (&kt->dirty_cache_entries_list);
+        if (kt->gc_entries_list)
+            zlist_destroy (&kt->gc_entries_list);
         flux_future_destroy (kt->f_sync_content_flush);
         flux_future_destroy (kt->f_sync_checkpoint);
         free (kt);
@@ -158,6 +209,8 @@ static kvstxn_t *kvstxn_create (kvstxn_mgr_t *ktm,
     zlist_autofree (kt->missing_refs_list);
     if (!(kt->dirty_cache_entries_list = zlist_new ()))
         goto error_enomem;
+    if (!(kt->gc_entries_list = zlist_new ()))
+        goto error_enomem;
     kt->ktm = ktm;
     kt->state = KVSTXN_STATE_INIT;
     return kt;
@@ -234,6 +287,50 @@ json_t *kvstxn_get_keys (kvstxn_t *kt)
     return NULL;
 }
 
+json_t *kvstxn_get_delta (kvstxn_t *kt)
+{
+    if (kt->state == KVSTXN_STATE_FINISHED)
+        return kt->delta;
+    return NULL;
+}
+
+/* Add encoded dir object 'data' stored under 'ref' to the delta, if it
+ * fits.  The data is base64 encoded since it may be binary.  The delta
+ * is only an optimization, so failure is logged and otherwise ignored.
+ */
+static void delta_add (kvstxn_t *kt, const char *ref, const char *data,
+                       size_t len)
+{
+    size_t xlen = base64_encoded_length (len);
+    size_t size = strlen (ref) + xlen;
+    char *xdata;
+    json_t *o;
+
+    if (kt->delta_size > delta_max_size
+        || size > delta_max_size - kt->delta_size)
+        return;
+    if (!kt->delta && !(kt->delta = json_object ()))
+        goto nomem;
+    if (!(xdata = malloc (xlen + 1)))
+        goto nomem;
+    if (base64_encode (xdata, xlen + 1, data, len) < 0) {
+        free (xdata);
+        goto nomem;
+    }
+    o = json_string (xdata);
+    free (xdata);
+    if (!o)
+        goto nomem;
+    if (json_object_set_new (kt->delta, ref, o) < 0) {
+        json_decref (o);
+        goto nomem;
+    }
+    kt->delta_size += size;
+    return;
+nomem:
+    flux_log (kt->ktm->h, LOG_ERR, "%s: out of memory", __FUNCTION__);
+}
+
 /* On error we should cleanup anything on the dirty cache list
  * that has not yet been passed to the user.  Because this has not
  * been passed to the user, there should be no waiters and the
@@ -268,6 +365,14 @@ void kvstxn_cleanup_dirty_cache_entry (kvstxn_t *kt, struct cache_entry *entry)
         assert (ret == 0);
         assert (cache_entry_get_dirty (entry) == false);
 
+        /* An entry made dirty only for gc is already in the content
+         * store and may be in use elsewhere, so leave it in the cache.
+         */
+        if (zlist_exists (kt->gc_entries_list, entry)) {
+            zlist_remove (kt->gc_entries_list, entry);
+            return;
+        }
+
         ret = cache_entry_get_raw (entry, &data, &len);
         assert (ret == 0);
 
@@ -332,6 +437,16 @@ static int store_cache (kvstxn_t *kt, json_t *o,
             }
         }
     }
+    else if (treeobj_binary) {
+        size_t len;
+        if (!(data = treeobj_encode_binary (o, &len))) {
+            flux_log_error (kt->ktm->h,
+                            "%s: treeobj_encode_binary",
+                            __FUNCTION__);
+            goto error;
+        }
+        datalen = len;
+    }
     else {
         if (treeobj_validate (o) < 0 || !(data = treeobj_encode (o))) {
             flux_log_error (kt->ktm->h, "%s: treeobj_encode", __FUNCTION__);
@@ -355,8 +470,27 @@ static int store_cache (kvstxn_t *kt, json_t *o,
         }
     }
     if (cache_entry_get_valid (entry)) {
-        kt->ktm->noop_stores++;
-        rc = 0;
+        /* Store a clean entry again while gc is active.  A dirty entry
+         * is already being stored.
+         */
+        if (gc_active && !cache_entry_get_dirty (entry)) {
+            if (cache_entry_set_dirty (entry, true) < 0) {
+                flux_log_error (kt->ktm->h,
+                                "%s: cache_entry_set_dirty",
+                                __FUNCTION__);
+                goto error;
+            }
+            if (zlist_append (kt->gc_entries_list, entry) < 0) {
+                (void)cache_entry_set_dirty (entry, false);
+                errno = ENOMEM;
+                goto error;
+            }
+            rc = 1;
+        }
+        else {
+            kt->ktm->noop_stores++;
+            rc = 0;
+        }
     }
     else {
         if (cache_entry_set_raw (entry, data, datalen) < 0) {
@@ -372,6 +506,8 @@ static int store_cache (kvstxn_t *kt, json_t *o,
             assert (ret == 1);
             goto error;
         }
+        if (!is_raw && delta_max_size > 0)
+            delta_add (kt, ref, data, datalen);
         rc = 1;
     }
     *entryp = entry;
@@ -385,6 +521,89 @@ static int store_cache (kvstxn_t *kt, json_t *o,
     return -1;
 }
 
+static int kvstxn_unroll (kvstxn_t *kt, json_t *dir);
+static int kvstxn_unroll_dirshard (kvstxn_t *kt, json_t *shard);
+
+/* Store directory object 'o' (a dir or dirshard), after unrolling its
+ * contents, and return a new dirref to it in 'dirrefp'.  'level' is the
+ * dirshard level that 'o' is converted to if it is a dir that has grown
+ * past the sharding threshold.
+ */
+static int kvstxn_store_dir (kvstxn_t *kt,
+                             json_t *o,
+                             int level,
+                             json_t **dirrefp)
+{
+    json_t *shard = NULL;
+    char ref[BLOBREF_MAX_STRING_SIZE];
+    struct cache_entry *entry;
+    int ret;
+    int rc = -1;
+
+    if (dirshard_threshold > 0
+        && level <= TREEOBJ_DIRSHARD_MAXLEVEL
+        && treeobj_is_dir (o)
+        && treeobj_get_count (o) > dirshard_threshold) {
+        if (!(shard = treeobj_dirshard_split (o, level)))
+            return -1;
+        o = shard;
+    }
+    if (treeobj_is_dirshard (o)) {
+        if (kvstxn_unroll_dirshard (kt, o) < 0)
+            goto done;
+    }
+    else if (kvstxn_unroll (kt, o) < 0) /* depth first */
+        goto done;
+    if ((ret = store_cache (kt, o, false, ref, sizeof (ref), &entry)) < 0)
+        goto done;
+    if (ret) {
+        if (kvstxn_add_dirty_cache_entry (kt, entry) < 0)
+            goto done;
+    }
+    if (!(*dirrefp = treeobj_create_dirref (ref)))
+        goto done;
+    rc = 0;
+done:
+    ERRNO_SAFE_WRAP (json_decref, shard);
+    return rc;
+}
+
+/* Store inline buckets of a dirshard, converting them to DIRREFs.
+ * Buckets that were emptied by unlinks are dropped.
+ */
+static int kvstxn_unroll_dirshard (kvstxn_t *kt, json_t *shard)
+{
+    json_t *buckets;
+    json_t *bucket;
+    json_t *ktmp;
+    int level;
+    void *iter;
+
+    if (!(buckets = treeobj_dirshard_get_buckets (shard))
+        || (level = treeobj_dirshard_get_level (shard)) < 0)
+        return -1;
+
+    iter = json_object_iter (buckets);
+    while (iter) {
+        void *next = json_object_iter_next (buckets, iter);
+
+        bucket = json_object_iter_value (iter);
+        if (treeobj_is_dir (bucket) && treeobj_get_count (bucket) == 0)
+            json_object_del (buckets, json_object_iter_key (iter));
+        else if (treeobj_is_dir (bucket) || treeobj_is_dirshard (bucket)) {
+            if (kvstxn_store_dir (kt, bucket, level + 1, &ktmp) < 0)
+                return -1;
+            if (json_object_iter_set_new (buckets, iter, ktmp) < 0) {
+                json_decref (ktmp);
+                errno = ENOMEM;
+                return -1;
+            }
+        }
+        iter = next;
+    }
+    return 0;
+}
+
 /* Store DIRVAL objects, converting them to DIRREFs.
  * Store (large) FILEVAL objects, converting them to FILEREFs.
  * Return 0 on success, -1 on error
@@ -411,17 +630,8 @@ static int kvstxn_unroll (kvstxn_t *kt, json_t *dir)
      */
     while (iter) {
         dir_entry = json_object_iter_value (iter);
-        if (treeobj_is_dir (dir_entry)) {
-            if (kvstxn_unroll (kt, dir_entry) < 0) /* depth first */
-                return -1;
-            if ((ret = store_cache (kt, dir_entry,
-                                    false, ref, sizeof (ref), &entry)) < 0)
-                return -1;
-            if (ret) {
-                if (kvstxn_add_dirty_cache_entry (kt, entry) < 0)
-                    return -1;
-            }
-            if (!(ktmp = treeobj_create_dirref (ref)))
+        if (treeobj_is_dir (dir_entry) || treeobj_is_dirshard (dir_entry)) {
+            if (kvstxn_store_dir (kt, dir_entry, 0, &ktmp) < 0)
                 return -1;
             if (json_object_iter_set_new (dir, iter, ktmp) < 0) {
                 json_decref (ktmp);
@@ -580,7 +790,8 @@ static int kvstxn_append (kvstxn_t *kt, json_t *dirent,
         return -1;
     }
     else if (treeobj_is_dir (entry)
-             || treeobj_is_dirref (entry)) {
+             || treeobj_is_dirref (entry)
+             || treeobj_is_dirshard (entry)) {
         errno = EISDIR;
         return -1;
     }
@@ -595,6 +806,76 @@ static int kvstxn_append (kvstxn_t *kt, json_t *dirent,
     return 0;
 }
 
+/* If 'dir' is a dirshard, descend into the bucket where entry 'name'
+ * belongs, until a dir is reached.  Buckets that are dirrefs are replaced
+ * with copies of the directories they reference, so they may be modified
+ * and are stored again by kvstxn_unroll().  If the bucket does not exist,
+ * it is created if 'create' is true, otherwise *dirp is set to NULL.
+ * If a bucket is not in the cache, *dirp is set to NULL and *missing_ref
+ * is set.  Return 0 on success, -1 on error.
+ */
+static int kvstxn_dirshard_descend (kvstxn_t *kt,
+                                    json_t *dir,
+                                    const char *name,
+                                    bool create,
+                                    json_t **dirp,
+                                    const char **missing_ref)
+{
+    while (treeobj_is_dirshard (dir)) {
+        json_t *bucket;
+
+        if (!(bucket = treeobj_dirshard_get_bucket (dir, name))) {
+            if (errno != ENOENT)
+                return -1;
+            if (!create) {
+                *dirp = NULL;
+                return 0;
+            }
+            if (!(bucket = treeobj_create_dir ()))
+                return -1;
+            if (treeobj_dirshard_set_bucket (dir, name, bucket) < 0) {
+                ERRNO_SAFE_WRAP (json_decref, bucket);
+                return -1;
+            }
+            json_decref (bucket);
+        }
+        else if (treeobj_is_dirref (bucket)) {
+            struct cache_entry *entry;
+            const json_t *bucketktmp;
+            const char *ref;
+
+            if (treeobj_get_count (bucket) != 1
+                || !(ref = treeobj_get_blobref (bucket, 0))) {
+                errno = ENOTRECOVERABLE;
+                return -1;
+            }
+            if (!(entry = cache_lookup (kt->ktm->cache, ref))
+                || !cache_entry_get_valid (entry)) {
+                *missing_ref = ref;
+                *dirp = NULL;
+                return 0; /* stall */
+            }
+            if (!(bucketktmp = cache_entry_get_treeobj (entry))
+                || (!treeobj_is_dir (bucketktmp)
+                    && !treeobj_is_dirshard (bucketktmp))) {
+                errno = ENOTRECOVERABLE;
+                return -1;
+            }
+            /* do not corrupt store by modifying orig. */
+            if (!(bucket = treeobj_deep_copy (bucketktmp)))
+                return -1;
+            if (treeobj_dirshard_set_bucket (dir, name, bucket) < 0) {
+                ERRNO_SAFE_WRAP (json_decref, bucket);
+                return -1;
+            }
+            json_decref (bucket);
+        }
+        dir = bucket;
+    }
+    *dirp = dir;
+    return 0;
+}
+
 /* link (key, dirent) into directory 'dir'.
  */
 static int kvstxn_link_dirent (kvstxn_t *kt,
@@ -623,6 +904,13 @@ static int kvstxn_link_dirent (kvstxn_t *kt,
         goto done;
     }
 
+    /* Sharded directories are created internally, not by users.
+     */
+    if (treeobj_is_dirshard (dirent)) {
+        saved_errno = EINVAL;
+        goto done;
+    }
+
     /* This is the first part of a key with multiple path components.
      * Make sure that it is a treeobj dir, then recurse on the
      * remaining path components.
@@ -630,6 +918,18 @@ static int kvstxn_link_dirent (kvstxn_t *kt,
     while ((next = strchr (name, '.'))) {
         *next++ = '\0';
 
+        if (kvstxn_dirshard_descend (kt,
+                                     dir,
+                                     name,
+                                     !json_is_null (dirent),
+                                     &dir,
+                                     missing_ref) < 0) {
+            saved_errno = errno;
+            goto done;
+        }
+        if (!dir) /* stall, or key deletion of nonexistent key */
+            goto success;
+
         if (!treeobj_is_dir (dir)) {
             saved_errno = ENOTRECOVERABLE;
             goto done;
@@ -649,7 +949,8 @@ static int kvstxn_link_dirent (kvstxn_t *kt,
                 goto done;
             }
             json_decref (subdir);
-        } else if (treeobj_is_dir (dir_entry)) {
+        } else if (treeobj_is_dir (dir_entry)
+                   || treeobj_is_dirshard (dir_entry)) {
             subdir = dir_entry;
         } else if (treeobj_is_dirref (dir_entry)) {
             struct cache_entry *entry;
@@ -753,6 +1054,17 @@ static int kvstxn_link_dirent (kvstxn_t *kt,
     /* This is the final path component of the key.  Add/modify/delete
      * it in the directory.
      */
+    if (kvstxn_dirshard_descend (kt,
+                                 dir,
+                                 name,
+                                 !json_is_null (dirent),
+                                 &dir,
+                                 missing_ref) < 0) {
+        saved_errno = errno;
+        goto done;
+    }
+    if (!dir) /* stall, or key deletion of nonexistent key */
+        goto success;
     if (!json_is_null (dirent)) {
         if (flags & FLUX_KVS_APPEND) {
             if (kvstxn_append (kt, dirent, dir, name, append) < 0) {
@@ -865,6 +1177,7 @@ kvstxn_process_t kvstxn_process (kvstxn_t *kt,
                 kt->errnum = EINVAL;
                 return KVSTXN_PROCESS_ERROR;
             }
+            kt->gc_generation = gc_active ? gc_generation : 0;
             kt->state = KVSTXN_STATE_LOAD_ROOT;
         }
         else if (kt->state == KVSTXN_STATE_LOAD_ROOT) {
@@ -1236,10 +1549,13 @@ kvstxn_mgr_t *kvstxn_mgr_create (struct cache *cache,
     ktm->cache = cache;
     ktm->ns_name = ns;
     ktm->hash_name = hash_name;
-    if (!(ktm->ready = zlist_new ())) {
+    if (!(ktm->ready = zlist_new ())
+        || !(ktm->owner_pending = zlist_new ())) {
         saved_errno = ENOMEM;
         goto error;
     }
+    list_head_init (&ktm->guests);
+    ktm->owner_credit = KVSTXN_OWNER_WEIGHT;
     ktm->h = h;
     ktm->aux = aux;
     return ktm;
@@ -1250,22 +1566,164 @@ kvstxn_mgr_t *kvstxn_mgr_create (struct cache *cache,
     return NULL;
 }
 
+void kvstxn_set_dirshard_threshold (int threshold)
+{
+    if (threshold >= 0)
+        dirshard_threshold = threshold;
+}
+
+int kvstxn_get_dirshard_threshold (void)
+{
+    return dirshard_threshold;
+}
+
+void kvstxn_set_treeobj_binary (bool binary)
+{
+    treeobj_binary = binary;
+}
+
+bool kvstxn_get_treeobj_binary (void)
+{
+    return treeobj_binary;
+}
+
+void kvstxn_set_gc_active (bool active)
+{
+    if (active && !gc_active)
+        gc_generation++;
+    gc_active = active;
+}
+
+bool kvstxn_get_gc_active (void)
+{
+    return gc_active;
+}
+
+void kvstxn_set_delta_max_size (size_t size)
+{
+    delta_max_size = size;
+}
+
+size_t kvstxn_get_delta_max_size (void)
+{
+    return delta_max_size;
+}
+
+static void txn_list_destroy (zlist_t *l)
+{
+    if (l) {
+        kvstxn_t *kt;
+        while ((kt = zlist_pop (l)))
+            kvstxn_destroy (kt);
+        zlist_destroy (&l);
+    }
+}
+
+static void guest_queue_destroy (struct guest_queue *gq)
+{
+    if (gq) {
+        txn_list_destroy (gq->txns);
+        free (gq);
+    }
+}
+
+static struct guest_queue *guest_queue_get (kvstxn_mgr_t *ktm,
+                                            uint32_t userid)
+{
+    struct guest_queue *gq;
+
+    list_for_each (&ktm->guests, gq, node) {
+        if (gq->userid == userid)
+            return gq;
+    }
+    if (!(gq = calloc (1, sizeof (*gq))))
+        return NULL;
+    if (!(gq->txns = zlist_new ())) {
+        free (gq);
+        errno = ENOMEM;
+        return NULL;
+    }
+    gq->userid = userid;
+    list_add_tail (&ktm->guests, &gq->node);
+    return gq;
+}
+
 void kvstxn_mgr_destroy (kvstxn_mgr_t *ktm)
 {
     if (ktm) {
+        struct guest_queue *gq;
         if (ktm->ready)
             zlist_destroy (&ktm->ready);
+        txn_list_destroy (ktm->owner_pending);
+        while ((gq = list_pop (&ktm->guests, struct guest_queue, node)))
+            guest_queue_destroy (gq);
         free (ktm);
     }
 }
 
-int kvstxn_mgr_add_transaction (kvstxn_mgr_t *ktm,
-                                const char *name,
-                                json_t *ops,
-                                int flags,
-                                int internal_flags)
+static int ready_append (kvstxn_mgr_t *ktm, kvstxn_t *kt)
+{
+    if (zlist_append (ktm->ready, kt) < 0) {
+        errno = ENOMEM;
+        return -1;
+    }
+    zlist_freefn (ktm->ready, kt, (zlist_free_fn *)kvstxn_destroy, true);
+    return 0;
+}
+
+/* Move up to KVSTXN_BATCH_MAX transactions from 'pending' to the ready
+ * queue, preserving their order.  Returns the number moved.
+ */
+static int ready_admit (kvstxn_mgr_t *ktm, zlist_t *pending)
+{
+    kvstxn_t *kt;
+    int count = 0;
+
+    while (count < KVSTXN_BATCH_MAX && (kt = zlist_first (pending))) {
+        if (ready_append (ktm, kt) < 0)
+            break;
+        zlist_remove (pending, kt);
+        count++;
+    }
+    return count;
+}
+
+/* When the ready queue drains, refill it from the pending queues.
+ * On ENOMEM, transactions stay pending until the next attempt.
+ */
+static void kvstxn_mgr_admit (kvstxn_mgr_t *ktm)
+{
+    struct guest_queue *gq;
+
+    if (zlist_size (ktm->ready) > 0)
+        return;
+    if (zlist_size (ktm->owner_pending) > 0
+        && (ktm->owner_credit > 0 || ktm->guest_pending == 0)) {
+        if (ready_admit (ktm, ktm->owner_pending) > 0
+            && ktm->owner_credit > 0)
+            ktm->owner_credit--;
+        return;
+    }
+    if ((gq = list_pop (&ktm->guests, struct guest_queue, node))) {
+        ktm->guest_pending -= ready_admit (ktm, gq->txns);
+        if (zlist_size (gq->txns) > 0)
+            list_add_tail (&ktm->guests, &gq->node);
+        else
+            guest_queue_destroy (gq);
+        ktm->owner_credit = KVSTXN_OWNER_WEIGHT;
+    }
+}
+
+static int kvstxn_mgr_add (kvstxn_mgr_t *ktm,
+                           const char *name,
+                           json_t *ops,
+                           int flags,
+                           int internal_flags,
+                           bool guest,
+                           uint32_t userid)
 {
     kvstxn_t *kt;
+    struct guest_queue *gq;
     int valid_internal_flags = KVSTXN_INTERNAL_FLAG_NO_PUBLISH;
 
     if (!name
@@ -1282,14 +1740,57 @@ int kvstxn_mgr_add_transaction (kvstxn_mgr_t *ktm,
                               internal_flags)))
         return -1;
 
-    if (zlist_append (ktm->ready, kt) < 0) {
-        kvstxn_destroy (kt);
-        errno = ENOMEM;
-        return -1;
+    /* With no guests waiting, owner transactions go straight to the
+     * ready queue, where they may be merged with one in progress.
+     */
+    if (!guest) {
+        if (ktm->guest_pending == 0
+            && zlist_size (ktm->owner_pending) == 0) {
+            if (ready_append (ktm, kt) < 0)
+                goto error;
+            return 0;
+        }
+        if (zlist_append (ktm->owner_pending, kt) < 0) {
+            errno = ENOMEM;
+            goto error;
+        }
     }
-    zlist_freefn (ktm->ready, kt, (zlist_free_fn *)kvstxn_destroy, true);
-
+    else {
+        if (!(gq = guest_queue_get (ktm, userid)))
+            goto error;
+        if (zlist_append (gq->txns, kt) < 0) {
+            if (zlist_size (gq->txns) == 0) {
+                list_del (&gq->node);
+                guest_queue_destroy (gq);
+            }
+            errno = ENOMEM;
+            goto error;
+        }
+        ktm->guest_pending++;
+    }
+    kvstxn_mgr_admit (ktm);
     return 0;
+error:
+    ERRNO_SAFE_WRAP (kvstxn_destroy, kt);
+    return -1;
+}
+
+int kvstxn_mgr_add_transaction (kvstxn_mgr_t *ktm,
+                                const char *name,
+                                json_t *ops,
+                                int flags,
+                                int internal_flags)
+{
+    return kvstxn_mgr_add (ktm, name, ops, flags, internal_flags, false, 0);
+}
+
+int kvstxn_mgr_add_guest_transaction (kvstxn_mgr_t *ktm,
+                                      const char *name,
+                                      json_t *ops,
+                                      int flags,
+                                      uint32_t userid)
+{
+    return kvstxn_mgr_add (ktm, name, ops, flags, 0, true, userid);
 }
 
 bool kvstxn_mgr_transaction_ready (kvstxn_mgr_t *ktm)
@@ -1335,9 +1836,21 @@ void kvstxn_mgr_remove_transaction (kvstxn_mgr_t *ktm, kvstxn_t *kt,
                 kt_tmp = zlist_next (ktm->ready);
             }
         }
+        kvstxn_mgr_admit (ktm);
     }
 }
 
+bool kvstxn_mgr_gc_pending (kvstxn_mgr_t *ktm)
+{
+    kvstxn_t *kt;
+
+    if ((kt = zlist_first (ktm->ready))
+        && kt->processing
+        && (!gc_active || kt->gc_generation != gc_generation))
+        return true;
+    return false;
+}
+
 int kvstxn_mgr_get_noop_stores (kvstxn_mgr_t *ktm)
 {
     return ktm->noop_stores;
@@ -1350,7 +1863,19 @@ void kvstxn_mgr_clear_noop_stores (kvstxn_mgr_t *ktm)
 
 int kvstxn_mgr_ready_transaction_count (kvstxn_mgr_t *ktm)
 {
-    return zlist_size (ktm->ready);
+    return zlist_size (ktm->ready)
+           + zlist_size (ktm->owner_pending)
+           + ktm->guest_pending;
+}
+
+int kvstxn_mgr_owner_pending_count (kvstxn_mgr_t *ktm)
+{
+    return zlist_size (ktm->owner_pending);
+}
+
+int kvstxn_mgr_guest_pending_count (kvstxn_mgr_t *ktm)
+{
+    return ktm->guest_pending;
 }
 
 /* N.B. FLUX_KVS_SYNC implies FLUX_KVS_NO_MERGE, as we checkpoint
@@ -37,6 +37,41 @@ typedef enum {
 
 #define KVSTXN_INTERNAL_FLAG_NO_PUBLISH 0x01
 
+/* Directories with more entries than the dirshard threshold are split
+ * into sharded directories (see treeobj_dirshard_split()) when they are
+ * stored.  A threshold of zero disables sharding.  The threshold applies
+ * to all kvstxn managers.
+ */
+#define KVSTXN_DIRSHARD_THRESHOLD_DEFAULT 1024
+
+void kvstxn_set_dirshard_threshold (int threshold);
+int kvstxn_get_dirshard_threshold (void);
+
+/* Store directory objects with treeobj_encode_binary() instead of
+ * treeobj_encode().  Readers accept either encoding, so this may be
+ * changed at any time.  The setting applies to all kvstxn managers.
+ */
+void kvstxn_set_treeobj_binary (bool binary);
+bool kvstxn_get_treeobj_binary (void);
+
+/* Directory objects newly stored by a transaction are collected in a
+ * "delta" object, mapping blobref to base64 encoded object, until the
+ * total size of the delta would exceed the delta max size.  The delta is
+ * published with the setroot event so that other ranks may populate
+ * their caches.  A max size of zero disables the delta.  The max size
+ * applies to all kvstxn managers.
+ */
+void kvstxn_set_delta_max_size (size_t size);
+size_t kvstxn_get_delta_max_size (void);
+
+/* While the content store is being garbage collected, transactions store
+ * blobs even if they are already valid in the cache, so that the content
+ * store protects them from the sweep.  The setting applies to all kvstxn
+ * managers.
+ */
+void kvstxn_set_gc_active (bool active);
+bool kvstxn_get_gc_active (void);
+
 /*
  * kvstxn_t API
  */
@@ -86,6 +121,11 @@ const char *kvstxn_get_newroot_ref (kvstxn_t *kt);
  * (i.e. kvstxn_process() returns KVSTXN_PROCESS_FINISHED) */
 json_t *kvstxn_get_keys (kvstxn_t *kt);
 
+/* returns non-NULL only if process state complete
+ * (i.e. kvstxn_process() returns KVSTXN_PROCESS_FINISHED) and the
+ * delta is enabled and non-empty */
+json_t *kvstxn_get_delta (kvstxn_t *kt);
+
 /* Primary transaction processing function.
  *
  * Pass in a kvstxn_t that was obtained via
@@ -171,6 +211,19 @@ int kvstxn_mgr_add_transaction (kvstxn_mgr_t *ktm,
                                 int flags,
                                 int internal_flags);
 
+/* kvstxn_mgr_add_guest_transaction() is like
+ * kvstxn_mgr_add_transaction(), but for a transaction requested by a
+ * guest user.  While guest transactions are pending, owner and guest
+ * transactions are admitted to the ready queue by weighted turns, with
+ * guests served round robin by 'userid', so guest load does not starve
+ * owner transactions or other guests.
+ */
+int kvstxn_mgr_add_guest_transaction (kvstxn_mgr_t *ktm,
+                                      const char *name,
+                                      json_t *ops,
+                                      int flags,
+                                      uint32_t userid);
+
 /* returns true if there is a transaction ready for processing and is
  * not blocked, false if not.
  */
@@ -200,12 +253,24 @@ kvstxn_t *kvstxn_mgr_get_ready_transaction (kvstxn_mgr_t *ktm);
 void kvstxn_mgr_remove_transaction (kvstxn_mgr_t *ktm, kvstxn_t *kt,
                                     bool fallback);
 
+/* Returns true if a transaction is being processed that was started
+ * before garbage collection became active, and may therefore have
+ * skipped stores of blobs that were already cached.
+ */
+bool kvstxn_mgr_gc_pending (kvstxn_mgr_t *ktm);
+
 int kvstxn_mgr_get_noop_stores (kvstxn_mgr_t *ktm);
 void kvstxn_mgr_clear_noop_stores (kvstxn_mgr_t *ktm);
 
-/* return count of ready transactions */
+/* return count of ready transactions, including those pending admission
+ * to the ready queue
+ */
 int kvstxn_mgr_ready_transaction_count (kvstxn_mgr_t *ktm);
 
+/* return count of owner or guest transactions pending admission */
+int kvstxn_mgr_owner_pending_count (kvstxn_mgr_t *ktm);
+int kvstxn_mgr_guest_pending_count (kvstxn_mgr_t *ktm);
+
 /* In internally stored ready transactions (moved to ready status via
  * kvstxn_mgr_add_transaction()), merge them into a new ready transaction
  * if they are capable of being merged.
@@ -25,6 +25,7 @@
 
 #include "src/common/libczmqcontainers/czmq_containers.h"
 #include "src/common/libutil/blobref.h"
+#include "src/common/libutil/errno_safe.h"
 #include "src/common/libkvs/treeobj.h"
 #include "src/common/libkvs/kvs_util_private.h"
 #include "ccan/str/str.h"
@@ -46,6 +47,7 @@ typedef struct {
     const json_t *dirent;
     json_t *tmp_dirent;         /* tmp dirent that may need to be created */
     zlist_t *pathcomps;
+    bool symlinked;             /* a symlink was followed at this level */
 
     /* If 'dirent' field is set and depends on cache entry not
      * expiring, use this to manage grabbing/giving up reference to
@@ -71,16 +73,21 @@ struct lookup {
 
     int flags;
 
+    int append_index;           /* -1 unless lookup_set_append_index() */
+
     void *aux;
 
     /* potential return values from lookup */
     json_t *val;           /* value of lookup */
+    json_t *append_sizes;  /* blob sizes if append_index set */
 
     /* if valref_missing_refs is true, iterate on refs, else
      * return missing_ref string.
      */
     const json_t *valref_missing_refs;
+    json_t *dirshard_missing_refs;
     const char *missing_ref;
+    char missing_ref_buf[BLOBREF_MAX_STRING_SIZE];
 
     /* for namespace callback */
 
@@ -351,6 +358,58 @@ cleanup:
     return ret;
 }
 
+/* Start the top level walk at the deepest directory on the path that a
+ * previous lookup under the same root has already resolved.  The last
+ * path component is always looked up normally.
+ */
+static int walk_path_jump (lookup_t *lh, walk_level_t *wl)
+{
+    const char *ref = NULL;
+    int len = strlen (lh->path);
+    int skip = 1;
+    int i;
+
+    while (!ref) {
+        const char *p = memrchr (lh->path, '.', len);
+        if (!p)
+            return 0;
+        len = p - lh->path;
+        ref = cache_path_lookup (lh->cache, wl->root_ref, lh->path, len);
+    }
+    json_decref (wl->tmp_dirent);
+    if (!(wl->tmp_dirent = treeobj_create_dirref (ref)))
+        return -1;
+    walk_level_update_dirent (wl, wl->tmp_dirent, NULL);
+    for (i = 0; i < len; i++) {
+        if (lh->path[i] == '.')
+            skip++;
+    }
+    while (skip-- > 0)
+        (void)zlist_pop (wl->pathcomps);
+    return 0;
+}
+
+/* Remember the directory that the top level walk resolved 'pathcomp'
+ * to, for walk_path_jump().
+ */
+static void walk_path_record (lookup_t *lh,
+                              walk_level_t *wl,
+                              const char *pathcomp)
+{
+    const char *ref;
+    int len;
+
+    if (wl->depth
+        || wl->symlinked
+        || last_pathcomp (wl->pathcomps, pathcomp)
+        || !treeobj_is_dirref (wl->dirent)
+        || treeobj_get_count (wl->dirent) != 1
+        || !(ref = treeobj_get_blobref (wl->dirent, 0)))
+        return;
+    len = (pathcomp - wl->path_copy) + strlen (pathcomp);
+    (void)cache_path_insert (lh->cache, wl->root_ref, lh->path, len, ref);
+}
+
 /* Get dirent of the requested path starting at the given root.
  *
  * Return true on success or error, error code is returned in ep and
@@ -411,7 +470,7 @@ static lookup_process_t walk (lookup_t *lh)
                     lh->errnum = ENOTRECOVERABLE;
                 goto error;
             }
-            if (!treeobj_is_dir (dir)) {
+            if (!treeobj_is_dir (dir) && !treeobj_is_dirshard (dir)) {
                 /* dirref pointed to non-dir error, special case when
                  * root_dirent is bad, is EINVAL from user.
                  */
@@ -442,6 +501,39 @@ static lookup_process_t walk (lookup_t *lh)
             }
         }
 
+        /* Descend into the bucket of a sharded directory */
+
+        while (treeobj_is_dirshard (dir)) {
+            const json_t *bucket;
+            const char *refstr;
+
+            if (!(bucket = treeobj_dirshard_peek_bucket (dir, pathcomp))) {
+                if (errno != ENOENT) {
+                    lh->errnum = errno;
+                    goto error;
+                }
+                goto done;
+            }
+            if (!treeobj_is_dirref (bucket)
+                || treeobj_get_count (bucket) != 1
+                || !(refstr = treeobj_get_blobref (bucket, 0))) {
+                lh->errnum = ENOTRECOVERABLE;
+                goto error;
+            }
+            if (!(entry = cache_lookup (lh->cache, refstr))
+                || !cache_entry_get_valid (entry)) {
+                /* copy, the shard holding refstr is not referenced */
+                strcpy (lh->missing_ref_buf, refstr);
+                lh->missing_ref = lh->missing_ref_buf;
+                return LOOKUP_PROCESS_LOAD_MISSING_REFS;
+            }
+            if (!(dir = cache_entry_get_treeobj (entry))
+                || (!treeobj_is_dir (dir) && !treeobj_is_dirshard (dir))) {
+                lh->errnum = ENOTRECOVERABLE;
+                goto error;
+            }
+        }
+
         /* Get directory reference of path component from directory */
 
         if (!(dirent_tmp = treeobj_peek_entry (dir, pathcomp))) {
@@ -462,6 +554,7 @@ static lookup_process_t walk (lookup_t *lh)
             walk_level_t *wltmp = NULL;
             lookup_process_t sret;
 
+            wl->symlinked = true;
             sret = walk_symlink (lh, wl, entry, dirent_tmp, pathcomp, &wltmp);
             if (sret == LOOKUP_PROCESS_ERROR)
                 goto error;
@@ -474,8 +567,10 @@ static lookup_process_t walk (lookup_t *lh)
                 continue;
             }
         }
-        else
+        else {
             walk_level_update_dirent (wl, dirent_tmp, entry);
+            walk_path_record (lh, wl, pathcomp);
+        }
 
         if (last_pathcomp (wl->pathcomps, pathcomp)
             && wl->depth) {
@@ -570,6 +665,7 @@ lookup_t *lookup_create (struct cache *cache,
 
     lh->cred = cred;
     lh->flags = flags;
+    lh->append_index = -1;
 
     lh->val = NULL;
     lh->valref_missing_refs = NULL;
@@ -599,6 +695,8 @@ void lookup_destroy (lookup_t *lh)
         free (lh->root_ref);
         free (lh->path);
         json_decref (lh->val);
+        json_decref (lh->append_sizes);
+        json_decref (lh->dirshard_missing_refs);
         free (lh->missing_namespace);
         zlist_destroy (&lh->levels);
         free (lh);
@@ -644,13 +742,42 @@ json_t *lookup_get_value (lookup_t *lh)
     return NULL;
 }
 
+int lookup_set_append_index (lookup_t *lh, int index)
+{
+    if (!lh || index < 0 || lh->state != LOOKUP_STATE_INIT) {
+        errno = EINVAL;
+        return -1;
+    }
+    lh->append_index = index;
+    return 0;
+}
+
+json_t *lookup_get_append_sizes (lookup_t *lh)
+{
+    if (lh
+        && lh->state == LOOKUP_STATE_FINISHED
+        && lh->errnum == 0)
+        return json_incref (lh->append_sizes);
+    return NULL;
+}
+
 int lookup_iter_missing_refs (lookup_t *lh, lookup_ref_f cb, void *data)
 {
     if (lh
         && (lh->state == LOOKUP_STATE_CHECK_ROOT
             || lh->state == LOOKUP_STATE_WALK
             || lh->state == LOOKUP_STATE_VALUE)) {
-        if (lh->valref_missing_refs) {
+        if (lh->dirshard_missing_refs
+            && json_array_size (lh->dirshard_missing_refs) > 0) {
+            size_t index;
+            json_t *value;
+
+            json_array_foreach (lh->dirshard_missing_refs, index, value) {
+                if (cb (lh, json_string_value (value), data) < 0)
+                    return -1;
+            }
+        }
+        else if (lh->valref_missing_refs) {
             int refcount, i;
 
             if (!treeobj_is_valref (lh->valref_missing_refs)) {
@@ -661,7 +788,8 @@ int lookup_iter_missing_refs (lookup_t *lh, lookup_ref_f cb, void *data)
             refcount = treeobj_get_count (lh->valref_missing_refs);
             assert (refcount > 0);
 
-            for (i = 0; i < refcount; i++) {
+            i = lh->append_index > 0 ? lh->append_index : 0;
+            for (; i < refcount; i++) {
                 struct cache_entry *entry;
                 const char *ref;
 
@@ -776,8 +904,9 @@ static int get_single_blobref_valref_value (lookup_t *lh, bool *stall)
     return 0;
 }
 
-static int get_multi_blobref_valref_length (lookup_t *lh, int refcount,
-                                            int *total_len, bool *stall)
+static int get_multi_blobref_valref_length (lookup_t *lh, int start,
+                                            int refcount, int *total_len,
+                                            bool *stall)
 {
     struct cache_entry *entry;
     const char *reftmp;
@@ -785,7 +914,7 @@ static int get_multi_blobref_valref_length (lookup_t *lh, int refcount,
     int len;
     int i;
 
-    for (i = 0; i < refcount; i++) {
+    for (i = start; i < refcount; i++) {
         if (!(reftmp = treeobj_get_blobref (lh->wdirent, i))) {
             lh->errnum = errno;
             return -1;
@@ -816,8 +945,8 @@ static int get_multi_blobref_valref_length (lookup_t *lh, int refcount,
     return 0;
 }
 
-static char *get_multi_blobref_valref_data (lookup_t *lh, int refcount,
-                                            int total_len)
+static char *get_multi_blobref_valref_data (lookup_t *lh, int start,
+                                            int refcount, int total_len)
 {
     struct cache_entry *entry;
     const char *reftmp;
@@ -832,7 +961,7 @@ static char *get_multi_blobref_valref_data (lookup_t *lh, int refcount,
         return NULL;
     }
 
-    for (i = 0; i < refcount; i++) {
+    for (i = start; i < refcount; i++) {
         int ret;
 
         /* this function should only be called if all cache entries
@@ -851,6 +980,14 @@ static char *get_multi_blobref_valref_data (lookup_t *lh, int refcount,
         memcpy (valbuf + pos, valdata, len);
         pos += len;
         assert (pos <= total_len);
+
+        if (lh->append_sizes
+            && json_array_append_new (lh->append_sizes,
+                                      json_integer (len)) < 0) {
+            free (valbuf);
+            lh->errnum = ENOMEM;
+            return NULL;
+        }
     }
 
     return valbuf;
@@ -858,14 +995,18 @@ static char *get_multi_blobref_valref_data (lookup_t *lh, int refcount,
 
 /* return 0 on success, -1 on failure.  On success, stall should be
  * check */
-static int get_multi_blobref_valref_value (lookup_t *lh, int refcount,
-                                           bool *stall)
+static int get_multi_blobref_valref_value (lookup_t *lh, int start,
+                                           int refcount, bool *stall)
 {
     char *valbuf = NULL;
     int total_len = 0;
     int rc = -1;
 
-    if (get_multi_blobref_valref_length (lh, refcount, &total_len, stall) < 0)
+    if (get_multi_blobref_valref_length (lh,
+                                         start,
+                                         refcount,
+                                         &total_len,
+                                         stall) < 0)
         goto done;
 
     if ((*stall) == true) {
@@ -873,7 +1014,10 @@ static int get_multi_blobref_valref_value (lookup_t *lh, int refcount,
         goto done;
     }
 
-    if (!(valbuf = get_multi_blobref_valref_data (lh, refcount, total_len)))
+    if (!(valbuf = get_multi_blobref_valref_data (lh,
+                                                  start,
+                                                  refcount,
+                                                  total_len)))
         goto done;
 
     if (!(lh->val = treeobj_create_val (valbuf, total_len))) {
@@ -888,11 +1032,142 @@ done:
     return rc;
 }
 
+/* An inline val is a single blob for the purpose of an append index,
+ * since kvstxn stores it as the first blobref when it is appended to.
+ */
+static int get_val_append (lookup_t *lh)
+{
+    int len;
+
+    if (lh->append_index > 1) {
+        lh->errnum = EINVAL;
+        return -1;
+    }
+    if (treeobj_decode_val (lh->wdirent, NULL, &len) < 0) {
+        lh->errnum = errno;
+        return -1;
+    }
+    json_decref (lh->append_sizes);
+    if (!(lh->append_sizes = json_array ())) {
+        lh->errnum = ENOMEM;
+        return -1;
+    }
+    if (lh->append_index == 1)
+        lh->val = treeobj_create_val (NULL, 0);
+    else {
+        if (json_array_append_new (lh->append_sizes, json_integer (len)) < 0) {
+            lh->errnum = ENOMEM;
+            return -1;
+        }
+        lh->val = treeobj_deep_copy (lh->wdirent);
+    }
+    if (!lh->val) {
+        lh->errnum = errno;
+        return -1;
+    }
+    return 0;
+}
+
+/* Copy the entries of sharded directory 'shard' into 'dir'.  Buckets
+ * not in the cache are added to lh->dirshard_missing_refs and skipped.
+ */
+static int dirshard_merge (lookup_t *lh, const json_t *shard, json_t *dir)
+{
+    const json_t *buckets;
+    const char *name;
+    json_t *bucket;
+
+    if (!(buckets = treeobj_dirshard_get_buckets ((json_t *)shard)))
+        return -1;
+    json_object_foreach ((json_t *)buckets, name, bucket) {
+        struct cache_entry *entry;
+        const json_t *o;
+        const char *ref;
+
+        if (!treeobj_is_dirref (bucket)
+            || treeobj_get_count (bucket) != 1
+            || !(ref = treeobj_get_blobref (bucket, 0))) {
+            errno = ENOTRECOVERABLE;
+            return -1;
+        }
+        if (!(entry = cache_lookup (lh->cache, ref))
+            || !cache_entry_get_valid (entry)) {
+            if (json_array_append_new (lh->dirshard_missing_refs,
+                                       json_string (ref)) < 0) {
+                errno = ENOMEM;
+                return -1;
+            }
+            continue;
+        }
+        if (!(o = cache_entry_get_treeobj (entry))) {
+            errno = ENOTRECOVERABLE;
+            return -1;
+        }
+        if (treeobj_is_dirshard (o)) {
+            if (dirshard_merge (lh, o, dir) < 0)
+                return -1;
+        }
+        else if (treeobj_is_dir (o)) {
+            const char *key;
+            json_t *value;
+
+            json_object_foreach (treeobj_get_data ((json_t *)o), key, value) {
+                json_t *cpy;
+
+                if (!(cpy = treeobj_deep_copy (value)))
+                    return -1;
+                if (treeobj_insert_entry_novalidate (dir, key, cpy) < 0) {
+                    ERRNO_SAFE_WRAP (json_decref, cpy);
+                    return -1;
+                }
+                json_decref (cpy);
+            }
+        }
+        else {
+            errno = ENOTRECOVERABLE;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Set lh->val to a plain dir with the contents of sharded directory
+ * 'shard'.  Set 'stall' if buckets must be loaded first.
+ */
+static int dirshard_readdir (lookup_t *lh, const json_t *shard, bool *stall)
+{
+    json_t *dir;
+
+    if (!lh->dirshard_missing_refs) {
+        if (!(lh->dirshard_missing_refs = json_array ())) {
+            errno = ENOMEM;
+            return -1;
+        }
+    }
+    else
+        json_array_clear (lh->dirshard_missing_refs);
+    if (!(dir = treeobj_create_dir ()))
+        return -1;
+    if (dirshard_merge (lh, shard, dir) < 0) {
+        ERRNO_SAFE_WRAP (json_decref, dir);
+        return -1;
+    }
+    if (json_array_size (lh->dirshard_missing_refs) > 0) {
+        json_decref (dir);
+        *stall = true;
+        return 0;
+    }
+    lh->val = dir;
+    *stall = false;
+    return 0;
+}
+
 lookup_process_t lookup (lookup_t *lh)
 {
     const json_t *valtmp = NULL;
     const char *reftmp;
     struct cache_entry *entry;
+    walk_level_t *wl;
     bool is_replay = false;
     int refcount;
 
@@ -995,7 +1270,8 @@ lookup_process_t lookup (lookup_t *lh)
         case LOOKUP_STATE_WALK_INIT:
             /* initialize walk - first depth is level 0 */
 
-            if (!walk_levels_push (lh, lh->root_ref, lh->path, 0)) {
+            if (!(wl = walk_levels_push (lh, lh->root_ref, lh->path, 0))
+                || walk_path_jump (lh, wl) < 0) {
                 lh->errnum = errno;
                 goto error;
             }
@@ -1074,6 +1350,17 @@ lookup_process_t lookup (lookup_t *lh)
                     lh->errnum = ENOTRECOVERABLE;
                     goto error;
                 }
+                if (treeobj_is_dirshard (valtmp)) {
+                    bool stall;
+
+                    if (dirshard_readdir (lh, valtmp, &stall) < 0) {
+                        lh->errnum = errno;
+                        goto error;
+                    }
+                    if (stall)
+                        return LOOKUP_PROCESS_LOAD_MISSING_REFS;
+                    goto done;
+                }
                 if (!treeobj_is_dir (valtmp)) {
                     /* dirref points to not dir */
                     lh->errnum = ENOTRECOVERABLE;
@@ -1104,7 +1391,25 @@ lookup_process_t lookup (lookup_t *lh)
                     lh->errnum = ENOTRECOVERABLE;
                     goto error;
                 }
-                if (refcount == 1) {
+                if (lh->append_index >= 0) {
+                    if (lh->append_index > refcount) {
+                        lh->errnum = EINVAL;
+                        goto error;
+                    }
+                    json_decref (lh->append_sizes);
+                    if (!(lh->append_sizes = json_array ())) {
+                        lh->errnum = ENOMEM;
+                        goto error;
+                    }
+                    if (get_multi_blobref_valref_value (lh,
+                                                        lh->append_index,
+                                                        refcount,
+                                                        &stall) < 0)
+                        goto error;
+                    if (stall)
+                        return LOOKUP_PROCESS_LOAD_MISSING_REFS;
+                }
+                else if (refcount == 1) {
                     if (get_single_blobref_valref_value (lh, &stall) < 0)
                         goto error;
                     if (stall)
@@ -1112,6 +1417,7 @@ lookup_process_t lookup (lookup_t *lh)
                 }
                 else {
                     if (get_multi_blobref_valref_value (lh,
+                                                        0,
                                                         refcount,
                                                         &stall) < 0)
                         goto error;
@@ -1140,7 +1446,11 @@ lookup_process_t lookup (lookup_t *lh)
                     lh->errnum = ENOTDIR;
                     goto error;
                 }
-                if (!(lh->val = treeobj_deep_copy (lh->wdirent))) {
+                if (lh->append_index >= 0) {
+                    if (get_val_append (lh) < 0)
+                        goto error;
+                }
+                else if (!(lh->val = treeobj_deep_copy (lh->wdirent))) {
                     lh->errnum = errno;
                     goto error;
                 }
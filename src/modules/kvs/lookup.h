@@ -105,6 +105,20 @@ int lookup_get_root_seq (lookup_t *lh);
  * be new */
 int lookup_set_current_epoch (lookup_t *lh, int epoch);
 
+/* Return only the part of a value stored after its first 'index'
+ * blobrefs, so that an appended value can be followed without
+ * loading the data already seen.  An inline val counts as a single
+ * blob.  The lookup fails with EINVAL if the value has fewer than
+ * 'index' blobs.  Must be set before the first call to lookup().
+ */
+int lookup_set_append_index (lookup_t *lh, int index);
+
+/* Get the sizes of the blobs returned by a lookup with an append
+ * index, as a json array of integers.  Returns NULL unless an append
+ * index was set and the lookup completed successfully.
+ */
+json_t *lookup_get_append_sizes (lookup_t *lh);
+
 /* Lookup the key path in the KVS cache starting at root.
  *
  * Returns LOOKUP_PROCESS_ERROR on error,
@@ -715,6 +715,116 @@ void cache_expiration_tests (void)
     cache_destroy (cache);
 }
 
+void cache_eviction_tests (void)
+{
+    struct cache *cache;
+    struct cache_entry *e1, *e2, *e3, *e4;
+    struct cache_counters cc;
+    char buf[100];
+    size_t size;
+    json_t *dir;
+    int len;
+
+    memset (buf, 'x', sizeof (buf));
+
+    ok ((cache = cache_create (NULL)) != NULL,
+        "cache_create works");
+    ok (cache_get_max_size (cache) == 0,
+        "cache max size is unlimited by default");
+    ok (cache_get_resident_size (cache) == 0,
+        "empty cache has resident size 0");
+
+    e1 = cache_entry_create ("aaa");
+    e2 = cache_entry_create ("bbb");
+    e3 = cache_entry_create ("ccc");
+    ok (e1 && e2 && e3,
+        "cache_entry_create works");
+    ok (cache_entry_set_raw (e1, buf, sizeof (buf)) == 0
+        && cache_entry_set_raw (e2, buf, sizeof (buf)) == 0
+        && cache_entry_set_raw (e3, buf, sizeof (buf)) == 0,
+        "cache_entry_set_raw works on 3 entries");
+    ok (cache_insert (cache, e1) == 0
+        && cache_insert (cache, e2) == 0
+        && cache_insert (cache, e3) == 0,
+        "cache_insert works on 3 entries");
+    ok (cache_get_resident_size (cache) == 3 * sizeof (buf),
+        "resident size accounts for raw data");
+
+    /* touch e1 so that e2 is the least recently used */
+    ok (cache_lookup (cache, "aaa") == e1,
+        "cache_lookup aaa works");
+    ok (cache_lookup (cache, "zzz") == NULL,
+        "cache_lookup zzz fails");
+    cache_get_counters (cache, &cc);
+    ok (cc.hits == 1 && cc.misses == 1,
+        "cache counters show 1 hit and 1 miss");
+
+    cache_set_max_size (cache, 3 * sizeof (buf));
+    ok (cache_count_entries (cache) == 3,
+        "no entries evicted when resident size equals max size");
+
+    /* dirty and referenced entries are never evicted */
+    ok (cache_entry_set_dirty (e2, true) == 0,
+        "cache_entry_set_dirty bbb works");
+    cache_entry_incref (e3);
+
+    ok ((e4 = cache_entry_create ("ddd")) != NULL
+        && cache_entry_set_raw (e4, buf, sizeof (buf)) == 0,
+        "created entry ddd");
+    ok (cache_insert (cache, e4) == 0,
+        "cache_insert ddd works");
+    ok (cache_count_entries (cache) == 3,
+        "cache contains 3 entries after insert over budget");
+    ok (cache_lookup (cache, "aaa") == NULL,
+        "aaa was evicted");
+    ok (cache_lookup (cache, "bbb") == e2
+        && cache_lookup (cache, "ccc") == e3
+        && cache_lookup (cache, "ddd") == e4,
+        "dirty, referenced, and newly inserted entries remain");
+    cache_get_counters (cache, &cc);
+    ok (cc.evictions == 1,
+        "cache counters show 1 eviction");
+    ok (cache_get_resident_size (cache) == 3 * sizeof (buf),
+        "resident size updated after eviction");
+
+    /* treeobj decode is charged to the cache */
+    cache_set_max_size (cache, 0);
+    size = cache_get_resident_size (cache);
+    dir = treeobj_create_dir ();
+    ok ((e1 = cache_entry_create ("eee")) != NULL
+        && cache_entry_set_treeobj (e1, dir) == 0,
+        "created entry eee with treeobj");
+    json_decref (dir);
+    ok (cache_insert (cache, e1) == 0,
+        "cache_insert eee works");
+    ok (cache_entry_get_raw (e1, NULL, &len) == 0
+        && cache_get_resident_size (cache) == size + len,
+        "resident size accounts for raw data of eee");
+    ok (cache_entry_get_treeobj (e1) != NULL,
+        "cache_entry_get_treeobj works");
+    ok (cache_get_resident_size (cache) > size + len,
+        "resident size accounts for decoded treeobj");
+
+    cache_clear_counters (cache);
+    cache_get_counters (cache, &cc);
+    ok (cc.hits == 0 && cc.misses == 0 && cc.evictions == 0
+        && cc.expirations == 0,
+        "cache_clear_counters works");
+
+    ok (cache_entry_set_dirty (e2, false) == 0,
+        "cache_entry_set_dirty bbb false works");
+    cache_entry_decref (e3);
+    ok (cache_expire_entries (cache, 0) == 4,
+        "cache_expire_entries expired all 4 entries");
+    cache_get_counters (cache, &cc);
+    ok (cc.expirations == 4 && cc.evictions == 0,
+        "expirations are counted separately from evictions");
+    ok (cache_get_resident_size (cache) == 0,
+        "resident size is 0 after all entries expired");
+
+    cache_destroy (cache);
+}
+
 int main (int argc, char *argv[])
 {
     plan (NO_PLAN);
@@ -727,6 +837,7 @@ int main (int argc, char *argv[])
     cache_expiration_tests ();
     cache_blobref_tests ();
     cache_remove_entry_tests ();
+    cache_eviction_tests ();
 
     done_testing ();
     return (0);
@@ -12,6 +12,7 @@
 #include "config.h"
 #endif
 #include <stdbool.h>
+#include <string.h>
 #include <unistd.h>
 #include <jansson.h>
 
@@ -246,6 +247,82 @@ void basic_iter_tests (void)
     cache_destroy (cache);
 }
 
+int collect_roots_cb (struct kvsroot *root, void *arg)
+{
+    char *buf = arg;
+    strcat (buf, root->ns_name);
+    return 0;
+}
+
+void aged_iter_tests (void)
+{
+    kvsroot_mgr_t *krm;
+    struct cache *cache;
+    struct kvsroot *root[4];
+    const char *names[] = { "a", "b", "c", "d" };
+    char buf[16];
+    int i;
+
+    cache = cache_create (NULL);
+
+    if (!(krm = kvsroot_mgr_create (NULL, &global)))
+        BAIL_OUT ("kvsroot_mgr_create failed");
+    for (i = 0; i < 4; i++) {
+        if (!(root[i] = kvsroot_mgr_create_root (krm,
+                                                 cache,
+                                                 "sha1",
+                                                 names[i],
+                                                 getuid (),
+                                                 0)))
+            BAIL_OUT ("kvsroot_mgr_create_root failed");
+    }
+
+    /* update in the order d, b, a, c at times 1, 2, 3, 4
+     */
+    kvsroot_set_update_time (krm, root[3], 1.);
+    kvsroot_set_update_time (krm, root[1], 2.);
+    kvsroot_set_update_time (krm, root[0], 3.);
+    kvsroot_set_update_time (krm, root[2], 4.);
+
+    buf[0] = '\0';
+    ok (kvsroot_mgr_iter_aged (krm, 0., collect_roots_cb, buf) == 0
+        && streq (buf, ""),
+        "kvsroot_mgr_iter_aged before=0 visits nothing");
+
+    buf[0] = '\0';
+    ok (kvsroot_mgr_iter_aged (krm, 3., collect_roots_cb, buf) == 0
+        && streq (buf, "db"),
+        "kvsroot_mgr_iter_aged visits older roots, oldest first");
+
+    kvsroot_set_update_time (krm, root[3], 5.);
+    buf[0] = '\0';
+    ok (kvsroot_mgr_iter_aged (krm, 4.5, collect_roots_cb, buf) == 0
+        && streq (buf, "bac"),
+        "kvsroot_set_update_time moves root to the end");
+
+    kvsroot_mark_remove (krm, root[2]);
+    ok (root[2]->remove == true,
+        "kvsroot_mark_remove sets remove flag");
+    kvsroot_set_update_time (krm, root[2], 6.);
+    buf[0] = '\0';
+    ok (kvsroot_mgr_iter_aged (krm, 0., collect_roots_cb, buf) == 0
+        && streq (buf, "c"),
+        "kvsroot_mgr_iter_aged always visits roots marked for removal");
+
+    ok (kvsroot_mgr_iter_aged (krm, 10., roots_remove_cb, krm) == 0
+        && kvsroot_mgr_root_count (krm) == 3
+        && kvsroot_mgr_lookup_root (krm, "c") == NULL,
+        "kvsroot_mgr_iter_aged works on remove callback");
+
+    buf[0] = '\0';
+    ok (kvsroot_mgr_iter_aged (krm, 10., collect_roots_cb, buf) == 0
+        && streq (buf, "bad"),
+        "removed root is no longer visited");
+
+    kvsroot_mgr_destroy (krm);
+    cache_destroy (cache);
+}
+
 void basic_kvstxn_mgr_tests (void)
 {
     kvsroot_mgr_t *krm;
@@ -302,6 +379,7 @@ int main (int argc, char *argv[])
     basic_api_tests ();
     basic_api_tests_non_primary ();
     basic_iter_tests ();
+    aged_iter_tests ();
     basic_kvstxn_mgr_tests ();
 
     done_testing ();
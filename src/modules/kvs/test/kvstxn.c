@@ -12,6 +12,7 @@
 #include "config.h"
 #endif
 #include <stdbool.h>
+#include <string.h>
 #include <jansson.h>
 #include <assert.h>
 
@@ -26,6 +27,7 @@
 #include "src/modules/kvs/kvstxn.h"
 #include "src/modules/kvs/kvsroot.h"
 #include "src/modules/kvs/lookup.h"
+#include "ccan/base64/base64.h"
 #include "ccan/str/str.h"
 
 static int test_global = 5;
@@ -278,6 +280,101 @@ void kvstxn_mgr_basic_tests (void)
     cache_destroy (cache);
 }
 
+static void add_class_kvstxn (kvstxn_mgr_t *ktm,
+                              const char *name,
+                              bool guest,
+                              uint32_t userid)
+{
+    json_t *ops = json_array ();
+    int rc;
+
+    ops_append (ops, name, "1", 0);
+    if (guest)
+        rc = kvstxn_mgr_add_guest_transaction (ktm, name, ops, 0, userid);
+    else
+        rc = kvstxn_mgr_add_transaction (ktm, name, ops, 0, 0);
+    ok (rc == 0,
+        "added %s transaction %s",
+        guest ? "guest" : "owner",
+        name);
+    json_decref (ops);
+}
+
+/* Process transactions without merging, and check their order.
+ */
+static void check_class_order (kvstxn_mgr_t *ktm, const char *expected)
+{
+    char order[256] = "";
+    kvstxn_t *kt;
+
+    while ((kt = kvstxn_mgr_get_ready_transaction (ktm))) {
+        json_t *names = kvstxn_get_names (kt);
+        const char *name = json_string_value (json_array_get (names, 0));
+        if (strlen (order) > 0)
+            strcat (order, " ");
+        strcat (order, name);
+        kvstxn_mgr_remove_transaction (ktm, kt, false);
+    }
+    ok (streq (order, expected),
+        "transactions were processed in order: %s", order);
+}
+
+void kvstxn_mgr_class_tests (void)
+{
+    struct cache *cache;
+    kvstxn_mgr_t *ktm;
+    char rootref[BLOBREF_MAX_STRING_SIZE];
+
+    cache = create_cache_with_empty_rootdir (rootref, sizeof (rootref));
+
+    ok ((ktm = kvstxn_mgr_create (cache,
+                                  KVS_PRIMARY_NAMESPACE,
+                                  "sha1",
+                                  NULL,
+                                  &test_global)) != NULL,
+        "kvstxn_mgr_create works");
+
+    add_class_kvstxn (ktm, "o1", false, 0);
+    add_class_kvstxn (ktm, "a1", true, 100);
+    add_class_kvstxn (ktm, "a2", true, 100);
+    add_class_kvstxn (ktm, "a3", true, 100);
+    add_class_kvstxn (ktm, "b1", true, 200);
+    add_class_kvstxn (ktm, "o2", false, 0);
+    ok (kvstxn_mgr_ready_transaction_count (ktm) == 6,
+        "kvstxn_mgr_ready_transaction_count includes pending transactions");
+    ok (kvstxn_mgr_owner_pending_count (ktm) == 1
+        && kvstxn_mgr_guest_pending_count (ktm) == 4,
+        "owner and guest pending counts are correct");
+    check_class_order (ktm, "o1 o2 a1 a2 a3 b1");
+
+    /* A guest transaction is admitted at once if nothing is queued.
+     * Owner transactions that arrive while a guest is waiting are
+     * admitted as one batch, ahead of the waiting guest.
+     */
+    add_class_kvstxn (ktm, "c1", true, 100);
+    ok (kvstxn_mgr_guest_pending_count (ktm) == 0
+        && kvstxn_mgr_transaction_ready (ktm),
+        "guest transaction was admitted to empty ready queue");
+    add_class_kvstxn (ktm, "d1", true, 300);
+    add_class_kvstxn (ktm, "o3", false, 0);
+    add_class_kvstxn (ktm, "o4", false, 0);
+    add_class_kvstxn (ktm, "d2", true, 300);
+    add_class_kvstxn (ktm, "e1", true, 400);
+    check_class_order (ktm, "c1 o3 o4 d1 d2 e1");
+
+    ok (kvstxn_mgr_ready_transaction_count (ktm) == 0,
+        "kvstxn_mgr_ready_transaction_count is 0");
+
+    /* Pending transactions are destroyed with the manager.
+     */
+    add_class_kvstxn (ktm, "f1", true, 100);
+    add_class_kvstxn (ktm, "f2", true, 100);
+    add_class_kvstxn (ktm, "o5", false, 0);
+
+    kvstxn_mgr_destroy (ktm);
+    cache_destroy (cache);
+}
+
 static void create_ready_kvstxn_wrapper (kvstxn_mgr_t *ktm,
                                          const char *name,
                                          const char *key,
@@ -3005,6 +3102,459 @@ void kvstxn_process_giant_dir (void)
     json_decref (root);
 }
 
+/* Process the single ready transaction 'name' to completion, with ops
+ * from 'ops', and copy the new root to 'newroot'.
+ */
+static void process_dirshard_kvstxn (kvstxn_mgr_t *ktm,
+                                     const char *name,
+                                     json_t *ops,
+                                     const char *root_ref,
+                                     char *newroot)
+{
+    kvstxn_t *kt;
+
+    ok (kvstxn_mgr_add_transaction (ktm, name, ops, 0, 0) == 0,
+        "kvstxn_mgr_add_transaction works");
+    ok ((kt = kvstxn_mgr_get_ready_transaction (ktm)) != NULL,
+        "kvstxn_mgr_get_ready_transaction returns ready kvstxn");
+    ok (kvstxn_process (kt, root_ref, 0) == KVSTXN_PROCESS_DIRTY_CACHE_ENTRIES,
+        "kvstxn_process returns KVSTXN_PROCESS_DIRTY_CACHE_ENTRIES");
+    ok (kvstxn_iter_dirty_cache_entries (kt, cache_noop_cb, NULL) == 0,
+        "kvstxn_iter_dirty_cache_entries works for dirty cache entries");
+    ok (kvstxn_process (kt, root_ref, 0) == KVSTXN_PROCESS_FINISHED,
+        "kvstxn_process returns KVSTXN_PROCESS_FINISHED");
+    strcpy (newroot, kvstxn_get_newroot_ref (kt));
+    kvstxn_mgr_remove_transaction (ktm, kt, false);
+}
+
+/* Return the treeobj that key 'dir' (a dirref) references under root.
+ */
+static const json_t *get_dirref_treeobj (struct cache *cache,
+                                         const char *root_ref,
+                                         const char *key)
+{
+    struct cache_entry *entry;
+    const json_t *o;
+
+    if (!(entry = cache_lookup (cache, root_ref))
+        || !(o = cache_entry_get_treeobj (entry))
+        || !(o = treeobj_peek_entry (o, key))
+        || !treeobj_is_dirref (o)
+        || !(entry = cache_lookup (cache, treeobj_get_blobref (o, 0))))
+        return NULL;
+    return cache_entry_get_treeobj (entry);
+}
+
+void kvstxn_process_dirshard (void)
+{
+    struct cache *cache;
+    kvsroot_mgr_t *krm;
+    kvstxn_mgr_t *ktm;
+    json_t *ops;
+    const json_t *o;
+    char root_ref[BLOBREF_MAX_STRING_SIZE];
+    char newroot[BLOBREF_MAX_STRING_SIZE];
+    char newroot2[BLOBREF_MAX_STRING_SIZE];
+    char key[64];
+    char val[64];
+    int i;
+
+    cache = create_cache_with_empty_rootdir (root_ref, sizeof (root_ref));
+    if (!(krm = kvsroot_mgr_create (NULL, NULL)))
+        BAIL_OUT ("kvsroot_mgr_create failed");
+
+    setup_kvsroot (krm, KVS_PRIMARY_NAMESPACE, cache, root_ref);
+
+    ok ((ktm = kvstxn_mgr_create (cache,
+                                  KVS_PRIMARY_NAMESPACE,
+                                  "sha1",
+                                  NULL,
+                                  &test_global)) != NULL,
+        "kvstxn_mgr_create works");
+
+    ok (kvstxn_get_dirshard_threshold () == KVSTXN_DIRSHARD_THRESHOLD_DEFAULT,
+        "kvstxn_get_dirshard_threshold returns default");
+    kvstxn_set_dirshard_threshold (4);
+    ok (kvstxn_get_dirshard_threshold () == 4,
+        "kvstxn_set_dirshard_threshold works");
+
+    /* a directory with more than 4 entries is stored as a dirshard
+     */
+    ops = json_array ();
+    for (i = 0; i < 16; i++) {
+        snprintf (key, sizeof (key), "dir.key%d", i);
+        snprintf (val, sizeof (val), "%d", i);
+        ops_append (ops, key, val, 0);
+    }
+    ops_append (ops, "small.a", "1", 0);
+    process_dirshard_kvstxn (ktm, "transaction1", ops, root_ref, newroot);
+    json_decref (ops);
+
+    ok ((o = get_dirref_treeobj (cache, newroot, "dir")) != NULL
+        && treeobj_is_dirshard (o),
+        "dir is stored as a dirshard");
+    ok ((o = get_dirref_treeobj (cache, newroot, "small")) != NULL
+        && treeobj_is_dir (o),
+        "small is stored as a dir");
+
+    for (i = 0; i < 16; i++) {
+        snprintf (key, sizeof (key), "dir.key%d", i);
+        snprintf (val, sizeof (val), "%d", i);
+        verify_value (cache, krm, KVS_PRIMARY_NAMESPACE, newroot, key, val);
+    }
+    verify_value (cache, krm, KVS_PRIMARY_NAMESPACE, newroot, "dir.nokey", NULL);
+
+    /* modify, delete, and add entries in the dirshard
+     */
+    ops = json_array ();
+    ops_append (ops, "dir.key3", "foo", 0);
+    ops_append (ops, "dir.key7", NULL, 0);
+    ops_append (ops, "dir.nokey", NULL, 0);
+    ops_append (ops, "dir.key16", "16", 0);
+    ops_append (ops, "dir.sub.a", "bar", 0);
+    process_dirshard_kvstxn (ktm, "transaction2", ops, newroot, newroot2);
+    json_decref (ops);
+
+    ok ((o = get_dirref_treeobj (cache, newroot2, "dir")) != NULL
+        && treeobj_is_dirshard (o),
+        "dir is still stored as a dirshard");
+
+    verify_value (cache, krm, KVS_PRIMARY_NAMESPACE, newroot2, "dir.key3", "foo");
+    verify_value (cache, krm, KVS_PRIMARY_NAMESPACE, newroot2, "dir.key7", NULL);
+    verify_value (cache, krm, KVS_PRIMARY_NAMESPACE, newroot2, "dir.key16", "16");
+    verify_value (cache, krm, KVS_PRIMARY_NAMESPACE, newroot2, "dir.sub.a", "bar");
+    verify_value (cache, krm, KVS_PRIMARY_NAMESPACE, newroot2, "dir.key0", "0");
+    verify_value (cache, krm, KVS_PRIMARY_NAMESPACE, newroot, "dir.key3", "3");
+
+    /* sharding can be disabled
+     */
+    kvstxn_set_dirshard_threshold (0);
+    ops = json_array ();
+    for (i = 0; i < 16; i++) {
+        snprintf (key, sizeof (key), "dir2.key%d", i);
+        ops_append (ops, key, "x", 0);
+    }
+    process_dirshard_kvstxn (ktm, "transaction3", ops, newroot2, newroot);
+    json_decref (ops);
+
+    ok ((o = get_dirref_treeobj (cache, newroot, "dir2")) != NULL
+        && treeobj_is_dir (o),
+        "dir2 is stored as a dir with sharding disabled");
+    verify_value (cache, krm, KVS_PRIMARY_NAMESPACE, newroot, "dir.key16", "16");
+
+    kvstxn_set_dirshard_threshold (KVSTXN_DIRSHARD_THRESHOLD_DEFAULT);
+
+    kvstxn_mgr_destroy (ktm);
+    ktest_finalize (cache, krm);
+}
+
+void kvstxn_process_dirshard_user (void)
+{
+    struct cache *cache;
+    kvsroot_mgr_t *krm;
+    kvstxn_mgr_t *ktm;
+    kvstxn_t *kt;
+    json_t *ops, *op, *shard;
+    char root_ref[BLOBREF_MAX_STRING_SIZE];
+
+    cache = create_cache_with_empty_rootdir (root_ref, sizeof (root_ref));
+    if (!(krm = kvsroot_mgr_create (NULL, NULL)))
+        BAIL_OUT ("kvsroot_mgr_create failed");
+
+    setup_kvsroot (krm, KVS_PRIMARY_NAMESPACE, cache, root_ref);
+
+    ok ((ktm = kvstxn_mgr_create (cache,
+                                  KVS_PRIMARY_NAMESPACE,
+                                  "sha1",
+                                  NULL,
+                                  &test_global)) != NULL,
+        "kvstxn_mgr_create works");
+
+    /* users may not write dirshard objects */
+    shard = treeobj_create_dirshard (0);
+    ops = json_array ();
+    txn_encode_op ("shard", 0, shard, &op);
+    json_array_append_new (ops, op);
+
+    ok (kvstxn_mgr_add_transaction (ktm, "transaction1", ops, 0, 0) == 0,
+        "kvstxn_mgr_add_transaction works");
+    ok ((kt = kvstxn_mgr_get_ready_transaction (ktm)) != NULL,
+        "kvstxn_mgr_get_ready_transaction returns ready kvstxn");
+    ok (kvstxn_process (kt, root_ref, 0) == KVSTXN_PROCESS_ERROR
+        && kvstxn_get_errnum (kt) == EINVAL,
+        "kvstxn_process fails with EINVAL on dirshard dirent");
+
+    json_decref (ops);
+    json_decref (shard);
+    kvstxn_mgr_destroy (ktm);
+    ktest_finalize (cache, krm);
+}
+
+/* Process a transaction setting 'key' and return a copy of its delta
+ * (or NULL).
+ */
+static json_t *process_delta_kvstxn (kvstxn_mgr_t *ktm,
+                                     const char *name,
+                                     const char *key,
+                                     const char *root_ref,
+                                     char *newroot)
+{
+    kvstxn_t *kt;
+    json_t *ops = json_array ();
+    json_t *delta;
+
+    ops_append (ops, key, "42", 0);
+    ok (kvstxn_mgr_add_transaction (ktm, name, ops, 0, 0) == 0,
+        "kvstxn_mgr_add_transaction works");
+    ok ((kt = kvstxn_mgr_get_ready_transaction (ktm)) != NULL,
+        "kvstxn_mgr_get_ready_transaction returns ready kvstxn");
+    ok (kvstxn_process (kt, root_ref, 0) == KVSTXN_PROCESS_DIRTY_CACHE_ENTRIES,
+        "kvstxn_process returns KVSTXN_PROCESS_DIRTY_CACHE_ENTRIES");
+    ok (kvstxn_get_delta (kt) == NULL,
+        "kvstxn_get_delta returns NULL before transaction is finished");
+    ok (kvstxn_iter_dirty_cache_entries (kt, cache_noop_cb, NULL) == 0,
+        "kvstxn_iter_dirty_cache_entries works for dirty cache entries");
+    ok (kvstxn_process (kt, root_ref, 0) == KVSTXN_PROCESS_FINISHED,
+        "kvstxn_process returns KVSTXN_PROCESS_FINISHED");
+    strcpy (newroot, kvstxn_get_newroot_ref (kt));
+    delta = json_incref (kvstxn_get_delta (kt));
+    kvstxn_mgr_remove_transaction (ktm, kt, false);
+    json_decref (ops);
+    return delta;
+}
+
+void kvstxn_process_delta (void)
+{
+    struct cache *cache;
+    kvsroot_mgr_t *krm;
+    kvstxn_mgr_t *ktm;
+    json_t *delta;
+    struct cache_entry *entry;
+    const void *data;
+    int len;
+    char root_ref[BLOBREF_MAX_STRING_SIZE];
+    char newroot[BLOBREF_MAX_STRING_SIZE];
+    char newroot2[BLOBREF_MAX_STRING_SIZE];
+    char buf[1024];
+    const char *s;
+
+    cache = create_cache_with_empty_rootdir (root_ref, sizeof (root_ref));
+    if (!(krm = kvsroot_mgr_create (NULL, NULL)))
+        BAIL_OUT ("kvsroot_mgr_create failed");
+
+    setup_kvsroot (krm, KVS_PRIMARY_NAMESPACE, cache, root_ref);
+
+    ok ((ktm = kvstxn_mgr_create (cache,
+                                  KVS_PRIMARY_NAMESPACE,
+                                  "sha1",
+                                  NULL,
+                                  &test_global)) != NULL,
+        "kvstxn_mgr_create works");
+
+    ok (kvstxn_get_delta_max_size () == 0,
+        "kvstxn_get_delta_max_size returns 0 by default");
+
+    delta = process_delta_kvstxn (ktm, "transaction1", "a.b.c",
+                                  root_ref, newroot);
+    ok (delta == NULL,
+        "kvstxn_get_delta returns NULL when delta is disabled");
+
+    kvstxn_set_delta_max_size (65536);
+    ok (kvstxn_get_delta_max_size () == 65536,
+        "kvstxn_set_delta_max_size works");
+
+    delta = process_delta_kvstxn (ktm, "transaction2", "a.b.d",
+                                  newroot, newroot2);
+    ok (delta != NULL && json_object_size (delta) == 3,
+        "delta contains root and two new dirs");
+    ok ((s = json_string_value (json_object_get (delta, newroot2))) != NULL
+        && (entry = cache_lookup (cache, newroot2)) != NULL
+        && cache_entry_get_raw (entry, &data, &len) == 0
+        && base64_decode (buf, sizeof (buf), s, strlen (s)) == len
+        && memcmp (data, buf, len) == 0,
+        "delta contains the encoded new root dir");
+    json_decref (delta);
+
+    /* a delta too small for any dir object is not created
+     */
+    kvstxn_set_delta_max_size (16);
+    delta = process_delta_kvstxn (ktm, "transaction3", "a.b.e",
+                                  newroot2, newroot);
+    ok (delta == NULL,
+        "kvstxn_get_delta returns NULL when no dir fits in delta");
+
+    kvstxn_set_delta_max_size (0);
+
+    kvstxn_mgr_destroy (ktm);
+    ktest_finalize (cache, krm);
+}
+
+void kvstxn_process_treeobj_binary (void)
+{
+    struct cache *cache;
+    kvsroot_mgr_t *krm;
+    kvstxn_mgr_t *ktm;
+    struct cache_entry *entry;
+    const void *data;
+    int len;
+    json_t *ops;
+    char root_ref[BLOBREF_MAX_STRING_SIZE];
+    char newroot[BLOBREF_MAX_STRING_SIZE];
+    char newroot2[BLOBREF_MAX_STRING_SIZE];
+
+    cache = create_cache_with_empty_rootdir (root_ref, sizeof (root_ref));
+    if (!(krm = kvsroot_mgr_create (NULL, NULL)))
+        BAIL_OUT ("kvsroot_mgr_create failed");
+
+    setup_kvsroot (krm, KVS_PRIMARY_NAMESPACE, cache, root_ref);
+
+    ok ((ktm = kvstxn_mgr_create (cache,
+                                  KVS_PRIMARY_NAMESPACE,
+                                  "sha1",
+                                  NULL,
+                                  &test_global)) != NULL,
+        "kvstxn_mgr_create works");
+
+    ok (kvstxn_get_treeobj_binary () == false,
+        "kvstxn_get_treeobj_binary returns false by default");
+    kvstxn_set_treeobj_binary (true);
+    ok (kvstxn_get_treeobj_binary () == true,
+        "kvstxn_set_treeobj_binary works");
+
+    ops = json_array ();
+    ops_append (ops, "a.b", "1", 0);
+    ops_append (ops, "a.c", "2", 0);
+    process_dirshard_kvstxn (ktm, "transaction1", ops, root_ref, newroot);
+    json_decref (ops);
+
+    ok ((entry = cache_lookup (cache, newroot)) != NULL
+        && cache_entry_get_raw (entry, &data, &len) == 0
+        && len > 0
+        && ((const unsigned char *)data)[0] == TREEOBJ_BINARY_MAGIC,
+        "new root is stored in binary encoding");
+    verify_value (cache, krm, KVS_PRIMARY_NAMESPACE, newroot, "a.b", "1");
+    verify_value (cache, krm, KVS_PRIMARY_NAMESPACE, newroot, "a.c", "2");
+
+    /* JSON and binary encoded dirs may be mixed */
+    kvstxn_set_treeobj_binary (false);
+    ops = json_array ();
+    ops_append (ops, "d", "3", 0);
+    process_dirshard_kvstxn (ktm, "transaction2", ops, newroot, newroot2);
+    json_decref (ops);
+
+    ok ((entry = cache_lookup (cache, newroot2)) != NULL
+        && cache_entry_get_raw (entry, &data, &len) == 0
+        && len > 0
+        && ((const char *)data)[0] == '{',
+        "new root is stored in JSON encoding");
+    verify_value (cache, krm, KVS_PRIMARY_NAMESPACE, newroot2, "a.b", "1");
+    verify_value (cache, krm, KVS_PRIMARY_NAMESPACE, newroot2, "d", "3");
+
+    kvstxn_mgr_destroy (ktm);
+    ktest_finalize (cache, krm);
+}
+
+static int cache_clear_dirty_cb (kvstxn_t *kt,
+                                 struct cache_entry *entry,
+                                 void *data)
+{
+    int *count = data;
+    if (cache_entry_get_dirty (entry)) {
+        (*count)++;
+        if (cache_entry_clear_dirty (entry) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/* Process a transaction setting 'key' to 'val', marking stored entries
+ * clean as the KVS would after storing them.  Returns the number stored.
+ */
+static int process_gc_kvstxn (kvstxn_mgr_t *ktm,
+                              const char *name,
+                              const char *key,
+                              const char *val,
+                              const char *rootref)
+{
+    kvstxn_t *kt;
+    kvstxn_process_t ret;
+    int count = 0;
+
+    create_ready_kvstxn (ktm, name, key, val, 0, 0);
+    if (!(kt = kvstxn_mgr_get_ready_transaction (ktm)))
+        BAIL_OUT ("kvstxn_mgr_get_ready_transaction failed");
+    ret = kvstxn_process (kt, rootref, 0);
+    if (ret == KVSTXN_PROCESS_DIRTY_CACHE_ENTRIES) {
+        if (kvstxn_iter_dirty_cache_entries (kt,
+                                             cache_clear_dirty_cb,
+                                             &count) < 0)
+            BAIL_OUT ("kvstxn_iter_dirty_cache_entries failed");
+        ret = kvstxn_process (kt, rootref, 0);
+    }
+    ok (ret == KVSTXN_PROCESS_FINISHED,
+        "kvstxn_process returns KVSTXN_PROCESS_FINISHED for %s", name);
+    kvstxn_mgr_remove_transaction (ktm, kt, false);
+    return count;
+}
+
+void kvstxn_process_gc (void)
+{
+    struct cache *cache;
+    kvsroot_mgr_t *krm;
+    kvstxn_mgr_t *ktm;
+    kvstxn_t *kt;
+    char root_ref[BLOBREF_MAX_STRING_SIZE];
+    int count = 0;
+
+    cache = create_cache_with_empty_rootdir (root_ref, sizeof (root_ref));
+    if (!(krm = kvsroot_mgr_create (NULL, NULL)))
+        BAIL_OUT ("kvsroot_mgr_create failed");
+
+    setup_kvsroot (krm, KVS_PRIMARY_NAMESPACE, cache, root_ref);
+
+    ok ((ktm = kvstxn_mgr_create (cache,
+                                  KVS_PRIMARY_NAMESPACE,
+                                  "sha1",
+                                  NULL,
+                                  &test_global)) != NULL,
+        "kvstxn_mgr_create works");
+
+    ok (kvstxn_get_gc_active () == false,
+        "kvstxn_get_gc_active returns false by default");
+    ok (process_gc_kvstxn (ktm, "transaction1", "key1", "1", root_ref) == 1,
+        "first transaction stores the new root");
+    ok (process_gc_kvstxn (ktm, "transaction2", "key1", "1", root_ref) == 0,
+        "identical transaction stores nothing");
+
+    kvstxn_set_gc_active (true);
+    ok (kvstxn_get_gc_active () == true,
+        "kvstxn_set_gc_active works");
+    ok (process_gc_kvstxn (ktm, "transaction3", "key1", "1", root_ref) == 1,
+        "identical transaction stores the cached root again during gc");
+    ok (kvstxn_mgr_gc_pending (ktm) == false,
+        "kvstxn_mgr_gc_pending returns false with no transactions");
+
+    kvstxn_set_gc_active (false);
+    create_ready_kvstxn (ktm, "transaction4", "key2", "2", 0, 0);
+    if (!(kt = kvstxn_mgr_get_ready_transaction (ktm)))
+        BAIL_OUT ("kvstxn_mgr_get_ready_transaction failed");
+    ok (kvstxn_process (kt, root_ref, 0) == KVSTXN_PROCESS_DIRTY_CACHE_ENTRIES,
+        "kvstxn_process returns KVSTXN_PROCESS_DIRTY_CACHE_ENTRIES");
+    kvstxn_set_gc_active (true);
+    ok (kvstxn_mgr_gc_pending (ktm) == true,
+        "kvstxn_mgr_gc_pending returns true for kvstxn started before gc");
+    ok (kvstxn_iter_dirty_cache_entries (kt, cache_clear_dirty_cb, &count) == 0
+        && kvstxn_process (kt, root_ref, 0) == KVSTXN_PROCESS_FINISHED,
+        "kvstxn started before gc finishes");
+    kvstxn_mgr_remove_transaction (ktm, kt, false);
+    ok (kvstxn_mgr_gc_pending (ktm) == false,
+        "kvstxn_mgr_gc_pending returns false once it is removed");
+    kvstxn_set_gc_active (false);
+
+    kvstxn_mgr_destroy (ktm);
+    ktest_finalize (cache, krm);
+}
+
 void kvstxn_process_append (void)
 {
     struct cache *cache;
@@ -3534,6 +4084,7 @@ int main (int argc, char *argv[])
     plan (NO_PLAN);
 
     kvstxn_mgr_basic_tests ();
+    kvstxn_mgr_class_tests ();
     kvstxn_mgr_merge_tests ();
     kvstxn_basic_tests ();
     kvstxn_corner_case_tests ();
@@ -3567,6 +4118,11 @@ int main (int argc, char *argv[])
     kvstxn_process_bad_dirrefs ();
     kvstxn_process_big_fileval ();
     kvstxn_process_giant_dir ();
+    kvstxn_process_dirshard ();
+    kvstxn_process_dirshard_user ();
+    kvstxn_process_delta ();
+    kvstxn_process_treeobj_binary ();
+    kvstxn_process_gc ();
     kvstxn_process_append ();
     kvstxn_process_append_errors ();
     kvstxn_process_append_no_duplicate ();
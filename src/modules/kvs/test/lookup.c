@@ -2951,6 +2951,7 @@ void lookup_stall_namespace_removed (void) {
     cache_remove_entry (cache, root_ref);
     cache_remove_entry (cache, dirref_ref);
     cache_remove_entry (cache, valref_ref);
+    cache_path_purge (cache);
     setup_kvsroot (krm, KVS_PRIMARY_NAMESPACE, cache, root_ref, 0);
 
     /*
@@ -3046,6 +3047,7 @@ void lookup_stall_namespace_removed (void) {
     cache_remove_entry (cache, root_ref);
     cache_remove_entry (cache, dirref_ref);
     cache_remove_entry (cache, valref_ref);
+    cache_path_purge (cache);
     setup_kvsroot (krm, KVS_PRIMARY_NAMESPACE, cache, root_ref, 0);
 
     /*
@@ -3092,6 +3094,7 @@ void lookup_stall_namespace_removed (void) {
     cache_remove_entry (cache, root_ref);
     cache_remove_entry (cache, dirref_ref);
     cache_remove_entry (cache, valref_ref);
+    cache_path_purge (cache);
     setup_kvsroot (krm, KVS_PRIMARY_NAMESPACE, cache, root_ref, 0);
 
     ok ((lh = lookup_create (cache,
@@ -3135,6 +3138,7 @@ void lookup_stall_namespace_removed (void) {
     cache_remove_entry (cache, root_ref);
     cache_remove_entry (cache, dirref_ref);
     cache_remove_entry (cache, valref_ref);
+    cache_path_purge (cache);
     setup_kvsroot (krm, KVS_PRIMARY_NAMESPACE, cache, root_ref, 0);
 
     ltest_finalize (cache, krm);
@@ -3322,6 +3326,458 @@ void lookup_stall_ref_expire_cache_entries (void) {
     json_decref (root);
 }
 
+/* lookups under the same root skip directories resolved earlier */
+void lookup_path_cache (void) {
+    json_t *root;
+    json_t *dirref1;
+    json_t *dirref2;
+    json_t *test;
+    struct cache *cache;
+    kvsroot_mgr_t *krm;
+    lookup_t *lh;
+    char dirref1_ref[BLOBREF_MAX_STRING_SIZE];
+    char dirref2_ref[BLOBREF_MAX_STRING_SIZE];
+    char root_ref[BLOBREF_MAX_STRING_SIZE];
+
+    ltest_init (&cache, &krm);
+
+    /* This cache is
+     *
+     * dirref2_ref
+     * "val" : val to "bar"
+     *
+     * dirref1_ref
+     * "val" : val to "foo"
+     * "dirref2" : dirref to dirref2_ref
+     *
+     * root_ref
+     * "dirref1" : dirref to dirref1_ref
+     * "symlink" : symlink to "dirref1"
+     */
+
+    dirref2 = treeobj_create_dir ();
+    _treeobj_insert_entry_val (dirref2, "val", "bar", 3);
+    treeobj_hash ("sha1", dirref2, dirref2_ref, sizeof (dirref2_ref));
+    (void)cache_insert (cache, create_cache_entry_treeobj (dirref2_ref, dirref2));
+
+    dirref1 = treeobj_create_dir ();
+    _treeobj_insert_entry_val (dirref1, "val", "foo", 3);
+    _treeobj_insert_entry_dirref (dirref1, "dirref2", dirref2_ref);
+    treeobj_hash ("sha1", dirref1, dirref1_ref, sizeof (dirref1_ref));
+    (void)cache_insert (cache, create_cache_entry_treeobj (dirref1_ref, dirref1));
+
+    root = treeobj_create_dir ();
+    _treeobj_insert_entry_dirref (root, "dirref1", dirref1_ref);
+    _treeobj_insert_entry_symlink (root, "symlink", NULL, "dirref1");
+    treeobj_hash ("sha1", root, root_ref, sizeof (root_ref));
+    (void)cache_insert (cache, create_cache_entry_treeobj (root_ref, root));
+
+    setup_kvsroot (krm, KVS_PRIMARY_NAMESPACE, cache, root_ref, 0);
+
+    /* paths through symlinks are not remembered */
+    ok ((lh = lookup_create (cache,
+                             krm,
+                             KVS_PRIMARY_NAMESPACE,
+                             NULL,
+                             0,
+                             "symlink.dirref2.val",
+                             owner_cred,
+                             0,
+                             NULL)) != NULL,
+        "lookup_create on path symlink.dirref2.val");
+    test = treeobj_create_val ("bar", 3);
+    check_value (lh, test, "lookup symlink.dirref2.val");
+    json_decref (test);
+    ok (cache_path_count (cache) == 0,
+        "no paths remembered after lookup through symlink");
+
+    ok ((lh = lookup_create (cache,
+                             krm,
+                             KVS_PRIMARY_NAMESPACE,
+                             NULL,
+                             0,
+                             "dirref1.dirref2.val",
+                             owner_cred,
+                             0,
+                             NULL)) != NULL,
+        "lookup_create on path dirref1.dirref2.val");
+    test = treeobj_create_val ("bar", 3);
+    check_value (lh, test, "lookup dirref1.dirref2.val");
+    json_decref (test);
+    ok (cache_path_count (cache) == 2,
+        "dirref1 and dirref1.dirref2 remembered");
+    ok (cache_path_lookup (cache, root_ref, "dirref1.dirref2", 15) != NULL
+        && streq (cache_path_lookup (cache, root_ref, "dirref1.dirref2", 15),
+                  dirref2_ref),
+        "dirref1.dirref2 maps to dirref2_ref");
+    ok (cache_path_lookup (cache, dirref1_ref, "dirref1", 7) == NULL,
+        "paths are not shared between roots");
+
+    /* with the root and dirref1 gone, lookup only needs dirref2 */
+    ok (cache_remove_entry (cache, root_ref) == 1
+        && cache_remove_entry (cache, dirref1_ref) == 1,
+        "removed root_ref and dirref1_ref from cache");
+
+    ok ((lh = lookup_create (cache,
+                             krm,
+                             KVS_PRIMARY_NAMESPACE,
+                             NULL,
+                             0,
+                             "dirref1.dirref2.val",
+                             owner_cred,
+                             0,
+                             NULL)) != NULL,
+        "lookup_create on path dirref1.dirref2.val");
+    test = treeobj_create_val ("bar", 3);
+    check_value (lh, test, "lookup dirref1.dirref2.val without root");
+    json_decref (test);
+
+    ok ((lh = lookup_create (cache,
+                             krm,
+                             KVS_PRIMARY_NAMESPACE,
+                             NULL,
+                             0,
+                             "dirref1.val",
+                             owner_cred,
+                             0,
+                             NULL)) != NULL,
+        "lookup_create on path dirref1.val");
+    check_stall (lh, EAGAIN, 1, dirref1_ref, "dirref1.val stalls on dirref1");
+    lookup_destroy (lh);
+
+    cache_path_purge (cache);
+    ok (cache_path_count (cache) == 0,
+        "cache_path_purge works");
+    ok ((lh = lookup_create (cache,
+                             krm,
+                             KVS_PRIMARY_NAMESPACE,
+                             NULL,
+                             0,
+                             "dirref1.dirref2.val",
+                             owner_cred,
+                             0,
+                             NULL)) != NULL,
+        "lookup_create on path dirref1.dirref2.val");
+    check_stall (lh, EAGAIN, 1, root_ref,
+                 "dirref1.dirref2.val stalls on root after purge");
+    lookup_destroy (lh);
+
+    ltest_finalize (cache, krm);
+    json_decref (dirref1);
+    json_decref (dirref2);
+    json_decref (root);
+}
+
+/* lookup tests on sharded directories */
+void lookup_dirshard (void) {
+    json_t *root;
+    json_t *dir;
+    json_t *shard;
+    json_t *buckets;
+    json_t *bucket;
+    json_t *test;
+    const char *name;
+    struct cache *cache;
+    kvsroot_mgr_t *krm;
+    lookup_t *lh;
+    lookup_t *lh2;
+    char bucket_ref[BLOBREF_MAX_STRING_SIZE];
+    char missing_ref[BLOBREF_MAX_STRING_SIZE];
+    char shard_ref[BLOBREF_MAX_STRING_SIZE];
+    char root_ref[BLOBREF_MAX_STRING_SIZE];
+    json_t *missing_bucket = NULL;
+
+    ltest_init (&cache, &krm);
+
+    /* This cache is
+     *
+     * shard_ref
+     * dirshard of dir with entries "a" to "h", buckets are dirrefs,
+     * the bucket holding "a" is not in the cache initially.
+     *
+     * root_ref
+     * "dir" : dirref to shard_ref
+     */
+
+    dir = treeobj_create_dir ();
+    _treeobj_insert_entry_val (dir, "a", "1", 1);
+    _treeobj_insert_entry_val (dir, "b", "2", 1);
+    _treeobj_insert_entry_val (dir, "c", "3", 1);
+    _treeobj_insert_entry_val (dir, "d", "4", 1);
+    _treeobj_insert_entry_val (dir, "e", "5", 1);
+    _treeobj_insert_entry_val (dir, "f", "6", 1);
+    _treeobj_insert_entry_val (dir, "g", "7", 1);
+    _treeobj_insert_entry_val (dir, "h", "8", 1);
+
+    if (!(shard = treeobj_dirshard_split (dir, 0)))
+        BAIL_OUT ("treeobj_dirshard_split failed");
+    missing_bucket = json_incref (treeobj_dirshard_get_bucket (shard, "a"));
+    buckets = treeobj_dirshard_get_buckets (shard);
+    json_object_foreach (buckets, name, bucket) {
+        treeobj_hash ("sha1", bucket, bucket_ref, sizeof (bucket_ref));
+        if (bucket == missing_bucket)
+            strcpy (missing_ref, bucket_ref);
+        else {
+            (void)cache_insert (cache,
+                                create_cache_entry_treeobj (bucket_ref,
+                                                            bucket));
+        }
+        json_object_set_new (buckets, name, treeobj_create_dirref (bucket_ref));
+    }
+    treeobj_hash ("sha1", shard, shard_ref, sizeof (shard_ref));
+    (void)cache_insert (cache, create_cache_entry_treeobj (shard_ref, shard));
+
+    root = treeobj_create_dir ();
+    _treeobj_insert_entry_dirref (root, "dir", shard_ref);
+    treeobj_hash ("sha1", root, root_ref, sizeof (root_ref));
+    (void)cache_insert (cache, create_cache_entry_treeobj (root_ref, root));
+
+    setup_kvsroot (krm, KVS_PRIMARY_NAMESPACE, cache, root_ref, 0);
+
+    /* lookup dir.b, bucket in cache */
+    ok ((lh = lookup_create (cache,
+                             krm,
+                             KVS_PRIMARY_NAMESPACE,
+                             NULL,
+                             0,
+                             "dir.b",
+                             owner_cred,
+                             0,
+                             NULL)) != NULL,
+        "lookup_create on path dir.b");
+    test = treeobj_create_val ("2", 1);
+    check_value (lh, test, "lookup dir.b");
+    json_decref (test);
+
+    /* lookup dir.a, stall on missing bucket */
+    ok ((lh = lookup_create (cache,
+                             krm,
+                             KVS_PRIMARY_NAMESPACE,
+                             NULL,
+                             0,
+                             "dir.a",
+                             owner_cred,
+                             0,
+                             NULL)) != NULL,
+        "lookup_create on path dir.a");
+    check_stall (lh, EAGAIN, 1, missing_ref, "dir.a stall");
+
+    /* readdir dir, stall on missing bucket */
+    ok ((lh2 = lookup_create (cache,
+                              krm,
+                              KVS_PRIMARY_NAMESPACE,
+                              NULL,
+                              0,
+                              "dir",
+                              owner_cred,
+                              FLUX_KVS_READDIR,
+                              NULL)) != NULL,
+        "lookup_create on path dir (readdir)");
+    check_stall (lh2, EAGAIN, 1, missing_ref, "dir readdir stall");
+
+    (void)cache_insert (cache, create_cache_entry_treeobj (missing_ref,
+                                                           missing_bucket));
+
+    test = treeobj_create_val ("1", 1);
+    check_value (lh, test, "lookup dir.a after stall");
+    json_decref (test);
+
+    check_value (lh2, dir, "readdir dir after stall returns merged dir");
+
+    /* lookup dir.nokey */
+    ok ((lh = lookup_create (cache,
+                             krm,
+                             KVS_PRIMARY_NAMESPACE,
+                             NULL,
+                             0,
+                             "dir.nokey",
+                             owner_cred,
+                             0,
+                             NULL)) != NULL,
+        "lookup_create on path dir.nokey");
+    check_value (lh, NULL, "lookup dir.nokey");
+
+    ltest_finalize (cache, krm);
+    json_decref (missing_bucket);
+    json_decref (shard);
+    json_decref (dir);
+    json_decref (root);
+}
+
+void check_append (lookup_t *lh,
+                   json_t *get_value_result,
+                   json_t *sizes_result,
+                   const char *msg)
+{
+    json_t *sizes;
+
+    check_common (lh,
+                  LOOKUP_PROCESS_FINISHED,
+                  0,
+                  false,
+                  get_value_result,
+                  1,
+                  NULL,
+                  msg,
+                  false);
+    ok ((sizes = lookup_get_append_sizes (lh)) != NULL
+        && json_equal (sizes, sizes_result) == true,
+        "%s: lookup_get_append_sizes returned matching sizes", msg);
+    json_decref (sizes);
+    lookup_destroy (lh);
+}
+
+lookup_t *append_lookup_create (struct cache *cache,
+                                kvsroot_mgr_t *krm,
+                                const char *path,
+                                int index)
+{
+    lookup_t *lh;
+
+    if (!(lh = lookup_create (cache,
+                              krm,
+                              KVS_PRIMARY_NAMESPACE,
+                              NULL,
+                              0,
+                              path,
+                              owner_cred,
+                              0,
+                              NULL)))
+        BAIL_OUT ("lookup_create failed");
+    if (lookup_set_append_index (lh, index) < 0)
+        BAIL_OUT ("lookup_set_append_index failed");
+    return lh;
+}
+
+void lookup_append_index (void) {
+    json_t *root;
+    json_t *valref;
+    json_t *test;
+    json_t *sizes;
+    struct cache *cache;
+    kvsroot_mgr_t *krm;
+    lookup_t *lh;
+    char valref1_ref[BLOBREF_MAX_STRING_SIZE];
+    char valref2_ref[BLOBREF_MAX_STRING_SIZE];
+    char valref3_ref[BLOBREF_MAX_STRING_SIZE];
+    char root_ref[BLOBREF_MAX_STRING_SIZE];
+
+    ltest_init (&cache, &krm);
+
+    /* This cache is
+     *
+     * valref1_ref
+     * "abcd"
+     *
+     * valref2_ref
+     * "efgh"
+     *
+     * valref3_ref
+     * "ij", not in the cache initially
+     *
+     * root_ref
+     * "val" : val to "foo"
+     * "valref" : valref to [ valref1_ref, valref2_ref, valref3_ref ]
+     */
+
+    blobref_hash ("sha1", "abcd", 4, valref1_ref, sizeof (valref1_ref));
+    blobref_hash ("sha1", "efgh", 4, valref2_ref, sizeof (valref2_ref));
+    blobref_hash ("sha1", "ij", 2, valref3_ref, sizeof (valref3_ref));
+
+    (void)cache_insert (cache, create_cache_entry_raw (valref1_ref, "abcd", 4));
+    (void)cache_insert (cache, create_cache_entry_raw (valref2_ref, "efgh", 4));
+
+    root = treeobj_create_dir ();
+    _treeobj_insert_entry_val (root, "val", "foo", 3);
+    valref = treeobj_create_valref (valref1_ref);
+    treeobj_append_blobref (valref, valref2_ref);
+    treeobj_append_blobref (valref, valref3_ref);
+    treeobj_insert_entry (root, "valref", valref);
+    treeobj_hash ("sha1", root, root_ref, sizeof (root_ref));
+    (void)cache_insert (cache, create_cache_entry_treeobj (root_ref, root));
+
+    setup_kvsroot (krm, KVS_PRIMARY_NAMESPACE, cache, root_ref, 0);
+
+    /* invalid append index */
+    ok ((lh = lookup_create (cache,
+                             krm,
+                             KVS_PRIMARY_NAMESPACE,
+                             NULL,
+                             0,
+                             "val",
+                             owner_cred,
+                             0,
+                             NULL)) != NULL,
+        "lookup_create on path val");
+    ok (lookup_set_append_index (lh, -1) < 0 && errno == EINVAL,
+        "lookup_set_append_index fails on negative index");
+    ok (lookup (lh) == LOOKUP_PROCESS_FINISHED,
+        "lookup val without append index");
+    ok (lookup_get_append_sizes (lh) == NULL,
+        "lookup_get_append_sizes returns NULL without append index");
+    ok (lookup_set_append_index (lh, 0) < 0 && errno == EINVAL,
+        "lookup_set_append_index fails after lookup");
+    lookup_destroy (lh);
+
+    /* only the missing blob after the append index is loaded */
+    lh = append_lookup_create (cache, krm, "valref", 2);
+    check_stall (lh, EAGAIN, 1, valref3_ref, "valref index 2 stall");
+
+    (void)cache_insert (cache, create_cache_entry_raw (valref3_ref, "ij", 2));
+
+    test = treeobj_create_val ("ij", 2);
+    sizes = json_pack ("[i]", 2);
+    check_append (lh, test, sizes, "valref index 2 after stall");
+    json_decref (test);
+    json_decref (sizes);
+
+    lh = append_lookup_create (cache, krm, "valref", 0);
+    test = treeobj_create_val ("abcdefghij", 10);
+    sizes = json_pack ("[i,i,i]", 4, 4, 2);
+    check_append (lh, test, sizes, "valref index 0");
+    json_decref (test);
+    json_decref (sizes);
+
+    lh = append_lookup_create (cache, krm, "valref", 1);
+    test = treeobj_create_val ("efghij", 6);
+    sizes = json_pack ("[i,i]", 4, 2);
+    check_append (lh, test, sizes, "valref index 1");
+    json_decref (test);
+    json_decref (sizes);
+
+    lh = append_lookup_create (cache, krm, "valref", 3);
+    test = treeobj_create_val (NULL, 0);
+    sizes = json_array ();
+    check_append (lh, test, sizes, "valref index 3");
+    json_decref (test);
+    json_decref (sizes);
+
+    lh = append_lookup_create (cache, krm, "valref", 4);
+    check_error (lh, EINVAL, "valref index 4");
+
+    /* inline val counts as one blob */
+    lh = append_lookup_create (cache, krm, "val", 0);
+    test = treeobj_create_val ("foo", 3);
+    sizes = json_pack ("[i]", 3);
+    check_append (lh, test, sizes, "val index 0");
+    json_decref (test);
+    json_decref (sizes);
+
+    lh = append_lookup_create (cache, krm, "val", 1);
+    test = treeobj_create_val (NULL, 0);
+    sizes = json_array ();
+    check_append (lh, test, sizes, "val index 1");
+    json_decref (test);
+    json_decref (sizes);
+
+    lh = append_lookup_create (cache, krm, "val", 2);
+    check_error (lh, EINVAL, "val index 2");
+
+    ltest_finalize (cache, krm);
+    json_decref (root);
+    json_decref (valref);
+}
+
 int main (int argc, char *argv[])
 {
     plan (NO_PLAN);
@@ -3344,6 +3800,9 @@ int main (int argc, char *argv[])
     lookup_stall_ref ();
     lookup_stall_namespace_removed ();
     lookup_stall_ref_expire_cache_entries ();
+    lookup_path_cache ();
+    lookup_dirshard ();
+    lookup_append_index ();
 
     done_testing ();
     return (0);
@@ -0,0 +1,179 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdbool.h>
+#include <errno.h>
+#include <jansson.h>
+
+#include "src/common/libtap/tap.h"
+#include "src/modules/kvs/topn.h"
+#include "ccan/str/str.h"
+
+static json_t *get_entry (json_t *a, int index, const char **name)
+{
+    json_t *o;
+
+    if (!(o = json_array_get (a, index))
+        || json_unpack (o, "{s:s}", "name", name) < 0)
+        BAIL_OUT ("topn_get returned a malformed entry");
+    return o;
+}
+
+static json_int_t get_int (json_t *o, const char *field)
+{
+    json_int_t i;
+
+    if (json_unpack (o, "{s:I}", field, &i) < 0)
+        BAIL_OUT ("topn_get entry has no %s", field);
+    return i;
+}
+
+void basic_tests (void)
+{
+    struct topn *tn;
+    json_t *a;
+    json_t *o;
+    const char *name;
+    double latency;
+
+    errno = 0;
+    ok (topn_create (0) == NULL && errno == EINVAL,
+        "topn_create size=0 fails with EINVAL");
+    lives_ok ({topn_destroy (NULL);},
+              "topn_destroy tn=NULL doesn't crash");
+
+    if (!(tn = topn_create (4)))
+        BAIL_OUT ("topn_create failed");
+
+    errno = 0;
+    ok (topn_add_lookup (tn, NULL, 1, 0, -1.) < 0 && errno == EINVAL,
+        "topn_add_lookup name=NULL fails with EINVAL");
+    errno = 0;
+    ok (topn_add_commit (tn, "a", 0, 0, -1.) < 0 && errno == EINVAL,
+        "topn_add_commit weight=0 fails with EINVAL");
+
+    a = topn_get (tn);
+    ok (a != NULL && json_array_size (a) == 0,
+        "topn_get returns an empty array initially");
+    json_decref (a);
+
+    ok (topn_add_lookup (tn, "a", 1, 10, 0.5) == 0
+        && topn_add_lookup (tn, "b", 2, 20, -1.) == 0
+        && topn_add_lookup (tn, "b", 2, 20, -1.) == 0
+        && topn_add_commit (tn, "a", 1, 30, 1.5) == 0
+        && topn_add_commit (tn, "c", 8, 1, -1.) == 0,
+        "topn_add_lookup and topn_add_commit work");
+
+    if (!(a = topn_get (tn)))
+        BAIL_OUT ("topn_get failed");
+    ok (json_array_size (a) == 3,
+        "topn_get returns 3 entries");
+    o = get_entry (a, 0, &name);
+    ok (streq (name, "c")
+        && get_int (o, "count") == 8
+        && get_int (o, "commits") == 8
+        && get_int (o, "lookups") == 0
+        && get_int (o, "bytes") == 8
+        && get_int (o, "error") == 0,
+        "first entry has the highest count and weighted bytes");
+    o = get_entry (a, 1, &name);
+    ok (streq (name, "b")
+        && get_int (o, "count") == 4
+        && get_int (o, "lookups") == 4
+        && get_int (o, "bytes") == 80,
+        "second entry is correct");
+    o = get_entry (a, 2, &name);
+    ok (streq (name, "a")
+        && get_int (o, "count") == 2
+        && get_int (o, "lookups") == 1
+        && get_int (o, "commits") == 1
+        && get_int (o, "bytes") == 40,
+        "third entry counts both lookups and commits");
+    ok (json_unpack (o, "{s:f}", "latency", &latency) == 0
+        && latency > 0.999 && latency < 1.001,
+        "latency is the mean of the measured requests");
+    json_decref (a);
+
+    topn_clear (tn);
+    a = topn_get (tn);
+    ok (a != NULL && json_array_size (a) == 0,
+        "topn_get returns an empty array after topn_clear");
+    json_decref (a);
+
+    topn_destroy (tn);
+}
+
+void eviction_tests (void)
+{
+    struct topn *tn;
+    json_t *a;
+    json_t *o;
+    const char *name;
+    bool found_d = false;
+    bool found_a = false;
+
+    if (!(tn = topn_create (2)))
+        BAIL_OUT ("topn_create failed");
+
+    ok (topn_add_lookup (tn, "a", 5, 0, -1.) == 0
+        && topn_add_lookup (tn, "b", 3, 0, -1.) == 0
+        && topn_add_lookup (tn, "c", 1, 0, -1.) == 0,
+        "added a third name to a table of size 2");
+
+    if (!(a = topn_get (tn)))
+        BAIL_OUT ("topn_get failed");
+    ok (json_array_size (a) == 2,
+        "topn_get returns 2 entries");
+    o = get_entry (a, 0, &name);
+    ok (streq (name, "a") && get_int (o, "count") == 5,
+        "name with the highest count was kept");
+    o = get_entry (a, 1, &name);
+    ok (streq (name, "c")
+        && get_int (o, "count") == 4
+        && get_int (o, "error") == 3
+        && get_int (o, "lookups") == 1,
+        "new name replaced the lowest count, inheriting it as error");
+    json_decref (a);
+
+    ok (topn_add_commit (tn, "d", 1, 0, -1.) == 0,
+        "added a fourth name");
+    if (!(a = topn_get (tn)))
+        BAIL_OUT ("topn_get failed");
+    for (size_t i = 0; i < json_array_size (a); i++) {
+        o = get_entry (a, i, &name);
+        if (streq (name, "d"))
+            found_d = get_int (o, "count") == 5 && get_int (o, "error") == 4;
+        else if (streq (name, "a"))
+            found_a = true;
+    }
+    ok (json_array_size (a) == 2 && found_a && found_d,
+        "fourth name replaced the third");
+    json_decref (a);
+
+    topn_destroy (tn);
+}
+
+int main (int argc, char *argv[])
+{
+    plan (NO_PLAN);
+
+    basic_tests ();
+    eviction_tests ();
+
+    done_testing ();
+    return 0;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -12,6 +12,7 @@
 #include "config.h"
 #endif
 #include <stdbool.h>
+#include <errno.h>
 #include <jansson.h>
 
 #include "src/common/libtap/tap.h"
@@ -195,6 +196,46 @@ void treq_ops_tests (void)
     treq_destroy (tr);
 }
 
+void treq_ops_count_tests (void)
+{
+    treq_t *tr;
+    json_t *ops;
+
+    ok ((tr = treq_create ("foo", 5, 0)) != NULL,
+        "treq_create works");
+
+    ops = json_array ();
+    json_array_append_new (ops, json_string ("A"));
+    json_array_append_new (ops, json_string ("B"));
+
+    errno = 0;
+    ok (treq_add_request_ops_count (tr, ops, 0) < 0 && errno == EINVAL,
+        "treq_add_request_ops_count fails with EINVAL on count of 0");
+
+    ok (treq_add_request_ops_count (tr, ops, 3) == 0,
+        "treq_add_request_ops_count adds ops for 3 requests");
+
+    ok (treq_count_reached (tr) == false,
+        "treq_count_reached() is false");
+
+    errno = 0;
+    ok (treq_add_request_ops_count (tr, NULL, 3) < 0 && errno == EOVERFLOW,
+        "treq_add_request_ops_count fails with EOVERFLOW exceeding nprocs");
+
+    ok (treq_add_request_ops_count (tr, NULL, 2) == 0,
+        "treq_add_request_ops_count adds remaining 2 requests");
+
+    ok (treq_count_reached (tr) == true,
+        "treq_count_reached() is true");
+
+    ok (json_equal (ops, treq_get_ops (tr)) == true,
+        "treq_get_ops match");
+
+    json_decref (ops);
+
+    treq_destroy (tr);
+}
+
 void treq_request_tests (void)
 {
     treq_t *tr;
@@ -367,6 +408,7 @@ int main (int argc, char *argv[])
 
     treq_basic_tests ();
     treq_ops_tests ();
+    treq_ops_count_tests ();
     treq_request_tests ();
     treq_mgr_basic_tests ();
     treq_mgr_iter_tests ();
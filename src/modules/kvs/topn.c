@@ -0,0 +1,224 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* topn.c - space-saving top-N counters
+ *
+ * Entries live in a fixed array indexed by a hash of their names.
+ * Finding the entry to evict is a linear scan, which is cheap for the
+ * small sizes used here, and only happens when an untracked name is
+ * seen with the table full.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <jansson.h>
+
+#include "src/common/libczmqcontainers/czmq_containers.h"
+
+#include "topn.h"
+
+struct topn_entry {
+    char *name;
+    uint64_t count;
+    uint64_t error;
+    uint64_t lookups;
+    uint64_t commits;
+    uint64_t bytes;
+    double latency_sum;
+    uint64_t latency_count;
+};
+
+struct topn {
+    int size;
+    int used;
+    struct topn_entry *entries;
+    zhashx_t *index;            /* name => entry */
+};
+
+void topn_destroy (struct topn *tn)
+{
+    if (tn) {
+        int saved_errno = errno;
+        for (int i = 0; i < tn->used; i++)
+            free (tn->entries[i].name);
+        free (tn->entries);
+        zhashx_destroy (&tn->index);
+        free (tn);
+        errno = saved_errno;
+    }
+}
+
+struct topn *topn_create (int size)
+{
+    struct topn *tn;
+
+    if (size <= 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(tn = calloc (1, sizeof (*tn))))
+        return NULL;
+    tn->size = size;
+    if (!(tn->entries = calloc (size, sizeof (tn->entries[0])))
+        || !(tn->index = zhashx_new ())) {
+        topn_destroy (tn);
+        errno = ENOMEM;
+        return NULL;
+    }
+    return tn;
+}
+
+void topn_clear (struct topn *tn)
+{
+    if (tn) {
+        for (int i = 0; i < tn->used; i++)
+            free (tn->entries[i].name);
+        memset (tn->entries, 0, tn->size * sizeof (tn->entries[0]));
+        tn->used = 0;
+        zhashx_purge (tn->index);
+    }
+}
+
+/* Return the entry for 'name', adding it if it is not tracked, by
+ * replacing the entry with the lowest count if the table is full.
+ */
+static struct topn_entry *topn_entry_get (struct topn *tn, const char *name)
+{
+    struct topn_entry *e;
+    char *cpy;
+
+    if ((e = zhashx_lookup (tn->index, name)))
+        return e;
+    if (!(cpy = strdup (name)))
+        return NULL;
+    if (tn->used < tn->size)
+        e = &tn->entries[tn->used++];
+    else {
+        e = &tn->entries[0];
+        for (int i = 1; i < tn->size; i++) {
+            if (tn->entries[i].count < e->count)
+                e = &tn->entries[i];
+        }
+        zhashx_delete (tn->index, e->name);
+        free (e->name);
+        *e = (struct topn_entry){ .count = e->count, .error = e->count };
+    }
+    e->name = cpy;
+    zhashx_update (tn->index, e->name, e);
+    return e;
+}
+
+static int topn_add (struct topn *tn,
+                     const char *name,
+                     int weight,
+                     bool commit,
+                     size_t bytes,
+                     double latency)
+{
+    struct topn_entry *e;
+
+    if (!tn || !name || weight <= 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!(e = topn_entry_get (tn, name)))
+        return -1;
+    e->count += weight;
+    if (commit)
+        e->commits += weight;
+    else
+        e->lookups += weight;
+    e->bytes += bytes * weight;
+    if (latency >= 0.) {
+        e->latency_sum += latency;
+        e->latency_count++;
+    }
+    return 0;
+}
+
+int topn_add_lookup (struct topn *tn,
+                     const char *name,
+                     int weight,
+                     size_t bytes,
+                     double latency)
+{
+    return topn_add (tn, name, weight, false, bytes, latency);
+}
+
+int topn_add_commit (struct topn *tn,
+                     const char *name,
+                     int weight,
+                     size_t bytes,
+                     double latency)
+{
+    return topn_add (tn, name, weight, true, bytes, latency);
+}
+
+static int entry_cmp (const void *a, const void *b)
+{
+    const struct topn_entry *e1 = *(const struct topn_entry **)a;
+    const struct topn_entry *e2 = *(const struct topn_entry **)b;
+
+    if (e1->count != e2->count)
+        return e1->count < e2->count ? 1 : -1;
+    return strcmp (e1->name, e2->name);
+}
+
+json_t *topn_get (struct topn *tn)
+{
+    struct topn_entry **sorted = NULL;
+    json_t *a = NULL;
+
+    if (!tn) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(sorted = calloc (tn->size, sizeof (*sorted))))
+        return NULL;
+    for (int i = 0; i < tn->used; i++)
+        sorted[i] = &tn->entries[i];
+    qsort (sorted, tn->used, sizeof (*sorted), entry_cmp);
+    if (!(a = json_array ()))
+        goto nomem;
+    for (int i = 0; i < tn->used; i++) {
+        struct topn_entry *e = sorted[i];
+        double latency = 0.;
+        json_t *o;
+
+        if (e->latency_count > 0)
+            latency = e->latency_sum / e->latency_count;
+        if (!(o = json_pack ("{s:s s:I s:I s:I s:I s:I s:f}",
+                             "name", e->name,
+                             "count", (json_int_t)e->count,
+                             "error", (json_int_t)e->error,
+                             "lookups", (json_int_t)e->lookups,
+                             "commits", (json_int_t)e->commits,
+                             "bytes", (json_int_t)e->bytes,
+                             "latency", latency))
+            || json_array_append_new (a, o) < 0)
+            goto nomem;
+    }
+    free (sorted);
+    return a;
+nomem:
+    free (sorted);
+    json_decref (a);
+    errno = ENOMEM;
+    return NULL;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
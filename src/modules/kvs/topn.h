@@ -0,0 +1,58 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _FLUX_KVS_TOPN_H
+#define _FLUX_KVS_TOPN_H
+
+#include <stdint.h>
+#include <jansson.h>
+
+/* Approximate top-N counters of KVS activity by name (e.g. namespace,
+ * key prefix, or userid), using the space-saving algorithm: at most
+ * 'size' names are tracked, and a new name replaces the one with the
+ * lowest count, inheriting that count as its possible overestimate.
+ * Any name whose true count exceeds 1/size of the total is retained.
+ */
+struct topn;
+
+struct topn *topn_create (int size);
+void topn_destroy (struct topn *tn);
+
+/* Record 'weight' lookups or commits of 'name', where 'bytes' is the
+ * size of the values read or written and 'latency' (seconds, or < 0 if
+ * not measured) is the time taken to respond.  'weight' is the sampling
+ * period, so counts and bytes estimate totals.
+ */
+int topn_add_lookup (struct topn *tn,
+                     const char *name,
+                     int weight,
+                     size_t bytes,
+                     double latency);
+int topn_add_commit (struct topn *tn,
+                     const char *name,
+                     int weight,
+                     size_t bytes,
+                     double latency);
+
+/* Return an array of tracked names, ordered by descending count:
+ *   [{"name":s, "count":I, "error":I, "lookups":I, "commits":I,
+ *     "bytes":I, "latency":f}, ...]
+ * where "error" is the maximum overestimate of "count", and "latency"
+ * is the mean latency of sampled requests in seconds.
+ */
+json_t *topn_get (struct topn *tn);
+
+void topn_clear (struct topn *tn);
+
+#endif /* !_FLUX_KVS_TOPN_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -286,11 +286,20 @@ json_t *treq_get_ops (treq_t *tr)
 }
 
 int treq_add_request_ops (treq_t *tr, json_t *ops)
+{
+    return treq_add_request_ops_count (tr, ops, 1);
+}
+
+int treq_add_request_ops_count (treq_t *tr, json_t *ops, int count)
 {
     json_t *op;
     int i;
 
-    if (tr->count == tr->nprocs) {
+    if (count <= 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (count > tr->nprocs - tr->count) {
         errno = EOVERFLOW;
         return -1;
     }
@@ -304,7 +313,7 @@ int treq_add_request_ops (treq_t *tr, json_t *ops)
                 }
         }
     }
-    tr->count++;
+    tr->count += count;
     return 0;
 }
 
@@ -72,6 +72,11 @@ json_t *treq_get_ops (treq_t *tr);
  */
 int treq_add_request_ops (treq_t *tr, json_t *ops);
 
+/* Like treq_add_request_ops(), but 'ops' are the merged ops of 'count'
+ * requests, e.g. as relayed from a downstream broker.
+ */
+int treq_add_request_ops_count (treq_t *tr, json_t *ops, int count);
+
 /* copy the request message into the transaction, where it can be
  * retrieved later.
  */
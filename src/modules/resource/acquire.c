@@ -15,9 +15,10 @@
  * Scheduler makes resource.acquire RPC.  Streaming responses are of the form:
  *
  * First response:
- *   {resources:resource_object up:idset}
+ *   {resources:resource_object up:idset epoch:number seq:integer}
  * Subsequent responses:
- *   {up?:idset down?:idset}
+ *   {up?:idset down?:idset seq:integer}
+ *   {expiration:number seq:integer}
  *
  * Where:
  * - resource_object maps execution target ids to resources
@@ -36,6 +37,22 @@
  * targets from the resource_object are marked "down".  On the next
  * scheduler reload, the resource set will omit those targets.
  *
+ * SEQUENCE NUMBERS
+ *
+ * Changes in availability and expiration are numbered, independent of
+ * any request, starting from zero when the resource module is loaded.
+ * Each response carries the sequence number of the most recent change.
+ * The "epoch" identifies the module instance that assigned the numbers.
+ *
+ * A reloaded scheduler may pick up where it left off by including
+ *   {resume:{epoch:number seq:integer}}
+ * in its request, using the epoch and last sequence number it received.
+ * If those changes are still remembered, the first response omits
+ * "resources" and contains only the net changes since then:
+ *   {up?:idset down?:idset expiration?:number epoch:number seq:integer}
+ * Otherwise the full first response is sent as usual, so the scheduler
+ * must check for the presence of "resources".
+ *
  * RESOURCE OBJECT
  *
  * The Rv1 format described in RFC 20 is used.
@@ -53,6 +70,7 @@
 #if HAVE_CONFIG_H
 #include "config.h"
 #endif
+#include <sys/time.h>
 #include <jansson.h>
 #include <flux/core.h>
 
@@ -83,8 +101,16 @@ struct acquire {
     struct resource_ctx *ctx;
     flux_msg_handler_t **handlers;
     struct flux_msglist *requests;      // N.B. there can be only one currently
+    double epoch;                       // identifies this sequence
+    int seq;                            // number of the last change
+    struct idset *valid;                // all targets (NULL until R is known)
+    struct idset *up;                   // available targets
+    json_t *history;                    // recent changes, oldest first
 };
 
+/* How many changes are remembered for resuming schedulers.
+ */
+static const int history_max = 1024;
 
 static void acquire_request_destroy (struct acquire_request *ar)
 {
@@ -98,6 +124,137 @@ static void acquire_request_destroy (struct acquire_request *ar)
     }
 }
 
+/* Return the subset of 'valid' that is currently available.
+ */
+static struct idset *available_targets (struct resource_ctx *ctx,
+                                        const struct idset *valid)
+{
+    struct idset *up;
+    struct idset *drain = NULL;
+
+    if (!(up = idset_copy (valid)))
+        return NULL;
+    if (!(drain = drain_get (ctx->drain))
+        || idset_subtract (up, drain) < 0
+        || idset_subtract (up, monitor_get_down (ctx->monitor)) < 0
+        || idset_subtract (up, exclude_get (ctx->exclude)) < 0)
+        goto error;
+    idset_destroy (drain);
+    return up;
+error:
+    ERRNO_SAFE_WRAP (idset_destroy, drain);
+    ERRNO_SAFE_WRAP (idset_destroy, up);
+    return NULL;
+}
+
+/* Forget all changes, e.g. after an error, so that no scheduler
+ * resumes from an incomplete history.
+ */
+static void history_reset (struct acquire *acquire)
+{
+    json_array_clear (acquire->history);
+    acquire->seq++;
+}
+
+/* Number 'entry' with the next sequence number and remember it.
+ * Takes a reference on 'entry'.
+ */
+static int history_append (struct acquire *acquire, json_t *entry)
+{
+    if (!entry
+        || json_object_set_new (entry,
+                                "seq",
+                                json_integer (acquire->seq + 1)) < 0
+        || json_array_append_new (acquire->history, entry) < 0) {
+        json_decref (entry);
+        errno = ENOMEM;
+        return -1;
+    }
+    acquire->seq++;
+    if (json_array_size (acquire->history) > history_max)
+        json_array_remove (acquire->history, 0);
+    return 0;
+}
+
+/* Start tracking availability once R and the subsystems it depends on
+ * are ready.  This is a no-op if tracking has already started.
+ */
+static int history_init (struct acquire *acquire)
+{
+    struct resource_ctx *ctx = acquire->ctx;
+    json_t *resobj;
+    json_error_t e;
+    struct rlist *rl;
+
+    if (acquire->valid
+        || !ctx->drain
+        || !ctx->monitor
+        || !(resobj = inventory_get (ctx->inventory)))
+        return 0;
+    if (!(rl = rlist_from_json (resobj, &e))) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!(acquire->valid = rlist_ranks (rl))
+        || !(acquire->up = available_targets (ctx, acquire->valid))) {
+        ERRNO_SAFE_WRAP (rlist_destroy, rl);
+        ERRNO_SAFE_WRAP (idset_destroy, acquire->valid);
+        acquire->valid = NULL;
+        return -1;
+    }
+    rlist_destroy (rl);
+    return 0;
+}
+
+/* Record any change in availability since the last call.
+ */
+static int history_update (struct acquire *acquire)
+{
+    struct idset *new_up;
+    struct idset *up = NULL;
+    struct idset *dn = NULL;
+    json_t *entry = NULL;
+    int rc = -1;
+
+    if (!acquire->valid)
+        return 0;
+    if (!(new_up = available_targets (acquire->ctx, acquire->valid))
+        || rutil_idset_diff (acquire->up, new_up, &up, &dn) < 0)
+        goto out;
+    if (up || dn) {
+        if (!(entry = json_object ())
+            || (up && rutil_set_json_idset (entry, "up", up) < 0)
+            || (dn && rutil_set_json_idset (entry, "down", dn) < 0)) {
+            json_decref (entry);
+            errno = ENOMEM;
+            goto out;
+        }
+        if (history_append (acquire, entry) < 0)
+            goto out;
+    }
+    idset_destroy (acquire->up);
+    acquire->up = new_up;
+    new_up = NULL;
+    rc = 0;
+out:
+    ERRNO_SAFE_WRAP (idset_destroy, new_up);
+    ERRNO_SAFE_WRAP (idset_destroy, up);
+    ERRNO_SAFE_WRAP (idset_destroy, dn);
+    return rc;
+}
+
+/* Return true if changes following 'seq' of 'epoch' are all remembered.
+ */
+static bool history_covers (struct acquire *acquire, double epoch, int seq)
+{
+    int oldest = acquire->seq - json_array_size (acquire->history);
+
+    return (acquire->valid != NULL
+            && epoch == acquire->epoch
+            && seq >= oldest
+            && seq <= acquire->seq);
+}
+
 /* Initialize request context once resource object is available.
  * This may be called from acquire_cb() or reslog_cb().
  */
@@ -158,36 +315,25 @@ static int acquire_request_update (struct acquire_request *ar,
                                    struct idset **up,
                                    struct idset **dn)
 {
-    struct resource_ctx *ctx = acquire->ctx;
     struct idset *new_up;
-    struct idset *drain = NULL;
 
-    if (!(new_up = idset_copy (ar->valid)))
+    if (!(new_up = available_targets (acquire->ctx, ar->valid)))
         return -1;
-    if (!(drain = drain_get (ctx->drain)))
-        goto error;
-    if (idset_subtract (new_up, drain) < 0)
-        goto error;
-    if (idset_subtract (new_up, monitor_get_down (ctx->monitor)) < 0)
-        goto error;
-    if (idset_subtract (new_up, exclude_get (ctx->exclude)) < 0)
-        goto error;
-    if (rutil_idset_diff (ar->up, new_up, up, dn) < 0)
-        goto error;
+    if (rutil_idset_diff (ar->up, new_up, up, dn) < 0) {
+        ERRNO_SAFE_WRAP (idset_destroy, new_up);
+        return -1;
+    }
     idset_destroy (ar->up);
     ar->up = new_up;
-    idset_destroy (drain);
     return 0;
-error:
-    idset_destroy (new_up);
-    idset_destroy (drain);
-    return -1;
 }
 
 /* Send the first response to resource.acquire request.  This presumes
  * that acquire_request_init() has already prepared ar->resources and ar->up.
  */
-static int acquire_respond_first (flux_t *h, const flux_msg_t *msg)
+static int acquire_respond_first (flux_t *h,
+                                  const flux_msg_t *msg,
+                                  struct acquire *acquire)
 {
     struct acquire_request *ar = flux_msg_aux_get (msg, "acquire");
     json_t *o = NULL;
@@ -198,7 +344,12 @@ static int acquire_respond_first (flux_t *h, const flux_msg_t *msg)
         goto nomem;
     if (rutil_set_json_idset (o, "up", ar->up) < 0)
         goto error;
-    if (flux_respond_pack (h, msg, "O", o) < 0)
+    if (flux_respond_pack (h,
+                           msg,
+                           "O{s:f s:i}",
+                           o,
+                           "epoch", acquire->epoch,
+                           "seq", acquire->seq) < 0)
         goto error;
     json_decref (o);
     ar->response_count++;
@@ -210,11 +361,90 @@ error:
     return -1;
 }
 
+/* Send the first response to a resource.acquire request that resumes
+ * from 'seq', summarizing the changes recorded since then.  This presumes
+ * that history_covers() returned true.
+ */
+static int acquire_respond_resume (flux_t *h,
+                                   const flux_msg_t *msg,
+                                   struct acquire *acquire,
+                                   int seq)
+{
+    struct acquire_request *ar = flux_msg_aux_get (msg, "acquire");
+    struct idset *up;
+    struct idset *dn = NULL;
+    double expiration = -1.;
+    size_t index;
+    json_t *entry;
+    json_t *o = NULL;
+    int rc = -1;
+
+    if (!(up = idset_create (0, IDSET_FLAG_AUTOGROW))
+        || !(dn = idset_create (0, IDSET_FLAG_AUTOGROW)))
+        goto out;
+    json_array_foreach (acquire->history, index, entry) {
+        int entry_seq;
+        const char *s_up = NULL;
+        const char *s_dn = NULL;
+        struct idset *ids;
+
+        if (json_unpack (entry,
+                         "{s:i s?s s?s s?F}",
+                         "seq", &entry_seq,
+                         "up", &s_up,
+                         "down", &s_dn,
+                         "expiration", &expiration) < 0) {
+            errno = EPROTO;
+            goto out;
+        }
+        if (entry_seq <= seq)
+            continue;
+        if (s_up) {
+            if (!(ids = idset_decode (s_up)))
+                goto out;
+            (void)idset_add (up, ids);
+            (void)idset_subtract (dn, ids);
+            idset_destroy (ids);
+        }
+        if (s_dn) {
+            if (!(ids = idset_decode (s_dn)))
+                goto out;
+            (void)idset_add (dn, ids);
+            (void)idset_subtract (up, ids);
+            idset_destroy (ids);
+        }
+    }
+    if (!(o = json_pack ("{s:f s:i}",
+                         "epoch", acquire->epoch,
+                         "seq", acquire->seq))) {
+        errno = ENOMEM;
+        goto out;
+    }
+    if ((idset_count (up) > 0 && rutil_set_json_idset (o, "up", up) < 0)
+        || (idset_count (dn) > 0 && rutil_set_json_idset (o, "down", dn) < 0))
+        goto out;
+    if (expiration >= 0.
+        && json_object_set_new (o, "expiration", json_real (expiration)) < 0) {
+        errno = ENOMEM;
+        goto out;
+    }
+    if (flux_respond_pack (h, msg, "O", o) < 0)
+        goto out;
+    ar->response_count++;
+    rc = 0;
+out:
+    ERRNO_SAFE_WRAP (json_decref, o);
+    ERRNO_SAFE_WRAP (idset_destroy, up);
+    ERRNO_SAFE_WRAP (idset_destroy, dn);
+    return rc;
+}
+
 /* Send a subsequent response to resource.acquire request, driven by
  * reslog_cb().
  */
 static int acquire_respond_next (flux_t *h,
                                  const flux_msg_t *msg,
+                                 struct acquire *acquire,
                                  struct idset *up,
                                  struct idset *down)
 {
@@ -227,7 +457,7 @@ static int acquire_respond_next (flux_t *h,
         goto error;
     if (down && rutil_set_json_idset (o, "down", down) < 0)
         goto error;
-    if (flux_respond_pack (h, msg, "O", o) < 0)
+    if (flux_respond_pack (h, msg, "O{s:i}", o, "seq", acquire->seq) < 0)
         goto error;
     json_decref (o);
     ar->response_count++;
@@ -242,6 +472,7 @@ error:
 /* Handle a resource.acquire request.
  * Currently there is only one request slot.
  * The response is deferred until resources are available.
+ * A request may ask to resume from a sequence number (see PROTOCOL).
  */
 static void acquire_cb (flux_t *h,
                         flux_msg_handler_t *mh,
@@ -250,11 +481,21 @@ static void acquire_cb (flux_t *h,
 {
     struct acquire *acquire = arg;
     struct acquire_request *ar;
+    const char *payload;
+    double epoch = 0.;
+    int seq = -1;
     json_t *resobj;
+    int rc;
 
     if (!(ar = calloc (1, sizeof (*ar))))
         goto error;
-    if (flux_request_decode (msg, NULL, NULL) < 0
+    if (flux_request_decode (msg, NULL, &payload) < 0
+        || (payload && flux_request_unpack (msg,
+                                            NULL,
+                                            "{s?{s:F s:i}}",
+                                            "resume",
+                                              "epoch", &epoch,
+                                              "seq", &seq) < 0)
         || flux_msg_aux_set (msg,
                              "acquire",
                              ar,
@@ -273,7 +514,13 @@ static void acquire_cb (flux_t *h,
 
     if (acquire_request_init (ar, acquire, resobj) < 0)
         goto error;
-    if (acquire_respond_first (h, msg) < 0)
+    if (history_init (acquire) < 0)
+        flux_log_error (h, "error initializing resource.acquire history");
+    if (seq >= 0 && history_covers (acquire, epoch, seq))
+        rc = acquire_respond_resume (h, msg, acquire, seq);
+    else
+        rc = acquire_respond_first (h, msg, acquire);
+    if (rc < 0)
         flux_log_error (h, "error responding to acquire request");
     return;
 error:
@@ -329,6 +576,36 @@ static void reslog_cb (struct reslog *reslog,
     json_t *resobj;
     const flux_msg_t *msg;
 
+    /* Number changes before responding, so responses carry the
+     * sequence number of the change that triggered them.
+     */
+    if (streq (name, "resource-define")) {
+        if (history_init (acquire) < 0)
+            flux_log_error (h, "error initializing resource.acquire history");
+    }
+    else if (streq (name, "resource-update")) {
+        double expiration = -1.;
+
+        if (json_unpack (context, "{s?F}", "expiration", &expiration) == 0
+            && expiration >= 0.
+            && acquire->valid
+            && history_append (acquire,
+                               json_pack ("{s:f}",
+                                          "expiration", expiration)) < 0) {
+            flux_log_error (h, "error recording resource.acquire change");
+            history_reset (acquire);
+        }
+    }
+    else if (streq (name, "online")
+             || streq (name, "offline")
+             || streq (name, "drain")
+             || streq (name, "undrain")) {
+        if (history_update (acquire) < 0) {
+            flux_log_error (h, "error recording resource.acquire change");
+            history_reset (acquire);
+        }
+    }
+
     msg = flux_msglist_first (acquire->requests);
     while (msg) {
         struct acquire_request *ar = flux_msg_aux_get (msg, "acquire");
@@ -345,7 +622,7 @@ static void reslog_cb (struct reslog *reslog,
                     goto error;
 
                 }
-                if (acquire_respond_first (h, msg) < 0) {
+                if (acquire_respond_first (h, msg, acquire) < 0) {
                     flux_log_error (h,
                                     "error responding to resource.acquire (%s)",
                                     name);
@@ -367,8 +644,9 @@ static void reslog_cb (struct reslog *reslog,
             if (expiration >= 0.
                 && flux_respond_pack (h,
                                       msg,
-                                      "{s:f}",
-                                      "expiration", expiration) < 0) {
+                                      "{s:f s:i}",
+                                      "expiration", expiration,
+                                      "seq", acquire->seq) < 0) {
                     flux_log_error (h,
                                     "error responding to resource.acquire (%s)",
                                     name);
@@ -392,6 +670,7 @@ static void reslog_cb (struct reslog *reslog,
                 if (up || dn) {
                     if (acquire_respond_next (h,
                                               msg,
+                                              acquire,
                                               up,
                                               dn) < 0) {
                         flux_log_error (h,
@@ -448,6 +727,9 @@ void acquire_destroy (struct acquire *acquire)
             }
             flux_msglist_destroy (acquire->requests);
         }
+        idset_destroy (acquire->valid);
+        idset_destroy (acquire->up);
+        json_decref (acquire->history);
         free (acquire);
         errno = saved_errno;
     }
@@ -456,11 +738,15 @@ void acquire_destroy (struct acquire *acquire)
 struct acquire *acquire_create (struct resource_ctx *ctx)
 {
     struct acquire *acquire;
+    struct timeval tv;
 
     if (!(acquire = calloc (1, sizeof (*acquire))))
         return NULL;
     acquire->ctx = ctx;
-    if (!(acquire->requests = flux_msglist_create ()))
+    gettimeofday (&tv, NULL);
+    acquire->epoch = tv.tv_sec + tv.tv_usec / 1e6;
+    if (!(acquire->requests = flux_msglist_create ())
+        || !(acquire->history = json_array ()))
         goto error;
     if (flux_msg_handler_addvec (ctx->h,
                                  htab,
@@ -299,6 +299,67 @@ error:
     return o;
 }
 
+json_t *drain_snapshot (struct drain *drain)
+{
+    struct drainset *ds;
+    json_t *o = NULL;
+    json_t *a = NULL;
+    const char *key;
+    json_t *val;
+
+    if (!(ds = drainset_create ()))
+        return NULL;
+    for (unsigned int rank = 0; rank < drain->ctx->size; rank++) {
+        if (drain->info[rank].drained) {
+            if (drainset_drain_rank (ds,
+                                     rank,
+                                     drain->info[rank].timestamp,
+                                     drain->info[rank].reason) < 0)
+                goto error;
+        }
+    }
+    if (!(o = drainset_to_json (ds))
+        || !(a = json_array ()))
+        goto error;
+    json_object_foreach (o, key, val) {
+        double timestamp;
+        const char *reason;
+        char *nodelist;
+        json_t *entry;
+
+        if (json_unpack (val,
+                         "{s:F s:s}",
+                         "timestamp", &timestamp,
+                         "reason", &reason) < 0
+            || !(nodelist = flux_hostmap_lookup (drain->ctx->h, key, NULL)))
+            goto error;
+        if (strlen (reason) > 0)
+            entry = json_pack ("{s:s s:s s:f s:s}",
+                               "idset", key,
+                               "nodelist", nodelist,
+                               "timestamp", timestamp,
+                               "reason", reason);
+        else
+            entry = json_pack ("{s:s s:s s:f}",
+                               "idset", key,
+                               "nodelist", nodelist,
+                               "timestamp", timestamp);
+        free (nodelist);
+        if (!entry || json_array_append_new (a, entry) < 0) {
+            json_decref (entry);
+            goto error;
+        }
+    }
+    json_decref (o);
+    drainset_destroy (ds);
+    return a;
+error:
+    ERRNO_SAFE_WRAP (json_decref, a);
+    ERRNO_SAFE_WRAP (json_decref, o);
+    drainset_destroy (ds);
+    return NULL;
+}
+
 struct idset *drain_get (struct drain *drain)
 {
     unsigned int rank;
@@ -623,7 +684,63 @@ done:
     return newids;
 }
 
-/* Recover drained idset from eventlog.
+/* Restore drain state from the context of a snapshot event.
+ */
+static int replay_snapshot (struct drain *drain,
+                            json_t *context,
+                            size_t index,
+                            flux_error_t *error)
+{
+    json_t *a;
+    size_t i;
+    json_t *entry;
+
+    if (json_unpack (context, "{s:o}", "drain", &a) < 0
+        || !json_is_array (a)) {
+        errprintf (error, "line %zu: snapshot parse error", index + 1);
+        errno = EPROTO;
+        return -1;
+    }
+    json_array_foreach (a, i, entry) {
+        const char *s;
+        const char *nodelist;
+        const char *reason = NULL;
+        double timestamp;
+        struct idset *idset;
+
+        if (json_unpack (entry,
+                         "{s:s s:s s:F s?s}",
+                         "idset", &s,
+                         "nodelist", &nodelist,
+                         "timestamp", &timestamp,
+                         "reason", &reason) < 0) {
+            errprintf (error, "line %zu: snapshot parse error", index + 1);
+            errno = EPROTO;
+            return -1;
+        }
+        if (!(idset = decode_targets (drain, s, nodelist))) {
+            errprintf (error,
+                       "line %zu: snapshot target decode error",
+                       index + 1);
+            return -1;
+        }
+        if (update_draininfo_idset (drain,
+                                    idset,
+                                    true,
+                                    timestamp,
+                                    reason,
+                                    1) < 0) {
+            errprintf (error, "line %zu: snapshot update error", index + 1);
+            idset_destroy (idset);
+            return -1;
+        }
+        idset_destroy (idset);
+    }
+    return 0;
+}
+
+/* Recover drained idset from eventlog, starting from the last snapshot
+ * if there is one, since it summarizes all prior events.
  */
 static int replay_eventlog (struct drain *drain,
                             const json_t *eventlog,
@@ -633,7 +750,9 @@ static int replay_eventlog (struct drain *drain,
     json_t *entry;
 
     if (eventlog) {
-        json_array_foreach (eventlog, index, entry) {
+        for (index = reslog_snapshot_index (eventlog);
+             index < json_array_size (eventlog);
+             index++) {
             double timestamp;
             const char *name;
             json_t *context;
@@ -641,6 +760,7 @@ static int replay_eventlog (struct drain *drain,
             const char *reason = NULL;
             struct idset *idset;
 
+            entry = json_array_get (eventlog, index);
             if (eventlog_entry_parse (entry, &timestamp, &name, &context) < 0) {
                 errprintf (error, "line %zu: event parse error", index + 1);
                 return -1;
@@ -710,6 +830,10 @@ static int replay_eventlog (struct drain *drain,
                 }
                 idset_destroy (idset);
             }
+            else if (streq (name, RESLOG_SNAPSHOT)) {
+                if (replay_snapshot (drain, context, index, error) < 0)
+                    return -1;
+            }
         }
     }
     return 0;
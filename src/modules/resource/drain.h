@@ -22,6 +22,12 @@ struct idset *drain_get (struct drain *drain);
  */
 json_t *drain_get_info  (struct drain *drain);
 
+/* Return the drain state as an array of
+ *   {"idset":s "nodelist":s "timestamp":f "reason"?:s}
+ * for inclusion in a resource.eventlog snapshot event.
+ */
+json_t *drain_snapshot (struct drain *drain);
+
 /* Drain 'rank' for 'reason'.  Call this on rank 0 only, otherwise use
  * resource.drain RPC.
  */
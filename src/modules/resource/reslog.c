@@ -16,6 +16,7 @@
 #include "src/common/libczmqcontainers/czmq_containers.h"
 #include "src/common/libutil/errno_safe.h"
 #include "src/common/libeventlog/eventlog.h"
+#include "ccan/str/str.h"
 
 #include "reslog.h"
 
@@ -29,6 +30,12 @@ struct reslog {
     zlist_t *pending;       // list of pending futures
     reslog_cb_f cb;
     void *cb_arg;
+    unsigned int generation; // count of events posted
+
+    reslog_snapshot_f snapshot_cb;
+    void *snapshot_arg;
+    int snapshot_interval;  // 0 = no snapshots
+    int snapshot_count;     // events committed since last snapshot
 };
 
 static const char *auxkey = "flux::event_info";
@@ -112,6 +119,11 @@ static void post_continuation (flux_future_t *f, void *arg)
     (void)post_handler (reslog, f);
 }
 
+unsigned int reslog_generation (struct reslog *reslog)
+{
+    return reslog ? reslog->generation : 0;
+}
+
 int reslog_sync (struct reslog *reslog)
 {
     flux_future_t *f;
@@ -122,6 +134,42 @@ int reslog_sync (struct reslog *reslog)
     return 0;
 }
 
+static bool is_snapshot (const json_t *entry)
+{
+    const char *name;
+
+    return eventlog_entry_parse ((json_t *)entry, NULL, &name, NULL) == 0
+           && streq (name, RESLOG_SNAPSHOT);
+}
+
+static void post_snapshot (struct reslog *reslog)
+{
+    json_t *context;
+
+    reslog->snapshot_count = 0;
+    if (!(context = reslog->snapshot_cb (reslog->snapshot_arg))
+        || reslog_post_pack (reslog,
+                             NULL,
+                             0.,
+                             RESLOG_SNAPSHOT,
+                             0,
+                             "O",
+                             context) < 0)
+        flux_log_error (reslog->h, "error posting %s snapshot", RESLOG_KEY);
+    json_decref (context);
+}
+
+/* Account for an event committed to the eventlog, and post a snapshot
+ * if the snapshot interval has been reached.
+ */
+static void snapshot_check (struct reslog *reslog, const char *name)
+{
+    if (reslog->snapshot_interval == 0 || streq (name, RESLOG_SNAPSHOT))
+        return;
+    if (++reslog->snapshot_count >= reslog->snapshot_interval)
+        post_snapshot (reslog);
+}
+
 int reslog_post_pack (struct reslog *reslog,
                       const flux_msg_t *request,
                       double timestamp,
@@ -143,6 +191,7 @@ int reslog_post_pack (struct reslog *reslog,
 
     if (!event)
         return -1;
+    reslog->generation++;
     if ((flags & EVENT_NO_COMMIT)) {
         if (!(f = flux_future_create (NULL, NULL)))
             goto error;
@@ -176,6 +225,8 @@ int reslog_post_pack (struct reslog *reslog,
     free (val);
     flux_kvs_txn_destroy (txn);
     json_decref (event);
+    if (!(flags & EVENT_NO_COMMIT))
+        snapshot_check (reslog, name);
     return 0;
 nomem:
     errno = ENOMEM;
@@ -193,6 +244,93 @@ void reslog_set_callback (struct reslog *reslog, reslog_cb_f cb, void *arg)
     reslog->cb_arg = arg;
 }
 
+size_t reslog_snapshot_index (const json_t *eventlog)
+{
+    size_t index;
+    json_t *entry;
+    size_t last = 0;
+
+    json_array_foreach (eventlog, index, entry) {
+        if (is_snapshot (entry))
+            last = index;
+    }
+    return last;
+}
+
+int reslog_set_snapshot (struct reslog *reslog,
+                         int interval,
+                         const json_t *eventlog,
+                         reslog_snapshot_f cb,
+                         void *arg)
+{
+    size_t start;
+
+    if (interval < 0 || (interval > 0 && !cb)) {
+        errno = EINVAL;
+        return -1;
+    }
+    reslog->snapshot_interval = interval;
+    reslog->snapshot_cb = cb;
+    reslog->snapshot_arg = arg;
+    reslog->snapshot_count = 0;
+    if (interval > 0 && eventlog) {
+        start = reslog_snapshot_index (eventlog);
+        reslog->snapshot_count = json_array_size (eventlog) - start;
+        if (is_snapshot (json_array_get (eventlog, start)))
+            reslog->snapshot_count--;
+        if (reslog->snapshot_count >= interval)
+            post_snapshot (reslog);
+    }
+    return 0;
+}
+
+int reslog_compact (flux_t *h, json_t *eventlog)
+{
+    size_t start = reslog_snapshot_index (eventlog);
+    json_t *tail;
+    char *s = NULL;
+    flux_kvs_txn_t *txn = NULL;
+    flux_future_t *f = NULL;
+    int rc = -1;
+
+    if (start == 0)
+        return 0;
+    if (!(tail = json_array ()))
+        goto nomem;
+    for (size_t i = start; i < json_array_size (eventlog); i++) {
+        if (json_array_append (tail, json_array_get (eventlog, i)) < 0) {
+            json_decref (tail);
+            goto nomem;
+        }
+    }
+    if (json_array_clear (eventlog) < 0
+        || json_array_extend (eventlog, tail) < 0) {
+        json_decref (tail);
+        goto nomem;
+    }
+    json_decref (tail);
+    if (!(s = eventlog_encode (eventlog))
+        || !(txn = flux_kvs_txn_create ())
+        || flux_kvs_txn_put (txn, 0, RESLOG_KEY, s) < 0
+        || !(f = flux_kvs_commit (h, NULL, 0, txn))
+        || flux_rpc_get (f, NULL) < 0)
+        goto done;
+    flux_log (h,
+              LOG_INFO,
+              "%s: removed %zu entries preceding snapshot",
+              RESLOG_KEY,
+              start);
+    rc = 0;
+done:
+    flux_future_destroy (f);
+    flux_kvs_txn_destroy (txn);
+    ERRNO_SAFE_WRAP (free, s);
+    return rc;
+nomem:
+    errno = ENOMEM;
+    return -1;
+}
+
 void reslog_destroy (struct reslog *reslog)
 {
     if (reslog) {
@@ -22,6 +22,11 @@ typedef void (*reslog_cb_f)(struct reslog *reslog,
                             json_t *context,
                             void *arg);
 
+/* Return the context of a snapshot event, which summarizes the state
+ * established by all prior events.
+ */
+typedef json_t *(*reslog_snapshot_f)(void *arg);
+
 struct reslog *reslog_create (flux_t *h);
 void reslog_destroy (struct reslog *reslog);
 
@@ -38,6 +43,12 @@ int reslog_post_pack (struct reslog *reslog,
                       const char *fmt,
                       ...);
 
+/* Return a counter that is incremented each time an event is posted.
+ * Since every change to resource state is accompanied by an event,
+ * this may be used to tell when cached views of that state are stale.
+ */
+unsigned int reslog_generation (struct reslog *reslog);
+
 /* Force all pending commits to the eventlog to complete.
  */
 int reslog_sync (struct reslog *reslog);
@@ -46,7 +57,29 @@ int reslog_sync (struct reslog *reslog);
  */
 void reslog_set_callback (struct reslog *reslog, reslog_cb_f cb, void *arg);
 
+/* Post a snapshot event, with context obtained from 'cb', after every
+ * 'interval' committed events.  'eventlog' is the eventlog as loaded, used
+ * to count the events posted since its last snapshot.  If there are already
+ * 'interval' such events, a snapshot is posted immediately.
+ */
+int reslog_set_snapshot (struct reslog *reslog,
+                         int interval,
+                         const json_t *eventlog,
+                         reslog_snapshot_f cb,
+                         void *arg);
+
+/* Return the index of the last snapshot event in 'eventlog', or 0 if
+ * there is none.
+ */
+size_t reslog_snapshot_index (const json_t *eventlog);
+
+/* Remove the entries preceding the last snapshot event from 'eventlog',
+ * and rewrite the eventlog in the KVS to match.
+ */
+int reslog_compact (flux_t *h, json_t *eventlog);
+
 #define RESLOG_KEY "resource.eventlog"
+#define RESLOG_SNAPSHOT "snapshot"
 
 #endif /* !_FLUX_RESOURCE_RESLOG_H */
 
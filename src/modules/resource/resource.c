@@ -65,6 +65,7 @@ static int parse_config (struct resource_ctx *ctx,
                          bool *noverifyp,
                          bool *norestrictp,
                          bool *no_update_watchp,
+                         int *snapshotp,
                          flux_error_t *errp)
 {
     flux_error_t error;
@@ -73,24 +74,32 @@ static int parse_config (struct resource_ctx *ctx,
     int noverify = 0;
     int norestrict = 0;
     int no_update_watch = 0;
+    int snapshot = 0;
     json_t *o = NULL;
     json_t *config = NULL;
 
     if (flux_conf_unpack (conf,
                           &error,
-                          "{s?{s?s s?o s?s s?b s?b s?b !}}",
+                          "{s?{s?s s?o s?s s?b s?b s?b s?i !}}",
                           "resource",
                             "path", &path,
                             "config", &config,
                             "exclude", &exclude,
                             "norestrict", &norestrict,
                             "noverify", &noverify,
-                            "no-update-watch", &no_update_watch) < 0) {
+                            "no-update-watch", &no_update_watch,
+                            "eventlog-snapshot", &snapshot) < 0) {
         errprintf (errp,
                    "error parsing [resource] configuration: %s",
                    error.text);
         return -1;
     }
+    if (snapshot < 0) {
+        errprintf (errp,
+                   "error parsing [resource] configuration:"
+                   " eventlog-snapshot must be >= 0");
+        return -1;
+    }
     if (config) {
         struct rlist *rl = rlist_from_config (config, &error);
         if (!rl) {
@@ -133,6 +142,8 @@ static int parse_config (struct resource_ctx *ctx,
         *norestrictp = norestrict ? true : false;
     if (no_update_watchp)
         *no_update_watchp = no_update_watch ? true : false;
+    if (snapshotp)
+        *snapshotp = snapshot;
     if (R)
         *R = o;
     else
@@ -156,7 +167,15 @@ static void config_reload_cb (flux_t *h,
 
     if (flux_conf_reload_decode (msg, &conf) < 0)
         goto error;
-    if (parse_config (ctx, conf, NULL, NULL, NULL, NULL, NULL, &error) < 0) {
+    if (parse_config (ctx,
+                      conf,
+                      NULL,
+                      NULL,
+                      NULL,
+                      NULL,
+                      NULL,
+                      NULL,
+                      &error) < 0) {
         errstr = error.text;
         goto error;
     }
@@ -254,6 +273,35 @@ static const struct flux_msg_handler_spec htab[] = {
     FLUX_MSGHANDLER_TABLE_END,
 };
 
+/* reslog_snapshot_f signature
+ * Summarize drain, exclude, and online state.  Only the drain state is
+ * replayed on restart, the rest is informational.
+ */
+static json_t *snapshot_cb (void *arg)
+{
+    struct resource_ctx *ctx = arg;
+    json_t *drain;
+    char *exclude = NULL;
+    char *online = NULL;
+    json_t *o = NULL;
+
+    if (!(drain = drain_snapshot (ctx->drain))
+        || !(exclude = idset_encode (exclude_get (ctx->exclude),
+                                     IDSET_FLAG_RANGE))
+        || !(online = idset_encode (monitor_get_up (ctx->monitor),
+                                    IDSET_FLAG_RANGE)))
+        goto done;
+    o = json_pack ("{s:O s:s s:s}",
+                   "drain", drain,
+                   "exclude", exclude,
+                   "online", online);
+done:
+    ERRNO_SAFE_WRAP (free, online);
+    ERRNO_SAFE_WRAP (free, exclude);
+    ERRNO_SAFE_WRAP (json_decref, drain);
+    return o;
+}
+
 /* Synchronously read resource.eventlog, and parse into
  * a JSON array for replay by the various subsystems.
  * 'eventlog' is set to NULL if it doesn't exist (no error).
@@ -323,6 +371,7 @@ int mod_main (flux_t *h, int argc, char **argv)
     bool noverify = false;
     bool norestrict = false;
     bool no_update_watch = false;
+    int snapshot = 0;
     json_t *R_from_config;
 
     if (!(ctx = resource_ctx_create (h)))
@@ -338,6 +387,7 @@ int mod_main (flux_t *h, int argc, char **argv)
                       &noverify,
                       &norestrict,
                       &no_update_watch,
+                      &snapshot,
                       &error) < 0) {
         flux_log (h, LOG_ERR, "%s", error.text);
         goto error;
@@ -378,6 +428,12 @@ int mod_main (flux_t *h, int argc, char **argv)
          */
         if (upgrade_eventlog (h, &eventlog) < 0)
             goto error;
+        /* Drop events preceding the last snapshot, which summarizes them.
+         */
+        if (snapshot > 0 && eventlog && reslog_compact (h, eventlog) < 0) {
+            flux_log_error (h, "error compacting %s", RESLOG_KEY);
+            goto error;
+        }
         if (!(ctx->acquire = acquire_create (ctx)))
             goto error;
 
@@ -401,6 +457,14 @@ int mod_main (flux_t *h, int argc, char **argv)
         goto error;
     if (!(ctx->status = status_create (ctx)))
         goto error;
+    if (ctx->rank == 0) {
+        if (reslog_set_snapshot (ctx->reslog,
+                                 snapshot,
+                                 eventlog,
+                                 snapshot_cb,
+                                 ctx) < 0)
+            goto error;
+    }
     if (flux_msg_handler_addvec (h, htab, ctx, &ctx->handlers) < 0)
         goto error;
     if (flux_reactor_run (flux_get_reactor (h), 0) < 0) {
@@ -21,6 +21,7 @@
 #include "rutil.h"
 #include "monitor.h"
 #include "exclude.h"
+#include "reslog.h"
 #include "status.h"
 
 #include "src/common/libutil/errprintf.h"
@@ -31,8 +32,36 @@ struct status {
     struct resource_ctx *ctx;
     flux_msg_handler_t **handlers;
     struct flux_msglist *requests;
+
+    /* Views of resource state that are reused across queries until the
+     * next event is posted to resource.eventlog.
+     */
+    unsigned int generation;    // reslog generation of cached views
+    json_t *payload;            // resource.status response
+    struct rlist *rl;           // R with exclude, down, drain applied
+    json_t *all;                // sched-status "all"
+    json_t *down;               // sched-status "down"
 };
 
+/* Drop cached views if resource state has changed since they were made.
+ */
+static void status_cache_check (struct status *status)
+{
+    unsigned int generation = reslog_generation (status->ctx->reslog);
+
+    if (status->generation != generation) {
+        json_decref (status->payload);
+        status->payload = NULL;
+        rlist_destroy (status->rl);
+        status->rl = NULL;
+        json_decref (status->all);
+        status->all = NULL;
+        json_decref (status->down);
+        status->down = NULL;
+        status->generation = generation;
+    }
+}
+
 static json_t *prepare_status_payload (struct status *status)
 {
     struct resource_ctx *ctx = status->ctx;
@@ -67,7 +96,6 @@ static void status_cb (flux_t *h,
                        void *arg)
 {
     struct status *status = arg;
-    json_t *o = NULL;
     flux_error_t error;
 
     if (flux_request_decode (msg, NULL, NULL) < 0) {
@@ -79,18 +107,18 @@ static void status_cb (flux_t *h,
         errno = EPROTO;
         goto error;
     }
-    if (!(o = prepare_status_payload (status))) {
+    status_cache_check (status);
+    if (!status->payload
+        && !(status->payload = prepare_status_payload (status))) {
         errprintf (&error, "error preparing response: %s", strerror (errno));
         goto error;
     }
-    if (flux_respond_pack (h, msg, "O", o) < 0)
+    if (flux_respond_pack (h, msg, "O", status->payload) < 0)
         flux_log_error (h, "error responding to resource.status request");
-    json_decref (o);
     return;
 error:
     if (flux_respond_error (h, msg, errno, error.text) < 0)
         flux_log_error (h, "error responding to resource.status request");
-    json_decref (o);
 }
 
 /* Mark the ranks in 'ids' DOWN in the resource set 'rl'.
@@ -301,45 +329,44 @@ static json_t *prepare_sched_status_payload (struct status *status,
                                              json_t *allocated)
 {
     struct resource_ctx *ctx = status->ctx;
-    const struct idset *exclude = exclude_get (ctx->exclude);
-    const struct idset *down = monitor_get_down (ctx->monitor);
-    struct idset *drain = drain_get (ctx->drain);
-    const json_t *R;
     json_t *o;
-    struct rlist *rl = NULL;
     json_t *result = NULL;
 
-    if (!(R = inventory_get (ctx->inventory))
-        || !(rl = create_rlist (R, exclude, down, drain))
-        || !(result = json_object ()))
-        goto error;
-
-    if (!(o = get_all (rl))
-        || json_object_set_new (result, "all", o) < 0) {
-        json_decref (o);
-        goto error;
+    status_cache_check (status);
+    if (!status->rl) {
+        const struct idset *exclude = exclude_get (ctx->exclude);
+        const struct idset *down = monitor_get_down (ctx->monitor);
+        struct idset *drain;
+        const json_t *R;
+
+        if (!(R = inventory_get (ctx->inventory))
+            || !(drain = drain_get (ctx->drain)))
+            return NULL;
+        status->rl = create_rlist (R, exclude, down, drain);
+        idset_destroy (drain);
+        if (!status->rl)
+            return NULL;
     }
-    if (!(o = get_down (rl))
-        || json_object_set_new (result, "down", o) < 0) {
-        json_decref (o);
-        goto error;
+    if ((!status->all && !(status->all = get_all (status->rl)))
+        || (!status->down && !(status->down = get_down (status->rl))))
+        return NULL;
+    if (!(result = json_pack ("{s:O s:O}",
+                              "all", status->all,
+                              "down", status->down))) {
+        errno = ENOMEM;
+        return NULL;
     }
     if (allocated)
-        o = update_properties_json (allocated, rl);
+        o = update_properties_json (allocated, status->rl);
     else
         o = get_empty_set ();
     if (!o || json_object_set_new (result, "allocated", o) < 0) {
         json_decref (o);
         goto error;
     }
-
-    idset_destroy (drain);
-    rlist_destroy (rl);
     return result;
 error:
     ERRNO_SAFE_WRAP (json_decref, result);
-    idset_destroy (drain);
-    rlist_destroy (rl);
     return NULL;
 }
 
@@ -472,6 +499,10 @@ void status_destroy (struct status *status)
         int saved_errno = errno;
         flux_msg_handler_delvec (status->handlers);
         flux_msglist_destroy (status->requests);
+        json_decref (status->payload);
+        rlist_destroy (status->rl);
+        json_decref (status->all);
+        json_decref (status->down);
         free (status);
         errno = saved_errno;
     }
@@ -15,6 +15,11 @@
  *
  * Reduce r_local from each rank, leaving the result in topo->reduce->rl
  * on rank 0.  If resources are not known, then this R is set in inventory.
+ *
+ * Keep a parsed copy of the topology so that job shells can obtain the
+ * cpusets for their allocated cores (resource.topo-cpuset) without
+ * loading the topology XML themselves.  Results are cached by request,
+ * since consecutive jobs on a node often have identical allocations.
  */
 
 #if HAVE_CONFIG_H
@@ -23,6 +28,7 @@
 #include <jansson.h>
 #include <flux/core.h>
 
+#include "src/common/libczmqcontainers/czmq_containers.h"
 #include "src/common/libidset/idset.h"
 #include "src/common/libutil/errno_safe.h"
 #include "src/common/librlist/rhwloc.h"
@@ -47,6 +53,8 @@ struct topo {
     flux_msg_handler_t **handlers;
     char *xml;
     struct rlist *r_local;
+    hwloc_topology_t topology;  // parsed on first topo-cpuset request
+    zhashx_t *cpusets;          // cached topo-cpuset responses
 
     struct reduction reduce;
 };
@@ -255,9 +263,233 @@ error:
         flux_log_error (h, "error responding to topo-get request");
 }
 
+#define CPUSET_CACHE_MAX 64
+
+static void cpuset_destructor (void **item)
+{
+    if (item) {
+        json_decref (*item);
+        *item = NULL;
+    }
+}
+
+/* Return the union of the cpusets of 'cores' in 'topology'.
+ */
+static hwloc_cpuset_t cores_to_cpuset (hwloc_topology_t topology,
+                                       const char *cores)
+{
+    hwloc_cpuset_t coreset;
+    hwloc_cpuset_t cpuset;
+    int depth;
+    int i;
+
+    if (!(coreset = hwloc_bitmap_alloc ()))
+        return NULL;
+    if (!(cpuset = hwloc_bitmap_alloc ()))
+        goto nomem;
+    if (hwloc_bitmap_list_sscanf (coreset, cores) < 0)
+        goto inval;
+    depth = hwloc_get_type_depth (topology, HWLOC_OBJ_CORE);
+    if (depth == HWLOC_TYPE_DEPTH_UNKNOWN
+        || depth == HWLOC_TYPE_DEPTH_MULTIPLE)
+        goto inval;
+    i = hwloc_bitmap_first (coreset);
+    while (i >= 0) {
+        hwloc_obj_t core = hwloc_get_obj_by_depth (topology, depth, i);
+        if (!core || !core->cpuset) {
+            errno = ENOENT;
+            goto error;
+        }
+        hwloc_bitmap_or (cpuset, cpuset, core->cpuset);
+        i = hwloc_bitmap_next (coreset, i);
+    }
+    hwloc_bitmap_free (coreset);
+    return cpuset;
+inval:
+    errno = EINVAL;
+    goto error;
+nomem:
+    errno = ENOMEM;
+error:
+    hwloc_bitmap_free (coreset);
+    if (cpuset)
+        hwloc_bitmap_free (cpuset);
+    return NULL;
+}
+
+static int cpuset_array_append (json_t *a, hwloc_const_cpuset_t set)
+{
+    char *s;
+    json_t *o;
+
+    if (hwloc_bitmap_list_asprintf (&s, set) < 0)
+        goto nomem;
+    o = json_string (s);
+    free (s);
+    if (!o || json_array_append_new (a, o) < 0) {
+        json_decref (o);
+        goto nomem;
+    }
+    return 0;
+nomem:
+    errno = ENOMEM;
+    return -1;
+}
+
+/* Distribute 'ntasks' over the cores of 'cpuset' as the job shell does
+ * for cpu-affinity=per-task, and return a JSON array of cpusets.
+ * The topology is restricted, so operate on a copy.
+ */
+static json_t *distribute_tasks (hwloc_topology_t topology,
+                                 hwloc_const_cpuset_t cpuset,
+                                 int ntasks)
+{
+    hwloc_topology_t topo = NULL;
+    hwloc_obj_t *roots = NULL;
+    hwloc_cpuset_t *sets = NULL;
+    json_t *a = NULL;
+    int depth;
+    int cores;
+
+    if (hwloc_topology_dup (&topo, topology) < 0
+        || hwloc_topology_restrict (topo, cpuset, 0) < 0)
+        goto error;
+    depth = hwloc_get_type_depth (topo, HWLOC_OBJ_CORE);
+    cores = hwloc_get_nbobjs_by_depth (topo, depth);
+    if (cores <= 0) {
+        errno = EINVAL;
+        goto error;
+    }
+    if (!(roots = calloc (cores, sizeof (*roots)))
+        || !(sets = calloc (ntasks, sizeof (*sets)))
+        || !(a = json_array ()))
+        goto nomem;
+    for (int i = 0; i < cores; i++)
+        roots[i] = hwloc_get_obj_by_depth (topo, depth, i);
+    hwloc_distrib (topo, roots, cores, sets, ntasks, depth, 0);
+    for (int i = 0; i < ntasks; i++) {
+        if (!sets[i])
+            goto nomem;
+        if (cpuset_array_append (a, sets[i]) < 0)
+            goto error;
+    }
+    goto out;
+nomem:
+    errno = ENOMEM;
+error:
+    ERRNO_SAFE_WRAP (json_decref, a);
+    a = NULL;
+out:
+    if (sets) {
+        for (int i = 0; i < ntasks; i++) {
+            if (sets[i])
+                hwloc_bitmap_free (sets[i]);
+        }
+        free (sets);
+    }
+    free (roots);
+    if (topo)
+        hwloc_topology_destroy (topo);
+    return a;
+}
+
+/* Return the topo-cpuset response for 'cores' and 'ntasks', which remains
+ * owned by the cache.
+ */
+static json_t *topo_cpuset_lookup (struct topo *topo,
+                                   const char *cores,
+                                   int ntasks)
+{
+    char *key = NULL;
+    json_t *o = NULL;
+    json_t *pertask = NULL;
+    hwloc_cpuset_t cpuset = NULL;
+    char *s = NULL;
+
+    if (asprintf (&key, "%d:%s", ntasks, cores) < 0)
+        goto nomem;
+    if ((o = zhashx_lookup (topo->cpusets, key)))
+        goto out;
+    if (!topo->topology
+        && !(topo->topology = rhwloc_xml_topology_load (topo->xml,
+                                                        RHWLOC_NO_RESTRICT)))
+        goto error;
+    if (!(cpuset = cores_to_cpuset (topo->topology, cores)))
+        goto error;
+    if (hwloc_bitmap_list_asprintf (&s, cpuset) < 0)
+        goto nomem;
+    if (ntasks > 0
+        && !(pertask = distribute_tasks (topo->topology, cpuset, ntasks)))
+        goto error;
+    if (!(o = json_pack ("{s:s}", "cpuset", s)))
+        goto nomem;
+    if (pertask) {
+        int rc = json_object_set_new (o, "pertask", pertask);
+        pertask = NULL;
+        if (rc < 0)
+            goto nomem;
+    }
+    if (zhashx_size (topo->cpusets) >= CPUSET_CACHE_MAX)
+        zhashx_purge (topo->cpusets);
+    if (zhashx_insert (topo->cpusets, key, o) < 0)
+        goto nomem;
+    goto out;
+nomem:
+    errno = ENOMEM;
+error:
+    ERRNO_SAFE_WRAP (json_decref, o);
+    o = NULL;
+out:
+    ERRNO_SAFE_WRAP (json_decref, pertask);
+    if (cpuset)
+        hwloc_bitmap_free (cpuset);
+    ERRNO_SAFE_WRAP (free, s);
+    ERRNO_SAFE_WRAP (free, key);
+    return o;
+}
+
+/* Return the cpuset for a core idset, and optionally the per-task
+ * cpusets for 'ntasks' tasks distributed over them.
+ */
+static void topo_cpuset_cb (flux_t *h,
+                            flux_msg_handler_t *mh,
+                            const flux_msg_t *msg,
+                            void *arg)
+{
+    struct topo *topo = arg;
+    const char *cores;
+    int ntasks = 0;
+    json_t *o;
+
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s:s s?i}",
+                             "cores", &cores,
+                             "ntasks", &ntasks) < 0)
+        goto error;
+    if (ntasks < 0) {
+        errno = EPROTO;
+        goto error;
+    }
+    if (!(o = topo_cpuset_lookup (topo, cores, ntasks)))
+        goto error;
+    if (flux_respond_pack (h, msg, "O", o) < 0)
+        flux_log_error (h, "error responding to topo-cpuset request");
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        flux_log_error (h, "error responding to topo-cpuset request");
+}
+
 static const struct flux_msg_handler_spec htab[] = {
     { FLUX_MSGTYPE_REQUEST, "resource.topo-reduce",  topo_reduce_cb, 0 },
     { FLUX_MSGTYPE_REQUEST, "resource.topo-get", topo_get_cb, FLUX_ROLE_USER },
+    {
+        FLUX_MSGTYPE_REQUEST,
+        "resource.topo-cpuset",
+        topo_cpuset_cb,
+        FLUX_ROLE_USER
+    },
     FLUX_MSGHANDLER_TABLE_END,
 };
 
@@ -268,6 +500,9 @@ void topo_destroy (struct topo *topo)
         int saved_errno = errno;
         flux_msg_handler_delvec (topo->handlers);
         free (topo->xml);
+        if (topo->topology)
+            hwloc_topology_destroy (topo->topology);
+        zhashx_destroy (&topo->cpusets);
         rlist_destroy (topo->reduce.rl);
         rlist_destroy (topo->r_local);
         free (topo);
@@ -329,6 +564,11 @@ struct topo *topo_create (struct resource_ctx *ctx,
     if (!(topo = calloc (1, sizeof (*topo))))
         return NULL;
     topo->ctx = ctx;
+    if (!(topo->cpusets = zhashx_new ())) {
+        errno = ENOMEM;
+        goto error;
+    }
+    zhashx_set_destructor (topo->cpusets, cpuset_destructor);
     if (!(topo->xml = topo_get_local_xml (ctx, no_restrict))) {
         flux_log (ctx->h, LOG_ERR, "error loading hwloc topology");
         goto error;
@@ -11,15 +11,18 @@
 #if HAVE_CONFIG_H
 #include "config.h"
 #endif
+#include <limits.h>
 #include <flux/core.h>
 #include <flux/schedutil.h>
 
 #include "src/common/libczmqcontainers/czmq_containers.h"
 #include "src/common/libutil/errno_safe.h"
 #include "src/common/libutil/errprintf.h"
+#include "src/common/libutil/monotime.h"
 #include "src/common/libjob/job.h"
 #include "src/common/libjob/jj.h"
 #include "src/common/libjob/idf58.h"
+#include "src/common/libjob/job_hash.h"
 #include "src/common/librlist/rlist.h"
 #include "ccan/str/str.h"
 
@@ -41,6 +44,55 @@ struct jobreq {
     struct jj_counts jj;
     json_t *constraints;
     int errnum;
+    double t_estimate;      /* backfill: reserved start time, 0 = none */
+    int jobs_ahead;         /* reason_pending jobs_ahead sent, -1 = none */
+};
+
+/* Allocations that have passed their expiration are assumed to be freed
+ * no sooner than this many seconds after the start of a backfill pass.
+ */
+#define BACKFILL_OVERDUE_DELAY 1.
+
+/* Maximum number of jobs considered per check_cb() in backfill mode.
+ * A pass over the queue that is not finished resumes on the next
+ * reactor loop iteration.
+ */
+#define BACKFILL_BATCH_SIZE 8
+
+/* Maximum time in milliseconds spent allocating jobs per check_cb().
+ * Jobs that remain are considered on the next reactor loop iteration.
+ */
+#define ALLOC_TIME_BUDGET 10.
+
+/* Maximum number of cached R objects for single node allocations.
+ */
+#define R_CACHE_SIZE 1024
+
+/* Maximum number of cached feasibility results.
+ */
+#define FEASIBILITY_CACHE_SIZE 1024
+
+/* Result of a feasibility check, cached by request shape.
+ */
+struct feasibility {
+    int errnum;             /* 0 = feasible */
+    char errmsg[];          /* empty if none */
+};
+
+/* A running allocation, tracked in backfill mode.
+ */
+struct allocation {
+    flux_jobid_t id;
+    double expiration;      /* 0 = none */
+    struct rlist *rl;
+};
+
+/* A point in the backfill availability profile: the resources that are
+ * free from time 't' until the time of the next point.
+ */
+struct profile_point {
+    double t;
+    struct rlist *free;
 };
 
 struct simple_sched {
@@ -54,6 +106,16 @@ struct simple_sched {
     struct rlist *rlist;    /* list of resources */
     zlistx_t *queue;        /* job queue */
     schedutil_t *util_ctx;
+    zhashx_t *R_cache;      /* R of single node allocs, by resource summary */
+    zhashx_t *feasibility_cache; /* struct feasibility, by request shape */
+
+    bool backfill;          /* mode=backfill */
+    int queue_depth;        /* backfill: max jobs considered per pass */
+    zhashx_t *allocs;       /* backfill: running allocations by jobid */
+    zlistx_t *profile;      /* backfill: availability profile for pass */
+    struct jobreq *bf_next; /* backfill: next job to consider in pass */
+    int bf_count;           /* backfill: jobs considered so far in pass */
+    int bf_reserved;        /* backfill: reservations made in pass */
 
     flux_watcher_t *prep;
     flux_watcher_t *check;
@@ -112,6 +174,7 @@ jobreq_create (const flux_msg_t *msg)
 
     if (job == NULL)
         return NULL;
+    job->jobs_ahead = -1;
 
     if (flux_msg_unpack (msg, "{s:I s:i s:i s:f s:o}",
                          "id", &job->id,
@@ -165,6 +228,10 @@ static void simple_sched_destroy (flux_t *h, struct simple_sched *ss)
         flux_watcher_destroy (ss->check);
         flux_watcher_destroy (ss->idle);
         schedutil_destroy (ss->util_ctx);
+        zlistx_destroy (&ss->profile);
+        zhashx_destroy (&ss->allocs);
+        zhashx_destroy (&ss->R_cache);
+        zhashx_destroy (&ss->feasibility_cache);
         rlist_destroy (ss->rlist);
         free (ss->alloc_mode);
         free (ss->mode);
@@ -183,16 +250,151 @@ static struct simple_sched * simple_sched_create (void)
      * concurrency being excessively large.
      */
     ss->alloc_limit = 8;
+    ss->queue_depth = 32;
     return ss;
 }
 
+static void allocation_destroy (struct allocation *a)
+{
+    if (a) {
+        int saved_errno = errno;
+        rlist_destroy (a->rl);
+        free (a);
+        errno = saved_errno;
+    }
+}
+
+static void allocation_destructor (void **item)
+{
+    if (item) {
+        allocation_destroy (*item);
+        *item = NULL;
+    }
+}
+
+static int allocation_cmp (const void *x, const void *y)
+{
+    const struct allocation *a1 = x;
+    const struct allocation *a2 = y;
+
+    return NUMCMP (a1->expiration, a2->expiration);
+}
+
+/* Track allocation 'rl' of job 'id' for backfill planning.
+ */
+static int allocation_add (struct simple_sched *ss,
+                           flux_jobid_t id,
+                           const struct rlist *rl)
+{
+    struct allocation *a;
+
+    if (!ss->backfill)
+        return 0;
+    if (!(a = calloc (1, sizeof (*a))))
+        return -1;
+    a->id = id;
+    a->expiration = rl->expiration;
+    if (!(a->rl = rlist_copy_empty (rl))) {
+        allocation_destroy (a);
+        return -1;
+    }
+    zhashx_delete (ss->allocs, &id);
+    if (zhashx_insert (ss->allocs, &a->id, a) < 0) {
+        allocation_destroy (a);
+        errno = EEXIST;
+        return -1;
+    }
+    return 0;
+}
+
+/* Stop tracking resources 'rl' freed by job 'id'.  A job's resources
+ * may be freed in more than one part.
+ */
+static void allocation_remove (struct simple_sched *ss,
+                               flux_jobid_t id,
+                               const struct rlist *rl)
+{
+    struct allocation *a;
+    struct rlist *rest;
+
+    if (!ss->backfill || !(a = zhashx_lookup (ss->allocs, &id)))
+        return;
+    if (!(rest = rlist_diff (a->rl, rl)) || rlist_count (rest, "core") == 0) {
+        rlist_destroy (rest);
+        zhashx_delete (ss->allocs, &id);
+        return;
+    }
+    rlist_destroy (a->rl);
+    a->rl = rest;
+}
+
+static void R_destructor (void **item)
+{
+    if (item) {
+        json_decref (*item);
+        *item = NULL;
+    }
+}
+
+/* Return a copy of cached R with new starttime and expiration.  Only the
+ * objects that change are copied, the rest is shared with the cache.
+ */
+static json_t *R_cache_copy (json_t *cached, struct rlist *l)
+{
+    json_t *R;
+    json_t *exec = NULL;
+
+    if (!(R = json_copy (cached))
+        || !(exec = json_copy (json_object_get (cached, "execution")))
+        || json_object_set_new (exec,
+                                "starttime",
+                                json_real (l->starttime)) < 0
+        || json_object_set_new (exec,
+                                "expiration",
+                                json_real (l->expiration)) < 0
+        || json_object_set_new (R, "execution", exec) < 0) {
+        json_decref (exec);
+        json_decref (R);
+        return NULL;
+    }
+    return R;
+}
+
+/* Look up R for single node allocation 'l', with resource summary
+ * 'summary', in the R cache, converting and caching it on a miss.
+ */
+static json_t *R_cache_lookup (struct simple_sched *ss,
+                               struct rlist *l,
+                               const char *summary)
+{
+    json_t *R;
+
+    if (!(R = zhashx_lookup (ss->R_cache, summary))) {
+        if (!(R = rlist_to_R (l)))
+            return NULL;
+        if (zhashx_size (ss->R_cache) >= R_CACHE_SIZE)
+            zhashx_purge (ss->R_cache);
+        if (zhashx_insert (ss->R_cache, summary, R) < 0) {
+            json_decref (R);
+            return NULL;
+        }
+    }
+    return R;
+}
+
+/* Encode R for allocation 'l'.  Single node allocations of the same
+ * resources recur often with small jobs, so R for those is built from
+ * the R cache rather than converted from 'l' each time.
+ */
 static char *Rstring_create (struct simple_sched *ss,
                              struct rlist *l,
+                             const char *summary,
                              double now,
                              double timelimit)
 {
     char *s = NULL;
     json_t *R = NULL;
+    json_t *cached;
     l->starttime = now;
     l->expiration = 0.;
     if (timelimit > 0.) {
@@ -201,7 +403,13 @@ static char *Rstring_create (struct simple_sched *ss,
     else if (ss->rlist->expiration > 0.) {
         l->expiration = ss->rlist->expiration;
     }
-    if ((R = rlist_to_R (l))) {
+    if (summary && !l->scheduling && rlist_nnodes (l) == 1) {
+        if ((cached = R_cache_lookup (ss, l, summary)))
+            R = R_cache_copy (cached, l);
+    }
+    else
+        R = rlist_to_R (l);
+    if (R) {
         s = json_dumps (R, JSON_COMPACT);
         json_decref (R);
     }
@@ -209,6 +417,7 @@ static char *Rstring_create (struct simple_sched *ss,
 }
 
 static struct rlist *sched_alloc (struct simple_sched *ss,
+                                  struct rlist *rl,
                                   struct jobreq *job,
                                   flux_error_t *errp)
 {
@@ -220,30 +429,71 @@ static struct rlist *sched_alloc (struct simple_sched *ss,
         .exclusive = job->jj.exclusive,
         .constraints = job->constraints
     };
-    return rlist_alloc (ss->rlist, &ai, errp);
+    return rlist_alloc (rl, &ai, errp);
+}
+
+static void alloc_respond_success (struct simple_sched *ss,
+                                   struct jobreq *job,
+                                   struct rlist *alloc,
+                                   const char *s,
+                                   const char *R)
+{
+    int rc;
+
+    if (ss->backfill)
+        rc = schedutil_alloc_respond_success_pack (ss->util_ctx,
+                                                   job->msg,
+                                                   R,
+                                                   "{ s:{s:s s:n s:n s:n} }",
+                                                   "sched",
+                                                   "resource_summary", s,
+                                                   "reason_pending",
+                                                   "jobs_ahead",
+                                                   "t_estimate");
+    else
+        rc = schedutil_alloc_respond_success_pack (ss->util_ctx,
+                                                   job->msg,
+                                                   R,
+                                                   "{ s:{s:s s:n s:n} }",
+                                                   "sched",
+                                                   "resource_summary", s,
+                                                   "reason_pending",
+                                                   "jobs_ahead");
+    if (rc < 0)
+        flux_log_error (ss->h, "schedutil_alloc_respond_success_pack");
+    else if (allocation_add (ss, job->id, alloc) < 0)
+        flux_log_error (ss->h, "alloc: error tracking allocation");
+
+    flux_log (ss->h, LOG_DEBUG, "alloc: %s: %s", idf58 (job->id), s);
 }
 
+/* Try to allocate resources for the job at the head of the queue.
+ * Return 0 if the job was allocated or denied, or -1 with errno set to
+ * ENOSPC if it must wait for resources or ENOENT if the queue is empty.
+ */
 static int try_alloc (flux_t *h, struct simple_sched *ss)
 {
-    int rc = -1;
-    char *s = NULL;
     struct rlist *alloc = NULL;
     struct jj_counts *jj = NULL;
     char *R = NULL;
+    char *s = NULL;
     struct jobreq *job = zlistx_first (ss->queue);
     double now = flux_reactor_now (flux_get_reactor (h));
     bool fail_alloc = flux_module_debug_test (h, DEBUG_FAIL_ALLOC, false);
     flux_error_t error;
 
-    if (!job)
+    if (!job) {
+        errno = ENOENT;
         return -1;
+    }
 
     jj = &job->jj;
-    if (!fail_alloc) {
-        errno = 0;
-        alloc = sched_alloc (ss, job, &error);
-    }
-    if (!alloc || !(R = Rstring_create (ss, alloc, now, jj->duration))) {
+    errno = 0;
+    if (!fail_alloc)
+        alloc = sched_alloc (ss, ss->rlist, job, &error);
+    if (alloc)
+        s = rlist_dumps (alloc);
+    if (!alloc || !(R = Rstring_create (ss, alloc, s, now, jj->duration))) {
         const char *note = "unable to allocate provided jobspec";
         if (alloc != NULL) {
             /*  unlikely: allocation succeeded but Rstring_create failed */
@@ -254,7 +504,7 @@ static int try_alloc (flux_t *h, struct simple_sched *ss)
             rlist_destroy (alloc);
             alloc = NULL;
         } else if (errno == ENOSPC)
-            return rc;
+            return -1;
         else if (errno == EOVERFLOW)
             note = "unsatisfiable request";
         else if (fail_alloc)
@@ -265,29 +515,19 @@ static int try_alloc (flux_t *h, struct simple_sched *ss)
             flux_log_error (h, "schedutil_alloc_respond_deny");
         goto out;
     }
-    s = rlist_dumps (alloc);
-
-    if (schedutil_alloc_respond_success_pack (ss->util_ctx,
-                                              job->msg,
-                                              R,
-                                              "{ s:{s:s s:n s:n} }",
-                                              "sched",
-                                              "resource_summary", s,
-                                              "reason_pending",
-                                              "jobs_ahead") < 0)
-        flux_log_error (h, "schedutil_alloc_respond_success_pack");
-
-    flux_log (h, LOG_DEBUG, "alloc: %s: %s", idf58 (job->id), s);
-    rc = 0;
+    alloc_respond_success (ss, job, alloc, s, R);
 
 out:
     zlistx_delete (ss->queue, job->handle);
     rlist_destroy (alloc);
     free (R);
     free (s);
-    return rc;
+    return 0;
 }
 
+/* Only jobs whose position in the queue has changed since the last
+ * pass are re-annotated.
+ */
 static void annotate_reason_pending (struct simple_sched *ss)
 {
     int jobs_ahead = 0;
@@ -297,19 +537,459 @@ static void annotate_reason_pending (struct simple_sched *ss)
 
     struct jobreq *job = zlistx_first (ss->queue);
     while (job) {
-        if (schedutil_alloc_respond_annotate_pack (ss->util_ctx,
-                                                   job->msg,
-                                                   "{ s:{s:s s:i} }",
-                                                   "sched",
-                                                   "reason_pending",
-                                                     "insufficient resources",
-                                                   "jobs_ahead",
-                                                     jobs_ahead++) < 0)
+        if (job->jobs_ahead != jobs_ahead
+            && schedutil_alloc_respond_annotate_pack (ss->util_ctx,
+                                                      job->msg,
+                                                      "{ s:{s:s s:i} }",
+                                                      "sched",
+                                                      "reason_pending",
+                                                      "insufficient resources",
+                                                      "jobs_ahead",
+                                                      jobs_ahead) < 0)
             flux_log_error (ss->h, "schedutil_alloc_respond_annotate_pack");
+        job->jobs_ahead = jobs_ahead++;
         job = zlistx_next (ss->queue);
     }
 }
 
+/* Backfill mode
+ *
+ * Each pass over the queue starts from a profile of resource availability
+ * over time: free resources now, plus a point at each distinct expiration
+ * of a running allocation where its resources are released.  Jobs are
+ * considered in priority order.  A job that can start now without taking
+ * resources reserved for a job ahead of it (for its whole duration) is
+ * allocated.  Otherwise it is given a reservation at the earliest profile
+ * point where it fits for its whole duration ("conservative" backfill),
+ * which later jobs must then avoid.
+ *
+ * At most queue_depth jobs are considered per pass, in batches of
+ * BACKFILL_BATCH_SIZE per check_cb().  Any event that changes the queue or
+ * resources abandons a pass in progress, so the next one starts afresh.
+ */
+static void profile_point_destroy (struct profile_point *p)
+{
+    if (p) {
+        int saved_errno = errno;
+        rlist_destroy (p->free);
+        free (p);
+        errno = saved_errno;
+    }
+}
+
+static void profile_point_destructor (void **item)
+{
+    if (item) {
+        profile_point_destroy (*item);
+        *item = NULL;
+    }
+}
+
+static int profile_point_cmp (const void *x, const void *y)
+{
+    const struct profile_point *p1 = x;
+    const struct profile_point *p2 = y;
+
+    return NUMCMP (p1->t, p2->t);
+}
+
+/* Add a point at time 't' to 'profile', which takes ownership of 'free'
+ * (even on failure).
+ */
+static int profile_insert (zlistx_t *profile, double t, struct rlist *free)
+{
+    struct profile_point *p;
+
+    if (!free || !(p = calloc (1, sizeof (*p)))) {
+        rlist_destroy (free);
+        return -1;
+    }
+    p->t = t;
+    p->free = free;
+    if (!zlistx_insert (profile, p, false)) {
+        profile_point_destroy (p);
+        errno = ENOMEM;
+        return -1;
+    }
+    return 0;
+}
+
+/* Return the resources in 'a' that are also in 'b'.  Unlike
+ * rlist_intersect(), node properties of 'a' are kept so that the
+ * result may still be matched against constraints.
+ */
+static struct rlist *rlist_restrict (const struct rlist *a,
+                                     const struct rlist *b)
+{
+    struct rlist *gone;
+    struct rlist *result = NULL;
+
+    if ((gone = rlist_diff (a, b))) {
+        result = rlist_diff (a, gone);
+        rlist_destroy (gone);
+    }
+    return result;
+}
+
+static zlistx_t *profile_create (struct simple_sched *ss, double now)
+{
+    zlistx_t *profile;
+    zlistx_t *l = NULL;
+    struct rlist *all = NULL;
+    struct rlist *down = NULL;
+    struct rlist *up = NULL;
+    struct allocation *a;
+
+    if (!(profile = zlistx_new ()) || !(l = zlistx_new ()))
+        goto error;
+    zlistx_set_destructor (profile, profile_point_destructor);
+    zlistx_set_comparator (profile, profile_point_cmp);
+    zlistx_set_comparator (l, allocation_cmp);
+
+    if (profile_insert (profile, now, rlist_copy_avail (ss->rlist)) < 0)
+        goto error;
+
+    /*  Released resources only become free if they are on up nodes.
+     */
+    if (!(all = rlist_copy_empty (ss->rlist))
+        || !(down = rlist_copy_down (ss->rlist))
+        || !(up = rlist_diff (all, down)))
+        goto error;
+
+    a = zhashx_first (ss->allocs);
+    while (a) {
+        if (a->expiration > 0. && !zlistx_add_end (l, a))
+            goto error;
+        a = zhashx_next (ss->allocs);
+    }
+    zlistx_sort (l);
+
+    a = zlistx_first (l);
+    while (a) {
+        struct profile_point *last = zlistx_last (profile);
+        double t = a->expiration;
+        struct rlist *released;
+        struct rlist *free;
+
+        if (t < now + BACKFILL_OVERDUE_DELAY)
+            t = now + BACKFILL_OVERDUE_DELAY;
+        if (!(released = rlist_restrict (up, a->rl)))
+            goto error;
+        free = rlist_union (last->free, released);
+        rlist_destroy (released);
+        if (last->t == t) {
+            if (!free)
+                goto error;
+            rlist_destroy (last->free);
+            last->free = free;
+        }
+        else if (profile_insert (profile, t, free) < 0)
+            goto error;
+        a = zlistx_next (l);
+    }
+    zlistx_destroy (&l);
+    rlist_destroy (all);
+    rlist_destroy (down);
+    rlist_destroy (up);
+    return profile;
+error:
+    ERRNO_SAFE_WRAP (zlistx_destroy, &l);
+    ERRNO_SAFE_WRAP (zlistx_destroy, &profile);
+    rlist_destroy (all);
+    rlist_destroy (down);
+    rlist_destroy (up);
+    return NULL;
+}
+
+/* Return the time of the first profile point after 't', or 0 if none.
+ */
+static double profile_next (zlistx_t *profile, double t)
+{
+    struct profile_point *p = zlistx_first (profile);
+    while (p) {
+        if (p->t > t)
+            return p->t;
+        p = zlistx_next (profile);
+    }
+    return 0.;
+}
+
+/* Return the resources free over [start, end), where 'start' is the time
+ * of a profile point and an 'end' of 0 means forever.
+ */
+static struct rlist *profile_window (zlistx_t *profile,
+                                     double start,
+                                     double end)
+{
+    struct profile_point *p = zlistx_first (profile);
+    struct rlist *result = NULL;
+
+    while (p && (end == 0. || p->t < end)) {
+        if (p->t >= start) {
+            struct rlist *rl;
+            if (result)
+                rl = rlist_restrict (result, p->free);
+            else
+                rl = rlist_copy_empty (p->free);
+            rlist_destroy (result);
+            if (!(result = rl))
+                return NULL;
+        }
+        p = zlistx_next (profile);
+    }
+    return result;
+}
+
+/* Remove resources 'rl' from the profile over [start, end), where an
+ * 'end' of 0 means forever.
+ */
+static int profile_reserve (zlistx_t *profile,
+                            const struct rlist *rl,
+                            double start,
+                            double end)
+{
+    struct profile_point *p;
+    struct profile_point *prev = NULL;
+
+    /*  Split the profile at 'end' so that 'rl' is released there.
+     */
+    if (end > 0.) {
+        p = zlistx_first (profile);
+        while (p && p->t < end) {
+            prev = p;
+            p = zlistx_next (profile);
+        }
+        if (prev
+            && (!p || p->t > end)
+            && profile_insert (profile,
+                               end,
+                               rlist_copy_empty (prev->free)) < 0)
+            return -1;
+    }
+    p = zlistx_first (profile);
+    while (p && (end == 0. || p->t < end)) {
+        if (p->t >= start) {
+            struct rlist *free;
+            if (!(free = rlist_diff (p->free, rl)))
+                return -1;
+            rlist_destroy (p->free);
+            p->free = free;
+        }
+        p = zlistx_next (profile);
+    }
+    return 0;
+}
+
+static void backfill_reset (struct simple_sched *ss)
+{
+    zlistx_destroy (&ss->profile);
+    ss->bf_next = NULL;
+    ss->bf_count = 0;
+    ss->bf_reserved = 0;
+}
+
+/* Return the time 'job' is expected to run if started at 't',
+ * or 0 if unlimited.
+ */
+static double jobreq_duration (struct simple_sched *ss,
+                               struct jobreq *job,
+                               double t)
+{
+    if (job->jj.duration > 0.)
+        return job->jj.duration;
+    if (ss->rlist->expiration > t)
+        return ss->rlist->expiration - t;
+    return 0.;
+}
+
+static void annotate_t_estimate (struct simple_sched *ss,
+                                 struct jobreq *job,
+                                 double t)
+{
+    int rc;
+
+    if (job->t_estimate == t)
+        return;
+    if (t > 0.)
+        rc = schedutil_alloc_respond_annotate_pack (ss->util_ctx,
+                                                    job->msg,
+                                                    "{ s:{s:f} }",
+                                                    "sched",
+                                                    "t_estimate", t);
+    else
+        rc = schedutil_alloc_respond_annotate_pack (ss->util_ctx,
+                                                    job->msg,
+                                                    "{ s:{s:n} }",
+                                                    "sched",
+                                                    "t_estimate");
+    if (rc < 0)
+        flux_log_error (ss->h, "schedutil_alloc_respond_annotate_pack");
+    job->t_estimate = t;
+}
+
+/* Allocate 'job' now from resources that stay free in the profile for
+ * its whole duration.
+ */
+static struct rlist *backfill_alloc (struct simple_sched *ss,
+                                     struct jobreq *job,
+                                     double t0,
+                                     double duration)
+{
+    struct rlist *fit;
+    struct rlist *alloc = NULL;
+    flux_error_t error;
+
+    if ((fit = profile_window (ss->profile,
+                               t0,
+                               duration > 0. ? t0 + duration : 0.))) {
+        alloc = sched_alloc (ss, fit, job, &error);
+        rlist_destroy (fit);
+    }
+    if (alloc && rlist_set_allocated (ss->rlist, alloc) < 0) {
+        flux_log_error (ss->h, "backfill: rlist_set_allocated");
+        rlist_destroy (alloc);
+        alloc = NULL;
+    }
+    return alloc;
+}
+
+/* Reserve resources for 'job' at the first profile point after 't0' where
+ * it fits for its whole duration.  Return the reserved time, or 0 if the
+ * job could not be fit into the profile.
+ */
+static double backfill_reserve (struct simple_sched *ss,
+                                struct jobreq *job,
+                                double t0)
+{
+    double t = t0;
+
+    while ((t = profile_next (ss->profile, t)) > 0.) {
+        double duration = jobreq_duration (ss, job, t);
+        double end = duration > 0. ? t + duration : 0.;
+        struct rlist *fit;
+        struct rlist *rl = NULL;
+        flux_error_t error;
+
+        if ((fit = profile_window (ss->profile, t, end))) {
+            rl = sched_alloc (ss, fit, job, &error);
+            rlist_destroy (fit);
+        }
+        if (rl) {
+            int rc = profile_reserve (ss->profile, rl, t, end);
+            rlist_destroy (rl);
+            if (rc < 0) {
+                flux_log_error (ss->h, "backfill: error updating profile");
+                return 0.;
+            }
+            ss->bf_reserved++;
+            return t;
+        }
+    }
+    return 0.;
+}
+
+static void backfill_job (struct simple_sched *ss,
+                          struct jobreq *job,
+                          double now)
+{
+    struct profile_point *p0 = zlistx_first (ss->profile);
+    double duration = jobreq_duration (ss, job, p0->t);
+    struct rlist *alloc = NULL;
+    char *R = NULL;
+    char *s = NULL;
+    const char *note = "unable to allocate provided jobspec";
+    flux_error_t error;
+
+    if (flux_module_debug_test (ss->h, DEBUG_FAIL_ALLOC, false)) {
+        note = "DEBUG_FAIL_ALLOC";
+        goto deny;
+    }
+    errno = 0;
+    if (!(alloc = sched_alloc (ss, ss->rlist, job, &error))) {
+        if (errno == EOVERFLOW)
+            note = "unsatisfiable request";
+        if (errno != ENOSPC)
+            goto deny;
+    }
+    else if (ss->bf_reserved > 0) {
+        /*  Resources are free now, but may be reserved before this job
+         *   would end.  Give them back and allocate only from resources
+         *   that stay free for the job's duration.
+         */
+        if (rlist_free (ss->rlist, alloc) < 0) {
+            flux_log_error (ss->h, "backfill: failed to free trial alloc");
+            flux_reactor_stop_error (flux_get_reactor (ss->h));
+            rlist_destroy (alloc);
+            return;
+        }
+        rlist_destroy (alloc);
+        alloc = backfill_alloc (ss, job, p0->t, duration);
+    }
+    if (!alloc) {
+        annotate_t_estimate (ss, job, backfill_reserve (ss, job, p0->t));
+        return;
+    }
+    s = rlist_dumps (alloc);
+    if (!(R = Rstring_create (ss, alloc, s, now, job->jj.duration))) {
+        note = "internal scheduler error generating R";
+        flux_log (ss->h, LOG_ERR, "%s", note);
+        if (rlist_free (ss->rlist, alloc) < 0)
+            flux_log_error (ss->h, "backfill: rlist_free");
+        goto deny;
+    }
+    alloc_respond_success (ss, job, alloc, s, R);
+    if (profile_reserve (ss->profile,
+                         alloc,
+                         p0->t,
+                         duration > 0. ? p0->t + duration : 0.) < 0)
+        flux_log_error (ss->h, "backfill: error updating profile");
+    goto out;
+deny:
+    if (schedutil_alloc_respond_deny (ss->util_ctx, job->msg, note) < 0)
+        flux_log_error (ss->h, "schedutil_alloc_respond_deny");
+out:
+    zlistx_delete (ss->queue, job->handle);
+    rlist_destroy (alloc);
+    free (R);
+    free (s);
+}
+
+/* Consider the next batch of jobs in the current backfill pass, starting
+ * a new pass if none is in progress.  Return true if the pass is not done.
+ */
+static bool backfill_schedule (struct simple_sched *ss)
+{
+    double now = flux_reactor_now (flux_get_reactor (ss->h));
+    struct jobreq *job;
+    int count = 0;
+
+    if (!ss->profile) {
+        if (!(ss->profile = profile_create (ss, now))) {
+            flux_log_error (ss->h, "backfill: error creating profile");
+            return false;
+        }
+        job = zlistx_first (ss->queue);
+    }
+    else if ((job = ss->bf_next) && !zlistx_find (ss->queue, job))
+        job = NULL;
+
+    while (job
+           && ss->bf_count < ss->queue_depth
+           && count++ < BACKFILL_BATCH_SIZE) {
+        struct jobreq *next = zlistx_next (ss->queue);
+        backfill_job (ss, job, now);
+        ss->bf_count++;
+        job = next;
+    }
+    if (job && ss->bf_count < ss->queue_depth) {
+        ss->bf_next = job;
+        return true;
+    }
+    backfill_reset (ss);
+    annotate_reason_pending (ss);
+    return false;
+}
+
 static void prep_cb (flux_reactor_t *r, flux_watcher_t *w,
                      int revents, void *arg)
 {
@@ -326,20 +1006,39 @@ static void check_cb (flux_reactor_t *r, flux_watcher_t *w,
                       int revents, void *arg)
 {
     struct simple_sched *ss = arg;
+    struct timespec t0;
+
     flux_watcher_stop (ss->idle);
 
-    /* See if we can fulfill alloc for a pending job
-     * If current head of queue can't be allocated, stop the prep
-     *  watcher, i.e. block. O/w, retry on next loop.
+    if (ss->backfill) {
+        if (!backfill_schedule (ss)) {
+            flux_watcher_stop (ss->prep);
+            flux_watcher_stop (ss->check);
+        }
+        return;
+    }
+
+    /* Allocate pending jobs in queue order until the head of the queue
+     *  can't be allocated or the time budget for this pass is spent.
+     *  If the head of the queue can't be allocated, stop the prep
+     *  watcher, i.e. block. O/w, continue on next loop.
      */
-    if (try_alloc (ss->h, ss) < 0 && errno == ENOSPC) {
+    monotime (&t0);
+    while (try_alloc (ss->h, ss) == 0) {
+        if (monotime_since (t0) >= ALLOC_TIME_BUDGET)
+            return;
+    }
+    if (errno == ENOSPC) {
         annotate_reason_pending (ss);
         flux_watcher_stop (ss->prep);
         flux_watcher_stop (ss->check);
     }
 }
 
-static int try_free (flux_t *h, struct simple_sched *ss, json_t *R)
+static int try_free (flux_t *h,
+                     struct simple_sched *ss,
+                     flux_jobid_t id,
+                     json_t *R)
 {
     int rc = -1;
     char *r = NULL;
@@ -354,8 +1053,10 @@ static int try_free (flux_t *h, struct simple_sched *ss, json_t *R)
     r = rlist_dumps (alloc);
     if ((rc = rlist_free (ss->rlist, alloc)) < 0)
         flux_log_error (h, "free: %s", r);
-    else
+    else {
         flux_log (h, LOG_DEBUG, "free: %s", r);
+        allocation_remove (ss, id, alloc);
+    }
     free (r);
     rlist_destroy (alloc);
     return rc;
@@ -364,14 +1065,19 @@ static int try_free (flux_t *h, struct simple_sched *ss, json_t *R)
 void free_cb (flux_t *h, const flux_msg_t *msg, const char *R_str, void *arg)
 {
     struct simple_sched *ss = arg;
+    flux_jobid_t id = FLUX_JOBID_ANY;
     json_t *R;
 
-    if (flux_request_unpack (msg, NULL, "{s:o}", "R", &R) < 0) {
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s?I s:o}",
+                             "id", &id,
+                             "R", &R) < 0) {
         flux_log (h, LOG_ERR, "free: error unpacking sched.free request");
         return;
     }
 
-    if (try_free (h, ss, R) < 0) {
+    if (try_free (h, ss, id, R) < 0) {
         flux_log_error (h, "free: could not free R");
         return;
     }
@@ -382,6 +1088,7 @@ void free_cb (flux_t *h, const flux_msg_t *msg, const char *R_str, void *arg)
         flux_log_error (h, "free_cb: schedutil_free_respond");
 
     /* See if we can fulfill alloc for a pending job */
+    backfill_reset (ss);
     flux_watcher_start (ss->prep);
 }
 
@@ -419,6 +1126,7 @@ static void alloc_cb (flux_t *h, const flux_msg_t *msg, void *arg)
     job->handle = zlistx_insert (ss->queue,
                                  job,
                                  search_dir);
+    backfill_reset (ss);
     flux_watcher_start (ss->prep);
     return;
 err:
@@ -448,8 +1156,11 @@ static void cancel_cb (flux_t *h,
             flux_log_error (h, "alloc_respond_cancel");
             return;
         }
+        backfill_reset (ss);
         zlistx_delete (ss->queue, job->handle);
         annotate_reason_pending (ss);
+        if (ss->backfill)
+            flux_watcher_start (ss->prep);
     }
 }
 
@@ -498,6 +1209,10 @@ static void prioritize_cb (flux_t *h,
             job = zlistx_next (ss->queue);
         }
     }
+    if (ss->backfill) {
+        backfill_reset (ss);
+        flux_watcher_start (ss->prep);
+    }
     annotate_reason_pending (ss);
     return;
 
@@ -544,8 +1259,11 @@ static int hello_cb (flux_t *h,
     s = rlist_dumps (alloc);
     if ((rc = rlist_set_allocated (ss->rlist, alloc)) < 0)
         flux_log_error (h, "hello: rlist_remove (%s)", s);
-    else
+    else {
         flux_log (h, LOG_DEBUG, "hello: alloc %s", s);
+        if (allocation_add (ss, id, alloc) < 0)
+            flux_log_error (h, "hello: error tracking allocation");
+    }
     free (s);
     rlist_destroy (alloc);
     return rc;
@@ -609,6 +1327,95 @@ err:
         flux_log_error (h, "flux_respond_error");
 }
 
+/* Feasibility depends only on the request shape and the resource set,
+ * not on what is currently allocated, so results are cached by shape:
+ * node, slot, and slot size counts, plus the constraints in canonical
+ * form.  The cache is cleared when the resource set changes.
+ */
+static char *feasibility_key (struct jj_counts *jj, json_t *constraints)
+{
+    char *s = NULL;
+    char *key;
+
+    if (constraints
+        && !(s = json_dumps (constraints, JSON_COMPACT | JSON_SORT_KEYS))) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    if (asprintf (&key,
+                  "%d:%d:%d:%s",
+                  jj->nnodes,
+                  jj->nslots,
+                  jj->slot_size,
+                  s ? s : "") < 0)
+        key = NULL;
+    ERRNO_SAFE_WRAP (free, s);
+    return key;
+}
+
+static struct feasibility *feasibility_create (int errnum, const char *errmsg)
+{
+    struct feasibility *result;
+
+    if (!errmsg)
+        errmsg = "";
+    if (!(result = malloc (sizeof (*result) + strlen (errmsg) + 1)))
+        return NULL;
+    result->errnum = errnum;
+    strcpy (result->errmsg, errmsg);
+    return result;
+}
+
+static void feasibility_destructor (void **item)
+{
+    if (item) {
+        free (*item);
+        *item = NULL;
+    }
+}
+
+/* Run a trial allocation against the full resource set.
+ * Return NULL with 'errmsg' set on an internal error.
+ */
+static struct feasibility *feasibility_check (struct simple_sched *ss,
+                                              struct jj_counts *jj,
+                                              json_t *constraints,
+                                              const char **errmsg)
+{
+    struct rlist *alloc;
+    flux_error_t error;
+    struct rlist_alloc_info ai = {
+        .mode = ss->alloc_mode,
+        .nnodes = jj->nnodes,
+        .nslots = jj->nslots,
+        .slot_size = jj->slot_size,
+        .constraints = constraints
+    };
+
+    if (!(alloc = rlist_alloc (ss->rlist, &ai, &error))) {
+        /* If ENOSPC then job is satisfiable
+         */
+        if (errno != ENOSPC)
+            return feasibility_create (errno, error.text);
+        return feasibility_create (0, NULL);
+    }
+    if (rlist_free (ss->rlist, alloc) < 0) {
+        /*  If rlist_free() fails we're in trouble because
+         *  ss->rlist will have an invalid allocation. This should
+         *  be rare if not impossible, so just exit the reactor.
+         *
+         *  The sched module can then be reloaded without loss of jobs.
+         */
+        flux_log_error (ss->h, "feasibility_cb: failed to free fake alloc");
+        flux_reactor_stop_error (flux_get_reactor (ss->h));
+        rlist_destroy (alloc);
+        *errmsg = "Internal scheduler error";
+        return NULL;
+    }
+    rlist_destroy (alloc);
+    return feasibility_create (0, NULL);
+}
+
 static void feasibility_cb (flux_t *h,
                             flux_msg_handler_t *mh,
                             const flux_msg_t *msg,
@@ -618,9 +1425,9 @@ static void feasibility_cb (flux_t *h,
     struct jj_counts jj;
     json_t *jobspec;
     json_t *constraints = NULL;
-    struct rlist *alloc = NULL;
+    struct feasibility *result;
+    char *key = NULL;
     const char *errmsg = NULL;
-    flux_error_t error;
 
     if (flux_request_unpack (msg, NULL, "{s:o}",
                             "jobspec", &jobspec) < 0)
@@ -641,41 +1448,32 @@ static void feasibility_cb (flux_t *h,
         errmsg = "Unsupported resource type 'gpu'";
         goto err;
     }
-
-    struct rlist_alloc_info ai = {
-        .mode = ss->alloc_mode,
-        .nnodes = jj.nnodes,
-        .nslots = jj.nslots,
-        .slot_size = jj.slot_size,
-        .constraints = constraints
-    };
-    if (!(alloc = rlist_alloc (ss->rlist, &ai, &error))) {
-        if (errno != ENOSPC) {
-            errmsg = error.text;
+    if (!(key = feasibility_key (&jj, constraints)))
+        goto err;
+    if (!(result = zhashx_lookup (ss->feasibility_cache, key))) {
+        if (!(result = feasibility_check (ss, &jj, constraints, &errmsg)))
+            goto err;
+        if (zhashx_size (ss->feasibility_cache) >= FEASIBILITY_CACHE_SIZE)
+            zhashx_purge (ss->feasibility_cache);
+        if (zhashx_insert (ss->feasibility_cache, key, result) < 0) {
+            free (result);
+            errno = ENOMEM;
             goto err;
         }
-        /* Fall-through: if ENOSPC then job is satisfiable */
     }
-    if (alloc && rlist_free (ss->rlist, alloc) < 0) {
-        /*  If rlist_free() fails we're in trouble because
-         *  ss->rlist will have an invalid allocation. This should
-         *  be rare if not impossible, so just exit the reactor.
-         *
-         *  The sched module can then be reloaded without loss of jobs.
-         */
-        flux_log_error (h, "feasibility_cb: failed to free fake alloc");
-        flux_reactor_stop_error (flux_get_reactor (h));
-        errmsg = "Internal scheduler error";
+    if (result->errnum) {
+        errno = result->errnum;
+        errmsg = result->errmsg[0] ? result->errmsg : NULL;
         goto err;
     }
-    rlist_destroy (alloc);
     if (flux_respond_pack (h, msg, "{s:i}", "errnum", 0) < 0)
         flux_log_error (h, "feasibility_cb: flux_respond_pack");
+    free (key);
     return;
 err:
-    rlist_destroy (alloc);
     if (flux_respond_error (h, msg, errno, errmsg) < 0)
         flux_log_error (h, "feasibility_cb: flux_respond_error");
+    free (key);
 }
 
 /* For testing purposes, support the sched.expiration RPC even though
@@ -690,6 +1488,7 @@ static void expiration_cb (flux_t *h,
     flux_jobid_t id;
     double expiration;
     const char *errmsg = NULL;
+    struct allocation *a;
 
     if (flux_request_unpack (msg,
                              NULL,
@@ -707,6 +1506,11 @@ static void expiration_cb (flux_t *h,
         errmsg = "Rejecting expiration update for testing";
         goto err;
     }
+    if (ss->backfill && (a = zhashx_lookup (ss->allocs, &id))) {
+        a->expiration = expiration;
+        backfill_reset (ss);
+        flux_watcher_start (ss->prep);
+    }
     if (flux_respond (h, msg, NULL) < 0)
         flux_log_error (h, "feasibility_cb: flux_respond_pack");
     return;
@@ -734,6 +1538,10 @@ static int ss_resource_update (struct simple_sched *ss, flux_future_t *f)
     flux_rpc_get (f, &s);
     flux_log (ss->h, LOG_DEBUG, "resource update: %s", s);
 
+    /* Cached feasibility results may no longer hold.
+     */
+    zhashx_purge (ss->feasibility_cache);
+
     /* Update resource states:
      */
     if ((up && rlist_mark_up (ss->rlist, up) < 0)
@@ -766,8 +1574,14 @@ static void acquire_continuation (flux_future_t *f, void *arg)
         flux_reactor_stop (flux_get_reactor (ss->h));
         return;
     }
-    if (ss_resource_update (ss, f) == 0)
-        try_alloc (ss->h, ss);
+    if (ss_resource_update (ss, f) == 0) {
+        if (ss->backfill) {
+            backfill_reset (ss);
+            flux_watcher_start (ss->prep);
+        }
+        else
+            try_alloc (ss->h, ss);
+    }
 }
 
 /*  Synchronously acquire resources from resource module.
@@ -826,6 +1640,7 @@ static int simple_sched_init (flux_t *h, struct simple_sched *ss)
 {
     int rc = -1;
     char *s = NULL;
+    const char *mode = "limited=8";
 
     /*  Acquire resources from resource module and set initial
      *   resource state.
@@ -839,9 +1654,13 @@ static int simple_sched_init (flux_t *h, struct simple_sched *ss)
         flux_log_error (h, "schedutil_hello");
         goto out;
     }
-    if (schedutil_ready (ss->util_ctx,
-                         ss->mode ? ss->mode : "limited=8",
-                         NULL) < 0) {
+    /*  In backfill mode, the job manager sends all pending jobs.
+     */
+    if (ss->backfill)
+        mode = "unlimited";
+    else if (ss->mode)
+        mode = ss->mode;
+    if (schedutil_ready (ss->util_ctx, mode, NULL) < 0) {
         flux_log_error (h, "schedutil_ready");
         goto out;
     }
@@ -874,9 +1693,15 @@ static void set_mode (struct simple_sched *ss, const char *mode)
             return;
         }
         ss->alloc_limit = n;
+        ss->backfill = false;
     }
     else if (strcasecmp (mode, "unlimited") == 0) {
         ss->alloc_limit = 0;
+        ss->backfill = false;
+    }
+    else if (strcasecmp (mode, "backfill") == 0) {
+        ss->alloc_limit = 0;
+        ss->backfill = true;
     }
     else {
         flux_log (ss->h, LOG_ERR, "unknown mode: %s", mode);
@@ -907,9 +1732,22 @@ static int process_args (flux_t *h, struct simple_sched *ss,
         else if (strstarts (argv[i], "mode=")) {
             set_mode (ss, argv[i]+5);
         }
+        else if (strstarts (argv[i], "queue-depth=")) {
+            char *endptr;
+            long n = strtol (argv[i]+12, &endptr, 0);
+            if (*endptr != '\0' || n <= 0 || n > INT_MAX) {
+                flux_log (h, LOG_ERR, "invalid queue-depth: %s", argv[i]+12);
+                errno = EINVAL;
+                return -1;
+            }
+            ss->queue_depth = n;
+        }
         else if (streq (argv[i], "test-free-nolookup")) {
             ss->schedutil_flags |= SCHEDUTIL_FREE_NOLOOKUP;
         }
+        else if (streq (argv[i], "batch")) {
+            ss->schedutil_flags |= SCHEDUTIL_BATCH;
+        }
         else {
             flux_log_error (h, "Unknown module option: '%s'", argv[i]);
             errno = EINVAL;
@@ -963,6 +1801,18 @@ int mod_main (flux_t *h, int argc, char **argv)
     zlistx_set_comparator (ss->queue, jobreq_cmp);
     zlistx_set_destructor (ss->queue, jobreq_destructor);
 
+    if (!(ss->allocs = job_hash_create ()))
+        goto done;
+    zhashx_set_destructor (ss->allocs, allocation_destructor);
+
+    if (!(ss->R_cache = zhashx_new ()))
+        goto done;
+    zhashx_set_destructor (ss->R_cache, R_destructor);
+
+    if (!(ss->feasibility_cache = zhashx_new ()))
+        goto done;
+    zhashx_set_destructor (ss->feasibility_cache, feasibility_destructor);
+
     /* Let `flux module load simple-sched` return before synchronous
      * initialization with resource and job-manager modules.
      */
@@ -9,6 +9,12 @@
 \************************************************************/
 
 /* sdexec.c - run subprocesses under systemd as transient units
+ *
+ * Unit property updates are received on a single sdbus.subscribe request
+ * for all units, created when the first unit is started, and dispatched to
+ * each unit by object path.  This avoids a subscribe RPC and a per-signal
+ * match in sdbus for every unit, and lets StartTransientUnit be sent
+ * immediately, without a per-unit subscription ahead of it.
  *
  * Configuration:
  *  [systemd]
@@ -37,6 +43,7 @@
 #include "src/common/libutil/errno_safe.h"
 #include "src/common/libutil/fdutils.h"
 #include "src/common/libutil/jpath.h"
+#include "src/common/libczmqcontainers/czmq_containers.h"
 #include "ccan/str/str.h"
 
 #include "src/common/libsdexec/stop.h"
@@ -54,13 +61,14 @@ struct sdexec_ctx {
     flux_msg_handler_t **handlers;
     struct flux_msglist *requests; // each exec request "owns" an sdproc
     struct flux_msglist *kills;
+    flux_future_t *f_watch;     // sdbus.subscribe for all units
+    zhashx_t *units;            // unit object path => sdproc
 };
 
 struct sdproc {
     const flux_msg_t *msg;
     json_t *cmd;
     int flags;
-    flux_future_t *f_watch;
     flux_future_t *f_start;
     flux_future_t *f_stop;
     struct unit *unit;
@@ -71,6 +79,7 @@ struct sdproc {
     uint8_t finished_response_sent:1;
     uint8_t out_eof_sent:1;
     uint8_t err_eof_sent:1;
+    uint8_t watched:1;
 
     int errnum;
     const char *errstr;
@@ -200,22 +209,48 @@ static void reset_continuation (flux_future_t *f, void *arg)
     }
 }
 
-/* sdbus.subscribe sent a PropertiesChanged response for a particular unit.
- * Advance the proc->unit state accordingly and send exec responses as needed.
+/* The sdbus.subscribe request for all units failed, e.g. because sdbus
+ * lost its D-Bus connection.  Fail all exec requests, since their units
+ * can no longer be tracked, and drop the subscription so the next exec
+ * request creates a new one.
+ */
+static void watch_error (struct sdexec_ctx *ctx, flux_future_t *f)
+{
+    int errnum = errno;
+    const char *errstr = future_strerror (f, errnum);
+    const flux_msg_t *msg;
+
+    flux_log (ctx->h, LOG_ERR, "unit watch: %s", errstr);
+    while ((msg = flux_msglist_first (ctx->requests))) {
+        if (flux_respond_error (ctx->h, msg, errnum, errstr) < 0)
+            flux_log_error (ctx->h, "error responding to exec request");
+        flux_msglist_delete (ctx->requests); // destroys proc too
+    }
+    flux_future_destroy (ctx->f_watch);
+    ctx->f_watch = NULL;
+}
+
+/* sdbus.subscribe sent a PropertiesChanged response for some unit.
+ * Look up the sdproc by object path, and if found, advance the proc->unit
+ * state accordingly and send exec responses as needed.
  * call finalize_exec_request_if_done() in case this update is the last thing
  * the exec request was waiting for.
  */
 static void property_changed_continuation (flux_future_t *f, void *arg)
 {
     flux_t *h = flux_future_get_flux (f);
-    struct sdproc *proc = arg;
+    struct sdexec_ctx *ctx = arg;
+    struct sdproc *proc;
+    const char *path;
     json_t *properties;
 
-    if (!(properties = sdexec_property_changed_dict (f))) {
-        exec_respond_error (proc, errno, future_strerror (f, errno));
+    if (!(properties = sdexec_property_changed_dict (f))
+        || !(path = sdexec_property_changed_path (f))) {
+        watch_error (ctx, f);
         return;
     }
-    if (!sdexec_unit_update (proc->unit, properties)) {
+    if (!(proc = zhashx_lookup (ctx->units, path))
+        || !sdexec_unit_update (proc->unit, properties)) {
         flux_future_reset (f);
         return;
     }
@@ -382,9 +417,8 @@ static void channel_cb (struct channel *ch, json_t *io, void *arg)
 /* Since an sdproc is attached to each exec message's aux container, this
  * destructor is typically called when an exec request is destroyed, e.g.
  * after unit reaping is complete and the exec client has been sent ENODATA
- * or another error response.  This ends the sdbus.subscribe request for
- * property updates on this unit.  The subscribe future is destroyed here;
- * we do not wait for the ENODATA response.
+ * or another error response.  This stops dispatching property updates
+ * for this unit.
  */
 static void sdproc_destroy (struct sdproc *proc)
 {
@@ -393,20 +427,11 @@ static void sdproc_destroy (struct sdproc *proc)
         sdexec_channel_destroy (proc->in);
         sdexec_channel_destroy (proc->out);
         sdexec_channel_destroy (proc->err);
-        if (proc->f_watch) {
-            flux_future_t *f;
+        if (proc->watched) {
             sdexec_log_debug (proc->ctx->h,
                               "unwatch %s",
                               sdexec_unit_name (proc->unit));
-            f = flux_rpc_pack (proc->ctx->h,
-                               "sdbus.subscribe-cancel",
-                               proc->ctx->rank,
-                               FLUX_RPC_NORESPONSE,
-                               "{s:i}",
-                               "matchtag",
-                               flux_rpc_get_matchtag (proc->f_watch));
-            flux_future_destroy (f);
-            flux_future_destroy (proc->f_watch);
+            zhashx_delete (proc->ctx->units, sdexec_unit_path (proc->unit));
         }
         flux_future_destroy (proc->f_start);
         flux_future_destroy (proc->f_stop);
@@ -546,11 +571,36 @@ static int authorize_request (const flux_msg_t *msg,
     return -1;
 }
 
+/* Subscribe to property updates for all units, if not already subscribed.
+ * N.B. sdbus handles requests in order, so the subscription is in place
+ * before any StartTransientUnit request sent after this.
+ */
+static int watch_units (struct sdexec_ctx *ctx)
+{
+    const char *path_glob = "/org/freedesktop/systemd1/unit/*";
+
+    if (ctx->f_watch)
+        return 0;
+    sdexec_log_debug (ctx->h, "watch units");
+    if (!(ctx->f_watch = sdexec_property_changed (ctx->h,
+                                                  ctx->rank,
+                                                  path_glob))
+        || flux_future_then (ctx->f_watch,
+                             -1,
+                             property_changed_continuation,
+                             ctx) < 0) {
+        flux_future_destroy (ctx->f_watch);
+        ctx->f_watch = NULL;
+        return -1;
+    }
+    return 0;
+}
+
 /* Start a process as a systemd transient unit.  This is a streaming request.
- * It triggers two sdbus RPCs:
- * 1) sdbus.subscribe (streaming) for updates to this unit's properties
- * 2) sdbus.call StartTransientUnit to launch the transient unit.
- * Responses to those are handled in property_changed_continuation()
+ * It registers the unit for property updates from the shared subscription
+ * (see watch_units()), then sends sdbus.call StartTransientUnit without
+ * waiting for anything, so concurrent exec requests are pipelined.
+ * Responses are handled in property_changed_continuation()
  * and start_continuation().
  */
 static void exec_cb (flux_t *h,
@@ -594,15 +644,15 @@ static void exec_cb (flux_t *h,
         goto error;
     }
     proc->msg = msg;
+    if (watch_units (ctx) < 0)
+        goto error;
     sdexec_log_debug (h, "watch %s", sdexec_unit_name (proc->unit));
-    if (!(proc->f_watch = sdexec_property_changed (h,
-                                               ctx->rank,
-                                               sdexec_unit_path (proc->unit)))
-        || flux_future_then (proc->f_watch,
-                             -1,
-                             property_changed_continuation,
-                             proc) < 0)
+    if (zhashx_insert (ctx->units, sdexec_unit_path (proc->unit), proc) < 0) {
+        errstr = "a unit with this name is already running";
+        errno = EEXIST;
         goto error;
+    }
+    proc->watched = 1;
     sdexec_log_debug (h, "start %s", sdexec_unit_name (proc->unit));
     if (!(proc->f_start = sdexec_start_transient_unit (h,
                                              ctx->rank,
@@ -949,6 +999,19 @@ static void sdexec_ctx_destroy (struct sdexec_ctx *ctx)
             flux_msglist_destroy (ctx->requests);
         }
         flux_msglist_destroy (ctx->kills);
+        if (ctx->f_watch) {
+            flux_future_t *f;
+            f = flux_rpc_pack (ctx->h,
+                               "sdbus.subscribe-cancel",
+                               ctx->rank,
+                               FLUX_RPC_NORESPONSE,
+                               "{s:i}",
+                               "matchtag",
+                               flux_rpc_get_matchtag (ctx->f_watch));
+            flux_future_destroy (f);
+            flux_future_destroy (ctx->f_watch);
+        }
+        zhashx_destroy (&ctx->units);
         free (ctx->local_uri);
         free (ctx);
         errno = saved_errno;
@@ -971,6 +1034,10 @@ static struct sdexec_ctx *sdexec_ctx_create (flux_t *h)
     if (!(ctx->requests = flux_msglist_create ())
         || !(ctx->kills = flux_msglist_create ()))
         goto error;
+    if (!(ctx->units = zhashx_new ())) {
+        errno = ENOMEM;
+        goto error;
+    }
     return ctx;
 error:
     sdexec_ctx_destroy (ctx);
@@ -9,6 +9,11 @@
 \************************************************************/
 
 /* builtin cpu-affinity processing
+ *
+ * The cpusets for the shell and, with cpu-affinity=per-task, for each
+ * task are requested from the resource module on the local broker, which
+ * keeps a parsed copy of the topology.  Only if that fails does the shell
+ * load the topology from XML and compute them itself.
  */
 #define FLUX_SHELL_PLUGIN_NAME "cpu-affinity"
 
@@ -16,7 +21,10 @@
 #include "config.h"
 #endif
 
+#include <sched.h>
 #include <hwloc.h>
+#include <hwloc/glibc-sched.h>
+#include <jansson.h>
 #include <flux/core.h>
 #include <flux/shell.h>
 
@@ -280,17 +288,14 @@ static int shell_affinity_topology_init (flux_shell_t *shell,
     return 0;
 }
 
-/*  Create shell affinity context, including reading in hwloc
- *   topology, gathering number of local tasks and assigned core list,
- *   and getting the resulting cpuset for the entire shell.
+/*  Create shell affinity context, gathering number of local tasks
+ *   and assigned core list.
  */
 static struct shell_affinity * shell_affinity_create (flux_shell_t *shell)
 {
     struct shell_affinity *sa = calloc (1, sizeof (*sa));
     if (!sa)
         return NULL;
-    if (shell_affinity_topology_init (shell, sa) < 0)
-        goto err;
     if (flux_shell_rank_info_unpack (shell,
                                      -1,
                                      "{ s:i s:{s:s} }",
@@ -329,6 +334,79 @@ static bool affinity_getopt (flux_shell_t *shell, const char **resultp)
 }
 
 
+/*  Get the shell cpuset, and per-task cpusets if 'ntasks' > 0, from the
+ *   resource module on the local broker.
+ */
+static int shell_affinity_query (flux_shell_t *shell,
+                                 struct shell_affinity *sa,
+                                 int ntasks)
+{
+    flux_future_t *f;
+    const char *cpuset;
+    json_t *pertask = NULL;
+    size_t index;
+    json_t *entry;
+
+    if (!(f = flux_rpc_pack (flux_shell_get_flux (shell),
+                             "resource.topo-cpuset",
+                             FLUX_NODEID_ANY,
+                             0,
+                             "{s:s s:i}",
+                             "cores", sa->cores,
+                             "ntasks", ntasks))
+        || flux_rpc_get_unpack (f,
+                                "{s:s s?o}",
+                                "cpuset", &cpuset,
+                                "pertask", &pertask) < 0)
+        goto error;
+    if (!(sa->cpuset = hwloc_bitmap_alloc ())
+        || hwloc_bitmap_list_sscanf (sa->cpuset, cpuset) < 0)
+        goto inval;
+    if (ntasks > 0) {
+        if (json_array_size (pertask) != ntasks
+            || !(sa->pertask = cpuset_array_create (ntasks)))
+            goto inval;
+        json_array_foreach (pertask, index, entry) {
+            const char *s = json_string_value (entry);
+            if (!s || hwloc_bitmap_list_sscanf (sa->pertask[index], s) < 0)
+                goto inval;
+        }
+    }
+    flux_future_destroy (f);
+    return 0;
+inval:
+    errno = EPROTO;
+error:
+    if (sa->cpuset) {
+        hwloc_bitmap_free (sa->cpuset);
+        sa->cpuset = NULL;
+    }
+    cpuset_array_destroy (sa->pertask, ntasks);
+    sa->pertask = NULL;
+    flux_future_destroy (f);
+    return -1;
+}
+
+/*  Bind the calling process to 'set'.  Without a topology, which is the
+ *   case when cpusets came from the broker, use sched_setaffinity(2)
+ *   directly.  This binds only the calling thread, but tasks inherit the
+ *   binding of the shell thread that forks them.
+ */
+static int shell_affinity_bind (struct shell_affinity *sa,
+                                hwloc_const_cpuset_t set)
+{
+    cpu_set_t mask;
+
+    if (sa->topo)
+        return hwloc_set_cpubind (sa->topo, set, 0);
+    if (hwloc_cpuset_to_glibc_sched_affinity (NULL,
+                                              set,
+                                              &mask,
+                                              sizeof (mask)) < 0)
+        return -1;
+    return sched_setaffinity (0, sizeof (mask), &mask);
+}
+
 /*  Return task id for a shell task
  */
 static int flux_shell_task_getid (flux_shell_task_t *task)
@@ -361,7 +439,7 @@ static int task_affinity (flux_plugin_t *p,
     struct shell_affinity *sa = data;
     int i = get_taskid (p);
     if (sa->pertask)
-        hwloc_set_cpubind (sa->topo, sa->pertask[i], 0);
+        shell_affinity_bind (sa, sa->pertask[i]);
     shell_affinity_destroy (sa);
     return 0;
 }
@@ -374,6 +452,7 @@ static int affinity_init (flux_plugin_t *p,
     const char *option;
     struct shell_affinity *sa = NULL;
     flux_shell_t *shell = flux_plugin_get_shell (p);
+    bool per_task;
 
     if (!shell)
         return shell_log_errno ("flux_plugin_get_shell");
@@ -383,35 +462,46 @@ static int affinity_init (flux_plugin_t *p,
     }
     if (!(sa = shell_affinity_create (shell)))
         return shell_log_errno ("shell_affinity_create");
-
-    /*  Attempt to get cpuset union of all allocated cores. If this
-     *   fails, then it might be because the allocated cores exceeds
-     *   the real cores available on this machine, so just log an
-     *   informational message and skip setting affinity.
-     */
-    if (!(sa->cpuset = shell_affinity_get_cpuset (sa, sa->cores))) {
-        shell_warn ("unable to get cpuset for cores %s. Disabling affinity",
-                    sa->cores);
-        return 0;
+    per_task = streq (option, "per-task");
+
+    if (shell_affinity_query (shell, sa, per_task ? sa->ntasks : 0) < 0) {
+        shell_debug ("resource.topo-cpuset: %s, loading topology",
+                     flux_strerror (errno));
+        if (shell_affinity_topology_init (shell, sa) < 0) {
+            shell_affinity_destroy (sa);
+            return shell_log_errno ("shell_affinity_create");
+        }
+        /*  Attempt to get cpuset union of all allocated cores. If this
+         *   fails, then it might be because the allocated cores exceeds
+         *   the real cores available on this machine, so just log an
+         *   informational message and skip setting affinity.
+         */
+        if (!(sa->cpuset = shell_affinity_get_cpuset (sa, sa->cores))) {
+            shell_warn ("unable to get cpuset for cores %s. Disabling affinity",
+                        sa->cores);
+            shell_affinity_destroy (sa);
+            return 0;
+        }
+        /*  If cpu-affinity=per-task, then distribute ntasks over the
+         *   resources to which the shell will be bound.
+         */
+        if (per_task) {
+            if (!(sa->pertask = distribute_tasks (sa->topo,
+                                                  sa->cpuset,
+                                                  sa->ntasks)))
+                shell_log_errno ("distribute_tasks failed");
+        }
     }
     if (flux_plugin_aux_set (p, "affinity", sa, shell_affinity_destroy) < 0) {
         shell_affinity_destroy (sa);
         return -1;
     }
-    if (hwloc_set_cpubind (sa->topo, sa->cpuset, 0) < 0)
-        return shell_log_errno ("hwloc_set_cpubind");
+    if (shell_affinity_bind (sa, sa->cpuset) < 0)
+        return shell_log_errno ("failed to bind shell to cpuset");
 
-    /*  If cpu-affinity=per-task, then distribute ntasks over whatever
-     *   resources to which the shell is now bound (from above)
-     *  Set a 'task.exec' callback to actually make the per-task binding.
+    /*  Set a 'task.exec' callback to actually make the per-task binding.
      */
-    if (streq (option, "per-task")) {
-        if (!(sa->pertask = distribute_tasks (sa->topo,
-                                              sa->cpuset,
-                                              sa->ntasks)))
-            shell_log_errno ("distribute_tasks failed");
-    }
-    else if (strstarts (option, "map:")) {
+    if (strstarts (option, "map:")) {
         if (!(sa->pertask = parse_cpuset_list (option+4, sa->ntasks)))
             return -1;
     }
@@ -0,0 +1,346 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* cache.c - node-local cache for shell startup
+ *
+ * Each entry is a file named <type>-<hash of path> in the cache directory,
+ * containing a header that identifies the source path and its stat(2)
+ * attributes, followed by the cached data.  A lookup compares the header
+ * with one built from a fresh stat of the source, so a stale or colliding
+ * entry is simply a miss.  Entries are written to a temporary file and
+ * renamed into place, so concurrent shells on the same node never see a
+ * partial entry.
+ *
+ * Directory listings are cached as a sequence of NUL terminated names,
+ * tagged with the directory's own attributes, whose mtime changes
+ * whenever an entry is added, removed, or renamed.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <fnmatch.h>
+#include <errno.h>
+#include <glob.h>
+
+#include "src/common/libutil/hashmap.h"
+#include "src/common/libutil/read_all.h"
+#include "src/common/libutil/errno_safe.h"
+#include "ccan/str/str.h"
+
+#include "cache.h"
+
+#define CACHE_VERSION 1
+
+struct shell_cache {
+    char *dir;
+};
+
+void shell_cache_destroy (struct shell_cache *cache)
+{
+    if (cache) {
+        int saved_errno = errno;
+        free (cache->dir);
+        free (cache);
+        errno = saved_errno;
+    }
+}
+
+struct shell_cache *shell_cache_create (const char *dir)
+{
+    struct shell_cache *cache;
+    struct stat sb;
+
+    if (!dir) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (mkdir (dir, 0700) < 0 && errno != EEXIST)
+        return NULL;
+    if (lstat (dir, &sb) < 0)
+        return NULL;
+    if (!S_ISDIR (sb.st_mode)
+        || sb.st_uid != getuid ()
+        || (sb.st_mode & (S_IWGRP | S_IWOTH))) {
+        errno = EPERM;
+        return NULL;
+    }
+    if (!(cache = calloc (1, sizeof (*cache)))
+        || !(cache->dir = strdup (dir))) {
+        shell_cache_destroy (cache);
+        return NULL;
+    }
+    return cache;
+}
+
+static char *cache_entry (struct shell_cache *cache,
+                          const char *type,
+                          const char *path)
+{
+    char *file;
+    size_t hash = hashmap_hash_bytes (path, strlen (path));
+
+    if (asprintf (&file, "%s/%s-%016zx", cache->dir, type, hash) < 0)
+        return NULL;
+    return file;
+}
+
+static char *cache_header (const char *type,
+                           const char *path,
+                           const struct stat *sb)
+{
+    char *header;
+
+    if (asprintf (&header,
+                  "flux-shell-cache %d %s %ju %ju %jd %jd.%09ld\n%s\n",
+                  CACHE_VERSION,
+                  type,
+                  (uintmax_t)sb->st_dev,
+                  (uintmax_t)sb->st_ino,
+                  (intmax_t)sb->st_size,
+                  (intmax_t)sb->st_mtim.tv_sec,
+                  sb->st_mtim.tv_nsec,
+                  path) < 0)
+        return NULL;
+    return header;
+}
+
+void *shell_cache_read (struct shell_cache *cache,
+                        const char *type,
+                        const char *path,
+                        const struct stat *sb,
+                        size_t *size)
+{
+    char *file = NULL;
+    char *header = NULL;
+    char *buf = NULL;
+    struct stat st;
+    size_t hlen;
+    ssize_t n;
+    int fd = -1;
+
+    if (!cache || !type || !path || !sb || !size) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(file = cache_entry (cache, type, path))
+        || !(header = cache_header (type, path, sb))
+        || (fd = open (file, O_RDONLY | O_CLOEXEC)) < 0
+        || fstat (fd, &st) < 0)
+        goto error;
+    hlen = strlen (header);
+    if (st.st_uid != getuid () || st.st_size < (off_t)hlen) {
+        errno = ENOENT;
+        goto error;
+    }
+    if ((n = read_all (fd, (void **)&buf)) < 0)
+        goto error;
+    if ((size_t)n < hlen || memcmp (buf, header, hlen) != 0) {
+        errno = ENOENT;
+        goto error;
+    }
+    memmove (buf, buf + hlen, n - hlen);
+    *size = n - hlen;
+    close (fd);
+    free (header);
+    free (file);
+    return buf;
+error:
+    if (fd >= 0)
+        ERRNO_SAFE_WRAP (close, fd);
+    ERRNO_SAFE_WRAP (free, buf);
+    ERRNO_SAFE_WRAP (free, header);
+    ERRNO_SAFE_WRAP (free, file);
+    return NULL;
+}
+
+int shell_cache_write (struct shell_cache *cache,
+                       const char *type,
+                       const char *path,
+                       const struct stat *sb,
+                       const void *data,
+                       size_t size)
+{
+    char *file = NULL;
+    char *tmp = NULL;
+    char *header = NULL;
+    int fd = -1;
+    int rc;
+
+    if (!cache || !type || !path || !sb || (!data && size > 0)) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!(file = cache_entry (cache, type, path))
+        || !(header = cache_header (type, path, sb))
+        || asprintf (&tmp, "%s.XXXXXX", file) < 0)
+        goto error;
+    if ((fd = mkostemp (tmp, O_CLOEXEC)) < 0) {
+        free (tmp);
+        tmp = NULL;
+        goto error;
+    }
+    if (write_all (fd, header, strlen (header)) < 0
+        || write_all (fd, data, size) < 0)
+        goto error;
+    rc = close (fd);
+    fd = -1;
+    if (rc < 0 || rename (tmp, file) < 0)
+        goto error;
+    free (header);
+    free (tmp);
+    free (file);
+    return 0;
+error:
+    if (fd >= 0)
+        ERRNO_SAFE_WRAP (close, fd);
+    if (tmp)
+        ERRNO_SAFE_WRAP (unlink, tmp);
+    ERRNO_SAFE_WRAP (free, tmp);
+    ERRNO_SAFE_WRAP (free, header);
+    ERRNO_SAFE_WRAP (free, file);
+    return -1;
+}
+
+/* Read the names in 'dir' into a buffer of NUL terminated strings.
+ */
+static char *dir_list (const char *dir, size_t *size)
+{
+    DIR *dirp;
+    struct dirent *dent;
+    char *buf = NULL;
+    size_t len = 0;
+
+    if (!(dirp = opendir (dir)))
+        return NULL;
+    while ((errno = 0, dent = readdir (dirp))) {
+        size_t n = strlen (dent->d_name) + 1;
+        char *new;
+
+        if (streq (dent->d_name, ".") || streq (dent->d_name, ".."))
+            continue;
+        if (!(new = realloc (buf, len + n)))
+            goto error;
+        buf = new;
+        memcpy (buf + len, dent->d_name, n);
+        len += n;
+    }
+    if (errno != 0)
+        goto error;
+    closedir (dirp);
+    /* An empty directory is a valid, empty listing.
+     */
+    if (!buf && !(buf = malloc (1)))
+        return NULL;
+    *size = len;
+    return buf;
+error:
+    ERRNO_SAFE_WRAP (closedir, dirp);
+    ERRNO_SAFE_WRAP (free, buf);
+    return NULL;
+}
+
+static int path_cmp (const void *a, const void *b)
+{
+    return strcoll (*(char **)a, *(char **)b);
+}
+
+/* Fill 'gl' with the paths in 'dir' whose names match 'pattern', sorted
+ * as glob(3) would.
+ */
+static int glob_names (const char *dir,
+                       const char *pattern,
+                       const char *names,
+                       size_t size,
+                       glob_t *gl)
+{
+    const char *name = names;
+    char **pathv = NULL;
+    size_t count = 0;
+
+    while (name < names + size) {
+        if (fnmatch (pattern, name, FNM_PERIOD) == 0) {
+            char **new;
+            if (!(new = realloc (pathv, (count + 2) * sizeof (*pathv))))
+                goto nospace;
+            pathv = new;
+            if (asprintf (&pathv[count], "%s/%s", dir, name) < 0)
+                goto nospace;
+            pathv[++count] = NULL;
+        }
+        name += strlen (name) + 1;
+    }
+    if (count == 0)
+        return GLOB_NOMATCH;
+    qsort (pathv, count, sizeof (*pathv), path_cmp);
+    gl->gl_pathc = count;
+    gl->gl_pathv = pathv;
+    return 0;
+nospace:
+    gl->gl_pathc = count;
+    gl->gl_pathv = pathv;
+    globfree (gl);
+    return GLOB_NOSPACE;
+}
+
+int shell_cache_glob (struct shell_cache *cache,
+                      const char *pattern,
+                      glob_t *gl)
+{
+    const char *slash;
+    char *dir = NULL;
+    char *names = NULL;
+    size_t size;
+    struct stat sb;
+    int rc;
+
+    memset (gl, 0, sizeof (*gl));
+
+    /* Only absolute patterns whose last component holds all of the
+     * wildcards are looked up in the cache.
+     */
+    if (!cache
+        || pattern[0] != '/'
+        || !(slash = strrchr (pattern, '/'))
+        || slash[1] == '\0'
+        || strchr (slash + 1, '\\')
+        || !(dir = strndup (pattern, slash - pattern))
+        || strpbrk (dir, "*?[\\")) {
+        free (dir);
+        return glob (pattern, GLOB_TILDE_CHECK, NULL, gl);
+    }
+    if (stat (*dir ? dir : "/", &sb) < 0 || !S_ISDIR (sb.st_mode)) {
+        free (dir);
+        return GLOB_NOMATCH;
+    }
+    if (!(names = shell_cache_read (cache, "dir", dir, &sb, &size))) {
+        if (!(names = dir_list (*dir ? dir : "/", &size))) {
+            free (dir);
+            return glob (pattern, GLOB_TILDE_CHECK, NULL, gl);
+        }
+        (void)shell_cache_write (cache, "dir", dir, &sb, names, size);
+    }
+    rc = glob_names (dir, slash + 1, names, size, gl);
+    free (names);
+    free (dir);
+    return rc;
+}
+
+/* vi: ts=4 sw=4 expandtab
+ */
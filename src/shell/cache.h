@@ -0,0 +1,64 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _SHELL_CACHE_H
+#define _SHELL_CACHE_H
+
+#include <sys/stat.h>
+#include <glob.h>
+
+/*  Node-local cache of data derived from shell startup files, such as
+ *   compiled initrc scripts and plugin directory listings, shared by all
+ *   shells run by the same user on a node.  Each entry is tagged with the
+ *   device, inode, size, and mtime of the file it was derived from, and
+ *   is ignored once the file changes.
+ */
+struct shell_cache;
+
+/*  Use 'dir' as the cache directory, creating it if necessary.
+ *   Fails with EPERM if 'dir' is not a directory owned by the caller
+ *   and writable only by the caller.
+ */
+struct shell_cache *shell_cache_create (const char *dir);
+
+void shell_cache_destroy (struct shell_cache *cache);
+
+/*  Return a copy of the data of 'type' cached for 'path', where 'sb'
+ *   is the result of stat(2) on 'path', or NULL if there is no valid
+ *   entry.  The caller must free the result.
+ */
+void *shell_cache_read (struct shell_cache *cache,
+                        const char *type,
+                        const char *path,
+                        const struct stat *sb,
+                        size_t *size);
+
+/*  Cache 'data' of 'type' for 'path', replacing any existing entry.
+ */
+int shell_cache_write (struct shell_cache *cache,
+                       const char *type,
+                       const char *path,
+                       const struct stat *sb,
+                       const void *data,
+                       size_t size);
+
+/*  Equivalent to glob (pattern, GLOB_TILDE_CHECK, NULL, gl), except that
+ *   if the directory part of 'pattern' contains no wildcards, its listing
+ *   is read from the cache if the directory has not changed.  The result
+ *   must be freed with globfree(3).  'cache' may be NULL.
+ */
+int shell_cache_glob (struct shell_cache *cache,
+                      const char *pattern,
+                      glob_t *gl);
+
+#endif /* !_SHELL_CACHE_H */
+
+/* vi: ts=4 sw=4 expandtab
+ */
@@ -27,6 +27,17 @@
  *   plugin hook, which allows the level of one or more logging
  *   plugins to be set independently of the main shell log
  *   facility level.
+ *
+ *  To keep a misbehaving plugin from flooding the KVS, messages are
+ *   rate limited with a token bucket (log.rate messages per second
+ *   with bursts of up to log.burst).  Messages over the limit are
+ *   dropped and counted, and a summary of the number suppressed is
+ *   logged once messages are allowed again.  FATAL messages are never
+ *   suppressed.
+ *
+ *  With log.aggregate, follower shells send their messages to the
+ *   leader after the init barrier, so that a single eventlogger
+ *   batches messages from all shells into the output eventlog.
  */
 #define FLUX_SHELL_PLUGIN_NAME "evlog"
 
@@ -38,25 +49,130 @@
 #include <flux/shell.h>
 
 #include "src/common/libeventlog/eventlogger.h"
+#include "src/common/libutil/monotime.h"
 #include "ccan/str/str.h"
 
 #include "info.h"
 #include "internal.h"
 #include "builtins.h"
 
+static const double default_rate = 100.;
+static const double default_burst = 1000.;
+
 struct evlog {
     int sync_mode;
     int level;
     flux_shell_t *shell;
     struct eventlogger *ev;
+
+    double rate;                // messages per second, 0 = unlimited
+    double burst;
+    double tokens;
+    struct timespec last;       // time tokens were last added
+    int suppressed;
+    flux_watcher_t *summary_w;
+
+    int aggregate;
+    bool forward;               // send messages to the leader shell
 };
 
+/*  Append a log message directly to the output eventlog.
+ */
+static int evlog_append (struct evlog *evlog, int level, const char *context)
+{
+    int flags = 0;
+
+    if (evlog->sync_mode || level == FLUX_SHELL_FATAL)
+        flags = EVENTLOGGER_FLAG_WAIT;
+    return eventlogger_append (evlog->ev, flags, "output", "log", context);
+}
+
+/*  Create the context of a log event for 'suppressed' messages on 'rank'.
+ */
+static char *summary_context (int rank, int suppressed)
+{
+    char msg[64];
+    json_t *o;
+    char *s = NULL;
+
+    snprintf (msg,
+              sizeof (msg),
+              "rate limit: %d messages suppressed",
+              suppressed);
+    if ((o = json_pack ("{s:i s:i s:s s:s}",
+                        "rank", rank,
+                        "level", FLUX_SHELL_WARN,
+                        "component", "evlog",
+                        "message", msg))) {
+        s = json_dumps (o, JSON_COMPACT);
+        json_decref (o);
+    }
+    return s;
+}
+
+/*  Log a summary of messages suppressed by the rate limit, if any.
+ */
+static void evlog_summary (struct evlog *evlog)
+{
+    char *context;
+    int rank = evlog->shell->info ? evlog->shell->info->shell_rank : -1;
+
+    if (evlog->suppressed == 0
+        || !(context = summary_context (rank, evlog->suppressed)))
+        return;
+    if (evlog_append (evlog, FLUX_SHELL_WARN, context) == 0)
+        evlog->suppressed = 0;
+    free (context);
+}
+
+/*  Return true if a message may be logged now, consuming a token.
+ */
+static bool evlog_ratelimit_ok (struct evlog *evlog)
+{
+    if (evlog->rate <= 0.)
+        return true;
+    evlog->tokens += evlog->rate * monotime_since (evlog->last) / 1000.;
+    if (evlog->tokens > evlog->burst)
+        evlog->tokens = evlog->burst;
+    monotime (&evlog->last);
+    if (evlog->tokens < 1.) {
+        if (evlog->suppressed++ == 0 && evlog->summary_w)
+            flux_watcher_start (evlog->summary_w);
+        return false;
+    }
+    evlog->tokens -= 1.;
+    return true;
+}
+
+/*  Once per second while messages are being suppressed, log a summary
+ *  if the rate limit allows.  Otherwise the summary is logged ahead of
+ *  the next message that gets through.
+ */
+static void summary_cb (flux_reactor_t *r,
+                        flux_watcher_t *w,
+                        int revents,
+                        void *arg)
+{
+    struct evlog *evlog = arg;
+    int suppressed = evlog->suppressed;
+
+    if (suppressed == 0)
+        return;
+    if (evlog_ratelimit_ok (evlog))
+        evlog_summary (evlog);
+    else
+        evlog->suppressed = suppressed; // don't count the summary itself
+    if (evlog->suppressed > 0) {
+        flux_timer_watcher_reset (w, 1., 0.);
+        flux_watcher_start (w);
+    }
+}
+
 static int log_eventlog (flux_plugin_t *p,
                          const char *topic,
                          flux_plugin_arg_t *args,
                          void *data)
 {
-    int flags = 0;
     int rc = 0;
     int level = -1;
     char *context = NULL;
@@ -69,20 +185,74 @@ static int log_eventlog (flux_plugin_t *p,
         return -1;
     if (level > evlog->level)
         return 0;
-    if (evlog->sync_mode || level == FLUX_SHELL_FATAL)
-        flags = EVENTLOGGER_FLAG_WAIT;
-    if (flux_plugin_arg_get (args, FLUX_PLUGIN_ARG_IN, &context) < 0
-        || eventlogger_append (evlog->ev, flags, "output", "log", context) < 0)
-        rc = -1;
+    if (level != FLUX_SHELL_FATAL && !evlog_ratelimit_ok (evlog))
+        return 0;
+    if (flux_plugin_arg_get (args, FLUX_PLUGIN_ARG_IN, &context) < 0)
+        return -1;
+    if (evlog->forward && !evlog->sync_mode && level != FLUX_SHELL_FATAL) {
+        flux_future_t *f;
+        if (!(f = flux_shell_rpc_pack (evlog->shell,
+                                       "log",
+                                       0,
+                                       FLUX_RPC_NORESPONSE,
+                                       "{s:i s:s}",
+                                       "suppressed", evlog->suppressed,
+                                       "context", context)))
+            rc = -1;
+        else
+            evlog->suppressed = 0;
+        flux_future_destroy (f);
+    }
+    else {
+        evlog_summary (evlog);
+        if (evlog_append (evlog, level, context) < 0)
+            rc = -1;
+    }
     free (context);
     return rc;
 }
 
+/*  Handle log messages forwarded from follower shells.  A follower's
+ *  suppressed message count is logged on its behalf.
+ */
+static void log_forward_cb (flux_t *h,
+                            flux_msg_handler_t *mh,
+                            const flux_msg_t *msg,
+                            void *arg)
+{
+    struct evlog *evlog = arg;
+    const char *context;
+    int suppressed;
+    int rank;
+    json_t *o;
+
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s:i s:s}",
+                             "suppressed", &suppressed,
+                             "context", &context) < 0)
+        return;
+    if (suppressed > 0
+        && (o = json_loads (context, 0, NULL))) {
+        char *s;
+        if (json_unpack (o, "{s:i}", "rank", &rank) == 0
+            && (s = summary_context (rank, suppressed))) {
+            (void)evlog_append (evlog, FLUX_SHELL_WARN, s);
+            free (s);
+        }
+        json_decref (o);
+    }
+    (void)evlog_append (evlog, FLUX_SHELL_NOTICE, context);
+}
+
 static void evlog_destroy (struct evlog *evlog)
 {
     /*  Redirect future logging to stderr */
     flux_shell_log_setlevel (evlog->level, "stderr");
 
+    evlog->sync_mode = 1;
+    evlog_summary (evlog);
+    flux_watcher_destroy (evlog->summary_w);
     eventlogger_flush (evlog->ev);
     eventlogger_destroy (evlog->ev);
     free (evlog);
@@ -152,6 +322,16 @@ static struct evlog *evlog_create (flux_shell_t *shell)
     eventlogger_set_commit_timeout (evlog->ev, 5.);
     evlog->level = FLUX_SHELL_NOTICE + shell->verbose;
     evlog->shell = shell;
+    evlog->rate = default_rate;
+    evlog->burst = default_burst;
+    evlog->tokens = default_burst;
+    monotime (&evlog->last);
+    if (!(evlog->summary_w = flux_timer_watcher_create (shell->r,
+                                                        1.,
+                                                        0.,
+                                                        summary_cb,
+                                                        evlog)))
+        goto err;
     return evlog;
 err:
     evlog_destroy (evlog);
@@ -194,6 +374,72 @@ static int evlog_shell_exit (flux_plugin_t *p,
      *   there will no longer be a reactor.
      */
     evlog->sync_mode = 1;
+    flux_watcher_stop (evlog->summary_w);
+    evlog_summary (evlog);
+    return 0;
+}
+
+/*  Once shell info is available, apply log.rate, log.burst, and
+ *   log.aggregate options.
+ */
+static int log_eventlog_init (flux_plugin_t *p,
+                              const char *topic,
+                              flux_plugin_arg_t *args,
+                              void *data)
+{
+    flux_shell_t *shell = flux_plugin_get_shell (p);
+    struct evlog *evlog;
+    double rate = default_rate;
+    double burst = default_burst;
+    int aggregate = 0;
+
+    if (!(evlog = flux_plugin_aux_get (p, "evlog")))
+        return 0;
+    if (flux_shell_getopt_unpack (shell,
+                                  "log",
+                                  "{s?F s?F s?i}",
+                                  "rate", &rate,
+                                  "burst", &burst,
+                                  "aggregate", &aggregate) < 0) {
+        shell_log_error ("error parsing log shell option");
+        return -1;
+    }
+    if (rate < 0. || burst < 1.) {
+        shell_log_error ("log.rate must be >= 0 and log.burst >= 1");
+        return -1;
+    }
+    evlog->rate = rate;
+    evlog->burst = burst;
+    if (evlog->tokens > burst)
+        evlog->tokens = burst;
+    evlog->aggregate = aggregate;
+    if (aggregate && shell->info->shell_rank == 0) {
+        if (flux_shell_service_register (shell,
+                                         "log",
+                                         log_forward_cb,
+                                         evlog) < 0) {
+            shell_log_errno ("error registering log service");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*  Start forwarding messages to the leader after the init barrier,
+ *   when the leader's log service is known to be registered.
+ */
+static int log_eventlog_post_init (flux_plugin_t *p,
+                                   const char *topic,
+                                   flux_plugin_arg_t *args,
+                                   void *data)
+{
+    flux_shell_t *shell = flux_plugin_get_shell (p);
+    struct evlog *evlog;
+
+    if ((evlog = flux_plugin_aux_get (p, "evlog"))
+        && evlog->aggregate
+        && shell->info->shell_rank > 0)
+        evlog->forward = true;
     return 0;
 }
 
@@ -236,6 +482,8 @@ struct shell_builtin builtin_log_eventlog = {
     .name = FLUX_SHELL_PLUGIN_NAME,
     .connect = log_eventlog_start,
     .reconnect = log_eventlog_reconnect,
+    .init = log_eventlog_init,
+    .post_init = log_eventlog_post_init,
 };
 
 /*
@@ -41,7 +41,9 @@ struct flux_shell {
     struct mustache_renderer *mr;
 
     struct plugstack *plugstack;
+    struct shell_cache *cache;
     struct shell_eventlogger *ev;
+    struct shell_timing *timing;
 
     zhashx_t *completion_refs;
 
@@ -49,6 +51,7 @@ struct flux_shell {
 
     int verbose;
     int nosetpgrp;
+    int vfork;
 
     struct aux_item *aux;
 };
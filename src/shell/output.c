@@ -36,6 +36,16 @@
  *   synchronously waited for to complete.
  * - The number of in-flight write requests on each shell is limited to
  *   shell_output_hwm, to avoid matchtag exhaustion, etc. for chatty tasks.
+ * - Follower shells accumulate output entries in a batch that is sent
+ *   to the leader in one RPC when output.forward-timeout expires or the
+ *   batch grows past shell_output_batch_max bytes.  If output.merge is
+ *   set, consecutive identical lines from different local tasks are
+ *   merged into one entry with an idset rank label.
+ * - Output to files is buffered per file, up to output.write-buffer
+ *   bytes, and written when the buffer fills, output.flush-interval
+ *   after the first buffered write, or when output is complete.
+ * - If a file path contains {{taskid}}, each shell writes the output of
+ *   its own tasks directly to one file per task, bypassing the leader.
  */
 #define FLUX_SHELL_PLUGIN_NAME "output"
 
@@ -47,6 +57,7 @@
 #include <jansson.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/uio.h>
 #include <flux/core.h>
 
 #include "src/common/libidset/idset.h"
@@ -54,6 +65,7 @@
 #include "src/common/libeventlog/eventlogger.h"
 #include "src/common/libioencode/ioencode.h"
 #include "src/common/libutil/parse_size.h"
+#include "src/common/libutil/hashmap.h"
 #include "ccan/str/str.h"
 
 #include "task.h"
@@ -72,6 +84,9 @@ enum {
 
 struct shell_output_fd {
     int fd;
+    char *buf;                  // output not yet written to fd
+    size_t len;
+    size_t size;
 };
 
 struct shell_output_type_file {
@@ -79,6 +94,8 @@ struct shell_output_type_file {
     char *path;
     int label;
     int flags;
+    bool per_task;              // path contains {{taskid}}
+    struct hashmap *task_fds;   // taskid => fdp, if per_task
 };
 
 struct shell_output {
@@ -101,10 +118,27 @@ struct shell_output {
     zhash_t *fds;
     const char *stdout_buffer_type;
     const char *stderr_buffer_type;
+    size_t write_buffer;
+    double flush_interval;
+    flux_watcher_t *flush_timer;
+    bool flush_armed;
+
+    /* follower only */
+    double forward_timeout;
+    bool merge;
+    json_t *batch;
+    size_t batch_bytes;
+    flux_watcher_t *batch_timer;
+    json_t *merge_context;      // last data entry in batch (borrowed)
+    struct idset *merge_ranks;
+    char *merge_data;
+    int merge_len;
 };
 
 static const int shell_output_lwm = 100;
 static const int shell_output_hwm = 1000;
+static const size_t shell_output_batch_max = 65536;
+static const size_t shell_output_write_buffer = 65536;
 
 /* Pause/resume output for all tasks.
  */
@@ -401,12 +435,103 @@ static int shell_output_write_fd (int fd, const void *buf, size_t len)
     return n;
 }
 
-static int shell_output_label (struct shell_output_type_file *ofp,
-                               const char *rank)
+static int shell_output_writev_fd (int fd, struct iovec *iov, int iovcnt)
 {
-    if (shell_output_write_fd (ofp->fdp->fd,  rank, strlen (rank)) < 0
-        || shell_output_write_fd (ofp->fdp->fd, ": ", 2) < 0)
+    while (iovcnt > 0) {
+        ssize_t n;
+        if ((n = writev (fd, iov, iovcnt)) < 0) {
+            if (errno != EINTR)
+                return -1;
+            continue;
+        }
+        while (iovcnt > 0 && n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (char *)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+    return 0;
+}
+
+static int shell_output_fd_flush (struct shell_output_fd *fdp)
+{
+    int rc = 0;
+
+    if (fdp && fdp->len > 0) {
+        if (shell_output_write_fd (fdp->fd, fdp->buf, fdp->len) < 0)
+            rc = -1;
+        fdp->len = 0;
+    }
+    return rc;
+}
+
+static void shell_output_flush_all (struct shell_output *out)
+{
+    struct shell_output_fd *fdp;
+
+    if (!out->fds)
+        return;
+    fdp = zhash_first (out->fds);
+    while (fdp) {
+        if (shell_output_fd_flush (fdp) < 0)
+            shell_log_errno ("error writing output file");
+        fdp = zhash_next (out->fds);
+    }
+}
+
+static void shell_output_flush_timer_cb (flux_reactor_t *r,
+                                         flux_watcher_t *w,
+                                         int revents,
+                                         void *arg)
+{
+    struct shell_output *out = arg;
+    out->flush_armed = false;
+    shell_output_flush_all (out);
+}
+
+/* Append an optionally labeled line of output to the file's buffer,
+ * first flushing the buffer if it is too full to hold it.  Output
+ * larger than the buffer is written directly with one writev(2).
+ */
+static int shell_output_fd_write (struct shell_output *out,
+                                  struct shell_output_fd *fdp,
+                                  const char *label,
+                                  const void *data,
+                                  size_t len)
+{
+    struct iovec iov[3];
+    int iovcnt = 0;
+    size_t total = 0;
+    int i;
+
+    if (label) {
+        iov[iovcnt].iov_base = (char *)label;
+        iov[iovcnt++].iov_len = strlen (label);
+        iov[iovcnt].iov_base = ": ";
+        iov[iovcnt++].iov_len = 2;
+    }
+    iov[iovcnt].iov_base = (void *)data;
+    iov[iovcnt++].iov_len = len;
+    for (i = 0; i < iovcnt; i++)
+        total += iov[i].iov_len;
+
+    if (fdp->len + total > fdp->size && shell_output_fd_flush (fdp) < 0)
         return -1;
+    if (total > fdp->size)
+        return shell_output_writev_fd (fdp->fd, iov, iovcnt);
+    for (i = 0; i < iovcnt; i++) {
+        memcpy (fdp->buf + fdp->len, iov[i].iov_base, iov[i].iov_len);
+        fdp->len += iov[i].iov_len;
+    }
+    if (!out->flush_armed) {
+        flux_timer_watcher_reset (out->flush_timer, out->flush_interval, 0.);
+        flux_watcher_start (out->flush_timer);
+        out->flush_armed = true;
+    }
     return 0;
 }
 
@@ -433,10 +558,11 @@ static int shell_output_data (struct shell_output *out, json_t *context)
         ofp = &out->stderr_file;
     }
     if ((output_type == FLUX_OUTPUT_TYPE_FILE) && len > 0) {
-        if (ofp->label
-            && shell_output_label (ofp, rank) < 0)
-            goto out;
-        if (shell_output_write_fd (ofp->fdp->fd, data, len) < 0)
+        if (shell_output_fd_write (out,
+                                   ofp->fdp,
+                                   ofp->label ? rank : NULL,
+                                   data,
+                                   len) < 0)
             goto out;
     }
     rc = 0;
@@ -477,6 +603,11 @@ static void shell_output_log (struct shell_output *out, json_t *context)
          */
         return;
     }
+    /*  Log messages are rare, so write them directly after any
+     *   buffered output, rather than buffering them too.
+     */
+    if (shell_output_fd_flush (out->stderr_file.fdp) < 0)
+        return;
     dprintf (fd, "flux-shell");
     if (rank >= 0)
         dprintf (fd, "[%d]", rank);
@@ -520,6 +651,8 @@ static void shell_output_decref (struct shell_output *out,
         if (flux_shell_remove_completion_ref (out->shell, "output.write") < 0)
             shell_log_errno ("flux_shell_remove_completion_ref");
 
+        shell_output_flush_all (out);
+
         /* no more output is coming, flush the last batch of output */
         if ((out->stdout_type == FLUX_OUTPUT_TYPE_KVS
             || (out->stderr_type == FLUX_OUTPUT_TYPE_KVS))) {
@@ -538,25 +671,12 @@ static void shell_output_decref_shell_rank (struct shell_output *out,
         shell_output_decref (out, mh);
 }
 
-static int shell_output_write_leader (struct shell_output *out,
-                                      const char *type,
-                                      int shell_rank,
-                                      json_t *o,
-                                      flux_msg_handler_t *mh) // may be NULL
+/* Dispose of accumulated output entries on the leader.
+ */
+static int shell_output_process (struct shell_output *out)
 {
-    json_t *entry;
-
-    if (streq (type, "eof")) {
-        shell_output_decref_shell_rank (out, shell_rank, mh);
+    if (json_array_size (out->output) == 0)
         return 0;
-    }
-    if (!(entry = eventlog_entry_pack (0., type, "O", o))) // increfs 'o'
-        goto error;
-    if (json_array_append_new (out->output, entry) < 0) {
-        json_decref (entry);
-        errno = ENOMEM;
-        goto error;
-    }
     /* Error failing to commit is a fatal error.  Should be cleaner in
      * future. Issue #2378 */
     if ((out->stdout_type == FLUX_OUTPUT_TYPE_TERM
@@ -576,11 +696,75 @@ static int shell_output_write_leader (struct shell_output *out,
     }
     if (json_array_clear (out->output) < 0) {
         shell_log_error ("json_array_clear failed");
-        goto error;
+        return -1;
+    }
+    return 0;
+}
+
+static int shell_output_append_leader (struct shell_output *out,
+                                       const char *type,
+                                       int shell_rank,
+                                       json_t *o,
+                                       flux_msg_handler_t *mh) // may be NULL
+{
+    json_t *entry;
+
+    if (streq (type, "eof")) {
+        if (shell_output_process (out) < 0)
+            return -1;
+        shell_output_decref_shell_rank (out, shell_rank, mh);
+        return 0;
+    }
+    if (!(entry = eventlog_entry_pack (0., type, "O", o))) // increfs 'o'
+        return -1;
+    if (json_array_append_new (out->output, entry) < 0) {
+        json_decref (entry);
+        errno = ENOMEM;
+        return -1;
     }
     return 0;
-error:
-    return -1;
+}
+
+static int shell_output_write_leader (struct shell_output *out,
+                                      const char *type,
+                                      int shell_rank,
+                                      json_t *o,
+                                      flux_msg_handler_t *mh) // may be NULL
+{
+    if (shell_output_append_leader (out, type, shell_rank, o, mh) < 0
+        || shell_output_process (out) < 0)
+        return -1;
+    return 0;
+}
+
+/* A "batch" write carries an array of {name, context} entries from
+ * one follower, which are appended in order and processed together.
+ */
+static int shell_output_write_batch (struct shell_output *out,
+                                     int shell_rank,
+                                     json_t *batch,
+                                     flux_msg_handler_t *mh)
+{
+    json_t *entry;
+    size_t index;
+
+    if (!json_is_array (batch)) {
+        errno = EPROTO;
+        return -1;
+    }
+    json_array_foreach (batch, index, entry) {
+        const char *type;
+        json_t *o;
+
+        if (json_unpack (entry, "{s:s s:o}", "name", &type, "context", &o) < 0
+            || streq (type, "batch")) {
+            errno = EPROTO;
+            return -1;
+        }
+        if (shell_output_append_leader (out, type, shell_rank, o, mh) < 0)
+            return -1;
+    }
+    return shell_output_process (out);
 }
 
 /* Convert 'iodecode' object to an valid RFC 24 data event.
@@ -603,7 +787,11 @@ static void shell_output_write_cb (flux_t *h,
                              "shell_rank", &shell_rank,
                              "context", &o) < 0)
         goto error;
-    if (shell_output_write_leader (out, type, shell_rank, o, mh) < 0)
+    if (streq (type, "batch")) {
+        if (shell_output_write_batch (out, shell_rank, o, mh) < 0)
+            goto error;
+    }
+    else if (shell_output_write_leader (out, type, shell_rank, o, mh) < 0)
         goto error;
     if (flux_respond (out->shell->h, msg, NULL) < 0)
         shell_log_errno ("flux_respond");
@@ -626,11 +814,93 @@ static void shell_output_write_completion (flux_future_t *f, void *arg)
         shell_output_control (out, false);
 }
 
+static int shell_output_send (struct shell_output *out,
+                              const char *type,
+                              json_t *context)
+{
+    flux_future_t *f = NULL;
+
+    if (!(f = flux_shell_rpc_pack (out->shell,
+                                   "write",
+                                    0,
+                                    0,
+                                    "{s:s s:i s:O}",
+                                    "name", type,
+                                    "shell_rank", out->shell->info->shell_rank,
+                                    "context", context)))
+        goto error;
+    if (flux_future_then (f, -1, shell_output_write_completion, out) < 0)
+        goto error;
+    if (zlist_append (out->pending_writes, f) < 0)
+        shell_log_error ("zlist_append failed");
+    if (zlist_size (out->pending_writes) >= shell_output_hwm)
+        shell_output_control (out, true);
+    return 0;
+error:
+    flux_future_destroy (f);
+    return -1;
+}
+
+static void shell_output_merge_reset (struct shell_output *out)
+{
+    out->merge_context = NULL;
+    free (out->merge_data);
+    out->merge_data = NULL;
+    out->merge_len = 0;
+    if (out->merge_ranks && !idset_empty (out->merge_ranks))
+        (void)idset_range_clear (out->merge_ranks,
+                                 idset_first (out->merge_ranks),
+                                 idset_last (out->merge_ranks));
+}
+
+static void shell_output_batch_flush (struct shell_output *out)
+{
+    if (json_array_size (out->batch) == 0)
+        return;
+    flux_watcher_stop (out->batch_timer);
+    shell_output_merge_reset (out);
+    if (shell_output_send (out, "batch", out->batch) < 0)
+        shell_log_errno ("shell.write: batch");
+    if (json_array_clear (out->batch) < 0)
+        shell_log_error ("json_array_clear failed");
+    out->batch_bytes = 0;
+}
+
+static void shell_output_batch_timer_cb (flux_reactor_t *r,
+                                         flux_watcher_t *w,
+                                         int revents,
+                                         void *arg)
+{
+    struct shell_output *out = arg;
+    shell_output_batch_flush (out);
+}
+
+static int shell_output_batch_append (struct shell_output *out,
+                                      const char *type,
+                                      json_t *context,
+                                      size_t len)
+{
+    json_t *entry;
+
+    if (!(entry = json_pack ("{s:s s:O}", "name", type, "context", context))
+        || json_array_append_new (out->batch, entry) < 0) {
+        errno = ENOMEM;
+        return -1;
+    }
+    if (json_array_size (out->batch) == 1) {
+        flux_timer_watcher_reset (out->batch_timer, out->forward_timeout, 0.);
+        flux_watcher_start (out->batch_timer);
+    }
+    out->batch_bytes += len;
+    if (out->batch_bytes >= shell_output_batch_max)
+        shell_output_batch_flush (out);
+    return 0;
+}
+
 static int shell_output_write_type (struct shell_output *out,
                                     char *type,
                                     json_t *context)
 {
-    flux_future_t *f = NULL;
     int shell_rank = out->shell->info->shell_rank;
 
     if (shell_rank == 0) {
@@ -638,26 +908,95 @@ static int shell_output_write_type (struct shell_output *out,
             shell_log_errno ("shell_output_write_leader");
     }
     else {
-        if (!(f = flux_shell_rpc_pack (out->shell,
-                                       "write",
-                                        0,
-                                        0,
-                                        "{s:s s:i s:O}",
-                                        "name", type,
-                                        "shell_rank", shell_rank,
-                                        "context", context)))
-            goto error;
-        if (flux_future_then (f, -1, shell_output_write_completion, out) < 0)
-            goto error;
-        if (zlist_append (out->pending_writes, f) < 0)
-            shell_log_error ("zlist_append failed");
-        if (zlist_size (out->pending_writes) >= shell_output_hwm)
-            shell_output_control (out, true);
+        shell_output_merge_reset (out);
+        if (shell_output_batch_append (out, type, context, 0) < 0)
+            return -1;
     }
     return 0;
-error:
-    flux_future_destroy (f);
-    return -1;
+}
+
+/* If 'data' repeats the last data entry in the batch for another task,
+ * add 'rank' to that entry's rank label instead of appending a new one.
+ * Only the last entry is considered so per-task ordering is preserved.
+ */
+static bool shell_output_merge (struct shell_output *out,
+                                int rank,
+                                const char *stream,
+                                const char *data,
+                                int len)
+{
+    json_t *o = out->merge_context;
+    const char *s;
+    char *ranks;
+    int rc;
+
+    if (!o
+        || out->merge_len != len
+        || memcmp (out->merge_data, data, len) != 0
+        || json_unpack (o, "{s:s}", "stream", &s) < 0
+        || !streq (s, stream)
+        || idset_test (out->merge_ranks, rank))
+        return false;
+    if (idset_set (out->merge_ranks, rank) < 0
+        || !(ranks = idset_encode (out->merge_ranks,
+                                   IDSET_FLAG_BRACKETS | IDSET_FLAG_RANGE))) {
+        shell_output_merge_reset (out);
+        return false;
+    }
+    rc = json_object_set_new (o, "rank", json_string (ranks));
+    free (ranks);
+    if (rc < 0) {
+        shell_output_merge_reset (out);
+        return false;
+    }
+    return true;
+}
+
+/* Remember the data entry just appended to the batch as a merge target.
+ */
+static void shell_output_merge_start (struct shell_output *out,
+                                      int rank,
+                                      json_t *o,
+                                      const char *data,
+                                      int len)
+{
+    if (!out->merge_ranks
+        && !(out->merge_ranks = idset_create (0, IDSET_FLAG_AUTOGROW)))
+        return;
+    if (!(out->merge_data = malloc (len))
+        || idset_set (out->merge_ranks, rank) < 0) {
+        shell_output_merge_reset (out);
+        return;
+    }
+    memcpy (out->merge_data, data, len);
+    out->merge_len = len;
+    out->merge_context = o;
+}
+
+/* Write task output directly to the task's own output file.
+ * The file is closed when the shell exits, so EOF is ignored.
+ */
+static int shell_output_task_file_write (struct shell_output *out,
+                                         struct shell_output_type_file *ofp,
+                                         int rank,
+                                         const char *data,
+                                         int len)
+{
+    struct shell_output_fd *fdp;
+    char rankstr[13];
+
+    if (len == 0)
+        return 0;
+    if (!(fdp = hashmap_lookup (ofp->task_fds, &rank))) {
+        errno = ENOENT;
+        return -1;
+    }
+    (void) snprintf (rankstr, sizeof (rankstr), "%d", rank);
+    return shell_output_fd_write (out,
+                                  fdp,
+                                  ofp->label ? rankstr : NULL,
+                                  data,
+                                  len);
 }
 
 static int shell_output_write (struct shell_output *out,
@@ -670,6 +1009,15 @@ static int shell_output_write (struct shell_output *out,
     int rc;
     json_t *o = NULL;
     char rankstr[13];
+    bool mergeable = out->merge && out->batch && !eof && len > 0;
+    struct shell_output_type_file *ofp = streq (stream, "stdout")
+                                         ? &out->stdout_file
+                                         : &out->stderr_file;
+
+    if (ofp->per_task)
+        return shell_output_task_file_write (out, ofp, rank, data, len);
+    if (mergeable && shell_output_merge (out, rank, stream, data, len))
+        return 0;
 
     /* integer %d guaranteed to fit in 13 bytes
      */
@@ -678,7 +1026,15 @@ static int shell_output_write (struct shell_output *out,
         shell_log_errno ("ioencode");
         return -1;
     }
-    rc = shell_output_write_type (out, "data", o);
+    if (!out->batch)
+        rc = shell_output_write_type (out, "data", o);
+    else {
+        shell_output_merge_reset (out);
+        if ((rc = shell_output_batch_append (out, "data", o, len)) == 0
+            && mergeable
+            && json_array_size (out->batch) > 0)
+            shell_output_merge_start (out, rank, o, data, len);
+    }
     json_decref (o);
     return rc;
 }
@@ -709,6 +1065,7 @@ static void shell_output_type_file_cleanup (struct shell_output_type_file *ofp)
 {
     if (ofp->path)
         free (ofp->path);
+    hashmap_destroy (ofp->task_fds);
 }
 
 void shell_output_destroy (struct shell_output *out)
@@ -718,6 +1075,13 @@ void shell_output_destroy (struct shell_output *out)
         int saved_errno = errno;
         flux_future_t *f = NULL;
 
+        if (out->batch) {
+            shell_output_batch_flush (out);
+            flux_watcher_destroy (out->batch_timer);
+            shell_output_merge_reset (out);
+            idset_destroy (out->merge_ranks);
+            json_decref (out->batch);
+        }
         if (shell_rank != 0) {
             /* Nonzero shell rank: send EOF to leader shell to notify
              *  that no more messages will be sent to shell.write
@@ -764,14 +1128,8 @@ void shell_output_destroy (struct shell_output *out)
         json_decref (out->output);
         shell_output_type_file_cleanup (&out->stdout_file);
         shell_output_type_file_cleanup (&out->stderr_file);
-        if (out->fds) { // leader only
-            struct shell_output_fd *fdp = zhash_first (out->fds);
-            while (fdp) {
-                close (fdp->fd);
-                fdp = zhash_next (out->fds);
-            }
-            zhash_destroy (&out->fds);
-        }
+        flux_watcher_destroy (out->flush_timer);
+        zhash_destroy (&out->fds); // flushes and closes files
         eventlogger_destroy (out->ev);
         idset_destroy (out->active_shells);
         free (out);
@@ -835,14 +1193,18 @@ shell_output_setup_type_file (struct shell_output *out,
         return -1;
     }
 
+    /* {{taskid}} is left in place here, to be rendered for each task.
+     */
     if (!(ofp->path = flux_shell_mustache_render (out->shell, path)))
         return -1;
+    ofp->per_task = strstr (ofp->path, "{{taskid}}") != NULL;
 
     if (ofp_copy) {
         if (!(ofp_copy->path = strdup (ofp->path)))
             return -1;
         ofp_copy->label = ofp->label;
         ofp_copy->flags = ofp->flags;
+        ofp_copy->per_task = ofp->per_task;
     }
 
     return 0;
@@ -970,11 +1332,16 @@ static int shell_output_check_alternate_buffer_type (struct shell_output *out)
     return 0;
 }
 
-static struct shell_output_fd *shell_output_fd_create (int fd)
+static struct shell_output_fd *shell_output_fd_create (int fd, size_t size)
 {
     struct shell_output_fd *fdp = calloc (1, sizeof (*fdp));
     if (!fdp)
         return NULL;
+    if (size > 0 && !(fdp->buf = malloc (size))) {
+        free (fdp);
+        return NULL;
+    }
+    fdp->size = size;
     fdp->fd = fd;
     return fdp;
 }
@@ -983,45 +1350,76 @@ static void shell_output_fd_destroy (void *data)
 {
     struct shell_output_fd *fdp = data;
     if (fdp) {
+        if (shell_output_fd_flush (fdp) < 0)
+            shell_log_errno ("error writing output file");
         close (fdp->fd);
+        free (fdp->buf);
         free (fdp);
     }
 }
 
-static int shell_output_type_file_setup (struct shell_output *out,
-                                         struct shell_output_type_file *ofp)
+static struct shell_output_fd *shell_output_fd_open (struct shell_output *out,
+                                                     const char *path,
+                                                     int flags)
 {
     mode_t mode = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
     struct shell_output_fd *fdp = NULL;
     int saved_errno, fd = -1;
 
     /* check if we're outputting to the same file as another stream */
-    if ((fdp = zhash_lookup (out->fds, ofp->path))) {
-        ofp->fdp = fdp;
-        return 0;
-    }
+    if ((fdp = zhash_lookup (out->fds, path)))
+        return fdp;
 
-    if ((fd = open (ofp->path, ofp->flags, mode)) < 0) {
-        shell_log_errno ("error opening output file '%s'", ofp->path);
+    if ((fd = open (path, flags, mode)) < 0) {
+        shell_log_errno ("error opening output file '%s'", path);
         goto error;
     }
 
-    if (!(fdp = shell_output_fd_create (fd)))
+    if (!(fdp = shell_output_fd_create (fd, out->write_buffer)))
         goto error;
+    fd = -1;
 
-    if (zhash_insert (out->fds, ofp->path, fdp) < 0) {
+    if (zhash_insert (out->fds, path, fdp) < 0) {
         errno = EEXIST;
         goto error;
     }
-    zhash_freefn (out->fds, ofp->path, shell_output_fd_destroy);
-    ofp->fdp = fdp;
-    return 0;
+    zhash_freefn (out->fds, path, shell_output_fd_destroy);
+    return fdp;
 
 error:
     saved_errno = errno;
+    if (fd >= 0)
+        close (fd);
     shell_output_fd_destroy (fdp);
     errno = saved_errno;
-    return -1;
+    return NULL;
+}
+
+static int shell_output_type_file_setup (struct shell_output *out,
+                                         struct shell_output_type_file *ofp)
+{
+    if (!(ofp->fdp = shell_output_fd_open (out, ofp->path, ofp->flags)))
+        return -1;
+    return 0;
+}
+
+/* Open the output file for task 'taskid', rendering {{taskid}} in the
+ * path in the context of the current task.
+ */
+static int shell_output_task_file_setup (struct shell_output *out,
+                                         struct shell_output_type_file *ofp,
+                                         int taskid)
+{
+    struct shell_output_fd *fdp;
+    char *path;
+
+    if (!(path = flux_shell_mustache_render (out->shell, ofp->path)))
+        return -1;
+    fdp = shell_output_fd_open (out, path, ofp->flags);
+    free (path);
+    if (!fdp || hashmap_insert (ofp->task_fds, &taskid, fdp) < 0)
+        return -1;
+    return 0;
 }
 
 /* Write RFC 24 header event to KVS.  Assume:
@@ -1209,6 +1607,93 @@ static int get_output_limit (struct shell_output *out)
     return 0;
 }
 
+static int shell_output_file_init (struct shell_output *out)
+{
+    json_t *val = NULL;
+    const char *s;
+    uint64_t size;
+
+    /* Unbuffered stdout (e.g. flux run -u) implies unbuffered files.
+     */
+    if (!strcasecmp (out->stdout_buffer_type, "none"))
+        out->write_buffer = 0;
+    else
+        out->write_buffer = shell_output_write_buffer;
+    out->flush_interval = 0.1;
+    if (flux_shell_getopt_unpack (out->shell,
+                                  "output",
+                                  "{s?o s?F}",
+                                  "write-buffer", &val,
+                                  "flush-interval", &out->flush_interval) < 0
+        || out->flush_interval < 0.) {
+        shell_log_error ("invalid output.flush-interval");
+        return -1;
+    }
+    if (val) {
+        if (json_is_integer (val) && json_integer_value (val) >= 0)
+            out->write_buffer = json_integer_value (val);
+        else if ((s = json_string_value (val)) && parse_size (s, &size) == 0)
+            out->write_buffer = size;
+        else {
+            shell_log_error ("invalid output.write-buffer");
+            errno = EINVAL;
+            return -1;
+        }
+    }
+    if (!(out->fds = zhash_new ())) {
+        errno = ENOMEM;
+        return -1;
+    }
+    if ((out->stdout_file.per_task
+         && !(out->stdout_file.task_fds = hashmap_create (sizeof (int),
+                                                          NULL,
+                                                          NULL)))
+        || (out->stderr_file.per_task
+            && !(out->stderr_file.task_fds = hashmap_create (sizeof (int),
+                                                             NULL,
+                                                             NULL))))
+        return -1;
+    out->flush_timer = flux_timer_watcher_create (out->shell->r,
+                                                  out->flush_interval,
+                                                  0.,
+                                                  shell_output_flush_timer_cb,
+                                                  out);
+    if (!out->flush_timer)
+        return -1;
+    return 0;
+}
+
+static int shell_output_batch_init (struct shell_output *out)
+{
+    json_t *merge = NULL;
+
+    out->forward_timeout = 0.01;
+    if (flux_shell_getopt_unpack (out->shell,
+                                  "output",
+                                  "{s?F s?o}",
+                                  "forward-timeout", &out->forward_timeout,
+                                  "merge", &merge) < 0
+        || out->forward_timeout < 0.) {
+        shell_log_error ("invalid output.forward-timeout");
+        return -1;
+    }
+    /* -o output.merge sets the option to integer 1 */
+    out->merge = json_is_true (merge)
+                 || (json_is_integer (merge) && json_integer_value (merge));
+    if (!(out->batch = json_array ())) {
+        errno = ENOMEM;
+        return -1;
+    }
+    out->batch_timer = flux_timer_watcher_create (out->shell->r,
+                                                  out->forward_timeout,
+                                                  0.,
+                                                  shell_output_batch_timer_cb,
+                                                  out);
+    if (!out->batch_timer)
+        return -1;
+    return 0;
+}
+
 struct shell_output *shell_output_create (flux_shell_t *shell)
 {
     struct shell_output *out;
@@ -1227,10 +1712,19 @@ struct shell_output *shell_output_create (flux_shell_t *shell)
         goto error;
     if (shell_output_check_alternate_buffer_type (out) < 0)
         goto error;
+    if (out->stdout_type == FLUX_OUTPUT_TYPE_FILE
+        || out->stderr_type == FLUX_OUTPUT_TYPE_FILE) {
+        if (shell_output_file_init (out) < 0)
+            goto error;
+    }
 
     if (!(out->pending_writes = zlist_new ()))
         goto error;
-    if (shell->info->shell_rank == 0) {
+    if (shell->info->shell_rank != 0) {
+        if (shell_output_batch_init (out) < 0)
+            goto error;
+    }
+    else {
         int ntasks = out->shell->info->rankinfo.ntasks;
         if (output_type_requires_service (out->stdout_type)
             || output_type_requires_service (out->stderr_type)) {
@@ -1267,21 +1761,14 @@ struct shell_output *shell_output_create (flux_shell_t *shell)
             }
         }
         if (out->stdout_type == FLUX_OUTPUT_TYPE_FILE
-            || out->stderr_type == FLUX_OUTPUT_TYPE_FILE) {
-            if (!(out->fds = zhash_new ())) {
-                errno = ENOMEM;
+            && !out->stdout_file.per_task) {
+            if (shell_output_type_file_setup (out, &(out->stdout_file)) < 0)
+                goto error;
+        }
+        if (out->stderr_type == FLUX_OUTPUT_TYPE_FILE
+            && !out->stderr_file.per_task) {
+            if (shell_output_type_file_setup (out, &(out->stderr_file)) < 0)
                 goto error;
-            }
-            if (out->stdout_type == FLUX_OUTPUT_TYPE_FILE) {
-                if (shell_output_type_file_setup (out,
-                                                  &(out->stdout_file)) < 0)
-                    goto error;
-            }
-            if (out->stderr_type == FLUX_OUTPUT_TYPE_FILE) {
-                if (shell_output_type_file_setup (out,
-                                                  &(out->stderr_file)) < 0)
-                    goto error;
-            }
         }
         if (output_eventlogger_start (out) < 0)
             goto error;
@@ -1419,6 +1906,16 @@ static int shell_output_task_init (flux_plugin_t *p,
                                                output_cb, out) < 0)
             return -1;
     }
+    if (out->stdout_file.per_task
+        && shell_output_task_file_setup (out,
+                                         &out->stdout_file,
+                                         task->rank) < 0)
+        return -1;
+    if (out->stderr_file.per_task
+        && shell_output_task_file_setup (out,
+                                         &out->stderr_file,
+                                         task->rank) < 0)
+        return -1;
 
     return 0;
 }
@@ -1463,7 +1960,8 @@ static int shell_output_init (flux_plugin_t *p,
     /*  If stderr is redirected to file, be sure to also copy log messages
      *   there as soon as file is opened
      */
-    if (out->stderr_type == FLUX_OUTPUT_TYPE_FILE) {
+    if (out->stderr_type == FLUX_OUTPUT_TYPE_FILE
+        && !out->stderr_file.per_task) {
         shell_debug ("redirecting log messages to job output file");
         if (flux_plugin_add_handler (p, "shell.log", log_output, out) < 0)
             return shell_log_errno ("failed to add shell.log handler");
@@ -23,8 +23,10 @@
 
 #include "src/common/libczmqcontainers/czmq_containers.h"
 #include "src/common/libutil/iterators.h"
+#include "src/common/libutil/monotime.h"
 
 #include "plugstack.h"
+#include "cache.h"
 
 #ifdef PLUGSTACK_STANDALONE
 #undef  shell_log_error
@@ -35,9 +37,12 @@
 
 struct plugstack {
     char *searchpath;   /* If set, search path for plugstack_load()        */
+    struct shell_cache *cache; /* If set, cache of plugin directory lists  */
     zhashx_t *aux;      /* aux items to propagate to loaded plugins        */
     zlistx_t *plugins;  /* Ordered list of loaded plugins                  */
     zhashx_t *names;    /* Hash for lookup of plugins by name              */
+    plugstack_timer_f timer_cb; /* If set, called after each callback      */
+    void *timer_arg;
 };
 
 void plugstack_unload_name (struct plugstack *st, const char *name)
@@ -62,6 +67,12 @@ int plugstack_set_searchpath (struct plugstack *st, const char *path)
     return 0;
 }
 
+void plugstack_set_cache (struct plugstack *st, struct shell_cache *cache)
+{
+    if (st)
+        st->cache = cache;
+}
+
 const char *plugstack_get_searchpath (struct plugstack *st)
 {
     if (!st) {
@@ -164,18 +175,36 @@ int plugstack_call (struct plugstack *st,
 
     p = zlistx_first (l);
     while (p) {
-        if (flux_plugin_call (p, name, args) < 0) {
+        struct timespec t0;
+        int result;
+
+        if (st->timer_cb)
+            monotime (&t0);
+        if ((result = flux_plugin_call (p, name, args)) < 0) {
             shell_log_error ("plugin '%s': %s failed",
                              flux_plugin_get_name (p),
                              name);
             rc = -1;
         }
+        if (st->timer_cb && result != 0)
+            st->timer_cb (name,
+                          flux_plugin_get_name (p),
+                          monotime_since (t0) / 1000.,
+                          st->timer_arg);
         p = zlistx_next (l);
     }
     zlistx_destroy (&l);
     return rc;
 }
 
+void plugstack_set_timer (struct plugstack *st,
+                          plugstack_timer_f cb,
+                          void *arg)
+{
+    st->timer_cb = cb;
+    st->timer_arg = arg;
+}
+
 static int plugin_aux_from_zhashx (flux_plugin_t *p, zhashx_t *aux)
 {
     const char *key;
@@ -234,7 +263,7 @@ static int plugstack_glob (struct plugstack *st,
     glob_t gl;
     int rc = -1;
 
-    rc = glob (pattern, GLOB_TILDE_CHECK, NULL, &gl);
+    rc = shell_cache_glob (st->cache, pattern, &gl);
     switch (rc) {
         case 0:
             rc = load_from_glob (st, &gl, conf);
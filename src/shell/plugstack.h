@@ -32,6 +32,12 @@ int plugstack_push (struct plugstack *st, flux_plugin_t *p);
  */
 int plugstack_set_searchpath (struct plugstack *st, const char *searchpath);
 
+/*  Use 'cache' to look up directory listings when loading plugins.
+ *   The cache is not owned by the plugstack.
+ */
+struct shell_cache;
+void plugstack_set_cache (struct plugstack *st, struct shell_cache *cache);
+
 /*  Get current plugstack searchpath
  */
 const char *plugstack_get_searchpath (struct plugstack *st);
@@ -61,6 +67,18 @@ int plugstack_call (struct plugstack *st,
                     const char *name,
                     flux_plugin_arg_t *args);
 
+/*  Set a function to be called with the elapsed time in seconds of each
+ *   plugin callback made by plugstack_call().
+ */
+typedef void (*plugstack_timer_f) (const char *name,
+                                   const char *plugin,
+                                   double seconds,
+                                   void *arg);
+
+void plugstack_set_timer (struct plugstack *st,
+                          plugstack_timer_f cb,
+                          void *arg);
+
 #endif /* !_SHELL_PLUGSTACK_H */
 
 /* vi: ts=4 sw=4 expandtab
@@ -0,0 +1,318 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* kvs_codec.c - compact encoding of PMI KVS dicts
+ *
+ * PMI business card keys are typically a common string plus a rank,
+ * e.g. "mpi-bc-1234", so sorting the keys and dropping the prefix each
+ * shares with its predecessor removes most of their bulk, and LZ4 takes
+ * care of repetition in the values.  See kvs_codec.h for the format.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <lz4.h>
+#include <jansson.h>
+
+#include "src/common/libutil/b64.h"
+#include "src/common/libutil/errno_safe.h"
+#include "ccan/str/str.h"
+
+#include "kvs_codec.h"
+
+struct buf {
+    char *data;
+    size_t len;
+    size_t size;
+};
+
+static int buf_reserve (struct buf *b, size_t len)
+{
+    if (b->size - b->len < len) {
+        size_t size = b->size ? b->size : 4096;
+        char *data;
+
+        while (size - b->len < len)
+            size *= 2;
+        if (!(data = realloc (b->data, size))) {
+            errno = ENOMEM;
+            return -1;
+        }
+        b->data = data;
+        b->size = size;
+    }
+    return 0;
+}
+
+static int buf_put_varint (struct buf *b, size_t val)
+{
+    if (buf_reserve (b, 10) < 0)
+        return -1;
+    while (val >= 0x80) {
+        b->data[b->len++] = (val & 0x7f) | 0x80;
+        val >>= 7;
+    }
+    b->data[b->len++] = val;
+    return 0;
+}
+
+static int buf_put_bytes (struct buf *b, const char *data, size_t len)
+{
+    if (buf_put_varint (b, len) < 0 || buf_reserve (b, len) < 0)
+        return -1;
+    memcpy (b->data + b->len, data, len);
+    b->len += len;
+    return 0;
+}
+
+static int get_varint (const char **pp, const char *end, size_t *valp)
+{
+    const unsigned char *p = (const unsigned char *)*pp;
+    size_t val = 0;
+    int shift = 0;
+
+    do {
+        if ((const char *)p == end || shift > 56)
+            return -1;
+        val |= (size_t)(*p & 0x7f) << shift;
+        shift += 7;
+    } while (*p++ & 0x80);
+    *pp = (const char *)p;
+    *valp = val;
+    return 0;
+}
+
+static int get_bytes (const char **pp,
+                      const char *end,
+                      const char **datap,
+                      size_t *lenp)
+{
+    size_t len;
+
+    if (get_varint (pp, end, &len) < 0 || end - *pp < len)
+        return -1;
+    *datap = *pp;
+    *lenp = len;
+    *pp += len;
+    return 0;
+}
+
+static int compare_keys (const void *a, const void *b)
+{
+    return strcmp (*(const char **)a, *(const char **)b);
+}
+
+/* Serialize the entries of 'dict' into 'b', in the uncompressed format.
+ */
+static int pack_dict (json_t *dict, struct buf *b)
+{
+    size_t count = json_object_size (dict);
+    const char **keys;
+    const char *key;
+    json_t *val;
+    const char *prev = "";
+    size_t i = 0;
+    int rc = -1;
+
+    if (!(keys = calloc (count ? count : 1, sizeof (keys[0]))))
+        return -1;
+    json_object_foreach (dict, key, val) {
+        if (!json_is_string (val)) {
+            errno = EINVAL;
+            goto done;
+        }
+        keys[i++] = key;
+    }
+    qsort (keys, count, sizeof (keys[0]), compare_keys);
+    if (buf_put_varint (b, count) < 0)
+        goto done;
+    for (i = 0; i < count; i++) {
+        size_t prefix = 0;
+
+        while (prev[prefix] && prev[prefix] == keys[i][prefix])
+            prefix++;
+        val = json_object_get (dict, keys[i]);
+        if (buf_put_varint (b, prefix) < 0
+            || buf_put_bytes (b,
+                              keys[i] + prefix,
+                              strlen (keys[i] + prefix)) < 0
+            || buf_put_bytes (b,
+                              json_string_value (val),
+                              json_string_length (val)) < 0)
+            goto done;
+        prev = keys[i];
+    }
+    rc = 0;
+done:
+    ERRNO_SAFE_WRAP (free, keys);
+    return rc;
+}
+
+/* Rebuild a dict from the uncompressed format.
+ */
+static json_t *unpack_dict (const char *data, size_t len)
+{
+    const char *p = data;
+    const char *end = data + len;
+    size_t count;
+    struct buf key = { 0 };
+    json_t *dict;
+
+    if (!(dict = json_object ()))
+        goto nomem;
+    if (get_varint (&p, end, &count) < 0)
+        goto inval;
+    for (size_t i = 0; i < count; i++) {
+        size_t prefix;
+        const char *s;
+        size_t slen;
+        json_t *val;
+
+        if (get_varint (&p, end, &prefix) < 0
+            || prefix > key.len
+            || get_bytes (&p, end, &s, &slen) < 0
+            || memchr (s, '\0', slen))
+            goto inval;
+        key.len = prefix;
+        if (buf_reserve (&key, slen + 1) < 0)
+            goto error;
+        memcpy (key.data + key.len, s, slen);
+        key.len += slen;
+        key.data[key.len] = '\0';
+        if (get_bytes (&p, end, &s, &slen) < 0)
+            goto inval;
+        if (!(val = json_stringn (s, slen)))
+            goto inval;
+        if (json_object_set_new (dict, key.data, val) < 0)
+            goto nomem;
+    }
+    if (p != end)
+        goto inval;
+    free (key.data);
+    return dict;
+inval:
+    errno = EPROTO;
+    goto error;
+nomem:
+    errno = ENOMEM;
+error:
+    ERRNO_SAFE_WRAP (free, key.data);
+    ERRNO_SAFE_WRAP (json_decref, dict);
+    return NULL;
+}
+
+json_t *kvs_codec_encode (json_t *dict, size_t threshold)
+{
+    struct buf b = { 0 };
+    char *zbuf = NULL;
+    char *xbuf = NULL;
+    int zlen;
+    ssize_t xlen;
+    json_t *o = NULL;
+
+    if (!json_is_object (dict)) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (pack_dict (dict, &b) < 0)
+        goto done;
+    if (threshold > 0 && b.len < threshold) {
+        o = json_incref (dict);
+        goto done;
+    }
+    if (b.len > LZ4_MAX_INPUT_SIZE) {
+        errno = EOVERFLOW;
+        goto done;
+    }
+    if (!(zbuf = malloc (LZ4_compressBound (b.len))))
+        goto done;
+    if ((zlen = LZ4_compress_default (b.data,
+                                      zbuf,
+                                      b.len,
+                                      LZ4_compressBound (b.len))) <= 0) {
+        errno = EINVAL;
+        goto done;
+    }
+    if (!(xbuf = malloc (b64_encoded_length (zlen) + 1))
+        || (xlen = b64_encode (xbuf,
+                               b64_encoded_length (zlen) + 1,
+                               zbuf,
+                               zlen)) < 0)
+        goto done;
+    if (!(o = json_pack ("{s:s s:I s:s#}",
+                         "encoding", "lz4",
+                         "size", (json_int_t)b.len,
+                         "data", xbuf, xlen)))
+        errno = ENOMEM;
+done:
+    ERRNO_SAFE_WRAP (free, b.data);
+    ERRNO_SAFE_WRAP (free, zbuf);
+    ERRNO_SAFE_WRAP (free, xbuf);
+    return o;
+}
+
+bool kvs_codec_is_encoded (json_t *o)
+{
+    return json_is_integer (json_object_get (o, "size"));
+}
+
+json_t *kvs_codec_decode (json_t *o)
+{
+    const char *encoding;
+    json_int_t size;
+    const char *xbuf;
+    size_t xlen;
+    char *zbuf = NULL;
+    size_t zsize;
+    ssize_t zlen;
+    char *data = NULL;
+    json_t *dict = NULL;
+
+    if (!json_is_object (o)) {
+        errno = EPROTO;
+        return NULL;
+    }
+    if (!kvs_codec_is_encoded (o))
+        return json_incref (o);
+    if (json_unpack (o,
+                     "{s:s s:I s:s%}",
+                     "encoding", &encoding,
+                     "size", &size,
+                     "data", &xbuf, &xlen) < 0
+        || !streq (encoding, "lz4")
+        || size < 0
+        || size > LZ4_MAX_INPUT_SIZE) {
+        errno = EPROTO;
+        return NULL;
+    }
+    zsize = b64_decoded_length (xlen) + 1;
+    if (!(zbuf = malloc (zsize))
+        || !(data = malloc (size > 0 ? size : 1)))
+        goto done;
+    if ((zlen = b64_decode (zbuf, zsize, xbuf, xlen)) < 0
+        || zlen > LZ4_MAX_INPUT_SIZE
+        || LZ4_decompress_safe (zbuf, data, zlen, size) != size) {
+        errno = EPROTO;
+        goto done;
+    }
+    dict = unpack_dict (data, size);
+done:
+    ERRNO_SAFE_WRAP (free, zbuf);
+    ERRNO_SAFE_WRAP (free, data);
+    return dict;
+}
+
+/* vi: ts=4 sw=4 expandtab
+ */
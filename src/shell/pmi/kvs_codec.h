@@ -0,0 +1,53 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef SHELL_PMI_KVS_CODEC_H
+#define SHELL_PMI_KVS_CODEC_H
+
+#include <stdbool.h>
+#include <jansson.h>
+
+/* Compact encoding of a PMI KVS dict (an object with string values)
+ * for pmi-exchange messages:
+ *
+ *   {"encoding":"lz4", "size":I, "data":s}
+ *
+ * where "data" is the base64 encoding of an LZ4 block which decompresses
+ * to "size" bytes.  Those bytes are a varint entry count followed by one
+ * entry per key in sorted order:
+ *
+ *   varint prefix   length of the prefix shared with the previous key
+ *   varint len      length of the rest of the key
+ *   bytes           rest of the key
+ *   varint len      length of the value
+ *   bytes           value
+ *
+ * Since every value in a plain dict is a string, an object with an
+ * integer "size" cannot be mistaken for one.
+ */
+
+/* Encode 'dict'.  If 'threshold' is greater than zero and the entries
+ * take fewer than 'threshold' bytes before compression, return a new
+ * reference to 'dict' instead.  Returns NULL with errno set on failure.
+ */
+json_t *kvs_codec_encode (json_t *dict, size_t threshold);
+
+/* Return a dict from 'o', which may be an encoded or plain dict.
+ * The caller must drop the returned reference.  Returns NULL with
+ * errno set on failure (EPROTO if 'o' is malformed).
+ */
+json_t *kvs_codec_decode (json_t *o);
+
+bool kvs_codec_is_encoded (json_t *o);
+
+#endif /* !SHELL_PMI_KVS_CODEC_H */
+
+/* vi: ts=4 sw=4 expandtab
+ */
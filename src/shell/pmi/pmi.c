@@ -80,10 +80,11 @@
 struct shell_pmi {
     flux_shell_t *shell;
     struct pmi_simple_server *server;
-    json_t *global; // already exchanged
+    json_t *global; // already exchanged (native: lookup cache)
     json_t *pending;// pending to be exchanged
     json_t *locals;  // never exchanged
     struct pmi_exchange *exchange;
+    zhashx_t *lookups; // native: key => pending lookup future
 };
 
 /* pmi_simple_ops->warn() signature */
@@ -129,29 +130,70 @@ nomem:
  ** This is used if pmi.kvs=native option is provided.
  **/
 
+static void clients_destroy (void *arg)
+{
+    zlist_t *clients = arg;
+    zlist_destroy (&clients);
+}
+
+/* Answer every client waiting on this lookup.  Successful results are
+ * cached until the next fence, since many local tasks typically get the
+ * same keys after a barrier.
+ */
 static void native_lookup_continuation (flux_future_t *f, void *arg)
 {
     struct shell_pmi *pmi = arg;
-    void *cli = flux_future_aux_get (f, "pmi_cli");
+    zlist_t *clients = flux_future_aux_get (f, "pmi_clients");
+    const char *key = flux_future_aux_get (f, "pmi_key");
     const char *val = NULL;
+    void *cli;
 
-    (void)flux_kvs_lookup_get (f, &val); // leave val=NULL on failure
-    pmi_simple_server_kvs_get_complete (pmi->server, cli, val);
-    flux_future_destroy (f);
+    if (flux_kvs_lookup_get (f, &val) < 0)
+        val = NULL;
+    else if (put_dict (pmi->global, key, val) < 0)
+        shell_warn ("error caching PMI key %s", key);
+    while ((cli = zlist_pop (clients)))
+        pmi_simple_server_kvs_get_complete (pmi->server, cli, val);
+    zhashx_delete (pmi->lookups, key);
 }
 
 static int native_lookup (struct shell_pmi *pmi, const char *key, void *cli)
 {
     char *nkey;
+    char *keycpy;
     flux_future_t *f;
+    zlist_t *clients;
 
+    /* Join a lookup of the same key that is already in progress.
+     */
+    if ((f = zhashx_lookup (pmi->lookups, key))) {
+        clients = flux_future_aux_get (f, "pmi_clients");
+        return zlist_append (clients, cli);
+    }
     if (asprintf (&nkey, "pmi.%s", key) < 0)
         return -1;
     if (!(f = flux_kvs_lookup (pmi->shell->h, NULL, 0, nkey)))
-        return -1;
-    if (flux_future_aux_set (f, "pmi_cli", cli, NULL) < 0)
         goto error;
-    if (flux_future_then (f, -1, native_lookup_continuation, pmi) < 0)
+    if (!(clients = zlist_new ())
+        || flux_future_aux_set (f,
+                                "pmi_clients",
+                                clients,
+                                clients_destroy) < 0) {
+        zlist_destroy (&clients);
+        errno = ENOMEM;
+        goto error;
+    }
+    if (zlist_append (clients, cli) < 0
+        || !(keycpy = strdup (key))) {
+        errno = ENOMEM;
+        goto error;
+    }
+    if (flux_future_aux_set (f, "pmi_key", keycpy, free) < 0) {
+        ERRNO_SAFE_WRAP (free, keycpy);
+        goto error;
+    }
+    if (flux_future_then (f, -1, native_lookup_continuation, pmi) < 0
+        || zhashx_insert (pmi->lookups, keycpy, f) < 0)
         goto error;
     free (nkey);
     return 0;
@@ -169,6 +211,7 @@ static void native_fence_continuation (flux_future_t *f, void *arg)
 
     flux_future_destroy (f);
     json_object_clear (pmi->pending);
+    json_object_clear (pmi->global);
 }
 
 static int native_fence (struct shell_pmi *pmi)
@@ -247,7 +290,8 @@ static int native_kvs_get (void *arg,
     const char *val = NULL;
 
     if ((o = json_object_get (pmi->locals, key))
-            || (o = json_object_get (pmi->pending, key))) {
+            || (o = json_object_get (pmi->pending, key))
+            || (o = json_object_get (pmi->global, key))) {
         val = json_string_value (o);
         pmi_simple_server_kvs_get_complete (pmi->server, cli, val);
         return 0;
@@ -466,12 +510,22 @@ out:
     return rc;
 }
 
+/* zhashx_destructor_fn footprint */
+static void lookup_destroy (void **item)
+{
+    if (item) {
+        flux_future_destroy (*item);
+        *item = NULL;
+    }
+}
+
 static void pmi_destroy (struct shell_pmi *pmi)
 {
     if (pmi) {
         int saved_errno = errno;
         pmi_simple_server_destroy (pmi->server);
         pmi_exchange_destroy (pmi->exchange);
+        zhashx_destroy (&pmi->lookups);
         json_decref (pmi->global);
         json_decref (pmi->pending);
         json_decref (pmi->locals);
@@ -489,6 +543,7 @@ static struct pmi_simple_ops shell_pmi_ops = {
 
 static int parse_args (json_t *config,
                        int *exchange_k,
+                       int *exchange_compress,
                        const char **kvs,
                        int *nomap)
 {
@@ -498,14 +553,19 @@ static int parse_args (json_t *config,
         if (json_unpack_ex (config,
                             &error,
                             0,
-                            "{s?s s?{s?i !} s?i !}",
+                            "{s?s s?{s?i s?i !} s?i !}",
                             "kvs", kvs,
                             "exchange",
                               "k", exchange_k,
+                              "compress", exchange_compress,
                             "nomap", nomap) < 0) {
             shell_log_error ("option error: %s", error.text);
             return -1;
         }
+        if (*exchange_compress < 0) {
+            shell_log_error ("exchange.compress must be >= 0");
+            return -1;
+        }
     }
     return 0;
 }
@@ -518,13 +578,18 @@ static struct shell_pmi *pmi_create (flux_shell_t *shell, json_t *config)
     char kvsname[32];
     const char *kvs = "exchange";
     int exchange_k = 0; // 0=use default tree fanout
+    int exchange_compress = 4096; // min payload size to compress, 0=never
     int nomap = 0;      // avoid generation of PMI_process_mapping
 
     if (!(pmi = calloc (1, sizeof (*pmi))))
         return NULL;
     pmi->shell = shell;
 
-    if (parse_args (config, &exchange_k, &kvs, &nomap) < 0)
+    if (parse_args (config,
+                    &exchange_k,
+                    &exchange_compress,
+                    &kvs,
+                    &nomap) < 0)
         goto error;
     if (streq (kvs, "native")) {
         shell_pmi_ops.kvs_put = native_kvs_put;
@@ -537,7 +602,9 @@ static struct shell_pmi *pmi_create (flux_shell_t *shell, json_t *config)
         shell_pmi_ops.kvs_put = exchange_kvs_put;
         shell_pmi_ops.kvs_get = exchange_kvs_get;
         shell_pmi_ops.barrier_enter = exchange_barrier_enter;
-        if (!(pmi->exchange = pmi_exchange_create (shell, exchange_k)))
+        if (!(pmi->exchange = pmi_exchange_create (shell,
+                                                   exchange_k,
+                                                   exchange_compress)))
             goto error;
     }
     else {
@@ -566,10 +633,12 @@ static struct shell_pmi *pmi_create (flux_shell_t *shell, json_t *config)
         goto error;
     if (!(pmi->global = json_object ())
         || !(pmi->pending = json_object ())
-        || !(pmi->locals = json_object ())) {
+        || !(pmi->locals = json_object ())
+        || !(pmi->lookups = zhashx_new ())) {
         errno = ENOMEM;
         goto error;
     }
+    zhashx_set_destructor (pmi->lookups, lookup_destroy);
     if (!nomap && init_clique (pmi) < 0)
         goto error;
     if (set_flux_instance_level (pmi) < 0
@@ -23,6 +23,12 @@
  * Broadcast fans out at each tree level, reducing the number of messages
  * that have to be sent by rank 0.
  *
+ * Payloads at least 'compress' bytes in size are sent in the compact
+ * encoding of kvs_codec.h, which receivers recognize regardless of their
+ * own setting.  The parent's response already holds the full dict, so a
+ * shell relays it to its children as received rather than encoding it
+ * again.
+ *
  * N.B. This binary tree is created from thin air for algorithmic purposes.
  * Nodes that are peers in the ersatz tree may actually be multiple hops
  * apart on the Flux tree based overlay network at the broker level.
@@ -43,11 +49,13 @@
 #include "internal.h"
 
 #include "pmi_exchange.h"
+#include "kvs_codec.h"
 
 #define DEFAULT_TREE_K 2
 
 struct session {
     json_t *dict;               // container for gathered dictionary
+    json_t *response;           // payload for responses to children
     pmi_exchange_f cb;          // callback for exchange completion
     void *cb_arg;
 
@@ -65,6 +73,7 @@ struct pmi_exchange {
     int rank;
     uint32_t parent_rank;
     int child_count;
+    size_t compress;
 
     struct session *session;
 };
@@ -83,6 +92,7 @@ static void session_destroy (struct session *ses)
         }
         flux_future_destroy (ses->f);
         json_decref (ses->dict);
+        json_decref (ses->response);
         free (ses);
         errno = saved_errno;
     }
@@ -106,6 +116,15 @@ nomem:
     return NULL;
 }
 
+/* Return a payload for 'dict', compressed if large enough.
+ */
+static json_t *exchange_encode (struct pmi_exchange *pex, json_t *dict)
+{
+    if (pex->compress == 0)
+        return json_incref (dict);
+    return kvs_codec_encode (dict, pex->compress);
+}
+
 static void session_process (struct session *ses)
 {
     struct pmi_exchange *pex = ses->pex;
@@ -123,23 +142,27 @@ static void session_process (struct session *ses)
     /* Send exchange request, if needed.
      */
     if (pex->rank > 0 && !ses->f) {
-        flux_future_t *f;
-
-        if (!(f = flux_shell_rpc_pack (pex->shell,
-                                       "pmi-exchange",
-                                       pex->parent_rank,
-                                       0,
-                                       "O",
-                                       ses->dict))
+        flux_future_t *f = NULL;
+        json_t *payload;
+
+        if (!(payload = exchange_encode (pex, ses->dict))
+                || !(f = flux_shell_rpc_pack (pex->shell,
+                                              "pmi-exchange",
+                                              pex->parent_rank,
+                                              0,
+                                              "O",
+                                              payload))
                 || flux_future_then (f,
                                      -1,
                                      exchange_response_completion,
                                      pex) < 0) {
             flux_future_destroy (f);
+            json_decref (payload);
             shell_warn ("error sending pmi-exchange request");
             ses->has_error = 1;
             goto done;
         }
+        json_decref (payload);
         ses->f = f;
     }
 
@@ -150,8 +173,15 @@ static void session_process (struct session *ses)
 
     /* Send exchange response(s), if needed.
      */
+    if (zlist_size (ses->requests) > 0 && !ses->response) {
+        if (!(ses->response = exchange_encode (pex, ses->dict))) {
+            shell_warn ("error encoding pmi-exchange response");
+            ses->has_error = 1;
+            goto done;
+        }
+    }
     while ((msg = zlist_pop (ses->requests))) {
-        if (flux_respond_pack (h, msg, "O", ses->dict) < 0) {
+        if (flux_respond_pack (h, msg, "O", ses->response) < 0) {
             shell_warn ("error responding to pmi-exchange request");
             flux_msg_decref (msg);
             ses->has_error = 1;
@@ -170,19 +200,27 @@ done:
 static void exchange_response_completion (flux_future_t *f, void *arg)
 {
     struct pmi_exchange *pex = arg;
-    json_t *dict;
+    json_t *payload;
+    json_t *dict = NULL;
 
-    if (flux_rpc_get_unpack (f, "o", &dict) < 0) {
+    if (flux_rpc_get_unpack (f, "o", &payload) < 0) {
         shell_warn ("pmi-exchange request: %s", future_strerror (f, errno));
         pex->session->has_error = 1;
         goto done;
     }
+    if (!(dict = kvs_codec_decode (payload))) {
+        shell_warn ("pmi-exchange response: %s", flux_strerror (errno));
+        pex->session->has_error = 1;
+        goto done;
+    }
     if (json_object_update (pex->session->dict, dict) < 0) {
         shell_warn ("pmi-exchange response handling failed to update dict");
         pex->session->has_error = 1;
         goto done;
     }
+    pex->session->response = json_incref (payload);
 done:
+    json_decref (dict);
     session_process (pex->session);
 }
 
@@ -194,11 +232,16 @@ static void exchange_request_cb (flux_t *h,
                                  void *arg)
 {
     struct pmi_exchange *pex = arg;
-    json_t *dict;
+    json_t *payload;
+    json_t *dict = NULL;
     const char *errstr = NULL;
 
-    if (flux_request_unpack (msg, NULL, "o", &dict) < 0)
+    if (flux_request_unpack (msg, NULL, "o", &payload) < 0)
+        goto error;
+    if (!(dict = kvs_codec_decode (payload))) {
+        errstr = "pmi-exchange request could not be decoded";
         goto error;
+    }
     if (!pex->session) {
         if (!(pex->session = session_create (pex)))
             goto error;
@@ -218,6 +261,7 @@ static void exchange_request_cb (flux_t *h,
         errstr = "pmi-exchange request failed to save pending request";
         goto nomem;
     }
+    json_decref (dict);
     session_process (pex->session);
     return;
 nomem:
@@ -226,6 +270,7 @@ error:
     if (flux_respond_error (h, msg, errno, errstr) < 0)
         shell_warn ("error responding to pmi-exchange request: %s",
                     flux_strerror (errno));
+    json_decref (dict);
 }
 
 /* PMI implementation on _this_ shell is ready to exchange.
@@ -269,7 +314,9 @@ static int child_count (int k, int rank, int size)
     return count;
 }
 
-struct pmi_exchange *pmi_exchange_create (flux_shell_t *shell, int k)
+struct pmi_exchange *pmi_exchange_create (flux_shell_t *shell,
+                                          int k,
+                                          size_t compress)
 {
     struct pmi_exchange *pex;
 
@@ -291,6 +338,7 @@ struct pmi_exchange *pmi_exchange_create (flux_shell_t *shell, int k)
     pex->rank = shell->info->shell_rank;
     pex->parent_rank = kary_parentof (k, pex->rank);
     pex->child_count = child_count (k, pex->rank, pex->size);
+    pex->compress = compress;
 
     if (flux_shell_service_register (shell,
                                      "pmi-exchange",
@@ -13,8 +13,11 @@
 
 /* Create handle for performing multiple sequential exchanges.
  * 'k' is the tree fanout (k=0 selects internal default).
+ * Payloads of at least 'compress' bytes are compressed (0 disables).
  */
-struct pmi_exchange *pmi_exchange_create (flux_shell_t *shell, int k);
+struct pmi_exchange *pmi_exchange_create (flux_shell_t *shell,
+                                          int k,
+                                          size_t compress);
 void pmi_exchange_destroy (struct pmi_exchange *pex);
 
 typedef void (*pmi_exchange_f)(struct pmi_exchange *pex, void *arg);
@@ -0,0 +1,181 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <jansson.h>
+
+#include "src/common/libtap/tap.h"
+
+#include "pmi/kvs_codec.h"
+
+static json_t *create_dict (int count)
+{
+    json_t *dict;
+    char key[64];
+    char val[128];
+
+    if (!(dict = json_object ()))
+        BAIL_OUT ("json_object failed");
+    for (int i = 0; i < count; i++) {
+        snprintf (key, sizeof (key), "mpi-bc-%d", i);
+        snprintf (val,
+                  sizeof (val),
+                  "tcp://10.0.%d.%d:%d;ofi://fabric0/%x",
+                  i / 256,
+                  i % 256,
+                  40000 + i,
+                  i * 2654435761U);
+        if (json_object_set_new (dict, key, json_string (val)) < 0)
+            BAIL_OUT ("json_object_set_new failed");
+    }
+    return dict;
+}
+
+static void test_roundtrip (int count)
+{
+    json_t *dict = create_dict (count);
+    json_t *o;
+    json_t *dict2;
+    char *s;
+
+    o = kvs_codec_encode (dict, 0);
+    ok (o != NULL && kvs_codec_is_encoded (o),
+        "kvs_codec_encode %d entries works", count);
+    dict2 = kvs_codec_decode (o);
+    ok (dict2 != NULL && json_equal (dict, dict2),
+        "kvs_codec_decode %d entries returns the original dict", count);
+    if (count >= 100 && o) {
+        size_t len = json_string_length (json_object_get (o, "data"));
+
+        if (!(s = json_dumps (dict, JSON_COMPACT)))
+            BAIL_OUT ("json_dumps failed");
+        ok (len < strlen (s),
+            "encoded dict is smaller than its JSON encoding");
+        diag ("json %zu bytes, encoded %zu bytes", strlen (s), len);
+        free (s);
+    }
+    json_decref (dict2);
+    json_decref (o);
+    json_decref (dict);
+}
+
+static void test_threshold (void)
+{
+    json_t *dict = create_dict (4);
+    json_t *o;
+    json_t *dict2;
+
+    o = kvs_codec_encode (dict, 1024);
+    ok (o == dict,
+        "kvs_codec_encode returns small dict as is");
+    ok (!kvs_codec_is_encoded (o),
+        "and it is not considered encoded");
+    dict2 = kvs_codec_decode (o);
+    ok (dict2 == dict,
+        "kvs_codec_decode returns plain dict as is");
+    json_decref (dict2);
+    json_decref (o);
+    json_decref (dict);
+}
+
+static void test_special (void)
+{
+    json_t *dict;
+    json_t *o;
+    json_t *dict2;
+
+    /* keys that are prefixes of each other, empty key and value,
+     * and a value with an embedded NUL
+     */
+    if (!(dict = json_pack ("{s:s s:s s:s s:s s:s}",
+                            "", "",
+                            "a", "x",
+                            "ab", "",
+                            "abc", "yz",
+                            "b", "w")))
+        BAIL_OUT ("json_pack failed");
+    if (json_object_set_new (dict, "nul", json_stringn ("a\0b", 3)) < 0)
+        BAIL_OUT ("json_object_set_new failed");
+    o = kvs_codec_encode (dict, 0);
+    dict2 = kvs_codec_decode (o);
+    ok (dict2 != NULL && json_equal (dict, dict2),
+        "kvs_codec handles prefix keys, empty strings, and NUL in values");
+    json_decref (dict2);
+    json_decref (o);
+    json_decref (dict);
+}
+
+static void test_errors (void)
+{
+    json_t *dict;
+    json_t *o;
+
+    if (!(dict = json_pack ("{s:i}", "a", 1)))
+        BAIL_OUT ("json_pack failed");
+    errno = 0;
+    ok (kvs_codec_encode (dict, 0) == NULL && errno == EINVAL,
+        "kvs_codec_encode fails with EINVAL on non-string value");
+    json_decref (dict);
+
+    if (!(o = json_pack ("{s:s s:i s:s}",
+                         "encoding", "gzip",
+                         "size", 1,
+                         "data", "AA==")))
+        BAIL_OUT ("json_pack failed");
+    errno = 0;
+    ok (kvs_codec_decode (o) == NULL && errno == EPROTO,
+        "kvs_codec_decode fails with EPROTO on unknown encoding");
+    json_decref (o);
+
+    if (!(o = json_pack ("{s:s s:i s:s}",
+                         "encoding", "lz4",
+                         "size", 100,
+                         "data", "AA==")))
+        BAIL_OUT ("json_pack failed");
+    errno = 0;
+    ok (kvs_codec_decode (o) == NULL && errno == EPROTO,
+        "kvs_codec_decode fails with EPROTO on corrupt data");
+    json_decref (o);
+
+    /* "\x20" is an LZ4 literal run of 2: 0x01 0x05, i.e. one entry with
+     * a shared prefix of 5 bytes, which is more than the previous key
+     */
+    if (!(o = json_pack ("{s:s s:i s:s}",
+                         "encoding", "lz4",
+                         "size", 2,
+                         "data", "IAEF")))
+        BAIL_OUT ("json_pack failed");
+    errno = 0;
+    ok (kvs_codec_decode (o) == NULL && errno == EPROTO,
+        "kvs_codec_decode fails with EPROTO on bad prefix length");
+    json_decref (o);
+}
+
+int main (int argc, char *argv[])
+{
+    plan (NO_PLAN);
+
+    test_roundtrip (0);
+    test_roundtrip (1);
+    test_roundtrip (1000);
+    test_threshold ();
+    test_special ();
+    test_errors ();
+
+    done_testing ();
+}
+
+/* vi: ts=4 sw=4 expandtab
+ */
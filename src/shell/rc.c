@@ -30,6 +30,7 @@
 #include "ccan/str/str.h"
 #include "internal.h"
 #include "info.h"
+#include "cache.h"
 
 /*  Lua plugin helper types:
  */
@@ -321,6 +322,75 @@ static int l_plugin_load (lua_State *L)
     return 0;
 }
 
+struct dump_buf {
+    char *data;
+    size_t len;
+};
+
+static int dump_writer (lua_State *L, const void *p, size_t sz, void *ud)
+{
+    struct dump_buf *db = ud;
+    char *new;
+
+    if (!(new = realloc (db->data, db->len + sz)))
+        return 1;
+    db->data = new;
+    memcpy (db->data + db->len, p, sz);
+    db->len += sz;
+    return 0;
+}
+
+/*  Compile rcfile onto the stack, using bytecode from the shell cache
+ *   if rcfile has not changed since it was cached.  On a miss, the
+ *   compiled chunk is dumped (with debug info, for error messages) and
+ *   cached for the next shell on this node.
+ */
+static int rcfile_load (lua_State *L,
+                        const char *rcfile,
+                        const struct stat *sb)
+{
+    struct shell_cache *cache = rc_shell ? rc_shell->cache : NULL;
+    char type[32];
+    char *chunkname = NULL;
+    struct dump_buf db = { 0 };
+    void *data;
+    size_t size;
+    int rc;
+
+    if (!cache)
+        return luaL_loadfile (L, rcfile);
+
+    /*  Bytecode is specific to the Lua version.
+     */
+    snprintf (type, sizeof (type), "luac%d", LUA_VERSION_NUM);
+    if ((data = shell_cache_read (cache, type, rcfile, sb, &size))) {
+        if (asprintf (&chunkname, "@%s", rcfile) < 0) {
+            free (data);
+            return luaL_loadfile (L, rcfile);
+        }
+        rc = luaL_loadbuffer (L, data, size, chunkname);
+        free (chunkname);
+        free (data);
+        if (rc == 0) {
+            shell_trace ("loaded %s from cache", rcfile);
+            return 0;
+        }
+        lua_pop (L, 1);
+    }
+    if ((rc = luaL_loadfile (L, rcfile)) != 0)
+        return rc;
+#if LUA_VERSION_NUM >= 503
+    rc = lua_dump (L, dump_writer, &db, 0);
+#else
+    rc = lua_dump (L, dump_writer, &db);
+#endif
+    if (rc == 0
+        && shell_cache_write (cache, type, rcfile, sb, db.data, db.len) < 0)
+        shell_trace ("failed to cache %s: %s", rcfile, strerror (errno));
+    free (db.data);
+    return 0;
+}
+
 /*  Run a Lua file as a shell initrc script
  */
 static int shell_run_rcfile (flux_shell_t *shell,
@@ -340,7 +410,7 @@ static int shell_run_rcfile (flux_shell_t *shell,
 
     /*  Compile rcfile onto stack
      */
-    if (luaL_loadfile (L, rcfile) != 0) {
+    if (rcfile_load (L, rcfile, &sb) != 0) {
         shell_log_error ("%s: %s", rcfile, lua_tostring (L, -1));
         return -1;
     }
@@ -362,9 +432,9 @@ static int l_source_rcfiles (lua_State *L)
     glob_t gl;
     const char *pattern = lua_tostring (L, -1);
 
-    /* XXX: using GLOB_TILDE GNU extension for now
+    /* N.B. shell_cache_glob() uses the GLOB_TILDE_CHECK GNU extension
      */
-    if ((rc = glob (pattern, GLOB_TILDE_CHECK, NULL, &gl)) != 0) {
+    if ((rc = shell_cache_glob (rc_shell->cache, pattern, &gl)) != 0) {
         globfree (&gl);
         if (rc == GLOB_NOMATCH) {
             if (!isa_pattern (pattern))
@@ -126,6 +126,22 @@ static int rankinfo_get_children (struct rankinfo *ri,
     return 0;
 }
 
+/*  Fill 'ri' from 'template', which was decoded from the same children.
+ */
+static int rankinfo_copy_children (struct rankinfo *ri,
+                                   const struct rankinfo *template,
+                                   flux_error_t *errp)
+{
+    ri->cores = template->cores;
+    ri->gpus = template->gpus;
+    if (!(ri->cpuset = idset_copy (template->cpuset))
+        || !(ri->gpuset = idset_copy (template->gpuset)))
+        return errprintf (errp, "Failed to copy cpu or gpu sets");
+    ri->ncores = template->ncores;
+    ri->ngpus = template->ngpus;
+    return 0;
+}
+
 static int rcalc_process_all_ranks (rcalc_t *r, flux_error_t *errp)
 {
     json_t *entry;
@@ -151,12 +167,21 @@ static int rcalc_process_all_ranks (rcalc_t *r, flux_error_t *errp)
                               rank,
                               strerror (errno));
 
+        /*  Children are the same for every rank in the entry, so decode
+         *   them for the first rank only and copy them to the rest.
+         */
         i = idset_first (ids);
         while (i != IDSET_INVALID_ID) {
             struct rankinfo *ri = &r->ranks[n];
+            int rc;
+
             ri->id = n;
             ri->rank = i;
-            if (rankinfo_get_children (ri, children, errp) < 0) {
+            if (i == idset_first (ids))
+                rc = rankinfo_get_children (ri, children, errp);
+            else
+                rc = rankinfo_copy_children (ri, &r->ranks[n - 1], errp);
+            if (rc < 0) {
                 idset_destroy (ids);
                 return -1;
             }
@@ -42,6 +42,8 @@
 #include "rc.h"
 #include "log.h"
 #include "mustache.h"
+#include "timing.h"
+#include "cache.h"
 
 static char *shell_name = "flux-shell";
 static const char *shell_usage = "[OPTIONS] JOBID";
@@ -925,7 +927,9 @@ static void shell_finalize (flux_shell_t *shell)
      */
     shell->plugstack = NULL;
     plugstack_destroy (plugstack);
+    shell_cache_destroy (shell->cache);
 
+    shell_timing_destroy (shell->timing);
     mustache_renderer_destroy (shell->mr);
     shell_eventlogger_destroy (shell->ev);
     shell_svc_destroy (shell->svc);
@@ -1049,6 +1053,27 @@ static int mustache_render_jobid (flux_shell_t *shell,
     return 0;
 }
 
+/*  Outside of a task context, leave the tag in place so the result
+ *   can be rendered again for each task, e.g. for per-task output files.
+ */
+static int mustache_render_taskid (flux_shell_t *shell,
+                                   const char *name,
+                                   FILE *fp)
+{
+    int rc;
+
+    if (shell->current_task)
+        rc = fprintf (fp, "%d", shell->current_task->rank);
+    else
+        rc = fprintf (fp, "{{%s}}", name);
+    if (rc < 0) {
+        shell_log_error ("memstream write failed for %s: %s",
+                         name,
+                         strerror (errno));
+    }
+    return 0;
+}
+
 static int mustache_cb (FILE *fp, const char *name, void *arg)
 {
     int rc = -1;
@@ -1064,6 +1089,8 @@ static int mustache_cb (FILE *fp, const char *name, void *arg)
         return mustache_render_jobid (shell, name, fp);
     if (streq (name, "name"))
         return mustache_render_name (shell, name, fp);
+    if (streq (name, "taskid"))
+        return mustache_render_taskid (shell, name, fp);
 
     if (snprintf (topic,
                   sizeof (topic),
@@ -1105,6 +1132,9 @@ static void shell_initialize (flux_shell_t *shell)
 
     memset (shell, 0, sizeof (struct flux_shell));
 
+    if (!(shell->timing = shell_timing_create ()))
+        shell_die_errno (1, "shell_timing_create");
+
     if (gethostname (shell->hostname, sizeof (shell->hostname)) < 0)
         shell_die_errno (1, "gethostname");
 
@@ -1289,6 +1319,30 @@ static int load_initrc (flux_shell_t *shell, const char *default_rcfile)
     return 0;
 }
 
+/*  Cache compiled initrc scripts and plugin directory listings in the
+ *   broker rundir, which is node-local, so that only the first shell on
+ *   a node reads them from a possibly shared file system.  Shells that
+ *   do not run as the instance owner cannot write the rundir and do not
+ *   use the cache.
+ */
+static void shell_cache_init (flux_shell_t *shell)
+{
+    const char *rundir;
+    char path[PATH_MAX + 1];
+
+    if (getuid () != shell->broker_owner
+        || !(rundir = flux_attr_get (shell->h, "rundir")))
+        return;
+    if (snprintf (path, sizeof (path), "%s/shell-cache", rundir)
+        >= sizeof (path))
+        return;
+    if (!(shell->cache = shell_cache_create (path))) {
+        shell_debug ("%s: startup cache disabled: %s", path, strerror (errno));
+        return;
+    }
+    plugstack_set_cache (shell->plugstack, shell->cache);
+}
+
 static int shell_initrc (flux_shell_t *shell)
 {
     const char *default_rcfile = shell_conf_get ("shell_initrc");
@@ -1316,6 +1370,8 @@ static int shell_initrc (flux_shell_t *shell)
         }
     }
 
+    shell_cache_init (shell);
+
     /*  Load initrc file if necessary
      */
     return load_initrc (shell, default_rcfile);
@@ -1584,6 +1640,7 @@ int main (int argc, char *argv[])
     /* Connect to broker:
      */
     shell_connect_flux (&shell);
+    shell_timing_phase (shell.timing, "connect");
 
     if (!(shell.ev = shell_eventlogger_create (&shell)))
         shell_die_errno (1, "shell_eventlogger_create");
@@ -1597,6 +1654,7 @@ int main (int argc, char *argv[])
      */
     if (!(shell.info = shell_info_create (&shell)))
         exit (1);
+    shell_timing_phase (shell.timing, "info");
 
     if (shell_export_environment_from_job (&shell) < 0)
         exit (1);
@@ -1611,6 +1669,10 @@ int main (int argc, char *argv[])
                                   &shell.nosetpgrp) < 0)
         shell_die (1, "failed to parse attributes.system.shell.nosetpgrp");
 
+    /* Launch tasks with vfork semantics if vfork option is set */
+    if (flux_shell_getopt_unpack (&shell, "vfork", "i", &shell.vfork) < 0)
+        shell_die (1, "failed to parse attributes.system.shell.vfork");
+
     /* Reinitialize log facility with new verbosity/shell.info */
     if (shell_log_reinit (&shell) < 0)
         shell_die_errno (1, "shell_log_reinit");
@@ -1620,10 +1682,16 @@ int main (int argc, char *argv[])
     if (!(shell.svc = shell_svc_create (&shell)))
         shell_die (1, "shell_svc_create");
 
+    /* Time plugin callbacks and collect timing records if requested.
+     */
+    if (shell_timing_enable (shell.timing, &shell) < 0)
+        shell_die_errno (1, "shell_timing_enable");
+
     /* Change working directory and Load shell initrc
      */
     if (shell_initrc (&shell) < 0)
         shell_die_errno (1, "shell_initrc");
+    shell_timing_phase (shell.timing, "initrc");
 
     if (shell_taskmap (&shell) < 0)
         shell_die (1, "shell_taskmap");
@@ -1640,6 +1708,7 @@ int main (int argc, char *argv[])
      */
     if (shell_init (&shell) < 0)
         shell_die_errno (1, "shell_init");
+    shell_timing_phase (shell.timing, "shell.init");
 
     /* Now that verbosity, task mapping, etc. may have changed, log
      * basic shell info.
@@ -1650,6 +1719,7 @@ int main (int argc, char *argv[])
      */
     if (shell_barrier (&shell, "init") < 0)
         shell_die_errno (1, "shell_barrier");
+    shell_timing_phase (shell.timing, "barrier.init");
 
     /*  Emit an event after barrier completion from rank 0
      */
@@ -1661,6 +1731,7 @@ int main (int argc, char *argv[])
      */
     if (shell_post_init (&shell) < 0)
         shell_die_errno (1, "shell_post_init");
+    shell_timing_phase (shell.timing, "shell.post-init");
 
     /* Create tasks
      */
@@ -1724,12 +1795,15 @@ int main (int argc, char *argv[])
     /*  Reset current task since we've left task-specific context:
      */
     shell.current_task = NULL;
+    shell_timing_phase (shell.timing, "tasks");
 
     if (shell_start (&shell) < 0)
         shell_die_errno (1, "shell.start callback(s) failed");
+    shell_timing_phase (shell.timing, "shell.start");
 
     if (shell_barrier (&shell, "start") < 0)
         shell_die_errno (1, "shell_barrier");
+    shell_timing_phase (shell.timing, "barrier.start");
 
     /*  Emit an event after barrier completion from rank 0
      */
@@ -1737,6 +1811,9 @@ int main (int argc, char *argv[])
         && shell_eventlogger_emit_event (shell.ev, "shell.start") < 0)
             shell_die_errno (1, "failed to emit event shell.start");
 
+    if (shell_timing_report (shell.timing) < 0)
+        shell_log_errno ("error reporting shell timing");
+
     /* Main reactor loop
      * Exits when all completion references released
      */
@@ -231,6 +231,8 @@ int shell_task_start (struct flux_shell *shell,
 
     if (shell->nosetpgrp)
         flags &= ~FLUX_SUBPROCESS_FLAGS_SETPGRP;
+    if (shell->vfork)
+        flags |= FLUX_SUBPROCESS_FLAGS_VFORK_EXEC;
 
     task->proc = flux_local_exec_ex (r,
                                      flags,
@@ -239,6 +241,9 @@ int shell_task_start (struct flux_shell *shell,
                                      &hooks,
                                      NULL,
                                      NULL);
+    /* The pre_exec hook ran in our memory if the task was vforked.
+     */
+    task->in_pre_exec = false;
     if (!task->proc)
         return -1;
     if (flux_subprocess_aux_set (task->proc, "flux::task", task, NULL) < 0) {
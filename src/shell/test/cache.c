@@ -0,0 +1,272 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <glob.h>
+
+#include "src/common/libtap/tap.h"
+#include "src/common/libutil/unlink_recursive.h"
+#include "ccan/str/str.h"
+
+#include "cache.h"
+
+static char tmpdir[PATH_MAX];
+
+static void path_make (char *buf, size_t size, const char *name)
+{
+    if (snprintf (buf, size, "%s/%s", tmpdir, name) >= size)
+        BAIL_OUT ("path too long");
+}
+
+static void file_create (const char *path, const char *content)
+{
+    FILE *fp;
+
+    if (!(fp = fopen (path, "w"))
+        || fputs (content, fp) < 0
+        || fclose (fp) != 0)
+        BAIL_OUT ("failed to create %s", path);
+}
+
+/* Move the mtime of 'path' forward so a change is detected even where
+ * timestamps are coarse.
+ */
+static void mtime_bump (const char *path, int seconds)
+{
+    struct stat sb;
+    struct timespec ts[2];
+
+    if (stat (path, &sb) < 0)
+        BAIL_OUT ("stat %s failed", path);
+    ts[0] = sb.st_atim;
+    ts[1] = sb.st_mtim;
+    ts[1].tv_sec += seconds;
+    if (utimensat (AT_FDCWD, path, ts, 0) < 0)
+        BAIL_OUT ("utimensat %s failed", path);
+}
+
+static void test_create (void)
+{
+    struct shell_cache *cache;
+    char path[PATH_MAX];
+    struct stat sb;
+
+    errno = 0;
+    ok (shell_cache_create (NULL) == NULL && errno == EINVAL,
+        "shell_cache_create dir=NULL fails with EINVAL");
+
+    path_make (path, sizeof (path), "file");
+    file_create (path, "");
+    errno = 0;
+    ok (shell_cache_create (path) == NULL && errno == EPERM,
+        "shell_cache_create on a regular file fails with EPERM");
+
+    path_make (path, sizeof (path), "shared");
+    if (mkdir (path, 0700) < 0 || chmod (path, 0770) < 0)
+        BAIL_OUT ("failed to create %s", path);
+    errno = 0;
+    ok (shell_cache_create (path) == NULL && errno == EPERM,
+        "shell_cache_create on a group writable dir fails with EPERM");
+
+    path_make (path, sizeof (path), "cache");
+    ok ((cache = shell_cache_create (path)) != NULL,
+        "shell_cache_create creates a new directory");
+    ok (stat (path, &sb) == 0
+        && S_ISDIR (sb.st_mode)
+        && (sb.st_mode & 0777) == 0700,
+        "cache directory has mode 0700");
+    shell_cache_destroy (cache);
+    ok ((cache = shell_cache_create (path)) != NULL,
+        "shell_cache_create works on an existing directory");
+    shell_cache_destroy (cache);
+    lives_ok ({shell_cache_destroy (NULL);},
+              "shell_cache_destroy cache=NULL doesn't crash");
+}
+
+static void test_read_write (struct shell_cache *cache)
+{
+    char path[PATH_MAX];
+    struct stat sb;
+    size_t size;
+    char *data;
+
+    path_make (path, sizeof (path), "source.lua");
+    file_create (path, "print (\"hello\")\n");
+    if (stat (path, &sb) < 0)
+        BAIL_OUT ("stat %s failed", path);
+
+    errno = 0;
+    ok (shell_cache_read (NULL, "luac", path, &sb, &size) == NULL
+        && errno == EINVAL,
+        "shell_cache_read cache=NULL fails with EINVAL");
+    errno = 0;
+    ok (shell_cache_write (cache, "luac", path, NULL, "x", 1) < 0
+        && errno == EINVAL,
+        "shell_cache_write sb=NULL fails with EINVAL");
+
+    errno = 0;
+    ok (shell_cache_read (cache, "luac", path, &sb, &size) == NULL
+        && errno == ENOENT,
+        "shell_cache_read of a missing entry fails with ENOENT");
+
+    ok (shell_cache_write (cache, "luac", path, &sb, "compiled", 8) == 0,
+        "shell_cache_write works");
+    data = shell_cache_read (cache, "luac", path, &sb, &size);
+    ok (data != NULL && size == 8 && memcmp (data, "compiled", 8) == 0,
+        "shell_cache_read returns the cached data");
+    free (data);
+
+    errno = 0;
+    ok (shell_cache_read (cache, "dir", path, &sb, &size) == NULL
+        && errno == ENOENT,
+        "shell_cache_read of another type fails with ENOENT");
+
+    ok (shell_cache_write (cache, "luac", path, &sb, "recompiled", 10) == 0,
+        "shell_cache_write replaces an entry");
+    data = shell_cache_read (cache, "luac", path, &sb, &size);
+    ok (data != NULL && size == 10 && memcmp (data, "recompiled", 10) == 0,
+        "shell_cache_read returns the new data");
+    free (data);
+
+    mtime_bump (path, 10);
+    if (stat (path, &sb) < 0)
+        BAIL_OUT ("stat %s failed", path);
+    errno = 0;
+    ok (shell_cache_read (cache, "luac", path, &sb, &size) == NULL
+        && errno == ENOENT,
+        "shell_cache_read fails with ENOENT after the source changes");
+
+    ok (shell_cache_write (cache, "luac", path, &sb, NULL, 0) == 0,
+        "shell_cache_write of empty data works");
+    data = shell_cache_read (cache, "luac", path, &sb, &size);
+    ok (data != NULL && size == 0,
+        "shell_cache_read returns empty data");
+    free (data);
+}
+
+static void test_glob (struct shell_cache *cache)
+{
+    char dir[PATH_MAX];
+    char path[PATH_MAX];
+    char pattern[PATH_MAX];
+    struct stat sb;
+    glob_t gl;
+    int rc;
+
+    path_make (dir, sizeof (dir), "plugins");
+    if (mkdir (dir, 0700) < 0)
+        BAIL_OUT ("mkdir %s failed", dir);
+    path_make (path, sizeof (path), "plugins/b.so");
+    file_create (path, "");
+    path_make (path, sizeof (path), "plugins/a.so");
+    file_create (path, "");
+    path_make (path, sizeof (path), "plugins/.hidden.so");
+    file_create (path, "");
+    path_make (path, sizeof (path), "plugins/c.txt");
+    file_create (path, "");
+    path_make (pattern, sizeof (pattern), "plugins/*.so");
+
+    rc = shell_cache_glob (cache, pattern, &gl);
+    ok (rc == 0
+        && gl.gl_pathc == 2
+        && strstarts (gl.gl_pathv[0], dir)
+        && strends (gl.gl_pathv[0], "/a.so")
+        && strends (gl.gl_pathv[1], "/b.so")
+        && gl.gl_pathv[2] == NULL,
+        "shell_cache_glob returns sorted matches, skipping dot files");
+    globfree (&gl);
+
+    if (stat (dir, &sb) < 0)
+        BAIL_OUT ("stat %s failed", dir);
+    ok (shell_cache_write (cache, "dir", dir, &sb, "x.so\0y.txt", 11) == 0,
+        "replaced the cached directory listing");
+    rc = shell_cache_glob (cache, pattern, &gl);
+    ok (rc == 0
+        && gl.gl_pathc == 1
+        && strends (gl.gl_pathv[0], "/x.so"),
+        "shell_cache_glob uses the cached directory listing");
+    globfree (&gl);
+
+    path_make (path, sizeof (path), "plugins/d.so");
+    file_create (path, "");
+    mtime_bump (dir, 10);
+    rc = shell_cache_glob (cache, pattern, &gl);
+    ok (rc == 0
+        && gl.gl_pathc == 3
+        && strends (gl.gl_pathv[2], "/d.so"),
+        "shell_cache_glob rereads the directory after it changes");
+    globfree (&gl);
+
+    rc = shell_cache_glob (NULL, pattern, &gl);
+    ok (rc == 0 && gl.gl_pathc == 3,
+        "shell_cache_glob works with cache=NULL");
+    globfree (&gl);
+
+    path_make (pattern, sizeof (pattern), "plugins/*.none");
+    ok (shell_cache_glob (cache, pattern, &gl) == GLOB_NOMATCH,
+        "shell_cache_glob returns GLOB_NOMATCH when nothing matches");
+    globfree (&gl);
+
+    path_make (pattern, sizeof (pattern), "plugins/missing/*.so");
+    ok (shell_cache_glob (cache, pattern, &gl) == GLOB_NOMATCH,
+        "shell_cache_glob returns GLOB_NOMATCH for a missing directory");
+    globfree (&gl);
+
+    path_make (pattern, sizeof (pattern), "*/a.so");
+    rc = shell_cache_glob (cache, pattern, &gl);
+    ok (rc == 0 && gl.gl_pathc == 1 && strends (gl.gl_pathv[0], "/a.so"),
+        "shell_cache_glob handles wildcards in the directory part");
+    globfree (&gl);
+}
+
+int main (int argc, char *argv[])
+{
+    const char *tmp = getenv ("TMPDIR");
+    struct shell_cache *cache;
+    char path[PATH_MAX];
+
+    plan (NO_PLAN);
+
+    if (snprintf (tmpdir,
+                  sizeof (tmpdir),
+                  "%s/shell-cache-test.XXXXXX",
+                  tmp ? tmp : "/tmp") >= sizeof (tmpdir)
+        || !mkdtemp (tmpdir))
+        BAIL_OUT ("could not create tmp directory");
+
+    test_create ();
+
+    path_make (path, sizeof (path), "cache");
+    if (!(cache = shell_cache_create (path)))
+        BAIL_OUT ("shell_cache_create failed");
+    test_read_write (cache);
+    test_glob (cache);
+    shell_cache_destroy (cache);
+
+    if (unlink_recursive (tmpdir) < 0)
+        diag ("failed to remove %s", tmpdir);
+
+    done_testing ();
+    return 0;
+}
+
+/* vi: ts=4 sw=4 expandtab
+ */
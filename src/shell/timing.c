@@ -0,0 +1,261 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* timing.c - shell startup phase timing
+ *
+ * Each shell keeps a record of the form
+ *
+ *   {"rank":i "start":f "phases":[[s,f]...] "plugins":{topic:{name:f}}}
+ *
+ * where "start" is the wall clock time at which the shell started,
+ * "phases" lists phase names and durations in order, and "plugins" has
+ * the total time spent in each plugin callback, by topic.
+ *
+ * With -o timing, followers send their record to the leader in a
+ * shell-<id>.timing request once tasks have started.  The leader posts
+ * the array of all records as the context of a shell.timing event
+ * once every shell has reported, or after a timeout.
+ */
+#define FLUX_SHELL_PLUGIN_NAME NULL
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <sys/time.h>
+#include <jansson.h>
+#include <flux/core.h>
+#include <flux/shell.h>
+
+#include "src/common/libutil/monotime.h"
+
+#include "internal.h"
+#include "info.h"
+#include "timing.h"
+
+/* How long the leader waits for records from other shells.
+ */
+static const double collect_timeout = 30.;
+
+struct shell_timing {
+    flux_shell_t *shell;
+    double start;
+    struct timespec last;
+    json_t *phases;
+    json_t *plugins;
+
+    bool enabled;
+    json_t *records;            // leader: records received so far
+    flux_watcher_t *timer;      // leader: collect_timeout
+    bool posted;
+};
+
+void shell_timing_destroy (struct shell_timing *t)
+{
+    if (t) {
+        int saved_errno = errno;
+        json_decref (t->phases);
+        json_decref (t->plugins);
+        json_decref (t->records);
+        flux_watcher_destroy (t->timer);
+        free (t);
+        errno = saved_errno;
+    }
+}
+
+struct shell_timing *shell_timing_create (void)
+{
+    struct shell_timing *t;
+    struct timeval tv;
+
+    if (!(t = calloc (1, sizeof (*t))))
+        return NULL;
+    monotime (&t->last);
+    gettimeofday (&tv, NULL);
+    t->start = tv.tv_sec + tv.tv_usec / 1e6;
+    if (!(t->phases = json_array ())
+        || !(t->plugins = json_object ()))
+        goto nomem;
+    return t;
+nomem:
+    shell_timing_destroy (t);
+    errno = ENOMEM;
+    return NULL;
+}
+
+void shell_timing_phase (struct shell_timing *t, const char *name)
+{
+    json_t *o;
+
+    if (!t)
+        return;
+    if (!(o = json_pack ("[s f]", name, monotime_since (t->last) / 1000.))
+        || json_array_append_new (t->phases, o) < 0) {
+        json_decref (o);
+        shell_log_error ("error recording %s phase time", name);
+    }
+    monotime (&t->last);
+}
+
+/* plugstack_timer_f signature
+ */
+static void plugin_timer_cb (const char *topic,
+                             const char *name,
+                             double seconds,
+                             void *arg)
+{
+    struct shell_timing *t = arg;
+    json_t *o;
+    json_t *val;
+
+    if (!name)
+        return;
+    if (!(o = json_object_get (t->plugins, topic))) {
+        if (!(o = json_object ())
+            || json_object_set_new (t->plugins, topic, o) < 0)
+            goto error;
+    }
+    if ((val = json_object_get (o, name)))
+        json_real_set (val, json_real_value (val) + seconds);
+    else if (json_object_set_new (o, name, json_real (seconds)) < 0)
+        goto error;
+    return;
+error:
+    t->enabled = false; // stop timing
+    plugstack_set_timer (t->shell->plugstack, NULL, NULL);
+    shell_log_error ("error recording %s plugin time", name);
+}
+
+static json_t *timing_record (struct shell_timing *t)
+{
+    return json_pack ("{s:i s:f s:O s:O}",
+                      "rank", t->shell->info->shell_rank,
+                      "start", t->start,
+                      "phases", t->phases,
+                      "plugins", t->plugins);
+}
+
+static void timing_post (struct shell_timing *t)
+{
+    if (t->posted)
+        return;
+    t->posted = true;
+    flux_watcher_stop (t->timer);
+    if (flux_shell_add_event_context (t->shell,
+                                      "shell.timing",
+                                      0,
+                                      "{s:O}",
+                                      "ranks", t->records) < 0
+        || shell_eventlogger_emit_event (t->shell->ev, "shell.timing") < 0)
+        shell_log_errno ("error posting shell.timing event");
+    flux_shell_remove_completion_ref (t->shell, "timing");
+}
+
+static int timing_append (struct shell_timing *t, json_t *record)
+{
+    if (json_array_append (t->records, record) < 0) {
+        errno = ENOMEM;
+        return -1;
+    }
+    if (json_array_size (t->records) == t->shell->info->shell_size)
+        timing_post (t);
+    return 0;
+}
+
+static void timing_timeout_cb (flux_reactor_t *r,
+                               flux_watcher_t *w,
+                               int revents,
+                               void *arg)
+{
+    struct shell_timing *t = arg;
+
+    shell_warn ("timing: %zu of %d shells reported",
+                json_array_size (t->records),
+                t->shell->info->shell_size);
+    timing_post (t);
+}
+
+static void timing_cb (flux_t *h,
+                       flux_msg_handler_t *mh,
+                       const flux_msg_t *msg,
+                       void *arg)
+{
+    struct shell_timing *t = arg;
+    json_t *record;
+
+    if (t->posted) // late record after timeout
+        return;
+    if (flux_request_unpack (msg, NULL, "o", &record) < 0
+        || timing_append (t, record) < 0)
+        shell_log_errno ("error handling timing record");
+}
+
+int shell_timing_enable (struct shell_timing *t, flux_shell_t *shell)
+{
+    int enabled = 0;
+
+    if (flux_shell_getopt_unpack (shell, "timing", "i", &enabled) < 0) {
+        shell_log_error ("timing option must be an integer");
+        return -1;
+    }
+    if (!enabled)
+        return 0;
+    t->shell = shell;
+    t->enabled = true;
+    plugstack_set_timer (shell->plugstack, plugin_timer_cb, t);
+    if (shell->info->shell_rank == 0) {
+        if (!(t->records = json_array ())
+            || !(t->timer = flux_timer_watcher_create (shell->r,
+                                                       collect_timeout,
+                                                       0.,
+                                                       timing_timeout_cb,
+                                                       t)))
+            return -1;
+        if (flux_shell_service_register (shell, "timing", timing_cb, t) < 0
+            || flux_shell_add_completion_ref (shell, "timing") < 0)
+            return -1;
+    }
+    return 0;
+}
+
+int shell_timing_report (struct shell_timing *t)
+{
+    json_t *record;
+    flux_future_t *f;
+    int rc = -1;
+
+    if (!t || !t->enabled)
+        return 0;
+    if (!(record = timing_record (t))) {
+        errno = ENOMEM;
+        return -1;
+    }
+    if (t->shell->info->shell_rank == 0) {
+        flux_watcher_start (t->timer);
+        if (timing_append (t, record) < 0)
+            goto out;
+    }
+    else {
+        if (!(f = flux_shell_rpc_pack (t->shell,
+                                       "timing",
+                                       0,
+                                       FLUX_RPC_NORESPONSE,
+                                       "O",
+                                       record)))
+            goto out;
+        flux_future_destroy (f);
+    }
+    rc = 0;
+out:
+    json_decref (record);
+    return rc;
+}
+
+/* vi: ts=4 sw=4 expandtab
+ */
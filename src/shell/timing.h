@@ -0,0 +1,46 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _SHELL_TIMING_H
+#define _SHELL_TIMING_H
+
+#include <flux/shell.h>
+
+/* Timestamps for shell startup phases and plugin callbacks.
+ *
+ * Phases are recorded unconditionally since that is cheap.  If the
+ * 'timing' shell option is set, plugin callbacks are timed as well, and
+ * once tasks have started, each shell sends its record to the leader,
+ * which posts them all in a shell.timing event to the exec eventlog.
+ */
+
+struct shell_timing *shell_timing_create (void);
+void shell_timing_destroy (struct shell_timing *t);
+
+/* Record the end of phase 'name', which began at the end of the
+ * previous phase, or when 't' was created.
+ */
+void shell_timing_phase (struct shell_timing *t, const char *name);
+
+/* If the timing option is set, start timing plugin callbacks and,
+ * on the leader, accept records from the other shells.
+ * Call after the shell service is created.
+ */
+int shell_timing_enable (struct shell_timing *t, flux_shell_t *shell);
+
+/* If enabled, send this shell's record to the leader.
+ * Call after the last startup phase has been recorded.
+ */
+int shell_timing_report (struct shell_timing *t);
+
+#endif /* !_SHELL_TIMING_H */
+
+/* vi: ts=4 sw=4 expandtab
+ */
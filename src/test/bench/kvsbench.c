@@ -0,0 +1,504 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* kvsbench - KVS and content store benchmarks
+ *
+ * Usage: kvsbench [OPTIONS] commit|append|fence|lookup|watch|store|load
+ *
+ * commit  Commit transactions that put --keys keys (default 1).  With one
+ *         key, the same key is overwritten by every commit.
+ * append  Commit transactions that append to one key.
+ * fence   Complete fences of --nprocs participants, each putting one key.
+ * lookup  Look up a key --depth directories deep.
+ * watch   Commit a key watched by --watchers watchers, timing each commit
+ *         until all watchers have seen the new value.
+ * store   Store unique blobs in the content store.
+ * load    Load blobs previously stored (not timed) from the content store.
+ *
+ * store and load go through the content cache unless --bypass is given,
+ * in which case they go directly to the backing module.  Cache size,
+ * flush batching, and the backing module itself are configured on the
+ * broker as usual (e.g. content.backing-module, and the content and kvs
+ * module options) and the backing module name is included in results.
+ *
+ * Each test is repeated for each value size in --size.  Results are
+ * printed on stdout as one JSON object per line, with the same fields
+ * as msgbench(1) results plus the test parameters, e.g.
+ *
+ *  {"test":"commit", "backend":"content-sqlite", "size":64, "keys":1,
+ *   "count":1000, "seconds":0.9, "rate":1111.1, "mbps":0.07,
+ *   "latency":{"min":610.0, "p50":802.1, "p99":1910.3, "max":3001.0}}
+ *
+ * Keys are created under kvsbench.PID, which is removed on exit.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <jansson.h>
+#include <flux/core.h>
+#include <flux/optparse.h>
+
+#include "src/common/libutil/log.h"
+#include "src/common/libutil/monotime.h"
+#include "src/common/libutil/parse_size.h"
+#include "src/common/libcontent/content.h"
+#include "ccan/str/str.h"
+
+#include "report.h"
+
+static const char *default_sizes = "64";
+
+static struct optparse_option opts[] = {
+    { .name = "size", .key = 's', .has_arg = 1, .arginfo = "LIST",
+      .flags = OPTPARSE_OPT_AUTOSPLIT,
+      .usage = "Value or blob sizes to test (default 64)",
+    },
+    { .name = "count", .key = 'c', .has_arg = 1, .arginfo = "N",
+      .usage = "Number of operations per size (default 1000)",
+    },
+    { .name = "keys", .key = 'k', .has_arg = 1, .arginfo = "N",
+      .usage = "commit: put N keys per transaction (default 1)",
+    },
+    { .name = "nprocs", .key = 'n', .has_arg = 1, .arginfo = "N",
+      .usage = "fence: number of participants (default 4)",
+    },
+    { .name = "depth", .key = 'd', .has_arg = 1, .arginfo = "N",
+      .usage = "lookup: directory depth of key (default 8)",
+    },
+    { .name = "watchers", .key = 'w', .has_arg = 1, .arginfo = "N",
+      .usage = "watch: number of watchers (default 16)",
+    },
+    { .name = "bypass", .key = 'b', .has_arg = 0,
+      .usage = "store, load: bypass the content cache",
+    },
+    OPTPARSE_TABLE_END
+};
+
+struct bench {
+    flux_t *h;
+    const char *test;
+    const char *backend;
+    char dir[64];
+    size_t size;
+    int count;
+    int keys;
+    int nprocs;
+    int depth;
+    int watchers;
+    int content_flags;
+    char *value;
+    double *latency;            // usec
+
+    /* watch test state */
+    int seq;
+    int seen;
+    struct timespec t_commit;
+};
+
+static void report (struct bench *b, double seconds)
+{
+    json_t *o;
+
+    o = json_pack ("{s:s s:s s:I}",
+                   "test", b->test,
+                   "backend", b->backend,
+                   "size", (json_int_t)b->size);
+    if (o && streq (b->test, "commit"))
+        json_object_set_new (o, "keys", json_integer (b->keys));
+    else if (o && streq (b->test, "fence"))
+        json_object_set_new (o, "nprocs", json_integer (b->nprocs));
+    else if (o && streq (b->test, "lookup"))
+        json_object_set_new (o, "depth", json_integer (b->depth));
+    else if (o && streq (b->test, "watch"))
+        json_object_set_new (o, "watchers", json_integer (b->watchers));
+    else if (o && (streq (b->test, "store") || streq (b->test, "load")))
+        json_object_set_new (o, "bypass", json_boolean (b->content_flags));
+    bench_report (o, b->count, b->size, seconds, b->latency);
+}
+
+/* Commit 'txn' and wait for it to complete.
+ */
+static void commit (struct bench *b, flux_kvs_txn_t *txn)
+{
+    flux_future_t *f;
+
+    if (!(f = flux_kvs_commit (b->h, NULL, 0, txn))
+        || flux_future_get (f, NULL) < 0)
+        log_msg_exit ("commit: %s", future_strerror (f, errno));
+    flux_future_destroy (f);
+}
+
+static void put (struct bench *b, const char *key, int flags)
+{
+    flux_kvs_txn_t *txn;
+
+    if (!(txn = flux_kvs_txn_create ())
+        || flux_kvs_txn_put_raw (txn, flags, key, b->value, b->size) < 0)
+        log_err_exit ("error preparing transaction");
+    commit (b, txn);
+    flux_kvs_txn_destroy (txn);
+}
+
+static void bench_commit (struct bench *b, int flags)
+{
+    struct timespec t0;
+    char key[128];
+
+    monotime (&t0);
+    for (int i = 0; i < b->count; i++) {
+        struct timespec t;
+        flux_kvs_txn_t *txn;
+
+        monotime (&t);
+        if (!(txn = flux_kvs_txn_create ()))
+            log_err_exit ("flux_kvs_txn_create");
+        for (int k = 0; k < b->keys; k++) {
+            snprintf (key, sizeof (key), "%s.commit.%d", b->dir, k);
+            if (flux_kvs_txn_put_raw (txn, flags, key, b->value, b->size) < 0)
+                log_err_exit ("flux_kvs_txn_put_raw");
+        }
+        commit (b, txn);
+        flux_kvs_txn_destroy (txn);
+        b->latency[i] = monotime_since (t) * 1000;
+    }
+    report (b, monotime_since (t0) / 1000);
+}
+
+static void bench_fence (struct bench *b)
+{
+    flux_future_t **f;
+    struct timespec t0;
+
+    if (!(f = calloc (b->nprocs, sizeof (f[0]))))
+        log_msg_exit ("out of memory");
+    monotime (&t0);
+    for (int i = 0; i < b->count; i++) {
+        struct timespec t;
+        char name[128];
+
+        monotime (&t);
+        snprintf (name, sizeof (name), "%s.%zu.%d", b->dir, b->size, i);
+        for (int n = 0; n < b->nprocs; n++) {
+            flux_kvs_txn_t *txn;
+            char key[128];
+
+            snprintf (key, sizeof (key), "%s.fence.%d", b->dir, n);
+            if (!(txn = flux_kvs_txn_create ())
+                || flux_kvs_txn_put_raw (txn, 0, key, b->value, b->size) < 0
+                || !(f[n] = flux_kvs_fence (b->h,
+                                            NULL,
+                                            0,
+                                            name,
+                                            b->nprocs,
+                                            txn)))
+                log_err_exit ("fence");
+            flux_kvs_txn_destroy (txn);
+        }
+        for (int n = 0; n < b->nprocs; n++) {
+            if (flux_future_get (f[n], NULL) < 0)
+                log_msg_exit ("fence: %s", future_strerror (f[n], errno));
+            flux_future_destroy (f[n]);
+        }
+        b->latency[i] = monotime_since (t) * 1000;
+    }
+    report (b, monotime_since (t0) / 1000);
+    free (f);
+}
+
+static void bench_lookup (struct bench *b)
+{
+    char key[1024];
+    int n;
+    struct timespec t0;
+
+    n = snprintf (key, sizeof (key), "%s.lookup", b->dir);
+    for (int i = 0; i < b->depth && n < sizeof (key); i++)
+        n += snprintf (key + n, sizeof (key) - n, ".d%d", i);
+    if (n >= sizeof (key))
+        log_msg_exit ("--depth is too large");
+    put (b, key, 0);
+
+    monotime (&t0);
+    for (int i = 0; i < b->count; i++) {
+        struct timespec t;
+        flux_future_t *f;
+        const void *data;
+        int len;
+
+        monotime (&t);
+        if (!(f = flux_kvs_lookup (b->h, NULL, 0, key))
+            || flux_kvs_lookup_get_raw (f, &data, &len) < 0)
+            log_msg_exit ("lookup: %s", future_strerror (f, errno));
+        flux_future_destroy (f);
+        b->latency[i] = monotime_since (t) * 1000;
+    }
+    report (b, monotime_since (t0) / 1000);
+}
+
+static void watch_commit (struct bench *b)
+{
+    char key[128];
+    char *val;
+    flux_kvs_txn_t *txn;
+    flux_future_t *f;
+
+    snprintf (key, sizeof (key), "%s.watch", b->dir);
+    if (asprintf (&val, "%d %s", b->seq, b->value) < 0)
+        log_msg_exit ("out of memory");
+    monotime (&b->t_commit);
+    if (!(txn = flux_kvs_txn_create ())
+        || flux_kvs_txn_put_raw (txn, 0, key, val, strlen (val) + 1) < 0
+        || !(f = flux_kvs_commit (b->h, NULL, 0, txn)))
+        log_err_exit ("commit");
+    flux_future_destroy (f); // completion is detected by the watchers
+    flux_kvs_txn_destroy (txn);
+    free (val);
+}
+
+static void watch_continuation (flux_future_t *f, void *arg)
+{
+    struct bench *b = arg;
+    const void *data;
+    int len;
+
+    if (flux_kvs_lookup_get_raw (f, &data, &len) < 0)
+        log_msg_exit ("watch: %s", future_strerror (f, errno));
+    if (len > 0 && strtol (data, NULL, 10) == b->seq) {
+        if (++b->seen == b->watchers) {
+            b->latency[b->seq] = monotime_since (b->t_commit) * 1000;
+            b->seen = 0;
+            if (++b->seq == b->count)
+                flux_reactor_stop (flux_get_reactor (b->h));
+            else
+                watch_commit (b);
+        }
+    }
+    flux_future_reset (f);
+}
+
+static void bench_watch (struct bench *b)
+{
+    flux_future_t **f;
+    char key[128];
+    struct timespec t0;
+
+    if (!(f = calloc (b->watchers, sizeof (f[0]))))
+        log_msg_exit ("out of memory");
+    snprintf (key, sizeof (key), "%s.watch", b->dir);
+    put (b, key, 0);
+    for (int n = 0; n < b->watchers; n++) {
+        if (!(f[n] = flux_kvs_lookup (b->h, NULL, FLUX_KVS_WATCH, key))
+            || flux_kvs_lookup_get_raw (f[n], NULL, NULL) < 0)
+            log_err_exit ("watch");
+        flux_future_reset (f[n]);
+        if (flux_future_then (f[n], -1., watch_continuation, b) < 0)
+            log_err_exit ("flux_future_then");
+    }
+    b->seq = 0;
+    b->seen = 0;
+    monotime (&t0);
+    watch_commit (b);
+    if (flux_reactor_run (flux_get_reactor (b->h), 0) < 0)
+        log_err_exit ("flux_reactor_run");
+    report (b, monotime_since (t0) / 1000);
+    for (int n = 0; n < b->watchers; n++)
+        flux_future_destroy (f[n]);
+    free (f);
+}
+
+/* Store 'count' blobs, made unique by a sequence number, and return their
+ * concatenated hashes if 'hashes' is non-NULL.
+ */
+static void store (struct bench *b, char **hashes, int *hash_len)
+{
+    static unsigned int seq = 0;
+    char *buf;
+    struct timespec t0;
+
+    if (!(buf = calloc (1, b->size)))
+        log_msg_exit ("out of memory");
+    monotime (&t0);
+    for (int i = 0; i < b->count; i++) {
+        struct timespec t;
+        flux_future_t *f;
+        const void *hash;
+        int n;
+
+        snprintf (buf, b->size, "kvsbench %d %u", (int)getpid (), seq++);
+        monotime (&t);
+        if (!(f = content_store (b->h, buf, b->size, b->content_flags))
+            || content_store_get_hash (f, &hash, &n) < 0)
+            log_msg_exit ("store: %s", future_strerror (f, errno));
+        b->latency[i] = monotime_since (t) * 1000;
+        if (hashes) {
+            if (i == 0 && !(*hashes = malloc (n * b->count)))
+                log_msg_exit ("out of memory");
+            memcpy (*hashes + i * n, hash, n);
+            *hash_len = n;
+        }
+        flux_future_destroy (f);
+    }
+    if (!hashes)
+        report (b, monotime_since (t0) / 1000);
+    free (buf);
+}
+
+static void bench_load (struct bench *b)
+{
+    char *hashes;
+    int hash_len;
+    struct timespec t0;
+
+    store (b, &hashes, &hash_len);
+    monotime (&t0);
+    for (int i = 0; i < b->count; i++) {
+        struct timespec t;
+        flux_future_t *f;
+        const void *data;
+        int len;
+
+        monotime (&t);
+        if (!(f = content_load_byhash (b->h,
+                                       hashes + i * hash_len,
+                                       hash_len,
+                                       b->content_flags))
+            || content_load_get (f, &data, &len) < 0)
+            log_msg_exit ("load: %s", future_strerror (f, errno));
+        flux_future_destroy (f);
+        b->latency[i] = monotime_since (t) * 1000;
+    }
+    report (b, monotime_since (t0) / 1000);
+    free (hashes);
+}
+
+static void run_size (struct bench *b, const char *arg)
+{
+    uint64_t size;
+
+    if (parse_size (arg, &size) < 0)
+        log_msg_exit ("invalid size: %s", arg);
+    b->size = size;
+    if (streq (b->test, "store") || streq (b->test, "load")) {
+        if (size < 32)
+            log_msg_exit ("store and load sizes must be at least 32");
+    }
+    free (b->value);
+    if (!(b->value = malloc (size + 1)))
+        log_msg_exit ("out of memory");
+    memset (b->value, 'x', size);
+    b->value[size] = '\0';
+
+    if (streq (b->test, "commit"))
+        bench_commit (b, 0);
+    else if (streq (b->test, "append"))
+        bench_commit (b, FLUX_KVS_APPEND);
+    else if (streq (b->test, "fence"))
+        bench_fence (b);
+    else if (streq (b->test, "lookup"))
+        bench_lookup (b);
+    else if (streq (b->test, "watch"))
+        bench_watch (b);
+    else if (streq (b->test, "store"))
+        store (b, NULL, NULL);
+    else
+        bench_load (b);
+}
+
+static void run (struct bench *b, optparse_t *p)
+{
+    const char *arg;
+
+    if (!optparse_hasopt (p, "size")) {
+        run_size (b, default_sizes);
+        return;
+    }
+    optparse_getopt_iterator_reset (p, "size");
+    while ((arg = optparse_getopt_next (p, "size")))
+        run_size (b, arg);
+}
+
+static void cleanup (struct bench *b)
+{
+    flux_kvs_txn_t *txn;
+
+    if (!(txn = flux_kvs_txn_create ())
+        || flux_kvs_txn_unlink (txn, 0, b->dir) < 0)
+        log_err_exit ("error preparing transaction");
+    commit (b, txn);
+    flux_kvs_txn_destroy (txn);
+}
+
+int main (int argc, char *argv[])
+{
+    const char *tests[] = {
+        "commit", "append", "fence", "lookup", "watch", "store", "load", NULL
+    };
+    optparse_t *p;
+    int optindex;
+    struct bench b = { 0 };
+    int i;
+
+    log_init ("kvsbench");
+
+    if (!(p = optparse_create ("kvsbench"))
+        || optparse_add_option_table (p, opts) != OPTPARSE_SUCCESS
+        || optparse_set (p,
+                         OPTPARSE_USAGE,
+                         "[OPTIONS] commit|append|fence|lookup|watch|store|load")
+           != OPTPARSE_SUCCESS)
+        log_msg_exit ("error setting up option parsing");
+    if ((optindex = optparse_parse_args (p, argc, argv)) < 0)
+        exit (1);
+    if (optindex != argc - 1) {
+        optparse_print_usage (p);
+        exit (1);
+    }
+    b.test = argv[optindex];
+    for (i = 0; tests[i] != NULL; i++) {
+        if (streq (b.test, tests[i]))
+            break;
+    }
+    if (!tests[i])
+        log_msg_exit ("unknown test: %s", b.test);
+    if ((b.count = optparse_get_int (p, "count", 1000)) < 1
+        || (b.keys = optparse_get_int (p, "keys", 1)) < 1
+        || (b.nprocs = optparse_get_int (p, "nprocs", 4)) < 1
+        || (b.depth = optparse_get_int (p, "depth", 8)) < 0
+        || (b.watchers = optparse_get_int (p, "watchers", 16)) < 1)
+        log_msg_exit ("numeric options must be positive");
+    if (optparse_hasopt (p, "bypass"))
+        b.content_flags = CONTENT_FLAG_CACHE_BYPASS;
+    if (!(b.latency = calloc (b.count, sizeof (b.latency[0]))))
+        log_msg_exit ("out of memory");
+    snprintf (b.dir, sizeof (b.dir), "kvsbench.%d", (int)getpid ());
+
+    if (!(b.h = flux_open (NULL, 0)))
+        log_err_exit ("flux_open");
+    if (!(b.backend = flux_attr_get (b.h, "content.backing-module")))
+        b.backend = "none";
+
+    run (&b, p);
+
+    if (!streq (b.test, "store") && !streq (b.test, "load"))
+        cleanup (&b);
+    flux_close (b.h);
+    free (b.value);
+    free (b.latency);
+    optparse_destroy (p);
+    log_fini ();
+    return 0;
+}
+
+// vi: ts=4 sw=4 expandtab
@@ -0,0 +1,465 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* msgbench - message layer microbenchmarks
+ *
+ * Usage: msgbench [OPTIONS] encode|rpc|event
+ *
+ * encode  Time flux_msg_encode() and flux_msg_decode() of request messages.
+ * rpc     Time echo RPCs.  By default, broker.ping requests are sent to the
+ *         local broker over FLUX_URI (or --uri).  With --rank, requests are
+ *         routed over the overlay network to that rank.  With
+ *         --uri=interthread, an echo server is run in a thread of this
+ *         process, which isolates the cost of the message layer.
+ * event   Time publication of events and their delivery back to this
+ *         process.  Run on a rank other than 0 to include the overlay hops
+ *         to the rank 0 sequencer and back.
+ *
+ * Each test is repeated for each payload size in --size.  Results are
+ * printed on stdout as one JSON object per line, e.g.
+ *
+ *  {"test":"rpc", "path":"local", "size":1024, "count":1000, "window":1,
+ *   "seconds":0.08, "rate":12500.0, "mbps":12.8,
+ *   "latency":{"min":61.0, "p50":75.2, "p99":140.3, "max":301.1}}
+ *
+ * where "rate" is operations per second, "mbps" is payload megabytes per
+ * second, and "latency" is in microseconds (rpc and event only).
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <jansson.h>
+#include <flux/core.h>
+#include <flux/optparse.h>
+
+#include "src/common/libutil/log.h"
+#include "src/common/libutil/monotime.h"
+#include "src/common/libutil/parse_size.h"
+#include "ccan/str/str.h"
+
+#include "report.h"
+
+static const char *default_sizes = "0,64,1K,16K,256K,1M";
+
+static struct optparse_option opts[] = {
+    { .name = "size", .key = 's', .has_arg = 1, .arginfo = "LIST",
+      .flags = OPTPARSE_OPT_AUTOSPLIT,
+      .usage = "Payload sizes to test (default 0,64,1K,16K,256K,1M)",
+    },
+    { .name = "count", .key = 'c', .has_arg = 1, .arginfo = "N",
+      .usage = "Number of operations per size (default 1000)",
+    },
+    { .name = "window", .key = 'w', .has_arg = 1, .arginfo = "N",
+      .usage = "Keep N rpcs or events in flight (default 1)",
+    },
+    { .name = "rank", .key = 'r', .has_arg = 1, .arginfo = "N",
+      .usage = "Send rpcs to broker rank N (default local broker)",
+    },
+    { .name = "uri", .key = 'u', .has_arg = 1, .arginfo = "URI",
+      .usage = "Connect to URI, or 'interthread' for an in-process server",
+    },
+    OPTPARSE_TABLE_END
+};
+
+struct bench {
+    flux_t *h;
+    const char *test;
+    const char *path;
+    size_t size;
+    int count;
+    int window;
+    uint32_t nodeid;
+    char *payload;              // json object string with 'size' byte pad
+    char topic[64];
+
+    int sent;
+    int received;
+    struct timespec *t_sent;
+    double *latency;            // usec
+    struct timespec t0;
+};
+
+static void report (struct bench *b, double seconds, const char *op)
+{
+    json_t *o;
+
+    o = json_pack ("{s:s s:s s:I s:i}",
+                   "test", op ? op : b->test,
+                   "path", b->path,
+                   "size", (json_int_t)b->size,
+                   "window", b->window);
+    bench_report (o, b->count, b->size, seconds, b->latency);
+}
+
+static char *make_payload (size_t size, int seq)
+{
+    char *pad;
+    json_t *o;
+    char *s;
+
+    if (!(pad = malloc (size + 1)))
+        log_msg_exit ("out of memory");
+    memset (pad, 'x', size);
+    pad[size] = '\0';
+    if (!(o = json_pack ("{s:i s:s}", "seq", seq, "pad", pad))
+        || !(s = json_dumps (o, JSON_COMPACT)))
+        log_msg_exit ("error creating payload");
+    json_decref (o);
+    free (pad);
+    return s;
+}
+
+/* encode
+ */
+
+static void bench_encode (struct bench *b)
+{
+    flux_msg_t *msg;
+    char *pad;
+    void *buf;
+    ssize_t n;
+    struct timespec t;
+
+    if (!(pad = calloc (1, b->size + 1)))
+        log_msg_exit ("out of memory");
+    if (!(msg = flux_request_encode_raw ("msgbench.encode", pad, b->size))
+        || flux_msg_set_rolemask (msg, FLUX_ROLE_OWNER) < 0
+        || flux_msg_set_userid (msg, getuid ()) < 0
+        || (n = flux_msg_encode_size (msg)) < 0)
+        log_err_exit ("error creating message");
+    if (!(buf = malloc (n)))
+        log_msg_exit ("out of memory");
+
+    monotime (&t);
+    for (int i = 0; i < b->count; i++) {
+        if (flux_msg_encode_size (msg) != n
+            || flux_msg_encode (msg, buf, n) < 0)
+            log_err_exit ("flux_msg_encode");
+    }
+    report (b, monotime_since (t) / 1000, "encode");
+
+    monotime (&t);
+    for (int i = 0; i < b->count; i++) {
+        flux_msg_t *cpy;
+        if (!(cpy = flux_msg_decode (buf, n)))
+            log_err_exit ("flux_msg_decode");
+        flux_msg_destroy (cpy);
+    }
+    report (b, monotime_since (t) / 1000, "decode");
+
+    free (buf);
+    flux_msg_destroy (msg);
+    free (pad);
+}
+
+/* rpc
+ */
+
+static void rpc_send (struct bench *b);
+
+static void rpc_continuation (flux_future_t *f, void *arg)
+{
+    struct bench *b = arg;
+    int seq = (intptr_t)flux_future_aux_get (f, "seq");
+
+    if (flux_future_get (f, NULL) < 0)
+        log_msg_exit ("%s: %s", b->topic, future_strerror (f, errno));
+    b->latency[seq] = monotime_since (b->t_sent[seq]) * 1000;
+    flux_future_destroy (f);
+    if (++b->received == b->count)
+        flux_reactor_stop (flux_get_reactor (b->h));
+    else if (b->sent < b->count)
+        rpc_send (b);
+}
+
+static void rpc_send (struct bench *b)
+{
+    flux_future_t *f;
+    int seq = b->sent++;
+
+    monotime (&b->t_sent[seq]);
+    if (!(f = flux_rpc (b->h, b->topic, b->payload, b->nodeid, 0))
+        || flux_future_aux_set (f, "seq", (void *)(intptr_t)seq, NULL) < 0
+        || flux_future_then (f, -1., rpc_continuation, b) < 0)
+        log_err_exit ("%s", b->topic);
+}
+
+static void bench_rpc (struct bench *b)
+{
+    b->payload = make_payload (b->size, 0);
+    monotime (&b->t0);
+    while (b->sent < b->count && b->sent < b->window)
+        rpc_send (b);
+    if (flux_reactor_run (flux_get_reactor (b->h), 0) < 0)
+        log_err_exit ("flux_reactor_run");
+    report (b, monotime_since (b->t0) / 1000, NULL);
+    free (b->payload);
+}
+
+/* Echo server thread for --uri=interthread.
+ */
+
+static void echo_cb (flux_t *h,
+                     flux_msg_handler_t *mh,
+                     const flux_msg_t *msg,
+                     void *arg)
+{
+    const char *s;
+
+    if (flux_request_decode (msg, NULL, &s) < 0
+        || flux_respond (h, msg, s) < 0)
+        log_err ("error responding to echo request");
+}
+
+static void shutdown_cb (flux_t *h,
+                         flux_msg_handler_t *mh,
+                         const flux_msg_t *msg,
+                         void *arg)
+{
+    flux_reactor_stop (flux_get_reactor (h));
+}
+
+static const struct flux_msg_handler_spec htab[] = {
+    { FLUX_MSGTYPE_REQUEST, "msgbench.echo", echo_cb, 0 },
+    { FLUX_MSGTYPE_REQUEST, "msgbench.shutdown", shutdown_cb, 0 },
+    FLUX_MSGHANDLER_TABLE_END,
+};
+
+static void *server_thread (void *arg)
+{
+    flux_t *h = arg;
+    flux_msg_handler_t **handlers;
+
+    if (flux_msg_handler_addvec (h, htab, NULL, &handlers) < 0)
+        log_err_exit ("flux_msg_handler_addvec");
+    if (flux_reactor_run (flux_get_reactor (h), 0) < 0)
+        log_err_exit ("flux_reactor_run");
+    flux_msg_handler_delvec (handlers);
+    return NULL;
+}
+
+static flux_t *server_create (pthread_t *tid)
+{
+    char uri[64];
+    flux_t *h;
+    flux_reactor_t *r;
+    int e;
+
+    snprintf (uri, sizeof (uri), "interthread://msgbench-%d", (int)getpid ());
+    if (!(h = flux_open (uri, 0))
+        || !(r = flux_reactor_create (0))
+        || flux_set_reactor (h, r) < 0
+        || flux_aux_set (h, NULL, r, (flux_free_f)flux_reactor_destroy) < 0
+        || flux_opt_set (h, FLUX_OPT_ROUTER_NAME, "server", 7) < 0)
+        log_err_exit ("error creating server handle");
+    if ((e = pthread_create (tid, NULL, server_thread, h)) != 0)
+        log_errn_exit (e, "pthread_create");
+    if (!(h = flux_open (uri, 0)))
+        log_err_exit ("error creating client handle");
+    return h;
+}
+
+static void server_destroy (flux_t *h, pthread_t tid)
+{
+    flux_future_t *f;
+    int e;
+
+    if (!(f = flux_rpc (h, "msgbench.shutdown", NULL, 0, FLUX_RPC_NORESPONSE)))
+        log_err_exit ("msgbench.shutdown");
+    flux_future_destroy (f);
+    if ((e = pthread_join (tid, NULL)) != 0)
+        log_errn_exit (e, "pthread_join");
+}
+
+/* event
+ */
+
+static void event_publish (struct bench *b)
+{
+    flux_future_t *f;
+    char *s;
+    int seq = b->sent++;
+
+    s = make_payload (b->size, seq);
+    monotime (&b->t_sent[seq]);
+    if (!(f = flux_event_publish (b->h, b->topic, 0, s)))
+        log_err_exit ("flux_event_publish");
+    flux_future_destroy (f); // publish response is not needed
+    free (s);
+}
+
+static void event_cb (flux_t *h,
+                      flux_msg_handler_t *mh,
+                      const flux_msg_t *msg,
+                      void *arg)
+{
+    struct bench *b = arg;
+    int seq;
+
+    if (flux_event_unpack (msg, NULL, "{s:i}", "seq", &seq) < 0
+        || seq < 0
+        || seq >= b->sent)
+        log_msg_exit ("malformed event");
+    b->latency[seq] = monotime_since (b->t_sent[seq]) * 1000;
+    if (++b->received == b->count)
+        flux_reactor_stop (flux_get_reactor (h));
+    else if (b->sent < b->count)
+        event_publish (b);
+}
+
+static void bench_event (struct bench *b)
+{
+    struct flux_match match = FLUX_MATCH_EVENT;
+    flux_msg_handler_t *mh;
+
+    match.topic_glob = b->topic;
+    if (flux_event_subscribe (b->h, b->topic) < 0
+        || !(mh = flux_msg_handler_create (b->h, match, event_cb, b)))
+        log_err_exit ("error subscribing to %s", b->topic);
+    flux_msg_handler_start (mh);
+    monotime (&b->t0);
+    while (b->sent < b->count && b->sent < b->window)
+        event_publish (b);
+    if (flux_reactor_run (flux_get_reactor (b->h), 0) < 0)
+        log_err_exit ("flux_reactor_run");
+    report (b, monotime_since (b->t0) / 1000, NULL);
+    flux_msg_handler_destroy (mh);
+    if (flux_event_unsubscribe (b->h, b->topic) < 0)
+        log_err_exit ("error unsubscribing from %s", b->topic);
+}
+
+static void run_size (struct bench *b, const char *arg)
+{
+    uint64_t size;
+
+    if (parse_size (arg, &size) < 0)
+        log_msg_exit ("invalid size: %s", arg);
+    b->size = size;
+    b->sent = 0;
+    b->received = 0;
+    if (streq (b->test, "encode"))
+        bench_encode (b);
+    else if (streq (b->test, "rpc"))
+        bench_rpc (b);
+    else
+        bench_event (b);
+}
+
+static void run (struct bench *b, optparse_t *p)
+{
+    const char *arg;
+
+    if (!optparse_hasopt (p, "size")) {
+        char *cpy;
+        char *saveptr = NULL;
+        char *tok;
+
+        if (!(cpy = strdup (default_sizes)))
+            log_msg_exit ("out of memory");
+        tok = strtok_r (cpy, ",", &saveptr);
+        while (tok) {
+            run_size (b, tok);
+            tok = strtok_r (NULL, ",", &saveptr);
+        }
+        free (cpy);
+        return;
+    }
+    optparse_getopt_iterator_reset (p, "size");
+    while ((arg = optparse_getopt_next (p, "size")))
+        run_size (b, arg);
+}
+
+int main (int argc, char *argv[])
+{
+    optparse_t *p;
+    int optindex;
+    struct bench b = { 0 };
+    const char *uri;
+    pthread_t tid;
+    bool interthread = false;
+
+    log_init ("msgbench");
+
+    if (!(p = optparse_create ("msgbench"))
+        || optparse_add_option_table (p, opts) != OPTPARSE_SUCCESS
+        || optparse_set (p,
+                         OPTPARSE_USAGE,
+                         "[OPTIONS] encode|rpc|event") != OPTPARSE_SUCCESS)
+        log_msg_exit ("error setting up option parsing");
+    if ((optindex = optparse_parse_args (p, argc, argv)) < 0)
+        exit (1);
+    if (optindex != argc - 1) {
+        optparse_print_usage (p);
+        exit (1);
+    }
+    b.test = argv[optindex];
+    if (!streq (b.test, "encode")
+        && !streq (b.test, "rpc")
+        && !streq (b.test, "event"))
+        log_msg_exit ("unknown test: %s", b.test);
+    if ((b.count = optparse_get_int (p, "count", 1000)) < 1)
+        log_msg_exit ("--count must be at least 1");
+    if ((b.window = optparse_get_int (p, "window", 1)) < 1)
+        log_msg_exit ("--window must be at least 1");
+    b.nodeid = FLUX_NODEID_ANY;
+    if (optparse_hasopt (p, "rank")) {
+        int rank = optparse_get_int (p, "rank", -1);
+        if (rank < 0)
+            log_msg_exit ("--rank must be a non-negative integer");
+        b.nodeid = rank;
+    }
+    uri = optparse_get_str (p, "uri", NULL);
+
+    if (streq (b.test, "encode"))
+        b.path = "none";
+    else if (uri && streq (uri, "interthread")) {
+        if (streq (b.test, "event"))
+            log_msg_exit ("event test requires a broker connection");
+        if (b.nodeid != FLUX_NODEID_ANY)
+            log_msg_exit ("--rank cannot be used with --uri=interthread");
+        interthread = true;
+        b.path = "interthread";
+        b.h = server_create (&tid);
+        snprintf (b.topic, sizeof (b.topic), "msgbench.echo");
+    }
+    else {
+        if (!(b.h = flux_open (uri, 0)))
+            log_err_exit ("flux_open");
+        b.path = b.nodeid == FLUX_NODEID_ANY ? "local" : "overlay";
+        if (streq (b.test, "rpc"))
+            snprintf (b.topic, sizeof (b.topic), "broker.ping");
+        else
+            snprintf (b.topic, sizeof (b.topic), "msgbench.%d", (int)getpid ());
+    }
+    if (!streq (b.test, "encode")) {
+        if (!(b.t_sent = calloc (b.count, sizeof (b.t_sent[0])))
+            || !(b.latency = calloc (b.count, sizeof (b.latency[0]))))
+            log_msg_exit ("out of memory");
+    }
+
+    run (&b, p);
+
+    if (interthread)
+        server_destroy (b.h, tid);
+    flux_close (b.h);
+    free (b.t_sent);
+    free (b.latency);
+    optparse_destroy (p);
+    log_fini ();
+    return 0;
+}
+
+// vi: ts=4 sw=4 expandtab
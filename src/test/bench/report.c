@@ -0,0 +1,66 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdlib.h>
+#include <stdio.h>
+#include <jansson.h>
+
+#include "src/common/libutil/log.h"
+
+#include "report.h"
+
+static int cmpdouble (const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return x < y ? -1 : x > y ? 1 : 0;
+}
+
+void bench_report (json_t *o,
+                   int count,
+                   size_t size,
+                   double seconds,
+                   double *latency)
+{
+    json_t *val;
+    char *s;
+
+    if (!o
+        || !(val = json_pack ("{s:i s:f s:f s:f}",
+                              "count", count,
+                              "seconds", seconds,
+                              "rate", seconds > 0 ? count / seconds : 0.,
+                              "mbps", seconds > 0 ?
+                                 1E-6 * size * count / seconds : 0.))
+        || json_object_update (o, val) < 0)
+        log_msg_exit ("error creating result object");
+    json_decref (val);
+    if (latency && count > 0) {
+        qsort (latency, count, sizeof (latency[0]), cmpdouble);
+        if (!(val = json_pack ("{s:f s:f s:f s:f}",
+                               "min", latency[0],
+                               "p50", latency[count / 2],
+                               "p99", latency[(count * 99) / 100],
+                               "max", latency[count - 1]))
+            || json_object_set_new (o, "latency", val) < 0)
+            log_msg_exit ("error creating result object");
+    }
+    if (!(s = json_dumps (o, JSON_COMPACT)))
+        log_msg_exit ("error encoding result object");
+    printf ("%s\n", s);
+    fflush (stdout);
+    free (s);
+    json_decref (o);
+}
+
+// vi: ts=4 sw=4 expandtab
@@ -0,0 +1,30 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _BENCH_REPORT_H
+#define _BENCH_REPORT_H
+
+#include <jansson.h>
+
+/* Add "count", "seconds", "rate" (ops/s) and "mbps" (payload MB/s) to
+ * result object 'o'.  If 'latency' is non-NULL, it holds 'count' samples
+ * in microseconds and is sorted in place to add a "latency" object with
+ * "min", "p50", "p99", and "max".  Print 'o' on stdout as one line and
+ * release it.  Exit on error.
+ */
+void bench_report (json_t *o,
+                   int count,
+                   size_t size,
+                   double seconds,
+                   double *latency);
+
+#endif /* !_BENCH_REPORT_H */
+
+// vi: ts=4 sw=4 expandtab
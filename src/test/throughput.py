@@ -67,6 +67,29 @@ def parse_args():
         help="Log job events",
         action="store_true",
     )
+    parser.add_argument(
+        "-S",
+        "--stages",
+        help="Print per-stage job latency percentiles",
+        action="store_true",
+    )
+    parser.add_argument(
+        "--exec-events",
+        help="With --stages, also fetch exec eventlogs for shell stages",
+        action="store_true",
+    )
+    parser.add_argument(
+        "--module-stats",
+        action="append",
+        help="Snapshot stats of MODULE before and after (multiple use OK)",
+        metavar="MODULE",
+    )
+    parser.add_argument(
+        "-j",
+        "--json",
+        help="Write results as JSON to FILE",
+        metavar="FILE",
+    )
     parser.add_argument("command", nargs=argparse.REMAINDER, default=["true"])
 
     return parser.parse_args()
@@ -109,6 +132,103 @@ def create_test_jobspec(args):
     return jobspec
 
 
+#  Job stages as (name, start event, end event).  Event names prefixed
+#  with "exec." are from the exec eventlog, fetched with --exec-events.
+#  "request" is the time the submit request was sent.
+STAGES = [
+    ("ingest", "request", "submit"),
+    ("validate", "submit", "validate"),
+    ("depend", "validate", "depend"),
+    ("priority", "depend", "priority"),
+    ("sched", "priority", "alloc"),
+    ("exec-init", "alloc", "exec.init"),
+    ("shell-start", "exec.starting", "exec.shell.start"),
+    ("start", "alloc", "start"),
+    ("run", "start", "finish"),
+    ("release", "finish", "free"),
+    ("inactive", "free", "clean"),
+]
+
+
+def percentile(values, pct):
+    return values[min(len(values) - 1, int(len(values) * pct / 100))]
+
+
+def stage_latencies(jobs):
+    """Return a dict of stage name to sorted list of latencies in seconds"""
+    result = {}
+    for name, start, end in STAGES:
+        values = []
+        for info in jobs.values():
+            times = info["times"]
+            if start in times and end in times:
+                values.append(times[end] - times[start])
+        if values:
+            result[name] = sorted(values)
+    return result
+
+
+def stage_summary(latencies):
+    """Summarize stage latencies as percentiles and a log2 histogram"""
+    summary = {}
+    for name, values in latencies.items():
+        #  histogram buckets are powers of 2 microseconds: bucket N counts
+        #  latencies in [2^(N-1), 2^N) usec
+        histogram = {}
+        for val in values:
+            bucket = max(0, int(val * 1e6)).bit_length()
+            histogram[bucket] = histogram.get(bucket, 0) + 1
+        summary[name] = {
+            "count": len(values),
+            "min": values[0],
+            "p50": percentile(values, 50),
+            "p90": percentile(values, 90),
+            "p99": percentile(values, 99),
+            "max": values[-1],
+            "histogram": {str(k): v for k, v in sorted(histogram.items())},
+        }
+    return summary
+
+
+def print_stages(summary):
+    print(f"{'STAGE':<12} {'P50':>9} {'P90':>9} {'P99':>9} {'MAX':>9} (ms)")
+    for name, stats in summary.items():
+        print(
+            f"{name:<12} {stats['p50']*1E3:>9.3f} {stats['p90']*1E3:>9.3f} "
+            f"{stats['p99']*1E3:>9.3f} {stats['max']*1E3:>9.3f}"
+        )
+
+
+def module_stats(handle, modules):
+    result = {}
+    for name in modules or []:
+        try:
+            result[name] = handle.rpc(f"{name}.stats-get").get()
+        except OSError as exc:
+            print(f"{name}.stats-get: {exc}", file=sys.stderr)
+    return result
+
+
+def stats_delta(before, after, prefix=""):
+    """Return a list of (key, before, after) for numeric values that changed"""
+    changed = []
+    for key, val in after.items():
+        old = before.get(key) if isinstance(before, dict) else None
+        if isinstance(val, dict):
+            changed.extend(stats_delta(old or {}, val, f"{prefix}{key}."))
+        elif isinstance(val, (int, float)) and not isinstance(val, bool):
+            if old != val:
+                changed.append((f"{prefix}{key}", old, val))
+    return changed
+
+
+def print_module_stats(before, after):
+    for name in after:
+        print(f"{name} stats:")
+        for key, old, new in stats_delta(before.get(name, {}), after[name]):
+            print(f"  {key:<40} {old!s:>12} -> {new!s:<12}")
+
+
 class BulkRun:
 
     # pylint: disable=too-many-instance-attributes
@@ -134,6 +254,7 @@ class BulkRun:
         if event is not None:
             if args.verbose:
                 print(f"{jobid}: {event.name}")
+            self.jobs[jobid]["times"].setdefault(event.name, event.timestamp)
             if event.name == "submit":
                 self.submitted += 1
                 self.jobs[jobid][event.name] = event
@@ -147,22 +268,45 @@ class BulkRun:
             if self.bbar:
                 self.bbar.update()
 
-    def handle_submit(self, args, jobid):
-        self.jobs[jobid] = {"t_submit": time.time()}
+    def handle_submit(self, args, jobid, t_request):
+        self.jobs[jobid] = {
+            "t_submit": time.time(),
+            "times": {"request": t_request},
+        }
         fut = job.event_watch_async(self.handle, jobid)
         fut.then(self.event_cb, args, jobid)
 
-    def submit_cb(self, future, args):
+    def submit_cb(self, future, args, t_request):
         # pylint: disable=broad-except
         try:
-            self.handle_submit(args, future.get_id())
+            self.handle_submit(args, future.get_id(), t_request)
         except Exception as exc:
             print(f"Submission failed: {exc}", file=sys.stderr)
 
     def submit_async(self, args):
         spec = self.jobspec.dumps()
         for _ in range(args.njobs):
-            job.submit_async(self.handle, spec).then(self.submit_cb, args)
+            job.submit_async(self.handle, spec).then(
+                self.submit_cb, args, time.time()
+            )
+
+    def exec_event_cb(self, future, jobid):
+        try:
+            event = future.get_event()
+        except OSError:  # e.g. job never started
+            return
+        if event is not None:
+            name = f"exec.{event.name}"
+            self.jobs[jobid]["times"].setdefault(name, event.timestamp)
+
+    def fetch_exec_events(self):
+        """Fetch the exec eventlog of each (inactive) job"""
+        for jobid in self.jobs:
+            fut = job.event_watch_async(
+                self.handle, jobid, eventlog="guest.exec.eventlog"
+            )
+            fut.then(self.exec_event_cb, jobid)
+        self.handle.reactor_run()
 
     def run(self, args):
         if args.status:
@@ -186,7 +330,12 @@ def main():
 
     jobspec = create_test_jobspec(args)
 
-    bulk = BulkRun(flux.Flux(), args.njobs, jobspec).run(args)
+    handle = flux.Flux()
+    stats_before = module_stats(handle, args.module_stats)
+
+    bulk = BulkRun(handle, args.njobs, jobspec).run(args)
+
+    stats_after = module_stats(handle, args.module_stats)
 
     jobs = bulk.jobs
 
@@ -212,6 +361,28 @@ def main():
     print(f"job runtime:    {job_runtime:<6.3f}s")
     print(f"throughput:     {jps:<.1f} job/s (script: {jpsb:5.1f} job/s)")
 
+    summary = {}
+    if args.stages or args.json:
+        if args.exec_events:
+            bulk.fetch_exec_events()
+        summary = stage_summary(stage_latencies(jobs))
+    if args.stages:
+        print_stages(summary)
+    if args.module_stats:
+        print_module_stats(stats_before, stats_after)
+    if args.json:
+        result = {
+            "njobs": args.njobs,
+            "submit_time": submit_time,
+            "script_runtime": script_runtime,
+            "job_runtime": job_runtime,
+            "throughput": jps,
+            "stages": summary,
+            "module_stats": {"before": stats_before, "after": stats_after},
+        }
+        with open(args.json, "w", encoding="utf-8") as fp:
+            json.dump(result, fp, indent=2)
+
 
 if __name__ == "__main__":
     main()
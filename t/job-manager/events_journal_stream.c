@@ -15,6 +15,8 @@
 #include <jansson.h>
 #include <signal.h>
 #include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
 #include <flux/core.h>
 
 #include "src/common/libutil/read_all.h"
@@ -40,12 +42,15 @@ int main (int argc, char *argv[])
 {
     ssize_t inlen;
     void *inbuf;
+    bool show_seq = false;
 
     if (!(h = flux_open (NULL, 0)))
         log_err_exit ("flux_open");
 
-    if (argc != 1) {
-        fprintf (stderr, "Usage: events_journal_stream <payload\n");
+    if (argc == 2 && !strcmp (argv[1], "--seq"))
+        show_seq = true;
+    else if (argc != 1) {
+        fprintf (stderr, "Usage: events_journal_stream [--seq] <payload\n");
         exit (1);
     }
 
@@ -70,15 +75,37 @@ int main (int argc, char *argv[])
         json_t *events;
         size_t index;
         json_t *entry;
+        json_int_t seq = -1;
+        int resumed = 0;
+        int purged = 0;
         if (flux_rpc_get_unpack (f,
-                                 "{s:I s:o}",
+                                 "{s:I s:o s?I s?b s?b}",
                                  "id", &id,
-                                 "events", &events) < 0) {
+                                 "events", &events,
+                                 "seq", &seq,
+                                 "resumed", &resumed,
+                                 "purged", &purged) < 0) {
             if (errno == ENODATA)
                 break;
             log_msg_exit ("job-manager.events-journal: %s",
                           future_strerror (f, errno));
         }
+        /* With --seq, print the sentinel that ends the backlog.
+         */
+        if (show_seq && id == FLUX_JOBID_ANY) {
+            printf ("{\"id\":-1,\"seq\":%lld,\"resumed\":%s}\n",
+                    (long long)seq,
+                    resumed ? "true" : "false");
+            fflush (stdout);
+        }
+        /* With --seq, print purges replayed from the journal history.
+         */
+        if (show_seq && purged) {
+            printf ("{\"id\":%ju,\"purged\":true,\"seq\":%lld}\n",
+                    (uintmax_t)id,
+                    (long long)seq);
+            fflush (stdout);
+        }
         json_array_foreach (events, index, entry) {
             /* For testing, wrap each eventlog entry in an outer object that
              * includes the jobid.  Not coincidentally, this looks like
@@ -90,6 +117,9 @@ int main (int argc, char *argv[])
             if (!(o = json_pack ("{s:I s:O}",
                                  "id", id,
                                  "entry", entry))
+                || (show_seq
+                    && seq >= 0
+                    && json_object_set_new (o, "seq", json_integer (seq)) < 0)
                 || !(s = json_dumps (o, 0)))
                 log_msg_exit ("Error creating eventlog envelope");
             printf ("%s\n", s);
@@ -24,8 +24,15 @@ static void trigger_cb (flux_t *h,
                         void *arg)
 {
     flux_plugin_t *p = arg;
+    int userid = -1;
 
-    if (flux_jobtap_reprioritize_all (p) < 0)
+    if (flux_request_unpack (msg, NULL, "{s?i}", "userid", &userid) < 0)
+        goto error;
+    if (userid >= 0) {
+        if (flux_jobtap_reprioritize_user (p, userid) < 0)
+            goto error;
+    }
+    else if (flux_jobtap_reprioritize_all (p) < 0)
         goto error;
     if (flux_respond (h, msg, NULL) < 0)
         flux_log_error (h, "flux_respond");
@@ -12,6 +12,8 @@
  *  an RPC to assign priority.
  */
 
+#include <stdlib.h>
+#include <jansson.h>
 #include <flux/core.h>
 #include <flux/jobtap.h>
 
@@ -46,6 +48,52 @@ error:
     flux_respond_error (h, msg, errno, flux_msg_last_error (msg));
 }
 
+static void release_batch_cb (flux_t *h,
+                              flux_msg_handler_t *mh,
+                              const flux_msg_t *msg,
+                              void *arg)
+{
+    flux_plugin_t *p = arg;
+    json_t *jobs;
+    json_t *entry;
+    size_t index;
+    flux_jobid_t *ids = NULL;
+    unsigned int *priority = NULL;
+    int count;
+
+    if (flux_request_unpack (msg, NULL, "{s:o}", "jobs", &jobs) < 0)
+        goto error;
+    if (!json_is_array (jobs)) {
+        errno = EPROTO;
+        goto error;
+    }
+    count = json_array_size (jobs);
+    if (!(ids = calloc (count + 1, sizeof (ids[0])))
+        || !(priority = calloc (count + 1, sizeof (priority[0]))))
+        goto error;
+    json_array_foreach (jobs, index, entry) {
+        int64_t pri;
+        if (json_unpack (entry, "[II]", &ids[index], &pri) < 0
+            || pri < FLUX_JOB_PRIORITY_MIN
+            || pri > FLUX_JOB_PRIORITY_MAX) {
+            errno = EPROTO;
+            goto error;
+        }
+        priority[index] = pri;
+    }
+    if (flux_jobtap_reprioritize_jobs (p, ids, priority, count) < 0)
+        goto error;
+    if (flux_respond (h, msg, NULL) < 0)
+        flux_log_error (h, "flux_respond");
+    free (ids);
+    free (priority);
+    return;
+error:
+    flux_respond_error (h, msg, errno, NULL);
+    free (ids);
+    free (priority);
+}
+
 static int priority_cb (flux_plugin_t *p,
                         const char *topic,
                         flux_plugin_arg_t *args,
@@ -63,7 +111,11 @@ static const struct flux_plugin_handler tab[] = {
 int flux_plugin_init (flux_plugin_t *p)
 {
     if (flux_plugin_register (p, "priority-wait", tab) < 0
-        || flux_jobtap_service_register (p, "release", release_cb, p) < 0)
+        || flux_jobtap_service_register (p, "release", release_cb, p) < 0
+        || flux_jobtap_service_register (p,
+                                         "release-batch",
+                                         release_batch_cb,
+                                         p) < 0)
         return -1;
     return 0;
 }
@@ -0,0 +1,83 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* lookup_batch - look up keys with flux_kvs_lookup_batch()
+ *
+ * Results are printed in argument order as "key=value", or
+ * "key: error" if the key could not be looked up.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include <flux/core.h>
+#include "src/common/libutil/log.h"
+
+int main (int argc, char *argv[])
+{
+    flux_t *h;
+    flux_future_t *f;
+    const char **keys;
+    char **results;
+    int count;
+    int index;
+    int i;
+
+    if (argc < 2) {
+        fprintf (stderr, "Usage: lookup_batch key [key...]\n");
+        return (1);
+    }
+    keys = (const char **)&argv[1];
+    count = argc - 1;
+    if (!(results = calloc (count, sizeof (results[0]))))
+        log_err_exit ("calloc");
+    if (!(h = flux_open (NULL, 0)))
+        log_err_exit ("flux_open");
+
+    if (!(f = flux_kvs_lookup_batch (h, NULL, 0, keys, count)))
+        log_err_exit ("flux_kvs_lookup_batch");
+
+    while (flux_kvs_lookup_batch_get_index (f, &index) == 0) {
+        const char *value;
+        char *s;
+        int rc;
+
+        if (results[index])
+            log_msg_exit ("duplicate response for %s", keys[index]);
+        if (flux_kvs_lookup_get (f, &value) < 0)
+            rc = asprintf (&s, "%s: %s", keys[index], strerror (errno));
+        else
+            rc = asprintf (&s, "%s=%s", keys[index], value ? value : "");
+        if (rc < 0)
+            log_err_exit ("asprintf");
+        results[index] = s;
+        flux_future_reset (f);
+    }
+    if (errno != ENODATA)
+        log_err_exit ("flux_kvs_lookup_batch_get_index");
+    flux_future_destroy (f);
+
+    for (i = 0; i < count; i++) {
+        if (!results[i])
+            log_msg_exit ("no response for %s", keys[i]);
+        printf ("%s\n", results[i]);
+        free (results[i]);
+    }
+    free (results);
+
+    flux_close (h);
+    return (0);
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
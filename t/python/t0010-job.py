@@ -26,7 +26,7 @@ import flux.constants
 import flux.kvs
 import yaml
 from flux import job
-from flux.job import JobInfo, Jobspec, JobspecV1, ffi
+from flux.job import JobInfo, Jobspec, JobspecTemplate, JobspecV1, ffi
 from flux.job.stats import JobStats
 
 
@@ -121,6 +121,35 @@ class TestJob(unittest.TestCase):
         jobid = job.submit(self.fh, jobspec)
         self.assertGreater(jobid, 0)
 
+    def test_08_1_jobspec_template(self):
+        jobspec = JobspecV1.from_command(["true"])
+        template = JobspecTemplate(jobspec)
+        self.assertEqual(json.loads(template.encode()), jobspec.jobspec)
+        encoded = template.encode(
+            {"tasks.0.command": ["hostname"], "attributes.system.job.name": "foo"}
+        )
+        patched = json.loads(encoded)
+        self.assertEqual(patched["tasks"][0]["command"], ["hostname"])
+        self.assertEqual(patched["attributes"]["system"]["job"]["name"], "foo")
+        self.assertEqual(patched["resources"], jobspec.resources)
+        # the template itself is unchanged
+        self.assertEqual(json.loads(template.encode()), jobspec.jobspec)
+        Jobspec(**patched)
+
+    def test_08_2_batch_submit(self):
+        template = JobspecTemplate(self.basic_jobspec)
+        jobspecs = [
+            template.encode({"attributes.system.job.name": f"batch{i}"})
+            for i in range(16)
+        ]
+        jobspecs.append("{}")
+        result = job.submit_batch(self.fh, jobspecs)
+        self.assertEqual(len(result), 17)
+        for jobid in result[:16]:
+            self.assertIsInstance(jobid, job.JobID)
+        self.assertEqual(len(set(result[:16])), 16)
+        self.assertIsInstance(result[16], OSError)
+
     def test_09_valid_duration(self):
         """Test setting Jobspec duration to various valid values"""
         jobspec = Jobspec.from_yaml_stream(self.basic_jobspec)
@@ -733,6 +762,27 @@ class TestJob(unittest.TestCase):
         # synchronous job.result() test
         self.assertEqual(job.result(self.fh, ids[3]), result[ids[3]].get_info())
 
+    def test_32_1_jobinfo_lazy(self):
+        info = JobInfo(
+            {
+                "id": 1234,
+                "state": flux.constants.FLUX_JOB_STATE_SCHED,
+                "annotations": {"sched": {"reason_pending": "test"}},
+                "dependencies": ["after:1"],
+            }
+        )
+        self.assertNotIn("_annotations", vars(info))
+        self.assertEqual(info.sched.reason_pending, "test")
+        self.assertIn("_annotations", vars(info))
+        self.assertNotIn("_dependencies", vars(info))
+        self.assertEqual(str(info.dependencies), "after:1")
+        self.assertEqual(info.state, "SCHED")
+        self.assertEqual(info.name, "")
+        with self.assertRaises(AttributeError):
+            info.result_id
+        with self.assertRaises(AttributeError):
+            info.nosuchattr
+
     def test_33_get_job(self):
         self.sleep_jobspec = JobspecV1.from_command(["sleep", "5"])
         jobid = job.submit(self.fh, self.sleep_jobspec)
@@ -179,6 +179,15 @@ class TestHostlistMethods(unittest.TestCase):
         with self.assertRaises(FileNotFoundError):
             hl.index("foo11")
 
+    def test_expand(self):
+        hl = hostlist.decode("foo[0-10000],bar")
+        hosts = hl.expand()
+        self.assertEqual(len(hosts), 10002)
+        self.assertEqual(hosts[0], "foo0")
+        self.assertEqual(hosts[-1], "bar")
+        self.assertListEqual(list(hl)[:2], ["foo0", "foo1"])
+        self.assertListEqual(hostlist.decode("").expand(), [])
+
 
 if __name__ == "__main__":
     unittest.main(testRunner=TAPTestRunner())
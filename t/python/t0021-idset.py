@@ -275,6 +275,21 @@ class TestIDsetMethods(unittest.TestCase):
                 result = result - arg
             self.assertEqual(str(result), test["result"])
 
+    def test_bulk(self):
+        ids = idset.IDset(range(10000, -1, -2))
+        self.assertEqual(len(ids), 5001)
+        self.assertListEqual(ids.expand(), list(range(0, 10001, 2)))
+        self.assertListEqual(list(ids)[:3], [0, 2, 4])
+        self.assertListEqual(
+            ids.test_many([0, 1, 10000, 10001]), [True, False, True, False]
+        )
+        self.assertListEqual(idset.IDset().expand(), [])
+        self.assertListEqual(idset.IDset([]).expand(), [])
+        with self.assertRaises(ValueError):
+            idset.IDset([1, -1])
+        with self.assertRaises(ValueError):
+            ids.test_many([-1])
+
 
 if __name__ == "__main__":
     unittest.main(testRunner=TAPTestRunner())
@@ -10,11 +10,12 @@
 # SPDX-License-Identifier: LGPL-3.0
 ###############################################################
 
+import threading
 import unittest
 from datetime import datetime
 
 import subflux  # noqa: F401 - To set up PYTHONPATH
-from flux.util import UtilDatetime, parse_datetime
+from flux.util import UtilDatetime, parse_datetime, tree_map
 from pycotap import TAPTestRunner
 
 
@@ -99,5 +100,50 @@ class TestUtilDatetime(unittest.TestCase):
         self.assertEqual(f"{self.ts:%b%d %R::>12h}", " Jun10 08:00")
 
 
+class TestTreeMap(unittest.TestCase):
+    #  A tree of integers where node n has children 10n+1 ... 10n+3
+    #  while n < 100
+    @staticmethod
+    def children(node, result):
+        if node >= 100:
+            return []
+        return [node * 10 + i for i in range(1, 4)]
+
+    def test_order(self):
+        tree = tree_map(lambda n: n * 2, [1, 2], self.children)
+        self.assertEqual([x[0] for x in tree], [1, 2])
+        self.assertEqual([x[1] for x in tree], [2, 4])
+        self.assertEqual([x[0] for x in tree[0][2]], [11, 12, 13])
+        self.assertEqual([x[0] for x in tree[1][2][2][2]], [231, 232, 233])
+        self.assertEqual(tree[1][2][2][2][0][1], 462)
+        self.assertEqual(tree[1][2][2][2][0][2], [])
+
+    def test_max_depth(self):
+        tree = tree_map(lambda n: n, [1], self.children, max_depth=1)
+        self.assertEqual(len(tree[0][2]), 3)
+        for child in tree[0][2]:
+            self.assertEqual(child[2], [])
+        tree = tree_map(lambda n: n, [1], self.children, max_depth=0)
+        self.assertEqual(tree[0][2], [])
+
+    def test_levels(self):
+        #  Each level is started only after the previous level completes
+        lock = threading.Lock()
+        visited = []
+
+        def func(node):
+            with lock:
+                visited.append(node)
+            return node
+
+        tree_map(func, [1, 2], self.children, max_workers=4)
+        depths = [len(str(n)) for n in visited]
+        self.assertEqual(depths, sorted(depths))
+        self.assertEqual(len(visited), 2 + 6 + 18)
+
+    def test_empty(self):
+        self.assertEqual(tree_map(lambda n: n, [], self.children), [])
+
+
 if __name__ == "__main__":
     unittest.main(testRunner=TAPTestRunner())
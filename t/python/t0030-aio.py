@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+
+###############################################################
+# Copyright 2026 Lawrence Livermore National Security, LLC
+# (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+#
+# This file is part of the Flux resource manager framework.
+# For details, see https://github.com/flux-framework.
+#
+# SPDX-License-Identifier: LGPL-3.0
+###############################################################
+
+import asyncio
+import errno
+import unittest
+
+import flux
+import flux.aio
+from subflux import rerun_under_flux
+
+
+def __flux_size():
+    return 2
+
+
+class TestAsyncio(unittest.TestCase):
+    @classmethod
+    def setUpClass(self):
+        self.f = flux.Flux()
+
+    def setUp(self):
+        self.loop = asyncio.new_event_loop()
+        asyncio.set_event_loop(self.loop)
+
+    def tearDown(self):
+        flux.aio.detach(self.f, self.loop)
+        self.loop.close()
+        asyncio.set_event_loop(None)
+
+    def run_loop(self, coro):
+        return self.loop.run_until_complete(asyncio.wait_for(coro, 60))
+
+    def test_01_await_rpc(self):
+        async def ping():
+            return await self.f.rpc("broker.ping", {"seq": 1})
+
+        resp = self.run_loop(ping())
+        self.assertEqual(resp["seq"], 1)
+
+    def test_02_await_many(self):
+        async def ping(count):
+            futures = [self.f.rpc("broker.ping", {"seq": i}) for i in range(count)]
+            return await asyncio.gather(*futures)
+
+        responses = self.run_loop(ping(100))
+        self.assertEqual([resp["seq"] for resp in responses], list(range(100)))
+
+    def test_03_await_remote(self):
+        async def ping():
+            return await self.f.rpc("broker.ping", {"seq": 2}, nodeid=1)
+
+        resp = self.run_loop(ping())
+        self.assertEqual(resp["seq"], 2)
+
+    def test_04_await_error(self):
+        async def bad_rpc():
+            return await self.f.rpc("nonexistent.topic")
+
+        with self.assertRaises(OSError) as cm:
+            self.run_loop(bad_rpc())
+        self.assertEqual(cm.exception.errno, errno.ENOSYS)
+
+    def test_05_await_ready(self):
+        future = self.f.rpc("broker.ping", {"seq": 3})
+        future.wait_for()
+
+        async def get():
+            return await future
+
+        self.assertEqual(self.run_loop(get())["seq"], 3)
+
+    def test_06_small_batch(self):
+        reader = flux.aio.attach(self.f, self.loop, batch=1)
+        self.assertEqual(reader.batch, 1)
+        self.assertIs(flux.aio.attach(self.f, self.loop), reader)
+
+        async def ping(count):
+            futures = [self.f.rpc("broker.ping", {"seq": i}) for i in range(count)]
+            return await asyncio.gather(*futures)
+
+        responses = self.run_loop(ping(20))
+        self.assertEqual(len(responses), 20)
+
+    def test_07_other_tasks_run(self):
+        ticks = []
+
+        async def ticker():
+            while True:
+                ticks.append(1)
+                await asyncio.sleep(0)
+
+        async def ping(count):
+            task = self.loop.create_task(ticker())
+            for i in range(count):
+                await self.f.rpc("broker.ping", {"seq": i})
+            task.cancel()
+
+        self.run_loop(ping(10))
+        self.assertGreater(len(ticks), 0)
+
+    def test_08_detach(self):
+        reader = flux.aio.attach(self.f, self.loop)
+        flux.aio.detach(self.f, self.loop)
+        self.assertIsNone(reader.fd)
+        self.assertIsNot(flux.aio.attach(self.f, self.loop), reader)
+
+
+if __name__ == "__main__":
+    if rerun_under_flux(__flux_size()):
+        from pycotap import TAPTestRunner
+
+        unittest.main(testRunner=TAPTestRunner())
@@ -0,0 +1,144 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* dispatch.c - measure message handler dispatch cost
+ *
+ * Register N handlers on a loop:// handle, a mix of literal event topics,
+ * "svcN.*" prefix globs, and a few globs that can't be indexed, then send
+ * M messages round robin to them and report the average time per message.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+#include <flux/core.h>
+
+#include "src/common/libutil/log.h"
+#include "src/common/libutil/monotime.h"
+
+static int handled;
+static int count = 100000;
+
+static const struct option longopts[] = {
+    {"handlers", required_argument, 0, 'n'},
+    {"count",    required_argument, 0, 'c'},
+    {"help",     no_argument,       0, 'h'},
+    {0, 0, 0, 0},
+};
+
+static void usage (void)
+{
+    fprintf (stderr,
+"Usage: dispatch [--handlers=N] [--count=M]\n"
+);
+    exit (1);
+}
+
+static void msg_cb (flux_t *h,
+                    flux_msg_handler_t *mh,
+                    const flux_msg_t *msg,
+                    void *arg)
+{
+    if (++handled == count)
+        flux_reactor_stop (flux_get_reactor (h));
+}
+
+int main (int argc, char *argv[])
+{
+    flux_t *h;
+    flux_msg_handler_t **handlers;
+    int nhandlers = 100;
+    struct timespec t0;
+    double elapsed;
+    int ch;
+    int i;
+
+    while ((ch = getopt_long (argc, argv, "n:c:h", longopts, NULL)) != -1) {
+        switch (ch) {
+            case 'n':
+                nhandlers = strtoul (optarg, NULL, 10);
+                break;
+            case 'c':
+                count = strtoul (optarg, NULL, 10);
+                break;
+            default:
+                usage ();
+        }
+    }
+    if (optind != argc || nhandlers < 1 || count < 1)
+        usage ();
+
+    if (!(h = flux_open ("loop://", 0)))
+        log_err_exit ("flux_open");
+    if (!(handlers = calloc (nhandlers, sizeof (handlers[0]))))
+        log_err_exit ("out of memory");
+
+    for (i = 0; i < nhandlers; i++) {
+        struct flux_match match = FLUX_MATCH_EVENT;
+        char topic[64];
+
+        if (i % 10 == 9) {
+            snprintf (topic, sizeof (topic), "glob%d.?", i);
+            match.topic_glob = topic;
+        }
+        else if (i % 2 == 1) {
+            snprintf (topic, sizeof (topic), "svc%d.*", i);
+            match.topic_glob = topic;
+        }
+        else {
+            snprintf (topic, sizeof (topic), "event%d", i);
+            match.topic_glob = topic;
+        }
+        if (!(handlers[i] = flux_msg_handler_create (h, match, msg_cb, NULL)))
+            log_err_exit ("flux_msg_handler_create");
+        flux_msg_handler_start (handlers[i]);
+    }
+
+    monotime (&t0);
+    for (i = 0; i < count; i++) {
+        int n = i % nhandlers;
+        char topic[64];
+        flux_msg_t *msg;
+
+        if (n % 10 == 9)
+            snprintf (topic, sizeof (topic), "glob%d.x", n);
+        else if (n % 2 == 1)
+            snprintf (topic, sizeof (topic), "svc%d.x", n);
+        else
+            snprintf (topic, sizeof (topic), "event%d", n);
+        if (!(msg = flux_event_encode (topic, NULL))
+            || flux_send (h, msg, 0) < 0)
+            log_err_exit ("error sending %s", topic);
+        flux_msg_destroy (msg);
+    }
+    if (flux_reactor_run (flux_get_reactor (h), 0) < 0)
+        log_err_exit ("flux_reactor_run");
+    elapsed = monotime_since (t0);
+
+    if (handled != count)
+        log_msg_exit ("handled %d of %d messages", handled, count);
+    printf ("handlers=%d messages=%d usec/msg=%.3f\n",
+            nhandlers,
+            count,
+            elapsed * 1000 / count);
+
+    for (i = 0; i < nhandlers; i++)
+        flux_msg_handler_destroy (handlers[i]);
+    free (handlers);
+    flux_close (h);
+    return (0);
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
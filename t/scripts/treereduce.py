@@ -0,0 +1,26 @@
+###############################################################
+# Copyright 2026 Lawrence Livermore National Security, LLC
+# (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+#
+# This file is part of the Flux resource manager framework.
+# For details, see https://github.com/flux-framework.
+#
+# SPDX-License-Identifier: LGPL-3.0
+###############################################################
+
+# Usage: treereduce.py [--rank=N] topic op [key] [payload]
+
+import json
+import sys
+
+import flux
+
+rank = flux.constants.FLUX_NODEID_ANY
+if sys.argv[1].startswith("--rank="):
+    rank = int(sys.argv.pop(1)[7:])
+req = {"topic": sys.argv[1], "op": sys.argv[2]}
+if len(sys.argv) > 3 and sys.argv[3]:
+    req["key"] = sys.argv[3]
+if len(sys.argv) > 4:
+    req["payload"] = json.loads(sys.argv[4])
+print(json.dumps(flux.Flux().rpc("treereduce.run", req, nodeid=rank).get()))
@@ -177,6 +177,61 @@ test_expect_success 'flux-start with size 2 works with tbon.zmqdebug' '
 test_expect_success 'flux-start with non-integer tbon.zmqdebug fails' '
 	test_must_fail flux start ${ARGS} -o,-Stbon.zmqdebug=foo /bin/true
 '
+test_expect_success 'flux-start with size 2 compresses with tbon.compress_threshold' '
+	flux start ${ARGS} -o,-Stbon.compress_threshold=256 -s2 \
+		flux exec -r 1 sh -c "flux ping --pad 64K --count 4 0 >/dev/null && \
+			flux module stats overlay" >compress.json &&
+	jq -e ".compress.threshold == 256" compress.json &&
+	jq -e ".compress.tx.count > 0" compress.json &&
+	jq -e ".compress.tx.\"compressed-bytes\" < .compress.tx.\"raw-bytes\"" \
+		compress.json
+'
+test_expect_success 'flux-start with size 2 reports per-child send counts' '
+	flux start ${ARGS} -o,-Stbon.child_hwm=1000 -s2 \
+		flux module stats overlay >childstats.json &&
+	jq -e ".\"child-hwm\" == 1000" childstats.json &&
+	jq -e ".children[0].rank == 1" childstats.json &&
+	jq -e ".children[0].sent > 0" childstats.json &&
+	jq -e ".children[0].dropped == 0" childstats.json
+'
+test_expect_success 'flux-start with size 2 filters events with tbon.event_filter' '
+	cat >evfilter.sh <<-EOT &&
+	flux exec -r 1 flux event sub --count=1 test.filter >filter.sub &
+	sleep 1
+	flux event pub test.unwanted
+	flux event pub test.filter
+	wait
+	flux module stats overlay
+	EOT
+	flux start ${ARGS} -o,-Stbon.event_filter=1 -s2 \
+		sh ./evfilter.sh >filter.json &&
+	grep test.filter filter.sub &&
+	jq -e ".\"event-filter\" == true" filter.json &&
+	jq -e ".children[0].filtered > 0" filter.json
+'
+test_expect_success 'flux-start with size 2 uses tbon.io_threads' '
+	flux start ${ARGS} -o,-Stbon.io_threads=3 -s2 \
+		flux module stats overlay >iothreads.json &&
+	jq -e ".\"io-threads\" == 3" iothreads.json
+'
+test_expect_success 'flux-start with size 2 uses tbon.sockbuf' '
+	flux start ${ARGS} -o,-Stbon.sockbuf=4194304 -s2 \
+		flux module stats overlay >sockbuf.json &&
+	jq -e ".sockbuf == 4194304" sockbuf.json
+'
+test_expect_success 'flux-start with negative tbon.sockbuf fails' '
+	test_must_fail flux start ${ARGS} -o,-Stbon.sockbuf=-1 /bin/true
+'
+test_expect_success 'flux-start with negative tbon.io_threads fails' '
+	test_must_fail flux start ${ARGS} -o,-Stbon.io_threads=-1 /bin/true
+'
+test_expect_success 'flux-start with negative tbon.child_hwm fails' '
+	test_must_fail flux start ${ARGS} -o,-Stbon.child_hwm=-1 /bin/true
+'
+test_expect_success 'flux-start with negative tbon.compress_threshold fails' '
+	test_must_fail flux start ${ARGS} -o,-Stbon.compress_threshold=-1 \
+		/bin/true
+'
 test_expect_success 'flux-start fails with unknown option' "
 	test_must_fail flux start ${ARGS} --unknown /bin/true
 "
@@ -463,6 +518,18 @@ test_expect_success 'hostlist attr is set on size 1 instance' '
 test_expect_success 'hostlist attr is set on all ranks of size 4 instance' '
 	flux start ${ARGS} -s4 flux exec flux getattr hostlist
 '
+test_expect_success 'hostlist attr is the same without process mapping' '
+	flux start ${ARGS} -s4 \
+		flux exec flux getattr hostlist >hostlist4.exp &&
+	flux start ${ARGS} -s4 --test-pmi-clique=none \
+		flux exec flux getattr hostlist >hostlist4.out &&
+	test_cmp hostlist4.exp hostlist4.out
+'
+test_expect_success 'single node instance skips all-to-all business cards' '
+	flux start ${ARGS} -s4 -vv /bin/true 2>cards.err &&
+	count=$(grep -c "cmd=get .*key=[0-9]" cards.err) &&
+	test $count -lt 16
+'
 test_expect_success 'flux start (singleton) cleans up rundir' '
 	flux start ${ARGS} \
 		flux getattr rundir >rundir_pmi.out &&
@@ -623,6 +690,10 @@ test_expect_success 'broker fails gracefully when local-uri in unwritable dir' '
 test_expect_success 'broker broker.pid attribute is immutable' '
 	test_must_fail flux start ${ARGS} -o,--setattr=broker.pid=1234 flux getattr broker.pid
 '
+test_expect_success 'broker broker.payload-encodings attribute includes cbor' '
+	flux start ${ARGS} flux getattr broker.payload-encodings >encodings.out &&
+	grep cbor encodings.out
+'
 test_expect_success 'broker --verbose option works' '
 	flux start ${ARGS} -o,-v /bin/true
 '
@@ -118,5 +118,8 @@ test_expect_success 'request: rpc test client handles expected failure other tha
 test_expect_success 'request: rpc test client handles unexpected failure' '
 	test_must_fail $RPC attr.get 2 </dev/null
 '
+test_expect_success 'request: dispatch benchmark runs' '
+	${FLUX_BUILD_DIR}/t/request/dispatch --handlers=50 --count=1000
+'
 
 test_done
@@ -92,6 +92,23 @@ test_expect_success 'module: reload fails with no arguments' '
 test_expect_success 'module: remove fails with no arguments' '
 	test_must_fail flux module remove
 '
+test_expect_success 'module: remove accepts multiple modules' '
+	flux module load --name=multi1 $testmod &&
+	flux module load --name=multi2 $testmod &&
+	flux module remove multi2 multi1 &&
+	flux module list >multi.out &&
+	test_must_fail grep multi multi.out
+'
+test_expect_success 'module: remove continues after a failure' '
+	flux module load --name=multi3 $testmod &&
+	test_must_fail flux module remove nosuchmod multi3 &&
+	flux module list >multi2.out &&
+	test_must_fail grep multi3 multi2.out
+'
+test_expect_success 'module: remove -f ignores missing modules in a list' '
+	flux module load --name=multi4 $testmod &&
+	flux module remove -f nosuchmod multi4 nosuchmod2
+'
 test_expect_success 'module: list fails with argument' '
 	test_must_fail flux module list foo
 '
@@ -103,6 +120,35 @@ test_expect_success 'module: list shows service name' '
 	flux module remove $testmod
 '
 
+test_expect_success 'module: load --lazy registers a stub' '
+	flux module load --lazy $testmod &&
+	flux module list >lazy.out &&
+	grep "^testmod .* L testmod" lazy.out
+'
+test_expect_success 'module: lazy module cannot be loaded twice' '
+	test_must_fail flux module load $testmod
+'
+test_expect_success 'module: first request loads lazy module' '
+	test $(module_getinfo testmod) = "testmod" &&
+	flux module list >lazy2.out &&
+	grep "^testmod .* R" lazy2.out
+'
+test_expect_success 'module: remove module loaded on first use' '
+	flux module remove testmod
+'
+test_expect_success 'module: lazy module can be removed before first use' '
+	flux module load --lazy --name=lazymod $testmod &&
+	flux module remove lazymod &&
+	flux module list >lazy3.out &&
+	test_must_fail grep lazymod lazy3.out
+'
+test_expect_success 'module: lazy module that fails to load returns ENOSYS' '
+	flux module load --lazy --name=nosuch /nonexistent/nosuch.so &&
+	test_must_fail module_getinfo nosuch 2>lazy.err &&
+	grep "Function not implemented" lazy.err &&
+	flux dmesg | grep "error loading nosuch on first use
+'
+
 test_expect_success 'module: load fails on invalid module' '
 	test_must_fail flux module load nosuchmodule 2>load.err &&
 	grep "module not found" load.err
@@ -210,6 +256,21 @@ test_expect_success 'flux module stats --rusage --parse maxrss works' '
 	test "$RSS" -gt 0
 '
 
+test_expect_success 'flux module stats --history works' '
+	flux module stats --history --parse period $REALMOD >history.period &&
+	test "$(cat history.period)" = "60.000000" &&
+	flux module stats --history --parse samples $REALMOD
+'
+test_expect_success 'flux module stats --history fails on unknown module' '
+	test_must_fail flux module stats --history nomod
+'
+test_expect_success 'flux module list -l shows resource usage' '
+	flux module list -l >list-long.out &&
+	head -1 list-long.out | grep CPU &&
+	head -1 list-long.out | grep RxMsgs &&
+	grep "^$REALMOD " list-long.out
+'
+
 # try to hit some error cases
 
 test_expect_success 'flux module with no arguments prints usage and fails' '
@@ -318,4 +379,53 @@ test_expect_success 'module: remove testmod' '
         flux module remove -f testmod
 '
 
+# Usage: module_cpus modname
+module_cpus () {
+	for task in /proc/$(flux getattr broker.pid)/task/*; do
+		if test "$(cat $task/comm)" = "$1"; then
+			grep Cpus_allowed_list $task/status | cut -f2
+		fi
+	done
+}
+
+test_expect_success 'module: configure testmod cpu-affinity' '
+	flux config load <<-EOT
+	[modules.testmod]
+	cpu-affinity = "0"
+	EOT
+'
+test_expect_success 'module: testmod thread is bound to CPU 0' '
+	flux module load $testmod &&
+	test "$(module_cpus testmod)" = "0"
+'
+test_expect_success 'module: remove testmod' '
+	flux module remove testmod
+'
+test_expect_success 'module: invalid cpu-affinity fails module load' '
+	flux config load <<-EOT &&
+	[modules.testmod]
+	cpu-affinity = "badcpus"
+	EOT
+	test_must_fail flux module load $testmod 2>affinity.err &&
+	grep "invalid cpu-affinity" affinity.err
+'
+test_expect_success 'module: invalid [modules] table fails module load' '
+	flux config load <<-EOT &&
+	[modules]
+	cpu-affinity = 42
+	EOT
+	test_must_fail flux module load $testmod
+'
+test_expect_success 'module: cpu-affinity = "none" works' '
+	flux config load <<-EOT &&
+	[modules]
+	cpu-affinity = "none"
+	EOT
+	flux module load $testmod &&
+	flux module remove testmod
+'
+test_expect_success 'module: restore empty config' '
+	flux config load </dev/null
+'
+
 test_done
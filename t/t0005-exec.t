@@ -282,4 +282,85 @@ test_expect_success 'dbus environment variable is not overwritten if set' '
 	test_cmp dbus.exp dbus.out
 '
 
+test_expect_success 'bulk exec works on all ranks' '
+	flux exec --bulk -l hostname | sort >bulk.out &&
+	test $(wc -l <bulk.out) -eq ${SIZE} &&
+	for i in $(seq 0 3); do grep "^$i: " bulk.out; done
+'
+test_expect_success 'bulk exec works on a subset of ranks' '
+	flux exec --bulk -n -l -r 1,3 echo hello | sort >bulk-subset.out &&
+	cat >bulk-subset.exp <<-EOT &&
+	1: hello
+	3: hello
+	EOT
+	test_cmp bulk-subset.exp bulk-subset.out
+'
+test_expect_success 'bulk exec aggregates exit codes by rank' '
+	test_expect_code 3 flux exec --bulk -n \
+	    sh -c "test \$(flux getattr rank) -ge 2 && exit 3; true" \
+	    2>bulk-exit.err &&
+	grep "^\[2-3\]: Exit 3" bulk-exit.err
+'
+test_expect_success 'bulk exec reports command not found' '
+	test_expect_code 127 flux exec --bulk -n -r 3 /nonexistent \
+	    2>bulk-noent.err &&
+	grep "rank 3" bulk-noent.err
+'
+test_expect_success 'bulk exec broadcasts stdin' '
+	echo hello >bulk-stdin.exp &&
+	run_timeout 10 flux exec --bulk -l cat <bulk-stdin.exp \
+	    >bulk-stdin.out &&
+	for i in $(seq 0 3); do
+		sed -n "s/^$i: //p" bulk-stdin.out >bulk-stdin.$i &&
+		test_cmp bulk-stdin.exp bulk-stdin.$i
+	done
+'
+test_expect_success 'bulk exec forwards signals' '
+	cat >test_bulk_signal.sh <<-EOF &&
+	#!/bin/bash
+	rm -f bulkready.out
+	mkfifo bulk.fifo
+	stdbuf --output=L \
+	    flux exec --bulk -n awk "BEGIN {print \"hi\"} {print}" bulk.fifo \
+	        >bulkready.out &
+	$waitfile -vt 20 -p ^hi -c ${SIZE} bulkready.out &&
+	kill -INT %1 &&
+	wait %1
+	exit \$?
+	EOF
+	chmod +x test_bulk_signal.sh &&
+	test_expect_code 130 run_timeout 20 ./test_bulk_signal.sh
+'
+test_expect_success 'aggregate exec groups identical output' '
+	flux exec -n --aggregate echo hello >agg.out &&
+	cat >agg.exp <<-EOT &&
+	----------------
+	[0-3]
+	----------------
+	hello
+	EOT
+	test_cmp agg.exp agg.out
+'
+test_expect_success 'aggregate exec groups ranks by their entire output' '
+	flux exec -n -a sh -c \
+	    "echo hello; test \$(flux getattr rank) -eq 2 && echo extra; true" \
+	    >agg2.out &&
+	cat >agg2.exp <<-EOT &&
+	----------------
+	[0-1,3]
+	----------------
+	hello
+	----------------
+	2
+	----------------
+	hello
+	extra
+	EOT
+	test_cmp agg2.exp agg2.out
+'
+test_expect_success 'aggregate exec reports exit codes by rank' '
+	test_expect_code 1 flux exec -n -a -r 1-3 false 2>agg3.err &&
+	grep "^\[1-3\]: Exit 1" agg3.err
+'
+
 test_done
@@ -191,6 +191,30 @@ test_expect_success 'load request with empty payload fails with EPROTO(71)' '
 test_expect_success 'register-backing request with empty payload fails with EPROTO(71)' '
 	${RPC} content.register-backing 71 </dev/null
 '
+test_expect_success 'store-batch stores multiple blobs on rank 0' '
+	printf "\000\000\000\003foo\000\000\000\005batch" >batch.in &&
+	${RPC} -r content.store-batch <batch.in >batch.out &&
+	hexlen=$(printf foo | ${BLOBREF} ${HASHFUN} \
+		| cut -d- -f2 | tr -d "\n" | wc -c) &&
+	test $(wc -c <batch.out) -eq $hexlen &&
+	flux content load $(printf foo | ${BLOBREF} ${HASHFUN}) >batch1.out &&
+	printf foo >batch1.exp &&
+	test_cmp batch1.exp batch1.out &&
+	flux content load $(printf batch | ${BLOBREF} ${HASHFUN}) >batch2.out &&
+	printf batch >batch2.exp &&
+	test_cmp batch2.exp batch2.out
+'
+test_expect_success 'store-batch with empty payload stores nothing' '
+	${RPC} -r content.store-batch </dev/null >batch0.out &&
+	test $(wc -c <batch0.out) -eq 0
+'
+test_expect_success 'store-batch with truncated blob fails with EPROTO(71)' '
+	printf "\000\000\000\010foo" >batchbad.in &&
+	${RPC} -r content.store-batch 71 <batchbad.in
+'
+test_expect_success 'store-batch fails with EINVAL(22) on rank > 0' '
+	flux exec -r 1 ${RPC} -r content.store-batch 22 <batch.in
+'
 test_expect_success 'content store --chunksize option splits blobs' '
 	echo "0123456789" >split.data &&
 	flux content store --chunksize=8 <split.data >split.refs &&
@@ -217,6 +241,43 @@ test_expect_success 'content load with no blobrefs fails' '
 	test_must_fail flux content load </dev/null
 '
 
+test_expect_success 'remove content module' '
+	flux exec flux module remove content
+'
+test_expect_success 'load content module with small purge target' '
+	flux exec flux module load content \
+	    purge-target-size=8192 purge-max-size=8192
+'
+test_expect_success 'stores on rank 1 are evicted on insert past purge-max-size' '
+	flux exec -r 1 sh -c "for i in \$(seq 1 20); do \
+	    (echo \$i; head -c 1000 /dev/zero) | flux content store; \
+	    done" >evict.refs &&
+	flux exec -r 1 flux module stats content >evict.stats &&
+	jq -e ".size <= 8192 and .ghosts > 0" <evict.stats
+'
+test_expect_success 'blob that is loaded again is promoted to protected list' '
+	ref=$(flux exec -r 1 sh -c "echo promote | flux content store") &&
+	flux exec -r 1 flux content load $ref >/dev/null &&
+	flux exec -r 1 flux module stats content >promote.stats &&
+	jq -e ".\"protected-size\" > 0" <promote.stats
+'
+test_expect_success 'create script to load blobs on a leaf rank' '
+	cat >home-load.sh <<-EOT &&
+	#!/bin/sh -e
+	for i in \$(seq 1 16); do echo home\$i | flux content store; done \\
+	    >home.refs
+	flux exec -r 6 flux content load <home.refs >home.data
+	flux exec -r 6 flux module stats content >home.stats
+	EOT
+	chmod +x home-load.sh
+'
+test_expect_success 'content.home-ranks sends misses to home ranks' '
+	flux start --test-size=7 -Stbon.topo=kary:2 \
+	    -Scontent.home-ranks=1-2 ./home-load.sh &&
+	for i in $(seq 1 16); do echo home$i; done >home.exp &&
+	test_cmp home.exp home.data &&
+	jq -e ".\"home-load\" > 0" <home.stats
+'
 test_expect_success 'remove content module' '
 	flux exec flux module remove content
 '
@@ -29,6 +29,7 @@ test_expect_success 'load content module with lower purge/age thresholds' '
 '
 
 HASHFUN=`flux getattr content.hash`
+BLOBREF=${FLUX_BUILD_DIR}/t/kvs/blobref
 
 test_expect_success 'load heartbeat module with fast rate to drive purge' '
 	flux module load heartbeat period=0.1s
@@ -330,6 +331,27 @@ test_expect_success 'reload module with no options and verify modes' '
 	flux dmesg >logs2 &&
 	grep "journal_mode=OFF synchronous=OFF" logs2
 '
+test_expect_success 'load-threads requires journal_mode=WAL' '
+	flux module remove -f content-sqlite &&
+	test_must_fail flux module load content-sqlite load-threads=2
+'
+test_expect_success 'load module with journal_mode=WAL load-threads=2' '
+	flux dmesg --clear &&
+	flux module load content-sqlite journal_mode=WAL load-threads=2 &&
+	flux dmesg >logs5 &&
+	grep "load-threads=2" logs5
+'
+test_expect_success 'blobs can be loaded by load threads' '
+	echo loadthreads >threads.in &&
+	flux content store <threads.in >threads.ref &&
+	flux content flush &&
+	flux content load --bypass-cache $(cat threads.ref) >threads.out &&
+	test_cmp threads.in threads.out
+'
+test_expect_success 'reload module with no options' '
+	flux module remove -f content-sqlite &&
+	flux module load content-sqlite
+'
 
 
 test_expect_success 'run flux without statedir and verify modes' '
@@ -384,6 +406,155 @@ test_expect_success 'full instance start fails corrupt database' '
 	test_must_fail flux start -o,-Sstatedir=$(pwd) /bin/true
 '
 
+test_expect_success 'online gc deletes unreachable blobs and keeps the KVS' '
+	mkdir -p gc &&
+	flux start -o,-Sbroker.rc1_path=$rc1_kvs,-Sbroker.rc3_path=$rc3_kvs \
+	    -o,-Sstatedir=$(pwd)/gc bash -c \
+	    "for i in \$(seq 1 10); do flux kvs put a.b=\$i; done && \
+	    flux content flush && \
+	    flux content gc -v >gc.out && \
+	    flux content dropcache && \
+	    flux kvs get a.b >gc.value" &&
+	grep "deleted [1-9]" gc.out &&
+	test "$(cat gc.value)" = "10"
+'
+test_expect_success 'KVS is intact after restart following gc' '
+	flux start -o,-Sbroker.rc1_path=$rc1_kvs,-Sbroker.rc3_path=$rc3_kvs \
+	    -o,-Sstatedir=$(pwd)/gc flux kvs get a.b >gc.value2 &&
+	test "$(cat gc.value2)" = "10"
+'
+
+test_expect_success 'create config with content-sqlite group commit' '
+	mkdir -p batchconf &&
+	cat >batchconf/content.toml <<-EOT
+	[content-sqlite]
+	batch-timeout = "0.5s"
+	batch-max-count = 4
+	EOT
+'
+test_expect_success 'stores are group committed when batch-timeout is set' '
+	flux start -o,--config-path=$(pwd)/batchconf \
+	    -o,-Sbroker.rc1_path=$rc1_kvs,-Sbroker.rc3_path=$rc3_kvs \
+	    bash -c "for i in \$(seq 1 20); do flux kvs put b.\$i=\$i; done && \
+	    flux content flush && \
+	    flux module stats content-sqlite" >batch.stats &&
+	jq -e ".store_batch.count > 0" <batch.stats &&
+	jq -e ".store_batch.max > 1" <batch.stats &&
+	jq -e ".store_batch.max <= 4" <batch.stats
+'
+test_expect_success 'content-sqlite fails to load with bad batch-max-count' '
+	mkdir -p badbatchconf &&
+	cat >badbatchconf/content.toml <<-EOT &&
+	[content-sqlite]
+	batch-max-count = 0
+	EOT
+	test_must_fail flux start -o,--config-path=$(pwd)/badbatchconf \
+	    -o,-Sbroker.rc1_path=$rc1_kvs,-Sbroker.rc3_path=$rc3_kvs \
+	    /bin/true
+'
+
+test_expect_success 'create config with zstd compression' '
+	mkdir -p zstdconf &&
+	cat >zstdconf/content.toml <<-EOT
+	[content-sqlite]
+	compression = "zstd"
+	compression-threshold = 0
+	EOT
+'
+test_expect_success 'check for zstd support' '
+	if flux start -o,--config-path=$(pwd)/zstdconf \
+	    -o,-Sbroker.rc1_path=$rc1_kvs,-Sbroker.rc3_path=$rc3_kvs \
+	    /bin/true; then \
+		test_set_prereq ZSTD; \
+	fi
+'
+test_expect_success 'content-sqlite fails to load with bad compression' '
+	mkdir -p badcompconf &&
+	cat >badcompconf/content.toml <<-EOT &&
+	[content-sqlite]
+	compression = "foo"
+	EOT
+	test_must_fail flux start -o,--config-path=$(pwd)/badcompconf \
+	    -o,-Sbroker.rc1_path=$rc1_kvs,-Sbroker.rc3_path=$rc3_kvs \
+	    /bin/true
+'
+test_expect_success !ZSTD 'flux content dict-train fails without zstd' '
+	test_must_fail flux content dict-train 2>dicttrain.err &&
+	grep "not supported" dicttrain.err
+'
+test_expect_success ZSTD 'zstd dictionary can be trained and used' '
+	cat >zstd.sh <<-\EOT &&
+	#!/bin/sh -e
+	for i in $(seq 1 200); do
+	    flux kvs put job.$i.spec="{\"id\":$i,\"cmd\":\"hostname\"}"
+	done
+	flux content flush
+	flux content dict-train --size=4096 >dicttrain.out
+	for i in $(seq 201 250); do flux kvs put job.$i.spec=$i; done
+	flux content flush
+	flux content dropcache
+	flux kvs get job.1.spec >zstd.value1
+	flux kvs get job.250.spec >zstd.value250
+	flux module stats content-sqlite >zstd.stats
+	EOT
+	chmod +x zstd.sh &&
+	mkdir -p zstd &&
+	flux start -o,--config-path=$(pwd)/zstdconf \
+	    -o,-Sbroker.rc1_path=$rc1_kvs,-Sbroker.rc3_path=$rc3_kvs \
+	    -o,-Sstatedir=$(pwd)/zstd ./zstd.sh &&
+	grep "^dictionary 1:" dicttrain.out &&
+	jq -e ".compression == \"zstd\"" <zstd.stats &&
+	jq -e ".dict_id == 1" <zstd.stats &&
+	grep "hostname" zstd.value1 &&
+	test "$(cat zstd.value250)" = "250"
+'
+test_expect_success ZSTD 'zstd compressed content is readable with lz4 config' '
+	flux start -o,-Sbroker.rc1_path=$rc1_kvs,-Sbroker.rc3_path=$rc3_kvs \
+	    -o,-Sstatedir=$(pwd)/zstd bash -c \
+	    "flux kvs get job.1.spec && flux kvs get job.250.spec" >zstd.values &&
+	grep "hostname" zstd.values &&
+	grep "^250$" zstd.values
+'
+
+test_expect_success 'bloom filter is enabled by default' '
+	flux module stats content-sqlite >bloom.stats &&
+	jq -e ".bloom.enabled == true" <bloom.stats &&
+	jq -e ".bloom.count > 0" <bloom.stats
+'
+test_expect_success 'load of missing blob is answered by bloom filter' '
+	echo nosuchblob | $BLOBREF $HASHFUN >missing.ref &&
+	test_must_fail flux content load --bypass-cache \
+	    $(cat missing.ref) 2>missing.err &&
+	grep "No such file or directory" missing.err &&
+	flux module stats content-sqlite >bloom.stats2 &&
+	jq -e ".bloom.negatives > 0" <bloom.stats2
+'
+test_expect_success 'bloom filter can be disabled by configuration' '
+	mkdir -p nobloomconf &&
+	cat >nobloomconf/content.toml <<-EOT &&
+	[content-sqlite]
+	bloom-filter = false
+	EOT
+	flux start -o,--config-path=$(pwd)/nobloomconf \
+	    -o,-Sbroker.rc1_path=$rc1_kvs,-Sbroker.rc3_path=$rc3_kvs \
+	    flux module stats content-sqlite >nobloom.stats &&
+	jq -e ".bloom.enabled == false" <nobloom.stats
+'
+
+test_expect_success 'listing a KVS directory prefetches its entries' '
+	mkdir -p prefetch &&
+	flux start -o,-Sbroker.rc1_path=$rc1_kvs,-Sbroker.rc3_path=$rc3_kvs \
+	    -o,-Sstatedir=$(pwd)/prefetch bash -c \
+	    "for i in \$(seq 1 10); do flux kvs put pf.\$i.x=\$i; done" &&
+	flux start -o,-Sbroker.rc1_path=$rc1_kvs,-Sbroker.rc3_path=$rc3_kvs \
+	    -o,-Sstatedir=$(pwd)/prefetch bash -c \
+	    "flux kvs ls pf >/dev/null && \
+	    flux kvs get pf.5.x >prefetch.value && \
+	    flux module stats content" >prefetch.stats &&
+	jq -e ".prefetch > 0" <prefetch.stats &&
+	test "$(cat prefetch.value)" = "5"
+'
+
 test_expect_success 'flux module stats content-sqlite is open to guests' '
 	FLUX_HANDLE_ROLEMASK=0x2 \
 	    flux module stats content-sqlite >/dev/null
@@ -114,6 +114,25 @@ test_expect_success 'restarted job restarts repeat count' '
     sleep .1 &&
     test $(flux dmesg | grep -c repeat-count-check) = 1
 '
+test_expect_success 'many entries due at once all run' '
+    for i in $(seq 1 20); do
+        flux_cron interval -c1 .1s echo batch-check-$i >>batch.ids || return 1
+    done &&
+    sleep .5 &&
+    for id in $(cat batch.ids); do
+        cron_entry_check ${id} stats.count 1 &&
+        cron_entry_check ${id} stopped true || return 1
+    done &&
+    test $(flux dmesg | grep -c "batch-check-") -eq 20 &&
+    for id in $(cat batch.ids); do flux cron delete ${id} || return 1; done
+'
+test_expect_success 'interval next_wakeup is in the future' '
+    id=$(flux_cron interval 1h echo next-wakeup-check) &&
+    test_when_finished "flux cron delete ${id}" &&
+    next=$(flux cron dump --key=typedata.next_wakeup ${id}) &&
+    now=$(date +%s) &&
+    test $(printf "%.0f" $next) -gt $((now+3500))
+'
 test_expect_success 'rank option works' '
     id=$(flux_cron interval -c1 -o rank=1 .01s flux getattr rank) &&
     sleep .1 &&
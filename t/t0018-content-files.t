@@ -70,6 +70,20 @@ test_expect_success 'content-files module load fails with unknown option' '
 	test_must_fail flux module load content-files notoption
 '
 
+test_expect_success 'content-files module load fails with bad io-threads' '
+	test_must_fail flux module load content-files io-threads=foo &&
+	test_must_fail flux module load content-files io-threads=-1
+'
+
+test_expect_success 'content-files module load fails with bad layout' '
+	test_must_fail flux module load content-files layout=foo
+'
+
+test_expect_success 'content-files module load fails with bad pack-segment-size' '
+	test_must_fail flux module load content-files pack-segment-size=foo &&
+	test_must_fail flux module load content-files pack-segment-size=0
+'
+
 test_expect_success 'load content-files module' '
 	flux module load content-files testing
 '
@@ -122,6 +136,119 @@ test_expect_success 'load with invalid hash size fails with EPROTO' '
 	grep "Protocol error" badhash.err
 '
 
+test_expect_success 'store/load/verify small blobs concurrently' '
+	for size in $SIZES; do make_blob $size >cblob.$size; done &&
+	for size in $SIZES; do backing_store <cblob.$size >chash.$size & done &&
+	wait &&
+	for size in $SIZES; do backing_load <chash.$size >cblob.$size.out & done &&
+	wait &&
+	err=0 &&
+	for size in $SIZES; do \
+		if ! test_cmp cblob.$size cblob.$size.out; then err=$(($err+1)); fi; \
+	done &&
+	test $err -eq 0
+'
+
+test_expect_success 'reload content-files module with io-threads=0' '
+	flux module reload content-files testing io-threads=0
+'
+
+test_expect_success 'reload/verify various size small blobs without I/O threads' '
+	err=0 &&
+	for size in $SIZES; do \
+		if ! recheck_blob $size; then err=$(($err+1)); fi; \
+	done &&
+	test $err -eq 0
+'
+
+test_expect_success 'blobs are stored in shard directories' '
+	test $(ls content.files/??/sha1-* | wc -l) -gt 0
+'
+
+test_expect_success 'reload content-files module with layout=flat' '
+	flux module reload content-files testing layout=flat
+'
+
+test_expect_success 'store a blob with layout=flat' '
+	make_blob 4096 >flatblob &&
+	backing_store <flatblob >flathash &&
+	test $(ls content.files/sha1-* | wc -l) -eq 1
+'
+
+test_expect_success 'reload content-files module with layout=pack sync' '
+	flux module reload content-files testing \
+	    layout=pack sync pack-segment-size=1M
+'
+
+test_expect_success 'flux module stats reports layout=pack' '
+	test "$(flux module stats content-files | jq -r .layout)" = "pack"
+'
+
+test_expect_success 'blobs stored with the other layouts are found' '
+	backing_load <flathash >flatblob.out &&
+	test_cmp flatblob flatblob.out &&
+	err=0 &&
+	for size in $SIZES; do \
+		if ! recheck_blob $size; then err=$(($err+1)); fi; \
+	done &&
+	test $err -eq 0
+'
+
+test_expect_success 'store/load/verify various size small blobs with layout=pack' '
+	err=0 &&
+	for size in $SIZES; do \
+		if ! check_blob $size; then err=$(($err+1)); fi; \
+	done &&
+	test $err -eq 0
+'
+
+test_expect_success 'store/load/verify small blobs concurrently with layout=pack' '
+	for size in $SIZES; do make_blob $size >pblob.$size; done &&
+	for size in $SIZES; do backing_store <pblob.$size >phash.$size & done &&
+	wait &&
+	for size in $SIZES; do backing_load <phash.$size >pblob.$size.out & done &&
+	wait &&
+	err=0 &&
+	for size in $SIZES; do \
+		if ! test_cmp pblob.$size pblob.$size.out; then err=$(($err+1)); fi; \
+	done &&
+	test $err -eq 0
+'
+
+test_expect_success 'blobs were appended to multiple pack segments' '
+	test -f content.files/pack/seg.000000 &&
+	test -f content.files/pack/seg.000001
+'
+
+test_expect_success 'reload content-files module with layout=pack' '
+	flux module reload content-files testing layout=pack
+'
+
+test_expect_success 'reload/verify various size small blobs with layout=pack' '
+	err=0 &&
+	for size in $SIZES; do \
+		if ! recheck_blob $size; then err=$(($err+1)); fi; \
+	done &&
+	test $err -eq 0
+'
+
+test_expect_success 'gc-begin fails with ENOSYS with layout=pack' '
+	test_must_fail $RPC content-backing.gc-begin </dev/null 2>gcpack.err &&
+	grep "Function not implemented" gcpack.err
+'
+
+test_expect_success 'reload content-files module with io-threads=0 sync' '
+	flux module reload content-files testing io-threads=0 sync
+'
+
+test_expect_success 'store/load/verify various size small blobs with sync' '
+	err=0 &&
+	for size in $SIZES; do \
+		if ! check_blob $size; then err=$(($err+1)); fi; \
+	done &&
+	test $err -eq 0
+'
+
 ##
 # Tests of the module acting as backing store for content cache
 ##
@@ -291,6 +418,76 @@ test_expect_success 'checkpoint-backing-get foo returns spoon' '
        wait_checkpoint_flush spoon
 '
 
+test_expect_success 'online gc deletes unreachable blobs and keeps the KVS' '
+	mkdir -p gc &&
+	flux start -o,-Sbroker.rc1_path=,-Sbroker.rc3_path= \
+	    -o,-Sstatedir=$(pwd)/gc bash -c \
+	    "flux module load content && \
+	    flux module load content-files && \
+	    flux module load kvs && \
+	    for i in \$(seq 1 10); do flux kvs put a.b=\$i; done && \
+	    flux content flush && \
+	    flux content gc -v >gc.out && \
+	    flux content dropcache && \
+	    flux kvs get a.b >gc.value && \
+	    flux module remove kvs && \
+	    flux module remove content-files && \
+	    flux module remove content" &&
+	grep "deleted [1-9]" gc.out &&
+	test "$(cat gc.value)" = "10"
+'
+test_expect_success 'create script that commits an old value during gc' '
+	cat >gc-recommit.sh <<-"EOT" &&
+	#!/bin/sh
+	set -e
+	flux module load content gc-batch-size=1
+	flux module load content-files
+	flux module load kvs
+	value=$(printf "%0200d" 42)
+	flux kvs put old=$value
+	flux kvs put $(seq -f "garbage.%g=%0200g" 1 500)
+	flux kvs unlink -R old garbage
+	flux content flush
+	flux content gc -v >gc3.out &
+	pid=$!
+	i=0
+	while ! flux module stats kvs | jq -e .gc.active >/dev/null; do
+	    test $i -lt 100 || break
+	    i=$((i+1))
+	    sleep 0.1
+	done
+	flux kvs put new=$value
+	wait $pid
+	flux kvs dropcache
+	flux content dropcache
+	flux kvs get new >gc3.value
+	test "$(cat gc3.value)" = "$value"
+	flux module remove kvs
+	flux module remove content-files
+	flux module remove content
+	EOT
+	chmod +x gc-recommit.sh
+'
+test_expect_success 'gc keeps an old value committed again during the pass' '
+	rm -rf gc3 && mkdir -p gc3 &&
+	flux start -o,-Sbroker.rc1_path=,-Sbroker.rc3_path= \
+	    -o,-Sstatedir=$(pwd)/gc3 ./gc-recommit.sh &&
+	grep "deleted [1-9]" gc3.out
+'
+test_expect_success 'gc fails when there are no KVS roots' '
+	rm -rf gc2 && mkdir -p gc2 &&
+	test_must_fail flux start -o,-Sbroker.rc1_path=,-Sbroker.rc3_path= \
+	    -o,-Sstatedir=$(pwd)/gc2 bash -c \
+	    "flux module load content && \
+	    flux module load content-files && \
+	    flux content gc; \
+	    rc=\$?; \
+	    flux module remove content-files && \
+	    flux module remove content; \
+	    exit \$rc" 2>gc2.err &&
+	grep "no KVS roots found" gc2.err
+'
+
 test_expect_success 'flux module stats content-files is open to guests' '
 	FLUX_HANDLE_ROLEMASK=0x2 \
 	    flux module stats content-files >/dev/null
@@ -186,5 +186,67 @@ test_expect_success 'Ensure example 1 of flux-archive(1) works' '
 	flux exec -r 1 rm -r tmp.project &&
 	flux archive remove
 '
+test_expect_success 'flux archive create fails with --window=0' '
+	test_must_fail flux archive create --window=0 . 2>window.err &&
+	grep "must be at least 1" window.err
+'
+test_expect_success 'flux archive create fails with --threads=0' '
+	test_must_fail flux archive create --threads=0 . 2>threads.err &&
+	grep "must be at least 1" threads.err
+'
+test_expect_success 'flux archive create fails with --chunking=badtype' '
+	test_must_fail flux archive create --chunking=badtype . 2>chunk.err &&
+	grep "must be fixed or content" chunk.err
+'
+test_expect_success 'flux archive create fails with --chunking=content --mmap' '
+	test_must_fail flux archive create --chunking=content --mmap . \
+	    2>chunkmmap.err &&
+	grep "cannot work with --chunking=content" chunkmmap.err
+'
+test_expect_success 'create a large file for chunking tests' '
+	mkdir -p chunk &&
+	randbytes 4194304 >chunk/big
+'
+test_expect_success 'flux archive create --chunking=content --window=1 works' '
+	flux archive create --name=cdc --chunking=content --window=1 \
+	    --threads=1 -C chunk big &&
+	flux kvs get archive.cdc | jq -e ".[0].encoding == \"blobvec\"" &&
+	flux kvs get archive.cdc | jq -e ".[0].data | length > 4"
+'
+test_expect_success 'and the file extracts faithfully' '
+	mkdir -p chunk.out1 &&
+	flux archive extract --name=cdc -C chunk.out1 &&
+	test_cmp chunk/big chunk.out1/big
+'
+test_expect_success 'modifying the middle of the file preserves most blobs' '
+	flux kvs get archive.cdc | jq -r ".[0].data[][2]" | sort >blobs1 &&
+	head -c 2097152 chunk/big >chunk/big2 &&
+	echo "inserted" >>chunk/big2 &&
+	tail -c +2097153 chunk/big >>chunk/big2 &&
+	flux archive create --name=cdc2 --chunking=content --threads=4 \
+	    -C chunk big2 &&
+	flux kvs get archive.cdc2 | jq -r ".[0].data[][2]" | sort >blobs2 &&
+	total=$(wc -l <blobs1) &&
+	shared=$(comm -12 blobs1 blobs2 | wc -l) &&
+	test $shared -ge $(($total - 2))
+'
+test_expect_success 'and the modified file extracts faithfully' '
+	mkdir -p chunk.out2 &&
+	flux archive extract --name=cdc2 -C chunk.out2 &&
+	test_cmp chunk/big2 chunk.out2/big2
+'
+test_expect_success 'fixed chunking with --window=512 --threads=8 works' '
+	flux archive create --name=fixed --window=512 --threads=8 \
+	    -C chunk big &&
+	flux kvs get archive.fixed | jq -e ".[0].data | length == 4" &&
+	mkdir -p chunk.out3 &&
+	flux archive extract --name=fixed -C chunk.out3 &&
+	test_cmp chunk/big chunk.out3/big
+'
+test_expect_success 'remove chunking test archives' '
+	flux archive remove --name=cdc &&
+	flux archive remove --name=cdc2 &&
+	flux archive remove --name=fixed
+'
 
 test_done
@@ -325,6 +325,59 @@ test_expect_success 'remove content-s3 module' '
 	flux module remove content-s3
 '
 
+##
+# Tests of small blob packing
+##
+
+test_expect_success 'config: reload with negative concurrency fails' '
+	cp content-s3.toml content-s3.nopack &&
+	echo "concurrency = -1" >>content-s3.toml &&
+	test_must_fail flux config reload &&
+	cp content-s3.nopack content-s3.toml
+'
+test_expect_success 'configure packing of blobs smaller than 2048 bytes' '
+	cat >>content-s3.toml <<-TOML &&
+	concurrency = 4
+	pack-threshold = 2048
+	pack-size = 65536
+	TOML
+	flux config reload
+'
+test_expect_success 'load content-s3 module' '
+	flux module load content-s3
+'
+test_expect_success 'store/load/verify various size blobs with packing' '
+	err=0 &&
+	for size in $SIZES; do \
+		if ! check_blob $size; then err=$(($err+1)); fi; \
+	done &&
+	test $err -eq 0
+'
+test_expect_success 'reload content-s3 module' '
+	flux module reload content-s3
+'
+test_expect_success 'reload/verify various size blobs with packing' '
+	err=0 &&
+	for size in $SIZES; do \
+		if ! recheck_blob $size; then err=$(($err+1)); fi; \
+	done &&
+	test $err -eq 0
+'
+test_expect_success 'remove content-s3 module' '
+	flux module remove content-s3
+'
+test_expect_success 'packed blobs can be read with packing disabled' '
+	mv -f content-s3.nopack content-s3.toml &&
+	flux config reload &&
+	flux module load content-s3 &&
+	err=0 &&
+	for size in $SIZES; do \
+		if ! recheck_blob $size; then err=$(($err+1)); fi; \
+	done &&
+	test $err -eq 0 &&
+	flux module remove content-s3
+'
+
 ##
 # Tests of kvs checkpointing
 ##
@@ -307,4 +307,32 @@ test_expect_success 'unmap test file' '
 	flux archive remove
 '
 
+test_expect_success 'create script to load parent blobs in a subinstance' '
+	cat >parent-load.sh <<-EOT &&
+	#!/bin/sh -e
+	echo parentblob | flux content store >parent.blobref
+	echo abcdefghijklmnopqrstuvwxyz >testfile3
+	flux archive create --mmap --small-file-threshold=10 ./testfile3
+	flux kvs get --raw archive.main | jq -r ".[0].data[0][2]" >mapped.blobref
+	flux run flux start -Scontent.parent-fallback=1 \\
+	    "flux content load <parent.blobref >parent.data && \\
+	    flux content load <mapped.blobref >mapped.data && \\
+	    flux module stats content >child.stats"
+	flux run flux start \\
+	    "flux content load <parent.blobref" 2>nofallback.err || :
+	flux archive remove
+	EOT
+	chmod +x parent-load.sh
+'
+test_expect_success 'subinstance loads parent blobs with content.parent-fallback' '
+	flux start ./parent-load.sh &&
+	echo parentblob >parent.exp &&
+	test_cmp parent.exp parent.data &&
+	echo abcdefghijklmnopqrstuvwxyz >mapped.exp &&
+	test_cmp mapped.exp mapped.data &&
+	jq -e ".\"parent-load\" == 1" <child.stats &&
+	jq -e ".\"parent-map\" == 1" <child.stats &&
+	grep "No such file or directory" nofallback.err
+'
+
 test_done
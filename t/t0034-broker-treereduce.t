@@ -0,0 +1,67 @@
+#!/bin/sh
+#
+
+test_description='Test broker treereduce service'
+
+. `dirname $0`/sharness.sh
+
+# Use a binary tree so that some brokers have grandchildren:
+#   0 -> 1 -> 3
+#     -> 2
+SIZE=4
+test_under_flux ${SIZE} minimal -o,-Stbon.topo=kary:2
+
+# Usage: treereduce [--rank=N] topic op [key] [payload]
+TREEREDUCE="flux python ${SHARNESS_TEST_SRCDIR}/scripts/treereduce.py"
+
+test_expect_success 'idset reduction of rank attribute covers all ranks' '
+	${TREEREDUCE} attr.get idset value "{\"name\":\"rank\"}" >idset.out &&
+	jq -e ".value == \"0-3\"" idset.out &&
+	jq -e ".ranks == \"0-3\"" idset.out &&
+	jq -e ".errors == \"\"" idset.out
+'
+test_expect_success 'concat reduction is in TBON pre-order' '
+	${TREEREDUCE} attr.get concat value "{\"name\":\"rank\"}" >concat.out &&
+	jq -e ".value == \"0132\"" concat.out
+'
+test_expect_success 'sum reduction of child-count is size - 1' '
+	${TREEREDUCE} overlay.stats-get sum child-count >sum.out &&
+	jq -e ".value == 3" sum.out
+'
+test_expect_success 'max and min reductions work' '
+	${TREEREDUCE} overlay.stats-get max child-count >max.out &&
+	jq -e ".value == 2" max.out &&
+	${TREEREDUCE} overlay.stats-get min child-count >min.out &&
+	jq -e ".value == 0" min.out
+'
+test_expect_success 'merge reduction of whole payload works' '
+	${TREEREDUCE} overlay.stats-get merge >merge.out &&
+	jq -e ".value | has(\"child-count\")" merge.out &&
+	jq -e ".ranks == \"0-3\"" merge.out
+'
+test_expect_success 'reduction of a subtree covers only that subtree' '
+	${TREEREDUCE} --rank=1 attr.get idset value "{\"name\":\"rank\"}" \
+		>subtree.out &&
+	jq -e ".value == \"1,3\"" subtree.out
+'
+test_expect_success 'failing method puts ranks in the error set' '
+	${TREEREDUCE} nosuch.method idset >fail.out &&
+	jq -e ".value == null" fail.out &&
+	jq -e ".ranks == \"\"" fail.out &&
+	jq -e ".errors == \"0-3\"" fail.out
+'
+test_expect_success 'response of the wrong type puts ranks in the error set' '
+	${TREEREDUCE} overlay.stats-get idset child-count >type.out &&
+	jq -e ".errors == \"0-3\"" type.out
+'
+test_expect_success 'unknown operator fails' '
+	test_must_fail ${TREEREDUCE} attr.get nosuchop 2>badop.err &&
+	grep "unknown reduction operator" badop.err
+'
+test_expect_success 'treereduce.run is restricted to the instance owner' '
+	test_must_fail env FLUX_HANDLE_ROLEMASK=0x2 \
+		${TREEREDUCE} attr.get idset 2>guest.err &&
+	grep "not permitted" guest.err
+'
+
+test_done
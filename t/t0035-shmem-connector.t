@@ -0,0 +1,48 @@
+#!/bin/sh
+#
+
+test_description='Test shmem:// connector'
+
+. `dirname $0`/sharness.sh
+
+test_under_flux 1 minimal
+
+test_expect_success 'connector-local creates shmem handshake socket' '
+	test -S $(flux getattr rundir)/local-shmem
+'
+test_expect_success 'set FLUX_URI to shmem:// equivalent of local-uri' '
+	SHMEM_URI=$(flux getattr local-uri | sed -e "s|^local://|shmem://|")
+'
+test_expect_success 'flux getattr works over shmem://' '
+	FLUX_URI=$SHMEM_URI flux getattr rank >rank.out &&
+	test "$(cat rank.out)" = "0"
+'
+test_expect_success 'ping: 10K 1K byte echo requests over shmem://' '
+	FLUX_URI=$SHMEM_URI run_timeout 25 \
+	    flux ping --pad 1024 --count 10240 --interval 0 0 >/dev/null
+'
+test_expect_success 'ping: 10 1M byte echo requests over shmem://' '
+	FLUX_URI=$SHMEM_URI run_timeout 15 \
+	    flux ping --pad 1M --count 10 --interval 0 0 >/dev/null
+'
+test_expect_success 'events are delivered over shmem://' '
+	FLUX_URI=$SHMEM_URI flux event sub --count=1 test.shmem >event.out &
+	pid=$! &&
+	sleep 1 &&
+	flux event pub test.shmem &&
+	wait $pid &&
+	grep "^test.shmem" event.out
+'
+test_expect_success 'broker notices when shmem:// client exits' '
+	FLUX_URI=$SHMEM_URI flux event sub test.never &
+	pid=$! &&
+	sleep 1 &&
+	kill $pid &&
+	test_expect_code 143 wait $pid &&
+	flux ping --count=1 broker
+'
+test_expect_success 'shmem:// connect fails with nonexistent path' '
+	test_must_fail env FLUX_URI=shmem:///noexist flux getattr rank 2>err &&
+	grep "not found" err
+'
+test_done
@@ -0,0 +1,47 @@
+#!/bin/sh
+#
+
+test_description='Smoke test the msgbench message layer benchmark'
+
+. `dirname $0`/sharness.sh
+
+test_under_flux 2 minimal
+
+MSGBENCH=${FLUX_BUILD_DIR}/src/test/bench/msgbench
+
+test_expect_success 'msgbench with no test fails with usage' '
+	test_must_fail $MSGBENCH 2>usage.err &&
+	grep Usage usage.err
+'
+test_expect_success 'msgbench with unknown test fails' '
+	test_must_fail $MSGBENCH badtest
+'
+test_expect_success 'msgbench encode works' '
+	$MSGBENCH --count=10 --size=0,1K encode >encode.out &&
+	test $(wc -l <encode.out) -eq 4 &&
+	jq -e "select(.test == \"decode\" and .size == 1024)" <encode.out
+'
+test_expect_success 'msgbench rpc over interthread works' '
+	$MSGBENCH --count=10 --window=4 --size=64 --uri=interthread rpc \
+	    >interthread.out &&
+	jq -e ".path == \"interthread\" and .count == 10 and .latency.max > 0" \
+	    <interthread.out
+'
+test_expect_success 'msgbench rpc to the local broker works' '
+	$MSGBENCH --count=10 --size=1K rpc >local.out &&
+	jq -e ".path == \"local\" and .size == 1024" <local.out
+'
+test_expect_success 'msgbench rpc over the overlay works' '
+	$MSGBENCH --count=10 --size=1K --rank=1 rpc >overlay.out &&
+	jq -e ".path == \"overlay\"" <overlay.out
+'
+test_expect_success 'msgbench event works on rank 1' '
+	flux exec -r 1 $MSGBENCH --count=10 --window=2 --size=0,1K event \
+	    >event.out &&
+	test $(wc -l <event.out) -eq 2 &&
+	jq -e ".test == \"event\" and .latency.min > 0" <event.out
+'
+test_expect_success 'msgbench event rejects interthread' '
+	test_must_fail $MSGBENCH --uri=interthread event
+'
+test_done
@@ -1272,6 +1272,56 @@ test_expect_success 'setroot-pause request with empty payload fails with EPROTO(
 test_expect_success 'setroot-unpause request with empty payload fails with EPROTO(71)' '
 	${RPC} kvs.setroot-unpause 71 </dev/null
 '
+test_expect_success 'lookup-stream request without streaming flag fails with EPROTO(71)' '
+	${RPC} kvs.lookup-stream 71 </dev/null
+'
+
+#
+# streaming get/put
+#
+
+test_expect_success 'kvs: put --stream stores a large value' '
+	dd if=/dev/urandom of=stream.in bs=1M count=3 2>/dev/null &&
+	echo foo >>stream.in &&
+	flux kvs put --stream stream.big=- <stream.in &&
+	flux kvs get --raw stream.big >stream.out &&
+	cmp stream.in stream.out
+'
+test_expect_success 'kvs: put --stream leaves no temporary key behind' '
+	flux kvs ls stream >ls.out &&
+	test_must_fail grep "~stream" ls.out
+'
+test_expect_success 'kvs: get --stream retrieves a large value' '
+	flux kvs get --stream stream.big >stream.out2 &&
+	cmp stream.in stream.out2
+'
+test_expect_success 'kvs: put --stream of empty input works' '
+	flux kvs put --stream stream.empty=- </dev/null &&
+	flux kvs get --stream stream.empty >stream_empty.out &&
+	test_must_be_empty stream_empty.out
+'
+test_expect_success 'kvs: get --stream works on a small value' '
+	flux kvs put stream.small=hello &&
+	flux kvs get --stream stream.small >stream_small.out &&
+	printf hello >stream_small.exp &&
+	cmp stream_small.exp stream_small.out
+'
+test_expect_success 'kvs: get --stream of a directory fails' '
+	test_must_fail flux kvs get --stream stream
+'
+test_expect_success 'kvs: get --stream of a missing key fails' '
+	test_must_fail flux kvs get --stream stream.nokey
+'
+test_expect_success 'kvs: get --stream --watch fails' '
+	test_must_fail flux kvs get --stream --watch stream.small
+'
+test_expect_success 'kvs: put --stream requires key=-' '
+	test_must_fail flux kvs put --stream stream.big=foo &&
+	test_must_fail flux kvs put --stream stream.a=- stream.b=-
+'
+test_expect_success 'kvs: unlink streamed keys' '
+	flux kvs unlink -R stream
+'
 
 #
 # module corner cases
@@ -488,6 +488,15 @@ test_expect_success 'kvs: test fence returns identical root info on all response
         ${FLUX_BUILD_DIR}/t/kvs/fence_api 8 apitest
 '
 
+test_expect_success 'kvs: fence participants on rank 1 are relayed upstream' '
+        flux exec -n -r 1 flux module stats -c kvs &&
+        flux exec -n -r 1 ${FLUX_BUILD_DIR}/t/kvs/fence_api 8 relaytest &&
+        flux exec -n -r 1 flux module stats kvs >relayfence.stats &&
+        jq -e ".relayfence.\"#participants\" == 8" <relayfence.stats &&
+        jq -e ".relayfence.\"#rpcs\" >= 1" <relayfence.stats &&
+        jq -e ".relayfence.\"#rpcs\" <= 8" <relayfence.stats
+'
+
 #
 # test invalid fence arguments
 #
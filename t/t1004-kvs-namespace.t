@@ -546,4 +546,69 @@ test_expect_success NO_CHAIN_LINT 'kvs: wait in different namespaces works' '
         test_expect_code 0 wait $testkvswaitpid
 '
 
+test_expect_success NO_CHAIN_LINT 'kvs: concurrent commits to many namespaces work' '
+        for i in $(seq 1 32); do
+                flux kvs namespace create manyns-$i || return 1
+        done
+        for i in $(seq 1 32); do
+                (for j in $(seq 1 8); do
+                        flux kvs put --namespace=manyns-$i key$j=$i.$j
+                done) &
+        done
+        for j in $(seq 1 8); do
+                flux kvs put --namespace=$PRIMARYNAMESPACE $DIR.many$j=$j &
+        done
+        wait
+        for i in $(seq 1 32); do
+                test $(flux kvs get --namespace=manyns-$i key8) = "$i.8" \
+                        || return 1
+        done
+        test $(flux kvs get --namespace=$PRIMARYNAMESPACE $DIR.many8) = "8" &&
+        for i in $(seq 1 32); do
+                flux kvs namespace remove manyns-$i || return 1
+        done
+'
+
+#
+# Followers learn about new namespaces from events
+#
+
+wait_prefetch() {
+        i=0
+        while ! flux exec -n -r $1 flux kvs namespace list | grep -q "^$2 " \
+              && [ $i -lt ${KVS_WAIT_ITERS} ]
+        do
+                sleep 0.1
+                i=$((i + 1))
+        done
+        return $(loophandlereturn $i)
+}
+
+test_expect_success 'kvs: new namespace is known on rank 1 before first use' '
+        flux kvs namespace create prefetchns &&
+        wait_prefetch 1 prefetchns &&
+        flux exec -n -r 1 flux module stats kvs >prefetch.stats &&
+        jq -e ".getroot.\"#prefetched\" > 0" <prefetch.stats
+'
+test_expect_success 'kvs: prefetched namespace can be used on rank 1' '
+        flux kvs put --namespace=prefetchns a=1 &&
+        flux exec -n -r 1 flux kvs get --namespace=prefetchns a >prefetch.out &&
+        echo 1 >prefetch.exp &&
+        test_cmp prefetch.exp prefetch.out
+'
+test_expect_success 'kvs: concurrent lookups of a new namespace on rank 1 work' '
+        flux kvs namespace create getrootns &&
+        flux kvs put --namespace=getrootns a=1 &&
+        flux exec -n -r 1 sh -c "for i in \$(seq 1 8); do \
+            flux kvs get --namespace=getrootns a & done; wait" >getroot.out &&
+        test $(grep -c 1 getroot.out) -eq 8 &&
+        flux exec -n -r 1 flux module stats kvs >getroot.stats &&
+        jq -e ".getroot | has(\"#rpcs\") and has(\"#coalesced\")" \
+            <getroot.stats
+'
+test_expect_success 'kvs: remove namespaces used on rank 1' '
+        flux kvs namespace remove prefetchns &&
+        flux kvs namespace remove getrootns
+'
+
 test_done
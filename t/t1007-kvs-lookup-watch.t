@@ -46,6 +46,25 @@ test_expect_success NO_CHAIN_LINT 'kvs-watch stats reports active watcher' '
        wait $pid
 '
 
+test_expect_success NO_CHAIN_LINT 'kvs-watch shares lookups of the same key' '
+       flux kvs put test.shared=0 &&
+       flux kvs get --watch --count=2 test.shared >shared1.out &
+       pid1=$! &&
+       flux kvs get --watch --count=2 test.shared >shared2.out &
+       pid2=$! &&
+       $waitfile --count=1 --timeout=10 --pattern="[0-9]+" shared1.out &&
+       $waitfile --count=1 --timeout=10 --pattern="[0-9]+" shared2.out &&
+       before=$(flux module stats --parse=shared-lookups kvs-watch) &&
+       flux kvs put --no-merge test.shared=1 &&
+       wait $pid1 &&
+       wait $pid2 &&
+       after=$(flux module stats --parse=shared-lookups kvs-watch) &&
+       test $after -gt $before &&
+       printf "0\n1\n" >shared.exp &&
+       test_cmp shared.exp shared1.out &&
+       test_cmp shared.exp shared2.out
+'
+
 # Check that stdin contains an integer on each line that
 # is one more than the integer on the previous line.
 test_monotonicity() {
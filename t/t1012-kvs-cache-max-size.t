@@ -0,0 +1,90 @@
+#!/bin/sh
+#
+
+test_description='Test kvs module cache-max-size config.'
+
+. `dirname $0`/kvs/kvs-helper.sh
+
+. `dirname $0`/sharness.sh
+
+export FLUX_CONF_DIR=$(pwd)
+SIZE=1
+test_under_flux ${SIZE} minimal
+
+cache_stat() {
+	flux module stats kvs | jq -r ".cache[\"$1\"]"
+}
+
+test_expect_success 'configure bad cache-max-size in kvs' '
+	cat >kvs.toml <<-EOF &&
+	[kvs]
+	cache-max-size = "1Z"
+	EOF
+	flux config reload &&
+	test_must_fail flux module load kvs
+'
+
+test_expect_success 'configure small cache-max-size, load modules' '
+	cat >kvs.toml <<-EOF &&
+	[kvs]
+	cache-max-size = "16k"
+	EOF
+	flux config reload &&
+	flux module load content &&
+	flux module load content-sqlite &&
+	flux module load kvs
+'
+
+test_expect_success 'kvs: stats report cache max size' '
+	test $(cache_stat "max bytes") -eq 16384
+'
+
+test_expect_success 'kvs: store more data than the cache can hold' '
+	for i in $(seq 1 64); do
+		flux kvs put --sync test.$i=$(printf "%01024d" $i) || return 1
+	done
+'
+
+test_expect_success 'kvs: stats report evictions' '
+	test $(cache_stat "#evictions") -gt 0
+'
+
+test_expect_success 'kvs: evicted data can still be read' '
+	flux kvs get test.1 > get1.out &&
+	printf "%01024d\n" 1 > get1.exp &&
+	test_cmp get1.exp get1.out
+'
+
+test_expect_success 'kvs: stats report hit rate' '
+	rate=$(cache_stat "hit rate") &&
+	test "$rate" != null
+'
+
+test_expect_success 'kvs: stats-clear resets eviction counter' '
+	flux module stats --clear kvs &&
+	test $(cache_stat "#evictions") -eq 0
+'
+
+test_expect_success 'configure bad cache-max-size in kvs on reload' '
+	cat >kvs.toml <<-EOF &&
+	[kvs]
+	cache-max-size = "1Z"
+	EOF
+	test_must_fail flux config reload
+'
+
+test_expect_success 're-config cache-max-size to unlimited' '
+	cat >kvs.toml <<-EOF &&
+	[kvs]
+	EOF
+	flux config reload &&
+	test $(cache_stat "max bytes") -eq 0
+'
+
+test_expect_success 'kvs: remove modules' '
+	flux module remove kvs &&
+	flux module remove content-sqlite &&
+	flux module remove content
+'
+
+test_done
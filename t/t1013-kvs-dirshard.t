@@ -0,0 +1,84 @@
+#!/bin/sh
+#
+
+test_description='Test kvs sharded directories.'
+
+. `dirname $0`/kvs/kvs-helper.sh
+
+. `dirname $0`/sharness.sh
+
+export FLUX_CONF_DIR=$(pwd)
+SIZE=1
+test_under_flux ${SIZE} minimal
+
+test_expect_success 'configure bad dirshard-threshold in kvs' '
+	cat >kvs.toml <<-EOF &&
+	[kvs]
+	dirshard-threshold = -1
+	EOF
+	flux config reload &&
+	test_must_fail flux module load kvs
+'
+
+test_expect_success 'configure small dirshard-threshold, load modules' '
+	cat >kvs.toml <<-EOF &&
+	[kvs]
+	dirshard-threshold = 8
+	EOF
+	flux config reload &&
+	flux module load content &&
+	flux module load content-sqlite &&
+	flux module load kvs
+'
+
+test_expect_success 'kvs: fill a directory past the threshold' '
+	for i in $(seq 1 100); do
+		echo test.dir.key$i=$i
+	done | xargs flux kvs put
+'
+
+test_expect_success 'kvs: directory is stored as a dirshard' '
+	ref=$(flux kvs get --treeobj test.dir | jq -r ".data[0]") &&
+	flux content load $ref | jq -e ".type == \"dirshard\""
+'
+
+test_expect_success 'kvs: keys in a sharded directory can be read' '
+	test $(flux kvs get test.dir.key1) -eq 1 &&
+	test $(flux kvs get test.dir.key50) -eq 50 &&
+	test $(flux kvs get test.dir.key100) -eq 100
+'
+
+test_expect_success 'kvs: sharded directory can be listed' '
+	flux kvs ls -1 test.dir >ls.out &&
+	test $(wc -l <ls.out) -eq 100
+'
+
+test_expect_success 'kvs: keys in a sharded directory can be updated' '
+	flux kvs put test.dir.key50=foo &&
+	flux kvs unlink test.dir.key51 &&
+	flux kvs put test.dir.sub.a=bar &&
+	test $(flux kvs get test.dir.key50) = foo &&
+	test_must_fail flux kvs get test.dir.key51 &&
+	test $(flux kvs get test.dir.sub.a) = bar &&
+	test $(flux kvs get test.dir.key52) -eq 52
+'
+
+test_expect_success 'kvs: sharded directory can be dumped' '
+	flux dump dump.tar &&
+	tar tvf dump.tar >dump.out &&
+	grep -q test/dir/key100 dump.out &&
+	grep -q test/dir/sub/a dump.out
+'
+
+test_expect_success 'kvs: sharded directory can be removed' '
+	flux kvs unlink -R test.dir &&
+	test_must_fail flux kvs get test.dir.key1
+'
+
+test_expect_success 'kvs: remove modules' '
+	flux module remove kvs &&
+	flux module remove content-sqlite &&
+	flux module remove content
+'
+
+test_done
@@ -0,0 +1,74 @@
+#!/bin/sh
+#
+
+test_description='Test kvs batched lookups.'
+
+. `dirname $0`/kvs/kvs-helper.sh
+
+. `dirname $0`/sharness.sh
+
+test_under_flux 4 kvs
+
+LOOKUP_BATCH=${FLUX_BUILD_DIR}/t/kvs/lookup_batch
+RPC=${FLUX_BUILD_DIR}/t/request/rpc
+RPC_STREAM=${FLUX_BUILD_DIR}/t/request/rpc_stream
+
+test_expect_success 'populate kvs' '
+	flux kvs put test.a=1 test.b=2 test.c=3 &&
+	flux kvs put test.dir.x=foo &&
+	flux kvs link test.a test.link
+'
+test_expect_success 'lookup_batch returns values for all keys' '
+	$LOOKUP_BATCH test.a test.b test.c test.link >batch.out &&
+	cat >batch.exp <<-EOF &&
+	test.a=1
+	test.b=2
+	test.c=3
+	test.link=1
+	EOF
+	test_cmp batch.exp batch.out
+'
+test_expect_success 'lookup_batch reports errors for individual keys' '
+	$LOOKUP_BATCH test.a test.nokey test.dir test.c >batch_err.out &&
+	cat >batch_err.exp <<-EOF &&
+	test.a=1
+	test.nokey: No such file or directory
+	test.dir: Is a directory
+	test.c=3
+	EOF
+	test_cmp batch_err.exp batch_err.out
+'
+test_expect_success 'lookup_batch works on a rank with a cold cache' '
+	flux exec -r 3 $LOOKUP_BATCH test.c test.b test.dir.x >batch_r3.out &&
+	cat >batch_r3.exp <<-EOF &&
+	test.c=3
+	test.b=2
+	test.dir.x=foo
+	EOF
+	test_cmp batch_r3.exp batch_r3.out
+'
+test_expect_success 'lookup_batch works with many keys' '
+	for i in $(seq 1 100); do echo "test.many.k$i=$i"; done >many.exp &&
+	flux kvs put $(cat many.exp) &&
+	flux exec -r 2 $LOOKUP_BATCH \
+		$(for i in $(seq 1 100); do echo test.many.k$i; done) \
+		>many.out &&
+	test_cmp many.exp many.out
+'
+test_expect_success 'kvs.lookup-batch fails without streaming flag' '
+	echo "{\"keys\":[\"test.a\"], \"namespace\":\"primary\", \"flags\":0}" \
+		>nostream.in &&
+	${RPC} kvs.lookup-batch 71 <nostream.in
+'
+test_expect_success 'kvs.lookup-batch fails with empty key list' '
+	echo "{\"keys\":[], \"namespace\":\"primary\", \"flags\":0}" \
+		| test_must_fail ${RPC_STREAM} kvs.lookup-batch 2>nokeys.err &&
+	grep "Protocol error" nokeys.err
+'
+test_expect_success 'kvs.lookup-batch fails on unknown namespace' '
+	echo "{\"keys\":[\"test.a\"], \"namespace\":\"nons\", \"flags\":0}" \
+		| test_must_fail ${RPC_STREAM} kvs.lookup-batch 2>nons.err &&
+	grep "Operation not supported" nons.err
+'
+
+test_done
@@ -0,0 +1,71 @@
+#!/bin/sh
+#
+
+test_description='Test kvs setroot-delta-max-size config.'
+
+. `dirname $0`/kvs/kvs-helper.sh
+
+. `dirname $0`/sharness.sh
+
+export FLUX_CONF_DIR=$(pwd)
+SIZE=2
+test_under_flux ${SIZE} minimal
+
+faults() {
+	flux exec -r $1 flux module stats kvs | jq -r ".cache[\"#faults\"]"
+}
+
+test_expect_success 'configure bad setroot-delta-max-size in kvs' '
+	cat >kvs.toml <<-EOF &&
+	[kvs]
+	setroot-delta-max-size = "1Z"
+	EOF
+	flux config reload &&
+	test_must_fail flux module load kvs
+'
+
+test_expect_success 'load modules without setroot delta' '
+	rm -f kvs.toml &&
+	flux exec flux config reload &&
+	flux exec flux module load content &&
+	flux module load content-sqlite &&
+	flux exec flux module load kvs
+'
+
+test_expect_success 'kvs: lookup of new data on rank 1 faults in dirs' '
+	flux kvs put test.a.b.c=0 &&
+	VERS=$(flux kvs version) &&
+	flux exec -r 1 flux kvs wait $VERS &&
+	flux exec -r 1 flux kvs get test.a.b.c &&
+	flux kvs put test.a.b.d=1 &&
+	VERS=$(flux kvs version) &&
+	flux exec -r 1 flux kvs wait $VERS &&
+	before=$(faults 1) &&
+	test $(flux exec -r 1 flux kvs get test.a.b.d) -eq 1 &&
+	test $(faults 1) -gt $before
+'
+
+test_expect_success 'reload config with setroot-delta-max-size' '
+	cat >kvs.toml <<-EOF &&
+	[kvs]
+	setroot-delta-max-size = "64K"
+	EOF
+	flux config reload
+'
+
+test_expect_success 'kvs: lookup of new data on rank 1 uses delta' '
+	flux kvs put test.a.b.e=2 &&
+	VERS=$(flux kvs version) &&
+	flux exec -r 1 flux kvs wait $VERS &&
+	before=$(faults 1) &&
+	test $(flux exec -r 1 flux kvs get test.a.b.e) -eq 2 &&
+	test $(faults 1) -eq $before
+'
+
+test_expect_success 'kvs: remove modules' '
+	flux exec flux module remove kvs &&
+	flux module remove content-sqlite &&
+	flux exec flux module remove content
+'
+
+test_done
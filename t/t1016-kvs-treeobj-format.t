@@ -0,0 +1,83 @@
+#!/bin/sh
+#
+
+test_description='Test kvs treeobj-format config.'
+
+. `dirname $0`/kvs/kvs-helper.sh
+
+. `dirname $0`/sharness.sh
+
+export FLUX_CONF_DIR=$(pwd)
+SIZE=1
+test_under_flux ${SIZE} minimal
+
+# Print the first byte of the content object referenced by key $1
+first_byte() {
+	ref=$(flux kvs get --treeobj $1 | jq -r ".data[0]") &&
+	flux content load $ref | od -An -tx1 -N1 | tr -d " "
+}
+
+test_expect_success 'configure bad treeobj-format in kvs' '
+	cat >kvs.toml <<-EOF &&
+	[kvs]
+	treeobj-format = "xml"
+	EOF
+	flux config reload &&
+	test_must_fail flux module load kvs
+'
+
+test_expect_success 'configure binary treeobj-format, load modules' '
+	cat >kvs.toml <<-EOF &&
+	[kvs]
+	treeobj-format = "binary"
+	EOF
+	flux config reload &&
+	flux module load content &&
+	flux module load content-sqlite &&
+	flux module load kvs
+'
+
+test_expect_success 'kvs: directories are stored in binary encoding' '
+	flux kvs put test.bin.a=1 test.bin.b=foo &&
+	test $(first_byte test.bin) = ff
+'
+
+test_expect_success 'kvs: binary encoded directories can be read' '
+	test $(flux kvs get test.bin.a) -eq 1 &&
+	test $(flux kvs get test.bin.b) = foo &&
+	flux kvs ls -1 test.bin >ls.out &&
+	test $(wc -l <ls.out) -eq 2
+'
+
+test_expect_success 'reload config with json treeobj-format' '
+	cat >kvs.toml <<-EOF &&
+	[kvs]
+	treeobj-format = "json"
+	EOF
+	flux config reload
+'
+
+test_expect_success 'kvs: directories are stored in JSON encoding' '
+	flux kvs put test.json.a=2 &&
+	test $(first_byte test.json) = 7b
+'
+
+test_expect_success 'kvs: both encodings can be read' '
+	test $(flux kvs get test.bin.a) -eq 1 &&
+	test $(flux kvs get test.json.a) -eq 2
+'
+
+test_expect_success 'kvs: binary encoded directories can be dumped' '
+	flux dump dump.tar &&
+	tar tvf dump.tar >dump.out &&
+	grep -q test/bin/b dump.out &&
+	grep -q test/json/a dump.out
+'
+
+test_expect_success 'kvs: remove modules' '
+	flux module remove kvs &&
+	flux module remove content-sqlite &&
+	flux module remove content
+'
+
+test_done
@@ -0,0 +1,53 @@
+#!/bin/sh
+#
+
+test_description='Smoke test the kvsbench KVS and content benchmark'
+
+. `dirname $0`/sharness.sh
+
+test_under_flux 1
+
+KVSBENCH=${FLUX_BUILD_DIR}/src/test/bench/kvsbench
+
+test_expect_success 'kvsbench with unknown test fails' '
+	test_must_fail $KVSBENCH badtest
+'
+test_expect_success 'kvsbench commit works with many keys' '
+	$KVSBENCH --count=10 --keys=8 --size=16,1K commit >commit.out &&
+	test $(wc -l <commit.out) -eq 2 &&
+	jq -e "select(.size == 1024) | .keys == 8 and .latency.p99 > 0" \
+	    <commit.out
+'
+test_expect_success 'kvsbench append works' '
+	$KVSBENCH --count=10 append >append.out &&
+	jq -e ".test == \"append\" and .count == 10" <append.out
+'
+test_expect_success 'kvsbench fence works' '
+	$KVSBENCH --count=10 --nprocs=3 fence >fence.out &&
+	jq -e ".nprocs == 3" <fence.out
+'
+test_expect_success 'kvsbench lookup works' '
+	$KVSBENCH --count=10 --depth=16 lookup >lookup.out &&
+	jq -e ".depth == 16" <lookup.out
+'
+test_expect_success 'kvsbench watch works' '
+	$KVSBENCH --count=10 --watchers=4 watch >watch.out &&
+	jq -e ".watchers == 4 and .latency.p50 > 0" <watch.out
+'
+test_expect_success 'kvsbench store and load work' '
+	$KVSBENCH --count=10 --size=4K store >store.out &&
+	jq -e ".bypass == false" <store.out &&
+	$KVSBENCH --count=10 --size=4K load >load.out &&
+	jq -e ".test == \"load\"" <load.out
+'
+test_expect_success 'kvsbench store and load work with --bypass' '
+	$KVSBENCH --count=10 --bypass store >store-bypass.out &&
+	jq -e ".bypass == true and (.backend | type == \"string\")" \
+	    <store-bypass.out &&
+	$KVSBENCH --count=10 --bypass load >load-bypass.out
+'
+test_expect_success 'kvsbench removes its keys' '
+	flux kvs ls >ls.out &&
+	test_must_fail grep kvsbench ls.out
+'
+test_done
@@ -0,0 +1,119 @@
+#!/bin/sh
+#
+
+test_description='Test kvs module top-N tracking of hot keys and users.'
+
+. `dirname $0`/kvs/kvs-helper.sh
+
+. `dirname $0`/sharness.sh
+
+export FLUX_CONF_DIR=$(pwd)
+SIZE=1
+test_under_flux ${SIZE} minimal
+
+top_stat() {
+	flux module stats kvs | jq -c ".top.$1"
+}
+
+test_expect_success 'configure bad top-sample in kvs' '
+	cat >kvs.toml <<-EOF &&
+	[kvs]
+	top-sample = 0
+	EOF
+	flux config reload &&
+	test_must_fail flux module load kvs
+'
+
+test_expect_success 'configure top-sample = 1, load modules' '
+	cat >kvs.toml <<-EOF &&
+	[kvs]
+	top-sample = 1
+	EOF
+	flux config reload &&
+	flux module load content &&
+	flux module load kvs
+'
+
+test_expect_success 'kvs: put and get some keys' '
+	for i in $(seq 1 8); do
+		flux kvs put hot.dir.$i=$i || return 1
+	done &&
+	flux kvs put cold=1 &&
+	for i in $(seq 1 8); do
+		flux kvs get hot.dir.$i || return 1
+	done
+'
+
+test_expect_success 'kvs: stats report the hottest key prefix first' '
+	top_stat prefix >prefix.json &&
+	jq -e ".[0].name == \"hot.dir\"" <prefix.json &&
+	jq -e ".[0].lookups == 8" <prefix.json &&
+	jq -e ".[0].commits == 8" <prefix.json &&
+	jq -e ".[0].bytes > 0" <prefix.json &&
+	jq -e "map(select(.name == \".\")) | .[0].commits == 1" <prefix.json
+'
+
+test_expect_success 'kvs: stats report the namespace and userid' '
+	top_stat namespace >namespace.json &&
+	jq -e ".[0].name == \"primary\"" <namespace.json &&
+	jq -e ".[0].commits == 9" <namespace.json &&
+	top_stat userid >userid.json &&
+	jq -e ".[0].name == \"$(id -u)\"" <userid.json
+'
+
+test_expect_success 'flux kvs top shows all tables' '
+	flux kvs top >top.out &&
+	test_debug "cat top.out" &&
+	grep "^namespace" top.out &&
+	grep "^prefix" top.out &&
+	grep "^userid" top.out &&
+	grep "^hot.dir" top.out &&
+	grep "^primary" top.out
+'
+
+test_expect_success 'flux kvs top --type and --limit work' '
+	flux kvs top --type=prefix --limit=1 >top-prefix.out &&
+	test_debug "cat top-prefix.out" &&
+	test $(wc -l <top-prefix.out) -eq 2 &&
+	grep "^hot.dir" top-prefix.out
+'
+
+test_expect_success 'flux kvs top fails with bad --type' '
+	test_must_fail flux kvs top --type=foo
+'
+
+test_expect_success 'kvs: top tables are empty for a guest' '
+	FLUX_HANDLE_USERID=9999 FLUX_HANDLE_ROLEMASK=0x2 \
+		flux module stats kvs >guest.json &&
+	jq -e ".top.prefix == []" <guest.json
+'
+
+test_expect_success 'kvs: stats-clear resets the top tables' '
+	flux module stats --clear kvs &&
+	test "$(top_stat prefix)" = "[]"
+'
+
+test_expect_success 'configure top-size = 0 to disable tracking' '
+	cat >kvs.toml <<-EOF &&
+	[kvs]
+	top-size = 0
+	EOF
+	flux config reload &&
+	flux kvs put hot.dir.1=1 &&
+	test "$(top_stat prefix)" = "[]"
+'
+
+test_expect_success 'configure bad top-size in kvs on reload' '
+	cat >kvs.toml <<-EOF &&
+	[kvs]
+	top-size = -1
+	EOF
+	test_must_fail flux config reload
+'
+
+test_expect_success 'kvs: remove modules' '
+	flux module remove kvs &&
+	flux module remove content
+'
+
+test_done
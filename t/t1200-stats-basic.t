@@ -42,6 +42,21 @@ test_expect_success 'valid content-cache packets received' '
 	$timeout flux python $udp -s content-cache -V flux start sleep 1
 '
 
+test_expect_success 'timing quantiles received for kvs commit' '
+	$timeout flux python $udp -s kvs.commit.p99 flux start \
+	"flux kvs put a=1 && sleep 1"
+'
+
+test_expect_success 'timing quantiles received for content store' '
+	$timeout flux python $udp -s content-cache.store.p50 flux start \
+	"flux kvs put a=1 && flux content flush && sleep 1"
+'
+
+test_expect_success 'timing quantiles received for job alloc' '
+	$timeout flux python $udp -s job-manager.alloc.p95 flux start \
+	"flux run hostname && sleep 1"
+'
+
 test_expect_success 'nothing received with no endpoint' '
 	unset FLUX_FRIPP_STATSD &&
 	test_expect_code 137 $timeout5 flux python $udp -n flux start
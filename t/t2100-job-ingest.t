@@ -137,6 +137,19 @@ test_expect_success NO_ASAN 'job-ingest: submit job 100 times, reuse signature'
 	${SUBMITBENCH} ${SUBMITBENCH_OPT_R} -r 100 use_case_2.6.json
 '
 
+test_expect_success 'job-ingest: stats report commit batching' '
+	flux module stats job-ingest >batch.stats &&
+	jq -e ".batch.\"batch-size\".count > 0" <batch.stats &&
+	jq -e ".batch.\"commit-usec\".count > 0" <batch.stats &&
+	jq -e ".batch.\"batch-size\".max <= .batch.\"max-count\"" <batch.stats
+'
+
+test_expect_success 'job-ingest: stats report signature cache hits' '
+	flux module stats job-ingest >signcache.stats &&
+	jq -e ".signcache.size > 0" <signcache.stats &&
+	jq -e ".signcache.hits > 0" <signcache.stats
+'
+
 test_expect_success HAVE_FLUX_SECURITY 'job-ingest: submit user != signed user fails' '
 	test_must_fail bash -c "FLUX_HANDLE_USERID=9999 \
 		flux job submit basic.json" 2>baduser.out &&
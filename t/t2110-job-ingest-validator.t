@@ -112,11 +112,37 @@ test_expect_success 'flux job-validator --feasibility-service works ' '
 test_expect_success 'job-ingest: v1 jobspecs accepted by default' '
 	test_valid ${JOBSPEC}/valid_v1/*
 '
+test_expect_success 'job-ingest: v1 jobspecs were validated in-process' '
+	flux module stats job-ingest >native.stats &&
+	jq -e ".pipeline.native.enabled == true" <native.stats &&
+	jq -e ".pipeline.native.validated > 0" <native.stats
+'
+test_expect_success 'job-ingest: invalid jobs rejected with in-process validation' '
+	test_invalid ${JOBSPEC}/invalid/* &&
+	flux module stats job-ingest >native2.stats &&
+	jq -e ".pipeline.native.deferred > 0" <native2.stats
+'
+test_expect_success 'job-ingest: identical jobspecs hit the validation cache' '
+	flux run --dry-run -n1 --setattr=user.x=$(printf "%0200d" 0) true \
+		>big.json &&
+	flux job submit big.json >/dev/null &&
+	flux job submit big.json >big.id &&
+	flux module stats job-ingest >native4.stats &&
+	jq -e ".pipeline.native.\"cache-hits\" > 0" <native4.stats
+'
+test_expect_success 'job-ingest: jobspec stored by reference can be read' '
+	flux job info $(cat big.id) jobspec \
+		| jq -e ".attributes.user.x | length == 200"
+'
 test_expect_success 'job-ingest: test jobspec validator with any version' '
 	ingest_module reload \
 		validator-plugins=jobspec \
 		validator-args="--require-version=any"
 '
+test_expect_success 'job-ingest: in-process validation is disabled by plugin args' '
+	flux module stats job-ingest >native3.stats &&
+	jq -e ".pipeline.native.enabled == false" <native3.stats
+'
 test_expect_success 'job-ingest: all valid jobspecs accepted' '
 	test_valid ${JOBSPEC}/valid/*
 '
@@ -158,6 +184,12 @@ test_expect_success 'job-ingest: feasibility validator works with jobs running'
 	flux cancel ${jobid} &&
 	flux job wait-event ${jobid} clean
 '
+test_expect_success 'job-ingest: repeated feasibility checks get the same result' '
+	test_must_fail flux submit -N 12 -n12 hostname 2>infeasible5.err &&
+	grep "unsatisfiable request" infeasible5.err &&
+	flux submit -n 2 hostname &&
+	flux submit -n 2 hostname
+'
 test_expect_success 'job-ingest: load multiple validators' '
 	ingest_module reload validator-plugins=feasibility,jobspec
 '
@@ -372,9 +372,47 @@ test_expect_success 'submit request with empty payload fails with EPROTO(71)' '
 	${RPC} job-manager.submit 71 </dev/null
 '
 
+test_expect_success 'bulk request with empty payload fails with EPROTO(71)' '
+	${RPC} job-manager.bulk 71 </dev/null
+'
+test_expect_success 'bulk request with unknown op fails with EPROTO(71)' '
+	echo "{\"op\":\"foo\",\"ids\":[]}" \
+	    | ${RPC} job-manager.bulk 71
+'
+test_expect_success 'job-manager: submit jobs for bulk operations' '
+	for i in 1 2 3; do \
+	    flux job submit basic.json | flux job id; \
+	done >bulk.ids
+'
+test_expect_success 'job-manager: bulk urgency works' '
+	jq -s "{op:\"urgency\", urgency:20, ids:(.+[42])}" bulk.ids \
+	    | ${RPC} job-manager.bulk >bulk-urgency.out &&
+	jq -e ".count == 3" bulk-urgency.out &&
+	jq -e ".errors == [[42, \"unknown job\"]]" bulk-urgency.out &&
+	for id in $(cat bulk.ids); do \
+	    flux job eventlog $id | grep "urgency=20" || return 1; \
+	done
+'
+test_expect_success 'job-manager: bulk cancel works' '
+	jq -s "{op:\"cancel\", note:\"bulk\", ids:.}" bulk.ids \
+	    | ${RPC} job-manager.bulk >bulk-cancel.out &&
+	jq -e ".count == 3 and .errors == []" bulk-cancel.out &&
+	for id in $(cat bulk.ids); do \
+	    flux job wait-event -t 10 $id clean || return 1; \
+	done
+'
+test_expect_success 'job-manager: bulk urgency on inactive jobs fails per job' '
+	jq -s "{op:\"urgency\", urgency:16, ids:.}" bulk.ids \
+	    | ${RPC} job-manager.bulk >bulk-inactive.out &&
+	jq -e ".count == 0" bulk-inactive.out &&
+	jq -e "[.errors[][1]] | unique == [\"job is inactive\"]" \
+	    bulk-inactive.out
+'
+
 test_expect_success 'job-manager stats works' '
 	flux module stats job-manager > stats.out &&
-	cat stats.out | $jq -e .journal.listeners
+	cat stats.out | $jq -e .journal.listeners &&
+	cat stats.out | $jq -e ".batch.\"commit-usec\".count > 0"
 '
 
 test_expect_success 'flux module stats job-manager is open to guests' '
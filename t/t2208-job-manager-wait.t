@@ -172,6 +172,56 @@ test_expect_success "wait --all --verbose emits one line per successful job" '
 	test $(wc -l <verbose.err) -eq 3
 '
 
+test_expect_success "streaming wait fails on specific jobid" '
+	cat >wait_stream_id.py <<-EOT &&
+	import flux
+	h = flux.Flux()
+	h.rpc("job-manager.wait", {"id": 42}, flags=flux.constants.FLUX_RPC_STREAMING).get()
+	EOT
+	test_must_fail flux python wait_stream_id.py 2>stream_id.err &&
+	grep "requires FLUX_JOBID_ANY" stream_id.err
+'
+
+test_expect_success "streaming wait batches zombies and ends with ENODATA" '
+	for i in 1 2 3; do flux submit --flags waitable /bin/true; done &&
+	flux queue drain &&
+	cat >wait_stream.py <<-EOT &&
+	import errno
+	import flux
+	h = flux.Flux()
+	f = h.rpc("job-manager.wait", {"id": flux.constants.FLUX_JOBID_ANY},
+	          flags=flux.constants.FLUX_RPC_STREAMING)
+	n = 0
+	try:
+	    while True:
+	        jobs = f.get()["jobs"]
+	        print(len(jobs))
+	        n += len(jobs)
+	        f.reset()
+	except OSError as exc:
+	    assert exc.errno == errno.ENODATA
+	print(f"total {n}")
+	EOT
+	flux python wait_stream.py >stream.out &&
+	test_debug "cat stream.out" &&
+	head -1 stream.out | grep "^3$" &&
+	grep "total 3" stream.out &&
+	test_job_count 0
+'
+
+test_expect_success "streaming wait receives jobs as they become inactive" '
+	flux submit --flags waitable sleep 0.5 &&
+	flux submit --flags waitable sleep 1 &&
+	flux python wait_stream.py >stream2.out &&
+	grep "total 2" stream2.out &&
+	test_job_count 0
+'
+
+test_expect_success "streaming wait ends with no waitable jobs" '
+	flux python wait_stream.py >stream3.out &&
+	grep "total 0" stream3.out
+'
+
 test_expect_success "wait fails on bad jobid, " '
 	test_expect_code 2 flux job wait 1
 '
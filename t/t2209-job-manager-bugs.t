@@ -51,13 +51,14 @@ test_expect_success 'issue3218: urgency change on running job doesnt segfault' '
 '
 #
 # Issue 4409: eventlog commit / job start race
-# Also tests job-manager.set-batch-timeout RPC
+# Also tests job-manager.set-batch-timeout RPC, which sets a fixed delay
+# in place of adaptive batching until it is set back to zero.
 #
 test_expect_success 'issue4409: eventlog commit races with job launch' '
 	printf "{\"timeout\": \"1\"}" | \
 	    test_expect_code 1 ${RPC} job-manager.set-batch-timeout &&
 	printf "{\"timeout\": 1}" | ${RPC} job-manager.set-batch-timeout &&
 	flux submit -vvv --cc=1-5 --wait --quiet hostname &&
-	printf "{\"timeout\": 0.01}" | ${RPC} job-manager.set-batch-timeout
+	printf "{\"timeout\": 0}" | ${RPC} job-manager.set-batch-timeout
 '
 test_done
@@ -10,6 +10,7 @@ test_under_flux 4
 
 RPC=${FLUX_BUILD_DIR}/t/request/rpc
 EVENTS_JOURNAL_STREAM=${FLUX_BUILD_DIR}/t/job-manager/events_journal_stream
+waitfile=${SHARNESS_TEST_SRCDIR}/scripts/waitfile.lua
 
 flux setattr log-stderr-level 1
 
@@ -227,6 +228,107 @@ test_expect_success NO_CHAIN_LINT 'job-manager: events-journal contains older jo
 	wait $pid
 '
 
+test_expect_success NO_CHAIN_LINT 'job-manager: events-journal states filter works' '
+	$jq -j -c -n "{states:64}" \
+		| $EVENTS_JOURNAL_STREAM > events8.out &
+	pid=$! &&
+	jobid=`flux job submit basic.json | flux job id` &&
+	wait_event_name ${jobid} clean events8.out &&
+	test_must_fail check_event_name ${jobid} submit events8.out &&
+	test_must_fail check_event_name ${jobid} start events8.out &&
+	kill -s USR1 $pid &&
+	wait $pid
+'
+
+test_expect_success NO_CHAIN_LINT 'job-manager: events-journal userid, queue filters work' '
+	$jq -j -c -n "{userid:$(($(id -u)+1))}" \
+		| $EVENTS_JOURNAL_STREAM > events9.out &
+	pid1=$! &&
+	$jq -j -c -n "{queue:\"nosuchqueue\"}" \
+		| $EVENTS_JOURNAL_STREAM > events10.out &
+	pid2=$! &&
+	$jq -j -c -n "{userid:$(id -u), allow:{clean:1}}" \
+		| $EVENTS_JOURNAL_STREAM > events11.out &
+	pid3=$! &&
+	jobid=`flux job submit basic.json | flux job id` &&
+	wait_event_name ${jobid} clean events11.out &&
+	test_must_fail check_event_name ${jobid} clean events9.out &&
+	test_must_fail check_event_name ${jobid} clean events10.out &&
+	kill -s USR1 $pid1 $pid2 $pid3 &&
+	wait $pid1 &&
+	wait $pid2 &&
+	wait $pid3
+'
+
+test_expect_success NO_CHAIN_LINT 'job-manager: events-journal ids filter works' '
+	jobid1=`flux job submit basic.json | flux job id` &&
+	flux job wait-event ${jobid1} clean &&
+	$jq -j -c -n "{full:true, ids:[${jobid1}, ${jobid1}]}" \
+		| $EVENTS_JOURNAL_STREAM > events12.out &
+	pid=$! &&
+	jobid2=`flux job submit basic.json | flux job id` &&
+	flux job wait-event ${jobid2} clean &&
+	wait_event_name ${jobid1} clean events12.out &&
+	kill -s USR1 $pid &&
+	wait $pid &&
+	test_must_fail check_event_name ${jobid2} submit events12.out
+'
+
+test_expect_success NO_CHAIN_LINT 'job-manager: events-journal resumes after since' '
+	$jq -j -c -n "{}" \
+		| $EVENTS_JOURNAL_STREAM --seq > events13.out &
+	pid=$! &&
+	jobid1=`flux job submit basic.json | flux job id` &&
+	wait_event_name ${jobid1} clean events13.out &&
+	kill -s USR1 $pid &&
+	wait $pid &&
+	seq=$($jq -s "map(.seq) | max" events13.out) &&
+	jobid2=`flux job submit basic.json | flux job id` &&
+	flux job wait-event ${jobid2} clean &&
+	$jq -j -c -n "{since:${seq}, allow:{clean:1}}" \
+		| $EVENTS_JOURNAL_STREAM --seq > events14.out &
+	pid=$! &&
+	wait_event_name ${jobid2} clean events14.out &&
+	kill -s USR1 $pid &&
+	wait $pid &&
+	test_must_fail check_event_name ${jobid1} clean events14.out &&
+	$jq -e "select(.id == -1) | .resumed" events14.out
+'
+
+test_expect_success NO_CHAIN_LINT 'job-manager: events-journal since from before load sends backlog' '
+	$jq -j -c -n "{since:1, full:true, allow:{clean:1}}" \
+		| $EVENTS_JOURNAL_STREAM --seq > events15.out &
+	pid=$! &&
+	jobid=`flux job submit basic.json | flux job id` &&
+	wait_event_name ${jobid} clean events15.out &&
+	kill -s USR1 $pid &&
+	wait $pid &&
+	$jq -e "select(.id == -1) | .resumed == false" events15.out &&
+	test $(grep -c clean events15.out) -gt 1
+'
+
+test_expect_success NO_CHAIN_LINT 'job-manager: events-journal resume includes purges' '
+	jobid=`flux job submit basic.json | flux job id` &&
+	flux job wait-event ${jobid} clean &&
+	$jq -j -c -n "{allow:{clean:1}}" \
+		| $EVENTS_JOURNAL_STREAM --seq > events16.out &
+	pid=$! &&
+	jobid2=`flux job submit basic.json | flux job id` &&
+	wait_event_name ${jobid2} clean events16.out &&
+	kill -s USR1 $pid &&
+	wait $pid &&
+	seq=$($jq -s "map(.seq) | max" events16.out) &&
+	flux job purge --force --num-limit=0 &&
+	$jq -j -c -n "{since:${seq}, allow:{purge:1}}" \
+		| $EVENTS_JOURNAL_STREAM --seq > events17.out &
+	pid=$! &&
+	$waitfile --count=1 --timeout=30 --pattern="\"resumed\":true" \
+		events17.out &&
+	kill -s USR1 $pid &&
+	wait $pid &&
+	$jq -e "select(.purged) | select(.id == ${jobid})" events17.out
+'
+
 test_expect_success 'job-manager: events-journal request fails with EPROTO on empty payload' '
 	$RPC job-manager.events-journal 71 < /dev/null
 '
@@ -378,6 +378,56 @@ test_expect_success 'job-manager: job exits PRIORITY when priority is set' '
 	flux jobs -no {priority} $jobid &&
 	test $(flux jobs -no {priority} $jobid) = 42000
 '
+test_expect_success 'job-manager: plugin can set priority of a batch of jobs' '
+	flux submit --cc=1-3 hostname >batch.ids &&
+	for id in $(cat batch.ids); do
+		flux job wait-event -vt 5 $id depend || return 1
+	done &&
+	cat <<-EOF >pri-batch.py &&
+	import flux
+	from flux.job import JobID
+	import sys
+
+	jobs = [[JobID(arg), 100 + i] for i, arg in enumerate(sys.argv[1:])]
+	topic = "job-manager.priority-wait.release-batch"
+	print(flux.Flux().rpc(topic, {"jobs": jobs}).get())
+	EOF
+	flux python pri-batch.py $(cat batch.ids) &&
+	i=0 &&
+	for id in $(cat batch.ids); do
+		flux job wait-event -vt 5 $id clean &&
+		test $(flux jobs -no {priority} $id) = $((100 + i)) || return 1
+		i=$((i + 1))
+	done
+'
+test_expect_success 'job-manager: batch priority update skips inactive jobs' '
+	flux python pri-batch.py $(cat batch.ids)
+'
+test_expect_success 'job-manager: batch priority update rejects bad priority' '
+	cat <<-EOF >pri-batch-bad.py &&
+	import flux
+	topic = "job-manager.priority-wait.release-batch"
+	flux.Flux().rpc(topic, {"jobs": [[1, -1]]}).get()
+	EOF
+	test_must_fail flux python pri-batch-bad.py
+'
+test_expect_success 'job-manager: plugin can reprioritize one user'"'"'s jobs' '
+	flux jobtap load --remove=all ${PLUGINPATH}/priority-invert.so &&
+	flux queue stop &&
+	jobid=$(flux submit --urgency=10 hostname) &&
+	flux job wait-event -vt 5 $jobid priority &&
+	cat <<-EOF >pri-user.py &&
+	import flux
+	import os
+	topic = "job-manager.priority-invert.trigger"
+	flux.Flux().rpc(topic, {"userid": os.getuid()}).get()
+	EOF
+	flux python pri-user.py &&
+	flux job wait-event -vt 5 -c 2 $jobid priority &&
+	test $(flux jobs -no {priority} $jobid) = 21 &&
+	flux cancel $jobid &&
+	flux queue start
+'
 test_expect_success 'job-manager: plugin can reject some jobs in a batch' '
 	flux module reload job-ingest batch-count=6 &&
 	flux jobtap load --remove=all ${PLUGINPATH}/validate.so &&
@@ -35,6 +35,22 @@ test_expect_success 'verify that job manager can restart with current dump' '
 test_expect_success 'and max_jobid is greater than zero' '
 	jq -e ".max_jobid > 0" <stats.out
 '
+test_expect_success 'and the inactive job was restored from the snapshot' '
+	jq -e ".inactive_jobs == 1" <stats.out &&
+	jq -e ".snapshot.restored == 1" <stats.out &&
+	jq -e ".snapshot.replayed == 0" <stats.out
+'
+test_expect_success 'delete snapshot from dump' '
+	mkdir -p tmp-nosnap &&
+	(cd tmp-nosnap && tar -xf -) <dump.tar &&
+	rm -r tmp-nosnap/checkpoint/job-manager-snapshot &&
+	(cd tmp-nosnap && tar -cf - *) >dump-nosnap.tar
+'
+test_expect_success 'verify that job manager replays all jobs without snapshot' '
+	restart_flux dump-nosnap.tar >stats-nosnap.out &&
+	jq -e ".inactive_jobs == 1" <stats-nosnap.out &&
+	jq -e ".snapshot.restored == 0" <stats-nosnap.out
+'
 test_expect_success 'delete checkpoint from dump' '
 	mkdir -p tmp &&
 	(cd tmp && tar -xf -) <dump.tar &&
@@ -7,6 +7,7 @@ test_description='Test flux job info lookup service'
 test_under_flux 4 job
 
 RPC=${FLUX_BUILD_DIR}/t/request/rpc
+RPC_STREAM=${FLUX_BUILD_DIR}/t/request/rpc_stream
 INFOLOOKUP=${FLUX_BUILD_DIR}/t/job-info/info_lookup
 
 fj_wait_event() {
@@ -145,6 +146,44 @@ test_expect_success 'flux job eventlog fails on bad id' '
 	test_must_fail flux job eventlog 12345
 '
 
+test_expect_success 'flux job eventlog --tail works' '
+	jobid=$(submit_job) &&
+	kvsdir=$(flux job id --to=kvs $jobid) &&
+	for i in 1 2 3; do \
+		flux kvs eventlog append ${kvsdir}.eventlog tail$i || return 1; \
+	done &&
+	flux job eventlog --tail=2 $jobid >eventlog_tail.out &&
+	test_debug "cat eventlog_tail.out" &&
+	test $(wc -l <eventlog_tail.out) -eq 2 &&
+	grep -q tail2 eventlog_tail.out &&
+	grep -q tail3 eventlog_tail.out
+'
+
+test_expect_success 'flux job eventlog --tail larger than eventlog works' '
+	flux job eventlog $jobid >eventlog_all.out &&
+	flux job eventlog --tail=1000 $jobid >eventlog_tail_all.out &&
+	test_cmp eventlog_all.out eventlog_tail_all.out
+'
+
+test_expect_success 'flux job eventlog --tail works on output eventlog' '
+	jobid=$(flux submit --wait \
+		sh -c "for i in \$(seq 1 100); do echo line\$i; done") &&
+	fj_wait_event $jobid clean >/dev/null &&
+	flux job eventlog -p output --tail=1 $jobid >output_tail.out &&
+	test_debug "cat output_tail.out" &&
+	test $(wc -l <output_tail.out) -eq 1 &&
+	grep -q eof output_tail.out
+'
+
+test_expect_success 'flux job eventlog --tail fails on bad id or path' '
+	test_must_fail flux job eventlog --tail=1 12345 &&
+	test_must_fail flux job eventlog --tail=1 -p noexist $jobid
+'
+
+test_expect_success 'flux job eventlog --tail=0 fails' '
+	test_must_fail flux job eventlog --tail=0 $jobid
+'
+
 test_expect_success 'flux job eventlog --format=json works' '
 	jobid=$(submit_job) &&
 	flux job eventlog --format=json $jobid > eventlog_format1.out &&
@@ -340,12 +379,56 @@ test_expect_success 'job-info.lookup: decode json returns object' '
 	grep sleep info_decode_2.out
 '
 
+#
+# job-info.lookup-batch
+#
+
+test_expect_success 'job-info.lookup-batch returns a response per job' '
+	id1=$(flux job id --to=dec $(submit_job)) &&
+	id2=$(flux job id --to=dec $(submit_job)) &&
+	$jq -j -c -n "{ids:[${id1},${id2}], keys:[\"jobspec\",\"R\"], flags:0}" \
+	  | test_must_fail ${RPC_STREAM} job-info.lookup-batch \
+		> lookup_batch1.out 2> lookup_batch1.err &&
+	grep "No data available" lookup_batch1.err &&
+	test $(wc -l < lookup_batch1.out) -eq 2 &&
+	$jq -e "select(.id == ${id1}) | .jobspec and .R" lookup_batch1.out &&
+	$jq -e "select(.id == ${id2}) | .jobspec and .R" lookup_batch1.out
+'
+
+test_expect_success 'job-info.lookup-batch reports unknown jobs and continues' '
+	id=$(flux job id --to=dec $(submit_job)) &&
+	$jq -j -c -n "{ids:[12345,${id}], keys:[\"jobspec\"], flags:0}" \
+	  | test_must_fail ${RPC_STREAM} job-info.lookup-batch \
+		> lookup_batch2.out 2> lookup_batch2.err &&
+	grep "No data available" lookup_batch2.err &&
+	$jq -e "select(.id == 12345) | .errnum == 2" lookup_batch2.out &&
+	$jq -e "select(.id == ${id}) | .jobspec" lookup_batch2.out
+'
+
+test_expect_success 'job-info.lookup-batch with more jobs than the window' '
+	id=$(flux job id --to=dec $(submit_job)) &&
+	$jq -j -c -n "{ids:[range(100)|${id}], keys:[\"eventlog\"], flags:0}" \
+	  | test_must_fail ${RPC_STREAM} job-info.lookup-batch \
+		> lookup_batch3.out 2> lookup_batch3.err &&
+	grep "No data available" lookup_batch3.err &&
+	test $(wc -l < lookup_batch3.out) -eq 100
+'
+
+test_expect_success 'job-info.lookup-batch with no jobs returns ENODATA' '
+	$jq -j -c -n "{ids:[], keys:[\"jobspec\"], flags:0}" \
+	  | test_must_fail ${RPC_STREAM} job-info.lookup-batch \
+		> lookup_batch4.out 2> lookup_batch4.err &&
+	grep "No data available" lookup_batch4.err &&
+	test_must_be_empty lookup_batch4.out
+'
+
 #
 # stats & corner cases
 #
 
 test_expect_success 'job-info lookup stats works' '
-	flux module stats --parse lookups job-info
+	flux module stats --parse lookups job-info &&
+	flux module stats --parse lookup_batches job-info
 '
 
 test_expect_success 'lookup request with empty payload fails with EPROTO(71)' '
@@ -367,4 +450,14 @@ test_expect_success 'lookup request with invalid flags fails with EPROTO(71)' '
 	  | ${RPC} job-info.lookup 71
 '
 
+test_expect_success 'lookup-batch request with invalid ids fails with EPROTO(71)' '
+	$jq -j -c -n  "{ids:[\"foo\"], keys:[\"jobspec\"], flags:0}" \
+	  | ${RPC} job-info.lookup-batch 71
+'
+
+test_expect_success 'lookup-batch request non-streaming fails with EPROTO(71)' '
+	$jq -j -c -n  "{ids:[12345], keys:[\"jobspec\"], flags:0}" \
+	  | ${RPC} job-info.lookup-batch 71
+'
+
 test_done
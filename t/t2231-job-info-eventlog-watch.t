@@ -425,15 +425,64 @@ test_expect_success NO_CHAIN_LINT 'flux job wait-event -p invalid and --waitcrea
 	flux cancel ${jobidall}
 '
 
+test_expect_success NO_CHAIN_LINT 'identical eventlog watchers share one kvs watch' '
+	jobid=$(submit_job_live sleeplong.json) &&
+	before=$(flux module stats --parse watch_sources job-info) &&
+	fj_wait_event $jobid clean > shared1.out &
+	pid1=$! &&
+	fj_wait_event $jobid clean > shared2.out &
+	pid2=$! &&
+	fj_wait_event $jobid clean > shared3.out &
+	pid3=$! &&
+	i=0 &&
+	while [ "$(flux module stats --parse watchers job-info)" -lt 3 ] \
+		&& [ $i -lt 50 ]
+	do
+		sleep 0.1
+		i=$((i + 1))
+	done &&
+	test $i -lt 50 &&
+	test $(flux module stats --parse watch_sources job-info) -eq $((before + 1)) &&
+	flux cancel $jobid &&
+	wait $pid1 &&
+	wait $pid2 &&
+	wait $pid3 &&
+	grep clean shared1.out &&
+	grep clean shared2.out &&
+	grep clean shared3.out
+'
+
+test_expect_success NO_CHAIN_LINT 'late eventlog watcher receives earlier events' '
+	jobid=$(submit_job_live sleeplong.json) &&
+	fj_wait_event -v $jobid clean > late1.out &
+	pid1=$! &&
+	wait_watchers_nonzero "watchers" &&
+	fj_wait_event -v $jobid clean > late2.out &
+	pid2=$! &&
+	flux cancel $jobid &&
+	wait $pid1 &&
+	wait $pid2 &&
+	grep submit late2.out &&
+	test_cmp late1.out late2.out
+'
+
 #
 # stats & corner cases
 #
 
 test_expect_success 'job-info stats works' '
 	flux module stats --parse watchers job-info &&
+	flux module stats --parse watch_sources job-info &&
 	flux module stats --parse guest_watchers job-info
 '
 
+test_expect_success 'job-info stats reports owner cache statistics' '
+	flux module stats --parse owner_cache.size job-info &&
+	flux module stats --parse owner_cache.hits job-info &&
+	flux module stats --parse owner_cache.misses job-info &&
+	flux module stats --parse owner_cache.evictions job-info
+'
+
 test_expect_success 'eventlog-watch request with empty payload fails with EPROTO(71)' '
 	${RPC} job-info.eventlog-watch 71 </dev/null
 '
@@ -153,7 +153,7 @@ db_check_values_no_run() {
         return 0
 }
 
-test_expect_success 'job-archive: load module without specifying period, should fail' '
+test_expect_success 'job-archive: load module without config, should fail' '
         test_must_fail flux module load job-archive
 '
 
@@ -275,9 +275,22 @@ test_expect_success 'job-archive: all jobs stored' '
         test $count -eq 8
 '
 
+test_expect_success 'job-archive: stores jobs that finished while unloaded' '
+        flux module remove job-archive &&
+        jobid=`flux submit hostname` &&
+        fj_wait_event $jobid clean &&
+        flux module load job-archive &&
+        wait_db $jobid ${ARCHIVEDB} &&
+        db_check_entries $jobid ${ARCHIVEDB} &&
+        db_check_values_run $jobid ${ARCHIVEDB} &&
+        count=`db_count_entries ${ARCHIVEDB}` &&
+        test $count -eq 9
+'
+
 # we don't check values in module stats b/c it can be racy w/ polling
 test_expect_success 'job-archive: get module stats' '
-        flux module stats job-archive
+        flux module stats job-archive &&
+        flux module stats --parse pending job-archive
 '
 
 test_expect_success 'flux module stats job-archive is open to guests' '
@@ -291,7 +304,7 @@ test_expect_success 'job-archive: unload module' '
 
 test_expect_success 'job-archive: db exists after module unloaded' '
         count=`db_count_entries ${ARCHIVEDB}` &&
-        test $count -eq 8
+        test $count -eq 9
 '
 
 test_expect_success 'job-archive: setup config file without dbpath' '
@@ -316,8 +329,9 @@ EOF
 	flux config reload
 '
 
-test_expect_success 'job-archive: load module failure, period not set' '
-        test_must_fail flux module load job-archive
+test_expect_success 'job-archive: load module without period' '
+        flux module load job-archive &&
+        flux module remove job-archive
 '
 
 test_expect_success 'job-archive: setup config file with illegal period' '
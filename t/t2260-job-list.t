@@ -841,6 +841,125 @@ test_expect_success 'flux job list-inactive w/ since (middle timestamp #2)' '
 	test $count -eq 12
 '
 
+# job object cache
+
+test_expect_success 'repeated listing of inactive jobs hits the cache' '
+	flux jobs -f inactive --json > cache1.json &&
+	hits=$(flux module stats job-list | jq .cache.hits) &&
+	flux jobs -f inactive --json > cache2.json &&
+	hits2=$(flux module stats job-list | jq .cache.hits) &&
+	count=$(jq ".jobs | length" cache1.json) &&
+	test $hits2 -ge $((hits + count)) &&
+	jq -S .jobs[].id cache1.json > cache1.ids &&
+	jq -S .jobs[].id cache2.json > cache2.ids &&
+	test_cmp cache1.ids cache2.ids
+'
+
+test_expect_success 'job-list: cache_size = 0 disables the cache' '
+	flux config load <<-EOF &&
+	[job-list]
+	cache_size = 0
+	EOF
+	flux module stats job-list | jq -e ".cache.count == 0" &&
+	hits=$(flux module stats job-list | jq .cache.hits) &&
+	flux jobs -f inactive --json > cache3.json &&
+	flux module stats job-list | jq -e ".cache.hits == $hits" &&
+	jq -S .jobs[].id cache3.json > cache3.ids &&
+	test_cmp cache1.ids cache3.ids
+'
+
+test_expect_success 'job-list: invalid cache_size is rejected' '
+	test_must_fail flux config load <<-EOF
+	[job-list]
+	cache_size = -1
+	EOF
+'
+
+test_expect_success 'job-list: restore default cache_size' '
+	flux config load </dev/null &&
+	flux module stats job-list | jq -e ".cache.size == 10000"
+'
+
+test_expect_success 'job-list: inactive jobs share interned strings' '
+	flux module stats job-list | jq -e ".strings > 0" &&
+	flux jobs -f inactive -no "{queue}{name}" | sort -u > strings.out &&
+	test $(wc -l < strings.out) -gt 0
+'
+
+# checkpoint
+
+test_expect_success 'job-list: reload restores jobs from checkpoint' '
+	flux jobs -a -no "{id} {state} {name} {queue} {nodelist}" \
+		| sort > ckpt1.out &&
+	flux module stats job-list | jq -S .jobs > ckpt1.stats &&
+	flux module reload job-list &&
+	flux dmesg -H | grep "checkpoint: restored" &&
+	flux jobs -a -no "{id} {state} {name} {queue} {nodelist}" \
+		| sort > ckpt2.out &&
+	flux module stats job-list | jq -S .jobs > ckpt2.stats &&
+	test_cmp ckpt1.out ckpt2.out &&
+	test_cmp ckpt1.stats ckpt2.stats
+'
+
+test_expect_success 'job-list: jobs that finish while unloaded are listed' '
+	flux module remove job-list &&
+	jobid=$(flux submit --wait hostname | flux job id) &&
+	flux module load job-list &&
+	wait_jobid_state $jobid inactive &&
+	flux job list -s inactive | grep $jobid
+'
+
+test_expect_success 'job-list: checkpoint is ignored after job-manager reload' '
+	flux queue stop &&
+	flux module remove job-list &&
+	flux module reload job-manager &&
+	flux module load job-list &&
+	flux dmesg -H | grep "journal cannot be resumed" &&
+	flux jobs -a -no "{id}" | sort > ckpt3.out &&
+	cut -d" " -f1 ckpt1.out > ckpt1.ids &&
+	comm -23 ckpt1.ids ckpt3.out > ckpt.missing &&
+	test_must_be_empty ckpt.missing &&
+	flux module reload job-exec &&
+	flux module reload sched-simple &&
+	flux queue start
+'
+
+# cursor pagination
+
+test_expect_success 'flux jobs --cursor pages through all jobs' '
+	flux jobs -a --json | jq -r ".jobs[].id" > cursor-all.out &&
+	flux jobs -a --json -c 5 > cursor-page.json &&
+	jq -r ".jobs[].id" cursor-page.json > cursor-pages.out &&
+	pages=1 &&
+	while cursor=$(jq -r ".cursor // empty" cursor-page.json) \
+		&& test -n "$cursor"; do
+		flux jobs -a --json -c 5 --cursor="$cursor" > cursor-page.json &&
+		jq -r ".jobs[].id" cursor-page.json >> cursor-pages.out &&
+		pages=$((pages+1)) || return 1
+	done &&
+	test_cmp cursor-all.out cursor-pages.out &&
+	test $pages -gt 2
+'
+
+test_expect_success 'flux jobs --cursor works with a state filter' '
+	flux jobs -f inactive --json | jq -r ".jobs[].id" > cursor-inactive.out &&
+	flux jobs -f inactive --json -c 7 > cursor-page.json &&
+	cursor=$(jq -r .cursor cursor-page.json) &&
+	jq -r ".jobs[].id" cursor-page.json > cursor-inactive-pages.out &&
+	flux jobs -f inactive --json --cursor="$cursor" \
+		| jq -r ".jobs[].id" >> cursor-inactive-pages.out &&
+	test_cmp cursor-inactive.out cursor-inactive-pages.out
+'
+
+test_expect_success 'flux jobs --json has no cursor on the last page' '
+	flux jobs -a --json | jq -e ".cursor == null"
+'
+
+test_expect_success 'flux jobs --cursor fails on invalid cursor' '
+	test_must_fail flux jobs -a --cursor=foo 2> cursor-invalid.err &&
+	grep "invalid cursor" cursor-invalid.err
+'
+
 
 # job list-id
 
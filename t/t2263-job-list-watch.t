@@ -0,0 +1,84 @@
+#!/bin/sh
+
+test_description='Test job-list.watch change stream RPC'
+
+. $(dirname $0)/sharness.sh
+
+test_under_flux 1
+
+waitfile="${SHARNESS_TEST_SRCDIR}/scripts/waitfile.lua"
+listRPC="flux python ${SHARNESS_TEST_SRCDIR}/job-list/list-rpc.py"
+
+get_watchers() {
+	flux module stats job-list | jq -r .watchers
+}
+
+test_expect_success 'create streaming job-list.watch script' '
+	cat >watch.py <<-EOT &&
+	import sys
+	import json
+	import flux
+	handle = flux.Flux()
+	payload = json.loads(sys.argv[2])
+	fut = handle.rpc("job-list.watch",payload,flags=flux.constants.FLUX_RPC_STREAMING)
+	for i in range(int(sys.argv[1])):
+	    print(json.dumps(fut.get()))
+	    sys.stdout.flush()
+	    fut.reset()
+	EOT
+	chmod +x watch.py
+'
+test_expect_success 'job-list.watch fails without streaming flag' '
+	echo "{\"attrs\":[]}" | $listRPC watch >nostream.out &&
+	grep "errno $(errno EPROTO)" nostream.out
+'
+test_expect_success 'job-list.watch fails with invalid constraint' '
+	test_must_fail flux python watch.py 1 \
+	    "{\"attrs\":[], \"constraint\":{\"foo\":[]}}"
+'
+test_expect_success 'job-list.watch first response is a snapshot' '
+	flux submit --wait-event=clean true &&
+	run_timeout 30 flux python watch.py 1 \
+	    "{\"attrs\":[\"state\"]}" >snapshot.out &&
+	jq -e ".jobs | length == 1" <snapshot.out
+'
+test_expect_success 'disconnect handling works' '
+	test $(get_watchers) -eq 0
+'
+test_expect_success NO_CHAIN_LINT 'start watching running jobs' '
+	flux python watch.py 100 \
+	    "{\"attrs\":[\"state\"], \
+	      \"constraint\":{\"states\":[\"running\"]}}" >watch.log &
+	echo $! >watch.pid &&
+	$waitfile watch.log
+'
+test_expect_success NO_CHAIN_LINT 'snapshot of running jobs is empty' '
+	head -1 watch.log | jq -e ".jobs == []"
+'
+test_expect_success NO_CHAIN_LINT 'a running job is inserted' '
+	jobid=$(flux submit --wait-event=start sleep 300) &&
+	$waitfile --pattern=insert watch.log &&
+	grep insert watch.log | jq -e ".job.state == 8" &&
+	test $(grep insert watch.log | jq .job.id) = $(flux job id $jobid)
+'
+test_expect_success NO_CHAIN_LINT 'an inactive job is removed' '
+	flux cancel $jobid &&
+	flux job wait-event $jobid clean &&
+	$waitfile --pattern=remove watch.log &&
+	test $(grep remove watch.log | jq .job.id) = $(flux job id $jobid)
+'
+test_expect_success NO_CHAIN_LINT 'kill watch script' '
+	pid=$(cat watch.pid) &&
+	kill -15 $pid &&
+	wait $pid || true
+'
+test_expect_success NO_CHAIN_LINT 'watchers were cleaned up' '
+	count=0 &&
+	while test $(get_watchers) -ne 0 && test $count -lt 100; do
+		sleep 0.1
+		count=$((count+1))
+	done &&
+	test $(get_watchers) -eq 0
+'
+
+test_done
@@ -239,4 +239,34 @@ test_expect_success 'flux jobtap query dependency-after works' '
 	flux job urgency $jobid default &&
 	flux job wait-event -vt 15 $depid clean
 '
+test_expect_success 'partially released job with dependencies can be canceled' '
+	job1=$(flux submit --urgency=hold hostname) &&
+	job2=$(flux submit --urgency=hold hostname) &&
+	depid=$(flux submit \
+		--dependency=afterany:$job1 \
+		--dependency=afterany:$job2 \
+		hostname) &&
+	flux job urgency $job1 default &&
+	flux job wait-event -vt 15 $job1 clean &&
+	flux jobtap query .dependency-after > query-partial.json &&
+	test_debug "jq -S . query-partial.json" &&
+	jq -e ".dependencies | length == 1" query-partial.json &&
+	flux cancel $depid &&
+	flux job urgency $job2 default &&
+	flux job wait-event -vt 15 $job2 clean &&
+	flux jobtap query .dependency-after > query-none2.json &&
+	jq -e ".dependencies | length == 0" query-none2.json
+'
+test_expect_success 'many jobs may depend on one job' '
+	jobid=$(flux submit --urgency=hold hostname) &&
+	flux bulksubmit --dependency=afterok:$jobid \
+		echo {} ::: $(seq 1 32) > fanout.ids &&
+	flux cancel $(head -4 fanout.ids) &&
+	flux jobtap query .dependency-after > query-fanout.json &&
+	jq -e ".dependencies | length == 28" query-fanout.json &&
+	flux job urgency $jobid default &&
+	for id in $(tail -28 fanout.ids); do
+		flux job wait-event -vt 15 $id clean || return 1
+	done
+'
 test_done
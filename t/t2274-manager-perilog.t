@@ -335,6 +335,66 @@ test_expect_success 'perilog: bad log-ignore regexp is caught' '
 	flux dmesg -Hc | grep "[fF]ailed to compile"
 '
 
+test_expect_success 'perilog: per-rank prolog/epilog run on all job ranks' '
+	cat <<-EOF >config/perilog.toml &&
+	[job-manager.prolog]
+	command = [ "flux", "getattr", "rank" ]
+	per-rank = true
+	[job-manager.epilog]
+	command = [ "flux", "getattr", "rank" ]
+	per-rank = true
+	EOF
+	flux config reload &&
+	flux jobtap load --remove=*.so perilog.so &&
+	flux dmesg -c >/dev/null &&
+	jobid=$(flux submit --wait-event=clean -N4 -n4 true) &&
+	flux job eventlog $jobid >per-rank.eventlog &&
+	test_debug "cat per-rank.eventlog" &&
+	grep "prolog-finish.*status=0" per-rank.eventlog &&
+	grep "epilog-finish.*status=0" per-rank.eventlog &&
+	test $(grep -c "perilog-timing.*ranks=\"0-3\"" per-rank.eventlog) -eq 2 &&
+	flux dmesg -H >per-rank.dmesg &&
+	for rank in 0 1 2 3; do
+		grep "prolog: rank $rank: stdout: $rank" per-rank.dmesg &&
+		grep "epilog: rank $rank: stdout: $rank" per-rank.dmesg || return 1
+	done
+'
+test_expect_success 'perilog: per-rank prolog failure drains failed ranks' '
+	cat <<-EOF >config/perilog.toml &&
+	[job-manager.prolog]
+	command = [
+	  "sh", "-c", "test \$(flux getattr rank) -ne 2 || exit 3"
+	]
+	per-rank = true
+	EOF
+	flux config reload &&
+	flux jobtap load --remove=*.so perilog.so &&
+	jobid=$(flux submit -N4 -n4 true) &&
+	flux job wait-event -vt 15 -m status=768 $jobid prolog-finish &&
+	flux job wait-event -vt 15 $jobid clean &&
+	flux job eventlog $jobid | grep "perilog-timing.*failed=\"2\"" &&
+	test_must_fail flux job attach -vEX $jobid 2>per-rank-fail.err &&
+	grep "exit code=3 on rank 2" per-rank-fail.err &&
+	test "$(drained_ranks)" = "2" &&
+	undrain_all
+'
+test_expect_success 'perilog: per-rank prolog can be canceled' '
+	cat <<-EOF >config/perilog.toml &&
+	[job-manager.prolog]
+	command = [ "sleep", "30" ]
+	per-rank = true
+	EOF
+	flux config reload &&
+	flux jobtap load --remove=*.so perilog.so &&
+	jobid=$(flux submit -N2 -n2 true) &&
+	flux job wait-event -t 15 $jobid prolog-start &&
+	flux cancel $jobid &&
+	flux job wait-event -vt 15 $jobid prolog-finish &&
+	flux job wait-event -vt 15 $jobid clean &&
+	flux resource drain &&
+	test "$(drained_ranks)" = ""
+'
+
 #  Note: run this job before taking rank 3 offline below
 test_expect_success 'perilog: run job across all 4 ranks' '
 	jobid=$(flux submit --wait-event=clean -N4 -n4 true)
@@ -250,6 +250,50 @@ test_expect_success 'sched-simple: submit job and cancel it' '
 	flux cancel $(cat job19.id) &&
 	$dmesg_grep -t 10 "free: rank0/core0"
 '
+test_expect_success 'sched-simple: reload sched-simple with batched alloc/free' '
+	flux dmesg --clear &&
+	flux module reload sched-simple batch &&
+	$dmesg_grep -t 10 "scheduler: ready unlimited batch"
+'
+test_expect_success 'sched-simple: batched mode allocates and frees jobs' '
+	flux submit --cc=1-4 -n1 hostname >batch.ids &&
+	for id in $(cat batch.ids); do
+		flux job wait-event --timeout=5.0 $id alloc || return 1
+	done &&
+	flux cancel $(cat batch.ids) &&
+	for id in $(cat batch.ids); do
+		flux job wait-event --timeout=5.0 $id free || return 1
+	done &&
+	test "$($query)" = "rank[0-1]/core[0-1]"
+'
+test_expect_success 'sched-simple: batched mode works with an alloc limit' '
+	flux dmesg --clear &&
+	flux module reload sched-simple batch mode=limited=2 &&
+	$dmesg_grep -t 10 "scheduler: ready limited batch" &&
+	flux submit --cc=1-6 -n1 hostname >batch2.ids &&
+	for id in $(head -4 batch2.ids); do
+		flux job wait-event --timeout=5.0 $id alloc || return 1
+	done &&
+	flux cancel $(head -4 batch2.ids) &&
+	for id in $(tail -2 batch2.ids); do
+		flux job wait-event --timeout=5.0 $id alloc || return 1
+	done &&
+	flux cancel $(tail -2 batch2.ids)
+'
+test_expect_success 'sched-simple: R is correct when reused for same resources' '
+	run_timeout 30 flux queue drain &&
+	flux job submit basic.json >reuse1.id &&
+	flux job wait-event --timeout=5.0 $(cat reuse1.id) alloc &&
+	flux cancel $(cat reuse1.id) &&
+	flux job wait-event --timeout=5.0 $(cat reuse1.id) free &&
+	flux job submit basic.json >reuse2.id &&
+	flux job wait-event --timeout=5.0 $(cat reuse2.id) alloc &&
+	flux job info $(cat reuse1.id) R | jq -c .execution.R_lite >reuse1.out &&
+	flux job info $(cat reuse2.id) R | jq -c .execution.R_lite >reuse2.out &&
+	test_cmp reuse1.out reuse2.out &&
+	flux job info $(cat reuse2.id) R | jq -e ".execution.starttime > 0" &&
+	flux cancel $(cat reuse2.id)
+'
 test_expect_success 'sched-simple: remove sched-simple and cancel jobs' '
 	flux module remove sched-simple &&
 	flux cancel --all
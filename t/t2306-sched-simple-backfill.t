@@ -0,0 +1,59 @@
+#!/bin/sh
+
+test_description='sched-simple backfill mode tests'
+
+. `dirname $0`/job-manager/sched-helper.sh
+
+. $(dirname $0)/sharness.sh
+
+export TEST_UNDER_FLUX_NO_JOB_EXEC=y
+test_under_flux 1 job
+
+flux setattr log-stderr-level 1
+
+wait_annotation_exists() {
+	for try in $(seq 1 10); do
+		jmgr_check_annotation_exists $1 $2 && return 0
+		sleep 0.5
+	done
+	return 1
+}
+
+test_expect_success 'sched-simple: invalid queue-depth fails' '
+	flux module unload sched-simple &&
+	test_must_fail flux module load sched-simple queue-depth=0 &&
+	test_must_fail flux module load sched-simple queue-depth=foo
+'
+test_expect_success 'sched-simple: load with 4 cores in backfill mode' '
+	flux R encode -r0 -c0-3 >R.test &&
+	flux resource reload R.test &&
+	flux module load sched-simple mode=backfill &&
+	test "$(flux resource list --state=free -no {rlist})" = "rank0/core[0-3]"
+'
+test_expect_success 'sched-simple: job using half the cores starts' '
+	flux submit -n2 -t 100s hostname >jobA.id &&
+	flux job wait-event -t 10 $(cat jobA.id) alloc
+'
+test_expect_success 'sched-simple: blocked job gets a reservation' '
+	flux submit -n4 -t 10s hostname >jobB.id &&
+	wait_annotation_exists $(cat jobB.id) sched.t_estimate
+'
+test_expect_success 'sched-simple: job that would delay it does not start' '
+	flux submit -n1 -t 200s hostname >jobC.id &&
+	wait_annotation_exists $(cat jobC.id) sched.t_estimate &&
+	test "$(flux jobs -no {state} $(cat jobC.id))" = "SCHED"
+'
+test_expect_success 'sched-simple: short job is backfilled' '
+	flux submit -n1 -t 50s hostname >jobD.id &&
+	flux job wait-event -t 10 $(cat jobD.id) alloc &&
+	test "$(flux jobs -no {state} $(cat jobB.id))" = "SCHED"
+'
+test_expect_success 'sched-simple: reserved job starts when resources free up' '
+	flux cancel $(cat jobA.id) $(cat jobD.id) &&
+	flux job wait-event -t 10 $(cat jobB.id) alloc
+'
+test_expect_success 'sched-simple: cancel remaining jobs' '
+	flux cancel --all &&
+	flux queue drain
+'
+test_done
@@ -28,6 +28,9 @@ load_resource () {
 get_topo() {
 	flux python -c "import flux; print(flux.Flux().rpc(\"resource.topo-get\",nodeid=$1).get_str())"
 }
+get_cpuset() {
+	flux python -c "import flux; print(flux.Flux().rpc(\"resource.topo-cpuset\",$1).get_str())"
+}
 res_reload() {
 	flux python -c "import flux; print(flux.Flux().rpc(\"resource.reload\",nodeid=$1).get())"
 }
@@ -58,6 +61,29 @@ test_expect_success 'send bad topo-reduce request to rank 0' '
 	bad_reduce 0
 '
 
+test_expect_success 'topo-cpuset returns cpuset for core 0' '
+	get_cpuset "{\"cores\":\"0\"}" >cpuset0.out &&
+	jq -e ".cpuset" cpuset0.out &&
+	jq -e ".pertask == null" cpuset0.out
+'
+test_expect_success 'topo-cpuset returns same result when cached' '
+	get_cpuset "{\"cores\":\"0\"}" >cpuset0.out2 &&
+	test_cmp cpuset0.out cpuset0.out2
+'
+test_expect_success 'topo-cpuset distributes tasks when ntasks is set' '
+	get_cpuset "{\"cores\":\"0\",\"ntasks\":1}" >cpuset1.out &&
+	jq -e ".pertask | length == 1" cpuset1.out
+'
+test_expect_success 'topo-cpuset fails on nonexistent core' '
+	test_must_fail get_cpuset "{\"cores\":\"100000\"}"
+'
+test_expect_success 'topo-cpuset fails on invalid core list' '
+	test_must_fail get_cpuset "{\"cores\":\"foo\"}"
+'
+test_expect_success 'topo-cpuset fails on negative ntasks' '
+	test_must_fail get_cpuset "{\"cores\":\"0\",\"ntasks\":-1}"
+'
+
 test_expect_success 'resource.eventlog exists' '
 	flux kvs eventlog get -u resource.eventlog >eventlog.out
 '
@@ -457,6 +457,67 @@ test_expect_success '' '
 	flux module load resource noverify
 '
 
+test_expect_success 'configure resource.eventlog-snapshot = 2' '
+	flux config load <<-EOT &&
+	resource.eventlog-snapshot = 2
+	EOT
+	flux module remove -f resource &&
+	flux module load resource noverify
+'
+test_expect_success 'drain and undrain some nodes' '
+	flux resource drain 1 snaptest1 &&
+	flux resource drain 2 snaptest2 &&
+	flux resource undrain 2
+'
+test_expect_success 'snapshot events were posted to resource.eventlog' '
+	has_resource_event snapshot
+'
+test_expect_success 'reloading resource module truncates eventlog' '
+	flux kvs eventlog get resource.eventlog >presnap.out &&
+	flux module remove -f resource &&
+	flux module load resource noverify &&
+	flux kvs eventlog get resource.eventlog >postsnap.out &&
+	test $(wc -l <postsnap.out) -lt $(wc -l <presnap.out) &&
+	head -1 postsnap.out | awk "{ print \$2 }" >first.out &&
+	test "$(cat first.out)" = "snapshot"
+'
+test_expect_success 'drain state was recovered from snapshot' '
+	flux resource drain --no-header -o "{ranks} {reason}" >snapdrain.out &&
+	test_debug "cat snapdrain.out" &&
+	grep "^1 snaptest1" snapdrain.out &&
+	test_must_fail grep snaptest2 snapdrain.out
+'
+test_expect_success 'negative eventlog-snapshot is rejected' '
+	test_must_fail flux config load <<-EOT
+	resource.eventlog-snapshot = -1
+	EOT
+'
+test_expect_success 'restore config and undrain' '
+	flux config load </dev/null &&
+	flux resource undrain 1
+'
+test_expect_success 'draining several targets posts a single event' '
+	flux kvs eventlog get resource.eventlog >batch.pre &&
+	flux resource drain 1-3 batchtest &&
+	flux kvs eventlog get resource.eventlog >batch.post &&
+	grep -c "drain" batch.pre >batch.pre.count &&
+	grep -c "drain" batch.post >batch.post.count &&
+	test $(cat batch.post.count) -eq $(($(cat batch.pre.count)+1))
+'
+test_expect_success 'repeated status queries are consistent' '
+	flux resource status -s drain -no {ranks} >status1.out &&
+	flux resource status -s drain -no {ranks} >status2.out &&
+	test_cmp status1.out status2.out &&
+	test "$(cat status1.out)" = "1-3" &&
+	test $(flux resource list -n -s down -o {nnodes}) -eq 3 &&
+	test $(flux resource list -n -s down -o {nnodes}) -eq 3
+'
+test_expect_success 'status queries reflect undrain immediately' '
+	flux resource undrain 1-3 &&
+	test -z "$(flux resource status -s drain -no {ranks})" &&
+	test $(flux resource list -n -s down -o {nnodes}) -eq 0
+'
+
 test_expect_success 'load scheduler' '
 	flux module load sched-simple
 '
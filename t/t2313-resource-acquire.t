@@ -80,6 +80,56 @@ test_expect_success NO_CHAIN_LINT 'undrain/drain rank 1 causes up,down responses
 	wait $pid
 '
 
+test_expect_success 'acquire responses carry sequence numbers' '
+	head -1 acquire4.out | jq -e .epoch &&
+	tail -1 acquire4.out | jq -e .seq
+'
+
+test_expect_success 'record epoch and sequence number of last change' '
+	$RPC resource.acquire </dev/null >acquire5.out &&
+	jq -c "{epoch:.epoch,seq:.seq}" acquire5.out >resume.json &&
+	cat resume.json
+'
+
+test_expect_success 'resume with no intervening changes returns no resources' '
+	jq -c "{resume:.}" resume.json \
+		| $RPC resource.acquire >acquire6.out &&
+	test_must_fail jq -e .resources acquire6.out &&
+	test_must_fail jq -e .up acquire6.out &&
+	test_must_fail jq -e .down acquire6.out
+'
+
+test_expect_success 'undrain rank 1 with no acquire client' '
+	flux resource undrain 1
+'
+
+test_expect_success 'resume returns the missed change' '
+	jq -c "{resume:.}" resume.json \
+		| $RPC resource.acquire >acquire7.out &&
+	test_must_fail jq -e .resources acquire7.out &&
+	jq -e -r .up acquire7.out >acquire7_up.out &&
+	echo 1 >acquire7_up.exp &&
+	test_cmp acquire7_up.exp acquire7_up.out &&
+	test $(jq .seq acquire7.out) -gt $(jq .seq resume.json)
+'
+
+test_expect_success 'resume from an unknown epoch returns resources' '
+	jq -c "{resume:(.epoch = 42)}" resume.json \
+		| $RPC resource.acquire >acquire8.out &&
+	jq -e .resources acquire8.out
+'
+
+test_expect_success 'resume from a future sequence number returns resources' '
+	jq -c "{resume:(.seq += 100)}" resume.json \
+		| $RPC resource.acquire >acquire9.out &&
+	jq -e .resources acquire9.out
+'
+
+test_expect_success 'malformed resume request fails with EPROTO' '
+	echo "{\"resume\":{\"seq\":1}}" \
+		| $RPC resource.acquire 71
+'
+
 test_expect_success 'load scheduler' '
 	flux module load sched-simple
 '
@@ -150,6 +150,32 @@ test_expect_success 'sdexec can set unit name' '
 	    $systemctl --user list-units --type=service >name.out &&
 	grep t2409-funfunfun name.out
 '
+test_expect_success 'sdexec runs many concurrent units' '
+	for i in $(seq 1 32); do \
+	    $sdexec -r 0 $sh -c "echo \$((\$0*2))" $i >conc.$i.out & \
+	done &&
+	wait &&
+	for i in $(seq 1 32); do \
+	    echo $(($i*2)) >conc.$i.exp && \
+	    test_cmp conc.$i.exp conc.$i.out || return 1; \
+	done
+'
+test_expect_success NO_CHAIN_LINT 'sdexec fails on duplicate running unit name' '
+	$sdexec -r 0 --setopt=SDEXEC_NAME=t2409-dup.service \
+	    $sh -c "sleep 30" &
+	pid=$! &&
+	i=0 &&
+	while ! $systemctl --user is-active t2409-dup.service >/dev/null \
+	    && test $i -lt 300; do \
+	    sleep 0.1; \
+	    i=$((i+1)); \
+	done &&
+	test_must_fail $sdexec -r 0 --setopt=SDEXEC_NAME=t2409-dup.service \
+	    $true 2>dup.err &&
+	grep "already running" dup.err &&
+	kill $pid;
+	wait $pid || true
+'
 test_expect_success 'sdexec can set unit Description property' '
 	cat >desc.exp <<-EOT &&
 	Description=fubar
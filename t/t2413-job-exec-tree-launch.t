@@ -0,0 +1,56 @@
+#!/bin/sh
+
+test_description='Test job-exec hierarchical launch over the TBON'
+
+. $(dirname $0)/sharness.sh
+
+test_under_flux 4 job -o,-Stbon.topo=kary:2
+
+test_expect_success 'job-exec: load job-exec on all ranks with tree-launch' '
+	flux module reload job-exec tree-launch &&
+	flux exec -r 1-3 flux module load job-exec
+'
+test_expect_success 'job-exec: tree-launch is reported in stats' '
+	flux module stats -p bulk-exec.config.tree_launch job-exec >stats.out &&
+	test "$(cat stats.out)" = "1"
+'
+test_expect_success 'job-exec: job runs on all ranks' '
+	flux run -N4 flux getattr rank | sort >ranks.out &&
+	test_debug "cat ranks.out" &&
+	test $(cat ranks.out | wc -l) -eq 4
+'
+test_expect_success 'job-exec: exit code is propagated' '
+	test_expect_code 3 flux run -N4 sh -c "exit 3"
+'
+test_expect_success 'job-exec: job can be canceled' '
+	id=$(flux submit -N4 sleep inf) &&
+	flux job wait-event -vt 30 $id start &&
+	flux cancel $id &&
+	test_must_fail flux job status $id
+'
+test_expect_success 'job-exec: job shell stderr is forwarded from all ranks' '
+	cat >stderr-shell.sh <<-EOT &&
+	#!/bin/sh
+	echo "stderr from \$(flux getattr rank)" >&2
+	EOT
+	chmod +x stderr-shell.sh &&
+	id=$(flux submit -N4 \
+	    --setattr=system.exec.job_shell=$(pwd)/stderr-shell.sh true) &&
+	flux job wait-event -vt 30 $id clean &&
+	flux job eventlog -p exec $id >eventlog.out &&
+	test $(grep -c "stderr from" eventlog.out) -eq 4
+'
+test_expect_success 'job-exec: job on ranks 1-3 survives job-exec reload' '
+	id=$(flux submit -N3 --requires=rank:1-3 sleep 5) &&
+	flux job wait-event -vt 30 -p guest.exec.eventlog $id shell.start &&
+	flux module reload job-exec tree-launch &&
+	flux job wait-event -vt 60 $id clean &&
+	flux job status $id &&
+	flux job eventlog -p exec $id >reattach.out &&
+	grep re-starting reattach.out
+'
+test_expect_success 'job-exec: unload job-exec on ranks 1-3' '
+	flux exec -r 1-3 flux module remove job-exec &&
+	flux module reload job-exec
+'
+test_done
@@ -100,6 +100,46 @@ test_expect_success 'attach: shows output from job' '
 	run_timeout 5 flux job attach $(cat jobid1) | grep foo
 '
 
+test_expect_success 'attach: submit a job with many lines of output' '
+	flux submit seq 1 100 >jobid-seq &&
+	flux job wait-event $(cat jobid-seq) clean
+'
+# Output entries are usually one line each, but the shell may combine
+# lines, and the final entries are EOFs, so check that the output is a
+# non-empty suffix of the full output with no more than N lines.
+test_expect_success 'attach: --tail=N shows only the end of the output' '
+	flux job attach --tail=5 $(cat jobid-seq) >tail.out &&
+	n=$(wc -l <tail.out) &&
+	test $n -ge 1 && test $n -le 5 &&
+	seq 1 100 | tail -n $n >tail.exp &&
+	test_cmp tail.exp tail.out
+'
+test_expect_success 'attach: --tail=N with N larger than output shows all' '
+	flux job attach --tail=1000 $(cat jobid-seq) >tail-all.out &&
+	seq 1 100 >tail-all.exp &&
+	test_cmp tail-all.exp tail-all.out
+'
+test_expect_success 'attach: --skip=N skips the first N entries' '
+	flux job attach --skip=1 $(cat jobid-seq) >skip.out &&
+	seq 1 100 >skip.exp &&
+	test_cmp skip.exp skip.out &&
+	flux job attach --skip=50 $(cat jobid-seq) >skip2.out &&
+	n=$(wc -l <skip2.out) &&
+	test $n -lt 100 &&
+	seq 1 100 | tail -n $n >skip2.exp &&
+	test_cmp skip2.exp skip2.out
+'
+test_expect_success 'attach: --since=0 shows no completed output' '
+	flux job attach --since=0 $(cat jobid-seq) >since0.out &&
+	test_must_be_empty since0.out
+'
+test_expect_success 'attach: --since=1h shows all output' '
+	flux job attach --since=1h $(cat jobid-seq) >since.out &&
+	test_cmp tail-all.exp since.out
+'
+test_expect_success 'attach: --tail with negative value fails' '
+	test_must_fail flux job attach --tail=-1 $(cat jobid-seq)
+'
 test_expect_success 'attach: submit a job and cancel it' '
 	flux submit sleep 30 >jobid2 &&
 	flux cancel $(cat jobid2)
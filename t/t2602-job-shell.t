@@ -385,6 +385,24 @@ test_expect_success 'job-shell: -o nosetpgrp works' '
 	flux run -n2 -o nosetpgrp \
 	    flux python -c "import os,sys; sys.exit(os.getpid() == os.getpgrp())"
 '
+test_expect_success 'job-shell: -o vfork runs tasks' '
+	flux run -n4 -o vfork --label-io \
+	    sh -c "echo \$FLUX_TASK_RANK" | sort >vfork.out &&
+	test_debug "cat vfork.out" &&
+	test $(wc -l <vfork.out) -eq 4 &&
+	grep "^3: 3" vfork.out
+'
+test_expect_success 'job-shell: -o vfork runs tasks in process group' '
+	flux run -n2 -o vfork \
+	    flux python -c "import os,sys; sys.exit(os.getpid() != os.getpgrp())"
+'
+test_expect_success 'job-shell: -o vfork reports exec failure' '
+	test_expect_code 127 flux run -o vfork nosuchcommand 2>vfork.err &&
+	grep "nosuchcommand" vfork.err
+'
+test_expect_success 'job-shell: -o vfork works with cpu-affinity=per-task' '
+	flux run -n2 -o vfork -o cpu-affinity=per-task true
+'
 
 # Check that job shell inherits FLUX_F58_FORCE_ASCII.
 # If not, then output filename will not match jobid returned by submit,
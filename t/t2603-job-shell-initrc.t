@@ -301,4 +301,29 @@ test_expect_success MULTICORE 'flux-shell: initrc: shell.rankinfo reports broker
 	    -o verbose -o initrc=${name}.lua true
 '
 flux job info $(flux job last) R
+test_expect_success 'flux-shell: initrc: compiled initrc is cached' '
+	cat >cached.lua <<-EOF &&
+	shell.log ("cached initrc v1")
+	EOF
+	flux run -o verbose=2 -o initrc=$(pwd)/cached.lua \
+		--requires=rank:0 true >cached1.out 2>&1 &&
+	test_debug "cat cached1.out" &&
+	grep "cached initrc v1" cached1.out &&
+	ls $(flux getattr rundir)/shell-cache/luac* &&
+	flux run -o verbose=2 -o initrc=$(pwd)/cached.lua \
+		--requires=rank:0 true >cached2.out 2>&1 &&
+	test_debug "cat cached2.out" &&
+	grep "loaded .*cached.lua from cache" cached2.out &&
+	grep "cached initrc v1" cached2.out
+'
+test_expect_success 'flux-shell: initrc: modified initrc is not read from cache' '
+	cat >cached.lua <<-EOF &&
+	shell.log ("cached initrc version 2")
+	EOF
+	flux run -o verbose=2 -o initrc=$(pwd)/cached.lua \
+		--requires=rank:0 true >cached3.out 2>&1 &&
+	test_debug "cat cached3.out" &&
+	test_must_fail grep "loaded .*cached.lua from cache" cached3.out &&
+	grep "cached initrc version 2" cached3.out
+'
 test_done
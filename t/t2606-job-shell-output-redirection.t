@@ -9,6 +9,7 @@ test_under_flux 4 job
 flux setattr log-stderr-level 1
 
 TEST_SUBPROCESS_DIR=${FLUX_BUILD_DIR}/src/common/libsubprocess
+waitfile=${SHARNESS_TEST_SRCDIR}/scripts/waitfile.lua
 
 #
 # 1 task output file tests
@@ -389,4 +390,61 @@ test_expect_success 'job-shell: invalid output.mode emits warning' '
 	test_debug "cat inval.out" &&
 	grep "ignoring invalid output.mode=foo" inval.err
 '
+test_expect_success 'job-shell: output from follower shells is batched' '
+	flux run -N2 -n4 --label-io -o output.forward-timeout=0.5 \
+		echo batched >batched.out &&
+	test_debug "cat batched.out" &&
+	test $(grep -c batched batched.out) -eq 4
+'
+test_expect_success 'job-shell: output.merge merges identical lines' '
+	flux run -N2 -n4 --label-io -o output.merge \
+		-o output.forward-timeout=2 echo merged >merged.out &&
+	test_debug "cat merged.out" &&
+	grep "^\[2-3\]: merged" merged.out
+'
+test_expect_success 'job-shell: invalid output.forward-timeout is rejected' '
+	test_must_fail flux run -N2 -o output.forward-timeout=-1 hostname
+'
+test_expect_success 'job-shell: buffered file output is complete' '
+	flux run -N2 -n4 --label-io --output=buffered.out \
+		-o output.write-buffer=64 \
+		seq 1000 &&
+	test $(wc -l <buffered.out) -eq 4000 &&
+	test $(grep -c "^2: " buffered.out) -eq 1000
+'
+test_expect_success 'job-shell: unbuffered file output is complete' '
+	flux run -N2 -n4 --label-io --output=unbuffered.out \
+		-o output.write-buffer=0 \
+		seq 100 &&
+	test $(wc -l <unbuffered.out) -eq 400
+'
+test_expect_success 'job-shell: buffered file output is flushed while running' '
+	id=$(flux submit --output=flush.out \
+		-o output.flush-interval=0.01 \
+		sh -c "echo flushed; sleep 60") &&
+	$waitfile --count=1 --timeout=30 --pattern=flushed flush.out &&
+	flux cancel $id
+'
+test_expect_success 'job-shell: invalid output.write-buffer is rejected' '
+	test_must_fail flux run --output=bad.out \
+		-o output.write-buffer=foo hostname
+'
+test_expect_success 'job-shell: {{taskid}} writes one output file per task' '
+	flux run -N2 -n4 --output="task.{{taskid}}.out" \
+		sh -c "echo out:\$FLUX_TASK_RANK; echo err:\$FLUX_TASK_RANK >&2" &&
+	for i in 0 1 2 3; do
+		grep "^out:$i$" task.$i.out &&
+		grep "^err:$i$" task.$i.out &&
+		test $(wc -l <task.$i.out) -eq 2 || return 1
+	done
+'
+test_expect_success 'job-shell: {{taskid}} works with --label-io and --error' '
+	flux run -N2 -n2 --label-io --output="lout.{{taskid}}" \
+		--error="lerr.{{taskid}}" \
+		sh -c "echo out; echo err >&2" &&
+	grep "^0: out" lout.0 &&
+	grep "^1: out" lout.1 &&
+	grep "^0: err" lerr.0 &&
+	grep "^1: err" lerr.1
+'
 test_done
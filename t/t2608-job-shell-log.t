@@ -220,4 +220,51 @@ test_expect_success 'flux-shell: stdout/err from task.exec works' '
 	grep "^this is stderr" print.err &&
 	grep "^this is stdout" print.out
 '
+test_expect_success 'flux-shell: create initrc that logs 50 messages' '
+	cat <<-EOF >log-storm.lua
+	plugin.register {
+	  name = "log-storm",
+	    handlers = {
+	    {
+	      topic = "shell.post-init",
+	      fn = function ()
+	        for i = 1, 50 do
+	          shell.log ("storm " .. i)
+	        end
+	      end
+	    }
+	  }
+	}
+	EOF
+'
+test_expect_success 'flux-shell: messages under the rate limit are all logged' '
+	flux run -o initrc=log-storm.lua -N2 -n2 true 2>storm-default.err &&
+	test $(grep -c "log-storm: storm" storm-default.err) -eq 100 &&
+	test_must_fail grep "messages suppressed" storm-default.err
+'
+test_expect_success 'flux-shell: log.rate and log.burst limit messages' '
+	flux run -o initrc=log-storm.lua -o log.rate=0.1 -o log.burst=10 \
+		-N2 -n2 true 2>storm-limit.err &&
+	test_debug "cat storm-limit.err" &&
+	test $(grep "flux-shell\[0\]" storm-limit.err \
+		| grep -c "log-storm: storm") -le 10 &&
+	grep "flux-shell\[0\]:  WARN: evlog: rate limit: [0-9]* messages suppressed" \
+		storm-limit.err &&
+	grep "flux-shell\[1\]:  WARN: evlog: rate limit: [0-9]* messages suppressed" \
+		storm-limit.err
+'
+test_expect_success 'flux-shell: log.rate=0 disables rate limiting' '
+	flux run -o initrc=log-storm.lua -o log.rate=0 -o log.burst=1 \
+		true 2>storm-unlimited.err &&
+	test $(grep -c "log-storm: storm" storm-unlimited.err) -eq 50
+'
+test_expect_success 'flux-shell: log.aggregate forwards messages to leader' '
+	flux run -o initrc=log-storm.lua -o log.aggregate \
+		-N2 -n2 true 2>storm-aggregate.err &&
+	grep "flux-shell\[1\]: log-storm: storm 50" storm-aggregate.err &&
+	test $(grep -c "log-storm: storm" storm-aggregate.err) -eq 100
+'
+test_expect_success 'flux-shell: invalid log.rate is an error' '
+	test_must_fail flux run -o log.rate=-1 true
+'
 test_done
@@ -39,4 +39,41 @@ test_expect_success 'flux-shell: plugin can add event context' '
 		-m event-test=foo ${id} shell.init
 
 '
+test_expect_success 'flux-shell: no shell.timing event by default' '
+	id=$(flux submit -n2 -N2 /bin/true) &&
+	flux job wait-event -vt 5 ${id} clean &&
+	test_must_fail flux job wait-event -vt 5 -p exec ${id} shell.timing
+'
+test_expect_success 'flux-shell: -o timing emits shell.timing event' '
+	id=$(flux submit -o timing -n4 -N2 /bin/true) &&
+	flux job wait-event -vt 5 -p exec ${id} shell.timing &&
+	flux job eventlog -p exec --format=json ${id} \
+		| jq -e "select(.name == \"shell.timing\")
+			| .context.ranks | length == 2" &&
+	flux job eventlog -p exec --format=json ${id} \
+		| jq -e "select(.name == \"shell.timing\")
+			| .context.ranks[].phases[] | select(.[0] == \"barrier.init\")"
+'
+test_expect_success 'flux job timing displays phases' '
+	flux job timing ${id} >timing.out &&
+	test_debug "cat timing.out" &&
+	grep "^PHASE" timing.out &&
+	grep "^barrier.start" timing.out &&
+	grep "^total" timing.out
+'
+test_expect_success 'flux job timing --plugins lists plugin callbacks' '
+	flux job timing --plugins ${id} >timing-plugins.out &&
+	test_debug "cat timing-plugins.out" &&
+	grep "^CALLBACK" timing-plugins.out &&
+	grep "^shell.init" timing-plugins.out
+'
+test_expect_success 'flux job timing fails on job run without -o timing' '
+	id=$(flux submit /bin/true) &&
+	flux job wait-event -vt 5 ${id} clean &&
+	test_must_fail flux job timing ${id} 2>timing.err &&
+	grep "no shell.timing event" timing.err
+'
+test_expect_success 'flux-shell: non-integer timing option is an error' '
+	test_must_fail flux run -o timing=foo /bin/true
+'
 test_done
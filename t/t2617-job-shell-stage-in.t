@@ -147,4 +147,21 @@ test_expect_success 'Verify that example 2 of flux-archive(1) works' '
 	flux archive remove --name=app
 '
 
+test_expect_success 'create a file spanning many blobs' '
+	mkdir -p big &&
+	dd if=/dev/urandom of=big/data bs=4096 count=200
+'
+test_expect_success 'stage-in of a many-blob file works on all nodes' '
+	flux archive create --name=big --chunksize=4096 -C big data &&
+	flux run -N4 -o stage-in.names=big \
+	    cmp {{tmpdir}}/data $(pwd)/big/data &&
+	flux archive remove --name=big
+'
+test_expect_success 'stage-in of a many-blob mmapped file works on all nodes' '
+	flux archive create --name=big --mmap --chunksize=4096 -C big data &&
+	flux run -N4 -o stage-in.names=big \
+	    cmp {{tmpdir}}/data $(pwd)/big/data &&
+	flux archive remove --name=big
+'
+
 test_done
@@ -256,6 +256,24 @@ test_expect_success NO_CHAIN_LINT 'flux-top works with FLUX_F58_FORCE_ASCII' '
        FLUX_F58_FORCE_ASCII=1 $runpty -f asciicast -o normalf.log \
 			      flux top --test-exit
 '
+# flux-top follows the job manager journal, so a job that starts after
+# flux-top is running should appear without polling job-list.
+test_expect_success NO_CHAIN_LINT 'flux-top shows a job started after startup' '
+	SHELL=/bin/sh &&
+	cat <<-EOF >live.in &&
+	{ "version": 2 }
+	[5.00, "i", "q"]
+	EOF
+	FLUX_F58_FORCE_ASCII=1 $runpty -f asciicast -o live.log \
+		--input=live.in flux top &
+	pid=$! &&
+	sleep 1 &&
+	id=$(flux submit --wait-event=start -n1 sleep 300) &&
+	wait $pid &&
+	flux cancel $id &&
+	flux job wait-event $id clean &&
+	grep -q $(flux job id --to=f58 $id | sed "s/ƒ/f/") live.log
+'
 test_expect_success 'configure queues and resource split amongst queues' '
 	flux R encode -r 0-3 -p batch:0-1 -p debug:2-3 \
 	   | tr -d "\n" \
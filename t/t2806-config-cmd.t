@@ -134,6 +134,33 @@ test_expect_success 'flux-config get returns empty object if no config' '
 	flux config get >empty.out &&
 	test_cmp empty.exp empty.out
 '
+test_expect_success 'flux-config reload --all works' '
+	echo "[baz]" >config/baz.toml &&
+	echo "a = 1" >>config/baz.toml &&
+	flux config reload --all &&
+	echo 1 >baz.exp &&
+	flux config get baz.a >baz.out &&
+	test_cmp baz.exp baz.out &&
+	rm -f config/baz.toml &&
+	flux config reload --all
+'
+test_expect_success 'flux-config reload --all distributes config to all ranks' '
+	mkdir -p allconf &&
+	printf "[x]\na = 1\nb = 2\n" >allconf/x.toml &&
+	printf "[x]\nb = 3\n" >override.toml &&
+	cat >reload-all.sh <<-EOT &&
+	flux exec -r all flux config get x.a &&
+	printf "[x]\na = 4\nb = 2\n" >allconf/x.toml &&
+	flux config reload --all &&
+	flux exec -r all flux config get x.a &&
+	flux exec -r all flux config get x.b
+	EOT
+	flux start -s2 -o,--config-path=$(pwd)/allconf \
+		-o,-Sconfig.override-path=$(pwd)/override.toml \
+		sh ./reload-all.sh >reload-all.out &&
+	printf "1\n1\n4\n4\n3\n3\n" >reload-all.exp &&
+	test_cmp reload-all.exp reload-all.out
+'
 test_expect_success 'flux-config load handles TOML input' '
 	echo "test.y.z=42" >load.toml &&
 	flux config load <load.toml &&
@@ -151,6 +151,23 @@ test_expect_success 'try dump - | restore - to key and verify content' '
 	test $(flux kvs readlink zz.z) = "smurf::otherthing" &&
 	test $(flux kvs readlink yy.zz.z) = "smurf::otherthing"
 '
+test_expect_success 'dump and restore produce the same archive with any --window' '
+	for i in $(seq 1 100); do \
+	    echo $i-$(seq 1 40) | flux kvs put many.k$i=-; \
+	done &&
+	flux dump --window=1 win1.tar &&
+	flux dump --window=512 win512.tar &&
+	tar xOf win1.tar >win1.out &&
+	tar xOf win512.tar >win512.out &&
+	test_cmp win1.out win512.out &&
+	flux restore --window=1 --key ww1 win512.tar &&
+	flux restore --window=512 --key ww512 win1.tar &&
+	test "$(flux kvs get --treeobj ww1)" = "$(flux kvs get --treeobj ww512)"
+'
+test_expect_success 'dump and restore reject --window=0' '
+	test_must_fail flux dump --window=0 x.tar &&
+	test_must_fail flux restore --window=0 --key ww0 win1.tar
+'
 test_expect_success 'dump ignores empty kvs directories' '
 	flux kvs mkdir empty &&
 	flux dump -v foo3.tar &&
@@ -225,6 +225,45 @@ test_expect_success 'wait for job-list inactive job count to reach 0' '
 test_expect_success 'confirm job-list stats show zero inactive jobs' '
 	test $(inactive_count job-list-stats) -eq 0
 '
+test_expect_success 'reconfigure job manager with rate-limited purge' '
+	flux module stats job-manager | jq .purge.commits >commits.before &&
+	flux config load <<-EOT
+	[job-manager]
+	inactive-age-limit = "1ms"
+	inactive-purge-rate = 20.0
+	inactive-purge-batch = 2
+	EOT
+'
+test_expect_success 'job manager stats report purge settings' '
+	flux module stats job-manager >purge-stats.json &&
+	jq -e ".purge.rate == 20" purge-stats.json &&
+	jq -e ".purge.batch == 2" purge-stats.json
+'
+test_expect_success 'create 10 inactive jobs' '
+	flux submit --cc=1-10 /bin/true &&
+	flux queue drain
+'
+test_expect_success 'wait for job-list inactive job count to reach 0' '
+	wait_inactive_count job-list 0 30
+'
+test_expect_success 'jobs were purged in batches of at most 2' '
+	flux module stats job-manager | jq .purge.commits >commits.after &&
+	test $(($(cat commits.after) - $(cat commits.before))) -ge 5
+'
+test_expect_success 'reconfigure job manager with invalid purge rate' '
+	test_must_fail flux config load 2>badrate.err <<-EOT &&
+	[job-manager]
+	inactive-purge-rate = -1.0
+	EOT
+	grep "must be >= 0" badrate.err
+'
+test_expect_success 'reconfigure job manager with invalid purge batch' '
+	test_must_fail flux config load 2>badbatch.err <<-EOT &&
+	[job-manager]
+	inactive-purge-batch = 0
+	EOT
+	grep "must be >= 1" badbatch.err
+'
 test_expect_success 'reconfigure job manager with incorrect type limit' '
 	test_must_fail flux config load 2>badtype.err <<-EOT &&
 	[job-manager]
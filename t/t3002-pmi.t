@@ -71,6 +71,9 @@ test_expect_success 'flux run -o pmi-simple.exchange.badopt fails' '
 test_expect_success 'flux run -o pmi-simple.exchange.k=foo fails' '
 	test_must_fail flux run -o pmi-simple.exchange.k=foo /bin/true
 '
+test_expect_success 'flux run -o pmi-simple.exchange.compress=-1 fails' '
+	test_must_fail flux run -o pmi-simple.exchange.compress=-1 /bin/true
+'
 test_expect_success 'flux run -o pmi-simple.nomap=foo fails' '
 	test_must_fail flux run -o pmi-simple.nomap=foo /bin/true
 '
@@ -109,6 +112,15 @@ test_expect_success 'kvstest works with -o pmi-simple.exchange.k=SIZE+1' '
 	grep "using k=${SIZE}" kvstest_kp1.err
 '
 
+test_expect_success 'kvstest works with -o pmi-simple.exchange.compress=1' '
+	flux run -n${SIZE} -N${SIZE} -o pmi-simple.exchange.compress=1 \
+		${kvstest} -N 100
+'
+test_expect_success 'kvstest works with -o pmi-simple.exchange.compress=0' '
+	flux run -n${SIZE} -N${SIZE} -o pmi-simple.exchange.compress=0 \
+		${kvstest} -N 100
+'
+
 test_expect_success 'kvstest fails with -o pmi-simple.kvs=unknown' '
 	test_must_fail flux run -o pmi-simple.kvs=unknown ${kvstest}
 '
@@ -69,6 +69,16 @@ test_expect_success 'wait timeout of zero is not an immediate timeout' '
 	flux overlay status --wait=full --summary --timeout=0
 '
 
+test_expect_success 'flux overlay status -v reports wireup time' '
+	flux overlay status --timeout=0 --summary -v >wireup.out &&
+	grep "^wireup: [0-9]" wireup.out
+'
+
+test_expect_success 'overlay.health response includes wireup time' '
+	flux python -c "import flux; print(flux.Flux().rpc(\"overlay.health\",nodeid=0).get_str())" \
+		| jq -e ".wireup >= 0"
+'
+
 test_expect_success 'flux overlay status --highlight option works (color)' '
 	flux overlay status --highlight=14 --color=always > highlight.out &&
 	grep "\[01;34" highlight.out > highlighted.out &&